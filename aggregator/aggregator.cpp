@@ -0,0 +1,219 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file aggregator.cpp
+ */
+
+#include <getopt.h>
+#include <signal.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fleet_http_server.h"
+#include "fleet_store.h"
+#include "logger.h"
+#include "node_subscriber.h"
+#include "push_receiver.h"
+
+namespace xpum::aggregator {
+
+using xpum::daemon::Logger;
+
+std::string nodes_file;
+std::string cluster_name = "default";
+std::string push_address = "0.0.0.0";
+int push_port = 0;
+std::string http_address = "127.0.0.1";
+int http_port = 9966;
+std::size_t subscribe_interval = 1000;
+std::size_t stale_timeout = 60;
+std::string log_level = "";
+char* log_file_name = nullptr;
+
+std::atomic_bool stop(false);
+
+void print_help(const char* app_name) {
+    printf("\n Usage: %s [OPTIONS]\n\n", app_name);
+    printf("  Options:\n");
+    printf("   -h, --help                       print this help\n");
+    printf("   -n, --nodes_file=filename        nodes of the cluster, \"node rack address [grpc target]\" per line\n");
+    printf("   -c, --cluster=name               name of the cluster in the labels, default \"default\"\n");
+    printf("       --push_port=number           receive the batches of xpumd --push_endpoint at ADDRESS:PORT\n");
+    printf("       --push_address=address       IPv4 address to receive the batches at, default 0.0.0.0\n");
+    printf("       --http_port=number           serve /metrics and /fleet at http://ADDRESS:PORT, default 9966\n");
+    printf("       --http_address=address       IPv4 address to serve HTTP at, default 127.0.0.1\n");
+    printf("       --subscribe_interval=number  min ms between the frames of the subscribed nodes, default 1000\n");
+    printf("       --stale_timeout=number       seconds without an update before a node is stale, default 60\n");
+    printf("       --log_level=LEVEL            log level (trace, debug, info, warn, error)\n");
+    printf("   -l, --log_file=filename          logfile to write\n");
+    printf("\n");
+}
+
+void signalHandler(int sig) {
+    stop = true;
+}
+
+bool to_size_t(const char* number, size_t& size) {
+    size_t tmp;
+    std::istringstream iss(number);
+    iss >> tmp;
+    if (iss.fail()) {
+        return false;
+    } else {
+        size = tmp;
+        return true;
+    }
+}
+
+bool to_port(const char* number, int& port) {
+    std::size_t value = 0;
+    if (!to_size_t(number, value) || value == 0 || value > 65535) {
+        return false;
+    }
+    port = (int)value;
+    return true;
+}
+
+void parse_opts(int argc, char* argv[]) {
+    int lopt;
+    static struct option long_options[] = {
+        {"help", no_argument, 0, 'h'},
+        {"nodes_file", required_argument, 0, 'n'},
+        {"cluster", required_argument, 0, 'c'},
+        {"log_file", required_argument, 0, 'l'},
+        {"push_port", required_argument, &lopt, 1},
+        {"push_address", required_argument, &lopt, 2},
+        {"http_port", required_argument, &lopt, 3},
+        {"http_address", required_argument, &lopt, 4},
+        {"subscribe_interval", required_argument, &lopt, 5},
+        {"stale_timeout", required_argument, &lopt, 6},
+        {"log_level", required_argument, &lopt, 7},
+        {NULL, 0, 0, 0}};
+    int value, option_index = 0;
+    while ((value = getopt_long(argc, argv, "n:c:l:h", long_options, &option_index)) != -1) {
+        switch (value) {
+            case 0: {
+                bool valid = false;
+                switch (lopt) {
+                    case 1:
+                        valid = to_port(optarg, push_port);
+                        break;
+                    case 2:
+                        push_address = optarg;
+                        valid = true;
+                        break;
+                    case 3:
+                        valid = to_port(optarg, http_port);
+                        break;
+                    case 4:
+                        http_address = optarg;
+                        valid = true;
+                        break;
+                    case 5:
+                        valid = to_size_t(optarg, subscribe_interval) && subscribe_interval > 0;
+                        break;
+                    case 6:
+                        valid = to_size_t(optarg, stale_timeout) && stale_timeout > 0;
+                        break;
+                    case 7: {
+                        std::string level = optarg;
+                        valid = level == "trace" || level == "debug" || level == "info" || level == "warn" || level == "error";
+                        log_level = level;
+                        break;
+                    }
+                    default:
+                        break;
+                }
+                if (!valid) {
+                    print_help(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            }
+            case 'n':
+                nodes_file = optarg;
+                break;
+            case 'c':
+                cluster_name = optarg;
+                break;
+            case 'l':
+                if (log_file_name == nullptr) {
+                    log_file_name = strdup(optarg);
+                }
+                break;
+            case 'h':
+                print_help(argv[0]);
+                exit(EXIT_SUCCESS);
+            case '?':
+                print_help(argv[0]);
+                exit(EXIT_FAILURE);
+            default:
+                break;
+        }
+    }
+}
+
+} // namespace xpum::aggregator
+
+using namespace xpum::aggregator;
+
+int main(int argc, char* argv[]) {
+    parse_opts(argc, argv);
+    Logger::init(log_level, log_file_name);
+    if (log_file_name != nullptr) {
+        free(log_file_name);
+        log_file_name = nullptr;
+    }
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+
+    FleetStore store(cluster_name, stale_timeout);
+    if (!nodes_file.empty() && !store.loadNodes(nodes_file)) {
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<PushReceiver> p_receiver;
+    if (push_port > 0) {
+        p_receiver.reset(new PushReceiver(store, push_address, push_port));
+        if (!p_receiver->start()) {
+            return EXIT_FAILURE;
+        }
+    }
+    std::vector<std::unique_ptr<NodeSubscriber>> subscribers;
+    for (auto& subscription : store.getSubscriptions()) {
+        subscribers.emplace_back(new NodeSubscriber(store, subscription.first, subscription.second, subscribe_interval));
+        subscribers.back()->start();
+    }
+    if (p_receiver == nullptr && subscribers.empty()) {
+        XPUM_LOG_ERROR("XPUM: no node to aggregate, set --push_port or the grpc targets of the nodes file");
+        return EXIT_FAILURE;
+    }
+    FleetHttpServer server(store, http_address, http_port);
+    if (!server.start()) {
+        return EXIT_FAILURE;
+    }
+    XPUM_LOG_INFO("XPUM: aggregating cluster {}, {} nodes subscribed", cluster_name, subscribers.size());
+
+    while (!stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+
+    XPUM_LOG_INFO("XPUM: aggregator shut down.");
+    server.stop();
+    for (auto& subscriber : subscribers) {
+        subscriber->stop();
+    }
+    if (p_receiver != nullptr) {
+        p_receiver->stop();
+    }
+    Logger::flush();
+    return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file fleet_http_server.cpp
+ */
+
+#include "fleet_http_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "logger.h"
+
+namespace xpum::aggregator {
+
+namespace {
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+void sendResponse(int fd, const char* status, const char* content_type, const std::string& body) {
+    std::string response = "HTTP/1.1 ";
+    response += status;
+    response += "\r\nContent-Type: ";
+    response += content_type;
+    response += "\r\nContent-Length: ";
+    response += std::to_string(body.size());
+    response += "\r\nConnection: close\r\n\r\n";
+    response += body;
+    sendAll(fd, response);
+}
+
+// the value of name in the query string, not decoded
+std::string getQueryParameter(const std::string& query, const std::string& name) {
+    size_t pos = 0;
+    while (pos < query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == std::string::npos) {
+            end = query.size();
+        }
+        std::string item = query.substr(pos, end - pos);
+        if (item.compare(0, name.size() + 1, name + "=") == 0) {
+            return item.substr(name.size() + 1);
+        }
+        pos = end + 1;
+    }
+    return "";
+}
+
+} // namespace
+
+FleetHttpServer::FleetHttpServer(FleetStore& store, const std::string& address, int port)
+    : store(store), address(address), port(port), listen_fd(-1), stopping(false) {
+}
+
+FleetHttpServer::~FleetHttpServer() {
+    stop();
+}
+
+bool FleetHttpServer::start() {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        XPUM_LOG_ERROR("XPUM: invalid HTTP address {}", address);
+        return false;
+    }
+    listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        XPUM_LOG_ERROR("XPUM: failed to create HTTP socket: {}", strerror(errno));
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 16) < 0) {
+        XPUM_LOG_ERROR("XPUM: failed to listen at {}:{} for HTTP: {}", address, port, strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+    stopping = false;
+    worker = std::thread(&FleetHttpServer::serve, this);
+    XPUM_LOG_INFO("XPUM: fleet rollups are served at http://{}:{}/metrics", address, port);
+    return true;
+}
+
+void FleetHttpServer::stop() {
+    stopping = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+    }
+}
+
+void FleetHttpServer::serve() {
+    pollfd pfd{};
+    pfd.fd = listen_fd;
+    pfd.events = POLLIN;
+    while (!stopping) {
+        // wake up now and then to notice stop()
+        int ret = poll(&pfd, 1, 500);
+        if (ret <= 0 || (pfd.revents & POLLIN) == 0) {
+            continue;
+        }
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        // a stalled client must not block the next scrape for long
+        timeval timeout{5, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        handleConnection(fd);
+        close(fd);
+    }
+}
+
+void FleetHttpServer::handleConnection(int fd) {
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            return;
+        }
+        request.append(buf, n);
+    }
+    auto line_end = request.find("\r\n");
+    std::string line = request.substr(0, line_end);
+    auto method_end = line.find(' ');
+    auto path_end = line.find(' ', method_end + 1);
+    if (method_end == std::string::npos || path_end == std::string::npos) {
+        sendResponse(fd, "400 Bad Request", "text/plain", "");
+        return;
+    }
+    std::string method = line.substr(0, method_end);
+    std::string target = line.substr(method_end + 1, path_end - method_end - 1);
+    auto query_begin = target.find('?');
+    std::string path = target.substr(0, query_begin);
+    std::string query = query_begin == std::string::npos ? "" : target.substr(query_begin + 1);
+    if (method != "GET") {
+        sendResponse(fd, "405 Method Not Allowed", "text/plain", "");
+    } else if (path == "/metrics") {
+        sendResponse(fd, "200 OK", "text/plain; version=0.0.4; charset=utf-8", store.renderMetrics());
+    } else if (path == "/fleet") {
+        sendResponse(fd, "200 OK", "application/json", store.renderFleet(getQueryParameter(query, "rack")));
+    } else {
+        sendResponse(fd, "404 Not Found", "text/plain", "");
+    }
+}
+
+} // namespace xpum::aggregator
@@ -0,0 +1,53 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file fleet_http_server.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "fleet_store.h"
+
+namespace xpum::aggregator {
+
+/*
+  FleetHttpServer serves the store over HTTP:
+    /metrics                 the rack and cluster rollups for Prometheus federation
+    /fleet                   the racks and the nodes with their rollups, as JSON
+    /fleet?rack=NAME         the nodes of one rack
+  One request at a time, like the metrics endpoint of xpumd: the responses
+  are rendered from the store in memory.
+*/
+class FleetHttpServer {
+   public:
+    FleetHttpServer(FleetStore& store, const std::string& address, int port);
+
+    ~FleetHttpServer();
+
+    bool start();
+
+    void stop();
+
+   private:
+    void serve();
+
+    void handleConnection(int fd);
+
+    FleetStore& store;
+
+    std::string address;
+
+    int port;
+
+    int listen_fd;
+
+    std::atomic<bool> stopping;
+
+    std::thread worker;
+};
+
+} // namespace xpum::aggregator
@@ -0,0 +1,405 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file fleet_store.cpp
+ */
+
+#include "fleet_store.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include "logger.h"
+#include "xpum_structs.h"
+
+namespace xpum::aggregator {
+
+namespace {
+
+enum class TileAggregation {
+    SUM,
+    AVG
+};
+
+struct FleetMetric {
+    const char* name;
+    const char* help;
+    // to the unit of the name, after the scale of the sample
+    double scale;
+    // how the tile values make up the device value if the device has none
+    TileAggregation aggregation;
+};
+
+// the names of the node exporter with the xpum_fleet_ prefix, see daemon/metrics_exporter.cpp
+const std::map<uint32_t, FleetMetric> fleet_metrics = {
+    {XPUM_STATS_GPU_UTILIZATION, {"xpum_fleet_engine_ratio", "GPU active time of the elapsed time (in %), per GPU", 0.01, TileAggregation::AVG}},
+    {XPUM_STATS_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION, {"xpum_fleet_compute_engine_group_ratio", "Avg utilization of the compute engine group (in %), per GPU", 0.01, TileAggregation::AVG}},
+    {XPUM_STATS_ENGINE_GROUP_MEDIA_ALL_UTILIZATION, {"xpum_fleet_media_engine_group_ratio", "Avg utilization of the media engine group (in %), per GPU", 0.01, TileAggregation::AVG}},
+    {XPUM_STATS_POWER, {"xpum_fleet_power_watts", "Avg GPU power (in watts), per GPU", 1, TileAggregation::SUM}},
+    {XPUM_STATS_ENERGY, {"xpum_fleet_energy_joules", "Total GPU energy consumption since boot (in Joules), per GPU", 0.001, TileAggregation::SUM}},
+    {XPUM_STATS_GPU_CORE_TEMPERATURE, {"xpum_fleet_gpu_temperature_celsius", "Avg GPU temperature (in Celsius degree), per GPU", 1, TileAggregation::AVG}},
+    {XPUM_STATS_MEMORY_TEMPERATURE, {"xpum_fleet_memory_temperature_celsius", "Avg GPU memory temperature (in Celsius degree), per GPU", 1, TileAggregation::AVG}},
+    {XPUM_STATS_GPU_FREQUENCY, {"xpum_fleet_frequency_mhz", "Avg GPU frequency (in MHz), per GPU", 1, TileAggregation::AVG}},
+    {XPUM_STATS_MEMORY_USED, {"xpum_fleet_memory_used_bytes", "Used GPU memory (in bytes), per GPU", 1, TileAggregation::SUM}},
+    {XPUM_STATS_MEMORY_UTILIZATION, {"xpum_fleet_memory_ratio", "Used GPU memory / Total GPU memory (in %), per GPU", 0.01, TileAggregation::AVG}},
+    {XPUM_STATS_MEMORY_BANDWIDTH, {"xpum_fleet_memory_bandwidth_ratio", "Avg memory throughput / max memory bandwidth (in %), per GPU", 0.01, TileAggregation::AVG}},
+    {XPUM_STATS_RAS_ERROR_CAT_RESET, {"xpum_fleet_resets", "Total number of GPU reset since Sysman init, per GPU", 1, TileAggregation::SUM}},
+    {XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE, {"xpum_fleet_uncorrectable_cache_errors", "Total number of uncorrectable GPU cache errors since Sysman init, per GPU", 1, TileAggregation::SUM}},
+    {XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE, {"xpum_fleet_uncorrectable_non_compute_errors", "Total number of uncorrectable GPU non-compute errors since Sysman init, per GPU", 1, TileAggregation::SUM}},
+};
+
+const char* unknown_rack = "unknown";
+
+uint64_t nowMillisecond() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+void appendLabel(std::string& labels, const char* name, const std::string& value) {
+    if (!labels.empty()) {
+        labels += ',';
+    }
+    labels += name;
+    labels += "=\"";
+    for (char c : value) {
+        switch (c) {
+            case '\\':
+                labels += "\\\\";
+                break;
+            case '"':
+                labels += "\\\"";
+                break;
+            case '\n':
+                labels += "\\n";
+                break;
+            default:
+                labels += c;
+                break;
+        }
+    }
+    labels += '"';
+}
+
+void appendJsonString(std::string& out, const std::string& value) {
+    out += '"';
+    for (char c : value) {
+        switch (c) {
+            case '\\':
+                out += "\\\\";
+                break;
+            case '"':
+                out += "\\\"";
+                break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+                break;
+        }
+    }
+    out += '"';
+}
+
+std::string formatDouble(double value) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.15g", value);
+    return buf;
+}
+
+} // namespace
+
+void FleetStore::Rollup::add(double value) {
+    if (count == 0 || value < min) {
+        min = value;
+    }
+    if (count == 0 || value > max) {
+        max = value;
+    }
+    sum += value;
+    count++;
+}
+
+void FleetStore::Rollup::merge(const Rollup& other) {
+    if (other.count == 0) {
+        return;
+    }
+    if (count == 0 || other.min < min) {
+        min = other.min;
+    }
+    if (count == 0 || other.max > max) {
+        max = other.max;
+    }
+    sum += other.sum;
+    count += other.count;
+}
+
+FleetStore::FleetStore(const std::string& cluster, uint32_t staleTimeout)
+    : cluster(cluster), stale_timeout_ms(staleTimeout * 1000ull) {
+}
+
+bool FleetStore::loadNodes(const std::string& fileName) {
+    std::ifstream file(fileName);
+    if (!file.is_open()) {
+        XPUM_LOG_ERROR("XPUM: failed to open nodes file {}", fileName);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string node, rack, address, target;
+        if (!(fields >> node)) {
+            continue;
+        }
+        if (!(fields >> rack >> address)) {
+            XPUM_LOG_WARN("XPUM: invalid line {} of nodes file {}", line_number, fileName);
+            continue;
+        }
+        fields >> target;
+        NodeEntry& entry = nodes[node];
+        entry.rack = rack;
+        entry.address = address;
+        entry.target = target;
+        addresses[address] = node;
+    }
+    XPUM_LOG_INFO("XPUM: {} nodes are read from {}", nodes.size(), fileName);
+    return true;
+}
+
+std::pair<std::string, std::string> FleetStore::resolve(const std::string& address) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = addresses.find(address);
+    if (it == addresses.end()) {
+        return std::make_pair(address, std::string(unknown_rack));
+    }
+    return std::make_pair(it->second, nodes[it->second].rack);
+}
+
+std::vector<std::pair<std::string, std::string>> FleetStore::getSubscriptions() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::pair<std::string, std::string>> ret;
+    for (auto& node : nodes) {
+        if (!node.second.target.empty()) {
+            ret.emplace_back(node.first, node.second.target);
+        }
+    }
+    return ret;
+}
+
+void FleetStore::update(const std::string& node, const std::string& rack, const std::map<FleetSeriesKey, FleetSample>& samples, bool keyFrame) {
+    std::lock_guard<std::mutex> lock(mutex);
+    NodeEntry& entry = nodes[node];
+    if (entry.rack.empty()) {
+        entry.rack = rack;
+    }
+    if (keyFrame) {
+        for (auto it = entry.series.begin(); it != entry.series.end();) {
+            if (samples.find(it->first) == samples.end()) {
+                it = entry.series.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (auto& sample : samples) {
+        FleetSample& current = entry.series[sample.first];
+        // the spooled batches of a node arrive after the newer ones
+        if (sample.second.timestamp >= current.timestamp) {
+            current = sample.second;
+        }
+    }
+    entry.last_update = nowMillisecond();
+}
+
+bool FleetStore::isStale(const NodeEntry& entry, uint64_t now) const {
+    return entry.last_update == 0 || now - entry.last_update > stale_timeout_ms;
+}
+
+void FleetStore::collectDeviceValues(const NodeEntry& entry, std::map<uint32_t, std::vector<double>>& values) {
+    // device id and metric type to the device value, or the tile values
+    std::map<std::pair<uint32_t, uint32_t>, double> device_values;
+    std::map<std::pair<uint32_t, uint32_t>, std::vector<double>> tile_values;
+    for (auto& series : entry.series) {
+        uint32_t type = std::get<2>(series.first);
+        auto metric = fleet_metrics.find(type);
+        if (metric == fleet_metrics.end()) {
+            continue;
+        }
+        double value = series.second.value;
+        if (series.second.scale > 1) {
+            value /= series.second.scale;
+        }
+        value *= metric->second.scale;
+        auto key = std::make_pair(std::get<0>(series.first), type);
+        if (std::get<1>(series.first) < 0) {
+            device_values[key] = value;
+        } else {
+            tile_values[key].push_back(value);
+        }
+    }
+    for (auto& tiles : tile_values) {
+        if (device_values.find(tiles.first) != device_values.end()) {
+            continue;
+        }
+        double sum = 0;
+        for (double value : tiles.second) {
+            sum += value;
+        }
+        bool average = fleet_metrics.at(tiles.first.second).aggregation == TileAggregation::AVG;
+        device_values[tiles.first] = average ? sum / tiles.second.size() : sum;
+    }
+    for (auto& value : device_values) {
+        values[value.first.second].push_back(value.second);
+    }
+}
+
+std::string FleetStore::renderMetrics() {
+    RackRollups rollups;
+    // rack to the count of the nodes up and stale, and of the devices
+    std::map<std::string, std::tuple<uint32_t, uint32_t, uint32_t>> counts;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t now = nowMillisecond();
+        for (auto& node : nodes) {
+            auto& count = counts[node.second.rack];
+            if (isStale(node.second, now)) {
+                std::get<1>(count)++;
+                continue;
+            }
+            std::get<0>(count)++;
+            std::map<uint32_t, std::vector<double>> values;
+            collectDeviceValues(node.second, values);
+            std::set<uint32_t> devices;
+            for (auto& series : node.second.series) {
+                devices.insert(std::get<0>(series.first));
+            }
+            std::get<2>(count) += devices.size();
+            for (auto& metric : values) {
+                Rollup& rollup = rollups[metric.first][node.second.rack];
+                for (double value : metric.second) {
+                    rollup.add(value);
+                }
+            }
+        }
+    }
+
+    std::string cluster_labels;
+    appendLabel(cluster_labels, "cluster", cluster);
+    std::map<std::string, std::string> rack_labels;
+    for (auto& count : counts) {
+        std::string labels = cluster_labels;
+        appendLabel(labels, "rack", count.first);
+        rack_labels[count.first] = labels;
+    }
+
+    std::string ret;
+    ret += "# HELP xpum_fleet_nodes Number of nodes, per rack and by state\n";
+    ret += "# TYPE xpum_fleet_nodes gauge\n";
+    for (auto& count : counts) {
+        ret += "xpum_fleet_nodes{" + rack_labels[count.first] + ",state=\"up\"} " + std::to_string(std::get<0>(count.second)) + '\n';
+        ret += "xpum_fleet_nodes{" + rack_labels[count.first] + ",state=\"stale\"} " + std::to_string(std::get<1>(count.second)) + '\n';
+    }
+    ret += "# HELP xpum_fleet_devices Number of GPUs of the nodes up, per rack\n";
+    ret += "# TYPE xpum_fleet_devices gauge\n";
+    for (auto& count : counts) {
+        ret += "xpum_fleet_devices{" + rack_labels[count.first] + "} " + std::to_string(std::get<2>(count.second)) + '\n';
+    }
+
+    for (auto& metric : rollups) {
+        const FleetMetric& family = fleet_metrics.at(metric.first);
+        ret += std::string("# HELP ") + family.name + " " + family.help + ", rolled up per rack and per cluster\n";
+        ret += std::string("# TYPE ") + family.name + " gauge\n";
+        Rollup total;
+        auto render = [&](const std::string& labels, const Rollup& rollup) {
+            ret += family.name + std::string("{") + labels + ",stat=\"sum\"} " + formatDouble(rollup.sum) + '\n';
+            ret += family.name + std::string("{") + labels + ",stat=\"avg\"} " + formatDouble(rollup.sum / rollup.count) + '\n';
+            ret += family.name + std::string("{") + labels + ",stat=\"min\"} " + formatDouble(rollup.min) + '\n';
+            ret += family.name + std::string("{") + labels + ",stat=\"max\"} " + formatDouble(rollup.max) + '\n';
+        };
+        for (auto& rack : metric.second) {
+            render(rack_labels[rack.first] + ",scope=\"rack\"", rack.second);
+            total.merge(rack.second);
+        }
+        render(cluster_labels + ",scope=\"cluster\"", total);
+    }
+    return ret;
+}
+
+std::string FleetStore::renderFleet(const std::string& rack) {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t now = nowMillisecond();
+    std::map<std::string, std::vector<const std::pair<const std::string, NodeEntry>*>> racks;
+    for (auto& node : nodes) {
+        if (rack.empty() || node.second.rack == rack) {
+            racks[node.second.rack].push_back(&node);
+        }
+    }
+    std::string ret = "{\"cluster\":";
+    appendJsonString(ret, cluster);
+    ret += ",\"racks\":[";
+    bool first_rack = true;
+    for (auto& item : racks) {
+        if (!first_rack) {
+            ret += ',';
+        }
+        first_rack = false;
+        ret += "{\"rack\":";
+        appendJsonString(ret, item.first);
+        ret += ",\"nodes\":[";
+        bool first_node = true;
+        for (auto p_node : item.second) {
+            const NodeEntry& entry = p_node->second;
+            if (!first_node) {
+                ret += ',';
+            }
+            first_node = false;
+            std::set<uint32_t> devices;
+            for (auto& series : entry.series) {
+                devices.insert(std::get<0>(series.first));
+            }
+            ret += "{\"node\":";
+            appendJsonString(ret, p_node->first);
+            ret += ",\"address\":";
+            appendJsonString(ret, entry.address);
+            ret += ",\"state\":";
+            ret += isStale(entry, now) ? "\"stale\"" : "\"up\"";
+            ret += ",\"last_update\":" + std::to_string(entry.last_update);
+            ret += ",\"device_count\":" + std::to_string(devices.size());
+            ret += ",\"metrics\":{";
+            std::map<uint32_t, std::vector<double>> values;
+            collectDeviceValues(entry, values);
+            bool first_metric = true;
+            for (auto& metric : values) {
+                if (!first_metric) {
+                    ret += ',';
+                }
+                first_metric = false;
+                Rollup rollup;
+                for (double value : metric.second) {
+                    rollup.add(value);
+                }
+                appendJsonString(ret, fleet_metrics.at(metric.first).name);
+                ret += ":{\"sum\":" + formatDouble(rollup.sum) + ",\"avg\":" + formatDouble(rollup.sum / rollup.count) +
+                       ",\"min\":" + formatDouble(rollup.min) + ",\"max\":" + formatDouble(rollup.max) + "}";
+            }
+            ret += "}}";
+        }
+        ret += "]}";
+    }
+    ret += "]}";
+    return ret;
+}
+
+} // namespace xpum::aggregator
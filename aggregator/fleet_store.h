@@ -0,0 +1,103 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file fleet_store.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace xpum::aggregator {
+
+// the latest sample of a series of a node
+struct FleetSample {
+    uint64_t value = 0;
+    uint32_t scale = 1;
+    bool is_counter = false;
+    uint64_t timestamp = 0;
+};
+
+// device id, tile id (-1 for the device) and metric type, xpum_stats_type_t
+typedef std::tuple<uint32_t, int32_t, uint32_t> FleetSeriesKey;
+
+/*
+  FleetStore keeps the latest sample of every series of every node, fed by
+  the pushed batches and the subscribed metrics streams, and renders the
+  rollups of the racks and of the cluster from them. Only the latest sample
+  is kept: the rollups are what the central Prometheus federates, and the
+  history of a node stays on the node.
+
+  A node whose last update is older than the stale timeout is left out of
+  the rollups and reported as stale, so a node going down does not keep its
+  last values in the sums.
+*/
+class FleetStore {
+   public:
+    // the node of an address without an entry in the nodes file is named by the address, in rack "unknown"
+    FleetStore(const std::string& cluster, uint32_t staleTimeout);
+
+    // "node rack address [grpc target]" per line, '#' starts a comment
+    bool loadNodes(const std::string& fileName);
+
+    // the node and rack of a peer address
+    std::pair<std::string, std::string> resolve(const std::string& address);
+
+    // the node name and gRPC target of the nodes to subscribe to
+    std::vector<std::pair<std::string, std::string>> getSubscriptions();
+
+    // keep the samples newer than the ones of the node, a key frame drops the series not in it
+    void update(const std::string& node, const std::string& rack, const std::map<FleetSeriesKey, FleetSample>& samples, bool keyFrame);
+
+    // the rollups in the Prometheus text format
+    std::string renderMetrics();
+
+    // the racks and nodes as JSON, only the rack if rack is not empty
+    std::string renderFleet(const std::string& rack);
+
+   private:
+    struct NodeEntry {
+        std::string rack;
+        std::string address;
+        std::string target;
+        uint64_t last_update = 0;
+        std::map<FleetSeriesKey, FleetSample> series;
+    };
+
+    struct Rollup {
+        double sum = 0;
+        double min = 0;
+        double max = 0;
+        uint32_t count = 0;
+
+        void add(double value);
+
+        void merge(const Rollup& other);
+    };
+
+    // metric type to the rollup of each rack
+    typedef std::map<uint32_t, std::map<std::string, Rollup>> RackRollups;
+
+    // the device values of a node, the tile values make up a device value the device has not
+    static void collectDeviceValues(const NodeEntry& entry, std::map<uint32_t, std::vector<double>>& values);
+
+    bool isStale(const NodeEntry& entry, uint64_t now) const;
+
+    std::string cluster;
+
+    uint64_t stale_timeout_ms;
+
+    std::mutex mutex;
+
+    std::map<std::string, NodeEntry> nodes;
+
+    // address to node name
+    std::map<std::string, std::string> addresses;
+};
+
+} // namespace xpum::aggregator
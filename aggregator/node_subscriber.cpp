@@ -0,0 +1,123 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file node_subscriber.cpp
+ */
+
+#include "node_subscriber.h"
+
+#include <grpc/impl/codegen/grpc_types.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "core.grpc.pb.h"
+#include "core.pb.h"
+#include "logger.h"
+
+namespace xpum::aggregator {
+
+namespace {
+
+// the backoff before opening a failed stream again, doubled up to the max
+const uint32_t min_backoff_ms = 1000;
+
+const uint32_t max_backoff_ms = 60 * 1000;
+
+} // namespace
+
+NodeSubscriber::NodeSubscriber(FleetStore& store, const std::string& node, const std::string& target, uint32_t interval)
+    : store(store), node(node), target(target), interval(interval), stopping(false) {
+}
+
+NodeSubscriber::~NodeSubscriber() {
+    stop();
+}
+
+void NodeSubscriber::start() {
+    stopping = false;
+    worker = std::thread(&NodeSubscriber::run, this);
+}
+
+void NodeSubscriber::stop() {
+    stopping = true;
+    {
+        std::lock_guard<std::mutex> lock(context_mutex);
+        if (p_context != nullptr) {
+            p_context->TryCancel();
+        }
+    }
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void NodeSubscriber::run() {
+    uint32_t backoff = min_backoff_ms;
+    while (!stopping) {
+        if (follow()) {
+            backoff = min_backoff_ms;
+        } else {
+            backoff = std::min(backoff * 2, max_backoff_ms);
+        }
+        // sleep in short steps to notice stop()
+        auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(backoff);
+        while (!stopping && std::chrono::steady_clock::now() < until) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+}
+
+bool NodeSubscriber::follow() {
+    grpc::ChannelArguments args;
+    args.SetInt(GRPC_ARG_ENABLE_HTTP_PROXY, 0);
+    // xpumd rate limits the clients by peer and user agent
+    args.SetUserAgentPrefix("xpum-aggregator");
+    auto channel = grpc::CreateCustomChannel(target, grpc::InsecureChannelCredentials(), args);
+    auto stub = XpumCoreService::NewStub(channel);
+    {
+        std::lock_guard<std::mutex> lock(context_mutex);
+        if (stopping) {
+            return true;
+        }
+        p_context = std::make_shared<grpc::ClientContext>();
+    }
+
+    XpumSubscribeMetricsRequest request;
+    request.set_interval(interval);
+    auto reader = stub->subscribeMetrics(p_context.get(), request);
+    bool received = false;
+    MetricsFrame frame;
+    while (reader->Read(&frame)) {
+        if (frame.errorno() != 0) {
+            XPUM_LOG_WARN("XPUM: node {} failed to stream metrics: {}", node, frame.errormsg());
+            break;
+        }
+        if (!received) {
+            XPUM_LOG_INFO("XPUM: subscribed to the metrics of node {} at {}", node, target);
+        }
+        received = true;
+        std::map<FleetSeriesKey, FleetSample> samples;
+        for (auto& data : frame.datalist()) {
+            FleetSample sample;
+            sample.value = data.value();
+            sample.scale = data.scale();
+            sample.is_counter = data.iscounter();
+            sample.timestamp = data.timestamp();
+            samples[FleetSeriesKey(data.deviceid(), data.istiledata() ? data.tileid() : -1, data.metricstype().value())] = sample;
+        }
+        // the node is in the nodes file, it keeps its rack there
+        store.update(node, "", samples, frame.keyframe());
+    }
+    grpc::Status status = reader->Finish();
+    if (!stopping && !status.ok()) {
+        XPUM_LOG_DEBUG("XPUM: metrics stream of node {} at {} ended: {}", node, target, status.error_message());
+    }
+    {
+        std::lock_guard<std::mutex> lock(context_mutex);
+        p_context.reset();
+    }
+    return received;
+}
+
+} // namespace xpum::aggregator
@@ -0,0 +1,67 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file node_subscriber.h
+ */
+
+#pragma once
+
+#include <grpc++/grpc++.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "fleet_store.h"
+
+namespace xpum::aggregator {
+
+/*
+  NodeSubscriber follows the subscribeMetrics stream of one xpumd and
+  applies its delta-encoded frames to the store: a key frame is the whole
+  set of series of the node, a frame after it only the values that changed.
+  The stream is opened again after a backoff when it ends, and the first
+  frame of a new stream is a key frame again.
+
+  xpumd serves gRPC on its unix sockets only, so the target of a remote node
+  is a TCP port forwarded to the socket of the node.
+*/
+class NodeSubscriber {
+   public:
+    // interval is the min ms between the frames
+    NodeSubscriber(FleetStore& store, const std::string& node, const std::string& target, uint32_t interval);
+
+    ~NodeSubscriber();
+
+    void start();
+
+    void stop();
+
+   private:
+    void run();
+
+    // false if the stream failed before its first frame
+    bool follow();
+
+    FleetStore& store;
+
+    std::string node;
+
+    std::string target;
+
+    uint32_t interval;
+
+    std::atomic<bool> stopping;
+
+    // the context of the stream in progress, cancelled by stop()
+    std::mutex context_mutex;
+
+    std::shared_ptr<grpc::ClientContext> p_context;
+
+    std::thread worker;
+};
+
+} // namespace xpum::aggregator
@@ -0,0 +1,319 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file push_receiver.cpp
+ */
+
+#include "push_receiver.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "logger.h"
+
+namespace xpum::aggregator {
+
+namespace {
+
+const uint32_t batch_magic = 0x50545058;
+
+const uint16_t batch_version = 1;
+
+class BitReader {
+   public:
+    BitReader(const char* data, size_t size) : data(data), size(size), pos(0) {}
+
+    // false if the stream ends before bits
+    bool read(int bits, uint64_t& value) {
+        value = 0;
+        while (bits > 0) {
+            if (pos >= size * 8) {
+                return false;
+            }
+            int used = pos % 8;
+            int n = std::min(bits, 8 - used);
+            uint64_t chunk = ((uint8_t)data[pos / 8] >> (8 - used - n)) & ((1u << n) - 1);
+            value = (value << n) | chunk;
+            pos += n;
+            bits -= n;
+        }
+        return true;
+    }
+
+    bool readSigned(int bits, int64_t& value) {
+        uint64_t raw;
+        if (!read(bits, raw)) {
+            return false;
+        }
+        // sign extend the two's complement of bits
+        if (bits < 64 && (raw >> (bits - 1)) & 1) {
+            raw |= ~0ull << bits;
+        }
+        value = (int64_t)raw;
+        return true;
+    }
+
+   private:
+    const char* data;
+
+    size_t size;
+
+    size_t pos;
+};
+
+template <typename T>
+bool getInt(const std::string& in, size_t& pos, T& value) {
+    if (pos + sizeof(T) > in.size()) {
+        return false;
+    }
+    uint64_t ret = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+        ret |= (uint64_t)(uint8_t)in[pos + i] << (i * 8);
+    }
+    value = (T)ret;
+    pos += sizeof(T);
+    return true;
+}
+
+// the last timestamp and value of a series, the inverse of TelemetryPusher::Series::append
+bool decodeSeries(const char* data, size_t size, uint32_t count, uint64_t& timestamp, uint64_t& value) {
+    if (count == 0) {
+        return false;
+    }
+    BitReader reader(data, size);
+    if (!reader.read(64, timestamp) || !reader.read(64, value)) {
+        return false;
+    }
+    int64_t delta = 0;
+    int leading = 0;
+    int trailing = 0;
+    for (uint32_t i = 1; i < count; i++) {
+        uint64_t bit;
+        int64_t dod = 0;
+        if (!reader.read(1, bit)) {
+            return false;
+        }
+        if (bit == 1) {
+            // the count of the leading ones, up to 4, picks the width of the delta of delta
+            static const int widths[] = {7, 9, 12, 64};
+            int ones = 1;
+            while (ones < 4) {
+                if (!reader.read(1, bit)) {
+                    return false;
+                }
+                if (bit == 0) {
+                    break;
+                }
+                ones++;
+            }
+            if (!reader.readSigned(widths[ones - 1], dod)) {
+                return false;
+            }
+        }
+        delta += dod;
+        timestamp += delta;
+
+        if (!reader.read(1, bit)) {
+            return false;
+        }
+        if (bit == 1) {
+            uint64_t control;
+            if (!reader.read(1, control)) {
+                return false;
+            }
+            if (control == 1) {
+                uint64_t lead, meaningful;
+                if (!reader.read(6, lead) || !reader.read(6, meaningful)) {
+                    return false;
+                }
+                leading = (int)lead;
+                trailing = 64 - leading - (int)meaningful - 1;
+                if (trailing < 0) {
+                    return false;
+                }
+            }
+            uint64_t bits;
+            if (!reader.read(64 - leading - trailing, bits)) {
+                return false;
+            }
+            value ^= bits << trailing;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+PushReceiver::PushReceiver(FleetStore& store, const std::string& address, int port)
+    : store(store), address(address), port(port), listen_fd(-1), stopping(false) {
+}
+
+PushReceiver::~PushReceiver() {
+    stop();
+}
+
+bool PushReceiver::start() {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        XPUM_LOG_ERROR("XPUM: invalid push address {}", address);
+        return false;
+    }
+    listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        XPUM_LOG_ERROR("XPUM: failed to create push socket: {}", strerror(errno));
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 1024) < 0) {
+        XPUM_LOG_ERROR("XPUM: failed to listen at {}:{} for pushed telemetry: {}", address, port, strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+    stopping = false;
+    worker = std::thread(&PushReceiver::serve, this);
+    XPUM_LOG_INFO("XPUM: pushed telemetry is received at {}:{}", address, port);
+    return true;
+}
+
+void PushReceiver::stop() {
+    stopping = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    for (auto& connection : connections) {
+        close(connection.first);
+    }
+    connections.clear();
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+    }
+}
+
+void PushReceiver::serve() {
+    std::vector<pollfd> pfds;
+    while (!stopping) {
+        pfds.clear();
+        pfds.push_back({listen_fd, POLLIN, 0});
+        for (auto& connection : connections) {
+            pfds.push_back({connection.first, POLLIN, 0});
+        }
+        // wake up now and then to notice stop()
+        int ret = poll(pfds.data(), pfds.size(), 500);
+        if (ret <= 0) {
+            continue;
+        }
+        for (size_t i = 1; i < pfds.size(); i++) {
+            if (pfds[i].revents == 0) {
+                continue;
+            }
+            auto it = connections.find(pfds[i].fd);
+            if (!receive(it->first, it->second)) {
+                close(it->first);
+                connections.erase(it);
+            }
+        }
+        if (pfds[0].revents & POLLIN) {
+            accept();
+        }
+    }
+}
+
+void PushReceiver::accept() {
+    sockaddr_in peer{};
+    socklen_t len = sizeof(peer);
+    int fd = accept4(listen_fd, (sockaddr*)&peer, &len, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (fd < 0) {
+        return;
+    }
+    char buf[INET_ADDRSTRLEN] = {};
+    inet_ntop(AF_INET, &peer.sin_addr, buf, sizeof(buf));
+    Connection& connection = connections[fd];
+    auto node = store.resolve(buf);
+    connection.node = node.first;
+    connection.rack = node.second;
+    XPUM_LOG_DEBUG("XPUM: node {} of rack {} connected from {}", connection.node, connection.rack, buf);
+}
+
+bool PushReceiver::receive(int fd, Connection& connection) {
+    char buf[64 * 1024];
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        XPUM_LOG_DEBUG("XPUM: node {} disconnected", connection.node);
+        return false;
+    }
+    if (n < 0) {
+        return true;
+    }
+    connection.buffer.append(buf, n);
+    // the complete frames of the buffer
+    size_t pos = 0;
+    while (true) {
+        size_t begin = pos;
+        uint32_t length;
+        if (!getInt<uint32_t>(connection.buffer, pos, length)) {
+            pos = begin;
+            break;
+        }
+        if (length > max_frame_bytes) {
+            XPUM_LOG_WARN("XPUM: invalid batch length {} from node {}", length, connection.node);
+            return false;
+        }
+        if (connection.buffer.size() - pos < length) {
+            pos = begin;
+            break;
+        }
+        std::map<FleetSeriesKey, FleetSample> samples;
+        if (decodeBatch(connection.buffer.substr(pos, length), samples)) {
+            store.update(connection.node, connection.rack, samples, false);
+        } else {
+            XPUM_LOG_WARN("XPUM: invalid batch from node {}", connection.node);
+        }
+        pos += length;
+    }
+    connection.buffer.erase(0, pos);
+    return true;
+}
+
+bool PushReceiver::decodeBatch(const std::string& frame, std::map<FleetSeriesKey, FleetSample>& samples) {
+    size_t pos = 0;
+    uint32_t magic, count;
+    uint16_t version, reserved;
+    uint64_t timestamp;
+    if (!getInt(frame, pos, magic) || !getInt(frame, pos, version) || !getInt(frame, pos, reserved) ||
+        !getInt(frame, pos, timestamp) || !getInt(frame, pos, count) || magic != batch_magic || version != batch_version) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t device_id, type, scale, sample_count, size;
+        int32_t tile_id;
+        uint8_t is_counter;
+        if (!getInt(frame, pos, device_id) || !getInt(frame, pos, tile_id) || !getInt(frame, pos, type) ||
+            !getInt(frame, pos, scale) || !getInt(frame, pos, is_counter) || !getInt(frame, pos, sample_count) ||
+            !getInt(frame, pos, size) || frame.size() - pos < size) {
+            return false;
+        }
+        FleetSample sample;
+        sample.scale = scale;
+        sample.is_counter = is_counter != 0;
+        if (!decodeSeries(frame.data() + pos, size, sample_count, sample.timestamp, sample.value)) {
+            return false;
+        }
+        samples[FleetSeriesKey(device_id, tile_id, type)] = sample;
+        pos += size;
+    }
+    return true;
+}
+
+} // namespace xpum::aggregator
@@ -0,0 +1,74 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file push_receiver.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "fleet_store.h"
+
+namespace xpum::aggregator {
+
+/*
+  PushReceiver is the collector of the telemetry batches xpumd pushes with
+  --push_endpoint, see daemon/telemetry_pusher.h for the format. All the
+  connections are served by one thread polling them, so thousands of nodes
+  cost one buffer each and no thread. The node of a connection is its peer
+  address, looked up in the nodes file.
+
+  Only the last sample of each series of a batch is decoded into the store,
+  the samples before are skipped through the bit stream.
+*/
+class PushReceiver {
+   public:
+    PushReceiver(FleetStore& store, const std::string& address, int port);
+
+    ~PushReceiver();
+
+    bool start();
+
+    void stop();
+
+    // decode a frame without its length prefix, false if it is not a valid batch
+    static bool decodeBatch(const std::string& frame, std::map<FleetSeriesKey, FleetSample>& samples);
+
+   private:
+    struct Connection {
+        std::string node;
+        std::string rack;
+        std::string buffer;
+    };
+
+    void serve();
+
+    void accept();
+
+    // false if the connection is to be closed
+    bool receive(int fd, Connection& connection);
+
+    // the max length of a batch, a longer length is a broken stream
+    static const uint32_t max_frame_bytes = 64 * 1024 * 1024;
+
+    FleetStore& store;
+
+    std::string address;
+
+    int port;
+
+    int listen_fd;
+
+    std::map<int, Connection> connections;
+
+    std::atomic<bool> stopping;
+
+    std::thread worker;
+};
+
+} // namespace xpum::aggregator
@@ -52,6 +52,9 @@ int listAmcFwVersions() {
     return 0;
 }
 
+// the percent of each AMC, the callbacks are called one at a time
+static std::vector<uint32_t> cardPercents;
+
 static void printProgress(int percentage) {
     int barWidth = 60;
 
@@ -65,7 +68,13 @@ static void printProgress(int percentage) {
         else
             std::cout << " ";
     }
-    std::cout << "] " << percentage << " %\r";
+    std::cout << "] " << percentage << " %";
+    if (cardPercents.size() > 1) {
+        for (size_t i = 0; i < cardPercents.size(); i++)
+            std::cout << (i == 0 ? " (" : ", ") << "AMC " << i << ": " << cardPercents[i] << " %";
+        std::cout << ")";
+    }
+    std::cout << "\r";
     std::cout.flush();
 }
 
@@ -73,8 +82,15 @@ static void percent_callback(uint32_t percent, void* pAmcManager) {
     printProgress(percent);
 }
 
+static void card_percent_callback(int card, uint32_t percent, void* pAmcManager) {
+    if (card >= (int)cardPercents.size())
+        cardPercents.resize(card + 1, 0);
+    cardPercents[card] = percent;
+}
+
 int updateAmcFw() {
     xpum::setPercentCallbackAndContext(percent_callback, nullptr);
+    xpum::setCardPercentCallback(card_percent_callback);
 
     int rc = xpum::cmd_firmware(filePath.c_str(), nullptr);
 
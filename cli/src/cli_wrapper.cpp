@@ -17,6 +17,7 @@
 #include "help_formatter.h"
 #include "exit_code.h"
 #include "comlet_dump.h"
+#include "comlet_top.h"
 #include "comlet_statistics.h"
 #include "comlet_diagnostic.h"
 #include "comlet_discovery.h"
@@ -144,6 +145,8 @@ int CLIWrapper::printResult(std::ostream &out) {
                     if(isNumber(stats_comlet->getDeviceId())){
                         setenv("XPUM_ENABLED_GPU_IDS", stats_comlet->getDeviceId().c_str(), 1);
                     }
+                    // statistics of a device need neither the card groups nor the policy timer
+                    setenv("_XPUM_INIT_SKIP", "FIRMWARE,TOPOLOGY,POLICY", 1);
                 }
             }
             if (comlet->getCommand().compare("dump") == 0) {
@@ -152,6 +155,7 @@ int CLIWrapper::printResult(std::ostream &out) {
 
                 std::string env = dump_comlet->getEnv();
                 setenv("XPUM_METRICS", env.c_str(), 1);
+                setenv("_XPUM_INIT_SKIP", "FIRMWARE,TOPOLOGY,POLICY", 1);
 
                 if(env.find("37") == std::string::npos){
                     auto deviceIds = dump_comlet->getDeviceIds();
@@ -176,7 +180,25 @@ int CLIWrapper::printResult(std::ostream &out) {
                     }
                 }
             }
-            if (comlet->getCommand().compare("dump") == 0 && std::dynamic_pointer_cast<ComletDump>(comlet)->dumpIdlePowerOnly()) {
+            if (comlet->getCommand().compare("top") == 0) {
+                // the view follows the samples of the monitor
+                putenv(const_cast<char *>("XPUM_DISABLE_PERIODIC_METRIC_MONITOR=0"));
+                setenv("XPUM_METRICS", "0,4-19,29-31,36,38-39", 1);
+                setenv("_XPUM_INIT_SKIP", "FIRMWARE,TOPOLOGY,POLICY", 1);
+                std::shared_ptr<ComletTop> top_comlet = std::dynamic_pointer_cast<ComletTop>(comlet);
+                std::string ids;
+                for (auto id : top_comlet->getDeviceIds()) {
+                    if (!isValidDeviceId(id)) {
+                        ids.clear();
+                        break;
+                    }
+                    ids += (ids.empty() ? "" : ",") + id;
+                }
+                if (!ids.empty()) {
+                    setenv("XPUM_ENABLED_GPU_IDS", ids.c_str(), 1);
+                }
+            }
+            if (comlet->getCommand().compare("dump") == 0 && std::dynamic_pointer_cast<ComletDump>(comlet)->dumpFromSysfsOnly()) {
                 this->coreStub = std::make_shared<LibCoreStub>(false);
             } else if (comlet->getCommand().compare("diag") == 0 && std::dynamic_pointer_cast<ComletDiagnostic>(comlet)->isPreCheck()) {
                 this->coreStub = std::make_shared<LibCoreStub>(false);  
@@ -6,7 +6,9 @@
 
 #include "comlet_agentset.h"
 
+#include <iomanip>
 #include <nlohmann/json.hpp>
+#include <sstream>
 
 #include "cli_table.h"
 #include "core_stub.h"
@@ -39,13 +41,19 @@ void ComletAgentSet::setupOptions() {
     auto samplingIntervalOpt = addOption("-t,--time", this->opts->samplingInterval, "Set the time interval (in milliseconds) by which XPU Manager daemon retrieve raw gpu statistics. Valid values include 100,200,500,1000.");
     samplingIntervalOpt->check(CLI::IsMember({100, 200, 500, 1000}));
 
+    auto selfStatsOpt = addFlag("--self-stats", this->opts->selfStats, "Display the latency statistics of XPU Manager itself: Level Zero calls and their handle locks, tick lateness, per device collection time, data storing time and collection errors of the monitor tasks, and the estimated memory of the telemetry caches");
+
     listOpt->excludes(samplingIntervalOpt);
+    selfStatsOpt->excludes(listOpt);
+    selfStatsOpt->excludes(samplingIntervalOpt);
 }
 
 std::unique_ptr<nlohmann::json> ComletAgentSet::run() {
     std::unique_ptr<nlohmann::json> json;
     if (this->opts->list) {
         return this->coreStub->getAgentConfig();
+    } else if (this->opts->selfStats) {
+        return this->coreStub->getInternalStats();
     } else if (this->opts->samplingInterval != -1) {
         int64_t sampling_interval = this->opts->samplingInterval;
         return this->coreStub->setAgentConfig("sampling_interval", &sampling_interval);
@@ -56,6 +64,71 @@ std::unique_ptr<nlohmann::json> ComletAgentSet::run() {
     }
 }
 
+static std::string toMicroseconds(uint64_t ns) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << ns / 1000.0;
+    return ss.str();
+}
+
+static void showSelfStats(std::ostream &out, const nlohmann::json &json) {
+    out << std::left << std::setfill(' ')
+        << std::setw(24) << "Type"
+        << std::setw(48) << "Name"
+        << std::setw(8) << "Device"
+        << std::setw(12) << "Count"
+        << std::setw(8) << "Errors"
+        << std::setw(12) << "Avg (us)"
+        << std::setw(12) << "P50 (us)"
+        << std::setw(12) << "P90 (us)"
+        << std::setw(12) << "P99 (us)"
+        << std::setw(12) << "Max (us)"
+        << std::endl;
+    bool has_memory = false;
+    for (auto &stats : json["internal_stats_list"]) {
+        if (stats["type"].get<std::string>() == "memory") {
+            has_memory = true;
+            continue;
+        }
+        int deviceId = stats["device_id"].get<int>();
+        uint64_t count = stats["count"].get<uint64_t>();
+        out << std::left << std::setfill(' ')
+            << std::setw(24) << stats["type"].get<std::string>()
+            << std::setw(48) << stats["name"].get<std::string>()
+            << std::setw(8) << (deviceId < 0 ? std::string("-") : std::to_string(deviceId))
+            << std::setw(12) << count
+            << std::setw(8) << stats["error_count"].get<uint64_t>()
+            << std::setw(12) << toMicroseconds(count > 0 ? stats["sum_ns"].get<uint64_t>() / count : 0)
+            << std::setw(12) << toMicroseconds(stats["p50_ns"].get<uint64_t>())
+            << std::setw(12) << toMicroseconds(stats["p90_ns"].get<uint64_t>())
+            << std::setw(12) << toMicroseconds(stats["p99_ns"].get<uint64_t>())
+            << std::setw(12) << toMicroseconds(stats["max_ns"].get<uint64_t>())
+            << std::endl;
+    }
+    if (!has_memory) {
+        return;
+    }
+
+    // the estimated memory of the telemetry caches, the sum is the current bytes and the max the peak bytes
+    out << std::endl
+        << std::left << std::setfill(' ')
+        << std::setw(48) << "Cache"
+        << std::setw(12) << "Entries"
+        << std::setw(16) << "Bytes"
+        << std::setw(16) << "Peak bytes"
+        << std::endl;
+    for (auto &stats : json["internal_stats_list"]) {
+        if (stats["type"].get<std::string>() != "memory") {
+            continue;
+        }
+        out << std::left << std::setfill(' ')
+            << std::setw(48) << stats["name"].get<std::string>()
+            << std::setw(12) << stats["count"].get<uint64_t>()
+            << std::setw(16) << stats["sum_ns"].get<uint64_t>()
+            << std::setw(16) << stats["max_ns"].get<uint64_t>()
+            << std::endl;
+    }
+}
+
 static void showResult(std::ostream &out, std::shared_ptr<nlohmann::json> json) {
     CharTable table(ComletConfigAgentSetting, *json);
     table.show(out);
@@ -68,6 +141,10 @@ void ComletAgentSet::getTableResult(std::ostream &out) {
         setExitCodeByJson(*res);
         return;
     }
+    if (this->opts->selfStats) {
+        showSelfStats(out, *res);
+        return;
+    }
     std::shared_ptr<nlohmann::json> json = std::make_shared<nlohmann::json>();
     *json = *res;
 
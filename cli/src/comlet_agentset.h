@@ -12,6 +12,7 @@ namespace xpum::cli {
 
 struct ComletAgentSetOptions {
     bool list;
+    bool selfStats = false;
     int samplingInterval = -1;
 };
 
@@ -12,7 +12,9 @@
 #include "core_stub.h"
 #include "utility.h"
 #include "exit_code.h"
+#include <iomanip>
 #include <set>
+#include <sstream>
 #include <unordered_map>
 
 
@@ -221,6 +223,13 @@ It also applies to diag level tests.";
     singleTestIdList->delimiter(',');
     singleTestIdList->check(CLI::Range(1, (int)testIdToType.size()));
 
+    auto samplingCostFlag = addFlag("--sampling-cost", this->opts->samplingCost, "Measure the latency and the CPU cost of sampling each metric of the GPU(s) on this machine,\n\
+the handle lock wait and the driver time of the samples, and recommend the sampling intervals for a target overhead");
+    auto iterationsOpt = addOption("--iterations", this->opts->samplingIterations, "The samples to read of each metric for the sampling cost, 1 to 1000, default 20");
+    iterationsOpt->check(CLI::Range(1, 1000));
+    auto targetOverheadOpt = addOption("--target-overhead", this->opts->targetOverhead, "The CPU time the sampling may take for the recommended intervals, in percent of one core, default 1");
+    targetOverheadOpt->check(CLI::Range(0.01, 100.0));
+
     preCheckOpt->excludes(deviceIdOpt);
     preCheckOpt->excludes(level);
     preCheckOpt->excludes(stressFlag);
@@ -237,12 +246,20 @@ It also applies to diag level tests.";
 
     onlyGPUOpt->needs(preCheckOpt);
 
+    samplingCostFlag->excludes(level);
+    samplingCostFlag->excludes(singleTestIdList);
+    samplingCostFlag->excludes(preCheckOpt);
+    samplingCostFlag->excludes(stressFlag);
+    iterationsOpt->needs(samplingCostFlag);
+    targetOverheadOpt->needs(samplingCostFlag);
+
     listErrorTypeOpt->needs(preCheckOpt);
 #ifndef DAEMONLESS
     preCheckOpt->excludes(groupIdOpt);
     groupIdOpt->excludes(preCheckOpt);
     groupIdOpt->excludes(stressFlag);
     groupIdOpt->excludes(stressTimeOpt);
+    groupIdOpt->excludes(samplingCostFlag);
     stressFlag->needs(stressTimeOpt);
 #endif
 }
@@ -307,6 +324,10 @@ std::unique_ptr<nlohmann::json> ComletDiagnostic::run() {
         return ret;
     }
 
+    if (this->opts->samplingCost) {
+        return this->coreStub->getSamplingCost(deviceId, this->opts->samplingIterations, this->opts->targetOverhead);
+    }
+
     if (this->opts->level >= 1 && this->opts->level <= 3) {
 #ifndef DAEMONLESS
         if (this->opts->groupId > 0 && this->opts->groupId != UINT_MAX) {
@@ -403,6 +424,47 @@ static void showDeviceDiagnostic(std::ostream &out, std::shared_ptr<nlohmann::js
     }
 }
 
+static std::string toMicroseconds(uint64_t ns) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << ns / 1000.0;
+    return ss.str();
+}
+
+static void showSamplingCost(std::ostream &out, const nlohmann::json &json) {
+    out << std::left << std::setfill(' ')
+        << std::setw(8) << "Device"
+        << std::setw(48) << "Metric"
+        << std::setw(9) << "Samples"
+        << std::setw(8) << "Errors"
+        << std::setw(12) << "Avg (us)"
+        << std::setw(12) << "Max (us)"
+        << std::setw(12) << "CPU (us)"
+        << std::setw(12) << "Lock (us)"
+        << std::setw(12) << "Driver (us)"
+        << std::setw(10) << "ZE calls"
+        << std::setw(14) << "Interval (ms)"
+        << std::setw(16) << "Recommended (ms)"
+        << std::endl;
+    for (auto &cost : json["sampling_cost_list"]) {
+        out << std::left << std::setfill(' ')
+            << std::setw(8) << cost["device_id"].get<int>()
+            << std::setw(48) << cost["name"].get<std::string>()
+            << std::setw(9) << cost["samples"].get<uint32_t>()
+            << std::setw(8) << cost["error_count"].get<uint32_t>()
+            << std::setw(12) << toMicroseconds(cost["latency_ns"].get<uint64_t>())
+            << std::setw(12) << toMicroseconds(cost["max_latency_ns"].get<uint64_t>())
+            << std::setw(12) << toMicroseconds(cost["cpu_time_ns"].get<uint64_t>())
+            << std::setw(12) << toMicroseconds(cost["lock_wait_ns"].get<uint64_t>())
+            << std::setw(12) << toMicroseconds(cost["driver_time_ns"].get<uint64_t>())
+            << std::setw(10) << cost["driver_calls"].get<uint32_t>()
+            << std::setw(14) << cost["current_interval_ms"].get<uint32_t>()
+            << std::setw(16) << cost["recommended_interval_ms"].get<uint32_t>()
+            << std::endl;
+    }
+    out << std::endl << "The recommended intervals keep the sampling of all the devices within "
+        << json["target_overhead"].get<double>() << "% of one CPU core." << std::endl;
+}
+
 void ComletDiagnostic::getTableResult(std::ostream &out) {
     this->opts->rawJson = false;
     auto res = run();
@@ -415,6 +477,11 @@ void ComletDiagnostic::getTableResult(std::ostream &out) {
     std::shared_ptr<nlohmann::json> json = std::make_shared<nlohmann::json>();
     *json = *res;
 
+    if (this->opts->samplingCost) {
+        showSamplingCost(out, *json);
+        return;
+    }
+
 #ifndef DAEMONLESS
     if (isGroupOperation()) {
         auto devices = (*json)["device_list"].get<std::vector<nlohmann::json>>();
@@ -29,6 +29,9 @@ struct ComletDiagnosticOptions {
     uint32_t stressTime = 0;
     bool stress = false;
     std::string sinceTime;
+    bool samplingCost = false;
+    uint32_t samplingIterations = 20;
+    double targetOverhead = 1.0;
 };
 
 enum ShowMode {
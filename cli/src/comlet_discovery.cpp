@@ -6,8 +6,10 @@
 
 #include "comlet_discovery.h"
 
+#include <algorithm>
 #include <regex>
 #include <map>
+#include <sstream>
 #include <stack>
 #include <nlohmann/json.hpp>
 
@@ -318,14 +320,8 @@ std::unique_ptr<nlohmann::json> ComletDiscovery::run() {
 
     if (this->opts->propIdList.size() > 0) {
         auto json = std::make_unique<nlohmann::json>();
-        auto deviceListJson = this->coreStub->getDeviceList();
-        auto deviceList = (*deviceListJson)["device_list"];
-        nlohmann::json deviceJsonList;
-        for (auto& device : deviceList) {
-            auto deviceDetailedJson = this->coreStub->getDeviceProperties(device["device_id"], this->opts->username, this->opts->password);
-            auto deviceJson = nlohmann::json::parse(deviceDetailedJson->dump());
-            deviceJsonList.push_back(deviceJson);
-        }
+        auto allJson = this->coreStub->getAllDeviceProperties();
+        nlohmann::json deviceJsonList = allJson->value("device_list", nlohmann::json::array());
         checkBadDevices(deviceJsonList);
         (*json)["device_list"] = deviceJsonList;
         return json;
@@ -414,72 +410,84 @@ static void dumpAllDeviceInfo(std::ostream &out, std::shared_ptr<nlohmann::json>
             propIdList.push_back(conf.dumpId);
         }
     }
-                                
-    for (size_t i = 0; i < propIdList.size(); ++i) {
-        auto prop = getDumpPropConfig(propIdList[i]);
-        assert(prop != nullptr);
-        if (prop == nullptr) {
+
+    // the configs are resolved once, not for each cell
+    std::vector<const dump_prop_config*> props;
+    for (auto propId : propIdList) {
+        auto it = std::find_if(dumpFieldConfig.begin(), dumpFieldConfig.end(),
+                               [propId](const dump_prop_config& conf) { return conf.dumpId == propId; });
+        assert(it != dumpFieldConfig.end());
+        if (it == dumpFieldConfig.end()) {
             return ;
         }
+        props.push_back(&(*it));
+    }
+
+    // the rows are written to out at once
+    std::ostringstream rows;
+    for (size_t i = 0; i < props.size(); ++i) {
         if (i > 0) {
-            out << ",";
+            rows << ",";
         }
-        out << prop->label;
+        rows << props[i]->label;
     }
-    out << std::endl;
-
-    auto devices = (*json)["device_list"];
-    for (auto device : devices) {
-        for (size_t i = 0; i < propIdList.size(); ++i) {
-            auto prop = getDumpPropConfig(propIdList[i]);
-            if (prop == nullptr) {
-                return ;
-            }
+    rows << "\n";
+
+    auto devices = json->find("device_list");
+    if (devices == json->end()) {
+        out << rows.str() << std::flush;
+        return;
+    }
+    for (auto& device : *devices) {
+        for (size_t i = 0; i < props.size(); ++i) {
+            auto prop = props[i];
             if (i > 0) {
-                out << ",";
+                rows << ",";
             }
 
-            auto value = device[prop->value];
-            if (value == nullptr) {
+            auto it = device.find(prop->value);
+            if (it == device.end() || it->is_null()) {
                 // No need to fill "" for the Device ID (number) column
                 if (prop->dumpId == 1) {
-                    out << "N/A";
+                    rows << "N/A";
                 } else {
-                    out << "\"N/A\"";
+                    rows << "\"N/A\"";
                 }
             } else {
+                auto& value = *it;
                 if (prop->scale > 0) {
                     if (prop->suffix != "") {
-                       out << "\"";
+                       rows << "\"";
                     }
                     if (value.is_number()) {
-                       out << scale_double_value(
-                               std::to_string(static_cast<double>(value)),
+                       rows << scale_double_value(
+                               std::to_string(value.get<double>()),
                                                  prop->scale);
                     } else if (value.is_string()) {
-                        out << scale_double_value(value, prop->scale);
+                        rows << scale_double_value(value.get_ref<const std::string&>(), prop->scale);
                     } else {
-                        out << value;
+                        rows << value;
                     }
                     if (prop->suffix != "") {
-                       out << prop->suffix << "\"";
+                       rows << prop->suffix << "\"";
                     }
                     continue;
                 } else if (value.is_string() && prop->suffix != "") {
-                    out << "\"" << (std::string(device[prop->value]) + 
-                            prop->suffix) << "\"";
+                    rows << "\"" << value.get_ref<const std::string&>() <<
+                            prop->suffix << "\"";
                     continue;
                 } else {
-                    out << device[prop->value];
+                    rows << value;
                 }
 
                 if (prop->suffix != "") {
-                    out << prop->suffix;
+                    rows << prop->suffix;
                 }
             }
-       }
-        out << std::endl;
+        }
+        rows << "\n";
     }
+    out << rows.str() << std::flush;
 }
 
 static void showAmcFwVersion(std::ostream &out, std::shared_ptr<nlohmann::json> json) {
@@ -502,8 +510,7 @@ void ComletDiscovery::getTableResult(std::ostream &out) {
         setExitCodeByJson(*res);
         return;
     }
-    std::shared_ptr<nlohmann::json> json = std::make_shared<nlohmann::json>();
-    *json = *res;
+    std::shared_ptr<nlohmann::json> json = std::make_shared<nlohmann::json>(std::move(*res));
 
     if (this->opts->listamcversions) {
         showAmcFwVersion(out, json);
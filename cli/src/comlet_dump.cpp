@@ -11,6 +11,7 @@
 #include <sstream>
 #include <algorithm>
 #include <chrono>
+#include <limits>
 
 #include "core_stub.h"
 #include "pretty_table.h"
@@ -138,11 +139,32 @@ std::string ComletDump::getEnv(){
     return env;
 }
 
-// For PVC idle power
+// For the dump of PVC without initializing Level Zero, e.g. in containers without sysman
 static std::map<int, std::string> gpu_id_to_bdfs;
 static std::map<std::string, int> gpu_bdf_to_ids;
 static std::map<std::string, int> gpu_bdf_to_tile_num;
-bool ComletDump::dumpIdlePowerOnly() { 
+
+// the metrics xpumGetMetricsFromSysfs reads from sysfs and hwmon
+static const std::set<int> sysfsDumpTypes{XPUM_DUMP_POWER,
+                                          XPUM_DUMP_ENERGY,
+                                          XPUM_DUMP_GPU_FREQUENCY,
+                                          XPUM_DUMP_GPU_CORE_TEMPERATURE,
+                                          XPUM_DUMP_MEMORY_TEMPERATURE,
+                                          XPUM_DUMP_MEMORY_USED};
+
+bool ComletDump::isSysfsMetricsOnly() {
+    if (this->opts->metricsIdList.empty()) {
+        return false;
+    }
+    for (auto metric : this->opts->metricsIdList) {
+        if (sysfsDumpTypes.count(metric) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ComletDump::dumpFromSysfsOnly() {
     std::set<std::string> gpu_bdfs;
     DIR *pdir = NULL;
     struct dirent *pdirent = NULL;
@@ -188,9 +210,7 @@ bool ComletDump::dumpIdlePowerOnly() {
         gpu_bdf_to_ids[gpu_bdf] = id;
         id++;
     }
-    if (this->opts->metricsIdList.size() == 1 && this->opts->metricsIdList[0] == XPUM_DUMP_POWER)
-        return true;
-    return false;
+    return isSysfsMetricsOnly();
 }
 
 void ComletDump::setupOptions() {
@@ -319,10 +339,71 @@ void ComletDump::setupOptions() {
     listDumpFlag->excludes(metricsListOpt);
     listDumpFlag->excludes(timeIntervalOpt);
     listDumpFlag->excludes(dumpTimesOpt);
+
+    auto dumpFormatOpt = addOption("--format", this->opts->dumpFormat, "Format of the raw data dump file, csv, binary or trace. trace writes Chrome trace event JSON for Perfetto or chrome://tracing. The default is csv.");
+    dumpFormatOpt->check(CLI::IsMember({"csv", "binary", "trace"}));
+    dumpFormatOpt->needs(startDumpFlag);
+    auto dumpLayoutOpt = addOption("--layout", this->opts->dumpLayout, "Layout of the raw data dump file for multiple devices. long: one row per device per sample; wide: one row per sample with the columns of all the devices. The default is long.");
+    dumpLayoutOpt->check(CLI::IsMember({"long", "wide"}));
+    dumpLayoutOpt->needs(startDumpFlag);
+    auto rotateSizeOpt = addOption("--rotate-size", this->opts->rotateSize, "Start a new raw data dump file before the current one exceeds this many MB, counted before compression. The files after the first one get the index before the extension.");
+    rotateSizeOpt->check(CLI::Range((uint64_t)1, (uint64_t)1024 * 1024));
+    rotateSizeOpt->needs(startDumpFlag);
+    auto rotateIntervalOpt = addOption("--rotate-interval", this->opts->rotateInterval, "Start a new raw data dump file when the current one is this many seconds old.");
+    rotateIntervalOpt->check(CLI::Range((uint32_t)1, std::numeric_limits<uint32_t>::max()));
+    rotateIntervalOpt->needs(startDumpFlag);
+    auto maxFilesOpt = addOption("--max-files", this->opts->maxFiles, "Remove the oldest raw data dump files of the task beyond this count. All the files are kept by default.");
+    maxFilesOpt->check(CLI::Range((uint32_t)1, std::numeric_limits<uint32_t>::max()));
+    maxFilesOpt->needs(startDumpFlag);
+    auto compressFlag = addFlag("--compress", this->opts->compress, "Compress the raw data dump files with zstd, the files get the suffix .zst.");
+    compressFlag->needs(startDumpFlag);
+    auto triggeredFlag = addFlag("--triggered", this->opts->triggered, "Keep the latest raw data in memory and write it to the dump file only when a policy of a dumped device is triggered, with the data of --pre-trigger seconds before and --post-trigger seconds after the trigger.");
+    triggeredFlag->needs(startDumpFlag);
+    auto preTriggerOpt = addOption("--pre-trigger", this->opts->preTriggerTime, "Seconds of raw data kept in memory and written out before the trigger of a triggered dump. The default is 60.");
+    preTriggerOpt->check(CLI::Range((uint32_t)1, (uint32_t)3600));
+    preTriggerOpt->needs(triggeredFlag);
+    auto postTriggerOpt = addOption("--post-trigger", this->opts->postTriggerTime, "Seconds of raw data written out after the trigger of a triggered dump, a trigger during them extends the capture. The default is 60.");
+    postTriggerOpt->check(CLI::Range((uint32_t)0, (uint32_t)86400));
+    postTriggerOpt->needs(triggeredFlag);
+    auto triggersOpt = addOption("--triggers", this->opts->triggers, "The triggers of a triggered dump, separated by the comma. The policy types temperature, memory_temperature, power, ras, missing, throttle and precheck, health for a health status turning critical and diagnostic for failed diagnostics. All of them trigger it by default.");
+    triggersOpt->delimiter(',');
+    triggersOpt->check(CLI::IsMember({"temperature", "memory_temperature", "power", "ras", "missing", "throttle", "precheck", "health", "diagnostic"}));
+    triggersOpt->needs(triggeredFlag);
 #endif
     addFlag("--date", this->opts->showDate, "Show date in timestamp.");
 }
 
+static uint32_t getTriggerMask(const std::vector<std::string>& triggers) {
+    static const std::map<std::string, std::vector<xpum_policy_type_t>> policyTypes = {
+        {"temperature", {XPUM_POLICY_TYPE_GPU_TEMPERATURE}},
+        {"memory_temperature", {XPUM_POLICY_TYPE_GPU_MEMORY_TEMPERATURE}},
+        {"power", {XPUM_POLICY_TYPE_GPU_POWER}},
+        {"ras", {XPUM_POLICY_TYPE_RAS_ERROR_CAT_RESET, XPUM_POLICY_TYPE_RAS_ERROR_CAT_PROGRAMMING_ERRORS, XPUM_POLICY_TYPE_RAS_ERROR_CAT_DRIVER_ERRORS,
+                 XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE, XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE}},
+        {"missing", {XPUM_POLICY_TYPE_GPU_MISSING}},
+        {"throttle", {XPUM_POLICY_TYPE_GPU_THROTTLE}},
+        {"precheck", {XPUM_POLICY_TYPE_PRECHECK_ERROR}},
+    };
+    uint32_t mask = 0;
+    for (auto& trigger : triggers) {
+        if (trigger == "health") {
+            mask |= XPUM_DUMP_TRIGGER_HEALTH;
+            continue;
+        }
+        if (trigger == "diagnostic") {
+            mask |= XPUM_DUMP_TRIGGER_DIAGNOSTIC;
+            continue;
+        }
+        auto it = policyTypes.find(trigger);
+        if (it != policyTypes.end()) {
+            for (auto type : it->second) {
+                mask |= 1U << type;
+            }
+        }
+    }
+    return mask;
+}
+
 std::unique_ptr<nlohmann::json> ComletDump::run() {
     std::unique_ptr<nlohmann::json> json;
 
@@ -357,21 +438,49 @@ std::unique_ptr<nlohmann::json> ComletDump::run() {
 
     if (this->opts->rawData) {
         if (this->opts->startDumpTask && !this->opts->deviceIds.empty()) {
-            if (this->opts->deviceIds.size() > 1) {
-                json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
-                (*json)["error"] = "Dumping to file is not supported for multiple devices";
-            } if(this->opts->deviceTileIds.size() > 1){
+            std::vector<xpum_dump_type_t> dumpTypeList;
+            for (auto i : this->opts->metricsIdList) {
+                auto &m = dumpTypeOptions[i];
+                dumpTypeList.push_back(m.dumpType);
+            }
+            xpum_dump_raw_data_option_t option{};
+            option.showDate = this->opts->showDate;
+            option.format = XPUM_DUMP_FORMAT_CSV;
+            if (this->opts->dumpFormat == "binary") {
+                option.format = XPUM_DUMP_FORMAT_BINARY;
+            } else if (this->opts->dumpFormat == "trace") {
+                option.format = XPUM_DUMP_FORMAT_TRACE;
+            }
+            option.layout = this->opts->dumpLayout == "wide" ? XPUM_DUMP_LAYOUT_WIDE : XPUM_DUMP_LAYOUT_LONG;
+            option.rotateSize = this->opts->rotateSize * 1024 * 1024;
+            option.rotateInterval = this->opts->rotateInterval;
+            option.maxFiles = this->opts->maxFiles;
+            option.compress = this->opts->compress;
+            option.triggered = this->opts->triggered;
+            option.preTriggerTime = this->opts->preTriggerTime;
+            option.postTriggerTime = this->opts->postTriggerTime;
+            option.triggerMask = getTriggerMask(this->opts->triggers);
+            if(this->opts->deviceTileIds.size() > 1){
                 json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
                 (*json)["error"] = "Dumping to file is not supported for multiple tiles";
-            }else {
+            } else if (this->opts->deviceIds.size() > 1) {
+                if (this->opts->deviceTileIds[0] != "-1") {
+                    json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+                    (*json)["error"] = "Dumping tile data to file is not supported for multiple devices";
+                } else if (std::find_if_not(this->opts->deviceIds.begin(), this->opts->deviceIds.end(), isNumber) != this->opts->deviceIds.end()) {
+                    json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+                    (*json)["error"] = "Device id should be a non-negative integer for dumping multiple devices to file";
+                } else {
+                    std::vector<uint32_t> deviceIdList;
+                    for (auto &id : this->opts->deviceIds) {
+                        deviceIdList.push_back(std::stoi(id));
+                    }
+                    json = this->coreStub->startMultiDeviceDumpRawDataTask(deviceIdList, dumpTypeList, option);
+                }
+            } else {
                 int deviceId = std::stoi(this->opts->deviceIds[0]);
                 int tileId = std::stoi(this->opts->deviceTileIds[0]);
-                std::vector<xpum_dump_type_t> dumpTypeList;
-                for (auto i : this->opts->metricsIdList) {
-                    auto &m = dumpTypeOptions[i];
-                    dumpTypeList.push_back(m.dumpType);
-                }
-                json = this->coreStub->startDumpRawDataTask(deviceId, tileId, dumpTypeList, this->opts->showDate);
+                json = this->coreStub->startDumpRawDataTask(deviceId, tileId, dumpTypeList, option);
             }
         } else if (this->opts->listDumpTask) {
             json = this->coreStub->listDumpRawDataTasks();
@@ -382,24 +491,45 @@ std::unique_ptr<nlohmann::json> ComletDump::run() {
             (*json)["error"] = "Unknow operation";
         }
 #ifdef DAEMONLESS
-    } else if (gpu_id_to_bdfs.size() > 0 && this->opts->metricsIdList.size() == 1 && this->opts->metricsIdList[0] == XPUM_DUMP_POWER) {
+    } else if (gpu_id_to_bdfs.size() > 0 && isSysfsMetricsOnly()) {
         json = getMetricsFromSysfs();
 #endif
     } else {
-        json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+        // the statistics of all the devices from the same samples in one call, the BDFs are resolved once
+        std::vector<int> targetIds;
         for (auto deviceId : this->opts->deviceIds) {
-            int targetId = -1;
-            if (isNumber(deviceId)) {
-                targetId = std::stoi(deviceId);
-            } else {
-                auto convertResult = this->coreStub->getDeivceIdByBDF(deviceId.c_str(), &targetId);
-                if (convertResult->contains("error")) {
-                    return convertResult;
+            auto it = targetIdMap.find(deviceId);
+            if (it == targetIdMap.end()) {
+                int targetId = -1;
+                if (isNumber(deviceId)) {
+                    targetId = std::stoi(deviceId);
+                } else {
+                    auto convertResult = this->coreStub->getDeivceIdByBDF(deviceId.c_str(), &targetId);
+                    if (convertResult->contains("error")) {
+                        return convertResult;
+                    }
                 }
+                it = targetIdMap.emplace(deviceId, targetId).first;
             }
-            auto tempdeviceJsons = this->coreStub->getStatistics(targetId);
-            deviceJsons[deviceId] = combineTileAndDeviceLevel(*tempdeviceJsons);
+            targetIds.push_back(it->second);
         }
+        json = this->coreStub->getStatisticsBulk(targetIds);
+        if (json->contains("error")) {
+            return json;
+        }
+        std::map<int, const nlohmann::json*> datas;
+        for (auto& data : (*json)["datas"]) {
+            datas[data["device_id"].get<int>()] = &data;
+        }
+        for (auto deviceId : this->opts->deviceIds) {
+            auto it = datas.find(targetIdMap[deviceId]);
+            if (it != datas.end()) {
+                deviceJsons[deviceId] = combineTileAndDeviceLevel(*it->second);
+            } else {
+                deviceJsons[deviceId] = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+            }
+        }
+        json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
     }
     return json;
 }
@@ -472,7 +602,9 @@ std::unique_ptr<nlohmann::json> ComletDump::combineTileAndDeviceLevel(nlohmann::
 
 void ComletDump::getJsonResult(std::ostream &out, bool raw) {
     if (!this->opts->rawData) {
-        out << "Not supported" << std::endl;
+        // the rows as newline delimited JSON, one object per device, tile and sample
+        jsonRows = true;
+        getTableResult(out);
         return;
     } else {
         ComletBase::getJsonResult(out, raw);
@@ -540,7 +672,7 @@ void ComletDump::getTableResult(std::ostream &out) {
             printByLine(dumpFile);
             dumpFile.close();
             std::cout << "Dumping is stopped." << std::endl;
-        } else if (gpu_id_to_bdfs.size() > 0 && this->opts->metricsIdList.size() == 1 && this->opts->metricsIdList[0] == XPUM_DUMP_POWER) {
+        } else if (gpu_id_to_bdfs.size() > 0 && isSysfsMetricsOnly()) {
             printByLineWithoutInitializeCore(out);
         } else {
             printByLine(out);
@@ -572,7 +704,7 @@ std::string keepTwoDecimalPrecision(double value) {
     return os.str();
 }
 
-std::string getJsonValue(nlohmann::json obj, int scale) {
+std::string getJsonValue(const nlohmann::json& obj, int scale) {
     if (obj.is_null()) {
         return "";
     }
@@ -590,6 +722,164 @@ std::string getJsonValue(nlohmann::json obj, int scale) {
     }
 }
 
+// the value shown for an engine or a Xe Link, the average of the interval with the daemon
+static const nlohmann::json* findShownValue(const nlohmann::json& obj) {
+#ifndef DAEMONLESS
+    auto it = obj.find("avg");
+#else
+    auto it = obj.find("value");
+#endif
+    return it == obj.end() ? nullptr : &(*it);
+}
+
+static void indexEngines(const std::string& engineType, const nlohmann::json& engines, int tileIdx, DumpRow& row) {
+    if (!engines.is_array()) {
+        return;
+    }
+    for (auto& u : engines) {
+        auto id = u.find("engine_id");
+        auto value = findShownValue(u);
+        if (id != u.end() && value != nullptr) {
+            row.engines.emplace(std::make_tuple(tileIdx, engineType, id->get<int>()), value);
+        }
+    }
+}
+
+// engine_util has the engines of the row by type, and those of each tile under "tile_id_<n>"
+static void indexEngineUtil(const nlohmann::json& engineUtil, DumpRow& row) {
+    static const std::string tilePrefix = "tile_id_";
+    for (auto& item : engineUtil.items()) {
+        if (item.key().compare(0, tilePrefix.size(), tilePrefix) != 0) {
+            indexEngines(item.key(), item.value(), -1, row);
+            continue;
+        }
+        if (!item.value().is_object()) {
+            continue;
+        }
+        int tileIdx = std::stoi(item.key().substr(tilePrefix.size()));
+        for (auto& engines : item.value().items()) {
+            indexEngines(engines.key(), engines.value(), tileIdx, row);
+        }
+    }
+}
+
+// index the statistics of the device, or of its tile tileId, for the columns of one row
+static void indexDumpRow(const nlohmann::json& deviceJson, const std::string& tileId, DumpRow& row) {
+    row.clear();
+    const nlohmann::json* statsList = nullptr;
+    const nlohmann::json* engineUtil = nullptr;
+    if (tileId == "-1") {
+        auto it = deviceJson.find("device_level");
+        if (it != deviceJson.end()) {
+            statsList = &(*it);
+        }
+        it = deviceJson.find("engine_util");
+        if (it != deviceJson.end()) {
+            engineUtil = &(*it);
+        }
+    } else {
+        auto tiles = deviceJson.find("tile_level");
+        if (tiles != deviceJson.end() && tiles->is_array()) {
+            int tileIdx = std::stoi(tileId);
+            for (auto& tile : *tiles) {
+                auto id = tile.find("tile_id");
+                auto dataList = tile.find("data_list");
+                if (id != tile.end() && id->get<int>() == tileIdx && dataList != tile.end()) {
+                    statsList = &(*dataList);
+                    auto it = tile.find("engine_util");
+                    if (it != tile.end()) {
+                        engineUtil = &(*it);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+    if (statsList != nullptr && statsList->is_array()) {
+        for (auto& metricObj : *statsList) {
+            auto type = metricObj.find("metrics_type");
+            if (type != metricObj.end() && type->is_string()) {
+                row.stats.emplace(type->get<std::string>(), &metricObj);
+            }
+        }
+    }
+    if (engineUtil != nullptr && engineUtil->is_object()) {
+        indexEngineUtil(*engineUtil, row);
+    }
+    auto fabric = deviceJson.find("fabric_throughput");
+    if (fabric != deviceJson.end() && fabric->is_array()) {
+        for (auto& tp : *fabric) {
+            auto name = tp.find("name");
+            auto value = findShownValue(tp);
+            if (name != tp.end() && name->is_string() && value != nullptr) {
+                row.fabric.emplace(name->get<std::string>(), value);
+            }
+        }
+    }
+}
+
+// one row of the columns, the rows of a sampling tick are written to the output together
+static const nlohmann::json* findDeviceProperties(const nlohmann::json& allProps, int deviceId) {
+    for (auto& device : allProps["device_list"]) {
+        if (device["device_id"].get<int>() == deviceId)
+            return &device;
+    }
+    return nullptr;
+}
+
+static void appendDumpRow(std::string& buf, std::vector<DumpColumn>& columnSchemaList) {
+    for (std::size_t i = 0; i < columnSchemaList.size(); i++) {
+        auto value = columnSchemaList[i].getValue();
+        if (value.empty())
+            value = "N/A";
+        if (value.size() < 4) {
+            buf.append(4 - value.size(), ' ');
+        }
+        buf += value;
+        if (i < columnSchemaList.size() - 1) {
+            buf += ", ";
+        }
+    }
+    buf += '\n';
+}
+
+// one row as a JSON object on one line, keyed by the column headers
+static void appendDumpJsonRow(std::string& buf, std::vector<DumpColumn>& columnSchemaList) {
+    nlohmann::json row = nlohmann::json::object();
+    for (auto& column : columnSchemaList) {
+        auto value = column.getValue();
+        if (value.empty()) {
+            row[column.header] = nullptr;
+            continue;
+        }
+        char* end = nullptr;
+        if (value.find_first_of(".eE") == std::string::npos) {
+            long long number = std::strtoll(value.c_str(), &end, 10);
+            if (*end == '\0') {
+                row[column.header] = number;
+                continue;
+            }
+        } else {
+            double number = std::strtod(value.c_str(), &end);
+            if (*end == '\0') {
+                row[column.header] = number;
+                continue;
+            }
+        }
+        row[column.header] = value;
+    }
+    buf += row.dump();
+    buf += '\n';
+}
+
+// the timestamp shared by the rows of all devices of a sampling tick
+static std::string getDumpTimestamp(bool showDate) {
+    struct timespec spec;
+    clock_gettime(CLOCK_REALTIME, &spec);
+    uint64_t ms = (uint64_t)spec.tv_sec * 1000 + spec.tv_nsec / 1000000;
+    return CoreStub::isotimestamp(ms, !showDate);
+}
+
 std::unique_ptr<nlohmann::json> ComletDump::getMetricsFromSysfs() {
     auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
     std::vector<std::string> bdfs;
@@ -691,10 +981,7 @@ void ComletDump::printByLineWithoutInitializeCore(std::ostream &out) {
     // timestamp column
     columnSchemaList.push_back({"Timestamp",
                                 [this]() {
-                                    if (this->opts->showDate)
-                                        return CoreStub::isotimestamp(time(nullptr) * 1000);
-                                    else
-                                        return CoreStub::isotimestamp(time(nullptr) * 1000, true);
+                                    return this->curTimestamp;
                                 }});
 
     // device id column
@@ -719,17 +1006,17 @@ void ComletDump::printByLineWithoutInitializeCore(std::ostream &out) {
             DumpColumn dc{
                 std::string(config.name),
                 [config, this]() {
-                    std::string metricKey = config.key;
-                    if (statsJson != nullptr) {
-                        for (auto metricObj : (*statsJson)) {
-                            if (metricObj["metrics_type"].get<std::string>().compare(metricKey) == 0) {
-                                if (metricObj.contains("avg")) {
-                                    return getJsonValue(metricObj["avg"], config.scale);
-                                } else {
-                                    // counter type
-                                    return getJsonValue(metricObj["value"], config.scale);
-                                }
-                            }
+                    auto it = curRow.stats.find(config.key);
+                    if (it != curRow.stats.end()) {
+                        auto& metricObj = *it->second;
+                        auto avg = metricObj.find("avg");
+                        if (avg != metricObj.end()) {
+                            return getJsonValue(*avg, config.scale);
+                        }
+                        // counter type
+                        auto value = metricObj.find("value");
+                        if (value != metricObj.end()) {
+                            return getJsonValue(*value, config.scale);
                         }
                     }
                     return std::string();
@@ -738,64 +1025,45 @@ void ComletDump::printByLineWithoutInitializeCore(std::ostream &out) {
         }
     }
 
-    // print table header
-    for (std::size_t i = 0; i < columnSchemaList.size(); i++) {
-        auto dc = columnSchemaList[i];
-        out << dc.header;
-        if (i < columnSchemaList.size() - 1) {
-            out << ", ";
+    // print table header, the JSON rows have the headers as keys
+    if (!jsonRows) {
+        for (std::size_t i = 0; i < columnSchemaList.size(); i++) {
+            auto& dc = columnSchemaList[i];
+            out << dc.header;
+            if (i < columnSchemaList.size() - 1) {
+                out << ", ";
+            }
         }
-    }
 
-    out << std::endl;
+        out << std::endl;
+    }
 
     int iter = 0;
 
+    // the reads are a whole interval apart, the time a read takes does not delay the next
+    auto deadline = std::chrono::steady_clock::now();
     while (true) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(this->opts->timeInterval * 900));
+        deadline += std::chrono::seconds(this->opts->timeInterval);
+        std::this_thread::sleep_until(deadline);
         res = run();
         if (res->contains("error")) {
             out << "Error: " << (*res)["error"].get<std::string>() << std::endl;
             return;
         }
-        for (auto deviceId : this->opts->deviceIds) {
+        std::string rows;
+        curTimestamp = getDumpTimestamp(this->opts->showDate);
+        for (auto& deviceId : this->opts->deviceIds) {
             curDeviceId = deviceId;
-            statsJson = nullptr;
-
-            for(auto tileId : this->opts->deviceTileIds){
+            for (auto& tileId : this->opts->deviceTileIds) {
                 curTileId = tileId;
-                if (this->opts->deviceTileIds.size() == 1 && this->opts->deviceTileIds[0] == "-1") {
-                    if (deviceJsons[deviceId]->contains("device_level")) {
-                        statsJson = std::make_shared<nlohmann::json>((*deviceJsons[deviceId])["device_level"]);
-                    }
-                } else {
-                    if (deviceJsons[deviceId]->contains("tile_level")) {
-                        auto tiles = (*deviceJsons[deviceId])["tile_level"].get<std::vector<nlohmann::json>>();
-                        for (auto tile : tiles) {
-                            if (tile.contains("tile_id") && tile["tile_id"].get<int>() == std::stoi(tileId) && tile.contains("data_list")) {
-                                statsJson = std::make_shared<nlohmann::json>(tile["data_list"]);
-                                break;
-                            }
-                        }
-                    }
-                }
-
-                for (std::size_t i = 0; i < columnSchemaList.size(); i++) {
-                    auto dc = columnSchemaList[i];
-                    auto value = dc.getValue();
-                    if (value.empty())
-                        value = "N/A";
-                    if (value.size() < 4) {
-                        out << std::string(4 - value.size(), ' ');
-                    }
-                    out << value;
-                    if (i < columnSchemaList.size() - 1) {
-                        out << ", ";
-                    }
-                }
-                out << std::endl;
+                indexDumpRow(*deviceJsons[deviceId], tileId, curRow);
+                if (jsonRows)
+                    appendDumpJsonRow(rows, columnSchemaList);
+                else
+                    appendDumpRow(rows, columnSchemaList);
             }
         }
+        out << rows << std::flush;
         if (this->opts->dumpTimes != -1 && ++iter >= this->opts->dumpTimes) {
             break;
         }
@@ -816,12 +1084,18 @@ void ComletDump::printByLine(std::ostream &out) {
         return;
     }
 
+    // the properties and the engine and fabric counts of all devices in one call
+    auto allProps = this->coreStub->getAllDeviceProperties();
+    if (allProps->contains("error")) {
+        out << "Error: " << (*allProps)["error"].get<std::string>() << std::endl;
+        setExitCodeByJson(*allProps);
+        return;
+    }
+
     // convert deviceIds if deviceId equals -1
     if(this->opts->deviceIds.size()==1 && this->opts->deviceIds[0]=="-1"){
         std::vector<std::string> deviceIds;
-        auto deviceListJson = this->coreStub->getDeviceList();
-        auto deviceList = (*deviceListJson)["device_list"];
-        for (auto& device : deviceList) {
+        for (auto& device : (*allProps)["device_list"]) {
             int id = device["device_id"];
             deviceIds.push_back(std::to_string(id));
         }
@@ -842,13 +1116,13 @@ void ComletDump::printByLine(std::ostream &out) {
         }
         else
             deviceId = std::stoi(deviceIdStr);
-        auto res = this->coreStub->getDeviceProperties(deviceId);
-        if (res->contains("error")) {
-            out << "Error: " << (*res)["error"].get<std::string>() << std::endl;
+        auto props = findDeviceProperties(*allProps, deviceId);
+        if (props == nullptr) {
+            out << "Error: Device not found" << std::endl;
             return;
         }
         if (!(this->opts->deviceTileIds.size() == 1 && this->opts->deviceTileIds[0] == "-1")) {
-            std::stringstream number_of_tiles((*res)["number_of_tiles"].get<std::string>());
+            std::stringstream number_of_tiles((*props)["number_of_tiles"].get<std::string>());
             int num_tiles = 0;
             number_of_tiles >> num_tiles;
 
@@ -893,11 +1167,15 @@ void ComletDump::printByLine(std::ostream &out) {
                         return;
                     }
                 }
-                auto res = this->coreStub->getDeviceProperties(targetId);
+                auto props = findDeviceProperties(*allProps, targetId);
+                if (props == nullptr) {
+                    out << "Error: Device not found" << std::endl;
+                    return;
+                }
                 if (deviceName.empty()) {
-                    deviceName = (*res)["device_name"].get<std::string>();
+                    deviceName = (*props)["device_name"].get<std::string>();
                 } else {
-                    if (deviceName != (*res)["device_name"].get<std::string>()) {
+                    if (deviceName != (*props)["device_name"].get<std::string>()) {
                         sameDeviceModel = false;
                         break;
                     }
@@ -930,17 +1208,7 @@ void ComletDump::printByLine(std::ostream &out) {
     // timestamp column
     columnSchemaList.push_back({"Timestamp",
                                 [this]() {
-                                    long ms; // Milliseconds
-                                    time_t s;  // Seconds
-                                    struct timespec spec;
-                                    clock_gettime(CLOCK_REALTIME, &spec);
-
-                                    s  = spec.tv_sec;
-                                    ms = spec.tv_nsec / 1000000; // Convert nanoseconds to milliseconds
-                                    if (this->opts->showDate)
-                                        return CoreStub::isotimestamp(s * 1000 + ms);
-                                    else
-                                        return CoreStub::isotimestamp(s * 1000 + ms, true);
+                                    return this->curTimestamp;
                                 }});
 
     // device id column
@@ -965,17 +1233,17 @@ void ComletDump::printByLine(std::ostream &out) {
             DumpColumn dc{
                 std::string(config.name),
                 [config, this]() {
-                    std::string metricKey = config.key;
-                    if (statsJson != nullptr) {
-                        for (auto metricObj : (*statsJson)) {
-                            if (metricObj["metrics_type"].get<std::string>().compare(metricKey) == 0) {
-                                if (metricObj.contains("avg")) {
-                                    return getJsonValue(metricObj["avg"], config.scale);
-                                } else {
-                                    // counter type
-                                    return getJsonValue(metricObj["value"], config.scale);
-                                }
-                            }
+                    auto it = curRow.stats.find(config.key);
+                    if (it != curRow.stats.end()) {
+                        auto& metricObj = *it->second;
+                        auto avg = metricObj.find("avg");
+                        if (avg != metricObj.end()) {
+                            return getJsonValue(*avg, config.scale);
+                        }
+                        // counter type
+                        auto value = metricObj.find("value");
+                        if (value != metricObj.end()) {
+                            return getJsonValue(*value, config.scale);
                         }
                     }
                     return std::string();
@@ -983,7 +1251,10 @@ void ComletDump::printByLine(std::ostream &out) {
             columnSchemaList.push_back(dc);
         } else if (config.optionType == xpum::dump::DUMP_OPTION_ENGINE) {
             auto pEngineCountMap = std::make_shared<std::map<int, std::map<int, int>>>();
-            pEngineCountMap = this->coreStub->getEngineCount(targetId);
+            for (auto& tile : (*allProps)["engine_count"][std::to_string(targetId)].items()) {
+                for (auto& typeCount : tile.value().items())
+                    (*pEngineCountMap)[std::stoi(tile.key())][std::stoi(typeCount.key())] = typeCount.value().get<int>();
+            }
 
             if (res->contains("error")) {
                 out << "Error: " << (*res)["error"].get<std::string>() << std::endl;
@@ -1028,21 +1299,9 @@ void ComletDump::printByLine(std::ostream &out) {
                         DumpColumn dc{
                             header,
                             [config, tileIdx, engineIdx, this]() {
-                                if (engineUtilJson != nullptr) {
-                                    nlohmann::json engineUtilByType;
-                                    if (tileIdx == -1)
-                                        engineUtilByType = (*engineUtilJson)[config.key];
-                                    else
-                                        engineUtilByType = (*engineUtilJson)["tile_id_"+std::to_string(tileIdx)][config.key];
-                                    for (auto u : engineUtilByType) {
-                                        if (u["engine_id"].get<int>() == engineIdx) {
-                                            #ifndef DAEMONLESS
-                                            return getJsonValue(u["avg"], config.scale);
-                                            #else
-                                            return getJsonValue(u["value"], config.scale);
-                                            #endif
-                                        }
-                                    }
+                                auto it = curRow.engines.find(std::make_tuple(tileIdx, std::string(config.key), engineIdx));
+                                if (it != curRow.engines.end()) {
+                                    return getJsonValue(*it->second, config.scale);
                                 }
                                 return std::string();
                             }};
@@ -1064,8 +1323,7 @@ void ComletDump::printByLine(std::ostream &out) {
                 }
             }
         } else if (config.optionType == xpum::dump::DUMP_OPTION_FABRIC) {
-            auto pFabricCountJson = std::shared_ptr<nlohmann::json>();
-            pFabricCountJson = this->coreStub->getFabricCount(targetId);
+            auto pFabricCountJson = std::make_shared<nlohmann::json>((*allProps)["fabric_count"][std::to_string(targetId)]);
 
             if (res->contains("error")) {
                 out << "Error: " << (*res)["error"].get<std::string>() << std::endl;
@@ -1096,16 +1354,9 @@ void ComletDump::printByLine(std::ostream &out) {
                     header = "XL " + key + " (kB/s)";
                     columnSchemaList.push_back({header,
                                                 [config, key, this]() {
-                                                    if (fabricThroughputJson != nullptr) {
-                                                        for (auto tp : (*fabricThroughputJson)) {
-                                                            if (key.compare(tp["name"].get<std::string>())==0) {
-                                                                #ifndef DAEMONLESS
-                                                                return getJsonValue(tp["avg"], config.scale);
-                                                                #else
-                                                                return getJsonValue(tp["value"], config.scale);     
-                                                                #endif
-                                                            }
-                                                        }
+                                                    auto it = curRow.fabric.find(key);
+                                                    if (it != curRow.fabric.end()) {
+                                                        return getJsonValue(*it->second, config.scale);
                                                     }
                                                     return std::string();
                                                 }});
@@ -1118,16 +1369,9 @@ void ComletDump::printByLine(std::ostream &out) {
                     header = "XL " + key + " (kB/s)";
                     columnSchemaList.push_back({header,
                                                 [config, key, this]() {
-                                                    if (fabricThroughputJson != nullptr) {
-                                                        for (auto tp : (*fabricThroughputJson)) {
-                                                            if (!key.compare(tp["name"].get<std::string>())) {
-                                                                #ifndef DAEMONLESS
-                                                                return getJsonValue(tp["avg"], config.scale);
-                                                                #else
-                                                                return getJsonValue(tp["value"], config.scale);
-                                                                #endif
-                                                            }
-                                                        }
+                                                    auto it = curRow.fabric.find(key);
+                                                    if (it != curRow.fabric.end()) {
+                                                        return getJsonValue(*it->second, config.scale);
                                                     }
                                                     return std::string();
                                                 }});
@@ -1144,11 +1388,12 @@ void ComletDump::printByLine(std::ostream &out) {
             DumpColumn dc{
                 std::string(config.name),
                 [config, this]() {
-                    std::string metricKey = config.key;
-                    if (statsJson != nullptr) {
-                        for (auto metricObj : (*statsJson)) {
-                            if (metricObj["metrics_type"].get<std::string>().compare(metricKey) == 0) {
-                                const uint64_t flags = metricObj["value"].get<uint64_t>();
+                    auto it = curRow.stats.find(config.key);
+                    if (it != curRow.stats.end()) {
+                        auto value = it->second->find("value");
+                        if (value != it->second->end()) {
+                            {
+                                const uint64_t flags = value->get<uint64_t>();
                                 std::string ss;
                                 if (flags & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_AVE_PWR_CAP) {
                                     ss += "Average Power Excursion | ";
@@ -1184,20 +1429,66 @@ void ComletDump::printByLine(std::ostream &out) {
         }
     }
 
-    // print table header
-    for (std::size_t i = 0; i < columnSchemaList.size(); i++) {
-        auto dc = columnSchemaList[i];
-        out << dc.header;
-        if (i < columnSchemaList.size() - 1) {
-            out << ", ";
+    // print table header, the JSON rows have the headers as keys
+    if (!jsonRows) {
+        for (std::size_t i = 0; i < columnSchemaList.size(); i++) {
+            auto& dc = columnSchemaList[i];
+            out << dc.header;
+            if (i < columnSchemaList.size() - 1) {
+                out << ", ";
+            }
         }
-    }
 
-    out << std::endl;
+        out << std::endl;
+    }
 
     int iter = 0;
     u_int64_t index = 0;
     uint64_t sleepMilliseconds = (this->opts->msTimeInterval == 0) ? (1000 * this->opts->timeInterval) : this->opts->msTimeInterval;
+    const std::chrono::milliseconds interval(sleepMilliseconds);
+
+    /*
+      With -i the rows follow the stores of the monitor. The deadline of each
+      row is an interval after the one before, half an interval off the
+      sampling ticks, and the row is read at the first store after it, so each
+      row has the samples of one interval, none twice and none skipped. The
+      deadlines keep the phase of the ticks as both run on the same clock.
+      With --ims, or if the updates can not be followed, the rows follow the
+      clock alone.
+    */
+    enum class StoreWait { UPDATE, TIMEOUT, STOPPED, UNAVAILABLE };
+    uint64_t generation = 0;
+    // wait for a store after generation until the time point, waking up to see if the dumping is stopped
+    auto waitForStore = [this, &generation](std::chrono::steady_clock::time_point until) {
+        while (keepDumping) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= until) {
+                return StoreWait::TIMEOUT;
+            }
+            auto timeout = std::min(std::chrono::duration_cast<std::chrono::milliseconds>(until - now) + std::chrono::milliseconds(1),
+                                    std::chrono::milliseconds(500));
+            uint64_t seen = generation;
+            if (!this->coreStub->waitForMetricsUpdate(&generation, timeout.count())) {
+                return StoreWait::UNAVAILABLE;
+            }
+            if (generation != seen) {
+                return StoreWait::UPDATE;
+            }
+        }
+        return StoreWait::STOPPED;
+    };
+    // the stores of the metrics of one tick come close together
+    const auto settleTime = std::min(std::chrono::milliseconds(150), interval / 4);
+
+    bool followUpdates = this->opts->msTimeInterval == 0;
+    std::chrono::steady_clock::time_point phase = std::chrono::steady_clock::now();
+    if (followUpdates) {
+        // the first update tells the generation, the store after it the phase of the ticks
+        followUpdates = waitForStore(phase + interval) == StoreWait::UPDATE && waitForStore(std::chrono::steady_clock::now() + interval * 2) == StoreWait::UPDATE;
+        phase = std::chrono::steady_clock::now() - interval / 2;
+        // the first row starts at the store
+        run();
+    }
 
     std::chrono::system_clock::time_point begin = std::chrono::system_clock::now();
     while (keepDumping) {
@@ -1208,70 +1499,62 @@ void ComletDump::printByLine(std::ostream &out) {
 
         ++index;
 
-        // for big interval
-        if (sleepMilliseconds > 1000){
-            auto leftTime = sleepMilliseconds;
-            while (leftTime > 1000 && keepDumping){
-                std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-                leftTime -= 1000;
+        if (followUpdates) {
+            auto deadline = phase + interval * index;
+            StoreWait wait;
+            // the stores before the deadline belong to this row
+            while ((wait = waitForStore(deadline)) == StoreWait::UPDATE) {
             }
-            if(!keepDumping){
+            if (wait == StoreWait::TIMEOUT) {
+                wait = waitForStore(deadline + interval);
+            }
+            if (wait == StoreWait::UPDATE) {
+                auto settled = std::chrono::steady_clock::now() + settleTime;
+                while (waitForStore(settled) == StoreWait::UPDATE) {
+                }
+            } else if (wait == StoreWait::UNAVAILABLE) {
+                followUpdates = false;
+                begin = std::chrono::system_clock::now() - interval * index;
+            }
+            if (!keepDumping) {
                 break;
             }
         }
 
-        std::this_thread::sleep_until(begin + std::chrono::milliseconds(sleepMilliseconds * index));
+        if (!followUpdates) {
+            // for big interval
+            if (sleepMilliseconds > 1000){
+                auto leftTime = sleepMilliseconds;
+                while (leftTime > 1000 && keepDumping){
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+                    leftTime -= 1000;
+                }
+                if(!keepDumping){
+                    break;
+                }
+            }
+
+            std::this_thread::sleep_until(begin + std::chrono::milliseconds(sleepMilliseconds * index));
+        }
         res = run();
         if (res->contains("error")) {
             out << "Error: " << (*res)["error"].get<std::string>() << std::endl;
             return;
         }
-        for (auto deviceId : this->opts->deviceIds) {
+        std::string rows;
+        curTimestamp = getDumpTimestamp(this->opts->showDate);
+        for (auto& deviceId : this->opts->deviceIds) {
             curDeviceId = deviceId;
-            statsJson = nullptr;
-            engineUtilJson = nullptr;
-            fabricThroughputJson = std::make_shared<nlohmann::json>((*deviceJsons[deviceId])["fabric_throughput"]);
-
-            for(auto tile : this->opts->deviceTileIds){
-                curTileId = tile;
-                if (this->opts->deviceTileIds.size() == 1 && this->opts->deviceTileIds[0] == "-1") {
-                    if (deviceJsons[deviceId]->contains("device_level")) {
-                        statsJson = std::make_shared<nlohmann::json>((*deviceJsons[deviceId])["device_level"]);
-                    }
-                    if (deviceJsons[deviceId]->contains("engine_util")) {
-                        engineUtilJson = std::make_shared<nlohmann::json>((*deviceJsons[deviceId])["engine_util"]);
-                    }
-                } else {
-                    if (deviceJsons[deviceId]->contains("tile_level")) {
-                        auto tiles = (*deviceJsons[deviceId])["tile_level"].get<std::vector<nlohmann::json>>();
-                        for (auto tile : tiles) {
-                            if (tile.contains("tile_id") && tile["tile_id"].get<int>() == std::stoi(curTileId) && tile.contains("data_list")) {
-                                statsJson = std::make_shared<nlohmann::json>(tile["data_list"]);
-                                if (tile.contains("engine_util")) {
-                                    engineUtilJson = std::make_shared<nlohmann::json>(tile["engine_util"]);
-                                }
-                                break;
-                            }
-                        }
-                    }
-                }
-
-                for (std::size_t i = 0; i < columnSchemaList.size(); i++) {
-                    auto dc = columnSchemaList[i];
-                    auto value = dc.getValue();
-                    if (value.empty())
-                        value = "N/A";
-                    if (value.size() < 4) {
-                        out << std::string(4 - value.size(), ' ');
-                    }
-                    out << value;
-                    if (i < columnSchemaList.size() - 1) {
-                        out << ", ";
-                    }
-                }
-                out << std::endl;
+            for (auto& tileId : this->opts->deviceTileIds) {
+                curTileId = tileId;
+                indexDumpRow(*deviceJsons[deviceId], tileId, curRow);
+                if (jsonRows)
+                    appendDumpJsonRow(rows, columnSchemaList);
+                else
+                    appendDumpRow(rows, columnSchemaList);
             }
         }
+        out << rows << std::flush;
         if ((this->opts->dumpTimes != -1 && ++iter >= this->opts->dumpTimes)) {
             keepDumping = false;
         }
@@ -11,6 +11,7 @@
 #include <memory>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <tuple>
 
 #include "comlet_base.h"
 #include "internal_dump_raw_data.h"
@@ -23,6 +24,26 @@ using xpum::dump::dumpTypeOptions;
 
 namespace xpum::cli {
 
+/*
+  The values shown in one dump row, indexed once per sampling tick from the
+  statistics of the device or the tile, so the columns are looked up instead
+  of searching and copying the statistics json for each cell.
+*/
+struct DumpRow {
+    // metrics type -> statistics object
+    std::map<std::string, const nlohmann::json*> stats;
+    // (tile id, engine type key, engine id) -> utilization value, tile id -1 for the engines of the row
+    std::map<std::tuple<int, std::string, int>, const nlohmann::json*> engines;
+    // Xe Link name -> throughput value
+    std::map<std::string, const nlohmann::json*> fabric;
+
+    void clear() {
+        stats.clear();
+        engines.clear();
+        fabric.clear();
+    }
+};
+
 struct ComletDumpOptions {
     std::vector<std::string> deviceIds = {"-1"};
     std::vector<std::string> deviceTileIds = {"-1"};
@@ -39,18 +60,33 @@ struct ComletDumpOptions {
     bool listDumpTask;
     int dumpTaskId = -1;
     bool showDate;
+    std::string dumpFormat = "csv";
+    std::string dumpLayout = "long";
+    // rotation of the dump file in MB and seconds, 0 for no limit
+    uint64_t rotateSize = 0;
+    uint32_t rotateInterval = 0;
+    uint32_t maxFiles = 0;
+    bool compress = false;
+    // keep the rows in memory and write them out when a policy is triggered
+    bool triggered = false;
+    uint32_t preTriggerTime = 60;
+    uint32_t postTriggerTime = 60;
+    std::vector<std::string> triggers;
 };
 
 class ComletDump : public ComletBase {
    private:
     std::unique_ptr<ComletDumpOptions> opts;
 
-    std::shared_ptr<nlohmann::json> statsJson;
-    std::shared_ptr<nlohmann::json> engineUtilJson;
-    std::shared_ptr<nlohmann::json> fabricThroughputJson;
+    DumpRow curRow;
     std::map<std::string, std::unique_ptr<nlohmann::json>> deviceJsons;
     std::string curDeviceId;
     std::string curTileId;
+    std::string curTimestamp;
+    // the device id of each -d value, the BDFs are only resolved once
+    std::map<std::string, int> targetIdMap;
+    // print newline delimited JSON rows instead of CSV
+    bool jsonRows = false;
 
     std::atomic<bool> keepDumping;
     std::ofstream dumpFile;
@@ -107,7 +143,10 @@ class ComletDump : public ComletBase {
 
     void dumpRawDataToFile(std::ostream &out);
 
-    bool dumpIdlePowerOnly();
+    // true if the metrics are all read from sysfs, so the dump does not need Level Zero
+    bool dumpFromSysfsOnly();
+
+    bool isSysfsMetricsOnly();
 
     std::string getEnv();
 
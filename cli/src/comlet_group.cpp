@@ -6,6 +6,7 @@
 
 #include "comlet_group.h"
 
+#include <cstring>
 #include <iostream>
 #include <map>
 #include <nlohmann/json.hpp>
@@ -29,7 +30,8 @@ static CharTableConfig ComletConfigCreateGroup(R"({
         "cells": [
             "group_id", [
                 { "label": "Group Name", "value": "group_name" },
-                { "label": "Device IDs", "value": "device_id_list" }
+                { "label": "Device IDs", "value": "device_id_list" },
+                { "label": "Selector", "value": "selector", "empty": false }
             ]
         ]
     }]
@@ -46,7 +48,8 @@ static CharTableConfig ComletConfigListGroup(R"({
         "cells": [
             "group_id", [
                 { "label": "Group Name", "value": "group_name" },
-                { "label": "Device IDs", "value": "device_id_list" }
+                { "label": "Device IDs", "value": "device_id_list" },
+                { "label": "Selector", "value": "selector", "empty": false }
             ]
         ]
     }]
@@ -63,7 +66,8 @@ static CharTableConfig ComletConfigAddDeviceToGroup(R"({
         "cells": [
             "group_id", [
                 { "label": "Group Name", "value": "group_name" },
-                { "label": "Device IDs", "value": "device_id_list" }
+                { "label": "Device IDs", "value": "device_id_list" },
+                { "label": "Selector", "value": "selector", "empty": false }
             ]
         ]
     }]
@@ -80,7 +84,8 @@ static CharTableConfig ComletConfigRemoveDeviceFromGroup(R"({
         "cells": [
             "group_id", [
                 { "label": "Group Name", "value": "group_name" },
-                { "label": "Device IDs", "value": "device_id_list" }
+                { "label": "Device IDs", "value": "device_id_list" },
+                { "label": "Selector", "value": "selector", "empty": false }
             ]
         ]
     }]
@@ -111,6 +116,22 @@ void ComletGroup::setupOptions() {
     auto g = addOption("-g,--group", this->opts->groupId, "Group ID.")->check(CLI::Range((uint32_t)1, std::numeric_limits<uint32_t>::max(), "unsigned"));
     auto n = addOption("-n,--name", this->opts->name, "Group name.");
     auto d = addOption("-d,--device", this->opts->deviceList, "Device IDs.");
+    auto model = addOption("--model", this->opts->model, "Create a dynamic group of the devices whose name contains the model or whose PCI device id is the model.");
+    auto numa = addOption("--numa", this->opts->numaNode, "Create a dynamic group of the devices on the NUMA node.");
+    numa->check(CLI::Range(0, std::numeric_limits<int>::max()));
+    auto pcieSwitch = addOption("--pcie-switch", this->opts->pcieSwitch, "Create a dynamic group of the devices below the PCIe switch or bridge of the BDF.");
+    pcieSwitch->check([](const std::string &str) {
+        return isBDF(str) ? std::string() : std::string("PCIe switch should be a BDF string");
+    });
+    auto functionType = addOption("--function-type", this->opts->functionType, "Create a dynamic group of the physical or virtual functions.");
+    functionType->check(CLI::IsMember({"physical", "virtual"}));
+    auto pod = addOption("--pod", this->opts->podUid, "Create a dynamic group of the devices used by the processes of the Kubernetes pod of the UID.");
+    auto health = addOption("--health", this->opts->healthStatus, "Create a dynamic group of the devices of the health status or worse.");
+    health->check(CLI::IsMember({"warning", "critical"}));
+    auto throttled = addFlag("--throttled", this->opts->throttled, "Create a dynamic group of the devices whose frequency is throttled.");
+    for (auto selector : {model, numa, pcieSwitch, functionType, pod, health, throttled}) {
+        selector->needs(c);
+    }
     d->check([this](const std::string &str) {
         std::string errStr = "Device id should be a non-negative integer or a BDF string";
         std::vector<std::string> deviceIds = split(str, ' ');
@@ -150,7 +171,7 @@ std::unique_ptr<nlohmann::json> ComletGroup::run() {
     setupOperationType();
     switch (opts->opType) {
         case GO_CREATE:
-            return this->coreStub->groupCreate(this->opts->name);
+            return createGroup();
         case GO_DELETE:
             return destroyGroup();
         case GO_LIST:
@@ -170,6 +191,45 @@ std::unique_ptr<nlohmann::json> ComletGroup::run() {
     return json;
 }
 
+std::unique_ptr<nlohmann::json> ComletGroup::createGroup() {
+    xpum_group_selector_t selector = {};
+    auto copyString = [](char *dest, const std::string &src) {
+        strncpy(dest, src.c_str(), XPUM_MAX_STR_LENGTH - 1);
+        dest[XPUM_MAX_STR_LENGTH - 1] = 0;
+    };
+    if (!opts->model.empty()) {
+        selector.flags |= XPUM_GROUP_SELECTOR_MODEL;
+        copyString(selector.model, opts->model);
+    }
+    if (opts->numaNode >= 0) {
+        selector.flags |= XPUM_GROUP_SELECTOR_NUMA_NODE;
+        selector.numaNode = opts->numaNode;
+    }
+    if (!opts->pcieSwitch.empty()) {
+        selector.flags |= XPUM_GROUP_SELECTOR_PCIE_SWITCH;
+        copyString(selector.pcieSwitch, opts->pcieSwitch);
+    }
+    if (!opts->functionType.empty()) {
+        selector.flags |= XPUM_GROUP_SELECTOR_FUNCTION_TYPE;
+        selector.functionType = opts->functionType == "physical" ? DEVICE_FUNCTION_TYPE_PHYSICAL : DEVICE_FUNCTION_TYPE_VIRTUAL;
+    }
+    if (!opts->podUid.empty()) {
+        selector.flags |= XPUM_GROUP_SELECTOR_POD;
+        copyString(selector.podUid, opts->podUid);
+    }
+    if (!opts->healthStatus.empty()) {
+        selector.flags |= XPUM_GROUP_SELECTOR_HEALTH;
+        selector.healthStatus = opts->healthStatus == "critical" ? XPUM_HEALTH_STATUS_CRITICAL : XPUM_HEALTH_STATUS_WARNING;
+    }
+    if (opts->throttled) {
+        selector.flags |= XPUM_GROUP_SELECTOR_THROTTLED;
+    }
+    if (selector.flags == 0) {
+        return this->coreStub->groupCreate(this->opts->name);
+    }
+    return this->coreStub->groupCreateBySelector(this->opts->name, selector);
+}
+
 std::unique_ptr<nlohmann::json> ComletGroup::destroyGroup() {
     return this->coreStub->groupDelete(this->opts->groupId);
 }
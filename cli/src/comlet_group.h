@@ -36,6 +36,14 @@ struct ComletGroupOptions {
     bool flagList;
     bool flagAdd;
     bool flagRemove;
+    // the selector of a dynamic group created with -c
+    std::string model;
+    int numaNode = -1;
+    std::string pcieSwitch;
+    std::string functionType;
+    std::string podUid;
+    std::string healthStatus;
+    bool throttled = false;
 };
 
 class ComletGroup : public ComletBase {
@@ -75,6 +83,7 @@ class ComletGroup : public ComletBase {
     }
 
    private:
+    std::unique_ptr<nlohmann::json> createGroup();
     std::unique_ptr<nlohmann::json> destroyGroup();
     std::unique_ptr<nlohmann::json> listGroup();
     std::unique_ptr<nlohmann::json> addDeviceToGroup();
@@ -612,6 +612,9 @@ void ComletStatistics::setupOptions() {
     return errStr;
     });
 
+    auto listAllFlag = addFlag("-l,--list", this->opts->listAll, "Display the statistics of all devices in one run");
+    listAllFlag->excludes(deviceIdOpt);
+
     auto xeLinkThroughputMatrixFlag = addFlag("--xelink", this->opts->xelinkThroughputMatrix, "Show the all the Xe Link throughput (GB/s) matrix");
 
     auto xeLinkUtilMatrixFlag = addFlag("--utils", this->opts->xelinkUtilMatrix, "Show the Xe Link throughput utilization");
@@ -627,6 +630,10 @@ std::unique_ptr<nlohmann::json> ComletStatistics::run() {
     if(this->opts->xelinkThroughputMatrix){
         return this->coreStub->getXelinkThroughputAndUtilMatrix();
     }
+    if (this->opts->listAll) {
+        // one process and one call for all devices, like for the monitoring plugins checking every GPU of a node
+        return this->coreStub->getStatisticsBulk({}, true, true);
+    }
     if (isDeviceOp()) {
         int targetId = -1;
         if (isNumber(this->opts->deviceId)) {
@@ -874,7 +881,7 @@ void ComletStatistics::getTableResult(std::ostream& out) {
     *json = *res;
     if (this->opts->xelinkThroughputMatrix) {
         printXelinkTable(json);
-    } else if (this->opts->groupId != 0) {
+    } else if (this->opts->groupId != 0 || this->opts->listAll) {
         auto devices = (*json)["datas"].get<std::vector<nlohmann::json>>();
         bool cont = false;
         for (auto device : devices) {
@@ -22,6 +22,7 @@ struct ComletStatisticsOptions {
     uint32_t groupId = 0;
     bool xelinkThroughputMatrix = false;
     bool xelinkUtilMatrix = false;
+    bool listAll = false;
 };
 
 class ComletStatistics : public ComletBase {
@@ -0,0 +1,359 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file comlet_top.cpp
+ */
+
+#include "comlet_top.h"
+
+#include <signal.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <thread>
+
+#include "core_stub.h"
+#include "exit_code.h"
+#include "terminal_screen.h"
+#include "utility.h"
+
+namespace xpum::cli {
+
+static volatile sig_atomic_t topStopped = 0;
+
+static void stopTop(int) {
+    topStopped = 1;
+}
+
+struct TopColumn {
+    const char *header;
+    int width;
+    const char *metricsType;
+    int precision;
+    // the value of a device without it is the sum of its tiles instead of their average
+    bool sumOfTiles;
+};
+
+static const TopColumn topColumns[] = {
+    {"GPU%", 7, "XPUM_STATS_GPU_UTILIZATION", 1, false},
+    {"Power(W)", 10, "XPUM_STATS_POWER", 1, true},
+    {"Freq(MHz)", 11, "XPUM_STATS_GPU_FREQUENCY", 0, false},
+    {"Temp(C)", 9, "XPUM_STATS_GPU_CORE_TEMPERATURE", 0, false},
+    {"Mem(MiB)", 10, "XPUM_STATS_MEMORY_USED", 0, true},
+    {"Mem%", 7, "XPUM_STATS_MEMORY_UTILIZATION", 1, false},
+    {"Compute%", 10, "XPUM_STATS_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION", 1, false},
+    {"Render%", 9, "XPUM_STATS_ENGINE_GROUP_RENDER_ALL_UTILIZATION", 1, false},
+    {"Media%", 8, "XPUM_STATS_ENGINE_GROUP_MEDIA_ALL_UTILIZATION", 1, false},
+    {"Copy%", 7, "XPUM_STATS_ENGINE_GROUP_COPY_ALL_UTILIZATION", 1, false},
+};
+
+static const char *topEngineKeys[] = {"compute", "render", "3d", "copy", "decoder", "encoder", "media_enhancement"};
+
+static bool findMetricValue(const nlohmann::json &dataList, const char *metricsType, double &value) {
+    if (!dataList.is_array()) {
+        return false;
+    }
+    for (auto &data : dataList) {
+        if (data.value("metrics_type", "") == metricsType && data.contains("value") && data["value"].is_number()) {
+            value = data["value"].get<double>();
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::string formatValue(bool found, double value, int precision, int width) {
+    std::ostringstream os;
+    os << std::right << std::setw(width);
+    if (found) {
+        os << std::fixed << std::setprecision(precision) << value;
+    } else {
+        os << "-";
+    }
+    return os.str();
+}
+
+static std::string engineLine(const nlohmann::json &engineUtil) {
+    std::ostringstream os;
+    os << std::string(10, ' ') << "engines:";
+    bool empty = true;
+    for (auto key : topEngineKeys) {
+        if (!engineUtil.contains(key) || engineUtil[key].empty()) {
+            continue;
+        }
+        os << (empty ? " " : "  | ") << key;
+        for (auto &engine : engineUtil[key]) {
+            double value = engine.contains("value") && engine["value"].is_number() ? engine["value"].get<double>() : 0;
+            os << " " << (int)std::round(value);
+        }
+        empty = false;
+    }
+    return empty ? "" : os.str();
+}
+
+void ComletTop::setupOptions() {
+    this->opts = std::unique_ptr<ComletTopOptions>(new ComletTopOptions());
+    auto deviceIdOpt = addOption("-d,--device", this->opts->deviceIds, "The device IDs or PCI BDF addresses to show. The value of \"-1\" means all devices.");
+    deviceIdOpt->check([](const std::string &str) {
+        std::string errStr = "Device id should be a non-negative integer or a BDF string";
+        if (str == "-1" || isValidDeviceId(str) || isBDF(str)) {
+            return std::string();
+        }
+        return errStr;
+    });
+    deviceIdOpt->delimiter(',');
+    auto timeIntervalOpt = addOption("-i", this->opts->timeInterval, "The interval (in seconds) to refresh the view. Default value: 1 second.");
+    timeIntervalOpt->check(CLI::Range(1, 3600));
+    auto iterationsOpt = addOption("-n", this->opts->iterations, "Number of refreshes before the view exits. The view is refreshed until q is pressed if this parameter is not specified.");
+    iterationsOpt->check(CLI::Range(1, std::numeric_limits<int>::max()));
+}
+
+std::unique_ptr<nlohmann::json> ComletTop::run() {
+    // all the devices if -1 is one of the values
+    std::vector<int> targetIds;
+    for (auto deviceId : this->opts->deviceIds) {
+        if (deviceId == "-1") {
+            targetIds.clear();
+            break;
+        }
+        auto it = targetIdMap.find(deviceId);
+        if (it == targetIdMap.end()) {
+            int targetId = -1;
+            if (isNumber(deviceId)) {
+                targetId = std::stoi(deviceId);
+            } else {
+                auto convertResult = this->coreStub->getDeivceIdByBDF(deviceId.c_str(), &targetId);
+                if (convertResult->contains("error")) {
+                    return convertResult;
+                }
+            }
+            it = targetIdMap.emplace(deviceId, targetId).first;
+        }
+        targetIds.push_back(it->second);
+    }
+
+    auto stats = this->coreStub->getStatisticsBulk(targetIds, false, true);
+    if (stats->contains("error")) {
+        return stats;
+    }
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+    (*json)["timestamp"] = stats->value("end", "");
+    (*json)["devices"] = stats->contains("datas") ? (*stats)["datas"] : nlohmann::json::array();
+    (*json)["processes"] = nlohmann::json::array();
+    // the processes are optional, a failure to read them does not stop the view
+    auto processes = this->coreStub->getAllDeviceUtilizationByProcess(100 * 1000);
+    if (!processes->contains("error") && processes->contains("device_util_by_proc_list")) {
+        for (auto &process : (*processes)["device_util_by_proc_list"]) {
+            int deviceId = process.value("device_id", -1);
+            if (targetIds.empty() || std::find(targetIds.begin(), targetIds.end(), deviceId) != targetIds.end()) {
+                (*json)["processes"].push_back(process);
+            }
+        }
+    }
+    return json;
+}
+
+std::vector<std::string> ComletTop::renderFrame(const nlohmann::json &snapshot, int rows) {
+#ifndef DAEMONLESS
+    std::string appName = "xpumcli";
+#else
+    std::string appName = "xpu-smi";
+#endif
+    std::vector<std::string> lines;
+    auto &devices = snapshot["devices"];
+    auto &processes = snapshot["processes"];
+
+    std::ostringstream title;
+    title << appName << " top - " << snapshot.value("timestamp", "") << "  devices: " << devices.size()
+          << "  processes: " << processes.size() << "  refresh: " << this->opts->timeInterval << "s";
+    if (rows > 0) {
+        title << "  q: quit";
+    }
+    lines.push_back(title.str());
+    lines.push_back("");
+
+    std::ostringstream header;
+    header << std::left << std::setw(5) << "DID" << std::setw(5) << "Tile";
+    for (auto &column : topColumns) {
+        header << std::right << std::setw(column.width) << column.header;
+    }
+    header << "  Name";
+    lines.push_back(header.str());
+
+    for (auto &device : devices) {
+        int deviceId = device.value("device_id", -1);
+        const nlohmann::json empty = nlohmann::json::array();
+        auto &tiles = device.contains("tile_level") ? device["tile_level"] : empty;
+
+        std::ostringstream row;
+        row << std::left << std::setw(5) << deviceId << std::setw(5) << "-";
+        for (auto &column : topColumns) {
+            double value = 0;
+            bool found = device.contains("device_level") && findMetricValue(device["device_level"], column.metricsType, value);
+            if (!found) {
+                // a metric only read on the tiles of the device
+                int count = 0;
+                double total = 0;
+                for (auto &tile : tiles) {
+                    double tileValue;
+                    if (tile.contains("data_list") && findMetricValue(tile["data_list"], column.metricsType, tileValue)) {
+                        total += tileValue;
+                        count++;
+                    }
+                }
+                found = count > 0;
+                value = column.sumOfTiles || count == 0 ? total : total / count;
+            }
+            row << formatValue(found, value, column.precision, column.width);
+        }
+        auto name = deviceNames.find(deviceId);
+        row << "  " << (name != deviceNames.end() ? name->second : "");
+        lines.push_back(row.str());
+        if (device.contains("engine_util")) {
+            auto line = engineLine(device["engine_util"]);
+            if (!line.empty()) {
+                lines.push_back(line);
+            }
+        }
+
+        for (auto &tile : tiles) {
+            std::ostringstream tileRow;
+            tileRow << std::left << std::setw(5) << "" << std::setw(5) << tile.value("tile_id", -1);
+            for (auto &column : topColumns) {
+                double value = 0;
+                bool found = tile.contains("data_list") && findMetricValue(tile["data_list"], column.metricsType, value);
+                tileRow << formatValue(found, value, column.precision, column.width);
+            }
+            lines.push_back(tileRow.str());
+            if (tile.contains("engine_util")) {
+                auto line = engineLine(tile["engine_util"]);
+                if (!line.empty()) {
+                    lines.push_back(line);
+                }
+            }
+        }
+    }
+
+    lines.push_back("");
+    std::ostringstream processHeader;
+    processHeader << std::left << std::setw(10) << "PID" << std::setw(20) << "Command" << std::setw(10) << "DeviceID"
+                  << std::setw(15) << "MEM(kB)" << std::setw(15) << "SHR(kB)";
+    lines.push_back(processHeader.str());
+
+    // the processes using the most device memory first
+    std::vector<const nlohmann::json *> sorted;
+    for (auto &process : processes) {
+        sorted.push_back(&process);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const nlohmann::json *a, const nlohmann::json *b) {
+        return a->value("mem_size", (uint64_t)0) > b->value("mem_size", (uint64_t)0);
+    });
+    for (size_t i = 0; i < sorted.size(); i++) {
+        if (rows > 0 && (int)lines.size() == rows - 1 && i + 1 < sorted.size()) {
+            lines.push_back("... " + std::to_string(sorted.size() - i) + " more");
+            break;
+        }
+        auto &process = *sorted[i];
+        std::ostringstream row;
+        row << std::left << std::setw(10) << process.value("process_id", (uint32_t)0)
+            << std::setw(20) << process.value("process_name", "").substr(0, 19)
+            << std::setw(10) << process.value("device_id", (uint32_t)0)
+            << std::setw(15) << process.value("mem_size", (uint64_t)0)
+            << std::setw(15) << process.value("shared_mem_size", (uint64_t)0);
+        lines.push_back(row.str());
+    }
+    return lines;
+}
+
+void ComletTop::getTableResult(std::ostream &out) {
+    auto deviceList = this->coreStub->getDeviceList();
+    if (deviceList->contains("device_list")) {
+        for (auto &device : (*deviceList)["device_list"]) {
+            deviceNames[device.value("device_id", -1)] = device.value("device_name", "");
+        }
+    }
+
+    TerminalScreen screen(out);
+    bool fullScreen = screen.open();
+    topStopped = 0;
+    auto oldIntHandler = signal(SIGINT, stopTop);
+    auto oldTermHandler = signal(SIGTERM, stopTop);
+
+    // a frame is made after the first store of the monitor past its deadline, from the same sample on all devices
+    uint64_t generation = 0;
+    bool followUpdates = true;
+    auto interval = std::chrono::milliseconds(this->opts->timeInterval * 1000);
+    auto deadline = std::chrono::steady_clock::now();
+    int frames = 0;
+    while (!topStopped) {
+        auto snapshot = run();
+        if (snapshot->contains("error")) {
+            screen.close();
+            out << "Error: " << (*snapshot)["error"].get<std::string>() << std::endl;
+            setExitCodeByJson(*snapshot);
+            break;
+        }
+        if (fullScreen) {
+            int rows, columns;
+            screen.getSize(rows, columns);
+            screen.draw(renderFrame(*snapshot, rows));
+        } else {
+            for (auto &line : renderFrame(*snapshot, 0)) {
+                out << line << std::endl;
+            }
+            out << std::endl;
+        }
+        if (this->opts->iterations > 0 && ++frames >= this->opts->iterations) {
+            break;
+        }
+
+        deadline += interval;
+        auto now = std::chrono::steady_clock::now();
+        if (deadline + interval < now) {
+            // fell behind, e.g. suspended
+            deadline = now;
+        }
+        bool updated = false;
+        while (!topStopped) {
+            int key = screen.readKey();
+            if (key == 'q' || key == 'Q' || key == 27) {
+                topStopped = 1;
+                break;
+            }
+            now = std::chrono::steady_clock::now();
+            // without a store in a whole interval past the deadline, the view is refreshed anyway
+            if (now >= deadline && (updated || !followUpdates || now >= deadline + interval)) {
+                break;
+            }
+            auto until = now < deadline ? deadline : deadline + interval;
+            auto timeout = std::min(std::chrono::duration_cast<std::chrono::milliseconds>(until - now), std::chrono::milliseconds(100));
+            if (timeout.count() <= 0) {
+                timeout = std::chrono::milliseconds(1);
+            }
+            if (followUpdates) {
+                uint64_t previous = generation;
+                followUpdates = this->coreStub->waitForMetricsUpdate(&generation, timeout.count());
+                if (generation != previous && std::chrono::steady_clock::now() >= deadline) {
+                    updated = true;
+                }
+            } else {
+                std::this_thread::sleep_for(timeout);
+            }
+        }
+        if (updated && !topStopped) {
+            // the other metrics of the sample are stored right after the first one
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+
+    signal(SIGINT, oldIntHandler);
+    signal(SIGTERM, oldTermHandler);
+    screen.close();
+}
+
+} // end namespace xpum::cli
@@ -0,0 +1,56 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file comlet_top.h
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "comlet_base.h"
+
+namespace xpum::cli {
+
+struct ComletTopOptions {
+    std::vector<std::string> deviceIds = {"-1"};
+    uint32_t timeInterval = 1;
+    int iterations = -1;
+};
+
+/*
+  A full-screen view of the devices, their tiles and engines and the
+  processes using them, refreshed in place like top. Each refresh reads the
+  statistics of all the devices in one call and is made after the monitor
+  stores a new sample, so a frame never mixes two samples. With -j, or when
+  the output is not a terminal, the frames are printed one after another.
+*/
+class ComletTop : public ComletBase {
+   public:
+    ComletTop() : ComletBase("top", "Show the devices, engines and processes in a full-screen view refreshed like top.") {}
+    virtual ~ComletTop() {}
+
+    virtual void setupOptions() override;
+    virtual std::unique_ptr<nlohmann::json> run() override;
+    virtual void getTableResult(std::ostream &out) override;
+
+    inline std::vector<std::string> getDeviceIds() {
+        return opts->deviceIds;
+    }
+
+   private:
+    std::unique_ptr<ComletTopOptions> opts;
+    // the device id of each -d value, the BDFs are only resolved once
+    std::map<std::string, int> targetIdMap;
+    // the names of the devices by id
+    std::map<int, std::string> deviceNames;
+
+    // the lines of one frame, the processes which do not fit in rows are counted, 0 for no limit
+    std::vector<std::string> renderFrame(const nlohmann::json &snapshot, int rows);
+};
+
+} // end namespace xpum::cli
@@ -57,6 +57,32 @@ static CharTableConfig ComletConfigTopdownDevice(R"({
     }]
 })"_json);
 
+static CharTableConfig ComletConfigPerfMetrics(R"({
+    "columns": [{
+        "title": "Tile ID"
+    }, {
+        "title": "Metric Group"
+    }, {
+        "title": "Metric"
+    }, {
+        "title": "Current"
+    }, {
+        "title": "Average"
+    }, {
+        "title": "Min"
+    }, {
+        "title": "Max"
+    }, {
+        "title": "Active Ratio"
+    }],
+    "rows": [{
+        "instance": "perf_metric_list[]",
+        "cells": [
+            "tile_id", "group_name", "metric_name", "current", "average", "min", "max", "active_ratio"
+        ]
+    }]
+})"_json);
+
 ComletTopdown::ComletTopdown() : ComletBase("topdown", "Expected feature.") {
 }
 
@@ -74,6 +100,9 @@ void ComletTopdown::setupOptions() {
     });
     addOption("-t,--tile", this->opts->deviceTileId, "The device tile ID to query. If the device has only one tile, this parameter should not be specified.");
     addOption("-s,--samplingInterval", this->opts->samplingInterval, "Set the time interval (in milliseconds) by which XPU Manager daemon monitors gpu component utilization statistics.");
+    addFlag("-m,--metrics", this->opts->metrics, "Show the performance metrics collected by the XPU Manager daemon when METRIC_PERF is enabled.");
+    addFlag("--monitor", this->opts->monitor, "Show the top-down analysis computed by the XPU Manager daemon from the performance metrics it monitors when METRIC_PERF is enabled, without sampling the device.");
+    addOption("-w,--window", this->opts->window, "The time window (in milliseconds) over which the performance metrics are aggregated. All kept samples are aggregated by default.");
 }
 
 std::unique_ptr<nlohmann::json> ComletTopdown::run() {
@@ -89,6 +118,12 @@ std::unique_ptr<nlohmann::json> ComletTopdown::run() {
                 return convertResult;
             }
         }
+        if (this->opts->metrics) {
+            return this->coreStub->getPerfMetrics(targetId, this->opts->deviceTileId, this->opts->window);
+        }
+        if (this->opts->monitor) {
+            return this->coreStub->getTopdownRatios(targetId, this->opts->deviceTileId, this->opts->window);
+        }
         auto json = this->coreStub->getDeviceComponentOccupancyRatio(targetId, this->opts->deviceTileId, this->opts->samplingInterval);
         return json;
     } else {
@@ -115,6 +150,11 @@ void ComletTopdown::getTableResult(std::ostream &out) {
     std::shared_ptr<nlohmann::json> json = std::make_shared<nlohmann::json>();
     *json = *res;
     
+    if (this->opts->metrics) {
+        CharTable table(ComletConfigPerfMetrics, *json);
+        table.show(out);
+        return;
+    }
     showTopdownAnalysisResult(out, json);
 }
 
@@ -18,6 +18,9 @@ struct ComletTopdownOptions {
     std::string deviceId = "-1";
     int deviceTileId = -1;
     int samplingInterval = -1;
+    bool metrics = false;
+    bool monitor = false;
+    uint32_t window = 0;
 };
 
 class ComletTopdown : public ComletBase {
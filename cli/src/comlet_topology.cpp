@@ -7,6 +7,7 @@
 #include "comlet_topology.h"
 
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <map>
 #include <nlohmann/json.hpp>
@@ -50,12 +51,26 @@ void ComletTopology::setupOptions() {
                      "  SYS: Connected with PCIe between NUMA nodes\n"
                      "  NODE: Connected with PCIe within a NUMA node\n"
                      "  MDF: Connected with Multi-Die Fabric Interface");
+    auto p = addOption("--placement", this->opts->placementDevices,
+                       "Advise the order of the devices for collectives, the ring follows Xe Link first, then the fewest PCIe\n"
+                       "switch hops within a NUMA node, and the CPUs and NUMA nodes local to the devices.\n"
+                       "The device IDs are separated by comma, the value of \"-1\" means all devices.");
+    p->delimiter(',');
+    p->check([](const std::string &str) {
+        if (!isValidDeviceId(str) && str != "-1") {
+            return std::string("Device id should be a non-negative integer. \"-1\" means all devices.");
+        }
+        return std::string();
+    });
     d->excludes(e);
     d->excludes(m);
     e->excludes(d);
     d->excludes(m);
     m->excludes(d);
     m->excludes(e);
+    p->excludes(d);
+    p->excludes(e);
+    p->excludes(m);
 }
 
 std::unique_ptr<nlohmann::json> ComletTopology::run() {
@@ -94,6 +109,17 @@ std::unique_ptr<nlohmann::json> ComletTopology::run() {
     } else if (this->opts->xeLink) {
         auto json = this->coreStub->getXelinkTopology();
         return json;
+    } else if (!this->opts->placementDevices.empty()) {
+        std::vector<int> deviceIds;
+        for (auto &id : this->opts->placementDevices) {
+            if (id == "-1") {
+                deviceIds.clear();
+                break;
+            }
+            deviceIds.push_back(std::stoi(id));
+        }
+        auto json = this->coreStub->getPlacementAdvice(deviceIds);
+        return json;
     } else {
         (*result)["error"] = "Wrong argument or unknow operation, run with --help for more information.";
         exit_code = XPUM_CLI_ERROR_BAD_ARGUMENT;
@@ -172,6 +198,36 @@ void ComletTopology::showXelinkTopology(std::shared_ptr<nlohmann::json> json) {
     }
 }
 
+void ComletTopology::showPlacementAdvice(std::shared_ptr<nlohmann::json> json) {
+    std::cout << std::left << std::setw(12) << "Ring Order" << std::setw(11) << "Device ID" << std::setw(11) << "NUMA Node"
+              << std::setw(13) << "Tree Parent" << std::setw(11) << "Next Link" << "CPU Affinity" << std::endl;
+    int order = 0;
+    for (auto &device : (*json)["device_list"]) {
+        int numaIndex = device["numa_index"].get<int>();
+        int treeParent = device["tree_parent"].get<int>();
+        std::string nextLink = device["next_link_type"].get<std::string>();
+        if (nextLink != "XL" && device["next_pcie_hops"].get<int>() > 0) {
+            nextLink += "(" + std::to_string(device["next_pcie_hops"].get<int>()) + ")";
+        }
+        std::cout << std::left << std::setw(12) << order++
+                  << std::setw(11) << device["device_id"].get<int>()
+                  << std::setw(11) << (numaIndex < 0 ? std::string("-") : std::to_string(numaIndex))
+                  << std::setw(13) << (treeParent < 0 ? std::string("-") : std::to_string(treeParent))
+                  << std::setw(11) << nextLink
+                  << device["cpu_affinity"].get<std::string>() << std::endl;
+    }
+    std::string numaNodes;
+    for (auto &numa : (*json)["numa_node_list"]) {
+        numaNodes += (numaNodes.empty() ? "" : ",") + std::to_string(numa.get<int>());
+    }
+    std::cout << std::endl;
+    std::cout << "CPU List: " << (*json)["cpu_list"].get<std::string>() << std::endl;
+    std::cout << "NUMA Nodes: " << numaNodes << std::endl;
+    std::cout << "Ring: " << (*json)["ring_xelink_hops"].get<int>() << " Xe Link hops, "
+              << (*json)["ring_pcie_hops"].get<int>() << " PCIe switch hops, "
+              << (*json)["ring_cross_numa_hops"].get<int>() << " NUMA crossings" << std::endl;
+}
+
 void ComletTopology::getTableResult(std::ostream &out) {
     auto res = run();
     if (res->contains("error")) {
@@ -184,6 +240,8 @@ void ComletTopology::getTableResult(std::ostream &out) {
 
     if (isDeviceOperation()) {
         showDeviceTopology(out, json);
+    } else if (!this->opts->placementDevices.empty()) {
+        showPlacementAdvice(json);
     } else {
         showXelinkTopology(json);
     }
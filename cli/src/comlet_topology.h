@@ -8,6 +8,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "comlet_base.h"
 
@@ -18,6 +19,7 @@ struct ComletTopologyOptions {
     std::string device = "";
     std::string xmlFile = "";
     bool xeLink = false;
+    std::vector<std::string> placementDevices;
 };
 
 class ComletTopology : public ComletBase {
@@ -39,6 +41,7 @@ class ComletTopology : public ComletBase {
     std::unique_ptr<ComletTopologyOptions> opts;
 
     void showXelinkTopology(std::shared_ptr<nlohmann::json> json);
+    void showPlacementAdvice(std::shared_ptr<nlohmann::json> json);
     void printXelinkTable(const nlohmann::json &table);
     std::string getPortList(const nlohmann::json &item);
     void printHead(std::string head[], int count, int headsize, int rowsize);
@@ -6,12 +6,18 @@
 
 #include "core_stub.h"
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <map>
 #include <nlohmann/json.hpp>
+#include <vector>
+#include "exit_code.h"
+#include "stats_model.h"
 #include "xpum_structs.h"
 
 namespace xpum::cli {
@@ -79,6 +85,31 @@ static MetricsTypeEntry metricsTypeArray[]{
     {XPUM_STATS_PCIE_WRITE, "XPUM_STATS_PCIE_WRITE"},
     {XPUM_STATS_ENGINE_UTILIZATION, "XPUM_STATS_ENGINE_UTILIZATION"}};
 
+std::string CoreStub::internalStatsTypeToString(xpum_internal_stats_type_t type) {
+    switch (type) {
+        case XPUM_INTERNAL_STATS_ZE_LOCK_WAIT:
+            return "ze_lock_wait";
+        case XPUM_INTERNAL_STATS_ZE_CALL:
+            return "ze_call";
+        case XPUM_INTERNAL_STATS_MONITOR_TICK_LATENESS:
+            return "monitor_tick_lateness";
+        case XPUM_INTERNAL_STATS_MONITOR_COLLECT:
+            return "monitor_collect";
+        case XPUM_INTERNAL_STATS_MONITOR_STORE:
+            return "monitor_store";
+        case XPUM_INTERNAL_STATS_MEMORY:
+            return "memory";
+        case XPUM_INTERNAL_STATS_EVENT_DELIVERY:
+            return "event_delivery";
+        case XPUM_INTERNAL_STATS_CPU_TIME:
+            return "cpu_time";
+        case XPUM_INTERNAL_STATS_CPU_BUDGET_CUT:
+            return "cpu_budget_cut";
+        default:
+            return std::to_string(type);
+    }
+}
+
 std::string CoreStub::metricsTypeToString(xpum_stats_type_t metricsType) {
     for (auto item : metricsTypeArray) {
         if (item.key == metricsType) {
@@ -142,4 +173,175 @@ std::string CoreStub::deviceFunctionTypeEnumToString(xpum_device_function_type_t
             return "unknown";
     }
 }
+
+bool CoreStub::metricsTypeAllowList(xpum_stats_type_t metricsType) {
+    std::vector<xpum_stats_type_t> allowList{
+        XPUM_STATS_GPU_UTILIZATION,
+        XPUM_STATS_EU_ACTIVE,
+        XPUM_STATS_EU_STALL,
+        XPUM_STATS_EU_IDLE,
+        XPUM_STATS_POWER,
+        // XPUM_STATS_ENERGY,
+        XPUM_STATS_GPU_FREQUENCY,
+        XPUM_STATS_GPU_CORE_TEMPERATURE,
+        XPUM_STATS_MEMORY_USED,
+        XPUM_STATS_MEMORY_UTILIZATION,
+        XPUM_STATS_MEMORY_BANDWIDTH,
+        // XPUM_STATS_MEMORY_READ,
+        // XPUM_STATS_MEMORY_WRITE,
+        XPUM_STATS_MEMORY_READ_THROUGHPUT,
+        XPUM_STATS_MEMORY_WRITE_THROUGHPUT,
+        XPUM_STATS_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION,
+        XPUM_STATS_ENGINE_GROUP_MEDIA_ALL_UTILIZATION,
+        XPUM_STATS_ENGINE_GROUP_COPY_ALL_UTILIZATION,
+        XPUM_STATS_ENGINE_GROUP_RENDER_ALL_UTILIZATION,
+        // XPUM_STATS_ENGINE_GROUP_3D_ALL_UTILIZATION,
+        XPUM_STATS_RAS_ERROR_CAT_RESET,
+        XPUM_STATS_RAS_ERROR_CAT_PROGRAMMING_ERRORS,
+        XPUM_STATS_RAS_ERROR_CAT_DRIVER_ERRORS,
+        XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE,
+        XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE,
+        // XPUM_STATS_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE,
+        // XPUM_STATS_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE,
+        XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE,
+        XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE,
+        // XPUM_STATS_GPU_REQUEST_FREQUENCY,
+        XPUM_STATS_MEMORY_TEMPERATURE,
+        // XPUM_STATS_FREQUENCY_THROTTLE,
+        // XPUM_STATS_PCIE_READ_THROUGHPUT,
+        // XPUM_STATS_PCIE_WRITE_THROUGHPUT,
+        // XPUM_STATS_PCIE_READ,
+        // XPUM_STATS_PCIE_WRITE,
+        XPUM_STATS_ENGINE_UTILIZATION,
+        XPUM_STATS_MEDIA_ENGINE_FREQUENCY,
+    };
+    return std::find(allowList.begin(), allowList.end(), metricsType) != allowList.end();
+}
+
+int32_t CoreStub::getCliScale(xpum_stats_type_t metricsType) {
+    switch (metricsType) {
+        case XPUM_STATS_ENERGY:
+            return 1000;
+        case XPUM_STATS_MEMORY_USED:
+            return 1048576;
+        default:
+            return 1;
+    }
+}
+
+std::unique_ptr<nlohmann::json> CoreStub::telemetrySnapshotToJson(const char* snapshot, size_t size, bool enableFilter, bool enableScale) {
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+    xpum_telemetry_snapshot_header_t header{};
+    if (size < sizeof(header)) {
+        (*json)["error"] = "Invalid telemetry snapshot";
+        (*json)["errno"] = XPUM_CLI_ERROR_GENERIC_ERROR;
+        return json;
+    }
+    std::memcpy(&header, snapshot, sizeof(header));
+    // the structs of a newer writer may be longer, only their known fields are read; the values of version 1 end before p50
+    if (header.magic != XPUM_TELEMETRY_SNAPSHOT_MAGIC || header.size > size || header.headerSize < sizeof(header)
+        || header.metricSize < sizeof(xpum_telemetry_metric_t) || header.recordSize < sizeof(xpum_telemetry_record_t)
+        || header.valueSize < offsetof(xpum_telemetry_value_t, p50)
+        || header.headerSize + (uint64_t)header.metricCount * header.metricSize > header.size) {
+        (*json)["error"] = "Invalid telemetry snapshot";
+        (*json)["errno"] = XPUM_CLI_ERROR_GENERIC_ERROR;
+        return json;
+    }
+
+    std::vector<xpum_telemetry_metric_t> schema(header.metricCount);
+    const char* p = snapshot + header.headerSize;
+    for (auto& metric : schema) {
+        std::memcpy(&metric, p, sizeof(metric));
+        p += header.metricSize;
+    }
+
+    // the data of all devices is in a row, in the order of the devices
+    std::vector<int> ids;
+    std::map<int, DeviceStats> devices;
+    const char* snapshotEnd = snapshot + header.size;
+    for (uint32_t i = 0; i < header.recordCount; i++) {
+        xpum_telemetry_record_t record{};
+        if (p + header.recordSize > snapshotEnd) {
+            break;
+        }
+        std::memcpy(&record, p, sizeof(record));
+        p += header.recordSize;
+        if (p + (uint64_t)record.valueCount * header.valueSize > snapshotEnd) {
+            break;
+        }
+        int deviceId = record.deviceId;
+        if (record.type == XPUM_TELEMETRY_RECORD_STATS && devices.find(deviceId) == devices.end()) {
+            ids.push_back(deviceId);
+        }
+        DeviceStats& device = devices[deviceId];
+        device.deviceId = deviceId;
+        StatsEntry entry;
+        entry.tileId = record.tileId;
+        for (uint32_t j = 0; j < record.valueCount; j++) {
+            xpum_telemetry_value_t value{};
+            std::memcpy(&value, p, std::min<size_t>(sizeof(value), header.valueSize));
+            p += header.valueSize;
+            if (value.metricIndex >= schema.size()) {
+                continue;
+            }
+            if (record.type == XPUM_TELEMETRY_RECORD_STATS) {
+                MetricStats metric;
+                metric.metricsType = schema[value.metricIndex].metricsType;
+                metric.isCounter = schema[value.metricIndex].isCounter != 0;
+                metric.value = value.value;
+                metric.accumulated = value.accumulated;
+                metric.min = value.min;
+                metric.avg = value.avg;
+                metric.max = value.max;
+                metric.scale = value.scale;
+                metric.hasPercentiles = header.valueSize >= offsetof(xpum_telemetry_value_t, p99) + sizeof(value.p99);
+                metric.p50 = value.p50;
+                metric.p90 = value.p90;
+                metric.p99 = value.p99;
+                entry.metrics.push_back(metric);
+            } else if (record.type == XPUM_TELEMETRY_RECORD_ENGINE) {
+                EngineStats engine;
+                engine.tileId = record.tileId;
+                engine.type = (xpum_engine_type_t)record.subType;
+                engine.index = record.index;
+                engine.value = value.value;
+                engine.min = value.min;
+                engine.avg = value.avg;
+                engine.max = value.max;
+                engine.scale = value.scale;
+                device.engines.push_back(engine);
+            } else if (record.type == XPUM_TELEMETRY_RECORD_FABRIC) {
+                FabricStats fabric;
+                fabric.tileId = record.tileId;
+                fabric.remoteDeviceId = record.index;
+                fabric.remoteTileId = record.remoteTileId;
+                fabric.type = (xpum_fabric_throughput_type_t)record.subType;
+                fabric.value = value.value;
+                fabric.min = value.min;
+                fabric.avg = value.avg;
+                fabric.max = value.max;
+                fabric.scale = value.scale;
+                device.fabrics.push_back(fabric);
+                device.hasFabric = true;
+            }
+        }
+        if (record.type == XPUM_TELEMETRY_RECORD_STATS) {
+            device.entries.push_back(std::move(entry));
+        }
+    }
+
+    (*json)["begin"] = isotimestamp(header.begin);
+    (*json)["end"] = isotimestamp(header.end);
+    (*json)["elapsed_time"] = (header.end - header.begin) / 1000;
+    (*json)["datas"] = nlohmann::json::array();
+    for (auto deviceId : ids) {
+        nlohmann::json deviceJson;
+        deviceJson["begin"] = (*json)["begin"];
+        deviceJson["end"] = (*json)["end"];
+        deviceJson["elapsed_time"] = (*json)["elapsed_time"];
+        deviceStatsToJson(devices[deviceId], enableFilter, enableScale, deviceJson);
+        (*json)["datas"].push_back(std::move(deviceJson));
+    }
+    return json;
+}
 } // end namespace xpum::cli
@@ -40,6 +40,9 @@ class CoreStub {
 
     virtual std::unique_ptr<nlohmann::json> getDeviceProperties(const char *bdf, std::string username="", std::string password="")=0;
 
+    // the properties of all devices in "device_list", and their "engine_count" and "fabric_count" by device id
+    virtual std::unique_ptr<nlohmann::json> getAllDeviceProperties()=0;
+
     virtual std::unique_ptr<nlohmann::json> getSerailNumberAndAmcVersion(int deviceId, std::string username="", std::string password="")=0;
 
     virtual std::unique_ptr<nlohmann::json> getAMCFirmwareVersions(std::string username, std::string password)=0;
@@ -48,6 +51,7 @@ class CoreStub {
     virtual std::unique_ptr<nlohmann::json> getTopology(int deviceId)=0;
 
     virtual std::unique_ptr<nlohmann::json> groupCreate(std::string groupName)=0;
+    virtual std::unique_ptr<nlohmann::json> groupCreateBySelector(std::string groupName, const xpum_group_selector_t &selector)=0;
     virtual std::unique_ptr<nlohmann::json> groupDelete(int groupId)=0;
     virtual std::unique_ptr<nlohmann::json> groupListAll()=0;
     virtual std::unique_ptr<nlohmann::json> groupList(int groupId)=0;
@@ -74,6 +78,8 @@ class CoreStub {
 
     virtual std::unique_ptr<nlohmann::json> getStatistics(int deviceId, bool enableFilter = false, bool enableScale = false)=0;
     virtual std::unique_ptr<nlohmann::json> getStatisticsByGroup(uint32_t groupId, bool enableFilter = false, bool enableScale = false)=0;
+    // the statistics of the devices, all devices if deviceIds is empty, from the same samples in one call, in "datas"
+    virtual std::unique_ptr<nlohmann::json> getStatisticsBulk(std::vector<int> deviceIds, bool enableFilter = false, bool enableScale = false)=0;
     virtual std::shared_ptr<nlohmann::json> getEngineStatistics(int deviceId)=0;
     virtual std::shared_ptr<std::map<int, std::map<int, int>>> getEngineCount(int deviceId)=0;
     virtual std::shared_ptr<nlohmann::json> getFabricStatistics(int deviceId)=0;
@@ -86,6 +92,8 @@ class CoreStub {
     virtual std::unique_ptr<nlohmann::json> setDeviceFrequencyRange(int deviceId, int tileId, int minFreq, int maxFreq)=0;
     virtual std::unique_ptr<nlohmann::json> getDeviceProcessState(int deviceId)=0;
     virtual std::unique_ptr<nlohmann::json> getDeviceComponentOccupancyRatio(int deviceId, int tileId, int samplingInterval)=0;
+    virtual std::unique_ptr<nlohmann::json> getPerfMetrics(int deviceId, int tileId, uint32_t windowMs)=0;
+    virtual std::unique_ptr<nlohmann::json> getTopdownRatios(int deviceId, int tileId, uint32_t windowMs)=0;
     virtual std::unique_ptr<nlohmann::json> getDeviceUtilizationByProcess(int deviceId, int utilizationInterval)=0;
     virtual std::unique_ptr<nlohmann::json> getAllDeviceUtilizationByProcess(int utilizationInterval)=0;
     virtual std::unique_ptr<nlohmann::json> getPerformanceFactor(int deviceId, int tileId)=0;
@@ -111,7 +119,8 @@ class CoreStub {
     virtual std::unique_ptr<nlohmann::json> runFirmwareFlash(int deviceId, unsigned int type, const std::string& filePath, std::string username, std::string password, bool force=false)=0;
     virtual std::unique_ptr<nlohmann::json> getFirmwareFlashResult(int deviceId, unsigned int type)=0;
 
-    virtual std::unique_ptr<nlohmann::json> startDumpRawDataTask(uint32_t deviceId, int tileId, std::vector<xpum_dump_type_t> metricsTypeList, bool showDate=false)=0;
+    virtual std::unique_ptr<nlohmann::json> startDumpRawDataTask(uint32_t deviceId, int tileId, std::vector<xpum_dump_type_t> metricsTypeList, const xpum_dump_raw_data_option_t& option)=0;
+    virtual std::unique_ptr<nlohmann::json> startMultiDeviceDumpRawDataTask(std::vector<uint32_t> deviceIdList, std::vector<xpum_dump_type_t> metricsTypeList, const xpum_dump_raw_data_option_t& option)=0;
     virtual std::unique_ptr<nlohmann::json> stopDumpRawDataTask(int taskId)=0;
     virtual std::unique_ptr<nlohmann::json> listDumpRawDataTasks()=0;
     virtual std::unique_ptr<nlohmann::json> genDebugLog(const std::string &fileName) = 0;
@@ -120,14 +129,34 @@ class CoreStub {
 
     static std::string metricsTypeToString(xpum_stats_type_t metricsType);
 
+    static bool metricsTypeAllowList(xpum_stats_type_t metricsType);
+
+    static int32_t getCliScale(xpum_stats_type_t metricsType);
+
+    // the statistics in a snapshot of xpumGetTelemetrySnapshot, in the format of getStatisticsBulk
+    static std::unique_ptr<nlohmann::json> telemetrySnapshotToJson(const char* snapshot, size_t size, bool enableFilter, bool enableScale);
+
     virtual std::unique_ptr<nlohmann::json> setAgentConfig(std::string key, void* pValue)=0;
 
     virtual std::unique_ptr<nlohmann::json> getAgentConfig()=0;
 
+    virtual std::unique_ptr<nlohmann::json> getInternalStats()=0;
+
+    // read each sampled capability of the devices iterations times and measure what a sample costs
+    virtual std::unique_ptr<nlohmann::json> getSamplingCost(int deviceId, uint32_t iterations, double targetOverhead)=0;
+
+    // wait at most timeout ms for data the monitor stores after generation, which is then the generation of the
+    // latest store. False if the stores can not be followed.
+    virtual bool waitForMetricsUpdate(uint64_t* generation, uint32_t timeout)=0;
+
+    static std::string internalStatsTypeToString(xpum_internal_stats_type_t type);
+
     virtual std::string getTopoXMLBuffer()=0;
 
     virtual std::unique_ptr<nlohmann::json> getXelinkTopology()=0;
 
+    virtual std::unique_ptr<nlohmann::json> getPlacementAdvice(std::vector<int> deviceIds)=0;
+
     virtual std::shared_ptr<nlohmann::json> getFabricCount(int deviceId)=0;
 
     virtual std::unique_ptr<nlohmann::json> getSensorReading()=0;
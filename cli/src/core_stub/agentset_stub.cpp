@@ -6,7 +6,9 @@
 
 #include <nlohmann/json.hpp>
 #include <string>
+#include <vector>
 
+#include "exit_code.h"
 #include "lib_core_stub.h"
 #include "logger.h"
 #include "xpum_api.h"
@@ -73,4 +75,76 @@ std::unique_ptr<nlohmann::json> LibCoreStub::getAgentConfig() {
     auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
     return json;
 }
+
+std::unique_ptr<nlohmann::json> LibCoreStub::getInternalStats() {
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+
+    uint32_t count = 0;
+    xpum_result_t res = xpumGetInternalStats(nullptr, &count);
+    std::vector<xpum_internal_stats_t> dataList(count);
+    if (res == XPUM_OK) {
+        res = xpumGetInternalStats(dataList.data(), &count);
+    }
+    if (res != XPUM_OK) {
+        (*json)["error"] = "Error";
+        return json;
+    }
+
+    std::vector<nlohmann::json> statsList;
+    for (uint32_t i = 0; i < count; i++) {
+        auto& data = dataList[i];
+        nlohmann::json stats;
+        stats["type"] = internalStatsTypeToString(data.type);
+        stats["name"] = data.name;
+        stats["device_id"] = data.deviceId;
+        stats["count"] = data.count;
+        stats["error_count"] = data.errorCount;
+        stats["sum_ns"] = data.sum;
+        stats["max_ns"] = data.max;
+        stats["p50_ns"] = data.p50;
+        stats["p90_ns"] = data.p90;
+        stats["p99_ns"] = data.p99;
+        statsList.push_back(stats);
+    }
+    (*json)["internal_stats_list"] = statsList;
+    return json;
+}
+
+std::unique_ptr<nlohmann::json> LibCoreStub::getSamplingCost(int deviceId, uint32_t iterations, double targetOverhead) {
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+
+    uint32_t count = 0;
+    xpum_result_t res = xpumGetSamplingCost(deviceId, iterations, targetOverhead, nullptr, &count);
+    std::vector<xpum_sampling_cost_t> dataList(count);
+    if (res == XPUM_OK) {
+        res = xpumGetSamplingCost(deviceId, iterations, targetOverhead, dataList.data(), &count);
+    }
+    if (res != XPUM_OK) {
+        (*json)["error"] = res == XPUM_RESULT_DEVICE_NOT_FOUND ? "device not found" : "Error";
+        (*json)["errno"] = errorNumTranslate(res);
+        return json;
+    }
+
+    std::vector<nlohmann::json> costList;
+    for (uint32_t i = 0; i < count; i++) {
+        auto& data = dataList[i];
+        nlohmann::json cost;
+        cost["device_id"] = data.deviceId;
+        cost["name"] = data.name;
+        cost["samples"] = data.samples;
+        cost["error_count"] = data.errorCount;
+        cost["latency_ns"] = data.latency;
+        cost["max_latency_ns"] = data.maxLatency;
+        cost["cpu_time_ns"] = data.cpuTime;
+        cost["lock_wait_ns"] = data.lockWait;
+        cost["driver_time_ns"] = data.driverTime;
+        cost["driver_calls"] = data.driverCalls;
+        cost["current_interval_ms"] = data.currentInterval;
+        cost["recommended_interval_ms"] = data.recommendedInterval;
+        costList.push_back(cost);
+    }
+    (*json)["target_overhead"] = targetOverhead;
+    (*json)["sampling_cost_list"] = costList;
+    return json;
+}
 } // namespace xpum::cli
\ No newline at end of file
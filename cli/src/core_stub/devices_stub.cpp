@@ -58,23 +58,27 @@ static std::string scale(std::string value, int scale) {
     return std::to_string(fvalue);
 }
 
+static void propertiesToJson(const xpum_device_properties_t &data, nlohmann::json &json) {
+    for (int i = 0; i < data.propertyLen; i++) {
+        auto& p = data.properties[i];
+        std::string name = getXpumDevicePropertyNameString(p.name);
+        if (name.compare("MAX_FABRIC_PORT_SPEED") == 0) {
+            name = "max_fabric_port_speed";
+            json[name] = scale(p.value, 1048576);
+        } else {
+            std::transform(name.begin(), name.end(), name.begin(),
+                           [](unsigned char c) { return std::tolower(c); });
+            json[name] = p.value;
+        }
+    }
+}
+
 std::unique_ptr<nlohmann::json> LibCoreStub::getDeviceProperties(int deviceId, std::string username, std::string password) {
     auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
     xpum_device_properties_t data;
     auto res = xpumGetDeviceProperties(deviceId, &data);    
     if (res == XPUM_OK) {
-        for (int i = 0; i < data.propertyLen; i++) {
-            auto& p = data.properties[i];
-            std::string name = getXpumDevicePropertyNameString(p.name);
-            if (name.compare("MAX_FABRIC_PORT_SPEED") == 0) {
-                name = "max_fabric_port_speed";
-                (*json)[name] = scale(p.value, 1048576);
-            } else {
-                std::transform(name.begin(), name.end(), name.begin(),
-                               [](unsigned char c) { return std::tolower(c); });
-                (*json)[name] = p.value;
-            }
-        }
+        propertiesToJson(data, *json);
     } else {
         switch (res) {
             case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
@@ -96,6 +100,43 @@ std::unique_ptr<nlohmann::json> LibCoreStub::getDeviceProperties(int deviceId, s
     return json;
 }
 
+std::unique_ptr<nlohmann::json> LibCoreStub::getAllDeviceProperties() {
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+    int count = 0;
+    auto res = xpumGetAllDeviceProperties(nullptr, &count);
+    std::vector<xpum_device_properties_t> dataList(count);
+    if (res == XPUM_OK) {
+        res = xpumGetAllDeviceProperties(dataList.data(), &count);
+    }
+    if (res != XPUM_OK) {
+        if (res == XPUM_LEVEL_ZERO_INITIALIZATION_ERROR)
+            (*json)["error"] = "Level Zero Initialization Error";
+        else
+            (*json)["error"] = "Error";
+        (*json)["errno"] = errorNumTranslate(res);
+        return json;
+    }
+
+    (*json)["device_list"] = nlohmann::json::array();
+    for (int i = 0; i < count; i++) {
+        auto &data = dataList[i];
+        nlohmann::json deviceJson;
+        propertiesToJson(data, deviceJson);
+        deviceJson["device_id"] = data.deviceId;
+        (*json)["device_list"].push_back(deviceJson);
+
+        std::string deviceId = std::to_string(data.deviceId);
+        nlohmann::json engineCountJson = nlohmann::json::object();
+        for (auto &tile : *getEngineCount(data.deviceId)) {
+            for (auto &typeCount : tile.second)
+                engineCountJson[std::to_string(tile.first)][std::to_string(typeCount.first)] = typeCount.second;
+        }
+        (*json)["engine_count"][deviceId] = engineCountJson;
+        (*json)["fabric_count"][deviceId] = *getFabricCount(data.deviceId);
+    }
+    return json;
+}
+
 std::unique_ptr<nlohmann::json> LibCoreStub::getDeviceProperties(const char *bdf, std::string username, std::string password) {
     xpum_device_id_t deviceId = -1;
     // No need to check return value as "-1" covers the failure case
@@ -13,7 +13,13 @@
 
 namespace xpum::cli {
 
-std::unique_ptr<nlohmann::json> LibCoreStub::startDumpRawDataTask(uint32_t deviceId, int tileId, std::vector<xpum_dump_type_t> dumpTypeList, bool showDate) {
+std::unique_ptr<nlohmann::json> LibCoreStub::startDumpRawDataTask(uint32_t deviceId, int tileId, std::vector<xpum_dump_type_t> dumpTypeList, const xpum_dump_raw_data_option_t& option) {
+
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+
+    return json;
+}
+std::unique_ptr<nlohmann::json> LibCoreStub::startMultiDeviceDumpRawDataTask(std::vector<uint32_t> deviceIdList, std::vector<xpum_dump_type_t> dumpTypeList, const xpum_dump_raw_data_option_t& option) {
 
     auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
 
@@ -135,6 +135,11 @@ std::unique_ptr<nlohmann::json> LibCoreStub::groupCreate(std::string groupName)
     return json;
 }
 
+std::unique_ptr<nlohmann::json> LibCoreStub::groupCreateBySelector(std::string groupName, const xpum_group_selector_t &selector) {
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+    return json;
+}
+
 std::unique_ptr<nlohmann::json> LibCoreStub::groupDelete(int groupId) {
     auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
     return json;
@@ -1826,6 +1831,16 @@ std::unique_ptr<nlohmann::json> LibCoreStub::getDeviceComponentOccupancyRatio(in
     return json;
 }
 
+std::unique_ptr<nlohmann::json> LibCoreStub::getPerfMetrics(int deviceId, int tileId, uint32_t windowMs) {
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+    return json;
+}
+
+std::unique_ptr<nlohmann::json> LibCoreStub::getTopdownRatios(int deviceId, int tileId, uint32_t windowMs) {
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+    return json;
+}
+
 std::unique_ptr<nlohmann::json> LibCoreStub::getDeviceUtilizationByProcess(
         int deviceId, int utilizationInterval) {
     auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
@@ -1980,6 +1995,63 @@ std::unique_ptr<nlohmann::json> LibCoreStub::getXelinkTopology() {
     return json;
 }
 
+std::unique_ptr<nlohmann::json> LibCoreStub::getPlacementAdvice(std::vector<int> deviceIds) {
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+    std::vector<xpum_device_id_t> deviceIdList(deviceIds.begin(), deviceIds.end());
+    xpum_placement_advice_t advice;
+    xpum_result_t res = xpumGetPlacementAdvice(deviceIdList.data(), deviceIdList.size(), &advice);
+    if (res == XPUM_OK) {
+        std::vector<nlohmann::json> deviceJsonList;
+        for (int i = 0; i < advice.count; i++) {
+            auto& placement = advice.devices[i];
+            auto deviceJson = nlohmann::json();
+            deviceJson["device_id"] = placement.deviceId;
+            deviceJson["numa_index"] = placement.numaIdx;
+            deviceJson["cpu_affinity"] = placement.cpuAffinity;
+            deviceJson["tree_parent"] = placement.treeParent;
+            std::string linkType;
+            if (placement.nextLinkType == XPUM_LINK_SELF) {
+                linkType = "S";
+            } else if (placement.nextLinkType == XPUM_LINK_XE) {
+                linkType = "XL";
+            } else if (placement.nextLinkType == XPUM_LINK_SYS) {
+                linkType = "SYS";
+            } else if (placement.nextLinkType == XPUM_LINK_NODE) {
+                linkType = "NODE";
+            } else {
+                linkType = "Unknown";
+            }
+            deviceJson["next_link_type"] = linkType;
+            deviceJson["next_pcie_hops"] = placement.nextPcieHops;
+            deviceJsonList.push_back(deviceJson);
+        }
+        (*json)["device_list"] = deviceJsonList;
+        (*json)["cpu_list"] = advice.cpuList;
+        (*json)["numa_node_list"] = std::vector<int32_t>(advice.numaNodes, advice.numaNodes + advice.numaNodeCount);
+        (*json)["ring_xelink_hops"] = advice.ringXelinkHops;
+        (*json)["ring_pcie_hops"] = advice.ringPcieHops;
+        (*json)["ring_cross_numa_hops"] = advice.ringCrossNumaHops;
+    } else {
+        switch (res) {
+            case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
+                (*json)["error"] = "Level Zero Initialization Error";
+                break;
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+                (*json)["error"] = "Device not found";
+                break;
+            case XPUM_BUFFER_TOO_SMALL:
+                (*json)["error"] = "Too many devices";
+                break;
+            default:
+                (*json)["error"] = "Error";
+                break;
+        }
+        (*json)["errno"] = errorNumTranslate(res);
+    }
+
+    return json;
+}
+
 std::unique_ptr<nlohmann::json> LibCoreStub::runStress(int deviceId, uint32_t stressTime) {
     auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
     xpum_result_t res = xpumRunStress(deviceId, stressTime);
@@ -12,9 +12,11 @@
 #include <nlohmann/json.hpp>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "xpum_structs.h"
 #include "core_stub.h"
+#include "stats_model.h"
 
 namespace xpum::cli {
 
@@ -35,6 +37,8 @@ class LibCoreStub : public CoreStub {
 
     std::unique_ptr<nlohmann::json> getDeviceProperties(const char *bdf, std::string username="", std::string password="");
 
+    std::unique_ptr<nlohmann::json> getAllDeviceProperties();
+
     std::unique_ptr<nlohmann::json> getSerailNumberAndAmcVersion(int deviceId, std::string username="", std::string password="");
 
     std::unique_ptr<nlohmann::json> getAMCFirmwareVersions(std::string username, std::string password);
@@ -44,6 +48,7 @@ class LibCoreStub : public CoreStub {
     std::unique_ptr<nlohmann::json> getTopology(int deviceId);
 
     std::unique_ptr<nlohmann::json> groupCreate(std::string groupName);
+    std::unique_ptr<nlohmann::json> groupCreateBySelector(std::string groupName, const xpum_group_selector_t &selector);
     std::unique_ptr<nlohmann::json> groupDelete(int groupId);
     std::unique_ptr<nlohmann::json> groupListAll();
     std::unique_ptr<nlohmann::json> groupList(int groupId);
@@ -74,6 +79,7 @@ class LibCoreStub : public CoreStub {
 
     std::unique_ptr<nlohmann::json> getStatistics(int deviceId, bool enableFilter = false, bool enableScale = false);
     std::unique_ptr<nlohmann::json> getStatisticsByGroup(uint32_t groupId, bool enableFilter = false, bool enableScale = false);
+    std::unique_ptr<nlohmann::json> getStatisticsBulk(std::vector<int> deviceIds, bool enableFilter = false, bool enableScale = false);
     std::shared_ptr<nlohmann::json> getEngineStatistics(int deviceId);
     std::shared_ptr<std::map<int, std::map<int, int>>> getEngineCount(int deviceId);
     std::shared_ptr<nlohmann::json> getFabricStatistics(int deviceId);
@@ -86,6 +92,8 @@ class LibCoreStub : public CoreStub {
     std::unique_ptr<nlohmann::json> setDeviceFrequencyRange(int deviceId, int tileId, int minFreq, int maxFreq);
     std::unique_ptr<nlohmann::json> getDeviceProcessState(int deviceId);
     std::unique_ptr<nlohmann::json> getDeviceComponentOccupancyRatio(int deviceId, int tileId, int samplingInterval);
+    std::unique_ptr<nlohmann::json> getPerfMetrics(int deviceId, int tileId, uint32_t windowMs);
+    std::unique_ptr<nlohmann::json> getTopdownRatios(int deviceId, int tileId, uint32_t windowMs);
     std::unique_ptr<nlohmann::json> getDeviceUtilizationByProcess(int deviceId, int utilizationInterval);
     std::unique_ptr<nlohmann::json> getAllDeviceUtilizationByProcess(int utilizationInterval);
     std::unique_ptr<nlohmann::json> getPerformanceFactor(int deviceId, int tileId);
@@ -108,7 +116,8 @@ class LibCoreStub : public CoreStub {
     std::unique_ptr<nlohmann::json> runFirmwareFlash(int deviceId, unsigned int type, const std::string& filePath, std::string username, std::string password, bool force=false);
     std::unique_ptr<nlohmann::json> getFirmwareFlashResult(int deviceId, unsigned int type);
 
-    std::unique_ptr<nlohmann::json> startDumpRawDataTask(uint32_t deviceId, int tileId, std::vector<xpum_dump_type_t> metricsTypeList, bool showDate=false);
+    std::unique_ptr<nlohmann::json> startDumpRawDataTask(uint32_t deviceId, int tileId, std::vector<xpum_dump_type_t> metricsTypeList, const xpum_dump_raw_data_option_t& option);
+    std::unique_ptr<nlohmann::json> startMultiDeviceDumpRawDataTask(std::vector<uint32_t> deviceIdList, std::vector<xpum_dump_type_t> metricsTypeList, const xpum_dump_raw_data_option_t& option);
     std::unique_ptr<nlohmann::json> stopDumpRawDataTask(int taskId);
     std::unique_ptr<nlohmann::json> listDumpRawDataTasks();
 
@@ -116,10 +125,18 @@ class LibCoreStub : public CoreStub {
 
     std::unique_ptr<nlohmann::json> getAgentConfig();
 
+    std::unique_ptr<nlohmann::json> getInternalStats();
+
+    std::unique_ptr<nlohmann::json> getSamplingCost(int deviceId, uint32_t iterations, double targetOverhead);
+
+    bool waitForMetricsUpdate(uint64_t* generation, uint32_t timeout);
+
     std::string getTopoXMLBuffer();
 
     std::unique_ptr<nlohmann::json> getXelinkTopology();
 
+    std::unique_ptr<nlohmann::json> getPlacementAdvice(std::vector<int> deviceIds);
+
     std::shared_ptr<nlohmann::json> getFabricCount(int deviceId);
 
     std::unique_ptr<nlohmann::json> getSensorReading();
@@ -139,5 +156,13 @@ class LibCoreStub : public CoreStub {
 
     std::unique_ptr<nlohmann::json> getVfMetrics(int deviceId);
 
+   private:
+    // the errors in "error" and "errno", empty if the statistics are read or not supported
+    nlohmann::json readEngineStatistics(int deviceId, std::vector<EngineStats> &engines);
+
+    nlohmann::json readFabricStatistics(int deviceId, DeviceStats &stats);
+
+    // the buffer of xpumGetTelemetrySnapshot, reused by getStatisticsBulk
+    std::vector<char> snapshotBuffer;
 };
 } // end namespace xpum::cli
@@ -4,6 +4,7 @@
  *  @file statistics_stub.cpp
  */
 
+#include <algorithm>
 #include <nlohmann/json.hpp>
 #include <sstream>
 #include <vector>
@@ -17,53 +18,10 @@
 #include "lib_core_stub.h"
 #include "exit_code.h"
 #include "internal_api.h"
+#include "stats_model.h"
 
 namespace xpum::cli {
 
-inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
-    std::vector<xpum_stats_type_t> allowList{
-        XPUM_STATS_GPU_UTILIZATION,
-        XPUM_STATS_EU_ACTIVE,
-        XPUM_STATS_EU_STALL,
-        XPUM_STATS_EU_IDLE,
-        XPUM_STATS_POWER,
-        // XPUM_STATS_ENERGY,
-        XPUM_STATS_GPU_FREQUENCY,
-        XPUM_STATS_GPU_CORE_TEMPERATURE,
-        XPUM_STATS_MEMORY_USED,
-        XPUM_STATS_MEMORY_UTILIZATION,
-        XPUM_STATS_MEMORY_BANDWIDTH,
-        // XPUM_STATS_MEMORY_READ,
-        // XPUM_STATS_MEMORY_WRITE,
-        XPUM_STATS_MEMORY_READ_THROUGHPUT,
-        XPUM_STATS_MEMORY_WRITE_THROUGHPUT,
-        XPUM_STATS_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION,
-        XPUM_STATS_ENGINE_GROUP_MEDIA_ALL_UTILIZATION,
-        XPUM_STATS_ENGINE_GROUP_COPY_ALL_UTILIZATION,
-        XPUM_STATS_ENGINE_GROUP_RENDER_ALL_UTILIZATION,
-        // XPUM_STATS_ENGINE_GROUP_3D_ALL_UTILIZATION,
-        XPUM_STATS_RAS_ERROR_CAT_RESET,
-        XPUM_STATS_RAS_ERROR_CAT_PROGRAMMING_ERRORS,
-        XPUM_STATS_RAS_ERROR_CAT_DRIVER_ERRORS,
-        XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE,
-        XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE,
-        // XPUM_STATS_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE,
-        // XPUM_STATS_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE,
-        XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE,
-        XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE,
-        // XPUM_STATS_GPU_REQUEST_FREQUENCY,
-        XPUM_STATS_MEMORY_TEMPERATURE,
-        // XPUM_STATS_FREQUENCY_THROTTLE,
-        // XPUM_STATS_PCIE_READ_THROUGHPUT,
-        // XPUM_STATS_PCIE_WRITE_THROUGHPUT,
-        // XPUM_STATS_PCIE_READ,
-        // XPUM_STATS_PCIE_WRITE,
-        XPUM_STATS_ENGINE_UTILIZATION,
-        XPUM_STATS_MEDIA_ENGINE_FREQUENCY,
-    };
-    return std::find(allowList.begin(), allowList.end(), metricsType) != allowList.end();
-}
-
 std::shared_ptr<std::map<int, std::map<int, int>>> LibCoreStub::getEngineCount(int deviceId) {
     std::map<int, std::map<int, int>> m;
     xpum_device_id_t xpum_device_id = deviceId;
@@ -100,8 +58,8 @@ std::shared_ptr<nlohmann::json> LibCoreStub::getFabricCount(int deviceId) {
     return std::make_shared<nlohmann::json>(json);
 }
 
-std::shared_ptr<nlohmann::json> LibCoreStub::getEngineStatistics(int deviceId) {
-    nlohmann::json json;
+nlohmann::json LibCoreStub::readEngineStatistics(int deviceId, std::vector<EngineStats> &engines) {
+    nlohmann::json error;
     xpum_device_id_t xpum_device_id = deviceId;
     uint64_t sessionId = 0;
     uint32_t count = 128;
@@ -110,154 +68,96 @@ std::shared_ptr<nlohmann::json> LibCoreStub::getEngineStatistics(int deviceId) {
     xpum_result_t res = xpumGetEngineStats(xpum_device_id, dataList, &count, &begin, &end, sessionId);
     if (res != XPUM_OK) {
         if (res == XPUM_METRIC_NOT_SUPPORTED || res == XPUM_METRIC_NOT_ENABLED)
-            return std::make_shared<nlohmann::json>(json);
+            return error;
         switch (res) {
             case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
-                json["error"] = "Level Zero Initialization Error";
-                json["errno"] = errorNumTranslate(res);
+                error["error"] = "Level Zero Initialization Error";
+                error["errno"] = errorNumTranslate(res);
                 break;
             default:
-                json["error"] = "Error";
-                json["errno"] = errorNumTranslate(res);
+                error["error"] = "Error";
+                error["errno"] = errorNumTranslate(res);
                 break;
         }
-        return std::make_shared<nlohmann::json>(json);
+        return error;
     }
 
-    // engine data
     for (uint32_t i = 0; i < count; i++) {
-        xpum_device_engine_stats_t& engineInfo = dataList[i];
-        xpum_engine_type_t engineType = engineInfo.type;
-        nlohmann::json obj;
-        int32_t scale = engineInfo.scale;
-        if (scale == 1) {
-            obj["value"] = engineInfo.value;
-        } else {
-            obj["value"] = (double)engineInfo.value / scale;
-        }
-        obj["engine_id"] = engineInfo.index;
-        std::string tileId = engineInfo.isTileData ? std::to_string(engineInfo.tileId) : "device";
-        switch (engineType) {
-            case XPUM_ENGINE_TYPE_COMPUTE:
-                json[tileId]["compute"].push_back(obj);
-                break;
-            case XPUM_ENGINE_TYPE_RENDER:
-                json[tileId]["render"].push_back(obj);
-                break;
-            case XPUM_ENGINE_TYPE_DECODE:
-                json[tileId]["decoder"].push_back(obj);
-                break;
-            case XPUM_ENGINE_TYPE_ENCODE:
-                json[tileId]["encoder"].push_back(obj);
-                break;
-            case XPUM_ENGINE_TYPE_COPY:
-                json[tileId]["copy"].push_back(obj);
-                break;
-            case XPUM_ENGINE_TYPE_MEDIA_ENHANCEMENT:
-                json[tileId]["media_enhancement"].push_back(obj);
-                break;
-            case XPUM_ENGINE_TYPE_3D:
-                json[tileId]["3d"].push_back(obj);
-                break;
-            default:
-                break;
-        }
-    }
-    for (auto &item : json.items()) {
-        auto key = item.key();
-        auto &obj = json[key];
-        if (!obj.contains("compute")) {
-            obj["compute"] = nlohmann::json::array();
-        }
-        if (!obj.contains("render")) {
-            obj["render"] = nlohmann::json::array();
-        }
-        if (!obj.contains("decoder")) {
-            obj["decoder"] = nlohmann::json::array();
-        }
-        if (!obj.contains("encoder")) {
-            obj["encoder"] = nlohmann::json::array();
-        }
-        if (!obj.contains("copy")) {
-            obj["copy"] = nlohmann::json::array();
-        }
-        if (!obj.contains("media_enhancement")) {
-            obj["media_enhancement"] = nlohmann::json::array();
-        }
-        if (!obj.contains("3d")) {
-            obj["3d"] = nlohmann::json::array();
-        }
+        const xpum_device_engine_stats_t &engineInfo = dataList[i];
+        EngineStats engine;
+        engine.tileId = engineInfo.isTileData ? engineInfo.tileId : -1;
+        engine.type = engineInfo.type;
+        engine.index = engineInfo.index;
+        engine.value = engineInfo.value;
+        engine.min = engineInfo.min;
+        engine.avg = engineInfo.avg;
+        engine.max = engineInfo.max;
+        engine.scale = engineInfo.scale;
+        engines.push_back(engine);
     }
+    return error;
+}
 
-    return std::make_shared<nlohmann::json>(json);
+std::shared_ptr<nlohmann::json> LibCoreStub::getEngineStatistics(int deviceId) {
+    std::vector<EngineStats> engines;
+    auto error = readEngineStatistics(deviceId, engines);
+    if (!error.empty()) {
+        return std::make_shared<nlohmann::json>(error);
+    }
+    return std::make_shared<nlohmann::json>(engineStatsToJson(engines));
 }
 
-std::shared_ptr<nlohmann::json> LibCoreStub::getFabricStatistics(int deviceId) {
-    nlohmann::json json;
+nlohmann::json LibCoreStub::readFabricStatistics(int deviceId, DeviceStats &stats) {
+    nlohmann::json error;
     xpum_device_id_t xpum_device_id = deviceId;
     uint64_t sessionId = 0;
     uint32_t count;
     uint64_t begin, end;
     auto res = xpumGetFabricThroughputStats(xpum_device_id, nullptr, &count, &begin, &end, sessionId);
-    if (res != XPUM_OK) {
-        if (res == XPUM_METRIC_NOT_SUPPORTED || res == XPUM_METRIC_NOT_ENABLED)
-            return std::make_shared<nlohmann::json>(json);
-        switch (res) {
-            case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
-                json["error"] = "Level Zero Initialization Error";
-                json["errno"] = errorNumTranslate(res);
-                break;
-            default:
-                json["error"] = "Error";
-                json["errno"] = errorNumTranslate(res);
-                break;
+    if (res == XPUM_OK) {
+        std::vector<xpum_device_fabric_throughput_stats_t> dataList(count);
+        res = xpumGetFabricThroughputStats(xpum_device_id, dataList.data(), &count, &begin, &end, sessionId);
+        if (res == XPUM_OK) {
+            for (uint32_t i = 0; i < count; i++) {
+                const xpum_device_fabric_throughput_stats_t &fabricInfo = dataList[i];
+                FabricStats fabric;
+                fabric.tileId = fabricInfo.tile_id;
+                fabric.remoteDeviceId = fabricInfo.remote_device_id;
+                fabric.remoteTileId = fabricInfo.remote_device_tile_id;
+                fabric.type = fabricInfo.type;
+                fabric.value = fabricInfo.value;
+                fabric.min = fabricInfo.min;
+                fabric.avg = fabricInfo.avg;
+                fabric.max = fabricInfo.max;
+                fabric.scale = fabricInfo.scale;
+                stats.fabrics.push_back(fabric);
+            }
+            stats.hasFabric = true;
+            return error;
         }
-        return std::make_shared<nlohmann::json>(json);
     }
-    xpum_device_fabric_throughput_stats_t dataList[count];
-    res = xpumGetFabricThroughputStats(xpum_device_id, dataList, &count, &begin, &end, sessionId);
-    if (res != XPUM_OK) {
-        if (res == XPUM_METRIC_NOT_SUPPORTED || res == XPUM_METRIC_NOT_ENABLED)
-            return std::make_shared<nlohmann::json>(json);
-        switch (res) {
-            case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
-                json["error"] = "Level Zero Initialization Error";
-                json["errno"] = errorNumTranslate(res);
-                break;
-            default:
-                json["error"] = "Error";
-                json["errno"] = errorNumTranslate(res);
-                break;
-        }
-        return std::make_shared<nlohmann::json>(json);
+    if (res == XPUM_METRIC_NOT_SUPPORTED || res == XPUM_METRIC_NOT_ENABLED)
+        return error;
+    switch (res) {
+        case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
+            error["error"] = "Level Zero Initialization Error";
+            error["errno"] = errorNumTranslate(res);
+            break;
+        default:
+            error["error"] = "Error";
+            error["errno"] = errorNumTranslate(res);
+            break;
     }
+    return error;
+}
 
-    // fabric data
-    json["fabric_throughput"] = nlohmann::json::array();
-    for (uint32_t i = 0; i < count; i++) {
-        xpum_device_fabric_throughput_stats_t& fabricInfo = dataList[i];
-        nlohmann::json obj;
-        std::stringstream ss;
-        if (fabricInfo.type == XPUM_FABRIC_THROUGHPUT_TYPE_TRANSMITTED) {
-            ss << deviceId << "/" << fabricInfo.tile_id << "->" << fabricInfo.remote_device_id << "/" << fabricInfo.remote_device_tile_id;
-        } else if (fabricInfo.type == XPUM_FABRIC_THROUGHPUT_TYPE_RECEIVED) {
-            ss << fabricInfo.remote_device_id << "/" << fabricInfo.remote_device_tile_id << "->" << deviceId << "/" << fabricInfo.tile_id;
-        } else {
-            continue;
-        }
-
-        int32_t scale = fabricInfo.scale * 1000; // kB
-        if (scale == 1) {
-            obj["value"] = fabricInfo.value;
-        } else {
-            obj["value"] = round((double)fabricInfo.value / scale * 100) / 100;
-        }
-        obj["name"] = ss.str();
-        obj["tile_id"] = fabricInfo.tile_id;
-        json["fabric_throughput"].push_back(obj);
+std::shared_ptr<nlohmann::json> LibCoreStub::getFabricStatistics(int deviceId) {
+    DeviceStats stats;
+    auto error = readFabricStatistics(deviceId, stats);
+    if (!error.empty() || !stats.hasFabric) {
+        return std::make_shared<nlohmann::json>(error);
     }
-
-    return std::make_shared<nlohmann::json>(json);
+    return std::make_shared<nlohmann::json>(fabricStatsToJson(deviceId, stats.fabrics));
 }
 
 std::unique_ptr<nlohmann::json> LibCoreStub::getXelinkThroughputAndUtilMatrix(){
@@ -398,17 +298,6 @@ std::unique_ptr<nlohmann::json> LibCoreStub::getXelinkThroughputAndUtilMatrix(){
     return json;
 }
 
-static int32_t getCliScale(xpum_stats_type_t metricsType) {
-    switch (metricsType) {
-        case XPUM_STATS_ENERGY:
-            return 1000;
-        case XPUM_STATS_MEMORY_USED:
-            return 1048576;
-        default:
-            return 1;
-    }
-}
-
 std::unique_ptr<nlohmann::json> LibCoreStub::getStatistics(int deviceId, bool enableFilter, bool enableScale) {
     auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
     xpum_device_id_t xpum_device_id = deviceId;
@@ -435,71 +324,80 @@ std::unique_ptr<nlohmann::json> LibCoreStub::getStatistics(int deviceId, bool en
         return json;
     }
 
-    // get engine stats
-    auto engineStatsJson = getEngineStatistics(deviceId);
-    if (engineStatsJson->contains("error")) {
-        return std::make_unique<nlohmann::json>(*engineStatsJson);
+    DeviceStats stats;
+    stats.deviceId = deviceId;
+    auto error = readEngineStatistics(deviceId, stats.engines);
+    if (!error.empty()) {
+        return std::make_unique<nlohmann::json>(error);
     }
+    // the statistics are shown without the fabric throughput if it fails
+    readFabricStatistics(deviceId, stats);
 
-    // get fabric stats
-    auto fabricStatsJson = getFabricStatistics(deviceId);
-    if (!fabricStatsJson->contains("error") && !fabricStatsJson->empty()) {
-        json->update(*fabricStatsJson);
-        // return std::make_unique<nlohmann::json>(*fabricStatsJson);
+    for (uint32_t i = 0; i < count; i++) {
+        const xpum_device_stats_t &statsInfo = dataList[i];
+        StatsEntry entry;
+        entry.tileId = statsInfo.isTileData ? statsInfo.tileId : -1;
+        for (int j = 0; j < statsInfo.count; j++) {
+            const xpum_device_stats_data_t &statsData = statsInfo.dataList[j];
+            MetricStats metric;
+            metric.metricsType = statsData.metricsType;
+            metric.isCounter = statsData.isCounter;
+            metric.value = statsData.value;
+            metric.accumulated = statsData.accumulated;
+            metric.min = statsData.min;
+            metric.avg = statsData.avg;
+            metric.max = statsData.max;
+            metric.scale = statsData.scale;
+            metric.hasPercentiles = true;
+            metric.p50 = statsData.p50;
+            metric.p90 = statsData.p90;
+            metric.p99 = statsData.p99;
+            entry.metrics.push_back(metric);
+        }
+        stats.entries.push_back(std::move(entry));
     }
 
-    std::vector<nlohmann::json> deviceLevelStatsDataList;
-    std::vector<nlohmann::json> tileLevelStatsDataList;
+    (*json)["begin"] = isotimestamp(begin);
+    (*json)["end"] = isotimestamp(end);
+    (*json)["elapsed_time"] = (end - begin) / 1000;
+    deviceStatsToJson(stats, enableFilter, enableScale, *json);
+    return json;
+}
 
-    for (uint32_t i = 0; i < count; i++) {
-        xpum_device_stats_t& stats_info = dataList[i];
-        std::vector<nlohmann::json> dataList;
-        for (int j = 0; j < stats_info.count; j++) {
-            xpum_device_stats_data_t& stats_data = stats_info.dataList[j];
-            if (enableFilter && !metricsTypeAllowList(stats_data.metricsType))
-                continue;
-            auto tmp = nlohmann::json();
-            xpum_stats_type_t metricsType = stats_data.metricsType;
-            tmp["metrics_type"] = metricsTypeToString(metricsType);
-            int32_t cliScale = getCliScale(metricsType);
-            int32_t scale = enableScale ? stats_data.scale * cliScale : stats_data.scale;
-            if (scale == 1) {
-                tmp["value"] = stats_data.value;
-                if (stats_data.isCounter) {
-                    tmp["value"] = stats_data.accumulated;
-                }
-            } else {
-                tmp["value"] = (double)stats_data.value / scale;
-                if (stats_data.isCounter) {
-                    tmp["value"] = (double)stats_data.accumulated / scale;
-                }
-            }
-            dataList.push_back(tmp);
-        }
-        if (stats_info.isTileData) {
-            auto tmp = nlohmann::json();
-            tmp["tile_id"] = stats_info.tileId;
-            tmp["data_list"] = dataList;
-            auto strTileId = std::to_string(stats_info.tileId);
-            if (engineStatsJson->contains(strTileId)) {
-                tmp["engine_util"] = (*engineStatsJson)[strTileId];
-            }
-            tileLevelStatsDataList.push_back(tmp);
-        } else {
-            deviceLevelStatsDataList.insert(deviceLevelStatsDataList.end(), dataList.begin(), dataList.end());
+std::unique_ptr<nlohmann::json> LibCoreStub::getStatisticsBulk(std::vector<int> deviceIds, bool enableFilter, bool enableScale) {
+    std::vector<xpum_device_id_t> deviceIdList(deviceIds.begin(), deviceIds.end());
+    uint32_t size = snapshotBuffer.size();
+    xpum_result_t res = XPUM_OK;
+    if (size == 0) {
+        res = xpumGetTelemetrySnapshot(deviceIdList.data(), deviceIdList.size(), nullptr, &size, 0);
+    }
+    if (res == XPUM_OK) {
+        // the buffer is kept for the next calls and only grows with the snapshot
+        snapshotBuffer.resize(std::max<size_t>(snapshotBuffer.size(), size));
+        size = snapshotBuffer.size();
+        res = xpumGetTelemetrySnapshot(deviceIdList.data(), deviceIdList.size(), snapshotBuffer.data(), &size, 0);
+        if (res == XPUM_BUFFER_TOO_SMALL) {
+            snapshotBuffer.resize(size);
+            res = xpumGetTelemetrySnapshot(deviceIdList.data(), deviceIdList.size(), snapshotBuffer.data(), &size, 0);
         }
     }
-
-    if (engineStatsJson->contains("device")) {
-        (*json)["engine_util"] = (*engineStatsJson)["device"];
+    if (res != XPUM_OK) {
+        auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+        switch (res) {
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+                (*json)["error"] = "device not found";
+                break;
+            case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
+                (*json)["error"] = "Level Zero Initialization Error";
+                break;
+            default:
+                (*json)["error"] = "Error";
+                break;
+        }
+        (*json)["errno"] = errorNumTranslate(res);
+        return json;
     }
-    (*json)["device_level"] = deviceLevelStatsDataList;
-    if (tileLevelStatsDataList.size() > 0)
-        (*json)["tile_level"] = tileLevelStatsDataList;
-
-    (*json)["device_id"] = deviceId;
-
-    return json;
+    return telemetrySnapshotToJson(snapshotBuffer.data(), size, enableFilter, enableScale);
 }
 
 std::unique_ptr<nlohmann::json> LibCoreStub::getStatisticsByGroup(uint32_t groupId, bool enableFilter, bool enableScale) {
@@ -595,4 +493,10 @@ std::vector<std::unique_ptr<nlohmann::json>> LibCoreStub::getMetricsFromSysfs(st
     }
     return ret;
 }
+
+bool LibCoreStub::waitForMetricsUpdate(uint64_t* generation, uint32_t timeout) {
+    xpum_result_t res = xpumWaitForMetricsUpdate(generation, timeout);
+    // XPUM_GENERIC_ERROR is a timeout
+    return res == XPUM_OK || res == XPUM_GENERIC_ERROR;
+}
 } // end namespace xpum::cli
@@ -6,6 +6,7 @@
 
 #include <nlohmann/json.hpp>
 #include <string>
+#include <vector>
 
 #include "core.grpc.pb.h"
 #include "core.pb.h"
@@ -161,4 +162,93 @@ std::unique_ptr<nlohmann::json> GrpcCoreStub::getAgentConfig() {
 
     return getAgentConfigJsonOBject(response.entrylist().configentries());
 }
+
+std::unique_ptr<nlohmann::json> GrpcCoreStub::getInternalStats() {
+    assert(this->stub != nullptr);
+
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+
+    grpc::ClientContext context;
+    InternalStatsResponse response;
+
+    grpc::Status status = stub->getInternalStats(&context, google::protobuf::Empty(), &response);
+
+    if (!status.ok()) {
+        (*json)["error"] = status.error_message();
+        (*json)["errno"] = XPUM_CLI_ERROR_GENERIC_ERROR;
+        return json;
+    }
+
+    if (response.errormsg().length() != 0) {
+        (*json)["error"] = response.errormsg();
+        (*json)["errno"] = errorNumTranslate(response.errorno());
+        return json;
+    }
+
+    std::vector<nlohmann::json> statsList;
+    for (auto& data : response.datalist()) {
+        nlohmann::json stats;
+        stats["type"] = internalStatsTypeToString((xpum_internal_stats_type_t)data.type().value());
+        stats["name"] = data.name();
+        stats["device_id"] = data.deviceid();
+        stats["count"] = data.count();
+        stats["error_count"] = data.errorcount();
+        stats["sum_ns"] = data.sum();
+        stats["max_ns"] = data.max();
+        stats["p50_ns"] = data.p50();
+        stats["p90_ns"] = data.p90();
+        stats["p99_ns"] = data.p99();
+        statsList.push_back(stats);
+    }
+    (*json)["internal_stats_list"] = statsList;
+    return json;
+}
+
+std::unique_ptr<nlohmann::json> GrpcCoreStub::getSamplingCost(int deviceId, uint32_t iterations, double targetOverhead) {
+    assert(this->stub != nullptr);
+
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+
+    grpc::ClientContext context;
+    SamplingCostRequest request;
+    request.set_deviceid(deviceId);
+    request.set_iterations(iterations);
+    request.set_targetoverhead(targetOverhead);
+    SamplingCostResponse response;
+
+    grpc::Status status = stub->getSamplingCost(&context, request, &response);
+
+    if (!status.ok()) {
+        (*json)["error"] = status.error_message();
+        (*json)["errno"] = XPUM_CLI_ERROR_GENERIC_ERROR;
+        return json;
+    }
+
+    if (response.errormsg().length() != 0) {
+        (*json)["error"] = response.errormsg();
+        (*json)["errno"] = errorNumTranslate(response.errorno());
+        return json;
+    }
+
+    std::vector<nlohmann::json> costList;
+    for (auto& data : response.datalist()) {
+        nlohmann::json cost;
+        cost["device_id"] = data.deviceid();
+        cost["name"] = data.name();
+        cost["samples"] = data.samples();
+        cost["error_count"] = data.errorcount();
+        cost["latency_ns"] = data.latency();
+        cost["max_latency_ns"] = data.maxlatency();
+        cost["cpu_time_ns"] = data.cputime();
+        cost["lock_wait_ns"] = data.lockwait();
+        cost["driver_time_ns"] = data.drivertime();
+        cost["driver_calls"] = data.drivercalls();
+        cost["current_interval_ms"] = data.currentinterval();
+        cost["recommended_interval_ms"] = data.recommendedinterval();
+        costList.push_back(cost);
+    }
+    (*json)["target_overhead"] = targetOverhead;
+    (*json)["sampling_cost_list"] = costList;
+    return json;
+}
 } // namespace xpum::cli
\ No newline at end of file
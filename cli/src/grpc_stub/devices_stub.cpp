@@ -56,6 +56,21 @@ static std::string scale(std::string value, int scale) {
     return std::to_string(fvalue);
 }
 
+static void propertiesToJson(const XpumDeviceProperties &response, nlohmann::json &json) {
+    for (int i{0}; i < response.properties_size(); ++i) {
+        auto &p = response.properties(i);
+        std::string name = p.name();
+        if (name.compare("MAX_FABRIC_PORT_SPEED") == 0) {
+            name = "max_fabric_port_speed";
+            json[name] = scale(p.value(), 1048576);
+        } else {
+            std::transform(name.begin(), name.end(), name.begin(),
+                           [](unsigned char c) { return std::tolower(c); });
+            json[name] = p.value();
+        }
+    }
+}
+
 std::unique_ptr<nlohmann::json> GrpcCoreStub::getDeviceProperties(int deviceId, std::string username, std::string password) {
     assert(this->stub != nullptr);
 
@@ -79,19 +94,62 @@ std::unique_ptr<nlohmann::json> GrpcCoreStub::getDeviceProperties(int deviceId,
         return json;
     }
 
-    for (int i{0}; i < response.properties_size(); ++i) {
-        auto &p = response.properties(i);
-        std::string name = p.name();
-        if (name.compare("MAX_FABRIC_PORT_SPEED") == 0) {
-            name = "max_fabric_port_speed";
-            (*json)[name] = scale(p.value(), 1048576);
-        } else {
-            std::transform(name.begin(), name.end(), name.begin(),
-                           [](unsigned char c) { return std::tolower(c); });
-            (*json)[name] = p.value();
+    propertiesToJson(response, *json);
+    (*json)["device_id"] = deviceId;
+
+    return json;
+}
+
+std::unique_ptr<nlohmann::json> GrpcCoreStub::getAllDeviceProperties() {
+    assert(this->stub != nullptr);
+
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+
+    grpc::ClientContext context;
+    GetAllDevicePropertiesResponse response;
+    grpc::Status status = stub->getAllDeviceProperties(&context, google::protobuf::Empty(), &response);
+
+    if (!status.ok()) {
+        (*json)["error"] = status.error_message();
+        (*json)["errno"] = XPUM_CLI_ERROR_GENERIC_ERROR;
+        return json;
+    }
+
+    if (response.errormsg().length() != 0) {
+        (*json)["error"] = response.errormsg();
+        (*json)["errno"] = errorNumTranslate(response.errorno());
+        return json;
+    }
+
+    (*json)["device_list"] = nlohmann::json::array();
+    for (auto &device : response.devices()) {
+        nlohmann::json deviceJson;
+        propertiesToJson(device.properties(), deviceJson);
+        deviceJson["device_id"] = device.deviceid();
+        (*json)["device_list"].push_back(deviceJson);
+
+        std::string deviceId = std::to_string(device.deviceid());
+        nlohmann::json engineCountJson = nlohmann::json::object();
+        for (auto &tileInfo : device.enginecountlist()) {
+            std::string tileId = std::to_string(tileInfo.istilelevel() ? tileInfo.tileid() : -1);
+            for (auto &countInfo : tileInfo.datalist())
+                engineCountJson[tileId][std::to_string(countInfo.enginetype())] = countInfo.count();
         }
+        (*json)["engine_count"][deviceId] = engineCountJson;
+
+        nlohmann::json fabricCountJson = nlohmann::json::object();
+        for (auto &tileInfo : device.fabriccountlist()) {
+            std::string tileId = tileInfo.istilelevel() ? std::to_string(tileInfo.tileid()) : "device";
+            for (auto &countInfo : tileInfo.datalist()) {
+                nlohmann::json obj;
+                obj["tile_id"] = countInfo.tileid();
+                obj["remote_device_id"] = countInfo.remotedeviceid();
+                obj["remote_tile_id"] = countInfo.remotetileid();
+                fabricCountJson[tileId].push_back(obj);
+            }
+        }
+        (*json)["fabric_count"][deviceId] = fabricCountJson;
     }
-    (*json)["device_id"] = deviceId;
 
     return json;
 }
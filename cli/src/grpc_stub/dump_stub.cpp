@@ -16,7 +16,21 @@
 
 namespace xpum::cli {
 
-std::unique_ptr<nlohmann::json> GrpcCoreStub::startDumpRawDataTask(uint32_t deviceId, int tileId, std::vector<xpum_dump_type_t> dumpTypeList, bool showDate) {
+static void setDumpOption(StartDumpRawDataTaskRequest& request, const xpum_dump_raw_data_option_t& option) {
+    request.set_showdate(option.showDate);
+    request.set_format(option.format);
+    request.set_layout(option.layout);
+    request.set_rotatesize(option.rotateSize);
+    request.set_rotateinterval(option.rotateInterval);
+    request.set_maxfiles(option.maxFiles);
+    request.set_compress(option.compress);
+    request.set_triggered(option.triggered);
+    request.set_pretriggertime(option.preTriggerTime);
+    request.set_posttriggertime(option.postTriggerTime);
+    request.set_triggermask(option.triggerMask);
+}
+
+std::unique_ptr<nlohmann::json> GrpcCoreStub::startDumpRawDataTask(uint32_t deviceId, int tileId, std::vector<xpum_dump_type_t> dumpTypeList, const xpum_dump_raw_data_option_t& option) {
     assert(this->stub != nullptr);
 
     auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
@@ -30,7 +44,7 @@ std::unique_ptr<nlohmann::json> GrpcCoreStub::startDumpRawDataTask(uint32_t devi
         auto p_enum = request.add_metricstypelist();
         p_enum->set_value(dumpType);
     }
-    request.set_showdate(showDate);
+    setDumpOption(request, option);
 
     grpc::Status status = stub->startDumpRawDataTask(&context, request, &response);
 
@@ -61,6 +75,54 @@ std::unique_ptr<nlohmann::json> GrpcCoreStub::startDumpRawDataTask(uint32_t devi
 
     return json;
 }
+std::unique_ptr<nlohmann::json> GrpcCoreStub::startMultiDeviceDumpRawDataTask(std::vector<uint32_t> deviceIdList, std::vector<xpum_dump_type_t> dumpTypeList, const xpum_dump_raw_data_option_t& option) {
+    assert(this->stub != nullptr);
+
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+
+    grpc::ClientContext context;
+    StartDumpRawDataTaskRequest request;
+    StartDumpRawDataTaskResponse response;
+    request.set_deviceid(deviceIdList.empty() ? 0 : deviceIdList[0]);
+    request.set_tileid(-1);
+    for (auto id : deviceIdList) {
+        request.add_deviceidlist(id);
+    }
+    for (int dumpType : dumpTypeList) {
+        auto p_enum = request.add_metricstypelist();
+        p_enum->set_value(dumpType);
+    }
+    setDumpOption(request, option);
+
+    grpc::Status status = stub->startDumpRawDataTask(&context, request, &response);
+
+    if (!status.ok()) {
+        (*json)["error"] = status.error_message();
+        (*json)["errno"] = XPUM_CLI_ERROR_GENERIC_ERROR;
+        XPUM_LOG_AUDIT("Failed to start dump raw data task on %d devices", (int)deviceIdList.size());
+        return json;
+    }
+
+    if (response.errormsg().length() != 0) {
+        (*json)["error"] = response.errormsg();
+        (*json)["errno"] = errorNumTranslate(response.errorno());
+        XPUM_LOG_AUDIT("Failed to start dump raw data task on %d devices", (int)deviceIdList.size());
+        return json;
+    }
+
+    auto taskInfo = response.taskinfo();
+
+    int taskId = taskInfo.dumptaskid();
+
+    std::string dumpFilePath = taskInfo.dumpfilepath();
+
+    (*json)["task_id"] = taskId;
+    (*json)["dump_file_path"] = dumpFilePath;
+
+    XPUM_LOG_AUDIT("Succeed to start dump raw data task %d on %d devices, file path: %s", taskId, (int)deviceIdList.size(), dumpFilePath.c_str());
+
+    return json;
+}
 std::unique_ptr<nlohmann::json> GrpcCoreStub::stopDumpRawDataTask(int taskId) {
     assert(this->stub != nullptr);
 
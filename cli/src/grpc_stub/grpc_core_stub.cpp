@@ -38,10 +38,19 @@ GrpcCoreStub::GrpcCoreStub(bool priv) {
     std::string serverAddr{"unix://" + unixSockName};
     grpc::ChannelArguments args;
     args.SetInt(GRPC_ARG_ENABLE_HTTP_PROXY, 0);
+    // xpumd rate limits the clients by peer and user agent
+    args.SetUserAgentPrefix("xpu-smi");
     this->channel = grpc::CreateCustomChannel(serverAddr, grpc::InsecureChannelCredentials(), args);
     this->stub = XpumCoreService::NewStub(this->channel);
 }
 
+GrpcCoreStub::~GrpcCoreStub() {
+    if (updateReader.joinable()) {
+        updateContext->TryCancel();
+        updateReader.join();
+    }
+}
+
 bool GrpcCoreStub::isChannelReady() {
     grpc::ClientContext context;
     XpumVersionInfoArray response;
@@ -186,6 +195,81 @@ std::unique_ptr<nlohmann::json> GrpcCoreStub::groupCreate(std::string groupName)
     return json;
 }
 
+// the conditions of the selector of a dynamic group, empty for the other groups
+static std::string groupSelectorToString(const GroupSelector &selector) {
+    std::vector<std::string> conditions;
+    if (selector.flags() & XPUM_GROUP_SELECTOR_MODEL) {
+        conditions.push_back("model=" + selector.model());
+    }
+    if (selector.flags() & XPUM_GROUP_SELECTOR_NUMA_NODE) {
+        conditions.push_back("numa=" + std::to_string(selector.numanode()));
+    }
+    if (selector.flags() & XPUM_GROUP_SELECTOR_PCIE_SWITCH) {
+        conditions.push_back("pcie-switch=" + selector.pcieswitch());
+    }
+    if (selector.flags() & XPUM_GROUP_SELECTOR_FUNCTION_TYPE) {
+        conditions.push_back(std::string("function-type=") + (selector.functiontype() == DEVICE_FUNCTION_TYPE_PHYSICAL ? "physical" : "virtual"));
+    }
+    if (selector.flags() & XPUM_GROUP_SELECTOR_POD) {
+        conditions.push_back("pod=" + selector.poduid());
+    }
+    if (selector.flags() & XPUM_GROUP_SELECTOR_HEALTH) {
+        conditions.push_back(std::string("health=") + (selector.healthstatus() == XPUM_HEALTH_STATUS_CRITICAL ? "critical" : "warning"));
+    }
+    if (selector.flags() & XPUM_GROUP_SELECTOR_THROTTLED) {
+        conditions.push_back("throttled");
+    }
+    std::string str;
+    for (auto &condition : conditions) {
+        str += (str.empty() ? "" : ",") + condition;
+    }
+    return str;
+}
+
+std::unique_ptr<nlohmann::json> GrpcCoreStub::groupCreateBySelector(std::string groupName, const xpum_group_selector_t &selector) {
+    assert(this->stub != nullptr);
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+    grpc::ClientContext context;
+    GroupInfo response;
+    GroupCreateBySelectorRequest request;
+    request.set_name(groupName);
+    GroupSelector *p_selector = request.mutable_selector();
+    p_selector->set_flags(selector.flags);
+    p_selector->set_model(selector.model);
+    p_selector->set_numanode(selector.numaNode);
+    p_selector->set_pcieswitch(selector.pcieSwitch);
+    p_selector->set_functiontype(selector.functionType);
+    p_selector->set_poduid(selector.podUid);
+    p_selector->set_healthstatus(selector.healthStatus);
+    grpc::Status status = stub->groupCreateBySelector(&context, request, &response);
+    if (status.ok()) {
+        if (response.errormsg().length() == 0) {
+            XPUM_LOG_AUDIT("Succeed to create dynamic group %d,%s", response.id(), groupName.c_str());
+            (*json)["group_id"] = response.id();
+            (*json)["group_name"] = response.groupname();
+            (*json)["device_count"] = response.count();
+
+            std::vector<int32_t> deviceIdList;
+            for (uint32_t j{0}; j < response.count(); ++j) {
+                deviceIdList.push_back(response.devicelist(j).id());
+            }
+
+            (*json)["device_id_list"] = deviceIdList;
+            (*json)["selector"] = groupSelectorToString(response.selector());
+        } else {
+            XPUM_LOG_AUDIT("Fail to create dynamic group %s", groupName.c_str());
+            (*json)["error"] = response.errormsg();
+            (*json)["errno"] = errorNumTranslate(response.errorno());
+        }
+
+    } else {
+        XPUM_LOG_AUDIT("Fail to create dynamic group %s", groupName.c_str());
+        (*json)["error"] = status.error_message();
+        (*json)["errno"] = XPUM_CLI_ERROR_GENERIC_ERROR;
+    }
+    return json;
+}
+
 std::unique_ptr<nlohmann::json> GrpcCoreStub::groupDelete(int groupId) {
     assert(this->stub != nullptr);
     auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
@@ -233,6 +317,9 @@ std::unique_ptr<nlohmann::json> GrpcCoreStub::groupListAll() {
                 }
 
                 groupJson["device_id_list"] = deviceIdList;
+                if (response.grouplist(i).selector().flags() != 0) {
+                    groupJson["selector"] = groupSelectorToString(response.grouplist(i).selector());
+                }
 
                 groupJsonList.push_back(groupJson);
             }
@@ -269,7 +356,9 @@ std::unique_ptr<nlohmann::json> GrpcCoreStub::groupList(int groupId) {
             }
 
             (*json)["device_id_list"] = deviceIdList;
-
+            if (response.selector().flags() != 0) {
+                (*json)["selector"] = groupSelectorToString(response.selector());
+            }
         } else {
             (*json)["error"] = response.errormsg();
             (*json)["errno"] = errorNumTranslate(response.errorno());
@@ -1266,6 +1355,15 @@ std::string GrpcCoreStub::policyConditionTypeEnumToString(XpumPolicyConditionTyp
         case POLICY_CONDITION_TYPE_WHEN_INCREASE:
             ret = "2. When occur";
             break;
+        case POLICY_CONDITION_TYPE_SUSTAINED_GREATER:
+            ret = "4. Sustained more than";
+            break;
+        case POLICY_CONDITION_TYPE_RATE_GREATER:
+            ret = "5. Rate more than";
+            break;
+        case POLICY_CONDITION_TYPE_EWMA_GREATER:
+            ret = "6. EWMA more than";
+            break;
         default:
             break;
     }
@@ -2105,6 +2203,39 @@ std::unique_ptr<nlohmann::json> GrpcCoreStub::getDeviceProcessState(int deviceId
     return json;
 }
 
+static void componentOccupancyRatiosToJson(const DeviceComponentOccupancyRatioResponse& response, int deviceId, nlohmann::json& json) {
+    std::vector<nlohmann::json> tileJsonList;
+    for (uint i{0}; i < response.tilecount(); ++i) {
+        auto tileJson = nlohmann::json();
+        tileJson["not_in_use"] = response.componentoccupancylist(i).notinuse();
+        tileJson["workload"] = response.componentoccupancylist(i).workload();
+        tileJson["engine"] = response.componentoccupancylist(i).engine();
+        tileJson["in_use"] = response.componentoccupancylist(i).inuse();
+        tileJson["active"] = response.componentoccupancylist(i).active();
+        tileJson["alu_active"] = response.componentoccupancylist(i).aluactive();
+        tileJson["xmx_active"] = response.componentoccupancylist(i).xmxactive();
+        tileJson["xmx_only"] = response.componentoccupancylist(i).xmxonly();
+        tileJson["xmx_fpu_active"] = response.componentoccupancylist(i).xmxfpuactive();
+        tileJson["fpu_without_xmx"] = response.componentoccupancylist(i).fpuwithoutxmx();
+        tileJson["fpu_only"] = response.componentoccupancylist(i).fpuonly();
+        tileJson["em_fpu_active"] = response.componentoccupancylist(i).emfpuactive();
+        tileJson["em_int_only"] = response.componentoccupancylist(i).emintonly();
+        tileJson["other"] = response.componentoccupancylist(i).other();
+        tileJson["stall"] = response.componentoccupancylist(i).stall();
+        tileJson["non_occupancy"] = response.componentoccupancylist(i).nonoccupancy();
+        tileJson["stall_alu"] = response.componentoccupancylist(i).stallalu();
+        tileJson["stall_barrier"] = response.componentoccupancylist(i).stallbarrier();
+        tileJson["stall_dep"] = response.componentoccupancylist(i).stalldep();
+        tileJson["stall_other"] = response.componentoccupancylist(i).stallother();
+        tileJson["stall_inst_fetch"] = response.componentoccupancylist(i).stallinstfetch();
+        tileJson["tile_id"] = response.componentoccupancylist(i).tileid();
+
+        tileJsonList.push_back(tileJson);
+    }
+    json["device_id"] = std::to_string(deviceId);
+    json["tile_json_list"] = tileJsonList;
+}
+
 std::unique_ptr<nlohmann::json> GrpcCoreStub::getDeviceComponentOccupancyRatio(int deviceId, int tileId, int samplingInterval) {
     assert(this->stub != nullptr);
     auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
@@ -2125,41 +2256,87 @@ std::unique_ptr<nlohmann::json> GrpcCoreStub::getDeviceComponentOccupancyRatio(i
     grpc::Status status = stub->getDeviceComponentOccupancyRatio(&context, request, &response);
     if (status.ok()) {
         if (response.errormsg().length() == 0) {
-            std::vector<nlohmann::json> tileJsonList;
-            for (uint i{0}; i < response.tilecount(); ++i) {
-                auto tileJson = nlohmann::json();
-                tileJson["not_in_use"] = response.componentoccupancylist(i).notinuse();
-                tileJson["workload"] = response.componentoccupancylist(i).workload();
-                tileJson["engine"] = response.componentoccupancylist(i).engine();
-                tileJson["in_use"] = response.componentoccupancylist(i).inuse();
-                tileJson["active"] = response.componentoccupancylist(i).active();
-                tileJson["alu_active"] = response.componentoccupancylist(i).aluactive();
-                tileJson["xmx_active"] = response.componentoccupancylist(i).xmxactive();
-                tileJson["xmx_only"] = response.componentoccupancylist(i).xmxonly();
-                tileJson["xmx_fpu_active"] = response.componentoccupancylist(i).xmxfpuactive();
-                tileJson["fpu_without_xmx"] = response.componentoccupancylist(i).fpuwithoutxmx();
-                tileJson["fpu_only"] = response.componentoccupancylist(i).fpuonly();
-                tileJson["em_fpu_active"] = response.componentoccupancylist(i).emfpuactive();
-                tileJson["em_int_only"] = response.componentoccupancylist(i).emintonly();
-                tileJson["other"] = response.componentoccupancylist(i).other();
-                tileJson["stall"] = response.componentoccupancylist(i).stall();
-                tileJson["non_occupancy"] = response.componentoccupancylist(i).nonoccupancy();
-                tileJson["stall_alu"] = response.componentoccupancylist(i).stallalu();
-                tileJson["stall_barrier"] = response.componentoccupancylist(i).stallbarrier();
-                tileJson["stall_dep"] = response.componentoccupancylist(i).stalldep();
-                tileJson["stall_other"] = response.componentoccupancylist(i).stallother();
-                tileJson["stall_inst_fetch"] = response.componentoccupancylist(i).stallinstfetch();
-                tileJson["tile_id"] = response.componentoccupancylist(i).tileid();
+            componentOccupancyRatiosToJson(response, deviceId, *json);
+        } else {
+            (*json)["error"] = response.errormsg();
+            (*json)["errno"] = errorNumTranslate(response.errorno());
+        }
+        
+    } else {
+        (*json)["error"] = status.error_message();
+        (*json)["errno"] = XPUM_CLI_ERROR_GENERIC_ERROR;
+    }
+    return json;
+}
 
-                tileJsonList.push_back(tileJson);
+std::unique_ptr<nlohmann::json> GrpcCoreStub::getPerfMetrics(int deviceId, int tileId, uint32_t windowMs) {
+    assert(this->stub != nullptr);
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+    grpc::ClientContext context;
+    GetPerfMetricsRequest request;
+    GetPerfMetricsResponse response;
+
+    request.set_deviceid(deviceId);
+    request.set_windowms(windowMs);
+    grpc::Status status = stub->getPerfMetrics(&context, request, &response);
+    if (status.ok()) {
+        if (response.errormsg().length() == 0) {
+            std::vector<nlohmann::json> metricJsonList;
+            for (int i = 0; i < response.metrics_size(); ++i) {
+                auto& metric = response.metrics(i);
+                if (tileId != -1 && metric.tileid() != tileId) {
+                    continue;
+                }
+                auto metricJson = nlohmann::json();
+                metricJson["tile_id"] = metric.tileid();
+                metricJson["group_name"] = metric.groupname();
+                metricJson["metric_name"] = metric.metricname();
+                metricJson["current"] = metric.current();
+                metricJson["average"] = metric.average();
+                metricJson["min"] = metric.min();
+                metricJson["max"] = metric.max();
+                metricJson["sample_count"] = metric.samplecount();
+                metricJson["active_ratio"] = metric.activeratio();
+                metricJsonList.push_back(metricJson);
             }
-            (*json)["device_id"] = std::to_string(deviceId);
-            (*json)["tile_json_list"] = tileJsonList;
+            (*json)["device_id"] = deviceId;
+            (*json)["perf_metric_list"] = metricJsonList;
+        } else {
+            (*json)["error"] = response.errormsg();
+            (*json)["errno"] = errorNumTranslate(response.errorno());
+        }
+    } else {
+        (*json)["error"] = status.error_message();
+        (*json)["errno"] = XPUM_CLI_ERROR_GENERIC_ERROR;
+    }
+    return json;
+}
+
+std::unique_ptr<nlohmann::json> GrpcCoreStub::getTopdownRatios(int deviceId, int tileId, uint32_t windowMs) {
+    assert(this->stub != nullptr);
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+    grpc::ClientContext context;
+    TopdownRatiosRequest request;
+    DeviceComponentOccupancyRatioResponse response;
+
+    request.set_deviceid(deviceId);
+    request.set_windowms(windowMs);
+    if (tileId == -1) {
+        request.set_istiledata(false);
+        request.set_tileid(0);
+    } else {
+        request.set_istiledata(true);
+        request.set_tileid(tileId);
+    }
+
+    grpc::Status status = stub->getTopdownRatios(&context, request, &response);
+    if (status.ok()) {
+        if (response.errormsg().length() == 0) {
+            componentOccupancyRatiosToJson(response, deviceId, *json);
         } else {
             (*json)["error"] = response.errormsg();
             (*json)["errno"] = errorNumTranslate(response.errorno());
         }
-        
     } else {
         (*json)["error"] = status.error_message();
         (*json)["errno"] = XPUM_CLI_ERROR_GENERIC_ERROR;
@@ -2307,6 +2484,48 @@ std::unique_ptr<nlohmann::json> GrpcCoreStub::getXelinkTopology() {
     return json;
 }
 
+std::unique_ptr<nlohmann::json> GrpcCoreStub::getPlacementAdvice(std::vector<int> deviceIds) {
+    assert(this->stub != nullptr);
+    auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+
+    grpc::ClientContext context;
+    XpumPlacementAdviceRequest request;
+    for (auto deviceId : deviceIds) {
+        request.add_deviceidlist(deviceId);
+    }
+    XpumPlacementAdviceResponse response;
+    grpc::Status status = stub->getPlacementAdvice(&context, request, &response);
+    if (status.ok()) {
+        if (response.errormsg().length() == 0) {
+            std::vector<nlohmann::json> deviceJsonList;
+            for (auto& device : response.devices()) {
+                auto deviceJson = nlohmann::json();
+                deviceJson["device_id"] = device.deviceid();
+                deviceJson["numa_index"] = device.numaindex();
+                deviceJson["cpu_affinity"] = device.cpuaffinity();
+                deviceJson["tree_parent"] = device.treeparent();
+                deviceJson["next_link_type"] = device.nextlinktype();
+                deviceJson["next_pcie_hops"] = device.nextpciehops();
+                deviceJsonList.push_back(deviceJson);
+            }
+            (*json)["device_list"] = deviceJsonList;
+            (*json)["cpu_list"] = response.cpulist();
+            (*json)["numa_node_list"] = std::vector<int32_t>(response.numanodes().begin(), response.numanodes().end());
+            (*json)["ring_xelink_hops"] = response.ringxelinkhops();
+            (*json)["ring_pcie_hops"] = response.ringpciehops();
+            (*json)["ring_cross_numa_hops"] = response.ringcrossnumahops();
+        } else {
+            (*json)["error"] = response.errormsg();
+            (*json)["errno"] = errorNumTranslate(response.errorno());
+        }
+    } else {
+        (*json)["error"] = status.error_message();
+        (*json)["errno"] = XPUM_CLI_ERROR_GENERIC_ERROR;
+    }
+
+    return json;
+}
+
 std::unique_ptr<nlohmann::json> GrpcCoreStub::runStress(int deviceId, uint32_t stressTime) {
     assert(this->stub != nullptr);
     auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
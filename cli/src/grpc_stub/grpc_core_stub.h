@@ -9,8 +9,10 @@
 #include <grpc++/channel.h>
 
 #include <chrono>
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <string>
 #include <thread>
@@ -18,6 +20,7 @@
 #include "core.grpc.pb.h"
 #include "xpum_structs.h"
 #include "core_stub.h"
+#include "stats_model.h"
 
 namespace xpum::cli {
 
@@ -25,6 +28,8 @@ class GrpcCoreStub : public CoreStub {
    public:
     GrpcCoreStub(bool priv);
 
+    ~GrpcCoreStub();
+
     bool isChannelReady();
 
     std::unique_ptr<nlohmann::json> getVersion();
@@ -35,6 +40,8 @@ class GrpcCoreStub : public CoreStub {
 
     std::unique_ptr<nlohmann::json> getDeviceProperties(const char *bdf, std::string username="", std::string password="");
 
+    std::unique_ptr<nlohmann::json> getAllDeviceProperties();
+
     std::unique_ptr<nlohmann::json> getSerailNumberAndAmcVersion(int deviceId, std::string username="", std::string password="");
 
     std::unique_ptr<nlohmann::json> getAMCFirmwareVersions(std::string username, std::string password);
@@ -44,6 +51,7 @@ class GrpcCoreStub : public CoreStub {
     std::unique_ptr<nlohmann::json> getTopology(int deviceId);
 
     std::unique_ptr<nlohmann::json> groupCreate(std::string groupName);
+    std::unique_ptr<nlohmann::json> groupCreateBySelector(std::string groupName, const xpum_group_selector_t &selector);
     std::unique_ptr<nlohmann::json> groupDelete(int groupId);
     std::unique_ptr<nlohmann::json> groupListAll();
     std::unique_ptr<nlohmann::json> groupList(int groupId);
@@ -73,6 +81,7 @@ class GrpcCoreStub : public CoreStub {
 
     std::unique_ptr<nlohmann::json> getStatistics(int deviceId, bool enableFilter = false, bool enableScale = false);
     std::unique_ptr<nlohmann::json> getStatisticsByGroup(uint32_t groupId, bool enableFilter = false, bool enableScale = false);
+    std::unique_ptr<nlohmann::json> getStatisticsBulk(std::vector<int> deviceIds, bool enableFilter = false, bool enableScale = false);
     std::shared_ptr<nlohmann::json> getEngineStatistics(int deviceId);
     std::shared_ptr<std::map<int, std::map<int, int>>> getEngineCount(int deviceId);
     std::shared_ptr<nlohmann::json> getFabricStatistics(int deviceId);
@@ -85,6 +94,8 @@ class GrpcCoreStub : public CoreStub {
     std::unique_ptr<nlohmann::json> setDeviceFrequencyRange(int deviceId, int tileId, int minFreq, int maxFreq);
     std::unique_ptr<nlohmann::json> getDeviceProcessState(int deviceId);
     std::unique_ptr<nlohmann::json> getDeviceComponentOccupancyRatio(int deviceId, int tileId, int samplingInterval);
+    std::unique_ptr<nlohmann::json> getPerfMetrics(int deviceId, int tileId, uint32_t windowMs);
+    std::unique_ptr<nlohmann::json> getTopdownRatios(int deviceId, int tileId, uint32_t windowMs);
     std::unique_ptr<nlohmann::json> getDeviceUtilizationByProcess(int deviceId, int utilizationInterval);
     std::unique_ptr<nlohmann::json> getAllDeviceUtilizationByProcess(int utilizationInterval);
     std::unique_ptr<nlohmann::json> getPerformanceFactor(int deviceId, int tileId);
@@ -111,7 +122,8 @@ class GrpcCoreStub : public CoreStub {
     std::unique_ptr<nlohmann::json> runFirmwareFlash(int deviceId, unsigned int type, const std::string& filePath, std::string username, std::string password, bool force=false);
     std::unique_ptr<nlohmann::json> getFirmwareFlashResult(int deviceId, unsigned int type);
 
-    std::unique_ptr<nlohmann::json> startDumpRawDataTask(uint32_t deviceId, int tileId, std::vector<xpum_dump_type_t> metricsTypeList, bool showDate=false);
+    std::unique_ptr<nlohmann::json> startDumpRawDataTask(uint32_t deviceId, int tileId, std::vector<xpum_dump_type_t> metricsTypeList, const xpum_dump_raw_data_option_t& option);
+    std::unique_ptr<nlohmann::json> startMultiDeviceDumpRawDataTask(std::vector<uint32_t> deviceIdList, std::vector<xpum_dump_type_t> metricsTypeList, const xpum_dump_raw_data_option_t& option);
     std::unique_ptr<nlohmann::json> stopDumpRawDataTask(int taskId);
     std::unique_ptr<nlohmann::json> listDumpRawDataTasks();
     std::unique_ptr<nlohmann::json> genDebugLog(const std::string &fileName);
@@ -120,10 +132,18 @@ class GrpcCoreStub : public CoreStub {
 
     std::unique_ptr<nlohmann::json> getAgentConfig();
 
+    std::unique_ptr<nlohmann::json> getInternalStats();
+
+    std::unique_ptr<nlohmann::json> getSamplingCost(int deviceId, uint32_t iterations, double targetOverhead);
+
+    bool waitForMetricsUpdate(uint64_t* generation, uint32_t timeout);
+
     std::string getTopoXMLBuffer();
 
     std::unique_ptr<nlohmann::json> getXelinkTopology();
 
+    std::unique_ptr<nlohmann::json> getPlacementAdvice(std::vector<int> deviceIds);
+
     std::shared_ptr<nlohmann::json> getFabricCount(int deviceId);
 
     std::unique_ptr<nlohmann::json> getSensorReading();
@@ -151,6 +171,27 @@ class GrpcCoreStub : public CoreStub {
 
     std::shared_ptr<grpc::Channel> channel;
 
+    // the subscribeMetrics stream of the updates, opened by the first waitForMetricsUpdate
+    std::unique_ptr<grpc::ClientContext> updateContext;
+
+    std::thread updateReader;
+
+    std::mutex updateMutex;
+
+    std::condition_variable updateCondition;
+
+    // the frames read, each is a store of the monitor
+    uint64_t updateCount = 0;
+
+    bool updateStreamOpen = false;
+
+    void readMetricsUpdates();
+
     std::string getCardUUID(const std::string& rawUUID);
+
+    // the errors in "error", empty if the statistics are read or not supported
+    nlohmann::json readEngineStatistics(int deviceId, std::vector<EngineStats>& engines);
+
+    nlohmann::json readFabricStatistics(int deviceId, DeviceStats& stats);
 };
 } // end namespace xpum::cli
@@ -4,6 +4,8 @@
  *  @file statistics_stub.cpp
  */
 
+#include <chrono>
+#include <map>
 #include <nlohmann/json.hpp>
 #include <sstream>
 #include <vector>
@@ -13,6 +15,7 @@
 #include "grpc_core_stub.h"
 #include "xpum_structs.h"
 #include "exit_code.h"
+#include "stats_model.h"
 
 namespace xpum::cli {
 
@@ -74,7 +77,7 @@ std::shared_ptr<nlohmann::json> GrpcCoreStub::getFabricCount(int deviceId) {
     return std::make_shared<nlohmann::json>(json);
 }
 
-std::shared_ptr<nlohmann::json> GrpcCoreStub::getEngineStatistics(int deviceId) {
+nlohmann::json GrpcCoreStub::readEngineStatistics(int deviceId, std::vector<EngineStats> &engines) {
     grpc::ClientContext engineContext;
     XpumGetEngineStatsRequest engineRequest;
     XpumGetEngineStatsResponse engineResponse;
@@ -82,145 +85,87 @@ std::shared_ptr<nlohmann::json> GrpcCoreStub::getEngineStatistics(int deviceId)
     engineRequest.set_sessionid(0);
     grpc::Status status = stub->getEngineStatistics(&engineContext, engineRequest, &engineResponse);
 
-    // std::shared_ptr<nlohmann::json> json;
-    nlohmann::json json;
-
+    nlohmann::json error;
     if (!status.ok()) {
-        json["error"] = status.error_message();
-        return std::make_shared<nlohmann::json>(json);
+        error["error"] = status.error_message();
+        return error;
     }
 
     if (engineResponse.errormsg().length() != 0) {
         if (engineResponse.errorno() == XPUM_METRIC_NOT_SUPPORTED || engineResponse.errorno() == XPUM_METRIC_NOT_ENABLED)
-            return std::make_shared<nlohmann::json>();
-        json["error"] = engineResponse.errormsg();
-        return std::make_shared<nlohmann::json>(json);
+            return error;
+        error["error"] = engineResponse.errormsg();
+        return error;
     }
 
-    // engine data
     for (auto &engineInfo : engineResponse.datalist()) {
-        xpum_engine_type_t engineType = (xpum_engine_type_t)engineInfo.enginetype();
-        nlohmann::json obj;
-        int32_t scale = engineInfo.scale();
-        if (scale == 1) {
-            obj["value"] = engineInfo.value();
-            obj["min"] = engineInfo.min();
-            obj["max"] = engineInfo.max();
-            obj["avg"] = engineInfo.avg();
-        } else {
-            obj["value"] = (double)engineInfo.value() / scale;
-            obj["min"] = (double)engineInfo.min() / scale;
-            obj["max"] = (double)engineInfo.max() / scale;
-            obj["avg"] = (double)engineInfo.avg() / scale;
-        }
-        obj["engine_id"] = engineInfo.engineid();
-        std::string tileId = engineInfo.istiledata() ? std::to_string(engineInfo.tileid()) : "device";
-        switch (engineType) {
-            case XPUM_ENGINE_TYPE_COMPUTE:
-                json[tileId]["compute"].push_back(obj);
-                break;
-            case XPUM_ENGINE_TYPE_RENDER:
-                json[tileId]["render"].push_back(obj);
-                break;
-            case XPUM_ENGINE_TYPE_DECODE:
-                json[tileId]["decoder"].push_back(obj);
-                break;
-            case XPUM_ENGINE_TYPE_ENCODE:
-                json[tileId]["encoder"].push_back(obj);
-                break;
-            case XPUM_ENGINE_TYPE_COPY:
-                json[tileId]["copy"].push_back(obj);
-                break;
-            case XPUM_ENGINE_TYPE_MEDIA_ENHANCEMENT:
-                json[tileId]["media_enhancement"].push_back(obj);
-                break;
-            case XPUM_ENGINE_TYPE_3D:
-                json[tileId]["3d"].push_back(obj);
-                break;
-            default:
-                break;
-        }
-    }
-    for (auto &item : json.items()) {
-        auto key = item.key();
-        auto &obj = json[key];
-        if (!obj.contains("compute")) {
-            obj["compute"] = nlohmann::json::array();
-        }
-        if (!obj.contains("render")) {
-            obj["render"] = nlohmann::json::array();
-        }
-        if (!obj.contains("decoder")) {
-            obj["decoder"] = nlohmann::json::array();
-        }
-        if (!obj.contains("encoder")) {
-            obj["encoder"] = nlohmann::json::array();
-        }
-        if (!obj.contains("copy")) {
-            obj["copy"] = nlohmann::json::array();
-        }
-        if (!obj.contains("media_enhancement")) {
-            obj["media_enhancement"] = nlohmann::json::array();
-        }
-        if (!obj.contains("3d")) {
-            obj["3d"] = nlohmann::json::array();
-        }
+        EngineStats engine;
+        engine.tileId = engineInfo.istiledata() ? engineInfo.tileid() : -1;
+        engine.type = (xpum_engine_type_t)engineInfo.enginetype();
+        engine.index = engineInfo.engineid();
+        engine.value = engineInfo.value();
+        engine.min = engineInfo.min();
+        engine.avg = engineInfo.avg();
+        engine.max = engineInfo.max();
+        engine.scale = engineInfo.scale();
+        engines.push_back(engine);
     }
-
-    return std::make_shared<nlohmann::json>(json);
+    return error;
 }
 
-std::shared_ptr<nlohmann::json> GrpcCoreStub::getFabricStatistics(int deviceId) {
-    nlohmann::json json;
+std::shared_ptr<nlohmann::json> GrpcCoreStub::getEngineStatistics(int deviceId) {
+    std::vector<EngineStats> engines;
+    auto error = readEngineStatistics(deviceId, engines);
+    if (!error.empty()) {
+        return std::make_shared<nlohmann::json>(error);
+    }
+    return std::make_shared<nlohmann::json>(engineStatsToJson(engines));
+}
 
+nlohmann::json GrpcCoreStub::readFabricStatistics(int deviceId, DeviceStats &stats) {
     grpc::ClientContext context;
     GetFabricStatsRequest request;
     GetFabricStatsResponse response;
     request.set_deviceid(deviceId);
     request.set_sessionid(0);
     grpc::Status status = stub->getFabricStatistics(&context, request, &response);
+
+    nlohmann::json error;
     if (!status.ok()) {
-        json["error"] = status.error_message();
-        return std::make_shared<nlohmann::json>(json);
+        error["error"] = status.error_message();
+        return error;
     }
     if (response.errormsg().length() != 0) {
         if (response.errorno() == XPUM_METRIC_NOT_SUPPORTED || response.errorno() == XPUM_METRIC_NOT_ENABLED)
-            return std::make_shared<nlohmann::json>();
-        json["error"] = response.errormsg();
-        return std::make_shared<nlohmann::json>(json);
+            return error;
+        error["error"] = response.errormsg();
+        return error;
     }
 
-    // fabric data
-    json["fabric_throughput"] = nlohmann::json::array();
     for (auto &fabricInfo : response.datalist()) {
-        nlohmann::json obj;
-
-        std::stringstream ss;
-        if (fabricInfo.type() == XPUM_FABRIC_THROUGHPUT_TYPE_TRANSMITTED) {
-            ss << deviceId << "/" << fabricInfo.tileid() << "->" << fabricInfo.remote_device_id() << "/" << fabricInfo.remote_device_tile_id();
-        } else if (fabricInfo.type() == XPUM_FABRIC_THROUGHPUT_TYPE_RECEIVED) {
-            ss << fabricInfo.remote_device_id() << "/" << fabricInfo.remote_device_tile_id() << "->" << deviceId << "/" << fabricInfo.tileid();
-        } else {
-            continue;
-        }
+        FabricStats fabric;
+        fabric.tileId = fabricInfo.tileid();
+        fabric.remoteDeviceId = fabricInfo.remote_device_id();
+        fabric.remoteTileId = fabricInfo.remote_device_tile_id();
+        fabric.type = (xpum_fabric_throughput_type_t)fabricInfo.type();
+        fabric.value = fabricInfo.value();
+        fabric.min = fabricInfo.min();
+        fabric.avg = fabricInfo.avg();
+        fabric.max = fabricInfo.max();
+        fabric.scale = fabricInfo.scale();
+        stats.fabrics.push_back(fabric);
+    }
+    stats.hasFabric = true;
+    return error;
+}
 
-        int32_t scale = fabricInfo.scale() * 1000; // kB
-        if (scale == 1) {
-            obj["value"] = fabricInfo.value();
-            obj["min"] = fabricInfo.min();
-            obj["max"] = fabricInfo.max();
-            obj["avg"] = fabricInfo.avg();
-        } else {
-            obj["value"] = round((double)fabricInfo.value() / scale * 100) / 100;
-            obj["min"] = round((double)fabricInfo.min() / scale * 100) / 100;
-            obj["max"] = round((double)fabricInfo.max() / scale * 100) / 100;
-            obj["avg"] = round((double)fabricInfo.avg() / scale * 100) / 100;
-        }
-        obj["name"] = ss.str();
-        obj["tile_id"] = fabricInfo.tileid();
-        json["fabric_throughput"].push_back(obj);
+std::shared_ptr<nlohmann::json> GrpcCoreStub::getFabricStatistics(int deviceId) {
+    DeviceStats stats;
+    auto error = readFabricStatistics(deviceId, stats);
+    if (!error.empty() || !stats.hasFabric) {
+        return std::make_shared<nlohmann::json>(error);
     }
-    return std::make_shared<nlohmann::json>(json);
+    return std::make_shared<nlohmann::json>(fabricStatsToJson(deviceId, stats.fabrics));
 }
 
 std::unique_ptr<nlohmann::json> GrpcCoreStub::getXelinkThroughputAndUtilMatrix() {
@@ -330,15 +275,23 @@ std::unique_ptr<nlohmann::json> GrpcCoreStub::getXelinkThroughputAndUtilMatrix()
     return json;
 }
 
-static int32_t getCliScale(xpum_stats_type_t metricsType) {
-    switch (metricsType) {
-        case XPUM_STATS_ENERGY:
-            return 1000;
-        case XPUM_STATS_MEMORY_USED:
-            return 1048576;
-        default:
-            return 1;
+// the metrics of a device or a tile
+static StatsEntry toStatsEntry(const DeviceStatsInfo &statsInfo) {
+    StatsEntry entry;
+    entry.tileId = statsInfo.istiledata() ? statsInfo.tileid() : -1;
+    for (auto &statsData : statsInfo.datalist()) {
+        MetricStats metric;
+        metric.metricsType = (xpum_stats_type_t)statsData.metricstype().value();
+        metric.isCounter = statsData.iscounter();
+        metric.value = statsData.value();
+        metric.accumulated = statsData.accumulated();
+        metric.min = statsData.min();
+        metric.avg = statsData.avg();
+        metric.max = statsData.max();
+        metric.scale = statsData.scale();
+        entry.metrics.push_back(metric);
     }
+    return entry;
 }
 
 std::unique_ptr<nlohmann::json> GrpcCoreStub::getStatistics(int deviceId, bool enableFilter, bool enableScale) {
@@ -366,84 +319,56 @@ std::unique_ptr<nlohmann::json> GrpcCoreStub::getStatistics(int deviceId, bool e
         return json;
     }
 
-    // get engine stats
-    auto engineStatsJson = getEngineStatistics(deviceId);
-    if (engineStatsJson->contains("error")) {
-        return std::make_unique<nlohmann::json>(*engineStatsJson);
+    DeviceStats stats;
+    stats.deviceId = deviceId;
+    auto error = readEngineStatistics(deviceId, stats.engines);
+    if (!error.empty()) {
+        return std::make_unique<nlohmann::json>(error);
     }
-
-    // get fabric stats
-    auto fabricStatsJson = getFabricStatistics(deviceId);
-    if (!fabricStatsJson->contains("error") && !fabricStatsJson->empty()) {
-        json->update(*fabricStatsJson);
-        // return std::make_unique<nlohmann::json>(*fabricStatsJson);
+    // the statistics are shown without the fabric throughput if it fails
+    readFabricStatistics(deviceId, stats);
+    for (auto &statsInfo : response.datalist()) {
+        stats.entries.push_back(toStatsEntry(statsInfo));
     }
 
-    std::vector<nlohmann::json> deviceJsonList;
     uint64_t begin = response.begin();
     uint64_t end = response.end();
     (*json)["begin"] = isotimestamp(begin);
     (*json)["end"] = isotimestamp(end);
-
     (*json)["elapsed_time"] = (end - begin) / 1000;
+    // the daemon filters the metrics
+    deviceStatsToJson(stats, false, enableScale, *json);
+    return json;
+}
 
-    std::vector<nlohmann::json> deviceLevelStatsDataList;
-    std::vector<nlohmann::json> tileLevelStatsDataList;
-
-    for (int i{0}; i < response.datalist_size(); i++) {
-        auto &stats_info = response.datalist(i);
-        std::vector<nlohmann::json> dataList;
-        for (int j = 0; j < stats_info.datalist_size(); j++) {
-            auto &stats_data = stats_info.datalist(j);
-            auto tmp = nlohmann::json();
-            xpum_stats_type_t metricsType = (xpum_stats_type_t)stats_data.metricstype().value();
-            tmp["metrics_type"] = metricsTypeToString(metricsType);
-            int32_t cliScale = getCliScale(metricsType);
-            int32_t scale = enableScale ? stats_data.scale() * cliScale : stats_data.scale();
-            if (scale == 1) {
-                tmp["value"] = stats_data.value();
-                if (!stats_data.iscounter()) {
-                    tmp["avg"] = stats_data.avg();
-                    tmp["min"] = stats_data.min();
-                    tmp["max"] = stats_data.max();
-                } else {
-                    tmp["total"] = stats_data.accumulated();
-                }
-            } else {
-                tmp["value"] = (double)stats_data.value() / scale;
-                if (!stats_data.iscounter()) {
-                    tmp["avg"] = (double)stats_data.avg() / scale;
-                    tmp["min"] = (double)stats_data.min() / scale;
-                    tmp["max"] = (double)stats_data.max() / scale;
-                } else {
-                    tmp["total"] = (double)stats_data.accumulated() / scale;
-                }
-            }
-            dataList.push_back(tmp);
-        }
-        if (stats_info.istiledata()) {
-            auto tmp = nlohmann::json();
-            tmp["tile_id"] = stats_info.tileid();
-            tmp["data_list"] = dataList;
-            auto strTileId = std::to_string(stats_info.tileid());
-            if (engineStatsJson->contains(strTileId)) {
-                tmp["engine_util"] = (*engineStatsJson)[strTileId];
-            }
-            tileLevelStatsDataList.push_back(tmp);
-        } else {
-            deviceLevelStatsDataList.insert(deviceLevelStatsDataList.end(), dataList.begin(), dataList.end());
-        }
+std::unique_ptr<nlohmann::json> GrpcCoreStub::getStatisticsBulk(std::vector<int> deviceIds, bool enableFilter, bool enableScale) {
+    assert(this->stub != nullptr);
+
+    grpc::ClientContext context;
+    XpumGetTelemetrySnapshotRequest request;
+    XpumGetTelemetrySnapshotResponse response;
+    for (auto deviceId : deviceIds) {
+        request.add_deviceidlist(deviceId);
     }
-    if (engineStatsJson->contains("device")) {
-        (*json)["engine_util"] = (*engineStatsJson)["device"];
+    request.set_sessionid(0);
+    grpc::Status status = stub->getTelemetrySnapshot(&context, request, &response);
+
+    if (!status.ok()) {
+        auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+        (*json)["error"] = status.error_message();
+        (*json)["errno"] = XPUM_CLI_ERROR_GENERIC_ERROR;
+        return json;
     }
-    (*json)["device_level"] = deviceLevelStatsDataList;
-    if (tileLevelStatsDataList.size() > 0)
-        (*json)["tile_level"] = tileLevelStatsDataList;
 
-    (*json)["device_id"] = deviceId;
+    if (response.errormsg().length() != 0) {
+        auto json = std::unique_ptr<nlohmann::json>(new nlohmann::json());
+        (*json)["error"] = response.errormsg();
+        (*json)["errno"] = errorNumTranslate(response.errorno());
+        return json;
+    }
 
-    return json;
+    // the snapshot is read in place from the response
+    return telemetrySnapshotToJson(response.snapshot().data(), response.snapshot().size(), enableFilter, enableScale);
 }
 
 std::unique_ptr<nlohmann::json> GrpcCoreStub::getStatisticsByGroup(uint32_t groupId, bool enableFilter, bool enableScale) {
@@ -470,61 +395,12 @@ std::unique_ptr<nlohmann::json> GrpcCoreStub::getStatisticsByGroup(uint32_t grou
         return json;
     }
 
-    auto deviceMap = nlohmann::json();
-
-    for (int i{0}; i < response.datalist_size(); i++) {
-        auto &stats_info = response.datalist(i);
-
-        std::string key = std::to_string(stats_info.deviceid());
-
-        if (!deviceMap.contains(key)) {
-            auto tmp = nlohmann::json();
-            tmp["device_level"] = std::vector<nlohmann::json>();
-            tmp["tile_level"] = std::vector<nlohmann::json>();
-            tmp["device_id"] = stats_info.deviceid();
-            deviceMap[key] = tmp;
-        }
-
-        std::vector<nlohmann::json> dataList;
-
-        for (int j = 0; j < stats_info.datalist_size(); j++) {
-            auto &stats_data = stats_info.datalist(j);
-            auto tmp = nlohmann::json();
-            xpum_stats_type_t metricsType = (xpum_stats_type_t)stats_data.metricstype().value();
-            tmp["metrics_type"] = metricsTypeToString(metricsType);
-            int32_t cliScale = getCliScale(metricsType);
-            int32_t scale = enableScale ? stats_data.scale() * cliScale : stats_data.scale();
-            if (scale == 1) {
-                tmp["value"] = stats_data.value();
-                if (!stats_data.iscounter()) {
-                    tmp["avg"] = stats_data.avg();
-                    tmp["min"] = stats_data.min();
-                    tmp["max"] = stats_data.max();
-                } else {
-                    tmp["total"] = stats_data.accumulated();
-                }
-            } else {
-                tmp["value"] = (double)stats_data.value() / scale;
-                if (!stats_data.iscounter()) {
-                    tmp["avg"] = (double)stats_data.avg() / scale;
-                    tmp["min"] = (double)stats_data.min() / scale;
-                    tmp["max"] = (double)stats_data.max() / scale;
-                } else {
-                    tmp["total"] = (double)stats_data.accumulated() / scale;
-                }
-            }
-            dataList.push_back(tmp);
-        }
-
-        if (stats_info.istiledata()) {
-            auto tmp = nlohmann::json();
-            tmp["tile_id"] = stats_info.tileid();
-            tmp["data_list"] = dataList;
-
-            deviceMap[key]["tile_level"].push_back(tmp);
-        } else {
-            deviceMap[key]["device_level"] = dataList;
-        }
+    // the devices in the order of their ids as strings
+    std::map<std::string, DeviceStats> devices;
+    for (auto &statsInfo : response.datalist()) {
+        DeviceStats &stats = devices[std::to_string(statsInfo.deviceid())];
+        stats.deviceId = statsInfo.deviceid();
+        stats.entries.push_back(toStatsEntry(statsInfo));
     }
 
     uint64_t begin = response.begin();
@@ -534,37 +410,20 @@ std::unique_ptr<nlohmann::json> GrpcCoreStub::getStatisticsByGroup(uint32_t grou
     std::string endTimestamp = isotimestamp(end);
 
     auto datas = std::vector<nlohmann::json>();
-    for (auto &item : deviceMap.items()) {
+    for (auto &item : devices) {
+        DeviceStats &stats = item.second;
+        auto error = readEngineStatistics(stats.deviceId, stats.engines);
+        if (!error.empty()) {
+            return std::make_unique<nlohmann::json>(error);
+        }
+        readFabricStatistics(stats.deviceId, stats);
         nlohmann::json data;
-        int deviceId = item.value()["device_id"].get<int>();
         data["begin"] = beginTimestamp;
         data["end"] = endTimestamp;
         data["elapsed_time"] = elapsed_time;
-        data["device_id"] = item.value()["device_id"];
-        data["device_level"] = item.value()["device_level"];
-        // get engine stats
-        auto engineStatsJson = getEngineStatistics(deviceId);
-        if (engineStatsJson->contains("error")) {
-            return std::make_unique<nlohmann::json>(*engineStatsJson);
-        }
-        if (engineStatsJson->contains("device")) {
-            data["engine_util"] = (*engineStatsJson)["device"];
-        }
-        if (item.value().contains("tile_level")) {
-            auto &tileLevelObj = item.value()["tile_level"];
-            for (auto &tileObj : tileLevelObj) {
-                std::string strTileId = std::to_string(tileObj["tile_id"].get<int>());
-                if (engineStatsJson->contains(strTileId)) {
-                    tileObj["engine_util"] = (*engineStatsJson)[strTileId];
-                }
-            }
-            data["tile_level"] = tileLevelObj;
-        }
-        // get fabric stats
-        auto fabricStatsJson = getFabricStatistics(deviceId);
-        if (!fabricStatsJson->contains("error") && !fabricStatsJson->empty()) {
-            // return std::make_unique<nlohmann::json>(*fabricStatsJson);
-            data.update(*fabricStatsJson);
+        deviceStatsToJson(stats, false, enableScale, data);
+        if (!data.contains("tile_level")) {
+            data["tile_level"] = nlohmann::json::array();
         }
         datas.push_back(data);
     }
@@ -580,4 +439,40 @@ std::vector<std::unique_ptr<nlohmann::json>> GrpcCoreStub::getMetricsFromSysfs(s
     return ret;
 }
 
+
+bool GrpcCoreStub::waitForMetricsUpdate(uint64_t* generation, uint32_t timeout) {
+    assert(this->stub != nullptr);
+    std::unique_lock<std::mutex> lock(updateMutex);
+    if (!updateReader.joinable()) {
+        updateContext.reset(new grpc::ClientContext());
+        updateStreamOpen = true;
+        updateReader = std::thread([this]() { readMetricsUpdates(); });
+    }
+    updateCondition.wait_for(lock, std::chrono::milliseconds(timeout), [this, generation]() {
+        return updateCount != *generation || !updateStreamOpen;
+    });
+    if (updateCount != *generation) {
+        *generation = updateCount;
+        return true;
+    }
+    return updateStreamOpen;
+}
+
+void GrpcCoreStub::readMetricsUpdates() {
+    XpumSubscribeMetricsRequest request;
+    request.set_updatesonly(true);
+    auto reader = stub->subscribeMetrics(updateContext.get(), request);
+    MetricsFrame frame;
+    while (reader->Read(&frame) && frame.errorno() == XPUM_OK) {
+        std::lock_guard<std::mutex> lock(updateMutex);
+        updateCount++;
+        updateCondition.notify_all();
+    }
+    // a daemon without the stream, or the stream cancelled
+    updateContext->TryCancel();
+    reader->Finish();
+    std::lock_guard<std::mutex> lock(updateMutex);
+    updateStreamOpen = false;
+    updateCondition.notify_all();
+}
 } // end namespace xpum::cli
@@ -30,6 +30,7 @@ std::string HelpFormatter::make_usage(const CLI::App *app, std::string name) con
         return "\n"
                "Usage: " + appName + " group [Options] \n"
                "  " + appName + " group -c -n [groupName] \n"
+               "  " + appName + " group -c -n [groupName] [--model model] [--numa node] [--pcie-switch BDF] [--function-type physical|virtual] [--pod podUid] [--health warning|critical] [--throttled] \n"
                "  " + appName + " group -a -g [groupId] -d [deviceIds] \n"
                "  " + appName + " group -r -d [deviceIds] -g [groupId] \n"
                "  " + appName + " group -D -g [groupId] \n"
@@ -50,6 +51,13 @@ std::string HelpFormatter::make_usage(const CLI::App *app, std::string name) con
                 "MEM:      Device memory size in bytes allocated by "
                 "this process (may not necessarily be resident on "
                 "the device at the time of reading) (kB)\n";
+    } else if (app->get_name().compare("top") == 0) {
+        return "\n"
+               "Usage: " + appName + " top [Options] \n"
+               "  " + appName + " top \n"
+               "  " + appName + " top -d [deviceIds] -i [timeInterval] \n"
+               "  " + appName + " top -n [iterations] -j \n"
+               "\nPress q or ESC to exit the view. When the output is not a terminal, the frames are printed one after another.\n";
     } else if (app->get_name().compare("topdown") == 0) {
         return "\n"
                "Usage: " + appName + " topdown [Options] \n"
@@ -57,6 +65,7 @@ std::string HelpFormatter::make_usage(const CLI::App *app, std::string name) con
                "  " + appName + " topdown -d [deviceId] -j \n"
                "  " + appName + " topdown -d [deviceId] -t [tileId] \n"
                "  " + appName + " topdown -d [deviceId] -t [tileId] -j \n"
+               "  " + appName + " topdown -d [deviceId] --monitor -w [windowMs] \n"
                "\nEU in Use:               Contribution to throughput (observed) when EUs are in use with EU threads placed (higher is better)\n"
                "EU Active:               Contribution to throughput (observed) when EUs are processing instructions from some EU threads (higher is better)\n"
                "ALU Active:              Contribution to throughput (estimated) with ALU instructions being processed (higher is better)\n"
@@ -84,7 +93,9 @@ std::string HelpFormatter::make_usage(const CLI::App *app, std::string name) con
                "  " + appName + " topology -d [pciBdfAddress] \n"
                "  " + appName + " topology -d [deviceId] -j \n"
                "  " + appName + " topology -f [filename]  \n"
-               "  " + appName + " topology -m  \n";
+               "  " + appName + " topology -m  \n"
+               "  " + appName + " topology --placement [deviceIds] \n"
+               "  " + appName + " topology --placement [deviceIds] -j \n";
     } else if (app->get_name().compare("health") == 0) {
         return "\nUsage: " + appName + " health [Options] \n"
                "  " + appName + " health -l \n"
@@ -179,7 +190,9 @@ std::string HelpFormatter::make_usage(const CLI::App *app, std::string name) con
         return "\nUsage: " + appName + " agentset [Options]\n"
                "  " + appName + " agentset -l\n"
                "  " + appName + " agentset -l -j\n"
-               "  " + appName + " agentset -t 200\n";
+               "  " + appName + " agentset -t 200\n"
+               "  " + appName + " agentset --self-stats\n"
+               "  " + appName + " agentset --self-stats -j\n";
     } else if (app->get_name().compare("discovery") == 0) {
         return "\nUsage: " + appName + " discovery [Options]\n"
                "  " + appName + " discovery\n"
@@ -0,0 +1,180 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file stats_model.cpp
+ */
+
+#include "stats_model.h"
+
+#include <cmath>
+#include <sstream>
+#include <string>
+
+#include "core_stub.h"
+
+namespace xpum::cli {
+
+static const char* engineTypeToJsonKey(xpum_engine_type_t engineType) {
+    switch (engineType) {
+        case XPUM_ENGINE_TYPE_COMPUTE:
+            return "compute";
+        case XPUM_ENGINE_TYPE_RENDER:
+            return "render";
+        case XPUM_ENGINE_TYPE_DECODE:
+            return "decoder";
+        case XPUM_ENGINE_TYPE_ENCODE:
+            return "encoder";
+        case XPUM_ENGINE_TYPE_COPY:
+            return "copy";
+        case XPUM_ENGINE_TYPE_MEDIA_ENHANCEMENT:
+            return "media_enhancement";
+        case XPUM_ENGINE_TYPE_3D:
+            return "3d";
+        default:
+            return nullptr;
+    }
+}
+
+nlohmann::json engineStatsToJson(const std::vector<EngineStats>& engines) {
+    nlohmann::json json;
+    for (auto& engine : engines) {
+        const char* key = engineTypeToJsonKey(engine.type);
+        if (key == nullptr) {
+            continue;
+        }
+        nlohmann::json obj;
+        if (engine.scale == 1) {
+            obj["value"] = engine.value;
+            obj["min"] = engine.min;
+            obj["max"] = engine.max;
+            obj["avg"] = engine.avg;
+        } else {
+            obj["value"] = (double)engine.value / engine.scale;
+            obj["min"] = (double)engine.min / engine.scale;
+            obj["max"] = (double)engine.max / engine.scale;
+            obj["avg"] = (double)engine.avg / engine.scale;
+        }
+        obj["engine_id"] = engine.index;
+        std::string tileId = engine.tileId >= 0 ? std::to_string(engine.tileId) : "device";
+        json[tileId][key].push_back(obj);
+    }
+    for (auto& item : json.items()) {
+        for (int type = XPUM_ENGINE_TYPE_COMPUTE; type < XPUM_ENGINE_TYPE_UNKNOWN; type++) {
+            const char* key = engineTypeToJsonKey((xpum_engine_type_t)type);
+            if (!item.value().contains(key)) {
+                item.value()[key] = nlohmann::json::array();
+            }
+        }
+    }
+    return json;
+}
+
+nlohmann::json fabricStatsToJson(int deviceId, const std::vector<FabricStats>& fabrics) {
+    nlohmann::json json;
+    json["fabric_throughput"] = nlohmann::json::array();
+    for (auto& fabric : fabrics) {
+        std::stringstream ss;
+        if (fabric.type == XPUM_FABRIC_THROUGHPUT_TYPE_TRANSMITTED) {
+            ss << deviceId << "/" << fabric.tileId << "->" << fabric.remoteDeviceId << "/" << fabric.remoteTileId;
+        } else if (fabric.type == XPUM_FABRIC_THROUGHPUT_TYPE_RECEIVED) {
+            ss << fabric.remoteDeviceId << "/" << fabric.remoteTileId << "->" << deviceId << "/" << fabric.tileId;
+        } else {
+            continue;
+        }
+
+        nlohmann::json obj;
+        int32_t scale = fabric.scale * 1000; // kB
+        if (scale == 1) {
+            obj["value"] = fabric.value;
+            obj["min"] = fabric.min;
+            obj["max"] = fabric.max;
+            obj["avg"] = fabric.avg;
+        } else {
+            obj["value"] = round((double)fabric.value / scale * 100) / 100;
+            obj["min"] = round((double)fabric.min / scale * 100) / 100;
+            obj["max"] = round((double)fabric.max / scale * 100) / 100;
+            obj["avg"] = round((double)fabric.avg / scale * 100) / 100;
+        }
+        obj["name"] = ss.str();
+        obj["tile_id"] = fabric.tileId;
+        json["fabric_throughput"].push_back(obj);
+    }
+    return json;
+}
+
+static std::vector<nlohmann::json> metricsToJson(const std::vector<MetricStats>& metrics, bool enableFilter, bool enableScale) {
+    std::vector<nlohmann::json> dataList;
+    for (auto& metric : metrics) {
+        if (enableFilter && !CoreStub::metricsTypeAllowList(metric.metricsType)) {
+            continue;
+        }
+        nlohmann::json obj;
+        obj["metrics_type"] = CoreStub::metricsTypeToString(metric.metricsType);
+        int32_t scale = enableScale ? metric.scale * CoreStub::getCliScale(metric.metricsType) : metric.scale;
+        if (scale == 1) {
+            obj["value"] = metric.value;
+            if (!metric.isCounter) {
+                obj["avg"] = metric.avg;
+                obj["min"] = metric.min;
+                obj["max"] = metric.max;
+                if (metric.hasPercentiles) {
+                    obj["p50"] = metric.p50;
+                    obj["p90"] = metric.p90;
+                    obj["p99"] = metric.p99;
+                }
+            } else {
+                obj["total"] = metric.accumulated;
+            }
+        } else {
+            obj["value"] = (double)metric.value / scale;
+            if (!metric.isCounter) {
+                obj["avg"] = (double)metric.avg / scale;
+                obj["min"] = (double)metric.min / scale;
+                obj["max"] = (double)metric.max / scale;
+                if (metric.hasPercentiles) {
+                    obj["p50"] = (double)metric.p50 / scale;
+                    obj["p90"] = (double)metric.p90 / scale;
+                    obj["p99"] = (double)metric.p99 / scale;
+                }
+            } else {
+                obj["total"] = (double)metric.accumulated / scale;
+            }
+        }
+        dataList.push_back(obj);
+    }
+    return dataList;
+}
+
+void deviceStatsToJson(const DeviceStats& stats, bool enableFilter, bool enableScale, nlohmann::json& json) {
+    nlohmann::json engineJson = engineStatsToJson(stats.engines);
+    std::vector<nlohmann::json> deviceLevelStatsDataList;
+    std::vector<nlohmann::json> tileLevelStatsDataList;
+    for (auto& entry : stats.entries) {
+        std::vector<nlohmann::json> dataList = metricsToJson(entry.metrics, enableFilter, enableScale);
+        if (entry.tileId >= 0) {
+            nlohmann::json tile;
+            tile["tile_id"] = entry.tileId;
+            tile["data_list"] = dataList;
+            auto strTileId = std::to_string(entry.tileId);
+            if (engineJson.contains(strTileId)) {
+                tile["engine_util"] = engineJson[strTileId];
+            }
+            tileLevelStatsDataList.push_back(tile);
+        } else {
+            deviceLevelStatsDataList.insert(deviceLevelStatsDataList.end(), dataList.begin(), dataList.end());
+        }
+    }
+    if (stats.hasFabric) {
+        json.update(fabricStatsToJson(stats.deviceId, stats.fabrics));
+    }
+    if (engineJson.contains("device")) {
+        json["engine_util"] = engineJson["device"];
+    }
+    json["device_level"] = deviceLevelStatsDataList;
+    if (tileLevelStatsDataList.size() > 0) {
+        json["tile_level"] = tileLevelStatsDataList;
+    }
+    json["device_id"] = stats.deviceId;
+}
+
+} // end namespace xpum::cli
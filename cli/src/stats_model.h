@@ -0,0 +1,89 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file stats_model.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+#include "xpum_structs.h"
+
+namespace xpum::cli {
+
+/*
+  The statistics of a device as read by the stubs, the same for the daemon
+  and the daemonless mode. The stubs fill it from the structs of the core
+  library or from the gRPC messages, and the JSON of the commands is made
+  from it in one place.
+*/
+
+// one metric of a device or a tile, the fields of xpum_device_stats_data_t
+struct MetricStats {
+    xpum_stats_type_t metricsType;
+    bool isCounter = false;
+    uint64_t value = 0;
+    uint64_t accumulated = 0;
+    uint64_t min = 0;
+    uint64_t avg = 0;
+    uint64_t max = 0;
+    uint32_t scale = 1;
+    // false for the snapshots of a daemon older than the percentiles
+    bool hasPercentiles = false;
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+};
+
+// the metrics of the device, tileId -1, or of one of its tiles
+struct StatsEntry {
+    int32_t tileId = -1;
+    std::vector<MetricStats> metrics;
+};
+
+struct EngineStats {
+    // -1 for an engine of the device
+    int32_t tileId = -1;
+    xpum_engine_type_t type;
+    uint64_t index = 0;
+    uint64_t value = 0;
+    uint64_t min = 0;
+    uint64_t avg = 0;
+    uint64_t max = 0;
+    uint32_t scale = 1;
+};
+
+struct FabricStats {
+    uint32_t tileId = 0;
+    uint32_t remoteDeviceId = 0;
+    uint32_t remoteTileId = 0;
+    xpum_fabric_throughput_type_t type;
+    uint64_t value = 0;
+    uint64_t min = 0;
+    uint64_t avg = 0;
+    uint64_t max = 0;
+    uint32_t scale = 1;
+};
+
+struct DeviceStats {
+    int deviceId = -1;
+    std::vector<StatsEntry> entries;
+    std::vector<EngineStats> engines;
+    // the fabric throughput is only in the JSON if it was read
+    bool hasFabric = false;
+    std::vector<FabricStats> fabrics;
+};
+
+// the engine utilizations of one device by tile id, "device" for the engines of the device
+nlohmann::json engineStatsToJson(const std::vector<EngineStats>& engines);
+
+// the Xe Link throughputs of one device in "fabric_throughput", named "<device>/<tile>-><remote device>/<remote tile>"
+nlohmann::json fabricStatsToJson(int deviceId, const std::vector<FabricStats>& fabrics);
+
+// the device_level, tile_level, engine_util, fabric_throughput and device_id of one device
+void deviceStatsToJson(const DeviceStats& stats, bool enableFilter, bool enableScale, nlohmann::json& json);
+
+} // end namespace xpum::cli
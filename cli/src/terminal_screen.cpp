@@ -0,0 +1,144 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file terminal_screen.cpp
+ */
+
+#include "terminal_screen.h"
+
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+namespace xpum::cli {
+
+// equal cells between two changed runs shorter than a cursor move are rewritten
+#define SCREEN_MIN_GAP 8
+
+TerminalScreen::~TerminalScreen() {
+    close();
+}
+
+bool TerminalScreen::open() {
+    if (opened) {
+        return true;
+    }
+    if (!isatty(STDOUT_FILENO)) {
+        return false;
+    }
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &savedTermios) == 0) {
+        struct termios raw = savedTermios;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        termiosSaved = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+    }
+    // the alternate screen, cursor hidden
+    out << "\033[?1049h\033[?25l\033[2J" << std::flush;
+    opened = true;
+    rows = 0;
+    columns = 0;
+    frame.clear();
+    return true;
+}
+
+void TerminalScreen::close() {
+    if (!opened) {
+        return;
+    }
+    out << "\033[?25h\033[?1049l" << std::flush;
+    if (termiosSaved) {
+        tcsetattr(STDIN_FILENO, TCSADRAIN, &savedTermios);
+        termiosSaved = false;
+    }
+    opened = false;
+}
+
+void TerminalScreen::getSize(int &rows, int &columns) {
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+        rows = ws.ws_row;
+        columns = ws.ws_col;
+    } else {
+        rows = 24;
+        columns = 80;
+    }
+}
+
+void TerminalScreen::draw(const std::vector<std::string> &lines) {
+    int newRows, newColumns;
+    getSize(newRows, newColumns);
+    std::string buf;
+    if (newRows != rows || newColumns != columns) {
+        rows = newRows;
+        columns = newColumns;
+        frame.clear();
+        buf += "\033[2J";
+    }
+    frame.resize(rows);
+    auto moveTo = [&buf](int row, int column) {
+        buf += "\033[" + std::to_string(row + 1) + ";" + std::to_string(column + 1) + "H";
+    };
+    for (int row = 0; row < rows; row++) {
+        // the last cell is left empty, writing it scrolls some terminals
+        size_t width = row == rows - 1 ? columns - 1 : columns;
+        std::string line = row < (int)lines.size() ? lines[row].substr(0, width) : "";
+        for (auto &c : line) {
+            if ((unsigned char)c < 0x20 || (unsigned char)c >= 0x7f) {
+                c = '?';
+            }
+        }
+        std::string &old = frame[row];
+        if (line == old) {
+            continue;
+        }
+        size_t common = std::min(line.size(), old.size());
+        size_t i = 0;
+        while (i < common) {
+            if (line[i] == old[i]) {
+                i++;
+                continue;
+            }
+            size_t end = i + 1;
+            size_t same = 0;
+            for (size_t j = end; j < common && same < SCREEN_MIN_GAP; j++) {
+                if (line[j] == old[j]) {
+                    same++;
+                } else {
+                    end = j + 1;
+                    same = 0;
+                }
+            }
+            moveTo(row, i);
+            buf.append(line, i, end - i);
+            i = end;
+        }
+        if (line.size() > old.size()) {
+            moveTo(row, common);
+            buf.append(line, common, std::string::npos);
+        } else if (line.size() < old.size()) {
+            moveTo(row, line.size());
+            buf += "\033[K";
+        }
+        old = std::move(line);
+    }
+    if (!buf.empty()) {
+        out << buf << std::flush;
+    }
+}
+
+int TerminalScreen::readKey() {
+    if (!termiosSaved) {
+        return -1;
+    }
+    struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+    unsigned char c;
+    if (poll(&pfd, 1, 0) > 0 && read(STDIN_FILENO, &c, 1) == 1) {
+        return c;
+    }
+    return -1;
+}
+
+} // end namespace xpum::cli
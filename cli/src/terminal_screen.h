@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file terminal_screen.h
+ */
+
+#pragma once
+
+#include <termios.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace xpum::cli {
+
+/*
+  TerminalScreen draws full-screen frames on the terminal with ANSI escape
+  sequences, on the alternate screen so the shell is restored on close.
+
+  The lines of the previous frame are kept and only the cells which changed
+  are written: for each line the runs of changed characters are rewritten
+  after moving the cursor to them, and the end of a line that got shorter
+  is erased. A frame is written to the terminal with one write, and the
+  whole screen is only redrawn when the terminal is resized.
+*/
+class TerminalScreen {
+   public:
+    explicit TerminalScreen(std::ostream &out) : out(out) {}
+    ~TerminalScreen();
+
+    // switch to the alternate screen and read the keys unbuffered, false if stdout is not a terminal
+    bool open();
+
+    void close();
+
+    // the rows and columns of the terminal
+    void getSize(int &rows, int &columns);
+
+    void draw(const std::vector<std::string> &lines);
+
+    // the key pressed, -1 if none
+    int readKey();
+
+   private:
+    std::ostream &out;
+    bool opened = false;
+    bool termiosSaved = false;
+    struct termios savedTermios;
+    int rows = 0;
+    int columns = 0;
+    std::vector<std::string> frame;
+};
+
+} // end namespace xpum::cli
@@ -35,6 +35,7 @@
 #include "comlet_vgpu.h"
 #include "comlet_log.h"
 #include "comlet_topdown.h"
+#include "comlet_top.h"
 #include "comlet_sensor.h"
 #include "core_stub.h"
 #include "logger.h"
@@ -154,6 +155,7 @@ int main(int argc, char** argv) {
         .addComlet(MAKE_COMLET_PTR(xpum::cli::ComletVgpu))
         .addComlet(MAKE_COMLET_PTR(xpum::cli::ComletStatistics))
         .addComlet(MAKE_COMLET_PTR(xpum::cli::ComletDump))
+        .addComlet(MAKE_COMLET_PTR(xpum::cli::ComletTop))
         .addComlet(MAKE_COMLET_PTR(xpum::cli::ComletLog))
 #ifndef DAEMONLESS
         .addComlet(MAKE_COMLET_PTR(xpum::cli::ComletAgentSet))
@@ -0,0 +1,566 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file xpum_bench.cpp
+ */
+
+/*
+  xpum_bench measures the hot paths of the telemetry pipeline of xpumd on fake
+  devices that produce synthetic measurement data, so the cost of the daemon
+  itself can be compared between builds without any GPU:
+
+    - the ticks of a device sweep monitor task
+    - DataLogic::storeMeasurementData for each kind of data handler
+    - DataLogic::getLatestMetrics and DataLogic::getMetricsStatistics
+    - DumpDeviceSource::updateData of the raw data dump
+
+  Every benchmark runs with 1, 8, 16 and 64 devices, or the device counts
+  given on the command line.
+
+    xpum_bench [-i iterations] [-t monitor_ticks] [device_count ...]
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "control/device_manager_interface.h"
+#include "core/core.h"
+#include "data_logic/data_logic.h"
+#include "dump_raw_data/dump_task.h"
+#include "infrastructure/configuration.h"
+#include "infrastructure/internal_stats.h"
+#include "infrastructure/scheduled_thread_pool.h"
+#include "infrastructure/utility.h"
+#include "monitor/monitor_task.h"
+
+using namespace xpum;
+
+// the capabilities the fake devices provide
+static const std::vector<DeviceCapability> BENCH_CAPABILITIES = {
+    DeviceCapability::METRIC_POWER,
+    DeviceCapability::METRIC_FREQUENCY,
+    DeviceCapability::METRIC_TEMPERATURE,
+    DeviceCapability::METRIC_MEMORY_USED_UTILIZATION,
+    DeviceCapability::METRIC_MEMORY_THROUGHPUT_BANDWIDTH,
+    DeviceCapability::METRIC_COMPUTATION,
+    DeviceCapability::METRIC_ENERGY,
+};
+
+static uint64_t nowMicroseconds() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+  FakeDevice returns synthetic data shaped like the data of GPUDeviceStub,
+  the values change on every sample so the data handlers do their usual work.
+*/
+class FakeDevice : public Device {
+   public:
+    explicit FakeDevice(uint32_t index) : sample(index * 7) {
+        setId(std::to_string(index));
+        for (auto cap : BENCH_CAPABILITIES) {
+            addCapability(cap);
+        }
+        char bdf[32];
+        snprintf(bdf, sizeof(bdf), "0000:%02x:00.0", index + 1);
+        addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS, std::string(bdf)));
+        addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_SUBDEVICE, 0));
+        addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_DEVICE_NAME, std::string("xpum_bench device")));
+    }
+
+    static std::shared_ptr<MeasurementData> makeData(MeasurementType type, uint64_t sample) {
+        auto p_data = std::make_shared<MeasurementData>();
+        uint64_t timestamp = nowMicroseconds();
+        uint64_t scale = Configuration::DEFAULT_MEASUREMENT_DATA_SCALE;
+        switch (type) {
+            case MeasurementType::METRIC_POWER:
+                // the energy counter of a 100 W device, in microjoules
+                p_data->setRawData(scale * timestamp * 100);
+                p_data->setRawTimestamp(timestamp);
+                p_data->setScale(scale);
+                break;
+            case MeasurementType::METRIC_FREQUENCY:
+                p_data->setCurrent(1000 + sample % 600);
+                p_data->setSubdeviceAdditionalData(UINT32_MAX, MeasurementType::METRIC_REQUEST_FREQUENCY, 1600);
+                break;
+            case MeasurementType::METRIC_TEMPERATURE:
+                p_data->setCurrent(scale * (40 + sample % 30));
+                p_data->setScale(scale);
+                break;
+            case MeasurementType::METRIC_MEMORY_USED:
+                p_data->setCurrent((8ULL << 30) + (sample % 1024) * (1ULL << 20));
+                p_data->setSubdeviceAdditionalData(UINT32_MAX, MeasurementType::METRIC_MEMORY_UTILIZATION, scale * (50 + sample % 10), scale);
+                break;
+            case MeasurementType::METRIC_MEMORY_READ:
+                p_data->setCurrent(timestamp * 4096);
+                p_data->setSubdeviceAdditionalData(UINT32_MAX, MeasurementType::METRIC_MEMORY_WRITE, timestamp * 2048);
+                p_data->setSubdeviceAdditionalData(UINT32_MAX, MeasurementType::METRIC_MEMORY_READ_THROUGHPUT, timestamp * 4, 1, true, timestamp);
+                p_data->setSubdeviceAdditionalData(UINT32_MAX, MeasurementType::METRIC_MEMORY_WRITE_THROUGHPUT, timestamp * 2, 1, true, timestamp);
+                break;
+            case MeasurementType::METRIC_COMPUTATION: {
+                ExtendedMeasurementData data;
+                data.on_subdevice = false;
+                data.subdevice_id = 0;
+                data.type = ZES_ENGINE_GROUP_ALL;
+                data.active_time = timestamp / 2 + sample % 1000;
+                data.timestamp = timestamp;
+                p_data->addExtendedData(1, data);
+                break;
+            }
+            case MeasurementType::METRIC_ENERGY:
+                p_data->setCurrent(timestamp / 10);
+                break;
+            default:
+                p_data->setCurrent(sample);
+                break;
+        }
+        return p_data;
+    }
+
+    void getPower(Callback_t callback) noexcept override {
+        sampleData(callback, MeasurementType::METRIC_POWER);
+    }
+
+    void getActuralRequestFrequency(Callback_t callback) noexcept override {
+        sampleData(callback, MeasurementType::METRIC_FREQUENCY);
+    }
+
+    void getTemperature(Callback_t callback, zes_temp_sensors_t type) noexcept override {
+        sampleData(callback, MeasurementType::METRIC_TEMPERATURE);
+    }
+
+    void getMemoryUsedUtilization(Callback_t callback) noexcept override {
+        sampleData(callback, MeasurementType::METRIC_MEMORY_USED);
+    }
+
+    void getMemoryThroughputAndBandwidth(Callback_t callback) noexcept override {
+        sampleData(callback, MeasurementType::METRIC_MEMORY_READ);
+    }
+
+    void getGPUUtilization(Callback_t callback) noexcept override {
+        sampleData(callback, MeasurementType::METRIC_COMPUTATION);
+    }
+
+    void getEnergy(Callback_t callback) noexcept override {
+        sampleData(callback, MeasurementType::METRIC_ENERGY);
+    }
+
+    void getEngineUtilization(Callback_t callback) noexcept override {
+        unsupported(callback);
+    }
+
+    void getEngineGroupUtilization(Callback_t callback, zes_engine_group_t engine_group_type) noexcept override {
+        unsupported(callback);
+    }
+
+    void getEuActiveStallIdle(Callback_t callback, MeasurementType type) noexcept override {
+        unsupported(callback);
+    }
+
+    void getRasErrorOnSubdevice(Callback_t callback) noexcept override {
+        unsupported(callback);
+    }
+
+    void getFrequencyThrottle(Callback_t callback) noexcept override {
+        unsupported(callback);
+    }
+
+    void getFrequencyThrottleReason(Callback_t callback) noexcept override {
+        unsupported(callback);
+    }
+
+    void getPCIeReadThroughput(Callback_t callback) noexcept override {
+        unsupported(callback);
+    }
+
+    void getPCIeWriteThroughput(Callback_t callback) noexcept override {
+        unsupported(callback);
+    }
+
+    void getPCIeRead(Callback_t callback) noexcept override {
+        unsupported(callback);
+    }
+
+    void getPCIeWrite(Callback_t callback) noexcept override {
+        unsupported(callback);
+    }
+
+    void getFabricThroughput(Callback_t callback) noexcept override {
+        unsupported(callback);
+    }
+
+    void getPerfMetrics(Callback_t callback) noexcept override {
+        unsupported(callback);
+    }
+
+    void getVfEngineUtilization(Callback_t callback) noexcept override {
+        unsupported(callback);
+    }
+
+    bool isUpgradingFwResultReady(void) noexcept override {
+        return true;
+    }
+
+   private:
+    void sampleData(Callback_t& callback, MeasurementType type) {
+        callback(makeData(type, sample++), nullptr);
+    }
+
+    void unsupported(Callback_t& callback) {
+        callback(nullptr, std::make_shared<BaseException>("not supported by the benchmark device"));
+    }
+
+    std::atomic<uint64_t> sample;
+};
+
+// FakeDeviceManager only provides the device lists the telemetry pipeline reads
+class FakeDeviceManager : public DeviceManagerInterface {
+   public:
+    explicit FakeDeviceManager(uint32_t device_count) {
+        for (uint32_t i = 0; i < device_count; i++) {
+            devices.push_back(std::make_shared<FakeDevice>(i));
+        }
+    }
+
+    void init() override {}
+
+    void close() override {}
+
+    void getDeviceList(std::vector<std::shared_ptr<Device>>& devices) override {
+        devices = this->devices;
+    }
+
+    void getDeviceList(DeviceCapability cap, std::vector<std::shared_ptr<Device>>& devices) override {
+        for (auto& p_device : this->devices) {
+            if (p_device->hasCapability(cap)) {
+                devices.push_back(p_device);
+            }
+        }
+    }
+
+    std::shared_ptr<MeasurementData> getRealtimeMeasurementData(MeasurementType type, std::string& device_id) override {
+        return nullptr;
+    }
+
+    void getDeviceSchedulers(const std::string& id, std::vector<Scheduler>& schedulers) override {}
+
+    void getDeviceStandbys(const std::string& id, std::vector<Standby>& standbys) override {}
+
+    void getDevicePowerProps(const std::string& id, std::vector<Power>& powers) override {}
+
+    void getDevicePowerLimits(const std::string& id, Power_sustained_limit_t& sustained_limit,
+                              Power_burst_limit_t& burst_limit, Power_peak_limit_t& peak_limit) override {}
+
+    bool setDevicePowerSustainedLimits(const std::string& id, int32_t tileId, const Power_sustained_limit_t& sustained_limit) override {
+        return false;
+    }
+
+    bool setDevicePowerBurstLimits(const std::string& id, const Power_burst_limit_t& burst_limit) override {
+        return false;
+    }
+
+    bool setDevicePowerPeakLimits(const std::string& id, const Power_peak_limit_t& peak_limit) override {
+        return false;
+    }
+
+    void getDeviceFrequencyRanges(const std::string& id, std::vector<Frequency>& frequencies) override {}
+
+    bool setDeviceFrequencyRange(const std::string& id, const Frequency& freq) override {
+        return false;
+    }
+
+    bool setDeviceFrequencyRangeForAll(const std::string& id, const Frequency& freq) override {
+        return false;
+    }
+
+    bool setDeviceStandby(const std::string& id, const Standby& standby) override {
+        return false;
+    }
+
+    bool setDeviceSchedulerTimeoutMode(const std::string& id, const SchedulerTimeoutMode& mode) override {
+        return false;
+    }
+
+    bool setDeviceSchedulerTimesliceMode(const std::string& id, const SchedulerTimesliceMode& mode) override {
+        return false;
+    }
+
+    bool setDeviceSchedulerExclusiveMode(const std::string& id, const SchedulerExclusiveMode& mode) override {
+        return false;
+    }
+
+    bool setDeviceSchedulerDebugMode(const std::string& id, const SchedulerDebugMode& mode) override {
+        return false;
+    }
+
+    bool resetDevice(const std::string& id, bool force) override {
+        return false;
+    }
+
+    bool getPPRDiagHandle(const std::string& id, zes_diag_handle_t& diagHandle) override {
+        return false;
+    }
+
+    void getFreqAvailableClocks(const std::string& id, uint32_t subdevice_id, std::vector<double>& clocks) override {}
+
+    void getDeviceProcessState(const std::string& id, std::vector<device_process>& processes) override {}
+
+    void getDeviceUtilByProcess(const std::string& id, uint32_t utilInterval,
+                                std::vector<std::vector<device_util_by_proc>>& utils) override {}
+
+    void getPerformanceFactor(const std::string& id, std::vector<PerformanceFactor>& pf) override {}
+
+    bool setPerformanceFactor(const std::string& id, PerformanceFactor& pf) override {
+        return false;
+    }
+
+    bool getFabricPorts(const std::string& id, std::vector<port_info>& portInfo) override {
+        return false;
+    }
+
+    bool setFabricPorts(const std::string& id, const port_info_set& portInfoSet) override {
+        return false;
+    }
+
+    bool getEccState(const std::string& id, MemoryEcc& ecc) override {
+        return false;
+    }
+
+    bool setEccState(const std::string& id, ecc_state_t& newState, MemoryEcc& ecc) override {
+        return false;
+    }
+
+    std::shared_ptr<Device> getDevice(const std::string& id) override {
+        for (auto& p_device : devices) {
+            if (p_device->getId() == id) {
+                return p_device;
+            }
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<Device> getDevice(uint32_t index) override {
+        return index < devices.size() ? devices[index] : nullptr;
+    }
+
+    std::shared_ptr<Device> getDevicebyBDF(const std::string& bdf) override {
+        return nullptr;
+    }
+
+    bool discoverFabricLinks() override {
+        return false;
+    }
+
+    std::string getDeviceIDByFabricID(uint64_t fabric_id) override {
+        return "";
+    }
+
+    bool getFabricLinks(const std::string& id, std::vector<FabricLinkInfo>& links) override {
+        return false;
+    }
+
+    bool tryLockDevices(const std::vector<std::string>& deviceList) override {
+        return true;
+    }
+
+    bool tryLockDevices(std::vector<std::shared_ptr<Device>>& deviceList) override {
+        return true;
+    }
+
+    void unlockDevices(const std::vector<std::string>& deviceList) override {}
+
+    void unlockDevices(std::vector<std::shared_ptr<Device>>& deviceList) override {}
+
+    SystemInfo getSystemInfo() override {
+        return SystemInfo();
+    }
+
+   private:
+    std::vector<std::shared_ptr<Device>> devices;
+};
+
+static void report(const std::string& name, uint32_t device_count, uint64_t count, double total_ns) {
+    double mean_us = count > 0 ? total_ns / count / 1000 : 0;
+    printf("%-48s %8u %10llu %14.3f %14.3f\n", name.c_str(), device_count, (unsigned long long)count,
+           mean_us, device_count > 0 ? mean_us / device_count : 0);
+}
+
+// run f iterations times and report the mean time of a run
+static void measure(const std::string& name, uint32_t device_count, uint32_t iterations, const std::function<void()>& f) {
+    // one untimed run, so the first allocations of the handlers are not measured
+    f();
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        f();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+    report(name, device_count, iterations, elapsed);
+}
+
+// the count and sum of the internal statistics of type, by name
+static std::map<std::string, std::pair<uint64_t, uint64_t>> readInternalStats(xpum_internal_stats_type_t type) {
+    std::map<std::string, std::pair<uint64_t, uint64_t>> stats;
+    uint32_t count = 0;
+    InternalStats::instance().getStats(nullptr, &count);
+    std::vector<xpum_internal_stats_t> dataList(count);
+    if (count == 0 || InternalStats::instance().getStats(dataList.data(), &count) != XPUM_OK) {
+        return stats;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (dataList[i].type == type) {
+            auto& entry = stats[dataList[i].name];
+            entry.first += dataList[i].count;
+            entry.second += dataList[i].sum;
+        }
+    }
+    return stats;
+}
+
+static void benchMonitorTask(uint32_t device_count, uint32_t ticks, std::shared_ptr<DeviceManagerInterface>& p_device_manager,
+                             std::shared_ptr<DataLogicInterface>& p_data_logic) {
+    auto collect_begin = readInternalStats(XPUM_INTERNAL_STATS_MONITOR_COLLECT);
+    auto store_begin = readInternalStats(XPUM_INTERNAL_STATS_MONITOR_STORE);
+    auto ticks_begin = readInternalStats(XPUM_INTERNAL_STATS_MONITOR_TICK_LATENESS);
+
+    // ticks as close together as the scheduler allows, the tick cost is taken from the internal statistics
+    const int freq = 10;
+    auto p_thread_pool = std::make_shared<ScheduledThreadPool>(2);
+    auto p_task = std::make_shared<MonitorTask>(BENCH_CAPABILITIES, freq, p_device_manager, p_data_logic);
+    p_task->start(p_thread_pool);
+    std::this_thread::sleep_for(std::chrono::milliseconds(freq * (ticks + 1)));
+    p_task->stop();
+    p_thread_pool->close();
+
+    auto collect_end = readInternalStats(XPUM_INTERNAL_STATS_MONITOR_COLLECT);
+    auto store_end = readInternalStats(XPUM_INTERNAL_STATS_MONITOR_STORE);
+    auto ticks_end = readInternalStats(XPUM_INTERNAL_STATS_MONITOR_TICK_LATENESS);
+    uint64_t tick_count = ticks_end["DEVICE_SWEEP"].first - ticks_begin["DEVICE_SWEEP"].first;
+    uint64_t collect_ns = 0;
+    for (auto& entry : collect_end) {
+        collect_ns += entry.second.second - collect_begin[entry.first].second;
+    }
+    uint64_t store_ns = 0;
+    for (auto& entry : store_end) {
+        store_ns += entry.second.second - store_begin[entry.first].second;
+    }
+    report("MonitorTask tick: collect (sum of devices)", device_count, tick_count, collect_ns);
+    report("MonitorTask tick: store", device_count, tick_count, store_ns);
+}
+
+static void benchStoreMeasurementData(uint32_t device_count, uint32_t iterations, std::shared_ptr<DataLogicInterface>& p_data_logic) {
+    // one type of each kind of data handler
+    const std::vector<std::pair<MeasurementType, std::string>> types = {
+        {MeasurementType::METRIC_TEMPERATURE, "StatsDataHandler"},
+        {MeasurementType::METRIC_POWER, "TimeWeightedAverageDataHandler"},
+        {MeasurementType::METRIC_MEMORY_READ, "CounterDataHandler"},
+        {MeasurementType::METRIC_COMPUTATION, "GPUUtilizationDataHandler"},
+    };
+    for (auto& type : types) {
+        uint64_t sample = 0;
+        measure("storeMeasurementData: " + type.second, device_count, iterations, [&]() {
+            auto datas = std::make_shared<DeviceIndexMap<std::shared_ptr<MeasurementData>>>();
+            for (uint32_t i = 0; i < device_count; i++) {
+                (*datas)[i] = FakeDevice::makeData(type.first, sample);
+            }
+            sample++;
+            p_data_logic->storeMeasurementData(type.first, Utility::getCurrentMillisecond(), datas);
+        });
+    }
+}
+
+static void benchQueries(uint32_t device_count, uint32_t iterations, std::shared_ptr<DataLogicInterface>& p_data_logic) {
+    std::vector<xpum_device_metrics_t> metrics(1);
+    measure("DataLogic::getLatestMetrics (all devices)", device_count, iterations, [&]() {
+        for (uint32_t i = 0; i < device_count; i++) {
+            int count = metrics.size();
+            p_data_logic->getLatestMetrics(i, metrics.data(), &count);
+        }
+    });
+
+    std::vector<xpum_device_stats_t> stats(1);
+    measure("DataLogic::getMetricsStatistics (all devices)", device_count, iterations, [&]() {
+        for (uint32_t i = 0; i < device_count; i++) {
+            uint32_t count = stats.size();
+            uint64_t begin = 0, end = 0;
+            p_data_logic->getMetricsStatistics(i, stats.data(), &count, &begin, &end, 0, false);
+        }
+    });
+}
+
+static void benchDump(uint32_t device_count, uint32_t iterations, std::shared_ptr<DataLogicInterface>& p_data_logic) {
+    const std::vector<xpum_dump_type_t> dump_types = {
+        XPUM_DUMP_GPU_UTILIZATION,
+        XPUM_DUMP_POWER,
+        XPUM_DUMP_GPU_FREQUENCY,
+        XPUM_DUMP_GPU_CORE_TEMPERATURE,
+        XPUM_DUMP_MEMORY_UTILIZATION,
+        XPUM_DUMP_MEMORY_READ_THROUGHPUT,
+        XPUM_DUMP_ENERGY,
+        XPUM_DUMP_MEMORY_USED,
+    };
+    std::vector<std::unique_ptr<DumpDeviceSource>> sources;
+    for (uint32_t i = 0; i < device_count; i++) {
+        sources.emplace_back(new DumpDeviceSource(i, -1, dump_types, p_data_logic));
+        sources.back()->buildColumns();
+    }
+    measure("DumpDeviceSource::updateData (all devices)", device_count, iterations, [&]() {
+        for (auto& p_source : sources) {
+            p_source->updateData();
+        }
+    });
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "Usage: %s [-i iterations] [-t monitor_ticks] [device_count ...]\n", name);
+}
+
+int main(int argc, char** argv) {
+    uint32_t iterations = 1000;
+    uint32_t ticks = 100;
+    std::vector<uint32_t> device_counts;
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "-t") == 0) && i + 1 < argc) {
+            uint32_t value = std::max(atoi(argv[i + 1]), 1);
+            (argv[i][1] == 'i' ? iterations : ticks) = value;
+            i++;
+        } else if (atoi(argv[i]) > 0) {
+            device_counts.push_back(atoi(argv[i]));
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (device_counts.empty()) {
+        device_counts = {1, 8, 16, 64};
+    }
+
+    Configuration::init();
+    // the in-memory persistency, the benchmark must not write telemetry files
+    Configuration::PERSISTENCY_DIR.clear();
+
+    printf("%-48s %8s %10s %14s %14s\n", "benchmark", "devices", "runs", "mean (us)", "per device (us)");
+    for (auto device_count : device_counts) {
+        std::shared_ptr<DeviceManagerInterface> p_device_manager = std::make_shared<FakeDeviceManager>(device_count);
+        std::shared_ptr<DataLogicInterface> p_data_logic = std::make_shared<DataLogic>();
+        p_data_logic->init();
+        Core::instance().initForBench(p_device_manager, p_data_logic);
+
+        benchMonitorTask(device_count, ticks, p_device_manager, p_data_logic);
+        benchStoreMeasurementData(device_count, iterations, p_data_logic);
+        benchQueries(device_count, iterations, p_data_logic);
+        benchDump(device_count, iterations, p_data_logic);
+
+        p_data_logic->close();
+    }
+    return 0;
+}
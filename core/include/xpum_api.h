@@ -152,6 +152,21 @@ XPUM_API xpum_result_t xpumGetDeviceList(xpum_device_basic_info deviceList[], in
  */
 XPUM_API xpum_result_t xpumGetDeviceProperties(xpum_device_id_t deviceId, xpum_device_properties_t *pXpumProperties);
 
+/**
+ * @brief Get the properties of all devices in one call.
+ * @details The properties read from the device firmware, like the AMC firmware version and the ECC state,
+ * are read once for each device in the background and not again, \ref xpumGetDeviceProperties reads them again.
+ * 
+ * @param properties               OUT: The array to store the device properties
+ * @param count                 IN/OUT: When \a properties is NULL, \a count will be filled with the number of
+ *                                      available devices, and return.
+ *                                      When \a properties is not NULL, \a count denotes the length of \a properties,
+ *                                      when return, the \a count will store real number of devices returned
+ * @return \ref xpum_result_t 
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetAllDeviceProperties(xpum_device_properties_t properties[], int *count);
+
 /**
  * @brief Get device property name string
  * 
@@ -237,6 +252,38 @@ XPUM_API xpum_result_t xpumGetSerialNumberAndAmcFwVersion(xpum_device_id_t devic
  */
 XPUM_API xpum_result_t xpumGroupCreate(const char *groupName, xpum_group_id_t *pGroupId);
 
+/**
+ * @brief Create a dynamic group of the devices matching a selector
+ * @details The devices of the group are kept up to date by the daemon: the group is evaluated
+ * once for all the devices when it is created, then a device is evaluated again when a sample,
+ * a health event or the processes of the device change an attribute the selector uses. The
+ * group is read, aggregated and used by policies like any group, but devices can not be added
+ * to or removed from it.
+ * 
+ * @param groupName          IN: Group name for the group to create
+ * @param selector           IN: The conditions a device matches to be in the group
+ * @param pGroupId          OUT: Pointer to group id that newly created
+ * @return \ref xpum_result_t 
+ *      - \ref XPUM_OK                  if query successfully
+ *      - \ref XPUM_GENERIC_ERROR       if a pointer is NULL, or the selector has no condition or an unknown one
+ *      - \ref XPUM_GROUP_LIMIT_REACHED if there are XPUM_MAX_NUM_GROUPS groups
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGroupCreateBySelector(const char *groupName, const xpum_group_selector_t *selector, xpum_group_id_t *pGroupId);
+
+/**
+ * @brief Get the selector of a dynamic group
+ * 
+ * @param groupId            IN: The id of the group
+ * @param selector          OUT: The selector the group was created with
+ * @return \ref xpum_result_t 
+ *      - \ref XPUM_OK                      if query successfully
+ *      - \ref XPUM_RESULT_GROUP_NOT_FOUND  if the group does not exist
+ *      - \ref XPUM_GENERIC_ERROR           if the group is not a dynamic group
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGroupGetSelector(xpum_group_id_t groupId, xpum_group_selector_t *selector);
+
 /**
  * @brief Used to destroy a group represented by \a groupId.
  * 
@@ -641,6 +688,45 @@ XPUM_API xpum_result_t xpumGetDeviceComponentOccupancyRatio(xpum_device_id_t dev
                                                    xpum_device_components_ratio_t dataArray[],
                                                    uint32_t *count);
 
+/**
+ * @brief Get the performance metrics of the device collected by the monitor
+ * @details The values are the averages of the metrics in each sample, the samples of the last XPUM_PERF_METRIC_RETENTION milliseconds are kept. METRIC_PERF must be enabled in XPUM_METRICS.
+ *
+ * @param deviceId          IN: The device Id
+ * @param windowMs          IN: The metrics are aggregated over the samples of the last \a windowMs milliseconds, over all kept samples if it is 0
+ * @param dataList          OUT: First pass NULL to query the metric count. Then pass array with desired length to store the metrics.
+ * @param count             IN/OUT: When \a dataList is NULL, \a count will be filled with the number of metrics, and return. When \a dataList is not NULL, \a count denotes the length of \a dataList, \a count should be equal to or larger than the number of metrics, when return, the \a count will store real number of entries returned by \a dataList
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than needed
+ *      - \ref XPUM_METRIC_NOT_ENABLED  if METRIC_PERF is not enabled
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetPerfMetrics(xpum_device_id_t deviceId,
+                                          uint32_t windowMs,
+                                          xpum_perf_metric_t dataList[],
+                                          uint32_t *count);
+
+/**
+ * @brief Get the top-down analysis of the device computed by the monitor
+ * @details The ratios are derived from the METRIC_PERF samples of the monitor, so they are returned without sampling the device. The entry i of \a dataArray is the tile i. METRIC_PERF must be enabled in XPUM_METRICS.
+ *
+ * @param deviceId          IN: The device Id
+ * @param windowMs          IN: The metrics are averaged over the samples of the last \a windowMs milliseconds, over all kept samples if it is 0
+ * @param dataArray         OUT: First pass NULL to query the tile count. Then pass array with desired length to store the ratios.
+ * @param count             IN/OUT: When \a dataArray is NULL, \a count will be filled with the number of tiles, and return. When \a dataArray is not NULL, \a count denotes the length of \a dataArray, \a count should be equal to or larger than the number of tiles, when return, the \a count will store real number of entries returned by \a dataArray
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                      if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL        if \a count is smaller than needed
+ *      - \ref XPUM_METRIC_NOT_ENABLED      if METRIC_PERF is not enabled
+ *      - \ref XPUM_METRIC_NOT_SUPPORTED    if the monitor has no METRIC_PERF sample of the device
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetTopdownRatios(xpum_device_id_t deviceId,
+                                            uint32_t windowMs,
+                                            xpum_device_components_ratio_t dataArray[],
+                                            uint32_t *count);
+
 /**
  * @brief Get the device utiliztions by processes
  * @details This function is used to get the device utiliztions by process
@@ -966,6 +1052,37 @@ XPUM_API xpum_result_t xpumGetDiagnosticsXeLinkThroughputResult(xpum_device_id_t
                                                 xpum_diag_xe_link_throughput_t resultList[],
                                                 int *count);
 
+/**
+ * @brief Measure the Xe Link matrix of devices
+ * This function will return immediately. To get the matrix, call \ref xpumGetXeLinkMatrix
+ * 
+ * @details The bandwidth in one direction, in both directions at the same time, and the latency of the copies are
+ * measured for every pair of tiles that can access each other, with each copy engine group of the source tile. The
+ * matrix is kept with the topology until the next measure or a change of the PCI devices.
+ * 
+ * @param deviceIdList      IN: The devices to measure, all devices if \a count is 0
+ * @param count             IN: The number of devices in \a deviceIdList
+ * @return
+ *      - \ref XPUM_OK                                  if the measure is started successfully
+ *      - \ref XPUM_RESULT_DEVICE_NOT_FOUND             if a device is not found
+ *      - \ref XPUM_RESULT_DIAGNOSTIC_TASK_NOT_COMPLETE if a diagnostic, a stress test or a measure is running on the devices
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumRunXeLinkMatrix(xpum_device_id_t deviceIdList[], int count);
+
+/**
+ * @brief Get the last Xe Link matrix measured
+ * 
+ * @param entries           OUT: The tile pairs of the matrix
+ * @param count             IN/OUT: When \a entries is NULL, \a count will be filled with the number of entries, and return. When \a entries is not NULL, \a count denotes the length of \a entries, when return, the \a count will store real number of entries returned by \a entries
+ * @param running           OUT: If a measure is running, the entries are from the previous one
+ * @return
+ *      - \ref XPUM_OK                  if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than needed
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetXeLinkMatrix(xpum_xe_link_matrix_entry_t entries[], int *count, bool *running);
+
 /**
  * @brief Run stress test on GPU
  * This function will return immediately. To check status of a stress test , call \ref xpumCheckStress
@@ -977,6 +1094,25 @@ XPUM_API xpum_result_t xpumGetDiagnosticsXeLinkThroughputResult(xpum_device_id_t
  */
 XPUM_API xpum_result_t xpumRunStress(xpum_device_id_t deviceId, uint32_t stressTime);
 
+/**
+ * @brief Run stress test on GPU with a mix of workloads
+ * This function will return immediately. To check status of a stress test , call \ref xpumCheckStress
+ * 
+ * @details The workloads selected by \a options run at the same time, each one pauses between its rounds to keep the GPU busy for the target utilization.
+ * If a trace interval is given, a burst sampling is started on each device for the stress time, at most 60 seconds, its samples are read by \ref xpumGetBurstSamples.
+ * 
+ * @param deviceId          IN: Device id, -1 means run stress test on all GPU devices
+ * @param options           IN: The stress options
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                                  if the stress test is started successfully
+ *      - \ref XPUM_RESULT_DEVICE_NOT_FOUND             if the device is not found
+ *      - \ref XPUM_RESULT_DIAGNOSTIC_TASK_NOT_COMPLETE if a diagnostic or stress test is running on the device
+ *      - \ref XPUM_RESULT_STRESS_INVALID_OPTIONS       if the profiles or the target utilization are invalid
+ *      - \ref XPUM_INTERVAL_INVALID                    if the trace interval is out of range
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumRunStressWithOptions(xpum_device_id_t deviceId, const xpum_stress_options_t *options);
+
 /**
  * @brief Check stress test status
  * 
@@ -1077,7 +1213,7 @@ XPUM_API xpum_result_t xpumGetAgentConfig(xpum_agent_config_t key, void *value);
  * @param count     IN/OUT: When \a dataList is NULL, \a count will be filled with the number of available entries, and return. When \a dataList is not NULL, \a count denotes the length of \a dataList, \a count should be equal to or larger than the number of available entries, when return, the \a count will store real number of entries returned by \a dataList
  * @param begin        OUT: Timestamp in milliseconds, the time when aggregation starts
  * @param end          OUT: Timestamp in milliseconds, the time when aggregation ends
- * @param sessionId     IN: Statistics session id. Currently XPUM only supports two statistic sessions, their session ids are 0 and 1 respectively.
+ * @param sessionId     IN: Statistics session id, from 0 to 1023. Each session aggregates from its own previous query, a session queried for the first time aggregates from the start of XPUM.
  * @return xpum_result_t
  *      - \ref XPUM_OK                  if query successfully
  *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than needed
@@ -1090,6 +1226,32 @@ XPUM_API xpum_result_t xpumGetStats(xpum_device_id_t deviceId,
                            uint64_t *end,
                            uint64_t sessionId);
 
+/**
+ * @brief Get statistics data of some metrics by device, like \ref xpumGetStats
+ *
+ * @details Only the statistics of the metrics in \a metricsMask are read and returned, the statistics session of the
+ * other metrics is left as it is.
+ *
+ * @param deviceId      IN: Device id
+ * @param metricsMask   IN: Bit (1 << type) for each \ref xpum_stats_type_t type to read, 0 for all metrics
+ * @param dataList     OUT: The arry to store statistics data for device \a deviceId. First pass NULL to query statistics data count. Then pass array with desired length to store statistics data.
+ * @param count     IN/OUT: When \a dataList is NULL, \a count will be filled with the number of available entries, and return. When \a dataList is not NULL, \a count denotes the length of \a dataList, \a count should be equal to or larger than the number of available entries, when return, the \a count will store real number of entries returned by \a dataList
+ * @param begin        OUT: Timestamp in milliseconds, the time when aggregation starts
+ * @param end          OUT: Timestamp in milliseconds, the time when aggregation ends
+ * @param sessionId     IN: Statistics session id, from 0 to 1023
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than needed
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetStatsByMask(xpum_device_id_t deviceId,
+                                 uint64_t metricsMask,
+                                 xpum_device_stats_t dataList[],
+                                 uint32_t *count,
+                                 uint64_t *begin,
+                                 uint64_t *end,
+                                 uint64_t sessionId);
+
 /**
  * @brief Get statistics data (not including per engine utilization & fabric throughput) by device list
  * 
@@ -1099,7 +1261,7 @@ XPUM_API xpum_result_t xpumGetStats(xpum_device_id_t deviceId,
  * @param count     IN/OUT: When \a dataList is NULL, \a count will be filled with the number of available entries, and return. When \a dataList is not NULL, \a count denotes the length of \a dataList, \a count should be equal to or larger than the number of available entries, when return, the \a count will store real number of entries returned by \a dataList
  * @param begin        OUT: Timestamp in milliseconds, the time when aggregation starts
  * @param end          OUT: Timestamp in milliseconds, the time when aggregation ends
- * @param sessionId     IN: Statistics session id. Currently XPUM only supports two statistic sessions, their session ids are 0 and 1 respectively.
+ * @param sessionId     IN: Statistics session id, from 0 to 1023. Each session aggregates from its own previous query, a session queried for the first time aggregates from the start of XPUM.
  * @return xpum_result_t
  *      - \ref XPUM_OK                  if query successfully
  *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than needed
@@ -1113,6 +1275,318 @@ XPUM_API xpum_result_t xpumGetStatsEx(xpum_device_id_t deviceIdList[],
                              uint64_t *end,
                              uint64_t sessionId);
 
+/**
+ * @brief Get statistics, per engine utilization and fabric throughput of devices in one snapshot buffer
+ *
+ * @details The snapshot starts with a \ref xpum_telemetry_snapshot_header_t, followed by the schema of the metrics in
+ * it and the records of the devices, tiles, engines and fabric links, each followed by its values. The structs are
+ * 8 bytes aligned in the buffer. All devices are read from the same sampling ticks, like \ref xpumGetStatsEx. The
+ * buffer can be kept by the caller for the next calls, and copied as a whole to other processes.
+ *
+ * @param deviceIdList  IN: Device id list, all devices if \a deviceCount is 0
+ * @param deviceCount   IN: Device id count
+ * @param buffer       OUT: The buffer to store the snapshot, 8 bytes aligned. First pass NULL to query the size needed.
+ * @param size      IN/OUT: When \a buffer is NULL, \a size will be filled with a size enough for the snapshot of the devices, and return. When \a buffer is not NULL, \a size denotes the length of \a buffer, when return, the \a size will store the size of the snapshot
+ * @param sessionId     IN: Statistics session id, from 0 to 1023. Each session aggregates from its own previous query, a session queried for the first time aggregates from the start of XPUM.
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL    if \a size is smaller than needed, \a size is filled with the size needed. The statistics of the call are lost for the session.
+ *      - \ref XPUM_RESULT_DEVICE_NOT_FOUND if a device id is invalid
+ *      - \ref XPUM_UNSUPPORTED_SESSIONID   if \a sessionId is invalid
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetTelemetrySnapshot(xpum_device_id_t deviceIdList[],
+                                       uint32_t deviceCount,
+                                       void *buffer,
+                                       uint32_t *size,
+                                       uint64_t sessionId);
+
+/**
+ * @brief Get the history of metrics by device from the persisted telemetry data
+ * 
+ * @details This API returns downsampled series computed from the samples persisted by the daemon (see --persistency_folder). Each series holds one point per \a step that has samples, with the min, avg and max values of the step. The points are computed from the raw samples, or from the 10 second or 1 minute rollups when \a step is as long and for the ranges older than the raw samples kept, so the history reaches back days and months at a coarser resolution. The points of a counter metric, like energy, RAS errors or PCIe bytes, hold the accumulated counter values read from the device, the difference of two points is the count over their interval. The metrics disabled by XPUM_METRICS have no series.
+ * 
+ * @param deviceId          IN: Device id
+ * @param metricsTypes      IN: The metric types to query
+ * @param metricsTypeCount  IN: The count of \a metricsTypes
+ * @param begin             IN: Timestamp in milliseconds, the begin of the time range
+ * @param end               IN: Timestamp in milliseconds, the end of the time range
+ * @param step              IN: The length in milliseconds of the time span aggregated into one point
+ * @param seriesList       OUT: The array to store the series description. First pass NULL to query the series and point count. Then pass arrays with desired length to store the series and points.
+ * @param seriesCount   IN/OUT: When \a seriesList is NULL, \a seriesCount will be filled with the number of available series, and return. When \a seriesList is not NULL, \a seriesCount denotes the length of \a seriesList, when return, it stores the real number of series returned
+ * @param pointList        OUT: The array to store the points of all series, each series refers to its points by offset and count
+ * @param pointCount    IN/OUT: Same as \a seriesCount, for \a pointList
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL    if \a seriesCount or \a pointCount is smaller than needed
+ *      - \ref XPUM_INTERVAL_INVALID    if the time range or \a step is invalid, or the range holds too many steps
+ *      - \ref XPUM_METRIC_NOT_SUPPORTED if a metric type in \a metricsTypes is invalid
+ *      - \ref XPUM_API_UNSUPPORTED     if the telemetry data is not persisted
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetMetricsHistory(xpum_device_id_t deviceId,
+                                    xpum_stats_type_t metricsTypes[],
+                                    uint32_t metricsTypeCount,
+                                    uint64_t begin,
+                                    uint64_t end,
+                                    uint64_t step,
+                                    xpum_metrics_history_t seriesList[],
+                                    uint32_t *seriesCount,
+                                    xpum_metrics_history_point_t pointList[],
+                                    uint32_t *pointCount);
+
+/**
+ * @brief Get the histograms of the main gauge metrics by device
+ * 
+ * @details The histograms hold every sample collected since xpumInit for power, GPU utilization, memory utilization, GPU core temperature and memory temperature, at the monitor frequency. They are never reset, so the counts of their bins can be exported as cumulative counters.
+ * 
+ * @param deviceId          IN: Device id
+ * @param histogramList    OUT: The array to store the histogram description. First pass NULL to query the histogram and bin count. Then pass arrays with desired length to store the histograms and bins.
+ * @param histogramCount IN/OUT: When \a histogramList is NULL, \a histogramCount will be filled with the number of available histograms, and return. When \a histogramList is not NULL, \a histogramCount denotes the length of \a histogramList, when return, it stores the real number of histograms returned
+ * @param binList          OUT: The array to store the bins of all histograms, each histogram refers to its bins by offset and binCount
+ * @param binCount      IN/OUT: Same as \a histogramCount, for \a binList
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL    if \a histogramCount or \a binCount is smaller than needed
+ *      - \ref XPUM_RESULT_DEVICE_NOT_FOUND if the device is not found
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetMetricsHistograms(xpum_device_id_t deviceId,
+                                       xpum_metrics_histogram_t histogramList[],
+                                       uint32_t *histogramCount,
+                                       xpum_metrics_histogram_bin_t binList[],
+                                       uint32_t *binCount);
+
+/**
+ * @brief Get the time the device and its tiles spent with each frequency throttle reason
+ * 
+ * @details The times are accumulated from the samples of XPUM_STATS_FREQUENCY_THROTTLE_REASON_GPU at the monitor frequency since xpumInit. They are never reset, so they can be exported as cumulative counters. A throttle episode shorter than the monitor period is counted if a sample falls into it.
+ * 
+ * @param deviceId          IN: Device id
+ * @param dataList         OUT: The array to store the residencies, device level data first. First pass NULL to query the count.
+ * @param count         IN/OUT: When \a dataList is NULL, \a count will be filled with the number of available entries, and return. When \a dataList is not NULL, \a count denotes the length of \a dataList, when return, it stores the real number of entries returned
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than needed
+ *      - \ref XPUM_RESULT_DEVICE_NOT_FOUND if the device is not found
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetThrottleResidency(xpum_device_id_t deviceId,
+                                                xpum_throttle_residency_t dataList[],
+                                                uint32_t *count);
+
+/**
+ * @brief Get the DRAM and UPI traffic of the host sockets
+ * 
+ * @details The host telemetry is enabled by the environment variable XPUM_HOST_TELEMETRY=1. It programs the memory controller and UPI uncore counters of the CPUs, like pcm-memory, and samples them in the same windows as the PCIe throughput of the devices, every XPUM_PCIE_SAMPLING_INTERVAL milliseconds.
+ * 
+ * @param dataList         OUT: The array to store the socket telemetry. First pass NULL to query the count.
+ * @param count         IN/OUT: When \a dataList is NULL, \a count will be filled with the number of available entries, and return. When \a dataList is not NULL, \a count denotes the length of \a dataList, when return, it stores the real number of entries returned
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than needed
+ *      - \ref XPUM_METRIC_NOT_ENABLED  if the host telemetry is not enabled
+ *      - \ref XPUM_METRIC_NOT_SUPPORTED if the uncore counters of the CPUs are not available
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetHostSocketTelemetry(xpum_host_socket_telemetry_t dataList[],
+                                                  uint32_t *count);
+
+/**
+ * @brief Get the inbound PCIe traffic of the IIO stacks of the host sockets
+ * 
+ * @details The stacks are sampled with the host sockets, see \ref xpumGetHostSocketTelemetry.
+ * 
+ * @param dataList         OUT: The array to store the stack telemetry. First pass NULL to query the count.
+ * @param count         IN/OUT: When \a dataList is NULL, \a count will be filled with the number of available entries, and return. When \a dataList is not NULL, \a count denotes the length of \a dataList, when return, it stores the real number of entries returned
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than needed
+ *      - \ref XPUM_METRIC_NOT_ENABLED  if the host telemetry is not enabled
+ *      - \ref XPUM_METRIC_NOT_SUPPORTED if the uncore counters of the CPUs are not available
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetHostIioStackTelemetry(xpum_host_iio_stack_telemetry_t dataList[],
+                                                    uint32_t *count);
+
+/**
+ * @brief Open a job window to account the telemetry of a set of devices
+ * 
+ * @details Energy, power, GPU utilization and memory used of the devices are integrated from every sample collected while the window is open, until \ref xpumCloseJobWindow is called.
+ * 
+ * @param jobId         IN: The job id, for example the scheduler job id or the Kubernetes pod name
+ * @param deviceIdList  IN: The devices used by the job
+ * @param deviceCount   IN: The count of \a deviceIdList
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                          if the window is opened successfully
+ *      - \ref XPUM_RESULT_DEVICE_NOT_FOUND     if a device in \a deviceIdList is not found
+ *      - \ref XPUM_RESULT_JOB_WINDOW_EXISTS    if a window with the same \a jobId is already open
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumOpenJobWindow(const char *jobId,
+                                         xpum_device_id_t deviceIdList[],
+                                         uint32_t deviceCount);
+
+/**
+ * @brief Get the accounting data of an open job window without closing it
+ * 
+ * @param jobId         IN: The job id
+ * @param dataList     OUT: The array to store the accounting data, one entry per device. First pass NULL to query the count. Then pass array with desired length to store the data.
+ * @param count     IN/OUT: When \a dataList is NULL, \a count will be filled with the number of devices of the job, and return. When \a dataList is not NULL, \a count denotes the length of \a dataList, when return, it stores the real number of entries returned
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                          if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL            if \a count is smaller than needed
+ *      - \ref XPUM_RESULT_JOB_WINDOW_NOT_FOUND if no window is open for \a jobId
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetJobWindowStats(const char *jobId,
+                                             xpum_job_window_stats_t dataList[],
+                                             uint32_t *count);
+
+/**
+ * @brief Get the energy of an open job window attributed to the processes of its devices
+ * 
+ * @details The energy of a device is attributed by the busy time of the engines of each process, so processes sharing a device are charged for the time they used it. It needs a driver exposing the busy time of the drm clients in sysfs, otherwise all the energy is in the entries of process id 0.
+ * 
+ * @param jobId         IN: The job id
+ * @param dataList     OUT: The array to store the energy, one entry per process of each device. First pass NULL to query the count. Then pass array with desired length to store the data.
+ * @param count     IN/OUT: When \a dataList is NULL, \a count will be filled with the number of entries, and return. When \a dataList is not NULL, \a count denotes the length of \a dataList, when return, it stores the real number of entries returned
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                          if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL            if \a count is smaller than needed
+ *      - \ref XPUM_RESULT_JOB_WINDOW_NOT_FOUND if no window is open for \a jobId
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetJobWindowProcessEnergy(const char *jobId,
+                                                     xpum_job_process_energy_t dataList[],
+                                                     uint32_t *count);
+
+/**
+ * @brief Get the efficiency of the counters the processes of a device publish with xpum_app_counters.h
+ * 
+ * @details The counters are read on every energy sample of the device, so METRIC_ENERGY must be enabled. Like the energy of a
+ * job window, it needs a driver exposing the busy time of the drm clients in sysfs, otherwise no work is attributed to the device.
+ * 
+ * @param deviceId      IN: Device id
+ * @param dataList     OUT: The array to store the efficiency, one entry per counter of each process. First pass NULL to query the count. Then pass array with desired length to store the data.
+ * @param count     IN/OUT: When \a dataList is NULL, \a count will be filled with the number of entries, and return. When \a dataList is not NULL, \a count denotes the length of \a dataList, when return, it stores the real number of entries returned
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                          if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL            if \a count is smaller than needed
+ *      - \ref XPUM_RESULT_DEVICE_NOT_FOUND     if the device is not found
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetAppCounterEfficiency(xpum_device_id_t deviceId,
+                                                   xpum_app_counter_efficiency_t dataList[],
+                                                   uint32_t *count);
+
+/**
+ * @brief Close a job window and get its accounting data
+ * 
+ * @param jobId         IN: The job id
+ * @param dataList     OUT: Same as \ref xpumGetJobWindowStats. The window is only closed when \a dataList is not NULL.
+ * @param count     IN/OUT: Same as \ref xpumGetJobWindowStats
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                          if the window is closed successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL            if \a count is smaller than needed
+ *      - \ref XPUM_RESULT_JOB_WINDOW_NOT_FOUND if no window is open for \a jobId
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumCloseJobWindow(const char *jobId,
+                                          xpum_job_window_stats_t dataList[],
+                                          uint32_t *count);
+
+/**
+ * @brief Start a burst sampling on a device
+ * 
+ * @details A small set of metrics is sampled at a short interval for a bounded duration, bypassing the periodic monitor. Samples are kept in a ring buffer until they are read by \ref xpumGetBurstSamples.
+ * 
+ * @param deviceId          IN: Device id
+ * @param metricsTypes      IN: The metrics to sample, XPUM_STATS_POWER, XPUM_STATS_GPU_FREQUENCY or XPUM_STATS_GPU_UTILIZATION
+ * @param metricsTypeCount  IN: The count of \a metricsTypes
+ * @param interval          IN: Sampling interval in milliseconds, no shorter than 10
+ * @param duration          IN: Sampling duration in milliseconds, no longer than 60000
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                              if the sampling is started successfully
+ *      - \ref XPUM_RESULT_DEVICE_NOT_FOUND         if the device is not found
+ *      - \ref XPUM_INTERVAL_INVALID                if \a interval or \a duration is out of range
+ *      - \ref XPUM_METRIC_NOT_SUPPORTED            if a metric in \a metricsTypes can not be burst sampled
+ *      - \ref XPUM_RESULT_BURST_SAMPLING_RUNNING   if a burst sampling is already running on the device
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumStartBurstSampling(xpum_device_id_t deviceId,
+                                              xpum_stats_type_t metricsTypes[],
+                                              uint32_t metricsTypeCount,
+                                              uint32_t interval,
+                                              uint32_t duration);
+
+/**
+ * @brief Read the pending samples of a burst sampling
+ * 
+ * @param deviceId      IN: Device id
+ * @param sampleList   OUT: The array to store the samples, oldest first. Samples copied to it are removed from the ring buffer.
+ * @param count     IN/OUT: When \a sampleList is NULL, \a count will be filled with the number of pending samples, and return. When \a sampleList is not NULL, \a count denotes the length of \a sampleList, when return, it stores the real number of samples returned
+ * @param running      OUT: If the sampling is still running. Once it is false and \a count is 0, all samples have been read.
+ * @param dropped      OUT: The count of samples dropped because the ring buffer was full
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                              if query successfully
+ *      - \ref XPUM_RESULT_BURST_SAMPLING_NOT_FOUND if no burst sampling was started on the device
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetBurstSamples(xpum_device_id_t deviceId,
+                                           xpum_burst_sample_t sampleList[],
+                                           uint32_t *count,
+                                           bool *running,
+                                           uint64_t *dropped);
+
+/**
+ * @brief Stop a burst sampling and discard its pending samples
+ * 
+ * @param deviceId      IN: Device id
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                              if the sampling is stopped successfully
+ *      - \ref XPUM_RESULT_BURST_SAMPLING_NOT_FOUND if no burst sampling was started on the device
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumStopBurstSampling(xpum_device_id_t deviceId);
+
+/**
+ * @brief Get the correlation of the timer of a device with the host clocks
+ * 
+ * @details The device timer and the host clocks are read together by zeDeviceGetGlobalTimestamps every second, a line is fitted
+ * to the latest samples to model the offset and the drift of the device timer. Device timestamps, like those of the metric
+ * streamer reports or of the kernels of an application, are converted to the host clocks with the model.
+ * 
+ * @param deviceId          IN: Device id
+ * @param correlation      OUT: The correlation of the device
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                              if query successfully
+ *      - \ref XPUM_RESULT_DEVICE_NOT_FOUND         if the device is not found
+ *      - \ref XPUM_RESULT_CLOCK_NOT_CORRELATED     if the timer of the device can not be read with the host clock
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetDeviceClockCorrelation(xpum_device_id_t deviceId,
+                                                     xpum_clock_correlation_t *correlation);
+
+/**
+ * @brief Convert a timestamp of the timer of a device to a host clock
+ * 
+ * @param deviceId          IN: Device id
+ * @param deviceTimestamp   IN: The device timer in ticks, as written by zeCommandListAppendWriteGlobalTimestamp
+ * @param domain            IN: The host clock to convert to
+ * @param hostTimestamp    OUT: The time of the host clock in nanoseconds
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                              if converted successfully
+ *      - \ref XPUM_RESULT_DEVICE_NOT_FOUND         if the device is not found
+ *      - \ref XPUM_GENERIC_ERROR                   if \a domain is invalid
+ *      - \ref XPUM_RESULT_CLOCK_NOT_CORRELATED     if the timer of the device can not be read with the host clock
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumConvertDeviceTimestamp(xpum_device_id_t deviceId,
+                                                  uint64_t deviceTimestamp,
+                                                  xpum_clock_domain_t domain,
+                                                  uint64_t *hostTimestamp);
+
 /**
  * @brief Get engine statistics data by device
  * 
@@ -1122,7 +1596,7 @@ XPUM_API xpum_result_t xpumGetStatsEx(xpum_device_id_t deviceIdList[],
  *                          When return, \a count will store the actual number of entries stored in \a dataList.
  * @param begin        OUT: Timestamp in milliseconds, the time when aggregation starts
  * @param end          OUT: Timestamp in milliseconds, the time when aggregation ends
- * @param sessionId     IN: Statistics session id. Currently XPUM only supports two statistic sessions, their session ids are 0 and 1 respectively.
+ * @param sessionId     IN: Statistics session id, from 0 to 1023. Each session aggregates from its own previous query, a session queried for the first time aggregates from the start of XPUM.
  * @return xpum_result_t
  *      - \ref XPUM_OK                  if query successfully
  *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than needed
@@ -1145,7 +1619,7 @@ XPUM_API xpum_result_t xpumGetEngineStats(xpum_device_id_t deviceId,
  *                          When return, \a count will store the actual number of entries stored in \a dataList.
  * @param begin        OUT: Timestamp in milliseconds, the time when aggregation starts
  * @param end          OUT: Timestamp in milliseconds, the time when aggregation ends
- * @param sessionId     IN: Statistics session id. Currently XPUM only supports two statistic sessions, their session ids are 0 and 1 respectively.
+ * @param sessionId     IN: Statistics session id, from 0 to 1023. Each session aggregates from its own previous query, a session queried for the first time aggregates from the start of XPUM.
  * @return xpum_result_t
  *      - \ref XPUM_OK                  if query successfully
  *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than needed
@@ -1168,7 +1642,7 @@ XPUM_API xpum_result_t xpumGetEngineStatsEx(xpum_device_id_t deviceIdList[],
  *                          When return, \a count will store the actual number of entries stored in \a dataList.
  * @param begin        OUT: Timestamp in milliseconds, the time when aggregation starts
  * @param end          OUT: Timestamp in milliseconds, the time when aggregation ends
- * @param sessionId     IN: Statistics session id. Currently XPUM only supports two statistic sessions, their session ids are 0 and 1 respectively.
+ * @param sessionId     IN: Statistics session id, from 0 to 1023. Each session aggregates from its own previous query, a session queried for the first time aggregates from the start of XPUM.
  * @return xpum_result_t
  *      - \ref XPUM_OK                  if query successfully
  *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than needed
@@ -1191,7 +1665,7 @@ XPUM_API xpum_result_t xpumGetFabricThroughputStats(xpum_device_id_t deviceId,
  *                          When return, \a count will store the actual number of entries stored in \a dataList.
  * @param begin        OUT: Timestamp in milliseconds, the time when aggregation starts
  * @param end          OUT: Timestamp in milliseconds, the time when aggregation ends
- * @param sessionId     IN: Statistics session id. Currently XPUM only supports two statistic sessions, their session ids are 0 and 1 respectively.
+ * @param sessionId     IN: Statistics session id, from 0 to 1023. Each session aggregates from its own previous query, a session queried for the first time aggregates from the start of XPUM.
  * @return xpum_result_t
  *      - \ref XPUM_OK                  if query successfully
  *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than needed
@@ -1207,6 +1681,11 @@ XPUM_API xpum_result_t xpumGetFabricThroughputStatsEx(xpum_device_id_t deviceIdL
 /**
  * @brief Get metrics data from sysfs
  * 
+ * Power, energy, temperature, frequency and memory used are read from sysfs and hwmon, without initializing Level Zero.
+ * The files of a device are opened on the first call and kept open. For each BDF, a device level entry followed by the
+ * tile entries is stored, with the index of the BDF in \a bdfs as device id. Power is derived from the energy read by
+ * the previous call if it is at least 10 ms and at most 10 s old, otherwise the call sleeps 50 ms once for all devices.
+ * 
  * @param bdfs          IN: The array of PCI BDF address strings
  * @param length        IN: The length of array \a bdfs
  * @param dataList     OUT: The array to store metrics data for device \a bdfs.
@@ -1231,7 +1710,7 @@ XPUM_API xpum_result_t xpumGetMetricsFromSysfs(const char **bdfs,
  * @param count     IN/OUT: When \a dataList is NULL, \a count will be filled with the number of available entries, and return. When \a dataList is not NULL, \a count denotes the length of \a dataList, \a count should be equal to or larger than the number of available entries, when return, the \a count will store real number of entries returned by \a dataList  
  * @param begin        OUT: Timestamp in milliseconds, the time when aggregation starts
  * @param end          OUT: Timestamp in milliseconds, the time when aggregation ends
- * @param sessionId     IN: Statistics session id. Currently XPUM only supports two statistic sessions, their session ids are 0 and 1 respectively.
+ * @param sessionId     IN: Statistics session id, from 0 to 1023. Each session aggregates from its own previous query, a session queried for the first time aggregates from the start of XPUM.
  * @return xpum_result_t 
  *      - \ref XPUM_OK                  if query successfully
  *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than device count of group
@@ -1243,6 +1722,23 @@ XPUM_API xpum_result_t xpumGetStatsByGroup(xpum_group_id_t groupId,
                                   uint64_t *begin,
                                   uint64_t *end,
                                   uint64_t sessionId);
+
+/**
+ * @brief Get the latest metrics of a group aggregated over its devices
+ * @details The aggregation is done once per sampling tick for each group, so the query does not read the devices of the group.
+ * 
+ * @param groupId       IN: Group id
+ * @param dataList     OUT: The array to store the aggregated metrics, one entry per metric type. First pass NULL to query the count. Then pass array with desired length to store the data.
+ * @param count     IN/OUT: When \a dataList is NULL, \a count will be filled with the number of available entries, and return. When \a dataList is not NULL, \a count denotes the length of \a dataList, when return, it stores the real number of entries returned
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                      if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL        if \a count is smaller than needed
+ *      - \ref XPUM_RESULT_GROUP_NOT_FOUND  if the group is not found
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetMetricsAggregatedByGroup(xpum_group_id_t groupId,
+                                                       xpum_group_metric_data_t dataList[],
+                                                       uint32_t *count);
 /// @endcond                                  
 
 /** @} */ // Closing for STATISTICS_API
@@ -1300,6 +1796,33 @@ XPUM_API xpum_result_t xpumStartDumpRawDataTaskEx(xpum_device_id_t deviceId,
                                        xpum_dump_raw_data_option_t dumpOptions,
                                        xpum_dump_raw_data_task_t *taskInfo);
 
+/**
+ * @brief Start one dump raw data task for multiple devices. All the devices are sampled in the same
+ * tick with a shared timestamp and written into one dump file, the layout of the file is set by
+ * \a dumpOptions.layout. Only device level data is dumped.
+ * 
+ * @param deviceIdList  IN: Devices to dump
+ * @param deviceCount   IN: The count of entries in \a deviceIdList, at most XPUM_MAX_NUM_DEVICES
+ * @param dumpTypeList  IN: metrics to dump
+ * @param count         IN: The count of entries in \a dumpTypeList
+ * @param dumpFilePath  IN: The path of file to dump raw data
+ * @param dumpOptions   IN: Dump Options for Raw Data Task
+ * @param taskInfo      OUT: The info of the task just created
+ * @return xpum_result_t 
+ *      - \ref XPUM_OK  if query successfully
+ *      - \ref XPUM_RESULT_DEVICE_NOT_FOUND  if any of the devices is not found
+ *      - \ref XPUM_RESULT_DUMP_METRICS_TYPE_NOT_SUPPORT  if not supported metrics type passed in
+ *      - \ref XPUM_GENERIC_ERROR if other error happens
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumStartDumpRawDataTaskMultiDevice(const xpum_device_id_t deviceIdList[],
+                                       const int deviceCount,
+                                       const xpum_dump_type_t dumpTypeList[],
+                                       const int count,
+                                       const char *dumpFilePath,
+                                       xpum_dump_raw_data_option_t dumpOptions,
+                                       xpum_dump_raw_data_task_t *taskInfo);
+
 /**
  * @brief Stop write to dumpFilePath
  * 
@@ -1380,6 +1903,23 @@ XPUM_API xpum_result_t xpumExportTopology2XML(char xmlBuffer[], int *memSize);
  */
 XPUM_API xpum_result_t xpumGetXelinkTopology(xpum_xelink_topo_info xelink_topo[], int *count);
 
+/**
+ * @brief Get the placement advice of a device set for collectives
+ * 
+ * The devices are ordered in a ring that prefers Xe Link, then the fewest PCIe bridges within a NUMA node, and
+ * a spanning tree over the same links is rooted at the first device of the ring.
+ * 
+ * @param deviceIdList  IN: The devices to place, all devices if \a count is 0
+ * @param count         IN: The number of devices in \a deviceIdList, at most XPUM_MAX_NUM_DEVICES
+ * @param advice        OUT: The ring and tree orders, and the NUMA nodes and CPUs local to the devices
+ * @return
+ *      - \ref XPUM_OK                          if query successfully
+ *      - \ref XPUM_RESULT_DEVICE_NOT_FOUND     if a device is not found
+ *      - \ref XPUM_BUFFER_TOO_SMALL            if there are more than XPUM_MAX_NUM_DEVICES devices
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetPlacementAdvice(xpum_device_id_t deviceIdList[], int count, xpum_placement_advice_t *advice);
+
 /** @} */ // Closing for TOPOLOGY_API
 
 /// @cond DAEMON_ONLY
@@ -1488,6 +2028,31 @@ XPUM_API xpum_result_t xpumDoVgpuPrecheck(xpum_vgpu_precheck_result_t *result);
  */
 XPUM_API xpum_result_t xpumCreateVf(xpum_device_id_t deviceId, xpum_vgpu_config_t *conf);
 
+/**
+ * @brief Create VF in the background
+ *
+ * The configuration is validated before the function returns, then the VF attributes are written
+ * in the background. The progress and the result can be read by \ref xpumGetVgpuProvisionStatus.
+ *
+ * @param deviceId           IN: Device Id
+ * @param conf               IN: Configurations for creating VFs
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                               if the creation is started
+ *      - \ref XPUM_RESULT_VGPU_PROVISION_RUNNING    if VFs are being created or removed on the device
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumCreateVfAsync(xpum_device_id_t deviceId, xpum_vgpu_config_t *conf);
+
+/**
+ * @brief Get the progress of the VF creation or removal on a device
+ *
+ * @param deviceId           IN: Device Id
+ * @param status             OUT: The progress of the running provisioning, or the result of the last one
+ * @return xpum_result_t
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetVgpuProvisionStatus(xpum_device_id_t deviceId, xpum_vgpu_provision_status_t *status);
+
 /**
  * @brief Get a list containing both PF and VFs
  * 
@@ -1530,7 +2095,7 @@ XPUM_API xpum_result_t xpumGetVfMetrics(xpum_device_id_t deviceId, xpum_vf_metri
 
 /**************************************************************************/
 /** @defgroup DEBUG_LOG_API Debug log api
- * These APIs are for debug log generating
+ * These APIs are for debug log generating and the internal statistics of XPUM
  * @{
  */
 /**************************************************************************/
@@ -1544,6 +2109,46 @@ XPUM_API xpum_result_t xpumGetVfMetrics(xpum_device_id_t deviceId, xpum_vf_metri
  */
 XPUM_API xpum_result_t xpumGenerateDebugLog(const char *fileName);
 
+/**
+ * @brief Get the latency statistics of the Level Zero calls and of the handle locks taken for them
+ *
+ * The statistics are always collected. They tell whether a slow query is caused by the driver, by the lock
+ * contention on the Level Zero handles or by XPUM itself.
+ *
+ * @param dataList     OUT: The array to store the statistics, one entry per type, operation and device. First pass NULL to query the count of entries.
+ * @param count     IN/OUT: When \a dataList is NULL, \a count will be filled with the number of available entries, and return. When \a dataList is not NULL, \a count denotes the length of \a dataList, \a count should be equal to or larger than the number of available entries, when return, the \a count will store real number of entries returned by \a dataList
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than needed
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetInternalStats(xpum_internal_stats_t dataList[], uint32_t *count);
+
+/**
+ * @brief Measure the cost of sampling the metrics of the devices on this machine
+ *
+ * Each capability the monitor samples is read \a iterations times back to back from each device, and the latency,
+ * CPU time, handle lock wait and driver call time of the reads are measured. The interval recommended for a
+ * capability gives each capability an equal share of \a targetOverhead, the CPU time of the monitor as a percentage
+ * of one core, summed over the devices. The monitor keeps running, so its samples may wait for the reads and the
+ * other way round. The capabilities read through a metric streamer, EU active/stall/idle and the performance
+ * metrics, are not measured, a second streamer can not be opened while the monitor has one.
+ *
+ * @param deviceId         IN: The device to measure, -1 for all devices
+ * @param iterations       IN: The samples to read of each capability, 1 to 1000
+ * @param targetOverhead   IN: The CPU time of the monitor to stay within, percent of one core, larger than 0
+ * @param dataList        OUT: The array to store the costs, one entry per device and capability. First pass NULL to query the count of entries, no device is read then.
+ * @param count        IN/OUT: When \a dataList is NULL, \a count will be filled with the number of entries, and return. When \a dataList is not NULL, \a count denotes the length of \a dataList, \a count should be equal to or larger than the number of entries, when return, the \a count will store real number of entries returned by \a dataList
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                       if the costs are measured successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL         if \a count is smaller than needed
+ *      - \ref XPUM_RESULT_DEVICE_NOT_FOUND  if the device is not found
+ *      - \ref XPUM_GENERIC_ERROR            if \a iterations or \a targetOverhead is out of range
+ * @note Support Platform: Linux
+ */
+XPUM_API xpum_result_t xpumGetSamplingCost(xpum_device_id_t deviceId, uint32_t iterations, double targetOverhead,
+                                           xpum_sampling_cost_t dataList[], uint32_t *count);
+
 /** @} */ // Closing for DEBUG_LOG_API
 
 /**************************************************************************/
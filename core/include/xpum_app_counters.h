@@ -0,0 +1,245 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file xpum_app_counters.h
+ */
+
+#ifndef _XPUM_APP_COUNTERS_H
+#define _XPUM_APP_COUNTERS_H
+
+#if defined(__cplusplus)
+#pragma once
+#endif
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__cplusplus)
+namespace xpum {
+extern "C" {
+#endif
+
+/**************************************************************************/
+/** @defgroup APP_COUNTERS Application counters
+ * A job publishes its own work counters, like samples or tokens processed,
+ * into a POSIX shared memory segment of its process with the inline
+ * functions below. Only this header is needed, no library of XPUM is linked.
+ *
+ * xpumd finds the segments of the running processes on each energy sample
+ * of the devices, reads the counters on the same tick, and splits the work
+ * of a process among the devices it uses by its engine busy time on each.
+ * With the energy attributed to the process on each device, this gives the
+ * work per second, the work per joule and the work per % of engine busy
+ * time by device and process, see xpumGetAppCounterEfficiency().
+ *
+ * A counter only grows: the job adds the work it has done. Adding is one
+ * atomic instruction, so it can be called from any thread of the job on
+ * every batch.
+ * @{
+ */
+/**************************************************************************/
+
+/**
+ * The prefix of the names of the segments, followed by the process id
+ */
+#define XPUM_APP_COUNTERS_SHM_PREFIX "/xpum_app_"
+
+/**
+ * The magic number at the start of a segment, "XPAC"
+ */
+#define XPUM_APP_COUNTERS_MAGIC 0x43415058
+
+/**
+ * The layout version, changed whenever the header or counter layout changes
+ */
+#define XPUM_APP_COUNTERS_VERSION 1
+
+/**
+ * Max count of counters of a process
+ */
+#define XPUM_APP_COUNTERS_MAX 64
+
+/**
+ * Max length of the name and the unit of a counter, with the terminating 0
+ */
+#define XPUM_APP_COUNTER_NAME_LENGTH 48
+
+/**
+ * Return codes of the application counter functions
+ */
+#define XPUM_APP_COUNTERS_OK 0
+#define XPUM_APP_COUNTERS_ERROR -1        ///< The segment can not be created
+#define XPUM_APP_COUNTERS_FULL -2         ///< The segment has no room for another counter
+#define XPUM_APP_COUNTERS_INVALID -3      ///< The publisher is not created or the counter does not exist
+
+/**
+ * @brief Struct of one counter
+ *
+ */
+typedef struct xpum_app_counter_t {
+    char name[XPUM_APP_COUNTER_NAME_LENGTH]; ///< The name of the counter, like "samples" or "tokens"
+    char unit[XPUM_APP_COUNTER_NAME_LENGTH]; ///< The unit of the work counted, may be empty
+    uint64_t value;                          ///< The work done since the counter was registered
+} xpum_app_counter_t;
+
+/**
+ * @brief Struct at the start of a segment, followed by maxCounters counters
+ *
+ */
+typedef struct xpum_app_counters_header_t {
+    uint32_t magic;        ///< XPUM_APP_COUNTERS_MAGIC while the segment is published
+    uint32_t version;      ///< XPUM_APP_COUNTERS_VERSION
+    uint32_t headerSize;   ///< The size of this header
+    uint32_t counterSize;  ///< The size of one counter
+    uint32_t maxCounters;  ///< The count of counters the segment has room for
+    uint32_t counterCount; ///< The count of registered counters, a counter is complete before it is counted
+    uint32_t processId;    ///< The process publishing the segment
+    uint32_t reserved;
+} xpum_app_counters_header_t;
+
+/**
+ * @brief Struct of the segment of a process
+ *
+ */
+typedef struct xpum_app_counters_t {
+    xpum_app_counters_header_t* header; ///< The mapped segment, NULL if not created
+    size_t size;                        ///< The size of the mapping
+    char name[32];                      ///< The name of the segment
+} xpum_app_counters_t;
+
+/**
+ * @brief The counters of a segment, which follow its header
+ */
+static inline xpum_app_counter_t* xpumAppCountersList(const xpum_app_counters_header_t* header) {
+    return (xpum_app_counter_t*)((char*)header + header->headerSize);
+}
+
+/**
+ * @brief Create the segment of the calling process
+ *
+ * @param counters  OUT: the created segment
+ * @return int
+ *      - \ref XPUM_APP_COUNTERS_OK     if successful
+ *      - \ref XPUM_APP_COUNTERS_ERROR  if the segment can not be created
+ */
+static inline int xpumAppCountersCreate(xpum_app_counters_t* counters) {
+    xpum_app_counters_header_t* header;
+    void* addr;
+    size_t size = sizeof(xpum_app_counters_header_t) + XPUM_APP_COUNTERS_MAX * sizeof(xpum_app_counter_t);
+    int fd;
+
+    counters->header = NULL;
+    counters->size = 0;
+    snprintf(counters->name, sizeof(counters->name), "%s%d", XPUM_APP_COUNTERS_SHM_PREFIX, (int)getpid());
+    // readable by xpumd, the counters of a job are not secret
+    fd = shm_open(counters->name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) {
+        return XPUM_APP_COUNTERS_ERROR;
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        shm_unlink(counters->name);
+        return XPUM_APP_COUNTERS_ERROR;
+    }
+    addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        shm_unlink(counters->name);
+        return XPUM_APP_COUNTERS_ERROR;
+    }
+    header = (xpum_app_counters_header_t*)addr;
+    header->version = XPUM_APP_COUNTERS_VERSION;
+    header->headerSize = sizeof(xpum_app_counters_header_t);
+    header->counterSize = sizeof(xpum_app_counter_t);
+    header->maxCounters = XPUM_APP_COUNTERS_MAX;
+    header->counterCount = 0;
+    header->processId = (uint32_t)getpid();
+    __atomic_store_n(&header->magic, XPUM_APP_COUNTERS_MAGIC, __ATOMIC_RELEASE);
+    counters->header = header;
+    counters->size = size;
+    return XPUM_APP_COUNTERS_OK;
+}
+
+/**
+ * @brief Register a counter, not thread safe with the other registrations
+ *
+ * @param counters  IN: the segment created by xpumAppCountersCreate()
+ * @param name      IN: the name of the counter, truncated to XPUM_APP_COUNTER_NAME_LENGTH - 1
+ * @param unit      IN: the unit of the work counted, may be NULL
+ * @return int
+ *      - the index of the counter, 0 or more, if successful
+ *      - \ref XPUM_APP_COUNTERS_FULL       if there are XPUM_APP_COUNTERS_MAX counters already
+ *      - \ref XPUM_APP_COUNTERS_INVALID    if the segment is not created
+ */
+static inline int xpumAppCounterRegister(xpum_app_counters_t* counters, const char* name, const char* unit) {
+    xpum_app_counters_header_t* header = counters->header;
+    xpum_app_counter_t* counter;
+    uint32_t index;
+
+    if (header == NULL || name == NULL) {
+        return XPUM_APP_COUNTERS_INVALID;
+    }
+    index = header->counterCount;
+    if (index >= header->maxCounters) {
+        return XPUM_APP_COUNTERS_FULL;
+    }
+    counter = xpumAppCountersList(header) + index;
+    strncpy(counter->name, name, XPUM_APP_COUNTER_NAME_LENGTH - 1);
+    counter->name[XPUM_APP_COUNTER_NAME_LENGTH - 1] = 0;
+    strncpy(counter->unit, unit != NULL ? unit : "", XPUM_APP_COUNTER_NAME_LENGTH - 1);
+    counter->unit[XPUM_APP_COUNTER_NAME_LENGTH - 1] = 0;
+    counter->value = 0;
+    // xpumd reads the count first
+    __atomic_store_n(&header->counterCount, index + 1, __ATOMIC_RELEASE);
+    return (int)index;
+}
+
+/**
+ * @brief Add the work done to a counter, thread safe
+ *
+ * @param counters  IN: the segment created by xpumAppCountersCreate()
+ * @param index     IN: the index returned by xpumAppCounterRegister()
+ * @param work      IN: the work done since the previous call
+ * @return int
+ *      - \ref XPUM_APP_COUNTERS_OK         if successful
+ *      - \ref XPUM_APP_COUNTERS_INVALID    if the counter does not exist
+ */
+static inline int xpumAppCounterAdd(xpum_app_counters_t* counters, int index, uint64_t work) {
+    xpum_app_counters_header_t* header = counters->header;
+
+    if (header == NULL || index < 0 || (uint32_t)index >= __atomic_load_n(&header->counterCount, __ATOMIC_ACQUIRE)) {
+        return XPUM_APP_COUNTERS_INVALID;
+    }
+    __atomic_fetch_add(&xpumAppCountersList(header)[index].value, work, __ATOMIC_RELAXED);
+    return XPUM_APP_COUNTERS_OK;
+}
+
+/**
+ * @brief Stop publishing and remove the segment
+ *
+ * @param counters  IN: the segment created by xpumAppCountersCreate()
+ */
+static inline void xpumAppCountersDestroy(xpum_app_counters_t* counters) {
+    if (counters->header != NULL) {
+        __atomic_store_n(&counters->header->magic, 0, __ATOMIC_RELEASE);
+        munmap((void*)counters->header, counters->size);
+        shm_unlink(counters->name);
+    }
+    counters->header = NULL;
+    counters->size = 0;
+}
+
+/** @} */ // Closing for APP_COUNTERS
+
+#if defined(__cplusplus)
+} // extern "C"
+} // end namespace xpum
+#endif
+
+#endif // _XPUM_APP_COUNTERS_H
@@ -164,7 +164,14 @@ typedef enum xpum_result_enum {
     XPUM_PPR_NOT_FOUND = 63,
     XPUM_UPDATE_FIRMWARE_GFX_DATA_IMAGE_VERSION_LOWER_OR_EQUAL_TO_DEVICE = 64,
     XPUM_RESULT_UNSUPPORTED_DEVICE = 65,
-    XPUM_GROUP_LIMIT_REACHED = 66
+    XPUM_GROUP_LIMIT_REACHED = 66,
+    XPUM_RESULT_JOB_WINDOW_EXISTS = 67,    ///< A job window with the same job id is already open
+    XPUM_RESULT_JOB_WINDOW_NOT_FOUND = 68, ///< Job window not found
+    XPUM_RESULT_BURST_SAMPLING_RUNNING = 69,   ///< A burst sampling is already running on the device
+    XPUM_RESULT_BURST_SAMPLING_NOT_FOUND = 70, ///< No burst sampling on the device
+    XPUM_RESULT_STRESS_INVALID_OPTIONS = 71,   ///< The stress options are invalid
+    XPUM_RESULT_VGPU_PROVISION_RUNNING = 72,   ///< VFs are being created or removed on the device
+    XPUM_RESULT_CLOCK_NOT_CORRELATED = 73      ///< The timer of the device can not be read with the host clock
 } xpum_result_t;
 
 typedef enum xpum_device_type_enum {
@@ -330,6 +337,34 @@ typedef enum xpum_health_status_enum {
     XPUM_HEALTH_STATUS_CRITICAL = 3,
 } xpum_health_status_t;
 
+/**
+ * @brief The conditions of a group selector
+ * 
+ */
+typedef enum xpum_group_selector_flags_enum {
+    XPUM_GROUP_SELECTOR_MODEL = 1 << 0,         ///< The device name contains model, or its PCI device id is model
+    XPUM_GROUP_SELECTOR_NUMA_NODE = 1 << 1,     ///< The device is on NUMA node numaNode
+    XPUM_GROUP_SELECTOR_PCIE_SWITCH = 1 << 2,   ///< The device is below the PCIe switch or bridge port of BDF pcieSwitch
+    XPUM_GROUP_SELECTOR_FUNCTION_TYPE = 1 << 3, ///< The device is a function of type functionType
+    XPUM_GROUP_SELECTOR_POD = 1 << 4,           ///< A process of the Kubernetes pod of UID podUid has the device open
+    XPUM_GROUP_SELECTOR_HEALTH = 1 << 5,        ///< The worst health status of the device is healthStatus or worse
+    XPUM_GROUP_SELECTOR_THROTTLED = 1 << 6,     ///< The frequency of the device is throttled in the latest sample
+} xpum_group_selector_flags_t;
+
+/**
+ * @brief Struct of the selector of a dynamic group, a device is in the group while it matches all the conditions in flags
+ * 
+ */
+typedef struct xpum_group_selector_t {
+    uint32_t flags;                           ///< The xpum_group_selector_flags_t of the conditions
+    char model[XPUM_MAX_STR_LENGTH];          ///< XPUM_GROUP_SELECTOR_MODEL: a part of the device name, or the PCI device id like 0x0bd5
+    int32_t numaNode;                         ///< XPUM_GROUP_SELECTOR_NUMA_NODE: the NUMA node
+    char pcieSwitch[XPUM_MAX_STR_LENGTH];     ///< XPUM_GROUP_SELECTOR_PCIE_SWITCH: the BDF of the switch or bridge port, like 0000:3a:00.0
+    xpum_device_function_type_t functionType; ///< XPUM_GROUP_SELECTOR_FUNCTION_TYPE: the function type
+    char podUid[XPUM_MAX_STR_LENGTH];         ///< XPUM_GROUP_SELECTOR_POD: the UID of the pod
+    xpum_health_status_t healthStatus;        ///< XPUM_GROUP_SELECTOR_HEALTH: the least health status matched, XPUM_HEALTH_STATUS_WARNING or XPUM_HEALTH_STATUS_CRITICAL
+} xpum_group_selector_t;
+
 typedef struct xpum_health_data_t {
     xpum_device_id_t deviceId;             ///< Device ID
     xpum_health_type_t type;               ///< Health type
@@ -490,6 +525,33 @@ typedef struct xpum_diag_task_info_t {
     int targetTypeCount;
 } xpum_diag_task_info_t;
 
+/**
+ * @brief The workloads a stress test runs, they can be combined
+ * 
+ */
+typedef enum xpum_stress_profile_enum {
+    XPUM_STRESS_PROFILE_INT_COMPUTE = 1 << 0,      ///< Integer compute kernel
+    XPUM_STRESS_PROFILE_FP32_COMPUTE = 1 << 1,     ///< Single-precision compute kernel
+    XPUM_STRESS_PROFILE_FP64_COMPUTE = 1 << 2,     ///< Double-precision compute kernel
+    XPUM_STRESS_PROFILE_MEMORY_BANDWIDTH = 1 << 3, ///< Kernel reading the device memory
+    XPUM_STRESS_PROFILE_PCIE_H2D = 1 << 4,         ///< Copy from host memory to device memory
+    XPUM_STRESS_PROFILE_PCIE_D2H = 1 << 5,         ///< Copy from device memory to host memory
+    XPUM_STRESS_PROFILE_XE_LINK = 1 << 6,          ///< Copy to the device memory of the other GPUs
+    XPUM_STRESS_PROFILE_MEDIA = 1 << 7,            ///< Media transcode
+    XPUM_STRESS_PROFILE_ALL = (1 << 8) - 1
+} xpum_stress_profile_t;
+
+/**
+ * @brief Struct to store the options of a stress test
+ * 
+ */
+typedef struct xpum_stress_options_t {
+    uint32_t stressTime;        ///< The time (in minutes) to run the stress test. 0 means unlimited time.
+    uint32_t profiles;          ///< The workloads to run at the same time, a bitwise OR of xpum_stress_profile_t. 0 means XPUM_STRESS_PROFILE_INT_COMPUTE.
+    uint32_t targetUtilization; ///< The percentage of time each workload keeps the GPU busy, 1 to 100. 0 means 100.
+    uint32_t traceInterval;     ///< The interval in milliseconds to burst sample power, frequency and utilization during the stress test, read by xpumGetBurstSamples. 0 means no trace.
+} xpum_stress_options_t;
+
 typedef enum xpum_media_format_enum {
     XPUM_MEDIA_FORMAT_H265 = 0,
     XPUM_MEDIA_FORMAT_H264 = 1,
@@ -520,6 +582,19 @@ typedef struct xpum_diag_xe_link_throughput_t {
     double maxSpeed;           // GBPS
     double threshold;          // GBPS  
 } xpum_diag_xe_link_throughput_t;
+
+typedef struct xpum_xe_link_matrix_entry_t {
+    xpum_device_id_t srcDeviceId;       ///< The device copied from
+    xpum_device_tile_id_t srcTileId;    ///< The tile copied from
+    xpum_device_id_t dstDeviceId;       ///< The device copied to
+    xpum_device_tile_id_t dstTileId;    ///< The tile copied to
+    int32_t copyEngineGroup;            ///< The engine group of the source tile with the highest bandwidth
+    double uniBandwidth;                ///< The bandwidth from the source to the destination, in GBPS
+    double biBandwidth;                 ///< The bandwidth of both directions at the same time, in GBPS
+    double latency;                     ///< The device time of a 4 KiB copy, in microseconds
+    bool degraded;                      ///< The bandwidth is below XE_LINK_THROUGHPUT_USAGE_PERCENTAGE of the median of the pairs
+    uint64_t timestamp;                 ///< When the pair was measured, in milliseconds since the epoch
+} xpum_xe_link_matrix_entry_t;
 /**************************************************************************/
 /**
  * Definitions for agent setting
@@ -600,7 +675,10 @@ typedef struct xpum_device_stats_data_t {
     uint64_t min;                  ///< The min value since last call, only valid if isCounter is false
     uint64_t avg;                  ///< The average value since last call, only valid if isCounter is false
     uint64_t max;                  ///< The max value since last call, only valid if isCounter is false
-    uint32_t scale;                ///< The magnification of the value, accumulated, min, avg, and max fields
+    uint32_t scale;                ///< The magnification of the value, accumulated, min, avg, max, p50, p90, and p99 fields
+    uint64_t p50;                  ///< The 50th percentile since last call, within 1% of a sampled value, only valid if isCounter is false
+    uint64_t p90;                  ///< The 90th percentile since last call, within 1% of a sampled value, only valid if isCounter is false
+    uint64_t p99;                  ///< The 99th percentile since last call, within 1% of a sampled value, only valid if isCounter is false
 } xpum_device_stats_data_t;
 
 /**
@@ -615,6 +693,293 @@ typedef struct xpum_device_stats_t {
     xpum_device_stats_data_t dataList[XPUM_STATS_MAX];
 } xpum_device_stats_t;
 
+/**
+ * @brief Struct to store one downsampled point of a metrics history series
+ * 
+ */
+typedef struct xpum_metrics_history_point_t {
+    uint64_t timestamp; ///< Timestamp in milliseconds, the begin of the step this point aggregates
+    uint64_t min;       ///< The min value in the step
+    uint64_t avg;       ///< The average value in the step
+    uint64_t max;       ///< The max value in the step
+    uint32_t count;     ///< The number of samples aggregated in the step
+} xpum_metrics_history_point_t;
+
+/**
+ * @brief Struct to store the description of a metrics history series
+ * 
+ */
+typedef struct xpum_metrics_history_t {
+    xpum_device_id_t deviceId;     ///< Device id
+    bool isTileData;               ///< If this series is tile level
+    int32_t tileId;                ///< The tile id, only valid if isTileData is true
+    xpum_stats_type_t metricsType; ///< Metric type
+    bool isCounter;                ///< If this metric is a counter, the points of a counter hold the accumulated values
+    uint32_t scale;                ///< The magnification of the min, avg, and max fields of the points
+    uint32_t offset;               ///< The index of the first point of this series in the point list
+    uint32_t count;                ///< The count of points of this series
+} xpum_metrics_history_t;
+
+/**
+ * @brief Struct to store one bin of a metrics histogram
+ * 
+ */
+typedef struct xpum_metrics_histogram_bin_t {
+    uint64_t upperBound; ///< The largest value falling into the bin, within 1% of the real upper bound
+    uint64_t count;      ///< The count of samples in the bin
+} xpum_metrics_histogram_bin_t;
+
+/**
+ * @brief Struct to store the description of a metrics histogram
+ * 
+ * The histogram holds every sample of the metric since xpumInit, it is never reset.
+ */
+typedef struct xpum_metrics_histogram_t {
+    xpum_device_id_t deviceId;     ///< Device id
+    bool isTileData;               ///< If this histogram is tile level
+    int32_t tileId;                ///< The tile id, only valid if isTileData is true
+    xpum_stats_type_t metricsType; ///< Metric type
+    uint32_t scale;                ///< The magnification of the sum and of the upper bounds of the bins
+    uint64_t count;                ///< The count of samples
+    uint64_t sum;                  ///< The sum of samples
+    uint32_t offset;               ///< The index of the first bin of this histogram in the bin list
+    uint32_t binCount;             ///< The count of bins of this histogram, in ascending order of upper bounds, empty bins are left out
+} xpum_metrics_histogram_t;
+
+/**
+ * @brief Struct to store the time a device or a tile spent with each frequency throttle reason
+ * 
+ * The times are accumulated at the monitor frequency since xpumInit, they are never reset. The interval since the previous sample is charged to the reasons of the new sample, the gaps in the sampling are left out.
+ */
+typedef struct xpum_throttle_residency_t {
+    xpum_device_id_t deviceId;  ///< Device id
+    bool isTileData;            ///< If this data is tile level
+    int32_t tileId;             ///< The tile id, only valid if isTileData is true
+    uint64_t sampledTime;       ///< The time covered by the samples, unit ms
+    uint64_t throttledTime;     ///< The time throttled for any reason, unit ms
+    uint64_t avgPowerCapTime;   ///< The time throttled by the average power cap, unit ms
+    uint64_t burstPowerCapTime; ///< The time throttled by the burst power cap, unit ms
+    uint64_t currentLimitTime;  ///< The time throttled by the current limit, unit ms
+    uint64_t thermalLimitTime;  ///< The time throttled by the thermal limit, unit ms
+    uint64_t psuAlertTime;      ///< The time throttled by the power supply assertion, unit ms
+    uint64_t swRangeTime;       ///< The time throttled by the software supplied frequency range, unit ms
+    uint64_t hwRangeTime;       ///< The time throttled by a sub block that has a lower frequency, unit ms
+} xpum_throttle_residency_t;
+
+/**
+ * @brief Struct to store the DRAM and UPI traffic of a host socket
+ * 
+ * The traffic is sampled by the memory controller and UPI uncore counters in the same windows as the PCIe throughput of the devices. The bytes are accumulated since xpumInit, they are never reset.
+ */
+typedef struct xpum_host_socket_telemetry_t {
+    uint32_t socketId;              ///< The socket id
+    uint64_t timestamp;             ///< The end of the sampling window, unit ms
+    uint64_t dramReadThroughput;    ///< The DRAM read throughput, unit kB/s
+    uint64_t dramWriteThroughput;   ///< The DRAM write throughput, unit kB/s
+    uint64_t dramRead;              ///< The bytes read from DRAM
+    uint64_t dramWrite;             ///< The bytes written to DRAM
+    uint64_t upiIncomingThroughput; ///< The data throughput received over all UPI links, unit kB/s
+    uint64_t upiIncoming;           ///< The data bytes received over all UPI links
+    uint32_t upiUtilization;        ///< The incoming data utilization of the busiest UPI link, unit 0.01%
+} xpum_host_socket_telemetry_t;
+
+/**
+ * @brief Struct to store the inbound PCIe traffic of an IIO stack of a host socket
+ * 
+ * The traffic of a stack covers all the devices attached to it, like the NICs and the NVMe drives feeding the GPUs. The bytes are accumulated since xpumInit, they are never reset.
+ */
+typedef struct xpum_host_iio_stack_telemetry_t {
+    uint32_t socketId;        ///< The socket id
+    uint32_t stackId;         ///< The IIO stack id in the socket
+    uint64_t timestamp;       ///< The end of the sampling window, unit ms
+    uint64_t readThroughput;  ///< The inbound read throughput, unit kB/s
+    uint64_t writeThroughput; ///< The inbound write throughput, unit kB/s
+    uint64_t read;            ///< The bytes of inbound reads
+    uint64_t write;           ///< The bytes of inbound writes
+} xpum_host_iio_stack_telemetry_t;
+
+/**
+ * @brief Struct to store the accounting data of a device in a job window
+ * 
+ */
+typedef struct xpum_job_window_stats_t {
+    xpum_device_id_t deviceId;   ///< Device id
+    uint64_t begin;              ///< Timestamp in milliseconds, the first sample in the window
+    uint64_t end;                ///< Timestamp in milliseconds, the latest sample in the window
+    uint64_t energy;             ///< Energy consumed in the window, unit mJ
+    uint64_t avgPower;           ///< Time-weighted average power, unit mW
+    uint64_t peakPower;          ///< Peak power, unit mW
+    uint64_t avgGpuUtilization;  ///< Time-weighted average GPU utilization, unit 0.01%
+    uint64_t avgMemoryUsed;      ///< Time-weighted average memory used, unit B
+    uint64_t peakMemoryUsed;     ///< Peak memory used, unit B
+    uint64_t memoryUsedIntegral; ///< Memory used integrated over the window, unit B*s
+} xpum_job_window_stats_t;
+
+/**
+ * @brief Struct to store the energy of a device in a job window attributed to one of its processes
+ * 
+ * The energy measured between two samples is split among the processes by their share of the engine busy time between the samples. The energy measured while no process was busy is in the entry of process id 0.
+ */
+typedef struct xpum_job_process_energy_t {
+    xpum_device_id_t deviceId;               ///< Device id
+    uint32_t processId;                      ///< Process id, 0 for the energy not attributed to a process
+    char processName[XPUM_MAX_STR_LENGTH];   ///< Process name
+    char containerId[XPUM_MAX_STR_LENGTH];   ///< The id of the container of the process, empty if it is not in a container
+    char podUid[XPUM_MAX_STR_LENGTH];        ///< The UID of the Kubernetes pod of the process, empty if it is not in a pod
+    uint64_t busyTime;                       ///< The engine busy time of the process in the window, unit ns
+    uint64_t energy;                         ///< Energy attributed to the process in the window, unit mJ
+} xpum_job_process_energy_t;
+
+/**
+ * @brief Struct to store a metric of a group aggregated over its devices in the latest sampling tick
+ * 
+ */
+typedef struct xpum_group_metric_data_t {
+    xpum_stats_type_t metricsType; ///< Metric type
+    bool isCounter;                ///< If this metric is a counter
+    uint64_t timestamp;            ///< Timestamp in milliseconds, the sampling tick aggregated
+    uint32_t deviceCount;          ///< The number of devices of the group having data in the tick
+    uint64_t sum;                  ///< The sum of the values of the devices
+    uint64_t avg;                  ///< The average of the values of the devices
+    uint64_t min;                  ///< The min value of the devices
+    uint64_t max;                  ///< The max value of the devices
+    uint32_t scale;                ///< The magnification of the sum, avg, min and max fields
+} xpum_group_metric_data_t;
+
+/**
+ * @brief Struct to store one performance metric of a tile aggregated over a window
+ * 
+ */
+typedef struct xpum_perf_metric_t {
+    xpum_device_tile_id_t tileId;            ///< Tile id, 0 for a device without tiles
+    char groupName[XPUM_MAX_STR_LENGTH];     ///< Metric group name
+    char metricName[XPUM_MAX_STR_LENGTH];    ///< Metric name
+    double current;                          ///< The value of the latest sample
+    double average;                          ///< The average of the samples in the window
+    double min;                              ///< The minimum of the samples in the window
+    double max;                              ///< The maximum of the samples in the window
+    uint32_t sampleCount;                    ///< The number of samples in the window
+    double activeRatio;                      ///< The fraction of the time the metric group was active, below 1 when the groups are multiplexed
+} xpum_perf_metric_t;
+
+/**
+ * @brief Struct to store one sample of a burst sampling
+ * 
+ */
+typedef struct xpum_burst_sample_t {
+    uint64_t timestamp;            ///< Timestamp in microseconds, the time when the sample is taken
+    xpum_stats_type_t metricsType; ///< Metric type, XPUM_STATS_POWER, XPUM_STATS_GPU_FREQUENCY or XPUM_STATS_GPU_UTILIZATION
+    bool isTileData;               ///< If this sample is tile level
+    int32_t tileId;                ///< The tile id, only valid when isTileData is true
+    uint64_t value;                ///< The sampled value
+    uint32_t scale;                ///< The magnification of the value
+} xpum_burst_sample_t;
+
+/**
+ * @brief Host clocks a device timestamp is converted to
+ */
+typedef enum xpum_clock_domain_enum {
+    XPUM_CLOCK_DOMAIN_MONOTONIC = 0, ///< CLOCK_MONOTONIC of the host
+    XPUM_CLOCK_DOMAIN_REALTIME = 1,  ///< CLOCK_REALTIME of the host
+} xpum_clock_domain_t;
+
+/**
+ * @brief Struct to store the correlation of the timer of a device with the host clocks
+ * 
+ * @details A host time is monotonicTimestamp + (deviceTicks - deviceTimestamp) * nsPerTick * (1 + driftPpm / 1e6),
+ * with deviceTicks - deviceTimestamp taken modulo 2^validBits.
+ */
+typedef struct xpum_clock_correlation_t {
+    xpum_device_id_t deviceId;   ///< Device id
+    uint64_t deviceTimestamp;    ///< The device timer in ticks at the latest correlation sample, as returned by zeDeviceGetGlobalTimestamps
+    uint64_t monotonicTimestamp; ///< CLOCK_MONOTONIC in nanoseconds of the model at deviceTimestamp
+    uint64_t realtimeTimestamp;  ///< CLOCK_REALTIME in nanoseconds of the model at deviceTimestamp
+    double nsPerTick;            ///< The nominal period of the device timer in nanoseconds
+    double driftPpm;             ///< The host ns per nominal device ns minus one, in parts per million, positive when the device timer runs slow
+    uint64_t errorNs;            ///< The estimated error of a converted timestamp in nanoseconds
+    uint32_t validBits;          ///< The count of valid bits of the device timer, it wraps at 2^validBits
+    uint32_t sampleCount;        ///< The count of correlation samples the model is fitted to
+    uint64_t updateTime;         ///< Timestamp in milliseconds of the latest correlation sample
+} xpum_clock_correlation_t;
+
+/**
+ * @brief Struct to store the efficiency of a counter published by a process with xpum_app_counters.h on one device
+ * 
+ * @details The work of a process is split among its devices by its engine busy time on each, the energy of a device among
+ * its processes by their engine busy time. The rate, the work per joule and the work per utilization are of the interval
+ * between the latest two energy samples.
+ */
+typedef struct xpum_app_counter_efficiency_t {
+    xpum_device_id_t deviceId;               ///< Device id
+    uint32_t processId;                      ///< Process id
+    char processName[XPUM_MAX_STR_LENGTH];   ///< Process name
+    char counterName[XPUM_MAX_STR_LENGTH];   ///< The name of the counter
+    char unit[XPUM_MAX_STR_LENGTH];          ///< The unit of the work counted, may be empty
+    uint64_t timestamp;                      ///< Timestamp in milliseconds of the latest energy sample
+    double rate;                             ///< The work on the device per second
+    double workPerJoule;                     ///< The work on the device per joule attributed to the process, 0 if no energy was attributed
+    double workPerUtilization;               ///< The work per second per % of engine busy time of the process on the device
+    double utilization;                      ///< The engine busy time of the process on the device in %, above 100 when it keeps several engines busy
+    double work;                             ///< The work on the device since the counter was first seen
+    double energy;                           ///< The energy attributed to the process since the counter was first seen, unit J
+} xpum_app_counter_efficiency_t;
+
+/**
+ * @brief Internal latency statistics types
+ */
+typedef enum xpum_internal_stats_type_enum {
+    XPUM_INTERNAL_STATS_ZE_LOCK_WAIT = 0,          ///< Time waiting for the lock of a Level Zero handle before a call
+    XPUM_INTERNAL_STATS_ZE_CALL = 1,               ///< Time spent in a Level Zero call
+    XPUM_INTERNAL_STATS_MONITOR_TICK_LATENESS = 2, ///< How late a tick of a monitor task starts compared to its schedule, per monitor task
+    XPUM_INTERNAL_STATS_MONITOR_COLLECT = 3,       ///< Time collecting a capability from a device in a monitor tick, per capability and device
+    XPUM_INTERNAL_STATS_MONITOR_STORE = 4,         ///< Time storing the data of a capability in a monitor tick, per capability
+    XPUM_INTERNAL_STATS_MEMORY = 5,                ///< Estimated memory held by a telemetry cache, per cache and in total: count is the entries, sum the current bytes and max the peak bytes
+    XPUM_INTERNAL_STATS_EVENT_DELIVERY = 6,        ///< Time from publishing an event to its delivery to a subscriber of the event bus, per subscriber: errorCount is the events dropped for the subscriber
+    XPUM_INTERNAL_STATS_CPU_TIME = 7,              ///< CPU time of xpumd in an interval of the CPU budget governor, per thread group and in total
+    XPUM_INTERNAL_STATS_CPU_BUDGET_CUT = 8,        ///< Intervals a cut of the CPU budget governor was active, per cut: sum is the time cut, errorCount the times the cut was applied
+} xpum_internal_stats_type_t;
+
+/**
+ * @brief Struct to store the latency distribution of one internal operation
+ *
+ * The distribution is kept in a log-linear histogram, the percentiles are
+ * the upper bounds of their buckets, within 12.5% of the real values.
+ */
+typedef struct xpum_internal_stats_t {
+    xpum_internal_stats_type_t type; ///< What the latency is of
+    char name[XPUM_MAX_STR_LENGTH];  ///< The operation, e.g. the name of the Level Zero function
+    xpum_device_id_t deviceId;       ///< The device the operation was done for, -1 if it is not done for a single device
+    uint64_t count;                  ///< The count of operations since xpumInit
+    uint64_t errorCount;             ///< The count of operations that reported an error, only counted for XPUM_INTERNAL_STATS_MONITOR_COLLECT, XPUM_INTERNAL_STATS_EVENT_DELIVERY and XPUM_INTERNAL_STATS_CPU_BUDGET_CUT
+    uint64_t sum;                    ///< The sum of latencies, unit ns
+    uint64_t max;                    ///< The max latency, unit ns
+    uint64_t p50;                    ///< The 50th percentile of latencies, unit ns
+    uint64_t p90;                    ///< The 90th percentile of latencies, unit ns
+    uint64_t p99;                    ///< The 99th percentile of latencies, unit ns
+} xpum_internal_stats_t;
+
+/**
+ * @brief Struct to store the measured cost of sampling a capability of a device
+ *
+ * The capability is read back to back by the caller, the times are the averages of the samples. The lock wait
+ * and driver call times are those of the Level Zero calls made for the samples, the CPU time is that of the
+ * thread reading the samples.
+ */
+typedef struct xpum_sampling_cost_t {
+    xpum_device_id_t deviceId;       ///< The device id
+    char name[XPUM_MAX_STR_LENGTH];  ///< The capability sampled, e.g. METRIC_POWER
+    uint32_t samples;                ///< The count of samples read
+    uint32_t errorCount;             ///< The count of samples that reported an error
+    uint64_t latency;                ///< The average time of a sample, unit ns
+    uint64_t maxLatency;             ///< The max time of a sample, unit ns
+    uint64_t cpuTime;                ///< The average CPU time of a sample, unit ns
+    uint64_t lockWait;               ///< The average time of a sample waiting for the locks of the Level Zero handles, unit ns
+    uint64_t driverTime;             ///< The average time of a sample in the Level Zero calls, unit ns
+    uint32_t driverCalls;            ///< The average count of Level Zero calls of a sample
+    uint32_t currentInterval;        ///< The interval the capability is sampled at by the monitor, unit ms
+    uint32_t recommendedInterval;    ///< The interval recommended for the capability to stay within the target overhead, the same for all devices, unit ms
+} xpum_sampling_cost_t;
+
 /**
  * @brief Engine types
  * 
@@ -703,6 +1068,92 @@ typedef struct xpum_device_fabric_throughput_metric_t {
     uint32_t scale;                     ///< The magnification of the value, accumulated, min, avg, and max fields
 } xpum_device_fabric_throughput_metric_t;
 
+/**
+ * The magic number at the start of a telemetry snapshot, "XPTS"
+ */
+#define XPUM_TELEMETRY_SNAPSHOT_MAGIC 0x53545058
+
+/**
+ * The version of the telemetry snapshot layout, a new version only appends fields to the structs
+ */
+#define XPUM_TELEMETRY_SNAPSHOT_VERSION 2
+
+/**
+ * @brief Telemetry snapshot record types
+ *
+ */
+typedef enum xpum_telemetry_record_type_enum {
+    XPUM_TELEMETRY_RECORD_STATS = 0,  ///< Statistics of a device or a tile
+    XPUM_TELEMETRY_RECORD_ENGINE = 1, ///< Utilization of one engine
+    XPUM_TELEMETRY_RECORD_FABRIC = 2, ///< Throughput of one fabric link
+    XPUM_TELEMETRY_RECORD_MAX,
+} xpum_telemetry_record_type_t;
+
+/**
+ * @brief Header of a telemetry snapshot
+ *
+ * @details The schema of metricCount entries of \ref xpum_telemetry_metric_t follows the header, then recordCount
+ * entries of \ref xpum_telemetry_record_t, each followed by its valueCount entries of \ref xpum_telemetry_value_t.
+ * Readers step over the structs by the sizes in the header, so they can read snapshots of a newer version.
+ */
+typedef struct xpum_telemetry_snapshot_header_t {
+    uint32_t magic;       ///< XPUM_TELEMETRY_SNAPSHOT_MAGIC
+    uint16_t version;     ///< XPUM_TELEMETRY_SNAPSHOT_VERSION of the writer
+    uint16_t headerSize;  ///< The size of the header
+    uint32_t size;        ///< The size of the snapshot, including the header
+    uint16_t metricSize;  ///< The size of each schema entry
+    uint16_t recordSize;  ///< The size of each record, not including its values
+    uint16_t valueSize;   ///< The size of each value
+    uint16_t reserved;    ///< Reserved
+    uint32_t metricCount; ///< The count of schema entries
+    uint32_t recordCount; ///< The count of records
+    uint32_t reserved2;   ///< Reserved
+    uint64_t begin;       ///< Timestamp in milliseconds, the time when aggregation starts
+    uint64_t end;         ///< Timestamp in milliseconds, the time when aggregation ends
+} xpum_telemetry_snapshot_header_t;
+
+/**
+ * @brief Schema entry of a telemetry snapshot, describing a metric the values refer to
+ *
+ */
+typedef struct xpum_telemetry_metric_t {
+    xpum_stats_type_t metricsType; ///< Metric type
+    uint8_t isCounter;             ///< 1 if this metric is a counter, its values are in the accumulated field
+    uint8_t reserved[3];           ///< Reserved
+} xpum_telemetry_metric_t;
+
+/**
+ * @brief Record of a telemetry snapshot, the device, tile, engine or fabric link its values belong to
+ *
+ */
+typedef struct xpum_telemetry_record_t {
+    uint32_t type;             ///< xpum_telemetry_record_type_t
+    xpum_device_id_t deviceId; ///< Device id
+    int32_t tileId;            ///< The tile id, -1 for the device
+    uint32_t valueCount;       ///< The count of values following the record
+    uint32_t subType;          ///< xpum_engine_type_t of an engine record, xpum_fabric_throughput_type_t of a fabric record
+    uint32_t index;            ///< The index of the engine of an engine record, the remote device id of a fabric record
+    int32_t remoteTileId;      ///< The remote tile id of a fabric record
+    uint32_t reserved;         ///< Reserved
+} xpum_telemetry_record_t;
+
+/**
+ * @brief Value of a telemetry snapshot
+ *
+ */
+typedef struct xpum_telemetry_value_t {
+    uint32_t metricIndex; ///< The index of the metric in the schema
+    uint32_t scale;       ///< The magnification of the value, accumulated, min, avg, and max fields
+    uint64_t value;       ///< The latest value
+    uint64_t accumulated; ///< The accumulated value, only valid if the metric is a counter
+    uint64_t min;         ///< The min value since last query of the session, only valid if the metric is not a counter
+    uint64_t avg;         ///< The average value since last query of the session, only valid if the metric is not a counter
+    uint64_t max;         ///< The max value since last query of the session, only valid if the metric is not a counter
+    uint64_t p50;         ///< The 50th percentile since last query of the session, only valid in XPUM_TELEMETRY_RECORD_STATS records if the metric is not a counter, since version 2
+    uint64_t p90;         ///< The 90th percentile since last query of the session, only valid like p50, since version 2
+    uint64_t p99;         ///< The 99th percentile since last query of the session, only valid like p50, since version 2
+} xpum_telemetry_value_t;
+
 /**
  * @brief Struct to store raw statistics data, not aggregated yet
  * 
@@ -1012,6 +1463,26 @@ typedef struct xpum_xelink_topo_info {
     int64_t maxBitRate;
 } xpum_xelink_topo_info;
 
+typedef struct xpum_device_placement_t {
+    xpum_device_id_t deviceId;               ///< Device id
+    int32_t numaIdx;                         ///< The NUMA node of the device, -1 if unknown
+    char cpuAffinity[XPUM_MAX_CPU_LIST_LEN]; ///< The CPUs of the NUMA node of the device
+    xpum_device_id_t treeParent;             ///< The parent of the device in the tree, -1 for the root
+    xpum_xelink_type_t nextLinkType;         ///< The link to the next device in the ring, XPUM_LINK_XE, XPUM_LINK_NODE or XPUM_LINK_SYS
+    int32_t nextPcieHops;                    ///< The PCIe bridges between the device and the next device in the ring, 0 over Xe Link
+} xpum_device_placement_t;
+
+typedef struct xpum_placement_advice_t {
+    int32_t count;                                         ///< The number of devices
+    xpum_device_placement_t devices[XPUM_MAX_NUM_DEVICES]; ///< The devices in the ring order
+    char cpuList[XPUM_MAX_CPU_LIST_LEN];                   ///< The CPUs of the NUMA nodes of all devices
+    int32_t numaNodeCount;                                 ///< The number of NUMA nodes of the devices
+    int32_t numaNodes[XPUM_MAX_NUM_DEVICES];               ///< The NUMA nodes of the devices
+    int32_t ringXelinkHops;                                ///< The ring links over Xe Link
+    int32_t ringPcieHops;                                  ///< The PCIe bridges crossed by the other ring links
+    int32_t ringCrossNumaHops;                             ///< The ring links between NUMA nodes
+} xpum_placement_advice_t;
+
 typedef enum xpum_ras_type_enum {
     XPUM_RAS_ERROR_CAT_RESET = 0,
     XPUM_RAS_ERROR_CAT_PROGRAMMING_ERRORS = 1,
@@ -1036,18 +1507,24 @@ typedef enum xpum_policy_type_enum {
     XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE = 7,
     XPUM_POLICY_TYPE_GPU_MISSING = 8,
     XPUM_POLICY_TYPE_GPU_THROTTLE = 9,
+    XPUM_POLICY_TYPE_PRECHECK_ERROR = 10,
     XPUM_POLICY_TYPE_MAX
 } xpum_policy_type_t;
 
 typedef enum xpum_policy_conditon_type_enum {
     XPUM_POLICY_CONDITION_TYPE_GREATER = 0,
     XPUM_POLICY_CONDITION_TYPE_LESS = 1,
-    XPUM_POLICY_CONDITION_TYPE_WHEN_OCCUR = 2
+    XPUM_POLICY_CONDITION_TYPE_WHEN_OCCUR = 2,
+    XPUM_POLICY_CONDITION_TYPE_SUSTAINED_GREATER = 3, ///< The value stays greater than threshold for window milliseconds
+    XPUM_POLICY_CONDITION_TYPE_RATE_GREATER = 4,      ///< The value increases faster than threshold per second
+    XPUM_POLICY_CONDITION_TYPE_EWMA_GREATER = 5       ///< The exponentially weighted moving average over window milliseconds is greater than threshold
 } xpum_policy_conditon_type_t;
 
 typedef struct xpum_policy_condition_t {
     xpum_policy_conditon_type_t type;
     uint64_t threshold;
+    uint64_t window;           ///< In milliseconds, only for SUSTAINED_GREATER and EWMA_GREATER
+    uint64_t releaseThreshold; ///< Only for SUSTAINED_GREATER, RATE_GREATER and EWMA_GREATER, they trigger once and again only after falling to this value, 0 for threshold
 } xpum_policy_condition_t;
 
 typedef enum xpum_policy_action_type_enum {
@@ -1126,8 +1603,45 @@ typedef enum xpum_dump_type_enum {
     XPUM_DUMP_MAX
 } xpum_dump_type_t;
 
+/**
+ * @brief Format of the raw data dump file
+ */
+typedef enum xpum_dump_format_enum {
+    XPUM_DUMP_FORMAT_CSV = 0,              ///< Comma separated text, one row per sample
+    XPUM_DUMP_FORMAT_BINARY = 1,           ///< Column schema header followed by fixed-width little-endian rows
+    XPUM_DUMP_FORMAT_TRACE = 2,            ///< Chrome trace event JSON, counter tracks per device, tile and engine, throttle slices and policy and RAS instant events
+} xpum_dump_format_t;
+
+/**
+ * @brief Layout of the raw data dump file when a task dumps more than one device
+ */
+typedef enum xpum_dump_layout_enum {
+    XPUM_DUMP_LAYOUT_LONG = 0,             ///< One row per device per sample, told apart by the DeviceId column
+    XPUM_DUMP_LAYOUT_WIDE = 1,             ///< One row per sample holding the columns of all the devices
+} xpum_dump_layout_t;
+
+/**
+ * Bit of xpum_dump_raw_data_option_t::triggerMask, the health of a dumped device turns critical
+ */
+#define XPUM_DUMP_TRIGGER_HEALTH (1U << 30)
+
+/**
+ * Bit of xpum_dump_raw_data_option_t::triggerMask, the diagnostics of a dumped device fail
+ */
+#define XPUM_DUMP_TRIGGER_DIAGNOSTIC (1U << 31)
+
 typedef struct xpum_dump_raw_data_option_t {
     bool showDate;                         ///< Show date or not in the timestamp
+    xpum_dump_format_t format;             ///< Format of the dump file
+    xpum_dump_layout_t layout;             ///< Layout of the dump file for multiple devices
+    uint64_t rotateSize;                   ///< Start a new dump file before the current one exceeds this many bytes, 0 for no limit
+    uint32_t rotateInterval;               ///< Start a new dump file when the current one is this many seconds old, 0 for no limit
+    uint32_t maxFiles;                     ///< Remove the oldest dump files beyond this count, 0 to keep all
+    bool compress;                         ///< Compress the dump files with zstd, they get the suffix .zst
+    bool triggered;                        ///< Keep the latest rows in memory and write them out only when a policy of a dumped device is triggered
+    uint32_t preTriggerTime;               ///< Seconds of rows kept in memory and written out before the trigger
+    uint32_t postTriggerTime;              ///< Seconds of rows written out after the trigger
+    uint32_t triggerMask;                  ///< The triggers of the task, bit (1 << xpum_policy_type_t) per policy type, XPUM_DUMP_TRIGGER_HEALTH and XPUM_DUMP_TRIGGER_DIAGNOSTIC, 0 for all of them
 } xpum_dump_raw_data_option_t;
 
 /**
@@ -1142,6 +1656,13 @@ typedef struct xpum_dump_raw_data_task_t {
     int count;                                    ///< The count of entries in metricsTypeList
     uint64_t beginTime;                           ///< The begin time of the task
     char dumpFilePath[XPUM_MAX_STR_LENGTH];       ///< The dump file path
+    int deviceCount;                              ///< The count of entries in deviceIdList
+    xpum_device_id_t deviceIdList[XPUM_MAX_NUM_DEVICES]; ///< All the devices dumped by the task, deviceId is the first one
+    char currentFilePath[XPUM_MAX_STR_LENGTH];   ///< The file written now, the rotated files are dumpFilePath with the index before the extension
+    uint64_t currentFileBytes;                   ///< The bytes written to the current file, before compression
+    uint64_t totalBytes;                         ///< The bytes written to all the files of the task, before compression
+    uint32_t fileCount;                          ///< The count of files written by the task, including the removed ones
+    uint32_t triggerCount;                       ///< The count of policy triggers of a triggered task
 } xpum_dump_raw_data_task_t;
 
 typedef struct {
@@ -1167,6 +1688,13 @@ typedef struct xpum_vgpu_config_t {
     uint64_t lmemPerVf;     ///< Local memory per vGPU (in bytes), if set to 0 then apply the configuration file to allocate local memory for vGPUs
 } xpum_vgpu_config_t;
 
+typedef struct xpum_vgpu_provision_status_t {
+    bool running;           ///< Whether VFs are being created or removed on the device
+    uint32_t numVfs;        ///< Number of VFs whose attributes are written by the provisioning
+    uint32_t numVfsDone;    ///< Number of VFs whose attributes are already written
+    xpum_result_t result;   ///< Result of the last provisioning, valid when it is not running
+} xpum_vgpu_provision_status_t;
+
 
 typedef struct xpum_vgpu_function_info_t {
     char bdfAddress[XPUM_MAX_STR_LENGTH];       ///< BDF address of the function
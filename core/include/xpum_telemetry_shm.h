@@ -0,0 +1,304 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file xpum_telemetry_shm.h
+ */
+
+#ifndef _XPUM_TELEMETRY_SHM_H
+#define _XPUM_TELEMETRY_SHM_H
+
+#if defined(__cplusplus)
+#pragma once
+#endif
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__cplusplus)
+namespace xpum {
+extern "C" {
+#endif
+
+/**************************************************************************/
+/** @defgroup TELEMETRY_SHM Telemetry shared memory
+ * When xpumd is started with --telemetry_shm, it publishes the latest metrics
+ * of all devices and tiles into a POSIX shared memory segment after every
+ * monitor update. A process on the same host reads the table with the inline
+ * functions below, without any system call after xpumTelemetryShmOpen().
+ *
+ * The table is guarded by a sequence lock: the sequence is odd while xpumd
+ * writes, and a reader retries if the sequence changed during its copy.
+ *
+ * The segment also has the PCIe counters of the GPUs by PCI address. xpumd
+ * owns the IIO PMU, so a daemonless xpu-smi reads them from here instead of
+ * programming the PMU again while xpumd samples it.
+ * @{
+ */
+/**************************************************************************/
+
+/**
+ * The name of the shared memory segment
+ */
+#define XPUM_TELEMETRY_SHM_NAME "/xpum_telemetry"
+
+/**
+ * The magic number at the start of the segment, "XPUM"
+ */
+#define XPUM_TELEMETRY_SHM_MAGIC 0x4d555058
+
+/**
+ * The layout version, changed whenever the header or entry layout changes
+ */
+#define XPUM_TELEMETRY_SHM_VERSION 2
+
+/**
+ * Max count of entries in the segment
+ */
+#define XPUM_TELEMETRY_SHM_MAX_ENTRIES 8192
+
+/**
+ * Max count of PCIe counter entries in the segment
+ */
+#define XPUM_TELEMETRY_SHM_MAX_PCIE_ENTRIES 64
+
+/**
+ * How many times a read is retried while xpumd keeps updating the table
+ */
+#define XPUM_TELEMETRY_SHM_READ_RETRIES 64
+
+/**
+ * Return codes of the telemetry shared memory functions
+ */
+#define XPUM_TELEMETRY_SHM_OK 0
+#define XPUM_TELEMETRY_SHM_NOT_AVAILABLE -1    ///< The segment does not exist or xpumd has stopped publishing, open it again
+#define XPUM_TELEMETRY_SHM_VERSION_MISMATCH -2 ///< The segment has a layout this header does not know
+#define XPUM_TELEMETRY_SHM_BUFFER_TOO_SMALL -3 ///< The buffer can not hold all entries, count is set to the entries needed
+#define XPUM_TELEMETRY_SHM_BUSY -4             ///< The table was updated during every retry
+
+/**
+ * @brief Struct of one metric of a device or a tile
+ *
+ */
+typedef struct xpum_telemetry_shm_entry_t {
+    int32_t deviceId;    ///< Device id
+    int32_t tileId;      ///< The tile id, -1 for the device level metric
+    int32_t metricsType; ///< Metric type, the value of xpum_stats_type_t
+    uint32_t isCounter;  ///< If this metric is a counter
+    uint32_t scale;      ///< The magnification of the value field
+    uint32_t reserved;
+    uint64_t value;      ///< The value of this metric type
+    uint64_t timestamp;  ///< The timestamp of this data
+} xpum_telemetry_shm_entry_t;
+
+/**
+ * @brief Struct of the PCIe counters of one GPU
+ *
+ */
+typedef struct xpum_telemetry_shm_pcie_entry_t {
+    uint32_t domain;          ///< PCI domain
+    uint8_t bus;              ///< PCI bus
+    uint8_t device;           ///< PCI device
+    uint8_t function;         ///< PCI function
+    uint8_t reserved;
+    uint64_t readThroughput;  ///< PCIe read throughput in kB/s
+    uint64_t writeThroughput; ///< PCIe write throughput in kB/s
+    uint64_t read;            ///< PCIe read bytes since xpumd started
+    uint64_t write;           ///< PCIe write bytes since xpumd started
+    uint64_t timestamp;       ///< The timestamp of this data
+} xpum_telemetry_shm_pcie_entry_t;
+
+/**
+ * @brief Struct at the start of the segment, followed by maxEntries entries,
+ * and by maxPcieEntries PCIe entries at pcieOffset
+ *
+ */
+typedef struct xpum_telemetry_shm_header_t {
+    uint32_t magic;      ///< XPUM_TELEMETRY_SHM_MAGIC while xpumd publishes, 0 after it stopped
+    uint32_t version;    ///< XPUM_TELEMETRY_SHM_VERSION
+    uint32_t headerSize; ///< The size of this header
+    uint32_t entrySize;  ///< The size of one entry
+    uint32_t maxEntries; ///< The count of entries the segment has room for
+    uint32_t entryCount; ///< The count of valid entries
+    uint64_t sequence;   ///< The sequence lock, odd while the table is written
+    uint64_t timestamp;  ///< The time of the last update
+    uint32_t pcieOffset;     ///< The offset of the PCIe entries from the start of the segment
+    uint32_t pcieEntrySize;  ///< The size of one PCIe entry
+    uint32_t maxPcieEntries; ///< The count of PCIe entries the segment has room for
+    uint32_t pcieEntryCount; ///< The count of valid PCIe entries, 0 if xpumd does not sample PCIe
+} xpum_telemetry_shm_header_t;
+
+/**
+ * @brief Struct of an opened segment
+ *
+ */
+typedef struct xpum_telemetry_shm_reader_t {
+    const xpum_telemetry_shm_header_t* header; ///< The mapped segment, NULL if not opened
+    size_t size;                               ///< The size of the mapping
+} xpum_telemetry_shm_reader_t;
+
+/**
+ * @brief Map the segment published by xpumd, read only
+ *
+ * @param reader    OUT: the opened segment
+ * @return int
+ *      - \ref XPUM_TELEMETRY_SHM_OK                if successful
+ *      - \ref XPUM_TELEMETRY_SHM_NOT_AVAILABLE     if xpumd does not publish the segment
+ *      - \ref XPUM_TELEMETRY_SHM_VERSION_MISMATCH  if the segment has an unknown layout
+ */
+static inline int xpumTelemetryShmOpen(xpum_telemetry_shm_reader_t* reader) {
+    struct stat st;
+    void* addr;
+    const xpum_telemetry_shm_header_t* header;
+    int fd;
+
+    reader->header = NULL;
+    reader->size = 0;
+    fd = shm_open(XPUM_TELEMETRY_SHM_NAME, O_RDONLY, 0);
+    if (fd < 0) {
+        return XPUM_TELEMETRY_SHM_NOT_AVAILABLE;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(xpum_telemetry_shm_header_t)) {
+        close(fd);
+        return XPUM_TELEMETRY_SHM_NOT_AVAILABLE;
+    }
+    addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return XPUM_TELEMETRY_SHM_NOT_AVAILABLE;
+    }
+    header = (const xpum_telemetry_shm_header_t*)addr;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != XPUM_TELEMETRY_SHM_MAGIC) {
+        munmap(addr, (size_t)st.st_size);
+        return XPUM_TELEMETRY_SHM_NOT_AVAILABLE;
+    }
+    if (header->version != XPUM_TELEMETRY_SHM_VERSION || header->headerSize != sizeof(xpum_telemetry_shm_header_t) ||
+        header->entrySize != sizeof(xpum_telemetry_shm_entry_t) ||
+        (size_t)st.st_size < header->headerSize + (size_t)header->maxEntries * header->entrySize ||
+        header->pcieEntrySize != sizeof(xpum_telemetry_shm_pcie_entry_t) ||
+        (size_t)st.st_size < header->pcieOffset + (size_t)header->maxPcieEntries * header->pcieEntrySize) {
+        munmap(addr, (size_t)st.st_size);
+        return XPUM_TELEMETRY_SHM_VERSION_MISMATCH;
+    }
+    reader->header = header;
+    reader->size = (size_t)st.st_size;
+    return XPUM_TELEMETRY_SHM_OK;
+}
+
+/**
+ * @brief Copy a consistent snapshot of one table of the segment, used by
+ * xpumTelemetryShmRead() and xpumTelemetryShmReadPCIe()
+ */
+static inline int xpumTelemetryShmCopy(const xpum_telemetry_shm_reader_t* reader, size_t offset, const uint32_t* tableCount,
+                                       uint32_t maxCount, size_t entrySize, void* entries, uint32_t* count, uint64_t* timestamp) {
+    const xpum_telemetry_shm_header_t* header = reader->header;
+    uint64_t begin, end, ts;
+    uint32_t n;
+    int retry;
+
+    for (retry = 0; retry < XPUM_TELEMETRY_SHM_READ_RETRIES; retry++) {
+        if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != XPUM_TELEMETRY_SHM_MAGIC) {
+            return XPUM_TELEMETRY_SHM_NOT_AVAILABLE;
+        }
+        begin = __atomic_load_n(&header->sequence, __ATOMIC_ACQUIRE);
+        if (begin & 1) {
+            continue;
+        }
+        n = *tableCount;
+        ts = header->timestamp;
+        if (n > maxCount) {
+            continue;
+        }
+        if (n > *count) {
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&header->sequence, __ATOMIC_RELAXED) != begin) {
+                continue;
+            }
+            *count = n;
+            return XPUM_TELEMETRY_SHM_BUFFER_TOO_SMALL;
+        }
+        memcpy(entries, (const char*)header + offset, (size_t)n * entrySize);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        end = __atomic_load_n(&header->sequence, __ATOMIC_RELAXED);
+        if (begin != end) {
+            continue;
+        }
+        *count = n;
+        if (timestamp != NULL) {
+            *timestamp = ts;
+        }
+        return XPUM_TELEMETRY_SHM_OK;
+    }
+    return XPUM_TELEMETRY_SHM_BUSY;
+}
+
+/**
+ * @brief Copy a consistent snapshot of the metric table
+ *
+ * @param reader    IN: the segment opened by xpumTelemetryShmOpen()
+ * @param entries   OUT: the buffer to copy the entries to
+ * @param count     IN/OUT: the size of the buffer, set to the count of entries copied
+ * @param timestamp OUT: the time of the update the entries belong to, may be NULL
+ * @return int
+ *      - \ref XPUM_TELEMETRY_SHM_OK                if successful
+ *      - \ref XPUM_TELEMETRY_SHM_NOT_AVAILABLE     if the segment is not opened or xpumd has stopped
+ *      - \ref XPUM_TELEMETRY_SHM_BUFFER_TOO_SMALL  if the buffer is too small
+ *      - \ref XPUM_TELEMETRY_SHM_BUSY              if no consistent copy could be taken
+ */
+static inline int xpumTelemetryShmRead(const xpum_telemetry_shm_reader_t* reader, xpum_telemetry_shm_entry_t* entries,
+                                       uint32_t* count, uint64_t* timestamp) {
+    const xpum_telemetry_shm_header_t* header = reader->header;
+
+    if (header == NULL) {
+        return XPUM_TELEMETRY_SHM_NOT_AVAILABLE;
+    }
+    return xpumTelemetryShmCopy(reader, header->headerSize, &header->entryCount, header->maxEntries,
+                                sizeof(xpum_telemetry_shm_entry_t), entries, count, timestamp);
+}
+
+/**
+ * @brief Copy a consistent snapshot of the PCIe counters
+ *
+ * @param reader    IN: the segment opened by xpumTelemetryShmOpen()
+ * @param entries   OUT: the buffer to copy the PCIe entries to
+ * @param count     IN/OUT: the size of the buffer, set to the count of entries copied
+ * @param timestamp OUT: the time of the update the entries belong to, may be NULL
+ * @return int
+ *      - the return codes of xpumTelemetryShmRead()
+ */
+static inline int xpumTelemetryShmReadPCIe(const xpum_telemetry_shm_reader_t* reader, xpum_telemetry_shm_pcie_entry_t* entries,
+                                           uint32_t* count, uint64_t* timestamp) {
+    const xpum_telemetry_shm_header_t* header = reader->header;
+
+    if (header == NULL) {
+        return XPUM_TELEMETRY_SHM_NOT_AVAILABLE;
+    }
+    return xpumTelemetryShmCopy(reader, header->pcieOffset, &header->pcieEntryCount, header->maxPcieEntries,
+                                sizeof(xpum_telemetry_shm_pcie_entry_t), entries, count, timestamp);
+}
+
+/**
+ * @brief Unmap the segment
+ *
+ * @param reader    IN: the segment opened by xpumTelemetryShmOpen()
+ */
+static inline void xpumTelemetryShmClose(xpum_telemetry_shm_reader_t* reader) {
+    if (reader->header != NULL) {
+        munmap((void*)reader->header, reader->size);
+    }
+    reader->header = NULL;
+    reader->size = 0;
+}
+
+/** @} */ // Closing for TELEMETRY_SHM
+
+#if defined(__cplusplus)
+} // extern "C"
+} // end namespace xpum
+#endif
+
+#endif // _XPUM_TELEMETRY_SHM_H
@@ -67,6 +67,7 @@ struct GetAmcSlotSerialNumbersParam{
 class AmcManager {
    public:
     std::atomic<int> percent;
+    virtual ~AmcManager() {}
     virtual bool preInit() = 0;
     virtual bool init(InitParam& param) = 0;
     virtual std::string getProtocol() = 0;
@@ -11,6 +11,7 @@
 #include <string>
 #include <sstream>
 #include "ipmi/ipmi.h"
+#include "ipmi/sensor_reading.h"
 
 namespace xpum {
 
@@ -50,12 +51,15 @@ bool IpmiAmcManager::init(InitParam& param) {
 static std::vector<std::string> getAMCFwVersionsInternal() {
     std::vector<std::string> versions;
     int count;
+    SensorReadingCollector::instance().pause();
     int err = cmd_get_amc_firmware_versions(nullptr, &count);
     if (err != 0 || count <= 0) {
+        SensorReadingCollector::instance().resume();
         return versions;
     }
     int buf[count][4];
     err = cmd_get_amc_firmware_versions(buf, &count);
+    SensorReadingCollector::instance().resume();
     if (err != 0) {
         return versions;
     }
@@ -100,7 +104,10 @@ void IpmiAmcManager::flashAMCFirmware(FlashAmcFirmwareParam& param) {
 
         setPercentCallbackAndContext(percent_callback, this);
 
+        // the cards are discovered again after the update
+        SensorReadingCollector::instance().pause();
         int rc = cmd_firmware(param.file.c_str(), nullptr);
+        SensorReadingCollector::instance().resume(true);
 
         auto result = rc == 0 ? xpum_firmware_flash_result_t::XPUM_DEVICE_FIRMWARE_FLASH_OK : xpum_firmware_flash_result_t::XPUM_DEVICE_FIRMWARE_FLASH_ERROR;
 
@@ -151,7 +158,10 @@ void IpmiAmcManager::getAMCSlotSerialNumbers(GetAmcSlotSerialNumbersParam& param
 }
 
 void IpmiAmcManager::getAMCSerialNumberByRiserSlot(uint8_t baseboardSlot, uint8_t riserSlot, std::string &serialNumber) {
-    if (int err = get_sn_number(baseboardSlot, riserSlot, serialNumber)) {
+    SensorReadingCollector::instance().pause();
+    int err = get_sn_number(baseboardSlot, riserSlot, serialNumber);
+    SensorReadingCollector::instance().resume();
+    if (err) {
         XPUM_LOG_ERROR("Get AMC Serial Number failed, NRV error code: {}", err);
     }
 }
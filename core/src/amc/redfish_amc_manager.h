@@ -22,7 +22,8 @@ class RedfishAmcManager : public AmcManager {
         return "redfish";
     }
 
-    static std::shared_ptr<AmcManager> instance();
+    // the manager of the vendor of this system, the caller owns it
+    static AmcManager* create();
 
     void readConfigFile();
 };
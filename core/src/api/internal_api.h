@@ -58,6 +58,12 @@ std::vector<EngineCount> getDeviceAndTileEngineCount(xpum_device_id_t deviceId);
 
 std::vector<FabricCount> getDeviceAndTileFabricCount(xpum_device_id_t deviceId);
 
+/**
+ * @brief Start reading the slow properties of all devices in the background,
+ * so the first \ref xpumGetAllDeviceProperties does not wait for them.
+ */
+void prefetchDeviceProperties();
+
 /**************************************************************************/
 /** @defgroup METRICS_API Get metrics data
  * These APIs are for collecting metrics data
@@ -95,6 +101,105 @@ xpum_result_t xpumGetEngineUtilizations(xpum_device_id_t deviceId,
                                         xpum_device_engine_metric_t dataList[],
                                         uint32_t *count);
 
+/**
+ * @brief Get statistics, per engine statistics and fabric throughput statistics of devices in one call
+ * @details The monitor does not store new samples while the devices are read, so the data of all devices comes from
+ * the same sampling ticks. Per engine and fabric throughput statistics are left out for devices not supporting them.
+ * The tile to device and device to card aggregations of the statistics are derived in the same call.
+ *
+ * @param deviceIdList      IN: The device id list, all devices if empty
+ * @param deviceCount       IN: The count of devices in \a deviceIdList
+ * @param stats            OUT: The statistics of the devices and their tiles
+ * @param engineStats      OUT: The per engine statistics
+ * @param fabricStats      OUT: The fabric throughput statistics
+ * @param derivedStats     OUT: The device statistics aggregated from tiles and the card statistics aggregated from devices
+ * @param begin            OUT: The earliest begin timestamp of the devices
+ * @param end              OUT: The end timestamp shared by all devices
+ * @param sessionId         IN: The statistics session id
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if query successfully
+ *      - \ref XPUM_RESULT_DEVICE_NOT_FOUND if a device id is invalid
+ *      - \ref XPUM_UNSUPPORTED_SESSIONID   if \a sessionId is invalid
+ */
+xpum_result_t xpumGetStatsBulk(xpum_device_id_t deviceIdList[],
+                               uint32_t deviceCount,
+                               std::vector<xpum_device_stats_t> &stats,
+                               std::vector<xpum_device_engine_stats_t> &engineStats,
+                               std::vector<xpum_device_fabric_throughput_stats_t> &fabricStats,
+                               std::vector<DerivedStats> &derivedStats,
+                               uint64_t *begin,
+                               uint64_t *end,
+                               uint64_t sessionId);
+
+/**
+ * @brief Wait for new metrics data
+ * @details Blocks until the monitor stores data after the given generation or the timeout expires. Subscribers
+ * keep the returned generation and pass it to the next call.
+ *
+ * @param generation    IN/OUT: The generation seen last, 0 for the first call. When return, the current generation
+ * @param timeout           IN: The max time to wait, in milliseconds
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if new data is stored
+ *      - \ref XPUM_GENERIC_ERROR       if no data is stored before the timeout
+ */
+xpum_result_t xpumWaitForMetricsUpdate(uint64_t *generation, uint32_t timeout);
+
+/**
+ * @brief Get the topology version
+ * @details The version changes when a PCI device is added, removed, or bound to or unbound from a driver, the
+ * topologies and the device list read before may differ from the current ones then.
+ *
+ * @param version          OUT: The topology version
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if query successfully
+ */
+xpum_result_t xpumGetTopologyVersion(uint64_t *version);
+
+/**
+ * @brief Wait for the progress of a firmware flash
+ * @details Blocks until the percentage or the result of a firmware flash of the device may have changed since the given
+ * generation, or the timeout expires. The caller reads the result again with xpumGetFirmwareFlashResult.
+ *
+ * @param deviceId          IN: Device id, -1 for the flashes of all devices
+ * @param generation    IN/OUT: The generation seen last, 0 for the first call. When return, the current generation
+ * @param timeout           IN: The max time to wait, in milliseconds
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if the flash progressed
+ *      - \ref XPUM_GENERIC_ERROR       if it did not progress before the timeout
+ */
+xpum_result_t xpumWaitForFirmwareFlashProgress(xpum_device_id_t deviceId, uint64_t *generation, uint32_t timeout);
+
+/**
+ * @brief Wait for the progress of the diagnostics
+ * @details Blocks until a test of the diagnostics of the device is done since the given generation, or the timeout
+ * expires. The caller reads the result again with xpumGetDiagnosticsResult.
+ *
+ * @param deviceId          IN: Device id, -1 for the diagnostics of all devices
+ * @param generation    IN/OUT: The generation seen last, 0 for the first call. When return, the current generation
+ * @param timeout           IN: The max time to wait, in milliseconds
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if the diagnostics progressed
+ *      - \ref XPUM_GENERIC_ERROR       if they did not progress before the timeout
+ */
+xpum_result_t xpumWaitForDiagnosticsProgress(xpum_device_id_t deviceId, uint64_t *generation, uint32_t timeout);
+
+/**
+ * @brief Get the realtime metrics of a device list if the monitor stored data since a generation
+ * @details The metrics are written to dataList in one pass from the latest data of the handlers, like
+ * xpumGetRealtimeMetricsEx. Pollers keep the returned generation and pass it to the next call, which
+ * returns no entries if nothing is stored in between.
+ *
+ * @param deviceIdList  IN: Device id list
+ * @param deviceCount   IN: Device id count
+ * @param dataList     OUT: The array to store realtime metrics, NULL to query the count
+ * @param count     IN/OUT: The length of \a dataList, when return, the number of entries returned, 0 if no data is stored since \a generation
+ * @param generation IN/OUT: The generation seen last, 0 for the first call. When return, the generation of the returned metrics
+ * @return xpum_result_t
+ *      - \ref XPUM_OK                  if query successfully
+ *      - \ref XPUM_BUFFER_TOO_SMALL    if \a count is smaller than needed
+ */
+xpum_result_t xpumGetRealtimeMetricsIfUpdated(xpum_device_id_t deviceIdList[], uint32_t deviceCount, xpum_device_realtime_metrics_t dataList[], uint32_t *count, uint64_t *generation);
+
 /**
  * @brief Get latest fabri throughput data by device
  *
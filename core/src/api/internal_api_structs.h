@@ -35,4 +35,18 @@ struct FabricCount {
     std::vector<FabricLinkInfo_t> dataList;
 };
 
+/*
+  A statistic of a device aggregated from its tiles when the device has no
+  device level data of the metric, or of a card aggregated from its devices.
+*/
+struct DerivedStats {
+    bool isCard;
+    uint32_t id;                    // the device id, or the id of the built-in group of the card
+    xpum_stats_type_t metricsType;
+    bool isAccumulated;             // value aggregates the accumulated fields, otherwise the avg fields
+    bool isSum;                     // value is the sum of the sources, otherwise their average
+    uint64_t value;
+    uint32_t scale;
+};
+
 } // namespace xpum
\ No newline at end of file
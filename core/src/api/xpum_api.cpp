@@ -10,8 +10,11 @@
 #include <string>
 #include <cstring>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 #include <dlfcn.h>
@@ -29,22 +32,30 @@
 #include "device/memoryEcc.h"
 #include "device/power.h"
 #include "device/amcInBand.h"
+#include "device/gpu/device_config_cache.h"
 #include "device/gpu/gpu_device_stub.h"
+#include "device/gpu/sysfs_metric_reader.h"
+#include "event/task_progress.h"
+#include "firmware/firmware_image.h"
 #include "infrastructure/configuration.h"
 #include "infrastructure/device_process.h"
 #include "infrastructure/device_util_by_proc.h"
 #include "infrastructure/device_property.h"
 #include "infrastructure/exception/level_zero_initialization_exception.h"
+#include "infrastructure/internal_stats.h"
 #include "infrastructure/version.h"
 #include "infrastructure/perf_measurement_data.h"
+#include "infrastructure/topdown_analysis.h"
 #include "infrastructure/utility.h"
 #include "internal_api.h"
+#include "monitor/sampling_cost_profiler.h"
 #include "ext-include/igsc_lib.h"
 #include "log/dbg_log.h"
 #include "vgpu/precheck.h"
 #include "level_zero/ze_api.h"
 #include "level_zero/zes_api.h"
 #include "diagnostic/precheck.h"
+#include "topology/topology.h"
 
 namespace xpum {
 
@@ -159,7 +170,7 @@ xpum_result_t validateDeviceId(xpum_device_id_t deviceId) {
         return res;
     }
 
-    auto pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    auto pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (pDevice == nullptr)
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     return XPUM_OK;
@@ -171,12 +182,10 @@ xpum_result_t validateDeviceIdAndTileId(xpum_device_id_t deviceId, xpum_device_t
         return res;
     }
 
-    auto pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    auto pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (pDevice == nullptr)
         return XPUM_RESULT_DEVICE_NOT_FOUND;
-    Property prop;
-    pDevice->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_TILES, prop);
-    if (tileId < 0 || tileId >= prop.getValueInt())
+    if (tileId < 0 || tileId >= pDevice->getPropertyLong(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_TILES))
         return XPUM_RESULT_TILE_NOT_FOUND;
     return XPUM_OK;
 }
@@ -190,26 +199,24 @@ xpum_result_t xpumGetEngineCount(xpum_device_id_t deviceId,
         return res;
     }
 
-    auto pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    auto pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (pDevice == nullptr)
         return XPUM_RESULT_DEVICE_NOT_FOUND;
-    *count = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getEngineCount(tileId, Utility::toZESEngineType(type));
+    *count = Core::instance().getDeviceManager()->getDevice(deviceId)->getEngineCount(tileId, Utility::toZESEngineType(type));
     return XPUM_OK;
 }
 
 std::vector<EngineCount> getDeviceAndTileEngineCount(xpum_device_id_t deviceId) {
     auto res = std::vector<EngineCount>();
-    auto pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    auto pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (pDevice == nullptr)
         return res;
-    Property prop;
-    pDevice->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_TILES, prop);
-    auto tileCount = prop.getValueInt();
+    auto tileCount = pDevice->getPropertyLong(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_TILES);
     if (tileCount == 1) {
         EngineCount ec;
         ec.isTileLevel = false;
         for (int engineType = 0; engineType < XPUM_ENGINE_TYPE_UNKNOWN; engineType++) {
-            int c = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getEngineCount(-1, Utility::toZESEngineType((xpum_engine_type_t)engineType));
+            int c = Core::instance().getDeviceManager()->getDevice(deviceId)->getEngineCount(-1, Utility::toZESEngineType((xpum_engine_type_t)engineType));
             EngineCountData data;
             data.count = c;
             data.engineType = (xpum_engine_type_t)engineType;
@@ -222,7 +229,7 @@ std::vector<EngineCount> getDeviceAndTileEngineCount(xpum_device_id_t deviceId)
             ec.isTileLevel = true;
             ec.tileId = tileId;
             for (int engineType = 0; engineType < XPUM_ENGINE_TYPE_UNKNOWN; engineType++) {
-                int c = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getEngineCount(tileId, Utility::toZESEngineType((xpum_engine_type_t)engineType));
+                int c = Core::instance().getDeviceManager()->getDevice(deviceId)->getEngineCount(tileId, Utility::toZESEngineType((xpum_engine_type_t)engineType));
                 EngineCountData data;
                 data.count = c;
                 data.engineType = (xpum_engine_type_t)engineType;
@@ -236,7 +243,7 @@ std::vector<EngineCount> getDeviceAndTileEngineCount(xpum_device_id_t deviceId)
 
 std::vector<FabricCount> getDeviceAndTileFabricCount(xpum_device_id_t deviceId) {
     auto res = std::vector<FabricCount>();
-    auto pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    auto pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (pDevice == nullptr)
         return res;
 
@@ -252,9 +259,7 @@ std::vector<FabricCount> getDeviceAndTileFabricCount(xpum_device_id_t deviceId)
         return res;
     }
 
-    Property prop;
-    pDevice->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_TILES, prop);
-    uint32_t tileCount = prop.getValueInt();
+    uint32_t tileCount = pDevice->getPropertyLong(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_TILES);
     if (tileCount == 1) {
         FabricCount fc;
         fc.isTileLevel = false;
@@ -480,7 +485,7 @@ xpum_result_t xpumGetSerialNumberAndAmcFwVersion(xpum_device_id_t deviceId,
     if (res != XPUM_OK)
         return res;
 
-    auto pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    auto pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
 
     std::vector<Property> properties;
     pDevice->getProperties(properties);
@@ -589,6 +594,15 @@ static xpum_result_t validateFwImagePath(xpum_firmware_flash_job *job) {
     if (job->filePath == nullptr)
         return XPUM_UPDATE_FIRMWARE_IMAGE_FILE_NOT_FOUND;
 
+    // a GFX or GFX_DATA image flashed before can be given by its hash instead of its path
+    if (std::strncmp(job->filePath, "sha256:", 7) == 0) {
+        if (job->type != XPUM_DEVICE_FIRMWARE_GFX && job->type != XPUM_DEVICE_FIRMWARE_GFX_DATA)
+            return XPUM_UPDATE_FIRMWARE_IMAGE_FILE_NOT_FOUND;
+        if (FirmwareImageCache::instance().load(job->filePath) == nullptr)
+            return XPUM_UPDATE_FIRMWARE_IMAGE_FILE_NOT_FOUND;
+        return XPUM_OK;
+    }
+
     std::ifstream fwFile(job->filePath);
     if (!fwFile.is_open()) {
         XPUM_LOG_INFO("invalid file");
@@ -919,6 +933,114 @@ std::string eccStateToString(xpum_ecc_state_t state) {
     return "";
 }
 
+// the properties read from the firmware of a device, too slow to be read on every query
+struct SlowDeviceProperties {
+    std::string amcFwVersion;
+    xpum_ecc_state_t eccState = XPUM_ECC_STATE_UNAVAILABLE;
+};
+
+static std::mutex slowPropertiesMutex;
+
+static std::map<xpum_device_id_t, std::shared_future<SlowDeviceProperties>> slowProperties;
+
+static SlowDeviceProperties readSlowDeviceProperties(std::shared_ptr<Device> p_device, xpum_device_id_t deviceId) {
+    SlowDeviceProperties slow;
+    Property functionType;
+    if (!p_device->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_DEVICE_FUNCTION_TYPE, functionType) ||
+        functionType.getValueInt() != DEVICE_FUNCTION_TYPE_PHYSICAL) {
+        return slow;
+    }
+    //amc version for pvc
+    if (p_device->getDeviceModel() == XPUM_DEVICE_MODEL_PVC) {
+        Property bdf;
+        p_device->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS, bdf);
+        std::string amc_version;
+        getAMCFirmwareVersionInBand(amc_version, bdf.getValue());
+        if (amc_version.compare("0.0.0.0") != 0) {
+            slow.amcFwVersion = amc_version;
+        }
+    }
+    bool available;
+    bool configurable;
+    xpum_ecc_state_t pending;
+    xpum_ecc_action_t action;
+    xpumGetEccState(deviceId, &available, &configurable, &slow.eccState, &pending, &action);
+    return slow;
+}
+
+/*
+ * getSlowDeviceProperties returns the slow properties of a device, read in
+ * the background once, or again if refresh is true.
+ */
+static std::shared_future<SlowDeviceProperties> getSlowDeviceProperties(std::shared_ptr<Device> p_device, xpum_device_id_t deviceId, bool refresh) {
+    std::lock_guard<std::mutex> lock(slowPropertiesMutex);
+    auto it = slowProperties.find(deviceId);
+    if (it != slowProperties.end() && !refresh) {
+        return it->second;
+    }
+    auto slow = std::async(std::launch::async, readSlowDeviceProperties, p_device, deviceId).share();
+    slowProperties[deviceId] = slow;
+    return slow;
+}
+
+static void fillDeviceProperties(std::shared_ptr<Device> &p_device, xpum_device_id_t deviceId,
+                                 const SlowDeviceProperties &slow, xpum_device_properties_t *pXpumProperties) {
+    pXpumProperties->deviceId = deviceId;
+    std::vector<Property> properties;
+    p_device->getProperties(properties);
+
+    std::map<xpum_device_internal_property_name_t, Property> prop_map;
+
+    for (size_t i = 0; i < properties.size(); i++) {
+        auto &prop = properties[i];
+        xpum_device_internal_property_name_t name = prop.getName();
+        prop_map[name] = prop;
+    }
+
+    if (!slow.amcFwVersion.empty()) {
+        prop_map[XPUM_DEVICE_PROPERTY_INTERNAL_AMC_FIRMWARE_VERSION].setValue(slow.amcFwVersion);
+    }
+
+    int propertyLen = 0;
+    for (int i = 0; i < XPUM_DEVICE_PROPERTY_MAX; i++) {
+        xpum_device_property_name_t propName = static_cast<xpum_device_property_name_t>(i);
+        auto propNameInternal = getDeviceInternalProperty(propName);
+        if (prop_map.find(propNameInternal) == prop_map.end()) {
+            continue;
+        }
+        auto &prop = prop_map[propNameInternal];
+        std::string value = prop.getValue();
+
+        if (propName == XPUM_DEVICE_PROPERTY_GFX_FIRMWARE_VERSION) {
+            value.erase(remove_if(value.begin(), value.end(), invalidChar), value.end());
+        }
+        auto &copy = pXpumProperties->properties[propertyLen++];
+        copy.name = propName;
+        strcpy(copy.value, value.c_str());
+    }
+    {
+        auto &copy = pXpumProperties->properties[propertyLen++];
+        copy.name = XPUM_DEVICE_PROPERTY_MEMORY_ECC_STATE;
+        std::string value = eccStateToString(slow.eccState);
+        strcpy(copy.value, value.c_str());
+    }
+
+    {
+        auto &copy = pXpumProperties->properties[propertyLen++];
+        copy.name = XPUM_DEVICE_PROPERTY_GFX_FIRMWARE_STATUS;
+        std::string fw_status_str;
+        if (Core::instance().getFirmwareManager()) {
+            auto fw_status = Core::instance().getFirmwareManager()->getGfxFwStatus(deviceId);
+            fw_status_str = FirmwareManager::transGfxFwStatusToString(fw_status);
+        } else {
+            fw_status_str = "";
+        }
+        strcpy(copy.value, fw_status_str.c_str());
+    }
+
+    pXpumProperties->propertyLen = propertyLen;
+}
+
 xpum_result_t xpumGetDeviceProperties(xpum_device_id_t deviceId, xpum_device_properties_t *pXpumProperties) {
     xpum_result_t res = Core::instance().apiAccessPreCheck();
     if (res != XPUM_OK) {
@@ -933,94 +1055,66 @@ xpum_result_t xpumGetDeviceProperties(xpum_device_id_t deviceId, xpum_device_pro
     if (res != XPUM_OK)
         return res;
 
+    // the firmware versions are read by the firmware manager warmup, wait for it
+    Core::instance().getFirmwareManager();
+
     std::vector<std::shared_ptr<Device>> devices;
     Core::instance().getDeviceManager()->getDeviceList(devices);
 
     for (auto &p_device : devices) {
         if (deviceId == stoi(p_device->getId())) {
-            pXpumProperties->deviceId = deviceId;
-            std::vector<Property> properties;
-            p_device->getProperties(properties);
-
-            std::map<xpum_device_internal_property_name_t, Property> prop_map;
-
-            for (size_t i = 0; i < properties.size(); i++) {
-                auto &prop = properties[i];
-                xpum_device_internal_property_name_t name = prop.getName();
-                prop_map[name] = prop;
-            }
+            // the query of one device reads the slow properties again
+            auto slow = getSlowDeviceProperties(p_device, deviceId, true);
+            fillDeviceProperties(p_device, deviceId, slow.get(), pXpumProperties);
+            return XPUM_OK;
+        }
+    }
 
-            {
-                //amc version for pvc
-                if(prop_map[
-                        XPUM_DEVICE_PROPERTY_INTERNAL_DEVICE_FUNCTION_TYPE].
-                        getValueInt() == DEVICE_FUNCTION_TYPE_PHYSICAL &&
-                        p_device->getDeviceModel() == XPUM_DEVICE_MODEL_PVC) {
-                    std::string amc_version;
-                    std::string bdf = prop_map[XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS].getValue();
-                    getAMCFirmwareVersionInBand(amc_version, bdf);
-                    if (amc_version.compare("0.0.0.0") != 0) {
-                        prop_map[XPUM_DEVICE_PROPERTY_INTERNAL_AMC_FIRMWARE_VERSION].setValue(std::string(amc_version.c_str()));
-                    }
-                }
-            }
+    return XPUM_RESULT_DEVICE_NOT_FOUND;
+}
 
-            int propertyLen = 0;
-            for (int i = 0; i < XPUM_DEVICE_PROPERTY_MAX; i++) {
-                xpum_device_property_name_t propName = static_cast<xpum_device_property_name_t>(i);
-                auto propNameInternal = getDeviceInternalProperty(propName);
-                if (prop_map.find(propNameInternal) == prop_map.end()) {
-                    continue;
-                }
-                auto &prop = prop_map[propNameInternal];
-                std::string value = prop.getValue();
+xpum_result_t xpumGetAllDeviceProperties(xpum_device_properties_t properties[], int *count) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
 
-                if (propName == XPUM_DEVICE_PROPERTY_GFX_FIRMWARE_VERSION) {
-                    value.erase(remove_if(value.begin(), value.end(), invalidChar), value.end());
-                }
-                auto &copy = pXpumProperties->properties[propertyLen++];
-                copy.name = propName;
-                strcpy(copy.value, value.c_str());
-            }
-            {
-                bool available;
-                bool configurable;
-                xpum_ecc_state_t current = XPUM_ECC_STATE_UNAVAILABLE;
-                xpum_ecc_state_t pending;
-                xpum_ecc_action_t action;
-                // Skip getting ECC state of VF through igsc API call
-                if (prop_map[
-                        XPUM_DEVICE_PROPERTY_INTERNAL_DEVICE_FUNCTION_TYPE].
-                        getValueInt() == DEVICE_FUNCTION_TYPE_PHYSICAL) {
-                    res = xpumGetEccState(deviceId, &available, 
-                            &configurable, &current, &pending, &action);
-                }
-                auto &copy = pXpumProperties->properties[propertyLen++];
-                copy.name = XPUM_DEVICE_PROPERTY_MEMORY_ECC_STATE;
-                std::string value = eccStateToString(current);
-                strcpy(copy.value, value.c_str());
-            }
+    if (Core::instance().getDeviceManager() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
 
-            {
-                auto &copy = pXpumProperties->properties[propertyLen++];
-                copy.name = XPUM_DEVICE_PROPERTY_GFX_FIRMWARE_STATUS;
-                std::string fw_status_str;
-                if (Core::instance().getFirmwareManager()) {
-                    auto fw_status = Core::instance().getFirmwareManager()->getGfxFwStatus(deviceId);
-                    fw_status_str = FirmwareManager::transGfxFwStatusToString(fw_status);
-                } else {
-                    fw_status_str = "";
-                }
-                strcpy(copy.value, fw_status_str.c_str());
-            }
+    std::vector<std::shared_ptr<Device>> devices;
+    Core::instance().getDeviceManager()->getDeviceList(devices);
 
-            pXpumProperties->propertyLen = propertyLen;
+    if (properties == nullptr) {
+        *count = devices.size();
+        return XPUM_OK;
+    }
+    if (*count < (int)devices.size()) {
+        return XPUM_BUFFER_TOO_SMALL;
+    }
 
-            return XPUM_OK;
-        }
+    // the slow properties of all devices are read at the same time
+    std::vector<std::shared_future<SlowDeviceProperties>> slow;
+    for (auto &p_device : devices) {
+        slow.push_back(getSlowDeviceProperties(p_device, stoi(p_device->getId()), false));
+    }
+    for (size_t i = 0; i < devices.size(); i++) {
+        fillDeviceProperties(devices[i], stoi(devices[i]->getId()), slow[i].get(), &properties[i]);
     }
+    *count = devices.size();
+    return XPUM_OK;
+}
 
-    return XPUM_RESULT_DEVICE_NOT_FOUND;
+void prefetchDeviceProperties() {
+    if (Core::instance().getDeviceManager() == nullptr) {
+        return;
+    }
+    std::vector<std::shared_ptr<Device>> devices;
+    Core::instance().getDeviceManager()->getDeviceList(devices);
+    for (auto &p_device : devices) {
+        getSlowDeviceProperties(p_device, stoi(p_device->getId()), false);
+    }
 }
 
 xpum_result_t xpumGetDeviceIdByBDF(const char *bdf, xpum_device_id_t *deviceId) {
@@ -1055,6 +1149,24 @@ xpum_result_t xpumGroupCreate(const char *groupName, xpum_group_id_t *pGroupId)
     return Core::instance().getGroupManager()->createGroup(groupName, pGroupId);
 }
 
+xpum_result_t xpumGroupCreateBySelector(const char *groupName, const xpum_group_selector_t *selector, xpum_group_id_t *pGroupId) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    return Core::instance().getGroupManager()->createGroupBySelector(groupName, selector, pGroupId);
+}
+
+xpum_result_t xpumGroupGetSelector(xpum_group_id_t groupId, xpum_group_selector_t *selector) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    return Core::instance().getGroupManager()->getGroupSelector(groupId, selector);
+}
+
 xpum_result_t xpumGroupDestroy(xpum_group_id_t groupId) {
     xpum_result_t res = Core::instance().apiAccessPreCheck();
     if (res != XPUM_OK) {
@@ -1106,6 +1218,16 @@ xpum_result_t xpumGetStats(xpum_device_id_t deviceId,
                            uint64_t *begin,
                            uint64_t *end,
                            uint64_t sessionId) {
+    return xpumGetStatsByMask(deviceId, 0, dataList, count, begin, end, sessionId);
+}
+
+xpum_result_t xpumGetStatsByMask(xpum_device_id_t deviceId,
+                                 uint64_t metricsMask,
+                                 xpum_device_stats_t dataList[],
+                                 uint32_t *count,
+                                 uint64_t *begin,
+                                 uint64_t *end,
+                                 uint64_t sessionId) {
     xpum_result_t res = Core::instance().apiAccessPreCheck();
     if (res != XPUM_OK) {
         return res;
@@ -1131,7 +1253,391 @@ xpum_result_t xpumGetStats(xpum_device_id_t deviceId,
         }
     }
 
-    return Core::instance().getDataLogic()->getMetricsStatistics(deviceId, dataList, count, begin, end, sessionId);
+    return Core::instance().getDataLogic()->getMetricsStatistics(deviceId, dataList, count, begin, end, sessionId, true, metricsMask);
+}
+
+xpum_result_t xpumGetMetricsHistory(xpum_device_id_t deviceId,
+                                    xpum_stats_type_t metricsTypes[],
+                                    uint32_t metricsTypeCount,
+                                    uint64_t begin,
+                                    uint64_t end,
+                                    uint64_t step,
+                                    xpum_metrics_history_t seriesList[],
+                                    uint32_t *seriesCount,
+                                    xpum_metrics_history_point_t pointList[],
+                                    uint32_t *pointCount) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getDataLogic() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+    res = validateDeviceId(deviceId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if ((metricsTypes == nullptr && metricsTypeCount > 0) || seriesCount == nullptr || pointCount == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    return Core::instance().getDataLogic()->getMetricsHistory(deviceId, metricsTypes, metricsTypeCount, begin, end, step,
+                                                              seriesList, seriesCount, pointList, pointCount);
+}
+
+xpum_result_t xpumGetMetricsHistograms(xpum_device_id_t deviceId,
+                                       xpum_metrics_histogram_t histogramList[],
+                                       uint32_t *histogramCount,
+                                       xpum_metrics_histogram_bin_t binList[],
+                                       uint32_t *binCount) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getDataLogic() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+    res = validateDeviceId(deviceId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (histogramCount == nullptr || binCount == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    return Core::instance().getDataLogic()->getMetricsHistograms(deviceId, histogramList, histogramCount, binList, binCount);
+}
+
+xpum_result_t xpumGetThrottleResidency(xpum_device_id_t deviceId,
+                                       xpum_throttle_residency_t dataList[],
+                                       uint32_t *count) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getDataLogic() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+    res = validateDeviceId(deviceId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (count == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    return Core::instance().getDataLogic()->getThrottleResidency(deviceId, dataList, count);
+}
+
+template <typename T>
+static xpum_result_t fillHostTelemetry(const std::vector<T> &entries, T dataList[], uint32_t *count) {
+    if (dataList == nullptr) {
+        *count = entries.size();
+        return XPUM_OK;
+    }
+    if (*count < entries.size()) {
+        return XPUM_BUFFER_TOO_SMALL;
+    }
+    std::copy(entries.begin(), entries.end(), dataList);
+    *count = entries.size();
+    return XPUM_OK;
+}
+
+xpum_result_t xpumGetHostSocketTelemetry(xpum_host_socket_telemetry_t dataList[],
+                                         uint32_t *count) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+    if (count == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+    if (!Configuration::HOST_TELEMETRY) {
+        return XPUM_METRIC_NOT_ENABLED;
+    }
+    std::vector<xpum_host_socket_telemetry_t> sockets;
+    if (!GPUDeviceStub::pcie_manager.getHostSocketTelemetry(sockets)) {
+        return XPUM_METRIC_NOT_SUPPORTED;
+    }
+    return fillHostTelemetry(sockets, dataList, count);
+}
+
+xpum_result_t xpumGetHostIioStackTelemetry(xpum_host_iio_stack_telemetry_t dataList[],
+                                           uint32_t *count) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+    if (count == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+    if (!Configuration::HOST_TELEMETRY) {
+        return XPUM_METRIC_NOT_ENABLED;
+    }
+    std::vector<xpum_host_iio_stack_telemetry_t> stacks;
+    if (!GPUDeviceStub::pcie_manager.getHostIioStackTelemetry(stacks)) {
+        return XPUM_METRIC_NOT_SUPPORTED;
+    }
+    return fillHostTelemetry(stacks, dataList, count);
+}
+
+xpum_result_t xpumOpenJobWindow(const char *jobId,
+                                xpum_device_id_t deviceIdList[],
+                                uint32_t deviceCount) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getDataLogic() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    if (jobId == nullptr || (deviceIdList == nullptr && deviceCount > 0)) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    std::vector<xpum_device_id_t> deviceIds;
+    for (uint32_t i = 0; i < deviceCount; i++) {
+        res = validateDeviceId(deviceIdList[i]);
+        if (res != XPUM_OK) {
+            return res;
+        }
+        deviceIds.push_back(deviceIdList[i]);
+    }
+
+    return Core::instance().getDataLogic()->openJobWindow(jobId, deviceIds);
+}
+
+xpum_result_t xpumGetJobWindowStats(const char *jobId,
+                                    xpum_job_window_stats_t dataList[],
+                                    uint32_t *count) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getDataLogic() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    if (jobId == nullptr || count == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    return Core::instance().getDataLogic()->getJobWindowStats(jobId, dataList, count, false);
+}
+
+xpum_result_t xpumGetJobWindowProcessEnergy(const char *jobId,
+                                            xpum_job_process_energy_t dataList[],
+                                            uint32_t *count) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getDataLogic() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    if (jobId == nullptr || count == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    return Core::instance().getDataLogic()->getJobWindowProcessEnergy(jobId, dataList, count);
+}
+
+xpum_result_t xpumGetAppCounterEfficiency(xpum_device_id_t deviceId,
+                                          xpum_app_counter_efficiency_t dataList[],
+                                          uint32_t *count) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getDataLogic() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    if (count == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    res = validateDeviceId(deviceId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    return Core::instance().getDataLogic()->getAppCounterEfficiency(deviceId, dataList, count);
+}
+
+xpum_result_t xpumGetPerfMetrics(xpum_device_id_t deviceId,
+                                 uint32_t windowMs,
+                                 xpum_perf_metric_t dataList[],
+                                 uint32_t *count) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getDataLogic() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    if (count == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    res = validateDeviceId(deviceId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    return Core::instance().getDataLogic()->getPerfMetrics(deviceId, windowMs, dataList, count);
+}
+
+xpum_result_t xpumCloseJobWindow(const char *jobId,
+                                 xpum_job_window_stats_t dataList[],
+                                 uint32_t *count) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getDataLogic() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    if (jobId == nullptr || count == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    return Core::instance().getDataLogic()->getJobWindowStats(jobId, dataList, count, dataList != nullptr);
+}
+
+xpum_result_t xpumStartBurstSampling(xpum_device_id_t deviceId,
+                                     xpum_stats_type_t metricsTypes[],
+                                     uint32_t metricsTypeCount,
+                                     uint32_t interval,
+                                     uint32_t duration) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getMonitorManager() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    if (metricsTypes == nullptr && metricsTypeCount > 0) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    res = validateDeviceId(deviceId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    std::vector<xpum_stats_type_t> metrics(metricsTypes, metricsTypes + metricsTypeCount);
+    return Core::instance().getMonitorManager()->startBurstSampling(deviceId, metrics, interval, duration);
+}
+
+xpum_result_t xpumGetBurstSamples(xpum_device_id_t deviceId,
+                                  xpum_burst_sample_t sampleList[],
+                                  uint32_t *count,
+                                  bool *running,
+                                  uint64_t *dropped) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getMonitorManager() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    if (count == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    res = validateDeviceId(deviceId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    return Core::instance().getMonitorManager()->getBurstSamples(deviceId, sampleList, count, running, dropped);
+}
+
+xpum_result_t xpumStopBurstSampling(xpum_device_id_t deviceId) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getMonitorManager() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    res = validateDeviceId(deviceId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    return Core::instance().getMonitorManager()->stopBurstSampling(deviceId);
+}
+
+xpum_result_t xpumGetDeviceClockCorrelation(xpum_device_id_t deviceId,
+                                            xpum_clock_correlation_t *correlation) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getMonitorManager() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    res = validateDeviceId(deviceId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (correlation == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    return Core::instance().getMonitorManager()->getClockCorrelation(deviceId, correlation);
+}
+
+xpum_result_t xpumConvertDeviceTimestamp(xpum_device_id_t deviceId,
+                                         uint64_t deviceTimestamp,
+                                         xpum_clock_domain_t domain,
+                                         uint64_t *hostTimestamp) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getMonitorManager() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    res = validateDeviceId(deviceId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (hostTimestamp == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    return Core::instance().getMonitorManager()->convertDeviceTimestamp(deviceId, deviceTimestamp, domain, hostTimestamp);
 }
 
 xpum_result_t xpumGetStatsEx(xpum_device_id_t deviceIdList[],
@@ -1358,7 +1864,7 @@ xpum_result_t xpumGetFabricThroughputStats(xpum_device_id_t deviceId,
         return XPUM_METRIC_NOT_ENABLED;
     }
     std::vector<xpum::DeviceCapability> capabilities;
-    Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getCapability(capabilities);
+    Core::instance().getDeviceManager()->getDevice(deviceId)->getCapability(capabilities);
     for (auto metric = metric_types.begin(); metric != metric_types.end();) {
         if (std::none_of(capabilities.begin(), capabilities.end(), [metric](xpum::DeviceCapability cap) { return (cap == Utility::capabilityFromMeasurementType(*metric)); })) {
             metric = metric_types.erase(metric);
@@ -1419,7 +1925,7 @@ xpum_result_t xpumGetFabricThroughputStatsEx(xpum_device_id_t deviceIdList[],
 
         // check device support METRIC_FABRIC_THROUGHPUT
         std::vector<xpum::DeviceCapability> capabilities;
-        Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getCapability(capabilities);
+        Core::instance().getDeviceManager()->getDevice(deviceId)->getCapability(capabilities);
         for (auto metric = metric_types.begin(); metric != metric_types.end();) {
             if (std::none_of(capabilities.begin(), capabilities.end(), [metric](xpum::DeviceCapability cap) { return (cap == Utility::capabilityFromMeasurementType(*metric)); })) {
                 metric = metric_types.erase(metric);
@@ -1463,7 +1969,7 @@ xpum_result_t xpumGetFabricThroughputStatsEx(xpum_device_id_t deviceIdList[],
         std::vector<xpum_device_fabric_throughput_stats_t> __dataList(__count);
         res = Core::instance().getDataLogic()->getFabricThroughputStatistics(deviceId, __dataList.data(), &__count, begin, end, sessionId);
         if (res == XPUM_BUFFER_TOO_SMALL) {
-            __dataList.reserve(__count);
+            __dataList.resize(__count);
             res = Core::instance().getDataLogic()->getFabricThroughputStatistics(deviceId, __dataList.data(), &__count, begin, end, sessionId);
         }
         if (res != XPUM_OK)
@@ -1477,13 +1983,370 @@ xpum_result_t xpumGetFabricThroughputStatsEx(xpum_device_id_t deviceIdList[],
         return XPUM_OK;
     }
 
-    *count = _dataList.size();
-    for (uint32_t i = 0; i < _dataList.size(); i++) {
-        dataList[i] = _dataList[i];
+    *count = _dataList.size();
+    for (uint32_t i = 0; i < _dataList.size(); i++) {
+        dataList[i] = _dataList[i];
+    }
+    return XPUM_OK;
+}
+
+// the devices of a bulk query, all devices if deviceCount is 0
+static xpum_result_t getBulkDeviceIds(xpum_device_id_t deviceIdList[], uint32_t deviceCount, std::vector<xpum_device_id_t> &deviceIds) {
+    deviceIds.assign(deviceIdList, deviceIdList + deviceCount);
+    if (deviceIds.empty()) {
+        std::vector<std::shared_ptr<Device>> devices;
+        Core::instance().getDeviceManager()->getDeviceList(devices);
+        for (auto &device : devices) {
+            deviceIds.push_back(std::stoi(device->getId()));
+        }
+    }
+    for (auto deviceId : deviceIds) {
+        xpum_result_t res = validateDeviceId(deviceId);
+        if (res != XPUM_OK) {
+            return res;
+        }
+    }
+    return XPUM_OK;
+}
+
+xpum_result_t xpumGetStatsBulk(xpum_device_id_t deviceIdList[],
+                               uint32_t deviceCount,
+                               std::vector<xpum_device_stats_t> &stats,
+                               std::vector<xpum_device_engine_stats_t> &engineStats,
+                               std::vector<xpum_device_fabric_throughput_stats_t> &fabricStats,
+                               std::vector<DerivedStats> &derivedStats,
+                               uint64_t *begin,
+                               uint64_t *end,
+                               uint64_t sessionId) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    auto p_data_logic = Core::instance().getDataLogic();
+    if (p_data_logic == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    if (sessionId >= Configuration::MAX_STATISTICS_SESSION_NUM) {
+        return XPUM_UNSUPPORTED_SESSIONID;
+    }
+
+    std::vector<xpum_device_id_t> deviceIds;
+    res = getBulkDeviceIds(deviceIdList, deviceCount, deviceIds);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    char *env = std::getenv("XPUM_DISABLE_PERIODIC_METRIC_MONITOR");
+    std::string xpum_disable_periodic_metric_monitor{env != NULL ? env : ""};
+    if (xpum_disable_periodic_metric_monitor == "1") {
+        if (!Core::instance().getMonitorManager()->initOneTimeMetricMonitorTasks(MeasurementType::METRIC_MAX)) {
+            return XPUM_GENERIC_ERROR;
+        }
+    }
+
+    stats.clear();
+    engineStats.clear();
+    fabricStats.clear();
+    derivedStats.clear();
+    *begin = std::numeric_limits<uint64_t>::max();
+
+    // no new samples are stored until all devices are read, so they all come from the same ticks
+    auto lock = p_data_logic->pauseUpdates();
+    for (auto deviceId : deviceIds) {
+        uint64_t begin_, end_;
+        uint32_t count = 0;
+        res = p_data_logic->getMetricsStatistics(deviceId, nullptr, &count, &begin_, &end_, sessionId);
+        if (res != XPUM_OK) {
+            return res;
+        }
+        std::vector<xpum_device_stats_t> deviceStats(count);
+        // waiting for the first RAS or EU data would never end while the stores are held back
+        res = p_data_logic->getMetricsStatistics(deviceId, deviceStats.data(), &count, &begin_, &end_, sessionId, false);
+        if (res != XPUM_OK) {
+            return res;
+        }
+        stats.insert(stats.end(), deviceStats.begin(), deviceStats.begin() + count);
+        *begin = std::min(*begin, begin_);
+
+        // per engine and fabric statistics are optional, skip devices not supporting them
+        count = 0;
+        res = p_data_logic->getEngineStatistics(deviceId, nullptr, &count, &begin_, &end_, sessionId);
+        if (res == XPUM_OK && count > 0) {
+            std::vector<xpum_device_engine_stats_t> deviceEngineStats(count);
+            res = p_data_logic->getEngineStatistics(deviceId, deviceEngineStats.data(), &count, &begin_, &end_, sessionId);
+            if (res == XPUM_OK) {
+                engineStats.insert(engineStats.end(), deviceEngineStats.begin(), deviceEngineStats.begin() + count);
+            }
+        }
+
+        count = 0;
+        res = p_data_logic->getFabricThroughputStatistics(deviceId, nullptr, &count, &begin_, &end_, sessionId);
+        if (res == XPUM_OK && count > 0) {
+            std::vector<xpum_device_fabric_throughput_stats_t> deviceFabricStats(count);
+            res = p_data_logic->getFabricThroughputStatistics(deviceId, deviceFabricStats.data(), &count, &begin_, &end_, sessionId);
+            if (res == XPUM_BUFFER_TOO_SMALL) {
+                deviceFabricStats.resize(count);
+                res = p_data_logic->getFabricThroughputStatistics(deviceId, deviceFabricStats.data(), &count, &begin_, &end_, sessionId);
+            }
+            if (res == XPUM_OK) {
+                fabricStats.insert(fabricStats.end(), deviceFabricStats.begin(), deviceFabricStats.begin() + count);
+            }
+        }
+    }
+    *end = Utility::getCurrentTime();
+    if (*begin == std::numeric_limits<uint64_t>::max()) {
+        *begin = *end;
+    }
+    lock.unlock();
+
+    p_data_logic->getDerivedStatistics(stats, derivedStats);
+    return XPUM_OK;
+}
+
+xpum_result_t xpumGetTelemetrySnapshot(xpum_device_id_t deviceIdList[],
+                                       uint32_t deviceCount,
+                                       void *buffer,
+                                       uint32_t *size,
+                                       uint64_t sessionId) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    auto p_data_logic = Core::instance().getDataLogic();
+    if (p_data_logic == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    if (sessionId >= Configuration::MAX_STATISTICS_SESSION_NUM) {
+        return XPUM_UNSUPPORTED_SESSIONID;
+    }
+
+    const uint32_t headerSize = sizeof(xpum_telemetry_snapshot_header_t);
+    const uint32_t metricSize = sizeof(xpum_telemetry_metric_t);
+    const uint32_t recordSize = sizeof(xpum_telemetry_record_t);
+    const uint32_t valueSize = sizeof(xpum_telemetry_value_t);
+
+    if (buffer == nullptr) {
+        // the counts do not read the data, so the session is not moved on
+        std::vector<xpum_device_id_t> deviceIds;
+        res = getBulkDeviceIds(deviceIdList, deviceCount, deviceIds);
+        if (res != XPUM_OK) {
+            return res;
+        }
+        uint64_t needed = headerSize + XPUM_STATS_MAX * metricSize;
+        for (auto deviceId : deviceIds) {
+            uint64_t begin, end;
+            uint32_t count = 0;
+            if (p_data_logic->getMetricsStatistics(deviceId, nullptr, &count, &begin, &end, sessionId) == XPUM_OK) {
+                needed += count * (recordSize + XPUM_STATS_MAX * valueSize);
+            }
+            count = 0;
+            if (p_data_logic->getEngineStatistics(deviceId, nullptr, &count, &begin, &end, sessionId) == XPUM_OK) {
+                needed += count * (recordSize + valueSize);
+            }
+            count = 0;
+            if (p_data_logic->getFabricThroughputStatistics(deviceId, nullptr, &count, &begin, &end, sessionId) == XPUM_OK) {
+                needed += count * (recordSize + valueSize);
+            }
+        }
+        *size = needed;
+        return XPUM_OK;
+    }
+
+    std::vector<xpum_device_stats_t> stats;
+    std::vector<xpum_device_engine_stats_t> engineStats;
+    std::vector<xpum_device_fabric_throughput_stats_t> fabricStats;
+    std::vector<DerivedStats> derivedStats;
+    uint64_t begin, end;
+    res = xpumGetStatsBulk(deviceIdList, deviceCount, stats, engineStats, fabricStats, derivedStats, &begin, &end, sessionId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    // the schema has the metrics in the order they first appear
+    std::vector<xpum_telemetry_metric_t> schema;
+    int32_t metricIndexes[XPUM_STATS_MAX];
+    std::fill(metricIndexes, metricIndexes + XPUM_STATS_MAX, -1);
+    auto getMetricIndex = [&](xpum_stats_type_t metricsType, bool isCounter) {
+        if (metricIndexes[metricsType] < 0) {
+            xpum_telemetry_metric_t metric{};
+            metric.metricsType = metricsType;
+            metric.isCounter = isCounter ? 1 : 0;
+            metricIndexes[metricsType] = schema.size();
+            schema.push_back(metric);
+        }
+        return (uint32_t)metricIndexes[metricsType];
+    };
+    uint64_t valueCount = 0;
+    for (auto &data : stats) {
+        for (int32_t i = 0; i < data.count; i++) {
+            getMetricIndex(data.dataList[i].metricsType, data.dataList[i].isCounter);
+        }
+        valueCount += data.count;
+    }
+    if (!engineStats.empty()) {
+        getMetricIndex(XPUM_STATS_ENGINE_UTILIZATION, false);
+    }
+    if (!fabricStats.empty()) {
+        getMetricIndex(XPUM_STATS_FABRIC_THROUGHPUT, false);
+    }
+    uint32_t recordCount = stats.size() + engineStats.size() + fabricStats.size();
+    valueCount += engineStats.size() + fabricStats.size();
+
+    uint64_t needed = headerSize + schema.size() * metricSize + recordCount * recordSize + valueCount * valueSize;
+    if (*size < needed) {
+        *size = needed;
+        return XPUM_BUFFER_TOO_SMALL;
+    }
+
+    char *p = static_cast<char *>(buffer);
+    xpum_telemetry_snapshot_header_t header{};
+    header.magic = XPUM_TELEMETRY_SNAPSHOT_MAGIC;
+    header.version = XPUM_TELEMETRY_SNAPSHOT_VERSION;
+    header.headerSize = headerSize;
+    header.size = needed;
+    header.metricSize = metricSize;
+    header.recordSize = recordSize;
+    header.valueSize = valueSize;
+    header.metricCount = schema.size();
+    header.recordCount = recordCount;
+    header.begin = begin;
+    header.end = end;
+    std::memcpy(p, &header, headerSize);
+    p += headerSize;
+    std::memcpy(p, schema.data(), schema.size() * metricSize);
+    p += schema.size() * metricSize;
+
+    for (auto &data : stats) {
+        xpum_telemetry_record_t record{};
+        record.type = XPUM_TELEMETRY_RECORD_STATS;
+        record.deviceId = data.deviceId;
+        record.tileId = data.isTileData ? data.tileId : -1;
+        record.valueCount = data.count;
+        std::memcpy(p, &record, recordSize);
+        p += recordSize;
+        for (int32_t i = 0; i < data.count; i++) {
+            const xpum_device_stats_data_t &statsData = data.dataList[i];
+            xpum_telemetry_value_t value{};
+            value.metricIndex = metricIndexes[statsData.metricsType];
+            value.scale = statsData.scale;
+            value.value = statsData.value;
+            value.accumulated = statsData.accumulated;
+            value.min = statsData.min;
+            value.avg = statsData.avg;
+            value.max = statsData.max;
+            value.p50 = statsData.p50;
+            value.p90 = statsData.p90;
+            value.p99 = statsData.p99;
+            std::memcpy(p, &value, valueSize);
+            p += valueSize;
+        }
+    }
+    for (auto &data : engineStats) {
+        xpum_telemetry_record_t record{};
+        record.type = XPUM_TELEMETRY_RECORD_ENGINE;
+        record.deviceId = data.deviceId;
+        record.tileId = data.isTileData ? data.tileId : -1;
+        record.valueCount = 1;
+        record.subType = data.type;
+        record.index = data.index;
+        std::memcpy(p, &record, recordSize);
+        p += recordSize;
+        xpum_telemetry_value_t value{};
+        value.metricIndex = metricIndexes[XPUM_STATS_ENGINE_UTILIZATION];
+        value.scale = data.scale;
+        value.value = data.value;
+        value.min = data.min;
+        value.avg = data.avg;
+        value.max = data.max;
+        std::memcpy(p, &value, valueSize);
+        p += valueSize;
+    }
+    for (auto &data : fabricStats) {
+        xpum_telemetry_record_t record{};
+        record.type = XPUM_TELEMETRY_RECORD_FABRIC;
+        record.deviceId = data.deviceId;
+        record.tileId = data.tile_id;
+        record.valueCount = 1;
+        record.subType = data.type;
+        record.index = data.remote_device_id;
+        record.remoteTileId = data.remote_device_tile_id;
+        std::memcpy(p, &record, recordSize);
+        p += recordSize;
+        xpum_telemetry_value_t value{};
+        value.metricIndex = metricIndexes[XPUM_STATS_FABRIC_THROUGHPUT];
+        value.scale = data.scale;
+        value.value = data.value;
+        value.accumulated = data.accumulated;
+        value.min = data.min;
+        value.avg = data.avg;
+        value.max = data.max;
+        std::memcpy(p, &value, valueSize);
+        p += valueSize;
+    }
+    *size = needed;
+    return XPUM_OK;
+}
+
+xpum_result_t xpumWaitForMetricsUpdate(uint64_t *generation, uint32_t timeout) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getDataLogic() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    uint64_t current = Core::instance().getDataLogic()->waitForUpdate(*generation, timeout);
+    if (current == *generation) {
+        return XPUM_GENERIC_ERROR;
+    }
+    *generation = current;
+    return XPUM_OK;
+}
+
+xpum_result_t xpumGetTopologyVersion(uint64_t *version) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+    if (version == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+    *version = Topology::getVersion();
+    return XPUM_OK;
+}
+
+static xpum_result_t waitForTaskProgress(TaskProgressSource source, xpum_device_id_t deviceId, uint64_t *generation, uint32_t timeout) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (generation == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    uint64_t current = TaskProgress::instance().wait(source, deviceId, *generation, timeout);
+    if (current == *generation) {
+        return XPUM_GENERIC_ERROR;
     }
+    *generation = current;
     return XPUM_OK;
 }
 
+xpum_result_t xpumWaitForFirmwareFlashProgress(xpum_device_id_t deviceId, uint64_t *generation, uint32_t timeout) {
+    return waitForTaskProgress(TASK_PROGRESS_FIRMWARE_FLASH, deviceId, generation, timeout);
+}
+
+xpum_result_t xpumWaitForDiagnosticsProgress(xpum_device_id_t deviceId, uint64_t *generation, uint32_t timeout) {
+    return waitForTaskProgress(TASK_PROGRESS_DIAGNOSTICS, deviceId, generation, timeout);
+}
+
 xpum_result_t xpumGetMetricsFromSysfs(const char **bdfs,
                                       uint32_t length,
                                       xpum_device_stats_t dataList[],
@@ -1493,66 +2356,8 @@ xpum_result_t xpumGetMetricsFromSysfs(const char **bdfs,
     }
 
     Logger::init();
-    if (length > 1) {
-        GPUDeviceStub::loadPVCIdlePowers();
-    }   
-    
-    int position = 0;
-    for (uint32_t index = 0; index < length; index++) {
-        std::string bdf = bdfs[index];
-        auto p_data = GPUDeviceStub::loadPVCIdlePowers(bdf);
-
-        xpum_device_stats_t device_stats {};
-        device_stats.deviceId = std::stoi(p_data->getDeviceId());
-        device_stats.isTileData = false;
-        device_stats.count = 0;
-        if (p_data->hasDataOnDevice()) {
-            xpum_device_stats_data_t stats_data {};
-            MeasurementType type = MeasurementType::METRIC_POWER;
-            stats_data.metricsType = Utility::xpumStatsTypeFromMeasurementType(type);
-            stats_data.scale = p_data->getScale();
-            stats_data.isCounter = false;
-            stats_data.avg = p_data->getAvg();
-            stats_data.min = p_data->getMin();
-            stats_data.max = p_data->getMax();
-            stats_data.value = p_data->getCurrent();
-            device_stats.dataList[0] = stats_data;
-            device_stats.count = 1;
-        }
-
-        if (position >= (int)*count) {
-            return XPUM_BUFFER_TOO_SMALL;
-        }
-        dataList[position++] = device_stats;
-        
-        for (uint32_t tileId = 0; tileId < 4; tileId++) {
-            if (p_data->getSubdeviceDataCurrent(tileId) == std::numeric_limits<uint64_t>::max())
-                continue;
-            
-            device_stats.isTileData = true;
-            device_stats.tileId = tileId;
-            device_stats.count = 0;
-            xpum_device_stats_data_t stats_data {};
-            MeasurementType type = MeasurementType::METRIC_POWER;
-            stats_data.metricsType = Utility::xpumStatsTypeFromMeasurementType(type);
-            stats_data.scale = p_data->getScale();
-            stats_data.isCounter = false;
-            stats_data.avg = p_data->getSubdeviceDataAvg(tileId);
-            stats_data.min = p_data->getSubdeviceDataMin(tileId);
-            stats_data.max = p_data->getSubdeviceDataMax(tileId);
-            stats_data.value = p_data->getSubdeviceDataCurrent(tileId);
-            device_stats.dataList[0] = stats_data;
-            device_stats.count = 1;
-
-            if (position >= (int)*count) {
-                return XPUM_BUFFER_TOO_SMALL;
-            }
-            dataList[position++] = device_stats;
-        }
-    }
-    *count = position;
-
-    return XPUM_OK;
+    std::vector<std::string> bdf_list(bdfs, bdfs + length);
+    return SysfsMetricReader::instance().read(bdf_list, dataList, count);
 }
 
 xpum_result_t xpumGetFabricThroughput(xpum_device_id_t deviceId,
@@ -1656,6 +2461,25 @@ xpum_result_t xpumGetStatsByGroup(xpum_group_id_t groupId,
     return res;
 }
 
+xpum_result_t xpumGetMetricsAggregatedByGroup(xpum_group_id_t groupId,
+                                              xpum_group_metric_data_t dataList[],
+                                              uint32_t *count) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (Core::instance().getDataLogic() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
+
+    if (count == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    return Core::instance().getDataLogic()->getGroupMetrics(groupId, dataList, count);
+}
+
 std::set<int64_t> monitor_freq_set{5, 10, 20, 50, 100, 200, 500, 1000};
 
 xpum_result_t xpumSetAgentConfig(xpum_agent_config_t key, void *value) {
@@ -1960,6 +2784,47 @@ xpum_result_t xpumGetDiagnosticsXeLinkThroughputResult(xpum_device_id_t deviceId
     return Core::instance().getDiagnosticManager()->getDiagnosticsXeLinkThroughputResult(deviceId, resultList, count);
 }
 
+xpum_result_t xpumRunXeLinkMatrix(xpum_device_id_t deviceIdList[], int count) {
+    xpum_result_t ret = Core::instance().apiAccessPreCheck();
+    if (ret != XPUM_OK) {
+        return ret;
+    }
+
+    std::vector<xpum_device_id_t> deviceIds;
+    for (int i = 0; i < count; i++) {
+        ret = validateDeviceId(deviceIdList[i]);
+        if (ret != XPUM_OK) {
+            return ret;
+        }
+        deviceIds.push_back(deviceIdList[i]);
+    }
+
+    return Core::instance().getDiagnosticManager()->runXeLinkMatrix(deviceIds);
+}
+
+xpum_result_t xpumGetXeLinkMatrix(xpum_xe_link_matrix_entry_t entries[], int *count, bool *running) {
+    xpum_result_t ret = Core::instance().apiAccessPreCheck();
+    if (ret != XPUM_OK) {
+        return ret;
+    }
+
+    *running = Core::instance().getDiagnosticManager()->isXeLinkMatrixRunning();
+    std::vector<xpum_xe_link_matrix_entry_t> matrix = Topology::getXeLinkMatrix();
+    if (entries == nullptr) {
+        *count = matrix.size();
+        return XPUM_OK;
+    }
+    if (*count < (int)matrix.size()) {
+        *count = matrix.size();
+        return XPUM_BUFFER_TOO_SMALL;
+    }
+    for (size_t i = 0; i < matrix.size(); i++) {
+        entries[i] = matrix[i];
+    }
+    *count = matrix.size();
+    return XPUM_OK;
+}
+
 void convertStandbyData(Standby &src, xpum_standby_data_t *des) {
     des->type = (xpum_standby_type_t)src.getType();
     des->mode = (xpum_standby_mode_t)src.getMode();
@@ -1992,7 +2857,7 @@ xpum_result_t xpumGetDeviceStandbys(xpum_device_id_t deviceId,
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2028,7 +2893,7 @@ xpum_result_t xpumSetDeviceStandby(xpum_device_id_t deviceId,
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2052,7 +2917,7 @@ xpum_result_t xpumGetDevicePowerLimits(xpum_device_id_t deviceId,
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2089,7 +2954,7 @@ xpum_result_t xpumSetDevicePowerSustainedLimits(xpum_device_id_t deviceId,
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2118,7 +2983,7 @@ xpum_result_t xpumSetDevicePowerSustainedLimits(xpum_device_id_t deviceId,
 xpum_result_t xpumSetDevicePowerBurstLimits(xpum_device_id_t deviceId,
                                             int32_t tileId,
                                             const xpum_power_burst_limit_t burst_limit) {
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2138,7 +3003,7 @@ xpum_result_t xpumSetDevicePowerBurstLimits(xpum_device_id_t deviceId,
 xpum_result_t xpumSetDevicePowerPeakLimits(xpum_device_id_t deviceId,
                                            int32_t tileId,
                                            const xpum_power_peak_limit_t peak_limit) {
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2162,7 +3027,7 @@ xpum_result_t xpumGetDeviceFrequencyRanges(xpum_device_id_t deviceId,
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2195,7 +3060,7 @@ xpum_result_t xpumSetDeviceFrequencyRange(xpum_device_id_t deviceId,
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2213,7 +3078,7 @@ xpum_result_t xpumSetDeviceFrequencyRange(xpum_device_id_t deviceId,
 
 xpum_result_t xpumGetDeviceSchedulers(xpum_device_id_t deviceId,
                                       xpum_scheduler_data_t *dataArray, uint32_t *count) {
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2348,7 +3213,7 @@ xpum_result_t xpumGetDevicePowerProps(xpum_device_id_t deviceId, xpum_power_prop
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2387,7 +3252,7 @@ xpum_result_t xpumSetDeviceSchedulerTimeoutMode(xpum_device_id_t deviceId,
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2413,7 +3278,7 @@ xpum_result_t xpumSetDeviceSchedulerTimesliceMode(xpum_device_id_t deviceId,
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2440,7 +3305,7 @@ xpum_result_t xpumSetDeviceSchedulerExclusiveMode(xpum_device_id_t deviceId,
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2501,6 +3366,7 @@ xpum_result_t xpumSetDeviceSchedulerExclusiveMode(xpum_device_id_t deviceId,
         }
     }
     if (found == true) {
+        DeviceConfigCache::instance().invalidate(device->getDeviceHandle(), DeviceConfigCache::SCHEDULERS);
         return XPUM_OK;
     } else {
         XPUM_LOG_INFO("Can't find device id: {}", deviceId);
@@ -2514,7 +3380,7 @@ xpum_result_t xpumSetDeviceSchedulerDebugMode(xpum_device_id_t deviceId,
 }
 
 xpum_result_t xpumApplyPPR(xpum_device_id_t deviceId, xpum_diag_result_t* diagResult, xpum_health_status_t* healthState) {
-    std::shared_ptr<Device> p_device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> p_device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (p_device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2593,7 +3459,7 @@ xpum_result_t xpumApplyPPR(xpum_device_id_t deviceId, xpum_diag_result_t* diagRe
 }
 
 xpum_result_t xpumResetDevice(xpum_device_id_t deviceId, bool force) {
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2648,7 +3514,7 @@ xpum_result_t xpumGetFreqAvailableClocks(xpum_device_id_t deviceId, uint32_t til
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2680,7 +3546,7 @@ xpum_result_t xpumGetDeviceProcessState(xpum_device_id_t deviceId, xpum_device_p
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -2707,6 +3573,37 @@ xpum_result_t xpumGetDeviceProcessState(xpum_device_id_t deviceId, xpum_device_p
     return XPUM_OK;
 }
 
+// the busy ratio of the compute and render engines of the device used by the top-down analysis
+static std::float_t getTopdownEngineUsage(xpum_device_id_t deviceId) {
+    uint32_t engineUtilRawDataSize = 0;
+    Core::instance().getDataLogic()->getEngineUtilizations(deviceId, nullptr, &engineUtilRawDataSize);
+    std::vector<xpum_device_engine_metric_t> engineUtilRawDataList(engineUtilRawDataSize);
+    Core::instance().getDataLogic()->getEngineUtilizations(deviceId, engineUtilRawDataList.data(), &engineUtilRawDataSize);
+
+    std::float_t engineCompute = 0;
+    std::float_t engineRender = 0;
+    std::int16_t countRenderEngine = 0;
+    std::int16_t countComputeEngine = 0;
+    std::float_t engineUsage = 0;
+    std::int16_t scale = 100;
+
+    for (auto engineUtilRawData : engineUtilRawDataList) {
+        if (engineUtilRawData.type == XPUM_ENGINE_TYPE_COMPUTE && engineUtilRawData.value > 0) {
+            countComputeEngine++;
+            engineCompute += engineUtilRawData.value;
+            scale = engineUtilRawData.scale;
+        } else if (engineUtilRawData.type == XPUM_ENGINE_TYPE_RENDER) {
+            countRenderEngine++;
+            engineRender += engineUtilRawData.value;
+            scale = engineUtilRawData.scale;
+        }
+    }
+    if (countComputeEngine != 0 && countRenderEngine != 0)
+        engineUsage = std::max(engineCompute / countComputeEngine, engineRender / countRenderEngine);
+    engineUsage /= scale;
+    return engineUsage;
+}
+
 xpum_result_t xpumGetDeviceComponentOccupancyRatio(xpum_device_id_t deviceId, 
                                                    xpum_device_tile_id_t tileId,
                                                    xpum_sampling_interval_t samplingInterval,
@@ -2731,14 +3628,12 @@ xpum_result_t xpumGetDeviceComponentOccupancyRatio(xpum_device_id_t deviceId,
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
 
-    Property prop;
-    device->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_TILES, prop);
-    uint32_t tileCount = prop.getValueInt();
+    uint32_t tileCount = device->getPropertyLong(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_TILES);
 
     if (*count > 0 && *count < tileCount && dataArray != nullptr) {
         return XPUM_BUFFER_TOO_SMALL;
@@ -2755,36 +3650,17 @@ xpum_result_t xpumGetDeviceComponentOccupancyRatio(xpum_device_id_t deviceId,
         Configuration::EU_ACTIVE_STALL_IDLE_STREAMER_SAMPLING_PERIOD = samplingInterval * 1000000;
     }
 
-    auto p_data = Core::instance().getDeviceManager()->getRealtimeMeasurementData(METRIC_PERF, device_id);
+    // the latest sample of the monitor is used when METRIC_PERF is monitored and no sampling interval is given
+    std::shared_ptr<MeasurementData> p_data;
+    if (samplingInterval <= 0) {
+        p_data = Core::instance().getDataLogic()->getLatestData(METRIC_PERF, device_id);
+    }
+    if (p_data == nullptr) {
+        p_data = Core::instance().getDeviceManager()->getRealtimeMeasurementData(METRIC_PERF, device_id);
+    }
     std::shared_ptr<PerfMeasurementData> p_measurement_data = std::static_pointer_cast<PerfMeasurementData>(p_data);
 
-    uint32_t engineUtilRawDataSize = 0;
-    Core::instance().getDataLogic()->getEngineUtilizations(deviceId, nullptr, &engineUtilRawDataSize);
-    std::vector<xpum_device_engine_metric_t> engineUtilRawDataList(engineUtilRawDataSize);
-    Core::instance().getDataLogic()->getEngineUtilizations(deviceId, engineUtilRawDataList.data(), &engineUtilRawDataSize);
-
-    /* calculate engine utilization of current device */
-    std::float_t engineCompute = 0;
-    std::float_t engineRender = 0;
-    std::int16_t countRenderEngine = 0;
-    std::int16_t countComputeEngine = 0;
-    std::float_t engineUsage = 0;
-    std::int16_t scale = 100;
-
-    for (auto engineUtilRawData : engineUtilRawDataList) {
-        if (engineUtilRawData.type == XPUM_ENGINE_TYPE_COMPUTE && engineUtilRawData.value > 0) {
-            countComputeEngine++;
-            engineCompute += engineUtilRawData.value;
-            scale = engineUtilRawData.scale;
-        } else if (engineUtilRawData.type == XPUM_ENGINE_TYPE_RENDER) {
-            countRenderEngine++;
-            engineRender += engineUtilRawData.value;
-            scale = engineUtilRawData.scale;
-        }
-    }
-    if (countComputeEngine != 0 && countRenderEngine != 0)
-        engineUsage = std::max(engineCompute / countComputeEngine, engineRender / countRenderEngine);
-    engineUsage /= scale;
+    std::float_t engineUsage = getTopdownEngineUsage(deviceId);
 
     auto p_perf_datas = p_measurement_data->getPerfMetricDatas();
     if (p_perf_datas->size() <= 0) {
@@ -2793,173 +3669,63 @@ xpum_result_t xpumGetDeviceComponentOccupancyRatio(xpum_device_id_t deviceId,
 
     /*  calculate the component occupancy ratio of each tile in current device */
     for (size_t i = 0; i < p_perf_datas->size(); i++) {
-        std::float_t active = 0;
-        std::float_t stall = 0;
-        std::float_t inUse = 0;
-        
-        std::float_t occupancy = 0;
-        std::float_t stallALU = 0;
-        std::float_t stallSFU = 0;
-        std::float_t stallSB = 0;
-        std::float_t stallSEND = 0;
-        std::float_t stallDep = 0;
-        std::float_t stallOther = 0;
-        std::float_t stallBarrier = 0;
-        std::float_t stallInstFetch = 0;
-        std::float_t fpuActive = 0;
-        std::float_t emActive = 0;
-        std::float_t xmxActive = 0;
-        std::float_t xmxOnly = 0;
-        std::float_t fpuWithoutXMX = 0;
-        std::float_t fpuOnly = 0;
-        std::float_t emIntOnly = 0;
-        std::float_t emFpuActive = 0;
-        std::float_t xmxFpuActive = 0;
-        std::float_t aluActive = 0;
-        std::float_t other = 0;
-        std::float_t stallTotal = 0;
-        std::float_t notInUse = 0;
-        std::float_t hypoInUse = 0;
-        std::float_t engine = 0;
-        std::float_t workload = 0;
-        std::float_t nonOccupancy = 0;
-        std::float_t remaining = 0;
-        std::float_t stallRatio = 0;
-
+        TopdownCounters_t counters;
         for (auto group_data : (*p_perf_datas)[i]->data) {
             for (auto metric_data : group_data.data) {
-                if (std::strcmp(metric_data.name.c_str(), "XveActive") == 0) {
-                    active = metric_data.average;
-                } 
-                if (std::strcmp(metric_data.name.c_str(), "XveStall") == 0) {
-                    stall = metric_data.average;
-                }
-                if (std::strcmp(metric_data.name.c_str(), "EmActive") == 0) {
-                    emActive = metric_data.average;
-                }
-                if (std::strcmp(metric_data.name.c_str(), "XmxActive") == 0) {
-                    xmxActive = metric_data.average;
-                }
-                if (std::strcmp(metric_data.name.c_str(), "FpuActive") == 0) {
-                    fpuActive = metric_data.average;
-                }
-                if (std::strcmp(metric_data.name.c_str(), "XveFpuEmActive") == 0) {
-                    emFpuActive = metric_data.average;
-                }
-                if (std::strcmp(metric_data.name.c_str(), "XveFpuXmxActive") == 0) {
-                    xmxFpuActive = metric_data.average;
-                }
-                if (std::strcmp(metric_data.name.c_str(), "XveThreadOccupancy") == 0) {
-                    occupancy = metric_data.average;
-                }
-                if (metric_data.name.find("ALUWR") != std::string::npos) {
-                    stallALU += metric_data.average;
-                }
-                if (metric_data.name.find("BARRIER") != std::string::npos) {
-                    stallBarrier += metric_data.average;
-                }
-                if (metric_data.name.find("SHARED_FUNCTION") != std::string::npos) {
-                    stallSFU += metric_data.average;
-                }
-                if (metric_data.name.find("SBID") != std::string::npos) {
-                    stallSB += metric_data.average;
-                }
-                if (metric_data.name.find("SENDWR") != std::string::npos) {
-                    stallSEND += metric_data.average;
-                }
-                if (metric_data.name.find("OTHER") != std::string::npos) {
-                    stallOther += metric_data.average;
-                }
-                if (metric_data.name.find("INSTFETCH") != std::string::npos) {
-                    stallInstFetch += metric_data.average;
-                }
+                addTopdownMetric(counters, metric_data.name, metric_data.average);
             }
         }
+        computeTopdownRatios(counters, engineUsage, dataArray[i]);
+    }
 
-        inUse = active + stall;
-        notInUse = 100 - inUse;
-        hypoInUse = inUse * 100 / engineUsage;
-        if (hypoInUse > 100) {
-            hypoInUse = 100;
-        }
+    return XPUM_OK;
+}
 
-        engine = hypoInUse - inUse;
-        if (engine < 0 || isnan(engine)) {
-            engine = 0;
-        } 
-        workload = notInUse - engine;
-        if (workload < 0) {
-            workload = 0;
-        }
+xpum_result_t xpumGetTopdownRatios(xpum_device_id_t deviceId,
+                                   uint32_t windowMs,
+                                   xpum_device_components_ratio_t dataArray[],
+                                   uint32_t *count) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
 
-        if (inUse != 0) {
-            if (inUse > 0) {
-                stallRatio = stall / inUse;
-            }
-            if (occupancy > 0) {
-                nonOccupancy = (stallRatio - std::pow(stallRatio, inUse / occupancy)) * inUse;
-            }
-            if (nonOccupancy < 0) {
-                nonOccupancy = 0;
-            }
-            remaining = stall - nonOccupancy;
-            if (remaining < 0) {
-                remaining = 0;
-            }
+    if (Core::instance().getDataLogic() == nullptr) {
+        return XPUM_NOT_INITIALIZED;
+    }
 
-            stallDep = stallSB;
-            if (stallDep < stallSFU) {
-                stallDep = stallSFU;
-            }
-            stallTotal = stallALU + stallBarrier + stallDep + stallOther + stallInstFetch;
-
-            remaining /= stallTotal;
-            stallALU *= remaining;
-            stallBarrier *= remaining;
-            stallDep *= remaining;
-            stallOther *= remaining;
-            stallInstFetch *= remaining;
-                
-            aluActive = emActive + fpuActive - emFpuActive + xmxActive - xmxFpuActive;
-            xmxOnly = xmxActive - xmxFpuActive;
-            fpuWithoutXMX = fpuActive - xmxFpuActive;
-            fpuOnly = fpuActive - xmxFpuActive - emFpuActive;
-            emIntOnly = emActive - emFpuActive;
-            other = active - aluActive;
-        }
-
-        std::vector<std::pair<std::string, std::double_t>> components_ratios;
-        components_ratios.push_back(std::pair<std::string, std::double_t>("notInUse", notInUse));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("workload", workload));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("engine", engine));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("inUse", inUse));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("active", active));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("aluActive", aluActive));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("xmxActive", xmxActive));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("xmxOnly", xmxOnly));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("xmxFpuActive", xmxFpuActive));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("fpuWithoutXMX", fpuWithoutXMX));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("fpuOnly", fpuOnly));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("emFpuActive", emFpuActive));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("emIntOnly", emIntOnly));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("other", other));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("stall", stall));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("nonOccupancy", nonOccupancy));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("stallALU", stallALU));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("stallBarrier", stallBarrier));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("stallDep", stallDep));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("stallOther", stallOther));
-        components_ratios.push_back(std::pair<std::string, std::double_t>("stallInstFetch", stallInstFetch));
-
-        dataArray[i].componentNum = components_ratios.size();
-        int idx = 0;
-        for (auto it = components_ratios.begin(); it != components_ratios.end(); it++) {
-            std::strcpy(dataArray[i].ratios[idx].occupancyName, (*it).first.c_str());
-            dataArray[i].ratios[idx].value = (*it).second;
-            idx++;
-        }
+    if (count == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    res = validateDeviceId(deviceId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    std::vector<TopdownCounters_t> counters;
+    res = Core::instance().getDataLogic()->getTopdownCounters(deviceId, windowMs, counters);
+    if (res != XPUM_OK) {
+        return res;
+    }
+    if (counters.empty()) {
+        return XPUM_METRIC_NOT_SUPPORTED;
+    }
+    if (dataArray == nullptr) {
+        *count = counters.size();
+        return XPUM_OK;
+    }
+    if (*count < counters.size()) {
+        *count = counters.size();
+        return XPUM_BUFFER_TOO_SMALL;
     }
 
+    std::float_t engineUsage = getTopdownEngineUsage(deviceId);
+    for (size_t i = 0; i < counters.size(); i++) {
+        dataArray[i].deviceId = deviceId;
+        computeTopdownRatios(counters[i], engineUsage, dataArray[i]);
+    }
+    *count = counters.size();
     return XPUM_OK;
 }
 
@@ -3065,7 +3831,7 @@ xpum_result_t xpumGetPerformanceFactor(xpum_device_id_t deviceId, xpum_device_pe
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -3101,7 +3867,7 @@ xpum_result_t xpumSetPerformanceFactor(xpum_device_id_t deviceId, xpum_device_pe
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -3125,7 +3891,7 @@ xpum_result_t xpumGetFabricPortConfig(xpum_device_id_t deviceId, xpum_fabric_por
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -3137,7 +3903,7 @@ xpum_result_t xpumGetFabricPortConfig(xpum_device_id_t deviceId, xpum_fabric_por
     //std::vector<xpum_fabric_port_config_t> portConfig;
     std::vector<port_info> pi;
 
-    Core::instance().getDeviceManager()->getFabricPorts(std::to_string(deviceId), pi);
+    Core::instance().getMonitorManager()->getFabricPorts(std::to_string(deviceId), pi);
 
     if (pi.size() > *count && dataArray != nullptr) {
         return XPUM_BUFFER_TOO_SMALL;
@@ -3164,7 +3930,7 @@ xpum_result_t xpumGetFabricPortConfig(xpum_device_id_t deviceId, xpum_fabric_por
 }
 
 xpum_result_t xpumSetFabricPortConfig(xpum_device_id_t deviceId, xpum_fabric_port_config_t fabricPortConfig) {
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     xpum_result_t res = Core::instance().apiAccessPreCheck();
     if (res != XPUM_OK) {
         return res;
@@ -3191,6 +3957,7 @@ xpum_result_t xpumSetFabricPortConfig(xpum_device_id_t deviceId, xpum_fabric_por
     pis.setting_beaconing = fabricPortConfig.setting_beaconing;
 
     if (Core::instance().getDeviceManager()->setFabricPorts(std::to_string(deviceId), pis)) {
+        Core::instance().getMonitorManager()->refreshFabricPorts(std::to_string(deviceId));
         return XPUM_OK;
     }
     return XPUM_GENERIC_ERROR;
@@ -3320,7 +4087,7 @@ xpum_result_t xpumGetEccState(xpum_device_id_t deviceId, bool* available, bool*
     uint8_t cur;
     uint8_t pen;
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -3330,7 +4097,7 @@ xpum_result_t xpumGetEccState(xpum_device_id_t deviceId, bool* available, bool*
         return res;
     }
 
-    if(Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getDeviceModel() == XPUM_DEVICE_MODEL_PVC){
+    if(Core::instance().getDeviceManager()->getDevice(deviceId)->getDeviceModel() == XPUM_DEVICE_MODEL_PVC){
         *available = true;
         *configurable = false;
 
@@ -3345,7 +4112,14 @@ xpum_result_t xpumGetEccState(xpum_device_id_t deviceId, bool* available, bool*
     std::string meiPath = device->getMeiDevicePath();
     //XPUM_LOG_INFO("XPUM meiPath {}", meiPath);
 
-    if (callIgscMemoryEcc( meiPath, true, 0, &cur, &pen) == true) {
+    DeviceConfigCache::MemoryEccState state = {};
+    bool read = DeviceConfigCache::instance().getMemoryEcc(device->getDeviceHandle(), state, [&meiPath](DeviceConfigCache::MemoryEccState& value) {
+        return callIgscMemoryEcc(meiPath, true, 0, &value.current, &value.pending);
+    });
+    cur = state.current;
+    pen = state.pending;
+
+    if (read == true) {
         *available = true;
         *configurable = true;
         if(cur == 0x00) {
@@ -3402,7 +4176,7 @@ xpum_result_t xpumSetEccState(xpum_device_id_t deviceId, xpum_ecc_state_t newSta
     uint8_t pen;
     uint8_t req;
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -3412,7 +4186,7 @@ xpum_result_t xpumSetEccState(xpum_device_id_t deviceId, xpum_ecc_state_t newSta
         return res;
     }
 
-    if(Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getDeviceModel() == XPUM_DEVICE_MODEL_PVC){
+    if(Core::instance().getDeviceManager()->getDevice(deviceId)->getDeviceModel() == XPUM_DEVICE_MODEL_PVC){
         *available = true;
         *configurable = false;
 
@@ -3434,7 +4208,9 @@ xpum_result_t xpumSetEccState(xpum_device_id_t deviceId, xpum_ecc_state_t newSta
         return XPUM_GENERIC_ERROR;
     }
 
-    if (callIgscMemoryEcc( meiPath, false, req, &cur, &pen) == true) {
+    bool set = callIgscMemoryEcc( meiPath, false, req, &cur, &pen);
+    DeviceConfigCache::instance().invalidate(device->getDeviceHandle(), DeviceConfigCache::MEMORY_ECC);
+    if (set == true) {
         *available = true;
         *configurable = true;
         if(cur == 0x00) {
@@ -3548,6 +4324,32 @@ xpum_result_t xpumStartDumpRawDataTaskEx(xpum_device_id_t deviceId,
     return Core::instance().getDumpRawDataManager()->startDumpRawDataTask(deviceId, tileId, dumpTypeList, count, dumpFilePath, dumpOptions, taskInfo);
 }
 
+xpum_result_t xpumStartDumpRawDataTaskMultiDevice(const xpum_device_id_t deviceIdList[],
+                                       const int deviceCount,
+                                       const xpum_dump_type_t dumpTypeList[],
+                                       const int count,
+                                       const char *dumpFilePath,
+                                       xpum_dump_raw_data_option_t dumpOptions,
+                                       xpum_dump_raw_data_task_t *taskInfo) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (deviceIdList == nullptr || deviceCount <= 0 || deviceCount > XPUM_MAX_NUM_DEVICES) {
+        return XPUM_RESULT_DEVICE_NOT_FOUND;
+    }
+    std::vector<xpum_device_id_t> devices;
+    for (int i = 0; i < deviceCount; i++) {
+        res = validateDeviceId(deviceIdList[i]);
+        if (res != XPUM_OK)
+            return res;
+        if (std::find(devices.begin(), devices.end(), deviceIdList[i]) == devices.end())
+            devices.push_back(deviceIdList[i]);
+    }
+    return Core::instance().getDumpRawDataManager()->startDumpRawDataTask(devices, dumpTypeList, count, dumpFilePath, dumpOptions, taskInfo);
+}
+
 xpum_result_t xpumStopDumpRawDataTask(xpum_dump_task_id_t taskId, xpum_dump_raw_data_task_t *taskInfo) {
     xpum_result_t res = Core::instance().apiAccessPreCheck();
     if (res != XPUM_OK) {
@@ -3585,6 +4387,51 @@ xpum_result_t xpumRunStress(xpum_device_id_t deviceId, uint32_t stressTime) {
     return Core::instance().getDiagnosticManager()->runStress(deviceId, stressTime);
 }
 
+xpum_result_t xpumRunStressWithOptions(xpum_device_id_t deviceId, const xpum_stress_options_t *options) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+    if (options == nullptr) {
+        return XPUM_RESULT_STRESS_INVALID_OPTIONS;
+    }
+    // the trace covers the stress time, as long as a burst sampling may last
+    uint32_t trace_duration = Configuration::BURST_SAMPLING_MAX_DURATION;
+    if (options->stressTime != 0 && (uint64_t)options->stressTime * 60 * 1000 < trace_duration) {
+        trace_duration = options->stressTime * 60 * 1000;
+    }
+    if (options->traceInterval != 0) {
+        if (Core::instance().getMonitorManager() == nullptr) {
+            return XPUM_NOT_INITIALIZED;
+        }
+        if (options->traceInterval < Configuration::BURST_SAMPLING_MIN_INTERVAL || options->traceInterval > trace_duration) {
+            return XPUM_INTERVAL_INVALID;
+        }
+    }
+    res = Core::instance().getDiagnosticManager()->runStress(deviceId, *options);
+    if (res != XPUM_OK || options->traceInterval == 0) {
+        return res;
+    }
+
+    std::vector<std::shared_ptr<Device>> devices;
+    if (deviceId == -1) {
+        Core::instance().getDeviceManager()->getDeviceList(devices);
+    } else {
+        devices.push_back(Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId)));
+    }
+    std::vector<xpum_stats_type_t> metrics = {XPUM_STATS_POWER, XPUM_STATS_GPU_FREQUENCY, XPUM_STATS_GPU_UTILIZATION};
+    for (auto &device : devices) {
+        if (device == nullptr) {
+            continue;
+        }
+        xpum_result_t trace_res = Core::instance().getMonitorManager()->startBurstSampling(std::stoi(device->getId()), metrics, options->traceInterval, trace_duration);
+        if (trace_res != XPUM_OK) {
+            XPUM_LOG_WARN("Failed to trace the stress test on device {}: {}", device->getId(), trace_res);
+        }
+    }
+    return XPUM_OK;
+}
+
 xpum_result_t xpumCheckStress(xpum_device_id_t deviceId, xpum_diag_task_info_t resultList[], int *count) {
     xpum_result_t res = Core::instance().apiAccessPreCheck();
     if (res != XPUM_OK) {
@@ -3619,6 +4466,62 @@ xpum_result_t xpumGenerateDebugLog(const char *fileName) {
     }
 }
 
+xpum_result_t xpumGetInternalStats(xpum_internal_stats_t dataList[], uint32_t *count) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (count == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    return InternalStats::instance().getStats(dataList, count);
+}
+
+xpum_result_t xpumGetSamplingCost(xpum_device_id_t deviceId, uint32_t iterations, double targetOverhead,
+                                  xpum_sampling_cost_t dataList[], uint32_t *count) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    if (count == nullptr || iterations == 0 || iterations > SamplingCostProfiler::MAX_ITERATIONS || !(targetOverhead > 0)) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    std::vector<std::shared_ptr<Device>> devices;
+    if (deviceId == -1) {
+        Core::instance().getDeviceManager()->getDeviceList(devices);
+    } else {
+        auto p_device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+        if (p_device == nullptr) {
+            return XPUM_RESULT_DEVICE_NOT_FOUND;
+        }
+        devices.push_back(p_device);
+    }
+
+    uint32_t needed = 0;
+    for (auto& p_device : devices) {
+        needed += SamplingCostProfiler::getCapabilities(p_device).size();
+    }
+    if (dataList == nullptr) {
+        *count = needed;
+        return XPUM_OK;
+    }
+    if (*count < needed) {
+        return XPUM_BUFFER_TOO_SMALL;
+    }
+
+    std::vector<xpum_sampling_cost_t> costs;
+    SamplingCostProfiler::measure(devices, iterations, targetOverhead, costs);
+    // the enabled metrics may change while the devices are read
+    uint32_t n = std::min((uint32_t)costs.size(), *count);
+    std::copy(costs.begin(), costs.begin() + n, dataList);
+    *count = n;
+    return XPUM_OK;
+}
+
 xpum_result_t getPciSlotName(char **pciPath, uint32_t sizePciPath, 
         char *slotName, uint32_t sizeSlotName) {
     std::vector<std::string> pciPathVec;
@@ -3652,6 +4555,26 @@ xpum_result_t xpumCreateVf(xpum_device_id_t deviceId, xpum_vgpu_config_t *conf)
     return Core::instance().getVgpuManager()->createVf(deviceId, conf);
 }
 
+xpum_result_t xpumCreateVfAsync(xpum_device_id_t deviceId, xpum_vgpu_config_t *conf) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    return Core::instance().getVgpuManager()->createVfAsync(deviceId, conf);
+}
+
+xpum_result_t xpumGetVgpuProvisionStatus(xpum_device_id_t deviceId, xpum_vgpu_provision_status_t *status) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+    if (status == nullptr) {
+        return XPUM_GENERIC_ERROR;
+    }
+    return Core::instance().getVgpuManager()->getProvisionStatus(deviceId, *status);
+}
+
 xpum_result_t xpumGetDeviceFunctionList(xpum_device_id_t deviceId, xpum_vgpu_function_info_t list[], int *count) {
     xpum_result_t res = Core::instance().apiAccessPreCheck();
     if (res != XPUM_OK) {
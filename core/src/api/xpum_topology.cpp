@@ -4,10 +4,12 @@
  *  @file xpum_topology.cpp
  */
 
+#include <algorithm>
 #include <sstream>
 
 #include "core/core.h"
 #include "internal_api.h"
+#include "topology/placement_advisor.h"
 #include "topology/topology.h"
 #include "xpum_api.h"
 
@@ -24,7 +26,7 @@ xpum_result_t xpumGetTopology(xpum_device_id_t deviceId, xpum_topology_t* topolo
         return res;
     }
 
-    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -281,4 +283,103 @@ xpum_result_t xpumGetXelinkTopology(xpum_xelink_topo_info xelink_topo[], int* co
     return res;
 }
 
+xpum_result_t xpumGetPlacementAdvice(xpum_device_id_t deviceIdList[], int count, xpum_placement_advice_t* advice) {
+    xpum_result_t res = Core::instance().apiAccessPreCheck();
+    if (res != XPUM_OK) {
+        return res;
+    }
+    if (advice == nullptr || count < 0 || (count > 0 && deviceIdList == nullptr)) {
+        return XPUM_GENERIC_ERROR;
+    }
+
+    std::vector<std::shared_ptr<Device>> devices;
+    if (count == 0) {
+        Core::instance().getDeviceManager()->getDeviceList(devices);
+    } else {
+        for (int i = 0; i < count; i++) {
+            auto device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceIdList[i]));
+            if (device == nullptr) {
+                return XPUM_RESULT_DEVICE_NOT_FOUND;
+            }
+            if (std::find(devices.begin(), devices.end(), device) == devices.end()) {
+                devices.push_back(device);
+            }
+        }
+    }
+    if (devices.empty()) {
+        return XPUM_RESULT_DEVICE_NOT_FOUND;
+    }
+    if (devices.size() > XPUM_MAX_NUM_DEVICES) {
+        return XPUM_BUFFER_TOO_SMALL;
+    }
+
+    int topoCount = 0;
+    res = xpumGetXelinkTopology(nullptr, &topoCount);
+    if (res != XPUM_OK) {
+        return res;
+    }
+    std::vector<xpum_xelink_topo_info> topoInfos(topoCount);
+    if (topoCount > 0) {
+        res = xpumGetXelinkTopology(topoInfos.data(), &topoCount);
+        if (res != XPUM_OK) {
+            return res;
+        }
+        topoInfos.resize(topoCount);
+    }
+
+    size_t n = devices.size();
+    std::vector<PlacementDevice> placementDevices(n);
+    std::vector<std::string> bdfAddresses(n);
+    for (size_t i = 0; i < n; i++) {
+        Property prop;
+        if (!devices[i]->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS, prop)) {
+            return XPUM_GENERIC_ERROR;
+        }
+        bdfAddresses[i] = prop.getValue();
+        placementDevices[i].deviceId = std::stoi(devices[i]->getId());
+        placementDevices[i].numaIdx = -1;
+        placementDevices[i].cpuAffinity = Topology::getLocalCpusList(bdfAddresses[i]);
+    }
+
+    std::vector<std::vector<int>> xelinkLanes(n, std::vector<int>(n, 0));
+    std::vector<std::vector<int>> pcieHops(n, std::vector<int>(n, 0));
+    auto indexOf = [&](xpum_device_id_t deviceId) {
+        for (size_t i = 0; i < n; i++) {
+            if (placementDevices[i].deviceId == deviceId) {
+                return (int)i;
+            }
+        }
+        return -1;
+    };
+    for (auto& info : topoInfos) {
+        int local = indexOf(info.localDevice.deviceId);
+        int remote = indexOf(info.remoteDevice.deviceId);
+        if (local < 0) {
+            continue;
+        }
+        if (placementDevices[local].numaIdx < 0 && info.localDevice.numaIdx != (uint32_t)-1) {
+            placementDevices[local].numaIdx = info.localDevice.numaIdx;
+            if (info.localDevice.cpuAffinity[0] != '\0') {
+                placementDevices[local].cpuAffinity = info.localDevice.cpuAffinity;
+            }
+        }
+        if (remote < 0 || remote == local || info.linkType != XPUM_LINK_XE) {
+            continue;
+        }
+        for (int port = 0; port < XPUM_MAX_XELINK_PORT; port++) {
+            xelinkLanes[local][remote] += info.linkPorts[port];
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i + 1; j < n; j++) {
+            pcieHops[i][j] = pcieHops[j][i] = Topology::getPcieHops(bdfAddresses[i], bdfAddresses[j]);
+            // a link seen from either end connects both
+            xelinkLanes[i][j] = xelinkLanes[j][i] = std::max(xelinkLanes[i][j], xelinkLanes[j][i]);
+        }
+    }
+
+    PlacementAdvisor::advise(placementDevices, xelinkLanes, pcieHops, *advice);
+    return XPUM_OK;
+}
+
 } // end namespace xpum
@@ -6,20 +6,36 @@
 
 #include "device_manager.h"
 
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <set>
 #include <vector>
 #include <regex>
 
+#include "device/gpu/device_config_cache.h"
+#include "device/gpu/device_event_listener.h"
 #include "device/gpu/gpu_device_stub.h"
+#include "device/gpu/mmio_register_reader.h"
+#include "device/gpu/pmu_engine_reader.h"
+#include "device/gpu/simulated_device.h"
+#include "device/gpu/sysman_handle_cache.h"
 #include "infrastructure/configuration.h"
 #include "infrastructure/device_process.h"
 #include "infrastructure/device_util_by_proc.h"
 #include "infrastructure/exception/ilegal_parameter_exception.h"
 #include "infrastructure/handle_lock.h"
 #include "infrastructure/logger.h"
+#include "infrastructure/thread_factory.h"
 #include "infrastructure/utility.h"
 #include "level_zero/zes_api.h"
 #include "firmware/system_cmd.h"
@@ -29,6 +45,9 @@ namespace xpum {
 DeviceManager::DeviceManager(std::shared_ptr<DataLogicInterface>& p_data_logic)
     : p_data_logic(p_data_logic) {
     fabric_ids_has_built = false;
+    fabric_event_subscription = -1;
+    state_event_subscription = -1;
+    hotplug_stop = false;
     XPUM_LOG_TRACE("DeviceManager()");
 }
 
@@ -64,6 +83,17 @@ void DeviceManager::init() {
     std::atomic<bool> ready(false);
     std::weak_ptr<DeviceManager> this_weak_ptr = shared_from_this();
 
+    if (Configuration::SIMULATED_DEVICE_COUNT > 0) {
+        // the simulated devices do not need Level Zero
+        for (auto& p_device : *SimulatedDevice::discoverDevices()) {
+            p_device->freezeProperties();
+            devices.emplace_back(p_device);
+            device_index.emplace_back(p_device);
+        }
+        discoverFabricLinks();
+        return;
+    }
+
     GPUDeviceStub::instance().discoverDevices([&cv, &ready, this_weak_ptr](std::shared_ptr<void> ret, std::shared_ptr<BaseException> e) {
         auto p_this = this_weak_ptr.lock();
         if (p_this == nullptr) {
@@ -81,7 +111,15 @@ void DeviceManager::init() {
             auto p_devices = std::static_pointer_cast<std::vector<std::shared_ptr<Device>>>(ret);
 
             for (auto& p_device : *p_devices) {
+                p_device->freezeProperties();
                 p_this->devices.emplace_back(p_device);
+                uint32_t index = p_device->getIndex();
+                if (index != std::numeric_limits<uint32_t>::max()) {
+                    if (index >= p_this->device_index.size()) {
+                        p_this->device_index.resize(index + 1);
+                    }
+                    p_this->device_index[index] = p_device;
+                }
             }
         }
 
@@ -95,8 +133,18 @@ void DeviceManager::init() {
 
     discoverFabricLinks();
 
+    if (Configuration::STAGED_CAPABILITY_PROBING) {
+        probeCapabilities(devices);
+    }
+
     if (Configuration::XPUM_MODE != "xpu-smi"){
-        std::thread rediscoveryFabricLinks([=](){
+        // the ports are read again and the links rebuilt when a port state changes
+        fabric_event_subscription = DeviceEventListener::instance().subscribe(devices, ZES_EVENT_TYPE_FLAG_FABRIC_PORT_HEALTH,
+            [this](const std::string& deviceId, zes_event_type_flags_t events) {
+                onFabricPortEvent(deviceId);
+            });
+
+        std::thread rediscoveryFabricLinks = ThreadFactory::create("xpum-fabric", [=](){
             for(int i = 0; i < 30; i++){
                 std::this_thread::sleep_for(std::chrono::seconds(10));
                 if(this->discoverFabricLinks()){
@@ -105,10 +153,299 @@ void DeviceManager::init() {
             }
         });
         rediscoveryFabricLinks.detach();
+
+        if (Configuration::DEVICE_CONFIG_MAX_AGE > 0) {
+            // a reset, a detach or a wake up may restore the defaults of the configuration
+            state_event_subscription = DeviceEventListener::instance().subscribe(devices,
+                ZES_EVENT_TYPE_FLAG_DEVICE_RESET_REQUIRED | ZES_EVENT_TYPE_FLAG_DEVICE_DETACH | ZES_EVENT_TYPE_FLAG_DEVICE_ATTACH |
+                    ZES_EVENT_TYPE_FLAG_DEVICE_SLEEP_STATE_EXIT,
+                [this](const std::string& deviceId, zes_event_type_flags_t events) {
+                    onDeviceStateEvent(deviceId);
+                });
+            loadDeviceConfigs(devices);
+        }
+
+        if (Configuration::HOTPLUG_REDISCOVERY) {
+            startHotplugListener();
+        }
     }
 }
 
 void DeviceManager::close() {
+    hotplug_stop = true;
+    if (hotplug_listener.joinable()) {
+        hotplug_listener.join();
+    }
+    if (fabric_event_subscription >= 0) {
+        DeviceEventListener::instance().unsubscribe(fabric_event_subscription);
+        fabric_event_subscription = -1;
+    }
+    if (state_event_subscription >= 0) {
+        DeviceEventListener::instance().unsubscribe(state_event_subscription);
+        state_event_subscription = -1;
+    }
+    if (capability_prober.joinable()) {
+        capability_prober.join();
+    }
+    if (config_loader.joinable()) {
+        config_loader.join();
+    }
+}
+
+void DeviceManager::probeCapabilities(const std::vector<std::shared_ptr<Device>>& list) {
+    if (capability_prober.joinable()) {
+        capability_prober.join();
+    }
+    capability_prober = ThreadFactory::create("xpum-probe", [list]() {
+        auto begin = std::chrono::steady_clock::now();
+        Utility::parallel_in_batches(list.size(), list.size(), [&](int start, int end) {
+            for (int i = start; i < end; ++i) {
+                GPUDeviceStub::probeCapabilities(list[i]);
+            }
+        });
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+        XPUM_LOG_INFO("Capabilities of {} devices probed in {} ms", list.size(), elapsed);
+    });
+}
+
+void DeviceManager::loadDeviceConfigs(const std::vector<std::shared_ptr<Device>>& list) {
+    if (config_loader.joinable()) {
+        config_loader.join();
+    }
+    config_loader = ThreadFactory::create("xpum-config", [this, list]() {
+        auto begin = std::chrono::steady_clock::now();
+        for (auto& p_device : list) {
+            if (hotplug_stop) {
+                return;
+            }
+            std::string id = p_device->getId();
+            std::vector<Scheduler> schedulers;
+            getDeviceSchedulers(id, schedulers);
+            std::vector<Standby> standbys;
+            getDeviceStandbys(id, standbys);
+            std::vector<Power> powers;
+            getDevicePowerProps(id, powers);
+            Power_sustained_limit_t sustained_limit;
+            Power_burst_limit_t burst_limit;
+            Power_peak_limit_t peak_limit;
+            getDevicePowerLimits(id, sustained_limit, burst_limit, peak_limit);
+            std::vector<Frequency> frequencies;
+            getDeviceFrequencyRanges(id, frequencies);
+            std::vector<PerformanceFactor> factors;
+            getPerformanceFactor(id, factors);
+            Property prop;
+            uint32_t tile_count = 0;
+            if (p_device->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_TILES, prop)) {
+                tile_count = prop.getValueInt();
+            }
+            for (uint32_t tile = 0; tile < tile_count; tile++) {
+                std::vector<double> clocks;
+                getFreqAvailableClocks(id, tile, clocks);
+            }
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+        XPUM_LOG_INFO("Configuration of {} devices read in {} ms", list.size(), elapsed);
+    });
+}
+
+void DeviceManager::onDeviceStateEvent(const std::string& id) {
+    auto p_device = getDevice(id);
+    if (p_device == nullptr) {
+        return;
+    }
+    XPUM_LOG_DEBUG("State of device {} changed, its configuration is read again on the next query", id);
+    DeviceConfigCache::instance().release(p_device->getDeviceHandle());
+}
+
+// whether the uevent is about a display class PCI function or a DRM node, the payload is "ACTION@DEVPATH\0KEY=VALUE\0..."
+static bool isGPUUevent(const char* buf, size_t len) {
+    std::string action, subsystem, pci_class;
+    size_t i = 0;
+    while (i < len) {
+        std::string field(buf + i);
+        i += field.size() + 1;
+        if (field.compare(0, 7, "ACTION=") == 0) {
+            action = field.substr(7);
+        } else if (field.compare(0, 10, "SUBSYSTEM=") == 0) {
+            subsystem = field.substr(10);
+        } else if (field.compare(0, 10, "PCI_CLASS=") == 0) {
+            pci_class = field.substr(10);
+        }
+    }
+    if (action != "add" && action != "remove" && action != "bind" && action != "unbind") {
+        return false;
+    }
+    if (subsystem == "drm") {
+        return true;
+    }
+    // PCI_CLASS is the class code in hex without leading zeros, 0x03 is the display controller class
+    return subsystem == "pci" && pci_class.size() == 5 && pci_class[0] == '3';
+}
+
+void DeviceManager::startHotplugListener() {
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    if (fd < 0) {
+        XPUM_LOG_WARN("Failed to open the uevent socket, devices are not rediscovered on hotplug");
+        return;
+    }
+    struct sockaddr_nl addr = {};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_pid = 0;
+    addr.nl_groups = 1;
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        XPUM_LOG_WARN("Failed to bind the uevent socket, devices are not rediscovered on hotplug");
+        ::close(fd);
+        return;
+    }
+
+    hotplug_listener = ThreadFactory::create("xpum-hotplug", [this, fd]() {
+        // one rediscovery after the events of a reset or a VF creation settle
+        const auto settle_time = std::chrono::milliseconds(1000);
+        bool pending = false;
+        auto last_event = std::chrono::steady_clock::now();
+        char buf[8192];
+        while (!hotplug_stop) {
+            struct pollfd pfd = {fd, POLLIN, 0};
+            int ret = poll(&pfd, 1, 200);
+            if (ret > 0 && (pfd.revents & POLLIN)) {
+                ssize_t len = recv(fd, buf, sizeof(buf) - 1, 0);
+                if (len > 0) {
+                    buf[len] = '\0';
+                    if (isGPUUevent(buf, len)) {
+                        pending = true;
+                        last_event = std::chrono::steady_clock::now();
+                    }
+                }
+                continue;
+            }
+            if (pending && std::chrono::steady_clock::now() - last_event >= settle_time) {
+                pending = false;
+                rediscover();
+            }
+        }
+        ::close(fd);
+    });
+}
+
+std::string DeviceManager::getBDF(const std::shared_ptr<Device>& p_device) {
+    return p_device->getPropertyValue(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS);
+}
+
+void DeviceManager::rediscover() {
+    std::condition_variable cv;
+    std::mutex ready_mutex;
+    bool ready = false;
+    std::shared_ptr<std::vector<std::shared_ptr<Device>>> p_found;
+    GPUDeviceStub::instance().discoverDevices([&](std::shared_ptr<void> ret, std::shared_ptr<BaseException> e) {
+        std::unique_lock<std::mutex> lock(ready_mutex);
+        if (e != nullptr) {
+            XPUM_LOG_ERROR("Failed to rediscover devices: {}", e->what());
+        } else if (ret != nullptr) {
+            p_found = std::static_pointer_cast<std::vector<std::shared_ptr<Device>>>(ret);
+        }
+        ready = true;
+        cv.notify_all();
+    });
+    {
+        std::unique_lock<std::mutex> lock(ready_mutex);
+        cv.wait(lock, [&ready]() { return ready; });
+    }
+    if (p_found == nullptr) {
+        return;
+    }
+
+    std::map<std::string, std::shared_ptr<Device>> found;
+    for (auto& p_device : *p_found) {
+        p_device->freezeProperties();
+        std::string bdf = getBDF(p_device);
+        if (!bdf.empty()) {
+            found[bdf] = p_device;
+        }
+    }
+
+    std::vector<std::shared_ptr<Device>> added;
+    uint32_t removed = 0;
+    uint32_t replaced = 0;
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        std::vector<std::shared_ptr<Device>> merged;
+        std::set<std::string> used_ids;
+        for (auto& p_device : devices) {
+            auto it = found.find(getBDF(p_device));
+            if (it == found.end()) {
+                XPUM_LOG_INFO("Device {} is removed", p_device->getId());
+                MmioRegisterReader::instance().release(getBDF(p_device));
+                PmuEngineReader::instance().release(getBDF(p_device));
+                SysmanHandleCache::instance().release(p_device->getDeviceHandle());
+                DeviceConfigCache::instance().release(p_device->getDeviceHandle());
+                removed++;
+                continue;
+            }
+            if (it->second->getDeviceHandle() == p_device->getDeviceHandle()) {
+                merged.push_back(p_device);
+            } else {
+                // the device is reset or rebound, its handles changed but it keeps its id
+                MmioRegisterReader::instance().release(it->first);
+                PmuEngineReader::instance().release(it->first);
+                SysmanHandleCache::instance().release(p_device->getDeviceHandle());
+                DeviceConfigCache::instance().release(p_device->getDeviceHandle());
+                it->second->setId(p_device->getId());
+                merged.push_back(it->second);
+                added.push_back(it->second);
+                replaced++;
+            }
+            used_ids.insert(p_device->getId());
+            found.erase(it);
+        }
+        uint32_t next_id = 0;
+        for (auto& entry : found) {
+            while (used_ids.count(std::to_string(next_id)) > 0) {
+                next_id++;
+            }
+            auto& p_device = entry.second;
+            p_device->setId(std::to_string(next_id++));
+            XPUM_LOG_INFO("Device {} is added at {}", p_device->getId(), entry.first);
+            merged.push_back(p_device);
+            added.push_back(p_device);
+        }
+        if (added.empty() && removed == 0) {
+            return;
+        }
+        std::sort(merged.begin(), merged.end(), [](const std::shared_ptr<Device>& a, const std::shared_ptr<Device>& b) {
+            return a->getIndex() < b->getIndex();
+        });
+        devices = merged;
+        device_index.clear();
+        for (auto& p_device : devices) {
+            uint32_t index = p_device->getIndex();
+            if (index != std::numeric_limits<uint32_t>::max()) {
+                if (index >= device_index.size()) {
+                    device_index.resize(index + 1);
+                }
+                device_index[index] = p_device;
+            }
+        }
+    }
+    XPUM_LOG_INFO("Devices rediscovered: {} added, {} replaced, {} removed", added.size() - replaced, replaced, removed);
+
+    // the fabric ids and links are built again for the new device list
+    std::vector<std::shared_ptr<Device>> list;
+    getDeviceList(list);
+    {
+        std::lock_guard<std::mutex> lock(fabric_mutex);
+        fabric_ids.clear();
+        for (auto& p_device : list) {
+            p_device->clearFabricPortHandles();
+        }
+        fabric_ids_has_built = false;
+    }
+    discoverFabricLinks();
+    if (Configuration::STAGED_CAPABILITY_PROBING && !added.empty()) {
+        probeCapabilities(added);
+    }
+    if (Configuration::DEVICE_CONFIG_MAX_AGE > 0 && !added.empty()) {
+        loadDeviceConfigs(added);
+    }
 }
 
 void DeviceManager::getDeviceList(std::vector<std::shared_ptr<Device>>& devices) {
@@ -173,15 +510,15 @@ std::shared_ptr<MeasurementData> DeviceManager::getRealtimeMeasurementData(
         throw(*exception);
     }
 
-    auto subdeviceAdditionalDataTypes = p_data->getSubdeviceAdditionalDataTypes();
-    if (subdeviceAdditionalDataTypes.find(type) != subdeviceAdditionalDataTypes.end()) {
+    if (p_data->hasSubdeviceAdditionalData(type)) {
         auto mData = std::make_shared<MeasurementData>();
-        auto subdeviceAdditionalDatas = p_data->getSubdeviceAdditionalDatas();
-        for (auto& sData : subdeviceAdditionalDatas) {
-            if (sData.first == UINT32_MAX)
-                mData->setCurrent(sData.second[type].current);
+        for (auto& sData : p_data->getSubdeviceAdditionalDatas()) {
+            if (sData.type != type)
+                continue;
+            if (sData.subdevice_id == UINT32_MAX)
+                mData->setCurrent(sData.data.current);
             else
-                mData->setSubdeviceDataCurrent(sData.first, sData.second[type].current);
+                mData->setSubdeviceDataCurrent(sData.subdevice_id, sData.data.current);
         }
         return mData;
     }
@@ -190,6 +527,13 @@ std::shared_ptr<MeasurementData> DeviceManager::getRealtimeMeasurementData(
 }
 
 std::shared_ptr<Device> DeviceManager::getDevice(const std::string& id) {
+    uint32_t index;
+    if (Device::toIndex(id, index)) {
+        auto p_device = getDevice(index);
+        if (p_device != nullptr && p_device->getId() == id) {
+            return p_device;
+        }
+    }
     std::unique_lock<std::mutex> lock(this->mutex);
     for (auto& p_device : this->devices) {
         if (p_device->getId() == id) {
@@ -200,16 +544,19 @@ std::shared_ptr<Device> DeviceManager::getDevice(const std::string& id) {
     return nullptr;
 }
 
+std::shared_ptr<Device> DeviceManager::getDevice(uint32_t index) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    if (index < device_index.size()) {
+        return device_index[index];
+    }
+    return nullptr;
+}
+
 std::shared_ptr<Device> DeviceManager::getDevicebyBDF(const std::string& bdf) {
     std::unique_lock<std::mutex> lock(this->mutex);
     for (auto& p_device : this->devices) {
-        std::vector<Property> properties;
-        p_device->getProperties(properties);
-        for (Property &prop : properties) {
-            if (prop.getName() == XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS
-                && prop.getValue() == bdf) {
-                return p_device;
-            }
+        if (p_device->getPropertyValue(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS) == bdf) {
+            return p_device;
         }
     }
 
@@ -219,17 +566,25 @@ std::shared_ptr<Device> DeviceManager::getDevicebyBDF(const std::string& bdf) {
 void DeviceManager::getDeviceSchedulers(const std::string& id, std::vector<Scheduler>& schedulers) {
     std::unique_lock<std::mutex> lock(this->mutex);
     zes_device_handle_t device = getDeviceHandle(id);
-    GPUDeviceStub::instance().getSchedulers(device, schedulers);
+    DeviceConfigCache::instance().getSchedulers(device, schedulers, [&device](std::vector<Scheduler>& value) {
+        GPUDeviceStub::instance().getSchedulers(device, value);
+    });
 }
 
 void DeviceManager::getDeviceStandbys(const std::string& id, std::vector<Standby>& standbys) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    GPUDeviceStub::instance().getStandbys(getDeviceHandle(id), standbys);
+    zes_device_handle_t device = getDeviceHandle(id);
+    DeviceConfigCache::instance().getStandbys(device, standbys, [&device](std::vector<Standby>& value) {
+        GPUDeviceStub::instance().getStandbys(device, value);
+    });
 }
 
 void DeviceManager::getDevicePowerProps(const std::string& id, std::vector<Power>& powers) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    GPUDeviceStub::instance().getPowerProps(getDeviceHandle(id), powers);
+    zes_device_handle_t device = getDeviceHandle(id);
+    DeviceConfigCache::instance().getPowerProps(device, powers, [&device](std::vector<Power>& value) {
+        GPUDeviceStub::instance().getPowerProps(device, value);
+    });
 }
 
 void DeviceManager::getDevicePowerLimits(const std::string& id,
@@ -237,34 +592,60 @@ void DeviceManager::getDevicePowerLimits(const std::string& id,
                                          Power_burst_limit_t& burst_limit,
                                          Power_peak_limit_t& peak_limit) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    GPUDeviceStub::instance().getPowerLimits(getDeviceHandle(id), sustained_limit, burst_limit, peak_limit);
+    zes_device_handle_t device = getDeviceHandle(id);
+    DeviceConfigCache::PowerLimits limits;
+    limits.sustained_limit = sustained_limit;
+    limits.burst_limit = burst_limit;
+    limits.peak_limit = peak_limit;
+    DeviceConfigCache::instance().getPowerLimits(device, limits, [&device](DeviceConfigCache::PowerLimits& value) {
+        GPUDeviceStub::instance().getPowerLimits(device, value.sustained_limit, value.burst_limit, value.peak_limit);
+    });
+    sustained_limit = limits.sustained_limit;
+    burst_limit = limits.burst_limit;
+    peak_limit = limits.peak_limit;
 }
 
 bool DeviceManager::setDevicePowerSustainedLimits(const std::string& id, int32_t tileId,
                                                   const Power_sustained_limit_t& sustained_limit) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    return GPUDeviceStub::instance().setPowerSustainedLimits(getDeviceHandle(id), tileId, sustained_limit);
+    zes_device_handle_t device = getDeviceHandle(id);
+    bool ret = GPUDeviceStub::instance().setPowerSustainedLimits(device, tileId, sustained_limit);
+    DeviceConfigCache::instance().invalidate(device, DeviceConfigCache::POWER_LIMITS);
+    return ret;
 }
 
 bool DeviceManager::setDevicePowerBurstLimits(const std::string& id,
                                               const Power_burst_limit_t& burst_limit) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    return GPUDeviceStub::instance().setPowerBurstLimits(getDeviceHandle(id), burst_limit);
+    zes_device_handle_t device = getDeviceHandle(id);
+    bool ret = GPUDeviceStub::instance().setPowerBurstLimits(device, burst_limit);
+    DeviceConfigCache::instance().invalidate(device, DeviceConfigCache::POWER_LIMITS);
+    return ret;
 }
 
 bool DeviceManager::setDevicePowerPeakLimits(const std::string& id,
                                              const Power_peak_limit_t& peak_limit) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    return GPUDeviceStub::instance().setPowerPeakLimits(getDeviceHandle(id), peak_limit);
+    zes_device_handle_t device = getDeviceHandle(id);
+    bool ret = GPUDeviceStub::instance().setPowerPeakLimits(device, peak_limit);
+    DeviceConfigCache::instance().invalidate(device, DeviceConfigCache::POWER_LIMITS);
+    return ret;
 }
 
 void DeviceManager::getDeviceFrequencyRanges(const std::string& id,
                                              std::vector<Frequency>& frequencies) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    GPUDeviceStub::instance().getFrequencyRanges(getDeviceHandle(id), frequencies);
+    zes_device_handle_t device = getDeviceHandle(id);
+    DeviceConfigCache::instance().getFrequencyRanges(device, frequencies, [&device](std::vector<Frequency>& value) {
+        GPUDeviceStub::instance().getFrequencyRanges(device, value);
+    });
 }
 
 zes_device_handle_t DeviceManager::getDeviceHandle(const std::string& id) {
+    uint32_t index;
+    if (Device::toIndex(id, index) && index < device_index.size() && device_index[index] != nullptr && device_index[index]->getId() == id) {
+        return device_index[index]->getDeviceHandle();
+    }
     for (auto& p_device : this->devices) {
         if (p_device->getId() == id) {
             return p_device->getDeviceHandle();
@@ -276,18 +657,27 @@ zes_device_handle_t DeviceManager::getDeviceHandle(const std::string& id) {
 bool DeviceManager::setDeviceFrequencyRange(const std::string& id,
                                             const Frequency& freq) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    return GPUDeviceStub::instance().setFrequencyRange(getDeviceHandle(id), freq);
+    zes_device_handle_t device = getDeviceHandle(id);
+    bool ret = GPUDeviceStub::instance().setFrequencyRange(device, freq);
+    DeviceConfigCache::instance().invalidate(device, DeviceConfigCache::FREQUENCY_RANGES);
+    return ret;
 }
 
 bool DeviceManager::setDeviceFrequencyRangeForAll(const std::string& id,
                                             const Frequency& freq) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    return GPUDeviceStub::instance().setFrequencyRangeForAll(getDeviceHandle(id), freq);
+    zes_device_handle_t device = getDeviceHandle(id);
+    bool ret = GPUDeviceStub::instance().setFrequencyRangeForAll(device, freq);
+    DeviceConfigCache::instance().invalidate(device, DeviceConfigCache::FREQUENCY_RANGES);
+    return ret;
 }
 
 void DeviceManager::getFreqAvailableClocks(const std::string& id, uint32_t subdevice_id, std::vector<double>& clocks) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    GPUDeviceStub::instance().getFreqAvailableClocks(getDeviceHandle(id), subdevice_id, clocks);
+    zes_device_handle_t device = getDeviceHandle(id);
+    DeviceConfigCache::instance().getAvailableClocks(device, subdevice_id, clocks, [&device, subdevice_id](std::vector<double>& value) {
+        GPUDeviceStub::instance().getFreqAvailableClocks(device, subdevice_id, value);
+    });
 }
 
 void DeviceManager::getDeviceProcessState(const std::string& id, std::vector<device_process>& processes) {
@@ -310,50 +700,76 @@ void DeviceManager::getDeviceUtilByProcess(const std::string& id,
         devices.push_back(getDeviceHandle(id));
         device_ids.push_back(id);
     }
+    // the sampling sleeps for utilInterval, other callers should not wait for it
+    lock.unlock();
     GPUDeviceStub::getDeviceUtilByProc(devices, device_ids, utilInterval, utils);
 }
 
 void DeviceManager::getPerformanceFactor(const std::string& id, std::vector<PerformanceFactor>& pf) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    GPUDeviceStub::instance().getPerformanceFactor(getDeviceHandle(id), pf);
+    zes_device_handle_t device = getDeviceHandle(id);
+    DeviceConfigCache::instance().getPerformanceFactors(device, pf, [&device](std::vector<PerformanceFactor>& value) {
+        GPUDeviceStub::instance().getPerformanceFactor(device, value);
+    });
 }
 
 bool DeviceManager::setPerformanceFactor(const std::string& id, PerformanceFactor& pf) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    return GPUDeviceStub::instance().setPerformanceFactor(getDeviceHandle(id), pf);
+    zes_device_handle_t device = getDeviceHandle(id);
+    bool ret = GPUDeviceStub::instance().setPerformanceFactor(device, pf);
+    DeviceConfigCache::instance().invalidate(device, DeviceConfigCache::PERFORMANCE_FACTORS);
+    return ret;
 }
 
 bool DeviceManager::setDeviceStandby(const std::string& id,
                                      const Standby& standby) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    return GPUDeviceStub::instance().setStandby(getDeviceHandle(id), standby);
+    zes_device_handle_t device = getDeviceHandle(id);
+    bool ret = GPUDeviceStub::instance().setStandby(device, standby);
+    DeviceConfigCache::instance().invalidate(device, DeviceConfigCache::STANDBYS);
+    return ret;
 }
 
 bool DeviceManager::setDeviceSchedulerTimeoutMode(const std::string& id,
                                                   const SchedulerTimeoutMode& mode) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    return GPUDeviceStub::instance().setSchedulerTimeoutMode(getDeviceHandle(id), mode);
+    zes_device_handle_t device = getDeviceHandle(id);
+    bool ret = GPUDeviceStub::instance().setSchedulerTimeoutMode(device, mode);
+    DeviceConfigCache::instance().invalidate(device, DeviceConfigCache::SCHEDULERS);
+    return ret;
 }
 
 bool DeviceManager::setDeviceSchedulerTimesliceMode(const std::string& id,
                                                     const SchedulerTimesliceMode& mode) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    return GPUDeviceStub::instance().setSchedulerTimesliceMode(getDeviceHandle(id), mode);
+    zes_device_handle_t device = getDeviceHandle(id);
+    bool ret = GPUDeviceStub::instance().setSchedulerTimesliceMode(device, mode);
+    DeviceConfigCache::instance().invalidate(device, DeviceConfigCache::SCHEDULERS);
+    return ret;
 }
 
 bool DeviceManager::setDeviceSchedulerExclusiveMode(const std::string& id, const SchedulerExclusiveMode& mode) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    return GPUDeviceStub::instance().setSchedulerExclusiveMode(getDeviceHandle(id), mode);
+    zes_device_handle_t device = getDeviceHandle(id);
+    bool ret = GPUDeviceStub::instance().setSchedulerExclusiveMode(device, mode);
+    DeviceConfigCache::instance().invalidate(device, DeviceConfigCache::SCHEDULERS);
+    return ret;
 }
 
 bool DeviceManager::setDeviceSchedulerDebugMode(const std::string& id, const SchedulerDebugMode& mode) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    return GPUDeviceStub::instance().setSchedulerDebugMode(getDeviceHandle(id), mode);
+    zes_device_handle_t device = getDeviceHandle(id);
+    bool ret = GPUDeviceStub::instance().setSchedulerDebugMode(device, mode);
+    DeviceConfigCache::instance().invalidate(device, DeviceConfigCache::SCHEDULERS);
+    return ret;
 }
 
 bool DeviceManager::resetDevice(const std::string& id, bool force) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    return GPUDeviceStub::instance().resetDevice(getDeviceHandle(id), (ze_bool_t)force);
+    zes_device_handle_t device = getDeviceHandle(id);
+    bool ret = GPUDeviceStub::instance().resetDevice(device, (ze_bool_t)force);
+    DeviceConfigCache::instance().release(device);
+    return ret;
 }
 
 bool DeviceManager::getPPRDiagHandle(const std::string& id, zes_diag_handle_t& diagHandle) {
@@ -378,7 +794,10 @@ bool DeviceManager::getEccState(const std::string& id, MemoryEcc& ecc) {
 
 bool DeviceManager::setEccState(const std::string& id, ecc_state_t& newState, MemoryEcc& ecc) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    return GPUDeviceStub::instance().setEccState(getDeviceHandle(id), newState, ecc);
+    zes_device_handle_t device = getDeviceHandle(id);
+    bool ret = GPUDeviceStub::instance().setEccState(device, newState, ecc);
+    DeviceConfigCache::instance().invalidate(device, DeviceConfigCache::MEMORY_ECC);
+    return ret;
 }
 
 std::string DeviceManager::getDeviceIDByFabricID(uint64_t fabric_id) {
@@ -390,50 +809,96 @@ std::string DeviceManager::getDeviceIDByFabricID(uint64_t fabric_id) {
     return ret;
 }
 
+bool DeviceManager::getFabricLinks(const std::string& id, std::vector<FabricLinkInfo>& links) {
+    std::lock_guard<std::mutex> lock(this->fabric_mutex);
+    auto it = fabric_links.find(id);
+    if (it == fabric_links.end()) {
+        return false;
+    }
+    links = it->second;
+    return true;
+}
+
+void DeviceManager::buildFabricLinks() {
+    fabric_links.clear();
+    for (auto& p_device : this->devices) {
+        std::vector<FabricLinkInfo> links;
+        bool resolved = true;
+        for (auto& fabric_link : *p_device->getFabricLinks()) {
+            auto remote = fabric_ids.find(fabric_link.remote_fabric_id);
+            if (remote == fabric_ids.end()) {
+                resolved = false;
+                continue;
+            }
+            FabricLinkInfo link;
+            link.tile_id = fabric_link.attach_id;
+            link.remote_device_id = std::stoi(remote->second);
+            link.remote_tile_id = fabric_link.remote_attach_id;
+            links.push_back(link);
+        }
+        if (resolved) {
+            fabric_links[p_device->getId()] = links;
+        }
+    }
+}
+
+void DeviceManager::onFabricPortEvent(const std::string& id) {
+    auto p_device = getDevice(id);
+    if (p_device == nullptr) {
+        return;
+    }
+    XPUM_LOG_INFO("Fabric port state of device {} changed, discover its fabric links again", id);
+    GPUDeviceStub::resetDeviceFabricPorts(p_device->getDeviceHandle());
+    {
+        std::lock_guard<std::mutex> lock(this->fabric_mutex);
+        p_device->clearFabricPortHandles();
+        fabric_ids_has_built = false;
+    }
+    discoverFabricLinks();
+}
+
 bool DeviceManager::discoverFabricLinks() {
     std::lock_guard<std::mutex> lock(this->fabric_mutex);
     if(fabric_ids_has_built)
         return true;
     fabric_ids_has_built = true;
+    if (Configuration::SIMULATED_DEVICE_COUNT > 0) {
+        for (auto& p_device : this->devices) {
+            auto p_simulated = std::dynamic_pointer_cast<SimulatedDevice>(p_device);
+            if (p_simulated != nullptr && p_simulated->getSimulatedFabricId() != 0) {
+                fabric_ids[p_simulated->getSimulatedFabricId()] = p_device->getId();
+            }
+        }
+        buildFabricLinks();
+        return fabric_ids_has_built;
+    }
     for (auto& p_device : this->devices) {
-        zes_device_handle_t device = p_device->getDeviceHandle();
-        uint32_t fabric_port_count = 0;
-        std::shared_ptr<FabricMeasurementData> ret = std::make_shared<FabricMeasurementData>();
-        ze_result_t res;
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFabricPorts(device, &fabric_port_count, nullptr));
-        if (res == ZE_RESULT_SUCCESS) {
-            std::vector<zes_fabric_port_handle_t> fabric_ports(fabric_port_count);
-            XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFabricPorts(device, &fabric_port_count, fabric_ports.data()));
-            if (res == ZE_RESULT_SUCCESS) {
-                for (auto& fp : fabric_ports) {
-                    zes_fabric_port_properties_t props = {};
-                    XPUM_ZE_HANDLE_LOCK(fp, res = zesFabricPortGetProperties(fp, &props));
-                    if (res == ZE_RESULT_SUCCESS) {
-                        zes_fabric_port_state_t state = {};
-                        XPUM_ZE_HANDLE_LOCK(fp, res = zesFabricPortGetState(fp, &state));
-                        if (state.status == ZES_FABRIC_PORT_STATUS_HEALTHY || state.status == ZES_FABRIC_PORT_STATUS_DEGRADED) {
-                            XPUM_LOG_INFO("Success to call zesFabricPortGetState with port state is healthy or degraded");
-                            fabric_ids[props.portId.fabricId] = p_device->getId();
-                            p_device->setFabricID(props.portId.fabricId);
-                            p_device->addFabricPortHandle(props.portId.attachId, state.remotePortId.fabricId, state.remotePortId.attachId, fp);
-                        } else {
-                            XPUM_LOG_WARN("Port state is neither healthy nor degraded when call zesFabricPortGetState");
-                            fabric_ids_has_built = false;
-                        }
-                    } else {
-                        XPUM_LOG_WARN("Failed to call zesFabricPortGetProperties");
-                        fabric_ids_has_built = false;
-                    }
-                }
+        // the ports read here are kept by the stub for the throughput collection
+        std::shared_ptr<const std::vector<DeviceFabricPort_t>> ports;
+        bool complete = false;
+        ze_result_t res = GPUDeviceStub::getDeviceFabricPorts(p_device->getDeviceHandle(), ports, &complete);
+        if (res != ZE_RESULT_SUCCESS) {
+            XPUM_LOG_WARN("Failed to call zesDeviceEnumFabricPorts");
+            fabric_ids_has_built = false;
+            continue;
+        }
+        if (!complete) {
+            XPUM_LOG_WARN("Failed to read the properties or the state of fabric ports");
+            fabric_ids_has_built = false;
+        }
+        for (auto& port : *ports) {
+            if (port.status == ZES_FABRIC_PORT_STATUS_HEALTHY || port.status == ZES_FABRIC_PORT_STATUS_DEGRADED) {
+                XPUM_LOG_INFO("Success to call zesFabricPortGetState with port state is healthy or degraded");
+                fabric_ids[port.fabric_id] = p_device->getId();
+                p_device->setFabricID(port.fabric_id);
+                p_device->addFabricPortHandle(port.attach_id, port.remote_fabric_id, port.remote_attach_id, port.handle);
             } else {
-                XPUM_LOG_WARN("Failed to call zesDeviceEnumFabricPorts");
+                XPUM_LOG_WARN("Port state is neither healthy nor degraded when call zesFabricPortGetState");
                 fabric_ids_has_built = false;
             }
-        } else {
-            XPUM_LOG_WARN("Failed to call zesDeviceEnumFabricPorts");
-            fabric_ids_has_built = false;
         }
     }
+    buildFabricLinks();
     return fabric_ids_has_built;
 }
 
@@ -5,8 +5,10 @@
  */
 
 #pragma once
+#include <atomic>
 #include <map>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 #include "data_logic/data_logic_interface.h"
@@ -108,12 +110,27 @@ class DeviceManager : public DeviceManagerInterface,
 
     std::shared_ptr<Device> getDevice(const std::string& id);
 
+    /*
+      Devices get dense indices 0..n-1 at discovery, the index of a device is
+      its numeric id, Device::getIndex(). This avoids converting the id to
+      string and scanning the device list. SharedData and the data handlers
+      keep the devices by the same index.
+    */
+    std::shared_ptr<Device> getDevice(uint32_t index);
+
     std::shared_ptr<Device> getDevicebyBDF(const std::string& bdf);
 
     bool discoverFabricLinks();
 
     std::string getDeviceIDByFabricID(uint64_t fabric_id);
 
+    /*
+      The fabric links of the device, built with the fabric IDs by
+      discoverFabricLinks() and rebuilt when a port state changes. False if a
+      remote device of the links is not known.
+    */
+    bool getFabricLinks(const std::string& id, std::vector<FabricLinkInfo>& links);
+
     bool tryLockDevices(const std::vector<std::string>& deviceList);
 
     bool tryLockDevices(std::vector<std::shared_ptr<Device>>& deviceList);
@@ -135,17 +152,62 @@ class DeviceManager : public DeviceManagerInterface,
 
     void initSystemInfo();
 
+    // the links of all devices from their fabric throughput IDs, the caller holds fabric_mutex
+    void buildFabricLinks();
+
+    void onFabricPortEvent(const std::string& id);
+
+    // drop the configuration kept of a device whose state is changed by a driver event
+    void onDeviceStateEvent(const std::string& id);
+
+    // read the configuration of the devices into DeviceConfigCache so the first queries find it
+    void loadDeviceConfigs(const std::vector<std::shared_ptr<Device>>& list);
+
+    // probe the capabilities of the devices discovered without them, the monitor tasks sample them once added
+    void probeCapabilities(const std::vector<std::shared_ptr<Device>>& list);
+
+    // listen to the kernel uevents of the GPUs and rediscover() after a burst of them
+    void startHotplugListener();
+
+    /*
+      Discover the devices again and merge them by PCI BDF address: the devices
+      not changed are kept, a device with a new handle replaces the old one
+      under the same id, new devices get the lowest free ids and the devices
+      gone are removed. The monitor tasks read the device list on every tick,
+      so only the devices changed stop or start being sampled.
+    */
+    void rediscover();
+
+    static std::string getBDF(const std::shared_ptr<Device>& p_device);
+
    private:
     std::shared_ptr<DataLogicInterface> p_data_logic;
 
     std::vector<std::shared_ptr<Device>> devices;
 
+    // devices indexed by their numeric id, built at discovery
+    std::vector<std::shared_ptr<Device>> device_index;
+
     std::map<uint32_t, std::string> fabric_ids;
 
     std::mutex fabric_mutex;
 
     bool fabric_ids_has_built;
 
+    std::map<std::string, std::vector<FabricLinkInfo>> fabric_links;
+
+    int fabric_event_subscription;
+
+    int state_event_subscription;
+
+    std::thread capability_prober;
+
+    std::thread config_loader;
+
+    std::thread hotplug_listener;
+
+    std::atomic<bool> hotplug_stop;
+
     std::mutex mutex;
 
     SystemInfo systemInfo;
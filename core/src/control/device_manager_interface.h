@@ -9,6 +9,7 @@
 #include <mutex>
 #include <vector>
 
+#include "api/internal_api_structs.h"
 #include "device/device.h"
 #include "device/frequency.h"
 #include "device/memoryEcc.h"
@@ -121,12 +122,16 @@ class DeviceManagerInterface : public InitCloseInterface {
 
     virtual std::shared_ptr<Device> getDevice(const std::string& id) = 0;
 
+    virtual std::shared_ptr<Device> getDevice(uint32_t index) = 0;
+
     virtual std::shared_ptr<Device> getDevicebyBDF(const std::string& bdf) = 0;
 
     virtual bool discoverFabricLinks() = 0;
 
     virtual std::string getDeviceIDByFabricID(uint64_t fabric_id) = 0;
 
+    virtual bool getFabricLinks(const std::string& id, std::vector<FabricLinkInfo>& links) = 0;
+
     virtual bool tryLockDevices(const std::vector<std::string>& deviceList) = 0;
 
     virtual bool tryLockDevices(std::vector<std::shared_ptr<Device>>& deviceList) = 0;
@@ -9,14 +9,19 @@
 #include "control/device_manager.h"
 #include "data_logic/data_logic.h"
 #include "device/gpu/gpu_device_stub.h"
-#include "diagnostic/diagnostic_manager.h"
+#include "device/gpu/metric_streamer_session.h"
+#include "diagnostic/diagnostic_plugin.h"
 #include "group/group_manager.h"
 #include "health/health_manager.h"
 #include "infrastructure/configuration.h"
 #include "infrastructure/exception/ilegal_state_exception.h"
 #include "infrastructure/logger.h"
+#include "infrastructure/plugin_loader.h"
+#include "infrastructure/telemetry_checkpoint.h"
+#include "infrastructure/thread_factory.h"
 #include "monitor/monitor_manager.h"
 #include "policy/policy_manager.h"
+#include "topology/pci_database.h"
 #include "topology/topology.h"
 
 namespace xpum {
@@ -29,6 +34,22 @@ Core::Core()
       p_diagnostic_manager(nullptr),
       p_policy_manager(nullptr),
       p_dump_raw_data_manager(nullptr),
+      firmware_init("firmware manager", [this]() {
+          p_firmware_manager->init();
+      }),
+      diagnostic_init("diagnostic manager", [this]() {
+          // the diagnostics read the firmware versions
+          firmware_init.ensure();
+          auto p_manager = createDiagnosticManager();
+          p_manager->init();
+          p_diagnostic_manager = p_manager;
+      }),
+      dump_raw_data_init("dump raw data manager", [this]() {
+          p_dump_raw_data_manager = std::make_shared<DumpRawDataManager>();
+      }),
+      vgpu_init("vgpu manager", [this]() {
+          p_vgpu_manager = std::make_shared<VgpuManager>();
+      }),
       initialized(false),
       ze_initialized(false) {
     XPUM_LOG_TRACE("core()");
@@ -63,7 +84,23 @@ std::shared_ptr<GroupManagerInterface> Core::getGroupManager() {
     return p_group_manager;
 }
 
+std::shared_ptr<DiagnosticManagerInterface> Core::createDiagnosticManager() {
+    DiagnosticPluginContext context{p_device_manager, p_data_logic, p_firmware_manager, spdlog::default_logger()};
+#ifdef XPUM_DIAGNOSTIC_PLUGIN
+    auto create = reinterpret_cast<CreateDiagnosticManagerFunc>(PluginLoader::getSymbol("diagnostic", XPUM_CREATE_DIAGNOSTIC_MANAGER_SYMBOL));
+    if (create == nullptr) {
+        return std::make_shared<UnavailableDiagnosticManager>();
+    }
+#else
+    CreateDiagnosticManagerFunc create = xpum_create_diagnostic_manager;
+#endif
+    return std::shared_ptr<DiagnosticManagerInterface>(create(context));
+}
+
 std::shared_ptr<DiagnosticManagerInterface> Core::getDiagnosticManager() {
+    if (initialized) {
+        diagnostic_init.ensure();
+    }
     return p_diagnostic_manager;
 }
 
@@ -72,17 +109,36 @@ std::shared_ptr<PolicyManagerInterface> Core::getPolicyManager() {
 }
 
 std::shared_ptr<DumpRawDataManager> Core::getDumpRawDataManager() {
+    if (initialized) {
+        dump_raw_data_init.ensure();
+    }
     return p_dump_raw_data_manager;
 }
 
 std::shared_ptr<FirmwareManager> Core::getFirmwareManager() {
+    if (initialized) {
+        firmware_init.ensure();
+    }
     return p_firmware_manager;
 }
 
 std::shared_ptr<VgpuManager> Core::getVgpuManager() {
+    if (initialized) {
+        vgpu_init.ensure();
+    }
     return p_vgpu_manager;
 }
 
+#ifdef XPUM_BENCH
+void Core::initForBench(std::shared_ptr<DeviceManagerInterface> p_device_manager,
+                        std::shared_ptr<DataLogicInterface> p_data_logic) {
+    std::unique_lock<std::mutex> lock(mutex);
+    this->p_device_manager = p_device_manager;
+    this->p_data_logic = p_data_logic;
+    initialized = true;
+}
+#endif
+
 void Core::init() {
     std::unique_lock<std::mutex> lock(mutex);
     if (initialized) {
@@ -93,49 +149,66 @@ void Core::init() {
 
     XPUM_LOG_INFO("initialize configuration");
     Configuration::init();
+    // the threads started by the caller from now on, like those of gRPC, inherit the housekeeping policy
+    ThreadFactory::setupCurrentThread("");
 
-    XPUM_LOG_INFO("initialize datalogic");
+    // the managers are created up front, the graph only runs their init
     p_data_logic = std::make_shared<DataLogic>();
-    p_data_logic->init();
-
     // Create the instance of FirmwareManger earlier then it may work 
     // even L0 init got failed and FirmwareManager::init was not called
     p_firmware_manager = std::make_shared<FirmwareManager>();
-
-    XPUM_LOG_INFO("initialize device manager");
     p_device_manager = std::make_shared<DeviceManager>(p_data_logic);
-    p_device_manager->init();
-
-    XPUM_LOG_INFO("initialize health manager");
     p_health_manager = std::make_shared<HealthManager>(p_device_manager, p_data_logic);
-    p_health_manager->init();
-
-    XPUM_LOG_INFO("initialize group manager");
     p_group_manager = std::make_shared<GroupManager>(p_device_manager, p_data_logic);
-    p_group_manager->init();
-
-    XPUM_LOG_INFO("initialize policy manager");
     p_policy_manager = std::make_shared<PolicyManager>(p_device_manager, p_data_logic, p_group_manager);
-    p_policy_manager->init();
-
-    XPUM_LOG_INFO("initialize dump raw data manager");
-    p_dump_raw_data_manager = std::make_shared<DumpRawDataManager>();
-
-    XPUM_LOG_INFO("initialize firmware manager");
-    p_firmware_manager->init();
-
-    XPUM_LOG_INFO("initialize diagnostic manager");
-    p_diagnostic_manager = std::make_shared<DiagnosticManager>(p_device_manager, p_data_logic, p_firmware_manager);
-    p_diagnostic_manager->init();
-
-    XPUM_LOG_INFO("initialize monitor manager");
     p_monitor_manager = std::make_shared<MonitorManager>(p_device_manager, p_data_logic);
-    p_monitor_manager->init();
 
-    p_vgpu_manager = std::make_shared<VgpuManager>();
+    if (init_graph != nullptr) {
+        init_graph->join();
+    }
+    init_graph.reset(new InitGraph("xpumd core init"));
+    bool daemon = Configuration::XPUM_MODE != "xpu-smi";
+    bool pcie = Configuration::INITIALIZE_PCIE_MANAGER && Configuration::SIMULATED_DEVICE_COUNT == 0;
+    std::vector<std::string> checkpoint_dependencies = {"datalogic", "device manager"};
+
+    init_graph->add("datalogic", {}, [this]() { p_data_logic->init(); });
+    // zeInit and the discovery of the devices, the longest step usually
+    init_graph->add("device manager", {}, [this]() { p_device_manager->init(); });
+    if (pcie) {
+        // the section of the PCIe counters is restored by the checkpoint
+        init_graph->add("pcie manager", {}, []() { GPUDeviceStub::initPCIeManager(); });
+        checkpoint_dependencies.push_back("pcie manager");
+        // xpu-smi reads the counters right away, xpumd samples them again later
+        init_graph->add("pcie first sample", {"pcie manager"}, []() { GPUDeviceStub::pcie_manager.waitForFirstSample(); }, !daemon);
+    }
+    if (daemon) {
+        // only the topology queries need them, the first one does not wait for the loads then
+        init_graph->add("topology", {}, []() { Topology::preload(); }, false);
+        init_graph->add("pci database", {}, []() { PciDatabase::instance(); }, false);
+    }
+    init_graph->add("health manager", {"device manager"}, [this]() { p_health_manager->init(); });
+    init_graph->add("group manager", {"datalogic", "device manager"}, [this]() { p_group_manager->init(); });
+    init_graph->add("policy manager", {"group manager"}, [this]() { p_policy_manager->init(); });
+    // the state of the last run is restored before the first sample
+    init_graph->add("checkpoint", checkpoint_dependencies, [this]() { TelemetryCheckpoint::instance().start(p_device_manager); });
+    // the listeners of the samples are in place before the first one
+    init_graph->add("monitor manager", {"checkpoint", "health manager", "policy manager"}, [this]() { p_monitor_manager->init(); });
+    init_graph->run();
 
     XPUM_LOG_INFO("xpumd core initialization completed");
     initialized = true;
+
+    // igsc, the AMC scan and the precheck watch run in the background, the telemetry is ready already
+    firmware_init.warmup();
+#ifdef XPUM_DIAGNOSTIC_PLUGIN
+    // the plugin is only loaded by the first diagnostics call, unless it runs the precheck watch
+    bool warmup_diagnostic = Configuration::XPUM_MODE != "xpu-smi" && Configuration::PRECHECK_WATCH;
+#else
+    bool warmup_diagnostic = true;
+#endif
+    if (warmup_diagnostic) {
+        diagnostic_init.warmup();
+    }
 }
 
 void Core::close() {
@@ -144,6 +217,12 @@ void Core::close() {
         return;
     }
 
+    if (init_graph != nullptr) {
+        init_graph->join();
+    }
+    firmware_init.join();
+    diagnostic_init.join();
+
     p_firmware_manager = nullptr;
 
     p_dump_raw_data_manager = nullptr;
@@ -160,11 +239,13 @@ void Core::close() {
           "Failed to close health manager");
     close(std::dynamic_pointer_cast<InitCloseInterface>(p_monitor_manager),
           "Failed to close monitor manager");
+    TelemetryCheckpoint::instance().stop();
     close(std::dynamic_pointer_cast<InitCloseInterface>(p_device_manager),
           "Failed to close device manager");
     close(std::dynamic_pointer_cast<InitCloseInterface>(p_data_logic),
           "Failed to close data logic");
     GPUDeviceStub::pcie_manager.close();
+    MetricStreamerSessionManager::instance().closeAllSessions();
 }
 
 void Core::close(const std::shared_ptr<InitCloseInterface>& p_init_close_interface,
@@ -183,7 +264,6 @@ void Core::close(const std::shared_ptr<InitCloseInterface>& p_init_close_interfa
 }
 
 bool Core::isInitialized() {
-    std::unique_lock<std::mutex> lock(mutex);
     return this->initialized;
 }
 
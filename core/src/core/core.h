@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
 
 #include "control/device_manager_interface.h"
@@ -15,6 +16,8 @@
 #include "group/group_manager_interface.h"
 #include "health/health_manager_interface.h"
 #include "infrastructure/init_close_interface.h"
+#include "infrastructure/init_graph.h"
+#include "infrastructure/lazy_init.h"
 #include "monitor/monitor_manager_interface.h"
 #include "policy/policy_manager_interface.h"
 #include "dump_raw_data/dump_manager.h"
@@ -67,6 +70,15 @@ class Core : public InitCloseInterface {
 
     std::shared_ptr<VgpuManager> getVgpuManager();
 
+#ifdef XPUM_BENCH
+    /*
+      xpum_bench runs the telemetry pipeline on fake devices, it only needs
+      the device manager and the data logic and does not call init().
+    */
+    void initForBench(std::shared_ptr<DeviceManagerInterface> p_device_manager,
+                      std::shared_ptr<DataLogicInterface> p_data_logic);
+#endif
+
    private:
     Core();
 
@@ -78,6 +90,9 @@ class Core : public InitCloseInterface {
 
     void close(const std::shared_ptr<InitCloseInterface> &p_init_close_interface, const std::string &p_msgPrix);
 
+    // by the diagnostic plugin with BUILD_PLUGINS, a manager of unsupported calls if it is not installed
+    std::shared_ptr<DiagnosticManagerInterface> createDiagnosticManager();
+
    private:
     std::shared_ptr<DeviceManagerInterface> p_device_manager;
 
@@ -99,7 +114,29 @@ class Core : public InitCloseInterface {
 
     std::shared_ptr<VgpuManager> p_vgpu_manager;
 
-    bool initialized;
+    /*
+      The steps of init() by their dependencies, the PCIe first sample in
+      xpumd, the hwloc topology and the PCI database are kept loading in the
+      background once the telemetry is ready. Replaced by every init().
+    */
+    std::unique_ptr<InitGraph> init_graph;
+
+    /*
+      The subsystems the telemetry does not need are initialized on first
+      use. The firmware and the diagnostic managers are warmed up in the
+      background once init() is done, the dump raw data and the vGPU
+      managers are only created when used.
+    */
+    LazyInit firmware_init;
+
+    LazyInit diagnostic_init;
+
+    LazyInit dump_raw_data_init;
+
+    LazyInit vgpu_init;
+
+    // set at the end of init(), the lazy subsystems are not initialized before
+    std::atomic<bool> initialized;
 
     bool ze_initialized;
 
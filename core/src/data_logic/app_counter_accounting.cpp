@@ -0,0 +1,284 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file app_counter_accounting.cpp
+ */
+
+#include "app_counter_accounting.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <signal.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <set>
+
+#include "core/core.h"
+#include "device/gpu/gpu_device_stub.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+static std::string readProcessName(uint32_t pid) {
+    std::string name;
+    std::ifstream comm("/proc/" + std::to_string(pid) + "/comm");
+    std::getline(comm, name);
+    return name;
+}
+
+static bool mapSegment(const std::string& name, uint32_t pid, AppCounterSegment& segment) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(xpum_app_counters_header_t)) {
+        close(fd);
+        return false;
+    }
+    void* addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+    auto header = (const xpum_app_counters_header_t*)addr;
+    // a segment of another layout, or one still being created
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != XPUM_APP_COUNTERS_MAGIC || header->version != XPUM_APP_COUNTERS_VERSION || header->headerSize < sizeof(xpum_app_counters_header_t) || header->counterSize != sizeof(xpum_app_counter_t) || header->processId != pid || header->headerSize + (size_t)header->maxCounters * header->counterSize > (size_t)st.st_size) {
+        munmap(addr, st.st_size);
+        return false;
+    }
+    segment.header = header;
+    segment.size = st.st_size;
+    segment.inode = st.st_ino;
+    segment.counters = (const xpum_app_counter_t*)((const char*)addr + header->headerSize);
+    segment.max_counters = header->maxCounters;
+    segment.process_name = readProcessName(pid);
+    return true;
+}
+
+AppCounterAccounting::~AppCounterAccounting() {
+    for (auto& segment : segments) {
+        munmap((void*)segment.second.header, segment.second.size);
+    }
+}
+
+void AppCounterAccounting::scanSegments() {
+    std::string prefix(XPUM_APP_COUNTERS_SHM_PREFIX + 1);
+    std::set<uint32_t> pids;
+    DIR* dir = opendir("/dev/shm");
+    if (dir != nullptr) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            std::string name(entry->d_name);
+            if (name.compare(0, prefix.size(), prefix) != 0) {
+                continue;
+            }
+            uint32_t pid = 0;
+            try {
+                pid = std::stoul(name.substr(prefix.size()));
+            } catch (std::exception& e) {
+                continue;
+            }
+            if (pid == 0) {
+                continue;
+            }
+            if (kill(pid, 0) != 0 && errno == ESRCH) {
+                // the process exited without xpumAppCountersDestroy()
+                shm_unlink(("/" + name).c_str());
+                continue;
+            }
+            auto segment_iter = segments.find(pid);
+            if (segment_iter != segments.end()) {
+                // reading a segment the process shrank would fault, a segment created again is mapped again
+                struct stat st;
+                if (stat(("/dev/shm/" + name).c_str(), &st) != 0 || (size_t)st.st_size < segment_iter->second.size || st.st_ino != segment_iter->second.inode) {
+                    continue;
+                }
+            }
+            pids.insert(pid);
+            if (segment_iter == segments.end()) {
+                AppCounterSegment segment;
+                if (mapSegment("/" + name, pid, segment)) {
+                    XPUM_LOG_DEBUG("application counters of process {} mapped", pid);
+                    segments.emplace(pid, std::move(segment));
+                }
+            }
+        }
+        closedir(dir);
+    }
+    for (auto iter = segments.begin(); iter != segments.end();) {
+        if (pids.find(iter->first) == pids.end() || __atomic_load_n(&iter->second.header->magic, __ATOMIC_ACQUIRE) != XPUM_APP_COUNTERS_MAGIC) {
+            munmap((void*)iter->second.header, iter->second.size);
+            for (auto& device : devices) {
+                auto& efficiencies = device.second.efficiencies;
+                efficiencies.erase(efficiencies.lower_bound(std::make_pair(iter->first, 0u)), efficiencies.lower_bound(std::make_pair(iter->first + 1, 0u)));
+            }
+            iter = segments.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void AppCounterAccounting::handleData(MeasurementType type, std::shared_ptr<SharedData>& p_data) {
+    if (type != MeasurementType::METRIC_ENERGY) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    scanSegments();
+    if (segments.empty()) {
+        devices.clear();
+        return;
+    }
+
+    // the busy time in ns and the energy in mJ of each process on each device in the interval, by pid and device index
+    std::map<uint32_t, std::map<uint32_t, std::pair<uint64_t, double>>> pid_devices;
+    // the length of the interval of each device in ms
+    std::map<uint32_t, Timestamp_t> elapsed;
+    Timestamp_t time = p_data->getTime();
+    for (auto& data : p_data->getData()) {
+        auto& p_measurement = data.second;
+        if (p_measurement == nullptr || !p_measurement->hasDataOnDevice() || p_measurement->getCurrent() == std::numeric_limits<uint64_t>::max()) {
+            continue;
+        }
+        auto p_device = Core::instance().getDeviceManager()->getDevice(data.first);
+        ClientBusyTimes busy_times;
+        if (p_device == nullptr || !GPUDeviceStub::getDeviceClientBusyTime(p_device->getDeviceHandle(), p_device->getId(), busy_times)) {
+            continue;
+        }
+        double energy = p_measurement->getCurrent() * 1.0 / (p_measurement->getScale() > 0 ? p_measurement->getScale() : 1);
+        auto& device = devices[data.first];
+        if (device.has_energy && time > device.time && energy >= device.energy) {
+            std::map<uint32_t, uint64_t> pid_busy_times;
+            uint64_t total = 0;
+            for (auto& client : busy_times) {
+                auto previous = device.busy_times.find(client.first);
+                if (previous == device.busy_times.end() || previous->second.first != client.second.first || client.second.second < previous->second.second) {
+                    continue;
+                }
+                uint64_t delta = client.second.second - previous->second.second;
+                if (delta > 0) {
+                    pid_busy_times[client.second.first] += delta;
+                    total += delta;
+                }
+            }
+            for (auto& pid_busy_time : pid_busy_times) {
+                if (segments.find(pid_busy_time.first) != segments.end()) {
+                    pid_devices[pid_busy_time.first][data.first] = std::make_pair(pid_busy_time.second, (energy - device.energy) * pid_busy_time.second / total);
+                }
+            }
+            elapsed[data.first] = time - device.time;
+        }
+        device.has_energy = true;
+        device.time = time;
+        device.energy = energy;
+        device.busy_times = std::move(busy_times);
+    }
+
+    for (auto& segment : segments) {
+        auto header = segment.second.header;
+        uint32_t counter_count = std::min(__atomic_load_n(&header->counterCount, __ATOMIC_ACQUIRE), segment.second.max_counters);
+        auto counters = segment.second.counters;
+        auto& values = segment.second.values;
+        size_t seen = values.size();
+        values.resize(counter_count);
+        auto pid_device = pid_devices.find(segment.first);
+        uint64_t pid_busy_time = 0;
+        if (pid_device != pid_devices.end()) {
+            for (auto& device : pid_device->second) {
+                pid_busy_time += device.second.first;
+            }
+        }
+        for (uint32_t i = 0; i < counter_count; i++) {
+            uint64_t value = __atomic_load_n(&counters[i].value, __ATOMIC_RELAXED);
+            // a new counter is counted from the first sample it is seen in
+            uint64_t work = (i < seen && value >= values[i]) ? value - values[i] : 0;
+            values[i] = value;
+            if (i >= seen || pid_busy_time == 0) {
+                continue;
+            }
+            for (auto& device : pid_device->second) {
+                double busy_time = device.second.first;
+                double device_work = work * busy_time / pid_busy_time;
+                double energy = device.second.second / 1000;
+                double seconds = elapsed[device.first] / 1000.0;
+                auto& efficiency = devices[device.first].efficiencies[std::make_pair(segment.first, i)];
+                efficiency.time = time;
+                efficiency.rate = device_work / seconds;
+                efficiency.work_per_joule = energy > 0 ? device_work / energy : 0;
+                // ns busy per ms elapsed, in %
+                efficiency.utilization = busy_time / (seconds * 1e9) * 100;
+                efficiency.work_per_utilization = efficiency.utilization > 0 ? efficiency.rate / efficiency.utilization : 0;
+                efficiency.work += device_work;
+                efficiency.energy += energy;
+            }
+        }
+    }
+
+    // the counters of the processes not busy on a device in the interval did no work on it
+    for (auto& device : elapsed) {
+        for (auto& entry : devices[device.first].efficiencies) {
+            auto& efficiency = entry.second;
+            if (efficiency.time != time) {
+                efficiency.time = time;
+                efficiency.rate = 0;
+                efficiency.work_per_joule = 0;
+                efficiency.work_per_utilization = 0;
+                efficiency.utilization = 0;
+            }
+        }
+    }
+}
+
+xpum_result_t AppCounterAccounting::getEfficiency(uint32_t device_id, xpum_app_counter_efficiency_t data_list[], uint32_t* count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iter = devices.find(device_id);
+    uint32_t size = iter == devices.end() ? 0 : iter->second.efficiencies.size();
+    if (data_list == nullptr) {
+        *count = size;
+        return XPUM_OK;
+    }
+    if (*count < size) {
+        *count = size;
+        return XPUM_BUFFER_TOO_SMALL;
+    }
+    auto copyString = [](char* dest, const char* src) {
+        strncpy(dest, src, XPUM_MAX_STR_LENGTH - 1);
+        dest[XPUM_MAX_STR_LENGTH - 1] = 0;
+    };
+    uint32_t index = 0;
+    if (iter != devices.end()) {
+        for (auto& entry : iter->second.efficiencies) {
+            auto segment = segments.find(entry.first.first);
+            if (segment == segments.end()) {
+                continue;
+            }
+            auto counter = segment->second.counters + entry.first.second;
+            auto& efficiency = entry.second;
+            auto& data = data_list[index++];
+            data.deviceId = device_id;
+            data.processId = entry.first.first;
+            copyString(data.processName, segment->second.process_name.c_str());
+            // the name is complete once the counter is counted, the array may not end with 0
+            char name[XPUM_APP_COUNTER_NAME_LENGTH + 1] = {};
+            memcpy(name, counter->name, XPUM_APP_COUNTER_NAME_LENGTH);
+            copyString(data.counterName, name);
+            memcpy(name, counter->unit, XPUM_APP_COUNTER_NAME_LENGTH);
+            copyString(data.unit, name);
+            data.timestamp = efficiency.time;
+            data.rate = efficiency.rate;
+            data.workPerJoule = efficiency.work_per_joule;
+            data.workPerUtilization = efficiency.work_per_utilization;
+            data.utilization = efficiency.utilization;
+            data.work = efficiency.work;
+            data.energy = efficiency.energy;
+        }
+    }
+    *count = index;
+    return XPUM_OK;
+}
+
+} // end namespace xpum
@@ -0,0 +1,101 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file app_counter_accounting.h
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/xpum_app_counters.h"
+#include "../include/xpum_structs.h"
+#include "infrastructure/measurement_type.h"
+#include "job_accounting.h"
+#include "shared_data.h"
+
+namespace xpum {
+
+// the efficiency of one counter of a process on one device
+struct AppCounterEfficiency {
+    Timestamp_t time;
+    double rate;
+    double work_per_joule;
+    double work_per_utilization;
+    double utilization;
+    double work;
+    double energy;
+
+    AppCounterEfficiency() : time(0), rate(0), work_per_joule(0), work_per_utilization(0), utilization(0), work(0), energy(0) {}
+};
+
+// the segment of xpum_app_counters.h published by a process, mapped read only
+struct AppCounterSegment {
+    const xpum_app_counters_header_t* header;
+    size_t size;
+    ino_t inode;
+    // the layout checked when the segment was mapped, the process can still write the header
+    const xpum_app_counter_t* counters;
+    uint32_t max_counters;
+    std::string process_name;
+    // the counter values at the previous energy sample, by index
+    std::vector<uint64_t> values;
+
+    AppCounterSegment() : header(nullptr), size(0), inode(0), counters(nullptr), max_counters(0) {}
+};
+
+struct AppCounterDevice {
+    bool has_energy;
+    Timestamp_t time;
+    double energy;
+    ClientBusyTimes busy_times;
+    // the pid, the counter index map index
+    std::map<std::pair<uint32_t, uint32_t>, AppCounterEfficiency> efficiencies;
+
+    AppCounterDevice() : has_energy(false), time(0), energy(0) {}
+};
+
+/*
+  AppCounterAccounting joins the work counters the processes publish with
+  xpum_app_counters.h with the telemetry of the devices they use.
+
+  On every energy sample the segments in /dev/shm are read on the same tick
+  as the busy time of the drm clients of each device. The energy of a device
+  between two samples is split among its processes by their busy time, as in
+  JobAccounting, and the work a process has done is split among its devices
+  by its busy time on each. The work of a process busy on no device with a
+  readable busy time is not attributed.
+*/
+class AppCounterAccounting {
+   public:
+    ~AppCounterAccounting();
+
+    /*
+      Fill the efficiency of the counters of the processes of device
+      device_id. If data_list is NULL, only count is filled.
+    */
+    xpum_result_t getEfficiency(uint32_t device_id, xpum_app_counter_efficiency_t data_list[], uint32_t* count);
+
+    void handleData(MeasurementType type, std::shared_ptr<SharedData>& p_data);
+
+   private:
+    // map the segments of new processes, drop those of processes which exited
+    void scanSegments();
+
+    std::mutex mutex;
+
+    // by pid
+    std::map<uint32_t, AppCounterSegment> segments;
+
+    // by device index
+    DeviceIndexMap<AppCounterDevice> devices;
+};
+
+} // end namespace xpum
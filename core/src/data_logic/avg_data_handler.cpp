@@ -19,62 +19,87 @@ AvgDataHandler::~AvgDataHandler() {
     close();
 }
 
-void AvgDataHandler::getAvg(std::string& device_id, int& min, int& max, int& avg) {
-    double accumated = 0.0;
-    int temp_min = std::numeric_limits<int>::max();
-    int temp_max = std::numeric_limits<int>::min();
-    int count = 0;
-    std::deque<std::shared_ptr<SharedData>>::const_iterator iter = deque.begin();
-    while (iter != deque.end()) {
-        if ((*iter)->getData().find(device_id) != (*iter)->getData().end()) {
-            int data = (*iter)->getData()[device_id]->getCurrent();
-            if (data > temp_max) {
-                temp_max = data;
-            }
-            if (data < temp_min) {
-                temp_min = data;
-            }
-            accumated += data;
-            count++;
-        }
-        iter++;
+void SlidingWindowAggregator::add(Timestamp_t time, int value) {
+    samples.emplace_back(time, value);
+    sum += value;
+    while (!min_queue.empty() && min_queue.back().second >= value) {
+        min_queue.pop_back();
+    }
+    min_queue.emplace_back(time, value);
+    while (!max_queue.empty() && max_queue.back().second <= value) {
+        max_queue.pop_back();
+    }
+    max_queue.emplace_back(time, value);
+}
+
+void SlidingWindowAggregator::evict(Timestamp_t now, Timestamp_t window) {
+    while (!samples.empty() && now - samples.front().first > window) {
+        sum -= samples.front().second;
+        samples.pop_front();
     }
-    if (temp_max != std::numeric_limits<int>::min()) {
-        max = temp_max;
+    while (!min_queue.empty() && now - min_queue.front().first > window) {
+        min_queue.pop_front();
     }
-    if (temp_min != std::numeric_limits<int>::max()) {
-        min = temp_min;
+    while (!max_queue.empty() && now - max_queue.front().first > window) {
+        max_queue.pop_front();
     }
-    if (count != 0) {
-        avg = accumated / count;
+}
+
+bool SlidingWindowAggregator::empty() const {
+    return samples.empty();
+}
+
+void SlidingWindowAggregator::get(int& min, int& max, int& avg) const {
+    if (samples.empty()) {
+        return;
+    }
+    min = min_queue.front().second;
+    max = max_queue.front().second;
+    avg = sum / (int64_t)samples.size();
+}
+
+void AvgDataHandler::getAvg(uint32_t device_id, int& min, int& max, int& avg) {
+    auto iter = windows.find(device_id);
+    if (iter != windows.end()) {
+        iter->second.get(min, max, avg);
     }
 }
 
 void AvgDataHandler::handleData(std::shared_ptr<SharedData>& p_data) noexcept {
     std::unique_lock<std::mutex> lock(this->mutex);
-    deque.push_back(p_data);
-    std::shared_ptr<SharedData>& q_data = deque.front();
-    while (q_data != nullptr && p_data->getTime() - q_data->getTime() > Configuration::DATA_HANDLER_CACHE_TIME_LIMIT) {
-        deque.pop_front();
-        q_data = deque.front();
+    Timestamp_t now = p_data->getTime();
+    for (auto& data : p_data->getData()) {
+        if (data.second != nullptr) {
+            windows[data.first].add(now, data.second->getCurrent());
+        }
+    }
+    for (auto iter = windows.begin(); iter != windows.end(); ++iter) {
+        iter->second.evict(now, Configuration::DATA_HANDLER_CACHE_TIME_LIMIT);
+        if (iter->second.empty()) {
+            windows.erase(iter->first);
+        }
     }
 }
 
-std::shared_ptr<MeasurementData> AvgDataHandler::getLatestData(std::string& device_id) noexcept {
+std::shared_ptr<MeasurementData> AvgDataHandler::getLatestData(uint32_t device_id) noexcept {
     std::unique_lock<std::mutex> lock(this->mutex);
     if (p_latestData == nullptr) {
         return nullptr;
     }
 
-    auto datas = p_latestData->getData();
+    auto& datas = p_latestData->getData();
+    auto iter = datas.find(device_id);
+    if (iter == datas.end() || iter->second == nullptr) {
+        return nullptr;
+    }
     int min = 0;
     int max = 0;
     int avg = 0;
     getAvg(device_id, min, max, avg);
-    datas[device_id]->setMin(min);
-    datas[device_id]->setMax(max);
-    datas[device_id]->setAvg(avg);
-    return datas[device_id];
+    iter->second->setMin(min);
+    iter->second->setMax(max);
+    iter->second->setAvg(avg);
+    return iter->second;
 }
 
 } // end namespace xpum
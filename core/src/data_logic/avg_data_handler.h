@@ -6,10 +6,38 @@
 
 #pragma once
 
+#include <deque>
+#include <map>
+
 #include "data_handler.h"
 
 namespace xpum {
 
+/*
+  Sliding window of the samples of one device. min and max are kept with
+  monotonic deques and avg with a running sum, so all of them are read in
+  constant time.
+*/
+class SlidingWindowAggregator {
+   public:
+    SlidingWindowAggregator() : sum(0) {}
+
+    void add(Timestamp_t time, int value);
+
+    // drop the samples taken more than window ms before now
+    void evict(Timestamp_t now, Timestamp_t window);
+
+    bool empty() const;
+
+    void get(int& min, int& max, int& avg) const;
+
+   private:
+    std::deque<std::pair<Timestamp_t, int>> samples;
+    std::deque<std::pair<Timestamp_t, int>> min_queue;
+    std::deque<std::pair<Timestamp_t, int>> max_queue;
+    int64_t sum;
+};
+
 class AvgDataHandler : public DataHandler {
    public:
     AvgDataHandler(MeasurementType type, std::shared_ptr<Persistency>& p_persistency);
@@ -18,10 +46,10 @@ class AvgDataHandler : public DataHandler {
 
     virtual void handleData(std::shared_ptr<SharedData>& p_data) noexcept;
 
-    virtual std::shared_ptr<MeasurementData> getLatestData(std::string& device_id) noexcept;
+    virtual std::shared_ptr<MeasurementData> getLatestData(uint32_t device_id) noexcept;
 
 private:
-    void getAvg(std::string& device_id, int& min, int& max, int& avg);
-    std::deque<std::shared_ptr<SharedData>> deque;
+    void getAvg(uint32_t device_id, int& min, int& max, int& avg);
+    DeviceIndexMap<SlidingWindowAggregator> windows;
 };
 } // end namespace xpum
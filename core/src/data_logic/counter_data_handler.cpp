@@ -11,57 +11,84 @@
 namespace xpum {
 
 CounterDataHandler::CounterDataHandler(MeasurementType type, 
-                                                   std::shared_ptr<Persistency>& p_persistency) 
-: StatsDataHandler(type, p_persistency) {
+                                                   std::shared_ptr<Persistency>& p_persistency,
+                                                   CounterMode mode) 
+: StatsDataHandler(type, p_persistency), mode(mode) {
 }
 
 CounterDataHandler::~CounterDataHandler() {
     close();
 }
 
-void CounterDataHandler::counterOverflowDetection(std::shared_ptr<SharedData>& p_data) noexcept {
+void CounterDataHandler::calculateRate(MeasurementData& pre, MeasurementData& cur) {
+    const uint64_t invalid = std::numeric_limits<uint64_t>::max();
+    if (cur.hasRawDataOnDevice() && pre.hasRawDataOnDevice()) {
+        uint64_t pre_data = pre.getRawdata();
+        uint64_t cur_data = cur.getRawdata();
+        // a counter going backwards wrapped or was reset, skip this interval
+        if (pre_data != invalid && cur_data != invalid && pre_data <= cur_data) {
+            uint64_t interval = cur.getRawTimestamp() - pre.getRawTimestamp();
+            if (interval != 0) {
+                cur.setCurrent((cur_data - pre_data) / interval);
+            }
+        }
+    }
+
+    if (!cur.hasSubdeviceRawData() || !pre.hasSubdeviceRawData()) {
+        return;
+    }
+    auto p_cur_subs = cur.getSubdeviceRawDatas();
+    auto p_pre_subs = pre.getSubdeviceRawDatas();
+    auto cur_iter = p_cur_subs->begin();
+    auto pre_iter = p_pre_subs->begin();
+    while (cur_iter != p_cur_subs->end() && pre_iter != p_pre_subs->end()) {
+        if (pre_iter->first < cur_iter->first) {
+            ++pre_iter;
+            continue;
+        }
+        if (cur_iter->first < pre_iter->first) {
+            ++cur_iter;
+            continue;
+        }
+        auto &pre_raw = pre_iter->second;
+        auto &cur_raw = cur_iter->second;
+        if (pre_raw.raw_data != invalid && cur_raw.raw_data != invalid && pre_raw.raw_data <= cur_raw.raw_data) {
+            uint64_t interval = cur_raw.raw_timestamp - pre_raw.raw_timestamp;
+            if (interval != 0) {
+                cur.setSubdeviceDataCurrent(cur_iter->first, (cur_raw.raw_data - pre_raw.raw_data) / interval);
+            }
+        }
+        ++cur_iter;
+        ++pre_iter;
+    }
+}
+
+void CounterDataHandler::processCounters(std::shared_ptr<SharedData>& p_data) {
     std::unique_lock<std::mutex> lock(this->mutex);
     if (p_preData == nullptr || p_data == nullptr) {
         return;
     }
 
-    std::map<std::string, std::shared_ptr<MeasurementData>>::iterator iter = p_data->getData().begin();
-    while (iter != p_data->getData().end()) {
-        auto &deviceId = iter->first;
-        auto &measurementData = iter->second;
-        if (measurementData->hasDataOnDevice() 
-        && p_preData->getData().find(deviceId) != p_preData->getData().end()
-        && p_data->getData().find(deviceId) != p_data->getData().end()) {
-            uint64_t pre_data = p_preData->getData()[deviceId]->getCurrent();
-            uint64_t cur_data = p_data->getData()[deviceId]->getCurrent();
-            if (pre_data > cur_data) {
-                p_preData = nullptr;
-                return;
-            }   
-        }
-
-        if (measurementData->hasSubdeviceData()
-        && p_preData->getData().find(deviceId) != p_preData->getData().end()
-        && p_preData->getData()[deviceId]->hasSubdeviceData()
-        && p_data->getData().find(deviceId) != p_data->getData().end()) {
-            std::map<uint32_t, SubdeviceData>::const_iterator iter_subdevice = measurementData->getSubdeviceDatas()->begin();
-            auto &subDeviceId = iter_subdevice->first;
-            auto &subDeviceData = iter_subdevice->second;
-            while (iter_subdevice != measurementData->getSubdeviceDatas()->end() 
-            && p_preData->getData()[deviceId]->getSubdeviceDatas()->find(subDeviceId) != p_preData->getData()[deviceId]->getSubdeviceDatas()->end()) {
-                uint64_t pre_data = p_preData->getData()[deviceId]->getSubdeviceDataCurrent(subDeviceId);
-                uint64_t cur_data = subDeviceData.current;
-                if (pre_data != std::numeric_limits<uint64_t>::max() && cur_data != std::numeric_limits<uint64_t>::max()) {
-                    if (pre_data > cur_data) {
-                        p_preData->getData()[deviceId]->clearSubdeviceDataCurrent(subDeviceId);
-                    }
-                }
-                ++iter_subdevice;
+    auto &datas = p_data->getData();
+    if (mode == CounterMode::RATE) {
+        // both samples are sorted by device ID
+        auto &pre_datas = p_preData->getData();
+        auto pre_iter = pre_datas.begin();
+        for (auto &entry : datas) {
+            while (pre_iter != pre_datas.end() && pre_iter->first < entry.first) {
+                ++pre_iter;
+            }
+            if (pre_iter == pre_datas.end()) {
+                break;
+            }
+            if (pre_iter->first == entry.first && pre_iter->second != nullptr && entry.second != nullptr) {
+                calculateRate(*pre_iter->second, *entry.second);
             }
         }
-
-        ++iter;
     }
+    updateBatchStatistics(datas, p_data->getTime());
+    sessions.seal();
+    reportMemory();
 }
 
 void CounterDataHandler::handleData(std::shared_ptr<SharedData>& p_data) noexcept {
@@ -69,8 +96,7 @@ void CounterDataHandler::handleData(std::shared_ptr<SharedData>& p_data) noexcep
         return;
     }
     
-    counterOverflowDetection(p_data);
-    updateStatistics(p_data);
+    processCounters(p_data);
 }
 
 } // end namespace xpum
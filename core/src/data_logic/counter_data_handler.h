@@ -10,15 +10,35 @@
 
 namespace xpum {
 
+/*
+  CounterDataHandler handles the counter-type metrics. The rates of one tick
+  are calculated in a single walk over the current and the previous samples,
+  which are both sorted by device ID, the sub-device tables of both samples
+  are walked side by side since they are sorted by sub-device ID, and the
+  statistics are then updated as one batch.
+*/
+
+enum class CounterMode {
+    // the counter value itself is the metric
+    ACCUMULATED,
+    // the metric is the rate of the raw counter between two samples
+    RATE,
+};
+
 class CounterDataHandler : public StatsDataHandler {
    public:
-    CounterDataHandler(MeasurementType type, std::shared_ptr<Persistency> &p_persistency);
+    CounterDataHandler(MeasurementType type, std::shared_ptr<Persistency> &p_persistency, CounterMode mode = CounterMode::ACCUMULATED);
 
     virtual ~CounterDataHandler();
 
-    void counterOverflowDetection(std::shared_ptr<SharedData> &p_data) noexcept;
-
     virtual void handleData(std::shared_ptr<SharedData> &p_data) noexcept;
 
+   protected:
+    void processCounters(std::shared_ptr<SharedData> &p_data);
+
+   private:
+    static void calculateRate(MeasurementData &pre, MeasurementData &cur);
+
+    CounterMode mode;
 };
-} // end namespace xpum
\ No newline at end of file
+} // end namespace xpum
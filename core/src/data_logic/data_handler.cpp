@@ -40,7 +40,10 @@ void DataHandler::updateDataInHandler(std::shared_ptr<SharedData>& p_data) noexc
     this->p_latestData = p_data;
     auto iter = this->p_latestData->getData().begin();
     while (iter != this->p_latestData->getData().end()) {
-        iter->second->setTimestamp(p_data->getTime());
+        // the data not stamped when it was read has the time of the tick
+        if (iter->second != nullptr && iter->second->getTimestamp() == 0) {
+            iter->second->setTimestamp(p_data->getTime());
+        }
         ++iter;
     }
     lock.unlock();
@@ -59,32 +62,27 @@ void DataHandler::updateDataInHandler(std::shared_ptr<SharedData>& p_data) noexc
     }
 }
 
-std::shared_ptr<MeasurementData> DataHandler::getLatestData(std::string& device_id) noexcept {
-    std::unique_lock<std::mutex> lock(this->mutex);
-    if (p_latestData == nullptr) {
-        return nullptr;
-    }
+void DataHandler::publishSnapshot(std::shared_ptr<SharedData>& p_data) noexcept {
+    std::atomic_store(&p_snapshot, p_data);
+}
 
-    auto datas = p_latestData->getData();
-    if (datas.find(device_id) != datas.end()) {
-        return datas[device_id];
-    } else {
+std::shared_ptr<MeasurementData> DataHandler::getSnapshotData(uint32_t device_id) noexcept {
+    auto p_data = std::atomic_load(&p_snapshot);
+    if (p_data == nullptr) {
         return nullptr;
     }
+
+    auto& datas = p_data->getData();
+    auto iter = datas.find(device_id);
+    return iter != datas.end() ? iter->second : nullptr;
 }
 
-std::shared_ptr<MeasurementData> DataHandler::getLatestStatistics(std::string& device_id, uint64_t session_id) noexcept {
-    std::unique_lock<std::mutex> lock(this->mutex);
-    if (p_latestData == nullptr) {
-        return nullptr;
-    }
+std::shared_ptr<MeasurementData> DataHandler::getLatestData(uint32_t device_id) noexcept {
+    return getSnapshotData(device_id);
+}
 
-    auto datas = p_latestData->getData();
-    if (datas.find(device_id) != datas.end()) {
-        return datas[device_id];
-    } else {
-        return nullptr;
-    }
+std::shared_ptr<MeasurementData> DataHandler::getLatestStatistics(uint32_t device_id, uint64_t session_id) noexcept {
+    return getSnapshotData(device_id);
 }
 
 } // end namespace xpum
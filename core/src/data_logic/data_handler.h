@@ -35,9 +35,19 @@ class DataHandler : public std::enable_shared_from_this<DataHandler> {
 
     virtual void handleData(std::shared_ptr<SharedData> &p_data) noexcept = 0;
 
-    virtual std::shared_ptr<MeasurementData> getLatestData(std::string &device_id) noexcept;
+    virtual std::shared_ptr<MeasurementData> getLatestData(uint32_t device_id) noexcept;
 
-    virtual std::shared_ptr<MeasurementData> getLatestStatistics(std::string &device_id, uint64_t session_id) noexcept;
+    virtual std::shared_ptr<MeasurementData> getLatestStatistics(uint32_t device_id, uint64_t session_id) noexcept;
+
+    /*
+      Publish p_data as the snapshot read by getLatestData, it must not be
+      modified by the handler any more. Readers load the snapshot atomically
+      without taking the handler mutex.
+    */
+    void publishSnapshot(std::shared_ptr<SharedData> &p_data) noexcept;
+
+   protected:
+    std::shared_ptr<MeasurementData> getSnapshotData(uint32_t device_id) noexcept;
 
    protected:
     std::mutex mutex;
@@ -47,6 +57,9 @@ class DataHandler : public std::enable_shared_from_this<DataHandler> {
     std::shared_ptr<SharedData> p_preData;
 
    private:
+    // only accessed through std::atomic_load and std::atomic_store
+    std::shared_ptr<SharedData> p_snapshot;
+
     MeasurementType type;
 
     std::atomic<bool> stop;
@@ -13,15 +13,31 @@
 #include "fabric_throughput_data_handler.h"
 #include "gpu_utilization_data_handler.h"
 #include "infrastructure/configuration.h"
+#include "infrastructure/metric_descriptor.h"
 #include "counter_data_handler.h"
 #include "stats_data_handler.h"
+#include "throttle_reason_data_handler.h"
 #include "time_weighted_average_data_handler.h"
 #include "shared_data.h"
 #include "perf_metrics_data_handler.h"
+#include "vf_engine_utilization_data_handler.h"
 #include "device/gpu/gpu_device_stub.h"
 
 namespace xpum {
 
+namespace {
+
+// returns the begin timestamp of the session and restarts it from now
+uint64_t takeSessionTimestamp(std::map<uint32_t, std::map<uint32_t, uint64_t>>& timestamps, uint32_t session_id, uint32_t device_id, uint64_t default_time) {
+    auto& device_timestamps = timestamps[session_id];
+    auto iter = device_timestamps.find(device_id);
+    uint64_t time = iter != device_timestamps.end() ? iter->second : default_time;
+    device_timestamps[device_id] = Utility::getCurrentTime();
+    return time;
+}
+
+} // namespace
+
 DataHandlerManager::DataHandlerManager(std::shared_ptr<Persistency>& persistency)
     : p_persistency(persistency) {
 }
@@ -32,153 +48,52 @@ DataHandlerManager::~DataHandlerManager() {
 
 void DataHandlerManager::init() {
     std::unique_lock<std::mutex> lock(mutex);
+    init_timestamp = Utility::getCurrentTime();
+
+    for (auto& descriptor : metric_descriptors) {
+        std::shared_ptr<DataHandler> p_handler;
+        switch (descriptor.handler) {
+            case MetricHandlerKind::TIME_WEIGHTED_AVERAGE:
+                p_handler = std::make_shared<TimeWeightedAverageDataHandler>(descriptor.type, p_persistency);
+                break;
+            case MetricHandlerKind::COUNTER:
+                p_handler = std::make_shared<CounterDataHandler>(descriptor.type, p_persistency);
+                break;
+            case MetricHandlerKind::ENGINE_UTILIZATION:
+                p_handler = std::make_shared<EngineUtilizationDataHandler>(descriptor.type, p_persistency);
+                break;
+            case MetricHandlerKind::GPU_UTILIZATION:
+                p_handler = std::make_shared<GPUUtilizationDataHandler>(descriptor.type, p_persistency);
+                break;
+            case MetricHandlerKind::ENGINE_GROUP_UTILIZATION:
+                p_handler = std::make_shared<EngineGroupUtilizationDataHandler>(descriptor.type, p_persistency);
+                break;
+            case MetricHandlerKind::FABRIC_THROUGHPUT:
+                p_handler = std::make_shared<FabricThroughputDataHandler>(descriptor.type, p_persistency);
+                break;
+            case MetricHandlerKind::PERF:
+                p_handler = std::make_shared<PerfMetricsHandler>(descriptor.type, p_persistency);
+                break;
+            case MetricHandlerKind::VF_ENGINE_UTILIZATION:
+                p_handler = std::make_shared<VfEngineUtilizationDataHandler>(descriptor.type, p_persistency);
+                break;
+            case MetricHandlerKind::THROTTLE_REASON:
+                p_handler = std::make_shared<ThrottleReasonDataHandler>(descriptor.type, p_persistency);
+                break;
+            default:
+                p_handler = std::make_shared<StatsDataHandler>(descriptor.type, p_persistency);
+                break;
+        }
+        p_handler->init();
+        data_handlers[descriptor.type] = p_handler;
+    }
 
-    data_handlers[MeasurementType::METRIC_TEMPERATURE] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_TEMPERATURE, p_persistency);
-    data_handlers[MeasurementType::METRIC_TEMPERATURE]->init();
-
-    data_handlers[MeasurementType::METRIC_FREQUENCY] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_FREQUENCY, p_persistency);
-    data_handlers[MeasurementType::METRIC_FREQUENCY]->init();
-
-    data_handlers[MeasurementType::METRIC_MEDIA_ENGINE_FREQUENCY] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_MEDIA_ENGINE_FREQUENCY, p_persistency);
-    data_handlers[MeasurementType::METRIC_MEDIA_ENGINE_FREQUENCY]->init();
-
-    data_handlers[MeasurementType::METRIC_REQUEST_FREQUENCY] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_REQUEST_FREQUENCY, p_persistency);
-    data_handlers[MeasurementType::METRIC_REQUEST_FREQUENCY]->init();
-
-    data_handlers[MeasurementType::METRIC_POWER] =
-        std::make_shared<TimeWeightedAverageDataHandler>(MeasurementType::METRIC_POWER, p_persistency);
-    data_handlers[MeasurementType::METRIC_POWER]->init();
-
-    data_handlers[MeasurementType::METRIC_ENERGY] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_ENERGY, p_persistency);
-    data_handlers[MeasurementType::METRIC_ENERGY]->init();
-
-    data_handlers[MeasurementType::METRIC_MEMORY_USED] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_MEMORY_USED, p_persistency);
-    data_handlers[MeasurementType::METRIC_MEMORY_USED]->init();
-
-    data_handlers[MeasurementType::METRIC_MEMORY_UTILIZATION] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_MEMORY_UTILIZATION, p_persistency);
-    data_handlers[MeasurementType::METRIC_MEMORY_UTILIZATION]->init();
-
-    data_handlers[MeasurementType::METRIC_MEMORY_BANDWIDTH] =
-        std::make_shared<TimeWeightedAverageDataHandler>(MeasurementType::METRIC_MEMORY_BANDWIDTH, p_persistency);
-    data_handlers[MeasurementType::METRIC_MEMORY_BANDWIDTH]->init();
-
-    data_handlers[MeasurementType::METRIC_MEMORY_READ] =
-        std::make_shared<CounterDataHandler>(MeasurementType::METRIC_MEMORY_READ, p_persistency);
-    data_handlers[MeasurementType::METRIC_MEMORY_READ]->init();
-
-    data_handlers[MeasurementType::METRIC_MEMORY_WRITE] =
-        std::make_shared<CounterDataHandler>(MeasurementType::METRIC_MEMORY_WRITE, p_persistency);
-    data_handlers[MeasurementType::METRIC_MEMORY_WRITE]->init();
-
-    data_handlers[MeasurementType::METRIC_MEMORY_READ_THROUGHPUT] =
-        std::make_shared<TimeWeightedAverageDataHandler>(MeasurementType::METRIC_MEMORY_READ_THROUGHPUT, p_persistency);
-    data_handlers[MeasurementType::METRIC_MEMORY_READ_THROUGHPUT]->init();
-
-    data_handlers[MeasurementType::METRIC_MEMORY_WRITE_THROUGHPUT] =
-        std::make_shared<TimeWeightedAverageDataHandler>(MeasurementType::METRIC_MEMORY_WRITE_THROUGHPUT, p_persistency);
-    data_handlers[MeasurementType::METRIC_MEMORY_WRITE_THROUGHPUT]->init();
-
-    data_handlers[MeasurementType::METRIC_ENGINE_UTILIZATION] =
-        std::make_shared<EngineUtilizationDataHandler>(MeasurementType::METRIC_ENGINE_UTILIZATION, p_persistency);
-    data_handlers[MeasurementType::METRIC_ENGINE_UTILIZATION]->init();
-
-    data_handlers[MeasurementType::METRIC_COMPUTATION] =
-        std::make_shared<GPUUtilizationDataHandler>(MeasurementType::METRIC_COMPUTATION, p_persistency);
-    data_handlers[MeasurementType::METRIC_COMPUTATION]->init();
-
-    data_handlers[MeasurementType::METRIC_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION] =
-        std::make_shared<EngineGroupUtilizationDataHandler>(MeasurementType::METRIC_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION, p_persistency);
-    data_handlers[MeasurementType::METRIC_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION]->init();
-
-    data_handlers[MeasurementType::METRIC_ENGINE_GROUP_MEDIA_ALL_UTILIZATION] =
-        std::make_shared<EngineGroupUtilizationDataHandler>(MeasurementType::METRIC_ENGINE_GROUP_MEDIA_ALL_UTILIZATION, p_persistency);
-    data_handlers[MeasurementType::METRIC_ENGINE_GROUP_MEDIA_ALL_UTILIZATION]->init();
-
-    data_handlers[MeasurementType::METRIC_ENGINE_GROUP_COPY_ALL_UTILIZATION] =
-        std::make_shared<EngineGroupUtilizationDataHandler>(MeasurementType::METRIC_ENGINE_GROUP_COPY_ALL_UTILIZATION, p_persistency);
-    data_handlers[MeasurementType::METRIC_ENGINE_GROUP_COPY_ALL_UTILIZATION]->init();
-
-    data_handlers[MeasurementType::METRIC_ENGINE_GROUP_RENDER_ALL_UTILIZATION] =
-        std::make_shared<EngineGroupUtilizationDataHandler>(MeasurementType::METRIC_ENGINE_GROUP_RENDER_ALL_UTILIZATION, p_persistency);
-    data_handlers[MeasurementType::METRIC_ENGINE_GROUP_RENDER_ALL_UTILIZATION]->init();
-
-    data_handlers[MeasurementType::METRIC_ENGINE_GROUP_3D_ALL_UTILIZATION] =
-        std::make_shared<EngineGroupUtilizationDataHandler>(MeasurementType::METRIC_ENGINE_GROUP_3D_ALL_UTILIZATION, p_persistency);
-    data_handlers[MeasurementType::METRIC_ENGINE_GROUP_3D_ALL_UTILIZATION]->init();
-
-    data_handlers[MeasurementType::METRIC_EU_ACTIVE] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_EU_ACTIVE, p_persistency);
-    data_handlers[MeasurementType::METRIC_EU_ACTIVE]->init();
-
-    data_handlers[MeasurementType::METRIC_EU_STALL] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_EU_STALL, p_persistency);
-    data_handlers[MeasurementType::METRIC_EU_STALL]->init();
-
-    data_handlers[MeasurementType::METRIC_EU_IDLE] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_EU_IDLE, p_persistency);
-    data_handlers[MeasurementType::METRIC_EU_IDLE]->init();
-
-    //METRIC_RAS_ERROR
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_RESET] = std::make_shared<StatsDataHandler>(MeasurementType::METRIC_RAS_ERROR_CAT_RESET, p_persistency);
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_RESET]->init();
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_PROGRAMMING_ERRORS] = std::make_shared<StatsDataHandler>(MeasurementType::METRIC_RAS_ERROR_CAT_PROGRAMMING_ERRORS, p_persistency);
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_PROGRAMMING_ERRORS]->init();
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_DRIVER_ERRORS] = std::make_shared<StatsDataHandler>(MeasurementType::METRIC_RAS_ERROR_CAT_DRIVER_ERRORS, p_persistency);
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_DRIVER_ERRORS]->init();
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE] = std::make_shared<StatsDataHandler>(MeasurementType::METRIC_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE, p_persistency);
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE]->init();
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE] = std::make_shared<StatsDataHandler>(MeasurementType::METRIC_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE, p_persistency);
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE]->init();
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE] = std::make_shared<StatsDataHandler>(MeasurementType::METRIC_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE, p_persistency);
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE]->init();
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE] = std::make_shared<StatsDataHandler>(MeasurementType::METRIC_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE, p_persistency);
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE]->init();
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE] = std::make_shared<StatsDataHandler>(MeasurementType::METRIC_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE, p_persistency);
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE]->init();
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE] = std::make_shared<StatsDataHandler>(MeasurementType::METRIC_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE, p_persistency);
-    data_handlers[MeasurementType::METRIC_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE]->init();
-
-    data_handlers[MeasurementType::METRIC_MEMORY_TEMPERATURE] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_MEMORY_TEMPERATURE, p_persistency);
-    data_handlers[MeasurementType::METRIC_MEMORY_TEMPERATURE]->init();
-
-    data_handlers[MeasurementType::METRIC_FREQUENCY_THROTTLE] =
-        std::make_shared<TimeWeightedAverageDataHandler>(MeasurementType::METRIC_FREQUENCY_THROTTLE, p_persistency);
-    data_handlers[MeasurementType::METRIC_FREQUENCY_THROTTLE]->init();
-
-    data_handlers[MeasurementType::METRIC_FREQUENCY_THROTTLE_REASON_GPU] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_FREQUENCY_THROTTLE_REASON_GPU, p_persistency);
-
-    data_handlers[MeasurementType::METRIC_PCIE_READ_THROUGHPUT] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_PCIE_READ_THROUGHPUT, p_persistency);
-    data_handlers[MeasurementType::METRIC_PCIE_READ_THROUGHPUT]->init();
-
-    data_handlers[MeasurementType::METRIC_PCIE_WRITE_THROUGHPUT] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_PCIE_WRITE_THROUGHPUT, p_persistency);
-    data_handlers[MeasurementType::METRIC_PCIE_WRITE_THROUGHPUT]->init();
-
-    data_handlers[MeasurementType::METRIC_PCIE_READ] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_PCIE_READ, p_persistency);
-    data_handlers[MeasurementType::METRIC_PCIE_READ]->init();
-
-    data_handlers[MeasurementType::METRIC_PCIE_WRITE] =
-        std::make_shared<StatsDataHandler>(MeasurementType::METRIC_PCIE_WRITE, p_persistency);
-    data_handlers[MeasurementType::METRIC_PCIE_WRITE]->init();
-
-    data_handlers[MeasurementType::METRIC_FABRIC_THROUGHPUT] =
-        std::make_shared<FabricThroughputDataHandler>(MeasurementType::METRIC_FABRIC_THROUGHPUT, p_persistency);
-    data_handlers[MeasurementType::METRIC_FABRIC_THROUGHPUT]->init();
-
-    data_handlers[MeasurementType::METRIC_PERF] =
-        std::make_shared<PerfMetricsHandler>(MeasurementType::METRIC_PERF, p_persistency);
-    data_handlers[MeasurementType::METRIC_PERF]->init();
+    // the residencies only grow, they are kept across restarts of xpumd
+    auto p_throttle_handler = std::static_pointer_cast<ThrottleReasonDataHandler>(data_handlers[MeasurementType::METRIC_FREQUENCY_THROTTLE_REASON_GPU]);
+    TelemetryCheckpoint::instance().registerSection(
+        "throttle",
+        [p_throttle_handler](std::vector<CheckpointRecord>& records) { p_throttle_handler->saveResidencies(records); },
+        [p_throttle_handler](const std::vector<CheckpointRecord>& records) { p_throttle_handler->restoreResidencies(records); });
 }
 
 void DataHandlerManager::close() {
@@ -187,21 +102,37 @@ void DataHandlerManager::close() {
 void DataHandlerManager::storeMeasurementData(
     MeasurementType type,
     Timestamp_t time,
-    std::shared_ptr<std::map<std::string, std::shared_ptr<MeasurementData>>> datas) {
+    std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas) {
     std::unique_lock<std::mutex> lock(mutex);
     auto& p_handler = data_handlers[type];
+    auto cur_listeners = listeners;
     lock.unlock();
 
     if (p_handler != nullptr) {
+        std::shared_lock<std::shared_timed_mutex> store_lock(store_mutex);
         auto p_shared_data = std::make_shared<SharedData>(time, datas);
         p_handler->updateDataInHandler(p_shared_data);
         p_handler->handleData(p_shared_data);
+        p_handler->publishSnapshot(p_shared_data);
+        job_accounting.handleData(type, p_shared_data);
+        app_counter_accounting.handleData(type, p_shared_data);
+        group_aggregation.handleData(type, p_shared_data);
+        store_lock.unlock();
+
+        for (auto& listener : *cur_listeners) {
+            listener(type, datas);
+        }
+
+        std::unique_lock<std::mutex> update_lock(update_mutex);
+        update_generation++;
+        update_lock.unlock();
+        update_cv.notify_all();
     }
 }
 
 std::shared_ptr<MeasurementData> DataHandlerManager::getLatestData(
     MeasurementType type,
-    std::string& device_id) noexcept {
+    uint32_t device_id) noexcept {
     std::unique_lock<std::mutex> lock(mutex);
     auto& p_handler = data_handlers[type];
     lock.unlock();
@@ -209,7 +140,7 @@ std::shared_ptr<MeasurementData> DataHandlerManager::getLatestData(
     return p_handler == nullptr ? nullptr : p_handler->getLatestData(device_id);
 }
 
-std::shared_ptr<MeasurementData> DataHandlerManager::getLatestStatistics(MeasurementType type, std::string& device_id, uint64_t session_id) noexcept {
+std::shared_ptr<MeasurementData> DataHandlerManager::getLatestStatistics(MeasurementType type, uint32_t device_id, uint64_t session_id) noexcept {
     std::unique_lock<std::mutex> lock(mutex);
     auto& p_handler = data_handlers[type];
     lock.unlock();
@@ -217,6 +148,71 @@ std::shared_ptr<MeasurementData> DataHandlerManager::getLatestStatistics(Measure
     return p_handler == nullptr ? nullptr : p_handler->getLatestStatistics(device_id, session_id);
 }
 
+void DataHandlerManager::getPerfMetricStats(uint32_t device_id, uint32_t window_ms, std::vector<PerfMetricStat_t>& stats) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = data_handlers.find(MeasurementType::METRIC_PERF);
+    auto p_handler = it == data_handlers.end() ? nullptr : std::static_pointer_cast<PerfMetricsHandler>(it->second);
+    lock.unlock();
+
+    stats.clear();
+    if (p_handler != nullptr) {
+        p_handler->getPerfMetricStats(device_id, window_ms, stats);
+    }
+}
+
+void DataHandlerManager::getHistograms(MeasurementType type, uint32_t device_id, std::map<uint32_t, QuantileSketch>& histograms) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = data_handlers.find(type);
+    auto p_handler = it == data_handlers.end() ? nullptr : std::dynamic_pointer_cast<StatsDataHandler>(it->second);
+    lock.unlock();
+
+    histograms.clear();
+    if (p_handler != nullptr) {
+        p_handler->getHistograms(device_id, histograms);
+    }
+}
+
+void DataHandlerManager::getThrottleResidencies(uint32_t device_id, std::map<uint32_t, ThrottleResidency_t>& residencies) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = data_handlers.find(MeasurementType::METRIC_FREQUENCY_THROTTLE_REASON_GPU);
+    auto p_handler = it == data_handlers.end() ? nullptr : std::static_pointer_cast<ThrottleReasonDataHandler>(it->second);
+    lock.unlock();
+
+    residencies.clear();
+    if (p_handler != nullptr) {
+        p_handler->getResidencies(device_id, residencies);
+    }
+}
+
+void DataHandlerManager::getTopdownCounters(uint32_t device_id, uint32_t window_ms, std::vector<TopdownCounters_t>& counters) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = data_handlers.find(MeasurementType::METRIC_PERF);
+    auto p_handler = it == data_handlers.end() ? nullptr : std::static_pointer_cast<PerfMetricsHandler>(it->second);
+    lock.unlock();
+
+    counters.clear();
+    if (p_handler != nullptr) {
+        p_handler->getTopdownCounters(device_id, window_ms, counters);
+    }
+}
+
+std::unique_lock<std::shared_timed_mutex> DataHandlerManager::pauseStores() {
+    return std::unique_lock<std::shared_timed_mutex>(store_mutex);
+}
+
+void DataHandlerManager::addListener(MeasurementListener listener) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto new_listeners = std::make_shared<std::vector<MeasurementListener>>(*listeners);
+    new_listeners->push_back(listener);
+    listeners = std::move(new_listeners);
+}
+
+uint64_t DataHandlerManager::waitForUpdate(uint64_t generation, uint32_t timeout) {
+    std::unique_lock<std::mutex> lock(update_mutex);
+    update_cv.wait_for(lock, std::chrono::milliseconds(timeout), [this, generation] { return update_generation != generation; });
+    return update_generation;
+}
+
 void DataHandlerManager::updateStatsTimestamp(uint32_t session_id, uint32_t device_id) {
     std::unique_lock<std::mutex> lock(mutex);
     stats_session_timestamps[session_id][device_id] = Utility::getCurrentTime();
@@ -224,9 +220,7 @@ void DataHandlerManager::updateStatsTimestamp(uint32_t session_id, uint32_t devi
 
 uint64_t DataHandlerManager::getStatsTimestamp(uint32_t session_id, uint32_t device_id) {
     std::unique_lock<std::mutex> lock(mutex);
-    uint64_t time = stats_session_timestamps[session_id][device_id];
-    stats_session_timestamps[session_id][device_id] = Utility::getCurrentTime();
-    return time;
+    return takeSessionTimestamp(stats_session_timestamps, session_id, device_id, init_timestamp);
 }
 
 void DataHandlerManager::updateEngineStatsTimestamp(uint32_t session_id, uint32_t device_id) {
@@ -236,9 +230,7 @@ void DataHandlerManager::updateEngineStatsTimestamp(uint32_t session_id, uint32_
 
 uint64_t DataHandlerManager::getEngineStatsTimestamp(uint32_t session_id, uint32_t device_id) {
     std::unique_lock<std::mutex> lock(mutex);
-    uint64_t time = engine_stats_session_timestamps[session_id][device_id];
-    engine_stats_session_timestamps[session_id][device_id] = Utility::getCurrentTime();
-    return time;
+    return takeSessionTimestamp(engine_stats_session_timestamps, session_id, device_id, init_timestamp);
 }
 
 void DataHandlerManager::updateFabricStatsTimestamp(uint32_t session_id, uint32_t device_id) {
@@ -248,9 +240,19 @@ void DataHandlerManager::updateFabricStatsTimestamp(uint32_t session_id, uint32_
 
 uint64_t DataHandlerManager::getFabricStatsTimestamp(uint32_t session_id, uint32_t device_id) {
     std::unique_lock<std::mutex> lock(mutex);
-    uint64_t time = fabric_stats_session_timestamps[session_id][device_id];
-    fabric_stats_session_timestamps[session_id][device_id] = Utility::getCurrentTime();
-    return time;
+    return takeSessionTimestamp(fabric_stats_session_timestamps, session_id, device_id, init_timestamp);
+}
+
+JobAccounting& DataHandlerManager::getJobAccounting() {
+    return job_accounting;
+}
+
+AppCounterAccounting& DataHandlerManager::getAppCounterAccounting() {
+    return app_counter_accounting;
+}
+
+GroupAggregation& DataHandlerManager::getGroupAggregation() {
+    return group_aggregation;
 }
 
 } // end namespace xpum
@@ -6,12 +6,22 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <map>
 #include <mutex>
+#include <shared_mutex>
 
+#include "app_counter_accounting.h"
 #include "data_handler.h"
+#include "data_logic_interface.h"
+#include "group_aggregation.h"
+#include "job_accounting.h"
 #include "infrastructure/measurement_type.h"
+#include "infrastructure/perf_measurement_data.h"
+#include "infrastructure/topdown_analysis.h"
 #include "persistency.h"
+#include "quantile_sketch.h"
+#include "throttle_reason_data_handler.h"
 
 namespace xpum {
 
@@ -29,13 +39,25 @@ class DataHandlerManager {
     void storeMeasurementData(
         MeasurementType type,
         Timestamp_t time,
-        std::shared_ptr<std::map<std::string, std::shared_ptr<MeasurementData>>> datas);
+        std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas);
 
     std::shared_ptr<MeasurementData> getLatestData(
         MeasurementType type,
-        std::string& device_id) noexcept;
+        uint32_t device_id) noexcept;
 
-    std::shared_ptr<MeasurementData> getLatestStatistics(MeasurementType type, std::string& device_id, uint64_t session_id) noexcept;
+    std::shared_ptr<MeasurementData> getLatestStatistics(MeasurementType type, uint32_t device_id, uint64_t session_id) noexcept;
+
+    // the METRIC_PERF metrics of the device aggregated over the last window_ms milliseconds
+    void getPerfMetricStats(uint32_t device_id, uint32_t window_ms, std::vector<PerfMetricStat_t>& stats);
+
+    // the histograms of every sample of the metric on the device, see StatsDataHandler::getHistograms
+    void getHistograms(MeasurementType type, uint32_t device_id, std::map<uint32_t, QuantileSketch>& histograms);
+
+    // the throttle reason residencies of the device, see ThrottleReasonDataHandler::getResidencies
+    void getThrottleResidencies(uint32_t device_id, std::map<uint32_t, ThrottleResidency_t>& residencies);
+
+    // the top-down counters of each tile of the device averaged over the last window_ms milliseconds
+    void getTopdownCounters(uint32_t device_id, uint32_t window_ms, std::vector<TopdownCounters_t>& counters);
 
     void updateStatsTimestamp(uint32_t session_id, uint32_t device_id);
 
@@ -49,6 +71,32 @@ class DataHandlerManager {
 
     uint64_t getFabricStatsTimestamp(uint32_t session_id, uint32_t device_id);
 
+    JobAccounting& getJobAccounting();
+
+    AppCounterAccounting& getAppCounterAccounting();
+
+    GroupAggregation& getGroupAggregation();
+
+    /*
+      Holds back storeMeasurementData while the returned lock is owned, so
+      statistics of several devices and metrics can be read from the same
+      sampling ticks.
+    */
+    std::unique_lock<std::shared_timed_mutex> pauseStores();
+
+    /*
+      Waits at most timeout milliseconds for data stored after generation,
+      returns the current generation. Every storeMeasurementData call starts a
+      new generation.
+    */
+    uint64_t waitForUpdate(uint64_t generation, uint32_t timeout);
+
+    /*
+      Registers a listener called by storeMeasurementData once the data is
+      handled, outside of pauseStores().
+    */
+    void addListener(MeasurementListener listener);
+
     private:
     DataHandlerManager() = default;
 
@@ -62,7 +110,28 @@ class DataHandlerManager {
 
     std::map<uint32_t, std::map<uint32_t, uint64_t>> fabric_stats_session_timestamps;
 
+    JobAccounting job_accounting;
+
+    AppCounterAccounting app_counter_accounting;
+
+    GroupAggregation group_aggregation;
+
+    // the begin timestamp of sessions queried for the first time
+    uint64_t init_timestamp = 0;
+
     std::mutex mutex;
+
+    // shared by the monitor tasks storing data, exclusive for pauseStores()
+    std::shared_timed_mutex store_mutex;
+
+    uint64_t update_generation = 0;
+
+    std::mutex update_mutex;
+
+    std::condition_variable update_cv;
+
+    // replaced rather than changed when a listener is added, a store only takes a reference
+    std::shared_ptr<const std::vector<MeasurementListener>> listeners = std::make_shared<std::vector<MeasurementListener>>();
 };
 
 } // end namespace xpum
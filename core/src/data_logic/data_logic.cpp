@@ -13,12 +13,14 @@
 #include "core/core.h"
 #include "api/device_model.h"
 #include "db_persistency.h"
+#include "time_series_persistency.h"
 #include "engine_measurement_data.h"
 #include "fabric_measurement_data.h"
 #include "infrastructure/configuration.h"
 #include "infrastructure/const.h"
 #include "infrastructure/exception/ilegal_state_exception.h"
 #include "infrastructure/logger.h"
+#include "infrastructure/metric_descriptor.h"
 #include "infrastructure/utility.h"
 #include "device/gpu/gpu_device_stub.h"
 
@@ -34,7 +36,12 @@ DataLogic::~DataLogic() {
 }
 
 void DataLogic::init() {
-    p_persistency = std::make_shared<DBPersistency>();
+    if (!Configuration::PERSISTENCY_DIR.empty() && Configuration::getXPUMMode() == "xpum") {
+        XPUM_LOG_INFO("persist telemetry data in {}", Configuration::PERSISTENCY_DIR);
+        p_persistency = std::make_shared<TimeSeriesPersistency>(Configuration::PERSISTENCY_DIR);
+    } else {
+        p_persistency = std::make_shared<DBPersistency>();
+    }
     p_data_handler_manager = std::make_unique<DataHandlerManager>(p_persistency);
     p_data_handler_manager->init();
 }
@@ -43,25 +50,58 @@ void DataLogic::close() {
     if (p_data_handler_manager != nullptr) {
         p_data_handler_manager->close();
     }
+    if (p_persistency != nullptr) {
+        p_persistency->flush();
+    }
 }
 
 void DataLogic::storeMeasurementData(MeasurementType type, Timestamp_t time,
-                                     std::shared_ptr<std::map<std::string, std::shared_ptr<MeasurementData>>> datas) {
+                                     std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas) {
     if (p_data_handler_manager == nullptr) {
         throw IlegalStateException("initialization is not done!");
     }
-    p_data_handler_manager->storeMeasurementData(type, time, datas);
+    p_data_handler_manager->storeMeasurementData(type, time, std::move(datas));
 }
 
 std::shared_ptr<MeasurementData> DataLogic::getLatestData(MeasurementType type,
                                                           std::string& device_id) {
+    // the handlers keep the devices by index, the string id is only converted here
+    uint32_t index;
+    if (!Device::toIndex(device_id, index)) {
+        return nullptr;
+    }
+    return getLatestData(type, index);
+}
+
+std::shared_ptr<MeasurementData> DataLogic::getLatestData(MeasurementType type, uint32_t device_id) {
     if (p_data_handler_manager == nullptr) {
         throw IlegalStateException("initialization is not done!");
     }
     return p_data_handler_manager->getLatestData(type, device_id);
 }
 
-std::shared_ptr<MeasurementData> DataLogic::getLatestStatistics(MeasurementType type, std::string& device_id, uint64_t session_id) {
+std::unique_lock<std::shared_timed_mutex> DataLogic::pauseUpdates() {
+    if (p_data_handler_manager == nullptr) {
+        throw IlegalStateException("initialization is not done!");
+    }
+    return p_data_handler_manager->pauseStores();
+}
+
+uint64_t DataLogic::waitForUpdate(uint64_t generation, uint32_t timeout) {
+    if (p_data_handler_manager == nullptr) {
+        throw IlegalStateException("initialization is not done!");
+    }
+    return p_data_handler_manager->waitForUpdate(generation, timeout);
+}
+
+void DataLogic::addMeasurementListener(MeasurementListener listener) {
+    if (p_data_handler_manager == nullptr) {
+        throw IlegalStateException("initialization is not done!");
+    }
+    p_data_handler_manager->addListener(listener);
+}
+
+std::shared_ptr<MeasurementData> DataLogic::getLatestStatistics(MeasurementType type, uint32_t device_id, uint64_t session_id) {
     if (p_data_handler_manager == nullptr) {
         throw IlegalStateException("initialization is not done!");
     }
@@ -73,27 +113,31 @@ xpum_result_t DataLogic::getMetricsStatistics(xpum_device_id_t deviceId,
                                               uint32_t* count,
                                               uint64_t* begin,
                                               uint64_t* end,
-                                              uint64_t session_id) {
-    if (Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId)) == nullptr) {
+                                              uint64_t session_id,
+                                              bool wait_for_data,
+                                              uint64_t metrics_mask) {
+    auto p_device = Core::instance().getDeviceManager()->getDevice(deviceId);
+    if (p_device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
-    Property prop;
-    Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_SUBDEVICE, prop);
-    uint32_t num_subdevice = prop.getValueInt();
+    uint32_t num_subdevice = p_device->getPropertyLong(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_SUBDEVICE);
     if (dataList == nullptr) {
         *count = num_subdevice + 1;
         return XPUM_OK;
     }
 
-    Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS, prop);
-    std::string bdf = prop.getValue();
+    std::string bdf = p_device->getPropertyValue(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS);
 
     std::map<MeasurementType, std::shared_ptr<MeasurementData>> m_datas;
     auto metric_types = Configuration::getEnabledMetrics();
     std::vector<xpum::DeviceCapability> capabilities;
-    Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getCapability(capabilities);
+    p_device->getCapability(capabilities);
     for (auto metric = metric_types.begin(); metric != metric_types.end();) {
-        if (std::none_of(capabilities.begin(), capabilities.end(), [metric](xpum::DeviceCapability cap) { return (cap == Utility::capabilityFromMeasurementType(*metric)); })) {
+        // only the handlers of the metrics asked for are read, their sessions alone move on
+        MeasurementType type = *metric;
+        xpum_stats_type_t stats_type = Utility::xpumStatsTypeFromMeasurementType(type);
+        bool masked_out = metrics_mask != 0 && (stats_type >= XPUM_STATS_MAX || (metrics_mask & (1ULL << stats_type)) == 0);
+        if (masked_out || std::none_of(capabilities.begin(), capabilities.end(), [metric](xpum::DeviceCapability cap) { return (cap == Utility::capabilityFromMeasurementType(*metric)); })) {
             metric = metric_types.erase(metric);
         } else {
             metric++;
@@ -102,25 +146,24 @@ xpum_result_t DataLogic::getMetricsStatistics(xpum_device_id_t deviceId,
 
     auto metric_types_iter = metric_types.begin();
     bool hasDataOnDevice = false;
-    std::string device_id = std::to_string(deviceId);
     while (metric_types_iter != metric_types.end()) {
-        if (*metric_types_iter != METRIC_ENGINE_UTILIZATION && *metric_types_iter != METRIC_FABRIC_THROUGHPUT) {
+        if (*metric_types_iter != METRIC_ENGINE_UTILIZATION && *metric_types_iter != METRIC_FABRIC_THROUGHPUT && *metric_types_iter != METRIC_VF_ENGINE_UTILIZATION) {
             std::shared_ptr<MeasurementData> p_data = std::make_shared<MeasurementData>();
             auto p_pvc_idle_power = GPUDeviceStub::loadPVCIdlePowers(bdf, false);
             if (*metric_types_iter == METRIC_POWER && p_pvc_idle_power->hasDataOnDevice()) {
                 p_data = p_pvc_idle_power;
             } else {
-                p_data = getLatestStatistics(*metric_types_iter, device_id, session_id);
+                p_data = getLatestStatistics(*metric_types_iter, deviceId, session_id);
             }
             if (p_data != nullptr) {
                 hasDataOnDevice = hasDataOnDevice || p_data->hasDataOnDevice();
                 m_datas.insert(std::make_pair(*metric_types_iter, p_data));
-            } else if ((*metric_types_iter >= METRIC_RAS_ERROR_CAT_RESET && *metric_types_iter <= METRIC_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE)
-                    || (*metric_types_iter >= METRIC_EU_ACTIVE && *metric_types_iter <= METRIC_EU_IDLE)) {
+            } else if (wait_for_data && ((*metric_types_iter >= METRIC_RAS_ERROR_CAT_RESET && *metric_types_iter <= METRIC_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE)
+                    || (*metric_types_iter >= METRIC_EU_ACTIVE && *metric_types_iter <= METRIC_EU_IDLE))) {
                 auto start_time = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
                 auto end_time = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
                 while (end_time - start_time <= 30) {
-                    p_data = getLatestStatistics(*metric_types_iter, device_id, session_id);
+                    p_data = getLatestStatistics(*metric_types_iter, deviceId, session_id);
                     if (p_data != nullptr) {
                         hasDataOnDevice = hasDataOnDevice || p_data->hasDataOnDevice();
                         m_datas.insert(std::make_pair(*metric_types_iter, p_data));
@@ -158,6 +201,9 @@ xpum_result_t DataLogic::getMetricsStatistics(xpum_device_id_t deviceId,
                     stats_data.avg = measurementData->getAvg();
                     stats_data.min = measurementData->getMin();
                     stats_data.max = measurementData->getMax();
+                    stats_data.p50 = measurementData->getP50();
+                    stats_data.p90 = measurementData->getP90();
+                    stats_data.p99 = measurementData->getP99();
                     stats_data.value = measurementData->getCurrent();
                 }
                 device_stats.dataList[device_stats.count++] = stats_data;
@@ -194,6 +240,10 @@ xpum_result_t DataLogic::getMetricsStatistics(xpum_device_id_t deviceId,
                     stats_data.avg = measurementData->getSubdeviceDataAvg(i);
                     stats_data.min = measurementData->getSubdeviceDataMin(i);
                     stats_data.max = measurementData->getSubdeviceDataMax(i);
+                    auto& subdevice_data = measurementData->getSubdeviceDatas()->at(i);
+                    stats_data.p50 = subdevice_data.p50;
+                    stats_data.p90 = subdevice_data.p90;
+                    stats_data.p99 = subdevice_data.p99;
                     stats_data.value = measurementData->getSubdeviceDataCurrent(i);
                 }
                 subdevice_stats.dataList[subdevice_stats.count++] = stats_data;
@@ -209,27 +259,278 @@ xpum_result_t DataLogic::getMetricsStatistics(xpum_device_id_t deviceId,
     return XPUM_OK;
 }
 
-void DataLogic::getLatestMetrics(xpum_device_id_t deviceId,
-                                 xpum_device_metrics_t dataList[],
-                                 int* count) {
-    if (Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId)) == nullptr) {
-        return;
+namespace {
+
+// the upper limit of points of one history series
+const uint64_t MAX_METRICS_HISTORY_STEPS = 10000;
+
+struct MetricsHistoryBucket {
+    uint64_t min;
+    uint64_t max;
+    uint64_t sum;
+    uint32_t count;
+};
+
+} // namespace
+
+xpum_result_t DataLogic::getMetricsHistory(xpum_device_id_t deviceId,
+                                           xpum_stats_type_t metricsTypes[],
+                                           uint32_t metricsTypeCount,
+                                           uint64_t begin,
+                                           uint64_t end,
+                                           uint64_t step,
+                                           xpum_metrics_history_t seriesList[],
+                                           uint32_t* seriesCount,
+                                           xpum_metrics_history_point_t pointList[],
+                                           uint32_t* pointCount) {
+    if (Core::instance().getDeviceManager()->getDevice(deviceId) == nullptr) {
+        return XPUM_RESULT_DEVICE_NOT_FOUND;
+    }
+    if (p_persistency == nullptr) {
+        return XPUM_API_UNSUPPORTED;
+    }
+    if (step == 0 || end < begin || (end - begin) / step >= MAX_METRICS_HISTORY_STEPS) {
+        return XPUM_INTERVAL_INVALID;
+    }
+    uint64_t step_count = (end - begin) / step + 1;
+    bool fill = seriesList != nullptr && pointList != nullptr;
+    uint32_t series_index = 0;
+    uint32_t point_index = 0;
+    auto& metric_types = Configuration::getEnabledMetrics();
+    for (uint32_t i = 0; i < metricsTypeCount; i++) {
+        MeasurementType type = Utility::measurementTypeFromXpumStatsType(metricsTypes[i]);
+        if (type == METRIC_MAX) {
+            return XPUM_METRIC_NOT_SUPPORTED;
+        }
+        // the history left of a metric disabled since is not returned, like its statistics
+        if (metric_types.find(type) == metric_types.end()) {
+            continue;
+        }
+        // buckets and scale per subdevice, UINT32_MAX is the device level
+        std::map<uint32_t, std::vector<MetricsHistoryBucket>> buckets;
+        std::map<uint32_t, uint32_t> scales;
+        // the persistency picks the raw samples or the rollups by the step and the range kept
+        bool supported = p_persistency->queryPersistentAggregates(type, deviceId, begin, end, step,
+                                                                  [&](Timestamp_t time, uint32_t subdevice_id, uint64_t min, uint64_t max, uint64_t sum, uint64_t count, uint32_t scale) {
+            if (time < 0 || (uint64_t)time < begin || (uint64_t)time > end) {
+                return;
+            }
+            auto& series = buckets[subdevice_id];
+            if (series.empty()) {
+                series.resize(step_count, MetricsHistoryBucket{std::numeric_limits<uint64_t>::max(), 0, 0, 0});
+            }
+            auto& bucket = series[(time - begin) / step];
+            bucket.min = std::min(bucket.min, min);
+            bucket.max = std::max(bucket.max, max);
+            bucket.sum += sum;
+            bucket.count += count;
+            scales[subdevice_id] = scale;
+        });
+        if (!supported) {
+            return XPUM_API_UNSUPPORTED;
+        }
+        // device level data first, then tiles in order
+        std::vector<uint32_t> order;
+        if (buckets.find(UINT32_MAX) != buckets.end()) {
+            order.push_back(UINT32_MAX);
+        }
+        for (auto& b : buckets) {
+            if (b.first != UINT32_MAX) {
+                order.push_back(b.first);
+            }
+        }
+        for (auto subdevice_id : order) {
+            auto& series = buckets[subdevice_id];
+            if (fill && series_index >= *seriesCount) {
+                return XPUM_BUFFER_TOO_SMALL;
+            }
+            xpum_metrics_history_t history{};
+            history.deviceId = deviceId;
+            history.isTileData = subdevice_id != UINT32_MAX;
+            history.tileId = history.isTileData ? subdevice_id : -1;
+            history.metricsType = metricsTypes[i];
+            history.isCounter = Utility::isCounterMetric(type);
+            history.scale = scales[subdevice_id];
+            history.offset = point_index;
+            for (uint64_t s = 0; s < step_count; s++) {
+                auto& bucket = series[s];
+                if (bucket.count == 0) {
+                    continue;
+                }
+                if (fill) {
+                    if (point_index >= *pointCount) {
+                        return XPUM_BUFFER_TOO_SMALL;
+                    }
+                    xpum_metrics_history_point_t& point = pointList[point_index];
+                    point.timestamp = begin + s * step;
+                    point.min = bucket.min;
+                    point.max = bucket.max;
+                    point.avg = bucket.sum / bucket.count;
+                    point.count = bucket.count;
+                }
+                point_index++;
+                history.count++;
+            }
+            if (fill) {
+                seriesList[series_index] = history;
+            }
+            series_index++;
+        }
+    }
+    *seriesCount = series_index;
+    *pointCount = point_index;
+    return XPUM_OK;
+}
+
+static void fillThrottleResidency(xpum_throttle_residency_t& data, xpum_device_id_t deviceId, uint32_t subdevice_id, const ThrottleResidency_t& residency) {
+    data = xpum_throttle_residency_t{};
+    data.deviceId = deviceId;
+    data.isTileData = subdevice_id != UINT32_MAX;
+    data.tileId = data.isTileData ? subdevice_id : -1;
+    data.sampledTime = residency.sampled;
+    data.throttledTime = residency.throttled;
+    data.avgPowerCapTime = residency.reasons[THROTTLE_REASON_AVE_PWR_CAP];
+    data.burstPowerCapTime = residency.reasons[THROTTLE_REASON_BURST_PWR_CAP];
+    data.currentLimitTime = residency.reasons[THROTTLE_REASON_CURRENT_LIMIT];
+    data.thermalLimitTime = residency.reasons[THROTTLE_REASON_THERMAL_LIMIT];
+    data.psuAlertTime = residency.reasons[THROTTLE_REASON_PSU_ALERT];
+    data.swRangeTime = residency.reasons[THROTTLE_REASON_SW_RANGE];
+    data.hwRangeTime = residency.reasons[THROTTLE_REASON_HW_RANGE];
+}
+
+xpum_result_t DataLogic::getMetricsHistograms(xpum_device_id_t deviceId,
+                                              xpum_metrics_histogram_t histogramList[],
+                                              uint32_t* histogramCount,
+                                              xpum_metrics_histogram_bin_t binList[],
+                                              uint32_t* binCount) {
+    if (Core::instance().getDeviceManager()->getDevice(deviceId) == nullptr) {
+        return XPUM_RESULT_DEVICE_NOT_FOUND;
+    }
+    if (p_data_handler_manager == nullptr) {
+        throw IlegalStateException("initialization is not done!");
+    }
+    bool fill = histogramList != nullptr && binList != nullptr;
+    uint32_t histogram_index = 0;
+    uint32_t bin_index = 0;
+    std::vector<std::pair<uint64_t, uint64_t>> bins;
+    for (auto& descriptor : metric_descriptors) {
+        if (!descriptor.histogram || descriptor.stats_type == XPUM_STATS_MAX) {
+            continue;
+        }
+        std::map<uint32_t, QuantileSketch> histograms;
+        p_data_handler_manager->getHistograms(descriptor.type, deviceId, histograms);
+        if (histograms.empty()) {
+            continue;
+        }
+        auto p_latest = p_data_handler_manager->getLatestData(descriptor.type, deviceId);
+        uint32_t scale = p_latest != nullptr ? p_latest->getScale() : 1;
+        // device level data first, then tiles in order
+        std::vector<uint32_t> order;
+        if (histograms.find(UINT32_MAX) != histograms.end()) {
+            order.push_back(UINT32_MAX);
+        }
+        for (auto& h : histograms) {
+            if (h.first != UINT32_MAX) {
+                order.push_back(h.first);
+            }
+        }
+        for (auto subdevice_id : order) {
+            auto& sketch = histograms[subdevice_id];
+            sketch.getBins(bins);
+            if (fill) {
+                if (histogram_index >= *histogramCount || bin_index + bins.size() > *binCount) {
+                    return XPUM_BUFFER_TOO_SMALL;
+                }
+                xpum_metrics_histogram_t& histogram = histogramList[histogram_index];
+                histogram = xpum_metrics_histogram_t{};
+                histogram.deviceId = deviceId;
+                histogram.isTileData = subdevice_id != UINT32_MAX;
+                histogram.tileId = histogram.isTileData ? subdevice_id : -1;
+                histogram.metricsType = descriptor.stats_type;
+                histogram.scale = scale;
+                histogram.count = sketch.getCount();
+                histogram.sum = sketch.getSum();
+                histogram.offset = bin_index;
+                histogram.binCount = bins.size();
+                for (auto& bin : bins) {
+                    binList[bin_index].upperBound = bin.first;
+                    binList[bin_index].count = bin.second;
+                    bin_index++;
+                }
+            } else {
+                bin_index += bins.size();
+            }
+            histogram_index++;
+        }
+    }
+    *histogramCount = histogram_index;
+    *binCount = bin_index;
+    return XPUM_OK;
+}
+
+xpum_result_t DataLogic::getThrottleResidency(xpum_device_id_t deviceId,
+                                              xpum_throttle_residency_t dataList[],
+                                              uint32_t* count) {
+    if (Core::instance().getDeviceManager()->getDevice(deviceId) == nullptr) {
+        return XPUM_RESULT_DEVICE_NOT_FOUND;
+    }
+    if (p_data_handler_manager == nullptr) {
+        throw IlegalStateException("initialization is not done!");
+    }
+    std::map<uint32_t, ThrottleResidency_t> residencies;
+    p_data_handler_manager->getThrottleResidencies(deviceId, residencies);
+    if (dataList == nullptr) {
+        *count = residencies.size();
+        return XPUM_OK;
+    }
+    if (*count < residencies.size()) {
+        return XPUM_BUFFER_TOO_SMALL;
+    }
+    uint32_t index = 0;
+    // device level data first, then tiles in order
+    auto iter = residencies.find(UINT32_MAX);
+    if (iter != residencies.end()) {
+        fillThrottleResidency(dataList[index++], deviceId, iter->first, iter->second);
+    }
+    for (auto& entry : residencies) {
+        if (entry.first != UINT32_MAX) {
+            fillThrottleResidency(dataList[index++], deviceId, entry.first, entry.second);
+        }
     }
-    Property prop;
-    Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_SUBDEVICE, prop);
-    uint32_t num_subdevice = prop.getValueInt();
+    *count = index;
+    return XPUM_OK;
+}
+
+// the realtime metrics have no timestamp
+static inline void setMetricTimestamp(xpum_device_metric_data_t& data, uint64_t timestamp) {
+    data.timestamp = timestamp;
+}
+
+static inline void setMetricTimestamp(xpum_device_realtime_metric_t& data, uint64_t timestamp) {
+}
+
+template <typename Metrics>
+xpum_result_t DataLogic::fillLatestMetrics(xpum_device_id_t deviceId, Metrics dataList[], uint32_t capacity, uint32_t* count) {
+    typedef typename std::remove_reference<decltype(dataList[0].dataList[0])>::type Metric;
+    auto p_device = Core::instance().getDeviceManager()->getDevice(deviceId);
+    if (p_device == nullptr) {
+        return XPUM_RESULT_DEVICE_NOT_FOUND;
+    }
+    uint32_t num_subdevice = p_device->getPropertyLong(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_SUBDEVICE);
     *count = num_subdevice + 1;
     if (dataList == nullptr) {
-        return;
+        return XPUM_OK;
+    }
+    if (capacity < num_subdevice + 1) {
+        return XPUM_BUFFER_TOO_SMALL;
     }
 
-    Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS, prop);
-    std::string bdf = prop.getValue();
+    std::string bdf = p_device->getPropertyValue(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS);
 
     std::map<MeasurementType, std::shared_ptr<MeasurementData>> m_datas;
     auto metric_types = Configuration::getEnabledMetrics();
     std::vector<xpum::DeviceCapability> capabilities;
-    Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getCapability(capabilities);
+    p_device->getCapability(capabilities);
     for (auto metric = metric_types.begin(); metric != metric_types.end();) {
         if (std::none_of(capabilities.begin(), capabilities.end(), [metric](xpum::DeviceCapability cap) { return (cap == Utility::capabilityFromMeasurementType(*metric)); })) {
             metric = metric_types.erase(metric);
@@ -240,15 +541,14 @@ void DataLogic::getLatestMetrics(xpum_device_id_t deviceId,
 
     auto metric_types_iter = metric_types.begin();
     bool hasDataOnDevice = false;
-    std::string device_id = std::to_string(deviceId);
     while (metric_types_iter != metric_types.end()) {
-        if (*metric_types_iter != METRIC_ENGINE_UTILIZATION && *metric_types_iter != METRIC_FABRIC_THROUGHPUT) {
+        if (*metric_types_iter != METRIC_ENGINE_UTILIZATION && *metric_types_iter != METRIC_FABRIC_THROUGHPUT && *metric_types_iter != METRIC_VF_ENGINE_UTILIZATION) {
             std::shared_ptr<MeasurementData> m_data = std::make_shared<MeasurementData>();
             auto p_pvc_idle_power = GPUDeviceStub::loadPVCIdlePowers(bdf, false);
             if (*metric_types_iter == METRIC_POWER && p_pvc_idle_power->hasDataOnDevice(), false) {
                 m_data = p_pvc_idle_power;
             } else {
-                m_data = getLatestData(*metric_types_iter, device_id);
+                m_data = getLatestData(*metric_types_iter, deviceId);
             }
             if (m_data != nullptr) {
                 hasDataOnDevice = hasDataOnDevice || m_data->hasDataOnDevice();
@@ -259,7 +559,7 @@ void DataLogic::getLatestMetrics(xpum_device_id_t deviceId,
     }
 
     std::map<MeasurementType, std::shared_ptr<MeasurementData>>::iterator datas_iter = m_datas.begin();
-    xpum_device_metrics_t device_metrics{};
+    Metrics device_metrics{};
     device_metrics.deviceId = deviceId;
     device_metrics.isTileData = false;
     device_metrics.count = 0;
@@ -267,12 +567,12 @@ void DataLogic::getLatestMetrics(xpum_device_id_t deviceId,
         while (datas_iter != m_datas.end()) {
             auto &measurementData = datas_iter->second;
             if (measurementData->hasDataOnDevice()) {
-                xpum_device_metric_data_t metric_data;
+                Metric metric_data{};
                 MeasurementType type = datas_iter->first;
                 metric_data.metricsType = Utility::xpumStatsTypeFromMeasurementType(type);
                 metric_data.isCounter = Utility::isCounterMetric(type) ? true : false;
                 metric_data.value = measurementData->getCurrent();
-                metric_data.timestamp = measurementData->getTimestamp();
+                setMetricTimestamp(metric_data, measurementData->getTimestamp());
                 metric_data.scale = measurementData->getScale();
                 device_metrics.dataList[device_metrics.count++] = metric_data;
             }
@@ -283,7 +583,7 @@ void DataLogic::getLatestMetrics(xpum_device_id_t deviceId,
     dataList[index++] = device_metrics;
 
     for (uint32_t i = 0; i < num_subdevice; i++) {
-        xpum_device_metrics_t subdevice_metrics;
+        Metrics subdevice_metrics{};
         subdevice_metrics.deviceId = deviceId;
         subdevice_metrics.tileId = i;
         subdevice_metrics.isTileData = true;
@@ -292,12 +592,12 @@ void DataLogic::getLatestMetrics(xpum_device_id_t deviceId,
         while (datas_iter != m_datas.end()) {
             auto &measurementData = datas_iter->second;
             if (measurementData->hasSubdeviceData() && measurementData->getSubdeviceDatas()->find(i) != measurementData->getSubdeviceDatas()->end() && measurementData->getSubdeviceDataCurrent(i) != std::numeric_limits<uint64_t>::max()) {
-                xpum_device_metric_data_t metric_data;
+                Metric metric_data{};
                 MeasurementType type = datas_iter->first;
                 metric_data.metricsType = Utility::xpumStatsTypeFromMeasurementType(type);
                 metric_data.isCounter = Utility::isCounterMetric(type) ? true : false;
                 metric_data.value = measurementData->getSubdeviceDataCurrent(i);
-                metric_data.timestamp = measurementData->getTimestamp();
+                setMetricTimestamp(metric_data, measurementData->getTimestamp());
                 metric_data.scale = measurementData->getScale();
                 subdevice_metrics.dataList[subdevice_metrics.count++] = metric_data;
             }
@@ -305,6 +605,22 @@ void DataLogic::getLatestMetrics(xpum_device_id_t deviceId,
         }
         dataList[index++] = subdevice_metrics;
     }
+    return XPUM_OK;
+}
+
+void DataLogic::getLatestMetrics(xpum_device_id_t deviceId,
+                                 xpum_device_metrics_t dataList[],
+                                 int* count) {
+    uint32_t total = 0;
+    if (fillLatestMetrics(deviceId, dataList, std::numeric_limits<uint32_t>::max(), &total) != XPUM_RESULT_DEVICE_NOT_FOUND) {
+        *count = total;
+    }
+}
+
+xpum_result_t DataLogic::getLatestRealtimeMetrics(xpum_device_id_t deviceId,
+                                                  xpum_device_realtime_metrics_t dataList[],
+                                                  uint32_t* count) {
+    return fillLatestMetrics(deviceId, dataList, *count, count);
 }
 
 xpum_result_t DataLogic::getEngineStatistics(xpum_device_id_t deviceId,
@@ -313,12 +629,11 @@ xpum_result_t DataLogic::getEngineStatistics(xpum_device_id_t deviceId,
                                              uint64_t* begin,
                                              uint64_t* end,
                                              uint64_t session_id) {
-    std::string device_id = std::to_string(deviceId);
-    if (Core::instance().getDeviceManager()->getDevice(device_id) == nullptr) {
+    if (Core::instance().getDeviceManager()->getDevice(deviceId) == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
 
-    uint32_t engine_count = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getEngineCount();
+    uint32_t engine_count = Core::instance().getDeviceManager()->getDevice(deviceId)->getEngineCount();
     if (dataList == nullptr) {
         *count = engine_count;
         return XPUM_OK;
@@ -333,7 +648,7 @@ xpum_result_t DataLogic::getEngineStatistics(xpum_device_id_t deviceId,
         return XPUM_METRIC_NOT_ENABLED;
     }
     std::vector<xpum::DeviceCapability> capabilities;
-    Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getCapability(capabilities);
+    Core::instance().getDeviceManager()->getDevice(deviceId)->getCapability(capabilities);
     for (auto metric = metric_types.begin(); metric != metric_types.end();) {
         if (std::none_of(capabilities.begin(), capabilities.end(), [metric](xpum::DeviceCapability cap) { return (cap == Utility::capabilityFromMeasurementType(*metric)); })) {
             metric = metric_types.erase(metric);
@@ -346,17 +661,21 @@ xpum_result_t DataLogic::getEngineStatistics(xpum_device_id_t deviceId,
         return XPUM_METRIC_NOT_SUPPORTED;
     }
 
-    std::shared_ptr<MeasurementData> p_data = getLatestStatistics(METRIC_ENGINE_UTILIZATION, device_id, session_id);
+    std::shared_ptr<MeasurementData> p_data = getLatestStatistics(METRIC_ENGINE_UTILIZATION, deviceId, session_id);
     if (p_data == nullptr) {
         *count = 0;
         return XPUM_OK;
     }
-    auto iter = p_data->getMultiMetricsDatas()->begin();
+    auto p_engine_data = std::static_pointer_cast<EngineCollectionMeasurementData>(p_data);
+    auto multi_metrics_datas = p_data->getMultiMetricsDatas();
+    auto p_device = Core::instance().getDeviceManager()->getDevice(deviceId);
     uint32_t index = 0;
-    while (iter != p_data->getMultiMetricsDatas()->end()) {
-        auto &engineHandle = iter->first;
-        auto &measurementData = iter->second;
-        uint32_t engine_index = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getEngineIndex(engineHandle);
+    for (uint32_t i = 0; i < multi_metrics_datas->size(); i++) {
+        auto &measurementData = (*multi_metrics_datas)[i];
+        if (!measurementData.valid) {
+            continue;
+        }
+        uint32_t engine_index = p_device->getEngineIndex(p_data->getMultiMetricsSchema()->keyOf(i));
         if (engine_index != std::numeric_limits<uint32_t>::max() && measurementData.current != std::numeric_limits<uint64_t>::max()) {
             xpum_device_engine_stats_t data;
             data.isTileData = measurementData.on_subdevice;
@@ -367,7 +686,7 @@ xpum_result_t DataLogic::getEngineStatistics(xpum_device_id_t deviceId,
             data.max = measurementData.max;
             data.index = engine_index;
             data.scale = p_data->getScale();
-            data.type = Utility::toXPUMEngineType(std::static_pointer_cast<EngineCollectionMeasurementData>(p_data)->getEngineType(engineHandle));
+            data.type = Utility::toXPUMEngineType(p_engine_data->getEngineType(i));
             data.deviceId = deviceId;
             if (index >= *count) {
                 return XPUM_BUFFER_TOO_SMALL;
@@ -375,7 +694,6 @@ xpum_result_t DataLogic::getEngineStatistics(xpum_device_id_t deviceId,
             dataList[index] = data;
             ++index;
         }
-        ++iter;
     }
     *count = index;
     return XPUM_OK;
@@ -384,8 +702,7 @@ xpum_result_t DataLogic::getEngineStatistics(xpum_device_id_t deviceId,
 xpum_result_t DataLogic::getEngineUtilizations(xpum_device_id_t deviceId,
                                                xpum_device_engine_metric_t dataList[],
                                                uint32_t* count) {
-    std::string device_id = std::to_string(deviceId);
-    if (Core::instance().getDeviceManager()->getDevice(device_id) == nullptr) {
+    if (Core::instance().getDeviceManager()->getDevice(deviceId) == nullptr) {
         *count = 0;
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -397,7 +714,7 @@ xpum_result_t DataLogic::getEngineUtilizations(xpum_device_id_t deviceId,
         return XPUM_METRIC_NOT_ENABLED;
     }
     std::vector<xpum::DeviceCapability> capabilities;
-    Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getCapability(capabilities);
+    Core::instance().getDeviceManager()->getDevice(deviceId)->getCapability(capabilities);
     for (auto metric = metric_types.begin(); metric != metric_types.end();) {
         if (std::none_of(capabilities.begin(), capabilities.end(), [metric](xpum::DeviceCapability cap) { return (cap == Utility::capabilityFromMeasurementType(*metric)); })) {
             metric = metric_types.erase(metric);
@@ -410,22 +727,26 @@ xpum_result_t DataLogic::getEngineUtilizations(xpum_device_id_t deviceId,
         return XPUM_METRIC_NOT_SUPPORTED;
     }
 
-    *count = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getEngineCount();
+    *count = Core::instance().getDeviceManager()->getDevice(deviceId)->getEngineCount();
     if (dataList == nullptr) {
         return XPUM_OK;
     }
 
-    std::shared_ptr<MeasurementData> p_data = getLatestData(METRIC_ENGINE_UTILIZATION, device_id);
+    std::shared_ptr<MeasurementData> p_data = getLatestData(METRIC_ENGINE_UTILIZATION, deviceId);
     if (p_data == nullptr) {
         *count = 0;
         return XPUM_OK;
     }
-    auto iter = p_data->getMultiMetricsDatas()->begin();
+    auto p_engine_data = std::static_pointer_cast<EngineCollectionMeasurementData>(p_data);
+    auto multi_metrics_datas = p_data->getMultiMetricsDatas();
+    auto p_device = Core::instance().getDeviceManager()->getDevice(deviceId);
     uint32_t index = 0;
-    while (iter != p_data->getMultiMetricsDatas()->end()) {
-        auto &engineHandle = iter->first;
-        auto &measurementData = iter->second;
-        uint32_t engine_index = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getEngineIndex(engineHandle);
+    for (uint32_t i = 0; i < multi_metrics_datas->size(); i++) {
+        auto &measurementData = (*multi_metrics_datas)[i];
+        if (!measurementData.valid) {
+            continue;
+        }
+        uint32_t engine_index = p_device->getEngineIndex(p_data->getMultiMetricsSchema()->keyOf(i));
         if (engine_index != std::numeric_limits<uint32_t>::max()) {
             xpum_device_engine_metric_t data;
             data.isTileData = measurementData.on_subdevice;
@@ -433,14 +754,13 @@ xpum_result_t DataLogic::getEngineUtilizations(xpum_device_id_t deviceId,
             data.value = measurementData.current;
             data.index = engine_index;
             data.scale = p_data->getScale();
-            data.type = Utility::toXPUMEngineType(std::static_pointer_cast<EngineCollectionMeasurementData>(p_data)->getEngineType(engineHandle));
+            data.type = Utility::toXPUMEngineType(p_engine_data->getEngineType(i));
             if (index >= *count) {
                 return XPUM_BUFFER_TOO_SMALL;
             }
             dataList[index] = data;
             ++index;
         }
-        ++iter;
     }
     *count = index;
     return XPUM_OK;
@@ -452,8 +772,7 @@ xpum_result_t DataLogic::getFabricThroughputStatistics(xpum_device_id_t deviceId
                                                        uint64_t* begin,
                                                        uint64_t* end,
                                                        uint64_t session_id) {
-    std::string device_id = std::to_string(deviceId);
-    if (Core::instance().getDeviceManager()->getDevice(device_id) == nullptr) {
+    if (Core::instance().getDeviceManager()->getDevice(deviceId) == nullptr) {
         *count = 0;
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -464,7 +783,7 @@ xpum_result_t DataLogic::getFabricThroughputStatistics(xpum_device_id_t deviceId
         return XPUM_METRIC_NOT_ENABLED;
     }
     std::vector<xpum::DeviceCapability> capabilities;
-    Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getCapability(capabilities);
+    Core::instance().getDeviceManager()->getDevice(deviceId)->getCapability(capabilities);
     for (auto metric = metric_types.begin(); metric != metric_types.end();) {
         if (std::none_of(capabilities.begin(), capabilities.end(), [metric](xpum::DeviceCapability cap) { return (cap == Utility::capabilityFromMeasurementType(*metric)); })) {
             metric = metric_types.erase(metric);
@@ -477,27 +796,30 @@ xpum_result_t DataLogic::getFabricThroughputStatistics(xpum_device_id_t deviceId
         return XPUM_METRIC_NOT_SUPPORTED;
     }
 
-    uint32_t throughput_count = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getFabricThroughputInfoCount();
+    uint32_t throughput_count = Core::instance().getDeviceManager()->getDevice(deviceId)->getFabricThroughputInfoCount();
     if (dataList == nullptr || throughput_count == 0) {
         *count = throughput_count;
         return XPUM_OK;
     }
 
     uint32_t total = 0;
-    std::shared_ptr<MeasurementData> p_data = getLatestStatistics(METRIC_FABRIC_THROUGHPUT, device_id, session_id);
+    std::shared_ptr<MeasurementData> p_data = getLatestStatistics(METRIC_FABRIC_THROUGHPUT, deviceId, session_id);
 
     if(p_data == nullptr){
         *count = 0;
         return XPUM_OK;
     }
 
-    auto fabric_datas_iter = std::static_pointer_cast<FabricMeasurementData>(p_data)->getMultiMetricsDatas()->begin();
-    while (fabric_datas_iter != std::static_pointer_cast<FabricMeasurementData>(p_data)->getMultiMetricsDatas()->end()) {
-        FabricThroughputInfo info;
-        if (Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getFabricThroughputInfo(fabric_datas_iter->first, info)) {
+    auto multi_metrics_datas = p_data->getMultiMetricsDatas();
+    auto p_device = Core::instance().getDeviceManager()->getDevice(deviceId);
+    // the throughput infos of the valid datas, looked up once for both passes
+    std::vector<FabricThroughputInfo> infos(multi_metrics_datas->size());
+    std::vector<bool> has_infos(multi_metrics_datas->size(), false);
+    for (uint32_t i = 0; i < multi_metrics_datas->size(); i++) {
+        if ((*multi_metrics_datas)[i].valid && p_device->getFabricThroughputInfo(p_data->getMultiMetricsSchema()->keyOf(i), infos[i])) {
+            has_infos[i] = true;
             ++total;
         }
-        ++fabric_datas_iter;
     }
     if(total > *count){
         *count = total;
@@ -512,12 +834,10 @@ xpum_result_t DataLogic::getFabricThroughputStatistics(xpum_device_id_t deviceId
         return XPUM_OK;
     }
 
-    auto iter = p_data->getMultiMetricsDatas()->begin();
-    while (iter != p_data->getMultiMetricsDatas()->end()) {
-        auto &fabricId = iter->first;
-        auto &measurementData = iter->second;
-        FabricThroughputInfo info;
-        if (Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getFabricThroughputInfo(fabricId, info)) {
+    for (uint32_t i = 0; i < multi_metrics_datas->size(); i++) {
+        auto &measurementData = (*multi_metrics_datas)[i];
+        auto &info = infos[i];
+        if (has_infos[i]) {
             xpum_device_fabric_throughput_stats_t stats{};
             stats.tile_id = info.attach_id;
             std::string did = 
@@ -545,7 +865,6 @@ xpum_result_t DataLogic::getFabricThroughputStatistics(xpum_device_id_t deviceId
             dataList[index] = stats;
             ++index;
         }
-        ++iter;
     }
     *count = index;
     return XPUM_OK;
@@ -554,8 +873,7 @@ xpum_result_t DataLogic::getFabricThroughputStatistics(xpum_device_id_t deviceId
 xpum_result_t DataLogic::getFabricThroughput(xpum_device_id_t deviceId,
                                              xpum_device_fabric_throughput_metric_t dataList[],
                                              uint32_t* count) {
-    std::string device_id = std::to_string(deviceId);
-    if (Core::instance().getDeviceManager()->getDevice(device_id) == nullptr) {
+    if (Core::instance().getDeviceManager()->getDevice(deviceId) == nullptr) {
         *count = 0;
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -566,7 +884,7 @@ xpum_result_t DataLogic::getFabricThroughput(xpum_device_id_t deviceId,
         return XPUM_METRIC_NOT_ENABLED;
     }
     std::vector<xpum::DeviceCapability> capabilities;
-    Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getCapability(capabilities);
+    Core::instance().getDeviceManager()->getDevice(deviceId)->getCapability(capabilities);
     for (auto metric = metric_types.begin(); metric != metric_types.end();) {
         if (std::none_of(capabilities.begin(), capabilities.end(), [metric](xpum::DeviceCapability cap) { return (cap == Utility::capabilityFromMeasurementType(*metric)); })) {
             metric = metric_types.erase(metric);
@@ -579,26 +897,26 @@ xpum_result_t DataLogic::getFabricThroughput(xpum_device_id_t deviceId,
         return XPUM_METRIC_NOT_SUPPORTED;
     }
 
-    uint32_t throughput_count = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getFabricThroughputInfoCount();
+    uint32_t throughput_count = Core::instance().getDeviceManager()->getDevice(deviceId)->getFabricThroughputInfoCount();
     if (dataList == nullptr || *count == 0) {
         *count = throughput_count;
         return XPUM_OK;
     }
 
     uint32_t index = 0;
-    std::shared_ptr<MeasurementData> p_data = getLatestData(METRIC_FABRIC_THROUGHPUT, device_id);
+    std::shared_ptr<MeasurementData> p_data = getLatestData(METRIC_FABRIC_THROUGHPUT, deviceId);
 
     if(p_data == nullptr){
         *count = 0;
         return XPUM_OK;
     }
 
-    auto iter = p_data->getMultiMetricsDatas()->begin();
-    while (iter != p_data->getMultiMetricsDatas()->end()) {
-        auto &fabricId = iter->first;
-        auto &measurementData = iter->second;
+    auto multi_metrics_datas = p_data->getMultiMetricsDatas();
+    auto p_device = Core::instance().getDeviceManager()->getDevice(deviceId);
+    for (uint32_t i = 0; i < multi_metrics_datas->size(); i++) {
+        auto &measurementData = (*multi_metrics_datas)[i];
         FabricThroughputInfo info;
-        if (Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getFabricThroughputInfo(fabricId, info)) {
+        if (measurementData.valid && p_device->getFabricThroughputInfo(p_data->getMultiMetricsSchema()->keyOf(i), info)) {
             xpum_device_fabric_throughput_metric_t stats;
             stats.tile_id = info.attach_id;
             std::string did = 
@@ -623,7 +941,6 @@ xpum_result_t DataLogic::getFabricThroughput(xpum_device_id_t deviceId,
             dataList[index] = stats;
             ++index;
         }
-        ++iter;
     }
     *count = index;
     return XPUM_OK;
@@ -632,41 +949,161 @@ xpum_result_t DataLogic::getFabricThroughput(xpum_device_id_t deviceId,
 bool DataLogic::getFabricLinkInfo(xpum_device_id_t deviceId,
                                   FabricLinkInfo info[],
                                   uint32_t* count) {
-    std::string device_id = std::to_string(deviceId);
-    if (Core::instance().getDeviceManager()->getDevice(device_id) == nullptr) {
+    if (Core::instance().getDeviceManager()->getDevice(deviceId) == nullptr) {
         return false;
     }
 
-    uint32_t index = 0;
-    auto fabric_throughput_info = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getFabricThroughputIDS();
-    auto attach_iter = fabric_throughput_info.begin();
-    while (attach_iter != fabric_throughput_info.end()) {
-        auto remote_fabric_iter = attach_iter->second.begin();
-        while (remote_fabric_iter != attach_iter->second.end()) {
-            auto remote_attach_iter = remote_fabric_iter->second.begin();
-            while (remote_attach_iter != remote_fabric_iter->second.end()) {
-                if (info != nullptr) {
-                    FabricLinkInfo link;
-                    link.tile_id = attach_iter->first;
-                    std::string did = Core::instance().getDeviceManager(
-                            )->getDeviceIDByFabricID(remote_fabric_iter->first);
-                    if (did.empty() == true) {
-                        return false;
-                    } else {
-                        link.remote_device_id = std::stoi(did);
-                    }
-                    link.remote_tile_id = remote_attach_iter->first;
-                    info[index] = link;
+    // the links are kept by the device manager, they are not resolved for each query
+    std::vector<FabricLinkInfo> links;
+    if (!Core::instance().getDeviceManager()->getFabricLinks(std::to_string(deviceId), links)) {
+        return false;
+    }
+    if (info != nullptr) {
+        std::copy(links.begin(), links.end(), info);
+    }
+    *count = links.size();
+    return true;
+}
+
+struct DerivedStatsRule {
+    xpum_stats_type_t type;
+    bool is_accumulated;
+    bool is_sum;
+};
+
+static const std::vector<DerivedStatsRule> tile_to_device_rules = {
+    {XPUM_STATS_POWER, false, true},
+    {XPUM_STATS_RAS_ERROR_CAT_RESET, true, true},
+    {XPUM_STATS_RAS_ERROR_CAT_PROGRAMMING_ERRORS, true, true},
+    {XPUM_STATS_RAS_ERROR_CAT_DRIVER_ERRORS, true, true},
+    {XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE, true, true},
+    {XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE, true, true},
+    {XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE, true, true},
+    {XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE, true, true},
+    {XPUM_STATS_MEMORY_UTILIZATION, false, false},
+    {XPUM_STATS_MEMORY_BANDWIDTH, false, false},
+    {XPUM_STATS_GPU_UTILIZATION, false, false}};
+
+static const std::vector<DerivedStatsRule> device_to_card_rules = {
+    {XPUM_STATS_POWER, false, true}};
+
+// the aggregated field of the data in the scale of the sum, false if the data does not have the field
+static bool derivedStatsSource(const DerivedStatsRule& rule, const xpum_device_stats_data_t& data, uint32_t scale, uint64_t& value) {
+    if (rule.is_accumulated != data.isCounter) {
+        return false;
+    }
+    value = rule.is_accumulated ? data.accumulated : data.avg;
+    uint32_t data_scale = data.scale > 0 ? data.scale : 1;
+    if (data_scale != scale) {
+        value = (uint64_t)(value * 1.0 * scale / data_scale);
+    }
+    return true;
+}
+
+static const xpum_device_stats_data_t* findStatsData(const xpum_device_stats_t& stats, xpum_stats_type_t type) {
+    for (int i = 0; i < stats.count; i++) {
+        if (stats.dataList[i].metricsType == type) {
+            return &stats.dataList[i];
+        }
+    }
+    return nullptr;
+}
+
+void DataLogic::getDerivedStatistics(const std::vector<xpum_device_stats_t>& stats,
+                                     std::vector<DerivedStats>& derived) {
+    derived.clear();
+    std::map<xpum_device_id_t, const xpum_device_stats_t*> device_levels;
+    std::map<xpum_device_id_t, std::vector<const xpum_device_stats_t*>> tile_levels;
+    for (auto& s : stats) {
+        if (s.isTileData) {
+            tile_levels[s.deviceId].push_back(&s);
+        } else {
+            device_levels[s.deviceId] = &s;
+        }
+    }
+
+    // the device level values the cards are aggregated from, the device level data or the derived ones
+    std::map<xpum_device_id_t, std::map<xpum_stats_type_t, std::pair<uint64_t, uint32_t>>> device_values;
+    for (auto& device : device_levels) {
+        for (auto& rule : device_to_card_rules) {
+            const xpum_device_stats_data_t* data = findStatsData(*device.second, rule.type);
+            uint64_t value;
+            uint32_t scale = data != nullptr && data->scale > 0 ? data->scale : 1;
+            if (data != nullptr && derivedStatsSource(rule, *data, scale, value)) {
+                device_values[device.first][rule.type] = std::make_pair(value, scale);
+            }
+        }
+    }
+
+    for (auto& tiles : tile_levels) {
+        auto device_iter = device_levels.find(tiles.first);
+        for (auto& rule : tile_to_device_rules) {
+            if (device_iter != device_levels.end() && findStatsData(*device_iter->second, rule.type) != nullptr) {
+                continue;
+            }
+            DerivedStats d{false, (uint32_t)tiles.first, rule.type, rule.is_accumulated, rule.is_sum, 0, 0};
+            uint32_t count = 0;
+            for (auto tile : tiles.second) {
+                const xpum_device_stats_data_t* data = findStatsData(*tile, rule.type);
+                if (data == nullptr) {
+                    continue;
+                }
+                if (count == 0) {
+                    d.scale = data->scale > 0 ? data->scale : 1;
                 }
-                ++index;
-                ++remote_attach_iter;
+                uint64_t value;
+                if (derivedStatsSource(rule, *data, d.scale, value)) {
+                    d.value += value;
+                    count++;
+                }
+            }
+            if (count == 0) {
+                continue;
             }
-            ++remote_fabric_iter;
+            if (!rule.is_sum) {
+                d.value /= count;
+            }
+            derived.push_back(d);
+            device_values[tiles.first][rule.type] = std::make_pair(d.value, d.scale);
+        }
+    }
+
+    std::map<xpum_group_id_t, std::vector<xpum_device_id_t>> cards;
+    for (auto& device : device_values) {
+        xpum_group_id_t card_id;
+        if (Core::instance().getGroupManager()->getCardId(device.first, &card_id)) {
+            cards[card_id].push_back(device.first);
+        }
+    }
+    for (auto& card : cards) {
+        for (auto& rule : device_to_card_rules) {
+            DerivedStats d{true, card.first, rule.type, rule.is_accumulated, rule.is_sum, 0, 0};
+            uint32_t count = 0;
+            for (auto device_id : card.second) {
+                auto& values = device_values[device_id];
+                auto value_iter = values.find(rule.type);
+                if (value_iter == values.end()) {
+                    continue;
+                }
+                uint64_t value = value_iter->second.first;
+                uint32_t scale = value_iter->second.second;
+                if (count == 0) {
+                    d.scale = scale;
+                } else if (scale != d.scale) {
+                    value = (uint64_t)(value * 1.0 * d.scale / scale);
+                }
+                d.value += value;
+                count++;
+            }
+            if (count == 0) {
+                continue;
+            }
+            if (!rule.is_sum) {
+                d.value /= count;
+            }
+            derived.push_back(d);
         }
-        ++attach_iter;
     }
-    *count = index;
-    return true;
 }
 
 void DataLogic::updateStatsTimestamp(uint32_t session_id, uint32_t device_id) {
@@ -711,4 +1148,115 @@ uint64_t DataLogic::getFabricStatsTimestamp(uint32_t session_id, uint32_t device
     return p_data_handler_manager->getFabricStatsTimestamp(session_id, device_id);
 }
 
+xpum_result_t DataLogic::openJobWindow(const std::string& job_id, const std::vector<xpum_device_id_t>& device_ids) {
+    if (p_data_handler_manager == nullptr) {
+        throw IlegalStateException("initialization is not done!");
+    }
+    return p_data_handler_manager->getJobAccounting().openJobWindow(job_id, device_ids);
+}
+
+xpum_result_t DataLogic::getPerfMetrics(xpum_device_id_t deviceId, uint32_t windowMs, xpum_perf_metric_t dataList[], uint32_t* count) {
+    if (p_data_handler_manager == nullptr) {
+        throw IlegalStateException("initialization is not done!");
+    }
+    if (Core::instance().getDeviceManager()->getDevice(deviceId) == nullptr) {
+        *count = 0;
+        return XPUM_RESULT_DEVICE_NOT_FOUND;
+    }
+    auto& metric_types = Configuration::getEnabledMetrics();
+    if (metric_types.find(METRIC_PERF) == metric_types.end()) {
+        *count = 0;
+        return XPUM_METRIC_NOT_ENABLED;
+    }
+
+    std::vector<PerfMetricStat_t> stats;
+    p_data_handler_manager->getPerfMetricStats(deviceId, windowMs, stats);
+    if (dataList == nullptr) {
+        *count = stats.size();
+        return XPUM_OK;
+    }
+    if (*count < stats.size()) {
+        *count = stats.size();
+        return XPUM_BUFFER_TOO_SMALL;
+    }
+    for (size_t i = 0; i < stats.size(); i++) {
+        auto& data = dataList[i];
+        data.tileId = stats[i].tile_id;
+        strncpy(data.groupName, stats[i].group_name.c_str(), XPUM_MAX_STR_LENGTH - 1);
+        data.groupName[XPUM_MAX_STR_LENGTH - 1] = 0;
+        strncpy(data.metricName, stats[i].metric_name.c_str(), XPUM_MAX_STR_LENGTH - 1);
+        data.metricName[XPUM_MAX_STR_LENGTH - 1] = 0;
+        data.current = stats[i].current;
+        data.average = stats[i].average;
+        data.min = stats[i].min;
+        data.max = stats[i].max;
+        data.sampleCount = stats[i].count;
+        data.activeRatio = stats[i].active_ratio;
+    }
+    *count = stats.size();
+    return XPUM_OK;
+}
+
+xpum_result_t DataLogic::getTopdownCounters(xpum_device_id_t deviceId, uint32_t windowMs, std::vector<TopdownCounters_t>& counters) {
+    if (p_data_handler_manager == nullptr) {
+        throw IlegalStateException("initialization is not done!");
+    }
+    counters.clear();
+    if (Core::instance().getDeviceManager()->getDevice(deviceId) == nullptr) {
+        return XPUM_RESULT_DEVICE_NOT_FOUND;
+    }
+    auto& metric_types = Configuration::getEnabledMetrics();
+    if (metric_types.find(METRIC_PERF) == metric_types.end()) {
+        return XPUM_METRIC_NOT_ENABLED;
+    }
+    p_data_handler_manager->getTopdownCounters(deviceId, windowMs, counters);
+    return XPUM_OK;
+}
+
+xpum_result_t DataLogic::getJobWindowStats(const std::string& job_id, xpum_job_window_stats_t stats[], uint32_t* count, bool close) {
+    if (p_data_handler_manager == nullptr) {
+        throw IlegalStateException("initialization is not done!");
+    }
+    return p_data_handler_manager->getJobAccounting().getJobWindowStats(job_id, stats, count, close);
+}
+
+xpum_result_t DataLogic::getJobWindowProcessEnergy(const std::string& job_id, xpum_job_process_energy_t energies[], uint32_t* count) {
+    if (p_data_handler_manager == nullptr) {
+        throw IlegalStateException("initialization is not done!");
+    }
+    return p_data_handler_manager->getJobAccounting().getJobWindowProcessEnergy(job_id, energies, count);
+}
+
+xpum_result_t DataLogic::getAppCounterEfficiency(xpum_device_id_t deviceId, xpum_app_counter_efficiency_t dataList[], uint32_t* count) {
+    if (p_data_handler_manager == nullptr) {
+        throw IlegalStateException("initialization is not done!");
+    }
+    if (Core::instance().getDeviceManager()->getDevice(deviceId) == nullptr) {
+        *count = 0;
+        return XPUM_RESULT_DEVICE_NOT_FOUND;
+    }
+    return p_data_handler_manager->getAppCounterAccounting().getEfficiency(deviceId, dataList, count);
+}
+
+void DataLogic::setGroupDevices(xpum_group_id_t group_id, const std::vector<xpum_device_id_t>& device_ids) {
+    if (p_data_handler_manager == nullptr) {
+        throw IlegalStateException("initialization is not done!");
+    }
+    p_data_handler_manager->getGroupAggregation().setGroupDevices(group_id, device_ids);
+}
+
+void DataLogic::removeGroup(xpum_group_id_t group_id) {
+    if (p_data_handler_manager == nullptr) {
+        throw IlegalStateException("initialization is not done!");
+    }
+    p_data_handler_manager->getGroupAggregation().removeGroup(group_id);
+}
+
+xpum_result_t DataLogic::getGroupMetrics(xpum_group_id_t group_id, xpum_group_metric_data_t data_list[], uint32_t* count) {
+    if (p_data_handler_manager == nullptr) {
+        throw IlegalStateException("initialization is not done!");
+    }
+    return p_data_handler_manager->getGroupAggregation().getGroupMetrics(group_id, data_list, count);
+}
+
 } // end namespace xpum
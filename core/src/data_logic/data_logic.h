@@ -31,14 +31,37 @@ class DataLogic : public DataLogicInterface {
     void storeMeasurementData(
         MeasurementType type,
         Timestamp_t time,
-        std::shared_ptr<std::map<std::string, std::shared_ptr<MeasurementData>>> datas) override;
+        std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas) override;
 
     xpum_result_t getMetricsStatistics(xpum_device_id_t device_id,
                                        xpum_device_stats_t data_list[],
                                        uint32_t* count,
                                        uint64_t* begin,
                                        uint64_t* end,
-                                       uint64_t session_id);
+                                       uint64_t session_id,
+                                       bool wait_for_data = true,
+                                       uint64_t metrics_mask = 0);
+
+    xpum_result_t getMetricsHistory(xpum_device_id_t device_id,
+                                    xpum_stats_type_t metrics_types[],
+                                    uint32_t metrics_type_count,
+                                    uint64_t begin,
+                                    uint64_t end,
+                                    uint64_t step,
+                                    xpum_metrics_history_t series_list[],
+                                    uint32_t* series_count,
+                                    xpum_metrics_history_point_t point_list[],
+                                    uint32_t* point_count);
+
+    xpum_result_t getMetricsHistograms(xpum_device_id_t device_id,
+                                       xpum_metrics_histogram_t histogram_list[],
+                                       uint32_t* histogram_count,
+                                       xpum_metrics_histogram_bin_t bin_list[],
+                                       uint32_t* bin_count);
+
+    xpum_result_t getThrottleResidency(xpum_device_id_t device_id,
+                                       xpum_throttle_residency_t data_list[],
+                                       uint32_t* count);
 
     xpum_result_t getEngineStatistics(xpum_device_id_t device_id,
                                       xpum_device_engine_stats_t data_list[],
@@ -66,10 +89,24 @@ class DataLogic : public DataLogicInterface {
                           xpum_device_metrics_t dataList[],
                           int* count);
 
+    // the latest metrics of the device and its tiles written to dataList in one pass,
+    // XPUM_BUFFER_TOO_SMALL if *count is less than the tiles and the device
+    xpum_result_t getLatestRealtimeMetrics(xpum_device_id_t deviceId,
+                                           xpum_device_realtime_metrics_t dataList[],
+                                           uint32_t* count);
+
     xpum_result_t getEngineUtilizations(xpum_device_id_t deviceId,
                                         xpum_device_engine_metric_t dataList[],
                                         uint32_t* count);
 
+    /*
+      The tile to device and device to card aggregations of stats, which
+      holds the device and tile level statistics of devices read from the
+      same ticks.
+    */
+    void getDerivedStatistics(const std::vector<xpum_device_stats_t>& stats,
+                              std::vector<DerivedStats>& derived);
+
     void updateStatsTimestamp(uint32_t session_id, uint32_t device_id);
 
     uint64_t getStatsTimestamp(uint32_t session_id, uint32_t device_id);
@@ -82,12 +119,44 @@ class DataLogic : public DataLogicInterface {
 
     uint64_t getFabricStatsTimestamp(uint32_t session_id, uint32_t device_id);
 
-   private:
+    xpum_result_t openJobWindow(const std::string& job_id, const std::vector<xpum_device_id_t>& device_ids);
+
+    xpum_result_t getJobWindowStats(const std::string& job_id, xpum_job_window_stats_t stats[], uint32_t* count, bool close);
+
+    xpum_result_t getJobWindowProcessEnergy(const std::string& job_id, xpum_job_process_energy_t energies[], uint32_t* count);
+
+    xpum_result_t getAppCounterEfficiency(xpum_device_id_t deviceId, xpum_app_counter_efficiency_t dataList[], uint32_t* count);
+
+    void setGroupDevices(xpum_group_id_t group_id, const std::vector<xpum_device_id_t>& device_ids);
+
+    void removeGroup(xpum_group_id_t group_id);
+
+    xpum_result_t getGroupMetrics(xpum_group_id_t group_id, xpum_group_metric_data_t data_list[], uint32_t* count);
+
+    xpum_result_t getPerfMetrics(xpum_device_id_t deviceId, uint32_t windowMs, xpum_perf_metric_t dataList[], uint32_t* count);
+
+    xpum_result_t getTopdownCounters(xpum_device_id_t deviceId, uint32_t windowMs, std::vector<TopdownCounters_t>& counters);
+
     std::shared_ptr<MeasurementData> getLatestData(MeasurementType type, 
         std::string& device_id);
 
+    std::shared_ptr<MeasurementData> getLatestData(MeasurementType type, uint32_t device_id);
+
+    std::unique_lock<std::shared_timed_mutex> pauseUpdates() override;
+
+    uint64_t waitForUpdate(uint64_t generation, uint32_t timeout) override;
+
+    void addMeasurementListener(MeasurementListener listener) override;
+
+   private:
+
     std::shared_ptr<MeasurementData> getLatestStatistics(MeasurementType type, 
-        std::string& device_id, uint64_t session_id);
+        uint32_t device_id, uint64_t session_id);
+
+    // the latest metrics of the device in xpum_device_metrics_t or xpum_device_realtime_metrics_t,
+    // *count is set to the entries of the device and dataList is filled if it has capacity entries
+    template <typename Metrics>
+    xpum_result_t fillLatestMetrics(xpum_device_id_t deviceId, Metrics dataList[], uint32_t capacity, uint32_t* count);
 
 
     std::unique_ptr<DataHandlerManager> p_data_handler_manager;
@@ -8,38 +8,73 @@
 
 #include <map>
 #include <deque>
+#include <functional>
+#include <shared_mutex>
 
 #include "infrastructure/const.h"
+#include "infrastructure/device_index_map.h"
 #include "infrastructure/measurement_data.h"
 #include "infrastructure/measurement_type.h"
+#include "infrastructure/topdown_analysis.h"
 #include "infrastructure/init_close_interface.h"
 #include "../include/xpum_structs.h"
 #include "api/internal_api_structs.h"
 
 namespace xpum {
 
+/*
+  Called after the data of a storeMeasurementData call is handled, the latest
+  data of the devices in datas can then be read by getLatestData.
+*/
+typedef std::function<void(MeasurementType type,
+                           std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas)>
+    MeasurementListener;
+
 class DataLogicInterface : public InitCloseInterface {
     public:
         virtual ~DataLogicInterface(){};
         virtual void storeMeasurementData(
                 MeasurementType type,
                 Timestamp_t time,
-                std::shared_ptr<std::map<std::string, std::shared_ptr<MeasurementData>>> datas) = 0;
+                std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas) = 0;
         virtual xpum_result_t getMetricsStatistics(xpum_device_id_t deviceId,
                 xpum_device_stats_t dataList[],
                 uint32_t *count,
                 uint64_t *begin,
                 uint64_t *end,
-                uint64_t session_id) = 0;
+                uint64_t session_id,
+                bool wait_for_data = true,
+                uint64_t metrics_mask = 0) = 0;
         virtual xpum_result_t getEngineStatistics(xpum_device_id_t deviceId,
                 xpum_device_engine_stats_t dataList[],
                 uint32_t *count,
                 uint64_t *begin,
                 uint64_t *end,
                 uint64_t session_id) = 0;
+        virtual xpum_result_t getMetricsHistory(xpum_device_id_t deviceId,
+                xpum_stats_type_t metricsTypes[],
+                uint32_t metricsTypeCount,
+                uint64_t begin,
+                uint64_t end,
+                uint64_t step,
+                xpum_metrics_history_t seriesList[],
+                uint32_t *seriesCount,
+                xpum_metrics_history_point_t pointList[],
+                uint32_t *pointCount) = 0;
+        virtual xpum_result_t getMetricsHistograms(xpum_device_id_t deviceId,
+                xpum_metrics_histogram_t histogramList[],
+                uint32_t *histogramCount,
+                xpum_metrics_histogram_bin_t binList[],
+                uint32_t *binCount) = 0;
+        virtual xpum_result_t getThrottleResidency(xpum_device_id_t deviceId,
+                xpum_throttle_residency_t dataList[],
+                uint32_t *count) = 0;
         virtual void getLatestMetrics(xpum_device_id_t deviceId,
                 xpum_device_metrics_t dataList[],
                 int *count) = 0;
+        virtual xpum_result_t getLatestRealtimeMetrics(xpum_device_id_t deviceId,
+                xpum_device_realtime_metrics_t dataList[],
+                uint32_t *count) = 0;
         virtual xpum_result_t getEngineUtilizations(xpum_device_id_t deviceId,
                 xpum_device_engine_metric_t dataList[],
                 uint32_t *count) = 0;
@@ -55,12 +90,30 @@ class DataLogicInterface : public InitCloseInterface {
         virtual bool getFabricLinkInfo(xpum_device_id_t deviceId,
                 FabricLinkInfo info[],
                 uint32_t *count) = 0;
+        virtual void getDerivedStatistics(const std::vector<xpum_device_stats_t>& stats,
+                std::vector<DerivedStats>& derived) = 0;
         virtual void updateStatsTimestamp(uint32_t session_id, uint32_t device_id) = 0;
         virtual uint64_t getStatsTimestamp(uint32_t session_id, uint32_t device_id) = 0;
         virtual void updateEngineStatsTimestamp(uint32_t session_id, uint32_t device_id) = 0;
         virtual uint64_t getEngineStatsTimestamp(uint32_t session_id, uint32_t device_id) = 0;
         virtual void updateFabricStatsTimestamp(uint32_t session_id, uint32_t device_id) = 0;
         virtual uint64_t getFabricStatsTimestamp(uint32_t session_id, uint32_t device_id) = 0;
+        virtual xpum_result_t openJobWindow(const std::string& job_id, const std::vector<xpum_device_id_t>& device_ids) = 0;
+        virtual xpum_result_t getJobWindowStats(const std::string& job_id, xpum_job_window_stats_t stats[], uint32_t* count, bool close) = 0;
+        virtual xpum_result_t getJobWindowProcessEnergy(const std::string& job_id, xpum_job_process_energy_t energies[], uint32_t* count) = 0;
+        virtual xpum_result_t getAppCounterEfficiency(xpum_device_id_t deviceId, xpum_app_counter_efficiency_t dataList[], uint32_t* count) = 0;
+        virtual void setGroupDevices(xpum_group_id_t group_id, const std::vector<xpum_device_id_t>& device_ids) = 0;
+        virtual void removeGroup(xpum_group_id_t group_id) = 0;
+        virtual xpum_result_t getGroupMetrics(xpum_group_id_t group_id, xpum_group_metric_data_t data_list[], uint32_t* count) = 0;
+        virtual std::shared_ptr<MeasurementData> getLatestData(MeasurementType type,
+                std::string& device_id) = 0;
+        // the same by the device index, Device::getIndex(), without converting the id
+        virtual std::shared_ptr<MeasurementData> getLatestData(MeasurementType type, uint32_t device_id) = 0;
+        virtual xpum_result_t getPerfMetrics(xpum_device_id_t deviceId, uint32_t windowMs, xpum_perf_metric_t dataList[], uint32_t* count) = 0;
+        virtual xpum_result_t getTopdownCounters(xpum_device_id_t deviceId, uint32_t windowMs, std::vector<TopdownCounters_t>& counters) = 0;
+        virtual std::unique_lock<std::shared_timed_mutex> pauseUpdates() = 0;
+        virtual uint64_t waitForUpdate(uint64_t generation, uint32_t timeout) = 0;
+        virtual void addMeasurementListener(MeasurementListener listener) = 0;
 };
 
 } // end namespace xpum
@@ -12,7 +12,7 @@ namespace xpum {
 
 void DBPersistency::storeData2PersistentStorage(
     MeasurementType type, Timestamp_t time,
-    std::map<std::string, std::shared_ptr<MeasurementData>> &datas) {
+    DeviceIndexMap<std::shared_ptr<MeasurementData>> &datas) {
     XPUM_LOG_TRACE("received monitor data, type: {}", type);
 }
 
@@ -16,7 +16,7 @@ class DBPersistency : public Persistency {
     virtual void storeData2PersistentStorage(
         MeasurementType type,
         Timestamp_t time,
-        std::map<std::string, std::shared_ptr<MeasurementData>>& datas) override;
+        DeviceIndexMap<std::shared_ptr<MeasurementData>>& datas) override;
 };
 
 } // end namespace xpum
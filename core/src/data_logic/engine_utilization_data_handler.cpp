@@ -25,38 +25,36 @@ EngineUtilizationDataHandler::~EngineUtilizationDataHandler() {
 
 void EngineUtilizationDataHandler::calculateData(std::shared_ptr<SharedData>& p_data) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    std::map<std::string, std::shared_ptr<MeasurementData>>::iterator iter = p_data->getData().begin();
+    DeviceIndexMap<std::shared_ptr<MeasurementData>>::iterator iter = p_data->getData().begin();
     while (iter != p_data->getData().end()) {
         //iter->first is deviceId and iter->second is MeasurementData
         auto pre_iter = p_preData->getData().find(iter->first);
         if (pre_iter != p_preData->getData().end()) {
-            auto cur_engine_datas = std::static_pointer_cast<EngineCollectionMeasurementData>(iter->second)->getEngineRawDatas();
-            //pre_iter->second is MeasurementData
-            auto pre_engine_datas = std::static_pointer_cast<EngineCollectionMeasurementData>(pre_iter->second)->getEngineRawDatas();
-            auto cur_engine_datas_iter = cur_engine_datas->begin();
-            while (cur_engine_datas_iter != cur_engine_datas->end()) {
-                auto &engineHandle = cur_engine_datas_iter->first;
-                auto &engineRawData = cur_engine_datas_iter->second;
-                auto pre_engine_datas_iter = pre_engine_datas->find(
-                        engineHandle);
-                if (pre_engine_datas_iter != pre_engine_datas->end()) {
+            auto p_cur = std::static_pointer_cast<EngineCollectionMeasurementData>(iter->second);
+            auto p_pre = std::static_pointer_cast<EngineCollectionMeasurementData>(pre_iter->second);
+            // both samples are indexed by the engine schema of the device
+            if (p_cur->getMultiMetricsSchema() == p_pre->getMultiMetricsSchema()) {
+                auto &cur_engine_datas = p_cur->getEngineRawDatas();
+                auto &pre_engine_datas = p_pre->getEngineRawDatas();
+                for (uint32_t i = 0; i < cur_engine_datas.size() && i < pre_engine_datas.size(); i++) {
+                    auto &engineRawData = cur_engine_datas[i];
+                    if (!engineRawData.valid || !pre_engine_datas[i].valid) {
+                        continue;
+                    }
                     auto cur_active_time = engineRawData.raw_active_time;
                     auto cur_timestamp = engineRawData.raw_timestamp;
-                    // pre_engine_datas_iter->second is EngRawData_t 
-                    auto pre_active_time = pre_engine_datas_iter->second.raw_active_time;
-                    auto pre_timestamp = pre_engine_datas_iter->second.raw_timestamp;
+                    auto pre_active_time = pre_engine_datas[i].raw_active_time;
+                    auto pre_timestamp = pre_engine_datas[i].raw_timestamp;
                     if (cur_timestamp - pre_timestamp != 0) {
                         uint64_t val = Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * 100 * (cur_active_time - pre_active_time) / (cur_timestamp - pre_timestamp);
                         if (val > Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * 100) {
                             val = Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * 100;
                         }
-                        std::static_pointer_cast<EngineCollectionMeasurementData>(iter->second)->addSingleMeasurementData(engineHandle, engineRawData.on_subdevice, engineRawData.subdevice_id);
-                        std::static_pointer_cast<EngineCollectionMeasurementData>(iter->second)->setDataCur(engineHandle, val);
-                        iter->second->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
+                        p_cur->addSingleMeasurementData(i, engineRawData.on_subdevice, engineRawData.subdevice_id);
+                        p_cur->setDataCur(i, val);
+                        p_cur->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
                     }
                 }
-
-                ++cur_engine_datas_iter;
             }
         }
         ++iter;
@@ -25,79 +25,63 @@ FabricThroughputDataHandler::~FabricThroughputDataHandler() {
 
 void FabricThroughputDataHandler::calculateData(std::shared_ptr<SharedData>& p_data) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    std::map<std::string, std::shared_ptr<MeasurementData>>::iterator iter = p_data->getData().begin();
+    DeviceIndexMap<std::shared_ptr<MeasurementData>>::iterator iter = p_data->getData().begin();
     while (iter != p_data->getData().end()) {
         auto &deviceId = iter->first;
-        auto &measurementData = iter->second;
         auto pre_iter = p_preData->getData().find(deviceId);
-        if (pre_iter != p_preData->getData().end()) {
-            std::map<uint64_t, uint64_t> rx_vals;
-            std::map<uint64_t, uint64_t> tx_vals;
-            std::map<uint64_t, uint64_t> rx_counter_vals;
-            std::map<uint64_t, uint64_t> tx_counter_vals;
-            //iter->second and pre_iter->second is MeasurementData
-            auto cur_raw_datas = std::static_pointer_cast<FabricMeasurementData>(iter->second)->getFabricRawDatas();
-            auto pre_raw_datas = std::static_pointer_cast<FabricMeasurementData>(pre_iter->second)->getFabricRawDatas();
-            auto cur_raw_datas_iter = cur_raw_datas->begin();
-            while (cur_raw_datas_iter != cur_raw_datas->end()) {
-                auto &fpHandle = cur_raw_datas_iter->first;
-                auto pre_raw_datas_iter = pre_raw_datas->find(fpHandle);
-                if (pre_raw_datas_iter != pre_raw_datas->end()) {
-                    //cur_raw_datas_iter->second and 
-                    //pre_raw_datas_iter->second is FabricRawData_t
-                    auto cur_timestamp = cur_raw_datas_iter->second.timestamp;
-                    auto cur_rx_counter = cur_raw_datas_iter->second.rx_counter;
-                    auto cur_tx_counter = cur_raw_datas_iter->second.tx_counter;
-                    auto pre_timestamp = pre_raw_datas_iter->second.timestamp;
-                    auto pre_rx_counter = pre_raw_datas_iter->second.rx_counter;
-                    auto pre_tx_counter = pre_raw_datas_iter->second.tx_counter;
-                    if (cur_timestamp - pre_timestamp != 0) {
-                        uint64_t rx_val = Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * 1000000 * (cur_rx_counter - pre_rx_counter) / (cur_timestamp - pre_timestamp);
-                        uint64_t tx_val = Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * 1000000 * (cur_tx_counter - pre_tx_counter) / (cur_timestamp - pre_timestamp);
-                        rx_vals[fpHandle] = rx_val;
-                        tx_vals[fpHandle] = tx_val;
-                        p_data->getData()[deviceId]->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
-                    }
-                    rx_counter_vals[fpHandle] = cur_rx_counter;
-                    tx_counter_vals[fpHandle] = cur_tx_counter;
+        auto p_device = Core::instance().getDeviceManager()->getDevice(deviceId);
+        auto p_cur = std::static_pointer_cast<FabricMeasurementData>(iter->second);
+        auto p_pre = pre_iter != p_preData->getData().end() ? std::static_pointer_cast<FabricMeasurementData>(pre_iter->second) : nullptr;
+        // both samples are indexed by the fabric port schema of the device
+        if (p_pre != nullptr && p_device != nullptr && p_cur->getPortSchema() == p_pre->getPortSchema()) {
+            //The vector index is the fabric port schema index
+            auto &cur_raw_datas = p_cur->getFabricRawDatas();
+            auto &pre_raw_datas = p_pre->getFabricRawDatas();
+            std::vector<uint64_t> rx_vals(cur_raw_datas.size(), 0);
+            std::vector<uint64_t> tx_vals(cur_raw_datas.size(), 0);
+            std::vector<uint64_t> rx_counter_vals(cur_raw_datas.size(), 0);
+            std::vector<uint64_t> tx_counter_vals(cur_raw_datas.size(), 0);
+            for (uint32_t i = 0; i < cur_raw_datas.size() && i < pre_raw_datas.size(); i++) {
+                if (!cur_raw_datas[i].valid || !pre_raw_datas[i].valid) {
+                    continue;
+                }
+                auto cur_timestamp = cur_raw_datas[i].timestamp;
+                auto cur_rx_counter = cur_raw_datas[i].rx_counter;
+                auto cur_tx_counter = cur_raw_datas[i].tx_counter;
+                auto pre_timestamp = pre_raw_datas[i].timestamp;
+                auto pre_rx_counter = pre_raw_datas[i].rx_counter;
+                auto pre_tx_counter = pre_raw_datas[i].tx_counter;
+                if (cur_timestamp - pre_timestamp != 0) {
+                    rx_vals[i] = Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * 1000000 * (cur_rx_counter - pre_rx_counter) / (cur_timestamp - pre_timestamp);
+                    tx_vals[i] = Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * 1000000 * (cur_tx_counter - pre_tx_counter) / (cur_timestamp - pre_timestamp);
+                    p_cur->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
                 }
-                ++cur_raw_datas_iter;
+                rx_counter_vals[i] = cur_rx_counter;
+                tx_counter_vals[i] = cur_tx_counter;
             }
 
-            auto throughput_handles = Core::instance().getDeviceManager()->getDevice(deviceId)->getThroughputHandles();
-            auto attach_ids_iter = throughput_handles.begin();
-            while (attach_ids_iter != throughput_handles.end()) {
-                auto remote_fabric_ids_iter = attach_ids_iter->second.begin();
-                while (remote_fabric_ids_iter != attach_ids_iter->second.end()) {
-                    auto remote_attach_ids_iter = remote_fabric_ids_iter->second.begin();
-                    while (remote_attach_ids_iter != remote_fabric_ids_iter->second.end()) {
-                        auto handles = remote_attach_ids_iter->second;
-                        //The declaration: getFabricThroughputID(uint32_t attach_id, uint32_t remote_fabric_id, uint32_t remote_attach_id, FabricThroughputType type);
-                        uint64_t rx_id = Core::instance().getDeviceManager()->getDevice(deviceId)->getFabricThroughputID(attach_ids_iter->first, remote_fabric_ids_iter->first, remote_attach_ids_iter->first, FabricThroughputType::RECEIVED);
-                        uint64_t tx_id = Core::instance().getDeviceManager()->getDevice(deviceId)->getFabricThroughputID(attach_ids_iter->first, remote_fabric_ids_iter->first, remote_attach_ids_iter->first, FabricThroughputType::TRANSMITTED);
-                        uint64_t rx_counter_id = Core::instance().getDeviceManager()->getDevice(deviceId)->getFabricThroughputID(attach_ids_iter->first, remote_fabric_ids_iter->first, remote_attach_ids_iter->first, FabricThroughputType::RECEIVED_COUNTER);
-                        uint64_t tx_counter_id = Core::instance().getDeviceManager()->getDevice(deviceId)->getFabricThroughputID(attach_ids_iter->first, remote_fabric_ids_iter->first, remote_attach_ids_iter->first, FabricThroughputType::TRANSMITTED_COUNTER);
-                        uint64_t rx_val = 0;
-                        uint64_t tx_val = 0;
-                        uint64_t rx_counter_val = 0;
-                        uint64_t tx_counter_val = 0;
-                        auto handles_iter = handles.begin();
-                        while (handles_iter != handles.end()) {
-                            rx_val += rx_vals[(uint64_t)(*handles_iter)];
-                            tx_val += tx_vals[(uint64_t)(*handles_iter)];
-                            rx_counter_val += rx_counter_vals[(uint64_t)(*handles_iter)];
-                            tx_counter_val += tx_counter_vals[(uint64_t)(*handles_iter)];
-                            ++handles_iter;
-                        }
-                        std::static_pointer_cast<FabricMeasurementData>(measurementData)->setDataCur(rx_id, rx_val);
-                        std::static_pointer_cast<FabricMeasurementData>(measurementData)->setDataCur(tx_id, tx_val);
-                        std::static_pointer_cast<FabricMeasurementData>(measurementData)->setDataCur(rx_counter_id, rx_counter_val);
-                        std::static_pointer_cast<FabricMeasurementData>(measurementData)->setDataCur(tx_counter_id, tx_counter_val);
-                        ++remote_attach_ids_iter;
+            auto throughput_schema = MultiMetricsSchema::instance(p_device.get(), SCHEMA_FABRIC_THROUGHPUT);
+            p_cur->setMultiMetricsSchema(throughput_schema);
+            auto &port_schema = p_cur->getPortSchema();
+            auto p_links = p_device->getFabricLinks();
+            for (auto &link : *p_links) {
+                uint64_t rx_val = 0;
+                uint64_t tx_val = 0;
+                uint64_t rx_counter_val = 0;
+                uint64_t tx_counter_val = 0;
+                for (auto &handle : link.port_handles) {
+                    uint32_t index;
+                    if (port_schema->find((uint64_t)handle, index) && index < cur_raw_datas.size()) {
+                        rx_val += rx_vals[index];
+                        tx_val += tx_vals[index];
+                        rx_counter_val += rx_counter_vals[index];
+                        tx_counter_val += tx_counter_vals[index];
                     }
-                    ++remote_fabric_ids_iter;
                 }
-                ++attach_ids_iter;
+                p_cur->setDataCur(throughput_schema->indexOf(link.throughput_ids[FabricThroughputType::RECEIVED]), rx_val);
+                p_cur->setDataCur(throughput_schema->indexOf(link.throughput_ids[FabricThroughputType::TRANSMITTED]), tx_val);
+                p_cur->setDataCur(throughput_schema->indexOf(link.throughput_ids[FabricThroughputType::RECEIVED_COUNTER]), rx_counter_val);
+                p_cur->setDataCur(throughput_schema->indexOf(link.throughput_ids[FabricThroughputType::TRANSMITTED_COUNTER]), tx_counter_val);
             }
         }
         ++iter;
@@ -38,7 +38,7 @@ uint32_t GPUUtilizationDataHandler::getAverage(std::vector<uint32_t>& datas) {
 void GPUUtilizationDataHandler::calculateData(std::shared_ptr<SharedData>& p_data) {
     std::unique_lock<std::mutex> lock(this->mutex);
 
-    std::map<std::string, std::shared_ptr<MeasurementData>>::iterator iter = p_data->getData().begin();
+    DeviceIndexMap<std::shared_ptr<MeasurementData>>::iterator iter = p_data->getData().begin();
     while (iter != p_data->getData().end()) {
         auto &deviceId = iter->first;
         auto extended_data = iter->second->getExtendedDatas()->begin();
@@ -0,0 +1,116 @@
+/* 
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file group_aggregation.cpp
+ */
+
+#include "group_aggregation.h"
+
+#include <limits>
+
+#include "infrastructure/utility.h"
+
+namespace xpum {
+
+void GroupMetricAggregate::add(uint64_t value, uint32_t value_scale) {
+    if (value_scale == 0) {
+        value_scale = 1;
+    }
+    if (device_count == 0) {
+        scale = value_scale;
+    } else if (value_scale != scale) {
+        value = (uint64_t)(value * 1.0 * scale / value_scale);
+    }
+    sum += value;
+    if (device_count == 0 || value < min) {
+        min = value;
+    }
+    if (device_count == 0 || value > max) {
+        max = value;
+    }
+    device_count++;
+}
+
+bool GroupAggregation::isAggregatedType(MeasurementType type) {
+    if (type == MeasurementType::METRIC_ENGINE_UTILIZATION || type == MeasurementType::METRIC_FABRIC_THROUGHPUT || type == MeasurementType::METRIC_VF_ENGINE_UTILIZATION || type == MeasurementType::METRIC_PERF) {
+        return false;
+    }
+    return Utility::xpumStatsTypeFromMeasurementType(type) != XPUM_STATS_MAX;
+}
+
+void GroupAggregation::setGroupDevices(xpum_group_id_t group_id, const std::vector<xpum_device_id_t>& device_ids) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& group = groups[group_id];
+    group.device_ids.assign(device_ids.begin(), device_ids.end());
+    group.metrics.clear();
+}
+
+void GroupAggregation::removeGroup(xpum_group_id_t group_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    groups.erase(group_id);
+}
+
+xpum_result_t GroupAggregation::getGroupMetrics(xpum_group_id_t group_id, xpum_group_metric_data_t data_list[], uint32_t* count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iter = groups.find(group_id);
+    if (iter == groups.end()) {
+        return XPUM_RESULT_GROUP_NOT_FOUND;
+    }
+    auto& metrics = iter->second.metrics;
+    if (data_list == nullptr) {
+        *count = metrics.size();
+        return XPUM_OK;
+    }
+    if (*count < metrics.size()) {
+        return XPUM_BUFFER_TOO_SMALL;
+    }
+    uint32_t index = 0;
+    for (auto& metric : metrics) {
+        MeasurementType type = metric.first;
+        auto& aggregate = metric.second;
+        auto& data = data_list[index++];
+        data.metricsType = Utility::xpumStatsTypeFromMeasurementType(type);
+        data.isCounter = Utility::isCounterMetric(type);
+        data.timestamp = aggregate.time;
+        data.deviceCount = aggregate.device_count;
+        data.sum = aggregate.sum;
+        data.avg = aggregate.sum / aggregate.device_count;
+        data.min = aggregate.min;
+        data.max = aggregate.max;
+        data.scale = aggregate.scale;
+    }
+    *count = index;
+    return XPUM_OK;
+}
+
+void GroupAggregation::handleData(MeasurementType type, std::shared_ptr<SharedData>& p_data) {
+    if (!isAggregatedType(type)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (groups.empty()) {
+        return;
+    }
+    auto& datas = p_data->getData();
+    for (auto& group : groups) {
+        GroupMetricAggregate aggregate;
+        aggregate.time = p_data->getTime();
+        for (auto& device_id : group.second.device_ids) {
+            auto data_iter = datas.find(device_id);
+            if (data_iter == datas.end() || data_iter->second == nullptr) {
+                continue;
+            }
+            auto& p_measurement = data_iter->second;
+            if (!p_measurement->hasDataOnDevice() || p_measurement->getCurrent() == std::numeric_limits<uint64_t>::max()) {
+                continue;
+            }
+            aggregate.add(p_measurement->getCurrent(), p_measurement->getScale());
+        }
+        // a tick without data of the group keeps the previous aggregate
+        if (aggregate.device_count > 0) {
+            group.second.metrics[type] = aggregate;
+        }
+    }
+}
+
+} // end namespace xpum
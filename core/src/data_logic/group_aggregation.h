@@ -0,0 +1,73 @@
+/* 
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file group_aggregation.h
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../include/xpum_structs.h"
+#include "infrastructure/measurement_type.h"
+#include "shared_data.h"
+
+namespace xpum {
+
+/*
+  The sum, min and max of one metric over the devices of a group in one
+  sampling tick, in the scale of the first device read.
+*/
+struct GroupMetricAggregate {
+    Timestamp_t time;
+    uint32_t device_count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint32_t scale;
+
+    GroupMetricAggregate() : time(0), device_count(0), sum(0), min(0), max(0), scale(1) {}
+
+    void add(uint64_t value, uint32_t value_scale);
+};
+
+struct GroupAggregate {
+    // the device indices, the numeric device ids
+    std::vector<uint32_t> device_ids;
+    std::map<MeasurementType, GroupMetricAggregate> metrics;
+};
+
+/*
+  GroupAggregation keeps the devices of the groups registered by
+  GroupManager and aggregates every sample that passes through
+  DataHandlerManager over each group, so a group query is one lookup
+  instead of a query of each of its devices.
+*/
+class GroupAggregation {
+   public:
+    // register the group or replace its devices, the aggregates are restarted
+    void setGroupDevices(xpum_group_id_t group_id, const std::vector<xpum_device_id_t>& device_ids);
+
+    void removeGroup(xpum_group_id_t group_id);
+
+    /*
+      Fill the aggregated metrics of group group_id from the latest tick of
+      each metric. If data_list is NULL, only count is filled.
+    */
+    xpum_result_t getGroupMetrics(xpum_group_id_t group_id, xpum_group_metric_data_t data_list[], uint32_t* count);
+
+    void handleData(MeasurementType type, std::shared_ptr<SharedData>& p_data);
+
+    static bool isAggregatedType(MeasurementType type);
+
+   private:
+    std::mutex mutex;
+
+    std::map<xpum_group_id_t, GroupAggregate> groups;
+};
+
+} // end namespace xpum
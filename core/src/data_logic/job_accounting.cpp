@@ -0,0 +1,303 @@
+/* 
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file job_accounting.cpp
+ */
+
+#include "job_accounting.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <sstream>
+
+#include "core/core.h"
+#include "device/gpu/gpu_device_stub.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+void JobMetricIntegral::add(Timestamp_t time, double value) {
+    if (has_sample && time > last_time) {
+        integral += last_value * (time - last_time);
+        duration += time - last_time;
+    }
+    if (!has_sample || value > peak) {
+        peak = value;
+    }
+    has_sample = true;
+    last_time = time;
+    last_value = value;
+}
+
+double JobMetricIntegral::average() const {
+    if (duration > 0) {
+        return integral / duration;
+    }
+    return has_sample ? last_value : 0;
+}
+
+bool JobAccounting::isAccountedType(MeasurementType type) {
+    return type == MeasurementType::METRIC_ENERGY || type == MeasurementType::METRIC_POWER || type == MeasurementType::METRIC_COMPUTATION || type == MeasurementType::METRIC_MEMORY_USED;
+}
+
+xpum_result_t JobAccounting::openJobWindow(const std::string& job_id, const std::vector<xpum_device_id_t>& device_ids) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (jobs.find(job_id) != jobs.end()) {
+        return XPUM_RESULT_JOB_WINDOW_EXISTS;
+    }
+    auto& job = jobs[job_id];
+    for (auto device_id : device_ids) {
+        job[device_id];
+    }
+    XPUM_LOG_INFO("job window {} opened for {} devices", job_id, device_ids.size());
+    return XPUM_OK;
+}
+
+xpum_result_t JobAccounting::getJobWindowStats(const std::string& job_id, xpum_job_window_stats_t stats[], uint32_t* count, bool close) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iter = jobs.find(job_id);
+    if (iter == jobs.end()) {
+        return XPUM_RESULT_JOB_WINDOW_NOT_FOUND;
+    }
+    if (stats == nullptr) {
+        *count = iter->second.size();
+        return XPUM_OK;
+    }
+    if (*count < iter->second.size()) {
+        return XPUM_BUFFER_TOO_SMALL;
+    }
+    uint32_t index = 0;
+    for (auto& device : iter->second) {
+        auto& accounting = device.second;
+        auto& stat = stats[index++];
+        stat.deviceId = device.first;
+        stat.begin = accounting.begin;
+        stat.end = accounting.end;
+        if (accounting.has_energy && accounting.last_energy >= accounting.first_energy) {
+            stat.energy = accounting.last_energy - accounting.first_energy;
+        } else {
+            // W * ms is mJ
+            stat.energy = accounting.power.integral;
+        }
+        stat.avgPower = accounting.power.average() * 1000;
+        stat.peakPower = accounting.power.peak * 1000;
+        stat.avgGpuUtilization = accounting.gpu_utilization.average() * 100;
+        stat.avgMemoryUsed = accounting.memory_used.average();
+        stat.peakMemoryUsed = accounting.memory_used.peak;
+        stat.memoryUsedIntegral = accounting.memory_used.integral / 1000;
+    }
+    *count = index;
+    if (close) {
+        jobs.erase(iter);
+        XPUM_LOG_INFO("job window {} closed", job_id);
+    }
+    return XPUM_OK;
+}
+
+xpum_result_t JobAccounting::getJobWindowProcessEnergy(const std::string& job_id, xpum_job_process_energy_t energies[], uint32_t* count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iter = jobs.find(job_id);
+    if (iter == jobs.end()) {
+        return XPUM_RESULT_JOB_WINDOW_NOT_FOUND;
+    }
+    uint32_t size = 0;
+    for (auto& device : iter->second) {
+        size += device.second.processes.size() + 1;
+    }
+    if (energies == nullptr) {
+        *count = size;
+        return XPUM_OK;
+    }
+    if (*count < size) {
+        return XPUM_BUFFER_TOO_SMALL;
+    }
+    auto copyString = [](char* dest, const std::string& src) {
+        strncpy(dest, src.c_str(), XPUM_MAX_STR_LENGTH - 1);
+        dest[XPUM_MAX_STR_LENGTH - 1] = 0;
+    };
+    uint32_t index = 0;
+    for (auto& device : iter->second) {
+        auto& unattributed = energies[index++];
+        memset(&unattributed, 0, sizeof(unattributed));
+        unattributed.deviceId = device.first;
+        unattributed.energy = device.second.unattributed_energy;
+        for (auto& process : device.second.processes) {
+            auto& energy = energies[index++];
+            energy.deviceId = unattributed.deviceId;
+            energy.processId = process.first;
+            copyString(energy.processName, process.second.name);
+            copyString(energy.containerId, process.second.container_id);
+            copyString(energy.podUid, process.second.pod_uid);
+            energy.busyTime = process.second.busy_time;
+            energy.energy = process.second.energy;
+        }
+    }
+    *count = index;
+    return XPUM_OK;
+}
+
+void JobAccounting::attributeEnergy(JobDeviceAccounting& accounting, double energy, const ClientBusyTimes& busy_times) {
+    if (accounting.has_busy_times && energy >= accounting.busy_times_energy) {
+        double delta_energy = energy - accounting.busy_times_energy;
+        // the busy time of the clients present in both samples, by pid
+        std::map<uint32_t, uint64_t> pid_busy_times;
+        uint64_t total = 0;
+        for (auto& client : busy_times) {
+            auto previous = accounting.busy_times.find(client.first);
+            if (previous == accounting.busy_times.end() || previous->second.first != client.second.first || client.second.second < previous->second.second) {
+                continue;
+            }
+            uint64_t delta = client.second.second - previous->second.second;
+            if (delta > 0) {
+                pid_busy_times[client.second.first] += delta;
+                total += delta;
+            }
+        }
+        if (total == 0) {
+            accounting.unattributed_energy += delta_energy;
+        } else {
+            for (auto& pid_busy_time : pid_busy_times) {
+                auto process = accounting.processes.find(pid_busy_time.first);
+                if (process == accounting.processes.end()) {
+                    process = accounting.processes.emplace(pid_busy_time.first, JobProcessEnergy()).first;
+                    readProcessInfo(pid_busy_time.first, process->second);
+                }
+                process->second.busy_time += pid_busy_time.second;
+                process->second.energy += delta_energy * pid_busy_time.second / total;
+            }
+        }
+    }
+    accounting.has_busy_times = true;
+    accounting.busy_times_energy = energy;
+    accounting.busy_times = busy_times;
+}
+
+void JobAccounting::readProcessInfo(uint32_t pid, JobProcessEnergy& process) {
+    std::string dir = "/proc/" + std::to_string(pid);
+    std::ifstream comm(dir + "/comm");
+    std::getline(comm, process.name);
+    std::ifstream cgroup(dir + "/cgroup");
+    std::string line;
+    while (std::getline(cgroup, line)) {
+        // "0::/kubepods.slice/kubepods-besteffort.slice/kubepods-besteffort-pod<uid>.slice/cri-containerd-<id>.scope"
+        // of the systemd driver, "3:cpu:/kubepods/besteffort/pod<uid>/<id>" of the cgroupfs driver, or "0::/docker/<id>"
+        auto colon = line.find(':');
+        if (colon != std::string::npos) {
+            colon = line.find(':', colon + 1);
+        }
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::stringstream path(line.substr(colon + 1));
+        std::string component;
+        while (std::getline(path, component, '/')) {
+            for (auto suffix : {".slice", ".scope"}) {
+                std::string str(suffix);
+                if (component.size() > str.size() && component.compare(component.size() - str.size(), str.size(), str) == 0) {
+                    component.erase(component.size() - str.size());
+                }
+            }
+            auto pod = component.rfind("pod");
+            if (pod != std::string::npos && (pod == 0 || component[pod - 1] == '-')) {
+                std::string uid = component.substr(pod + 3);
+                // the systemd driver has '_' in place of '-'
+                std::replace(uid.begin(), uid.end(), '_', '-');
+                if (uid.size() == 36) {
+                    process.pod_uid = uid;
+                }
+                continue;
+            }
+            // the container id is 64 hex digits, after a prefix like "docker-" or "cri-containerd-"
+            auto dash = component.rfind('-');
+            std::string id = dash == std::string::npos ? component : component.substr(dash + 1);
+            if (id.size() == 64 && std::all_of(id.begin(), id.end(), ::isxdigit)) {
+                process.container_id = id;
+            }
+        }
+    }
+}
+
+void JobAccounting::handleData(MeasurementType type, std::shared_ptr<SharedData>& p_data) {
+    if (!isAccountedType(type)) {
+        return;
+    }
+    // the busy times are read out of the lock, once for each device of the windows
+    std::map<uint32_t, ClientBusyTimes> device_busy_times;
+    if (type == MeasurementType::METRIC_ENERGY) {
+        std::set<uint32_t> device_ids;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& job : jobs) {
+                for (auto& device : job.second) {
+                    device_ids.insert(device.first);
+                }
+            }
+        }
+        for (auto& device_id : device_ids) {
+            auto p_device = Core::instance().getDeviceManager()->getDevice(device_id);
+            if (p_device == nullptr) {
+                continue;
+            }
+            ClientBusyTimes busy_times;
+            if (GPUDeviceStub::getDeviceClientBusyTime(p_device->getDeviceHandle(), p_device->getId(), busy_times)) {
+                device_busy_times[device_id] = std::move(busy_times);
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (jobs.empty()) {
+        return;
+    }
+    Timestamp_t time = p_data->getTime();
+    for (auto& job : jobs) {
+        for (auto& device : job.second) {
+            auto data_iter = p_data->getData().find(device.first);
+            if (data_iter == p_data->getData().end() || data_iter->second == nullptr) {
+                continue;
+            }
+            auto& p_measurement = data_iter->second;
+            if (!p_measurement->hasDataOnDevice() || p_measurement->getCurrent() == std::numeric_limits<uint64_t>::max()) {
+                continue;
+            }
+            double value = p_measurement->getCurrent() * 1.0 / (p_measurement->getScale() > 0 ? p_measurement->getScale() : 1);
+            auto& accounting = device.second;
+            if (accounting.begin == 0) {
+                accounting.begin = time;
+            }
+            if (time > accounting.end) {
+                accounting.end = time;
+            }
+            switch (type) {
+                case MeasurementType::METRIC_ENERGY:
+                    if (!accounting.has_energy) {
+                        accounting.first_energy = value;
+                        accounting.has_energy = true;
+                    }
+                    accounting.last_energy = value;
+                    {
+                        auto busy_times = device_busy_times.find(device.first);
+                        if (busy_times != device_busy_times.end()) {
+                            attributeEnergy(accounting, value, busy_times->second);
+                        }
+                    }
+                    break;
+                case MeasurementType::METRIC_POWER:
+                    accounting.power.add(time, value);
+                    break;
+                case MeasurementType::METRIC_COMPUTATION:
+                    accounting.gpu_utilization.add(time, value);
+                    break;
+                case MeasurementType::METRIC_MEMORY_USED:
+                    accounting.memory_used.add(time, value);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+} // end namespace xpum
@@ -0,0 +1,119 @@
+/* 
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file job_accounting.h
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../include/xpum_structs.h"
+#include "infrastructure/measurement_type.h"
+#include "shared_data.h"
+
+namespace xpum {
+
+/*
+  Time-weighted integral of one metric of a device over a job window. Each
+  sample is held until the next one of the same metric arrives.
+*/
+struct JobMetricIntegral {
+    bool has_sample;
+    Timestamp_t last_time;
+    double last_value;
+    double integral;
+    Timestamp_t duration;
+    double peak;
+
+    JobMetricIntegral() : has_sample(false), last_time(0), last_value(0), integral(0), duration(0), peak(0) {}
+
+    void add(Timestamp_t time, double value);
+
+    double average() const;
+};
+
+// the busy time in ns of each drm client of a device and the pid of the client, by the client
+typedef std::map<std::string, std::pair<uint32_t, uint64_t>> ClientBusyTimes;
+
+// the energy of a device attributed to one of its processes
+struct JobProcessEnergy {
+    std::string name;
+    std::string container_id;
+    std::string pod_uid;
+    uint64_t busy_time;
+    double energy;
+
+    JobProcessEnergy() : busy_time(0), energy(0) {}
+};
+
+struct JobDeviceAccounting {
+    Timestamp_t begin;
+    Timestamp_t end;
+    bool has_energy;
+    double first_energy;
+    double last_energy;
+    JobMetricIntegral power;
+    JobMetricIntegral gpu_utilization;
+    JobMetricIntegral memory_used;
+    // the busy times of the clients at the previous energy sample
+    bool has_busy_times;
+    double busy_times_energy;
+    ClientBusyTimes busy_times;
+    // by pid
+    std::map<uint32_t, JobProcessEnergy> processes;
+    // the energy measured while no process was busy
+    double unattributed_energy;
+
+    JobDeviceAccounting() : begin(0), end(0), has_energy(false), first_energy(0), last_energy(0), has_busy_times(false), busy_times_energy(0), unattributed_energy(0) {}
+};
+
+/*
+  JobAccounting keeps the open job windows and integrates energy, power,
+  GPU utilization and memory used of their devices from every sample that
+  passes through DataHandlerManager.
+
+  The energy of a device between two energy samples is also split among its
+  processes by the busy time of their drm clients in the same interval, so
+  the processes and pods sharing a device are each charged for their use.
+  The busy time is per card, the energy is attributed at device level.
+*/
+class JobAccounting {
+   public:
+    xpum_result_t openJobWindow(const std::string& job_id, const std::vector<xpum_device_id_t>& device_ids);
+
+    /*
+      Fill the statistics of the devices of job job_id. If stats is NULL, only
+      count is filled. If close is true the window is closed after the
+      statistics are filled.
+    */
+    xpum_result_t getJobWindowStats(const std::string& job_id, xpum_job_window_stats_t stats[], uint32_t* count, bool close);
+
+    /*
+      Fill the energy attributed to the processes of the devices of job
+      job_id, with one entry of process id 0 per device for the energy not
+      attributed. If energies is NULL, only count is filled.
+    */
+    xpum_result_t getJobWindowProcessEnergy(const std::string& job_id, xpum_job_process_energy_t energies[], uint32_t* count);
+
+    void handleData(MeasurementType type, std::shared_ptr<SharedData>& p_data);
+
+    static bool isAccountedType(MeasurementType type);
+
+    // the name, container and pod of a process, from /proc
+    static void readProcessInfo(uint32_t pid, JobProcessEnergy& process);
+
+   private:
+    static void attributeEnergy(JobDeviceAccounting& accounting, double energy, const ClientBusyTimes& busy_times);
+
+    std::mutex mutex;
+
+    // the job id map index, the device index map index
+    std::map<std::string, std::map<uint32_t, JobDeviceAccounting>> jobs;
+};
+
+} // end namespace xpum
@@ -11,126 +11,163 @@
 
 #include "infrastructure/configuration.h"
 #include "infrastructure/engine_measurement_data.h"
+#include "infrastructure/memory_accounting.h"
+#include "infrastructure/metric_descriptor.h"
 
 namespace xpum {
 
 MultiMetricsStatsDataHandler::MultiMetricsStatsDataHandler(MeasurementType type,
                                                                              std::shared_ptr<Persistency>& p_persistency)
     : DataHandler(type, p_persistency) {
+    multi_sessions_data[StatsSessions::INITIAL_EPOCH];
+    auto descriptor = getMetricDescriptor(type);
+    memory_name = std::string("statistics of ") + (descriptor != nullptr && descriptor->name[0] != '\0' ? descriptor->name : "metric " + std::to_string(type));
 }
 
 MultiMetricsStatsDataHandler::~MultiMetricsStatsDataHandler() {
     close();
+    MemoryAccounting::instance().remove(memory_name);
+}
+
+void MultiMetricsStatsDataHandler::reportMemory() {
+    uint64_t entries = 0;
+    uint64_t bytes = 0;
+    for (auto &epoch : multi_sessions_data) {
+        entries += epoch.second.size();
+        bytes += epoch.second.capacity() * sizeof(multi_devices_data_t::value_type);
+        for (auto &device_stats : epoch.second) {
+            bytes += device_stats.second.capacity() * sizeof(Statistics_data_t);
+        }
+    }
+    bytes += batch_values.capacity() * sizeof(uint64_t) + batch_masks.capacity() * sizeof(uint8_t) + batch_offsets.capacity() * sizeof(size_t);
+    MemoryAccounting::instance().report(memory_name, bytes, entries);
 }
 
 void MultiMetricsStatsDataHandler::handleData(std::shared_ptr<SharedData>& p_data) noexcept {
     updateStatistics(p_data);
 }
 
-void MultiMetricsStatsDataHandler::resetStatistics(std::string& device_id, uint64_t session_id) {
-    if (multi_sessions_data.find(session_id) != multi_sessions_data.end()) {
-        if (multi_sessions_data[session_id].find(device_id) != multi_sessions_data[session_id].end()) {
-            multi_sessions_data[session_id][device_id].clear();
+void MultiMetricsStatsDataHandler::resetStatistics(uint32_t device_id, uint64_t session_id) {
+    std::vector<uint64_t> released;
+    uint64_t epoch = sessions.reset(session_id, device_id, released);
+    // the new epoch starts with the next update
+    multi_sessions_data[epoch];
+    for (auto& released_epoch : released) {
+        multi_sessions_data.erase(released_epoch);
+    }
+}
+
+void MultiMetricsStatsDataHandler::accumulate(Statistics_data_t* stats, const uint64_t* values, const uint8_t* masks, size_t count, long long time) {
+    for (size_t i = 0; i < count; i++) {
+        if (masks[i] == 0) {
+            continue;
+        }
+        auto &s = stats[i];
+        uint64_t value = values[i];
+        if (s.count == 0) {
+            s = Statistics_data_t(value, time);
+            continue;
         }
+        s.count++;
+        s.min = std::min(s.min, value);
+        s.max = std::max(s.max, value);
+        s.avg = s.avg * (s.count - 1) * 1.0 / s.count + value * 1.0 / s.count;
+        s.latest_time = time;
     }
 }
 
 void MultiMetricsStatsDataHandler::updateStatistics(std::shared_ptr<SharedData>& p_data) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    std::map<std::string, std::shared_ptr<MeasurementData>>::iterator iter = p_data->getData().begin();
-    while (iter != p_data->getData().end()) {
-        auto &deviceId = iter->first;
-        for (uint64_t session = 0; session < Configuration::MAX_STATISTICS_SESSION_NUM; session++) {
-            auto multi_metrics_measurement_datas = iter->second->getMultiMetricsDatas();
-            std::map<std::string, std::map<uint64_t, Statistics_data_t>>::iterator iter_statistics = multi_sessions_data[session].find(deviceId);
-            if (iter_statistics != multi_sessions_data[session].end()) {
-                auto multi_metrics_datas_iter = multi_metrics_measurement_datas->begin();
-                while (multi_metrics_datas_iter != multi_metrics_measurement_datas->end()) {
-                    auto &metricHandle = multi_metrics_datas_iter->first;
-                    auto &singleMeasurementData = multi_metrics_datas_iter->second;
-                    auto stats_iter = multi_sessions_data[session][deviceId].find(uint64_t(metricHandle));
-                    if (stats_iter != multi_sessions_data[session][deviceId].end()) {
-                        stats_iter->second.count++;
-                        if (singleMeasurementData.current < stats_iter->second.min) {
-                            stats_iter->second.min = singleMeasurementData.current;
-                        }
-                        if (singleMeasurementData.current > stats_iter->second.max) {
-                            stats_iter->second.max = singleMeasurementData.current;
-                        }
-                        stats_iter->second.avg = stats_iter->second.avg * (stats_iter->second.count - 1) * 1.0 / stats_iter->second.count + singleMeasurementData.current * 1.0 / stats_iter->second.count;
-                        stats_iter->second.latest_time = p_data->getTime();
-                    } else {
-                        if (singleMeasurementData.current != std::numeric_limits<uint64_t>::max()) {
-                            multi_sessions_data[session][deviceId][uint64_t(metricHandle)] = Statistics_data_t(singleMeasurementData.current, p_data->getTime());
-                        }
-                    }
-                    multi_metrics_datas_iter++;
-                }
-            } else {
-                auto multi_metrics_datas_iter = multi_metrics_measurement_datas->begin();
-                while (multi_metrics_datas_iter != multi_metrics_measurement_datas->end()) {
-                    //multi_metrics_datas_iter->first is handle (engine or fp)
-                    //multi_metrics_datas_iter->second is SingleMeasurementData_t
-                    if (multi_metrics_datas_iter->second.current != std::numeric_limits<uint64_t>::max()) {
-                        multi_sessions_data[session][deviceId][uint64_t(multi_metrics_datas_iter->first)] = Statistics_data_t(multi_metrics_datas_iter->second.current, p_data->getTime());
-                    }
-                    multi_metrics_datas_iter++;
-                }
+    auto &datas = p_data->getData();
+    long long time = p_data->getTime();
+
+    // the samples of the tick in columns, the samples without data are masked once here rather than in every epoch
+    batch_values.clear();
+    batch_masks.clear();
+    batch_offsets.clear();
+    for (auto &entry : datas) {
+        batch_offsets.push_back(batch_values.size());
+        if (entry.second == nullptr) {
+            continue;
+        }
+        auto multi_metrics_measurement_datas = entry.second->getMultiMetricsDatas();
+        for (auto &single : *multi_metrics_measurement_datas) {
+            bool valid = single.valid && single.current != std::numeric_limits<uint64_t>::max();
+            batch_values.push_back(valid ? single.current : 0);
+            batch_masks.push_back(valid ? 1 : 0);
+        }
+    }
+    batch_offsets.push_back(batch_values.size());
+
+    for (auto &epoch : multi_sessions_data) {
+        auto &epoch_data = epoch.second;
+        // the samples and the epoch statistics are both indexed by the device index
+        epoch_data.reserve(datas.capacity());
+        size_t index = 0;
+        for (auto &entry : datas) {
+            size_t begin = batch_offsets[index];
+            size_t count = batch_offsets[index + 1] - begin;
+            index++;
+            if (entry.second == nullptr) {
+                continue;
             }
+            auto &device_stats = epoch_data[entry.first];
+            if (device_stats.size() < count) {
+                device_stats.resize(count);
+            }
+            accumulate(device_stats.data(), batch_values.data() + begin, batch_masks.data() + begin, count, time);
         }
-        ++iter;
     }
+    sessions.seal();
+    reportMemory();
 }
 
-std::shared_ptr<MeasurementData> MultiMetricsStatsDataHandler::getLatestStatistics(std::string& device_id, uint64_t session_id) noexcept {
+std::shared_ptr<MeasurementData> MultiMetricsStatsDataHandler::getLatestStatistics(uint32_t device_id, uint64_t session_id) noexcept {
     std::unique_lock<std::mutex> lock(this->mutex);
     if (p_latestData == nullptr) {
         return nullptr;
     }
 
-    auto datas = p_latestData->getData();
-    if (datas.find(device_id) != datas.end() && datas[device_id] != nullptr) {
-        auto cur_datas = datas[device_id];
-        auto multi_metrics_measurement_datas = datas[device_id]->getMultiMetricsDatas();
-        auto multi_metrics_datas_iter = multi_metrics_measurement_datas->begin();
-        while (multi_metrics_datas_iter != multi_metrics_measurement_datas->end()) {
-            auto &metricHandle = multi_metrics_datas_iter->first;
-            auto &singleMeasurementData = multi_metrics_datas_iter->second;
-            cur_datas->setDataCur(metricHandle, singleMeasurementData.current);
-            cur_datas->setDataMin(metricHandle, singleMeasurementData.current);
-            cur_datas->setDataMax(metricHandle, singleMeasurementData.current);
-            cur_datas->setDataAvg(metricHandle, singleMeasurementData.current);
-            cur_datas->setStartTime(cur_datas->getTimestamp());
-            cur_datas->setLatestTime(cur_datas->getTimestamp());
-            datas[device_id]->setStartTime(datas[device_id]->getTimestamp());
-            datas[device_id]->setLatestTime(datas[device_id]->getTimestamp());
-            ++multi_metrics_datas_iter;
+    auto& datas = p_latestData->getData();
+    auto data_iter = datas.find(device_id);
+    if (data_iter == datas.end()) {
+        return nullptr;
+    }
+    auto cur_datas = data_iter->second;
+    if (cur_datas == nullptr) {
+        return cur_datas;
+    }
+    auto multi_metrics_measurement_datas = cur_datas->getMultiMetricsDatas();
+    for (uint32_t i = 0; i < multi_metrics_measurement_datas->size(); i++) {
+        auto &singleMeasurementData = (*multi_metrics_measurement_datas)[i];
+        if (!singleMeasurementData.valid) {
+            continue;
         }
+        cur_datas->setDataMin(i, singleMeasurementData.current);
+        cur_datas->setDataMax(i, singleMeasurementData.current);
+        cur_datas->setDataAvg(i, singleMeasurementData.current);
+        cur_datas->setStartTime(cur_datas->getTimestamp());
+        cur_datas->setLatestTime(cur_datas->getTimestamp());
     }
 
-    if (multi_sessions_data.find(session_id) != multi_sessions_data.end() && multi_sessions_data[session_id].find(device_id) != multi_sessions_data[session_id].end() && datas[device_id] != nullptr) {
-        auto multi_metrics_measurement_datas = datas[device_id]->getMultiMetricsDatas();
-        auto multi_metrics_datas_iter = multi_metrics_measurement_datas->begin();
-        while (multi_metrics_datas_iter != multi_metrics_measurement_datas->end()) {
-            auto &metricHandle = multi_metrics_datas_iter->first;
-            if(multi_sessions_data[session_id][device_id].find(metricHandle) != multi_sessions_data[session_id][device_id].end()){
-                auto cur_datas = std::static_pointer_cast<MeasurementData>(datas[device_id]);
-                cur_datas->setDataMin(metricHandle, multi_sessions_data[session_id][device_id][uint64_t(metricHandle)].min);
-                cur_datas->setDataMax(metricHandle, multi_sessions_data[session_id][device_id][uint64_t(metricHandle)].max);
-                cur_datas->setDataAvg(metricHandle, multi_sessions_data[session_id][device_id][uint64_t(metricHandle)].avg);
-                cur_datas->setStartTime(multi_sessions_data[session_id][device_id][uint64_t(metricHandle)].start_time);
-                cur_datas->setLatestTime(multi_sessions_data[session_id][device_id][uint64_t(metricHandle)].latest_time);
+    auto epoch_iter = multi_sessions_data.find(sessions.getEpoch(session_id, device_id));
+    if (epoch_iter != multi_sessions_data.end() && epoch_iter->second.find(device_id) != epoch_iter->second.end()) {
+        auto &device_stats = epoch_iter->second[device_id];
+        for (uint32_t i = 0; i < multi_metrics_measurement_datas->size() && i < device_stats.size(); i++) {
+            auto &stats = device_stats[i];
+            if (!(*multi_metrics_measurement_datas)[i].valid || stats.count == 0) {
+                continue;
             }
-            ++multi_metrics_datas_iter;
+            cur_datas->setDataMin(i, stats.min);
+            cur_datas->setDataMax(i, stats.max);
+            cur_datas->setDataAvg(i, stats.avg);
+            cur_datas->setStartTime(stats.start_time);
+            cur_datas->setLatestTime(stats.latest_time);
         }
         resetStatistics(device_id, session_id);
     }
 
-    if (datas.find(device_id) != datas.end()) {
-        return datas[device_id];
-    } else {
-        return nullptr;
-    }
+    return cur_datas;
 }
 
 } // end namespace xpum
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "data_handler.h"
+#include "stats_sessions.h"
 
 namespace xpum {
 
@@ -31,10 +32,11 @@ struct Statistics_data_t {
     }
 };
 
-//The map index is engine handle or fabric ID
-typedef std::map<uint64_t, Statistics_data_t> multi_metrics_data_t;
-//The map index is device ID
-typedef std::map<std::string, multi_metrics_data_t> multi_devices_data_t;
+//The vector index is the multi metrics schema index of the engine or fabric throughput,
+//the statistics with count 0 have no data yet
+typedef std::vector<Statistics_data_t> multi_metrics_data_t;
+//The map index is device index
+typedef DeviceIndexMap<multi_metrics_data_t> multi_devices_data_t;
 
 class MultiMetricsStatsDataHandler : public DataHandler {
    public:
@@ -44,13 +46,29 @@ class MultiMetricsStatsDataHandler : public DataHandler {
 
     virtual void handleData(std::shared_ptr<SharedData> &p_data) noexcept;
 
-    virtual std::shared_ptr<MeasurementData> getLatestStatistics(std::string &device_id, uint64_t session_id) noexcept;
+    virtual std::shared_ptr<MeasurementData> getLatestStatistics(uint32_t device_id, uint64_t session_id) noexcept;
 
    protected:
-    void resetStatistics(std::string &device_id, uint64_t session_id);
+    void resetStatistics(uint32_t device_id, uint64_t session_id);
 
     void updateStatistics(std::shared_ptr<SharedData> &p_data);
 
+    // add the values whose mask is not 0 to the statistics of the same index
+    static void accumulate(Statistics_data_t *stats, const uint64_t *values, const uint8_t *masks, size_t count, long long time);
+
+    // report the size of the statistics to MemoryAccounting, the caller holds the mutex
+    void reportMemory();
+
+    StatsSessions sessions;
+
+    std::string memory_name;
+
+    // the samples of the tick being updated, batch_offsets[i] is where device i of the tick starts
+    std::vector<uint64_t> batch_values;
+    std::vector<uint8_t> batch_masks;
+    std::vector<size_t> batch_offsets;
+
+    //The map index is epoch ID
     std::map<uint64_t, multi_devices_data_t> multi_sessions_data;
 };
 } // end namespace xpum
@@ -6,10 +6,10 @@
 
 
 #include <algorithm>
-#include <iostream>
 
 #include "core/core.h"
 #include "infrastructure/configuration.h"
+#include "infrastructure/memory_accounting.h"
 #include "perf_measurement_data.h"
 #include "perf_metrics_data_handler.h"
 
@@ -23,34 +23,184 @@ PerfMetricsHandler::PerfMetricsHandler(MeasurementType type,
 
 PerfMetricsHandler::~PerfMetricsHandler() {
     close();
+    MemoryAccounting::instance().remove("performance metric windows");
 }
 
-void PerfMetricsHandler::calculateData(std::shared_ptr<SharedData>& p_data) {
-    std::unique_lock<std::mutex> lock(this->mutex);
+void PerfMetricsHandler::reportWindowMemory() {
+    uint64_t samples = 0;
+    uint64_t bytes = windows.capacity() * sizeof(DeviceIndexMap<PerfMetricWindow_t>::value_type);
+    for (auto& entry : windows) {
+        auto& window = entry.second;
+        uint64_t sample_size = sizeof(PerfMetricSample_t) + window.keys.size() * sizeof(double) + window.groups.size() * sizeof(double) + window.tile_count * sizeof(TopdownCounters_t);
+        samples += window.samples.size();
+        bytes += window.samples.size() * sample_size;
+        bytes += window.keys.size() * (sizeof(PerfMetricKey_t) + sizeof(int)) + window.tile_count * sizeof(TopdownCounters_t);
+    }
+    MemoryAccounting::instance().report("performance metric windows", bytes, samples);
+}
+
+bool PerfMetricsHandler::sameLayout(const PerfMetricWindow_t& window, PerfMeasurementData& data) {
+    auto p_perf_datas = data.getPerfMetricDatas();
+    size_t index = 0;
+    for (size_t i = 0; i < p_perf_datas->size(); i++) {
+        for (auto& group_data : (*p_perf_datas)[i]->data) {
+            if (index >= window.groups.size() || window.groups[index].first != i || window.groups[index].second != group_data.name || window.group_sizes[index] != group_data.data.size()) {
+                return false;
+            }
+            index++;
+        }
+    }
+    return index == window.groups.size();
+}
 
-    auto all_device_data = p_data->getData();
-    for (auto it = all_device_data.begin(); it != all_device_data.end(); it++) {
-        std::shared_ptr<PerfMeasurementData> p_measurement_data = std::static_pointer_cast<PerfMeasurementData>(it->second);
-        std::cout << "Device Id:" << it->first << std::endl;
+void PerfMetricsHandler::calculateData(std::shared_ptr<SharedData>& p_data) {
+    Timestamp_t time = p_data->getTime();
+    // the older samples are dropped first when the caches are over the memory limit
+    Timestamp_t retention = MemoryAccounting::instance().isOverBudget() ? Configuration::PERF_METRIC_RETENTION / 2 : Configuration::PERF_METRIC_RETENTION;
+    std::unique_lock<std::mutex> lock(this->window_mutex);
+    for (auto& device_data : p_data->getData()) {
+        auto p_measurement_data = std::static_pointer_cast<PerfMeasurementData>(device_data.second);
         auto p_perf_datas = p_measurement_data->getPerfMetricDatas();
+        auto& window = windows[device_data.first];
+        if (!sameLayout(window, *p_measurement_data)) {
+            // the metric groups changed, the samples with the old layout are dropped
+            window = PerfMetricWindow_t();
+            for (size_t i = 0; i < p_perf_datas->size(); i++) {
+                for (auto& group_data : (*p_perf_datas)[i]->data) {
+                    for (auto& metric_data : group_data.data) {
+                        window.keys.push_back({(uint32_t)i, (uint32_t)window.groups.size(), metric_data.name});
+                    }
+                    window.groups.emplace_back((uint32_t)i, group_data.name);
+                    window.group_sizes.push_back(group_data.data.size());
+                }
+            }
+            window.tile_count = p_perf_datas->size();
+            window.topdown_totals.resize(window.tile_count);
+            for (auto& key : window.keys) {
+                bool exact = false;
+                window.topdown_counters.push_back(topdownCounterOf(key.metric_name, exact));
+                window.topdown_exact.push_back(exact);
+            }
+        }
+
+        PerfMetricSample_t sample;
+        sample.time = time;
+        sample.values.reserve(window.keys.size());
         for (size_t i = 0; i < p_perf_datas->size(); i++) {
-            std::cout << "Sub device:" << i << std::endl;
-            for (auto group_data : (*p_perf_datas)[i]->data) {
-                std::cout << "Metric group:" << group_data.name << std::endl;
-                for (auto metric_data : group_data.data) {
-                    std::cout << "Metric name:" << metric_data.name << " Value:" << metric_data.average << std::endl;
+            for (auto& group_data : (*p_perf_datas)[i]->data) {
+                sample.group_active_ratios.push_back(group_data.active_ratio);
+                for (auto& metric_data : group_data.data) {
+                    sample.values.push_back(metric_data.average);
                 }
             }
-        }        
+        }
+        sample.topdown.resize(window.tile_count);
+        for (size_t k = 0; k < window.keys.size(); k++) {
+            int counter = window.topdown_counters[k];
+            if (counter < 0) {
+                continue;
+            }
+            auto& counters = sample.topdown[window.keys[k].tile_id];
+            if (window.topdown_exact[k]) {
+                counters.values[counter] = sample.values[k];
+            } else {
+                counters.values[counter] += sample.values[k];
+            }
+        }
+        for (uint32_t t = 0; t < window.tile_count; t++) {
+            window.topdown_totals[t].add(sample.topdown[t]);
+        }
+        window.samples.push_back(std::move(sample));
+        while (!window.samples.empty() && window.samples.front().time + retention < time) {
+            for (uint32_t t = 0; t < window.tile_count; t++) {
+                window.topdown_totals[t].add(window.samples.front().topdown[t], -1);
+            }
+            window.samples.pop_front();
+        }
+    }
+    reportWindowMemory();
+}
+
+void PerfMetricsHandler::getPerfMetricStats(uint32_t device_id, uint32_t window_ms, std::vector<PerfMetricStat_t>& stats) {
+    stats.clear();
+    std::unique_lock<std::mutex> lock(this->window_mutex);
+    auto it = windows.find(device_id);
+    if (it == windows.end() || it->second.samples.empty()) {
+        return;
+    }
+    auto& window = it->second;
+    Timestamp_t latest = window.samples.back().time;
+    stats.resize(window.keys.size());
+    for (size_t k = 0; k < window.keys.size(); k++) {
+        auto& stat = stats[k];
+        stat.tile_id = window.keys[k].tile_id;
+        stat.group_name = window.groups[window.keys[k].group_index].second;
+        stat.metric_name = window.keys[k].metric_name;
+        stat.current = window.samples.back().values[k];
+        stat.average = 0;
+        stat.min = stat.current;
+        stat.max = stat.current;
+        stat.count = 0;
+        stat.active_ratio = window.samples.back().group_active_ratios[window.keys[k].group_index];
+    }
+    for (auto sample = window.samples.rbegin(); sample != window.samples.rend(); ++sample) {
+        if (window_ms > 0 && sample->time + window_ms < latest) {
+            break;
+        }
+        for (size_t k = 0; k < stats.size(); k++) {
+            double value = sample->values[k];
+            stats[k].average += value;
+            stats[k].min = std::min(stats[k].min, value);
+            stats[k].max = std::max(stats[k].max, value);
+            stats[k].count++;
+        }
+    }
+    for (auto& stat : stats) {
+        if (stat.count > 0) {
+            stat.average /= stat.count;
+        }
+    }
+}
+
+void PerfMetricsHandler::getTopdownCounters(uint32_t device_id, uint32_t window_ms, std::vector<TopdownCounters_t>& counters) {
+    counters.clear();
+    std::unique_lock<std::mutex> lock(this->window_mutex);
+    auto it = windows.find(device_id);
+    if (it == windows.end() || it->second.samples.empty()) {
+        return;
+    }
+    auto& window = it->second;
+    Timestamp_t latest = window.samples.back().time;
+    counters.resize(window.tile_count);
+    if (window_ms == 0 || window.samples.front().time + window_ms >= latest) {
+        // the window covers all the kept samples
+        for (uint32_t t = 0; t < window.tile_count; t++) {
+            counters[t].add(window.topdown_totals[t], 1.0 / window.samples.size());
+        }
+        return;
+    }
+    uint32_t count = 0;
+    for (auto sample = window.samples.rbegin(); sample != window.samples.rend() && sample->time + window_ms >= latest; ++sample) {
+        for (uint32_t t = 0; t < window.tile_count; t++) {
+            counters[t].add(sample->topdown[t]);
+        }
+        count++;
+    }
+    for (auto& tile_counters : counters) {
+        for (auto& value : tile_counters.values) {
+            value /= count;
+        }
     }
 }
 
 void PerfMetricsHandler::handleData(std::shared_ptr<SharedData>& p_data) noexcept {
-    if (p_preData == nullptr || p_data == nullptr) {
+    if (p_data == nullptr) {
         return;
     }
 
     calculateData(p_data);
-    updateStatistics(p_data);
+    if (p_preData != nullptr) {
+        updateStatistics(p_data);
+    }
 }
 } // end namespace xpum
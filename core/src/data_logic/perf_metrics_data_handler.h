@@ -6,10 +6,23 @@
 
 #pragma once
 
+#include <deque>
+
+#include "infrastructure/perf_measurement_data.h"
+#include "infrastructure/topdown_analysis.h"
 #include "stats_data_handler.h"
 
 namespace xpum {
 
+/*
+  PerfMetricsHandler keeps the metric averages of each sample of a device in
+  flat arrays, in the order of the metrics of the first sample with the same
+  tiles and groups, for the last Configuration::PERF_METRIC_RETENTION
+  milliseconds. The counters of the top-down analysis of each tile are
+  reduced once per sample, and their sums over the kept samples are updated
+  as samples are added and dropped. While the telemetry caches are over
+  Configuration::TELEMETRY_MEMORY_LIMIT, half of the retention is kept.
+*/
 class PerfMetricsHandler : public StatsDataHandler {
    public:
     PerfMetricsHandler(MeasurementType type, std::shared_ptr<Persistency> &p_persistency);
@@ -20,7 +33,51 @@ class PerfMetricsHandler : public StatsDataHandler {
 
     void calculateData(std::shared_ptr<SharedData> &p_data);
 
+    // the metrics of the device aggregated over the samples of the last window_ms milliseconds,
+    // over all the kept samples if window_ms is 0
+    void getPerfMetricStats(uint32_t device_id, uint32_t window_ms, std::vector<PerfMetricStat_t> &stats);
+
+    // the top-down counters of each tile of the device averaged over the samples of the last
+    // window_ms milliseconds, over all the kept samples if window_ms is 0
+    void getTopdownCounters(uint32_t device_id, uint32_t window_ms, std::vector<TopdownCounters_t> &counters);
+
    private:
-    
+    struct PerfMetricKey_t {
+        uint32_t tile_id;
+        uint32_t group_index;
+        std::string metric_name;
+    };
+
+    struct PerfMetricSample_t {
+        Timestamp_t time;
+        std::vector<double> values;
+        std::vector<double> group_active_ratios;
+        // the top-down counters of each tile
+        std::vector<TopdownCounters_t> topdown;
+    };
+
+    struct PerfMetricWindow_t {
+        // tile id and group name of each group, and the metric count of the group
+        std::vector<std::pair<uint32_t, std::string>> groups;
+        std::vector<size_t> group_sizes;
+        std::vector<PerfMetricKey_t> keys;
+        std::deque<PerfMetricSample_t> samples;
+        uint32_t tile_count = 0;
+        // the top-down counter of each metric, -1 if the metric is not used, and whether it is exact
+        std::vector<int> topdown_counters;
+        std::vector<bool> topdown_exact;
+        // the sums of the top-down counters of each tile over the samples
+        std::vector<TopdownCounters_t> topdown_totals;
+    };
+
+    // whether the layout of the device data is the one of the window
+    static bool sameLayout(const PerfMetricWindow_t &window, PerfMeasurementData &data);
+
+    // report the size of the windows to MemoryAccounting, the caller holds window_mutex
+    void reportWindowMemory();
+
+    std::mutex window_mutex;
+
+    DeviceIndexMap<PerfMetricWindow_t> windows;
 };
 } // end namespace xpum
@@ -1,4 +1,4 @@
-/* 
+/*
  *  Copyright (C) 2021-2023 Intel Corporation
  *  SPDX-License-Identifier: MIT
  *  @file persistency.h
@@ -6,13 +6,29 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 
+#include "infrastructure/device_index_map.h"
 #include "infrastructure/measurement_data.h"
 #include "infrastructure/measurement_type.h"
 
 namespace xpum {
 
+/*
+  Called for every persisted sample of a device, in time order for each
+  subdevice. subdevice_id is UINT32_MAX for device level data, raw is true if
+  value is a raw counter.
+*/
+typedef std::function<void(Timestamp_t time, uint32_t subdevice_id, uint64_t value, uint32_t scale, bool raw)> PersistedSampleVisitor_t;
+
+/*
+  Called for every aggregate of the persisted values of a device that are not
+  raw counters: the samples of a span starting at time, or a single sample
+  with min, max and sum being its value and count 1.
+*/
+typedef std::function<void(Timestamp_t time, uint32_t subdevice_id, uint64_t min, uint64_t max, uint64_t sum, uint64_t count, uint32_t scale)> PersistedAggregateVisitor_t;
+
 class Persistency {
    public:
     virtual ~Persistency(){};
@@ -20,7 +36,38 @@ class Persistency {
     virtual void storeData2PersistentStorage(
         MeasurementType type,
         Timestamp_t time,
-        std::map<std::string, std::shared_ptr<MeasurementData>>& datas) = 0;
+        DeviceIndexMap<std::shared_ptr<MeasurementData>>& datas) = 0;
+
+    /*
+      Visit the persisted samples of device_id in [begin, end]. Returns false if
+      the persistent storage does not keep history.
+    */
+    virtual bool queryPersistentData(
+        MeasurementType type,
+        uint32_t device_id,
+        Timestamp_t begin,
+        Timestamp_t end,
+        const PersistedSampleVisitor_t& visitor) {
+        return false;
+    }
+
+    /*
+      Visit the aggregates of device_id in [begin, end] at the coarsest
+      resolution kept that is not longer than step, or a coarser one if it
+      keeps more of the range. Returns false if the persistent storage does
+      not keep history.
+    */
+    virtual bool queryPersistentAggregates(
+        MeasurementType type,
+        uint32_t device_id,
+        Timestamp_t begin,
+        Timestamp_t end,
+        Timestamp_t step,
+        const PersistedAggregateVisitor_t& visitor) {
+        return false;
+    }
+
+    virtual void flush() {}
 };
 
 } // end namespace xpum
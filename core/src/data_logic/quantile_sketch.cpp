@@ -0,0 +1,121 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file quantile_sketch.cpp
+ */
+
+#include "quantile_sketch.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace xpum {
+
+constexpr double QuantileSketch::RELATIVE_ACCURACY;
+
+const int32_t QuantileSketch::MAX_BINS;
+
+static const double gamma_value = (1 + QuantileSketch::RELATIVE_ACCURACY) / (1 - QuantileSketch::RELATIVE_ACCURACY);
+
+static const double log_gamma = std::log(gamma_value);
+
+int32_t QuantileSketch::indexOf(uint64_t value) {
+    return (int32_t)std::ceil(std::log((double)value) / log_gamma);
+}
+
+double QuantileSketch::valueOf(int32_t index) {
+    return 2 * std::pow(gamma_value, index) / (gamma_value + 1);
+}
+
+size_t QuantileSketch::slotOf(int32_t index) {
+    if (bins.empty()) {
+        bins.assign(1, 0);
+        offset = index;
+        return 0;
+    }
+    int32_t high_index = offset + (int32_t)bins.size() - 1;
+    if (index >= offset && index <= high_index) {
+        return index - offset;
+    }
+    int32_t low = std::min(index, offset);
+    int32_t high = std::max(index, high_index);
+    if (high - low + 1 > MAX_BINS) {
+        low = high - MAX_BINS + 1;
+    }
+    std::vector<uint32_t> resized(high - low + 1, 0);
+    for (size_t i = 0; i < bins.size(); i++) {
+        resized[std::max(offset + (int32_t)i, low) - low] += bins[i];
+    }
+    bins.swap(resized);
+    offset = low;
+    return std::max(index, low) - low;
+}
+
+void QuantileSketch::add(uint64_t value) {
+    count++;
+    sum += value;
+    min = std::min(min, value);
+    max = std::max(max, value);
+    if (value == 0) {
+        zero_count++;
+        return;
+    }
+    bins[slotOf(indexOf(value))]++;
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.count == 0) {
+        return;
+    }
+    count += other.count;
+    sum += other.sum;
+    zero_count += other.zero_count;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    if (other.bins.empty()) {
+        return;
+    }
+    // extend to both ends first, the bins are resized at most twice
+    slotOf(other.offset);
+    slotOf(other.offset + (int32_t)other.bins.size() - 1);
+    for (size_t i = 0; i < other.bins.size(); i++) {
+        if (other.bins[i] != 0) {
+            bins[slotOf(other.offset + (int32_t)i)] += other.bins[i];
+        }
+    }
+}
+
+void QuantileSketch::getBins(std::vector<std::pair<uint64_t, uint64_t>>& result) const {
+    result.clear();
+    if (zero_count > 0) {
+        result.emplace_back(0, zero_count);
+    }
+    for (size_t i = 0; i < bins.size(); i++) {
+        if (bins[i] != 0) {
+            // capped by max, the highest bin ends at the largest value seen
+            uint64_t upper = std::min((uint64_t)std::floor(std::pow(gamma_value, offset + (int32_t)i)), max);
+            result.emplace_back(upper, bins[i]);
+        }
+    }
+}
+
+uint64_t QuantileSketch::quantile(double q) const {
+    if (count == 0) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    uint64_t rank = (uint64_t)(q * (count - 1));
+    if (rank < zero_count) {
+        return 0;
+    }
+    uint64_t seen = zero_count;
+    for (size_t i = 0; i < bins.size(); i++) {
+        seen += bins[i];
+        if (seen > rank) {
+            double value = valueOf(offset + (int32_t)i);
+            return std::min(std::max((uint64_t)std::llround(value), min), max);
+        }
+    }
+    return max;
+}
+
+} // end namespace xpum
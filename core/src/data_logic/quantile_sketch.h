@@ -0,0 +1,84 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file quantile_sketch.h
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace xpum {
+
+/*
+  QuantileSketch estimates the quantiles of a metric in the way of DDSketch:
+  a value v falls into the bin ceil(log_gamma(v)), so every quantile is
+  within RELATIVE_ACCURACY of a value really seen. Only the bins from the
+  lowest to the highest value seen are kept, a power or temperature series
+  needs a few dozen of them. When the range outgrows MAX_BINS the lowest
+  bins are collapsed into one, the high quantiles keep their accuracy.
+
+  Two sketches merge by adding their bins, the result is the sketch of both
+  series. Unlike LatencyHistogram it is not thread safe, the statistics
+  handlers update it under their mutex.
+*/
+class QuantileSketch {
+   public:
+    static constexpr double RELATIVE_ACCURACY = 0.01;
+
+    static const int32_t MAX_BINS = 1024;
+
+    QuantileSketch() : offset(0), zero_count(0), count(0), sum(0), min(std::numeric_limits<uint64_t>::max()), max(0) {}
+
+    void add(uint64_t value);
+
+    void merge(const QuantileSketch& other);
+
+    // the estimate of the q-th quantile, 0 <= q <= 1, UINT64_MAX if nothing is added
+    uint64_t quantile(double q) const;
+
+    uint64_t getCount() const { return count; }
+
+    uint64_t getSum() const { return sum; }
+
+    /*
+      The bins that are not empty, in ascending order, as the largest value
+      falling into each bin and the count of values in it. Zero has a bin of
+      its own.
+    */
+    void getBins(std::vector<std::pair<uint64_t, uint64_t>>& result) const;
+
+    // the heap held by the bins, for MemoryAccounting
+    uint64_t memoryBytes() const { return bins.capacity() * sizeof(uint32_t); }
+
+   private:
+    static int32_t indexOf(uint64_t value);
+
+    // the representative value of the bin, the middle of it in relative terms
+    static double valueOf(int32_t index);
+
+    // the position in bins counting index, the bins are extended or collapsed to hold it
+    size_t slotOf(int32_t index);
+
+    // the bin index of bins[0]
+    int32_t offset;
+
+    std::vector<uint32_t> bins;
+
+    // zero has no logarithm, it is counted apart
+    uint64_t zero_count;
+
+    uint64_t count;
+
+    uint64_t sum;
+
+    uint64_t min;
+
+    uint64_t max;
+};
+
+} // end namespace xpum
@@ -10,20 +10,18 @@ namespace xpum {
 
 SharedData::SharedData(
     Timestamp_t time,
-    std::shared_ptr<std::map<std::string, std::shared_ptr<MeasurementData>>> datas) {
-    for (auto it = datas->begin(); it != datas->end(); it++) {
-        this->datas[it->first] = (it->second);
+    std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas)
+    : time(time), datas(std::move(datas)) {
+    if (this->datas == nullptr) {
+        this->datas = std::make_shared<DeviceIndexMap<std::shared_ptr<MeasurementData>>>();
     }
-
-    this->time = time;
 }
 
 SharedData::~SharedData() {
-    datas.clear();
 }
 
-std::map<std::string, std::shared_ptr<MeasurementData>>& SharedData::getData() noexcept {
-    return this->datas;
+DeviceIndexMap<std::shared_ptr<MeasurementData>>& SharedData::getData() noexcept {
+    return *this->datas;
 }
 
 Timestamp_t SharedData::getTime() noexcept {
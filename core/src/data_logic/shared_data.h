@@ -9,25 +9,32 @@
 #include <map>
 
 #include "infrastructure/const.h"
+#include "infrastructure/device_index_map.h"
 #include "infrastructure/measurement_data.h"
 
 namespace xpum {
 
+/*
+  SharedData is the data of one type from one monitor tick, by the dense
+  index of the devices. It shares the map of the tick with the listeners of
+  the data logic rather than copying it, so the map is not changed after it
+  is stored.
+*/
 class SharedData {
    public:
-    SharedData(Timestamp_t time, std::shared_ptr<std::map<std::string, std::shared_ptr<MeasurementData>>> datas);
+    SharedData(Timestamp_t time, std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas);
 
     virtual ~SharedData();
 
    public:
-    std::map<std::string, std::shared_ptr<MeasurementData>>& getData() noexcept;
+    DeviceIndexMap<std::shared_ptr<MeasurementData>>& getData() noexcept;
 
     Timestamp_t getTime() noexcept;
 
    private:
     Timestamp_t time;
 
-    std::map<std::string, std::shared_ptr<MeasurementData>> datas;
+    std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas;
 };
 
 } // end namespace xpum
@@ -9,107 +9,180 @@
 #include <iostream>
 
 #include "infrastructure/configuration.h"
+#include "infrastructure/memory_accounting.h"
+#include "infrastructure/metric_descriptor.h"
 #include "infrastructure/utility.h"
 
 namespace xpum {
 
 StatsDataHandler::StatsDataHandler(MeasurementType type,
                                                          std::shared_ptr<Persistency>& p_persistency)
-    : DataHandler(type, p_persistency) {
+    : DataHandler(type, p_persistency), track_percentiles(!Utility::isCounterMetric(type)) {
+    multi_sessions_data[StatsSessions::INITIAL_EPOCH];
+    auto descriptor = getMetricDescriptor(type);
+    track_histograms = descriptor != nullptr && descriptor->histogram && track_percentiles;
+    memory_name = std::string("statistics of ") + (descriptor != nullptr && descriptor->name[0] != '\0' ? descriptor->name : "metric " + std::to_string(type));
 }
 
 StatsDataHandler::~StatsDataHandler() {
     close();
+    MemoryAccounting::instance().remove(memory_name);
 }
 
-void StatsDataHandler::resetStatistics(std::string& device_id, uint64_t session_id) {
-    if (multi_sessions_data.find(session_id) != multi_sessions_data.end()) {
-        multi_sessions_data[session_id].erase(device_id);
+void StatsDataHandler::reportMemory() {
+    uint64_t devices = 0;
+    uint64_t subdevices = 0;
+    uint64_t sketch_bytes = 0;
+    // the device slots are allocated up to the largest device index
+    uint64_t slot_bytes = histograms.capacity() * sizeof(DeviceIndexMap<std::map<uint32_t, QuantileSketch>>::value_type);
+    for (auto& epoch : multi_sessions_data) {
+        devices += epoch.second.size();
+        slot_bytes += epoch.second.capacity() * sizeof(DeviceIndexMap<Statistics_data>::value_type);
+        for (auto& device_stats : epoch.second) {
+            subdevices += device_stats.second.subdevice_datas.size();
+            sketch_bytes += device_stats.second.sketch.memoryBytes();
+            for (auto& subdevice_stats : device_stats.second.subdevice_datas) {
+                sketch_bytes += subdevice_stats.second.sketch.memoryBytes();
+            }
+        }
+    }
+    for (auto& device_histograms : histograms) {
+        subdevices += device_histograms.second.size();
+        for (auto& histogram : device_histograms.second) {
+            sketch_bytes += histogram.second.memoryBytes();
+        }
+    }
+    uint64_t bytes = slot_bytes + subdevices * MemoryAccounting::mapNodeSize<uint32_t, Statistics_subdevice_data>() + sketch_bytes;
+    MemoryAccounting::instance().report(memory_name, bytes, devices + subdevices);
+}
+
+void StatsDataHandler::resetStatistics(uint32_t device_id, uint64_t session_id) {
+    std::vector<uint64_t> released;
+    uint64_t epoch = sessions.reset(session_id, device_id, released);
+    // the new epoch starts with the next update
+    multi_sessions_data[epoch];
+    for (auto& released_epoch : released) {
+        multi_sessions_data.erase(released_epoch);
     }
 }
 
 void StatsDataHandler::updateStatistics(std::shared_ptr<SharedData>& p_data) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    std::map<std::string, std::shared_ptr<MeasurementData>>::iterator iter = p_data->getData().begin();
-    while (iter != p_data->getData().end()) {
-        auto &deviceId = iter->first;
-        auto &measurementData = iter->second;
-        for (uint64_t session = 0; session < Configuration::MAX_STATISTICS_SESSION_NUM; session++) {
-            std::map<std::string, Statistics_data>::iterator iter_statistics = multi_sessions_data[session].find(deviceId);
-            if (iter_statistics != multi_sessions_data[session].end()) {
-                auto &stats = iter_statistics->second;
-                stats.count++;
-                if (measurementData->hasDataOnDevice()) {
-                    stats.hasDataOnDevice = true;
-                    if (measurementData->getCurrent() < stats.min) {
-                        stats.min = measurementData->getCurrent();
-                    }
-                    if (measurementData->getCurrent() > stats.max) {
-                        stats.max = measurementData->getCurrent();
-                    }
-                    stats.avg = stats.avg * (stats.count - 1) * 1.0 / stats.count + measurementData->getCurrent() * 1.0 / stats.count;
-                } else {
-                    stats.hasDataOnDevice = false;
+    updateBatchStatistics(p_data->getData(), p_data->getTime());
+    sessions.seal();
+    reportMemory();
+}
+
+void StatsDataHandler::updateBatchStatistics(DeviceIndexMap<std::shared_ptr<MeasurementData>>& datas, long long time) {
+    const uint64_t invalid = std::numeric_limits<uint64_t>::max();
+    for (auto& epoch : multi_sessions_data) {
+        auto& epoch_data = epoch.second;
+        epoch_data.reserve(datas.capacity());
+        for (auto& entry : datas) {
+            auto& deviceId = entry.first;
+            auto& measurementData = entry.second;
+            if (measurementData == nullptr) {
+                continue;
+            }
+            auto iter_statistics = epoch_data.find(deviceId);
+            auto p_subdevice_datas = measurementData->getSubdeviceDatas();
+            if (iter_statistics != epoch_data.end()) {
+                iter_statistics->second.add(measurementData->hasDataOnDevice(), measurementData->getCurrent(), time);
+                if (track_percentiles && measurementData->hasDataOnDevice()) {
+                    iter_statistics->second.sketch.add(measurementData->getCurrent());
                 }
-                stats.latest_time = p_data->getTime();
-            } else {
-                if (measurementData->getCurrent() != std::numeric_limits<uint64_t>::max()) {
-                    multi_sessions_data[session].insert(std::make_pair(deviceId, Statistics_data(measurementData->getCurrent(), p_data->getTime())));
+            } else if (measurementData->getCurrent() != invalid) {
+                iter_statistics = epoch_data.emplace(deviceId, Statistics_data(measurementData->getCurrent(), time)).first;
+                if (track_percentiles) {
+                    iter_statistics->second.sketch.add(measurementData->getCurrent());
                 }
+            } else if (!p_subdevice_datas->empty()) {
+                // the statistics of the first sub-device start with the device, it is also added below
+                auto& first = *p_subdevice_datas->begin();
+                iter_statistics = epoch_data.emplace(deviceId, Statistics_data(first.first, first.second.current, time)).first;
+            } else {
+                continue;
             }
 
-            std::map<uint32_t, SubdeviceData>::const_iterator iter_subdevice = measurementData->getSubdeviceDatas()->begin();
-            while (iter_subdevice != measurementData->getSubdeviceDatas()->end()) {
-                auto &subDeviceId = iter_subdevice->first;
-                if (multi_sessions_data[session].find(deviceId) == multi_sessions_data[session].end()) {
-                    multi_sessions_data[session].insert(std::make_pair(deviceId, Statistics_data(subDeviceId, measurementData->getSubdeviceDataCurrent(subDeviceId), p_data->getTime())));
-                    continue;
+            auto& subdevice_statistics = iter_statistics->second.subdevice_datas;
+            auto iter_subdevice_statistics = subdevice_statistics.begin();
+            for (auto& sub : *p_subdevice_datas) {
+                uint64_t current_data = sub.second.current;
+                while (iter_subdevice_statistics != subdevice_statistics.end() && iter_subdevice_statistics->first < sub.first) {
+                    ++iter_subdevice_statistics;
                 }
-                std::map<uint32_t, Statistics_subdevice_data>::iterator iter_subdevice_statistics = multi_sessions_data[session].find(deviceId)->second.subdevice_datas.find(subDeviceId);
-                if (iter_subdevice_statistics != multi_sessions_data[session].find(deviceId)->second.subdevice_datas.end()) {
-                    auto &subStats = iter_subdevice_statistics->second;
-                    if (measurementData->getSubdeviceDataCurrent(subDeviceId) != std::numeric_limits<uint64_t>::max()) {
-                        subStats.count++;
-                        uint64_t current_data = measurementData->getSubdeviceDataCurrent(subDeviceId);
-                        if (current_data < subStats.min) {
-                            subStats.min = current_data;
-                        }
-                        if (current_data > subStats.max) {
-                            subStats.max = current_data;
+                if (iter_subdevice_statistics != subdevice_statistics.end() && iter_subdevice_statistics->first == sub.first) {
+                    if (current_data != invalid) {
+                        iter_subdevice_statistics->second.add(current_data);
+                        if (track_percentiles) {
+                            iter_subdevice_statistics->second.sketch.add(current_data);
                         }
-                        subStats.avg = (subStats.avg * (subStats.count - 1) + measurementData->getSubdeviceDataCurrent(iter_subdevice_statistics->first)) * 1.0 / subStats.count;
                     }
-                } else {
-                    if (measurementData->getSubdeviceDataCurrent(subDeviceId) != std::numeric_limits<uint64_t>::max()) {
-                        if (multi_sessions_data[session].find(deviceId) == multi_sessions_data[session].end()) {
-                            multi_sessions_data[session].insert(std::make_pair(deviceId, Statistics_data(subDeviceId, measurementData->getSubdeviceDataCurrent(subDeviceId), p_data->getTime())));
-                        } else {
-                            multi_sessions_data[session].find(deviceId)->second.subdevice_datas.insert(std::make_pair(subDeviceId, Statistics_subdevice_data(measurementData->getSubdeviceDataCurrent(subDeviceId))));
-                        }
+                } else if (current_data != invalid) {
+                    iter_subdevice_statistics = subdevice_statistics.emplace_hint(iter_subdevice_statistics, sub.first, Statistics_subdevice_data(current_data));
+                    if (track_percentiles) {
+                        iter_subdevice_statistics->second.sketch.add(current_data);
                     }
                 }
-                ++iter_subdevice;
             }
         }
-        ++iter;
     }
+    if (track_histograms) {
+        updateHistograms(datas);
+    }
+}
+
+void StatsDataHandler::updateHistograms(DeviceIndexMap<std::shared_ptr<MeasurementData>>& datas) {
+    const uint64_t invalid = std::numeric_limits<uint64_t>::max();
+    for (auto& entry : datas) {
+        auto& measurementData = entry.second;
+        if (measurementData == nullptr) {
+            continue;
+        }
+        auto p_subdevice_datas = measurementData->getSubdeviceDatas();
+        bool has_device_data = measurementData->hasDataOnDevice() && measurementData->getCurrent() != invalid;
+        if (!has_device_data && p_subdevice_datas->empty()) {
+            continue;
+        }
+        auto& device_histograms = histograms[entry.first];
+        if (has_device_data) {
+            device_histograms[UINT32_MAX].add(measurementData->getCurrent());
+        }
+        for (auto& sub : *p_subdevice_datas) {
+            if (sub.second.current != invalid) {
+                device_histograms[sub.first].add(sub.second.current);
+            }
+        }
+    }
+}
+
+void StatsDataHandler::getHistograms(uint32_t device_id, std::map<uint32_t, QuantileSketch>& result) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    auto iter = histograms.find(device_id);
+    if (iter == histograms.end()) {
+        result.clear();
+        return;
+    }
+    result = iter->second;
 }
 
 void StatsDataHandler::handleData(std::shared_ptr<SharedData>& p_data) noexcept {
     updateStatistics(p_data);
 }
 
-std::shared_ptr<MeasurementData> StatsDataHandler::getLatestStatistics(std::string& device_id, uint64_t session_id) noexcept {
+std::shared_ptr<MeasurementData> StatsDataHandler::getLatestStatistics(uint32_t device_id, uint64_t session_id) noexcept {
     std::unique_lock<std::mutex> lock(this->mutex);
     if (p_latestData == nullptr) {
         return nullptr;
     }
 
-    auto datas = p_latestData->getData();
+    // datas[device_id] is only used after find, the map is not copied
+    auto& datas = p_latestData->getData();
     if (datas.find(device_id) != datas.end() && datas[device_id] != nullptr) {
         datas[device_id]->setAvg(datas[device_id]->getCurrent());
         datas[device_id]->setMin(datas[device_id]->getCurrent());
         datas[device_id]->setMax(datas[device_id]->getCurrent());
+        datas[device_id]->setPercentiles(datas[device_id]->getCurrent(), datas[device_id]->getCurrent(), datas[device_id]->getCurrent());
         datas[device_id]->setStartTime(datas[device_id]->getTimestamp());
         datas[device_id]->setLatestTime(datas[device_id]->getTimestamp());
         auto sub = datas[device_id]->getSubdeviceDatas()->begin();
@@ -119,17 +192,20 @@ std::shared_ptr<MeasurementData> StatsDataHandler::getLatestStatistics(std::stri
             sub->second.avg = sub->second.current;
             sub->second.min = sub->second.current;
             sub->second.max = sub->second.current;
+            sub->second.p50 = sub->second.p90 = sub->second.p99 = sub->second.current;
             sub++;
         }
     }
 
-    if (multi_sessions_data.find(session_id) != multi_sessions_data.end() && datas.find(device_id) != datas.end() && datas[device_id] != nullptr) {
-        std::map<std::string, Statistics_data>::iterator iter = multi_sessions_data[session_id].find(device_id);
-        auto &stats = iter->second;
-        if (iter != multi_sessions_data[session_id].end()) {
+    auto epoch_iter = multi_sessions_data.find(sessions.getEpoch(session_id, device_id));
+    if (epoch_iter != multi_sessions_data.end() && datas.find(device_id) != datas.end() && datas[device_id] != nullptr) {
+        auto iter = epoch_iter->second.find(device_id);
+        if (iter != epoch_iter->second.end()) {
+            auto &stats = iter->second;
             datas[device_id]->setAvg(stats.avg);
             datas[device_id]->setMin(stats.min);
             datas[device_id]->setMax(stats.max);
+            datas[device_id]->setPercentiles(stats.sketch.quantile(0.5), stats.sketch.quantile(0.9), stats.sketch.quantile(0.99));
             datas[device_id]->setStartTime(stats.start_time);
             datas[device_id]->setLatestTime(stats.latest_time);
             //The first sub is subDeviceId 
@@ -138,6 +214,7 @@ std::shared_ptr<MeasurementData> StatsDataHandler::getLatestStatistics(std::stri
                 datas[device_id]->setSubdeviceDataAvg(sub.first, sub.second.avg);
                 datas[device_id]->setSubdeviceDataMin(sub.first, sub.second.min);
                 datas[device_id]->setSubdeviceDataMax(sub.first, sub.second.max);
+                datas[device_id]->setSubdeviceDataPercentiles(sub.first, sub.second.sketch.quantile(0.5), sub.second.sketch.quantile(0.9), sub.second.sketch.quantile(0.99));
             }
             resetStatistics(device_id, session_id);
         }
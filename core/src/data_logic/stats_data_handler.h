@@ -7,6 +7,8 @@
 #pragma once
 
 #include "data_handler.h"
+#include "quantile_sketch.h"
+#include "stats_sessions.h"
 
 namespace xpum {
 
@@ -15,12 +17,23 @@ struct Statistics_subdevice_data {
     uint64_t avg;
     uint64_t min;
     uint64_t max;
+    QuantileSketch sketch;
     Statistics_subdevice_data(uint64_t data) {
         min = data;
         max = data;
         avg = data;
         count = 1;
     }
+    void add(uint64_t data) {
+        count++;
+        if (data < min) {
+            min = data;
+        }
+        if (data > max) {
+            max = data;
+        }
+        avg = (avg * (count - 1) + data) * 1.0 / count;
+    }
 };
 
 struct Statistics_data {
@@ -31,7 +44,9 @@ struct Statistics_data {
     long long start_time;
     long long latest_time;
     bool hasDataOnDevice;
+    QuantileSketch sketch;
     std::map<uint32_t, Statistics_subdevice_data> subdevice_datas;
+    Statistics_data() : count(0), avg(0), min(0), max(0), start_time(0), latest_time(0), hasDataOnDevice(false) {}
     Statistics_data(uint64_t data, long long time) {
         min = data;
         max = data;
@@ -51,6 +66,21 @@ struct Statistics_data {
         latest_time = time;
         hasDataOnDevice = false;
     }
+    // a sample counts even without device data, then the device has no statistics
+    void add(bool has_data, uint64_t data, long long time) {
+        count++;
+        hasDataOnDevice = has_data;
+        if (has_data) {
+            if (data < min) {
+                min = data;
+            }
+            if (data > max) {
+                max = data;
+            }
+            avg = avg * (count - 1) * 1.0 / count + data * 1.0 / count;
+        }
+        latest_time = time;
+    }
 };
 
 class StatsDataHandler : public DataHandler {
@@ -61,14 +91,47 @@ class StatsDataHandler : public DataHandler {
 
     virtual void handleData(std::shared_ptr<SharedData> &p_data) noexcept;
 
-    virtual std::shared_ptr<MeasurementData> getLatestStatistics(std::string &device_id, uint64_t session_id) noexcept;
+    virtual std::shared_ptr<MeasurementData> getLatestStatistics(uint32_t device_id, uint64_t session_id) noexcept;
+
+    /*
+      The histograms of every sample of the device since the start, by
+      sub-device ID, UINT32_MAX for the device. They are never reset, so a
+      scraper reads them as cumulative counters. Empty if the metric has no
+      histogram.
+    */
+    void getHistograms(uint32_t device_id, std::map<uint32_t, QuantileSketch> &histograms);
 
    protected:
-    void resetStatistics(std::string &device_id, uint64_t session_id);
+    void resetStatistics(uint32_t device_id, uint64_t session_id);
 
     void updateStatistics(std::shared_ptr<SharedData> &p_data);
 
-    //The map index is session ID, the second map index is device ID
-    std::map<uint64_t, std::map<std::string, Statistics_data>> multi_sessions_data;
+    /*
+      Update the statistics of all the epochs with the samples of one tick, the
+      caller holds the mutex. The samples and the statistics of an epoch are
+      both indexed by the device index, so a device is found without a string
+      compare, and the sub-device tables are walked in sub-device ID order.
+    */
+    void updateBatchStatistics(DeviceIndexMap<std::shared_ptr<MeasurementData>> &datas, long long time);
+
+    // report the size of the statistics to MemoryAccounting, the caller holds the mutex
+    void reportMemory();
+
+    // the percentiles of the samples are sketched for the metrics that are not counters
+    bool track_percentiles;
+
+    bool track_histograms;
+
+    // the device index map index, the sub-device ID map index, UINT32_MAX for the device
+    DeviceIndexMap<std::map<uint32_t, QuantileSketch>> histograms;
+
+    void updateHistograms(DeviceIndexMap<std::shared_ptr<MeasurementData>> &datas);
+
+    StatsSessions sessions;
+
+    std::string memory_name;
+
+    //The map index is epoch ID, the second map index is device index
+    std::map<uint64_t, DeviceIndexMap<Statistics_data>> multi_sessions_data;
 };
 } // end namespace xpum
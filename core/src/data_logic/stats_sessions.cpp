@@ -0,0 +1,55 @@
+/* 
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file stats_sessions.cpp
+ */
+
+#include "stats_sessions.h"
+
+namespace xpum {
+
+const uint64_t StatsSessions::INITIAL_EPOCH;
+
+StatsSessions::StatsSessions() : next_epoch(INITIAL_EPOCH + 1), has_pending_epoch(false) {
+}
+
+uint64_t StatsSessions::getEpoch(uint64_t session_id, uint32_t device_id) const {
+    auto session_iter = session_epochs.find(session_id);
+    if (session_iter == session_epochs.end()) {
+        return INITIAL_EPOCH;
+    }
+    auto device_iter = session_iter->second.find(device_id);
+    if (device_iter == session_iter->second.end()) {
+        return INITIAL_EPOCH;
+    }
+    return device_iter->second;
+}
+
+uint64_t StatsSessions::reset(uint64_t session_id, uint32_t device_id, std::vector<uint64_t>& released) {
+    if (!has_pending_epoch) {
+        next_epoch++;
+        has_pending_epoch = true;
+    }
+    uint64_t pending_epoch = next_epoch - 1;
+
+    uint64_t old_epoch = getEpoch(session_id, device_id);
+    if (old_epoch == pending_epoch) {
+        return pending_epoch;
+    }
+    session_epochs[session_id][device_id] = pending_epoch;
+    epoch_refs[pending_epoch]++;
+    if (old_epoch != INITIAL_EPOCH) {
+        auto iter = epoch_refs.find(old_epoch);
+        if (iter != epoch_refs.end() && --iter->second == 0) {
+            epoch_refs.erase(iter);
+            released.push_back(old_epoch);
+        }
+    }
+    return pending_epoch;
+}
+
+void StatsSessions::seal() {
+    has_pending_epoch = false;
+}
+
+} // end namespace xpum
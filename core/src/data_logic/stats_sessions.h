@@ -0,0 +1,56 @@
+/* 
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file stats_sessions.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "infrastructure/device_index_map.h"
+
+namespace xpum {
+
+/*
+  StatsSessions maps statistics sessions to epochs. An epoch is one set of
+  statistics accumulated since the tick it started at. Sessions reset before
+  the same tick share one epoch, so the statistics handlers update each
+  epoch once per tick, however many sessions read from it. Sessions that
+  have never been reset read from INITIAL_EPOCH, which starts at the first
+  data.
+*/
+class StatsSessions {
+   public:
+    static const uint64_t INITIAL_EPOCH = 0;
+
+    StatsSessions();
+
+    // the epoch session_id reads the statistics of device_id from
+    uint64_t getEpoch(uint64_t session_id, uint32_t device_id) const;
+
+    /*
+      Move session_id of device_id to the epoch started by the next update and
+      return that epoch. Epochs that no session reads from anymore are added
+      to released.
+    */
+    uint64_t reset(uint64_t session_id, uint32_t device_id, std::vector<uint64_t>& released);
+
+    // called by every update, a reset after it starts a new epoch
+    void seal();
+
+   private:
+    uint64_t next_epoch;
+
+    bool has_pending_epoch;
+
+    // the session id map index, the device index map index
+    std::map<uint64_t, DeviceIndexMap<uint64_t>> session_epochs;
+
+    // the number of (session, device) pairs reading from each epoch
+    std::map<uint64_t, uint32_t> epoch_refs;
+};
+
+} // end namespace xpum
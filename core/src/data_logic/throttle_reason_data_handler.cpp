@@ -0,0 +1,127 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file throttle_reason_data_handler.cpp
+ */
+
+#include "throttle_reason_data_handler.h"
+
+#include "device/device.h"
+#include "infrastructure/configuration.h"
+#include "infrastructure/memory_accounting.h"
+
+namespace xpum {
+
+const uint32_t ThrottleReasonDataHandler::MAX_GAP_FACTOR;
+
+static const char* residency_memory_name = "throttle reason residency";
+
+ThrottleReasonDataHandler::ThrottleReasonDataHandler(MeasurementType type,
+                                                     std::shared_ptr<Persistency>& p_persistency)
+    : StatsDataHandler(type, p_persistency) {
+}
+
+ThrottleReasonDataHandler::~ThrottleReasonDataHandler() {
+    close();
+    MemoryAccounting::instance().remove(residency_memory_name);
+}
+
+void ThrottleReasonDataHandler::handleData(std::shared_ptr<SharedData>& p_data) noexcept {
+    updateStatistics(p_data);
+    updateResidencies(p_data);
+}
+
+void ThrottleReasonDataHandler::accumulate(ResidencyState& state, uint64_t flags, Timestamp_t time) {
+    Timestamp_t interval = time - state.last_time;
+    Timestamp_t max_gap = (Timestamp_t)Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE * MAX_GAP_FACTOR;
+    bool first = state.last_time == 0;
+    state.last_time = time;
+    if (first || interval <= 0 || interval > max_gap) {
+        return;
+    }
+    auto& residency = state.residency;
+    residency.sampled += interval;
+    if (flags == 0) {
+        return;
+    }
+    residency.throttled += interval;
+    for (int reason = 0; reason < THROTTLE_REASON_COUNT; reason++) {
+        if (flags & (1ULL << reason)) {
+            residency.reasons[reason] += interval;
+        }
+    }
+}
+
+void ThrottleReasonDataHandler::updateResidencies(std::shared_ptr<SharedData>& p_data) {
+    const uint64_t invalid = std::numeric_limits<uint64_t>::max();
+    Timestamp_t time = p_data->getTime();
+    std::unique_lock<std::mutex> lock(this->mutex);
+    uint64_t entries = 0;
+    for (auto& entry : p_data->getData()) {
+        auto& measurementData = entry.second;
+        if (measurementData == nullptr) {
+            continue;
+        }
+        auto& device_states = residency_states[entry.first];
+        if (measurementData->hasDataOnDevice() && measurementData->getCurrent() != invalid) {
+            accumulate(device_states[UINT32_MAX], measurementData->getCurrent(), time);
+        }
+        for (auto& sub : *measurementData->getSubdeviceDatas()) {
+            if (sub.second.current != invalid) {
+                accumulate(device_states[sub.first], sub.second.current, time);
+            }
+        }
+    }
+    for (auto& device_states : residency_states) {
+        entries += device_states.second.size();
+    }
+    MemoryAccounting::instance().report(residency_memory_name, entries * MemoryAccounting::mapNodeSize<uint32_t, ResidencyState>(), entries);
+}
+
+void ThrottleReasonDataHandler::getResidencies(uint32_t device_id, std::map<uint32_t, ThrottleResidency_t>& residencies) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    residencies.clear();
+    auto iter = residency_states.find(device_id);
+    if (iter == residency_states.end()) {
+        return;
+    }
+    for (auto& state : iter->second) {
+        residencies[state.first] = state.second.residency;
+    }
+}
+
+void ThrottleReasonDataHandler::saveResidencies(std::vector<CheckpointRecord>& records) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    for (auto& device_states : residency_states) {
+        for (auto& state : device_states.second) {
+            auto& residency = state.second.residency;
+            CheckpointRecord record;
+            record.device_id = std::to_string(device_states.first);
+            record.subdevice_id = state.first;
+            record.values[0] = residency.sampled;
+            record.values[1] = residency.throttled;
+            for (int reason = 0; reason < THROTTLE_REASON_COUNT; reason++) {
+                record.values[2 + reason] = residency.reasons[reason];
+            }
+            records.push_back(record);
+        }
+    }
+}
+
+void ThrottleReasonDataHandler::restoreResidencies(const std::vector<CheckpointRecord>& records) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    for (auto& record : records) {
+        uint32_t device_index;
+        if (!Device::toIndex(record.device_id, device_index)) {
+            continue;
+        }
+        auto& residency = residency_states[device_index][record.subdevice_id].residency;
+        residency.sampled += record.values[0];
+        residency.throttled += record.values[1];
+        for (int reason = 0; reason < THROTTLE_REASON_COUNT; reason++) {
+            residency.reasons[reason] += record.values[2 + reason];
+        }
+    }
+}
+
+} // end namespace xpum
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file throttle_reason_data_handler.h
+ */
+
+#pragma once
+
+#include "infrastructure/telemetry_checkpoint.h"
+#include "stats_data_handler.h"
+
+namespace xpum {
+
+// the reasons in the bit order of zes_freq_throttle_reason_flags_t
+enum ThrottleReason {
+    THROTTLE_REASON_AVE_PWR_CAP,
+    THROTTLE_REASON_BURST_PWR_CAP,
+    THROTTLE_REASON_CURRENT_LIMIT,
+    THROTTLE_REASON_THERMAL_LIMIT,
+    THROTTLE_REASON_PSU_ALERT,
+    THROTTLE_REASON_SW_RANGE,
+    THROTTLE_REASON_HW_RANGE,
+    THROTTLE_REASON_COUNT,
+};
+
+// the milliseconds a device or a tile spent with each throttle reason since the start
+struct ThrottleResidency_t {
+    // the time covered by the samples, the gaps in the sampling are left out
+    uint64_t sampled;
+    // the time with any reason
+    uint64_t throttled;
+    uint64_t reasons[THROTTLE_REASON_COUNT];
+};
+
+/*
+  ThrottleReasonDataHandler keeps the statistics of the throttle reason flags
+  like StatsDataHandler, and accumulates the residency of each reason. The
+  interval since the previous sample of a device or a tile is charged to the
+  reasons of the new sample, so the residency grows at the sampling rate and
+  a reason seen in a single sample is still counted. An interval longer than
+  MAX_GAP_FACTOR monitor periods is a gap in the sampling and is not charged.
+*/
+class ThrottleReasonDataHandler : public StatsDataHandler {
+   public:
+    static const uint32_t MAX_GAP_FACTOR = 3;
+
+    ThrottleReasonDataHandler(MeasurementType type, std::shared_ptr<Persistency> &p_persistency);
+
+    virtual ~ThrottleReasonDataHandler();
+
+    virtual void handleData(std::shared_ptr<SharedData> &p_data) noexcept;
+
+    // the residencies of the device by sub-device ID, UINT32_MAX for the device, they are never reset
+    void getResidencies(uint32_t device_id, std::map<uint32_t, ThrottleResidency_t> &residencies);
+
+    // the residencies as TelemetryCheckpoint records, sampled, throttled and the reasons in order
+    void saveResidencies(std::vector<CheckpointRecord> &records);
+
+    // the residencies of a checkpoint are added to the ones counted since the start
+    void restoreResidencies(const std::vector<CheckpointRecord> &records);
+
+   private:
+    struct ResidencyState {
+        ThrottleResidency_t residency;
+        Timestamp_t last_time;
+    };
+
+    void accumulate(ResidencyState &state, uint64_t flags, Timestamp_t time);
+
+    void updateResidencies(std::shared_ptr<SharedData> &p_data);
+
+    // the device index map index, the sub-device ID map index, UINT32_MAX for the device
+    DeviceIndexMap<std::map<uint32_t, ResidencyState>> residency_states;
+};
+} // end namespace xpum
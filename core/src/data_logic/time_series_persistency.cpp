@@ -0,0 +1,770 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file time_series_persistency.cpp
+ */
+
+#include "time_series_persistency.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <set>
+#include <tuple>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/logger.h"
+#include "infrastructure/numa_memory.h"
+
+namespace xpum {
+
+namespace {
+
+const char TS_FILE_MAGIC[8] = {'X', 'P', 'U', 'M', 'T', 'S', '0', '1'};
+const uint32_t TS_FILE_VERSION = 1;
+const uint32_t TS_FILE_HEADER_SIZE = 4096;
+const uint32_t TS_SLOT_SIZE = 8192;
+const uint32_t TS_SLOT_MAGIC = 0x42535458;
+const uint32_t TS_BLOCK_MAX_SAMPLES = 120;
+const Timestamp_t TS_BLOCK_MAX_TIME_SPAN = 60 * 1000;
+// upper bound of the bytes a new column adds to the encoded block besides its values
+const size_t TS_COLUMN_HEADER_MAX_SIZE = 32;
+const size_t TS_VARINT_MAX_SIZE = 10;
+// a block of a rollup file covers more points, they are sealed as the slot gets full
+const uint32_t TS_ROLLUP_BLOCK_MAX_SAMPLES = 480;
+const Timestamp_t TS_ROLLUP_RESOLUTIONS[] = {10 * 1000, 60 * 1000};
+const char* const TS_ROLLUP_NAMES[] = {"10s", "1m"};
+const uint32_t TS_ROLLUP_FIELD_COUNT = 4;
+
+// the fields of the columns, the samples of the raw file are values
+enum TimeSeriesField {
+    TS_FIELD_VALUE = 0,
+    TS_FIELD_MIN = 1,
+    TS_FIELD_MAX = 2,
+    TS_FIELD_AVG = 3,
+    TS_FIELD_COUNT = 4,
+};
+
+struct TimeSeriesFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t metric_type;
+    uint32_t slot_size;
+    uint32_t slot_count;
+};
+
+size_t putVarint(std::string& out, uint64_t value) {
+    size_t size = 0;
+    while (value >= 0x80) {
+        out.push_back((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+        size++;
+    }
+    out.push_back((char)value);
+    return size + 1;
+}
+
+bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t zigzagEncode(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+int64_t zigzagDecode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+uint32_t checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool createDirectories(const std::string& dir) {
+    std::string path;
+    for (size_t pos = 0; pos != std::string::npos;) {
+        pos = dir.find('/', pos + 1);
+        path = dir.substr(0, pos);
+        if (path.empty()) {
+            continue;
+        }
+        if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+  The raw file holds PERSISTENCY_RETENTION hours when PERSISTENCY_FILE_SIZE is
+  not set. A block is sealed after TS_BLOCK_MAX_SAMPLES samples or
+  TS_BLOCK_MAX_TIME_SPAN, whichever comes first, and takes a whole slot, so
+  the file needs a slot per block span of the retention plus the slot being
+  overwritten.
+*/
+uint32_t rawFileSize() {
+    if (Configuration::PERSISTENCY_FILE_SIZE > 0) {
+        return Configuration::PERSISTENCY_FILE_SIZE;
+    }
+    uint64_t interval = Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE > 0 ? Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE : 1;
+    uint64_t block_span = std::min<uint64_t>(TS_BLOCK_MAX_SAMPLES * interval, TS_BLOCK_MAX_TIME_SPAN);
+    uint64_t retention = (uint64_t)Configuration::PERSISTENCY_RETENTION * 3600 * 1000;
+    uint64_t slots = (retention + block_span - 1) / block_span + 1;
+    uint64_t size = TS_FILE_HEADER_SIZE + slots * TS_SLOT_SIZE;
+    uint64_t max_size = TS_FILE_HEADER_SIZE + (uint64_t)((UINT32_MAX - TS_FILE_HEADER_SIZE) / TS_SLOT_SIZE) * TS_SLOT_SIZE;
+    return (uint32_t)std::min(size, max_size);
+}
+
+} // namespace
+
+TimeSeriesRingFile::TimeSeriesRingFile(const std::string& path, MeasurementType type, uint32_t file_size)
+    : path(path),
+      type(type),
+      file_size(file_size),
+      slot_count(0),
+      fd(-1),
+      base(nullptr),
+      head(0),
+      next_sequence(1) {
+}
+
+TimeSeriesRingFile::~TimeSeriesRingFile() {
+    close();
+}
+
+uint32_t TimeSeriesRingFile::payloadCapacity() {
+    return TS_SLOT_SIZE - sizeof(TimeSeriesSlotHeader);
+}
+
+bool TimeSeriesRingFile::open() {
+    slot_count = file_size > TS_FILE_HEADER_SIZE ? (file_size - TS_FILE_HEADER_SIZE) / TS_SLOT_SIZE : 0;
+    if (slot_count < 2) {
+        slot_count = 2;
+    }
+    file_size = TS_FILE_HEADER_SIZE + slot_count * TS_SLOT_SIZE;
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        XPUM_LOG_WARN("Failed to open persistent storage file {}: {}", path, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close();
+        return false;
+    }
+    bool fresh = st.st_size != (off_t)file_size;
+    if (fresh && (ftruncate(fd, 0) != 0 || ftruncate(fd, file_size) != 0)) {
+        XPUM_LOG_WARN("Failed to resize persistent storage file {}: {}", path, strerror(errno));
+        close();
+        return false;
+    }
+    void* p = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        XPUM_LOG_WARN("Failed to map persistent storage file {}: {}", path, strerror(errno));
+        close();
+        return false;
+    }
+    base = (uint8_t*)p;
+    // the files of a tmpfs mounted with huge=advise are then mapped with huge pages
+    if (Configuration::MONITOR_HUGE_PAGES) {
+        NumaMemory::adviseHugePages(base, file_size);
+    }
+
+    TimeSeriesFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (!fresh && (std::memcmp(header.magic, TS_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != TS_FILE_VERSION || header.metric_type != (uint32_t)type || header.slot_size != TS_SLOT_SIZE || header.slot_count != slot_count)) {
+        XPUM_LOG_INFO("Persistent storage file {} has a different layout, reset it", path);
+        fresh = true;
+    }
+    if (fresh) {
+        std::memset(base, 0, file_size);
+        std::memcpy(header.magic, TS_FILE_MAGIC, sizeof(header.magic));
+        header.version = TS_FILE_VERSION;
+        header.metric_type = (uint32_t)type;
+        header.slot_size = TS_SLOT_SIZE;
+        header.slot_count = slot_count;
+        std::memcpy(base, &header, sizeof(header));
+        msync(base, file_size, MS_ASYNC);
+    }
+
+    uint64_t max_sequence = 0;
+    for (uint32_t i = 0; i < slot_count; i++) {
+        TimeSeriesSlotHeader slot_header;
+        std::memcpy(&slot_header, base + TS_FILE_HEADER_SIZE + (size_t)i * TS_SLOT_SIZE, sizeof(slot_header));
+        if (slot_header.magic == TS_SLOT_MAGIC && slot_header.sequence > max_sequence) {
+            max_sequence = slot_header.sequence;
+            head = (i + 1) % slot_count;
+        }
+    }
+    next_sequence = max_sequence + 1;
+    return true;
+}
+
+void TimeSeriesRingFile::close() {
+    if (base != nullptr) {
+        msync(base, file_size, MS_SYNC);
+        munmap(base, file_size);
+        base = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void TimeSeriesRingFile::append(const std::string& payload, const TimeSeriesBlock& block) {
+    if (base == nullptr || payload.size() > payloadCapacity()) {
+        return;
+    }
+    uint8_t* slot = base + TS_FILE_HEADER_SIZE + (size_t)head * TS_SLOT_SIZE;
+    TimeSeriesSlotHeader header = {};
+    // invalidate the slot first, so a crash in the middle never leaves a half written block
+    std::memcpy(slot, &header, sizeof(header));
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(slot + sizeof(header), payload.data(), payload.size());
+    header.payload_size = payload.size();
+    header.sequence = next_sequence++;
+    header.begin_time = block.begin_time;
+    header.end_time = block.end_time;
+    header.sample_count = block.sample_count;
+    header.checksum = checksum((const uint8_t*)payload.data(), payload.size());
+    header.magic = TS_SLOT_MAGIC;
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(slot, &header, sizeof(header));
+    msync(slot, TS_SLOT_SIZE, MS_ASYNC);
+    head = (head + 1) % slot_count;
+}
+
+Timestamp_t TimeSeriesRingFile::oldestTime() {
+    Timestamp_t oldest = std::numeric_limits<Timestamp_t>::max();
+    if (base == nullptr) {
+        return oldest;
+    }
+    for (uint32_t i = 0; i < slot_count; i++) {
+        TimeSeriesSlotHeader header;
+        std::memcpy(&header, base + TS_FILE_HEADER_SIZE + (size_t)i * TS_SLOT_SIZE, sizeof(header));
+        if (header.magic == TS_SLOT_MAGIC && header.begin_time < oldest) {
+            oldest = header.begin_time;
+        }
+    }
+    return oldest;
+}
+
+void TimeSeriesRingFile::forEachSlot(Timestamp_t begin, Timestamp_t end,
+                                     std::function<void(const TimeSeriesSlotHeader& header, const uint8_t* payload)> func) {
+    if (base == nullptr) {
+        return;
+    }
+    std::vector<std::pair<uint64_t, uint32_t>> slots;
+    for (uint32_t i = 0; i < slot_count; i++) {
+        TimeSeriesSlotHeader header;
+        std::memcpy(&header, base + TS_FILE_HEADER_SIZE + (size_t)i * TS_SLOT_SIZE, sizeof(header));
+        if (header.magic != TS_SLOT_MAGIC || header.payload_size > payloadCapacity()) {
+            continue;
+        }
+        if (header.end_time < begin || header.begin_time > end) {
+            continue;
+        }
+        slots.emplace_back(header.sequence, i);
+    }
+    std::sort(slots.begin(), slots.end());
+    for (auto& s : slots) {
+        const uint8_t* slot = base + TS_FILE_HEADER_SIZE + (size_t)s.second * TS_SLOT_SIZE;
+        TimeSeriesSlotHeader header;
+        std::memcpy(&header, slot, sizeof(header));
+        const uint8_t* payload = slot + sizeof(header);
+        if (checksum(payload, header.payload_size) != header.checksum) {
+            XPUM_LOG_DEBUG("Skip corrupted block {} in {}", header.sequence, path);
+            continue;
+        }
+        func(header, payload);
+    }
+}
+
+TimeSeriesPersistency::TimeSeriesPersistency(const std::string& dir) : dir(dir) {
+    while (this->dir.size() > 1 && this->dir.back() == '/') {
+        this->dir.pop_back();
+    }
+    if (!createDirectories(this->dir)) {
+        XPUM_LOG_WARN("Failed to create persistent storage folder {}: {}", this->dir, strerror(errno));
+    }
+}
+
+TimeSeriesPersistency::~TimeSeriesPersistency() {
+    flush();
+}
+
+std::shared_ptr<TimeSeriesPersistency::MetricSeries> TimeSeriesPersistency::getSeries(MeasurementType type, bool create) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = series.find(type);
+    if (it != series.end()) {
+        return it->second;
+    }
+    std::string path = dir + "/metric_" + std::to_string((int)type) + ".xts";
+    if (!create && access(path.c_str(), F_OK) != 0) {
+        return nullptr;
+    }
+    auto p_series = std::make_shared<MetricSeries>();
+    p_series->encoded_size = 0;
+    p_series->p_file = std::unique_ptr<TimeSeriesRingFile>(new TimeSeriesRingFile(path, type, rawFileSize()));
+    if (!p_series->p_file->open()) {
+        p_series->p_file = nullptr;
+    }
+    p_series->rollups.resize(sizeof(TS_ROLLUP_RESOLUTIONS) / sizeof(TS_ROLLUP_RESOLUTIONS[0]));
+    for (size_t i = 0; i < p_series->rollups.size(); i++) {
+        auto& tier = p_series->rollups[i];
+        tier.resolution = TS_ROLLUP_RESOLUTIONS[i];
+        tier.encoded_size = 0;
+        tier.span_begin = 0;
+        std::string rollup_path = dir + "/metric_" + std::to_string((int)type) + "_" + TS_ROLLUP_NAMES[i] + ".xts";
+        tier.p_file = std::unique_ptr<TimeSeriesRingFile>(new TimeSeriesRingFile(rollup_path, type, Configuration::PERSISTENCY_ROLLUP_FILE_SIZE));
+        if (!tier.p_file->open()) {
+            tier.p_file = nullptr;
+        }
+    }
+    series[type] = p_series;
+    return p_series;
+}
+
+void TimeSeriesPersistency::appendValue(TimeSeriesBlock& block, uint32_t device_id, uint32_t subdevice_id, bool raw, uint32_t field, uint32_t scale, uint64_t value, size_t& encoded_size) {
+    if (value == std::numeric_limits<uint64_t>::max()) {
+        return;
+    }
+    TimeSeriesColumn* p_column = nullptr;
+    for (auto& column : block.columns) {
+        if (column.device_id == device_id && column.subdevice_id == subdevice_id && column.raw == raw && column.field == field) {
+            p_column = &column;
+            break;
+        }
+    }
+    if (p_column == nullptr) {
+        TimeSeriesColumn column;
+        column.device_id = device_id;
+        column.subdevice_id = subdevice_id;
+        column.raw = raw;
+        column.field = field;
+        column.scale = scale;
+        column.last_value = 0;
+        block.columns.push_back(column);
+        p_column = &block.columns.back();
+        encoded_size += TS_COLUMN_HEADER_MAX_SIZE;
+    }
+    uint32_t index = block.sample_count - 1;
+    size_t presence_size = (block.sample_count + 7) / 8;
+    if (p_column->presence.size() < presence_size) {
+        encoded_size += presence_size - p_column->presence.size();
+        p_column->presence.resize(presence_size, 0);
+    }
+    uint8_t bit = 1 << (index % 8);
+    if (p_column->presence[index / 8] & bit) {
+        return;
+    }
+    p_column->presence[index / 8] |= bit;
+    encoded_size += putVarint(p_column->values, zigzagEncode((int64_t)(value - p_column->last_value)));
+    p_column->last_value = value;
+}
+
+void TimeSeriesPersistency::seal(MetricSeries& series) {
+    if (series.block.sample_count > 0 && series.p_file != nullptr) {
+        std::string payload;
+        encodeBlock(series.block, payload);
+        series.p_file->append(payload, series.block);
+    }
+    series.block = TimeSeriesBlock();
+    series.encoded_size = 0;
+}
+
+void TimeSeriesPersistency::accumulate(MetricSeries& series, uint32_t device_id, uint32_t subdevice_id, uint32_t scale, uint64_t value) {
+    if (value == std::numeric_limits<uint64_t>::max()) {
+        return;
+    }
+    for (auto& tier : series.rollups) {
+        auto it = tier.accumulators.find(std::make_pair(device_id, subdevice_id));
+        if (it == tier.accumulators.end()) {
+            tier.accumulators[std::make_pair(device_id, subdevice_id)] = RollupAccumulator{value, value, value, 1, scale};
+            continue;
+        }
+        auto& accumulator = it->second;
+        accumulator.min = std::min(accumulator.min, value);
+        accumulator.max = std::max(accumulator.max, value);
+        accumulator.sum += value;
+        accumulator.count++;
+    }
+}
+
+void TimeSeriesPersistency::emitRollup(RollupTier& tier) {
+    if (tier.accumulators.empty()) {
+        return;
+    }
+    auto& block = tier.block;
+    size_t value_count = tier.accumulators.size() * TS_ROLLUP_FIELD_COUNT;
+    size_t bound = TS_VARINT_MAX_SIZE * 2 + value_count * (TS_COLUMN_HEADER_MAX_SIZE + TS_VARINT_MAX_SIZE + 1) + block.columns.size();
+    if (bound > TimeSeriesRingFile::payloadCapacity()) {
+        tier.accumulators.clear();
+        return;
+    }
+    if (block.sample_count > 0 && (block.sample_count >= TS_ROLLUP_BLOCK_MAX_SAMPLES || tier.span_begin < block.end_time || tier.encoded_size + bound > TimeSeriesRingFile::payloadCapacity())) {
+        sealRollup(tier);
+    }
+    if (block.sample_count == 0) {
+        block.begin_time = block.end_time = tier.span_begin;
+        tier.encoded_size = TS_VARINT_MAX_SIZE;
+    }
+    tier.encoded_size += putVarint(block.timestamps, (uint64_t)(tier.span_begin - block.end_time));
+    block.end_time = tier.span_begin;
+    block.sample_count++;
+    for (auto& item : tier.accumulators) {
+        auto& accumulator = item.second;
+        uint32_t device_id = item.first.first;
+        uint32_t subdevice_id = item.first.second;
+        appendValue(block, device_id, subdevice_id, false, TS_FIELD_MIN, accumulator.scale, accumulator.min, tier.encoded_size);
+        appendValue(block, device_id, subdevice_id, false, TS_FIELD_MAX, accumulator.scale, accumulator.max, tier.encoded_size);
+        appendValue(block, device_id, subdevice_id, false, TS_FIELD_AVG, accumulator.scale, accumulator.sum / accumulator.count, tier.encoded_size);
+        appendValue(block, device_id, subdevice_id, false, TS_FIELD_COUNT, accumulator.scale, accumulator.count, tier.encoded_size);
+    }
+    tier.accumulators.clear();
+}
+
+void TimeSeriesPersistency::sealRollup(RollupTier& tier) {
+    if (tier.block.sample_count > 0 && tier.p_file != nullptr) {
+        std::string payload;
+        encodeBlock(tier.block, payload);
+        tier.p_file->append(payload, tier.block);
+    }
+    tier.block = TimeSeriesBlock();
+    tier.encoded_size = 0;
+}
+
+void TimeSeriesPersistency::storeData2PersistentStorage(
+    MeasurementType type, Timestamp_t time,
+    DeviceIndexMap<std::shared_ptr<MeasurementData>>& datas) {
+    // the VF utilizations are kept by their handler only, they have no device or subdevice value
+    if (datas.empty() || type == MeasurementType::METRIC_VF_ENGINE_UTILIZATION) {
+        return;
+    }
+    auto p_series = getSeries(type, true);
+    if (p_series == nullptr) {
+        return;
+    }
+
+    size_t value_count = 0;
+    for (auto& data : datas) {
+        value_count += 1 + data.second->getSubdeviceDataSize() + data.second->getSubdeviceRawDatas()->size();
+    }
+
+    std::unique_lock<std::mutex> lock(p_series->mutex);
+    auto& block = p_series->block;
+    size_t bound = TS_VARINT_MAX_SIZE * 2 + value_count * (TS_COLUMN_HEADER_MAX_SIZE + TS_VARINT_MAX_SIZE + 1) + block.columns.size();
+    if (bound > TimeSeriesRingFile::payloadCapacity()) {
+        XPUM_LOG_DEBUG("Too many values to persist for metric {}", type);
+        return;
+    }
+    if (block.sample_count > 0 && (block.sample_count >= TS_BLOCK_MAX_SAMPLES || time < block.end_time || time - block.begin_time >= TS_BLOCK_MAX_TIME_SPAN || p_series->encoded_size + bound > TimeSeriesRingFile::payloadCapacity())) {
+        seal(*p_series);
+    }
+    if (block.sample_count == 0) {
+        block.begin_time = block.end_time = time;
+        p_series->encoded_size = TS_VARINT_MAX_SIZE;
+    }
+    p_series->encoded_size += putVarint(block.timestamps, (uint64_t)(time - block.end_time));
+    block.end_time = time;
+    block.sample_count++;
+
+    // a sample of another span closes the span accumulated so far
+    for (auto& tier : p_series->rollups) {
+        Timestamp_t span_begin = time - time % tier.resolution;
+        if (span_begin != tier.span_begin) {
+            emitRollup(tier);
+            tier.span_begin = span_begin;
+        }
+    }
+
+    for (auto& data : datas) {
+        uint32_t device_id = data.first;
+        auto& p_data = data.second;
+        uint32_t scale = p_data->getScale();
+        // the raw counters are kept as read, the rollups of a counter hold its accumulated values
+        if (p_data->hasDataOnDevice()) {
+            appendValue(block, device_id, UINT32_MAX, false, TS_FIELD_VALUE, scale, p_data->getCurrent(), p_series->encoded_size);
+            accumulate(*p_series, device_id, UINT32_MAX, scale, p_data->getCurrent());
+        } else if (p_data->hasRawDataOnDevice()) {
+            appendValue(block, device_id, UINT32_MAX, true, TS_FIELD_VALUE, scale, p_data->getRawdata(), p_series->encoded_size);
+            accumulate(*p_series, device_id, UINT32_MAX, scale, p_data->getRawdata());
+        }
+        auto p_subdevice_datas = p_data->getSubdeviceDatas();
+        for (auto& sub : *p_subdevice_datas) {
+            appendValue(block, device_id, sub.first, false, TS_FIELD_VALUE, scale, sub.second.current, p_series->encoded_size);
+            accumulate(*p_series, device_id, sub.first, scale, sub.second.current);
+        }
+        for (auto& sub : *p_data->getSubdeviceRawDatas()) {
+            appendValue(block, device_id, sub.first, true, TS_FIELD_VALUE, scale, sub.second.raw_data, p_series->encoded_size);
+            if (p_subdevice_datas->find(sub.first) == p_subdevice_datas->end()) {
+                accumulate(*p_series, device_id, sub.first, scale, sub.second.raw_data);
+            }
+        }
+    }
+}
+
+void TimeSeriesPersistency::encodeBlock(const TimeSeriesBlock& block, std::string& payload) {
+    size_t presence_size = (block.sample_count + 7) / 8;
+    payload = block.timestamps;
+    putVarint(payload, block.columns.size());
+    for (auto& column : block.columns) {
+        putVarint(payload, column.device_id);
+        putVarint(payload, column.subdevice_id == UINT32_MAX ? 0 : (uint64_t)column.subdevice_id + 1);
+        putVarint(payload, (column.raw ? 1 : 0) | ((uint64_t)column.field << 1));
+        putVarint(payload, column.scale);
+        payload.append((const char*)column.presence.data(), column.presence.size());
+        payload.append(presence_size - column.presence.size(), '\0');
+        putVarint(payload, column.values.size());
+        payload.append(column.values);
+    }
+}
+
+void TimeSeriesPersistency::decodeColumns(const uint8_t* payload, uint32_t payload_size, Timestamp_t begin_time, uint32_t sample_count,
+                                          uint32_t device_id, Timestamp_t begin, Timestamp_t end,
+                                          const std::function<void(Timestamp_t time, uint32_t subdevice_id, uint32_t field, uint64_t value, uint32_t scale, bool raw)>& visitor) {
+    const uint8_t* p = payload;
+    const uint8_t* payload_end = payload + payload_size;
+    std::vector<Timestamp_t> times(sample_count);
+    Timestamp_t time = begin_time;
+    uint64_t value;
+    for (uint32_t i = 0; i < sample_count; i++) {
+        if (!getVarint(p, payload_end, value)) {
+            return;
+        }
+        time += (Timestamp_t)value;
+        times[i] = time;
+    }
+    uint64_t column_count;
+    if (!getVarint(p, payload_end, column_count)) {
+        return;
+    }
+    size_t presence_size = (sample_count + 7) / 8;
+    for (uint64_t c = 0; c < column_count; c++) {
+        uint64_t column_device_id, subdevice, flags, scale, values_size;
+        if (!getVarint(p, payload_end, column_device_id) || !getVarint(p, payload_end, subdevice) || !getVarint(p, payload_end, flags) || !getVarint(p, payload_end, scale)) {
+            return;
+        }
+        const uint8_t* presence = p;
+        p += presence_size;
+        if (p > payload_end || !getVarint(p, payload_end, values_size) || values_size > (uint64_t)(payload_end - p)) {
+            return;
+        }
+        const uint8_t* values = p;
+        p += values_size;
+        if (column_device_id != device_id) {
+            continue;
+        }
+        uint32_t subdevice_id = subdevice == 0 ? UINT32_MAX : (uint32_t)(subdevice - 1);
+        const uint8_t* values_end = values + values_size;
+        uint64_t last_value = 0;
+        for (uint32_t i = 0; i < sample_count; i++) {
+            if ((presence[i / 8] & (1 << (i % 8))) == 0) {
+                continue;
+            }
+            if (!getVarint(values, values_end, value)) {
+                break;
+            }
+            last_value += (uint64_t)zigzagDecode(value);
+            if (times[i] >= begin && times[i] <= end) {
+                visitor(times[i], subdevice_id, (uint32_t)(flags >> 1), last_value, (uint32_t)scale, (flags & 1) != 0);
+            }
+        }
+    }
+}
+
+void TimeSeriesPersistency::decodeBlock(const uint8_t* payload, uint32_t payload_size, Timestamp_t begin_time, uint32_t sample_count,
+                                        uint32_t device_id, Timestamp_t begin, Timestamp_t end, const PersistedSampleVisitor_t& visitor) {
+    decodeColumns(payload, payload_size, begin_time, sample_count, device_id, begin, end,
+                  [&](Timestamp_t time, uint32_t subdevice_id, uint32_t field, uint64_t value, uint32_t scale, bool raw) {
+        if (field == TS_FIELD_VALUE) {
+            visitor(time, subdevice_id, value, scale, raw);
+        }
+    });
+}
+
+void TimeSeriesPersistency::decodeRollupBlock(const uint8_t* payload, uint32_t payload_size, Timestamp_t begin_time, uint32_t sample_count,
+                                              uint32_t device_id, Timestamp_t begin, Timestamp_t end, const PersistedAggregateVisitor_t& visitor) {
+    // the fields of a span are in their own columns, gathered by subdevice and time
+    std::map<std::pair<uint32_t, Timestamp_t>, std::pair<RollupAccumulator, uint64_t>> spans;
+    decodeColumns(payload, payload_size, begin_time, sample_count, device_id, begin, end,
+                  [&](Timestamp_t time, uint32_t subdevice_id, uint32_t field, uint64_t value, uint32_t scale, bool raw) {
+        auto& span = spans[std::make_pair(subdevice_id, time)];
+        span.first.scale = scale;
+        if (field == TS_FIELD_MIN) {
+            span.first.min = value;
+        } else if (field == TS_FIELD_MAX) {
+            span.first.max = value;
+        } else if (field == TS_FIELD_AVG) {
+            span.second = value;
+        } else if (field == TS_FIELD_COUNT) {
+            span.first.count = value;
+        }
+    });
+    for (auto& span : spans) {
+        auto& accumulator = span.second.first;
+        if (accumulator.count > 0) {
+            visitor(span.first.second, span.first.first, accumulator.min, accumulator.max, span.second.second * accumulator.count, accumulator.count, accumulator.scale);
+        }
+    }
+}
+
+bool TimeSeriesPersistency::queryPersistentData(MeasurementType type, uint32_t device_id,
+                                                Timestamp_t begin, Timestamp_t end,
+                                                const PersistedSampleVisitor_t& visitor) {
+    auto p_series = getSeries(type, false);
+    if (p_series == nullptr) {
+        return true;
+    }
+    std::unique_lock<std::mutex> lock(p_series->mutex);
+    visitSamples(*p_series, device_id, begin, end, visitor);
+    return true;
+}
+
+void TimeSeriesPersistency::visitSamples(MetricSeries& series, uint32_t device_id, Timestamp_t begin, Timestamp_t end,
+                                         const PersistedSampleVisitor_t& visitor) {
+    if (series.p_file != nullptr) {
+        series.p_file->forEachSlot(begin, end, [&](const TimeSeriesSlotHeader& header, const uint8_t* payload) {
+            decodeBlock(payload, header.payload_size, header.begin_time, header.sample_count, device_id, begin, end, visitor);
+        });
+    }
+    auto& block = series.block;
+    if (block.sample_count > 0 && block.end_time >= begin && block.begin_time <= end) {
+        std::string payload;
+        encodeBlock(block, payload);
+        decodeBlock((const uint8_t*)payload.data(), payload.size(), block.begin_time, block.sample_count, device_id, begin, end, visitor);
+    }
+}
+
+Timestamp_t TimeSeriesPersistency::oldestTime(MetricSeries& series, int tier) {
+    Timestamp_t oldest = std::numeric_limits<Timestamp_t>::max();
+    if (tier == 0) {
+        if (series.p_file != nullptr) {
+            oldest = series.p_file->oldestTime();
+        }
+        if (series.block.sample_count > 0) {
+            oldest = std::min(oldest, series.block.begin_time);
+        }
+        return oldest;
+    }
+    auto& rollup = series.rollups[tier - 1];
+    if (rollup.p_file != nullptr) {
+        oldest = rollup.p_file->oldestTime();
+    }
+    if (rollup.block.sample_count > 0) {
+        oldest = std::min(oldest, rollup.block.begin_time);
+    }
+    if (!rollup.accumulators.empty()) {
+        oldest = std::min(oldest, rollup.span_begin);
+    }
+    return oldest;
+}
+
+bool TimeSeriesPersistency::queryPersistentAggregates(MeasurementType type, uint32_t device_id,
+                                                      Timestamp_t begin, Timestamp_t end, Timestamp_t step,
+                                                      const PersistedAggregateVisitor_t& visitor) {
+    auto p_series = getSeries(type, false);
+    if (p_series == nullptr) {
+        return true;
+    }
+    std::unique_lock<std::mutex> lock(p_series->mutex);
+    // tier 0 is the raw file, then the rollups from the finest
+    int tier_count = 1 + (int)p_series->rollups.size();
+    int tier = 0;
+    for (int i = tier_count - 1; i > 0; i--) {
+        if (p_series->rollups[i - 1].resolution <= step) {
+            tier = i;
+            break;
+        }
+    }
+    // a coarser tier if this one does not reach back to begin, the one keeping the most if none does
+    int chosen = tier;
+    Timestamp_t chosen_oldest = oldestTime(*p_series, tier);
+    for (int i = tier; i < tier_count && chosen_oldest > begin; i++) {
+        Timestamp_t oldest = oldestTime(*p_series, i);
+        if (oldest < chosen_oldest) {
+            chosen = i;
+            chosen_oldest = oldest;
+        }
+    }
+    XPUM_LOG_DEBUG("Query metric {} of device {} at tier {}", type, device_id, chosen);
+
+    if (chosen == 0) {
+        // a raw counter is only aggregated where the sample has no converted value, like the rollups
+        std::set<std::pair<Timestamp_t, uint32_t>> values;
+        std::vector<std::tuple<Timestamp_t, uint32_t, uint64_t, uint32_t>> raws;
+        visitSamples(*p_series, device_id, begin, end, [&](Timestamp_t time, uint32_t subdevice_id, uint64_t value, uint32_t scale, bool raw) {
+            if (raw) {
+                raws.emplace_back(time, subdevice_id, value, scale);
+                return;
+            }
+            values.emplace(time, subdevice_id);
+            visitor(time, subdevice_id, value, value, value, 1, scale);
+        });
+        for (auto& sample : raws) {
+            if (values.find(std::make_pair(std::get<0>(sample), std::get<1>(sample))) == values.end()) {
+                uint64_t value = std::get<2>(sample);
+                visitor(std::get<0>(sample), std::get<1>(sample), value, value, value, 1, std::get<3>(sample));
+            }
+        }
+        return true;
+    }
+    auto& rollup = p_series->rollups[chosen - 1];
+    if (rollup.p_file != nullptr) {
+        rollup.p_file->forEachSlot(begin, end, [&](const TimeSeriesSlotHeader& header, const uint8_t* payload) {
+            decodeRollupBlock(payload, header.payload_size, header.begin_time, header.sample_count, device_id, begin, end, visitor);
+        });
+    }
+    auto& block = rollup.block;
+    if (block.sample_count > 0 && block.end_time >= begin && block.begin_time <= end) {
+        std::string payload;
+        encodeBlock(block, payload);
+        decodeRollupBlock((const uint8_t*)payload.data(), payload.size(), block.begin_time, block.sample_count, device_id, begin, end, visitor);
+    }
+    // the span still accumulated
+    if (rollup.span_begin >= begin && rollup.span_begin <= end) {
+        for (auto& item : rollup.accumulators) {
+            if (item.first.first == device_id) {
+                auto& accumulator = item.second;
+                visitor(rollup.span_begin, item.first.second, accumulator.min, accumulator.max, accumulator.sum, accumulator.count, accumulator.scale);
+            }
+        }
+    }
+    return true;
+}
+
+void TimeSeriesPersistency::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (auto& s : series) {
+        std::unique_lock<std::mutex> series_lock(s.second->mutex);
+        seal(*s.second);
+        // a span accumulated again after a restart is merged with this one by the queries
+        for (auto& tier : s.second->rollups) {
+            emitRollup(tier);
+            sealRollup(tier);
+        }
+    }
+}
+
+} // end namespace xpum
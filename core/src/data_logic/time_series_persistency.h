@@ -0,0 +1,214 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file time_series_persistency.h
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "persistency.h"
+
+namespace xpum {
+
+/*
+  One column of a block: the samples of a device (or one of its subdevices).
+  presence has one bit per sample of the block, values holds the zigzag
+  varint encoded deltas of the present samples. The blocks of a rollup file
+  have a column per field of the aggregates, min, max, avg and count.
+*/
+struct TimeSeriesColumn {
+    uint32_t device_id;
+    uint32_t subdevice_id;
+    bool raw;
+    uint32_t field;
+    uint32_t scale;
+    uint64_t last_value;
+    std::vector<uint8_t> presence;
+    std::string values;
+};
+
+/*
+  Samples collected in memory until they are sealed into one slot of the ring file.
+*/
+struct TimeSeriesBlock {
+    Timestamp_t begin_time;
+    Timestamp_t end_time;
+    uint32_t sample_count;
+    std::string timestamps;
+    std::vector<TimeSeriesColumn> columns;
+
+    TimeSeriesBlock() : begin_time(0), end_time(0), sample_count(0) {}
+};
+
+struct TimeSeriesSlotHeader {
+    uint32_t magic;
+    uint32_t payload_size;
+    uint64_t sequence;
+    int64_t begin_time;
+    int64_t end_time;
+    uint32_t sample_count;
+    uint32_t checksum;
+};
+
+/*
+  TimeSeriesRingFile is an append-only, memory-mapped file made of fixed size
+  slots. Each slot holds one sealed block, the oldest slot is overwritten when
+  the file is full.
+*/
+class TimeSeriesRingFile {
+   public:
+    TimeSeriesRingFile(const std::string& path, MeasurementType type, uint32_t file_size);
+
+    ~TimeSeriesRingFile();
+
+    bool open();
+
+    void append(const std::string& payload, const TimeSeriesBlock& block);
+
+    void forEachSlot(Timestamp_t begin, Timestamp_t end,
+                     std::function<void(const TimeSeriesSlotHeader& header, const uint8_t* payload)> func);
+
+    static uint32_t payloadCapacity();
+
+    // the begin time of the oldest block kept, INT64_MAX if there is none
+    Timestamp_t oldestTime();
+
+   private:
+    void close();
+
+   private:
+    std::string path;
+
+    MeasurementType type;
+
+    uint32_t file_size;
+
+    uint32_t slot_count;
+
+    int fd;
+
+    uint8_t* base;
+
+    uint32_t head;
+
+    uint64_t next_sequence;
+};
+
+/*
+  TimeSeriesPersistency keeps the history of every metric type in its own
+  ring file under Configuration::PERSISTENCY_DIR. Samples are stored column
+  by column per device, delta and varint encoded.
+
+  A block of the raw file is sealed every 60 seconds at most, so by default
+  the file is sized to keep Configuration::PERSISTENCY_RETENTION hours (24,
+  about 11 MB per metric). Configuration::PERSISTENCY_FILE_SIZE sets the
+  size instead, each 8 KB slot of it keeps one minute. A block is sealed earlier when the
+  samples of all devices fill the slot, on a host with many devices the raw
+  file keeps less than the retention.
+
+  Each metric also has a rollup file per resolution, 10 seconds and 1 minute,
+  of Configuration::PERSISTENCY_ROLLUP_FILE_SIZE. The min, max, avg and count
+  of the span are accumulated as the samples are stored and appended when a
+  sample of the next span comes, so the rollups cost no pass over the raw
+  file. A rollup block holds up to 480 points, the default 4 MB files keep
+  about 4 weeks of the 10 seconds and 5 months of the 1 minute resolution.
+*/
+class TimeSeriesPersistency : public Persistency {
+   public:
+    TimeSeriesPersistency(const std::string& dir);
+
+    virtual ~TimeSeriesPersistency();
+
+    virtual void storeData2PersistentStorage(
+        MeasurementType type,
+        Timestamp_t time,
+        DeviceIndexMap<std::shared_ptr<MeasurementData>>& datas) override;
+
+    virtual bool queryPersistentData(
+        MeasurementType type,
+        uint32_t device_id,
+        Timestamp_t begin,
+        Timestamp_t end,
+        const PersistedSampleVisitor_t& visitor) override;
+
+    virtual bool queryPersistentAggregates(
+        MeasurementType type,
+        uint32_t device_id,
+        Timestamp_t begin,
+        Timestamp_t end,
+        Timestamp_t step,
+        const PersistedAggregateVisitor_t& visitor) override;
+
+    virtual void flush() override;
+
+    static void encodeBlock(const TimeSeriesBlock& block, std::string& payload);
+
+    static void decodeBlock(const uint8_t* payload, uint32_t payload_size, Timestamp_t begin_time, uint32_t sample_count,
+                            uint32_t device_id, Timestamp_t begin, Timestamp_t end, const PersistedSampleVisitor_t& visitor);
+
+   private:
+    struct RollupAccumulator {
+        uint64_t min;
+        uint64_t max;
+        uint64_t sum;
+        uint64_t count;
+        uint32_t scale;
+    };
+
+    struct RollupTier {
+        Timestamp_t resolution;
+        std::unique_ptr<TimeSeriesRingFile> p_file;
+        TimeSeriesBlock block;
+        size_t encoded_size;
+        // the span being accumulated and its values by device and subdevice
+        Timestamp_t span_begin;
+        std::map<std::pair<uint32_t, uint32_t>, RollupAccumulator> accumulators;
+    };
+
+    struct MetricSeries {
+        std::mutex mutex;
+        std::unique_ptr<TimeSeriesRingFile> p_file;
+        TimeSeriesBlock block;
+        size_t encoded_size;
+        std::vector<RollupTier> rollups;
+    };
+
+    std::shared_ptr<MetricSeries> getSeries(MeasurementType type, bool create);
+
+    static void appendValue(TimeSeriesBlock& block, uint32_t device_id, uint32_t subdevice_id, bool raw, uint32_t field, uint32_t scale, uint64_t value, size_t& encoded_size);
+
+    static void seal(MetricSeries& series);
+
+    static void visitSamples(MetricSeries& series, uint32_t device_id, Timestamp_t begin, Timestamp_t end, const PersistedSampleVisitor_t& visitor);
+
+    static void accumulate(MetricSeries& series, uint32_t device_id, uint32_t subdevice_id, uint32_t scale, uint64_t value);
+
+    // append the accumulated span to the block of the tier
+    static void emitRollup(RollupTier& tier);
+
+    static void sealRollup(RollupTier& tier);
+
+    static Timestamp_t oldestTime(MetricSeries& series, int tier);
+
+    static void decodeColumns(const uint8_t* payload, uint32_t payload_size, Timestamp_t begin_time, uint32_t sample_count,
+                              uint32_t device_id, Timestamp_t begin, Timestamp_t end,
+                              const std::function<void(Timestamp_t time, uint32_t subdevice_id, uint32_t field, uint64_t value, uint32_t scale, bool raw)>& visitor);
+
+    static void decodeRollupBlock(const uint8_t* payload, uint32_t payload_size, Timestamp_t begin_time, uint32_t sample_count,
+                                  uint32_t device_id, Timestamp_t begin, Timestamp_t end, const PersistedAggregateVisitor_t& visitor);
+
+   private:
+    std::string dir;
+
+    std::mutex mutex;
+
+    std::map<MeasurementType, std::shared_ptr<MetricSeries>> series;
+};
+
+} // end namespace xpum
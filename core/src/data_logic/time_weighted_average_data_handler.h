@@ -6,20 +6,14 @@
 
 #pragma once
 
-#include "stats_data_handler.h"
+#include "counter_data_handler.h"
 
 namespace xpum {
 
-class TimeWeightedAverageDataHandler : public StatsDataHandler {
+class TimeWeightedAverageDataHandler : public CounterDataHandler {
    public:
     TimeWeightedAverageDataHandler(MeasurementType type, std::shared_ptr<Persistency> &p_persistency);
 
     virtual ~TimeWeightedAverageDataHandler();
-
-    virtual void handleData(std::shared_ptr<SharedData> &p_data) noexcept;
-
-    void counterOverflowDetection(std::shared_ptr<SharedData> &p_data) noexcept;
-
-    void calculateData(std::shared_ptr<SharedData> &p_data);
 };
-} // end namespace xpum
\ No newline at end of file
+} // end namespace xpum
@@ -0,0 +1,64 @@
+/* 
+ *  Copyright (C) 2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file vf_engine_utilization_data_handler.cpp
+ */
+
+#include "vf_engine_utilization_data_handler.h"
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/vf_measurement_data.h"
+
+namespace xpum {
+
+VfEngineUtilizationDataHandler::VfEngineUtilizationDataHandler(MeasurementType type,
+                                                               std::shared_ptr<Persistency>& p_persistency)
+    : DataHandler(type, p_persistency) {
+}
+
+VfEngineUtilizationDataHandler::~VfEngineUtilizationDataHandler() {
+    close();
+}
+
+void VfEngineUtilizationDataHandler::calculateData(std::shared_ptr<SharedData>& p_data) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    for (auto& data : p_data->getData()) {
+        //data.first is deviceId and data.second is VfMeasurementData
+        auto pre_iter = p_preData->getData().find(data.first);
+        if (pre_iter == p_preData->getData().end()) {
+            continue;
+        }
+        auto cur_vf_data = std::static_pointer_cast<VfMeasurementData>(data.second);
+        auto pre_vf_data = std::static_pointer_cast<VfMeasurementData>(pre_iter->second);
+        auto& pre_raw_datas = pre_vf_data->getVfRawDatas();
+        for (auto& vf : cur_vf_data->getVfRawDatas()) {
+            auto pre_vf = pre_raw_datas.find(vf.first);
+            if (pre_vf == pre_raw_datas.end()) {
+                continue;
+            }
+            for (auto& engine : vf.second) {
+                auto pre_engine = pre_vf->second.find(engine.first);
+                if (pre_engine == pre_vf->second.end() || engine.second.raw_timestamp <= pre_engine->second.raw_timestamp ||
+                    engine.second.raw_active_time < pre_engine->second.raw_active_time) {
+                    continue;
+                }
+                uint64_t val = Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * 100 * (engine.second.raw_active_time - pre_engine->second.raw_active_time) / (engine.second.raw_timestamp - pre_engine->second.raw_timestamp);
+                if (val > Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * 100) {
+                    val = Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * 100;
+                }
+                cur_vf_data->setUtilization(vf.first, engine.first, val);
+            }
+        }
+        cur_vf_data->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
+    }
+}
+
+void VfEngineUtilizationDataHandler::handleData(std::shared_ptr<SharedData>& p_data) noexcept {
+    if (p_preData == nullptr || p_data == nullptr) {
+        return;
+    }
+
+    calculateData(p_data);
+}
+
+} // end namespace xpum
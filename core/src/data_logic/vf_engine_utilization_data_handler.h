@@ -0,0 +1,29 @@
+/* 
+ *  Copyright (C) 2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file vf_engine_utilization_data_handler.h
+ */
+
+#pragma once
+
+#include "data_handler.h"
+
+namespace xpum {
+
+/*
+  VfEngineUtilizationDataHandler computes the engine group utilizations of
+  the VFs from two passes of the monitor, so the latest data can be read by
+  VgpuManager without sampling the devices again.
+*/
+class VfEngineUtilizationDataHandler : public DataHandler {
+   public:
+    VfEngineUtilizationDataHandler(MeasurementType type, std::shared_ptr<Persistency> &p_persistency);
+
+    virtual ~VfEngineUtilizationDataHandler();
+
+    virtual void handleData(std::shared_ptr<SharedData> &p_data) noexcept;
+
+    void calculateData(std::shared_ptr<SharedData> &p_data);
+};
+
+} // end namespace xpum
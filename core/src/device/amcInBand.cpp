@@ -10,6 +10,10 @@
 #include <string>
 #include <regex>
 #include <iomanip>
+#include <cinttypes>
+#include <fstream>
+#include <map>
+#include <mutex>
 #include "amcInBand.h"
 #include "logger.h"
 
@@ -57,38 +61,61 @@ uint64_t access_device_memory(std::string hex_base, uint64_t width) {
     return read_result;
 }
 
-bool getDeviceRegion(std::string bdf, std::string& region_base){
-    std::string cmd = "lspci -vvv -s " + bdf + " | egrep \"size=[0-9]{1,2}M\" 2>/dev/null";
-    FILE* f = popen(cmd.c_str(), "r");
-    if (f == NULL) {
+// the region of the device sized 1M - 99M above 4T, as was searched in the output of lspci -vvv
+static bool readDeviceRegion(std::string bdf, std::string& region_base) {
+    std::string path = "/sys/bus/pci/devices/" + bdf;
+    if (access(path.c_str(), F_OK) != 0) {
+        path = "/sys/bus/pci/devices/0000:" + bdf;
+    }
+    std::ifstream resource(path + "/resource");
+    if (!resource.is_open()) {
         return false;
     }
-    char c_line[1024];
-    while (fgets(c_line, 1024, f) != NULL) {
-        std::string line(c_line);
-        if (line.find("Region") == std::string::npos) {
+    const uint64_t mb = 1024 * 1024;
+    std::string line;
+    // only the BARs, not the expansion ROM
+    for (int bar = 0; bar < 6 && std::getline(resource, line); bar++) {
+        uint64_t start = 0, end = 0, flags = 0;
+        if (sscanf(line.c_str(), "%" SCNx64 " %" SCNx64 " %" SCNx64, &start, &end, &flags) != 3 || end <= start) {
             continue;
         }
-
-        if (line.find("disabled") != std::string::npos) {
-            std::string enable_commad = "setpci -s " + bdf + " COMMAND=0x02";
-            if (!system(enable_commad.c_str())) {
-                pclose(f);
-                return false;
-            }
+        uint64_t size = end - start + 1;
+        if (size % mb == 0 && size / mb >= 1 && size / mb <= 99 && start >= 0x10000000000) {
+            region_base = to_hex_string(start);
         }
+    }
+    if (region_base.empty()) {
+        return false;
+    }
 
-        std::regex reg("[0-9a-fA-F]{11,16}");
-        std::smatch match;
-        if(std::regex_search(line, match, reg)) {
-            region_base = match.str();
+    // the memory space is disabled in the command register
+    std::ifstream config(path + "/config", std::ios::binary);
+    char command = 0;
+    if (config.is_open() && config.seekg(4) && config.read(&command, 1) && !(command & 0x02)) {
+        std::string enable_commad = "setpci -s " + bdf + " COMMAND=0x02";
+        if (!system(enable_commad.c_str())) {
+            return false;
         }
     }
-    pclose(f);
-    if (region_base.empty()) {
+    return true;
+}
+
+bool getDeviceRegion(std::string bdf, std::string& region_base){
+    // the regions do not change, they are read once per device
+    static std::mutex mtx;
+    static std::map<std::string, std::string> regions;
+    std::lock_guard<std::mutex> lck(mtx);
+    auto it = regions.find(bdf);
+    if (it != regions.end()) {
+        region_base = it->second;
+        return true;
+    }
+    std::string base;
+    if (!readDeviceRegion(bdf, base)) {
         return false;
     }
-    region_base = "0x" + region_base;
+    regions[bdf] = base;
+    region_base = base;
     return true;
 }
 
@@ -6,7 +6,11 @@
 
 #include "device.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
 #include <cstring>
+#include <tuple>
 
 #include "infrastructure/exception/ilegal_parameter_exception.h"
 #include "infrastructure/logger.h"
@@ -16,6 +20,7 @@ namespace xpum {
 
 Device::Device() {
     fabric_id = std::numeric_limits<uint32_t>::max();
+    index = std::numeric_limits<uint32_t>::max();
 }
 
 std::string Device::getId() noexcept {
@@ -23,6 +28,31 @@ std::string Device::getId() noexcept {
     return id;
 }
 
+void Device::setId(const std::string& id) noexcept {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->id = id;
+    uint32_t new_index;
+    index = toIndex(id, new_index) ? new_index : std::numeric_limits<uint32_t>::max();
+}
+
+uint32_t Device::getIndex() noexcept {
+    return index;
+}
+
+bool Device::toIndex(const std::string& id, uint32_t& index) {
+    if (id.empty() || id.size() > 9) {
+        return false;
+    }
+    index = 0;
+    for (char c : id) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        index = index * 10 + (c - '0');
+    }
+    return true;
+}
+
 void Device::getCapability(std::vector<DeviceCapability>& capabilites) noexcept {
     std::unique_lock<std::mutex> lock(this->mutex);
     for (auto& cap : capabilities) {
@@ -40,23 +70,86 @@ bool Device::hasCapability(DeviceCapability& cap) noexcept {
     return false;
 }
 
-void Device::getProperties(std::vector<Property>& properties) noexcept {
-    std::unique_lock<std::mutex> lock(this->mutex);
-    for (auto& prop : this->properties) {
-        properties.push_back(prop);
+void Device::PropertyValue::set(const std::string& value) {
+    present = true;
+    this->value = value;
+    // a number at the start, like std::stoi of Property::getValueInt
+    errno = 0;
+    char* end = nullptr;
+    number = std::strtol(value.c_str(), &end, 10);
+    numeric = end != value.c_str() && errno == 0;
+}
+
+bool Device::isRefreshableProperty(xpum_device_internal_property_name_t name) noexcept {
+    switch (name) {
+        case XPUM_DEVICE_PROPERTY_INTERNAL_PCI_SLOT:
+        case XPUM_DEVICE_PROPERTY_INTERNAL_GFX_FIRMWARE_NAME:
+        case XPUM_DEVICE_PROPERTY_INTERNAL_GFX_FIRMWARE_VERSION:
+        case XPUM_DEVICE_PROPERTY_INTERNAL_GFX_DATA_FIRMWARE_NAME:
+        case XPUM_DEVICE_PROPERTY_INTERNAL_GFX_DATA_FIRMWARE_VERSION:
+        case XPUM_DEVICE_PROPERTY_INTERNAL_GFX_PSCBIN_FIRMWARE_NAME:
+        case XPUM_DEVICE_PROPERTY_INTERNAL_GFX_PSCBIN_FIRMWARE_VERSION:
+        case XPUM_DEVICE_PROPERTY_INTERNAL_AMC_FIRMWARE_NAME:
+        case XPUM_DEVICE_PROPERTY_INTERNAL_AMC_FIRMWARE_VERSION:
+        case XPUM_DEVICE_PROPERTY_INTERNAL_XELINK_CALIBRATION_DATE:
+            return true;
+        default:
+            return false;
     }
 }
 
-bool Device::getProperty(xpum_device_internal_property_name_t name, Property& ret) noexcept {
+void Device::freezeProperties() noexcept {
     std::unique_lock<std::mutex> lock(this->mutex);
-    for (auto& prop : this->properties) {
-        if (prop.getName() == name) {
-            ret.setValue(prop.getValue());
-            return true;
+    properties_frozen.store(true, std::memory_order_release);
+}
+
+bool Device::readProperty(xpum_device_internal_property_name_t name, PropertyValue& ret) noexcept {
+    if (name < 0 || name >= XPUM_DEVICE_PROPERTY_INTERNAL_MAX) {
+        return false;
+    }
+    if (isRefreshableProperty(name)) {
+        auto p_table = std::atomic_load(&refreshable_properties);
+        ret = (*p_table)[name];
+    } else if (properties_frozen.load(std::memory_order_acquire)) {
+        ret = properties[name];
+    } else {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        ret = properties[name];
+    }
+    return ret.present;
+}
+
+void Device::getProperties(std::vector<Property>& properties) noexcept {
+    for (int i = 0; i < XPUM_DEVICE_PROPERTY_INTERNAL_MAX; i++) {
+        auto name = static_cast<xpum_device_internal_property_name_t>(i);
+        PropertyValue prop;
+        if (readProperty(name, prop)) {
+            properties.emplace_back(name, prop.value);
         }
     }
+}
 
-    return false;
+bool Device::getProperty(xpum_device_internal_property_name_t name, Property& ret) noexcept {
+    PropertyValue prop;
+    if (!readProperty(name, prop)) {
+        return false;
+    }
+    ret.setValue(prop.value);
+    return true;
+}
+
+std::string Device::getPropertyValue(xpum_device_internal_property_name_t name) noexcept {
+    PropertyValue prop;
+    readProperty(name, prop);
+    return prop.value;
+}
+
+long Device::getPropertyLong(xpum_device_internal_property_name_t name, long defaultValue) noexcept {
+    PropertyValue prop;
+    if (!readProperty(name, prop) || !prop.numeric) {
+        return defaultValue;
+    }
+    return prop.number;
 }
 
 void Device::addCapability(DeviceCapability& capability) {
@@ -81,25 +174,40 @@ void Device::removeCapability(DeviceCapability& capability) {
 }
 
 void Device::addProperty(Property prop) {
+    auto name = prop.getName();
+    if (name < 0 || name >= XPUM_DEVICE_PROPERTY_INTERNAL_MAX) {
+        return;
+    }
     std::unique_lock<std::mutex> lock(this->mutex);
-    for (auto it = properties.begin(); it != properties.end(); ++it) {
-        if (prop.getName() == it->getName()) {
-            it->setValue(prop.getValue());
-            return;
-        }
+    if (isRefreshableProperty(name)) {
+        auto p_table = std::make_shared<PropertyTable>(*refreshable_properties);
+        (*p_table)[name].set(prop.getValue());
+        std::atomic_store(&refreshable_properties, std::shared_ptr<const PropertyTable>(p_table));
+        return;
     }
-
-    this->properties.push_back(prop);
+    if (properties_frozen.load()) {
+        XPUM_LOG_WARN("Property {} of device {} is read at discovery and not changed afterwards", static_cast<int>(name), id);
+        return;
+    }
+    properties[name].set(prop.getValue());
 }
 
 void Device::removeProperty(xpum_device_internal_property_name_t name) {
+    if (name < 0 || name >= XPUM_DEVICE_PROPERTY_INTERNAL_MAX) {
+        return;
+    }
     std::unique_lock<std::mutex> lock(this->mutex);
-    for (auto it = properties.begin(); it != properties.end(); ++it) {
-        if (it->getName() == name) {
-            properties.erase(it);
-            return;
-        }
+    if (isRefreshableProperty(name)) {
+        auto p_table = std::make_shared<PropertyTable>(*refreshable_properties);
+        (*p_table)[name] = PropertyValue();
+        std::atomic_store(&refreshable_properties, std::shared_ptr<const PropertyTable>(p_table));
+        return;
+    }
+    if (properties_frozen.load()) {
+        XPUM_LOG_WARN("Property {} of device {} is read at discovery and not changed afterwards", static_cast<int>(name), id);
+        return;
     }
+    properties[name] = PropertyValue();
 }
 
 zes_device_handle_t Device::getDeviceHandle() {
@@ -129,60 +237,56 @@ bool Device::isUpgradingFw(void) noexcept {
     return false;
 }
 
+namespace {
+
+typedef void (*DeviceMethod)(Device* p_device, Callback_t callback);
+
+struct DeviceMethodTable {
+    DeviceMethod methods[(int)DeviceCapability::DEVICE_CAPABILITY_MAX] = {};
+
+    DeviceMethodTable() {
+        const std::pair<DeviceCapability, DeviceMethod> entries[] = {
+            {DeviceCapability::METRIC_POWER, [](Device* p_device, Callback_t callback) { p_device->getPower(callback); }},
+            {DeviceCapability::METRIC_FREQUENCY, [](Device* p_device, Callback_t callback) { p_device->getActuralRequestFrequency(callback); }},
+            {DeviceCapability::METRIC_TEMPERATURE, [](Device* p_device, Callback_t callback) { p_device->getTemperature(callback, ZES_TEMP_SENSORS_GPU); }},
+            {DeviceCapability::METRIC_MEMORY_USED_UTILIZATION, [](Device* p_device, Callback_t callback) { p_device->getMemoryUsedUtilization(callback); }},
+            {DeviceCapability::METRIC_COMPUTATION, [](Device* p_device, Callback_t callback) { p_device->getGPUUtilization(callback); }},
+            {DeviceCapability::METRIC_ENGINE_UTILIZATION, [](Device* p_device, Callback_t callback) { p_device->getEngineUtilization(callback); }},
+            {DeviceCapability::METRIC_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION, [](Device* p_device, Callback_t callback) { p_device->getEngineGroupUtilization(callback, ZES_ENGINE_GROUP_COMPUTE_ALL); }},
+            {DeviceCapability::METRIC_ENGINE_GROUP_MEDIA_ALL_UTILIZATION, [](Device* p_device, Callback_t callback) { p_device->getEngineGroupUtilization(callback, ZES_ENGINE_GROUP_MEDIA_ALL); }},
+            {DeviceCapability::METRIC_ENGINE_GROUP_COPY_ALL_UTILIZATION, [](Device* p_device, Callback_t callback) { p_device->getEngineGroupUtilization(callback, ZES_ENGINE_GROUP_COPY_ALL); }},
+            {DeviceCapability::METRIC_ENGINE_GROUP_RENDER_ALL_UTILIZATION, [](Device* p_device, Callback_t callback) { p_device->getEngineGroupUtilization(callback, ZES_ENGINE_GROUP_RENDER_ALL); }},
+            {DeviceCapability::METRIC_ENGINE_GROUP_3D_ALL_UTILIZATION, [](Device* p_device, Callback_t callback) { p_device->getEngineGroupUtilization(callback, ZES_ENGINE_GROUP_3D_ALL); }},
+            {DeviceCapability::METRIC_ENERGY, [](Device* p_device, Callback_t callback) { p_device->getEnergy(callback); }},
+            {DeviceCapability::METRIC_MEMORY_THROUGHPUT_BANDWIDTH, [](Device* p_device, Callback_t callback) { p_device->getMemoryThroughputAndBandwidth(callback); }},
+            {DeviceCapability::METRIC_EU_ACTIVE_STALL_IDLE, [](Device* p_device, Callback_t callback) { p_device->getEuActiveStallIdle(callback, MeasurementType::METRIC_EU_ACTIVE); }},
+            {DeviceCapability::METRIC_RAS_ERROR, [](Device* p_device, Callback_t callback) { p_device->getRasErrorOnSubdevice(callback); }},
+            {DeviceCapability::METRIC_MEMORY_TEMPERATURE, [](Device* p_device, Callback_t callback) { p_device->getTemperature(callback, ZES_TEMP_SENSORS_MEMORY); }},
+            {DeviceCapability::METRIC_FREQUENCY_THROTTLE, [](Device* p_device, Callback_t callback) { p_device->getFrequencyThrottle(callback); }},
+            {DeviceCapability::METRIC_FREQUENCY_THROTTLE_REASON_GPU, [](Device* p_device, Callback_t callback) { p_device->getFrequencyThrottleReason(callback); }},
+            {DeviceCapability::METRIC_PCIE_READ_THROUGHPUT, [](Device* p_device, Callback_t callback) { p_device->getPCIeReadThroughput(callback); }},
+            {DeviceCapability::METRIC_PCIE_WRITE_THROUGHPUT, [](Device* p_device, Callback_t callback) { p_device->getPCIeWriteThroughput(callback); }},
+            {DeviceCapability::METRIC_PCIE_READ, [](Device* p_device, Callback_t callback) { p_device->getPCIeRead(callback); }},
+            {DeviceCapability::METRIC_PCIE_WRITE, [](Device* p_device, Callback_t callback) { p_device->getPCIeWrite(callback); }},
+            {DeviceCapability::METRIC_FABRIC_THROUGHPUT, [](Device* p_device, Callback_t callback) { p_device->getFabricThroughput(callback); }},
+            {DeviceCapability::METRIC_PERF, [](Device* p_device, Callback_t callback) { p_device->getPerfMetrics(callback); }},
+            {DeviceCapability::METRIC_VF_ENGINE_UTILIZATION, [](Device* p_device, Callback_t callback) { p_device->getVfEngineUtilization(callback); }},
+        };
+        for (auto& entry : entries) {
+            methods[(int)entry.first] = entry.second;
+        }
+    }
+};
+
+} // namespace
+
 std::function<void(Callback_t)> Device::getDeviceMethod(DeviceCapability& capability, Device* p_device) {
-    switch (capability) {
-        case DeviceCapability::METRIC_POWER:
-            return [p_device](Callback_t callback) { p_device->getPower(callback); };
-        case DeviceCapability::METRIC_FREQUENCY:
-            return [p_device](Callback_t callback) { p_device->getActuralRequestFrequency(callback); };
-        case DeviceCapability::METRIC_TEMPERATURE:
-            return [p_device](Callback_t callback) { p_device->getTemperature(callback, ZES_TEMP_SENSORS_GPU); };
-        case DeviceCapability::METRIC_MEMORY_USED_UTILIZATION:
-            return [p_device](Callback_t callback) { p_device->getMemoryUsedUtilization(callback); };
-        case DeviceCapability::METRIC_COMPUTATION:
-            return [p_device](Callback_t callback) { p_device->getGPUUtilization(callback); };
-        case DeviceCapability::METRIC_ENGINE_UTILIZATION:
-            return [p_device](Callback_t callback) { p_device->getEngineUtilization(callback); };
-        case DeviceCapability::METRIC_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION:
-            return [p_device](Callback_t callback) { p_device->getEngineGroupUtilization(callback, ZES_ENGINE_GROUP_COMPUTE_ALL); };
-        case DeviceCapability::METRIC_ENGINE_GROUP_MEDIA_ALL_UTILIZATION:
-            return [p_device](Callback_t callback) { p_device->getEngineGroupUtilization(callback, ZES_ENGINE_GROUP_MEDIA_ALL); };
-        case DeviceCapability::METRIC_ENGINE_GROUP_COPY_ALL_UTILIZATION:
-            return [p_device](Callback_t callback) { p_device->getEngineGroupUtilization(callback, ZES_ENGINE_GROUP_COPY_ALL); };
-        case DeviceCapability::METRIC_ENGINE_GROUP_RENDER_ALL_UTILIZATION:
-            return [p_device](Callback_t callback) { p_device->getEngineGroupUtilization(callback, ZES_ENGINE_GROUP_RENDER_ALL); };
-        case DeviceCapability::METRIC_ENGINE_GROUP_3D_ALL_UTILIZATION:
-            return [p_device](Callback_t callback) { p_device->getEngineGroupUtilization(callback, ZES_ENGINE_GROUP_3D_ALL); };
-        case DeviceCapability::METRIC_ENERGY:
-            return [p_device](Callback_t callback) { p_device->getEnergy(callback); };
-        case DeviceCapability::METRIC_MEMORY_THROUGHPUT_BANDWIDTH:
-            return [p_device](Callback_t callback) { p_device->getMemoryThroughputAndBandwidth(callback); };
-        case DeviceCapability::METRIC_EU_ACTIVE_STALL_IDLE:
-            return [p_device](Callback_t callback) { p_device->getEuActiveStallIdle(callback, MeasurementType::METRIC_EU_ACTIVE); };
-        case DeviceCapability::METRIC_RAS_ERROR:
-            return [p_device](Callback_t callback) { p_device->getRasErrorOnSubdevice(callback); };
-        case DeviceCapability::METRIC_MEMORY_TEMPERATURE:
-            return [p_device](Callback_t callback) { p_device->getTemperature(callback, ZES_TEMP_SENSORS_MEMORY); };
-        case DeviceCapability::METRIC_FREQUENCY_THROTTLE:
-            return [p_device](Callback_t callback) { p_device->getFrequencyThrottle(callback); };
-        case DeviceCapability::METRIC_FREQUENCY_THROTTLE_REASON_GPU:
-            return [p_device](Callback_t callback) { p_device->getFrequencyThrottleReason(callback); };
-        case DeviceCapability::METRIC_PCIE_READ_THROUGHPUT:
-            return [p_device](Callback_t callback) { p_device->getPCIeReadThroughput(callback); };
-        case DeviceCapability::METRIC_PCIE_WRITE_THROUGHPUT:
-            return [p_device](Callback_t callback) { p_device->getPCIeWriteThroughput(callback); };
-        case DeviceCapability::METRIC_PCIE_READ:
-            return [p_device](Callback_t callback) { p_device->getPCIeRead(callback); };
-        case DeviceCapability::METRIC_PCIE_WRITE:
-            return [p_device](Callback_t callback) { p_device->getPCIeWrite(callback); };
-        case DeviceCapability::METRIC_FABRIC_THROUGHPUT:
-            return [p_device](Callback_t callback) { p_device->getFabricThroughput(callback); };
-        case DeviceCapability::METRIC_PERF:
-            return [p_device](Callback_t callback) { p_device->getPerfMetrics(callback); };            
-        default:
-            break;
+    static const DeviceMethodTable table;
+    if ((int)capability < 0 || capability >= DeviceCapability::DEVICE_CAPABILITY_MAX || table.methods[(int)capability] == nullptr) {
+        return nullptr;
     }
-    return nullptr;
+    DeviceMethod method = table.methods[(int)capability];
+    return [method, p_device](Callback_t callback) { method(p_device, callback); };
 }
 
 void Device::addEngine(uint64_t handle, zes_engine_group_t type, bool on_subdevice, uint32_t subdevice_id) {
@@ -230,87 +334,55 @@ void Device::setFabricID(uint32_t fabric_id) {
 
 void Device::addFabricPortHandle(uint32_t attach_id, uint32_t remote_fabric_id, uint32_t remote_attach_id, zes_fabric_port_handle_t handle) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    connected_fabric_port_handles[attach_id][remote_fabric_id][remote_attach_id].push_back(handle);
-
-    fabric_throughput_ids[attach_id][remote_fabric_id][remote_attach_id].reserve(4);
-    fabric_throughput_ids[attach_id][remote_fabric_id][remote_attach_id].push_back(FabricThroughputType::RECEIVED);
-    FabricThroughputInfo rx_info;
-    rx_info.attach_id = attach_id;
-    rx_info.remote_fabric_id = remote_fabric_id;
-    rx_info.remote_attach_id = remote_attach_id;
-    rx_info.type = FabricThroughputType::RECEIVED;
-    fabric_throughput_info[(uint64_t) & (fabric_throughput_ids[attach_id][remote_fabric_id][remote_attach_id][FabricThroughputType::RECEIVED])] = rx_info;
-
-    fabric_throughput_ids[attach_id][remote_fabric_id][remote_attach_id].push_back(FabricThroughputType::TRANSMITTED);
-    FabricThroughputInfo tx_info;
-    tx_info.attach_id = attach_id;
-    tx_info.remote_fabric_id = remote_fabric_id;
-    tx_info.remote_attach_id = remote_attach_id;
-    tx_info.type = FabricThroughputType::TRANSMITTED;
-    fabric_throughput_info[(uint64_t) & (fabric_throughput_ids[attach_id][remote_fabric_id][remote_attach_id][FabricThroughputType::TRANSMITTED])] = tx_info;
-
-    fabric_throughput_ids[attach_id][remote_fabric_id][remote_attach_id].push_back(FabricThroughputType::RECEIVED_COUNTER);
-    FabricThroughputInfo rx_counter_info;
-    rx_counter_info.attach_id = attach_id;
-    rx_counter_info.remote_fabric_id = remote_fabric_id;
-    rx_counter_info.remote_attach_id = remote_attach_id;
-    rx_counter_info.type = FabricThroughputType::RECEIVED_COUNTER;
-    fabric_throughput_info[(uint64_t) & (fabric_throughput_ids[attach_id][remote_fabric_id][remote_attach_id][FabricThroughputType::RECEIVED_COUNTER])] = rx_counter_info;
-
-    fabric_throughput_ids[attach_id][remote_fabric_id][remote_attach_id].push_back(FabricThroughputType::TRANSMITTED_COUNTER);
-    FabricThroughputInfo tx_counter_info;
-    tx_counter_info.attach_id = attach_id;
-    tx_counter_info.remote_fabric_id = remote_fabric_id;
-    tx_counter_info.remote_attach_id = remote_attach_id;
-    tx_counter_info.type = FabricThroughputType::TRANSMITTED_COUNTER;
-    fabric_throughput_info[(uint64_t) & (fabric_throughput_ids[attach_id][remote_fabric_id][remote_attach_id][FabricThroughputType::TRANSMITTED_COUNTER])] = tx_counter_info;
+    auto p_links = std::make_shared<FabricLinkTable>(*fabric_links);
+    auto it = std::lower_bound(p_links->begin(), p_links->end(), std::make_tuple(attach_id, remote_fabric_id, remote_attach_id),
+                               [](const FabricLink& link, const std::tuple<uint32_t, uint32_t, uint32_t>& key) {
+                                   return std::make_tuple(link.attach_id, link.remote_fabric_id, link.remote_attach_id) < key;
+                               });
+    if (it == p_links->end() || it->attach_id != attach_id || it->remote_fabric_id != remote_fabric_id || it->remote_attach_id != remote_attach_id) {
+        FabricLink link;
+        link.attach_id = attach_id;
+        link.remote_fabric_id = remote_fabric_id;
+        link.remote_attach_id = remote_attach_id;
+        for (int type = 0; type < FABRIC_THROUGHPUT_TYPE_MAX; type++) {
+            link.throughput_ids[type] = getFabricThroughputID(attach_id, remote_fabric_id, remote_attach_id, (FabricThroughputType)type);
+        }
+        it = p_links->insert(it, link);
+    }
+    if (std::find(it->port_handles.begin(), it->port_handles.end(), handle) != it->port_handles.end()) {
+        return;
+    }
+    it->port_handles.push_back(handle);
+    std::atomic_store(&fabric_links, std::shared_ptr<const FabricLinkTable>(p_links));
 }
 
-uint64_t Device::getFabricThroughputID(uint32_t attach_id, uint32_t remote_fabric_id, uint32_t remote_attach_id, FabricThroughputType type) {
+void Device::clearFabricPortHandles() {
     std::unique_lock<std::mutex> lock(this->mutex);
-    if (fabric_throughput_ids.find(attach_id) != fabric_throughput_ids.end() && fabric_throughput_ids[attach_id].find(remote_fabric_id) != fabric_throughput_ids[attach_id].end() && fabric_throughput_ids[attach_id][remote_fabric_id].find(remote_attach_id) != fabric_throughput_ids[attach_id][remote_fabric_id].end()) {
-        return (uint64_t) & (fabric_throughput_ids[attach_id][remote_fabric_id][remote_attach_id][type]);
-    }
+    std::atomic_store(&fabric_links, std::make_shared<const FabricLinkTable>());
+}
 
-    return std::numeric_limits<uint64_t>::max();
+std::shared_ptr<const FabricLinkTable> Device::getFabricLinks() {
+    return std::atomic_load(&fabric_links);
 }
 
-std::map<uint32_t, std::map<uint32_t, std::map<uint32_t, std::vector<zes_fabric_port_handle_t>>>> Device::getThroughputHandles() {
-    std::unique_lock<std::mutex> lock(this->mutex);
-    return connected_fabric_port_handles;
+uint64_t Device::getFabricThroughputID(uint32_t attach_id, uint32_t remote_fabric_id, uint32_t remote_attach_id, FabricThroughputType type) {
+    return ((uint64_t)remote_fabric_id << 32) | ((uint64_t)(attach_id & 0xfff) << 20) | ((uint64_t)(remote_attach_id & 0xffff) << 4) | (uint64_t)type;
 }
 
 bool Device::getFabricThroughputInfo(uint64_t throughput_id, FabricThroughputInfo& info) {
-    std::unique_lock<std::mutex> lock(this->mutex);
-    if (fabric_throughput_info.find(throughput_id) != fabric_throughput_info.end()) {
-        info = fabric_throughput_info[throughput_id];
-        return true;
+    uint32_t type = throughput_id & 0xf;
+    if (type >= FABRIC_THROUGHPUT_TYPE_MAX) {
+        return false;
     }
-    return false;
+    info.attach_id = (throughput_id >> 20) & 0xfff;
+    info.remote_fabric_id = throughput_id >> 32;
+    info.remote_attach_id = (throughput_id >> 4) & 0xffff;
+    info.type = (FabricThroughputType)type;
+    return true;
 }
 
 uint32_t Device::getFabricThroughputInfoCount() {
-    std::unique_lock<std::mutex> lock(this->mutex);
-    uint32_t count = 0;
-    auto attach_id_iter = fabric_throughput_ids.begin();
-    while (attach_id_iter != fabric_throughput_ids.end()) {
-        auto remote_fabric_id_iter = attach_id_iter->second.begin();
-        while (remote_fabric_id_iter != attach_id_iter->second.end()) {
-            auto remote_attach_id_iter = remote_fabric_id_iter->second.begin();
-            while (remote_attach_id_iter != remote_fabric_id_iter->second.end()) {
-                count += FABRIC_THROUGHPUT_TYPE_MAX;
-                ++remote_attach_id_iter;
-            }
-            ++remote_fabric_id_iter;
-        }
-        ++attach_id_iter;
-    }
-    return count;
-}
-
-std::map<uint32_t, std::map<uint32_t, std::map<uint32_t, std::vector<FabricThroughputType>>>> Device::getFabricThroughputIDS() {
-    std::unique_lock<std::mutex> lock(this->mutex);
-    return fabric_throughput_ids;
+    return getFabricLinks()->size() * FABRIC_THROUGHPUT_TYPE_MAX;
 }
 
 int Device::getDeviceModel() {
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <array>
 #include <functional>
 #include <map>
 #include <memory>
@@ -54,6 +55,18 @@ typedef struct FabricThroughputInfo_t {
     FabricThroughputType type;
 } FabricThroughputInfo;
 
+// an Xe Link from a tile of the device to a tile of a remote device, and the fabric ports carrying it
+struct FabricLink {
+    uint32_t attach_id;
+    uint32_t remote_fabric_id;
+    uint32_t remote_attach_id;
+    std::vector<zes_fabric_port_handle_t> port_handles;
+    // the keys of the link in the SCHEMA_FABRIC_THROUGHPUT schema, by FabricThroughputType
+    uint64_t throughput_ids[FABRIC_THROUGHPUT_TYPE_MAX];
+};
+
+typedef std::vector<FabricLink> FabricLinkTable;
+
 
 struct pci_address_t {
     uint32_t domain;    ///< BDF domain
@@ -73,6 +86,19 @@ class Device {
 
     std::string getId() noexcept;
 
+    /*
+      The dense index of the device, its id as a number, the data of the
+      devices are kept in DeviceIndexMap by it. UINT32_MAX if the id is not
+      a number.
+    */
+    uint32_t getIndex() noexcept;
+
+    // the dense index of a device id, false if the id is not a number
+    static bool toIndex(const std::string& id, uint32_t& index);
+
+    // the id of a device found again by the rediscovery, set before it is added to the device list
+    void setId(const std::string& id) noexcept;
+
     void getCapability(std::vector<DeviceCapability>& capabilites) noexcept;
 
     bool hasCapability(DeviceCapability& cap) noexcept;
@@ -81,6 +107,23 @@ class Device {
 
     bool getProperty(xpum_device_internal_property_name_t name, Property& ret) noexcept;
 
+    // the value of a property, empty when the device does not have it
+    std::string getPropertyValue(xpum_device_internal_property_name_t name) noexcept;
+
+    // the value of a numeric property, defaultValue when the device does not have it or it is not a number
+    long getPropertyLong(xpum_device_internal_property_name_t name, long defaultValue = 0) noexcept;
+
+    /*
+      The properties read by the discovery are frozen when the device is
+      published to the device list, and read without a lock from then on.
+      The refreshable properties, see isRefreshableProperty, can still be
+      added and removed.
+    */
+    void freezeProperties() noexcept;
+
+    // the firmware versions, the PCI slot and the Xe Link calibration date, which change after discovery
+    static bool isRefreshableProperty(xpum_device_internal_property_name_t name) noexcept;
+
     virtual void getPower(Callback_t callback) noexcept = 0;
 
     virtual void getActuralRequestFrequency(Callback_t callback) noexcept = 0;
@@ -101,9 +144,7 @@ class Device {
 
     virtual void getEuActiveStallIdle(Callback_t callback, MeasurementType type) noexcept = 0;
 
-    virtual void getRasError(Callback_t callback, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType) noexcept = 0;
-
-    virtual void getRasErrorOnSubdevice(Callback_t callback, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType) noexcept = 0;
+    // all the RAS error categories of the device and its subdevices, read in one pass
     virtual void getRasErrorOnSubdevice(Callback_t callback) noexcept = 0;
 
     virtual void getFrequencyThrottle(Callback_t callback) noexcept = 0;
@@ -122,6 +163,8 @@ class Device {
 
     virtual void getPerfMetrics(Callback_t callback) noexcept = 0;
 
+    virtual void getVfEngineUtilization(Callback_t callback) noexcept = 0;
+
     void addCapability(DeviceCapability& capability);
 
     void removeCapability(DeviceCapability& capability);
@@ -157,15 +200,29 @@ class Device {
 
     void addFabricPortHandle(uint32_t attach_id, uint32_t remote_fabric_id, uint32_t remote_attach_id, zes_fabric_port_handle_t handle);
 
-    uint64_t getFabricThroughputID(uint32_t attach_id, uint32_t remote_fabric_id, uint32_t remote_attach_id, FabricThroughputType type);
+    // remove the fabric port handles and throughput IDs, before the links are discovered again
+    void clearFabricPortHandles();
 
-    std::map<uint32_t, std::map<uint32_t, std::map<uint32_t, std::vector<zes_fabric_port_handle_t>>>> getThroughputHandles();
+    /*
+      The links of the device sorted by attach id, remote fabric id and remote
+      attach id. The table is never changed, adding a port handle or clearing
+      them replaces it, so the readers keep a consistent table without a lock
+      or a copy.
+    */
+    std::shared_ptr<const FabricLinkTable> getFabricLinks();
 
-    bool getFabricThroughputInfo(uint64_t throughput_id, FabricThroughputInfo& info);
+    /*
+      The throughput ID of a link is made of the link and the type, so a link
+      found again after its ports are discovered again keeps its ID and its
+      index in the schema. The attach ids must fit 12 bits and the remote
+      attach ids 16 bits.
+    */
+    static uint64_t getFabricThroughputID(uint32_t attach_id, uint32_t remote_fabric_id, uint32_t remote_attach_id, FabricThroughputType type);
 
-    uint32_t getFabricThroughputInfoCount();
+    // the link and type of a throughput ID, false if it is not an ID of getFabricThroughputID
+    static bool getFabricThroughputInfo(uint64_t throughput_id, FabricThroughputInfo& info);
 
-    std::map<uint32_t, std::map<uint32_t, std::map<uint32_t, std::vector<FabricThroughputType>>>> getFabricThroughputIDS();
+    uint32_t getFabricThroughputInfoCount();
 
     void setPciAddress(pci_address_t address) {
         bdfAddr = address;
@@ -228,6 +285,9 @@ class Device {
    protected:
     std::string id;
 
+    // set with id, read without the mutex by every sample
+    std::atomic<uint32_t> index;
+
     zes_device_handle_t zes_device_handle;
 
     ze_device_handle_t ze_device_handle;
@@ -238,17 +298,33 @@ class Device {
 
     std::vector<DeviceCapability> capabilities;
 
-    std::vector<Property> properties;
+    struct PropertyValue {
+        bool present = false;
+        bool numeric = false;
+        long number = 0;
+        std::string value;
 
-    std::map<uint64_t, EngineInfo> engines;
+        void set(const std::string& value);
+    };
 
-    uint32_t fabric_id;
+    typedef std::array<PropertyValue, XPUM_DEVICE_PROPERTY_INTERNAL_MAX> PropertyTable;
 
-    std::map<uint32_t, std::map<uint32_t, std::map<uint32_t, std::vector<zes_fabric_port_handle_t>>>> connected_fabric_port_handles;
+    bool readProperty(xpum_device_internal_property_name_t name, PropertyValue& ret) noexcept;
 
-    std::map<uint32_t, std::map<uint32_t, std::map<uint32_t, std::vector<FabricThroughputType>>>> fabric_throughput_ids;
+    // indexed by the name, written only by the discovery before properties_frozen is set
+    PropertyTable properties;
+
+    std::atomic<bool> properties_frozen{false};
+
+    // copied, changed and swapped under mutex on every update, read by atomic_load
+    std::shared_ptr<const PropertyTable> refreshable_properties = std::make_shared<const PropertyTable>();
+
+    std::map<uint64_t, EngineInfo> engines;
+
+    uint32_t fabric_id;
 
-    std::map<uint64_t, FabricThroughputInfo> fabric_throughput_info;
+    // replaced under mutex, read by atomic_load
+    std::shared_ptr<const FabricLinkTable> fabric_links = std::make_shared<const FabricLinkTable>();
 
     pci_address_t bdfAddr;
 
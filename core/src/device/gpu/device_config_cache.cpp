@@ -0,0 +1,141 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file device_config_cache.cpp
+ */
+
+#include "device_config_cache.h"
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/utility.h"
+
+namespace xpum {
+
+DeviceConfigCache& DeviceConfigCache::instance() {
+    static DeviceConfigCache cache;
+    return cache;
+}
+
+template <typename T>
+bool DeviceConfigCache::get(const zes_device_handle_t& device, Item item, uint32_t subdevice_id, T& value,
+                            const std::function<bool(T&)>& read) {
+    if (device == nullptr || Configuration::DEVICE_CONFIG_MAX_AGE == 0) {
+        return read(value);
+    }
+    auto key = std::make_pair(item, subdevice_id);
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lck(mutex);
+        auto& config = devices[device];
+        auto it = config.entries.find(key);
+        if (it != config.entries.end() &&
+            Utility::getCurrentMillisecond() - it->second.time <= (long long)Configuration::DEVICE_CONFIG_MAX_AGE) {
+            value = *std::static_pointer_cast<T>(it->second.value);
+            return true;
+        }
+        generation = config.generation;
+    }
+
+    long long time = Utility::getCurrentMillisecond();
+    if (!read(value)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lck(mutex);
+    auto it = devices.find(device);
+    if (it != devices.end() && it->second.generation == generation) {
+        auto& entry = it->second.entries[key];
+        entry.value = std::make_shared<T>(value);
+        entry.time = time;
+    }
+    return true;
+}
+
+void DeviceConfigCache::getSchedulers(const zes_device_handle_t& device, std::vector<Scheduler>& schedulers,
+                                      const std::function<void(std::vector<Scheduler>&)>& read) {
+    get<std::vector<Scheduler>>(device, SCHEDULERS, 0, schedulers, [&](std::vector<Scheduler>& value) {
+        read(value);
+        return !value.empty();
+    });
+}
+
+void DeviceConfigCache::getStandbys(const zes_device_handle_t& device, std::vector<Standby>& standbys,
+                                    const std::function<void(std::vector<Standby>&)>& read) {
+    get<std::vector<Standby>>(device, STANDBYS, 0, standbys, [&](std::vector<Standby>& value) {
+        read(value);
+        return !value.empty();
+    });
+}
+
+void DeviceConfigCache::getPowerProps(const zes_device_handle_t& device, std::vector<Power>& powers,
+                                      const std::function<void(std::vector<Power>&)>& read) {
+    get<std::vector<Power>>(device, POWER_PROPS, 0, powers, [&](std::vector<Power>& value) {
+        read(value);
+        return !value.empty();
+    });
+}
+
+void DeviceConfigCache::getPowerLimits(const zes_device_handle_t& device, PowerLimits& limits,
+                                       const std::function<void(PowerLimits&)>& read) {
+    get<PowerLimits>(device, POWER_LIMITS, 0, limits, [&](PowerLimits& value) {
+        read(value);
+        return true;
+    });
+}
+
+void DeviceConfigCache::getFrequencyRanges(const zes_device_handle_t& device, std::vector<Frequency>& frequencies,
+                                           const std::function<void(std::vector<Frequency>&)>& read) {
+    get<std::vector<Frequency>>(device, FREQUENCY_RANGES, 0, frequencies, [&](std::vector<Frequency>& value) {
+        read(value);
+        return !value.empty();
+    });
+}
+
+void DeviceConfigCache::getAvailableClocks(const zes_device_handle_t& device, uint32_t subdevice_id, std::vector<double>& clocks,
+                                           const std::function<void(std::vector<double>&)>& read) {
+    get<std::vector<double>>(device, AVAILABLE_CLOCKS, subdevice_id, clocks, [&](std::vector<double>& value) {
+        read(value);
+        return !value.empty();
+    });
+}
+
+void DeviceConfigCache::getPerformanceFactors(const zes_device_handle_t& device, std::vector<PerformanceFactor>& factors,
+                                              const std::function<void(std::vector<PerformanceFactor>&)>& read) {
+    get<std::vector<PerformanceFactor>>(device, PERFORMANCE_FACTORS, 0, factors, [&](std::vector<PerformanceFactor>& value) {
+        read(value);
+        return !value.empty();
+    });
+}
+
+bool DeviceConfigCache::getMemoryEcc(const zes_device_handle_t& device, MemoryEccState& state,
+                                     const std::function<bool(MemoryEccState&)>& read) {
+    return get<MemoryEccState>(device, MEMORY_ECC, 0, state, read);
+}
+
+void DeviceConfigCache::invalidate(const zes_device_handle_t& device, Item item) {
+    std::lock_guard<std::mutex> lck(mutex);
+    auto it = devices.find(device);
+    if (it == devices.end()) {
+        return;
+    }
+    auto& config = it->second;
+    for (auto entry = config.entries.begin(); entry != config.entries.end();) {
+        if (entry->first.first == item) {
+            entry = config.entries.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+    config.generation++;
+}
+
+void DeviceConfigCache::release(const zes_device_handle_t& device) {
+    std::lock_guard<std::mutex> lck(mutex);
+    auto it = devices.find(device);
+    if (it == devices.end()) {
+        return;
+    }
+    it->second.entries.clear();
+    it->second.generation++;
+}
+
+} // end namespace xpum
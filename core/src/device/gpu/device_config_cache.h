@@ -0,0 +1,120 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file device_config_cache.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "device/frequency.h"
+#include "device/performancefactor.h"
+#include "device/power.h"
+#include "device/scheduler.h"
+#include "device/standby.h"
+#include "level_zero/zes_api.h"
+
+namespace xpum {
+
+/*
+  DeviceConfigCache keeps the configuration read from the devices: the
+  schedulers, standbys, power properties and limits, frequency ranges and
+  available clocks, performance factors and memory ECC state. A query of an
+  item kept is answered from memory, the others are read and kept.
+
+  Only XPUM changes the configuration in practice, so an item is dropped by
+  the set* calls changing it, and all the items of a device by a reset or by
+  a driver event changing the state of the device. An item is also read
+  again when it is older than DEVICE_CONFIG_MAX_AGE, in case it is changed
+  by another tool. A read that finds nothing is not kept.
+*/
+class DeviceConfigCache {
+   public:
+    enum Item {
+        SCHEDULERS,
+        STANDBYS,
+        POWER_PROPS,
+        POWER_LIMITS,
+        FREQUENCY_RANGES,
+        AVAILABLE_CLOCKS,
+        PERFORMANCE_FACTORS,
+        MEMORY_ECC,
+    };
+
+    struct PowerLimits {
+        Power_sustained_limit_t sustained_limit;
+        Power_burst_limit_t burst_limit;
+        Power_peak_limit_t peak_limit;
+    };
+
+    // the current and pending ECC states reported by the firmware
+    struct MemoryEccState {
+        uint8_t current;
+        uint8_t pending;
+    };
+
+    static DeviceConfigCache& instance();
+
+    void getSchedulers(const zes_device_handle_t& device, std::vector<Scheduler>& schedulers,
+                       const std::function<void(std::vector<Scheduler>&)>& read);
+
+    void getStandbys(const zes_device_handle_t& device, std::vector<Standby>& standbys,
+                     const std::function<void(std::vector<Standby>&)>& read);
+
+    void getPowerProps(const zes_device_handle_t& device, std::vector<Power>& powers,
+                       const std::function<void(std::vector<Power>&)>& read);
+
+    void getPowerLimits(const zes_device_handle_t& device, PowerLimits& limits,
+                        const std::function<void(PowerLimits&)>& read);
+
+    void getFrequencyRanges(const zes_device_handle_t& device, std::vector<Frequency>& frequencies,
+                            const std::function<void(std::vector<Frequency>&)>& read);
+
+    void getAvailableClocks(const zes_device_handle_t& device, uint32_t subdevice_id, std::vector<double>& clocks,
+                            const std::function<void(std::vector<double>&)>& read);
+
+    void getPerformanceFactors(const zes_device_handle_t& device, std::vector<PerformanceFactor>& factors,
+                               const std::function<void(std::vector<PerformanceFactor>&)>& read);
+
+    // false if the state can not be read, it is not kept then
+    bool getMemoryEcc(const zes_device_handle_t& device, MemoryEccState& state,
+                      const std::function<bool(MemoryEccState&)>& read);
+
+    void invalidate(const zes_device_handle_t& device, Item item);
+
+    // drop all the items of a device handle that is reset, changed by an event or removed
+    void release(const zes_device_handle_t& device);
+
+   private:
+    struct Entry {
+        std::shared_ptr<void> value;
+        long long time = 0;
+    };
+
+    struct DeviceConfig {
+        // the items by the item and the subdevice, which is 0 for the items of the device
+        std::map<std::pair<Item, uint32_t>, Entry> entries;
+        // changed by every invalidation, a value read before one is not kept
+        uint64_t generation = 0;
+    };
+
+    DeviceConfigCache() = default;
+
+    // read returns whether the value read is kept
+    template <typename T>
+    bool get(const zes_device_handle_t& device, Item item, uint32_t subdevice_id, T& value,
+             const std::function<bool(T&)>& read);
+
+    std::mutex mutex;
+
+    std::map<zes_device_handle_t, DeviceConfig> devices;
+};
+
+} // end namespace xpum
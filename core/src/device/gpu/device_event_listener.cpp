@@ -0,0 +1,160 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file device_event_listener.cpp
+ */
+
+#include "device_event_listener.h"
+
+#include <algorithm>
+
+#include "infrastructure/handle_lock.h"
+#include "infrastructure/logger.h"
+#include "infrastructure/thread_factory.h"
+
+namespace xpum {
+
+// how long one zesDriverEventListenEx call waits, it bounds the time to stop the thread
+static const uint64_t LISTEN_TIMEOUT_MS = 500;
+
+DeviceEventListener& DeviceEventListener::instance() {
+    static DeviceEventListener listener;
+    return listener;
+}
+
+DeviceEventListener::~DeviceEventListener() {
+    stop();
+}
+
+int DeviceEventListener::subscribe(const std::vector<std::shared_ptr<Device>>& devices, zes_event_type_flags_t events,
+                                   DeviceEventCallback_t callback) {
+    std::unique_lock<std::mutex> lock(mutex);
+    int id = next_id++;
+    subscribers[id] = {events, callback};
+
+    for (auto& p_device : devices) {
+        zes_device_handle_t device = p_device->getDeviceHandle();
+        if (device == nullptr) {
+            continue;
+        }
+        auto it = targets.find(device);
+        if (it == targets.end()) {
+            it = targets.emplace(device, Target{p_device->getId(), 0}).first;
+            driver_devices[p_device->getDriverHandle()].push_back(device);
+        }
+        zes_event_type_flags_t flags = it->second.events | events;
+        if (flags == it->second.events) {
+            continue;
+        }
+        // the registered events replace the previous ones, so register the union
+        ze_result_t res;
+        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEventRegister(device, flags));
+        if (res == ZE_RESULT_SUCCESS) {
+            it->second.events = flags;
+            continue;
+        }
+        // the device may not support some of the events, add them one by one
+        XPUM_LOG_DEBUG("Failed to register events {:x} on device {}: {:x}", flags, it->second.device_id, res);
+        for (uint32_t bit = 0; bit < 32; bit++) {
+            zes_event_type_flags_t flag = events & (1u << bit);
+            if (flag == 0 || (it->second.events & flag) != 0) {
+                continue;
+            }
+            XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEventRegister(device, it->second.events | flag));
+            if (res == ZE_RESULT_SUCCESS) {
+                it->second.events |= flag;
+            }
+        }
+        // a failed call may have dropped the registered events
+        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEventRegister(device, it->second.events));
+    }
+
+    if (!thread.joinable()) {
+        stopping = false;
+        thread = ThreadFactory::create("xpum-events", [this]() { run(); });
+    }
+    return id;
+}
+
+void DeviceEventListener::unsubscribe(int id) {
+    bool stop_thread;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        subscribers.erase(id);
+        stop_thread = subscribers.empty();
+    }
+    if (stop_thread) {
+        stop();
+    }
+}
+
+bool DeviceEventListener::isRegistered(const std::string& deviceId, zes_event_type_flags_t events) {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (auto& target : targets) {
+        if (target.second.device_id == deviceId) {
+            return (target.second.events & events) == events;
+        }
+    }
+    return false;
+}
+
+void DeviceEventListener::stop() {
+    stopping = true;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void DeviceEventListener::run() {
+    XPUM_LOG_DEBUG("Device event listener is started");
+    bool listen_failed_logged = false;
+    while (!stopping) {
+        std::map<ze_driver_handle_t, std::vector<zes_device_handle_t>> drivers;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            drivers = driver_devices;
+        }
+        if (drivers.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(LISTEN_TIMEOUT_MS));
+            continue;
+        }
+        // each driver waits a share of the timeout, so one round takes about LISTEN_TIMEOUT_MS
+        uint64_t timeout = std::max((uint64_t)1, LISTEN_TIMEOUT_MS / drivers.size());
+        for (auto& driver : drivers) {
+            std::vector<zes_event_type_flags_t> events(driver.second.size(), 0);
+            uint32_t num_events = 0;
+            ze_result_t res = zesDriverEventListenEx(driver.first, timeout, driver.second.size(), driver.second.data(), &num_events, events.data());
+            if (res == ZE_RESULT_NOT_READY) {
+                continue;
+            }
+            if (res != ZE_RESULT_SUCCESS) {
+                if (!listen_failed_logged) {
+                    XPUM_LOG_WARN("Failed to listen device events: {:x}", res);
+                    listen_failed_logged = true;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+                continue;
+            }
+            if (num_events == 0) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            for (size_t i = 0; i < driver.second.size(); i++) {
+                if (events[i] == 0) {
+                    continue;
+                }
+                auto& device_id = targets[driver.second[i]].device_id;
+                XPUM_LOG_DEBUG("Device {} events: {:x}", device_id, events[i]);
+                for (auto& subscriber : subscribers) {
+                    zes_event_type_flags_t matched = events[i] & subscriber.second.events;
+                    if (matched != 0) {
+                        subscriber.second.callback(device_id, matched);
+                    }
+                }
+            }
+        }
+    }
+    XPUM_LOG_DEBUG("Device event listener is stopped");
+}
+
+} // end namespace xpum
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file device_event_listener.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "device/device.h"
+#include "level_zero/zes_api.h"
+
+namespace xpum {
+
+typedef std::function<void(const std::string& deviceId, zes_event_type_flags_t events)> DeviceEventCallback_t;
+
+/*
+  DeviceEventListener registers Level Zero sysman events on the devices and
+  waits for them with zesDriverEventListenEx in one thread, so a component
+  learns about a change of the device state without polling it.
+
+  The thread is started by the first subscriber and stopped when the last
+  one unsubscribes. The callbacks are called in the listener thread, they
+  delay the events of the other devices and should return quickly.
+*/
+class DeviceEventListener {
+   public:
+    static DeviceEventListener& instance();
+
+    /*
+      Register events on devices, callback is called with the events of a
+      device that match events. Return the id to unsubscribe with.
+    */
+    int subscribe(const std::vector<std::shared_ptr<Device>>& devices, zes_event_type_flags_t events,
+                  DeviceEventCallback_t callback);
+
+    /*
+      Remove the subscriber, no callback of it is running or called on return.
+    */
+    void unsubscribe(int id);
+
+    /*
+      If all of events are registered on the device
+    */
+    bool isRegistered(const std::string& deviceId, zes_event_type_flags_t events);
+
+   private:
+    struct Subscriber {
+        zes_event_type_flags_t events;
+        DeviceEventCallback_t callback;
+    };
+
+    struct Target {
+        std::string device_id;
+        zes_event_type_flags_t events;
+    };
+
+    DeviceEventListener() = default;
+
+    ~DeviceEventListener();
+
+    void run();
+
+    void stop();
+
+    std::mutex mutex;
+
+    int next_id = 0;
+
+    std::map<int, Subscriber> subscribers;
+
+    std::map<zes_device_handle_t, Target> targets;
+
+    std::map<ze_driver_handle_t, std::vector<zes_device_handle_t>> driver_devices;
+
+    std::atomic<bool> stopping{false};
+
+    std::thread thread;
+};
+
+} // end namespace xpum
@@ -0,0 +1,184 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file discovery_cache.cpp
+ */
+
+#include "discovery_cache.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <set>
+#include <sstream>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/logger.h"
+
+using namespace nlohmann;
+
+namespace xpum {
+
+// changed whenever the cached names or their meaning change
+static const int DISCOVERY_CACHE_VERSION = 1;
+
+static const char* GPU_DRIVERS[] = {"i915", "xe"};
+
+static std::string readFirstLine(const std::string& path) {
+    std::ifstream ifs(path);
+    std::string line;
+    if (ifs.good()) {
+        std::getline(ifs, line);
+    }
+    return line;
+}
+
+/*
+  The inode numbers of kernfs nodes are allocated cyclically, so a sysfs
+  directory gets a new one when it is created again, e.g. when a module is
+  reloaded or a device is bound to its driver again.
+*/
+static std::string inodeOf(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return "";
+    }
+    return std::to_string(st.st_ino);
+}
+
+DiscoveryCache& DiscoveryCache::instance() {
+    static DiscoveryCache cache;
+    return cache;
+}
+
+std::string DiscoveryCache::buildKey() {
+    std::stringstream ss;
+    ss << readFirstLine("/proc/sys/kernel/random/boot_id");
+    std::set<std::string> bdfs;
+    for (auto driver : GPU_DRIVERS) {
+        std::string module_path = std::string("/sys/module/") + driver;
+        ss << ";" << driver << ":" << inodeOf(module_path) << ":" << readFirstLine(module_path + "/srcversion");
+
+        std::string driver_path = std::string("/sys/bus/pci/drivers/") + driver;
+        DIR* dir = opendir(driver_path.c_str());
+        if (dir == NULL) {
+            continue;
+        }
+        struct dirent* ent;
+        while ((ent = readdir(dir)) != NULL) {
+            // the bound devices are the links named by their PCI address
+            if (ent->d_name[0] == '.' || strchr(ent->d_name, ':') == NULL) {
+                continue;
+            }
+            bdfs.insert(ent->d_name);
+        }
+        closedir(dir);
+    }
+    for (auto& bdf : bdfs) {
+        ss << ";" << bdf << ":" << inodeOf("/sys/bus/pci/devices/" + bdf + "/drm");
+    }
+    return ss.str();
+}
+
+void DiscoveryCache::load() {
+    std::lock_guard<std::mutex> lock(mutex);
+    enabled = !Configuration::DISCOVERY_CACHE_FILE.empty();
+    dirty = false;
+    values.clear();
+    if (!enabled) {
+        return;
+    }
+    key = buildKey();
+
+    std::ifstream ifs(Configuration::DISCOVERY_CACHE_FILE);
+    if (!ifs.good()) {
+        return;
+    }
+    try {
+        json j = json::parse(ifs);
+        if (j.value("version", 0) != DISCOVERY_CACHE_VERSION || j.value("key", "") != key) {
+            XPUM_LOG_INFO("Discovery cache {} is outdated", Configuration::DISCOVERY_CACHE_FILE);
+            return;
+        }
+        values = j.at("values").get<std::map<std::string, std::map<std::string, std::string>>>();
+        XPUM_LOG_DEBUG("Discovery cache {} is loaded", Configuration::DISCOVERY_CACHE_FILE);
+    } catch (std::exception& e) {
+        XPUM_LOG_WARN("Invalid discovery cache {}: {}", Configuration::DISCOVERY_CACHE_FILE, e.what());
+        values.clear();
+    }
+}
+
+void DiscoveryCache::save() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled || !dirty) {
+        return;
+    }
+    const std::string& path = Configuration::DISCOVERY_CACHE_FILE;
+    auto pos = path.rfind('/');
+    if (pos != std::string::npos && pos > 0) {
+        std::string dir = path.substr(0, pos);
+        if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+            XPUM_LOG_DEBUG("Failed to create the directory of discovery cache {}", path);
+            return;
+        }
+    }
+
+    json j;
+    j["version"] = DISCOVERY_CACHE_VERSION;
+    j["key"] = key;
+    j["values"] = values;
+    // write a temporary file and rename it, so a reader never sees a partial file
+    std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream ofs(tmp_path, std::ios::trunc);
+        if (!ofs.good()) {
+            XPUM_LOG_DEBUG("Failed to write discovery cache {}", path);
+            return;
+        }
+        ofs << j.dump();
+        if (!ofs.good()) {
+            ofs.close();
+            remove(tmp_path.c_str());
+            return;
+        }
+    }
+    if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+        remove(tmp_path.c_str());
+        XPUM_LOG_DEBUG("Failed to write discovery cache {}", path);
+        return;
+    }
+    dirty = false;
+}
+
+std::string DiscoveryCache::get(const std::string& bdf, const std::string& name,
+                                const std::function<std::string()>& compute) {
+    bool use_cache;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        use_cache = enabled;
+        auto it = values.find(bdf);
+        if (it != values.end()) {
+            auto v = it->second.find(name);
+            if (v != it->second.end()) {
+                return v->second;
+            }
+        }
+    }
+    // not holding the lock, devices are discovered in parallel
+    std::string value = compute();
+    if (!use_cache) {
+        return value;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    values[bdf][name] = value;
+    dirty = true;
+    return value;
+}
+
+} // end namespace xpum
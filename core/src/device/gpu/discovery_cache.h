@@ -0,0 +1,65 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file discovery_cache.h
+ */
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace xpum {
+
+/*
+  DiscoveryCache keeps the static facts found by GPUDeviceStub::toDiscover
+  (driver and kernel versions, PCI slot names, OAM socket ids) in a JSON file,
+  so the next start of xpu-smi or xpumd does not parse DMI tables or query
+  the package manager again.
+
+  The file is only used if its key matches the running system. The key is
+  made of the boot id, the identity of the loaded i915/xe modules and the
+  set of PCI devices bound to them, so a reboot, a driver reload or a
+  hotplug invalidates the cache.
+*/
+class DiscoveryCache {
+   public:
+    static DiscoveryCache& instance();
+
+    /*
+      Read the cache file, drop its content if the key does not match.
+    */
+    void load();
+
+    /*
+      Write the cache file if values were added since load().
+    */
+    void save();
+
+    /*
+      Get the value of name for the device with the PCI address bdf, or a
+      host wide value if bdf is empty. compute() is called on a cache miss
+      and its result is stored.
+    */
+    std::string get(const std::string& bdf, const std::string& name,
+                    const std::function<std::string()>& compute);
+
+   private:
+    DiscoveryCache() = default;
+
+    static std::string buildKey();
+
+    std::mutex mutex;
+
+    bool enabled = false;
+
+    bool dirty = false;
+
+    std::string key;
+
+    std::map<std::string, std::map<std::string, std::string>> values;
+};
+
+} // end namespace xpum
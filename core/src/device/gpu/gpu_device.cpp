@@ -13,12 +13,14 @@
 
 #include "core/core.h"
 #include "device/gpu/gpu_device_stub.h"
+#include "event/task_progress.h"
 #include "group/group_manager.h"
 #include "infrastructure/device_property.h"
 #include "infrastructure/logger.h"
 #include "stdio.h"
 #include "unistd.h"
 #include "firmware/igsc_err_msg.h"
+#include "firmware/mei_firmware_info.h"
 
 namespace xpum {
 using namespace std::chrono_literals;
@@ -29,7 +31,7 @@ GPUDevice::GPUDevice() {
 GPUDevice::GPUDevice(const std::string& id,
                      const zes_device_handle_t& zes_device,
                      std::vector<DeviceCapability>& capabilities) {
-    this->id = id;
+    setId(id);
     this->zes_device_handle = zes_device;
     for (DeviceCapability& cap : capabilities) {
         this->capabilities.push_back(cap);
@@ -41,7 +43,7 @@ GPUDevice::GPUDevice(const std::string& id,
                      const ze_device_handle_t& ze_device,
                      const zes_driver_handle_t& ze_driver,
                      std::vector<DeviceCapability>& capabilities) {
-    this->id = id;
+    setId(id);
     this->zes_device_handle = zes_device;
     this->ze_device_handle = ze_device;
     this->ze_driver_handle = ze_driver;
@@ -104,24 +106,6 @@ void GPUDevice::getEuActiveStallIdle(Callback_t callback, MeasurementType type)
                                                    });
 }
 
-void GPUDevice::getRasError(Callback_t callback, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType) noexcept {
-    GPUDeviceStub::instance().getRasError(
-        zes_device_handle,
-        [callback](std::shared_ptr<void> ret, std::shared_ptr<BaseException> e) {
-            callback(ret, e);
-        },
-        rasCat, rasType);
-}
-
-void GPUDevice::getRasErrorOnSubdevice(Callback_t callback, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType) noexcept {
-    GPUDeviceStub::instance().getRasErrorOnSubdevice(
-        zes_device_handle,
-        [callback](std::shared_ptr<void> ret, std::shared_ptr<BaseException> e) {
-            callback(ret, e);
-        },
-        rasCat, rasType);
-}
-
 void GPUDevice::getRasErrorOnSubdevice(Callback_t callback) noexcept {
     GPUDeviceStub::instance().getRasErrorOnSubdevice(
         zes_device_handle,
@@ -173,7 +157,8 @@ static void progress_percentage_func(uint32_t done, uint32_t total, void* ctx) {
 
     // store percent 
     GPUDevice* pDevice = (GPUDevice*) ctx;
-    pDevice->gscFwFlashPercent.store(percent);
+    if (pDevice->gscFwFlashPercent.exchange(percent) != (int)percent)
+        publishTaskProgress(TASK_PROGRESS_FIRMWARE_FLASH, std::stoi(pDevice->getId()));
 }
 
 static std::string print_fw_version(const struct igsc_fw_version* fw_version) {
@@ -330,8 +315,9 @@ xpum_result_t GPUDevice::runFirmwareFlash(RunGSCFirmwareFlashParam &param) noexc
                 }
             }
 
-            ret = igsc_device_fw_update_ex(&handle, (const uint8_t*)img.data(), img.size(),
+            ret = igsc_device_fw_update_ex(&handle, img->data(), img->size(),
                                            progress_func, this, flags);
+            MeiFirmwareInfo::instance().invalidate(meiPath);
 
             if (rc6Enabled && this->getDeviceModel() == XPUM_DEVICE_MODEL_PVC) {
                 writeRc6(this, valueList);
@@ -449,4 +435,11 @@ void GPUDevice::getPerfMetrics(Callback_t callback) noexcept {
                                                   });
 }
 
+void GPUDevice::getVfEngineUtilization(Callback_t callback) noexcept {
+    GPUDeviceStub::instance().getVfEngineUtilization(zes_device_handle,
+                                                     [callback](std::shared_ptr<void> ret, std::shared_ptr<BaseException> e) {
+                                                         callback(ret, e);
+                                                     });
+}
+
 } // end namespace xpum
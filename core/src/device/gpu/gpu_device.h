@@ -36,8 +36,6 @@ class GPUDevice : public Device {
     void getEngineGroupUtilization(Callback_t callback, zes_engine_group_t engine_group_type) noexcept override;
     void getEnergy(Callback_t callback) noexcept override;
     void getEuActiveStallIdle(Callback_t callback, MeasurementType type) noexcept override;
-    void getRasError(Callback_t callback, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType) noexcept override;
-    void getRasErrorOnSubdevice(Callback_t callback, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType) noexcept override;
     void getRasErrorOnSubdevice(Callback_t callback) noexcept override;
     void getFrequencyThrottle(Callback_t callback) noexcept override;
     void getFrequencyThrottleReason(Callback_t callback) noexcept override;
@@ -47,6 +45,7 @@ class GPUDevice : public Device {
     void getPCIeWrite(Callback_t callback) noexcept override;
     void getFabricThroughput(Callback_t callback) noexcept override;
     void getPerfMetrics(Callback_t callback) noexcept override;
+    void getVfEngineUtilization(Callback_t callback) noexcept override;
 
     virtual xpum_result_t runFirmwareFlash(RunGSCFirmwareFlashParam &param) noexcept override; // GSC
     virtual xpum_firmware_flash_result_t getFirmwareFlashResult(GetGSCFirmwareFlashResultParam &param) noexcept override;
@@ -11,13 +11,18 @@
 #include <errno.h>
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <deque>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
 #include <sys/types.h>
 #include <sys/mman.h>
 #include <fcntl.h>
@@ -35,7 +40,12 @@
 #include "device/performancefactor.h"
 #include "device/scheduler.h"
 #include "device/standby.h"
+#include "discovery_cache.h"
 #include "gpu_device.h"
+#include "metric_streamer_session.h"
+#include "mmio_register_reader.h"
+#include "pmu_engine_reader.h"
+#include "sysman_handle_cache.h"
 #include "infrastructure/configuration.h"
 #include "infrastructure/device_property.h"
 #include "infrastructure/device_type.h"
@@ -43,6 +53,7 @@
 #include "infrastructure/handle_lock.h"
 #include "infrastructure/logger.h"
 #include "infrastructure/measurement_data.h"
+#include "infrastructure/suspension.h"
 #include "infrastructure/utility.h"
 #include "firmware/system_cmd.h"
 #include "api/psc.h"
@@ -53,6 +64,11 @@
 namespace xpum {
 
 std::map<ze_device_handle_t, std::shared_ptr<std::vector<std::shared_ptr<DeviceMetricGroups_t>>>> GPUDeviceStub::device_perf_groups;
+std::map<ze_device_handle_t, PerfMetricMultiplexer_t> GPUDeviceStub::perf_metric_multiplexers;
+std::mutex GPUDeviceStub::engine_mutex;
+std::map<zes_device_handle_t, std::shared_ptr<const std::vector<DeviceEngine_t>>> GPUDeviceStub::device_engines;
+std::map<zes_device_handle_t, std::shared_ptr<EngineActivitySnapshot_t>> GPUDeviceStub::engine_activity_snapshots;
+std::map<zes_device_handle_t, std::string> GPUDeviceStub::engine_activity_pmu_bdfs;
 const char* GPU_TIME_NAME = "GpuTime";
 
 namespace {
@@ -93,6 +109,23 @@ bool checkCapability(const char* device_name, const std::string& bdf_address, co
     }
     return false;
 }
+
+// a monitor sample older than this many monitor periods is not used by the health checks
+const int HEALTH_SAMPLE_MAX_AGE_PERIODS = 3;
+
+// the health data reused from the monitor is only trusted while the monitor keeps sampling
+bool isRecentSample(const std::shared_ptr<MeasurementData>& p_data) {
+    if (p_data == nullptr || p_data->getScale() == 0) {
+        return false;
+    }
+    long long age = Utility::getCurrentMillisecond() - (long long)p_data->getTimestamp();
+    long long max_age = (long long)HEALTH_SAMPLE_MAX_AGE_PERIODS * std::max(Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE, 1);
+    if (age > max_age) {
+        XPUM_LOG_DEBUG("health: the monitor sample is {} ms old, read the device", age);
+        return false;
+    }
+    return true;
+}
 } // namespace
 
 GPUDeviceStub::GPUDeviceStub() : initialized(false) {
@@ -331,10 +364,12 @@ void GPUDeviceStub::init() {
         checkInitDependency();
         throw LevelZeroInitializationException("zeInit error");
     }
+}
 
-    if (Configuration::INITIALIZE_PCIE_MANAGER) {
-        pcie_manager.init();
-    }
+void GPUDeviceStub::initPCIeManager() {
+    // pcm-iio-gpu does not use Level Zero, Core::init starts it alongside zeInit
+    static std::once_flag once;
+    std::call_once(once, []() { pcie_manager.init(); });
 }
 
 void GPUDeviceStub::checkInitDependency() {
@@ -833,10 +868,172 @@ bool GPUDeviceStub::isPhysicalFunctionDevice(std::string pci_addr) {
     return true;
 }
 
+pfnZesEngineGetActivityExt_t GPUDeviceStub::getZesEngineGetActivityExt() {
+    static pfnZesEngineGetActivityExt_t pfn = []() -> pfnZesEngineGetActivityExt_t {
+        void* handle = dlopen("libze_loader.so.1", RTLD_NOW);
+        if (handle == nullptr) {
+            return nullptr;
+        }
+        auto f = reinterpret_cast<pfnZesEngineGetActivityExt_t>(dlsym(handle, "zesEngineGetActivityExt"));
+        if (f == nullptr) {
+            dlclose(handle);
+        }
+        return f;
+    }();
+    return pfn;
+}
+
+ze_result_t GPUDeviceStub::getDeviceEngines(const zes_device_handle_t& device, std::shared_ptr<const std::vector<DeviceEngine_t>>& engines) {
+    {
+        std::unique_lock<std::mutex> lock(engine_mutex);
+        auto it = device_engines.find(device);
+        if (it != device_engines.end()) {
+            engines = it->second;
+            return ZE_RESULT_SUCCESS;
+        }
+    }
+    ze_result_t res;
+    uint32_t engine_count = 0;
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_count, nullptr));
+    if (res != ZE_RESULT_SUCCESS) {
+        return res;
+    }
+    std::vector<zes_engine_handle_t> handles(engine_count);
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_count, handles.data()));
+    if (res != ZE_RESULT_SUCCESS) {
+        return res;
+    }
+    auto p_engines = std::make_shared<std::vector<DeviceEngine_t>>();
+    p_engines->reserve(engine_count);
+    for (uint32_t i = 0; i < engine_count; i++) {
+        zes_engine_properties_t props = {};
+        props.stype = ZES_STRUCTURE_TYPE_ENGINE_PROPERTIES;
+        props.pNext = nullptr;
+        XPUM_ZE_HANDLE_SHARED_LOCK(handles[i], res = zesEngineGetProperties(handles[i], &props));
+        if (res != ZE_RESULT_SUCCESS) {
+            XPUM_LOG_WARN("zesEngineGetProperties returned: {}", res);
+            continue;
+        }
+        p_engines->push_back({handles[i], props.type, (bool)props.onSubdevice, props.subdeviceId});
+    }
+    std::unique_lock<std::mutex> lock(engine_mutex);
+    engines = device_engines.emplace(device, p_engines).first->second;
+    return ZE_RESULT_SUCCESS;
+}
+
+void GPUDeviceStub::readEngineActivities(const std::vector<DeviceEngine_t>& engines, std::vector<zes_engine_stats_t>& stats, std::vector<ze_result_t>& results) {
+    stats.assign(engines.size(), zes_engine_stats_t{});
+    results.assign(engines.size(), ZE_RESULT_SUCCESS);
+    for (size_t i = 0; i < engines.size(); i++) {
+        XPUM_ZE_HANDLE_SHARED_LOCK(engines[i].handle, results[i] = zesEngineGetActivity(engines[i].handle, &stats[i]));
+    }
+}
+
+std::string GPUDeviceStub::getEngineActivityPmuBdf(const zes_device_handle_t& device) {
+    {
+        std::unique_lock<std::mutex> lock(engine_mutex);
+        auto it = engine_activity_pmu_bdfs.find(device);
+        if (it != engine_activity_pmu_bdfs.end()) {
+            return it->second;
+        }
+    }
+    std::string bdf;
+    ze_result_t res;
+    zes_device_properties_t props = {};
+    props.stype = ZES_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceGetProperties(device, &props));
+    if (res == ZE_RESULT_SUCCESS && PmuEngineReader::isSelected(props.core.deviceId)) {
+        zes_pci_properties_t pci_props = {};
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
+        if (res == ZE_RESULT_SUCCESS) {
+            bdf = to_string(pci_props.address);
+        }
+    }
+    std::unique_lock<std::mutex> lock(engine_mutex);
+    engine_activity_pmu_bdfs[device] = bdf;
+    return bdf;
+}
+
+// The PMU engine of a single engine, the engines of a type are enumerated in the order of their
+// instances on the device. The groups of several engines have no PMU event.
+static bool getPmuEngine(zes_engine_group_t type, uint32_t ordinal, std::pair<PmuEngineClass, uint32_t>& engine) {
+    switch (type) {
+        case ZES_ENGINE_GROUP_RENDER_SINGLE:
+            engine = std::make_pair(PMU_ENGINE_RENDER, ordinal);
+            return true;
+        case ZES_ENGINE_GROUP_COPY_SINGLE:
+            engine = std::make_pair(PMU_ENGINE_COPY, ordinal);
+            return true;
+        case ZES_ENGINE_GROUP_MEDIA_DECODE_SINGLE:
+        case ZES_ENGINE_GROUP_MEDIA_ENCODE_SINGLE:
+            engine = std::make_pair(PMU_ENGINE_VIDEO, ordinal);
+            return true;
+        case ZES_ENGINE_GROUP_MEDIA_ENHANCEMENT_SINGLE:
+            engine = std::make_pair(PMU_ENGINE_VIDEO_ENHANCE, ordinal);
+            return true;
+        case ZES_ENGINE_GROUP_COMPUTE_SINGLE:
+            engine = std::make_pair(PMU_ENGINE_COMPUTE, ordinal);
+            return true;
+        default:
+            return false;
+    }
+}
+
+ze_result_t GPUDeviceStub::getEngineActivitySnapshot(const zes_device_handle_t& device, uint32_t consumer, std::shared_ptr<const EngineActivitySnapshot_t>& snapshot) {
+    long long now = Utility::getCurrentMillisecond();
+    {
+        std::unique_lock<std::mutex> lock(engine_mutex);
+        auto it = engine_activity_snapshots.find(device);
+        if (it != engine_activity_snapshots.end() && (it->second->consumers & consumer) == 0 &&
+            now - it->second->read_time < Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE / 2) {
+            it->second->consumers |= consumer;
+            snapshot = it->second;
+            return ZE_RESULT_SUCCESS;
+        }
+    }
+    std::shared_ptr<const std::vector<DeviceEngine_t>> engines;
+    ze_result_t res = getDeviceEngines(device, engines);
+    if (res != ZE_RESULT_SUCCESS) {
+        return res;
+    }
+    auto p_snapshot = std::make_shared<EngineActivitySnapshot_t>();
+    p_snapshot->engines = engines;
+    PmuEngineSample pmu_sample;
+    std::string pmu_bdf = getEngineActivityPmuBdf(device);
+    if (!pmu_bdf.empty() && PmuEngineReader::instance().read(pmu_bdf, pmu_sample)) {
+        // the single engines from the one read of the PMU, in us like zesEngineGetActivity
+        p_snapshot->stats.assign(engines->size(), zes_engine_stats_t{});
+        p_snapshot->results.assign(engines->size(), ZE_RESULT_SUCCESS);
+        std::map<zes_engine_group_t, uint32_t> ordinals;
+        for (size_t i = 0; i < engines->size(); i++) {
+            auto& engine = (*engines)[i];
+            std::pair<PmuEngineClass, uint32_t> pmu_engine;
+            if (getPmuEngine(engine.type, ordinals[engine.type]++, pmu_engine)) {
+                auto busy = pmu_sample.busy.find(pmu_engine);
+                if (busy != pmu_sample.busy.end()) {
+                    p_snapshot->stats[i].activeTime = busy->second / 1000;
+                    p_snapshot->stats[i].timestamp = pmu_sample.time / 1000;
+                    continue;
+                }
+            }
+            auto& result = p_snapshot->results[i];
+            XPUM_ZE_HANDLE_SHARED_LOCK(engine.handle, result = zesEngineGetActivity(engine.handle, &p_snapshot->stats[i]));
+        }
+    } else {
+        readEngineActivities(*engines, p_snapshot->stats, p_snapshot->results);
+    }
+    p_snapshot->read_time = now;
+    p_snapshot->consumers = consumer;
+    std::unique_lock<std::mutex> lock(engine_mutex);
+    engine_activity_snapshots[device] = p_snapshot;
+    snapshot = p_snapshot;
+    return ZE_RESULT_SUCCESS;
+}
+
 bool GPUDeviceStub::hasVirtualFunctionOnDevice(const zes_device_handle_t &zes_device) {
     ze_result_t res;
     zes_pci_properties_t pci_props = {};
-    XPUM_ZE_HANDLE_LOCK(zes_device, res = zesDevicePciGetProperties(zes_device, &pci_props));
+    XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, res = zesDevicePciGetProperties(zes_device, &pci_props));
     if (res != ZE_RESULT_SUCCESS) {
         return false;
     }
@@ -861,7 +1058,7 @@ bool GPUDeviceStub::hasVirtualFunctionOnDevice(const zes_device_handle_t &zes_de
 void GPUDeviceStub::addCapabilities(zes_device_handle_t device, const ze_device_properties_t& props, std::vector<DeviceCapability>& capabilities) {
     zes_pci_properties_t pci_props = {};
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
     std::string bdf_address;
     if (res == ZE_RESULT_SUCCESS)
         bdf_address = to_string(pci_props.address);
@@ -936,6 +1133,11 @@ void GPUDeviceStub::addCapabilities(zes_device_handle_t device, const ze_device_
     }
     if (checkCapability(props.name, bdf_address, "fabric throughput", toGetFabricThroughput, device))
         capabilities.push_back(DeviceCapability::METRIC_FABRIC_THROUGHPUT);
+    // the VF activities are only reported by the PF with VFs enabled
+    if (!bdf_address.empty() && isPhysicalFunctionDevice(bdf_address) && hasVirtualFunctionOnDevice(device) && getZesEngineGetActivityExt() != nullptr) {
+        if (checkCapability(props.name, bdf_address, "VF engine utilization", toGetVfEngineUtilization, device))
+            capabilities.push_back(DeviceCapability::METRIC_VF_ENGINE_UTILIZATION);
+    }
 }
 
 void GPUDeviceStub::addEuActiveStallIdleCapabilities(zes_device_handle_t device, const ze_device_properties_t& props, ze_driver_handle_t driver, std::vector<DeviceCapability>& capabilities) {
@@ -945,7 +1147,7 @@ void GPUDeviceStub::addEuActiveStallIdleCapabilities(zes_device_handle_t device,
     }
     zes_pci_properties_t pci_props = {};
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
     std::string bdf_address;
     if (res == ZE_RESULT_SUCCESS)
         bdf_address = to_string(pci_props.address);
@@ -970,7 +1172,7 @@ void GPUDeviceStub::addEngineCapabilities(zes_device_handle_t device, const ze_d
     ze_result_t res;
     uint32_t engine_grp_count = 0;
     zes_pci_properties_t pci_props = {};
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
     std::string bdf_address;
     if (res == ZE_RESULT_SUCCESS)
         bdf_address = to_string(pci_props.address);
@@ -979,14 +1181,14 @@ void GPUDeviceStub::addEngineCapabilities(zes_device_handle_t device, const ze_d
 
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
     std::set<zes_engine_group_t> engine_caps;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_grp_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_grp_count, nullptr));
     if (res == ZE_RESULT_SUCCESS) {
         std::vector<zes_engine_handle_t> engines(engine_grp_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_grp_count, engines.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_grp_count, engines.data()));
         if (res == ZE_RESULT_SUCCESS) {
             for (auto& engine : engines) {
                 zes_engine_properties_t props = {};
-                XPUM_ZE_HANDLE_LOCK(engine, res = zesEngineGetProperties(engine, &props));
+                XPUM_ZE_HANDLE_SHARED_LOCK(engine, res = zesEngineGetProperties(engine, &props));
                 if (res == ZE_RESULT_SUCCESS) {
                     engine_caps.emplace(props.type);
                 } else {
@@ -1025,7 +1227,7 @@ void addPCIeProperties(ze_device_handle_t& device, std::shared_ptr<GPUDevice> p_
     using namespace std;
     zes_pci_properties_t data = {};
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDevicePciGetProperties(device, &data));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDevicePciGetProperties(device, &data));
     if (res == ZE_RESULT_SUCCESS) {
         p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_PCIE_GENERATION, std::to_string(data.maxSpeed.gen)));
         p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_PCIE_MAX_LINK_WIDTH, std::to_string(data.maxSpeed.width)));
@@ -1043,7 +1245,7 @@ void GPUDeviceStub::logSupportedMetrics(zes_device_handle_t device, const ze_dev
     }
     zes_pci_properties_t pci_props = {};
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
     std::string bdf_address;
     if (res == ZE_RESULT_SUCCESS)
         bdf_address = to_string(pci_props.address);
@@ -1076,17 +1278,17 @@ void static addMemUtilizationCapAndMemProperty(ze_device_handle_t& device, std::
         uint64_t free_size = 0;
         uint32_t mem_module_count = 0;
         //zes_mem_health_t memory_health = ZES_MEM_HEALTH_OK;
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumMemoryModules(device, &mem_module_count, nullptr));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumMemoryModules(device, &mem_module_count, nullptr));
         if (res == ZE_RESULT_SUCCESS) {
             std::vector<zes_mem_handle_t> mems(mem_module_count);
-            XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumMemoryModules(device, &mem_module_count, mems.data()));
+            XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumMemoryModules(device, &mem_module_count, mems.data()));
             if (res == ZE_RESULT_SUCCESS) {
                 bool mem_utilization_cap = true;
                 for (auto& mem : mems) {
                     uint64_t mem_module_physical_size = 0;
                     zes_mem_properties_t props = {};
                     props.stype = ZES_STRUCTURE_TYPE_MEM_PROPERTIES;
-                    XPUM_ZE_HANDLE_LOCK(mem, res = zesMemoryGetProperties(mem, &props));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(mem, res = zesMemoryGetProperties(mem, &props));
                     if (res == ZE_RESULT_SUCCESS) {
                         mem_module_physical_size = props.physicalSize;
                         int32_t mem_bus_width = props.busWidth;
@@ -1102,7 +1304,7 @@ void static addMemUtilizationCapAndMemProperty(ze_device_handle_t& device, std::
 
                     zes_mem_state_t sysman_memory_state = {};
                     sysman_memory_state.stype = ZES_STRUCTURE_TYPE_MEM_STATE;
-                    XPUM_ZE_HANDLE_LOCK(mem, res = zesMemoryGetState(mem, &sysman_memory_state));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(mem, res = zesMemoryGetState(mem, &sysman_memory_state));
                     if (res == ZE_RESULT_SUCCESS) {
                         if (props.physicalSize == 0) {
                             mem_module_physical_size = sysman_memory_state.size;
@@ -1136,6 +1338,8 @@ void static addMemUtilizationCapAndMemProperty(ze_device_handle_t& device, std::
 }
 
 std::mutex GPUDeviceStub::fabric_mutex;
+std::mutex GPUDeviceStub::fabric_port_mutex;
+std::map<zes_device_handle_t, std::shared_ptr<const std::vector<DeviceFabricPort_t>>> GPUDeviceStub::device_fabric_ports;
 std::shared_ptr<std::vector<std::shared_ptr<Device>>> GPUDeviceStub::toDiscover() {
     auto p_devices = std::make_shared<std::vector<std::shared_ptr<Device>>>();
     uint32_t driver_count = 0;
@@ -1143,16 +1347,18 @@ std::shared_ptr<std::vector<std::shared_ptr<Device>>> GPUDeviceStub::toDiscover(
     std::vector<ze_driver_handle_t> drivers(driver_count);
     zeDriverGet(&driver_count, drivers.data());
     std::vector<pci_addr_mei_device> pciAddrMeiDevices = getPCIAddrAndMeiDevices();
+    DiscoveryCache& cache = DiscoveryCache::instance();
+    cache.load();
 
     std::mutex devices_mtx;
 
     for (auto& p_driver : drivers) {
         uint32_t device_count = 0;
-        XPUM_ZE_HANDLE_LOCK(p_driver, zeDeviceGet(p_driver, &device_count, nullptr));
+        XPUM_ZE_HANDLE_SHARED_LOCK(p_driver, zeDeviceGet(p_driver, &device_count, nullptr));
         std::vector<ze_device_handle_t> devices(device_count);
-        XPUM_ZE_HANDLE_LOCK(p_driver, zeDeviceGet(p_driver, &device_count, devices.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(p_driver, zeDeviceGet(p_driver, &device_count, devices.data()));
         ze_driver_properties_t driver_prop = {};
-        XPUM_ZE_HANDLE_LOCK(p_driver, zeDriverGetProperties(p_driver, &driver_prop));
+        XPUM_ZE_HANDLE_SHARED_LOCK(p_driver, zeDriverGetProperties(p_driver, &driver_prop));
 
         Utility::parallel_in_batches(devices.size(), devices.size(), [&](int start, int end) {
         for (int i = start; i < end; ++i) {
@@ -1171,13 +1377,13 @@ std::shared_ptr<std::vector<std::shared_ptr<Device>>> GPUDeviceStub::toDiscover(
             zes_device_handle_t zes_device = (zes_device_handle_t)device;
             zes_device_properties_t props = {};
             props.stype = ZES_STRUCTURE_TYPE_DEVICE_PROPERTIES;
-            XPUM_ZE_HANDLE_LOCK(zes_device, res = zesDeviceGetProperties(zes_device, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, res = zesDeviceGetProperties(zes_device, &props));
             if(res != ZE_RESULT_SUCCESS){
                 continue;
             }
             ze_device_properties_t ze_props = {};
             ze_props.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
-            XPUM_ZE_HANDLE_LOCK(device, res = zeDeviceGetProperties(device, 
+            XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zeDeviceGetProperties(device, 
                 &ze_props));
             if(res != ZE_RESULT_SUCCESS){
                 XPUM_LOG_DEBUG("toDiscover: zeDeviceGetProperties returns {}", 
@@ -1186,19 +1392,22 @@ std::shared_ptr<std::vector<std::shared_ptr<Device>>> GPUDeviceStub::toDiscover(
             }
 
             if (ze_props.type == ZE_DEVICE_TYPE_GPU) {
-                addCapabilities(device, ze_props, capabilities);
-                addEngineCapabilities(device, ze_props, capabilities);
-                addEuActiveStallIdleCapabilities(device, ze_props, p_driver, capabilities);
-                logSupportedMetrics(device, ze_props, capabilities);
+                // with staged probing the device is available first and probeCapabilities() adds them
+                if (!Configuration::STAGED_CAPABILITY_PROBING) {
+                    addCapabilities(device, ze_props, capabilities);
+                    addEngineCapabilities(device, ze_props, capabilities);
+                    addEuActiveStallIdleCapabilities(device, ze_props, p_driver, capabilities);
+                    logSupportedMetrics(device, ze_props, capabilities);
+                }
                 auto p_gpu = std::make_shared<GPUDevice>(std::to_string(i), zes_device, device, p_driver, capabilities);
                 p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_DEVICE_TYPE, std::string("GPU")));
                 p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_DEVICE_ID, to_hex_string(ze_props.deviceId)));
                 p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_DEVICE_NAME, std::string(ze_props.name)));
                 // p_gpu->addProperty(Property(DeviceProperty::BOARD_NUMBER,std::string(props.boardNumber)));
                 // p_gpu->addProperty(Property(DeviceProperty::BRAND_NAME,std::string(props.brandName)));
-                p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_DRIVER_VERSION, getDriverVersion()));
-                p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_DRIVER_PACK_VERSION, getDriverPackVersion()));
-                p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_LINUX_KERNEL_VERSION, getKernelVersion()));
+                p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_DRIVER_VERSION, cache.get("", "driver_version", getDriverVersion)));
+                p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_DRIVER_PACK_VERSION, cache.get("", "driver_pack_version", getDriverPackVersion)));
+                p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_LINUX_KERNEL_VERSION, cache.get("", "kernel_version", getKernelVersion)));
                 p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_SERIAL_NUMBER, std::string(props.boardNumber)));
                 p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_VENDOR_NAME, std::string(props.vendorName)));
                 p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_CORE_CLOCK_RATE_MHZ, std::to_string(ze_props.coreClockRate)));
@@ -1230,7 +1439,7 @@ std::shared_ptr<std::vector<std::shared_ptr<Device>>> GPUDeviceStub::toDiscover(
                 p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_EUS, std::to_string(euCount)));
                 zes_pci_properties_t pci_props = {};
 
-                XPUM_ZE_HANDLE_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
+                XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
                 if (res == ZE_RESULT_SUCCESS) {
                     p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS, to_string(pci_props.address)));
                     p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_DRM_DEVICE, getDRMDevice(pci_props)));
@@ -1258,10 +1467,14 @@ std::shared_ptr<std::vector<std::shared_ptr<Device>>> GPUDeviceStub::toDiscover(
                         }                        
                     }
                     p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_DEVICE_STEPPING, stepping));
-                    p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_SLOT, getPciSlot(pci_props.address)));
+                    auto address = pci_props.address;
+                    std::string bdf = to_string(address);
+                    p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_SLOT,
+                                                cache.get(bdf, "pci_slot", [address]() { return getPciSlot(address); })));
 
                     if (isOamPlatform(device) ) {
-                        p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_OAM_SOCKET_ID, getOAMSocketId(pci_props.address)));
+                        p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_OAM_SOCKET_ID,
+                                                    cache.get(bdf, "oam_socket_id", [address]() { return getOAMSocketId(address); })));
                     } else {
                         //p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_OAM_SOCKET_ID, ""));
                     }
@@ -1290,15 +1503,15 @@ std::shared_ptr<std::vector<std::shared_ptr<Device>>> GPUDeviceStub::toDiscover(
                 {
                 std::lock_guard<std::mutex> lock(GPUDeviceStub::fabric_mutex);
                 uint32_t fabric_count = 0;
-                XPUM_ZE_HANDLE_LOCK(device, zesDeviceEnumFabricPorts(device, &fabric_count, nullptr));
+                XPUM_ZE_HANDLE_SHARED_LOCK(device, zesDeviceEnumFabricPorts(device, &fabric_count, nullptr));
                 if (fabric_count > 0) {
                     p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_FABRIC_PORT_NUMBER, std::to_string(fabric_count)));
                     std::vector<zes_fabric_port_handle_t> fps(fabric_count);
-                    XPUM_ZE_HANDLE_LOCK(device, zesDeviceEnumFabricPorts(device, &fabric_count, fps.data()));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(device, zesDeviceEnumFabricPorts(device, &fabric_count, fps.data()));
                     if (res == ZE_RESULT_SUCCESS) {
                         for (auto& fp : fps) {
                             zes_fabric_port_properties_t props = {};
-                            XPUM_ZE_HANDLE_LOCK(device, res = zesFabricPortGetProperties(fp, &props));
+                            XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesFabricPortGetProperties(fp, &props));
                             p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_FABRIC_PORT_MAX_RX_SPEED, props.maxRxSpeed.bitRate));
                             p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_FABRIC_PORT_MAX_TX_SPEED, props.maxTxSpeed.bitRate));
                             p_gpu->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_FABRIC_PORT_RX_LANES_NUMBER, props.maxRxSpeed.width));
@@ -1311,16 +1524,16 @@ std::shared_ptr<std::vector<std::shared_ptr<Device>>> GPUDeviceStub::toDiscover(
                 uint32_t engine_grp_count = 0;
                 uint32_t media_engine_count = 0;
                 uint32_t meida_enhancement_engine_count = 0;
-                XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_grp_count, nullptr));
+                XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_grp_count, nullptr));
                 if (res == ZE_RESULT_SUCCESS) {
                     std::vector<zes_engine_handle_t> engines(engine_grp_count);
-                    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_grp_count, engines.data()));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_grp_count, engines.data()));
                     if (res == ZE_RESULT_SUCCESS) {
                         for (auto& engine : engines) {
                             zes_engine_properties_t props = {};
                             props.stype = ZES_STRUCTURE_TYPE_ENGINE_PROPERTIES;
                             props.pNext = nullptr;
-                            XPUM_ZE_HANDLE_LOCK(engine, res = zesEngineGetProperties(engine, &props));
+                            XPUM_ZE_HANDLE_SHARED_LOCK(engine, res = zesEngineGetProperties(engine, &props));
                             if (res == ZE_RESULT_SUCCESS) {
                                 if (props.type == ZES_ENGINE_GROUP_COMPUTE_SINGLE || props.type == ZES_ENGINE_GROUP_RENDER_SINGLE || props.type == ZES_ENGINE_GROUP_MEDIA_DECODE_SINGLE || props.type == ZES_ENGINE_GROUP_MEDIA_ENCODE_SINGLE || props.type == ZES_ENGINE_GROUP_COPY_SINGLE || props.type == ZES_ENGINE_GROUP_MEDIA_ENHANCEMENT_SINGLE || props.type == ZES_ENGINE_GROUP_3D_SINGLE) {
                                     p_gpu->addEngine((uint64_t)engine, props.type, props.onSubdevice, props.subdeviceId);
@@ -1377,9 +1590,30 @@ std::shared_ptr<std::vector<std::shared_ptr<Device>>> GPUDeviceStub::toDiscover(
         }
     });
 
+    cache.save();
     return p_devices;
 }
 
+void GPUDeviceStub::probeCapabilities(const std::shared_ptr<Device>& p_device) {
+    ze_device_handle_t device = p_device->getDeviceZeHandle();
+    ze_device_properties_t ze_props = {};
+    ze_props.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+    ze_result_t res;
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zeDeviceGetProperties(device, &ze_props));
+    if (res != ZE_RESULT_SUCCESS) {
+        XPUM_LOG_WARN("Failed to probe the capabilities of device {}, zeDeviceGetProperties returned: {}", p_device->getId(), res);
+        return;
+    }
+    std::vector<DeviceCapability> capabilities;
+    addCapabilities(device, ze_props, capabilities);
+    addEngineCapabilities(device, ze_props, capabilities);
+    addEuActiveStallIdleCapabilities(device, ze_props, p_device->getDriverHandle(), capabilities);
+    logSupportedMetrics(device, ze_props, capabilities);
+    for (auto& cap : capabilities) {
+        p_device->addCapability(cap);
+    }
+}
+
 std::string GPUDeviceStub::getDRMDevice(const zes_pci_properties_t& pci_props) {
     char buf[128];
     DIR *pdir = NULL;
@@ -1510,19 +1744,17 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetPower(const zes_device_hand
     }
     std::map<std::string, ze_result_t> exception_msgs;
     bool data_acquired = false;
-    uint32_t power_domain_count = 0;
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
-    ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
-    std::vector<zes_pwr_handle_t> power_handles(power_domain_count);
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
+    std::vector<SysmanHandleCache::PowerDomain> domains;
+    ze_result_t res = SysmanHandleCache::instance().getPowerDomains(device, domains);
     if (res == ZE_RESULT_SUCCESS) {
-        for (auto& power : power_handles) {
-            zes_power_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetProperties(power, &props));
+        for (auto& domain : domains) {
+            auto& power = domain.handle;
+            auto& props = domain.props;
+            res = domain.props_result;
             if (res == ZE_RESULT_SUCCESS) {
                 zes_power_energy_counter_t snap = {};
-                XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetEnergyCounter(power, &snap));
+                XPUM_ZE_HANDLE_SHARED_LOCK(power, res = zesPowerGetEnergyCounter(power, &snap));
                 if (res == ZE_RESULT_SUCCESS) {
                     props.onSubdevice ? ret->setSubdeviceRawData(props.subdeviceId, Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * snap.energy) : ret->setRawData(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * snap.energy);
                     props.onSubdevice ? ret->setSubdeviceDataRawTimestamp(props.subdeviceId, snap.timestamp) : ret->setRawTimestamp(snap.timestamp);
@@ -1577,19 +1809,17 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetEnergy(const zes_device_han
     }
     std::map<std::string, ze_result_t> exception_msgs;
     bool data_acquired = false;
-    uint32_t power_domain_count = 0;
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
-    ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
-    std::vector<zes_pwr_handle_t> power_handles(power_domain_count);
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
+    std::vector<SysmanHandleCache::PowerDomain> domains;
+    ze_result_t res = SysmanHandleCache::instance().getPowerDomains(device, domains);
     if (res == ZE_RESULT_SUCCESS) {
-        for (auto& power : power_handles) {
-            zes_power_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetProperties(power, &props));
+        for (auto& domain : domains) {
+            auto& power = domain.handle;
+            auto& props = domain.props;
+            res = domain.props_result;
             if (res == ZE_RESULT_SUCCESS) {
                 zes_power_energy_counter_t counter = {};
-                XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetEnergyCounter(power, &counter));
+                XPUM_ZE_HANDLE_SHARED_LOCK(power, res = zesPowerGetEnergyCounter(power, &counter));
                 if (res == ZE_RESULT_SUCCESS) {
                     props.onSubdevice ? ret->setSubdeviceDataCurrent(props.subdeviceId, counter.energy * 1.0 / 1000) : ret->setCurrent(counter.energy * 1.0 / 1000);
                     data_acquired = true;
@@ -1624,22 +1854,20 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetActuralRequestFrequency(con
     }
     std::map<std::string, ze_result_t> exception_msgs;
     bool data_acquired = false;
-    uint32_t freq_count = 0;
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
-    ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, nullptr));
-    std::vector<zes_freq_handle_t> freq_handles(freq_count);
+    std::vector<SysmanHandleCache::FrequencyDomain> domains;
+    ze_result_t res = SysmanHandleCache::instance().getFrequencyDomains(device, domains);
     if (res == ZE_RESULT_SUCCESS) {
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, freq_handles.data()));
-        for (auto& ph_freq : freq_handles) {
-            zes_freq_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(ph_freq, res = zesFrequencyGetProperties(ph_freq, &props));
+        for (auto& domain : domains) {
+            auto& ph_freq = domain.handle;
+            auto& props = domain.props;
+            res = domain.props_result;
             if (res == ZE_RESULT_SUCCESS) {
                 if (props.type != ZES_FREQ_DOMAIN_GPU) {
                     continue;
                 }
                 zes_freq_state_t freq_state = {};
-                XPUM_ZE_HANDLE_LOCK(ph_freq, res = zesFrequencyGetState(ph_freq, &freq_state));
+                XPUM_ZE_HANDLE_SHARED_LOCK(ph_freq, res = zesFrequencyGetState(ph_freq, &freq_state));
                 if (res == ZE_RESULT_SUCCESS && freq_state.actual >= 0) {
                     uint32_t subdeviceId = UINT32_MAX;
                     if (props.onSubdevice) {
@@ -1695,19 +1923,17 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetFrequencyThrottle(const zes
     }
     std::map<std::string, ze_result_t> exception_msgs;
     bool data_acquired = false;
-    uint32_t freq_count = 0;
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
-    ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, nullptr));
-    std::vector<zes_freq_handle_t> freq_handles(freq_count);
+    std::vector<SysmanHandleCache::FrequencyDomain> domains;
+    ze_result_t res = SysmanHandleCache::instance().getFrequencyDomains(device, domains);
     if (res == ZE_RESULT_SUCCESS) {
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, freq_handles.data()));
-        for (auto& ph_freq : freq_handles) {
-            zes_freq_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(ph_freq, res = zesFrequencyGetProperties(ph_freq, &props));
+        for (auto& domain : domains) {
+            auto& ph_freq = domain.handle;
+            auto& props = domain.props;
+            res = domain.props_result;
             if (res == ZE_RESULT_SUCCESS) {
                 zes_freq_throttle_time_t freq_throttle = {};
-                XPUM_ZE_HANDLE_LOCK(ph_freq, res = zesFrequencyGetThrottleTime(ph_freq, &freq_throttle));
+                XPUM_ZE_HANDLE_SHARED_LOCK(ph_freq, res = zesFrequencyGetThrottleTime(ph_freq, &freq_throttle));
                 if (res == ZE_RESULT_SUCCESS) {
                     props.onSubdevice ? ret->setSubdeviceRawData(props.subdeviceId, Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * freq_throttle.throttleTime) : ret->setRawData(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * freq_throttle.throttleTime);
                     props.onSubdevice ? ret->setSubdeviceDataRawTimestamp(props.subdeviceId, freq_throttle.timestamp) : ret->setRawTimestamp(freq_throttle.timestamp);
@@ -1741,52 +1967,35 @@ void GPUDeviceStub::getTemperature(const zes_device_handle_t& device, Callback_t
 uint32_t GPUDeviceStub::getRegisterValueFromSys(zes_device_handle_t device, uint64_t offset) {
     if (device == nullptr)
         return (uint32_t)-1;
-    ze_result_t res;
-    zes_pci_properties_t pci_props = {};
-    pci_props.stype = ZES_STRUCTURE_TYPE_PCI_PROPERTIES;
-    pci_props.pNext = nullptr;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
-    if (res == ZE_RESULT_SUCCESS) {
-        return getRegisterValueFromSys(to_string(pci_props.address), offset);
+    // the BDF of a handle does not change, it is queried once
+    static std::mutex bdf_mutex;
+    static std::map<zes_device_handle_t, std::string> bdfs;
+    std::string bdf;
+    {
+        std::lock_guard<std::mutex> lck(bdf_mutex);
+        auto it = bdfs.find(device);
+        if (it != bdfs.end()) {
+            bdf = it->second;
+        }
     }
-    
-    return (uint32_t)-1;
+    if (bdf.empty()) {
+        ze_result_t res;
+        zes_pci_properties_t pci_props = {};
+        pci_props.stype = ZES_STRUCTURE_TYPE_PCI_PROPERTIES;
+        pci_props.pNext = nullptr;
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
+        if (res != ZE_RESULT_SUCCESS) {
+            return (uint32_t)-1;
+        }
+        bdf = to_string(pci_props.address);
+        std::lock_guard<std::mutex> lck(bdf_mutex);
+        bdfs[device] = bdf;
+    }
+    return getRegisterValueFromSys(bdf, offset);
 }
 
 uint32_t GPUDeviceStub::getRegisterValueFromSys(std::string bdfAddress, uint64_t offset) {
-    if (bdfAddress.empty())
-        return (uint32_t)-1;
-    std::string resource_file = "/sys/bus/pci/devices/" + bdfAddress + "/resource0";
-    int fd;
-    void *map_base, *virt_addr;
-    uint64_t read_result;
-    char *filename;
-    off_t target, target_base;
-    int type_width = 4;
-    int map_size = 4096UL;
-
-    filename = const_cast<char*>(resource_file.c_str());
-    target = offset;
-    if ((fd = open(filename, O_RDONLY | O_SYNC)) == -1) {
-        return (uint32_t)-1;
-    }
-    target_base = target & ~(sysconf(_SC_PAGE_SIZE)-1);
-    if (target + type_width - target_base > map_size)
-        map_size = target + type_width - target_base;
-    
-    map_base = mmap(0, map_size, PROT_READ, MAP_SHARED, fd, target_base);
-
-    if (map_base == (void *) -1) {
-        close(fd);
-        return (uint32_t)-1;
-    }
-    virt_addr = (uint8_t *)map_base + target - target_base;
-    read_result = *((uint32_t *) virt_addr);
-    uint32_t val = read_result;
-
-    munmap(map_base, map_size);
-    close(fd);
-    return val;
+    return MmioRegisterReader::instance().read(bdfAddress, offset);
 }
 
 std::shared_ptr<MeasurementData> GPUDeviceStub::toGetTemperature(const zes_device_handle_t& device, zes_temp_sensors_t type) {
@@ -1806,66 +2015,60 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetTemperature(const zes_devic
             throw BaseException("Failed to read register value from sys");
         }
     } 
-    uint32_t temp_sensor_count = 0;
-    ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumTemperatureSensors(device, &temp_sensor_count, nullptr));
-    if (temp_sensor_count == 0) {
+    std::vector<SysmanHandleCache::TemperatureSensor> sensors;
+    ze_result_t res = SysmanHandleCache::instance().getTemperatureSensors(device, sensors);
+    if (sensors.empty()) {
         throw BaseException("No temperature sensor detected");
     }
-    std::vector<zes_temp_handle_t> temp_sensors(temp_sensor_count);
     if (res == ZE_RESULT_SUCCESS) {
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumTemperatureSensors(device, &temp_sensor_count, temp_sensors.data()));
-        if (res == ZE_RESULT_SUCCESS) {
-            for (auto& temp : temp_sensors) {
-                zes_temp_properties_t props = {};
-                XPUM_ZE_HANDLE_LOCK(temp, res = zesTemperatureGetProperties(temp, &props));
-                if (res == ZE_RESULT_SUCCESS) {
-                    switch (props.type) {
-                        case ZES_TEMP_SENSORS_GPU:
-                            if (type == props.type) {
-                                double temp_val = 0;
-                                XPUM_ZE_HANDLE_LOCK(temp, res = zesTemperatureGetState(temp, &temp_val));
-                                // filter abnormal temperatures
-                                if (res == ZE_RESULT_SUCCESS && temp_val < 150) {
-                                    ret->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
-                                    if (props.onSubdevice) {
-                                        ret->setSubdeviceDataCurrent(props.subdeviceId, temp_val * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
-                                    } else {
-                                        ret->setCurrent(temp_val * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
-                                    }
-                                    data_acquired = true;
+        for (auto& sensor : sensors) {
+            auto& temp = sensor.handle;
+            auto& props = sensor.props;
+            res = sensor.props_result;
+            if (res == ZE_RESULT_SUCCESS) {
+                switch (props.type) {
+                    case ZES_TEMP_SENSORS_GPU:
+                        if (type == props.type) {
+                            double temp_val = 0;
+                            XPUM_ZE_HANDLE_SHARED_LOCK(temp, res = zesTemperatureGetState(temp, &temp_val));
+                            // filter abnormal temperatures
+                            if (res == ZE_RESULT_SUCCESS && temp_val < 150) {
+                                ret->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
+                                if (props.onSubdevice) {
+                                    ret->setSubdeviceDataCurrent(props.subdeviceId, temp_val * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
                                 } else {
-                                    exception_msgs["zesTemperatureGetState"] = res;
+                                    ret->setCurrent(temp_val * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
                                 }
+                                data_acquired = true;
+                            } else {
+                                exception_msgs["zesTemperatureGetState"] = res;
                             }
-                            break;
-                        case ZES_TEMP_SENSORS_MEMORY:
-                            if (type == props.type) {
-                                double temp_val = 0;
-                                XPUM_ZE_HANDLE_LOCK(temp, res = zesTemperatureGetState(temp, &temp_val));
-                                // filter abnormal temperatures
-                                if (res == ZE_RESULT_SUCCESS && temp_val < 150) {
-                                    ret->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
-                                    if (props.onSubdevice) {
-                                        ret->setSubdeviceDataCurrent(props.subdeviceId, temp_val * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
-                                    } else {
-                                        ret->setCurrent(temp_val * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
-                                    }
-                                    data_acquired = true;
+                        }
+                        break;
+                    case ZES_TEMP_SENSORS_MEMORY:
+                        if (type == props.type) {
+                            double temp_val = 0;
+                            XPUM_ZE_HANDLE_SHARED_LOCK(temp, res = zesTemperatureGetState(temp, &temp_val));
+                            // filter abnormal temperatures
+                            if (res == ZE_RESULT_SUCCESS && temp_val < 150) {
+                                ret->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
+                                if (props.onSubdevice) {
+                                    ret->setSubdeviceDataCurrent(props.subdeviceId, temp_val * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
                                 } else {
-                                    exception_msgs["zesTemperatureGetState"] = res;
+                                    ret->setCurrent(temp_val * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
                                 }
+                                data_acquired = true;
+                            } else {
+                                exception_msgs["zesTemperatureGetState"] = res;
                             }
-                            break;
-                        default:
-                            break;
-                    }
-                } else {
-                    exception_msgs["zesTemperatureGetProperties"] = res;
+                        }
+                        break;
+                    default:
+                        break;
                 }
+            } else {
+                exception_msgs["zesTemperatureGetProperties"] = res;
             }
-        } else {
-            exception_msgs["zesDeviceEnumTemperatureSensors"] = res;
         }
     } else {
         exception_msgs["zesDeviceEnumTemperatureSensors"] = res;
@@ -1892,42 +2095,35 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetMemoryUsedUtilization(const
     std::map<std::string, ze_result_t> exception_msgs;
     bool data_acquired = false;
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
-    uint32_t mem_module_count = 0;
-    ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumMemoryModules(device, &mem_module_count, nullptr));
+    std::vector<SysmanHandleCache::MemoryModule> modules;
+    ze_result_t res = SysmanHandleCache::instance().getMemoryModules(device, modules);
     if (res == ZE_RESULT_SUCCESS) {
-        std::vector<zes_mem_handle_t> mems(mem_module_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumMemoryModules(device, &mem_module_count, mems.data()));
-        if (res == ZE_RESULT_SUCCESS) {
-            for (auto& mem : mems) {
-                zes_mem_properties_t props = {};
-                props.stype = ZES_STRUCTURE_TYPE_MEM_PROPERTIES;
-                XPUM_ZE_HANDLE_LOCK(mem, res = zesMemoryGetProperties(mem, &props));
-                if (res == ZE_RESULT_SUCCESS) {
-                    zes_mem_state_t sysman_memory_state = {};
-                    sysman_memory_state.stype = ZES_STRUCTURE_TYPE_MEM_STATE;
-                    XPUM_ZE_HANDLE_LOCK(mem, res = zesMemoryGetState(mem, &sysman_memory_state));
-                    if (res == ZE_RESULT_SUCCESS && sysman_memory_state.size != 0) {
-                        uint64_t used = props.physicalSize == 0 ? sysman_memory_state.size - sysman_memory_state.free : props.physicalSize - sysman_memory_state.free;
-                        uint64_t utilization = Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * used * 100 / (props.physicalSize == 0 ? sysman_memory_state.size : props.physicalSize);
-                        uint32_t subdeviceId = UINT32_MAX;
-                        if (props.onSubdevice) {
-                            subdeviceId = props.subdeviceId;
-                            ret->setSubdeviceDataCurrent(props.subdeviceId, used);
-                        } else {
-                            ret->setCurrent(used);
-                        }
-                        ret->setSubdeviceAdditionalData(subdeviceId, MeasurementType::METRIC_MEMORY_UTILIZATION, utilization, Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
-                        data_acquired = true;
+        for (auto& module : modules) {
+            auto& mem = module.handle;
+            auto& props = module.props;
+            res = module.props_result;
+            if (res == ZE_RESULT_SUCCESS) {
+                zes_mem_state_t sysman_memory_state = {};
+                sysman_memory_state.stype = ZES_STRUCTURE_TYPE_MEM_STATE;
+                XPUM_ZE_HANDLE_SHARED_LOCK(mem, res = zesMemoryGetState(mem, &sysman_memory_state));
+                if (res == ZE_RESULT_SUCCESS && sysman_memory_state.size != 0) {
+                    uint64_t used = props.physicalSize == 0 ? sysman_memory_state.size - sysman_memory_state.free : props.physicalSize - sysman_memory_state.free;
+                    uint64_t utilization = Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * used * 100 / (props.physicalSize == 0 ? sysman_memory_state.size : props.physicalSize);
+                    uint32_t subdeviceId = UINT32_MAX;
+                    if (props.onSubdevice) {
+                        subdeviceId = props.subdeviceId;
+                        ret->setSubdeviceDataCurrent(props.subdeviceId, used);
                     } else {
-                        exception_msgs["zesMemoryGetState"] = res;
+                        ret->setCurrent(used);
                     }
+                    ret->setSubdeviceAdditionalData(subdeviceId, MeasurementType::METRIC_MEMORY_UTILIZATION, utilization, Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
+                    data_acquired = true;
                 } else {
-                    exception_msgs["zesMemoryGetProperties"] = res;
+                    exception_msgs["zesMemoryGetState"] = res;
                 }
+            } else {
+                exception_msgs["zesMemoryGetProperties"] = res;
             }
-        } else {
-            exception_msgs["zesDeviceEnumMemoryModules"] = res;
         }
     } else {
         exception_msgs["zesDeviceEnumMemoryModules"] = res;
@@ -1953,47 +2149,40 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetMemoryThroughputAndBandwidt
     }
     std::map<std::string, ze_result_t> exception_msgs;
     bool data_acquired = false;
-    uint32_t mem_module_count = 0;
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
-    ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumMemoryModules(device, &mem_module_count, nullptr));
+    std::vector<SysmanHandleCache::MemoryModule> modules;
+    ze_result_t res = SysmanHandleCache::instance().getMemoryModules(device, modules);
     if (res == ZE_RESULT_SUCCESS) {
-        std::vector<zes_mem_handle_t> mems(mem_module_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumMemoryModules(device, &mem_module_count, mems.data()));
-        if (res == ZE_RESULT_SUCCESS) {
-            for (auto& mem : mems) {
-                zes_mem_properties_t props = {};
-                props.stype = ZES_STRUCTURE_TYPE_MEM_PROPERTIES;
-                XPUM_ZE_HANDLE_LOCK(mem, res = zesMemoryGetProperties(mem, &props));
-                if (res != ZE_RESULT_SUCCESS || props.location != ZES_MEM_LOC_DEVICE) {
-                    continue;
-                }
+        for (auto& module : modules) {
+            auto& mem = module.handle;
+            auto& props = module.props;
+            res = module.props_result;
+            if (res != ZE_RESULT_SUCCESS || props.location != ZES_MEM_LOC_DEVICE) {
+                continue;
+            }
 
-                zes_mem_bandwidth_t mem_bandwidth = {};
-                XPUM_ZE_HANDLE_LOCK(mem, res = zesMemoryGetBandwidth(mem, &mem_bandwidth));
-                if (res == ZE_RESULT_SUCCESS) {
-                    uint32_t subdeviceId = UINT32_MAX;
-                    if (props.onSubdevice) {
-                        subdeviceId = props.subdeviceId;
-                        ret->setSubdeviceDataCurrent(props.subdeviceId, mem_bandwidth.readCounter);
-                    } else {
-                        ret->setCurrent(mem_bandwidth.readCounter);
-                    }
-                    ret->setSubdeviceAdditionalData(subdeviceId, MeasurementType::METRIC_MEMORY_WRITE, mem_bandwidth.writeCounter);
-                    ret->setSubdeviceAdditionalData(subdeviceId, MeasurementType::METRIC_MEMORY_READ_THROUGHPUT, mem_bandwidth.readCounter / 1024 * 1000, 1, true, mem_bandwidth.timestamp / 1000);
-                    ret->setSubdeviceAdditionalData(subdeviceId, MeasurementType::METRIC_MEMORY_WRITE_THROUGHPUT, mem_bandwidth.writeCounter / 1024 * 1000, 1, true, mem_bandwidth.timestamp / 1000);
-                    // The 100 for percentage and the first 1000 for mili seconds to seconds in the next comment code, but to overcome the possible overflow we use the next line of comment code
-                    // ret->setSubdeviceAdditionalData(subdeviceId, MeasurementType::METRIC_MEMORY_BANDWIDTH, 100 * (mem_bandwidth.readCounter + mem_bandwidth.writeCounter) / mem_bandwidth.maxBandwidth * 1000, 1, true, mem_bandwidth.timestamp / 1000);
-                    if (mem_bandwidth.maxBandwidth > 0) { 
-                        ret->setSubdeviceAdditionalData(subdeviceId, MeasurementType::METRIC_MEMORY_BANDWIDTH, 100 * (mem_bandwidth.readCounter / 1000 + mem_bandwidth.writeCounter / 1000) / (mem_bandwidth.maxBandwidth / 1000) * 1000, 1, true, mem_bandwidth.timestamp / 1000);
-                    }
-                    data_acquired = true;
+            zes_mem_bandwidth_t mem_bandwidth = {};
+            XPUM_ZE_HANDLE_SHARED_LOCK(mem, res = zesMemoryGetBandwidth(mem, &mem_bandwidth));
+            if (res == ZE_RESULT_SUCCESS) {
+                uint32_t subdeviceId = UINT32_MAX;
+                if (props.onSubdevice) {
+                    subdeviceId = props.subdeviceId;
+                    ret->setSubdeviceDataCurrent(props.subdeviceId, mem_bandwidth.readCounter);
                 } else {
-                    exception_msgs["zesMemoryGetBandwidth"] = res;
+                    ret->setCurrent(mem_bandwidth.readCounter);
                 }
+                ret->setSubdeviceAdditionalData(subdeviceId, MeasurementType::METRIC_MEMORY_WRITE, mem_bandwidth.writeCounter);
+                ret->setSubdeviceAdditionalData(subdeviceId, MeasurementType::METRIC_MEMORY_READ_THROUGHPUT, mem_bandwidth.readCounter / 1024 * 1000, 1, true, mem_bandwidth.timestamp / 1000);
+                ret->setSubdeviceAdditionalData(subdeviceId, MeasurementType::METRIC_MEMORY_WRITE_THROUGHPUT, mem_bandwidth.writeCounter / 1024 * 1000, 1, true, mem_bandwidth.timestamp / 1000);
+                // The 100 for percentage and the first 1000 for mili seconds to seconds in the next comment code, but to overcome the possible overflow we use the next line of comment code
+                // ret->setSubdeviceAdditionalData(subdeviceId, MeasurementType::METRIC_MEMORY_BANDWIDTH, 100 * (mem_bandwidth.readCounter + mem_bandwidth.writeCounter) / mem_bandwidth.maxBandwidth * 1000, 1, true, mem_bandwidth.timestamp / 1000);
+                if (mem_bandwidth.maxBandwidth > 0) { 
+                    ret->setSubdeviceAdditionalData(subdeviceId, MeasurementType::METRIC_MEMORY_BANDWIDTH, 100 * (mem_bandwidth.readCounter / 1000 + mem_bandwidth.writeCounter / 1000) / (mem_bandwidth.maxBandwidth / 1000) * 1000, 1, true, mem_bandwidth.timestamp / 1000);
+                }
+                data_acquired = true;
+            } else {
+                exception_msgs["zesMemoryGetBandwidth"] = res;
             }
-        } else {
-            exception_msgs["zesDeviceEnumMemoryModules"] = res;
         }
     } else {
         exception_msgs["zesDeviceEnumMemoryModules"] = res;
@@ -2014,25 +2203,71 @@ void GPUDeviceStub::getEuActiveStallIdle(const ze_device_handle_t& device, const
 }
 
 std::mutex GPUDeviceStub::metric_streamer_mutex;
+std::condition_variable GPUDeviceStub::perf_window_cv;
+std::set<ze_device_handle_t> GPUDeviceStub::perf_window_devices;
 std::map<ze_device_handle_t, zet_metric_group_handle_t> GPUDeviceStub::target_metric_groups;
 std::map<ze_device_handle_t, ze_context_handle_t> GPUDeviceStub::target_metric_contexts;
+std::map<zet_metric_group_handle_t, EuMetricDecodePlan_t> GPUDeviceStub::eu_metric_decode_plans;
+
+EuMetricDecodePlan_t GPUDeviceStub::buildEuMetricDecodePlan(zet_metric_group_handle_t metric_group) {
+    EuMetricDecodePlan_t plan = {0, -1, -1, -1, -1, -1, -1};
+    uint32_t metricCount = 0;
+    ze_result_t res = zetMetricGet(metric_group, &metricCount, nullptr);
+    if (res != ZE_RESULT_SUCCESS) {
+        throw BaseException("toGetEuActiveStallIdleCore");
+    }
+    std::vector<zet_metric_handle_t> phMetrics(metricCount);
+    res = zetMetricGet(metric_group, &metricCount, phMetrics.data());
+    if (res != ZE_RESULT_SUCCESS) {
+        throw BaseException("toGetEuActiveStallIdleCore");
+    }
+    plan.metric_count = metricCount;
+    for (uint32_t metric = 0; metric < metricCount; metric++) {
+        zet_metric_properties_t metricProperties = {};
+        metricProperties.pNext = nullptr;
+        res = zetMetricGetProperties(phMetrics[metric], &metricProperties);
+        if (res != ZE_RESULT_SUCCESS) {
+            throw BaseException("toGetEuActiveStallIdleCore");
+        }
+        if (std::strcmp(metricProperties.name, "GpuBusy") == 0) {
+            plan.gpu_busy = metric;
+        } else if (std::strcmp(metricProperties.name, "EuActive") == 0) {
+            plan.eu_active = metric;
+        } else if (std::strcmp(metricProperties.name, "EuStall") == 0) {
+            plan.eu_stall = metric;
+        } else if (std::strcmp(metricProperties.name, "XveActive") == 0 ||
+                   std::strcmp(metricProperties.name, "XVE_ACTIVE") == 0) {
+            plan.xve_active = metric;
+        } else if (std::strcmp(metricProperties.name, "XveStall") == 0 ||
+                   std::strcmp(metricProperties.name, "XVE_STALL") == 0) {
+            plan.xve_stall = metric;
+        } else if (std::strcmp(metricProperties.name, "GpuTime") == 0) {
+            plan.gpu_time = metric;
+        }
+    }
+    return plan;
+}
+
 void GPUDeviceStub::toGetEuActiveStallIdleCore(const ze_device_handle_t& device, uint32_t subdeviceId, const ze_driver_handle_t& driver, MeasurementType type, std::shared_ptr<MeasurementData>& data) {
     ze_result_t res;
     zet_metric_group_handle_t hMetricGroup = nullptr;
     ze_context_handle_t hContext = nullptr;
-    zet_metric_streamer_handle_t hMetricStreamer = nullptr;
-    zet_metric_streamer_desc_t metricStreamerDesc = {ZET_STRUCTURE_TYPE_METRIC_STREAMER_DESC};
+    std::shared_ptr<MetricStreamerSession> session;
+    bool opened = false;
+    EuMetricDecodePlan_t plan;
     {
 
     std::unique_lock<std::mutex> lock(GPUDeviceStub::metric_streamer_mutex);
+    // the performance metric groups are active on the device until their window is over
+    GPUDeviceStub::perf_window_cv.wait(lock, [&]() { return GPUDeviceStub::perf_window_devices.count(device) == 0; });
     if (GPUDeviceStub::target_metric_groups.find(device) != GPUDeviceStub::target_metric_groups.end()) {
         hMetricGroup = GPUDeviceStub::target_metric_groups.at(device);
     } else {
         uint32_t metricGroupCount = 0;
-        XPUM_ZE_HANDLE_LOCK(device, res = zetMetricGroupGet(device, &metricGroupCount, nullptr));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zetMetricGroupGet(device, &metricGroupCount, nullptr));
         if (res == ZE_RESULT_SUCCESS) {
             std::vector<zet_metric_group_handle_t> metricGroups(metricGroupCount);
-            XPUM_ZE_HANDLE_LOCK(device, res = zetMetricGroupGet(device, &metricGroupCount, metricGroups.data()));
+            XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zetMetricGroupGet(device, &metricGroupCount, metricGroups.data()));
             if (res == ZE_RESULT_SUCCESS) {
                 for (auto& metric_group : metricGroups) {
                     zet_metric_group_properties_t metric_group_properties = {};
@@ -2055,6 +2290,12 @@ void GPUDeviceStub::toGetEuActiveStallIdleCore(const ze_device_handle_t& device,
         throw BaseException("toGetEuActiveStallIdleCore");
     }
 
+    auto it_plan = GPUDeviceStub::eu_metric_decode_plans.find(hMetricGroup);
+    if (it_plan == GPUDeviceStub::eu_metric_decode_plans.end()) {
+        it_plan = GPUDeviceStub::eu_metric_decode_plans.emplace(hMetricGroup, buildEuMetricDecodePlan(hMetricGroup)).first;
+    }
+    plan = it_plan->second;
+
     if (GPUDeviceStub::target_metric_contexts.find(device) != GPUDeviceStub::target_metric_contexts.end()) {
         hContext = GPUDeviceStub::target_metric_contexts.at(device);
     } else {
@@ -2070,104 +2311,51 @@ void GPUDeviceStub::toGetEuActiveStallIdleCore(const ze_device_handle_t& device,
         GPUDeviceStub::target_metric_contexts[device] = hContext;
     }
 
-    XPUM_ZE_HANDLE_LOCK(device, res = zetContextActivateMetricGroups(hContext, device, 1, &hMetricGroup));
-    if (res != ZE_RESULT_SUCCESS) {
-        throw BaseException("toGetEuActiveStallIdleCore - zetContextActivateMetricGroups");
-    }
-    }
-
-    metricStreamerDesc.samplingPeriod = Configuration::EU_ACTIVE_STALL_IDLE_STREAMER_SAMPLING_PERIOD;
-    XPUM_ZE_HANDLE_LOCK(device, res = zetMetricStreamerOpen(hContext, device, hMetricGroup, &metricStreamerDesc, nullptr, &hMetricStreamer));
-    if (res != ZE_RESULT_SUCCESS) {
-        throw BaseException("toGetEuActiveStallIdleCore - zetMetricStreamerOpen");
-    }
-    std::this_thread::sleep_for(std::chrono::milliseconds(Configuration::EU_ACTIVE_STALL_IDLE_MONITOR_INTERNAL_PERIOD));
-    size_t rawSize = 0;
-    res = zetMetricStreamerReadData(hMetricStreamer, UINT32_MAX, &rawSize, nullptr);
-    if (res != ZE_RESULT_SUCCESS) {
-        throw BaseException("toGetEuActiveStallIdleCore");
-    }
-    std::vector<uint8_t> rawData(rawSize);
-    res = zetMetricStreamerReadData(hMetricStreamer, UINT32_MAX, &rawSize, rawData.data());
-    if (res != ZE_RESULT_SUCCESS) {
-        throw BaseException("toGetEuActiveStallIdleCore");
+    session = MetricStreamerSessionManager::instance().getOrOpenSession(device, hContext, hMetricGroup, opened);
     }
 
-    res = zetMetricStreamerClose(hMetricStreamer);
-    if (res != ZE_RESULT_SUCCESS) {
-        throw BaseException("zetMetricStreamerClose");
-    }
-    {
-    std::unique_lock<std::mutex> lock(GPUDeviceStub::metric_streamer_mutex);
-    res = zetContextActivateMetricGroups(hContext, device, 0, nullptr);
-    if (res != ZE_RESULT_SUCCESS) {
-        throw BaseException("zetContextActivateMetricGroups");
-    }
-    }
-    uint32_t numMetricValues = 0;
-    zet_metric_group_calculation_type_t calculationType = ZET_METRIC_GROUP_CALCULATION_TYPE_METRIC_VALUES;
-    res = zetMetricGroupCalculateMetricValues(hMetricGroup, calculationType, rawSize, rawData.data(), &numMetricValues, nullptr);
-    if (res != ZE_RESULT_SUCCESS) {
-        throw BaseException("toGetEuActiveStallIdleCore");
+    // A newly opened streamer has no reports yet, so wait for the first window.
+    // Later calls only drain the reports collected since the previous sample.
+    // The scratch buffers are per thread since the devices are sampled in parallel.
+    static thread_local MetricReadBuffer buffer;
+    int interval = std::max(Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE, Configuration::EU_ACTIVE_STALL_IDLE_MONITOR_INTERNAL_PERIOD);
+    buffer.reserve(expectedMetricReports(interval, session->sampling_period));
+    buffer.raw_size = 0;
+    if (!opened) {
+        MetricStreamerSessionManager::instance().readData(session, buffer);
     }
-    std::vector<zet_typed_value_t> metricValues(numMetricValues);
-    res = zetMetricGroupCalculateMetricValues(hMetricGroup, calculationType, rawSize, rawData.data(), &numMetricValues, metricValues.data());
-    if (res != ZE_RESULT_SUCCESS) {
-        throw BaseException("toGetEuActiveStallIdleCore");
+    if (buffer.raw_size == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(Configuration::EU_ACTIVE_STALL_IDLE_MONITOR_INTERNAL_PERIOD));
+        MetricStreamerSessionManager::instance().readData(session, buffer);
     }
-    uint32_t metricCount = 0;
-    res = zetMetricGet(hMetricGroup, &metricCount, nullptr);
-    if (res != ZE_RESULT_SUCCESS) {
+    uint32_t metricCount = plan.metric_count;
+    if (metricCount == 0) {
         throw BaseException("toGetEuActiveStallIdleCore");
     }
-    std::vector<zet_metric_handle_t> phMetrics(metricCount);
-    res = zetMetricGet(hMetricGroup, &metricCount, phMetrics.data());
+    res = buffer.calculate(hMetricGroup, metricCount);
     if (res != ZE_RESULT_SUCCESS) {
         throw BaseException("toGetEuActiveStallIdleCore");
     }
+    uint32_t numMetricValues = buffer.value_count;
+    const zet_typed_value_t* metricValues = buffer.values.data();
 
+    // Only the metrics listed in the decode plan are read from each report
+    auto readFp32 = [](const zet_typed_value_t* report, int32_t index) -> uint64_t {
+        return index < 0 ? 0 : report[index].value.fp32;
+    };
     uint32_t numReports = numMetricValues / metricCount;
-    std::vector<uint64_t> currents(4);
     uint64_t totalGpuBusy = 0;
     uint64_t totalEuStall = 0;
     uint64_t totalEuActive = 0;
     uint64_t totalGPUElapsedTime = 0;
     for (uint32_t report = 0; report < numReports; ++report) {
-        uint64_t currentGpuBusy = 0;
-        uint64_t currentEuStall = 0;
-        uint64_t currentEuActive = 0;
-        uint64_t currentXveStall = 0;
-        uint64_t currentXueActive = 0;
-        uint64_t currentGPUElapsedTime = 0;
-        for (uint32_t metric = 0; metric < metricCount; metric++) {
-            zet_typed_value_t data = metricValues[report * metricCount + metric];
-            zet_metric_properties_t metricProperties = {};
-            metricProperties.pNext = nullptr;
-            res = zetMetricGetProperties(phMetrics[metric], &metricProperties);
-            if (res != ZE_RESULT_SUCCESS) {
-                throw BaseException("toGetEuActiveStallIdleCore");
-            }
-            if (std::strcmp(metricProperties.name, "GpuBusy") == 0) {
-                currentGpuBusy = data.value.fp32;
-            }
-            if (std::strcmp(metricProperties.name, "EuActive") == 0) {
-                currentEuActive = data.value.fp32;
-            }
-            if (std::strcmp(metricProperties.name, "EuStall") == 0) {
-                currentEuStall = data.value.fp32;
-            }
-            if (strcmp(metricProperties.name, "XveActive") == 0 ||
-                    strcmp(metricProperties.name, "XVE_ACTIVE") == 0) {
-                currentXueActive = data.value.fp32;
-            } 
-            if (strcmp(metricProperties.name, "XveStall") == 0 ||
-                    strcmp(metricProperties.name, "XVE_STALL") == 0) {
-                currentXveStall = data.value.fp32;
-            }
-            if (std::strcmp(metricProperties.name, "GpuTime") == 0) {
-                currentGPUElapsedTime = data.value.ui64;
-            }
-        }
+        const zet_typed_value_t* values = metricValues + report * metricCount;
+        uint64_t currentGpuBusy = readFp32(values, plan.gpu_busy);
+        uint64_t currentEuStall = readFp32(values, plan.eu_stall);
+        uint64_t currentEuActive = readFp32(values, plan.eu_active);
+        uint64_t currentXveStall = readFp32(values, plan.xve_stall);
+        uint64_t currentXueActive = readFp32(values, plan.xve_active);
+        uint64_t currentGPUElapsedTime = plan.gpu_time < 0 ? 0 : values[plan.gpu_time].value.ui64;
         currentEuActive = std::max(currentEuActive, currentXueActive);
         currentEuStall = std::max(currentEuStall, currentXveStall);
         if (currentEuActive > 100 || currentEuStall > 100) {
@@ -2220,12 +2408,12 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetEuActiveStallIdle(const ze_
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
     ze_result_t res;
     uint32_t sub_device_count = 0;
-    XPUM_ZE_HANDLE_LOCK(device, res = zeDeviceGetSubDevices(device, &sub_device_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zeDeviceGetSubDevices(device, &sub_device_count, nullptr));
     if (res != ZE_RESULT_SUCCESS) {
         throw BaseException("toGetEuActiveStallIdle");
     }
     std::vector<ze_device_handle_t> sub_device_handles(sub_device_count);
-    XPUM_ZE_HANDLE_LOCK(device, res = zeDeviceGetSubDevices(device, &sub_device_count, sub_device_handles.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zeDeviceGetSubDevices(device, &sub_device_count, sub_device_handles.data()));
     if (res != ZE_RESULT_SUCCESS) {
         throw BaseException("toGetEuActiveStallIdle");
     }
@@ -2236,7 +2424,7 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetEuActiveStallIdle(const ze_
     for (auto& sub_device : sub_device_handles) {
         ze_device_properties_t props = {};
         props.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
-        XPUM_ZE_HANDLE_LOCK(device, res = zeDeviceGetProperties(sub_device, &props));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zeDeviceGetProperties(sub_device, &props));
         if (res != ZE_RESULT_SUCCESS) {
             throw BaseException("toGetEuActiveStallIdle");
         }
@@ -2245,139 +2433,72 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetEuActiveStallIdle(const ze_
     return ret;
 }
 
-void GPUDeviceStub::getRasError(const zes_device_handle_t& device, Callback_t callback, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType) noexcept {
+void GPUDeviceStub::getRasErrorOnSubdevice(const zes_device_handle_t& device, Callback_t callback) noexcept {
     if (device == nullptr) {
         return;
     }
-    //invokeTask(callback, toGetRasError, device,ZES_RAS_ERROR_CAT_RESET,ZES_RAS_ERROR_TYPE_UNCORRECTABLE);
-    invokeTask(callback, toGetRasError, device, rasCat, rasType);
+    //invokeTask(callback, toGetRasErrorOnSubdevice, device,ZES_RAS_ERROR_CAT_RESET,ZES_RAS_ERROR_TYPE_UNCORRECTABLE);
+    invokeTask(callback, toGetRasErrorOnSubdevice, device);
 }
 
-std::shared_ptr<MeasurementData> GPUDeviceStub::toGetRasError(const zes_device_handle_t& device, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType) {
-    //rasCat: ZES_RAS_ERROR_CAT_RESET; rasType: ZES_RAS_ERROR_TYPE_CORRECTABLE,ZES_RAS_ERROR_TYPE_UNCORRECTABLE
-    if (device == nullptr) {
-        throw BaseException("toGetRasError error");
+ze_result_t GPUDeviceStub::readRasErrorStates(const zes_device_handle_t& device, std::vector<RasErrorState_t>& states) {
+    std::vector<SysmanHandleCache::RasErrorSet> rasErrorSets;
+    ze_result_t res = SysmanHandleCache::instance().getRasErrorSets(device, rasErrorSets, ras_m);
+    if (res != ZE_RESULT_SUCCESS) {
+        return res;
     }
-    uint32_t numRasErrorSets = 0;
-    ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumRasErrorSets(device, &numRasErrorSets, nullptr));
-    if (res == ZE_RESULT_SUCCESS && numRasErrorSets > 0) {
-        std::vector<zes_ras_handle_t> phRasErrorSets(numRasErrorSets);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumRasErrorSets(device, &numRasErrorSets, phRasErrorSets.data()));
-        if (res == ZE_RESULT_SUCCESS) {
-            uint64_t rasCounter = 0;
-            for (auto& rasHandle : phRasErrorSets) {
-                // globally lock for RAS APIs to avoid two issues: 1) invalid read/write memory in zesRasGetState; 2) kernel error msg "mei-gsc mei-gscfi.3.auto: id exceeded 256"
-                std::lock_guard<std::mutex> lock(ras_m);
-                zes_ras_properties_t props = {};
-                props.stype = ZES_STRUCTURE_TYPE_RAS_PROPERTIES;
-                XPUM_ZE_HANDLE_LOCK(rasHandle, res = zesRasGetProperties(rasHandle, &props));
-                if (res == ZE_RESULT_SUCCESS) {
-                    //if (props.supported && props.enabled) {
-                    if (props.type == rasType) {
-                        zes_ras_state_t errorDetails = {};
-                        XPUM_ZE_HANDLE_LOCK(rasHandle, res = zesRasGetState(rasHandle, 0, &errorDetails));
-                        if (res == ZE_RESULT_SUCCESS) {
-                            rasCounter += errorDetails.category[rasCat];
-                        }
-                    }
-                    //}
-                }
-            }
-            return std::make_shared<MeasurementData>(rasCounter);
+    for (auto& rasErrorSet : rasErrorSets) {
+        auto& rasHandle = rasErrorSet.handle;
+        auto& props = rasErrorSet.props;
+        if (rasErrorSet.props_result != ZE_RESULT_SUCCESS || (props.type != ZES_RAS_ERROR_TYPE_CORRECTABLE && props.type != ZES_RAS_ERROR_TYPE_UNCORRECTABLE)) {
+            continue;
         }
+        RasErrorState_t state = {};
+        // globally lock for RAS APIs to avoid two issues: 1) invalid read/write memory in zesRasGetState; 2) kernel error msg "mei-gsc mei-gscfi.3.auto: id exceeded 256"
+        std::lock_guard<std::mutex> lock(ras_m);
+        XPUM_ZE_HANDLE_LOCK(rasHandle, res = zesRasGetState(rasHandle, 0, &state.state));
+        if (res != ZE_RESULT_SUCCESS) {
+            continue;
+        }
+        state.type = props.type;
+        state.on_subdevice = props.onSubdevice;
+        state.subdevice_id = props.subdeviceId;
+        states.push_back(state);
     }
-    throw BaseException("toGetRasError error");
-}
-
-void GPUDeviceStub::getRasErrorOnSubdevice(const zes_device_handle_t& device, Callback_t callback) noexcept {
-    if (device == nullptr) {
-        return;
-    }
-    //invokeTask(callback, toGetRasErrorOnSubdevice, device,ZES_RAS_ERROR_CAT_RESET,ZES_RAS_ERROR_TYPE_UNCORRECTABLE);
-    invokeTask(callback, toGetRasErrorOnSubdevice, device);
+    return states.empty() ? ZE_RESULT_ERROR_NOT_AVAILABLE : ZE_RESULT_SUCCESS;
 }
 
 std::shared_ptr<MeasurementData> GPUDeviceStub::toGetRasErrorOnSubdevice(const zes_device_handle_t& device) {
-    //rasCat: ZES_RAS_ERROR_CAT_RESET; rasType: ZES_RAS_ERROR_TYPE_CORRECTABLE,ZES_RAS_ERROR_TYPE_UNCORRECTABLE
     if (device == nullptr) {
         throw BaseException("toGetRasErrorOnSubdevice error");
     }
 
-    ////
-    bool dataAcquired = false;
+    // every category is fanned out from the one read of each set, the reset counter as the data, the others as additional data
+    std::vector<RasErrorState_t> states;
+    if (readRasErrorStates(device, states) != ZE_RESULT_SUCCESS) {
+        throw BaseException("toGetRasErrorOnSubdevice error");
+    }
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
-    uint32_t subdeviceId = UINT32_MAX;
-    uint64_t rasCounter = 0;
-    uint32_t numRasErrorSets = 0;
-    ze_result_t res;
-    zes_ras_state_t errorDetails = {};
-
-    ////
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumRasErrorSets(device, &numRasErrorSets, nullptr));
-    if (res == ZE_RESULT_SUCCESS && numRasErrorSets > 0) {
-        std::vector<zes_ras_handle_t> phRasErrorSets(numRasErrorSets);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumRasErrorSets(device, &numRasErrorSets, phRasErrorSets.data()));
-        if (res == ZE_RESULT_SUCCESS) {
-            //uint64_t rasCounter = 0;
-            for (auto& rasHandle : phRasErrorSets) {
-                // globally lock for RAS APIs to avoid two issues: 1) invalid read/write memory in zesRasGetState; 2) kernel error msg "mei-gsc mei-gscfi.3.auto: id exceeded 256"
-                std::lock_guard<std::mutex> lock(ras_m);
-                zes_ras_properties_t props = {};
-                props.stype = ZES_STRUCTURE_TYPE_RAS_PROPERTIES;
-                XPUM_ZE_HANDLE_LOCK(rasHandle, res = zesRasGetProperties(rasHandle, &props));
-                if (res == ZE_RESULT_SUCCESS) {
-                    //if (props.supported && props.enabled) {
-                    if (props.type == ZES_RAS_ERROR_TYPE_UNCORRECTABLE) {
-                        XPUM_ZE_HANDLE_LOCK(rasHandle, res = zesRasGetState(rasHandle, 0, &errorDetails));
-                        if (res == ZE_RESULT_SUCCESS) {
-                            subdeviceId = props.onSubdevice ? props.subdeviceId : UINT32_MAX;
-                            //
-                            rasCounter = errorDetails.category[ZES_RAS_ERROR_CAT_RESET];
-                            props.onSubdevice ? ret->setSubdeviceDataCurrent(subdeviceId, rasCounter) : ret->setCurrent(rasCounter);
-                            //
-                            rasCounter = errorDetails.category[ZES_RAS_ERROR_CAT_PROGRAMMING_ERRORS];
-                            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_PROGRAMMING_ERRORS, rasCounter);
-                            rasCounter = errorDetails.category[ZES_RAS_ERROR_CAT_DRIVER_ERRORS];
-                            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_DRIVER_ERRORS, rasCounter);
-                            //
-                            rasCounter = errorDetails.category[ZES_RAS_ERROR_CAT_CACHE_ERRORS];
-                            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE, rasCounter);
-                            rasCounter = errorDetails.category[ZES_RAS_ERROR_CAT_DISPLAY_ERRORS];
-                            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE, rasCounter);
-                            rasCounter = errorDetails.category[ZES_RAS_ERROR_CAT_NON_COMPUTE_ERRORS];
-                            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE, rasCounter);
-                            dataAcquired = true;
-                        }
-                    } else if (props.type == ZES_RAS_ERROR_TYPE_CORRECTABLE) {
-                        XPUM_ZE_HANDLE_LOCK(rasHandle, res = zesRasGetState(rasHandle, 0, &errorDetails));
-                        if (res == ZE_RESULT_SUCCESS) {
-                            subdeviceId = props.onSubdevice ? props.subdeviceId : UINT32_MAX;
-                            //
-                            rasCounter = errorDetails.category[ZES_RAS_ERROR_CAT_CACHE_ERRORS];
-                            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE, rasCounter);
-                            rasCounter = errorDetails.category[ZES_RAS_ERROR_CAT_DISPLAY_ERRORS];
-                            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE, rasCounter);
-                            rasCounter = errorDetails.category[ZES_RAS_ERROR_CAT_NON_COMPUTE_ERRORS];
-                            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE, rasCounter);
-                            dataAcquired = true;
-                        }
-                    }
-                    //}
-                }
-            }
-            //return std::make_shared<MeasurementData>(rasCounter);
+    for (auto& state : states) {
+        uint32_t subdeviceId = state.on_subdevice ? state.subdevice_id : UINT32_MAX;
+        auto& category = state.state.category;
+        if (state.type == ZES_RAS_ERROR_TYPE_UNCORRECTABLE) {
+            state.on_subdevice ? ret->setSubdeviceDataCurrent(subdeviceId, category[ZES_RAS_ERROR_CAT_RESET]) : ret->setCurrent(category[ZES_RAS_ERROR_CAT_RESET]);
+            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_PROGRAMMING_ERRORS, category[ZES_RAS_ERROR_CAT_PROGRAMMING_ERRORS]);
+            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_DRIVER_ERRORS, category[ZES_RAS_ERROR_CAT_DRIVER_ERRORS]);
+            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE, category[ZES_RAS_ERROR_CAT_CACHE_ERRORS]);
+            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE, category[ZES_RAS_ERROR_CAT_DISPLAY_ERRORS]);
+            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE, category[ZES_RAS_ERROR_CAT_NON_COMPUTE_ERRORS]);
+        } else {
+            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE, category[ZES_RAS_ERROR_CAT_CACHE_ERRORS]);
+            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE, category[ZES_RAS_ERROR_CAT_DISPLAY_ERRORS]);
+            ret->setSubdeviceAdditionalData(subdeviceId, METRIC_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE, category[ZES_RAS_ERROR_CAT_NON_COMPUTE_ERRORS]);
         }
     }
-    if (res == ZE_RESULT_SUCCESS && dataAcquired) {
-        return ret;
-    } else {
-        throw BaseException("toGetRasErrorOnSubdevice error");
-    }
+    return ret;
 }
 
 void GPUDeviceStub::getRasError(const zes_device_handle_t& device, uint64_t errorCategory[XPUM_RAS_ERROR_MAX]) noexcept {
-    //uint64_t errorCategory[XPUM_RAS_ERROR_MAX];
     for (int i = 0; i < XPUM_RAS_ERROR_MAX; i++) {
         errorCategory[i] = 0;
     }
@@ -2386,101 +2507,53 @@ void GPUDeviceStub::getRasError(const zes_device_handle_t& device, uint64_t erro
         return;
     }
 
-    //
-    uint32_t numRasErrorSets = 0;
-    ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumRasErrorSets(device, &numRasErrorSets, nullptr));
-    if (res == ZE_RESULT_SUCCESS) {
-        std::vector<zes_ras_handle_t> phRasErrorSets(numRasErrorSets);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumRasErrorSets(device, &numRasErrorSets, phRasErrorSets.data()));
-        if (res == ZE_RESULT_SUCCESS) {
-            for (auto& rasHandle : phRasErrorSets) {
-                // globally lock for RAS APIs to avoid two issues: 1) invalid read/write memory in zesRasGetState; 2) kernel error msg "mei-gsc mei-gscfi.3.auto: id exceeded 256"
-                std::lock_guard<std::mutex> lock(ras_m);
-                zes_ras_properties_t props = {};
-                props.stype = ZES_STRUCTURE_TYPE_RAS_PROPERTIES;
-                XPUM_ZE_HANDLE_LOCK(rasHandle, res = zesRasGetProperties(rasHandle, &props));
-                if (res == ZE_RESULT_SUCCESS) {
-                    if (props.type == ZES_RAS_ERROR_TYPE_CORRECTABLE) {
-                        zes_ras_state_t errorDetails = {};
-                        XPUM_ZE_HANDLE_LOCK(rasHandle, res = zesRasGetState(rasHandle, 0, &errorDetails));
-                        if (res == ZE_RESULT_SUCCESS) {
-                            errorCategory[XPUM_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE] += errorDetails.category[ZES_RAS_ERROR_CAT_CACHE_ERRORS];
-                            errorCategory[XPUM_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE] += errorDetails.category[ZES_RAS_ERROR_CAT_DISPLAY_ERRORS];
-                        }
-                    } else if (props.type == ZES_RAS_ERROR_TYPE_UNCORRECTABLE) {
-                        zes_ras_state_t errorDetails = {};
-                        XPUM_ZE_HANDLE_LOCK(rasHandle, res = zesRasGetState(rasHandle, 0, &errorDetails));
-                        if (res == ZE_RESULT_SUCCESS) {
-                            errorCategory[XPUM_RAS_ERROR_CAT_RESET] += errorDetails.category[ZES_RAS_ERROR_CAT_RESET];
-                            errorCategory[XPUM_RAS_ERROR_CAT_PROGRAMMING_ERRORS] += errorDetails.category[ZES_RAS_ERROR_CAT_PROGRAMMING_ERRORS];
-                            errorCategory[XPUM_RAS_ERROR_CAT_DRIVER_ERRORS] += errorDetails.category[ZES_RAS_ERROR_CAT_DRIVER_ERRORS];
-                            //
-                            errorCategory[XPUM_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE] += errorDetails.category[ZES_RAS_ERROR_CAT_CACHE_ERRORS];
-                            errorCategory[XPUM_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE] += errorDetails.category[ZES_RAS_ERROR_CAT_DISPLAY_ERRORS];
-                        }
-                    }
-                }
-            }
-            return;
+    std::vector<RasErrorState_t> states;
+    readRasErrorStates(device, states);
+    for (auto& state : states) {
+        auto& category = state.state.category;
+        if (state.type == ZES_RAS_ERROR_TYPE_CORRECTABLE) {
+            errorCategory[XPUM_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE] += category[ZES_RAS_ERROR_CAT_CACHE_ERRORS];
+            errorCategory[XPUM_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE] += category[ZES_RAS_ERROR_CAT_DISPLAY_ERRORS];
+            errorCategory[XPUM_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE] += category[ZES_RAS_ERROR_CAT_NON_COMPUTE_ERRORS];
+        } else {
+            errorCategory[XPUM_RAS_ERROR_CAT_RESET] += category[ZES_RAS_ERROR_CAT_RESET];
+            errorCategory[XPUM_RAS_ERROR_CAT_PROGRAMMING_ERRORS] += category[ZES_RAS_ERROR_CAT_PROGRAMMING_ERRORS];
+            errorCategory[XPUM_RAS_ERROR_CAT_DRIVER_ERRORS] += category[ZES_RAS_ERROR_CAT_DRIVER_ERRORS];
+            errorCategory[XPUM_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE] += category[ZES_RAS_ERROR_CAT_CACHE_ERRORS];
+            errorCategory[XPUM_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE] += category[ZES_RAS_ERROR_CAT_DISPLAY_ERRORS];
+            errorCategory[XPUM_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE] += category[ZES_RAS_ERROR_CAT_NON_COMPUTE_ERRORS];
         }
     }
-    //throw BaseException("getRasError error");
 }
 
-void GPUDeviceStub::getRasErrorOnSubdevice(const zes_device_handle_t& device, Callback_t callback, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType) noexcept {
+bool GPUDeviceStub::hasRasEventThresholds(const zes_device_handle_t& device) {
     if (device == nullptr) {
-        return;
+        return false;
     }
-    //invokeTask(callback, toGetRasErrorOnSubdevice, device,ZES_RAS_ERROR_CAT_RESET,ZES_RAS_ERROR_TYPE_UNCORRECTABLE);
-    invokeTask(callback, toGetRasErrorOnSubdeviceOld, device, rasCat, rasType);
-}
-
-std::shared_ptr<MeasurementData> GPUDeviceStub::toGetRasErrorOnSubdeviceOld(const zes_device_handle_t& device, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType) {
-    //rasCat: ZES_RAS_ERROR_CAT_RESET; rasType: ZES_RAS_ERROR_TYPE_CORRECTABLE,ZES_RAS_ERROR_TYPE_UNCORRECTABLE
-    if (device == nullptr) {
-        throw BaseException("toGetRasErrorOnSubdevice error");
+    std::vector<SysmanHandleCache::RasErrorSet> rasErrorSets;
+    ze_result_t res = SysmanHandleCache::instance().getRasErrorSets(device, rasErrorSets, ras_m);
+    if (res != ZE_RESULT_SUCCESS || rasErrorSets.empty()) {
+        return false;
     }
-    bool dataAcquired = false;
-    std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
-
-    ////
-    uint32_t numRasErrorSets = 0;
-    ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumRasErrorSets(device, &numRasErrorSets, nullptr));
-    if (res == ZE_RESULT_SUCCESS && numRasErrorSets > 0) {
-        std::vector<zes_ras_handle_t> phRasErrorSets(numRasErrorSets);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumRasErrorSets(device, &numRasErrorSets, phRasErrorSets.data()));
-        if (res == ZE_RESULT_SUCCESS) {
-            //uint64_t rasCounter = 0;
-            for (auto& rasHandle : phRasErrorSets) {
-                // globally lock for RAS APIs to avoid two issues: 1) invalid read/write memory in zesRasGetState; 2) kernel error msg "mei-gsc mei-gscfi.3.auto: id exceeded 256"
-                std::lock_guard<std::mutex> lock(ras_m);
-                zes_ras_properties_t props = {};
-                props.stype = ZES_STRUCTURE_TYPE_RAS_PROPERTIES;
-                XPUM_ZE_HANDLE_LOCK(rasHandle, res = zesRasGetProperties(rasHandle, &props));
-                if (res == ZE_RESULT_SUCCESS) {
-                    //if (props.supported && props.enabled) {
-                    if (props.type == rasType) {
-                        zes_ras_state_t errorDetails = {};
-                        XPUM_ZE_HANDLE_LOCK(rasHandle, res = zesRasGetState(rasHandle, 0, &errorDetails));
-                        if (res == ZE_RESULT_SUCCESS) {
-                            uint64_t rasCounter = errorDetails.category[rasCat];
-                            props.onSubdevice ? ret->setSubdeviceDataCurrent(props.subdeviceId, rasCounter) : ret->setCurrent(rasCounter);
-                            dataAcquired = true;
-                        }
-                    }
-                    //}
-                }
-            }
-            //return std::make_shared<MeasurementData>(rasCounter);
+    for (auto& rasErrorSet : rasErrorSets) {
+        auto& rasHandle = rasErrorSet.handle;
+        std::lock_guard<std::mutex> lock(ras_m);
+        zes_ras_config_t config = {};
+        config.stype = ZES_STRUCTURE_TYPE_RAS_CONFIG;
+        XPUM_ZE_HANDLE_SHARED_LOCK(rasHandle, res = zesRasGetConfig(rasHandle, &config));
+        if (res != ZE_RESULT_SUCCESS) {
+            return false;
+        }
+        // a threshold of 0 disables the event
+        bool hasThreshold = config.totalThreshold > 0;
+        for (int i = 0; i < ZES_MAX_RAS_ERROR_CATEGORY_COUNT; i++) {
+            hasThreshold = hasThreshold || config.detailedThresholds.category[i] > 0;
+        }
+        if (!hasThreshold) {
+            return false;
         }
     }
-    if (res == ZE_RESULT_SUCCESS && dataAcquired) {
-        return ret;
-    } else {
-        throw BaseException("toGetRasErrorOnSubdevice error");
-    }
+    return true;
 }
 
 void GPUDeviceStub::getGPUUtilization(const zes_device_handle_t& device, Callback_t callback) noexcept {
@@ -2497,51 +2570,37 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetGPUUtilization(const zes_de
 
     std::map<std::string, ze_result_t> exception_msgs;
     bool data_acquired = false;
-    uint32_t engine_count = 0;
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
     ze_result_t res;
     zes_device_properties_t props = {};
     props.stype = ZES_STRUCTURE_TYPE_DEVICE_PROPERTIES;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceGetProperties(device, &props));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceGetProperties(device, &props));
     if (res == ZE_RESULT_SUCCESS) {
         ret->setNumSubdevices(props.numSubdevices);
     } else {
         exception_msgs["zesDeviceGetProperties"] = res;
     }
 
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_count, nullptr));
+    std::shared_ptr<const EngineActivitySnapshot_t> snapshot;
+    res = getEngineActivitySnapshot(device, ENGINE_ACTIVITY_GPU_UTILIZATION, snapshot);
     if (res == ZE_RESULT_SUCCESS) {
-        std::vector<zes_engine_handle_t> engines(engine_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_count, engines.data()));
-        if (res == ZE_RESULT_SUCCESS) {
-            for (auto& engine : engines) {
-                zes_engine_properties_t props = {};
-                props.stype = ZES_STRUCTURE_TYPE_ENGINE_PROPERTIES;
-                props.pNext = nullptr;
-                XPUM_ZE_HANDLE_LOCK(engine, res = zesEngineGetProperties(engine, &props));
-                if (res == ZE_RESULT_SUCCESS) {
-                    if (props.type == ZES_ENGINE_GROUP_ALL) {
-                        zes_engine_stats_t snap = {};
-                        XPUM_ZE_HANDLE_LOCK(engine, res = zesEngineGetActivity(engine, &snap));
-                        if (res == ZE_RESULT_SUCCESS) {
-                            ExtendedMeasurementData data;
-                            data.on_subdevice = props.onSubdevice;
-                            data.subdevice_id = props.subdeviceId;
-                            data.type = props.type;
-                            data.active_time = snap.activeTime;
-                            data.timestamp = snap.timestamp;
-                            ret->addExtendedData(uint64_t(engine), data);
-                            data_acquired = true;
-                        } else {
-                            exception_msgs["zesEngineGetActivity"] = res;
-                        }
-                    }
-                } else {
-                    exception_msgs["zesEngineGetProperties"] = res;
-                }
+        for (size_t i = 0; i < snapshot->engines->size(); i++) {
+            auto& engine = (*snapshot->engines)[i];
+            if (engine.type != ZES_ENGINE_GROUP_ALL) {
+                continue;
+            }
+            if (snapshot->results[i] == ZE_RESULT_SUCCESS) {
+                ExtendedMeasurementData data;
+                data.on_subdevice = engine.on_subdevice;
+                data.subdevice_id = engine.subdevice_id;
+                data.type = engine.type;
+                data.active_time = snapshot->stats[i].activeTime;
+                data.timestamp = snapshot->stats[i].timestamp;
+                ret->addExtendedData(uint64_t(engine.handle), data);
+                data_acquired = true;
+            } else {
+                exception_msgs["zesEngineGetActivity"] = snapshot->results[i];
             }
-        } else {
-            exception_msgs["zesDeviceEnumEngineGroups"] = res;
         }
     } else {
         exception_msgs["zesDeviceEnumEngineGroups"] = res;
@@ -2568,43 +2627,28 @@ std::shared_ptr<EngineCollectionMeasurementData> GPUDeviceStub::toGetEngineUtili
 
     std::map<std::string, ze_result_t> exception_msgs;
     bool data_acquired = false;
-    uint32_t engine_count = 0;
-    std::shared_ptr<EngineCollectionMeasurementData> ret = std::make_shared<EngineCollectionMeasurementData>();
+    std::shared_ptr<EngineCollectionMeasurementData> ret = std::make_shared<EngineCollectionMeasurementData>(MultiMetricsSchema::instance(device, SCHEMA_ENGINE));
     ze_result_t res;
     zes_device_properties_t props = {};
     props.stype = ZES_STRUCTURE_TYPE_DEVICE_PROPERTIES;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceGetProperties(device, &props));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceGetProperties(device, &props));
     if (res == ZE_RESULT_SUCCESS) {
         ret->setNumSubdevices(props.numSubdevices);
     } else {
         exception_msgs["zesDeviceGetProperties"] = res;
     }
 
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_count, nullptr));
+    std::shared_ptr<const EngineActivitySnapshot_t> snapshot;
+    res = getEngineActivitySnapshot(device, ENGINE_ACTIVITY_ENGINE_UTILIZATION, snapshot);
     if (res == ZE_RESULT_SUCCESS) {
-        std::vector<zes_engine_handle_t> engines(engine_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_count, engines.data()));
-        if (res == ZE_RESULT_SUCCESS) {
-            for (auto& engine : engines) {
-                zes_engine_properties_t props = {};
-                props.stype = ZES_STRUCTURE_TYPE_ENGINE_PROPERTIES;
-                props.pNext = nullptr;
-                XPUM_ZE_HANDLE_LOCK(engine, res = zesEngineGetProperties(engine, &props));
-                if (res == ZE_RESULT_SUCCESS) {
-                    zes_engine_stats_t snap = {};
-                    XPUM_ZE_HANDLE_LOCK(engine, res = zesEngineGetActivity(engine, &snap));
-                    if (res == ZE_RESULT_SUCCESS) {
-                        ret->addRawData(uint64_t(engine), props.type, (bool)props.onSubdevice, props.subdeviceId, snap.activeTime, snap.timestamp);
-                        data_acquired = true;
-                    } else {
-                        exception_msgs["zesEngineGetActivity"] = res;
-                    }
-                } else {
-                    exception_msgs["zesEngineGetProperties"] = res;
-                }
+        for (size_t i = 0; i < snapshot->engines->size(); i++) {
+            auto& engine = (*snapshot->engines)[i];
+            if (snapshot->results[i] == ZE_RESULT_SUCCESS) {
+                ret->addRawData(uint64_t(engine.handle), engine.type, engine.on_subdevice, engine.subdevice_id, snapshot->stats[i].activeTime, snapshot->stats[i].timestamp);
+                data_acquired = true;
+            } else {
+                exception_msgs["zesEngineGetActivity"] = snapshot->results[i];
             }
-        } else {
-            exception_msgs["zesDeviceEnumEngineGroups"] = res;
         }
     } else {
         exception_msgs["zesDeviceEnumEngineGroups"] = res;
@@ -2631,78 +2675,62 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetEngineGroupUtilization(cons
 
     std::map<std::string, ze_result_t> exception_msgs;
     bool data_acquired = false;
-    uint32_t engine_count = 0;
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
     ze_result_t res;
     zes_device_properties_t props = {};
     props.stype = ZES_STRUCTURE_TYPE_DEVICE_PROPERTIES;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceGetProperties(device, &props));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceGetProperties(device, &props));
     if (res == ZE_RESULT_SUCCESS) {
         ret->setNumSubdevices(props.numSubdevices);
     } else {
         exception_msgs["zesDeviceGetProperties"] = res;
     }
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_count, nullptr));
+    std::shared_ptr<const EngineActivitySnapshot_t> snapshot;
+    res = getEngineActivitySnapshot(device, engineActivityGroupConsumer(engine_group_type), snapshot);
     if (res == ZE_RESULT_SUCCESS) {
-        std::vector<zes_engine_handle_t> engines(engine_count);
-        std::map<uint32_t, std::vector<uint32_t>> group_utilizations;
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_count, engines.data()));
-        if (res == ZE_RESULT_SUCCESS) {
-            for (auto& engine : engines) {
-                zes_engine_properties_t props = {};
-                props.stype = ZES_STRUCTURE_TYPE_ENGINE_PROPERTIES;
-                props.pNext = nullptr;
-                XPUM_ZE_HANDLE_LOCK(engine, res = zesEngineGetProperties(engine, &props));
-                if (res == ZE_RESULT_SUCCESS) {
-                    switch (engine_group_type) {
-                        case ZES_ENGINE_GROUP_COMPUTE_ALL:
-                            if (props.type != ZES_ENGINE_GROUP_COMPUTE_SINGLE && props.type != ZES_ENGINE_GROUP_COMPUTE_ALL) {
-                                continue;
-                            }
-                            break;
-                        case ZES_ENGINE_GROUP_RENDER_ALL:
-                            if (props.type != ZES_ENGINE_GROUP_RENDER_SINGLE && props.type != ZES_ENGINE_GROUP_RENDER_ALL) {
-                                continue;
-                            }
-                            break;
-                        case ZES_ENGINE_GROUP_MEDIA_ALL:
-                            if (props.type != ZES_ENGINE_GROUP_MEDIA_ALL && !(props.type == ZES_ENGINE_GROUP_MEDIA_DECODE_SINGLE || props.type == ZES_ENGINE_GROUP_MEDIA_ENCODE_SINGLE || props.type == ZES_ENGINE_GROUP_MEDIA_ENHANCEMENT_SINGLE)) {
-                                continue;
-                            }
-                            break;
-                        case ZES_ENGINE_GROUP_COPY_ALL:
-                            if (props.type != ZES_ENGINE_GROUP_COPY_SINGLE && props.type != ZES_ENGINE_GROUP_COPY_ALL) {
-                                continue;
-                            }
-                            break;
-                        case ZES_ENGINE_GROUP_3D_ALL:
-                            if (props.type != ZES_ENGINE_GROUP_3D_SINGLE && props.type != ZES_ENGINE_GROUP_3D_ALL) {
-                                continue;
-                            }
-                            break;
-                        default:
-                            break;
+        for (size_t i = 0; i < snapshot->engines->size(); i++) {
+            auto& engine = (*snapshot->engines)[i];
+            switch (engine_group_type) {
+                case ZES_ENGINE_GROUP_COMPUTE_ALL:
+                    if (engine.type != ZES_ENGINE_GROUP_COMPUTE_SINGLE && engine.type != ZES_ENGINE_GROUP_COMPUTE_ALL) {
+                        continue;
                     }
-                    zes_engine_stats_t snap = {};
-                    XPUM_ZE_HANDLE_LOCK(engine, res = zesEngineGetActivity(engine, &snap));
-                    if (res == ZE_RESULT_SUCCESS) {
-                        ExtendedMeasurementData data;
-                        data.on_subdevice = props.onSubdevice;
-                        data.subdevice_id = props.subdeviceId;
-                        data.type = props.type;
-                        data.active_time = snap.activeTime;
-                        data.timestamp = snap.timestamp;
-                        ret->addExtendedData(uint64_t(engine), data);
-                        data_acquired = true;
-                    } else {
-                        exception_msgs["zesEngineGetActivity"] = res;
+                    break;
+                case ZES_ENGINE_GROUP_RENDER_ALL:
+                    if (engine.type != ZES_ENGINE_GROUP_RENDER_SINGLE && engine.type != ZES_ENGINE_GROUP_RENDER_ALL) {
+                        continue;
                     }
-                } else {
-                    exception_msgs["zesEngineGetProperties"] = res;
-                }
+                    break;
+                case ZES_ENGINE_GROUP_MEDIA_ALL:
+                    if (engine.type != ZES_ENGINE_GROUP_MEDIA_ALL && !(engine.type == ZES_ENGINE_GROUP_MEDIA_DECODE_SINGLE || engine.type == ZES_ENGINE_GROUP_MEDIA_ENCODE_SINGLE || engine.type == ZES_ENGINE_GROUP_MEDIA_ENHANCEMENT_SINGLE)) {
+                        continue;
+                    }
+                    break;
+                case ZES_ENGINE_GROUP_COPY_ALL:
+                    if (engine.type != ZES_ENGINE_GROUP_COPY_SINGLE && engine.type != ZES_ENGINE_GROUP_COPY_ALL) {
+                        continue;
+                    }
+                    break;
+                case ZES_ENGINE_GROUP_3D_ALL:
+                    if (engine.type != ZES_ENGINE_GROUP_3D_SINGLE && engine.type != ZES_ENGINE_GROUP_3D_ALL) {
+                        continue;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            if (snapshot->results[i] == ZE_RESULT_SUCCESS) {
+                ExtendedMeasurementData data;
+                data.on_subdevice = engine.on_subdevice;
+                data.subdevice_id = engine.subdevice_id;
+                data.type = engine.type;
+                data.active_time = snapshot->stats[i].activeTime;
+                data.timestamp = snapshot->stats[i].timestamp;
+                ret->addExtendedData(uint64_t(engine.handle), data);
+                data_acquired = true;
+            } else {
+                exception_msgs["zesEngineGetActivity"] = snapshot->results[i];
             }
-        } else {
-            exception_msgs["zesDeviceEnumEngineGroups"] = res;
         }
     } else {
         exception_msgs["zesDeviceEnumEngineGroups"] = res;
@@ -2724,25 +2752,25 @@ void GPUDeviceStub::getSchedulers(const zes_device_handle_t& device, std::vector
     }
     uint32_t scheduler_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, nullptr));
     if (res == ZE_RESULT_SUCCESS) {
         std::vector<zes_sched_handle_t> scheds(scheduler_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, scheds.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, scheds.data()));
         for (auto& sched : scheds) {
             zes_sched_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(sched, res = zesSchedulerGetProperties(sched, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(sched, res = zesSchedulerGetProperties(sched, &props));
             if (res == ZE_RESULT_SUCCESS) {
                 zes_sched_mode_t mode = {};
                 zes_sched_timeout_properties_t timeout = {};
                 zes_sched_timeslice_properties_t timeslice = {};
                 uint64_t val1, val2;
-                XPUM_ZE_HANDLE_LOCK(sched, res = zesSchedulerGetCurrentMode(sched, &mode));
+                XPUM_ZE_HANDLE_SHARED_LOCK(sched, res = zesSchedulerGetCurrentMode(sched, &mode));
                 if (mode == ZES_SCHED_MODE_TIMEOUT) {
-                    XPUM_ZE_HANDLE_LOCK(sched, res = zesSchedulerGetTimeoutModeProperties(sched, false, &timeout));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(sched, res = zesSchedulerGetTimeoutModeProperties(sched, false, &timeout));
                     val1 = timeout.watchdogTimeout;
                     val2 = 0;
                 } else if (mode == ZES_SCHED_MODE_TIMESLICE) {
-                    XPUM_ZE_HANDLE_LOCK(sched, res = zesSchedulerGetTimesliceModeProperties(sched, false, &timeslice));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(sched, res = zesSchedulerGetTimesliceModeProperties(sched, false, &timeslice));
                     val1 = timeslice.interval;
                     val2 = timeslice.yieldTimeout;
                 } else if (mode == ZES_SCHED_MODE_EXCLUSIVE || mode == ZES_SCHED_MODE_COMPUTE_UNIT_DEBUG) {
@@ -2780,14 +2808,14 @@ bool GPUDeviceStub::getPPRDiagHandle(const zes_device_handle_t& device, zes_diag
     }
     ze_result_t res;
     uint32_t count = 0;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumDiagnosticTestSuites(device, &count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumDiagnosticTestSuites(device, &count, nullptr));
     if (res == ZE_RESULT_SUCCESS) {
         std::vector<zes_diag_handle_t> diagHandles{count};
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumDiagnosticTestSuites(device, &count, diagHandles.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumDiagnosticTestSuites(device, &count, diagHandles.data()));
         if (res == ZE_RESULT_SUCCESS) {
             for(auto diag : diagHandles){
                 zes_diag_properties_t pro{};
-                XPUM_ZE_HANDLE_LOCK(device, res = zesDiagnosticsGetProperties(diag, &pro));
+                XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDiagnosticsGetProperties(diag, &pro));
                 if(res == ZE_RESULT_SUCCESS){
                     std::string ppr_name = "MEMORY_PPR";
                     if(ppr_name.compare(pro.name) == 0){
@@ -2816,10 +2844,10 @@ void GPUDeviceStub::getDeviceProcessState(const zes_device_handle_t& device, std
     }
     uint32_t process_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceProcessesGetState(device, &process_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceProcessesGetState(device, &process_count, nullptr));
     if (res == ZE_RESULT_SUCCESS) {
         std::vector<zes_process_state_t> procs(process_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceProcessesGetState(device, &process_count, procs.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceProcessesGetState(device, &process_count, procs.data()));
         for (auto& proc : procs) {
             std::string pn = getProcessName(proc.processId);
             device_process dp(proc.processId, proc.memSize, proc.sharedSize, 
@@ -2862,58 +2890,6 @@ static bool strToUInt64(uint64_t *val, char *buf) {
 }
 
 
-static bool getProcNameAndMem(device_util_by_proc &util,uint32_t card_idx,
-        char *client) {
-    char path[PATH_MAX];
-    char buf[BUF_SIZE];
-    //Read proc name
-    int len = snprintf(path, PATH_MAX,
-            "/sys/class/drm/card%d/clients/%s/name",
-            card_idx, client);
-    if (len <= 0 || len >= PATH_MAX) {
-        return false;
-    }
-    if (readStrSysFsFile(buf, path) != true) {
-        return false;
-    }
-    std::string procName(buf);
-    procName.pop_back();
-    util.setProcessName(procName);
-
-    //Read mem size
-    len = snprintf(path, PATH_MAX,
-            "/sys/class/drm/card%d/clients/%s/total_device_memory_buffer_objects/created_bytes",
-            card_idx, client);
-    if (len <= 0 || len >= PATH_MAX) {
-        return false;
-    }
-    if (readStrSysFsFile(buf, path) != true) {
-        return false;
-    }
-    uint64_t memSize = 0;
-    if (strToUInt64(&memSize, buf) == false) {
-        return false;
-    }
-    util.setMemSize(memSize);
-
-    //Read shared mem size
-    len = snprintf(path, PATH_MAX,
-            "/sys/class/drm/card%d/clients/%s/total_device_memory_buffer_objects/imported_bytes",
-            card_idx, client);
-    if (len <= 0 || len >= PATH_MAX) {
-        return false;
-    }
-    if (readStrSysFsFile(buf, path) != true) {
-        return false;
-    }
-    uint64_t sharedMemSize = 0;
-    if (strToUInt64(&sharedMemSize, buf) == false) {
-        return false;
-    }
-    util.setSharedMemSize(sharedMemSize);
-    return true;
-}
-
 static bool getProcID(uint32_t &pid, uint32_t card_idx, char *client) {
     char path[PATH_MAX];
     char buf[BUF_SIZE];
@@ -2940,7 +2916,7 @@ static bool getProcID(uint32_t &pid, uint32_t card_idx, char *client) {
 static bool getCardIdx(uint32_t &card_idx, const zes_device_handle_t& device) {
     ze_result_t res;
     zes_pci_properties_t pci_props = {};
-    XPUM_ZE_HANDLE_LOCK(device,
+    XPUM_ZE_HANDLE_SHARED_LOCK(device,
             res = zesDevicePciGetProperties(device, &pci_props));
     if (res != ZE_RESULT_SUCCESS) {
         return false;
@@ -2984,32 +2960,243 @@ static bool getCardIdx(uint32_t &card_idx, const zes_device_handle_t& device) {
     return ret;
 }
 
-static bool addOrMergeUtil(std::vector<device_util_by_proc> &vec, device_util_by_proc &util) {
+// at most this many sysfs files of drm clients are kept open, beyond that
+// the files of new clients are opened on every read
+#define MAX_CACHED_CLIENT_FDS 512
+
+/*
+  The known clients of a card: the id, pid and name of a client never change,
+  so only its memory sizes are read again, through the cached descriptors.
+*/
+// the engine classes of i915, the names of files in the busy directory of a client
+#define DRM_ENGINE_CLASS_RENDER 0
+#define DRM_ENGINE_CLASS_COPY 1
+#define DRM_ENGINE_CLASS_VIDEO 2
+#define DRM_ENGINE_CLASS_VIDEO_ENHANCE 3
+#define DRM_ENGINE_CLASS_COMPUTE 4
+#define DRM_ENGINE_CLASS_NUM 5
+
+struct DrmClientEntry {
+    uint32_t pid = 0;
+    std::string name;
+    int createdFd = -1;
+    int importedFd = -1;
+    int busyFds[DRM_ENGINE_CLASS_NUM] = {-1, -1, -1, -1, -1};
+    // false if the driver does not expose the busy time of clients
+    bool hasBusy = true;
+    bool seen = false;
+};
+
+/*
+  The busy time in ns of each engine class of a client, read as the client
+  is listed.
+*/
+struct DrmClientBusy {
+    uint32_t pid = 0;
+    uint64_t busy[DRM_ENGINE_CLASS_NUM] = {};
+    bool valid[DRM_ENGINE_CLASS_NUM] = {};
+};
+
+struct DrmClientCache {
+    std::mutex mutex;
+    // by the client directory name
+    std::map<std::string, DrmClientEntry> clients;
+};
+
+static std::mutex drm_client_caches_mutex;
+static std::map<uint32_t, std::shared_ptr<DrmClientCache>> drm_client_caches;
+static std::map<zes_device_handle_t, uint32_t> card_indexes;
+// the count of engines of each class, by card index
+static std::map<uint32_t, std::vector<uint32_t>> card_engine_counts;
+static std::atomic<int> cached_client_fds{0};
+
+static void closeClientFds(DrmClientEntry &entry) {
+    if (entry.createdFd >= 0) {
+        close(entry.createdFd);
+        cached_client_fds--;
+    }
+    if (entry.importedFd >= 0) {
+        close(entry.importedFd);
+        cached_client_fds--;
+    }
+    entry.createdFd = entry.importedFd = -1;
+    for (auto& fd : entry.busyFds) {
+        if (fd >= 0) {
+            close(fd);
+            cached_client_fds--;
+        }
+        fd = -1;
+    }
+}
+
+static bool getCachedCardIdx(uint32_t &card_idx, const zes_device_handle_t& device) {
+    {
+        std::lock_guard<std::mutex> lock(drm_client_caches_mutex);
+        auto it = card_indexes.find(device);
+        if (it != card_indexes.end()) {
+            card_idx = it->second;
+            return true;
+        }
+    }
+    if (getCardIdx(card_idx, device) == false) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(drm_client_caches_mutex);
+    card_indexes[device] = card_idx;
+    return true;
+}
+
+static std::shared_ptr<DrmClientCache> getDrmClientCache(uint32_t card_idx) {
+    std::lock_guard<std::mutex> lock(drm_client_caches_mutex);
+    auto& p_cache = drm_client_caches[card_idx];
+    if (p_cache == nullptr) {
+        p_cache = std::make_shared<DrmClientCache>();
+    }
+    return p_cache;
+}
+
+// read a sysfs file from its start, sysfs generates the content again
+static bool readUInt64FromFd(uint64_t &val, int fd) {
+    char buf[BUF_SIZE];
+    ssize_t szRead = pread(fd, buf, BUF_SIZE - 1, 0);
+    if (szRead <= 0) {
+        return false;
+    }
+    buf[szRead] = 0;
+    return strToUInt64(&val, buf);
+}
+
+static bool readUInt64FromFile(uint64_t &val, const char *path, int &cachedFd) {
+    if (cachedFd >= 0) {
+        return readUInt64FromFd(val, cachedFd);
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool ret = readUInt64FromFd(val, fd);
+    if (ret && cached_client_fds < MAX_CACHED_CLIENT_FDS) {
+        cached_client_fds++;
+        cachedFd = fd;
+    } else {
+        close(fd);
+    }
+    return ret;
+}
+
+static bool initClientEntry(DrmClientEntry &entry, uint32_t card_idx, char *client) {
+    if (getProcID(entry.pid, card_idx, client) == false) {
+        return false;
+    }
+    char path[PATH_MAX];
+    char buf[BUF_SIZE];
+    int len = snprintf(path, PATH_MAX,
+            "/sys/class/drm/card%d/clients/%s/name",
+            card_idx, client);
+    if (len <= 0 || len >= PATH_MAX) {
+        return false;
+    }
+    if (readStrSysFsFile(buf, path) != true) {
+        return false;
+    }
+    entry.name = buf;
+    if (!entry.name.empty()) {
+        entry.name.pop_back();
+    }
+    return true;
+}
+
+static bool readClientMem(DrmClientEntry &entry, device_util_by_proc &util,
+        uint32_t card_idx, const char *client) {
+    char path[PATH_MAX];
+    uint64_t memSize = 0;
+    int len = snprintf(path, PATH_MAX,
+            "/sys/class/drm/card%d/clients/%s/total_device_memory_buffer_objects/created_bytes",
+            card_idx, client);
+    if (len <= 0 || len >= PATH_MAX || readUInt64FromFile(memSize, path, entry.createdFd) == false) {
+        return false;
+    }
+    uint64_t sharedMemSize = 0;
+    len = snprintf(path, PATH_MAX,
+            "/sys/class/drm/card%d/clients/%s/total_device_memory_buffer_objects/imported_bytes",
+            card_idx, client);
+    if (len <= 0 || len >= PATH_MAX || readUInt64FromFile(sharedMemSize, path, entry.importedFd) == false) {
+        return false;
+    }
+    util.setProcessName(entry.name);
+    util.setMemSize(memSize);
+    util.setSharedMemSize(sharedMemSize);
+    return true;
+}
+
+static void readClientBusy(DrmClientEntry &entry, DrmClientBusy &busy,
+        uint32_t card_idx, const char *client) {
+    busy.pid = entry.pid;
+    if (!entry.hasBusy) {
+        return;
+    }
+    char path[PATH_MAX];
     bool found = false;
-    auto iter = vec.begin();
-    while (iter != vec.end()) {
-        if (iter->getProcessId() == util.getProcessId()) {
-            iter->merge(&util);
+    for (int engine_class = 0; engine_class < DRM_ENGINE_CLASS_NUM; engine_class++) {
+        int len = snprintf(path, PATH_MAX,
+                "/sys/class/drm/card%d/clients/%s/busy/%d",
+                card_idx, client, engine_class);
+        if (len <= 0 || len >= PATH_MAX) {
+            continue;
+        }
+        if (readUInt64FromFile(busy.busy[engine_class], path, entry.busyFds[engine_class])) {
+            busy.valid[engine_class] = true;
             found = true;
-            break;
-        } 
-        iter++;
+        }
     }
-    if (found == false) {
-        vec.push_back(util);
+    // not retried for this client
+    entry.hasBusy = found;
+}
+
+static std::vector<uint32_t> getEngineCounts(uint32_t card_idx) {
+    {
+        std::lock_guard<std::mutex> lock(drm_client_caches_mutex);
+        auto it = card_engine_counts.find(card_idx);
+        if (it != card_engine_counts.end()) {
+            return it->second;
+        }
     }
-    return true;
+    std::vector<uint32_t> counts(DRM_ENGINE_CLASS_NUM, 0);
+    char path[PATH_MAX];
+    char buf[BUF_SIZE];
+    int len = snprintf(path, PATH_MAX, "/sys/class/drm/card%d/engine", card_idx);
+    DIR* pdir = (len <= 0 || len >= PATH_MAX) ? NULL : opendir(path);
+    if (pdir != NULL) {
+        struct dirent* pdirent = NULL;
+        while ((pdirent = readdir(pdir))) {
+            if (pdirent->d_name[0] == '.') {
+                continue;
+            }
+            len = snprintf(path, PATH_MAX, "/sys/class/drm/card%d/engine/%s/class", card_idx, pdirent->d_name);
+            if (len <= 0 || len >= PATH_MAX || readStrSysFsFile(buf, path) != true) {
+                continue;
+            }
+            uint32_t engine_class = 0;
+            if (strToUInt32(&engine_class, buf) && engine_class < DRM_ENGINE_CLASS_NUM) {
+                counts[engine_class]++;
+            }
+        }
+        closedir(pdir);
+    }
+    std::lock_guard<std::mutex> lock(drm_client_caches_mutex);
+    card_engine_counts[card_idx] = counts;
+    return counts;
 }
 
 static bool readMemUtil(std::vector<device_util_by_proc>& vec, 
-	    const zes_device_handle_t& device, std::string device_id) {
+	    const zes_device_handle_t& device, std::string device_id,
+        std::map<std::string, DrmClientBusy>& busies, uint32_t& card_idx) {
     char path[PATH_MAX];
     int len = 0;
     DIR* pdir = NULL;
     struct dirent* pdirent = NULL;
-    uint32_t card_idx = 0;
 
-    if (getCardIdx(card_idx, device) == false) {
+    if (getCachedCardIdx(card_idx, device) == false) {
         return false;
     }
 
@@ -3022,26 +3209,56 @@ static bool readMemUtil(std::vector<device_util_by_proc>& vec,
     if (pdir == NULL) {
         return false;
     }
+    auto p_cache = getDrmClientCache(card_idx);
+    std::lock_guard<std::mutex> lock(p_cache->mutex);
+    for (auto& client : p_cache->clients) {
+        client.second.seen = false;
+    }
+    // the index in vec by pid, a process may have several clients
+    std::unordered_map<uint32_t, size_t> pidIndexes;
+    uint32_t deviceId = std::stoi(device_id);
     while ((pdirent = readdir(pdir))) {
         if (pdirent->d_name[0] == '.') {
             continue;
         }
-        uint32_t pid = 0;
-        if (getProcID(pid, card_idx, pdirent->d_name) == false) {
-            closedir(pdir);
-            return false;
+        auto it = p_cache->clients.find(pdirent->d_name);
+        if (it == p_cache->clients.end()) {
+            DrmClientEntry entry;
+            // the client may be gone already
+            if (initClientEntry(entry, card_idx, pdirent->d_name) == false) {
+                continue;
+            }
+            it = p_cache->clients.emplace(pdirent->d_name, entry).first;
+        }
+        DrmClientEntry& entry = it->second;
+        device_util_by_proc util(entry.pid);
+        if (readClientMem(entry, util, card_idx, pdirent->d_name) == false) {
+            closeClientFds(entry);
+            p_cache->clients.erase(it);
+            continue;
         }
-        device_util_by_proc util(pid);
-        util.setDeviceId(std::stoi(device_id));
+        entry.seen = true;
+        readClientBusy(entry, busies[pdirent->d_name], card_idx, pdirent->d_name);
+        util.setDeviceId(deviceId);
         memcpy(util.d_name, pdirent->d_name, 32);
         util.d_name[31] = '\0';
-        if (getProcNameAndMem(util, card_idx, pdirent->d_name) == false) {
-            closedir(pdir);
-            return false;
+        auto index = pidIndexes.find(entry.pid);
+        if (index != pidIndexes.end()) {
+            vec[index->second].merge(&util);
+        } else {
+            pidIndexes[entry.pid] = vec.size();
+            vec.push_back(util);
         }
-        addOrMergeUtil(vec, util);
     }
     closedir(pdir);
+    for (auto it = p_cache->clients.begin(); it != p_cache->clients.end();) {
+        if (!it->second.seen) {
+            closeClientFds(it->second);
+            it = p_cache->clients.erase(it);
+        } else {
+            ++it;
+        }
+    }
     return true;
 }
 
@@ -3049,7 +3266,9 @@ static bool readMemUtil(std::vector<device_util_by_proc>& vec,
 //For each device/ card, there is a card_idx, device_id, device_handle
 //and a vector of utilizations, the utilizations of all devices are returned
 //by a vector of utilzation vector
-//GPU utilization is currently unavailable, set to 0
+//The engine utilizations come from the busy time of drm clients, sampled for
+//all devices before and after one sleep of utilInterval microseconds. They
+//are 0 if the driver does not expose the busy time of clients
 bool GPUDeviceStub::getDeviceUtilByProc(
     const std::vector<zes_device_handle_t>& devices,
     const std::vector<std::string>& device_ids,
@@ -3057,13 +3276,105 @@ bool GPUDeviceStub::getDeviceUtilByProc(
     std::vector<std::vector<device_util_by_proc>>& utils) {
 
     auto size0 = devices.size();
-    for (uint64_t i = 0; i < size0; i++) {
-        std::vector<device_util_by_proc> vec;
-        if (readMemUtil(vec, devices[i], device_ids[i]) == false) {
-            utils.clear();
-            return false;
+    std::vector<std::vector<device_util_by_proc>> results(size0);
+    std::vector<std::map<std::string, DrmClientBusy>> begin_busies(size0);
+    std::vector<std::map<std::string, DrmClientBusy>> end_busies(size0);
+    std::vector<std::chrono::steady_clock::time_point> begin_times(size0);
+    std::vector<std::chrono::steady_clock::time_point> end_times(size0);
+    std::vector<uint32_t> card_idxes(size0, 0);
+    std::atomic<bool> ok{true};
+    Utility::parallel_in_batches(size0, size0, [&](int start, int end) {
+        for (int i = start; i < end; ++i) {
+            std::vector<device_util_by_proc> ignored;
+            if (readMemUtil(ignored, devices[i], device_ids[i], begin_busies[i], card_idxes[i]) == false) {
+                ok = false;
+            }
+            begin_times[i] = std::chrono::steady_clock::now();
+        }
+    });
+    if (!ok) {
+        utils.clear();
+        return false;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(utilInterval));
+    Utility::parallel_in_batches(size0, size0, [&](int start, int end) {
+        for (int i = start; i < end; ++i) {
+            if (readMemUtil(results[i], devices[i], device_ids[i], end_busies[i], card_idxes[i]) == false) {
+                ok = false;
+            }
+            end_times[i] = std::chrono::steady_clock::now();
+        }
+    });
+    if (!ok) {
+        utils.clear();
+        return false;
+    }
+
+    for (size_t i = 0; i < size0; i++) {
+        double elapsed = std::chrono::duration<double, std::nano>(end_times[i] - begin_times[i]).count();
+        if (elapsed <= 0) {
+            continue;
+        }
+        std::vector<uint32_t> engine_counts = getEngineCounts(card_idxes[i]);
+        // the busy time of the clients present in both samples, by pid
+        std::unordered_map<uint32_t, std::vector<double>> pid_busies;
+        for (auto& end_busy : end_busies[i]) {
+            auto begin_busy = begin_busies[i].find(end_busy.first);
+            if (begin_busy == begin_busies[i].end() || begin_busy->second.pid != end_busy.second.pid) {
+                continue;
+            }
+            auto& sums = pid_busies[end_busy.second.pid];
+            sums.resize(DRM_ENGINE_CLASS_NUM, 0);
+            for (int engine_class = 0; engine_class < DRM_ENGINE_CLASS_NUM; engine_class++) {
+                if (end_busy.second.valid[engine_class] && begin_busy->second.valid[engine_class] &&
+                    end_busy.second.busy[engine_class] > begin_busy->second.busy[engine_class]) {
+                    sums[engine_class] += end_busy.second.busy[engine_class] - begin_busy->second.busy[engine_class];
+                }
+            }
+        }
+        auto toUtil = [&](const std::vector<double>& sums, int engine_class) {
+            uint32_t count = engine_counts[engine_class] > 0 ? engine_counts[engine_class] : 1;
+            return std::min(100.0, sums[engine_class] * 100 / (elapsed * count));
+        };
+        for (auto& util : results[i]) {
+            auto it = pid_busies.find(util.getProcessId());
+            if (it == pid_busies.end()) {
+                continue;
+            }
+            util.setRenderingEngineUtil(toUtil(it->second, DRM_ENGINE_CLASS_RENDER));
+            util.setCopyEngineUtil(toUtil(it->second, DRM_ENGINE_CLASS_COPY));
+            util.setMediaEngineUtil(toUtil(it->second, DRM_ENGINE_CLASS_VIDEO));
+            util.setMediaEnhancementUtil(toUtil(it->second, DRM_ENGINE_CLASS_VIDEO_ENHANCE));
+            util.setComputeEngineUtil(toUtil(it->second, DRM_ENGINE_CLASS_COMPUTE));
+        }
+    }
+    for (auto& vec : results) {
+        utils.push_back(std::move(vec));
+    }
+    return true;
+}
+
+bool GPUDeviceStub::getDeviceClientBusyTime(const zes_device_handle_t& device, const std::string& device_id,
+                                            std::map<std::string, std::pair<uint32_t, uint64_t>>& busy_times) {
+    std::vector<device_util_by_proc> ignored;
+    std::map<std::string, DrmClientBusy> busies;
+    uint32_t card_idx = 0;
+    if (readMemUtil(ignored, device, device_id, busies, card_idx) == false) {
+        return false;
+    }
+    for (auto& busy : busies) {
+        uint64_t total = 0;
+        bool valid = false;
+        for (int engine_class = 0; engine_class < DRM_ENGINE_CLASS_NUM; engine_class++) {
+            if (busy.second.valid[engine_class]) {
+                total += busy.second.busy[engine_class];
+                valid = true;
+            }
+        }
+        // the clients of a driver without the busy time are left out
+        if (valid) {
+            busy_times[busy.first] = std::make_pair(busy.second.pid, total);
         }
-        utils.push_back(vec);
     }
     return true;
 }
@@ -3087,14 +3398,14 @@ bool GPUDeviceStub::setPerformanceFactor(const zes_device_handle_t& device, Perf
     }
     uint32_t pfCount = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPerformanceFactorDomains(device, &pfCount, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPerformanceFactorDomains(device, &pfCount, nullptr));
     if (res == ZE_RESULT_SUCCESS) {
         zes_perf_handle_t hPerf[pfCount];
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPerformanceFactorDomains(device, &pfCount, hPerf));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPerformanceFactorDomains(device, &pfCount, hPerf));
         if (res == ZE_RESULT_SUCCESS) {
             for (auto perf : hPerf) {
                 zes_perf_properties_t prop = {};
-                XPUM_ZE_HANDLE_LOCK(perf, res = zesPerformanceFactorGetProperties(perf, &prop));
+                XPUM_ZE_HANDLE_SHARED_LOCK(perf, res = zesPerformanceFactorGetProperties(perf, &prop));
                 if (res == ZE_RESULT_SUCCESS) {
                     if (prop.subdeviceId == pf.getSubdeviceId() && prop.engines == pf.getEngine()) {
                         XPUM_ZE_HANDLE_LOCK(perf, res = zesPerformanceFactorSetConfig(perf, pf.getFactor()));
@@ -3124,17 +3435,17 @@ void GPUDeviceStub::getPerformanceFactor(const zes_device_handle_t& device, std:
     }
     uint32_t pfCount = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPerformanceFactorDomains(device, &pfCount, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPerformanceFactorDomains(device, &pfCount, nullptr));
     if (res == ZE_RESULT_SUCCESS) {
         zes_perf_handle_t hPerf[pfCount];
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPerformanceFactorDomains(device, &pfCount, hPerf));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPerformanceFactorDomains(device, &pfCount, hPerf));
         if (res == ZE_RESULT_SUCCESS) {
             for (auto perf : hPerf) {
                 zes_perf_properties_t prop = {};
                 double factor;
-                XPUM_ZE_HANDLE_LOCK(perf, res = zesPerformanceFactorGetProperties(perf, &prop));
+                XPUM_ZE_HANDLE_SHARED_LOCK(perf, res = zesPerformanceFactorGetProperties(perf, &prop));
                 if (res == ZE_RESULT_SUCCESS) {
-                    XPUM_ZE_HANDLE_LOCK(perf, res = zesPerformanceFactorGetConfig(perf, &factor));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(perf, res = zesPerformanceFactorGetConfig(perf, &factor));
                     if (res == ZE_RESULT_SUCCESS) {
                         PerformanceFactor p(prop.onSubdevice, prop.subdeviceId, 
                             prop.engines, factor);
@@ -3160,16 +3471,16 @@ void GPUDeviceStub::getStandbys(const zes_device_handle_t& device, std::vector<S
     }
     uint32_t standby_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumStandbyDomains(device, &standby_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumStandbyDomains(device, &standby_count, nullptr));
     if (res == ZE_RESULT_SUCCESS) {
         std::vector<zes_standby_handle_t> stans(standby_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumStandbyDomains(device, &standby_count, stans.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumStandbyDomains(device, &standby_count, stans.data()));
         for (auto& stan : stans) {
             zes_standby_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(stan, res = zesStandbyGetProperties(stan, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(stan, res = zesStandbyGetProperties(stan, &props));
             if (res == ZE_RESULT_SUCCESS) {
                 zes_standby_promo_mode_t mode;
-                XPUM_ZE_HANDLE_LOCK(stan, res = zesStandbyGetMode(stan, &mode));
+                XPUM_ZE_HANDLE_SHARED_LOCK(stan, res = zesStandbyGetMode(stan, &mode));
                 Standby s(props.type, (bool)props.onSubdevice, 
                     props.subdeviceId, mode);
                 standbys.push_back(s);
@@ -3184,13 +3495,13 @@ void GPUDeviceStub::getPowerProps(const zes_device_handle_t& device, std::vector
     }
     uint32_t power_domain_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
     std::vector<zes_pwr_handle_t> power_handles(power_domain_count);
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
     if (res == ZE_RESULT_SUCCESS) {
         for (auto& power : power_handles) {
             zes_power_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetProperties(power, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(power, res = zesPowerGetProperties(power, &props));
             if (res == ZE_RESULT_SUCCESS) {
                 Power p(props.onSubdevice, props.subdeviceId, props.canControl,
                                              props.isEnergyThresholdSupported,
@@ -3212,9 +3523,9 @@ void GPUDeviceStub::getAllPowerLimits(const zes_device_handle_t& device,
     }
     uint32_t power_domain_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
     std::vector<zes_pwr_handle_t> power_handles(power_domain_count);
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
     if (res == ZE_RESULT_SUCCESS) {
         for (auto& power : power_handles) {
             zes_power_sustained_limit_t sustained = {};
@@ -3224,10 +3535,10 @@ void GPUDeviceStub::getAllPowerLimits(const zes_device_handle_t& device,
             Power_peak_limit_t* peakLimit;
             zes_power_peak_limit_t peak = {};
             zes_power_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetProperties(power, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(power, res = zesPowerGetProperties(power, &props));
             if (res == ZE_RESULT_SUCCESS) {
                 tileIds.push_back(props.subdeviceId);
-                XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetLimits(power, &sustained, &burst, &peak));
+                XPUM_ZE_HANDLE_SHARED_LOCK(power, res = zesPowerGetLimits(power, &sustained, &burst, &peak));
                 if (res == ZE_RESULT_SUCCESS) {
                     sustainedLimit = new Power_sustained_limit_t();
                     sustainedLimit->enabled = sustained.enabled;
@@ -3260,20 +3571,20 @@ void GPUDeviceStub::getPowerLimits(const zes_device_handle_t& device,
     }
     uint32_t power_domain_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
     std::vector<zes_pwr_handle_t> power_handles(power_domain_count);
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
     if (res == ZE_RESULT_SUCCESS) {
         for (auto& power : power_handles) {
             zes_power_sustained_limit_t sustained = {};
             zes_power_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetProperties(power, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(power, res = zesPowerGetProperties(power, &props));
             if (res == ZE_RESULT_SUCCESS) {
                 if (props.onSubdevice == true) {
                     continue;
                 }
             }
-            XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetLimits(power, &sustained, nullptr, nullptr));
+            XPUM_ZE_HANDLE_SHARED_LOCK(power, res = zesPowerGetLimits(power, &sustained, nullptr, nullptr));
             if (res == ZE_RESULT_SUCCESS) {
                 sustained_limit.enabled = sustained.enabled;
                 sustained_limit.power = sustained.power;
@@ -3290,13 +3601,13 @@ bool GPUDeviceStub::setPowerSustainedLimits(const zes_device_handle_t& device, i
     }
     uint32_t power_domain_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
     std::vector<zes_pwr_handle_t> power_handles(power_domain_count);
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
     if (res == ZE_RESULT_SUCCESS) {
         for (auto& power : power_handles) {
             zes_power_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetProperties(power, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(power, res = zesPowerGetProperties(power, &props));
             if (res == ZE_RESULT_SUCCESS) {
                 if (props.subdeviceId == (uint32_t)tileId || (tileId == -1 && props.onSubdevice == false)) {
                     zes_power_sustained_limit_t sustained = {};
@@ -3321,9 +3632,9 @@ bool GPUDeviceStub::setPowerBurstLimits(const zes_device_handle_t& device,
     }
     uint32_t power_domain_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
     std::vector<zes_pwr_handle_t> power_handles(power_domain_count);
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
     if (res == ZE_RESULT_SUCCESS) {
         for (auto& power : power_handles) {
             zes_power_burst_limit_t burst = {};
@@ -3345,9 +3656,9 @@ bool GPUDeviceStub::setPowerPeakLimits(const zes_device_handle_t& device,
     }
     uint32_t power_domain_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
     std::vector<zes_pwr_handle_t> power_handles(power_domain_count);
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
     if (res == ZE_RESULT_SUCCESS) {
         for (auto& power : power_handles) {
             zes_power_peak_limit_t peak = {};
@@ -3368,20 +3679,20 @@ void GPUDeviceStub::getFrequencyRanges(const zes_device_handle_t& device, std::v
     }
     uint32_t freq_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, nullptr));
     std::vector<zes_freq_handle_t> freq_handles(freq_count);
     if (res == ZE_RESULT_SUCCESS) {
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, freq_handles.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, freq_handles.data()));
         for (auto& ph_freq : freq_handles) {
             zes_freq_properties_t prop = {};
             prop.stype = ZES_STRUCTURE_TYPE_FREQ_PROPERTIES;
-            XPUM_ZE_HANDLE_LOCK(ph_freq, res = zesFrequencyGetProperties(ph_freq, &prop));
+            XPUM_ZE_HANDLE_SHARED_LOCK(ph_freq, res = zesFrequencyGetProperties(ph_freq, &prop));
             if (res == ZE_RESULT_SUCCESS) {
                 if (prop.type != ZES_FREQ_DOMAIN_GPU) {
                     continue;
                 }
                 zes_freq_range_t range = {};
-                XPUM_ZE_HANDLE_LOCK(ph_freq, res = zesFrequencyGetRange(ph_freq, &range));
+                XPUM_ZE_HANDLE_SHARED_LOCK(ph_freq, res = zesFrequencyGetRange(ph_freq, &range));
                 if (res == ZE_RESULT_SUCCESS) {
                     Frequency f(prop.type, prop.onSubdevice, prop.subdeviceId,
                                 prop.canControl, prop.isThrottleEventSupported,
@@ -3399,23 +3710,23 @@ void GPUDeviceStub::getFreqAvailableClocks(const zes_device_handle_t& device, ui
     }
     uint32_t freq_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, nullptr));
     std::vector<zes_freq_handle_t> freq_handles(freq_count);
     if (res == ZE_RESULT_SUCCESS) {
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, freq_handles.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, freq_handles.data()));
         for (auto& ph_freq : freq_handles) {
             zes_freq_properties_t prop = {};
             prop.stype = ZES_STRUCTURE_TYPE_FREQ_PROPERTIES;
-            XPUM_ZE_HANDLE_LOCK(ph_freq, res = zesFrequencyGetProperties(ph_freq, &prop));
+            XPUM_ZE_HANDLE_SHARED_LOCK(ph_freq, res = zesFrequencyGetProperties(ph_freq, &prop));
             if (res == ZE_RESULT_SUCCESS) {
                 if (prop.type != ZES_FREQ_DOMAIN_GPU || prop.subdeviceId != subdevice_id) {
                     continue;
                 }
                 uint32_t pCount = 0;
-                XPUM_ZE_HANDLE_LOCK(ph_freq, res = zesFrequencyGetAvailableClocks(ph_freq, &pCount, nullptr));
+                XPUM_ZE_HANDLE_SHARED_LOCK(ph_freq, res = zesFrequencyGetAvailableClocks(ph_freq, &pCount, nullptr));
                 double clockArray[pCount];
                 if (res == ZE_RESULT_SUCCESS) {
-                    XPUM_ZE_HANDLE_LOCK(ph_freq, res = zesFrequencyGetAvailableClocks(ph_freq, &pCount, clockArray));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(ph_freq, res = zesFrequencyGetAvailableClocks(ph_freq, &pCount, clockArray));
                     for (uint32_t i = 0; i < pCount; i++) {
                         clocks.push_back(clockArray[i]);
                     }
@@ -3431,14 +3742,14 @@ bool GPUDeviceStub::setFrequencyRangeForAll(const zes_device_handle_t& device, c
     }
     uint32_t freq_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, nullptr));
     std::vector<zes_freq_handle_t> freq_handles(freq_count);
     if (res == ZE_RESULT_SUCCESS) {
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, freq_handles.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, freq_handles.data()));
         for (auto& ph_freq : freq_handles) {
             zes_freq_properties_t prop = {};
             prop.stype = ZES_STRUCTURE_TYPE_FREQ_PROPERTIES;
-            XPUM_ZE_HANDLE_LOCK(ph_freq, res = zesFrequencyGetProperties(ph_freq, &prop));
+            XPUM_ZE_HANDLE_SHARED_LOCK(ph_freq, res = zesFrequencyGetProperties(ph_freq, &prop));
             if (res == ZE_RESULT_SUCCESS) {
                 if (prop.type != freq.getType()) {
                     continue;
@@ -3459,14 +3770,14 @@ bool GPUDeviceStub::setFrequencyRange(const zes_device_handle_t& device, const F
     }
     uint32_t freq_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, nullptr));
     std::vector<zes_freq_handle_t> freq_handles(freq_count);
     if (res == ZE_RESULT_SUCCESS) {
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, freq_handles.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, freq_handles.data()));
         for (auto& ph_freq : freq_handles) {
             zes_freq_properties_t prop = {};
             prop.stype = ZES_STRUCTURE_TYPE_FREQ_PROPERTIES;
-            XPUM_ZE_HANDLE_LOCK(ph_freq, res = zesFrequencyGetProperties(ph_freq, &prop));
+            XPUM_ZE_HANDLE_SHARED_LOCK(ph_freq, res = zesFrequencyGetProperties(ph_freq, &prop));
             if (res == ZE_RESULT_SUCCESS) {
                 if (prop.type != freq.getType() || prop.subdeviceId != freq.getSubdeviceId()) {
                     continue;
@@ -3490,13 +3801,13 @@ bool GPUDeviceStub::setStandby(const zes_device_handle_t& device, const Standby&
     }
     uint32_t standby_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumStandbyDomains(device, &standby_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumStandbyDomains(device, &standby_count, nullptr));
     if (res == ZE_RESULT_SUCCESS) {
         std::vector<zes_standby_handle_t> stans(standby_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumStandbyDomains(device, &standby_count, stans.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumStandbyDomains(device, &standby_count, stans.data()));
         for (auto& stan : stans) {
             zes_standby_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(stan, res = zesStandbyGetProperties(stan, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(stan, res = zesStandbyGetProperties(stan, &props));
             if (res == ZE_RESULT_SUCCESS) {
                 if (props.subdeviceId != standby.getSubdeviceId()) {
                     continue;
@@ -3519,13 +3830,13 @@ bool GPUDeviceStub::setSchedulerTimeoutMode(const zes_device_handle_t& device,
     }
     uint32_t scheduler_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, nullptr));
     if (res == ZE_RESULT_SUCCESS) {
         std::vector<zes_sched_handle_t> scheds(scheduler_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, scheds.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, scheds.data()));
         for (auto& sched : scheds) {
             zes_sched_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(sched, res = zesSchedulerGetProperties(sched, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(sched, res = zesSchedulerGetProperties(sched, &props));
             if (res == ZE_RESULT_SUCCESS) {
                 if (props.subdeviceId != mode.subdevice_Id) {
                     continue;
@@ -3553,13 +3864,13 @@ bool GPUDeviceStub::setSchedulerTimesliceMode(const zes_device_handle_t& device,
     }
     uint32_t scheduler_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, nullptr));
     if (res == ZE_RESULT_SUCCESS) {
         std::vector<zes_sched_handle_t> scheds(scheduler_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, scheds.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, scheds.data()));
         for (auto& sched : scheds) {
             zes_sched_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(sched, res = zesSchedulerGetProperties(sched, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(sched, res = zesSchedulerGetProperties(sched, &props));
             if (res == ZE_RESULT_SUCCESS) {
                 if (props.subdeviceId != mode.subdevice_Id) {
                     continue;
@@ -3587,13 +3898,13 @@ bool GPUDeviceStub::setSchedulerExclusiveMode(const zes_device_handle_t& device,
     }
     uint32_t scheduler_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, nullptr));
     if (res == ZE_RESULT_SUCCESS) {
         std::vector<zes_sched_handle_t> scheds(scheduler_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, scheds.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, scheds.data()));
         for (auto& sched : scheds) {
             zes_sched_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(sched, res = zesSchedulerGetProperties(sched, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(sched, res = zesSchedulerGetProperties(sched, &props));
             if (res == ZE_RESULT_SUCCESS) {
                 if (props.subdeviceId != mode.subdevice_Id) {
                     continue;
@@ -3618,13 +3929,13 @@ bool GPUDeviceStub::setSchedulerDebugMode(const zes_device_handle_t& device, con
     }
     uint32_t scheduler_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, nullptr));
     if (res == ZE_RESULT_SUCCESS) {
         std::vector<zes_sched_handle_t> scheds(scheduler_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, scheds.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumSchedulers(device, &scheduler_count, scheds.data()));
         for (auto& sched : scheds) {
             zes_sched_properties_t props = {};
-            XPUM_ZE_HANDLE_LOCK(sched, res = zesSchedulerGetProperties(sched, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(sched, res = zesSchedulerGetProperties(sched, &props));
             if (res == ZE_RESULT_SUCCESS) {
                 if (props.subdeviceId != mode.subdevice_Id) {
                     continue;
@@ -3649,17 +3960,17 @@ bool GPUDeviceStub::getFrequencyState(const zes_device_handle_t& device, std::st
 
     uint32_t freq_count = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, nullptr));
     std::vector<zes_freq_handle_t> freq_handles(freq_count);
     if (res == ZE_RESULT_SUCCESS) {
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, freq_handles.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freq_count, freq_handles.data()));
         for (auto& ph_freq : freq_handles) {
             zes_freq_properties_t props = {};
             props.pNext = nullptr;
-            XPUM_ZE_HANDLE_LOCK(ph_freq, res = zesFrequencyGetProperties(ph_freq, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(ph_freq, res = zesFrequencyGetProperties(ph_freq, &props));
             if (res == ZE_RESULT_SUCCESS) {
                 zes_freq_state_t freq_state = {};
-                XPUM_ZE_HANDLE_LOCK(ph_freq, res = zesFrequencyGetState(ph_freq, &freq_state));
+                XPUM_ZE_HANDLE_SHARED_LOCK(ph_freq, res = zesFrequencyGetState(ph_freq, &freq_state));
                 if (res == ZE_RESULT_SUCCESS) {
                     if (freq_state.throttleReasons == 0) {   
                         ret = true;
@@ -3732,7 +4043,10 @@ std::string GPUDeviceStub::parseMemoryFailedMRCInfo(uint32_t registerValue) {
 }
 
 void GPUDeviceStub::getHealthStatus(const zes_device_handle_t& device, xpum_health_type_t type, xpum_health_data_t* data,
-                                    int core_thermal_threshold, int memory_thermal_threshold, int power_threshold, bool global_default_limit) {
+                                    int core_thermal_threshold, int memory_thermal_threshold, int power_threshold, bool global_default_limit,
+                                    std::shared_ptr<MeasurementData> p_latest_power,
+                                    std::shared_ptr<MeasurementData> p_latest_temperature,
+                                    const std::vector<port_info>* p_fabric_ports) {
     if (device == nullptr) {
         return;
     }
@@ -3744,16 +4058,16 @@ void GPUDeviceStub::getHealthStatus(const zes_device_handle_t& device, xpum_heal
         description = get_health_state_string(zes_mem_health_t::ZES_MEM_HEALTH_UNKNOWN);
         uint32_t mem_module_count = 0;
         ze_result_t res;
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumMemoryModules(device, &mem_module_count, nullptr));
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumMemoryModules(device, &mem_module_count, nullptr));
         if (res == ZE_RESULT_SUCCESS) {
             std::vector<zes_mem_handle_t> mems(mem_module_count);
-            XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumMemoryModules(device, &mem_module_count, mems.data()));
+            XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumMemoryModules(device, &mem_module_count, mems.data()));
             if (res == ZE_RESULT_SUCCESS) {
                 bool meet_zes_mem_health_unkown = false;
                 for (auto& mem : mems) {
                     zes_mem_state_t memory_state = {};
                     memory_state.stype = ZES_STRUCTURE_TYPE_MEM_STATE;
-                    XPUM_ZE_HANDLE_LOCK(mem, res = zesMemoryGetState(mem, &memory_state));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(mem, res = zesMemoryGetState(mem, &memory_state));
                     if (res == ZE_RESULT_SUCCESS) {
                         if (memory_state.health == ZES_MEM_HEALTH_UNKNOWN)
                             meet_zes_mem_health_unkown = true;
@@ -3796,26 +4110,46 @@ void GPUDeviceStub::getHealthStatus(const zes_device_handle_t& device, xpum_heal
 
         description = "The power health cannot be determined.";
         uint32_t power_domain_count = 0;
-        ze_result_t res;
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
-        std::vector<zes_pwr_handle_t> power_handles(power_domain_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
+        ze_result_t res = ZE_RESULT_SUCCESS;
+        std::vector<zes_pwr_handle_t> power_handles;
+        auto current_device_value = 0;
+        auto current_sub_device_value_sum = 0;
+        bool has_latest_power = false;
+        // the monitor derives the power from the energy counters of two successive ticks, reuse it rather than sleeping here
+        if (isRecentSample(p_latest_power)) {
+            uint64_t scale = p_latest_power->getScale();
+            if (p_latest_power->hasDataOnDevice() && p_latest_power->getCurrent() != std::numeric_limits<uint64_t>::max()) {
+                current_device_value = p_latest_power->getCurrent() / scale;
+                has_latest_power = true;
+            }
+            if (p_latest_power->hasSubdeviceData()) {
+                for (auto& sub : *p_latest_power->getSubdeviceDatas()) {
+                    if (sub.second.current != std::numeric_limits<uint64_t>::max()) {
+                        current_sub_device_value_sum += sub.second.current / scale;
+                        has_latest_power = true;
+                    }
+                }
+            }
+        }
+        if (!has_latest_power) {
+            XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
+            power_handles.resize(power_domain_count);
+            XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
+        }
         if (res == ZE_RESULT_SUCCESS) {
-            auto current_device_value = 0;
-            auto current_sub_device_value_sum = 0;
             for (auto& power : power_handles) {
                 zes_power_properties_t props = {};
                 props.stype = ZES_STRUCTURE_TYPE_POWER_PROPERTIES;
-                XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetProperties(power, &props));
+                XPUM_ZE_HANDLE_SHARED_LOCK(power, res = zesPowerGetProperties(power, &props));
                 if (res != ZE_RESULT_SUCCESS) {
                     continue;
                 }
                 zes_power_energy_counter_t snap1 = {};
                 zes_power_energy_counter_t snap2 = {};
-                XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetEnergyCounter(power, &snap1));
+                XPUM_ZE_HANDLE_SHARED_LOCK(power, res = zesPowerGetEnergyCounter(power, &snap1));
                 if (res == ZE_RESULT_SUCCESS) {
                     std::this_thread::sleep_for(std::chrono::milliseconds(Configuration::POWER_MONITOR_INTERNAL_PERIOD));
-                    XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetEnergyCounter(power, &snap2));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(power, res = zesPowerGetEnergyCounter(power, &snap2));
                     if (res == ZE_RESULT_SUCCESS && 
                             snap2.timestamp != snap1.timestamp) {
                         int value = (snap2.energy - snap1.energy) / (snap2.timestamp - snap1.timestamp);
@@ -3851,10 +4185,33 @@ void GPUDeviceStub::getHealthStatus(const zes_device_handle_t& device, xpum_heal
             thermal_threshold = memory_thermal_threshold;
         double temp_val = 0;
         description = "The temperature health cannot be determined.";
+        // the hottest sensor of the latest monitor sample, rather than reading the sensors again
+        if (isRecentSample(p_latest_temperature)) {
+            double scale = p_latest_temperature->getScale();
+            if (p_latest_temperature->hasDataOnDevice() && p_latest_temperature->getCurrent() != std::numeric_limits<uint64_t>::max()) {
+                temp_val = p_latest_temperature->getCurrent() / scale;
+            }
+            if (p_latest_temperature->hasSubdeviceData()) {
+                for (auto& sub : *p_latest_temperature->getSubdeviceDatas()) {
+                    if (sub.second.current != std::numeric_limits<uint64_t>::max()) {
+                        temp_val = std::max(temp_val, sub.second.current / scale);
+                    }
+                }
+            }
+            // filter abnormal temperatures
+            if (temp_val >= 150) {
+                temp_val = 0;
+            }
+        }
+        bool has_latest_temperature = temp_val > 0;
         uint32_t temp_sensor_count = 0;
-        ze_result_t res;
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumTemperatureSensors(device, &temp_sensor_count, nullptr));
-        if (temp_sensor_count == 0 && type == xpum_health_type_t::XPUM_HEALTH_CORE_THERMAL && Utility::isATSMPlatform(device)) {
+        ze_result_t res = ZE_RESULT_SUCCESS;
+        if (!has_latest_temperature) {
+            XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumTemperatureSensors(device, &temp_sensor_count, nullptr));
+        }
+        if (has_latest_temperature) {
+            XPUM_LOG_DEBUG("health: latest temperature value: {}", temp_val);
+        } else if (temp_sensor_count == 0 && type == xpum_health_type_t::XPUM_HEALTH_CORE_THERMAL && Utility::isATSMPlatform(device)) {
             int val = (int)getRegisterValueFromSys(device, 0x145978);
             if (val > 0) {
                 temp_val = val;
@@ -3862,10 +4219,10 @@ void GPUDeviceStub::getHealthStatus(const zes_device_handle_t& device, xpum_heal
         } else if (temp_sensor_count > 0) {
             std::vector<zes_temp_handle_t> temp_sensors(temp_sensor_count);
             if (res == ZE_RESULT_SUCCESS) {
-                XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumTemperatureSensors(device, &temp_sensor_count, temp_sensors.data()));
+                XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumTemperatureSensors(device, &temp_sensor_count, temp_sensors.data()));
                 for (auto& temp : temp_sensors) {
                     zes_temp_properties_t props = {};
-                    XPUM_ZE_HANDLE_LOCK(temp, res = zesTemperatureGetProperties(temp, &props));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(temp, res = zesTemperatureGetProperties(temp, &props));
                     if (res != ZE_RESULT_SUCCESS) {
                         continue;
                     }
@@ -3876,7 +4233,7 @@ void GPUDeviceStub::getHealthStatus(const zes_device_handle_t& device, xpum_heal
                         continue;
                     }
                     double val = 0;
-                    XPUM_ZE_HANDLE_LOCK(temp, res = zesTemperatureGetState(temp, &val));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(temp, res = zesTemperatureGetState(temp, &val));
                     // filter abnormal temperatures
                     if (res == ZE_RESULT_SUCCESS && val < 150) {
                         temp_val = val;
@@ -3895,35 +4252,25 @@ void GPUDeviceStub::getHealthStatus(const zes_device_handle_t& device, xpum_heal
             description = "Find an unhealthy temperature sensor. Its temperature is " + temp_buffer.str() + " that reaches or exceeds the " + (global_default_limit ? "global defalut limit " : "threshold ") + std::to_string(thermal_threshold) + ".";
         }
     } else if (type == xpum_health_type_t::XPUM_HEALTH_FABRIC_PORT) {
-        description = "All port statuses cannot be determined.";
-        uint32_t fabric_ports_count = 0;
-        ze_result_t res;
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFabricPorts(device, &fabric_ports_count, nullptr));
-        if (res == ZE_RESULT_SUCCESS && fabric_ports_count > 0) {
-            std::vector<zes_fabric_port_handle_t> fabric_ports(fabric_ports_count);
+        // the ports of the latest read of the monitor if given
+        std::vector<port_info> fabric_ports;
+        if (p_fabric_ports != nullptr) {
+            fabric_ports = *p_fabric_ports;
+        } else {
+            getFabricPorts(device, fabric_ports);
+        }
+        if (!fabric_ports.empty()) {
             std::vector<std::string> failed_fabric_ports, degraded_fabric_ports, disabled_fabric_ports;
-            XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFabricPorts(device, &fabric_ports_count, fabric_ports.data()));
             for (auto& fabric_port : fabric_ports) {
-                zes_fabric_port_properties_t fabric_port_properties = {};
-                fabric_port_properties.stype = ZES_STRUCTURE_TYPE_FABRIC_PORT_PROPERTIES;
-                XPUM_ZE_HANDLE_LOCK(fabric_port, res = zesFabricPortGetProperties(fabric_port, &fabric_port_properties));
-                if (res != ZE_RESULT_SUCCESS) {
-                    continue;
-                }
-                zes_fabric_port_state_t fabric_port_state = {};
-                fabric_port_state.stype = ZES_STRUCTURE_TYPE_FABRIC_PORT_STATE;
-                XPUM_ZE_HANDLE_LOCK(fabric_port, res = zesFabricPortGetState(fabric_port, &fabric_port_state));
-                if (res != ZE_RESULT_SUCCESS) {
-                    continue;
-                }
-                if (fabric_port_state.status == ZES_FABRIC_PORT_STATUS_FAILED) {
-                    failed_fabric_ports.emplace_back("Tile" + std::to_string(fabric_port_properties.portId.attachId) + "-" + std::to_string((int)(fabric_port_properties.portId.portNumber)));
+                std::string name = "Tile" + std::to_string(fabric_port.portProps.portId.attachId) + "-" + std::to_string((int)(fabric_port.portProps.portId.portNumber));
+                if (fabric_port.portState.status == ZES_FABRIC_PORT_STATUS_FAILED) {
+                    failed_fabric_ports.emplace_back(name);
                 }
-                if (fabric_port_state.status == ZES_FABRIC_PORT_STATUS_DEGRADED) {
-                    degraded_fabric_ports.emplace_back("Tile" + std::to_string(fabric_port_properties.portId.attachId) + "-" + std::to_string((int)(fabric_port_properties.portId.portNumber)));
+                if (fabric_port.portState.status == ZES_FABRIC_PORT_STATUS_DEGRADED) {
+                    degraded_fabric_ports.emplace_back(name);
                 }
-                if (fabric_port_state.status == ZES_FABRIC_PORT_STATUS_DISABLED) {
-                    disabled_fabric_ports.emplace_back("Tile" + std::to_string(fabric_port_properties.portId.attachId) + "-" + std::to_string((int)(fabric_port_properties.portId.portNumber)));
+                if (fabric_port.portState.status == ZES_FABRIC_PORT_STATUS_DISABLED) {
+                    disabled_fabric_ports.emplace_back(name);
                 }
             }
 
@@ -3989,13 +4336,13 @@ bool GPUDeviceStub::getFabricPorts(const zes_device_handle_t& device, std::vecto
     }
     uint32_t numPorts = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFabricPorts(device, &numPorts, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFabricPorts(device, &numPorts, nullptr));
     if (res != ZE_RESULT_SUCCESS || numPorts == 0) {
         return false;
     }
 
     std::vector<zes_fabric_port_handle_t> fp_handles(numPorts);
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFabricPorts(device, &numPorts, fp_handles.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFabricPorts(device, &numPorts, fp_handles.data()));
     if (res == ZE_RESULT_SUCCESS) {
         for (auto& hPort : fp_handles) {
             port_info info;
@@ -4008,27 +4355,27 @@ bool GPUDeviceStub::getFabricPorts(const zes_device_handle_t& device, std::vecto
             memset(&link, 0, sizeof(link));
             memset(&config, 0, sizeof(config));
 
-            XPUM_ZE_HANDLE_LOCK(device, res = zesFabricPortGetProperties(hPort, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesFabricPortGetProperties(hPort, &props));
             if (res != ZE_RESULT_SUCCESS) {
                 XPUM_LOG_WARN("Failed to zesFabricPortGetProperties returned: {}", res);
             }
             info.portProps = props;
 
-            XPUM_ZE_HANDLE_LOCK(device, res = zesFabricPortGetState(hPort, &state));
+            XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesFabricPortGetState(hPort, &state));
             if (res != ZE_RESULT_SUCCESS) {
                 XPUM_LOG_WARN("Failed to zesFabricPortGetState returned: {} port:{}.{}.{}",
                               res, props.portId.fabricId, props.portId.attachId, props.portId.portNumber);
             }
             info.portState = state;
 
-            XPUM_ZE_HANDLE_LOCK(device, res = zesFabricPortGetLinkType(hPort, &link));
+            XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesFabricPortGetLinkType(hPort, &link));
             if (res != ZE_RESULT_SUCCESS) {
                 XPUM_LOG_WARN("Failed to zesFabricPortGetLinkType returned: {} port:{}.{}.{}",
                               res, props.portId.fabricId, props.portId.attachId, props.portId.portNumber);
             }
             info.portLink = link;
 
-            XPUM_ZE_HANDLE_LOCK(device, res = zesFabricPortGetConfig(hPort, &config));
+            XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesFabricPortGetConfig(hPort, &config));
             if (res != ZE_RESULT_SUCCESS) {
                 XPUM_LOG_WARN("Failed to zesFabricPortGetConfig returned: {} port:{}.{}.{}",
                               res, props.portId.fabricId, props.portId.attachId, props.portId.portNumber);
@@ -4046,13 +4393,13 @@ bool GPUDeviceStub::setFabricPorts(const zes_device_handle_t& device, const port
     }
     uint32_t numPorts = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFabricPorts(device, &numPorts, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFabricPorts(device, &numPorts, nullptr));
     if (res != ZE_RESULT_SUCCESS || numPorts == 0) {
         return false;
     }
 
     std::vector<zes_fabric_port_handle_t> fp_handles(numPorts);
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFabricPorts(device, &numPorts, fp_handles.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFabricPorts(device, &numPorts, fp_handles.data()));
     if (res == ZE_RESULT_SUCCESS) {
         for (auto& hPort : fp_handles) {
             zes_fabric_port_properties_t props = {};
@@ -4060,12 +4407,12 @@ bool GPUDeviceStub::setFabricPorts(const zes_device_handle_t& device, const port
             memset(&props, 0, sizeof(props));
             memset(&config, 0, sizeof(config));
 
-            XPUM_ZE_HANDLE_LOCK(hPort, res = zesFabricPortGetProperties(hPort, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(hPort, res = zesFabricPortGetProperties(hPort, &props));
             if (res != ZE_RESULT_SUCCESS) {
                 continue;
             }
             if (props.subdeviceId == portInfoSet.subdeviceId && props.portId.portNumber == portInfoSet.portId.portNumber) {
-                XPUM_ZE_HANDLE_LOCK(hPort, res = zesFabricPortGetConfig(hPort, &config));
+                XPUM_ZE_HANDLE_SHARED_LOCK(hPort, res = zesFabricPortGetConfig(hPort, &config));
                 if (res != ZE_RESULT_SUCCESS) {
                     return false;
                 }
@@ -4103,7 +4450,7 @@ bool GPUDeviceStub::getEccState(const zes_device_handle_t& device, MemoryEcc& ec
     ze_result_t res;
     ze_bool_t boolValue = false;
 
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEccAvailable(device,  &boolValue));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEccAvailable(device,  &boolValue));
     if (res != ZE_RESULT_SUCCESS) {
         return false;
     }
@@ -4113,7 +4460,7 @@ bool GPUDeviceStub::getEccState(const zes_device_handle_t& device, MemoryEcc& ec
     ecc.setAvailable(true);
 
     boolValue = false;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEccConfigurable(device,  &boolValue));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEccConfigurable(device,  &boolValue));
     if (res != ZE_RESULT_SUCCESS) {
         return false;
     }
@@ -4123,7 +4470,7 @@ bool GPUDeviceStub::getEccState(const zes_device_handle_t& device, MemoryEcc& ec
     ecc.setConfigurable(true);
 
     zes_device_ecc_properties_t props = {ZES_DEVICE_ECC_STATE_UNAVAILABLE, ZES_DEVICE_ECC_STATE_UNAVAILABLE, ZES_DEVICE_ACTION_NONE};
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceGetEccState(device, &props));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceGetEccState(device, &props));
     if (res != ZE_RESULT_SUCCESS) {
         return false;
     }
@@ -4150,7 +4497,7 @@ bool GPUDeviceStub::setEccState(const zes_device_handle_t& device, ecc_state_t&
 #if 0
     ze_result_t res;
     ze_bool_t boolValue = false;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEccAvailable(device,  &boolValue));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEccAvailable(device,  &boolValue));
     if (res != ZE_RESULT_SUCCESS) {
         return false;
     }
@@ -4160,7 +4507,7 @@ bool GPUDeviceStub::setEccState(const zes_device_handle_t& device, ecc_state_t&
     ecc.setAvailable(true);
 
     boolValue = false;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEccConfigurable(device,  &boolValue));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEccConfigurable(device,  &boolValue));
     if (res != ZE_RESULT_SUCCESS) {
         return false;
     }
@@ -4194,14 +4541,14 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetFrequencyThrottleReason(con
     }
     uint32_t freqDomainCount = 0;
     ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freqDomainCount, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freqDomainCount, nullptr));
     if (res != ZE_RESULT_SUCCESS) {
         std::stringstream err;
         err << "zesDeviceEnumFrequencyDomains error, result: 0x" << std::hex << res;
         throw BaseException(err.str());
     }
     std::vector<zes_freq_handle_t> freqDomainList(freqDomainCount);
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freqDomainCount, freqDomainList.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFrequencyDomains(device, &freqDomainCount, freqDomainList.data()));
     if (res != ZE_RESULT_SUCCESS) {
         std::stringstream err;
         err << "zesDeviceEnumFrequencyDomains error, result: 0x" << std::hex << res;
@@ -4212,7 +4559,7 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetFrequencyThrottleReason(con
     bool hasDataOnSubDevice = false;
     for (auto &hFreq: freqDomainList) {
         zes_freq_properties_t freqProps = {};
-        XPUM_ZE_HANDLE_LOCK(hFreq, res = zesFrequencyGetProperties(hFreq, &freqProps));
+        XPUM_ZE_HANDLE_SHARED_LOCK(hFreq, res = zesFrequencyGetProperties(hFreq, &freqProps));
         if (res != ZE_RESULT_SUCCESS) {
             std::stringstream err;
             err << "zesFrequencyGetProperties error, result: 0x" << std::hex << res;
@@ -4220,7 +4567,7 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetFrequencyThrottleReason(con
         }
         if (freqProps.type == ZES_FREQ_DOMAIN_GPU) {
             zes_freq_state_t freqState = {};
-            XPUM_ZE_HANDLE_LOCK(hFreq, zesFrequencyGetState(hFreq, &freqState));
+            XPUM_ZE_HANDLE_SHARED_LOCK(hFreq, zesFrequencyGetState(hFreq, &freqState));
             if (res != ZE_RESULT_SUCCESS) {
                 std::stringstream err;
                 err << "zesFrequencyGetState error, result: 0x" << std::hex << res;
@@ -4255,14 +4602,12 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetPCIeReadThroughput(const ze
 
     ze_result_t res;
     zes_pci_properties_t pci_props = {};
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
-    std::string bdf_address;
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
     if (res != ZE_RESULT_SUCCESS) {
         throw BaseException("toGetPCIeReadThroughput error");
     }
-    bdf_address = to_string(pci_props.address);
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
-    auto value = pcie_manager.getLatestPCIeReadThroughput(bdf_address.substr(5));
+    auto value = pcie_manager.getLatestPCIeReadThroughput(PCIeManager::toBdfKey(pci_props.address.bus, pci_props.address.device, pci_props.address.function));
     ret->setCurrent(value);
     return ret;
 }
@@ -4281,14 +4626,12 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetPCIeWriteThroughput(const z
 
     ze_result_t res;
     zes_pci_properties_t pci_props = {};
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
-    std::string bdf_address;
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
     if (res != ZE_RESULT_SUCCESS) {
         throw BaseException("toGetPCIeWriteThroughput error");
     }
-    bdf_address = to_string(pci_props.address);
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
-    auto value = pcie_manager.getLatestPCIeWriteThroughput(bdf_address.substr(5));
+    auto value = pcie_manager.getLatestPCIeWriteThroughput(PCIeManager::toBdfKey(pci_props.address.bus, pci_props.address.device, pci_props.address.function));
     ret->setCurrent(value);
     return ret;
 }
@@ -4307,14 +4650,12 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetPCIeRead(const zes_device_h
 
     ze_result_t res;
     zes_pci_properties_t pci_props = {};
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
-    std::string bdf_address;
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
     if (res != ZE_RESULT_SUCCESS) {
         throw BaseException("toGetPCIeRead error");
     }
-    bdf_address = to_string(pci_props.address);
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
-    auto value = pcie_manager.getLatestPCIeRead(bdf_address.substr(5));
+    auto value = pcie_manager.getLatestPCIeRead(PCIeManager::toBdfKey(pci_props.address.bus, pci_props.address.device, pci_props.address.function));
     ret->setCurrent(value);
     return ret;
 }
@@ -4333,14 +4674,12 @@ std::shared_ptr<MeasurementData> GPUDeviceStub::toGetPCIeWrite(const zes_device_
 
     ze_result_t res;
     zes_pci_properties_t pci_props = {};
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
-    std::string bdf_address;
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
     if (res != ZE_RESULT_SUCCESS) {
         throw BaseException("toGetPCIeWrite error");
     }
-    bdf_address = to_string(pci_props.address);
     std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
-    auto value = pcie_manager.getLatestPCIeWrite(bdf_address.substr(5));
+    auto value = pcie_manager.getLatestPCIeWrite(PCIeManager::toBdfKey(pci_props.address.bus, pci_props.address.device, pci_props.address.function));
     ret->setCurrent(value);
     return ret;
 }
@@ -4352,6 +4691,65 @@ void GPUDeviceStub::getFabricThroughput(const zes_device_handle_t& device, Callb
     invokeTask(callback, toGetFabricThroughput, device);
 }
 
+ze_result_t GPUDeviceStub::getDeviceFabricPorts(const zes_device_handle_t& device, std::shared_ptr<const std::vector<DeviceFabricPort_t>>& ports, bool* complete) {
+    if (complete != nullptr) {
+        *complete = true;
+    }
+    {
+        std::unique_lock<std::mutex> lock(fabric_port_mutex);
+        auto it = device_fabric_ports.find(device);
+        if (it != device_fabric_ports.end()) {
+            ports = it->second;
+            return ZE_RESULT_SUCCESS;
+        }
+    }
+    ze_result_t res;
+    uint32_t fabric_port_count = 0;
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFabricPorts(device, &fabric_port_count, nullptr));
+    if (res != ZE_RESULT_SUCCESS) {
+        return res;
+    }
+    std::vector<zes_fabric_port_handle_t> handles(fabric_port_count);
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDeviceEnumFabricPorts(device, &fabric_port_count, handles.data()));
+    if (res != ZE_RESULT_SUCCESS) {
+        return res;
+    }
+    auto p_ports = std::make_shared<std::vector<DeviceFabricPort_t>>();
+    p_ports->reserve(fabric_port_count);
+    bool all_read = true;
+    for (uint32_t i = 0; i < fabric_port_count; i++) {
+        zes_fabric_port_properties_t props = {};
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesFabricPortGetProperties(handles[i], &props));
+        if (res != ZE_RESULT_SUCCESS) {
+            XPUM_LOG_WARN_RATE_LIMITED(1000, "zesFabricPortGetProperties returned: {}", res);
+            all_read = false;
+            continue;
+        }
+        zes_fabric_port_state_t state = {};
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesFabricPortGetState(handles[i], &state));
+        if (res != ZE_RESULT_SUCCESS) {
+            XPUM_LOG_WARN_RATE_LIMITED(1000, "zesFabricPortGetState returned: {}", res);
+            all_read = false;
+            continue;
+        }
+        p_ports->push_back({handles[i], props.portId.fabricId, props.portId.attachId, state.remotePortId.fabricId, state.remotePortId.attachId, state.status});
+    }
+    ports = p_ports;
+    if (complete != nullptr) {
+        *complete = all_read;
+    }
+    if (all_read) {
+        std::unique_lock<std::mutex> lock(fabric_port_mutex);
+        device_fabric_ports[device] = p_ports;
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+void GPUDeviceStub::resetDeviceFabricPorts(const zes_device_handle_t& device) {
+    std::unique_lock<std::mutex> lock(fabric_port_mutex);
+    device_fabric_ports.erase(device);
+}
+
 std::shared_ptr<FabricMeasurementData> GPUDeviceStub::toGetFabricThroughput(const zes_device_handle_t& device) {
     if (device == nullptr) {
         throw BaseException("toGetFabricThroughput error");
@@ -4359,38 +4757,20 @@ std::shared_ptr<FabricMeasurementData> GPUDeviceStub::toGetFabricThroughput(cons
     std::lock_guard<std::mutex> lock(GPUDeviceStub::fabric_mutex);
     std::map<std::string, ze_result_t> exception_msgs;
     bool data_acquired = false;
-    uint32_t fabric_port_count = 0;
-    std::shared_ptr<FabricMeasurementData> ret = std::make_shared<FabricMeasurementData>();
-    ze_result_t res;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFabricPorts(device, &fabric_port_count, nullptr));
+    std::shared_ptr<FabricMeasurementData> ret = std::make_shared<FabricMeasurementData>(MultiMetricsSchema::instance(device, SCHEMA_FABRIC_PORT));
+    // only the throughputs are read, the ports and their links are kept from the first call
+    std::shared_ptr<const std::vector<DeviceFabricPort_t>> ports;
+    ze_result_t res = getDeviceFabricPorts(device, ports);
     if (res == ZE_RESULT_SUCCESS) {
-        std::vector<zes_fabric_port_handle_t> fabric_ports(fabric_port_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumFabricPorts(device, &fabric_port_count, fabric_ports.data()));
-        if (res == ZE_RESULT_SUCCESS) {
-            for (auto& fp : fabric_ports) {
-                zes_fabric_port_properties_t props = {};
-                XPUM_ZE_HANDLE_LOCK(device, res = zesFabricPortGetProperties(fp, &props));
-                if (res == ZE_RESULT_SUCCESS) {
-                    zes_fabric_port_state_t state = {};
-                    XPUM_ZE_HANDLE_LOCK(device, res = zesFabricPortGetState(fp, &state));
-                    if (res == ZE_RESULT_SUCCESS) {
-                        zes_fabric_port_throughput_t throughput = {};
-                        XPUM_ZE_HANDLE_LOCK(device, res = zesFabricPortGetThroughput(fp, &throughput));
-                        if (res == ZE_RESULT_SUCCESS) {
-                            ret->addRawData(uint64_t(fp), throughput.timestamp, throughput.rxCounter, throughput.txCounter, props.portId.attachId, state.remotePortId.fabricId, state.remotePortId.attachId);
-                            data_acquired = true;
-                        } else {
-                            exception_msgs["zesFabricPortGetThroughput"] = res;
-                        }
-                    } else {
-                        exception_msgs["zesFabricPortGetState"] = res;
-                    }
-                } else {
-                    exception_msgs["zesFabricPortGetProperties"] = res;
-                }
+        for (auto& port : *ports) {
+            zes_fabric_port_throughput_t throughput = {};
+            XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesFabricPortGetThroughput(port.handle, &throughput));
+            if (res == ZE_RESULT_SUCCESS) {
+                ret->addRawData(uint64_t(port.handle), throughput.timestamp, throughput.rxCounter, throughput.txCounter, port.attach_id, port.remote_fabric_id, port.remote_attach_id);
+                data_acquired = true;
+            } else {
+                exception_msgs["zesFabricPortGetThroughput"] = res;
             }
-        } else {
-            exception_msgs["zesDeviceEnumFabricPorts"] = res;
         }
     } else {
         exception_msgs["zesDeviceEnumFabricPorts"] = res;
@@ -4400,20 +4780,106 @@ std::shared_ptr<FabricMeasurementData> GPUDeviceStub::toGetFabricThroughput(cons
         ret->setErrors(buildErrors(exception_msgs, __func__, __LINE__));
         return ret;
     } else {
-        if (fabric_port_count == 0 && exception_msgs.empty())
+        if ((ports == nullptr || ports->empty()) && exception_msgs.empty())
             throw BaseException("fabric port not found");
         else
             throw BaseException(buildErrors(exception_msgs, __func__, __LINE__));
     }
 }
 
+// the BDFs of the VFs of a PF from its virtfn links, read again only when the VF count changes
+static std::vector<std::string> getVfBdfsOfPf(const std::string& pf_bdf, uint32_t vf_count) {
+    static std::mutex mtx;
+    static std::map<std::string, std::vector<std::string>> cache;
+    std::lock_guard<std::mutex> lock(mtx);
+    auto& bdfs = cache[pf_bdf];
+    if (bdfs.size() == vf_count) {
+        return bdfs;
+    }
+    bdfs.clear();
+    for (uint32_t i = 0; i < vf_count; i++) {
+        std::string link = "/sys/bus/pci/devices/" + pf_bdf + "/virtfn" + std::to_string(i);
+        char buf[PATH_MAX] = {};
+        ssize_t len = readlink(link.c_str(), buf, sizeof(buf) - 1);
+        std::string target = len > 0 ? std::string(buf, len) : "";
+        auto pos = target.find_last_of('/');
+        bdfs.push_back(pos == std::string::npos ? target : target.substr(pos + 1));
+    }
+    return bdfs;
+}
+
+void GPUDeviceStub::getVfEngineUtilization(const zes_device_handle_t& device, Callback_t callback) noexcept {
+    if (device == nullptr) {
+        return;
+    }
+    invokeTask(callback, toGetVfEngineUtilization, device);
+}
+
+std::shared_ptr<VfMeasurementData> GPUDeviceStub::toGetVfEngineUtilization(const zes_device_handle_t& device) {
+    if (device == nullptr) {
+        throw BaseException("toGetVfEngineUtilization error");
+    }
+    auto pfnZesEngineGetActivityExt = getZesEngineGetActivityExt();
+    if (pfnZesEngineGetActivityExt == nullptr) {
+        throw BaseException("zesEngineGetActivityExt not found");
+    }
+    std::map<std::string, ze_result_t> exception_msgs;
+    bool data_acquired = false;
+    uint32_t vf_count = 0;
+    std::shared_ptr<VfMeasurementData> ret = std::make_shared<VfMeasurementData>();
+    ze_result_t res;
+    std::shared_ptr<const std::vector<DeviceEngine_t>> engines;
+    res = getDeviceEngines(device, engines);
+    if (res == ZE_RESULT_SUCCESS) {
+        std::vector<zes_engine_stats_t> stats;
+        for (auto& engine : *engines) {
+            if (engine.type != ZES_ENGINE_GROUP_ALL && engine.type != ZES_ENGINE_GROUP_COMPUTE_ALL && engine.type != ZES_ENGINE_GROUP_MEDIA_ALL && engine.type != ZES_ENGINE_GROUP_COPY_ALL && engine.type != ZES_ENGINE_GROUP_RENDER_ALL) {
+                continue;
+            }
+            // stats[0] is the PF, stats[i] is the VF i
+            uint32_t stats_count = 0;
+            XPUM_ZE_HANDLE_SHARED_LOCK(engine.handle, res = pfnZesEngineGetActivityExt(engine.handle, &stats_count, nullptr));
+            if (res == ZE_RESULT_SUCCESS && stats_count > 1) {
+                stats.resize(stats_count);
+                XPUM_ZE_HANDLE_SHARED_LOCK(engine.handle, res = pfnZesEngineGetActivityExt(engine.handle, &stats_count, stats.data()));
+            }
+            if (res != ZE_RESULT_SUCCESS || stats_count <= 1) {
+                exception_msgs["zesEngineGetActivityExt"] = res;
+                continue;
+            }
+            for (uint32_t i = 1; i < stats_count; i++) {
+                ret->addRawData(i, engine.type, stats[i].activeTime, stats[i].timestamp);
+            }
+            vf_count = std::max(vf_count, stats_count - 1);
+            data_acquired = true;
+        }
+    } else {
+        exception_msgs["zesDeviceEnumEngineGroups"] = res;
+    }
+
+    if (data_acquired) {
+        zes_pci_properties_t pci_props = {};
+        XPUM_ZE_HANDLE_SHARED_LOCK(device, res = zesDevicePciGetProperties(device, &pci_props));
+        if (res == ZE_RESULT_SUCCESS) {
+            ret->setVfBdfs(getVfBdfsOfPf(to_string(pci_props.address), vf_count));
+        }
+        ret->setErrors(buildErrors(exception_msgs, __func__, __LINE__));
+        return ret;
+    } else {
+        if (exception_msgs.empty())
+            throw BaseException("VF engine group not found");
+        else
+            throw BaseException(buildErrors(exception_msgs, __func__, __LINE__));
+    }
+}
+
 void GPUDeviceStub::getPerfMetrics(ze_device_handle_t& device, ze_driver_handle_t& driver, 
                                    Callback_t callback) noexcept {
     invokeTask(callback, toGetPerfMetrics, device, driver);
 }
 
-std::shared_ptr<PerfMeasurementData> GPUDeviceStub::toGetPerfMetrics(ze_device_handle_t& device, 
-                                                                     ze_driver_handle_t& driver) {  
+std::shared_ptr<MeasurementData> GPUDeviceStub::toGetPerfMetrics(ze_device_handle_t& device, 
+                                                                 ze_driver_handle_t& driver) {  
     uint32_t sub_device_count = MAX_SUB_DEVICE;
     ze_device_handle_t sub_device_handles[MAX_SUB_DEVICE];
     
@@ -4431,85 +4897,125 @@ std::shared_ptr<PerfMeasurementData> GPUDeviceStub::toGetPerfMetrics(ze_device_h
     }
 
     std::unique_lock<std::mutex> lock(GPUDeviceStub::metric_streamer_mutex);    
+    // a device is in one window at a time, the window of another device is no reason to wait
+    GPUDeviceStub::perf_window_cv.wait(lock, [&]() {
+        for (auto target_device : target_devices) {
+            if (GPUDeviceStub::perf_window_devices.count(target_device) > 0) {
+                return false;
+            }
+        }
+        return true;
+    });
+
+    // Only one set of metric groups can be activated on a device, so release
+    // the EU active/stall/idle streamer sessions; they are reopened on next use.
+    for (auto target_device : target_devices) {
+        MetricStreamerSessionManager::instance().closeSession(target_device);
+    }
 
+    // Each tick activates the next round of metric groups of every device, the
+    // groups of the other rounds report the data of their last active window.
     std::map<ze_device_handle_t, std::shared_ptr<std::map<uint32_t, std::shared_ptr<DeviceMetricGroups_t>>>> to_active_groups;
-    std::map<ze_device_handle_t, std::shared_ptr<std::vector<std::shared_ptr<DeviceMetricGroups_t>>>> remaining_groups;
-    std::map<ze_device_handle_t, std::shared_ptr<PerfMetricDeviceData_t>> device_datas;
     std::map<ze_device_handle_t, ze_context_handle_t> device_contexts;
-    
-    for (auto device : target_devices) {
-        auto p_groups = getDevicePerfMetricGroups(device, driver);
-        if (p_groups->size() > 0) {
-            auto p_metric_groups = std::make_shared<std::vector<std::shared_ptr<DeviceMetricGroups_t>>>();
-            for (auto it = p_groups->begin(); it != p_groups->end(); it++) {
-                p_metric_groups->push_back(*it);
-            }
-            remaining_groups[device] = p_metric_groups;
+    for (auto target_device : target_devices) {
+        auto p_groups = getDevicePerfMetricGroups(target_device, driver);
+        if (p_groups->size() == 0) {
+            continue;
+        }
+        auto& multiplexer = GPUDeviceStub::perf_metric_multiplexers[target_device];
+        if (multiplexer.rounds.empty()) {
+            buildPerfMetricRounds(*p_groups, multiplexer);
         }
+        auto p_device_groups = std::make_shared<std::map<uint32_t, std::shared_ptr<DeviceMetricGroups_t>>>();
+        for (auto& p_group : multiplexer.rounds[multiplexer.next_round]) {
+            (*p_device_groups)[p_group->domain] = p_group;
+        }
+        to_active_groups[target_device] = p_device_groups;
     }
 
-    while (true) {
-        if (remaining_groups.size() == 0) {
-            break;
+    auto start = std::chrono::steady_clock::now();
+    for (auto it = to_active_groups.begin(); it != to_active_groups.end(); it++) {
+        ze_device_handle_t target_device = it->first;
+        openDevicePerfMetricStream(target_device, driver, it->second, device_contexts);
+    }
+    GPUDeviceStub::perf_window_devices.insert(target_devices.begin(), target_devices.end());
+    lock.unlock();
+
+    // the streams collect for one window, the metric streamer mutex is not held meanwhile
+    auto finish = [target_devices, to_active_groups, device_contexts, start, driver]() mutable -> std::shared_ptr<MeasurementData> {
+        std::unique_lock<std::mutex> lock(GPUDeviceStub::metric_streamer_mutex);
+        try {
+            auto p_data = readPerfMetricsWindow(target_devices, to_active_groups, device_contexts, start, driver);
+            closePerfWindow(target_devices);
+            return p_data;
+        } catch (...) {
+            closePerfWindow(target_devices);
+            throw;
         }
+    };
+    auto resume_at = start + std::chrono::milliseconds(Configuration::EU_ACTIVE_STALL_IDLE_MONITOR_INTERNAL_PERIOD);
+    if (SuspendScope::active()) {
+        return SuspendScope::suspend(resume_at, finish);
+    }
+    std::this_thread::sleep_until(resume_at);
+    return finish();
+}
 
-        for (auto it = remaining_groups.begin(); it != remaining_groups.end();) {
-            std::shared_ptr<std::map<uint32_t, std::shared_ptr<DeviceMetricGroups_t>>> p_device_groups;
-            if (to_active_groups.find(it->first) == to_active_groups.end()) {
-                p_device_groups = std::make_shared<std::map<uint32_t, std::shared_ptr<DeviceMetricGroups_t>>>();
-                to_active_groups[it->first] = p_device_groups;
-            } else {
-                p_device_groups = to_active_groups.at(it->first);
-            }
+void GPUDeviceStub::closePerfWindow(const std::vector<ze_device_handle_t>& target_devices) {
+    for (auto target_device : target_devices) {
+        GPUDeviceStub::perf_window_devices.erase(target_device);
+    }
+    GPUDeviceStub::perf_window_cv.notify_all();
+}
 
-            for (auto it_group = it->second->begin(); it_group != it->second->end(); ) {
-                if (p_device_groups->find((*it_group)->domain) == p_device_groups->end()) {
-                    p_device_groups->insert(std::pair<uint32_t, std::shared_ptr<DeviceMetricGroups_t>>((*it_group)->domain, *it_group));
-                    it_group = it->second->erase(it_group);
-                } else {
-                    it_group++;
-                }
-            }
+std::shared_ptr<PerfMeasurementData> GPUDeviceStub::readPerfMetricsWindow(std::vector<ze_device_handle_t>& target_devices,
+                                                                          std::map<ze_device_handle_t, std::shared_ptr<std::map<uint32_t, std::shared_ptr<DeviceMetricGroups_t>>>>& to_active_groups,
+                                                                          std::map<ze_device_handle_t, ze_context_handle_t>& device_contexts,
+                                                                          std::chrono::steady_clock::time_point start,
+                                                                          ze_driver_handle_t& driver) {
+    for (auto it = to_active_groups.begin(); it != to_active_groups.end(); it++) {
+        readPerfMetricsData(it->second);
 
-            if (it->second->size() == 0) {
-                it = remaining_groups.erase(it);
-            } else {
-                it++;
-            }
+        for (auto it_group = it->second->begin(); it_group != it->second->end(); it_group++) {
+            zetMetricStreamerClose(it_group->second->streamer);
         }
 
-        for (auto it = to_active_groups.begin(); it != to_active_groups.end(); it++) {
-            openDevicePerfMetricStream(device, driver, it->second, device_contexts);
+        zetContextActivateMetricGroups(device_contexts[it->first], it->first, 0, nullptr);
+    }
+    uint64_t window = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::shared_ptr<PerfMeasurementData> p_measurement_data = std::make_shared<PerfMeasurementData>();
+    for (auto target_device : target_devices) {
+        auto it_multiplexer = GPUDeviceStub::perf_metric_multiplexers.find(target_device);
+        if (it_multiplexer == GPUDeviceStub::perf_metric_multiplexers.end() || it_multiplexer->second.rounds.empty()) {
+            continue;
         }
+        auto& multiplexer = it_multiplexer->second;
+        auto& active_round = multiplexer.rounds[multiplexer.next_round];
+        for (auto& p_group : active_round) {
+            p_group->time_running += window;
+        }
+        multiplexer.next_round = (multiplexer.next_round + 1) % multiplexer.rounds.size();
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(
-            Configuration::EU_ACTIVE_STALL_IDLE_MONITOR_INTERNAL_PERIOD));        
-                
-        for (auto it = to_active_groups.begin(); it != to_active_groups.end(); it++) {
-            std::shared_ptr<PerfMetricDeviceData_t> p_existing_device_data;
-            if (device_datas.find(it->first) != device_datas.end()) {
-                p_existing_device_data = device_datas[it->first];
-            } else {
-                p_existing_device_data = std::make_shared<PerfMetricDeviceData_t>();
-                device_datas[it->first] = p_existing_device_data;
+        auto p_device_data = std::make_shared<PerfMetricDeviceData_t>();
+        for (auto& p_group : *getDevicePerfMetricGroups(target_device, driver)) {
+            p_group->time_enabled += window;
+            if (!p_group->has_data) {
+                continue;
             }
-
-            readPerfMetricsData(it->second, p_existing_device_data);
-
-            for (auto it_group = it->second->begin(); it_group != it->second->end(); it_group++) {
-                zetMetricStreamerClose(it_group->second->streamer);
+            // Like perf, the counts are scaled by enabled / running time to estimate the
+            // counts of a group that is active all the time, the averages are kept as is.
+            PerfMetricGroupData_t group_data = p_group->last_data;
+            group_data.active_ratio = p_group->time_enabled == 0 ? 1 : (double)p_group->time_running / p_group->time_enabled;
+            for (auto& m : group_data.data) {
+                if (m.type != "time" && group_data.active_ratio > 0) {
+                    m.total /= group_data.active_ratio;
+                }
             }
-
-            zetContextActivateMetricGroups(device_contexts[it->first], it->first, 0, nullptr);
+            p_device_data->data.emplace_back(std::move(group_data));
         }
-
-        to_active_groups.clear();
-    }
-    
-    std::shared_ptr<PerfMeasurementData> p_measurement_data = std::make_shared<PerfMeasurementData>();
-    for (auto device : target_devices) {
-        if (device_datas.find(device) != device_datas.end()) {
-            p_measurement_data->addData(device_datas.at(device));
+        if (p_device_data->data.size() > 0) {
+            p_measurement_data->addData(p_device_data);
         }
     }
 
@@ -4552,6 +5058,7 @@ std::shared_ptr<std::vector<std::shared_ptr<DeviceMetricGroups_t>>> GPUDeviceStu
                         p_metric_group->domain = metric_group_prop.domain;
                         p_metric_group->metric_count = metric_group_prop.metricCount;
                         p_metric_group->metric_group = metric_groups[i];
+                        p_metric_group->gpu_time_index = -1;
                         target_metric_groups[metric_group_prop.name] = p_metric_group;
                     }
 
@@ -4597,6 +5104,7 @@ std::shared_ptr<std::vector<std::shared_ptr<DeviceMetricGroups_t>>> GPUDeviceStu
                 it->second->target_metrics.find(GPU_TIME_NAME) != it->second->target_metrics.end()) {
                 continue;
             }
+            buildPerfMetricDecodePlan(it->second);
             p_device_groups->push_back(it->second);
         }
 
@@ -4610,6 +5118,24 @@ std::shared_ptr<std::vector<std::shared_ptr<DeviceMetricGroups_t>>> GPUDeviceStu
 }
 
 
+void GPUDeviceStub::buildPerfMetricDecodePlan(std::shared_ptr<DeviceMetricGroups_t>& p_metric_group) {
+    p_metric_group->decode_plan.clear();
+    p_metric_group->gpu_time_index = -1;
+    for (auto it = p_metric_group->target_metrics.begin(); it != p_metric_group->target_metrics.end(); it++) {
+        if (it->second->index >= p_metric_group->metric_count) {
+            continue;
+        }
+        if (it->second->name == GPU_TIME_NAME) {
+            p_metric_group->gpu_time_index = it->second->index;
+        }
+        p_metric_group->decode_plan.push_back(it->second);
+    }
+    std::sort(p_metric_group->decode_plan.begin(), p_metric_group->decode_plan.end(),
+              [](const std::shared_ptr<PerfMetricData_t>& a, const std::shared_ptr<PerfMetricData_t>& b) {
+                  return a->index < b->index;
+              });
+}
+
 void GPUDeviceStub::openDevicePerfMetricStream(ze_device_handle_t& device,
                                               ze_driver_handle_t& driver, 
                                               std::shared_ptr<std::map<uint32_t, std::shared_ptr<DeviceMetricGroups_t>>>& p_target_groups,
@@ -4658,83 +5184,74 @@ void GPUDeviceStub::openDevicePerfMetricStream(ze_device_handle_t& device,
     }
 }
 
-void GPUDeviceStub::readPerfMetricsData(std::shared_ptr<std::map<uint32_t, std::shared_ptr<DeviceMetricGroups_t>>>& p_groups,
-                                        std::shared_ptr<PerfMetricDeviceData_t> &p_metric_device_data) {
-    for (auto it = p_groups->begin(); it != p_groups->end(); it++) {
-        size_t raw_size = 0;
-        ze_result_t res = zetMetricStreamerReadData(it->second->streamer, UINT32_MAX, &raw_size, nullptr);
-        if (res != ZE_RESULT_SUCCESS) {
-            throw BaseException("getPerfMetricsData");
+void GPUDeviceStub::buildPerfMetricRounds(const std::vector<std::shared_ptr<DeviceMetricGroups_t>>& groups, PerfMetricMultiplexer_t& multiplexer) {
+    multiplexer.rounds.clear();
+    multiplexer.next_round = 0;
+    for (auto& p_group : groups) {
+        // the first round without a group of the same domain
+        size_t round = 0;
+        while (round < multiplexer.rounds.size() &&
+               std::any_of(multiplexer.rounds[round].begin(), multiplexer.rounds[round].end(),
+                           [&](const std::shared_ptr<DeviceMetricGroups_t>& other) { return other->domain == p_group->domain; })) {
+            round++;
+        }
+        if (round == multiplexer.rounds.size()) {
+            multiplexer.rounds.emplace_back();
         }
+        multiplexer.rounds[round].push_back(p_group);
+    }
+    if (multiplexer.rounds.size() > 1) {
+        XPUM_LOG_INFO("{} perf metric groups are multiplexed in {} rounds", groups.size(), multiplexer.rounds.size());
+    }
+}
 
-        std::vector<uint8_t> raw_data(raw_size);
-        res = zetMetricStreamerReadData(it->second->streamer, UINT32_MAX, &raw_size, raw_data.data());
+void GPUDeviceStub::readPerfMetricsData(std::shared_ptr<std::map<uint32_t, std::shared_ptr<DeviceMetricGroups_t>>>& p_groups) {
+    uint32_t expected_reports = expectedMetricReports(Configuration::EU_ACTIVE_STALL_IDLE_MONITOR_INTERNAL_PERIOD,
+                                                      Configuration::EU_ACTIVE_STALL_IDLE_STREAMER_SAMPLING_PERIOD);
+    for (auto it = p_groups->begin(); it != p_groups->end(); it++) {
+        auto& buffer = it->second->read_buffer;
+        buffer.reserve(expected_reports);
+        ze_result_t res = buffer.read(it->second->streamer);
         if (res != ZE_RESULT_SUCCESS) {
             throw BaseException("getPerfMetricsData");
         }
 
-        uint32_t value_count = 0;
-        zet_metric_group_calculation_type_t calc_type = ZET_METRIC_GROUP_CALCULATION_TYPE_METRIC_VALUES;
-        res = zetMetricGroupCalculateMetricValues(it->second->metric_group, calc_type, raw_size, 
-                                                  raw_data.data(), &value_count, nullptr);
+        res = buffer.calculate(it->second->metric_group, it->second->metric_count);
         if (res != ZE_RESULT_SUCCESS) {
             throw BaseException("getPerfMetricsData");
         }
+        uint32_t value_count = buffer.value_count;
+        const zet_typed_value_t* values = buffer.values.data();
 
-        std::vector<zet_typed_value_t> values(value_count);
-        res = zetMetricGroupCalculateMetricValues(it->second->metric_group, calc_type, raw_size, 
-                                                  raw_data.data(), &value_count, values.data());
-        if (res != ZE_RESULT_SUCCESS) {
-            throw BaseException("getPerfMetricsData");
-        }        
-        
-        uint32_t report_count = value_count / it->second->metric_count;
+        uint32_t metric_count = it->second->metric_count;
+        uint32_t report_count = metric_count == 0 ? 0 : value_count / metric_count;
         uint64_t total_elapsed_time = 0;
         PerfMetricGroupData_t metric_group_data;
+        auto& decode_plan = it->second->decode_plan;
+        if (report_count > 0) {
+            metric_group_data.data.reserve(decode_plan.size());
+            for (auto& p_metric : decode_plan) {
+                PerfMetricData_t perf_metric_data {};
+                perf_metric_data.name = p_metric->name;
+                perf_metric_data.type = p_metric->type;
+                perf_metric_data.index = p_metric->index;
+                metric_group_data.data.emplace_back(perf_metric_data);
+            }
+        }
 
         for (uint32_t report = 0; report < report_count; ++report) {
+            const zet_typed_value_t* report_values = values + report * metric_count;
             uint64_t current_elapsed_time = 0;
-            for (uint32_t metric = 0; metric < it->second->metric_count; metric++) {
-                zet_typed_value_t data = values[report * it->second->metric_count + metric];
-                for (auto it_metric = it->second->target_metrics.begin(); 
-                     it_metric != it->second->target_metrics.end(); it_metric++) {
-                     if (it_metric->second->index == metric) {
-                        bool found = false;
-                        for (auto& m : metric_group_data.data) {
-                            if (m.name == it_metric->second->name) {
-                                if (m.name == GPU_TIME_NAME) {
-                                    current_elapsed_time = data.value.ui64;
-                                    m.current = data.value.ui64;
-                                } else {
-                                    m.current = data.value.fp32;
-                                }
-                                found = true;
-                                break;
-                            }
-                        }
-
-                        if (!found) {
-                            PerfMetricData_t perf_metric_data {};
-                            perf_metric_data.name = it_metric->second->name; 
-                            perf_metric_data.average = 0;
-                            perf_metric_data.total = 0;
-                            perf_metric_data.type = it_metric->second->type;
-
-                            if (it_metric->second->name == GPU_TIME_NAME) {
-                                perf_metric_data.current = data.value.ui64;
-                                current_elapsed_time = data.value.ui64;
-                            } else {
-                                perf_metric_data.current = data.value.fp32;
-                            }
-
-                            metric_group_data.data.emplace_back(perf_metric_data);
-                        }
-                        break;
-                     }
-                }            
+            if (it->second->gpu_time_index >= 0) {
+                current_elapsed_time = report_values[it->second->gpu_time_index].value.ui64;
             }
-
-            for (auto& m : metric_group_data.data) {
+            for (uint32_t k = 0; k < decode_plan.size(); ++k) {
+                auto& m = metric_group_data.data[k];
+                if ((int32_t)m.index == it->second->gpu_time_index) {
+                    m.current = current_elapsed_time;
+                } else {
+                    m.current = report_values[m.index].value.fp32;
+                }
                 m.total += m.type == "time" ? current_elapsed_time * m.current : m.current;
             }
 
@@ -4748,7 +5265,8 @@ void GPUDeviceStub::readPerfMetricsData(std::shared_ptr<std::map<uint32_t, std::
         }
 
         metric_group_data.name = it->second->group_name;
-        p_metric_device_data->data.emplace_back(metric_group_data);
+        it->second->last_data = std::move(metric_group_data);
+        it->second->has_data = true;
     }
 }
 
@@ -9,10 +9,14 @@
 #include <dirent.h>
 #include <dlfcn.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <set>
 #include <string>
 
 #include "device/device.h"
 #include "device/frequency.h"
+#include "device/gpu/metric_streamer_session.h"
 #include "device/memoryEcc.h"
 #include "device/pcie_manager.h"
 #include "device/performancefactor.h"
@@ -28,6 +32,7 @@
 #include "infrastructure/fabric_measurement_data.h"
 #include "infrastructure/measurement_data.h"
 #include "infrastructure/perf_measurement_data.h"
+#include "infrastructure/vf_measurement_data.h"
 #include "level_zero/ze_api.h"
 #include "level_zero/zes_api.h"
 #include "level_zero/zet_api.h"
@@ -35,6 +40,57 @@
 
 namespace xpum {
 
+// an engine group handle of a device and its properties, read once per device
+struct DeviceEngine_t {
+  zes_engine_handle_t handle;
+  zes_engine_group_t type;
+  bool on_subdevice;
+  uint32_t subdevice_id;
+};
+
+/*
+  The activity of all the engines of a device read in one pass. The GPU,
+  engine and engine group utilizations of a monitor tick are all computed
+  from the same snapshot instead of each reading the engines again.
+*/
+struct EngineActivitySnapshot_t {
+  std::shared_ptr<const std::vector<DeviceEngine_t>> engines;
+  // stats[i] and results[i] are of engines[i]
+  std::vector<zes_engine_stats_t> stats;
+  std::vector<ze_result_t> results;
+  long long read_time;
+  // the getters which took the snapshot, by ENGINE_ACTIVITY_* bit
+  uint32_t consumers;
+};
+
+const uint32_t ENGINE_ACTIVITY_GPU_UTILIZATION = 1u << 0;
+const uint32_t ENGINE_ACTIVITY_ENGINE_UTILIZATION = 1u << 1;
+
+// the bit of the utilization of an engine group type, the types are below 30
+inline uint32_t engineActivityGroupConsumer(zes_engine_group_t type) {
+  return 1u << (2 + type);
+}
+
+// a fabric port handle of a device and the link it is on, read once per device
+struct DeviceFabricPort_t {
+  zes_fabric_port_handle_t handle;
+  uint32_t fabric_id;
+  uint32_t attach_id;
+  uint32_t remote_fabric_id;
+  uint32_t remote_attach_id;
+  zes_fabric_port_status_t status;
+};
+
+// the error counters of a RAS error set of a device or subdevice
+struct RasErrorState_t {
+    zes_ras_error_type_t type;
+    bool on_subdevice;
+    uint32_t subdevice_id;
+    zes_ras_state_t state;
+};
+
+typedef ze_result_t (*pfnZesEngineGetActivityExt_t)(zes_engine_handle_t hEngine, uint32_t* pCount, zes_engine_stats_t* pStats);
+
 struct DeviceMetricGroups_t {
   std::string group_name;
   uint32_t domain;
@@ -42,6 +98,41 @@ struct DeviceMetricGroups_t {
   zet_metric_group_handle_t metric_group;
   zet_metric_streamer_handle_t streamer;
   std::map<std::string, std::shared_ptr<PerfMetricData_t>> target_metrics;
+  // target metrics ordered by metric index, built once when the group is discovered
+  std::vector<std::shared_ptr<PerfMetricData_t>> decode_plan;
+  int32_t gpu_time_index;
+  // scratch space of the streamer reads, kept with the group between samples
+  MetricReadBuffer read_buffer;
+  // the data of the last window the group was active in
+  PerfMetricGroupData_t last_data;
+  bool has_data = false;
+  // nanoseconds the group was enabled and active since it is multiplexed
+  uint64_t time_enabled = 0;
+  uint64_t time_running = 0;
+};
+
+/*
+  Only one metric group of a domain can be active on a device at a time, so
+  the perf metric groups of a device are split into rounds with at most one
+  group per domain, and one round is active per monitor tick.
+*/
+struct PerfMetricMultiplexer_t {
+  std::vector<std::vector<std::shared_ptr<DeviceMetricGroups_t>>> rounds;
+  size_t next_round = 0;
+};
+
+/*
+  Indices of the metrics read from the EU active/stall/idle metric group,
+  -1 if the group does not provide the metric.
+*/
+struct EuMetricDecodePlan_t {
+  uint32_t metric_count;
+  int32_t gpu_busy;
+  int32_t eu_active;
+  int32_t eu_stall;
+  int32_t xve_active;
+  int32_t xve_stall;
+  int32_t gpu_time;
 };
 
 /*
@@ -54,11 +145,17 @@ class GPUDeviceStub {
 
     static PCIeManager pcie_manager;
 
+    // once per process, a later call does nothing
+    static void initPCIeManager();
+
     static int zeInitReturnCode;
     
    public:
     void discoverDevices(Callback_t callback);
 
+    // add the capabilities of a device discovered with STAGED_CAPABILITY_PROBING, each one is probed by calling its getter
+    static void probeCapabilities(const std::shared_ptr<Device>& p_device);
+
     void getPower(const zes_device_handle_t& device, Callback_t callback) noexcept;
 
     void getActuralRequestFrequency(const zes_device_handle_t& device, Callback_t callback) noexcept;
@@ -79,13 +176,13 @@ class GPUDeviceStub {
 
     void getEuActiveStallIdle(const ze_device_handle_t& device, const ze_driver_handle_t& driver, MeasurementType type, Callback_t callback) noexcept;
 
-    void getRasError(const zes_device_handle_t& device, Callback_t callback, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType) noexcept;
-
-    void getRasErrorOnSubdevice(const zes_device_handle_t& device, Callback_t callback, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType) noexcept;
     void getRasErrorOnSubdevice(const zes_device_handle_t& device, Callback_t callback) noexcept;
 
     void getRasError(const zes_device_handle_t& device, uint64_t errorCategory[XPUM_RAS_ERROR_MAX]) noexcept;
 
+    // if every RAS error set of the device has a threshold, so a RAS event is sent when errors occur
+    static bool hasRasEventThresholds(const zes_device_handle_t& device);
+
     void getFrequencyThrottle(const zes_device_handle_t& device, Callback_t callback) noexcept;
 
     void getFrequencyThrottleReason(const zes_device_handle_t& device, Callback_t callback) noexcept;
@@ -113,6 +210,8 @@ class GPUDeviceStub {
 
     void getPerfMetrics(zes_device_handle_t& device, ze_driver_handle_t& driver, Callback_t callback) noexcept;
 
+    void getVfEngineUtilization(const zes_device_handle_t& device, Callback_t callback) noexcept;
+
     static void getPowerLimits(const zes_device_handle_t& device,
                                Power_sustained_limit_t& sustained_limit,
                                Power_burst_limit_t& burst_limit,
@@ -158,7 +257,10 @@ class GPUDeviceStub {
     static bool getFrequencyState(const zes_device_handle_t& device, std::string& freq_throttle_message);
 
     static void getHealthStatus(const zes_device_handle_t& device, xpum_health_type_t type, xpum_health_data_t* data,
-                                int core_thermal_threshold, int memory_thermal_threshold, int power_threshold, bool global_default_limit);
+                                int core_thermal_threshold, int memory_thermal_threshold, int power_threshold, bool global_default_limit,
+                                std::shared_ptr<MeasurementData> p_latest_power = nullptr,
+                                std::shared_ptr<MeasurementData> p_latest_temperature = nullptr,
+                                const std::vector<port_info>* p_fabric_ports = nullptr);
 
     static bool resetDevice(const zes_device_handle_t& device, ze_bool_t force);
     
@@ -171,18 +273,23 @@ class GPUDeviceStub {
         const std::vector<std::string>& device_ids, uint32_t utilInterval,
         std::vector<std::vector<device_util_by_proc>>& utils);
 
+    // the busy time in ns of all the engines of each drm client of a device, with the pid of the client, by the client
+    static bool getDeviceClientBusyTime(const zes_device_handle_t& device, const std::string& device_id,
+                                        std::map<std::string, std::pair<uint32_t, uint64_t>>& busy_times);
+
     static void getFreqAvailableClocks(const zes_device_handle_t& device, uint32_t subdevice_id, std::vector<double>& clocks);
 
     static std::shared_ptr<MeasurementData> toGetPower(const zes_device_handle_t& device);
 
-    static std::shared_ptr<MeasurementData> toGetRasError(const zes_device_handle_t& device, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType);
-
     static bool getFabricPorts(const zes_device_handle_t& device, std::vector<port_info>& portInfo);
 
     static bool setFabricPorts(const zes_device_handle_t& device, const port_info_set& portInfoSet);
 
     static std::shared_ptr<FabricMeasurementData> toGetFabricThroughput(const zes_device_handle_t& device);
 
+    // the engine group activities of all VFs of the PF in one pass, and the BDFs of the VFs
+    static std::shared_ptr<VfMeasurementData> toGetVfEngineUtilization(const zes_device_handle_t& device);
+
     static std::shared_ptr<MeasurementData> loadPVCIdlePowers(std::string bdf = "", bool fresh = true, int index = 0);
 
     static std::string getPciSlotByPath(std::vector<std::string> pciPath); 
@@ -200,6 +307,32 @@ class GPUDeviceStub {
     static bool isPhysicalFunctionDevice(std::string pci_addr);
 
     static bool hasVirtualFunctionOnDevice(const zes_device_handle_t &zes_device);
+
+    // zesEngineGetActivityExt resolved once, nullptr if the loader does not have it
+    static pfnZesEngineGetActivityExt_t getZesEngineGetActivityExt();
+
+    // The engines of device, enumerated and their properties read on the first call.
+    // The engines whose properties can not be read are skipped.
+    static ze_result_t getDeviceEngines(const zes_device_handle_t& device, std::shared_ptr<const std::vector<DeviceEngine_t>>& engines);
+
+    // zesEngineGetActivity of each engine into stats, results[i] is the result of engines[i]
+    static void readEngineActivities(const std::vector<DeviceEngine_t>& engines, std::vector<zes_engine_stats_t>& stats, std::vector<ze_result_t>& results);
+
+    // The engine activity snapshot of device for the getter consumer. A snapshot is shared until it is
+    // older than half the monitor period or consumer already took it, a getter never reads the same
+    // activities twice, then all the engines are read again.
+    static ze_result_t getEngineActivitySnapshot(const zes_device_handle_t& device, uint32_t consumer, std::shared_ptr<const EngineActivitySnapshot_t>& snapshot);
+
+    // the PCI address of device if its engines are read from the PMU, by XPUM_ENGINE_ACTIVITY_PMU, empty otherwise
+    static std::string getEngineActivityPmuBdf(const zes_device_handle_t& device);
+
+    // The fabric ports of device with their properties and state, read on the first call and
+    // kept until resetDeviceFabricPorts(). The ports whose properties or state can not be
+    // read are skipped, complete is set to false and the ports are read again by the next call.
+    static ze_result_t getDeviceFabricPorts(const zes_device_handle_t& device, std::shared_ptr<const std::vector<DeviceFabricPort_t>>& ports, bool* complete = nullptr);
+
+    // drop the fabric ports kept for device, after the state of a port changed
+    static void resetDeviceFabricPorts(const zes_device_handle_t& device);
 private: 
     GPUDeviceStub(); 
     ~GPUDeviceStub();
@@ -230,11 +363,21 @@ private:
 
     static void toGetEuActiveStallIdleCore(const ze_device_handle_t& device, uint32_t subdeviceId, const ze_driver_handle_t& driver, MeasurementType type, std::shared_ptr<MeasurementData>& data);
 
-    static std::shared_ptr<PerfMeasurementData> toGetPerfMetrics(ze_device_handle_t& device, ze_driver_handle_t& driver);
+    // suspends for the sampling window in a SuspendScope
+    static std::shared_ptr<MeasurementData> toGetPerfMetrics(ze_device_handle_t& device, ze_driver_handle_t& driver);
 
-    //static std::shared_ptr<MeasurementData> toGetRasError(const zes_device_handle_t& device, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType);
+    // the second half of toGetPerfMetrics, after the window, with the metric streamer mutex held
+    static std::shared_ptr<PerfMeasurementData> readPerfMetricsWindow(std::vector<ze_device_handle_t>& target_devices,
+                                                                      std::map<ze_device_handle_t, std::shared_ptr<std::map<uint32_t, std::shared_ptr<DeviceMetricGroups_t>>>>& to_active_groups,
+                                                                      std::map<ze_device_handle_t, ze_context_handle_t>& device_contexts,
+                                                                      std::chrono::steady_clock::time_point start,
+                                                                      ze_driver_handle_t& driver);
+
+    static void closePerfWindow(const std::vector<ze_device_handle_t>& target_devices);
+
+    // the state of each RAS error set of the device, with one zesRasGetState per set
+    static ze_result_t readRasErrorStates(const zes_device_handle_t& device, std::vector<RasErrorState_t>& states);
 
-    static std::shared_ptr<MeasurementData> toGetRasErrorOnSubdeviceOld(const zes_device_handle_t& device, const zes_ras_error_cat_t& rasCat, const zes_ras_error_type_t& rasType);
     static std::shared_ptr<MeasurementData> toGetRasErrorOnSubdevice(const zes_device_handle_t& device);
 
     static std::shared_ptr<MeasurementData> toGetFrequencyThrottle(const zes_device_handle_t& device);
@@ -278,11 +421,17 @@ private:
     
     static std::string getDRMDevice(const zes_pci_properties_t& pci_props);
 
+    static EuMetricDecodePlan_t buildEuMetricDecodePlan(zet_metric_group_handle_t metric_group);
+
+    static void buildPerfMetricDecodePlan(std::shared_ptr<DeviceMetricGroups_t>& p_metric_group);
+
     static std::shared_ptr<std::vector<std::shared_ptr<DeviceMetricGroups_t>>> getDevicePerfMetricGroups(ze_device_handle_t& device, 
                                                                                                          ze_driver_handle_t& driver);
 
-    static void readPerfMetricsData(std::shared_ptr<std::map<uint32_t, std::shared_ptr<DeviceMetricGroups_t>>>& p_groups,
-                                    std::shared_ptr<PerfMetricDeviceData_t> &p_metric_device_data);
+    static void buildPerfMetricRounds(const std::vector<std::shared_ptr<DeviceMetricGroups_t>>& groups, PerfMetricMultiplexer_t& multiplexer);
+
+    // read the streamers of p_groups into the last_data of each group
+    static void readPerfMetricsData(std::shared_ptr<std::map<uint32_t, std::shared_ptr<DeviceMetricGroups_t>>>& p_groups);
     
     static void openDevicePerfMetricStream(ze_device_handle_t& device, ze_driver_handle_t& driver, 
                                            std::shared_ptr<std::map<uint32_t, std::shared_ptr<DeviceMetricGroups_t>>>& p_target_groups,
@@ -300,18 +449,40 @@ private:
 
     static std::mutex metric_streamer_mutex;
 
+    // the devices whose metric streams are open for a performance metric window, guarded by metric_streamer_mutex
+    static std::set<ze_device_handle_t> perf_window_devices;
+
+    static std::condition_variable perf_window_cv;
+
     static std::map<ze_device_handle_t, zet_metric_group_handle_t> target_metric_groups;
 
     static std::map<ze_device_handle_t, ze_context_handle_t> target_metric_contexts;
 
+    static std::map<zet_metric_group_handle_t, EuMetricDecodePlan_t> eu_metric_decode_plans;
+
     static std::map<ze_device_handle_t, std::shared_ptr<std::vector<std::shared_ptr<DeviceMetricGroups_t>>>> device_perf_groups;
 
+    static std::map<ze_device_handle_t, PerfMetricMultiplexer_t> perf_metric_multiplexers;
+
+    static std::mutex engine_mutex;
+
+    static std::map<zes_device_handle_t, std::shared_ptr<const std::vector<DeviceEngine_t>>> device_engines;
+
+    static std::map<zes_device_handle_t, std::shared_ptr<EngineActivitySnapshot_t>> engine_activity_snapshots;
+
+    // the PCI address of the devices whose engines are read from the PMU, empty for the others
+    static std::map<zes_device_handle_t, std::string> engine_activity_pmu_bdfs;
+
     static std::mutex pvc_idle_power_mutex;
     static std::map<std::string, std::shared_ptr<MeasurementData>> pvc_idle_powers; // key: bdf value: idle_power
     static std::set<std::string> pvc_gpu_bdfs;
     static bool has_pvc_idle_powers;
 
     static std::mutex fabric_mutex;
+
+    static std::mutex fabric_port_mutex;
+
+    static std::map<zes_device_handle_t, std::shared_ptr<const std::vector<DeviceFabricPort_t>>> device_fabric_ports;
 };
 
 } // end namespace xpum
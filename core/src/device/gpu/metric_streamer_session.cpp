@@ -0,0 +1,202 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file metric_streamer_session.cpp
+ */
+
+#include "device/gpu/metric_streamer_session.h"
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/exception/base_exception.h"
+#include "infrastructure/handle_lock.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+void MetricReadBuffer::reserve(uint32_t expected_reports) {
+    size_t size = report_size * expected_reports;
+    if (raw_data.size() < size) {
+        raw_data.resize(size);
+    }
+}
+
+ze_result_t MetricReadBuffer::read(zet_metric_streamer_handle_t streamer) {
+    raw_size = 0;
+    ze_result_t res;
+    if (raw_data.empty()) {
+        // the report size is not known before the first read
+        size_t size = 0;
+        res = zetMetricStreamerReadData(streamer, UINT32_MAX, &size, nullptr);
+        if (res != ZE_RESULT_SUCCESS || size == 0) {
+            return res;
+        }
+        raw_data.resize(size);
+    }
+    while (true) {
+        size_t size = raw_data.size() - raw_size;
+        res = zetMetricStreamerReadData(streamer, UINT32_MAX, &size, raw_data.data() + raw_size);
+        if (res != ZE_RESULT_SUCCESS) {
+            return res;
+        }
+        raw_size += size;
+        if (size == 0 || raw_size < raw_data.size()) {
+            return res;
+        }
+        // the buffer is full, more reports may be waiting
+        raw_data.resize(raw_data.size() * 2);
+    }
+}
+
+ze_result_t MetricReadBuffer::calculate(zet_metric_group_handle_t metric_group, uint32_t metric_count) {
+    value_count = 0;
+    if (raw_size == 0) {
+        return ZE_RESULT_SUCCESS;
+    }
+    zet_metric_group_calculation_type_t calc_type = ZET_METRIC_GROUP_CALCULATION_TYPE_METRIC_VALUES;
+    if (report_size > 0 && metric_count > 0) {
+        // one spare report so that a full buffer means the values were truncated
+        size_t count = (raw_size / report_size + 1) * metric_count;
+        if (values.size() < count) {
+            values.resize(count);
+        }
+    }
+    ze_result_t res;
+    if (!values.empty()) {
+        value_count = values.size();
+        res = zetMetricGroupCalculateMetricValues(metric_group, calc_type, raw_size, raw_data.data(), &value_count, values.data());
+        if (res != ZE_RESULT_SUCCESS) {
+            return res;
+        }
+    }
+    if (value_count == values.size()) {
+        // the first calculation, or the values may be truncated
+        uint32_t count = 0;
+        res = zetMetricGroupCalculateMetricValues(metric_group, calc_type, raw_size, raw_data.data(), &count, nullptr);
+        if (res != ZE_RESULT_SUCCESS) {
+            return res;
+        }
+        if (count > values.size()) {
+            values.resize(count);
+            value_count = count;
+            res = zetMetricGroupCalculateMetricValues(metric_group, calc_type, raw_size, raw_data.data(), &value_count, values.data());
+            if (res != ZE_RESULT_SUCCESS) {
+                return res;
+            }
+        }
+    }
+    if (metric_count > 0 && value_count >= metric_count) {
+        report_size = raw_size / (value_count / metric_count);
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+uint32_t expectedMetricReports(uint32_t interval, uint32_t sampling_period) {
+    if (sampling_period == 0) {
+        return 1;
+    }
+    return (uint32_t)((uint64_t)interval * 1000000 / sampling_period) + 1;
+}
+
+MetricStreamerSessionManager& MetricStreamerSessionManager::instance() {
+    static MetricStreamerSessionManager manager;
+    return manager;
+}
+
+std::shared_ptr<MetricStreamerSession> MetricStreamerSessionManager::getOrOpenSession(ze_device_handle_t device,
+                                                                                      ze_context_handle_t context,
+                                                                                      zet_metric_group_handle_t metric_group,
+                                                                                      bool& opened) {
+    opened = false;
+    uint32_t sampling_period = Configuration::EU_ACTIVE_STALL_IDLE_STREAMER_SAMPLING_PERIOD;
+    std::unique_lock<std::mutex> lock(this->mutex);
+    auto it = sessions.find(device);
+    if (it != sessions.end()) {
+        auto session = it->second;
+        std::unique_lock<std::mutex> session_lock(session->mutex);
+        if (!session->closed && session->sampling_period == sampling_period && session->metric_group == metric_group) {
+            return session;
+        }
+        // the streamer failed or the sampling period was changed, reopen it
+        close(session);
+        sessions.erase(it);
+    }
+
+    ze_result_t res;
+    XPUM_ZE_HANDLE_LOCK(device, res = zetContextActivateMetricGroups(context, device, 1, &metric_group));
+    if (res != ZE_RESULT_SUCCESS) {
+        throw BaseException("toGetEuActiveStallIdleCore - zetContextActivateMetricGroups");
+    }
+
+    zet_metric_streamer_handle_t streamer = nullptr;
+    zet_metric_streamer_desc_t streamer_desc = {ZET_STRUCTURE_TYPE_METRIC_STREAMER_DESC};
+    streamer_desc.samplingPeriod = sampling_period;
+    XPUM_ZE_HANDLE_LOCK(device, res = zetMetricStreamerOpen(context, device, metric_group, &streamer_desc, nullptr, &streamer));
+    if (res != ZE_RESULT_SUCCESS) {
+        zetContextActivateMetricGroups(context, device, 0, nullptr);
+        throw BaseException("toGetEuActiveStallIdleCore - zetMetricStreamerOpen");
+    }
+
+    auto session = std::make_shared<MetricStreamerSession>();
+    session->device = device;
+    session->context = context;
+    session->metric_group = metric_group;
+    session->streamer = streamer;
+    session->sampling_period = sampling_period;
+    session->closed = false;
+    sessions[device] = session;
+    opened = true;
+    XPUM_LOG_DEBUG("metric streamer session opened for device {}", (void*)device);
+    return session;
+}
+
+void MetricStreamerSessionManager::readData(std::shared_ptr<MetricStreamerSession>& session, MetricReadBuffer& buffer) {
+    std::unique_lock<std::mutex> lock(session->mutex);
+    if (session->closed) {
+        throw BaseException("toGetEuActiveStallIdleCore - metric streamer session closed");
+    }
+    ze_result_t res = buffer.read(session->streamer);
+    if (res != ZE_RESULT_SUCCESS) {
+        close(session);
+        throw BaseException("toGetEuActiveStallIdleCore");
+    }
+}
+
+void MetricStreamerSessionManager::closeSession(ze_device_handle_t device) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    auto it = sessions.find(device);
+    if (it == sessions.end()) {
+        return;
+    }
+    auto session = it->second;
+    sessions.erase(it);
+    std::unique_lock<std::mutex> session_lock(session->mutex);
+    close(session);
+}
+
+void MetricStreamerSessionManager::closeAllSessions() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    for (auto& it : sessions) {
+        std::unique_lock<std::mutex> session_lock(it.second->mutex);
+        close(it.second);
+    }
+    sessions.clear();
+}
+
+void MetricStreamerSessionManager::close(std::shared_ptr<MetricStreamerSession>& session) {
+    if (session->closed) {
+        return;
+    }
+    session->closed = true;
+    ze_result_t res = zetMetricStreamerClose(session->streamer);
+    if (res != ZE_RESULT_SUCCESS) {
+        XPUM_LOG_DEBUG("zetMetricStreamerClose returned: {}", res);
+    }
+    session->streamer = nullptr;
+    res = zetContextActivateMetricGroups(session->context, session->device, 0, nullptr);
+    if (res != ZE_RESULT_SUCCESS) {
+        XPUM_LOG_DEBUG("zetContextActivateMetricGroups returned: {}", res);
+    }
+    XPUM_LOG_DEBUG("metric streamer session closed for device {}", (void*)session->device);
+}
+
+} // end namespace xpum
@@ -0,0 +1,115 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file metric_streamer_session.h
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "level_zero/ze_api.h"
+#include "level_zero/zet_api.h"
+
+namespace xpum {
+
+/*
+  Grow-only scratch space of the reads of one metric group. Once the buffers
+  are large enough for the reports collected between two reads, the raw
+  reports and the calculated values are read with one driver call each
+  instead of a size query followed by the read.
+*/
+struct MetricReadBuffer {
+    std::vector<uint8_t> raw_data;
+    // bytes of raw_data filled by the last read
+    size_t raw_size = 0;
+    std::vector<zet_typed_value_t> values;
+    // entries of values filled by the last calculation
+    uint32_t value_count = 0;
+    // bytes of one raw report, 0 until the first reports are calculated
+    size_t report_size = 0;
+
+    // Grow raw_data to hold expected_reports reports once the report size is known
+    void reserve(uint32_t expected_reports);
+
+    // Read all reports buffered by streamer into raw_data
+    ze_result_t read(zet_metric_streamer_handle_t streamer);
+
+    // Calculate the metric values of the reports in raw_data into values
+    ze_result_t calculate(zet_metric_group_handle_t metric_group, uint32_t metric_count);
+};
+
+// The reports a streamer sampling every sampling_period ns collects in interval ms
+uint32_t expectedMetricReports(uint32_t interval, uint32_t sampling_period);
+
+/*
+  A metric streamer that stays open between samples. The streamer keeps
+  collecting reports in the background so that each read drains whatever
+  has been buffered since the previous read.
+*/
+struct MetricStreamerSession {
+    ze_device_handle_t device;
+    ze_context_handle_t context;
+    zet_metric_group_handle_t metric_group;
+    zet_metric_streamer_handle_t streamer;
+    uint32_t sampling_period;
+    bool closed;
+    std::mutex mutex;
+};
+
+/*
+  MetricStreamerSessionManager keeps one long-lived metric streamer per
+  (sub)device, so the EU active/stall/idle sampling does not need to open,
+  sleep and close a streamer on every monitor tick.
+*/
+class MetricStreamerSessionManager {
+   public:
+    static MetricStreamerSessionManager& instance();
+
+    /*
+      Return the open session of device, or open a new one. The caller must
+      hold GPUDeviceStub::metric_streamer_mutex because opening a session
+      activates the metric group on the context. opened is set to true when
+      the session was created by this call.
+    */
+    std::shared_ptr<MetricStreamerSession> getOrOpenSession(ze_device_handle_t device,
+                                                            ze_context_handle_t context,
+                                                            zet_metric_group_handle_t metric_group,
+                                                            bool& opened);
+
+    /*
+      Drain all raw reports buffered by the streamer of session into buffer.
+      The session is closed if the read fails so that it is reopened on next use.
+    */
+    void readData(std::shared_ptr<MetricStreamerSession>& session, MetricReadBuffer& buffer);
+
+    /*
+      Close the session of device and deactivate its metric group. Callers that
+      need to activate other metric groups on the device must hold
+      GPUDeviceStub::metric_streamer_mutex and close the session first.
+    */
+    void closeSession(ze_device_handle_t device);
+
+    void closeAllSessions();
+
+   private:
+    MetricStreamerSessionManager() = default;
+
+    ~MetricStreamerSessionManager() = default;
+
+    MetricStreamerSessionManager(const MetricStreamerSessionManager&) = delete;
+
+    MetricStreamerSessionManager& operator=(const MetricStreamerSessionManager&) = delete;
+
+    static void close(std::shared_ptr<MetricStreamerSession>& session);
+
+   private:
+    std::mutex mutex;
+
+    std::map<ze_device_handle_t, std::shared_ptr<MetricStreamerSession>> sessions;
+};
+
+} // end namespace xpum
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file mmio_register_reader.cpp
+ */
+
+#include "mmio_register_reader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+MmioRegisterReader::Bar::~Bar() {
+    long page_size = sysconf(_SC_PAGE_SIZE);
+    for (auto& page : pages) {
+        munmap(page.second, page_size);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+MmioRegisterReader& MmioRegisterReader::instance() {
+    static MmioRegisterReader reader;
+    return reader;
+}
+
+uint32_t MmioRegisterReader::read(const std::string& bdf, uint64_t offset) {
+    if (bdf.empty()) {
+        return (uint32_t)-1;
+    }
+    std::lock_guard<std::mutex> lck(mtx);
+    auto& bar = bars[bdf];
+    if (bar == nullptr) {
+        std::string resource_file = "/sys/bus/pci/devices/" + bdf + "/resource0";
+        int fd = open(resource_file.c_str(), O_RDONLY | O_SYNC | O_CLOEXEC);
+        if (fd < 0) {
+            // not kept, so it is tried again, e.g. after the driver is bound
+            bars.erase(bdf);
+            return (uint32_t)-1;
+        }
+        bar = std::make_shared<Bar>();
+        bar->fd = fd;
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            bar->size = st.st_size;
+        }
+    }
+    if (bar->size > 0 && offset + sizeof(uint32_t) > bar->size) {
+        return (uint32_t)-1;
+    }
+
+    uint64_t page_size = sysconf(_SC_PAGE_SIZE);
+    uint64_t page = offset & ~(page_size - 1);
+    if (offset - page + sizeof(uint32_t) > page_size) {
+        // the registers are 4-byte aligned, none crosses a page
+        return (uint32_t)-1;
+    }
+    auto it = bar->pages.find(page);
+    if (it == bar->pages.end()) {
+        void* addr = mmap(0, page_size, PROT_READ, MAP_SHARED, bar->fd, page);
+        if (addr == MAP_FAILED) {
+            XPUM_LOG_DEBUG("Failed to map the register page {:#x} of {}", page, bdf);
+            return (uint32_t)-1;
+        }
+        it = bar->pages.emplace(page, addr).first;
+    }
+    return *(const volatile uint32_t*)((const uint8_t*)it->second + (offset - page));
+}
+
+void MmioRegisterReader::release(const std::string& bdf) {
+    std::lock_guard<std::mutex> lck(mtx);
+    bars.erase(bdf);
+}
+
+} // end namespace xpum
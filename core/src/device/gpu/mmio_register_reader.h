@@ -0,0 +1,53 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file mmio_register_reader.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace xpum {
+
+/*
+  MmioRegisterReader reads the 32-bit registers of BAR 0 of the GPUs through
+  /sys/bus/pci/devices/<bdf>/resource0. The resource file of a GPU is opened
+  on its first read and the page of a register is mapped on its first read,
+  both stay until the GPU is released, so a later read is one load from the
+  mapping instead of an open, mmap, munmap and close.
+*/
+class MmioRegisterReader {
+   public:
+    static MmioRegisterReader& instance();
+
+    // the register at offset of BAR 0 of the GPU at bdf, (uint32_t)-1 if it can not be read
+    uint32_t read(const std::string& bdf, uint64_t offset);
+
+    // unmap the BAR of the GPU at bdf, for a GPU removed or reset
+    void release(const std::string& bdf);
+
+   private:
+    struct Bar {
+        int fd = -1;
+
+        uint64_t size = 0;
+
+        // the page offset to its mapping
+        std::map<uint64_t, void*> pages;
+
+        ~Bar();
+    };
+
+    MmioRegisterReader() = default;
+
+    std::mutex mtx;
+
+    std::map<std::string, std::shared_ptr<Bar>> bars;
+};
+
+} // end namespace xpum
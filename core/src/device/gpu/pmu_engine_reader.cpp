@@ -0,0 +1,197 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file pmu_engine_reader.cpp
+ */
+
+#include "pmu_engine_reader.h"
+
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+static const std::string EVENT_SOURCE_DIR = "/sys/bus/event_source/devices/";
+
+static const std::string BUSY_SUFFIX = "-busy";
+
+PmuEngineReader::EventGroup::~EventGroup() {
+    // the siblings before the leader
+    for (auto it = fds.rbegin(); it != fds.rend(); ++it) {
+        close(*it);
+    }
+}
+
+PmuEngineReader& PmuEngineReader::instance() {
+    static PmuEngineReader reader;
+    return reader;
+}
+
+bool PmuEngineReader::isSelected(uint32_t pci_device_id) {
+    // "all", or the PCI device ids like "0x56c0,0x56c1"
+    static const std::pair<bool, std::set<uint32_t>> selected = []() {
+        std::pair<bool, std::set<uint32_t>> result(false, {});
+        std::stringstream ss(Configuration::ENGINE_ACTIVITY_PMU);
+        std::string id;
+        while (std::getline(ss, id, ',')) {
+            if (id == "all") {
+                result.first = true;
+                continue;
+            }
+            try {
+                result.second.insert(std::stoul(id, nullptr, 16));
+            } catch (std::exception& e) {
+                XPUM_LOG_WARN("Invalid PCI device id in XPUM_ENGINE_ACTIVITY_PMU: {}", id);
+            }
+        }
+        return result;
+    }();
+    return selected.first || selected.second.find(pci_device_id) != selected.second.end();
+}
+
+static bool readFirstLine(const std::string& path, std::string& line) {
+    std::ifstream file(path);
+    return (bool)std::getline(file, line);
+}
+
+// "rcs0" to the class and the instance
+static bool parseEngineName(const std::string& name, PmuEngineClass& engine_class, uint32_t& instance) {
+    static const std::map<std::string, PmuEngineClass> classes = {
+        {"rcs", PMU_ENGINE_RENDER},
+        {"bcs", PMU_ENGINE_COPY},
+        {"vcs", PMU_ENGINE_VIDEO},
+        {"vecs", PMU_ENGINE_VIDEO_ENHANCE},
+        {"ccs", PMU_ENGINE_COMPUTE},
+    };
+    auto digit = name.find_first_of("0123456789");
+    if (digit == std::string::npos || digit == 0 || name.find_first_not_of("0123456789", digit) != std::string::npos) {
+        return false;
+    }
+    auto it = classes.find(name.substr(0, digit));
+    if (it == classes.end()) {
+        return false;
+    }
+    engine_class = it->second;
+    instance = std::stoul(name.substr(digit));
+    return true;
+}
+
+std::shared_ptr<PmuEngineReader::EventGroup> PmuEngineReader::openGroup(const std::string& bdf) {
+    std::string pmu = "i915_" + bdf;
+    std::replace(pmu.begin(), pmu.end(), ':', '_');
+    std::string type_line;
+    if (!readFirstLine(EVENT_SOURCE_DIR + pmu + "/type", type_line)) {
+        // the PMU of the integrated GPU, always at 00:02.0, has no address in its name
+        if (bdf.size() < 7 || bdf.compare(bdf.size() - 7, 7, "00:02.0") != 0 || !readFirstLine(EVENT_SOURCE_DIR + "i915/type", type_line)) {
+            XPUM_LOG_INFO("No i915 PMU for {}, its engines are read from Level Zero", bdf);
+            return nullptr;
+        }
+        pmu = "i915";
+    }
+    std::string pmu_dir = EVENT_SOURCE_DIR + pmu;
+    // the i915 PMU counts for the whole GPU, the events are opened on the first CPU of its mask
+    int cpu = 0;
+    std::string cpumask;
+    std::vector<std::pair<std::pair<PmuEngineClass, uint32_t>, uint64_t>> events;
+    try {
+        uint32_t type = std::stoul(type_line);
+        if (readFirstLine(pmu_dir + "/cpumask", cpumask)) {
+            cpu = std::stoi(cpumask);
+        }
+        DIR* dir = opendir((pmu_dir + "/events").c_str());
+        if (dir == nullptr) {
+            return nullptr;
+        }
+        struct dirent* ent;
+        while ((ent = readdir(dir)) != nullptr) {
+            std::string name = ent->d_name;
+            if (name.size() <= BUSY_SUFFIX.size() || name.compare(name.size() - BUSY_SUFFIX.size(), BUSY_SUFFIX.size(), BUSY_SUFFIX) != 0) {
+                continue;
+            }
+            PmuEngineClass engine_class;
+            uint32_t instance;
+            std::string config;
+            if (!parseEngineName(name.substr(0, name.size() - BUSY_SUFFIX.size()), engine_class, instance) ||
+                !readFirstLine(pmu_dir + "/events/" + name, config) || config.compare(0, 7, "config=") != 0) {
+                continue;
+            }
+            events.emplace_back(std::make_pair(engine_class, instance), std::stoull(config.substr(7), nullptr, 16));
+        }
+        closedir(dir);
+        if (events.empty()) {
+            return nullptr;
+        }
+        std::sort(events.begin(), events.end());
+
+        auto p_group = std::make_shared<EventGroup>();
+        for (auto& event : events) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.type = type;
+            attr.size = sizeof(attr);
+            attr.config = event.second;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED;
+            int group_fd = p_group->fds.empty() ? -1 : p_group->fds.front();
+            int fd = syscall(SYS_perf_event_open, &attr, -1, cpu, group_fd, PERF_FLAG_FD_CLOEXEC);
+            if (fd < 0) {
+                XPUM_LOG_INFO("Failed to open the PMU events of {}, its engines are read from Level Zero: {}", bdf, strerror(errno));
+                return nullptr;
+            }
+            p_group->fds.push_back(fd);
+            p_group->engines.push_back(event.first);
+        }
+        // nr, time enabled, then the value of each event
+        p_group->buffer.resize(2 + p_group->fds.size());
+        XPUM_LOG_INFO("The {} engines of {} are read from the PMU {}", p_group->fds.size(), bdf, pmu);
+        return p_group;
+    } catch (std::exception& e) {
+        XPUM_LOG_WARN("Invalid PMU {} of {}: {}", pmu, bdf, e.what());
+        return nullptr;
+    }
+}
+
+bool PmuEngineReader::read(const std::string& bdf, PmuEngineSample& sample) {
+    if (bdf.empty()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lck(mtx);
+    auto it = groups.find(bdf);
+    if (it == groups.end()) {
+        it = groups.emplace(bdf, openGroup(bdf)).first;
+    }
+    auto& p_group = it->second;
+    if (p_group == nullptr) {
+        return false;
+    }
+    ssize_t size = p_group->buffer.size() * sizeof(uint64_t);
+    if (::read(p_group->fds.front(), p_group->buffer.data(), size) != size || p_group->buffer[0] != p_group->fds.size()) {
+        XPUM_LOG_WARN("Failed to read the PMU events of {}, its engines are read from Level Zero", bdf);
+        p_group = nullptr;
+        return false;
+    }
+    sample.time = p_group->buffer[1];
+    sample.busy.clear();
+    for (size_t i = 0; i < p_group->engines.size(); i++) {
+        sample.busy[p_group->engines[i]] = p_group->buffer[2 + i];
+    }
+    return true;
+}
+
+void PmuEngineReader::release(const std::string& bdf) {
+    std::lock_guard<std::mutex> lck(mtx);
+    groups.erase(bdf);
+}
+
+} // end namespace xpum
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file pmu_engine_reader.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace xpum {
+
+// the engine classes of the busy events of the i915 PMU
+enum PmuEngineClass {
+    PMU_ENGINE_RENDER,         // rcs
+    PMU_ENGINE_COPY,           // bcs
+    PMU_ENGINE_VIDEO,          // vcs
+    PMU_ENGINE_VIDEO_ENHANCE,  // vecs
+    PMU_ENGINE_COMPUTE,        // ccs
+};
+
+// the busy time of the engines of a GPU read in one group read
+struct PmuEngineSample {
+    // ns the group was enabled, the same for all the engines
+    uint64_t time;
+    // ns, by engine class and instance
+    std::map<std::pair<PmuEngineClass, uint32_t>, uint64_t> busy;
+};
+
+/*
+  PmuEngineReader reads the busy time of all the engines of a GPU from the
+  i915 PMU with perf_event_open, as an alternative to zesEngineGetActivity
+  on each engine. The busy events of a GPU are opened in one event group on
+  its first read, so a later read is one read() of all the counters, with
+  one timestamp for all the engines.
+
+  The PMU of a GPU is "i915" for an integrated GPU and "i915_<bdf>" for a
+  discrete one. A GPU without a PMU, like one bound to xe, or whose events
+  can not be opened, e.g. without CAP_PERFMON, is not tried again until it
+  is released.
+*/
+class PmuEngineReader {
+   public:
+    static PmuEngineReader& instance();
+
+    // whether the engines of a GPU of pci_device_id are read from the PMU, by XPUM_ENGINE_ACTIVITY_PMU
+    static bool isSelected(uint32_t pci_device_id);
+
+    // false if the PMU of the GPU at bdf can not be read
+    bool read(const std::string& bdf, PmuEngineSample& sample);
+
+    // close the events of the GPU at bdf, for a GPU removed or reset
+    void release(const std::string& bdf);
+
+   private:
+    struct EventGroup {
+        // the leader first
+        std::vector<int> fds;
+
+        std::vector<std::pair<PmuEngineClass, uint32_t>> engines;
+
+        // scratch space of the group read
+        std::vector<uint64_t> buffer;
+
+        ~EventGroup();
+    };
+
+    PmuEngineReader() = default;
+
+    // nullptr if the PMU of the GPU at bdf has no busy event or they can not be opened
+    static std::shared_ptr<EventGroup> openGroup(const std::string& bdf);
+
+    std::mutex mtx;
+
+    // nullptr for a GPU whose PMU can not be read
+    std::map<std::string, std::shared_ptr<EventGroup>> groups;
+};
+
+} // end namespace xpum
@@ -0,0 +1,590 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file simulated_device.cpp
+ */
+
+#include "simulated_device.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/device_property.h"
+#include "infrastructure/engine_measurement_data.h"
+#include "infrastructure/fabric_measurement_data.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+namespace {
+
+// a Data Center GPU Max 1550, per tile
+const uint32_t PCI_DEVICE_ID = 0x0bd5;
+const uint32_t PCI_VENDOR_ID = 0x8086;
+const uint32_t EU_COUNT = 512;
+const double IDLE_POWER = 45;
+const double MAX_POWER = 300;
+const double MIN_FREQUENCY = 900;
+const double MAX_FREQUENCY = 1600;
+const double THROTTLED_FREQUENCY = 1100;
+const double AMBIENT_TEMPERATURE = 30;
+const double THROTTLE_TEMPERATURE = 90;
+// the temperature a tile reaches at a constant power, in Celsius per W
+const double TEMPERATURE_PER_WATT = 0.2;
+const double MEMORY_TEMPERATURE_PER_WATT = 0.12;
+// the time constant of the temperature, in seconds
+const double THERMAL_TIME_CONSTANT = 20;
+const uint64_t MEMORY_SIZE = 64ULL * 1024 * 1024 * 1024;
+// in bytes per second
+const double MAX_MEMORY_BANDWIDTH = 1.6e12;
+const double MAX_FABRIC_BANDWIDTH = 26.5e9;
+const double MAX_PCIE_BANDWIDTH = 32e9;
+
+const uint32_t COMPUTE_ENGINES = 4;
+const uint32_t COPY_ENGINES = 8;
+const uint32_t MEDIA_ENGINES = 2;
+
+uint64_t nowMicroseconds() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string toHexString(uint32_t val) {
+    std::stringstream s;
+    s << std::string("0x") << std::hex << val << std::dec;
+    return s.str();
+}
+
+bool inEngineGroup(zes_engine_group_t group, zes_engine_group_t type) {
+    switch (group) {
+        case ZES_ENGINE_GROUP_COMPUTE_ALL:
+            return type == ZES_ENGINE_GROUP_COMPUTE_SINGLE;
+        case ZES_ENGINE_GROUP_RENDER_ALL:
+            return type == ZES_ENGINE_GROUP_RENDER_SINGLE;
+        case ZES_ENGINE_GROUP_MEDIA_ALL:
+            return type == ZES_ENGINE_GROUP_MEDIA_DECODE_SINGLE || type == ZES_ENGINE_GROUP_MEDIA_ENCODE_SINGLE || type == ZES_ENGINE_GROUP_MEDIA_ENHANCEMENT_SINGLE;
+        case ZES_ENGINE_GROUP_COPY_ALL:
+            return type == ZES_ENGINE_GROUP_COPY_SINGLE;
+        case ZES_ENGINE_GROUP_3D_ALL:
+            return type == ZES_ENGINE_GROUP_3D_SINGLE;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+SimulatedDevice::SimulatedDevice(uint32_t index, uint32_t device_count, uint32_t tile_count, uint32_t fabric_ports_per_tile)
+    : random(index + 1), tile_count(tile_count), fabric_id(0) {
+    setId(std::to_string(index));
+    std::uniform_real_distribution<double> uniform(0, 1);
+    period = 30 + 90 * uniform(random);
+    phase = 2 * M_PI * uniform(random);
+    last_time = nowMicroseconds();
+
+    DeviceCapability caps[] = {
+        DeviceCapability::METRIC_POWER,
+        DeviceCapability::METRIC_ENERGY,
+        DeviceCapability::METRIC_FREQUENCY,
+        DeviceCapability::METRIC_TEMPERATURE,
+        DeviceCapability::METRIC_MEMORY_TEMPERATURE,
+        DeviceCapability::METRIC_MEMORY_USED_UTILIZATION,
+        DeviceCapability::METRIC_MEMORY_THROUGHPUT_BANDWIDTH,
+        DeviceCapability::METRIC_COMPUTATION,
+        DeviceCapability::METRIC_ENGINE_UTILIZATION,
+        DeviceCapability::METRIC_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION,
+        DeviceCapability::METRIC_ENGINE_GROUP_MEDIA_ALL_UTILIZATION,
+        DeviceCapability::METRIC_ENGINE_GROUP_COPY_ALL_UTILIZATION,
+        DeviceCapability::METRIC_ENGINE_GROUP_RENDER_ALL_UTILIZATION,
+        DeviceCapability::METRIC_FREQUENCY_THROTTLE,
+        DeviceCapability::METRIC_FREQUENCY_THROTTLE_REASON_GPU,
+        DeviceCapability::METRIC_PCIE_READ_THROUGHPUT,
+        DeviceCapability::METRIC_PCIE_WRITE_THROUGHPUT,
+        DeviceCapability::METRIC_PCIE_READ,
+        DeviceCapability::METRIC_PCIE_WRITE};
+    for (auto& cap : caps) {
+        addCapability(cap);
+    }
+
+    bool on_subdevice = tile_count > 1;
+    uint64_t handle = (uint64_t(index) + 1) << 32;
+    for (uint32_t tile = 0; tile < tile_count; tile++) {
+        SimulatedTile state = {};
+        state.temperature = AMBIENT_TEMPERATURE + TEMPERATURE_PER_WATT * IDLE_POWER;
+        state.memory_temperature = AMBIENT_TEMPERATURE + MEMORY_TEMPERATURE_PER_WATT * IDLE_POWER;
+        state.frequency = MIN_FREQUENCY;
+        state.memory_used = MEMORY_SIZE / 20;
+        tiles.push_back(state);
+
+        auto add = [&](zes_engine_group_t type, uint32_t count, double load_factor) {
+            for (uint32_t i = 0; i < count; i++) {
+                engines.push_back({++handle, type, tile, load_factor * (0.8 + 0.4 * uniform(random)), 0});
+                addEngine(handle, type, on_subdevice, tile);
+            }
+        };
+        add(ZES_ENGINE_GROUP_COMPUTE_SINGLE, COMPUTE_ENGINES, 1.0);
+        add(ZES_ENGINE_GROUP_RENDER_SINGLE, 1, 0.3);
+        add(ZES_ENGINE_GROUP_COPY_SINGLE, COPY_ENGINES, 0.2);
+        add(ZES_ENGINE_GROUP_MEDIA_DECODE_SINGLE, MEDIA_ENGINES, 0.1);
+        add(ZES_ENGINE_GROUP_MEDIA_ENCODE_SINGLE, MEDIA_ENGINES, 0.05);
+        add(ZES_ENGINE_GROUP_MEDIA_ENHANCEMENT_SINGLE, MEDIA_ENGINES, 0.05);
+        all_engines.push_back({++handle, ZES_ENGINE_GROUP_ALL, tile, 1.0, 0});
+    }
+
+    // port k of a tile is linked to the same tile of the k + 1th next device
+    if (device_count > 1 && fabric_ports_per_tile > 0) {
+        fabric_id = index + 1;
+        DeviceCapability cap = DeviceCapability::METRIC_FABRIC_THROUGHPUT;
+        addCapability(cap);
+        setFabricID(fabric_id);
+        for (uint32_t tile = 0; tile < tile_count; tile++) {
+            for (uint32_t k = 0; k < fabric_ports_per_tile; k++) {
+                uint32_t remote = (index + (k % (device_count - 1)) + 1) % device_count;
+                fabric_ports.push_back({++handle, tile, remote + 1, tile, 0, 0});
+                addFabricPortHandle(tile, remote + 1, tile, (zes_fabric_port_handle_t)handle);
+            }
+        }
+    }
+
+    char bdf[16];
+    snprintf(bdf, sizeof(bdf), "0000:%02x:00.0", (index + 0x10) & 0xff);
+    setPciAddress({0, (index + 0x10) & 0xff, 0, 0});
+    char uuid[37];
+    snprintf(uuid, sizeof(uuid), "00000000-0000-0000-0000-%012x", index + 1);
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_DEVICE_TYPE, std::string("GPU")));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_DEVICE_ID, toHexString(PCI_DEVICE_ID)));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_VENDOR_ID, toHexString(PCI_VENDOR_ID)));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_DEVICE_NAME, std::string("Intel(R) Data Center GPU Max 1550 (simulated)")));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_VENDOR_NAME, std::string("Intel(R) Corporation")));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_UUID, std::string(uuid)));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_SERIAL_NUMBER, "SIM" + std::to_string(index)));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_DRIVER_VERSION, std::string("simulated")));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS, std::string(bdf)));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_DEVICE_FUNCTION_TYPE, DEVICE_FUNCTION_TYPE_PHYSICAL));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_SUBDEVICE, std::to_string(on_subdevice ? tile_count : 0)));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_TILES, std::to_string(tile_count)));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_EUS, std::to_string(EU_COUNT * tile_count)));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_MEDIA_ENGINES, std::to_string(2 * MEDIA_ENGINES * tile_count)));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_NUMBER_OF_MEDIA_ENH_ENGINES, std::to_string(MEDIA_ENGINES * tile_count)));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_CORE_CLOCK_RATE_MHZ, std::to_string((int)MAX_FREQUENCY)));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_MEMORY_PHYSICAL_SIZE_BYTE, std::to_string(MEMORY_SIZE * tile_count)));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_MEMORY_FREE_SIZE_BYTE, std::to_string(MEMORY_SIZE * tile_count)));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_PCIE_GENERATION, std::string("5")));
+    addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_PCIE_MAX_LINK_WIDTH, std::string("16")));
+    if (!fabric_ports.empty()) {
+        addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_FABRIC_PORT_NUMBER, std::to_string(fabric_ports.size())));
+    }
+}
+
+SimulatedDevice::~SimulatedDevice() {
+}
+
+std::shared_ptr<std::vector<std::shared_ptr<Device>>> SimulatedDevice::discoverDevices() {
+    auto p_devices = std::make_shared<std::vector<std::shared_ptr<Device>>>();
+    uint32_t count = Configuration::SIMULATED_DEVICE_COUNT;
+    for (uint32_t i = 0; i < count; i++) {
+        p_devices->push_back(std::make_shared<SimulatedDevice>(i, count, Configuration::SIMULATED_DEVICE_TILES, Configuration::SIMULATED_FABRIC_PORTS));
+    }
+    XPUM_LOG_INFO("{} simulated devices with {} tiles are used", count, Configuration::SIMULATED_DEVICE_TILES);
+    return p_devices;
+}
+
+uint32_t SimulatedDevice::getSimulatedFabricId() {
+    return fabric_id;
+}
+
+double SimulatedDevice::loadAt(uint32_t tile, double t) {
+    // the tiles of a device run the same workload slightly out of step
+    double load = 0.5 + 0.4 * std::sin(2 * M_PI * t / period + phase + 0.3 * tile);
+    return std::min(std::max(load, 0.0), 1.0);
+}
+
+void SimulatedDevice::advance(uint64_t now) {
+    if (now <= last_time) {
+        return;
+    }
+    double dt = (now - last_time) / 1e6;
+    last_time = now;
+    std::normal_distribution<double> noise(0, 0.05);
+    std::uniform_real_distribution<double> jitter(0.9, 1.1);
+    double smoothing = 1 - std::exp(-dt / THERMAL_TIME_CONSTANT);
+
+    for (uint32_t i = 0; i < tiles.size(); i++) {
+        auto& tile = tiles[i];
+        tile.load = std::min(std::max(loadAt(i, now / 1e6) + noise(random), 0.0), 1.0);
+        tile.power = IDLE_POWER + tile.load * (MAX_POWER - IDLE_POWER) * jitter(random);
+        tile.energy += (uint64_t)(tile.power * dt * 1e6);
+
+        double target = AMBIENT_TEMPERATURE + TEMPERATURE_PER_WATT * tile.power;
+        tile.temperature += (target - tile.temperature) * smoothing;
+        target = AMBIENT_TEMPERATURE + MEMORY_TEMPERATURE_PER_WATT * tile.power;
+        tile.memory_temperature += (target - tile.memory_temperature) * smoothing;
+
+        if (tile.temperature > THROTTLE_TEMPERATURE) {
+            tile.frequency = THROTTLED_FREQUENCY;
+            tile.throttle_time += (uint64_t)(dt * 1e6);
+        } else {
+            tile.frequency = MIN_FREQUENCY + (MAX_FREQUENCY - MIN_FREQUENCY) * std::min(1.0, 2 * tile.load);
+        }
+
+        // the memory used drifts towards a share of the memory that follows the load
+        double used_target = MEMORY_SIZE * (0.05 + 0.7 * tile.load);
+        tile.memory_used += (int64_t)((used_target - (double)tile.memory_used) * std::min(1.0, dt / 10));
+
+        tile.memory_read_rate = MAX_MEMORY_BANDWIDTH * 0.6 * tile.load * jitter(random);
+        tile.memory_write_rate = tile.memory_read_rate * 0.4 * jitter(random);
+        tile.memory_read += (uint64_t)(tile.memory_read_rate * dt);
+        tile.memory_write += (uint64_t)(tile.memory_write_rate * dt);
+
+        tile.pcie_read_rate = MAX_PCIE_BANDWIDTH * 0.3 * tile.load * jitter(random);
+        tile.pcie_write_rate = MAX_PCIE_BANDWIDTH * 0.1 * tile.load * jitter(random);
+        tile.pcie_read += (uint64_t)(tile.pcie_read_rate * dt);
+        tile.pcie_write += (uint64_t)(tile.pcie_write_rate * dt);
+    }
+
+    for (auto& engine : engines) {
+        double busy = std::min(1.0, tiles[engine.tile].load * engine.load_factor);
+        engine.active_time += (uint64_t)(busy * dt * 1e6);
+    }
+    for (auto& engine : all_engines) {
+        engine.active_time += (uint64_t)(tiles[engine.tile].load * dt * 1e6);
+    }
+    for (auto& port : fabric_ports) {
+        double rate = MAX_FABRIC_BANDWIDTH * 0.5 * tiles[port.tile].load;
+        port.rx_counter += (uint64_t)(rate * jitter(random) * dt);
+        port.tx_counter += (uint64_t)(rate * jitter(random) * dt);
+    }
+}
+
+void SimulatedDevice::unsupported(Callback_t& callback, const char* metric) {
+    callback(nullptr, std::make_shared<BaseException>(std::string(metric) + " is not simulated"));
+}
+
+void SimulatedDevice::getPower(Callback_t callback) noexcept {
+    auto ret = std::make_shared<MeasurementData>();
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        uint64_t now = nowMicroseconds();
+        advance(now);
+        uint64_t energy = 0;
+        for (uint32_t i = 0; i < tile_count; i++) {
+            energy += tiles[i].energy;
+            if (tile_count > 1) {
+                ret->setSubdeviceRawData(i, Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * tiles[i].energy);
+                ret->setSubdeviceDataRawTimestamp(i, now);
+            }
+        }
+        ret->setRawData(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * energy);
+        ret->setRawTimestamp(now);
+        ret->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getEnergy(Callback_t callback) noexcept {
+    auto ret = std::make_shared<MeasurementData>();
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        advance(nowMicroseconds());
+        uint64_t energy = 0;
+        for (uint32_t i = 0; i < tile_count; i++) {
+            energy += tiles[i].energy;
+            if (tile_count > 1) {
+                ret->setSubdeviceDataCurrent(i, tiles[i].energy / 1000);
+            }
+        }
+        ret->setCurrent(energy / 1000);
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getActuralRequestFrequency(Callback_t callback) noexcept {
+    auto ret = std::make_shared<MeasurementData>();
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        advance(nowMicroseconds());
+        for (uint32_t i = 0; i < tile_count; i++) {
+            uint32_t subdevice_id = UINT32_MAX;
+            if (tile_count > 1) {
+                subdevice_id = i;
+                ret->setSubdeviceDataCurrent(i, (uint64_t)tiles[i].frequency);
+            } else {
+                ret->setCurrent((uint64_t)tiles[i].frequency);
+            }
+            ret->setSubdeviceAdditionalData(subdevice_id, MeasurementType::METRIC_REQUEST_FREQUENCY, (uint64_t)MAX_FREQUENCY);
+        }
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getTemperature(Callback_t callback, zes_temp_sensors_t type) noexcept {
+    if (type != ZES_TEMP_SENSORS_GPU && type != ZES_TEMP_SENSORS_MEMORY) {
+        unsupported(callback, "The temperature sensor");
+        return;
+    }
+    auto ret = std::make_shared<MeasurementData>();
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        advance(nowMicroseconds());
+        ret->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
+        double hottest = 0;
+        for (uint32_t i = 0; i < tile_count; i++) {
+            double temperature = type == ZES_TEMP_SENSORS_GPU ? tiles[i].temperature : tiles[i].memory_temperature;
+            hottest = std::max(hottest, temperature);
+            if (tile_count > 1) {
+                ret->setSubdeviceDataCurrent(i, (uint64_t)(temperature * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE));
+            }
+        }
+        ret->setCurrent((uint64_t)(hottest * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE));
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getMemoryUsedUtilization(Callback_t callback) noexcept {
+    auto ret = std::make_shared<MeasurementData>();
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        advance(nowMicroseconds());
+        for (uint32_t i = 0; i < tile_count; i++) {
+            uint64_t used = tiles[i].memory_used;
+            uint64_t utilization = Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * used * 100 / MEMORY_SIZE;
+            uint32_t subdevice_id = UINT32_MAX;
+            if (tile_count > 1) {
+                subdevice_id = i;
+                ret->setSubdeviceDataCurrent(i, used);
+            } else {
+                ret->setCurrent(used);
+            }
+            ret->setSubdeviceAdditionalData(subdevice_id, MeasurementType::METRIC_MEMORY_UTILIZATION, utilization, Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
+        }
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getMemoryThroughputAndBandwidth(Callback_t callback) noexcept {
+    auto ret = std::make_shared<MeasurementData>();
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        uint64_t now = nowMicroseconds();
+        advance(now);
+        uint64_t max_bandwidth = (uint64_t)MAX_MEMORY_BANDWIDTH;
+        for (uint32_t i = 0; i < tile_count; i++) {
+            uint64_t read = tiles[i].memory_read;
+            uint64_t write = tiles[i].memory_write;
+            uint32_t subdevice_id = UINT32_MAX;
+            if (tile_count > 1) {
+                subdevice_id = i;
+                ret->setSubdeviceDataCurrent(i, read);
+            } else {
+                ret->setCurrent(read);
+            }
+            ret->setSubdeviceAdditionalData(subdevice_id, MeasurementType::METRIC_MEMORY_WRITE, write);
+            ret->setSubdeviceAdditionalData(subdevice_id, MeasurementType::METRIC_MEMORY_READ_THROUGHPUT, read / 1024 * 1000, 1, true, now / 1000);
+            ret->setSubdeviceAdditionalData(subdevice_id, MeasurementType::METRIC_MEMORY_WRITE_THROUGHPUT, write / 1024 * 1000, 1, true, now / 1000);
+            ret->setSubdeviceAdditionalData(subdevice_id, MeasurementType::METRIC_MEMORY_BANDWIDTH, 100 * (read / 1000 + write / 1000) / (max_bandwidth / 1000) * 1000, 1, true, now / 1000);
+        }
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getGPUUtilization(Callback_t callback) noexcept {
+    auto ret = std::make_shared<MeasurementData>();
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        uint64_t now = nowMicroseconds();
+        advance(now);
+        ret->setNumSubdevices(tile_count > 1 ? tile_count : 0);
+        for (auto& engine : all_engines) {
+            ExtendedMeasurementData data;
+            data.on_subdevice = tile_count > 1;
+            data.subdevice_id = engine.tile;
+            data.type = engine.type;
+            data.active_time = engine.active_time;
+            data.timestamp = now;
+            ret->addExtendedData(engine.handle, data);
+        }
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getEngineUtilization(Callback_t callback) noexcept {
+    auto ret = std::make_shared<EngineCollectionMeasurementData>(MultiMetricsSchema::instance(this, SCHEMA_ENGINE));
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        uint64_t now = nowMicroseconds();
+        advance(now);
+        ret->setNumSubdevices(tile_count > 1 ? tile_count : 0);
+        for (auto& engine : engines) {
+            ret->addRawData(engine.handle, engine.type, tile_count > 1, engine.tile, engine.active_time, now);
+        }
+    }
+    callback(ret, nullptr);
+}
+
+std::shared_ptr<MeasurementData> SimulatedDevice::engineGroupData(zes_engine_group_t engine_group_type, uint64_t now) {
+    auto ret = std::make_shared<MeasurementData>();
+    ret->setNumSubdevices(tile_count > 1 ? tile_count : 0);
+    for (auto& engine : engines) {
+        if (!inEngineGroup(engine_group_type, engine.type)) {
+            continue;
+        }
+        ExtendedMeasurementData data;
+        data.on_subdevice = tile_count > 1;
+        data.subdevice_id = engine.tile;
+        data.type = engine.type;
+        data.active_time = engine.active_time;
+        data.timestamp = now;
+        ret->addExtendedData(engine.handle, data);
+    }
+    return ret;
+}
+
+void SimulatedDevice::getEngineGroupUtilization(Callback_t callback, zes_engine_group_t engine_group_type) noexcept {
+    std::shared_ptr<MeasurementData> ret;
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        uint64_t now = nowMicroseconds();
+        advance(now);
+        ret = engineGroupData(engine_group_type, now);
+    }
+    if (ret->getExtendedDatas()->empty()) {
+        unsupported(callback, "The engine group");
+        return;
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getEuActiveStallIdle(Callback_t callback, MeasurementType type) noexcept {
+    unsupported(callback, "The EU activity");
+}
+
+void SimulatedDevice::getRasErrorOnSubdevice(Callback_t callback) noexcept {
+    unsupported(callback, "The RAS error");
+}
+
+void SimulatedDevice::getFrequencyThrottle(Callback_t callback) noexcept {
+    auto ret = std::make_shared<MeasurementData>();
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        uint64_t now = nowMicroseconds();
+        advance(now);
+        uint64_t throttle_time = 0;
+        for (uint32_t i = 0; i < tile_count; i++) {
+            throttle_time = std::max(throttle_time, tiles[i].throttle_time);
+            if (tile_count > 1) {
+                ret->setSubdeviceRawData(i, Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * tiles[i].throttle_time);
+                ret->setSubdeviceDataRawTimestamp(i, now);
+            }
+        }
+        ret->setRawData(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE * throttle_time);
+        ret->setRawTimestamp(now);
+        ret->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getFrequencyThrottleReason(Callback_t callback) noexcept {
+    auto ret = std::make_shared<MeasurementData>();
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        advance(nowMicroseconds());
+        zes_freq_throttle_reason_flags_t device_flags = 0;
+        for (uint32_t i = 0; i < tile_count; i++) {
+            zes_freq_throttle_reason_flags_t flags = tiles[i].temperature > THROTTLE_TEMPERATURE ? ZES_FREQ_THROTTLE_REASON_FLAG_THERMAL_LIMIT : 0;
+            device_flags |= flags;
+            if (tile_count > 1) {
+                ret->setSubdeviceDataCurrent(i, flags);
+            }
+        }
+        ret->setCurrent(device_flags);
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getPCIeReadThroughput(Callback_t callback) noexcept {
+    auto ret = std::make_shared<MeasurementData>();
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        advance(nowMicroseconds());
+        double rate = 0;
+        for (auto& tile : tiles) {
+            rate += tile.pcie_read_rate;
+        }
+        // in kB/s
+        ret->setCurrent((uint64_t)(rate / 1000));
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getPCIeWriteThroughput(Callback_t callback) noexcept {
+    auto ret = std::make_shared<MeasurementData>();
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        advance(nowMicroseconds());
+        double rate = 0;
+        for (auto& tile : tiles) {
+            rate += tile.pcie_write_rate;
+        }
+        // in kB/s
+        ret->setCurrent((uint64_t)(rate / 1000));
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getPCIeRead(Callback_t callback) noexcept {
+    auto ret = std::make_shared<MeasurementData>();
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        advance(nowMicroseconds());
+        uint64_t read = 0;
+        for (auto& tile : tiles) {
+            read += tile.pcie_read;
+        }
+        ret->setCurrent(read);
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getPCIeWrite(Callback_t callback) noexcept {
+    auto ret = std::make_shared<MeasurementData>();
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        advance(nowMicroseconds());
+        uint64_t write = 0;
+        for (auto& tile : tiles) {
+            write += tile.pcie_write;
+        }
+        ret->setCurrent(write);
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getFabricThroughput(Callback_t callback) noexcept {
+    if (fabric_ports.empty()) {
+        unsupported(callback, "The fabric throughput");
+        return;
+    }
+    auto ret = std::make_shared<FabricMeasurementData>(MultiMetricsSchema::instance(this, SCHEMA_FABRIC_PORT));
+    {
+        std::lock_guard<std::mutex> lock(simulation_mutex);
+        uint64_t now = nowMicroseconds();
+        advance(now);
+        for (auto& port : fabric_ports) {
+            ret->addRawData(port.handle, now, port.rx_counter, port.tx_counter, port.tile, port.remote_fabric_id, port.remote_attach_id);
+        }
+    }
+    callback(ret, nullptr);
+}
+
+void SimulatedDevice::getPerfMetrics(Callback_t callback) noexcept {
+    unsupported(callback, "The performance metrics");
+}
+
+void SimulatedDevice::getVfEngineUtilization(Callback_t callback) noexcept {
+    unsupported(callback, "The VF engine utilization");
+}
+
+} // end namespace xpum
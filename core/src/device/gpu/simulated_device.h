@@ -0,0 +1,154 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file simulated_device.h
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include "device/gpu/gpu_device.h"
+#include "infrastructure/measurement_data.h"
+
+namespace xpum {
+
+/*
+  SimulatedDevice is a GPU that exists only in xpumd, for testing the
+  daemon, the exporter and the CLI at scale without hardware. It is used
+  instead of the devices of GPUDeviceStub when Configuration::SIMULATED_DEVICE_COUNT
+  is set.
+
+  Each device has tiles, engines and Xe Link ports like a Data Center GPU
+  Max. Its load follows a slow wave with noise, different per device, and the
+  power, frequency, temperature, memory and link traffic follow the load.
+  The counters (energy, engine active time, memory and link traffic) only
+  grow, at the rate of the current values, so the data handlers compute
+  the same kind of values as for a real device.
+
+  Only the telemetry is simulated. The Level Zero handles are null, so the
+  configuration, diagnostics and firmware operations fail on these devices.
+*/
+class SimulatedDevice : public GPUDevice {
+   public:
+    SimulatedDevice(uint32_t index, uint32_t device_count, uint32_t tile_count, uint32_t fabric_ports_per_tile);
+
+    virtual ~SimulatedDevice();
+
+    // the devices to use instead of the discovered ones
+    static std::shared_ptr<std::vector<std::shared_ptr<Device>>> discoverDevices();
+
+    // the fabric id of the Xe Link ports, 0 if the device has none
+    uint32_t getSimulatedFabricId();
+
+   public:
+    void getPower(Callback_t callback) noexcept override;
+    void getActuralRequestFrequency(Callback_t callback) noexcept override;
+    void getTemperature(Callback_t callback, zes_temp_sensors_t type) noexcept override;
+    void getMemoryUsedUtilization(Callback_t callback) noexcept override;
+    void getMemoryThroughputAndBandwidth(Callback_t callback) noexcept override;
+    void getGPUUtilization(Callback_t callback) noexcept override;
+    void getEngineUtilization(Callback_t callback) noexcept override;
+    void getEngineGroupUtilization(Callback_t callback, zes_engine_group_t engine_group_type) noexcept override;
+    void getEnergy(Callback_t callback) noexcept override;
+    void getEuActiveStallIdle(Callback_t callback, MeasurementType type) noexcept override;
+    void getRasErrorOnSubdevice(Callback_t callback) noexcept override;
+    void getFrequencyThrottle(Callback_t callback) noexcept override;
+    void getFrequencyThrottleReason(Callback_t callback) noexcept override;
+    void getPCIeReadThroughput(Callback_t callback) noexcept override;
+    void getPCIeWriteThroughput(Callback_t callback) noexcept override;
+    void getPCIeRead(Callback_t callback) noexcept override;
+    void getPCIeWrite(Callback_t callback) noexcept override;
+    void getFabricThroughput(Callback_t callback) noexcept override;
+    void getPerfMetrics(Callback_t callback) noexcept override;
+    void getVfEngineUtilization(Callback_t callback) noexcept override;
+
+   private:
+    struct SimulatedEngine {
+        uint64_t handle;
+        zes_engine_group_t type;
+        uint32_t tile;
+        // the share of the load of the tile the engine is busy
+        double load_factor;
+        // in microseconds
+        uint64_t active_time;
+    };
+
+    struct SimulatedFabricPort {
+        uint64_t handle;
+        uint32_t tile;
+        uint32_t remote_fabric_id;
+        uint32_t remote_attach_id;
+        // in bytes
+        uint64_t rx_counter;
+        uint64_t tx_counter;
+    };
+
+    struct SimulatedTile {
+        // 0 - 1
+        double load;
+        // in W
+        double power;
+        // in MHz
+        double frequency;
+        // in Celsius
+        double temperature;
+        double memory_temperature;
+        // in bytes
+        uint64_t memory_used;
+        // in microjoules
+        uint64_t energy;
+        // in bytes
+        uint64_t memory_read;
+        uint64_t memory_write;
+        // in bytes per second
+        double memory_read_rate;
+        double memory_write_rate;
+        double pcie_read_rate;
+        double pcie_write_rate;
+        // in bytes
+        uint64_t pcie_read;
+        uint64_t pcie_write;
+        uint64_t throttle_time;
+    };
+
+    // move the simulation to now, in microseconds, the caller holds simulation_mutex
+    void advance(uint64_t now);
+
+    // the utilization of a tile at time t, in seconds
+    double loadAt(uint32_t tile, double t);
+
+    std::shared_ptr<MeasurementData> engineGroupData(zes_engine_group_t engine_group_type, uint64_t now);
+
+    static void unsupported(Callback_t& callback, const char* metric);
+
+    std::mutex simulation_mutex;
+
+    std::mt19937_64 random;
+
+    uint32_t tile_count;
+
+    uint32_t fabric_id;
+
+    // the period and phase of the load wave
+    double period;
+
+    double phase;
+
+    // the last time the simulation was moved to, in microseconds
+    uint64_t last_time;
+
+    std::vector<SimulatedTile> tiles;
+
+    std::vector<SimulatedEngine> engines;
+
+    // one ZES_ENGINE_GROUP_ALL engine per tile for the GPU utilization
+    std::vector<SimulatedEngine> all_engines;
+
+    std::vector<SimulatedFabricPort> fabric_ports;
+};
+
+} // end namespace xpum
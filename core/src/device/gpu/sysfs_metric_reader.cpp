@@ -0,0 +1,350 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file sysfs_metric_reader.cpp
+ */
+
+#include "sysfs_metric_reader.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+// the window to derive the power from if no recent energy reading exists
+static const std::chrono::milliseconds POWER_SAMPLE_WINDOW(50);
+
+// an energy reading of the previous read is used if it is within this range
+static const std::chrono::milliseconds POWER_REUSE_MIN(10);
+static const std::chrono::milliseconds POWER_REUSE_MAX(10000);
+
+static std::string readFirstLine(const std::string& path) {
+    std::ifstream ifs(path);
+    std::string line;
+    if (ifs.good()) {
+        std::getline(ifs, line);
+    }
+    line.erase(line.find_last_not_of(" \n\r\t") + 1);
+    return line;
+}
+
+static std::vector<std::string> listDir(const std::string& path, const char* prefix) {
+    std::vector<std::string> names;
+    DIR* dir = opendir(path.c_str());
+    if (dir == NULL) {
+        return names;
+    }
+    struct dirent* ent;
+    size_t len = strlen(prefix);
+    while ((ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.' || strncmp(ent->d_name, prefix, len) != 0) {
+            continue;
+        }
+        names.push_back(ent->d_name);
+    }
+    closedir(dir);
+    return names;
+}
+
+// the number after prefix in name, e.g. 1 of "gt1", -1 if there is none
+static int32_t indexAfter(const std::string& name, const std::string& prefix) {
+    auto pos = name.find(prefix);
+    if (pos == std::string::npos) {
+        return -1;
+    }
+    const char* begin = name.c_str() + pos + prefix.length();
+    char* end;
+    long index = strtol(begin, &end, 10);
+    if (end == begin || index < 0) {
+        return -1;
+    }
+    return (int32_t)index;
+}
+
+SysfsMetricReader::SysfsFile::~SysfsFile() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool SysfsMetricReader::SysfsFile::open(const std::string& path) {
+    if (fd >= 0) {
+        return true;
+    }
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    return fd >= 0;
+}
+
+bool SysfsMetricReader::SysfsFile::read(uint64_t& value) const {
+    if (fd < 0) {
+        return false;
+    }
+    // sysfs regenerates the content of an attribute on a read at offset 0
+    char buf[32];
+    ssize_t cnt = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (cnt <= 0) {
+        return false;
+    }
+    buf[cnt] = 0;
+    char* end;
+    value = strtoull(buf, &end, 10);
+    return end != buf;
+}
+
+SysfsMetricReader& SysfsMetricReader::instance() {
+    static SysfsMetricReader reader;
+    return reader;
+}
+
+void SysfsMetricReader::openHwmon(Gpu& gpu, const std::string& device_path) {
+    std::string hwmon_path = device_path + "/hwmon";
+    for (auto& hwmon : listDir(hwmon_path, "hwmon")) {
+        std::string path = hwmon_path + "/" + hwmon;
+        std::string name = readFirstLine(path + "/name");
+        int32_t tile_id;
+        if (name == "i915" || name == "xe") {
+            tile_id = -1;
+        } else {
+            // i915 names the hwmon of a tile like i915_gt0
+            tile_id = indexAfter(name, "gt");
+            if (tile_id < 0) {
+                continue;
+            }
+        }
+        Node& node = gpu.nodes[tile_id];
+        node.energy_file.open(path + "/energy1_input");
+        for (auto& input : listDir(path, "temp")) {
+            auto pos = input.find("_input");
+            if (pos == std::string::npos) {
+                continue;
+            }
+            std::string label = readFirstLine(path + "/" + input.substr(0, pos) + "_label");
+            if (label == "pkg" || label.empty()) {
+                node.temperature.open(path + "/" + input);
+            } else if (label == "vram") {
+                node.memory_temperature.open(path + "/" + input);
+            }
+        }
+    }
+}
+
+void SysfsMetricReader::openFrequencies(Gpu& gpu, const std::string& card_path) {
+    // i915
+    if (access((card_path + "/gt_act_freq_mhz").c_str(), F_OK) == 0) {
+        gpu.nodes[-1].frequency.open(card_path + "/gt_act_freq_mhz");
+        for (auto& gt : listDir(card_path + "/gt", "gt")) {
+            int32_t tile_id = indexAfter(gt, "gt");
+            if (tile_id >= 0) {
+                gpu.nodes[tile_id].frequency.open(card_path + "/gt/" + gt + "/rps_act_freq_mhz");
+            }
+        }
+        gpu.nodes[-1].memory_total.open(card_path + "/lmem_total_bytes");
+        gpu.nodes[-1].memory_avail.open(card_path + "/lmem_avail_bytes");
+        return;
+    }
+
+    // xe, the primary GT of a tile has the lowest id
+    std::string device_path = card_path + "/device";
+    for (auto& tile : listDir(device_path, "tile")) {
+        int32_t tile_id = indexAfter(tile, "tile");
+        if (tile_id < 0) {
+            continue;
+        }
+        std::string tile_path = device_path + "/" + tile;
+        int32_t primary = -1;
+        for (auto& gt : listDir(tile_path, "gt")) {
+            int32_t gt_id = indexAfter(gt, "gt");
+            if (gt_id >= 0 && (primary < 0 || gt_id < primary) &&
+                access((tile_path + "/" + gt + "/freq0/act_freq").c_str(), F_OK) == 0) {
+                primary = gt_id;
+            }
+        }
+        if (primary < 0) {
+            continue;
+        }
+        std::string freq_path = tile_path + "/gt" + std::to_string(primary) + "/freq0/act_freq";
+        gpu.nodes[tile_id].frequency.open(freq_path);
+        if (tile_id == 0) {
+            gpu.nodes[-1].frequency.open(freq_path);
+        }
+    }
+}
+
+std::shared_ptr<SysfsMetricReader::Gpu> SysfsMetricReader::openGpu(const std::string& bdf) {
+    auto it = gpus.find(bdf);
+    if (it != gpus.end()) {
+        return it->second;
+    }
+
+    std::string device_path = "/sys/bus/pci/devices/" + bdf;
+    if (readFirstLine(device_path + "/vendor") != "0x8086") {
+        return nullptr;
+    }
+    auto cards = listDir(device_path + "/drm", "card");
+    if (cards.empty()) {
+        return nullptr;
+    }
+
+    auto gpu = std::make_shared<Gpu>();
+    gpu->nodes[-1];
+    openHwmon(*gpu, device_path);
+    openFrequencies(*gpu, device_path + "/drm/" + cards[0]);
+    XPUM_LOG_DEBUG("[{}] {} nodes opened for sysfs metrics", bdf, gpu->nodes.size());
+    gpus[bdf] = gpu;
+    return gpu;
+}
+
+void SysfsMetricReader::readEnergy(Node& node) {
+    node.has_energy = node.energy_file.read(node.energy);
+    node.energy_time = std::chrono::steady_clock::now();
+}
+
+uint32_t SysfsMetricReader::fillStats(Node& node, xpum_device_stats_data_t* dataList) {
+    uint32_t count = 0;
+    uint64_t value;
+
+    if (node.has_energy) {
+        // energy1_input is in microjoules
+        xpum_device_stats_data_t& energy = dataList[count++];
+        energy.metricsType = XPUM_STATS_ENERGY;
+        energy.isCounter = true;
+        energy.scale = 1;
+        energy.value = node.energy / 1000;
+        energy.accumulated = energy.value;
+
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(node.energy_time - node.last_energy_time).count();
+        if (node.has_last_energy && us > 0 && node.energy >= node.last_energy) {
+            xpum_device_stats_data_t& power = dataList[count++];
+            power.metricsType = XPUM_STATS_POWER;
+            power.isCounter = false;
+            power.scale = Configuration::DEFAULT_MEASUREMENT_DATA_SCALE;
+            power.value = power.scale * (node.energy - node.last_energy) / us;
+            power.min = power.avg = power.max = power.value;
+        }
+        node.has_last_energy = true;
+        node.last_energy = node.energy;
+        node.last_energy_time = node.energy_time;
+    }
+
+    // the temperatures are in millidegrees Celsius, the frequencies in MHz
+    struct {
+        const SysfsFile& file;
+        xpum_stats_type_t type;
+        uint32_t divisor;
+        uint32_t scale;
+    } gauges[] = {
+        {node.temperature, XPUM_STATS_GPU_CORE_TEMPERATURE, 10, 100},
+        {node.memory_temperature, XPUM_STATS_MEMORY_TEMPERATURE, 10, 100},
+        {node.frequency, XPUM_STATS_GPU_FREQUENCY, 1, 1},
+    };
+    for (auto& gauge : gauges) {
+        if (!gauge.file.read(value)) {
+            continue;
+        }
+        xpum_device_stats_data_t& data = dataList[count++];
+        data.metricsType = gauge.type;
+        data.isCounter = false;
+        data.scale = gauge.scale;
+        data.value = value / gauge.divisor;
+        data.min = data.avg = data.max = data.value;
+    }
+
+    uint64_t avail;
+    if (node.memory_total.read(value) && node.memory_avail.read(avail) && value >= avail) {
+        xpum_device_stats_data_t& data = dataList[count++];
+        data.metricsType = XPUM_STATS_MEMORY_USED;
+        data.isCounter = false;
+        data.scale = 1;
+        data.value = value - avail;
+        data.min = data.avg = data.max = data.value;
+    }
+    return count;
+}
+
+xpum_result_t SysfsMetricReader::read(const std::vector<std::string>& bdfs, xpum_device_stats_t dataList[], uint32_t* count) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<std::shared_ptr<Gpu>> targets;
+    for (auto& bdf : bdfs) {
+        targets.push_back(openGpu(bdf));
+    }
+
+    // one sleep for all GPUs whose previous energy reading can not be used
+    std::vector<Node*> to_sample;
+    auto now = std::chrono::steady_clock::now();
+    for (auto& gpu : targets) {
+        if (gpu == nullptr) {
+            continue;
+        }
+        for (auto& entry : gpu->nodes) {
+            Node& node = entry.second;
+            if (!node.energy_file.isOpen()) {
+                continue;
+            }
+            auto age = now - node.last_energy_time;
+            if (!node.has_last_energy || age < POWER_REUSE_MIN || age > POWER_REUSE_MAX) {
+                to_sample.push_back(&node);
+            }
+        }
+    }
+    if (!to_sample.empty()) {
+        for (auto node : to_sample) {
+            readEnergy(*node);
+            node->has_last_energy = node->has_energy;
+            node->last_energy = node->energy;
+            node->last_energy_time = node->energy_time;
+        }
+        std::this_thread::sleep_for(POWER_SAMPLE_WINDOW);
+    }
+
+    uint32_t position = 0;
+    for (uint32_t index = 0; index < targets.size(); index++) {
+        auto& gpu = targets[index];
+        // the device level entry is always stored, so entries of GPU i have device id i
+        if (position >= *count) {
+            return XPUM_BUFFER_TOO_SMALL;
+        }
+        xpum_device_stats_t& device_stats = dataList[position++];
+        device_stats = {};
+        device_stats.deviceId = index;
+        device_stats.isTileData = false;
+        if (gpu == nullptr) {
+            XPUM_LOG_DEBUG("[{}] is not an Intel GPU", bdfs[index]);
+            continue;
+        }
+        for (auto& entry : gpu->nodes) {
+            if (entry.second.energy_file.isOpen()) {
+                readEnergy(entry.second);
+            }
+        }
+        device_stats.count = fillStats(gpu->nodes[-1], device_stats.dataList);
+
+        for (auto& entry : gpu->nodes) {
+            if (entry.first < 0) {
+                continue;
+            }
+            if (position >= *count) {
+                return XPUM_BUFFER_TOO_SMALL;
+            }
+            xpum_device_stats_t& tile_stats = dataList[position++];
+            tile_stats = {};
+            tile_stats.deviceId = index;
+            tile_stats.isTileData = true;
+            tile_stats.tileId = entry.first;
+            tile_stats.count = fillStats(entry.second, tile_stats.dataList);
+        }
+    }
+    *count = position;
+    return XPUM_OK;
+}
+
+} // end namespace xpum
@@ -0,0 +1,108 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file sysfs_metric_reader.h
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "xpum_structs.h"
+
+namespace xpum {
+
+/*
+  SysfsMetricReader reads power, energy, temperature, frequency and memory
+  used of the GPUs from sysfs and hwmon, without Level Zero. It serves
+  xpumGetMetricsFromSysfs, which is polled by processes that do not want to
+  initialize Level Zero.
+
+  The files of a GPU are found and opened on the first read of that GPU and
+  stay open, later reads only pread them. Power is derived from two energy
+  readings: the one of the previous read is used if it is recent enough,
+  otherwise the energy of all requested GPUs is read again after one shared
+  sleep.
+*/
+class SysfsMetricReader {
+   public:
+    static SysfsMetricReader& instance();
+
+    /*
+      Read the metrics of the GPUs at the PCI addresses bdfs. For each GPU,
+      one device level entry followed by one entry per tile is stored in
+      dataList, with the index of the GPU in bdfs as device id. Addresses
+      that are not an Intel GPU are skipped.
+    */
+    xpum_result_t read(const std::vector<std::string>& bdfs, xpum_device_stats_t dataList[], uint32_t* count);
+
+   private:
+    class SysfsFile {
+       public:
+        SysfsFile() = default;
+
+        ~SysfsFile();
+
+        SysfsFile(const SysfsFile&) = delete;
+
+        SysfsFile& operator=(const SysfsFile&) = delete;
+
+        bool open(const std::string& path);
+
+        bool isOpen() const {
+            return fd >= 0;
+        }
+
+        bool read(uint64_t& value) const;
+
+       private:
+        int fd = -1;
+    };
+
+    // the files of the device (tile -1) or of a tile
+    struct Node {
+        SysfsFile energy_file;
+        SysfsFile temperature;
+        SysfsFile memory_temperature;
+        SysfsFile frequency;
+        SysfsFile memory_total;
+        SysfsFile memory_avail;
+
+        bool has_last_energy = false;
+        uint64_t last_energy = 0;
+        std::chrono::steady_clock::time_point last_energy_time;
+
+        // of the current read
+        bool has_energy = false;
+        uint64_t energy = 0;
+        std::chrono::steady_clock::time_point energy_time;
+    };
+
+    struct Gpu {
+        std::map<int32_t, Node> nodes;
+    };
+
+    SysfsMetricReader() = default;
+
+    // nullptr if bdf is not the address of an Intel GPU bound to i915 or xe
+    std::shared_ptr<Gpu> openGpu(const std::string& bdf);
+
+    static void openHwmon(Gpu& gpu, const std::string& device_path);
+
+    static void openFrequencies(Gpu& gpu, const std::string& card_path);
+
+    static void readEnergy(Node& node);
+
+    static uint32_t fillStats(Node& node, xpum_device_stats_data_t* dataList);
+
+    std::mutex mutex;
+
+    std::map<std::string, std::shared_ptr<Gpu>> gpus;
+};
+
+} // end namespace xpum
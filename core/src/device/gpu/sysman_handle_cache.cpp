@@ -0,0 +1,130 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file sysman_handle_cache.cpp
+ */
+
+#include "sysman_handle_cache.h"
+
+#include "infrastructure/handle_lock.h"
+
+namespace xpum {
+
+SysmanHandleCache& SysmanHandleCache::instance() {
+    static SysmanHandleCache cache;
+    return cache;
+}
+
+template <typename C>
+ze_result_t SysmanHandleCache::get(const zes_device_handle_t& device,
+                                   std::shared_ptr<std::vector<C>> DeviceComponents::*member,
+                                   const std::function<ze_result_t(uint32_t*, typename C::Handle*)>& enumerate,
+                                   const std::function<ze_result_t(C&)>& readProps,
+                                   std::vector<C>& components) {
+    {
+        std::lock_guard<std::mutex> lck(mutex);
+        auto it = devices.find(device);
+        if (it != devices.end() && it->second.*member != nullptr) {
+            components = *(it->second.*member);
+            return ZE_RESULT_SUCCESS;
+        }
+    }
+
+    uint32_t count = 0;
+    ze_result_t res;
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = enumerate(&count, nullptr));
+    if (res != ZE_RESULT_SUCCESS) {
+        return res;
+    }
+    std::vector<typename C::Handle> handles(count);
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, res = enumerate(&count, handles.data()));
+    if (res != ZE_RESULT_SUCCESS) {
+        return res;
+    }
+    handles.resize(count);
+
+    components.clear();
+    bool complete = true;
+    for (auto& handle : handles) {
+        C component = {};
+        component.handle = handle;
+        component.props_result = readProps(component);
+        complete = complete && component.props_result == ZE_RESULT_SUCCESS;
+        components.push_back(component);
+    }
+    if (complete) {
+        std::lock_guard<std::mutex> lck(mutex);
+        devices[device].*member = std::make_shared<std::vector<C>>(components);
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+ze_result_t SysmanHandleCache::getPowerDomains(const zes_device_handle_t& device, std::vector<PowerDomain>& domains) {
+    return get<PowerDomain>(
+        device, &DeviceComponents::power_domains,
+        [&](uint32_t* count, zes_pwr_handle_t* handles) { return zesDeviceEnumPowerDomains(device, count, handles); },
+        [](PowerDomain& domain) {
+            ze_result_t res;
+            XPUM_ZE_HANDLE_SHARED_LOCK(domain.handle, res = zesPowerGetProperties(domain.handle, &domain.props));
+            return res;
+        },
+        domains);
+}
+
+ze_result_t SysmanHandleCache::getFrequencyDomains(const zes_device_handle_t& device, std::vector<FrequencyDomain>& domains) {
+    return get<FrequencyDomain>(
+        device, &DeviceComponents::frequency_domains,
+        [&](uint32_t* count, zes_freq_handle_t* handles) { return zesDeviceEnumFrequencyDomains(device, count, handles); },
+        [](FrequencyDomain& domain) {
+            ze_result_t res;
+            XPUM_ZE_HANDLE_SHARED_LOCK(domain.handle, res = zesFrequencyGetProperties(domain.handle, &domain.props));
+            return res;
+        },
+        domains);
+}
+
+ze_result_t SysmanHandleCache::getTemperatureSensors(const zes_device_handle_t& device, std::vector<TemperatureSensor>& sensors) {
+    return get<TemperatureSensor>(
+        device, &DeviceComponents::temperature_sensors,
+        [&](uint32_t* count, zes_temp_handle_t* handles) { return zesDeviceEnumTemperatureSensors(device, count, handles); },
+        [](TemperatureSensor& sensor) {
+            ze_result_t res;
+            XPUM_ZE_HANDLE_SHARED_LOCK(sensor.handle, res = zesTemperatureGetProperties(sensor.handle, &sensor.props));
+            return res;
+        },
+        sensors);
+}
+
+ze_result_t SysmanHandleCache::getMemoryModules(const zes_device_handle_t& device, std::vector<MemoryModule>& modules) {
+    return get<MemoryModule>(
+        device, &DeviceComponents::memory_modules,
+        [&](uint32_t* count, zes_mem_handle_t* handles) { return zesDeviceEnumMemoryModules(device, count, handles); },
+        [](MemoryModule& module) {
+            ze_result_t res;
+            module.props.stype = ZES_STRUCTURE_TYPE_MEM_PROPERTIES;
+            XPUM_ZE_HANDLE_SHARED_LOCK(module.handle, res = zesMemoryGetProperties(module.handle, &module.props));
+            return res;
+        },
+        modules);
+}
+
+ze_result_t SysmanHandleCache::getRasErrorSets(const zes_device_handle_t& device, std::vector<RasErrorSet>& sets, std::mutex& ras_mutex) {
+    return get<RasErrorSet>(
+        device, &DeviceComponents::ras_error_sets,
+        [&](uint32_t* count, zes_ras_handle_t* handles) { return zesDeviceEnumRasErrorSets(device, count, handles); },
+        [&](RasErrorSet& set) {
+            std::lock_guard<std::mutex> lock(ras_mutex);
+            ze_result_t res;
+            set.props.stype = ZES_STRUCTURE_TYPE_RAS_PROPERTIES;
+            XPUM_ZE_HANDLE_SHARED_LOCK(set.handle, res = zesRasGetProperties(set.handle, &set.props));
+            return res;
+        },
+        sets);
+}
+
+void SysmanHandleCache::release(const zes_device_handle_t& device) {
+    std::lock_guard<std::mutex> lck(mutex);
+    devices.erase(device);
+}
+
+} // end namespace xpum
@@ -0,0 +1,95 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file sysman_handle_cache.h
+ */
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "level_zero/zes_api.h"
+
+namespace xpum {
+
+/*
+  SysmanHandleCache keeps the Sysman component handles of the devices with
+  their properties (onSubdevice, subdeviceId, physicalSize, sensor type, ...),
+  which do not change while a device handle is valid. The metric getters of
+  GPUDeviceStub iterate over them instead of enumerating the components and
+  reading their properties on every sample, so a sample only calls the
+  *GetState and *GetEnergyCounter functions.
+
+  The components of a device are enumerated on their first request. A list
+  with a failed property query is returned but not kept, so it is read again
+  on the next request. release() drops the components of a device handle
+  that is removed or reset.
+*/
+class SysmanHandleCache {
+   public:
+    template <typename H, typename P>
+    struct Component {
+        typedef H Handle;
+
+        H handle;
+
+        P props;
+
+        // the result of the property query of the component
+        ze_result_t props_result;
+    };
+
+    typedef Component<zes_pwr_handle_t, zes_power_properties_t> PowerDomain;
+
+    typedef Component<zes_freq_handle_t, zes_freq_properties_t> FrequencyDomain;
+
+    typedef Component<zes_temp_handle_t, zes_temp_properties_t> TemperatureSensor;
+
+    typedef Component<zes_mem_handle_t, zes_mem_properties_t> MemoryModule;
+
+    typedef Component<zes_ras_handle_t, zes_ras_properties_t> RasErrorSet;
+
+    static SysmanHandleCache& instance();
+
+    // the result of the enumeration, the components are in the order enumerated
+    ze_result_t getPowerDomains(const zes_device_handle_t& device, std::vector<PowerDomain>& domains);
+
+    ze_result_t getFrequencyDomains(const zes_device_handle_t& device, std::vector<FrequencyDomain>& domains);
+
+    ze_result_t getTemperatureSensors(const zes_device_handle_t& device, std::vector<TemperatureSensor>& sensors);
+
+    ze_result_t getMemoryModules(const zes_device_handle_t& device, std::vector<MemoryModule>& modules);
+
+    // the RAS properties are read holding ras_mutex, which serializes the RAS APIs
+    ze_result_t getRasErrorSets(const zes_device_handle_t& device, std::vector<RasErrorSet>& sets, std::mutex& ras_mutex);
+
+    void release(const zes_device_handle_t& device);
+
+   private:
+    struct DeviceComponents {
+        std::shared_ptr<std::vector<PowerDomain>> power_domains;
+        std::shared_ptr<std::vector<FrequencyDomain>> frequency_domains;
+        std::shared_ptr<std::vector<TemperatureSensor>> temperature_sensors;
+        std::shared_ptr<std::vector<MemoryModule>> memory_modules;
+        std::shared_ptr<std::vector<RasErrorSet>> ras_error_sets;
+    };
+
+    SysmanHandleCache() = default;
+
+    template <typename C>
+    ze_result_t get(const zes_device_handle_t& device,
+                    std::shared_ptr<std::vector<C>> DeviceComponents::*member,
+                    const std::function<ze_result_t(uint32_t*, typename C::Handle*)>& enumerate,
+                    const std::function<ze_result_t(C&)>& readProps,
+                    std::vector<C>& components);
+
+    std::mutex mutex;
+
+    std::map<zes_device_handle_t, DeviceComponents> devices;
+};
+
+} // end namespace xpum
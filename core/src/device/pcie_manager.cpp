@@ -6,17 +6,30 @@
 
 #include "pcie_manager.h"
 
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
 #include "infrastructure/configuration.h"
 #include "infrastructure/exception/base_exception.h"
 #include "infrastructure/logger.h"
+#include "infrastructure/telemetry_checkpoint.h"
+#include "infrastructure/thread_factory.h"
+#include "infrastructure/utility.h"
 #include "pcm-iio-gpu.h"
 
 namespace xpum {
 
 PCIeManager::PCIeManager() {
+    this->slot_count.store(0);
+    this->daemon_segment.header = nullptr;
+    this->daemon_segment.size = 0;
+    this->attached.store(false);
     this->initialized.store(false);
     this->interrupted.store(false);
     this->stopped.store(false);
+    this->has_baselines.store(false);
+    this->host_sampled.store(false);
     XPUM_LOG_DEBUG("PCIeManager()");
 }
 
@@ -26,10 +39,16 @@ PCIeManager::~PCIeManager() {
 
 void PCIeManager::init() {
     XPUM_LOG_DEBUG("start PCIeManager init");
+    // xpumd owns the IIO PMU, programming it again would disturb its samples
+    if (Configuration::getXPUMMode() == "xpu-smi" && attachToDaemon()) {
+        XPUM_LOG_INFO("PCIe counters are read from xpumd");
+        return;
+    }
+    registerCheckpointSection();
     if (std::system("modprobe msr") != 0) {
         XPUM_LOG_ERROR("Failed to load msr kernel module");
     }
-    auto pcie_thread = std::thread([this]() {
+    auto pcie_thread = ThreadFactory::create("xpum-pcie", [this]() {
         try {
             int res = pcm_iio_gpu_init();
             if (res != 0) {
@@ -38,34 +57,33 @@ void PCIeManager::init() {
                 XPUM_LOG_ERROR("Failed to init pcm-iio-gpu");
                 return;
             }
-            std::vector<std::string> datas = pcm_iio_gpu_query();
-            while (!interrupted.load() && !datas.empty()) {
-                for (auto data : datas) {
-                    std::stringstream sstream(data);
-                    std::vector<std::string> line;
-                    std::string item;
-                    while (getline(sstream, item, ',')) {
-                        auto pos = item.find('=');
-                        line.push_back(item.substr(pos + 1));
-                    }
-                    // Note : sample interval is 100ms and unit is B/s
-                    auto read_value = std::stoull(line[2].c_str());
-                    pcie_read_throughputs[line[1]] = read_value / 1000;
-                    if (pcie_reads.find(line[1]) == pcie_reads.end()) {
-                        pcie_reads[line[1]] = 0;
-                    }
-                    pcie_reads[line[1]] += read_value * 0.1;
-
-                    auto write_value = std::stoull(line[3].c_str());
-                    pcie_write_throughputs[line[1]] = write_value / 1000;
-                    if (pcie_writes.find(line[1]) == pcie_writes.end()) {
-                        pcie_writes[line[1]] = 0;
-                    }
-                    pcie_writes[line[1]] += write_value * 0.1;
+            bool host = false;
+            if (Configuration::HOST_TELEMETRY) {
+                host = pcm_iio_gpu_enable_host_counters() == 0;
+                if (!host) {
+                    XPUM_LOG_ERROR("Failed to enable the host counters of pcm-iio-gpu");
+                }
+            }
+            std::vector<pcm_iio_gpu_counter> counters;
+            std::vector<pcm_host_socket_counter> host_socket_counters;
+            std::vector<pcm_iio_stack_counter> host_stack_counters;
+            auto last = std::chrono::steady_clock::now();
+            res = pcm_iio_gpu_query_counters(counters, Configuration::PCIE_SAMPLING_INTERVAL);
+            while (!interrupted.load() && res == 0 && !counters.empty()) {
+                // the bytes are the throughputs over the time really elapsed, which is longer than the interval under load
+                auto now = std::chrono::steady_clock::now();
+                double elapsed = std::chrono::duration<double>(now - last).count();
+                last = now;
+                for (auto& counter : counters) {
+                    publish(counter, elapsed);
+                }
+                // the host counters are read around the same window as the PCIe counters
+                if (host && pcm_iio_gpu_query_host_counters(host_socket_counters, host_stack_counters) == 0) {
+                    publishHost(host_socket_counters, host_stack_counters, elapsed);
                 }
                 if (!initialized.load())
                     initialized.store(true);
-                datas = pcm_iio_gpu_query();
+                res = pcm_iio_gpu_query_counters(counters, Configuration::PCIE_SAMPLING_INTERVAL);
             }
         } catch (std::exception& e) {
             interrupted.store(true);
@@ -74,13 +92,24 @@ void PCIeManager::init() {
         stopped.store(true);
     });
     pcie_thread.detach();
+    XPUM_LOG_DEBUG("PCIeManager init done");
+}
+
+void PCIeManager::waitForFirstSample() {
+    if (attached.load()) {
+        return;
+    }
     while (!stopped.load() && !interrupted.load() && !initialized.load()) {
         std::this_thread::sleep_for(std::chrono::milliseconds(50));
     }
-    XPUM_LOG_DEBUG("PCIeManager init done");
 }
 
 void PCIeManager::close() {
+    if (attached.load()) {
+        attached.store(false);
+        xpumTelemetryShmClose(&daemon_segment);
+        return;
+    }
     if (!initialized.load()) {
         return;
     }
@@ -88,43 +117,268 @@ void PCIeManager::close() {
     while (!stopped.load()) {
         std::this_thread::sleep_for(std::chrono::milliseconds(50));
     }
-    pcie_read_throughputs.clear();
-    pcie_write_throughputs.clear();
+    slot_count.store(0);
+}
+
+void PCIeManager::publish(const pcm_iio_gpu_counter& counter, double elapsedSeconds) {
+    uint32_t key = toBdfKey(counter.bus, counter.device, counter.function);
+    uint32_t count = slot_count.load(std::memory_order_relaxed);
+    uint32_t i = 0;
+    while (i < count && slots[i].key != key) {
+        i++;
+    }
+    if (i == count) {
+        if (count == max_devices) {
+            return;
+        }
+        auto& slot = slots[i];
+        slot.seq.store(0, std::memory_order_relaxed);
+        slot.key = key;
+        slot.read_total = 0;
+        slot.write_total = 0;
+        slot_count.store(count + 1, std::memory_order_release);
+    }
+
+    auto& slot = slots[i];
+    if (has_baselines.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(baseline_mutex);
+        auto iter = baselines.find(key);
+        if (iter != baselines.end()) {
+            slot.read_total += iter->second.first;
+            slot.write_total += iter->second.second;
+            baselines.erase(iter);
+            has_baselines.store(!baselines.empty(), std::memory_order_relaxed);
+        }
+    }
+    slot.read_total += counter.read_bytes_per_sec * elapsedSeconds;
+    slot.write_total += counter.write_bytes_per_sec * elapsedSeconds;
+
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.read_throughput.store(counter.read_bytes_per_sec / 1000, std::memory_order_relaxed);
+    slot.write_throughput.store(counter.write_bytes_per_sec / 1000, std::memory_order_relaxed);
+    slot.read.store((uint64_t)slot.read_total, std::memory_order_relaxed);
+    slot.write.store((uint64_t)slot.write_total, std::memory_order_relaxed);
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+void PCIeManager::publishHost(const std::vector<pcm_host_socket_counter>& sockets, const std::vector<pcm_iio_stack_counter>& stacks, double elapsedSeconds) {
+    uint64_t timestamp = Utility::getCurrentMillisecond();
+    std::lock_guard<std::mutex> lock(host_mutex);
+    // the sockets and the stacks do not change, the totals are kept by position
+    host_socket_totals.resize(sockets.size());
+    host_sockets.resize(sockets.size());
+    for (size_t i = 0; i < sockets.size(); i++) {
+        auto& counter = sockets[i];
+        auto& totals = host_socket_totals[i];
+        totals[0] += counter.dram_read_bytes_per_sec * elapsedSeconds;
+        totals[1] += counter.dram_write_bytes_per_sec * elapsedSeconds;
+        totals[2] += counter.upi_incoming_bytes_per_sec * elapsedSeconds;
+        auto& data = host_sockets[i];
+        data.socketId = counter.socket;
+        data.timestamp = timestamp;
+        data.dramReadThroughput = counter.dram_read_bytes_per_sec / 1000;
+        data.dramWriteThroughput = counter.dram_write_bytes_per_sec / 1000;
+        data.dramRead = (uint64_t)totals[0];
+        data.dramWrite = (uint64_t)totals[1];
+        data.upiIncomingThroughput = counter.upi_incoming_bytes_per_sec / 1000;
+        data.upiIncoming = (uint64_t)totals[2];
+        data.upiUtilization = counter.upi_utilization;
+    }
+    host_stack_totals.resize(stacks.size());
+    host_stacks.resize(stacks.size());
+    for (size_t i = 0; i < stacks.size(); i++) {
+        auto& counter = stacks[i];
+        auto& totals = host_stack_totals[i];
+        totals[0] += counter.read_bytes_per_sec * elapsedSeconds;
+        totals[1] += counter.write_bytes_per_sec * elapsedSeconds;
+        auto& data = host_stacks[i];
+        data.socketId = counter.socket;
+        data.stackId = counter.stack;
+        data.timestamp = timestamp;
+        data.readThroughput = counter.read_bytes_per_sec / 1000;
+        data.writeThroughput = counter.write_bytes_per_sec / 1000;
+        data.read = (uint64_t)totals[0];
+        data.write = (uint64_t)totals[1];
+    }
+    host_sampled.store(true);
+}
+
+bool PCIeManager::getHostSocketTelemetry(std::vector<xpum_host_socket_telemetry_t>& sockets) {
+    if (!host_sampled.load() || interrupted.load()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(host_mutex);
+    sockets = host_sockets;
+    return true;
+}
+
+bool PCIeManager::getHostIioStackTelemetry(std::vector<xpum_host_iio_stack_telemetry_t>& stacks) {
+    if (!host_sampled.load() || interrupted.load()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(host_mutex);
+    stacks = host_stacks;
+    return true;
+}
+
+bool PCIeManager::parseBdfKey(const std::string& bdf, uint32_t& bdfKey) {
+    uint32_t domain, bus, device, function;
+    if (std::sscanf(bdf.c_str(), "%x:%x:%x.%x", &domain, &bus, &device, &function) != 4) {
+        return false;
+    }
+    bdfKey = toBdfKey(bus, device, function);
+    return true;
+}
+
+void PCIeManager::addBaseline(uint32_t bdfKey, uint64_t read, uint64_t write) {
+    std::lock_guard<std::mutex> lock(baseline_mutex);
+    auto& baseline = baselines[bdfKey];
+    baseline.first += read;
+    baseline.second += write;
+    has_baselines.store(true, std::memory_order_relaxed);
+}
+
+void PCIeManager::registerCheckpointSection() {
+    TelemetryCheckpoint::instance().registerSection(
+        "pcie",
+        [this](std::vector<CheckpointRecord>& records) {
+            for (auto& device : TelemetryCheckpoint::instance().getDeviceBdfs()) {
+                uint32_t key;
+                if (!parseBdfKey(device.second, key)) {
+                    continue;
+                }
+                PCIeCounters counters{};
+                bool sampled = readCounters(key, counters);
+                // a baseline not taken by a sample yet is kept for the next run
+                std::unique_lock<std::mutex> lock(baseline_mutex);
+                auto iter = baselines.find(key);
+                if (iter != baselines.end()) {
+                    counters.read += (uint64_t)iter->second.first;
+                    counters.write += (uint64_t)iter->second.second;
+                } else if (!sampled) {
+                    continue;
+                }
+                lock.unlock();
+                CheckpointRecord record;
+                record.device_id = device.first;
+                record.values[0] = counters.read;
+                record.values[1] = counters.write;
+                records.push_back(record);
+            }
+        },
+        [this](const std::vector<CheckpointRecord>& records) {
+            auto& device_bdfs = TelemetryCheckpoint::instance().getDeviceBdfs();
+            for (auto& record : records) {
+                auto iter = device_bdfs.find(record.device_id);
+                uint32_t key;
+                if (iter != device_bdfs.end() && parseBdfKey(iter->second, key)) {
+                    addBaseline(key, record.values[0], record.values[1]);
+                }
+            }
+        });
+}
+
+bool PCIeManager::attachToDaemon() {
+    if (xpumTelemetryShmOpen(&daemon_segment) != XPUM_TELEMETRY_SHM_OK) {
+        return false;
+    }
+    // the segment of a daemon that does not sample PCIe has no PCIe entries
+    xpum_telemetry_shm_pcie_entry_t entries[XPUM_TELEMETRY_SHM_MAX_PCIE_ENTRIES];
+    uint32_t count = XPUM_TELEMETRY_SHM_MAX_PCIE_ENTRIES;
+    if (xpumTelemetryShmReadPCIe(&daemon_segment, entries, &count, nullptr) != XPUM_TELEMETRY_SHM_OK || count == 0) {
+        xpumTelemetryShmClose(&daemon_segment);
+        return false;
+    }
+    attached.store(true);
+    return true;
+}
+
+bool PCIeManager::readDaemonCounters(uint32_t bdfKey, PCIeCounters& counters) {
+    xpum_telemetry_shm_pcie_entry_t entries[XPUM_TELEMETRY_SHM_MAX_PCIE_ENTRIES];
+    uint32_t count = XPUM_TELEMETRY_SHM_MAX_PCIE_ENTRIES;
+    if (xpumTelemetryShmReadPCIe(&daemon_segment, entries, &count, nullptr) != XPUM_TELEMETRY_SHM_OK) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (toBdfKey(entries[i].bus, entries[i].device, entries[i].function) == bdfKey) {
+            counters.read_throughput = entries[i].readThroughput;
+            counters.write_throughput = entries[i].writeThroughput;
+            counters.read = entries[i].read;
+            counters.write = entries[i].write;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PCIeManager::readCounters(uint32_t bdfKey, PCIeCounters& counters) {
+    if (attached.load()) {
+        return readDaemonCounters(bdfKey, counters);
+    }
+    if (this->interrupted == true) {
+        return false;
+    }
+    uint32_t count = slot_count.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++) {
+        auto& slot = slots[i];
+        if (slot.key != bdfKey) {
+            continue;
+        }
+        while (true) {
+            uint32_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            counters.read_throughput = slot.read_throughput.load(std::memory_order_relaxed);
+            counters.write_throughput = slot.write_throughput.load(std::memory_order_relaxed);
+            counters.read = slot.read.load(std::memory_order_relaxed);
+            counters.write = slot.write.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == seq) {
+                // seq is 0 until the first sample is written
+                return seq != 0;
+            }
+        }
+    }
+    return false;
 }
 
-uint64_t PCIeManager::getLatestPCIeReadThroughput(std::string bdf) {
-    if (this->interrupted == true ||
-        pcie_read_throughputs.find(bdf) == pcie_read_throughputs.end()) {
+uint64_t PCIeManager::getLatestPCIeReadThroughput(uint32_t bdfKey) {
+    PCIeCounters counters;
+    if (!readCounters(bdfKey, counters)) {
         throw BaseException("get PCIe read throughput error");
     }
 
-    return pcie_read_throughputs[bdf];
+    return counters.read_throughput;
 }
 
-uint64_t PCIeManager::getLatestPCIeWriteThroughput(std::string bdf) {
-    if (this->interrupted == true ||
-        pcie_write_throughputs.find(bdf) == pcie_write_throughputs.end()) {
+uint64_t PCIeManager::getLatestPCIeWriteThroughput(uint32_t bdfKey) {
+    PCIeCounters counters;
+    if (!readCounters(bdfKey, counters)) {
         throw BaseException("get PCIe write throughput error");
     }
 
-    return pcie_write_throughputs[bdf];
+    return counters.write_throughput;
 }
 
-uint64_t PCIeManager::getLatestPCIeRead(std::string bdf) {
-    if (this->interrupted == true ||
-        pcie_reads.find(bdf) == pcie_reads.end()) {
+uint64_t PCIeManager::getLatestPCIeRead(uint32_t bdfKey) {
+    PCIeCounters counters;
+    if (!readCounters(bdfKey, counters)) {
         throw BaseException("get PCIe read error");
     }
 
-    return pcie_reads[bdf];
+    return counters.read;
 }
 
-uint64_t PCIeManager::getLatestPCIeWrite(std::string bdf) {
-    if (this->interrupted == true ||
-        pcie_writes.find(bdf) == pcie_writes.end()) {
+uint64_t PCIeManager::getLatestPCIeWrite(uint32_t bdfKey) {
+    PCIeCounters counters;
+    if (!readCounters(bdfKey, counters)) {
         throw BaseException("get PCIe write error");
     }
 
-    return pcie_writes[bdf];
+    return counters.write;
 }
 } // namespace xpum
\ No newline at end of file
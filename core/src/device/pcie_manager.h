@@ -8,16 +8,22 @@
 
 #include <array>
 #include <atomic>
+#include <cstdint>
 #include <cstdlib>
 #include <exception>
-#include <fstream>
-#include <iostream>
 #include <map>
-#include <sstream>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "infrastructure/init_close_interface.h"
+#include "xpum_structs.h"
+#include "xpum_telemetry_shm.h"
+
+struct pcm_iio_gpu_counter;
+struct pcm_host_socket_counter;
+struct pcm_iio_stack_counter;
 
 namespace xpum {
 
@@ -27,25 +33,102 @@ class PCIeManager : InitCloseInterface {
 
     virtual ~PCIeManager();
 
+    // start the sampling thread of pcm-iio-gpu, the counters are there after waitForFirstSample()
     void init() override;
 
     void close() override;
 
-    uint64_t getLatestPCIeReadThroughput(std::string bdf);
+    // wait until pcm-iio-gpu produces its first sample or fails, which takes a sampling interval
+    void waitForFirstSample();
+
+    // the key of a device in the PCIe counters, the PCI domain is not used by pcm-iio-gpu
+    static uint32_t toBdfKey(uint32_t bus, uint32_t device, uint32_t function) {
+        return (bus & 0xff) << 8 | (device & 0x1f) << 3 | (function & 0x7);
+    }
+
+    uint64_t getLatestPCIeReadThroughput(uint32_t bdfKey);
+
+    uint64_t getLatestPCIeWriteThroughput(uint32_t bdfKey);
 
-    uint64_t getLatestPCIeWriteThroughput(std::string bdf);
+    uint64_t getLatestPCIeRead(uint32_t bdfKey);
 
-    uint64_t getLatestPCIeRead(std::string bdf);
+    uint64_t getLatestPCIeWrite(uint32_t bdfKey);
 
-    uint64_t getLatestPCIeWrite(std::string bdf);
+    // the key of a device by its PCI address, like 0000:4d:00.0
+    static bool parseBdfKey(const std::string& bdf, uint32_t& bdfKey);
+
+    // the bytes counted before a restart of xpumd, they are added to the counters of the device
+    void addBaseline(uint32_t bdfKey, uint64_t read, uint64_t write);
+
+    // the host telemetry of the last sampling window, false if the host counters are not sampled
+    bool getHostSocketTelemetry(std::vector<xpum_host_socket_telemetry_t>& sockets);
+
+    bool getHostIioStackTelemetry(std::vector<xpum_host_iio_stack_telemetry_t>& stacks);
 
    private:
-    std::map<std::string, uint64_t> pcie_read_throughputs;
-    std::map<std::string, uint64_t> pcie_write_throughputs;
-    std::map<std::string, uint64_t> pcie_reads;
-    std::map<std::string, uint64_t> pcie_writes;
+    struct PCIeCounters {
+        // kB/s
+        uint64_t read_throughput;
+        uint64_t write_throughput;
+        // bytes
+        uint64_t read;
+        uint64_t write;
+    };
+
+    /*
+      The counters of one device, written by the sampling thread and read by
+      the metric tasks without a lock. seq is odd while the slot is written,
+      and a reader retries if seq changed during its read.
+    */
+    struct CounterSlot {
+        std::atomic<uint32_t> seq;
+        uint32_t key;
+        std::atomic<uint64_t> read_throughput;
+        std::atomic<uint64_t> write_throughput;
+        std::atomic<uint64_t> read;
+        std::atomic<uint64_t> write;
+        // the accumulated bytes, used by the sampling thread only
+        double read_total;
+        double write_total;
+    };
+
+    // the GPUs whose counters are kept
+    static const uint32_t max_devices = 64;
+
+    void publish(const pcm_iio_gpu_counter& counter, double elapsedSeconds);
+
+    void publishHost(const std::vector<pcm_host_socket_counter>& sockets, const std::vector<pcm_iio_stack_counter>& stacks, double elapsedSeconds);
+
+    bool readCounters(uint32_t bdfKey, PCIeCounters& counters);
+
+    // whether xpumd publishes the PCIe counters, the daemonless xpu-smi reads them instead of the IIO PMU
+    bool attachToDaemon();
+
+    bool readDaemonCounters(uint32_t bdfKey, PCIeCounters& counters);
+
+    // keep the accumulated bytes of the devices in the telemetry checkpoints
+    void registerCheckpointSection();
+
+    std::array<CounterSlot, max_devices> slots;
+    // the slots in use, the key of a slot is set before it is counted
+    std::atomic<uint32_t> slot_count;
+    // the telemetry segment of xpumd when attached
+    xpum_telemetry_shm_reader_t daemon_segment;
+    std::atomic<bool> attached;
     std::atomic<bool> interrupted;
     std::atomic<bool> initialized;
     std::atomic<bool> stopped;
+    // the baselines not added yet, a slot takes its baseline at the next publish
+    std::mutex baseline_mutex;
+    std::map<uint32_t, std::pair<double, double>> baselines;
+    std::atomic<bool> has_baselines;
+    // the host telemetry, published once per sampling window under host_mutex
+    std::mutex host_mutex;
+    std::atomic<bool> host_sampled;
+    std::vector<xpum_host_socket_telemetry_t> host_sockets;
+    std::vector<xpum_host_iio_stack_telemetry_t> host_stacks;
+    // the accumulated bytes in the order of the entries above: DRAM read and write and UPI incoming, stack read and write
+    std::vector<std::array<double, 3>> host_socket_totals;
+    std::vector<std::array<double, 2>> host_stack_totals;
 };
 } // namespace xpum
\ No newline at end of file
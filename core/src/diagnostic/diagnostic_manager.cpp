@@ -14,6 +14,9 @@
 #include "firmware/firmware_manager.h"
 #include "device/gpu/gpu_device_stub.h"
 #include "device/amcInBand.h"
+#include "event/event_bus.h"
+#include "event/events.h"
+#include "event/task_progress.h"
 #include "infrastructure/configuration.h"
 #include "infrastructure/handle_lock.h"
 #include "infrastructure/logger.h"
@@ -23,6 +26,11 @@
 #include <sys/stat.h>
 #include <sys/sysinfo.h>
 #include "helper.h"
+#include "kernel_cache.h"
+#include "micro_benchmark.h"
+#include "precheck.h"
+#include "reference_performance.h"
+#include "topology/topology.h"
 #define ALL_GPU_ID -1
 
 namespace xpum {
@@ -47,6 +55,10 @@ DiagnosticManager::DiagnosticManager(std::shared_ptr<DeviceManagerInterface> &p_
             device_names.insert(std::pair<ze_device_handle_t, std::string>(device->getDeviceHandle(), "Intel(R)Graphics[0x" + device_pci_id + "]"));
             XPUM_LOG_DEBUG("device {} device_pci_id {}", (void *)device->getDeviceHandle(), device_pci_id);
         }
+        if (device->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_GFX_FIRMWARE_VERSION, property)) {
+            // the reference performance may differ by firmware version
+            device_firmwares.insert(std::pair<ze_device_handle_t, std::string>(device->getDeviceHandle(), property.getValue()));
+        }
     }
     XPUM_LOG_TRACE("DiagnosticManager()");
 }
@@ -56,39 +68,15 @@ DiagnosticManager::~DiagnosticManager() {
 }
 
 void DiagnosticManager::init() {
+    if (Configuration::XPUM_MODE != "xpu-smi" && Configuration::PRECHECK_WATCH) {
+        PrecheckManager::startWatching();
+    }
 }
 
 void DiagnosticManager::close() {
+    PrecheckManager::stopWatching();
 }
 
-std::map<std::string, std::map<std::string, int>> DiagnosticManager::thresholds;
-std::map<ze_device_handle_t, std::string> DiagnosticManager::device_names;
-std::string DiagnosticManager::MEDIA_CODER_TOOLS_PATH = "/usr/share/mfx/samples/";
-std::string DiagnosticManager::MEDIA_CODER_TOOLS_1080P_FILE = "test_stream_1080p.265";
-std::string DiagnosticManager::MEDIA_CODER_TOOLS_4K_FILE = "test_stream_4K.265";
-std::string DiagnosticManager::MEDIA_CODEC_TOOLS_LIGHT_FILE = "test_stream.264";
-uint64_t DiagnosticManager::GPU_TEMPERATURE_THRESHOLD = 80;
-int DiagnosticManager::ZE_COMMAND_QUEUE_SYNCHRONIZE_TIMEOUT = 600;
-float DiagnosticManager::MEMORY_USE_PERCENTAGE_FOR_ERROR_TEST = 0.9;
-float DiagnosticManager::XE_LINK_THROUGHPUT_USAGE_PERCENTAGE = 0.7;
-int DiagnosticManager::REF_XE_LINK_THROUGHPUT_ONE_TILE_DEVICE = 23;
-int DiagnosticManager::REF_XE_LINK_THROUGHPUT_TWO_TILE_DEVICE = 19;
-float DiagnosticManager::XE_LINK_ALL_TO_ALL_THROUGHPUT_MIN_RATIO_OF_REF = 0.8;
-int DiagnosticManager::REF_XE_LINK_ALL_TO_ALL_THROUGHPUT_X2_ONE_TILE_DEVICE = 117;
-int DiagnosticManager::REF_XE_LINK_ALL_TO_ALL_THROUGHPUT_X4_ONE_TILE_DEVICE = 55;
-int DiagnosticManager::REF_XE_LINK_ALL_TO_ALL_THROUGHPUT_X8_ONE_TILE_DEVICE = 51;
-int DiagnosticManager::REF_XE_LINK_ALL_TO_ALL_THROUGHPUT_X2_TWO_TILE_DEVICE = 303;
-int DiagnosticManager::REF_XE_LINK_ALL_TO_ALL_THROUGHPUT_X4_TWO_TILE_DEVICE = 116;
-int DiagnosticManager::REF_XE_LINK_ALL_TO_ALL_THROUGHPUT_X8_TWO_TILE_DEVICE = 67;
-const std::string DiagnosticManager::COMPONENT_TYPE_NOT_SUPPORTED = "Not supported";
-const std::string DiagnosticManager::COMPONENT_TYPE_NOT_SUPPORTED_ON_PF = "Not supported on physical functions.";
-std::map<uint32_t, int32_t> DiagnosticManager::fabric_id_convert_to_device_id;
-std::map<int32_t, std::set<int32_t>> DiagnosticManager::device_id_link_to_device_ids;
-std::string DiagnosticManager::PVC_FW_MINIMUM_VERSION = "PVC2_1.23423";
-std::string DiagnosticManager::PVC_AMC_MINIMUM_VERSION = "6.7.0.0";
-std::string DiagnosticManager::ATSM150_FW_MINIMUM_VERSION = "DG02_1.3271";
-std::string DiagnosticManager::ATSM75_FW_MINIMUM_VERSION = "DG02_2.2277";
-
 void readTemperatureTask(std::atomic<bool>& subtask_done, uint64_t& max_temperature_value, const zes_device_handle_t& zes_device) {
     while (!subtask_done.load()) {
         try {
@@ -117,6 +105,8 @@ void readTemperatureTask(std::atomic<bool>& subtask_done, uint64_t& max_temperat
 
 xpum_result_t DiagnosticManager::runDiagnosticsCore(xpum_device_id_t deviceId, xpum_diag_level_t level, xpum_diag_task_type_t types[], int count) {
     std::unique_lock<std::mutex> lock(this->mutex);
+    if (xe_link_matrix_running)
+        return XPUM_RESULT_DIAGNOSTIC_TASK_NOT_COMPLETE;
 
     bool isPVCPlatform = false;
     if (devices.empty())
@@ -165,6 +155,7 @@ xpum_result_t DiagnosticManager::runDiagnosticsCore(xpum_device_id_t deviceId, x
     } catch (BaseException &e) {
         XPUM_LOG_DEBUG("fail to read xpum.conf and diagnostics.conf");
     }
+    ReferencePerformance::load();
 
     std::thread task(&DiagnosticManager::doDiagnosticCore, this, deviceId);
     task.detach();
@@ -217,7 +208,7 @@ void DiagnosticManager::initDiagTaskInfo(std::shared_ptr<xpum::xpum_diag_task_in
 }
 
 xpum_result_t DiagnosticManager::runLevelDiagnostics(xpum_device_id_t deviceId, xpum_diag_level_t level) {
-    if (deviceId != ALL_GPU_ID && this->p_device_manager->getDevice(std::to_string(deviceId)) == nullptr) {
+    if (deviceId != ALL_GPU_ID && this->p_device_manager->getDevice(deviceId) == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
 
@@ -228,7 +219,7 @@ xpum_result_t DiagnosticManager::runLevelDiagnostics(xpum_device_id_t deviceId,
 }
 
 xpum_result_t DiagnosticManager::runMultipleSpecificDiagnostics(xpum_device_id_t deviceId, xpum_diag_task_type_t types[], int count) {
-    if (deviceId != ALL_GPU_ID && this->p_device_manager->getDevice(std::to_string(deviceId)) == nullptr) {
+    if (deviceId != ALL_GPU_ID && this->p_device_manager->getDevice(deviceId) == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
     if (count <= 0 || count >= xpum_diag_task_type_t::XPUM_DIAG_TASK_TYPE_MAX) {
@@ -243,7 +234,7 @@ xpum_result_t DiagnosticManager::runMultipleSpecificDiagnostics(xpum_device_id_t
 }
 
 bool DiagnosticManager::isDiagnosticsRunning(xpum_device_id_t deviceId) {
-    if (this->p_device_manager->getDevice(std::to_string(deviceId)) == nullptr) {
+    if (this->p_device_manager->getDevice(deviceId) == nullptr) {
         return false;
     }
 
@@ -252,7 +243,36 @@ bool DiagnosticManager::isDiagnosticsRunning(xpum_device_id_t deviceId) {
         return true;
     }
 
-    return false;
+    return xe_link_matrix_running;
+}
+
+xpum_result_t DiagnosticManager::runXeLinkMatrix(std::vector<xpum_device_id_t> deviceIds) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    if (xe_link_matrix_running)
+        return XPUM_RESULT_DIAGNOSTIC_TASK_NOT_COMPLETE;
+    for (auto diagnostic_task_info : diagnostic_task_infos)
+        if (diagnostic_task_info.second->finished == false)
+            return XPUM_RESULT_DIAGNOSTIC_TASK_NOT_COMPLETE;
+    for (auto stress_task : stress_task_map)
+        if (stress_task.second->finished == false)
+            return XPUM_RESULT_DIAGNOSTIC_TASK_NOT_COMPLETE;
+
+    std::vector<std::shared_ptr<Device>> matrix_devices;
+    for (auto device : devices) {
+        if (deviceIds.empty() || std::find(deviceIds.begin(), deviceIds.end(), std::stoi(device->getId())) != deviceIds.end())
+            matrix_devices.push_back(device);
+    }
+    if (matrix_devices.empty() || (!deviceIds.empty() && matrix_devices.size() != deviceIds.size()))
+        return XPUM_RESULT_DEVICE_NOT_FOUND;
+
+    xe_link_matrix_running = true;
+    std::thread task(&DiagnosticManager::doXeLinkMatrix, this, matrix_devices);
+    task.detach();
+    return XPUM_OK;
+}
+
+bool DiagnosticManager::isXeLinkMatrixRunning() {
+    return xe_link_matrix_running;
 }
 
 bool DiagnosticManager::isLevelDiagnosticType(xpum_diag_task_type_t type) {
@@ -265,7 +285,7 @@ bool DiagnosticManager::isLevelDiagnosticType(xpum_diag_task_type_t type) {
 }
 
 xpum_result_t DiagnosticManager::getDiagnosticsResult(xpum_device_id_t deviceId, xpum_diag_task_info_t *result) {
-    if (deviceId != ALL_GPU_ID && this->p_device_manager->getDevice(std::to_string(deviceId)) == nullptr) {
+    if (deviceId != ALL_GPU_ID && this->p_device_manager->getDevice(deviceId) == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
 
@@ -492,7 +512,7 @@ void DiagnosticManager::combineMultiDeviceDiagnosticInfo(xpum::xpum_diag_task_in
 }
 
 xpum_result_t DiagnosticManager::getDiagnosticsMediaCodecResult(xpum_device_id_t deviceId, xpum_diag_media_codec_metrics_t resultList[], int *count) {
-    if (this->p_device_manager->getDevice(std::to_string(deviceId)) == nullptr) {
+    if (this->p_device_manager->getDevice(deviceId) == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
 
@@ -583,165 +603,259 @@ void DiagnosticManager::doDiagnosticExceptionHandle(xpum_diag_task_type_t type,
     component.finished = true;
 }
 
+bool DiagnosticManager::isCrossDeviceDiagnosticType(xpum_diag_task_type_t type) {
+    // the xe link tests copy between devices and the PCIe bandwidth shares the host link
+    return type == XPUM_DIAG_XE_LINK_THROUGHPUT || type == XPUM_DIAG_XE_LINK_ALL_TO_ALL_THROUGHPUT ||
+           type == XPUM_DIAG_INTEGRATION_PCIE;
+}
+
+int DiagnosticManager::getThreshold(const ze_device_handle_t &ze_device, const std::string &name) {
+    // not inserting, the devices are diagnosed in parallel
+    auto device_name = device_names.find(ze_device);
+    if (device_name == device_names.end()) {
+        return 0;
+    }
+    auto device_thresholds = thresholds.find(device_name->second);
+    if (device_thresholds == thresholds.end()) {
+        return 0;
+    }
+    auto threshold = device_thresholds->second.find(name);
+    return threshold != device_thresholds->second.end() ? threshold->second : 0;
+}
+
+bool DiagnosticManager::checkReference(const ze_device_handle_t &ze_device, const std::string &name, double value,
+                                       const std::string &unit, std::string &detail) {
+    auto device_name = device_names.find(ze_device);
+    if (device_name == device_names.end()) {
+        return false;
+    }
+    auto firmware = device_firmwares.find(ze_device);
+    ReferenceDistribution distribution;
+    if (!ReferencePerformance::find(device_name->second, firmware != device_firmwares.end() ? firmware->second : "", name, distribution)) {
+        return false;
+    }
+    double rank = ReferencePerformance::percentileRank(distribution, value);
+    detail += " Its percentile rank is " + roundDouble(rank, 1) + " of the reference of median " + roundDouble(distribution.median, 3) + " " + unit + " and 5th percentile " + roundDouble(distribution.p5, 3) + " " + unit + ".";
+    if (rank < ReferencePerformance::getRegressionPercentile()) {
+        detail += " It is a regression from the devices of the same kind.";
+        return true;
+    }
+    return false;
+}
+
 void DiagnosticManager::doDiagnosticCore(xpum_device_id_t deviceId) {
     if (diagnostic_task_infos.empty()) {
         XPUM_LOG_DEBUG("DiagnosticManager::doDiagnosticCore - device not found");
+        return;
     }
-    
-    auto targetCnt = diagnostic_task_infos.begin()->second->targetTypeCount;
-    for (int i = 0; i < targetCnt; i++) {
-        for (auto device : devices) {
-            xpum_device_id_t currentId = std::stoi(device->getId());
-            // only diag the designated device if not -1
-            if (deviceId != ALL_GPU_ID && currentId != deviceId)
-                continue;
-            ze_device_handle_t ze_device = device->getDeviceZeHandle(); 
-            zes_device_handle_t zes_device = device->getDeviceHandle(); 
-            ze_driver_handle_t ze_driver = device->getDriverHandle(); 
-            auto p_task_info = diagnostic_task_infos.at(currentId);
-            switch (p_task_info->targetTypes[i])
-            {
-                case XPUM_DIAG_SOFTWARE_ENV_VARIABLES:
-                    XPUM_LOG_INFO("device: {} - start environment variables diagnostic", currentId);
-                    try {
-                        doDiagnosticEnvironmentVariables(p_task_info);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_SOFTWARE_ENV_VARIABLES, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_SOFTWARE_LIBRARY:
-                    XPUM_LOG_INFO("device: {} - start libraries diagnostic", currentId);
-                    try {
-                        doDiagnosticLibraries(devices, p_task_info);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_SOFTWARE_LIBRARY, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_SOFTWARE_PERMISSION:
-                    XPUM_LOG_INFO("device: {} - start permission diagnostic", currentId);
-                    try {
-                        doDiagnosticPermission(devices.size(), p_task_info);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_SOFTWARE_PERMISSION, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_SOFTWARE_EXCLUSIVE:
-                    XPUM_LOG_INFO("device: {} - start exclusive diagnostic", currentId);
-                    try {
-                        doDiagnosticExclusive(zes_device, diagnostic_exclusive_processes, p_task_info);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_SOFTWARE_EXCLUSIVE, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_LIGHT_COMPUTATION:
-                    XPUM_LOG_INFO("device: {} - tart computation check diagnostic", currentId);
-                    try {
-                        doDiagnosticPeformanceComputation(ze_device, zes_device, ze_driver, diagnostic_perf_datas, p_task_info, true);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_LIGHT_COMPUTATION, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_LIGHT_CODEC:
-                    XPUM_LOG_INFO("device: {} - start media codec check diagnostic", currentId);
-                    try {
-                        doDiagnosticMediaCodec(zes_device, p_task_info, media_codec_perf_datas, true);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_LIGHT_CODEC, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_HARDWARE_SYSMAN:
-                    XPUM_LOG_INFO("device: {} - start hardware sysmam diagnostic", currentId);
-                    try {
-                        doDiagnosticHardwareSysman(zes_device, p_task_info);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_HARDWARE_SYSMAN, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_INTEGRATION_PCIE:
-                    XPUM_LOG_INFO("device: {} - start integration diagnostic", currentId);
-                    try {
-                        doDiagnosticIntegration(ze_device, zes_device, ze_driver, diagnostic_perf_datas, p_task_info);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_INTEGRATION_PCIE, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_MEDIA_CODEC:
-                    XPUM_LOG_INFO("device: {} - start mediacodec diagnostic", currentId);
-                    try {
-                        doDiagnosticMediaCodec(zes_device, p_task_info, media_codec_perf_datas, false);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_MEDIA_CODEC, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_PERFORMANCE_COMPUTATION:
-                    XPUM_LOG_INFO("device: {} - start computation diagnostic", currentId);
-                    try {
-                        doDiagnosticPeformanceComputation(ze_device, zes_device, ze_driver, diagnostic_perf_datas, p_task_info, false);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_PERFORMANCE_COMPUTATION, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_PERFORMANCE_POWER:
-                    XPUM_LOG_INFO("device: {} - start power diagnostic", currentId);
-                    try {
-                        doDiagnosticPeformancePower(ze_device, zes_device, ze_driver, diagnostic_perf_datas, p_task_info);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_PERFORMANCE_POWER, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH:
-                    XPUM_LOG_INFO("device: {} - start memory bandwidth diagnostic", currentId);
-                    try {
-                        doDiagnosticPeformanceMemoryBandwidth(ze_device, zes_device, ze_driver, diagnostic_perf_datas, p_task_info);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_PERFORMANCE_MEMORY_ALLOCATION:
-                    XPUM_LOG_INFO("device: {} - start memory allocation diagnostic", currentId);
-                    try {
-                        doDiagnosticPeformanceMemoryAllocation(ze_device, zes_device, ze_driver, p_task_info);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_PERFORMANCE_MEMORY_ALLOCATION, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_MEMORY_ERROR:
-                    XPUM_LOG_INFO("device: {} - start memory error diagnostic", currentId);
-                    try {
-                        doDiagnosticMemoryError(ze_device, zes_device, ze_driver, p_task_info);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_MEMORY_ERROR, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_XE_LINK_THROUGHPUT:
-                    XPUM_LOG_INFO("device: {} - start xe link throughput diagnostic", currentId);
-                    try {
-                        doDiagnosticXeLinkThroughput(ze_device, zes_device, ze_driver, p_task_info, devices, diagnostic_perf_datas, xe_link_throughput_datas);
-                    } catch (BaseException &e) {
-                        doDiagnosticExceptionHandle(XPUM_DIAG_XE_LINK_THROUGHPUT, e.what(), p_task_info);
-                    }
-                    break;
-                case XPUM_DIAG_XE_LINK_ALL_TO_ALL_THROUGHPUT:
-                    if (deviceId == ALL_GPU_ID && currentId == 0) {
-                        XPUM_LOG_INFO("device: all - start xe link all-to-all throughput diagnostic");
-                        try {
-                            doDiagnosticXeLinkAllToAllThroughput(ze_driver, devices, diagnostic_task_infos, diagnostic_perf_datas);
-                        } catch (BaseException &e) {
-                            doDiagnosticExceptionHandle(XPUM_DIAG_XE_LINK_THROUGHPUT, e.what(), p_task_info);
-                        }
-                    }
-                    break;
-                default:
-                    break;
+
+    std::vector<std::shared_ptr<Device>> targets;
+    for (auto device : devices) {
+        xpum_device_id_t currentId = std::stoi(device->getId());
+        // only diag the designated device if not -1
+        if (deviceId != ALL_GPU_ID && currentId != deviceId)
+            continue;
+        // create the result entries here, the workers only update them
+        diagnostic_perf_datas[currentId];
+        diagnostic_exclusive_processes[currentId];
+        media_codec_perf_datas[currentId];
+        targets.push_back(device);
+    }
+
+    // The tests on one device run in the order of the target types. The runs of
+    // the tests that only use their own device are one worker per device in
+    // parallel, the cross device tests run one device after another.
+    auto p_first_task_info = diagnostic_task_infos.begin()->second;
+    auto targetCnt = p_first_task_info->targetTypeCount;
+    int i = 0;
+    while (i < targetCnt) {
+        if (isCrossDeviceDiagnosticType(p_first_task_info->targetTypes[i])) {
+            for (auto device : targets) {
+                doDiagnosticTask(p_first_task_info->targetTypes[i], device, deviceId);
+                publishTaskProgress(TASK_PROGRESS_DIAGNOSTICS, std::stoi(device->getId()));
             }
+            i++;
+            continue;
+        }
+        int end = i;
+        while (end < targetCnt && !isCrossDeviceDiagnosticType(p_first_task_info->targetTypes[end]))
+            end++;
+        std::vector<std::thread> workers;
+        for (auto device : targets) {
+            workers.push_back(std::thread([this, device, deviceId, i, end]() {
+                auto p_task_info = diagnostic_task_infos.at(std::stoi(device->getId()));
+                for (int j = i; j < end; j++) {
+                    doDiagnosticTask(p_task_info->targetTypes[j], device, deviceId);
+                    publishTaskProgress(TASK_PROGRESS_DIAGNOSTICS, std::stoi(device->getId()));
+                }
+            }));
+        }
+        for (auto &worker : workers)
+            worker.join();
+        i = end;
+    }
+
+    for (auto device : targets) {
+        auto p_task_info = diagnostic_task_infos.at(std::stoi(device->getId()));
+        p_task_info->endTime = Utility::getCurrentMillisecond();
+        p_task_info->finished = true;
+        updateMessage(p_task_info->message, std::string("All diagnostics done"));
+        XPUM_LOG_INFO("device: {}, all diagnostics done", device->getId());
 
-            if (i == targetCnt - 1) {
-                p_task_info->endTime = Utility::getCurrentMillisecond();
-                p_task_info->finished = true;
-                updateMessage(p_task_info->message, std::string("All diagnostics done"));
-                XPUM_LOG_INFO("device: {}, all diagnostics done", device->getId()); 
-            }            
+        DiagnosticEvent event;
+        event.deviceId = std::stoi(device->getId());
+        event.result = xpum_diag_task_result_t::XPUM_DIAG_RESULT_PASS;
+        for (int j = 0; j < p_task_info->count; j++) {
+            if (p_task_info->componentList[p_task_info->targetTypes[j]].result == xpum_diag_task_result_t::XPUM_DIAG_RESULT_FAIL) {
+                event.result = xpum_diag_task_result_t::XPUM_DIAG_RESULT_FAIL;
+            }
         }
+        event.timestamp = p_task_info->endTime;
+        EventBus<DiagnosticEvent>::instance().publish(event);
+        publishTaskProgress(TASK_PROGRESS_DIAGNOSTICS, event.deviceId);
+    }
+}
+
+void DiagnosticManager::doDiagnosticTask(xpum_diag_task_type_t type, std::shared_ptr<Device> device, xpum_device_id_t deviceId) {
+    xpum_device_id_t currentId = std::stoi(device->getId());
+    ze_device_handle_t ze_device = device->getDeviceZeHandle();
+    zes_device_handle_t zes_device = device->getDeviceHandle();
+    ze_driver_handle_t ze_driver = device->getDriverHandle();
+    auto p_task_info = diagnostic_task_infos.at(currentId);
+    switch (type)
+    {
+        case XPUM_DIAG_SOFTWARE_ENV_VARIABLES:
+            XPUM_LOG_INFO("device: {} - start environment variables diagnostic", currentId);
+            try {
+                doDiagnosticEnvironmentVariables(p_task_info);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_SOFTWARE_ENV_VARIABLES, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_SOFTWARE_LIBRARY:
+            XPUM_LOG_INFO("device: {} - start libraries diagnostic", currentId);
+            try {
+                doDiagnosticLibraries(devices, p_task_info);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_SOFTWARE_LIBRARY, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_SOFTWARE_PERMISSION:
+            XPUM_LOG_INFO("device: {} - start permission diagnostic", currentId);
+            try {
+                doDiagnosticPermission(devices.size(), p_task_info);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_SOFTWARE_PERMISSION, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_SOFTWARE_EXCLUSIVE:
+            XPUM_LOG_INFO("device: {} - start exclusive diagnostic", currentId);
+            try {
+                doDiagnosticExclusive(zes_device, diagnostic_exclusive_processes, p_task_info);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_SOFTWARE_EXCLUSIVE, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_LIGHT_COMPUTATION:
+            XPUM_LOG_INFO("device: {} - tart computation check diagnostic", currentId);
+            try {
+                doDiagnosticPeformanceComputation(ze_device, zes_device, ze_driver, diagnostic_perf_datas, p_task_info, true);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_LIGHT_COMPUTATION, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_LIGHT_CODEC:
+            XPUM_LOG_INFO("device: {} - start media codec check diagnostic", currentId);
+            try {
+                doDiagnosticMediaCodec(zes_device, p_task_info, media_codec_perf_datas, true);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_LIGHT_CODEC, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_HARDWARE_SYSMAN:
+            XPUM_LOG_INFO("device: {} - start hardware sysmam diagnostic", currentId);
+            try {
+                doDiagnosticHardwareSysman(zes_device, p_task_info);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_HARDWARE_SYSMAN, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_INTEGRATION_PCIE:
+            XPUM_LOG_INFO("device: {} - start integration diagnostic", currentId);
+            try {
+                doDiagnosticIntegration(ze_device, zes_device, ze_driver, diagnostic_perf_datas, p_task_info);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_INTEGRATION_PCIE, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_MEDIA_CODEC:
+            XPUM_LOG_INFO("device: {} - start mediacodec diagnostic", currentId);
+            try {
+                doDiagnosticMediaCodec(zes_device, p_task_info, media_codec_perf_datas, false);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_MEDIA_CODEC, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_PERFORMANCE_COMPUTATION:
+            XPUM_LOG_INFO("device: {} - start computation diagnostic", currentId);
+            try {
+                doDiagnosticPeformanceComputation(ze_device, zes_device, ze_driver, diagnostic_perf_datas, p_task_info, false);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_PERFORMANCE_COMPUTATION, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_PERFORMANCE_POWER:
+            XPUM_LOG_INFO("device: {} - start power diagnostic", currentId);
+            try {
+                doDiagnosticPeformancePower(ze_device, zes_device, ze_driver, diagnostic_perf_datas, p_task_info);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_PERFORMANCE_POWER, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH:
+            XPUM_LOG_INFO("device: {} - start memory bandwidth diagnostic", currentId);
+            try {
+                doDiagnosticPeformanceMemoryBandwidth(ze_device, zes_device, ze_driver, diagnostic_perf_datas, p_task_info);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_PERFORMANCE_MEMORY_ALLOCATION:
+            XPUM_LOG_INFO("device: {} - start memory allocation diagnostic", currentId);
+            try {
+                doDiagnosticPeformanceMemoryAllocation(ze_device, zes_device, ze_driver, p_task_info);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_PERFORMANCE_MEMORY_ALLOCATION, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_MEMORY_ERROR:
+            XPUM_LOG_INFO("device: {} - start memory error diagnostic", currentId);
+            try {
+                doDiagnosticMemoryError(ze_device, zes_device, ze_driver, p_task_info);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_MEMORY_ERROR, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_XE_LINK_THROUGHPUT:
+            XPUM_LOG_INFO("device: {} - start xe link throughput diagnostic", currentId);
+            try {
+                doDiagnosticXeLinkThroughput(ze_device, zes_device, ze_driver, p_task_info, devices, diagnostic_perf_datas, xe_link_throughput_datas);
+            } catch (BaseException &e) {
+                doDiagnosticExceptionHandle(XPUM_DIAG_XE_LINK_THROUGHPUT, e.what(), p_task_info);
+            }
+            break;
+        case XPUM_DIAG_XE_LINK_ALL_TO_ALL_THROUGHPUT:
+            if (deviceId == ALL_GPU_ID && currentId == 0) {
+                XPUM_LOG_INFO("device: all - start xe link all-to-all throughput diagnostic");
+                try {
+                    doDiagnosticXeLinkAllToAllThroughput(ze_driver, devices, diagnostic_task_infos, diagnostic_perf_datas);
+                } catch (BaseException &e) {
+                    doDiagnosticExceptionHandle(XPUM_DIAG_XE_LINK_THROUGHPUT, e.what(), p_task_info);
+                }
+            }
+            break;
+        default:
+            break;
     }
 }
 
@@ -938,12 +1052,12 @@ void DiagnosticManager::doDiagnosticExclusive(const zes_device_handle_t &device,
     updateMessage(component4.message, std::string("Running"));
     uint32_t process_count = 0;
     ze_result_t ret;
-    XPUM_ZE_HANDLE_LOCK(device, ret = zesDeviceProcessesGetState(device, &process_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, ret = zesDeviceProcessesGetState(device, &process_count, nullptr));
     if (ret != ZE_RESULT_SUCCESS) {
         throw BaseException("zesDeviceProcessesGetState()[" + zeResultErrorCodeStr(ret) + "]");
     }
     std::vector<zes_process_state_t> processes(process_count);
-    XPUM_ZE_HANDLE_LOCK(device, ret = zesDeviceProcessesGetState(device, &process_count, processes.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, ret = zesDeviceProcessesGetState(device, &process_count, processes.data()));
     if (ret != ZE_RESULT_SUCCESS) {
         throw BaseException("zesDeviceProcessesGetState()[" + zeResultErrorCodeStr(ret) + "]");
     }
@@ -1040,6 +1154,34 @@ static std::string getDevicePath(const zes_pci_properties_t& pci_props) {
     return ret;
 }
 
+std::string DiagnosticManager::getMediaDataFolder() {
+    std::string mediadata_folder = std::string(XPUM_RESOURCES_DIR) + std::string("mediadata/");
+    if (!isPathExist(mediadata_folder)) {
+        char exe_path[XPUM_MAX_PATH_LEN];
+        ssize_t len = ::readlink("/proc/self/exe", exe_path, sizeof(exe_path));
+        if (len < 0 || len >= XPUM_MAX_PATH_LEN) {
+            throw BaseException("readlink returns error");
+        }
+        exe_path[len] = '\0';
+        std::string  current_file = exe_path;
+        mediadata_folder = current_file.substr(0, current_file.find_last_of('/')) + "/../lib/" + Configuration::getXPUMMode() + "/resources/mediadata/";
+        if (!isPathExist(mediadata_folder))
+            mediadata_folder = current_file.substr(0, current_file.find_last_of('/')) + "/../lib64/" + Configuration::getXPUMMode() + "/resources/mediadata/";
+    }
+    return mediadata_folder;
+}
+
+bool DiagnosticManager::findMediaCodecTools() {
+    std::ifstream file_transcode(DiagnosticManager::MEDIA_CODER_TOOLS_PATH + "sample_multi_transcode");
+    if (!file_transcode.good()) {
+        std::ifstream file_transcode_retry("/usr/bin/sample_multi_transcode");
+        if (!file_transcode_retry.good())
+            return false;
+        DiagnosticManager::MEDIA_CODER_TOOLS_PATH="/usr/bin/";
+    }
+    return true;
+}
+
 void DiagnosticManager::doDiagnosticMediaCodec(const zes_device_handle_t &zes_device, std::shared_ptr<xpum_diag_task_info_t> p_task_info,
                                                     std::map<xpum_device_id_t, std::vector<xpum_diag_media_codec_metrics_t>>& media_codec_perf_datas, bool checkOnly) {
     xpum_diag_component_info_t &component = p_task_info->componentList[
@@ -1061,35 +1203,15 @@ void DiagnosticManager::doDiagnosticMediaCodec(const zes_device_handle_t &zes_de
     zes_pci_properties_t pci_props;
     pci_props.stype = ZES_STRUCTURE_TYPE_PCI_PROPERTIES;
     pci_props.pNext = nullptr;
-    XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesDevicePciGetProperties(zes_device, &pci_props));
+    XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, ret = zesDevicePciGetProperties(zes_device, &pci_props));
     if (ret != ZE_RESULT_SUCCESS) {
         throw BaseException("zesDevicePciGetProperties()[" + zeResultErrorCodeStr(ret) + "]");
     }
     std::string device_path = getDevicePath(pci_props);
     XPUM_LOG_DEBUG("device path for media codec : {}", device_path);
     if (device_path.size() > 0) {
-        std::string mediadata_folder = std::string(XPUM_RESOURCES_DIR) + std::string("mediadata/");
-        if (!isPathExist(mediadata_folder)) {
-            char exe_path[XPUM_MAX_PATH_LEN];
-            ssize_t len = ::readlink("/proc/self/exe", exe_path, sizeof(exe_path));
-            if (len < 0 || len >= XPUM_MAX_PATH_LEN) {
-                throw BaseException("readlink returns error");
-            }
-            exe_path[len] = '\0';
-            std::string  current_file = exe_path;
-            mediadata_folder = current_file.substr(0, current_file.find_last_of('/')) + "/../lib/" + Configuration::getXPUMMode() + "/resources/mediadata/";
-            if (!isPathExist(mediadata_folder))
-                mediadata_folder = current_file.substr(0, current_file.find_last_of('/')) + "/../lib64/" + Configuration::getXPUMMode() + "/resources/mediadata/";
-        }
-        bool sample_multi_transcode_tool_exist = true;
-        std::ifstream file_transcode(DiagnosticManager::MEDIA_CODER_TOOLS_PATH + "sample_multi_transcode");
-        if (!file_transcode.good()) {
-            std::ifstream file_transcode_retry("/usr/bin/sample_multi_transcode");
-            if (!file_transcode_retry.good())
-                sample_multi_transcode_tool_exist = false;
-            else
-                DiagnosticManager::MEDIA_CODER_TOOLS_PATH="/usr/bin/";
-        }
+        std::string mediadata_folder = getMediaDataFolder();
+        bool sample_multi_transcode_tool_exist = findMediaCodecTools();
 
         bool h265_1080p_file_exist = true;
         std::ifstream file_h265_1080p(mediadata_folder + DiagnosticManager::MEDIA_CODER_TOOLS_1080P_FILE);
@@ -1163,6 +1285,7 @@ void DiagnosticManager::doDiagnosticMediaCodec(const zes_device_handle_t &zes_de
                 } else {
                     if (!checkOnly) {
                         media_codec_perf_datas[p_task_info->deviceId] = getMediaCodecMetricsData(
+                            zes_device,
                             p_task_info->deviceId,
                             device_path,
                             h265_1080p_file_exist,
@@ -1210,7 +1333,11 @@ std::string DiagnosticManager::getCommandResult(std::string command, int& fps) {
         auto pos = str.find(key);
         if (pos != std::string::npos) {
             std::string data = str.substr(pos + key.size());
-            fps = stoi(data);
+            try {
+                fps = stoi(data);
+            } catch (std::exception &e) {
+                XPUM_LOG_DEBUG("Invalid fps in media tool output: {}", str);
+            }
         }
         result += str;
     }
@@ -1225,7 +1352,73 @@ std::string DiagnosticManager::getCommandResult(std::string command, int& fps) {
     return result;
 }
 
-std::vector<xpum_diag_media_codec_metrics_t> DiagnosticManager::getMediaCodecMetricsData(xpum_device_id_t deviceId, std::string device_path, bool h265_1080p_file_exist, bool h265_4k_file_exist) {
+// the media engines of a device, their activity and the activity of the media engine group
+struct MediaEngineActivity {
+    std::vector<zes_engine_handle_t> decode_engines;
+    zes_engine_handle_t media_all_engine = nullptr;
+    std::vector<zes_engine_stats_t> decode_stats;
+    zes_engine_stats_t media_all_stats = {};
+};
+
+static MediaEngineActivity getMediaEngines(const zes_device_handle_t &zes_device) {
+    MediaEngineActivity activity;
+    uint32_t engine_count = 0;
+    ze_result_t res;
+    XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, res = zesDeviceEnumEngineGroups(zes_device, &engine_count, nullptr));
+    if (res != ZE_RESULT_SUCCESS || engine_count == 0) {
+        return activity;
+    }
+    std::vector<zes_engine_handle_t> engines(engine_count);
+    XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, res = zesDeviceEnumEngineGroups(zes_device, &engine_count, engines.data()));
+    if (res != ZE_RESULT_SUCCESS) {
+        return activity;
+    }
+    for (auto &engine : engines) {
+        zes_engine_properties_t props = {};
+        props.stype = ZES_STRUCTURE_TYPE_ENGINE_PROPERTIES;
+        XPUM_ZE_HANDLE_SHARED_LOCK(engine, res = zesEngineGetProperties(engine, &props));
+        if (res != ZE_RESULT_SUCCESS) {
+            continue;
+        }
+        // a transcode stream decodes and encodes on the same media engine
+        if (props.type == ZES_ENGINE_GROUP_MEDIA_DECODE_SINGLE) {
+            activity.decode_engines.push_back(engine);
+        } else if (props.type == ZES_ENGINE_GROUP_MEDIA_ALL && !props.onSubdevice) {
+            activity.media_all_engine = engine;
+        }
+    }
+    return activity;
+}
+
+static void readMediaEngineActivity(MediaEngineActivity &activity) {
+    ze_result_t res;
+    activity.decode_stats.resize(activity.decode_engines.size());
+    for (std::size_t i = 0; i < activity.decode_engines.size(); i++) {
+        XPUM_ZE_HANDLE_SHARED_LOCK(activity.decode_engines[i], res = zesEngineGetActivity(activity.decode_engines[i], &activity.decode_stats[i]));
+        if (res != ZE_RESULT_SUCCESS) {
+            activity.decode_stats[i] = {};
+        }
+    }
+    if (activity.media_all_engine != nullptr) {
+        XPUM_ZE_HANDLE_SHARED_LOCK(activity.media_all_engine, res = zesEngineGetActivity(activity.media_all_engine, &activity.media_all_stats));
+        if (res != ZE_RESULT_SUCCESS) {
+            activity.media_all_stats = {};
+        }
+    }
+}
+
+static int getUtilization(const zes_engine_stats_t &begin, const zes_engine_stats_t &end) {
+    if (end.timestamp <= begin.timestamp || end.activeTime < begin.activeTime) {
+        return -1;
+    }
+    return std::min(100.0, 100.0 * (end.activeTime - begin.activeTime) / (end.timestamp - begin.timestamp));
+}
+
+std::vector<xpum_diag_media_codec_metrics_t> DiagnosticManager::getMediaCodecMetricsData(const zes_device_handle_t &zes_device, xpum_device_id_t deviceId, std::string device_path, bool h265_1080p_file_exist, bool h265_4k_file_exist) {
+    // one stream per media engine, so that all of them are measured at once
+    MediaEngineActivity engine_activity = getMediaEngines(zes_device);
+    std::size_t stream_count = std::max((std::size_t)1, engine_activity.decode_engines.size());
+    XPUM_LOG_INFO("media codec performance streams: {}", stream_count);
     
     std::map<xpum_media_format_t, std::string> format_to_filename_1080p = {{XPUM_MEDIA_FORMAT_H264,"test_stream_1080p.264"}, {XPUM_MEDIA_FORMAT_AV1,"test_stream_1080p.av1"}};
     std::map<xpum_media_format_t, std::string> format_to_filename_4k = {{XPUM_MEDIA_FORMAT_H264,"test_stream_4K.264"}, {XPUM_MEDIA_FORMAT_AV1, "test_stream_4K.av1"}};
@@ -1290,19 +1483,75 @@ std::vector<xpum_diag_media_codec_metrics_t> DiagnosticManager::getMediaCodecMet
                 format = "av1";
             }
 
-            transcode_command = DiagnosticManager::MEDIA_CODER_TOOLS_PATH + "sample_multi_transcode -device " + device_path +
-                    " -hw" + async_para + " -i::" + format + " " + target_src_file + " -o::" + format + " " + target_dst_file + " 2>&1";
-            XPUM_LOG_INFO("Transcoding command: {}", transcode_command);
+            std::vector<std::string> transcode_commands;
+            for (std::size_t s = 0; s < stream_count; s++) {
+                transcode_command = DiagnosticManager::MEDIA_CODER_TOOLS_PATH + "sample_multi_transcode -device " + device_path +
+                        " -hw" + async_para + " -i::" + format + " " + target_src_file + " -o::" + format + " " + target_dst_file + "." + std::to_string(s) + " 2>&1";
+                XPUM_LOG_INFO("Transcoding command: {}", transcode_command);
+                transcode_commands.push_back(transcode_command);
+            }
             int metric_fps = -1;
+            std::vector<int> metric_stream_fps;
+            std::vector<int> metric_engine_utilizations;
+            int metric_media_utilization = -1;
             
             for (int round = 1; round <= 3; round++) {
-                fps = -1;
-                result = getCommandResult(transcode_command, fps);
-                XPUM_LOG_DEBUG("Transcoding round {} result: {}", round, result);
-                metric_fps = std::max(metric_fps, fps);
+                std::vector<int> stream_fps(stream_count, -1);
+                std::vector<std::thread> stream_threads;
+                readMediaEngineActivity(engine_activity);
+                MediaEngineActivity begin_activity = engine_activity;
+                for (std::size_t s = 0; s < stream_count; s++) {
+                    stream_threads.emplace_back([&transcode_commands, &stream_fps, s, round]() {
+                        std::string result = getCommandResult(transcode_commands[s], stream_fps[s]);
+                        XPUM_LOG_DEBUG("Transcoding round {} stream {} result: {}", round, s, result);
+                    });
+                }
+                for (auto &t : stream_threads) {
+                    t.join();
+                }
+                readMediaEngineActivity(engine_activity);
+                int total_fps = 0;
+                for (auto stream : stream_fps) {
+                    if (stream <= 0) {
+                        total_fps = -1;
+                        break;
+                    }
+                    total_fps += stream;
+                }
+                if (total_fps > metric_fps) {
+                    metric_fps = total_fps;
+                    metric_stream_fps = stream_fps;
+                    metric_engine_utilizations.clear();
+                    for (std::size_t i = 0; i < engine_activity.decode_stats.size(); i++) {
+                        metric_engine_utilizations.push_back(getUtilization(begin_activity.decode_stats[i], engine_activity.decode_stats[i]));
+                    }
+                    metric_media_utilization = getUtilization(begin_activity.media_all_stats, engine_activity.media_all_stats);
+                }
+            }
+            for (std::size_t s = 0; s < stream_count; s++) {
+                remove((target_dst_file + "." + std::to_string(s)).c_str());
             }
             if (metric_fps > 0) {
-                updateMessage(data.fps, std::to_string(metric_fps) + " FPS");
+                std::string fps_desc = std::to_string(metric_fps) + " FPS";
+                // the driver places the streams on the engines, so fps is per stream and utilization per engine
+                if (stream_count > 1) {
+                    fps_desc += " (streams:";
+                    for (std::size_t s = 0; s < metric_stream_fps.size(); s++)
+                        fps_desc += " " + std::to_string(metric_stream_fps[s]);
+                    fps_desc += " FPS";
+                    bool has_utilization = std::any_of(metric_engine_utilizations.begin(), metric_engine_utilizations.end(), [](int u) { return u >= 0; });
+                    if (has_utilization) {
+                        fps_desc += "; engines:";
+                        for (auto utilization : metric_engine_utilizations)
+                            fps_desc += utilization >= 0 ? " " + std::to_string(utilization) + "%" : std::string(" -");
+                    }
+                    fps_desc += ")";
+                }
+                if (metric_media_utilization >= 0) {
+                    fps_desc += " media utilization " + std::to_string(metric_media_utilization) + "%";
+                }
+                XPUM_LOG_INFO("Transcoding {} {}: {}", r, format, fps_desc);
+                updateMessage(data.fps, fps_desc);
                 datas.push_back(data);
             }
         }
@@ -1325,7 +1574,7 @@ std::string checkDowngradedPCIe(const zes_device_handle_t &zes_device) {
 
     ze_result_t res;
     zes_pci_properties_t pci_props = {};
-    XPUM_ZE_HANDLE_LOCK(zes_device, res = zesDevicePciGetProperties(zes_device, &pci_props));
+    XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, res = zesDevicePciGetProperties(zes_device, &pci_props));
     if (res != ZE_RESULT_SUCCESS) {
         return ret;
     }
@@ -1425,13 +1674,13 @@ std::vector<int> DiagnosticManager::getDeviceAvailableCopyEngingGroups(const ze_
     uint32_t numQueueGroups = 0;
     ze_result_t ret;
     
-    XPUM_ZE_HANDLE_LOCK(ze_device, ret = zeDeviceGetCommandQueueGroupProperties(ze_device, &numQueueGroups, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetCommandQueueGroupProperties(ze_device, &numQueueGroups, nullptr));
     if (ret != ZE_RESULT_SUCCESS || numQueueGroups == 0) {
         throw BaseException("zeDeviceGetCommandQueueGroupProperties()[" + zeResultErrorCodeStr(ret) + "]");
     }
     std::vector<ze_command_queue_group_properties_t> queueProperties;
     queueProperties.resize(numQueueGroups);
-    XPUM_ZE_HANDLE_LOCK(ze_device, ret = zeDeviceGetCommandQueueGroupProperties(ze_device, &numQueueGroups, queueProperties.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetCommandQueueGroupProperties(ze_device, &numQueueGroups, queueProperties.data()));
     if (ret != ZE_RESULT_SUCCESS) {
         throw BaseException("zeDeviceGetCommandQueueGroupProperties()[" + zeResultErrorCodeStr(ret) + "]");
     }
@@ -1519,27 +1768,23 @@ void DiagnosticManager::doDiagnosticIntegration(const ze_device_handle_t &ze_dev
                     memoryAlloc(context, device_handles[i], size, 1, &device_buffer);
                     memoryAllocHost(context, size, 1, &host_buffer);
 
-                    uint32_t number_iterations = 500;
-                    long double total_time_nsec = 0.0;
+                    uint32_t number_iterations = 100;
                     std::size_t element_size = sizeof(uint8_t);
                     std::size_t buffer_size = element_size * size;
-                    commandListAppendMemoryCopy(command_list, device_buffer, host_buffer, buffer_size);
-                    commandListClose(command_list);
-                    std::chrono::high_resolution_clock::time_point time_start, time_end;
-                    time_start = std::chrono::high_resolution_clock::now();
-                    for (uint32_t i = 0; i < number_iterations; i++) {
-                        commandQueueExecuteCommandLists(command_queue, command_list);
-                        commandQueueSynchronize(command_queue);
+                    MicroBenchmarkResult result;
+                    {
+                        MicroBenchmark benchmark(context, device_handles[i], MicroBenchmark::DEFAULT_WARMUP_ITERATIONS, number_iterations);
+                        result = benchmark.run(command_queue, command_list, [&](ze_command_list_handle_t list) {
+                            commandListAppendMemoryCopy(list, device_buffer, host_buffer, buffer_size);
+                        });
                     }
-                    time_end = std::chrono::high_resolution_clock::now();
-                    total_time_nsec = std::chrono::duration<long double, std::chrono::nanoseconds::period>(time_end - time_start).count();
 
                     commandListDestroy(command_list);
                     commandQueueDestroy(command_queue);
                     memoryFree(context, device_buffer);
                     memoryFree(context, host_buffer);
                     contextDestroy(context);
-                    calculateBandwidthLatency(total_time_nsec, static_cast<long double>(size * number_iterations), total_bandwidth, total_latency, number_iterations);
+                    calculateBandwidthLatency(result.median_nsec, static_cast<long double>(buffer_size), total_bandwidth, total_latency, 1);
                     all_bandwidth[i] = total_bandwidth;
                 } catch (BaseException &e) {
                     XPUM_LOG_DEBUG("Error in integration diagnostic {}",  e.what());
@@ -1570,8 +1815,8 @@ void DiagnosticManager::doDiagnosticIntegration(const ze_device_handle_t &ze_dev
         auto bandwidth_threshold = 0;
         auto ref_bandwidth = 0;
         if (device_names.find(ze_device) != device_names.end()) {
-            bandwidth_threshold = thresholds[device_names[ze_device]]["PCIE_BANDWIDTH_MIN_GBPS"];
-            ref_bandwidth = thresholds[device_names[ze_device]]["REF_PCIE_BANDWIDTH_GBPS"];
+            bandwidth_threshold = getThreshold(ze_device, "PCIE_BANDWIDTH_MIN_GBPS");
+            ref_bandwidth = getThreshold(ze_device, "REF_PCIE_BANDWIDTH_GBPS");
         }
         diagnostic_perf_datas[p_task_info->deviceId].pcie_bandwidth = total_bandwidth;
         diagnostic_perf_datas[p_task_info->deviceId].reference_pcie_bandwidth = ref_bandwidth;
@@ -1587,6 +1832,11 @@ void DiagnosticManager::doDiagnosticIntegration(const ze_device_handle_t &ze_dev
             desc += " Threshold is " + std::to_string(bandwidth_threshold) + " GBPS.";
             component.result = xpum_diag_task_result_t::XPUM_DIAG_RESULT_FAIL;
             updateMessage(component.message, desc);
+        } else if (checkReference(ze_device, "PCIE_BANDWIDTH_GBPS", total_bandwidth, "GBPS", bandwidth_detail)) {
+            std::string desc = "Fail to check PCIe bandwidth.";
+            desc += bandwidth_detail;
+            component.result = xpum_diag_task_result_t::XPUM_DIAG_RESULT_FAIL;
+            updateMessage(component.message, desc);
         } else {
             std::string desc = "Pass to check PCIe bandwidth.";
             desc += bandwidth_detail;
@@ -1665,7 +1915,7 @@ void DiagnosticManager::doDiagnosticPeformanceMemoryAllocation(const ze_device_h
                 ze_device_properties_t device_properties;
                 device_properties.pNext = nullptr;
                 device_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
-                XPUM_ZE_HANDLE_LOCK(ze_device, ret = zeDeviceGetProperties(ze_device, &device_properties));
+                XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetProperties(ze_device, &device_properties));
                 if (ret != ZE_RESULT_SUCCESS) {
                     throw BaseException("zeDeviceGetProperties()[" + zeResultErrorCodeStr(ret) + "]");
                 }
@@ -1751,6 +2001,10 @@ void DiagnosticManager::doDiagnosticPeformanceMemoryAllocation(const ze_device_h
 }
 
 std::vector<uint8_t> DiagnosticManager::loadBinaryFile(const std::string &file_path) {
+    return KernelCache::instance().getSpirv(file_path, [&file_path]() { return readKernelFile(file_path); });
+}
+
+std::vector<uint8_t> DiagnosticManager::readKernelFile(const std::string &file_path) {
     std::string folder = std::string(XPUM_RESOURCES_DIR) + std::string("kernels/");
     if (!isPathExist(folder)) {
         char exe_path[XPUM_MAX_PATH_LEN];
@@ -1798,33 +2052,30 @@ void DiagnosticManager::doDiagnosticMemoryError(const ze_device_handle_t &ze_dev
     uint64_t one_MB = 1024UL * 1024UL;
     uint32_t workgroup_size_x_ = 8;
     uint32_t number_of_kernel_args_ = 2;
-    uint32_t number_of_kernels_in_module_ = 10;
-    uint8_t init_value_1_ = 0;
-    uint8_t init_value_2_ = 0xAA; // 1010 1010
     float memory_use_percentage_for_error_test = MEMORY_USE_PERCENTAGE_FOR_ERROR_TEST;
 
     XPUM_LOG_DEBUG("memory use_percentage for memory error test: {}", MEMORY_USE_PERCENTAGE_FOR_ERROR_TEST);
-    uint32_t error_count = 0;
+    uint64_t error_count = 0;
     ze_device_properties_t device_properties;
     device_properties.pNext = nullptr;
     device_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
-    XPUM_ZE_HANDLE_LOCK(ze_device, ret = zeDeviceGetProperties(ze_device, &device_properties));
+    XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetProperties(ze_device, &device_properties));
     if (ret != ZE_RESULT_SUCCESS) {
         throw BaseException("zeDeviceGetProperties()[" + zeResultErrorCodeStr(ret) + "]");
     }
 
     uint64_t physical_size = 0;
     uint32_t mem_module_count = 0;
-    XPUM_ZE_HANDLE_LOCK(ze_device, ret = zesDeviceEnumMemoryModules(ze_device, &mem_module_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zesDeviceEnumMemoryModules(ze_device, &mem_module_count, nullptr));
     std::vector<zes_mem_handle_t> mems(mem_module_count);
-    XPUM_ZE_HANDLE_LOCK(ze_device, ret = zesDeviceEnumMemoryModules(ze_device, &mem_module_count, mems.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zesDeviceEnumMemoryModules(ze_device, &mem_module_count, mems.data()));
     if (ret == ZE_RESULT_SUCCESS) {
         for (auto& mem : mems) {
             uint64_t mem_module_physical_size = 0;
             zes_mem_properties_t props;
             props.pNext = nullptr;
             props.stype = ZES_STRUCTURE_TYPE_MEM_PROPERTIES;
-            XPUM_ZE_HANDLE_LOCK(mem, ret = zesMemoryGetProperties(mem, &props));
+            XPUM_ZE_HANDLE_SHARED_LOCK(mem, ret = zesMemoryGetProperties(mem, &props));
             if (ret == ZE_RESULT_SUCCESS) {
                 mem_module_physical_size = props.physicalSize;
             }
@@ -1832,7 +2083,7 @@ void DiagnosticManager::doDiagnosticMemoryError(const ze_device_handle_t &ze_dev
             zes_mem_state_t sysman_memory_state = {};
             sysman_memory_state.stype = ZES_STRUCTURE_TYPE_MEM_STATE;
             sysman_memory_state.pNext = nullptr;
-            XPUM_ZE_HANDLE_LOCK(mem, ret = zesMemoryGetState(mem, &sysman_memory_state));
+            XPUM_ZE_HANDLE_SHARED_LOCK(mem, ret = zesMemoryGetState(mem, &sysman_memory_state));
             if (ret == ZE_RESULT_SUCCESS) {
                 if (props.physicalSize == 0) {
                     mem_module_physical_size = sysman_memory_state.size;
@@ -1844,14 +2095,6 @@ void DiagnosticManager::doDiagnosticMemoryError(const ze_device_handle_t &ze_dev
 
     uint64_t target_test_memory_size = physical_size * 1.0 * memory_use_percentage_for_error_test;
     XPUM_LOG_DEBUG("memory physical size: {}, target test memory size: {}", physical_size, target_test_memory_size);
-    struct sysinfo info;
-    if (sysinfo(&info) == 0) {
-        uint64_t host_memory_size = (uint64_t) info.totalram / info.mem_unit;
-        if (target_test_memory_size > host_memory_size) {
-            XPUM_LOG_DEBUG("host memory size: {}, target test memory size: {}", host_memory_size, target_test_memory_size);
-            target_test_memory_size = host_memory_size;
-        }
-    }
     ze_context_handle_t context;
     contextCreate(ze_driver, &context);
     uint64_t max_allocation_size = workgroup_size_x_ * (target_test_memory_size / workgroup_size_x_);
@@ -1884,60 +2127,79 @@ void DiagnosticManager::doDiagnosticMemoryError(const ze_device_handle_t &ze_dev
         }
     }
 
-    for (auto& device : device_handles) {
-        std::vector<uint8_t *> input_allocations;
-        std::vector<uint8_t *> output_allocations;
-        std::vector<std::vector<uint8_t>> data_out_vector;
-        std::vector<std::string> test_kernel_names;
-
-        for (uint64_t dispatch_id = 0; dispatch_id < number_of_dispatch; dispatch_id++) {
-            uint8_t *input_allocation;
-            uint8_t *output_allocation;
-            void *memory_input = nullptr;
-            memoryAlloc(context, device, one_case_allocation_count, 8, &memory_input);
-            input_allocation = (uint8_t *)memory_input;
-            void *memory_output = nullptr;
-            memoryAlloc(context, device, one_case_allocation_count, 8, &memory_output);
-            output_allocation = (uint8_t *)memory_output;
-            
-            input_allocations.push_back(input_allocation);
-            output_allocations.push_back(output_allocation);
-            std::vector<uint8_t> data_out(one_case_allocation_count, init_value_1_);
-            data_out_vector.push_back(data_out);
-            std::string kernel_name;
-            kernel_name = "test_device_memory" + std::to_string((dispatch_id % number_of_kernels_in_module_) + 1);
-            test_kernel_names.push_back(kernel_name);
-        }
-
-        const std::vector<uint8_t> binary_file = loadBinaryFile("test_multiple_memory_allocations.spv");
-
-        ze_module_handle_t module_handle = nullptr;
-        moduleCreate(context, device, binary_file, &module_handle);
-        dispatchKernelsForMemoryTest(device, module_handle, input_allocations, output_allocations,
-                                        data_out_vector, test_kernel_names, number_of_dispatch, one_case_allocation_count, context);
-        for (auto each_allocation : input_allocations) {
-            memoryFree(context, each_allocation);
-        }
-        for (auto each_allocation : output_allocations) {
-            memoryFree(context, each_allocation);
-        }
-
-        moduleDestroy(module_handle);
-        int tile_level_error_count = 0;
-        for (auto each_data_out : data_out_vector) {
-            for (uint32_t i = 0; i < one_case_allocation_count; i++) {
-                if (init_value_2_ != each_data_out[i]) {
-                    tile_level_error_count += 1;
+    // the tiles are tested in parallel, the first error stops all of them
+    std::atomic<uint64_t> tested_size(0);
+    std::atomic<bool> failed(false);
+    std::atomic<std::size_t> finished_tiles(0);
+    std::vector<uint64_t> tile_error_counts(device_handles.size(), 0);
+    std::vector<std::string> error_messages(device_handles.size());
+    std::vector<uint8_t> tile_done(device_handles.size(), 0);
+    std::vector<std::thread> tile_threads;
+    for (std::size_t i = 0; i < device_handles.size(); i++) {
+        tile_threads.push_back(std::thread([&, i]() {
+            try {
+                ze_device_handle_t device = device_handles[i];
+                std::vector<uint8_t *> input_allocations;
+                std::vector<uint8_t *> output_allocations;
+                for (uint64_t dispatch_id = 0; dispatch_id < number_of_dispatch; dispatch_id++) {
+                    void *memory_input = nullptr;
+                    memoryAlloc(context, device, one_case_allocation_count, 8, &memory_input);
+                    input_allocations.push_back((uint8_t *)memory_input);
+                    void *memory_output = nullptr;
+                    memoryAlloc(context, device, one_case_allocation_count, 8, &memory_output);
+                    output_allocations.push_back((uint8_t *)memory_output);
                 }
-            }
-        }
-        if (tile_level_error_count <= 1)
-            XPUM_LOG_INFO("{} error was found", tile_level_error_count);
-        else
-            XPUM_LOG_INFO("{} errors were found", tile_level_error_count);
-        error_count += tile_level_error_count;
-    }
+
+                const std::vector<uint8_t> binary_file = loadBinaryFile("test_multiple_memory_allocations.spv");
+                ze_module_handle_t module_handle = nullptr;
+                moduleCreate(context, device, binary_file, &module_handle);
+                tile_error_counts[i] = testMemoryErrorOnDevice(device, module_handle, input_allocations, output_allocations,
+                                                               one_case_allocation_count, context, tested_size, failed);
+                for (auto each_allocation : input_allocations) {
+                    memoryFree(context, each_allocation);
+                }
+                for (auto each_allocation : output_allocations) {
+                    memoryFree(context, each_allocation);
+                }
+                moduleDestroy(module_handle);
+                if (tile_error_counts[i] <= 1)
+                    XPUM_LOG_INFO("{} error was found", tile_error_counts[i]);
+                else
+                    XPUM_LOG_INFO("{} errors were found", tile_error_counts[i]);
+                tile_done[i] = 1;
+            } catch (BaseException &e) {
+                XPUM_LOG_DEBUG("Error in memory error diagnostic");
+                XPUM_LOG_DEBUG(e.what());
+                error_messages[i] = e.what();
+                failed.store(true);
+            } catch (...) {
+                XPUM_LOG_DEBUG("Error in memory error diagnostic");
+                failed.store(true);
+            }
+            finished_tiles++;
+        }));
+    }
+
+    uint64_t total_size = device_handles.size() * number_of_dispatch * one_case_allocation_count * number_of_kernel_args_;
+    while (finished_tiles.load() < tile_threads.size()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        if (total_size > 0) {
+            updateMessage(component.message, "Running. " + std::to_string(tested_size.load() * 100 / total_size) + "% of the memory is tested.");
+        }
+    }
+    for (auto &tile_thread : tile_threads) {
+        tile_thread.join();
+    }
     contextDestroy(context);
+    for (std::size_t i = 0; i < device_handles.size(); i++) {
+        if (!tile_done[i]) {
+            if (error_messages[i].length() == 0)
+                throw BaseException("unknown reasons");
+            else
+                throw BaseException(error_messages[i]);
+        }
+        error_count += tile_error_counts[i];
+    }
     if (error_count == 0) {
         component.result = xpum_diag_task_result_t::XPUM_DIAG_RESULT_PASS;
         updateMessage(component.message, std::string("Pass to check memory error."));
@@ -1949,6 +2211,9 @@ void DiagnosticManager::doDiagnosticMemoryError(const ze_device_handle_t &ze_dev
         } else  {
             desc += std::to_string(error_count) + " errors were found.";
         }
+        if (tested_size.load() < total_size) {
+            desc += " The test stopped at the first failed chunk.";
+        }
         updateMessage(component.message, desc);
     }
     component.finished = true;
@@ -2006,6 +2271,159 @@ void DiagnosticManager::dispatchKernelsForMemoryTest(const ze_device_handle_t de
     }
 }
 
+// the device memory written and verified by one submission of the memory error test
+static const uint64_t MEMORY_ERROR_TEST_CHUNK_SIZE = 128UL * 1024UL * 1024UL;
+
+// the chunks in flight on each tile, the host verifies the oldest while the others run
+static const uint32_t MEMORY_ERROR_TEST_CHUNKS_IN_FLIGHT = 3;
+
+uint64_t DiagnosticManager::testMemoryErrorOnDevice(const ze_device_handle_t device, ze_module_handle_t module,
+                                                    const std::vector<uint8_t *> &src_allocations,
+                                                    const std::vector<uint8_t *> &dst_allocations,
+                                                    uint64_t one_case_allocation_count, ze_context_handle_t context,
+                                                    std::atomic<uint64_t> &tested_size, std::atomic<bool> &failed) {
+    uint32_t workgroup_size_x_ = 8;
+    uint32_t number_of_kernels_in_module_ = 10;
+    uint8_t init_value_2_ = 0xAA; // 1010 1010
+    uint8_t init_value_3_ = 0x55; // 0101 0101
+    ze_result_t ret;
+
+    // the patterns are written and checked on the compute queues and read back on a copy engine if there is one
+    uint32_t num_queue_groups = 0;
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, ret = zeDeviceGetCommandQueueGroupProperties(device, &num_queue_groups, nullptr));
+    if (ret != ZE_RESULT_SUCCESS || num_queue_groups == 0) {
+        throw BaseException("zeDeviceGetCommandQueueGroupProperties()[" + zeResultErrorCodeStr(ret) + "]");
+    }
+    std::vector<ze_command_queue_group_properties_t> queue_properties(num_queue_groups);
+    XPUM_ZE_HANDLE_SHARED_LOCK(device, ret = zeDeviceGetCommandQueueGroupProperties(device, &num_queue_groups, queue_properties.data()));
+    if (ret != ZE_RESULT_SUCCESS) {
+        throw BaseException("zeDeviceGetCommandQueueGroupProperties()[" + zeResultErrorCodeStr(ret) + "]");
+    }
+    uint32_t compute_ordinal = num_queue_groups;
+    uint32_t copy_ordinal = num_queue_groups;
+    for (uint32_t i = 0; i < num_queue_groups; i++) {
+        if (queue_properties[i].flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE) {
+            if (compute_ordinal == num_queue_groups)
+                compute_ordinal = i;
+        } else if (queue_properties[i].flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY) {
+            if (copy_ordinal == num_queue_groups)
+                copy_ordinal = i;
+        }
+    }
+    if (compute_ordinal == num_queue_groups) {
+        throw BaseException("compute engine not found");
+    }
+    if (copy_ordinal == num_queue_groups) {
+        copy_ordinal = compute_ordinal;
+    }
+
+    std::vector<ze_kernel_handle_t> test_functions(number_of_kernels_in_module_);
+    for (uint32_t i = 0; i < number_of_kernels_in_module_; i++) {
+        kernelCreate(module, "test_device_memory" + std::to_string(i + 1), &test_functions[i]);
+        kernelSetGroupSize(test_functions[i], workgroup_size_x_, 1, 1);
+    }
+
+    struct Chunk {
+        ze_command_list_handle_t compute_list;
+        ze_command_list_handle_t copy_list;
+        ze_command_queue_handle_t compute_queue;
+        ze_command_queue_handle_t copy_queue;
+        // the patterns are written and the kernels done
+        ze_event_handle_t written;
+        std::vector<uint8_t> data_out;
+        uint64_t dispatch_count;
+        bool pending;
+    };
+    uint64_t number_of_dispatch = src_allocations.size();
+    uint64_t dispatches_per_chunk = std::max<uint64_t>(1, MEMORY_ERROR_TEST_CHUNK_SIZE / (2 * one_case_allocation_count));
+    ze_event_pool_handle_t event_pool;
+    eventPoolCreate(context, MEMORY_ERROR_TEST_CHUNKS_IN_FLIGHT, &event_pool);
+    std::vector<Chunk> chunks(MEMORY_ERROR_TEST_CHUNKS_IN_FLIGHT);
+    for (uint32_t i = 0; i < chunks.size(); i++) {
+        Chunk &chunk = chunks[i];
+        commandListCreate(context, device, compute_ordinal, &chunk.compute_list);
+        commandListCreate(context, device, copy_ordinal, &chunk.copy_list);
+        commandQueueCreate(context, device, compute_ordinal, i % queue_properties[compute_ordinal].numQueues, &chunk.compute_queue);
+        commandQueueCreate(context, device, copy_ordinal, i % queue_properties[copy_ordinal].numQueues, &chunk.copy_queue);
+        eventCreate(event_pool, i, &chunk.written);
+        chunk.data_out.resize(dispatches_per_chunk * one_case_allocation_count);
+        chunk.dispatch_count = 0;
+        chunk.pending = false;
+    }
+
+    uint64_t next_dispatch = 0;
+    auto submit = [&](Chunk &chunk) {
+        chunk.dispatch_count = std::min(dispatches_per_chunk, number_of_dispatch - next_dispatch);
+        commandListReset(chunk.compute_list);
+        commandListReset(chunk.copy_list);
+        // the read-back waits for the kernels of this chunk only, the next chunk is written meanwhile
+        commandListAppendWaitOnEvent(chunk.copy_list, chunk.written);
+        uint32_t group_count_x = one_case_allocation_count / workgroup_size_x_;
+        ze_group_count_t thread_group_dimensions = {group_count_x, 1, 1};
+        for (uint64_t dispatch_id = next_dispatch; dispatch_id < next_dispatch + chunk.dispatch_count; dispatch_id++) {
+            uint8_t *src_allocation = src_allocations[dispatch_id];
+            uint8_t *dst_allocation = dst_allocations[dispatch_id];
+            // the arguments are taken when the kernel is appended
+            ze_kernel_handle_t test_function = test_functions[dispatch_id % number_of_kernels_in_module_];
+            kernelSetArgumentValue(test_function, 0, sizeof(src_allocation), &src_allocation);
+            kernelSetArgumentValue(test_function, 1, sizeof(dst_allocation), &dst_allocation);
+            commandListAppendMemoryFill(chunk.compute_list, src_allocation, &init_value_2_, sizeof(uint8_t),
+                                        one_case_allocation_count * sizeof(uint8_t));
+            commandListAppendMemoryFill(chunk.compute_list, dst_allocation, &init_value_3_, sizeof(uint8_t),
+                                        one_case_allocation_count * sizeof(uint8_t));
+            commandListAppendBarrier(chunk.compute_list);
+            commandListAppendLaunchKernel(chunk.compute_list, test_function, &thread_group_dimensions);
+            commandListAppendMemoryCopy(chunk.copy_list, chunk.data_out.data() + (dispatch_id - next_dispatch) * one_case_allocation_count,
+                                        dst_allocation, one_case_allocation_count * sizeof(uint8_t));
+        }
+        commandListAppendBarrier(chunk.compute_list);
+        commandListAppendSignalEvent(chunk.compute_list, chunk.written);
+        commandListClose(chunk.compute_list);
+        commandListClose(chunk.copy_list);
+        commandQueueExecuteCommandLists(chunk.compute_queue, chunk.compute_list);
+        commandQueueExecuteCommandLists(chunk.copy_queue, chunk.copy_list);
+        next_dispatch += chunk.dispatch_count;
+        chunk.pending = true;
+    };
+    auto verify = [&](Chunk &chunk) {
+        commandQueueSynchronize(chunk.copy_queue);
+        commandQueueSynchronize(chunk.compute_queue);
+        eventHostReset(chunk.written);
+        chunk.pending = false;
+        uint64_t size = chunk.dispatch_count * one_case_allocation_count;
+        uint64_t chunk_error_count = size - std::count(chunk.data_out.begin(), chunk.data_out.begin() + size, init_value_2_);
+        tested_size += size * 2;
+        return chunk_error_count;
+    };
+
+    uint64_t error_count = 0;
+    for (auto &chunk : chunks) {
+        if (next_dispatch < number_of_dispatch)
+            submit(chunk);
+    }
+    // the chunks are submitted in turn, the pending ones are verified in the same order
+    for (std::size_t i = 0; chunks[i].pending; i = (i + 1) % chunks.size()) {
+        error_count += verify(chunks[i]);
+        if (error_count > 0)
+            failed.store(true);
+        if (next_dispatch < number_of_dispatch && !failed.load())
+            submit(chunks[i]);
+    }
+
+    for (auto &chunk : chunks) {
+        commandListDestroy(chunk.compute_list);
+        commandListDestroy(chunk.copy_list);
+        commandQueueDestroy(chunk.compute_queue);
+        commandQueueDestroy(chunk.copy_queue);
+        eventDestroy(chunk.written);
+    }
+    eventPoolDestroy(event_pool);
+    for (auto test_function : test_functions) {
+        kernelDestroy(test_function);
+    }
+    return error_count;
+}
+
 void DiagnosticManager::doDiagnosticPeformanceComputation(const ze_device_handle_t &ze_device, const zes_device_handle_t &zes_device, const ze_driver_handle_t &ze_driver, std::map<xpum_device_id_t, PerfDatas> &diagnostic_perf_datas, std::shared_ptr<xpum_diag_task_info_t> p_task_info, bool checkOnly) {
     int comp_index = 0;
     if (checkOnly == true) {
@@ -2064,7 +2482,7 @@ void DiagnosticManager::doDiagnosticPeformanceComputation(const ze_device_handle
                 ze_device_properties_t device_properties;
                 device_properties.pNext = nullptr;
                 device_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
-                XPUM_ZE_HANDLE_LOCK(device_handles[i], ret = zeDeviceGetProperties(device_handles[i], &device_properties));
+                XPUM_ZE_HANDLE_SHARED_LOCK(device_handles[i], ret = zeDeviceGetProperties(device_handles[i], &device_properties));
                 if (ret != ZE_RESULT_SUCCESS) {
                     throw BaseException("zeDeviceGetProperties()[" + zeResultErrorCodeStr(ret) + "]");
                 }
@@ -2072,7 +2490,7 @@ void DiagnosticManager::doDiagnosticPeformanceComputation(const ze_device_handle
                 ze_device_compute_properties_t device_compute_properties;
                 device_compute_properties.pNext = nullptr;
                 device_compute_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_COMPUTE_PROPERTIES;
-                XPUM_ZE_HANDLE_LOCK(device_handles[i], ret = zeDeviceGetComputeProperties(device_handles[i], &device_compute_properties));
+                XPUM_ZE_HANDLE_SHARED_LOCK(device_handles[i], ret = zeDeviceGetComputeProperties(device_handles[i], &device_compute_properties));
                 if (ret != ZE_RESULT_SUCCESS) {
                     throw BaseException("zeDeviceGetComputeProperties()[" + zeResultErrorCodeStr(ret) + "]");
                 }
@@ -2113,7 +2531,7 @@ void DiagnosticManager::doDiagnosticPeformanceComputation(const ze_device_handle
                 timed = 0;
                 long double current;
                 // Vector width 1
-                timed = runKernel(command_queue, command_list, compute_sp_v1, workgroup_info, XPUM_DIAG_PERFORMANCE_COMPUTATION, checkOnly);
+                timed = runKernel(context, device_handles[i], command_queue, command_list, compute_sp_v1, workgroup_info, XPUM_DIAG_PERFORMANCE_COMPUTATION, checkOnly);
                 current = calculateGbps(timed, number_of_work_items * flops_per_work_item);
                 all_gflops[i] = std::max(all_gflops[i], current);
                 XPUM_LOG_INFO("compute sp vector width 1 done");
@@ -2156,8 +2574,8 @@ void DiagnosticManager::doDiagnosticPeformanceComputation(const ze_device_handle
     auto gflops_threshold = 0;
     auto ref_gflops = 0;
     if (device_names.find(ze_device) != device_names.end()) {
-        gflops_threshold = thresholds[device_names[ze_device]]["SINGLE_PRECISION_MIN_GFLOPS"];
-        ref_gflops = thresholds[device_names[ze_device]]["REF_SINGLE_PRECISION_GFLOPS"];
+        gflops_threshold = getThreshold(ze_device, "SINGLE_PRECISION_MIN_GFLOPS");
+        ref_gflops = getThreshold(ze_device, "REF_SINGLE_PRECISION_GFLOPS");
     }
     diagnostic_perf_datas[p_task_info->deviceId].gflops = all_gflops_value;
     diagnostic_perf_datas[p_task_info->deviceId].reference_gflops = ref_gflops;
@@ -2173,6 +2591,11 @@ void DiagnosticManager::doDiagnosticPeformanceComputation(const ze_device_handle
         desc += " " + compute_detail;
         desc += " Threshold is " + std::to_string(gflops_threshold) + " GFLOPS.";
         updateMessage(compute_component.message, desc);
+    } else if (checkOnly == false && checkReference(ze_device, "SINGLE_PRECISION_GFLOPS", all_gflops_value, "GFLOPS", compute_detail)) {
+        compute_component.result = xpum_diag_task_result_t::XPUM_DIAG_RESULT_FAIL;
+        std::string desc = "Fail to check computation performance.";
+        desc += " " + compute_detail;
+        updateMessage(compute_component.message, desc);
     } else {
         compute_component.result = xpum_diag_task_result_t::XPUM_DIAG_RESULT_PASS;
         if (checkOnly == true) {
@@ -2263,23 +2686,23 @@ void DiagnosticManager::doDiagnosticPeformancePower(const ze_device_handle_t &ze
                 auto current_sub_device_power_value_sum = 0;
                 ze_result_t res;
                 uint32_t power_domain_count = 0;
-                XPUM_ZE_HANDLE_LOCK(zes_device, res = zesDeviceEnumPowerDomains(zes_device, &power_domain_count, nullptr));
+                XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, res = zesDeviceEnumPowerDomains(zes_device, &power_domain_count, nullptr));
                 std::vector<zes_pwr_handle_t> power_handles(power_domain_count);
-                XPUM_ZE_HANDLE_LOCK(zes_device, res = zesDeviceEnumPowerDomains(zes_device, &power_domain_count, power_handles.data()));
+                XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, res = zesDeviceEnumPowerDomains(zes_device, &power_domain_count, power_handles.data()));
                 if (res == ZE_RESULT_SUCCESS) {
                     for (auto &power : power_handles) {
                         zes_power_properties_t props = {};
                         props.stype = ZES_STRUCTURE_TYPE_POWER_PROPERTIES;
                         props.pNext = nullptr;
-                        XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetProperties(power, &props));
+                        XPUM_ZE_HANDLE_SHARED_LOCK(power, res = zesPowerGetProperties(power, &props));
                         if (res != ZE_RESULT_SUCCESS) {
                             continue;
                         }
                         zes_power_energy_counter_t snap1, snap2;
-                        XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetEnergyCounter(power, &snap1));
+                        XPUM_ZE_HANDLE_SHARED_LOCK(power, res = zesPowerGetEnergyCounter(power, &snap1));
                         if (res == ZE_RESULT_SUCCESS) {
                             std::this_thread::sleep_for(std::chrono::milliseconds(Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE * 2));
-                            XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetEnergyCounter(power, &snap2));
+                            XPUM_ZE_HANDLE_SHARED_LOCK(power, res = zesPowerGetEnergyCounter(power, &snap2));
                             if (res == ZE_RESULT_SUCCESS) {
                                 int value = std::ceil((snap2.energy - snap1.energy) * 1.0 / (snap2.timestamp - snap1.timestamp));
                                 if (!props.onSubdevice) {
@@ -2319,7 +2742,7 @@ void DiagnosticManager::doDiagnosticPeformancePower(const ze_device_handle_t &ze
                 ze_device_properties_t device_properties;
                 device_properties.pNext = nullptr;
                 device_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
-                XPUM_ZE_HANDLE_LOCK(device_handles[i], ret = zeDeviceGetProperties(device_handles[i], &device_properties));
+                XPUM_ZE_HANDLE_SHARED_LOCK(device_handles[i], ret = zeDeviceGetProperties(device_handles[i], &device_properties));
                 if (ret != ZE_RESULT_SUCCESS) {
                     throw BaseException("zeDeviceGetProperties()[" + zeResultErrorCodeStr(ret) + "]");
                 }
@@ -2327,7 +2750,7 @@ void DiagnosticManager::doDiagnosticPeformancePower(const ze_device_handle_t &ze
                 ze_device_compute_properties_t device_compute_properties;
                 device_compute_properties.pNext = nullptr;
                 device_compute_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_COMPUTE_PROPERTIES;
-                XPUM_ZE_HANDLE_LOCK(device_handles[i], ret = zeDeviceGetComputeProperties(device_handles[i], &device_compute_properties));
+                XPUM_ZE_HANDLE_SHARED_LOCK(device_handles[i], ret = zeDeviceGetComputeProperties(device_handles[i], &device_compute_properties));
                 if (ret != ZE_RESULT_SUCCESS) {
                     throw BaseException("zeDeviceGetComputeProperties()[" + zeResultErrorCodeStr(ret) + "]");
                 }
@@ -2364,7 +2787,7 @@ void DiagnosticManager::doDiagnosticPeformancePower(const ze_device_handle_t &ze
 
                 timed = 0;
                 long double current;
-                timed = runKernel(command_queue, command_list, compute_int_v1, workgroup_info, XPUM_DIAG_PERFORMANCE_POWER);
+                timed = runKernel(context, device_handles[i], command_queue, command_list, compute_int_v1, workgroup_info, XPUM_DIAG_PERFORMANCE_POWER);
                 current = calculateGbps(timed, number_of_work_items * flops_per_work_item);
                 all_gflops[i] = std::max(all_gflops[i], current);
                 XPUM_LOG_INFO("compute int vector width 1 done");
@@ -2399,8 +2822,8 @@ void DiagnosticManager::doDiagnosticPeformancePower(const ze_device_handle_t &ze
     auto power_threshold = 0;
     auto ref_power = 0;
     if (device_names.find(ze_device) != device_names.end()) {
-        power_threshold = thresholds[device_names[ze_device]]["POWER_MIN_STRESS_WATT"];
-        ref_power = thresholds[device_names[ze_device]]["REF_POWER_STRESS_WATT"];
+        power_threshold = getThreshold(ze_device, "POWER_MIN_STRESS_WATT");
+        ref_power = getThreshold(ze_device, "REF_POWER_STRESS_WATT");
     }
     diagnostic_perf_datas[p_task_info->deviceId].peak_power = max_power_value;
     diagnostic_perf_datas[p_task_info->deviceId].reference_peak_power = ref_power;
@@ -2471,45 +2894,32 @@ void DiagnosticManager::setupFunction(ze_module_handle_t &module_handle, ze_kern
     kernelSetArgumentValue(function, 1, sizeof(output), &output);
 }
 
-long double DiagnosticManager::runKernel(ze_command_queue_handle_t command_queue, ze_command_list_handle_t command_list,
+long double DiagnosticManager::runKernel(const ze_context_handle_t &context, ze_device_handle_t ze_device,
+                                         ze_command_queue_handle_t command_queue, ze_command_list_handle_t command_list,
                                          ze_kernel_handle_t &function,
                                          struct ZeWorkGroups &workgroup_info, xpum_diag_task_type_t type, bool checkOnly) {
-    long double timed = 0;
-
     kernelSetGroupSize(function, workgroup_info.group_size_x, workgroup_info.group_size_y, workgroup_info.group_size_z);
     ze_group_count_t thread_group_dimensions;
     thread_group_dimensions.groupCountX = workgroup_info.group_count_x;
     thread_group_dimensions.groupCountY = workgroup_info.group_count_y;
     thread_group_dimensions.groupCountZ = workgroup_info.group_count_z;
-    commandListAppendLaunchKernel(command_list, function, &thread_group_dimensions);
-    commandListClose(command_list);
 
     // 1 round is good enough if it is not perf diag
     if (checkOnly == true) {
+        commandListAppendLaunchKernel(command_list, function, &thread_group_dimensions);
+        commandListClose(command_list);
         commandQueueExecuteCommandLists(command_queue, command_list);   
         commandQueueSynchronize(command_queue);
         return 0;
     }
 
-    // Consistent with ze_peak
-    uint32_t warmup_iterations = 5;
-    uint32_t iters = 20;
-    for (uint32_t i = 0; i < warmup_iterations; i++) {
-        commandQueueExecuteCommandLists(command_queue, command_list);
-        commandQueueSynchronize(command_queue);
-    }
-
-    std::chrono::high_resolution_clock::time_point time_start, time_end;
-    time_start = std::chrono::high_resolution_clock::now();
-    for (uint32_t i = 0; i < iters; i++) {
-        commandQueueExecuteCommandLists(command_queue, command_list);
-        commandQueueSynchronize(command_queue);
-    }
-    time_end = std::chrono::high_resolution_clock::now();
-    timed = std::chrono::duration<long double, std::chrono::nanoseconds::period>(time_end - time_start).count();
-    XPUM_LOG_DEBUG("runKernel - type: {}, iters: {}, total time: {}", type, iters, timed);
+    MicroBenchmark benchmark(context, ze_device);
+    MicroBenchmarkResult result = benchmark.run(command_queue, command_list, [&](ze_command_list_handle_t list) {
+        commandListAppendLaunchKernel(list, function, &thread_group_dimensions);
+    });
+    XPUM_LOG_DEBUG("runKernel - type: {}, iters: {}, median time: {}, stddev: {}", type, result.iterations, result.median_nsec, result.stddev_nsec);
     commandListReset(command_list);
-    return (timed / static_cast<long double>(iters));
+    return result.median_nsec;
 }
 
 long double DiagnosticManager::calculateGbps(long double period, long double total_gbps) {
@@ -2594,14 +3004,14 @@ void DiagnosticManager::doDiagnosticPeformanceMemoryBandwidth(const ze_device_ha
                     ze_device_properties_t device_properties;
                     device_properties.pNext = nullptr;
                     device_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
-                    XPUM_ZE_HANDLE_LOCK(device_handles[i], ret = zeDeviceGetProperties(device_handles[i], &device_properties));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(device_handles[i], ret = zeDeviceGetProperties(device_handles[i], &device_properties));
                     if (ret != ZE_RESULT_SUCCESS) {
                         throw BaseException("zeDeviceGetProperties()[" + zeResultErrorCodeStr(ret) + "]");
                     }
                     ze_device_compute_properties_t device_compute_properties;
                     device_compute_properties.pNext = nullptr;
                     device_compute_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_COMPUTE_PROPERTIES;
-                    XPUM_ZE_HANDLE_LOCK(device_handles[i], ret = zeDeviceGetComputeProperties(device_handles[i], &device_compute_properties));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(device_handles[i], ret = zeDeviceGetComputeProperties(device_handles[i], &device_compute_properties));
                     if (ret != ZE_RESULT_SUCCESS) {
                         throw BaseException("zeDeviceGetComputeProperties()[" + zeResultErrorCodeStr(ret) + "]");
                     }
@@ -2668,8 +3078,8 @@ void DiagnosticManager::doDiagnosticPeformanceMemoryBandwidth(const ze_device_ha
                     timed_go = 0;
                     temp_global_size = (num_items / 16);
                     setWorkgroups(device_compute_properties, temp_global_size, &workgroup_info);
-                    timed_lo = runKernel(command_queue, command_list, local_offset_v1, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
-                    timed_go = runKernel(command_queue, command_list, global_offset_v1, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
+                    timed_lo = runKernel(context, device_handles[i], command_queue, command_list, local_offset_v1, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
+                    timed_go = runKernel(context, device_handles[i], command_queue, command_list, global_offset_v1, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
                     timed = (timed_lo < timed_go) ? timed_lo : timed_go;
                     gbps = calculateGbps(timed, num_items * sizeof(float));
                     all_gbps[i] = std::max(all_gbps[i], gbps);
@@ -2679,8 +3089,8 @@ void DiagnosticManager::doDiagnosticPeformanceMemoryBandwidth(const ze_device_ha
                     timed_go = 0;
                     temp_global_size = (num_items / 2 / 16);
                     setWorkgroups(device_compute_properties, temp_global_size, &workgroup_info);
-                    timed_lo = runKernel(command_queue, command_list, local_offset_v2, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
-                    timed_go = runKernel(command_queue, command_list, global_offset_v2, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
+                    timed_lo = runKernel(context, device_handles[i], command_queue, command_list, local_offset_v2, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
+                    timed_go = runKernel(context, device_handles[i], command_queue, command_list, global_offset_v2, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
                     timed = (timed_lo < timed_go) ? timed_lo : timed_go;
                     gbps = calculateGbps(timed, num_items * sizeof(float));
                     all_gbps[i] = std::max(all_gbps[i], gbps);
@@ -2690,8 +3100,8 @@ void DiagnosticManager::doDiagnosticPeformanceMemoryBandwidth(const ze_device_ha
                     timed_go = 0;
                     temp_global_size = (num_items / 4 / 16);
                     setWorkgroups(device_compute_properties, temp_global_size, &workgroup_info);
-                    timed_lo = runKernel(command_queue, command_list, local_offset_v4, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
-                    timed_go = runKernel(command_queue, command_list, global_offset_v4, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
+                    timed_lo = runKernel(context, device_handles[i], command_queue, command_list, local_offset_v4, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
+                    timed_go = runKernel(context, device_handles[i], command_queue, command_list, global_offset_v4, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
                     timed = (timed_lo < timed_go) ? timed_lo : timed_go;
                     gbps = calculateGbps(timed, num_items * sizeof(float));
                     all_gbps[i] = std::max(all_gbps[i], gbps);
@@ -2701,8 +3111,8 @@ void DiagnosticManager::doDiagnosticPeformanceMemoryBandwidth(const ze_device_ha
                     timed_go = 0;
                     temp_global_size = (num_items / 8 / 16);
                     setWorkgroups(device_compute_properties, temp_global_size, &workgroup_info);
-                    timed_lo = runKernel(command_queue, command_list, local_offset_v8, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
-                    timed_go = runKernel(command_queue, command_list, global_offset_v8, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
+                    timed_lo = runKernel(context, device_handles[i], command_queue, command_list, local_offset_v8, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
+                    timed_go = runKernel(context, device_handles[i], command_queue, command_list, global_offset_v8, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
                     timed = (timed_lo < timed_go) ? timed_lo : timed_go;
                     gbps = calculateGbps(timed, num_items * sizeof(float));
                     all_gbps[i] = std::max(all_gbps[i], gbps);
@@ -2712,8 +3122,8 @@ void DiagnosticManager::doDiagnosticPeformanceMemoryBandwidth(const ze_device_ha
                     timed_go = 0;
                     temp_global_size = (num_items / 16 / 16);
                     setWorkgroups(device_compute_properties, temp_global_size, &workgroup_info);
-                    timed_lo = runKernel(command_queue, command_list, local_offset_v16, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
-                    timed_go = runKernel(command_queue, command_list, global_offset_v16, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
+                    timed_lo = runKernel(context, device_handles[i], command_queue, command_list, local_offset_v16, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
+                    timed_go = runKernel(context, device_handles[i], command_queue, command_list, global_offset_v16, workgroup_info, XPUM_DIAG_PERFORMANCE_MEMORY_BANDWIDTH);
                     timed = (timed_lo < timed_go) ? timed_lo : timed_go;
                     gbps = calculateGbps(timed, num_items * sizeof(float));
                     all_gbps[i] = std::max(all_gbps[i], gbps);
@@ -2765,8 +3175,8 @@ void DiagnosticManager::doDiagnosticPeformanceMemoryBandwidth(const ze_device_ha
         auto memorybandwidth_threshold = 0;
         auto ref_memorybandwidth = 0;
         if (device_names.find(ze_device) != device_names.end()) {
-            memorybandwidth_threshold = thresholds[device_names[ze_device]]["MEMORY_BANDWIDTH_MIN_GBPS"];
-            ref_memorybandwidth = thresholds[device_names[ze_device]]["REF_MEMORY_BANDWIDTH_GBPS"];
+            memorybandwidth_threshold = getThreshold(ze_device, "MEMORY_BANDWIDTH_MIN_GBPS");
+            ref_memorybandwidth = getThreshold(ze_device, "REF_MEMORY_BANDWIDTH_GBPS");
         }
         diagnostic_perf_datas[p_task_info->deviceId].memory_bandwidth = all_gbps_value;
         diagnostic_perf_datas[p_task_info->deviceId].reference_memory_bandwidth = ref_memorybandwidth;
@@ -2782,6 +3192,11 @@ void DiagnosticManager::doDiagnosticPeformanceMemoryBandwidth(const ze_device_ha
             desc += " " + memorybandwidth_detail;
             desc += " Threshold is " + std::to_string(memorybandwidth_threshold) + " GBPS.";
             updateMessage(memorybandwidth_component.message, desc);
+        } else if (checkReference(ze_device, "MEMORY_BANDWIDTH_GBPS", all_gbps_value, "GBPS", memorybandwidth_detail)) {
+            memorybandwidth_component.result = xpum_diag_task_result_t::XPUM_DIAG_RESULT_FAIL;
+            std::string desc = "Fail to check memory bandwidth.";
+            desc += " " + memorybandwidth_detail;
+            updateMessage(memorybandwidth_component.message, desc);
         } else {
             memorybandwidth_component.result = xpum_diag_task_result_t::XPUM_DIAG_RESULT_PASS;
             std::string desc = "Pass to check memory bandwidth.";
@@ -2808,7 +3223,7 @@ void DiagnosticManager::doDiagnosticPeformanceMemoryBandwidth(const ze_device_ha
 }
 
 xpum_result_t DiagnosticManager::getDiagnosticsXeLinkThroughputResult(xpum_device_id_t deviceId, xpum_diag_xe_link_throughput_t resultList[], int *count) {
-    if (this->p_device_manager->getDevice(std::to_string(deviceId)) == nullptr) {
+    if (this->p_device_manager->getDevice(deviceId) == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
 
@@ -2876,12 +3291,12 @@ xpum_result_t DiagnosticManager::getDiagnosticsXeLinkThroughputResult(xpum_devic
 void DiagnosticManager::getXeLinkPortTransmitCounters(const zes_device_handle_t& zes_device, int32_t device_id, std::map<std::vector<int32_t>, uint64_t>& tx_counters, double& max_speed) {
     ze_result_t ret;
     uint32_t fabric_port_count = 0;
-    XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesDeviceEnumFabricPorts(zes_device, &fabric_port_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, ret = zesDeviceEnumFabricPorts(zes_device, &fabric_port_count, nullptr));
     if (ret != ZE_RESULT_SUCCESS) {
         throw BaseException("zesDeviceEnumFabricPorts()[" + zeResultErrorCodeStr(ret) + "]");
     }
     std::vector<zes_fabric_port_handle_t> fabric_ports(fabric_port_count);
-    XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesDeviceEnumFabricPorts(zes_device, &fabric_port_count, fabric_ports.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, ret = zesDeviceEnumFabricPorts(zes_device, &fabric_port_count, fabric_ports.data()));
     if (ret != ZE_RESULT_SUCCESS) {
         throw BaseException("zesDeviceEnumFabricPorts()[" + zeResultErrorCodeStr(ret) + "]");
     }
@@ -2892,7 +3307,7 @@ void DiagnosticManager::getXeLinkPortTransmitCounters(const zes_device_handle_t&
         zes_fabric_port_properties_t properties;
         properties.stype = ZES_STRUCTURE_TYPE_FABRIC_PORT_PROPERTIES;
         properties.pNext = nullptr;
-        XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesFabricPortGetProperties(fabric_port, &properties));
+        XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, ret = zesFabricPortGetProperties(fabric_port, &properties));
         if (ret != ZE_RESULT_SUCCESS) {
             throw BaseException("zesFabricPortGetProperties()[" + zeResultErrorCodeStr(ret) + "]");
         }
@@ -2900,7 +3315,7 @@ void DiagnosticManager::getXeLinkPortTransmitCounters(const zes_device_handle_t&
         zes_fabric_port_state_t state;
         state.stype = ZES_STRUCTURE_TYPE_FABRIC_PORT_STATE;
         state.pNext = nullptr;
-        XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesFabricPortGetState(fabric_port, &state));
+        XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, ret = zesFabricPortGetState(fabric_port, &state));
         if (ret != ZE_RESULT_SUCCESS) {
             // workaround for zesFabricPortGetState not ready
             XPUM_LOG_DEBUG("failed to invoke zesFabricPortGetState() on deviceId: {}, tileId: {}, portId: {}, result: {}", 
@@ -2912,7 +3327,7 @@ void DiagnosticManager::getXeLinkPortTransmitCounters(const zes_device_handle_t&
                 int cnt = 0;
                 while (ret != ZE_RESULT_SUCCESS && cnt < 2) {
                     std::this_thread::sleep_for(std::chrono::milliseconds(50));
-                    XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesFabricPortGetState(fabric_port, &state));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, ret = zesFabricPortGetState(fabric_port, &state));
                     cnt += 1;
                 }
             } 
@@ -2927,7 +3342,7 @@ void DiagnosticManager::getXeLinkPortTransmitCounters(const zes_device_handle_t&
         }
 
         zes_fabric_port_throughput_t fabric_port_throughput;
-        XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesFabricPortGetThroughput(fabric_port, &fabric_port_throughput));
+        XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, ret = zesFabricPortGetThroughput(fabric_port, &fabric_port_throughput));
         if (ret != ZE_RESULT_SUCCESS) {
             throw BaseException("zesFabricPortGetThroughput()[" + zeResultErrorCodeStr(ret) + "]");
         }
@@ -3079,7 +3494,7 @@ void DiagnosticManager::doDiagnosticXeLinkThroughput(const ze_device_handle_t &z
     else
         diagnostic_perf_datas[p_task_info->deviceId].reference_xe_link_throughtput = REF_XE_LINK_THROUGHPUT_ONE_TILE_DEVICE;
     uint32_t fabric_port_count = 0;
-    XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesDeviceEnumFabricPorts(zes_device, &fabric_port_count, nullptr));
+    XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, ret = zesDeviceEnumFabricPorts(zes_device, &fabric_port_count, nullptr));
     if (fabric_port_count == 0) {
         XPUM_LOG_DEBUG("Target device GPU {} xe link port not found", device_id);
     }
@@ -3090,7 +3505,7 @@ void DiagnosticManager::doDiagnosticXeLinkThroughput(const ze_device_handle_t &z
         return;
     }
     std::vector<zes_fabric_port_handle_t> fabric_ports(fabric_port_count);
-    XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesDeviceEnumFabricPorts(zes_device, &fabric_port_count, fabric_ports.data()));
+    XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, ret = zesDeviceEnumFabricPorts(zes_device, &fabric_port_count, fabric_ports.data()));
     if (ret != ZE_RESULT_SUCCESS) {
         throw BaseException("zesDeviceEnumFabricPorts()[" + zeResultErrorCodeStr(ret) + "]");
     }
@@ -3099,7 +3514,7 @@ void DiagnosticManager::doDiagnosticXeLinkThroughput(const ze_device_handle_t &z
         zes_fabric_port_state_t state;
         state.stype = ZES_STRUCTURE_TYPE_FABRIC_PORT_STATE;
         state.pNext = nullptr;
-        XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesFabricPortGetState(fabric_port, &state));
+        XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, ret = zesFabricPortGetState(fabric_port, &state));
         if (ret == ZE_RESULT_SUCCESS) {
             XPUM_LOG_DEBUG("GPU {} fabric port status {}", device_id, state.status);
             if (state.status != ZES_FABRIC_PORT_STATUS_HEALTHY && state.status != ZES_FABRIC_PORT_STATUS_DEGRADED) {
@@ -3122,12 +3537,12 @@ void DiagnosticManager::doDiagnosticXeLinkThroughput(const ze_device_handle_t &z
         int peer_device_id = std::stoi(device->getId());
         ze_result_t ret;
         uint32_t fabric_port_count = 0;
-        XPUM_ZE_HANDLE_LOCK(peer_zes_device, ret = zesDeviceEnumFabricPorts(peer_zes_device, &fabric_port_count, nullptr));
+        XPUM_ZE_HANDLE_SHARED_LOCK(peer_zes_device, ret = zesDeviceEnumFabricPorts(peer_zes_device, &fabric_port_count, nullptr));
         if (ret != ZE_RESULT_SUCCESS) {
             continue;
         }
         std::vector<zes_fabric_port_handle_t> fabric_ports(fabric_port_count);
-        XPUM_ZE_HANDLE_LOCK(peer_zes_device, ret = zesDeviceEnumFabricPorts(peer_zes_device, &fabric_port_count, fabric_ports.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(peer_zes_device, ret = zesDeviceEnumFabricPorts(peer_zes_device, &fabric_port_count, fabric_ports.data()));
         if (ret != ZE_RESULT_SUCCESS) {
             continue;
         }
@@ -3139,7 +3554,7 @@ void DiagnosticManager::doDiagnosticXeLinkThroughput(const ze_device_handle_t &z
             zes_fabric_port_properties_t properties;
             properties.stype = ZES_STRUCTURE_TYPE_FABRIC_PORT_PROPERTIES;
             properties.pNext = nullptr;
-            XPUM_ZE_HANDLE_LOCK(peer_zes_device, ret = zesFabricPortGetProperties(fabric_port, &properties));
+            XPUM_ZE_HANDLE_SHARED_LOCK(peer_zes_device, ret = zesFabricPortGetProperties(fabric_port, &properties));
             if (ret != ZE_RESULT_SUCCESS) {
                 continue;
             } else {
@@ -3152,7 +3567,7 @@ void DiagnosticManager::doDiagnosticXeLinkThroughput(const ze_device_handle_t &z
             continue;
         
         ze_bool_t can_access;
-        XPUM_ZE_HANDLE_LOCK(ze_device, ret = zeDeviceCanAccessPeer(ze_device, peer_ze_device, &can_access));
+        XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceCanAccessPeer(ze_device, peer_ze_device, &can_access));
         if (ret == ZE_RESULT_SUCCESS) {
             if (can_access == 1) {
                 test_pairs.push_back(std::make_tuple(ze_device, zes_device, device_id, peer_ze_device, peer_zes_device, peer_device_id));
@@ -3165,7 +3580,7 @@ void DiagnosticManager::doDiagnosticXeLinkThroughput(const ze_device_handle_t &z
                     zes_fabric_port_state_t state;
                     state.stype = ZES_STRUCTURE_TYPE_FABRIC_PORT_STATE;
                     state.pNext = nullptr;
-                    XPUM_ZE_HANDLE_LOCK(peer_ze_device, ret = zesFabricPortGetState(fabric_port, &state));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(peer_ze_device, ret = zesFabricPortGetState(fabric_port, &state));
                     if (ret == ZE_RESULT_SUCCESS) {
                         XPUM_LOG_DEBUG("Peer GPU {} fabric port status {}", peer_device_id, state.status);
                         if (state.status != ZES_FABRIC_PORT_STATUS_HEALTHY && state.status != ZES_FABRIC_PORT_STATUS_DEGRADED) {
@@ -3233,6 +3648,17 @@ void DiagnosticManager::doDiagnosticXeLinkThroughput(const ze_device_handle_t &z
             break;   
         }
     } 
+    auto &link_throughputs = diagnostic_perf_datas[device_id].xe_link_throughtput;
+    if (xe_link_throughput_component.result == xpum_diag_task_result_t::XPUM_DIAG_RESULT_PASS && !link_throughputs.empty()) {
+        double mean_throughput = std::accumulate(link_throughputs.begin(), link_throughputs.end(), 0.0) / link_throughputs.size();
+        std::string desc = " Its mean Xe Link throughput is " + roundDouble(mean_throughput, 3) + " GBPS.";
+        if (checkReference(ze_device, "XE_LINK_THROUGHPUT_GBPS", mean_throughput, "GBPS", desc)) {
+            xe_link_throughput_component.result = xpum_diag_task_result_t::XPUM_DIAG_RESULT_FAIL;
+            updateMessage(xe_link_throughput_component.message, "Fail to check Xe Link throughput." + desc);
+        } else {
+            updateMessage(xe_link_throughput_component.message, "Pass to check Xe Link throughput." + desc);
+        }
+    }
     subtask_done.store(true);
     read_temperature_thread.join();
     XPUM_LOG_INFO("read temperature thread end");
@@ -3244,6 +3670,9 @@ void DiagnosticManager::doDiagnosticXeLinkThroughput(const ze_device_handle_t &z
     xe_link_throughput_component.finished = true;    
 }
 
+// the command queue group of the link copy engines
+static const uint32_t XE_LINK_COPY_ENGINE_GROUP = 2;
+
 void set_up_buffers(const ze_context_handle_t &context, std::vector<uint32_t> device_ids, std::vector<ze_device_handle_t> ze_devices,
             std::vector<void *> &ze_src_buffers, std::vector<void *> &ze_dst_buffers, char * &ze_host_buffer,
             int number_buffer_elements, size_t &buffer_size) {
@@ -3289,38 +3718,92 @@ void initialize_buffers(const ze_context_handle_t &context, std::vector<uint32_t
     }
 }
 
-void perform_copy(std::vector<uint32_t> device_ids, std::vector<DeviceCmdQueueAndListPairs> ze_peer_devices, std::vector<uint32_t> queues,
+// a copy engine of a device and the Xe Links it copies over
+struct XeLinkCopyEngine {
+    uint32_t device_id;
+    uint32_t engine_index;
+    ze_command_queue_handle_t command_queue;
+    std::vector<uint32_t> remote_device_ids;
+    // two batches queued in turn, so the engine has work while the host handles the other one
+    ze_command_list_handle_t command_lists[2];
+    ze_event_handle_t events[2];
+    // the global timestamps before and after each copy of the batches
+    uint64_t *timestamps;
+    // the device time of the batches and of the copies to each remote device, in ns
+    double busy_time;
+    std::vector<double> link_times;
+};
+
+/*
+  Copy from each device to the devices it has Xe Link to, keeping all link copy
+  engines busy, and return the tx throughput of each device in GB/s.
+
+  The engines of a device are spread over its links: a link gets several engines if
+  there are more engines than links, otherwise an engine takes several links. Each
+  engine runs a number of batches, one copy per link each, measured by device
+  timestamps around the copies.
+*/
+static std::vector<double> perform_copy(const ze_context_handle_t &context, std::vector<uint32_t> device_ids, std::vector<ze_device_handle_t> ze_devices,
+                    std::vector<DeviceCmdQueueAndListPairs> ze_peer_devices, std::vector<uint32_t> queues,
                     std::vector<void *> ze_src_buffers, std::vector<void *> ze_dst_buffers, size_t buffer_size, std::vector<std::vector<bool>> hasXeLink) {
     size_t num_engines = queues.size();
     size_t chunk = buffer_size / num_engines;
+    std::vector<double> ns_per_ticks(ze_devices.size(), 1);
+    std::vector<uint64_t> timestamp_masks(ze_devices.size(), UINT64_MAX);
+    std::vector<XeLinkCopyEngine> engines;
     for (auto local_device_id : device_ids) {
+        std::vector<uint32_t> links;
         for (auto remote_device_id : device_ids) {
-            if (local_device_id == remote_device_id || !hasXeLink[local_device_id][remote_device_id])
-                continue;
-
-            void *dst_buffer = ze_dst_buffers[remote_device_id];
-            void *src_buffer = ze_src_buffers[local_device_id];
-
-            for (size_t e = 0; e < num_engines; e++) {
-                ze_command_list_handle_t command_list = ze_peer_devices[local_device_id].engines[e].second;
+            if (local_device_id != remote_device_id && hasXeLink[local_device_id][remote_device_id])
+                links.push_back(remote_device_id);
+        }
+        if (links.empty())
+            continue;
+        MicroBenchmark::getDeviceTimer(ze_devices[local_device_id], ns_per_ticks[local_device_id], timestamp_masks[local_device_id]);
+        for (size_t e = 0; e < num_engines; e++) {
+            XeLinkCopyEngine engine = {};
+            engine.device_id = local_device_id;
+            engine.engine_index = e;
+            engine.command_queue = ze_peer_devices[local_device_id].engines[e].first;
+            for (size_t j = 0; j < links.size(); j++) {
+                if (links.size() >= num_engines ? j % num_engines == e : e % links.size() == j)
+                    engine.remote_device_ids.push_back(links[j]);
+            }
+            engine.link_times.resize(engine.remote_device_ids.size(), 0);
+            engines.push_back(engine);
+        }
+    }
+    if (engines.empty())
+        return std::vector<double>(ze_devices.size(), 0);
+
+    ze_event_pool_handle_t event_pool;
+    eventPoolCreate(context, engines.size() * 2, &event_pool);
+    for (size_t i = 0; i < engines.size(); i++) {
+        auto &engine = engines[i];
+        size_t num_links = engine.remote_device_ids.size();
+        void *timestamps = nullptr;
+        memoryAllocHost(context, 2 * 2 * num_links * sizeof(uint64_t), sizeof(uint64_t), &timestamps);
+        engine.timestamps = static_cast<uint64_t *>(timestamps);
+        for (int slot = 0; slot < 2; slot++) {
+            eventCreate(event_pool, i * 2 + slot, &engine.events[slot]);
+            commandListCreate(context, ze_devices[engine.device_id], XE_LINK_COPY_ENGINE_GROUP, &engine.command_lists[slot]);
+            ze_command_list_handle_t command_list = engine.command_lists[slot];
+            uint64_t *slot_timestamps = engine.timestamps + slot * 2 * num_links;
+            size_t offset = engine.engine_index * chunk;
+            for (size_t k = 0; k < num_links; k++) {
+                commandListAppendWriteGlobalTimestamp(command_list, slot_timestamps + 2 * k);
                 commandListAppendMemoryCopy(command_list,
-                    reinterpret_cast<void *>(reinterpret_cast<uint64_t>(dst_buffer) + e * chunk),
-                    reinterpret_cast<void *>(reinterpret_cast<uint64_t>(src_buffer) + e * chunk), chunk);
+                    reinterpret_cast<void *>(reinterpret_cast<uint64_t>(ze_dst_buffers[engine.remote_device_ids[k]]) + offset),
+                    reinterpret_cast<void *>(reinterpret_cast<uint64_t>(ze_src_buffers[engine.device_id]) + offset), chunk);
+                // the end timestamp is written after the copy has completed
+                commandListAppendBarrier(command_list);
+                commandListAppendWriteGlobalTimestamp(command_list, slot_timestamps + 2 * k + 1);
             }
+            commandListAppendSignalEvent(command_list, engine.events[slot]);
+            commandListClose(command_list);
         }
     }
 
-    for (auto local_device_id : device_ids) {
-        for (auto remote_device_id : device_ids) {
-            if (local_device_id == remote_device_id || !hasXeLink[local_device_id][remote_device_id])
-                continue;
-
-            for (size_t e = 0; e < num_engines; e++) {
-                ze_command_list_handle_t command_list = ze_peer_devices[local_device_id].engines[e].second;
-                commandListClose(command_list);
-            }
-        }
-    }
     int round = 1000;
     //  Not take too long when there are 8+ devices/tiles
     if (device_ids.size() >= 16)
@@ -3328,39 +3811,54 @@ void perform_copy(std::vector<uint32_t> device_ids, std::vector<DeviceCmdQueueAn
     else if (device_ids.size() >= 8)
         round = 400;
     XPUM_LOG_INFO("actual round for xe link all-to-all copy: {}", round);
+    for (auto &engine : engines) {
+        for (int slot = 0; slot < 2 && slot < round; slot++)
+            commandQueueExecuteCommandLists(engine.command_queue, engine.command_lists[slot]);
+    }
     for (int i = 0; i < round; i++) {
-        for (auto local_device_id : device_ids) {
-            for (auto remote_device_id : device_ids) {
-                if (local_device_id == remote_device_id || !hasXeLink[local_device_id][remote_device_id])
-                    continue;
-
-                uint32_t device_id = local_device_id;
-
-                for (size_t e = 0; e < num_engines; e++) {
-                    ze_command_list_handle_t command_list = ze_peer_devices[device_id].engines[e].second;
-                    ze_command_queue_handle_t command_queue = ze_peer_devices[device_id].engines[e].first;
-                    commandQueueExecuteCommandLists(command_queue, command_list);
-                }
+        int slot = i % 2;
+        for (auto &engine : engines) {
+            eventHostSynchronize(engine.events[slot]);
+            size_t num_links = engine.remote_device_ids.size();
+            const uint64_t *slot_timestamps = engine.timestamps + slot * 2 * num_links;
+            uint64_t mask = timestamp_masks[engine.device_id];
+            double ns_per_tick = ns_per_ticks[engine.device_id];
+            for (size_t k = 0; k < num_links; k++) {
+                engine.link_times[k] += ((slot_timestamps[2 * k + 1] - slot_timestamps[2 * k]) & mask) * ns_per_tick;
             }
+            engine.busy_time += ((slot_timestamps[2 * num_links - 1] - slot_timestamps[0]) & mask) * ns_per_tick;
+            eventHostReset(engine.events[slot]);
+            if (i + 2 < round)
+                commandQueueExecuteCommandLists(engine.command_queue, engine.command_lists[slot]);
         }
+    }
 
-        for (auto local_device_id : device_ids) {
-            for (auto remote_device_id : device_ids) {
-                if (local_device_id == remote_device_id || !hasXeLink[local_device_id][remote_device_id])
-                    continue;
-
-                for (size_t e = 0; e < num_engines; e++) {
-                    ze_command_queue_handle_t command_queue = ze_peer_devices[local_device_id].engines[e].first;
-                    commandQueueSynchronize(command_queue);
-                }
-            }
+    // bytes per ns is GB/s
+    std::vector<double> throughputs(ze_devices.size(), 0);
+    std::map<std::pair<uint32_t, uint32_t>, double> link_throughputs;
+    for (auto &engine : engines) {
+        double bytes = (double)round * chunk;
+        if (engine.busy_time > 0)
+            throughputs[engine.device_id] += bytes * engine.remote_device_ids.size() / engine.busy_time;
+        for (size_t k = 0; k < engine.remote_device_ids.size(); k++) {
+            if (engine.link_times[k] > 0)
+                link_throughputs[std::make_pair(engine.device_id, engine.remote_device_ids[k])] += bytes / engine.link_times[k];
         }
     }
+    for (auto &link_throughput : link_throughputs) {
+        XPUM_LOG_DEBUG("xe link all-to-all copy of {} bytes: local id {} - remote id {} throughput(GB/s): {}", chunk,
+                       link_throughput.first.first, link_throughput.first.second, link_throughput.second);
+    }
 
-    for (auto local_device_id : device_ids)
-        for (size_t e = 0; e < num_engines; e++) {
-            commandListReset(ze_peer_devices[local_device_id].engines[e].second);
+    for (auto &engine : engines) {
+        for (int slot = 0; slot < 2; slot++) {
+            commandListDestroy(engine.command_lists[slot]);
+            eventDestroy(engine.events[slot]);
         }
+        memoryFree(context, engine.timestamps);
+    }
+    eventPoolDestroy(event_pool);
+    return throughputs;
 }
 
 void free_buffers(const ze_context_handle_t &context, std::vector<uint32_t> device_ids, 
@@ -3379,7 +3877,8 @@ void free_buffers(const ze_context_handle_t &context, std::vector<uint32_t> devi
     memoryFree(context, ze_host_buffer);
 }
 
-void xe_link_all_to_all_parallel_copy(const ze_driver_handle_t &ze_driver, std::vector<ze_device_handle_t> all_ze_devices, std::vector<std::vector<bool>> hasXeLink) {
+// return the highest tx throughput of each device over the buffer sizes, in GB/s
+std::vector<double> xe_link_all_to_all_parallel_copy(const ze_driver_handle_t &ze_driver, std::vector<ze_device_handle_t> all_ze_devices, std::vector<std::vector<bool>> hasXeLink) {
     std::vector<uint32_t> device_ids{};
     for (uint32_t i = 0; i < all_ze_devices.size(); i++) {
         device_ids.push_back(i);
@@ -3401,13 +3900,13 @@ void xe_link_all_to_all_parallel_copy(const ze_driver_handle_t &ze_driver, std::
 
     for (uint32_t d = 0; d < flat_device_count; d++) {
         uint32_t numQueueGroups = 0;
-        XPUM_ZE_HANDLE_LOCK(all_ze_devices[d], ret = zeDeviceGetCommandQueueGroupProperties(all_ze_devices[d], &numQueueGroups, nullptr));
+        XPUM_ZE_HANDLE_SHARED_LOCK(all_ze_devices[d], ret = zeDeviceGetCommandQueueGroupProperties(all_ze_devices[d], &numQueueGroups, nullptr));
         if (ret != ZE_RESULT_SUCCESS) {
             throw BaseException("zeDeviceGetCommandQueueGroupProperties()[" + zeResultErrorCodeStr(ret) + "]");
         }
         std::vector<ze_command_queue_group_properties_t> queueProperties;
         queueProperties.resize(numQueueGroups);
-        XPUM_ZE_HANDLE_LOCK(all_ze_devices[d], ret = zeDeviceGetCommandQueueGroupProperties(all_ze_devices[d], &numQueueGroups, queueProperties.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(all_ze_devices[d], ret = zeDeviceGetCommandQueueGroupProperties(all_ze_devices[d], &numQueueGroups, queueProperties.data()));
         if (ret != ZE_RESULT_SUCCESS) {
             throw BaseException("zeDeviceGetCommandQueueGroupProperties()[" + zeResultErrorCodeStr(ret) + "]");
         }
@@ -3415,7 +3914,7 @@ void xe_link_all_to_all_parallel_copy(const ze_driver_handle_t &ze_driver, std::
         for (uint32_t g = 0; g < numQueueGroups; g++) {
             for (uint32_t q = 0; q < queueProperties[g].numQueues; q++) {
                 // g0: compute g1: main copy g2: link copy 
-                if (g == 2) {
+                if (g == XE_LINK_COPY_ENGINE_GROUP) {
                     ze_command_queue_handle_t command_queue;
                     commandQueueCreate(context, all_ze_devices[d], g, q, &command_queue);
 
@@ -3432,6 +3931,7 @@ void xe_link_all_to_all_parallel_copy(const ze_driver_handle_t &ze_driver, std::
     for (std::size_t i = 0; i < ze_peer_devices.front().engines.size(); i++)
         queues.push_back(i);
 
+    std::vector<double> throughputs(flat_device_count, 0);
     size_t buffer_size = 0;
     // The buffer size may have impacts on peak throughput and here we adopt the range from 4MiB to 64 MiB.
     for (int step = 4; step <= 64; step *= 2) {
@@ -3442,7 +3942,9 @@ void xe_link_all_to_all_parallel_copy(const ze_driver_handle_t &ze_driver, std::
 
         initialize_buffers(context, device_ids, ze_peer_devices, ze_src_buffers, ze_host_buffer, buffer_size);
 
-        perform_copy(device_ids, ze_peer_devices, queues, ze_src_buffers, ze_dst_buffers, buffer_size, hasXeLink);
+        std::vector<double> step_throughputs = perform_copy(context, device_ids, all_ze_devices, ze_peer_devices, queues, ze_src_buffers, ze_dst_buffers, buffer_size, hasXeLink);
+        for (std::size_t d = 0; d < flat_device_count; d++)
+            throughputs[d] = std::max(throughputs[d], step_throughputs[d]);
 
         free_buffers(context, device_ids, ze_src_buffers, ze_dst_buffers, ze_host_buffer);
     }
@@ -3455,6 +3957,207 @@ void xe_link_all_to_all_parallel_copy(const ze_driver_handle_t &ze_driver, std::
         }
     }
     contextDestroy(context);
+    return throughputs;
+}
+
+void DiagnosticManager::measureXeLinkUniBandwidth(const ze_driver_handle_t &ze_driver, ze_device_handle_t src_device, ze_device_handle_t dst_device,
+                                                  const std::vector<int> &copy_engine_groups, int &copy_engine_group, double &bandwidth, double &latency) {
+    size_t mem_size = 67108864; /* 64 MiB */
+    size_t small_size = 4096;
+    ze_context_handle_t context;
+    contextCreate(ze_driver, &context);
+    void *src_region = nullptr;
+    memoryAlloc(context, src_device, mem_size, 1, &src_region);
+    void *dst_region = nullptr;
+    memoryAlloc(context, dst_device, mem_size, 1, &dst_region);
+
+    copy_engine_group = -1;
+    bandwidth = 0;
+    latency = 0;
+    for (auto group : copy_engine_groups) {
+        ze_command_list_handle_t cmd_list;
+        ze_command_queue_handle_t cmd_queue;
+        commandListCreate(context, src_device, group, &cmd_list);
+        commandQueueCreate(context, src_device, group, 0, &cmd_queue);
+        MicroBenchmarkResult large_result, small_result;
+        {
+            MicroBenchmark benchmark(context, src_device);
+            large_result = benchmark.run(cmd_queue, cmd_list, [&](ze_command_list_handle_t list) {
+                commandListAppendMemoryCopy(list, dst_region, src_region, mem_size);
+            });
+            commandListReset(cmd_list);
+            small_result = benchmark.run(cmd_queue, cmd_list, [&](ze_command_list_handle_t list) {
+                commandListAppendMemoryCopy(list, dst_region, src_region, small_size);
+            });
+        }
+        commandQueueDestroy(cmd_queue);
+        commandListDestroy(cmd_list);
+
+        // bytes per nanosecond is GBPS
+        double group_bandwidth = large_result.median_nsec > 0 ? mem_size / large_result.median_nsec : 0;
+        XPUM_LOG_DEBUG("Xe Link matrix - copy engine group {}: {} GBPS, {} us", group, group_bandwidth, small_result.min_nsec / 1000);
+        if (group_bandwidth > bandwidth) {
+            bandwidth = group_bandwidth;
+            copy_engine_group = group;
+            latency = small_result.min_nsec / 1000;
+        }
+    }
+
+    memoryFree(context, src_region);
+    memoryFree(context, dst_region);
+    contextDestroy(context);
+}
+
+double DiagnosticManager::measureXeLinkBiBandwidth(const ze_driver_handle_t &ze_driver, ze_device_handle_t device_a, int group_a,
+                                                  ze_device_handle_t device_b, int group_b) {
+    size_t mem_size = 67108864; /* 64 MiB */
+    int warmup_iterations = 2;
+    int iterations = 10;
+    ze_context_handle_t context;
+    contextCreate(ze_driver, &context);
+    void *region_a = nullptr;
+    memoryAlloc(context, device_a, mem_size * 2, 1, &region_a);
+    void *region_b = nullptr;
+    memoryAlloc(context, device_b, mem_size * 2, 1, &region_b);
+    // each side copies the first half of its memory to the second half of the peer memory
+    void *half_a = static_cast<void *>(static_cast<uint8_t *>(region_a) + mem_size);
+    void *half_b = static_cast<void *>(static_cast<uint8_t *>(region_b) + mem_size);
+
+    ze_command_list_handle_t cmd_list_a, cmd_list_b;
+    ze_command_queue_handle_t cmd_queue_a, cmd_queue_b;
+    commandListCreate(context, device_a, group_a, &cmd_list_a);
+    commandQueueCreate(context, device_a, group_a, 0, &cmd_queue_a);
+    commandListCreate(context, device_b, group_b, &cmd_list_b);
+    commandQueueCreate(context, device_b, group_b, 0, &cmd_queue_b);
+    commandListAppendMemoryCopy(cmd_list_a, half_b, region_a, mem_size);
+    commandListClose(cmd_list_a);
+    commandListAppendMemoryCopy(cmd_list_b, half_a, region_b, mem_size);
+    commandListClose(cmd_list_b);
+
+    std::chrono::high_resolution_clock::time_point start_time;
+    for (int i = 0; i < warmup_iterations + iterations; i++) {
+        if (i == warmup_iterations)
+            start_time = std::chrono::high_resolution_clock::now();
+        commandQueueExecuteCommandLists(cmd_queue_a, cmd_list_a);
+        commandQueueExecuteCommandLists(cmd_queue_b, cmd_list_b);
+        commandQueueSynchronize(cmd_queue_a);
+        commandQueueSynchronize(cmd_queue_b);
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+
+    commandQueueDestroy(cmd_queue_a);
+    commandListDestroy(cmd_list_a);
+    commandQueueDestroy(cmd_queue_b);
+    commandListDestroy(cmd_list_b);
+    memoryFree(context, region_a);
+    memoryFree(context, region_b);
+    contextDestroy(context);
+
+    auto total_time_nsec = std::chrono::duration<long double, std::chrono::nanoseconds::period>(end_time - start_time).count();
+    return total_time_nsec > 0 ? 2.0 * mem_size * iterations / total_time_nsec : 0;
+}
+
+void DiagnosticManager::doXeLinkMatrix(std::vector<std::shared_ptr<Device>> matrix_devices) {
+    struct Endpoint {
+        ze_device_handle_t ze_device;
+        ze_driver_handle_t ze_driver;
+        xpum_device_id_t device_id;
+        int32_t tile_id;
+    };
+    // the tiles of the devices, or the device itself if it has no subdevice
+    std::vector<Endpoint> endpoints;
+    for (auto device : matrix_devices) {
+        ze_device_handle_t ze_device = device->getDeviceZeHandle();
+        xpum_device_id_t device_id = std::stoi(device->getId());
+        ze_result_t ret;
+        uint32_t subdevice_count = 0;
+        XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetSubDevices(ze_device, &subdevice_count, nullptr));
+        std::vector<ze_device_handle_t> subdevices(subdevice_count);
+        if (ret == ZE_RESULT_SUCCESS && subdevice_count > 0) {
+            XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetSubDevices(ze_device, &subdevice_count, subdevices.data()));
+        }
+        if (ret != ZE_RESULT_SUCCESS || subdevice_count == 0) {
+            endpoints.push_back({ze_device, device->getDriverHandle(), device_id, 0});
+            continue;
+        }
+        for (uint32_t i = 0; i < subdevice_count; i++) {
+            endpoints.push_back({subdevices[i], device->getDriverHandle(), device_id, (int32_t)i});
+        }
+    }
+
+    std::vector<xpum_xe_link_matrix_entry_t> entries;
+    // (src endpoint, dst endpoint) to its entry
+    std::map<std::pair<size_t, size_t>, size_t> entry_indexes;
+    std::map<size_t, std::vector<int>> endpoint_groups;
+    for (size_t i = 0; i < endpoints.size(); i++) {
+        for (size_t j = 0; j < endpoints.size(); j++) {
+            auto &src = endpoints[i];
+            auto &dst = endpoints[j];
+            if (i == j || src.ze_driver != dst.ze_driver)
+                continue;
+            ze_result_t ret;
+            ze_bool_t can_access = 0;
+            XPUM_ZE_HANDLE_SHARED_LOCK(src.ze_device, ret = zeDeviceCanAccessPeer(src.ze_device, dst.ze_device, &can_access));
+            if (ret != ZE_RESULT_SUCCESS || can_access == 0) {
+                XPUM_LOG_DEBUG("Xe Link matrix - GPU {}/{} >> GPU {}/{} : Unreachable", src.device_id, src.tile_id, dst.device_id, dst.tile_id);
+                continue;
+            }
+            try {
+                if (endpoint_groups.find(i) == endpoint_groups.end())
+                    endpoint_groups[i] = getDeviceAvailableCopyEngingGroups(src.ze_device, false);
+                xpum_xe_link_matrix_entry_t entry = {};
+                entry.srcDeviceId = src.device_id;
+                entry.srcTileId = src.tile_id;
+                entry.dstDeviceId = dst.device_id;
+                entry.dstTileId = dst.tile_id;
+                int copy_engine_group = -1;
+                measureXeLinkUniBandwidth(src.ze_driver, src.ze_device, dst.ze_device, endpoint_groups[i], copy_engine_group, entry.uniBandwidth, entry.latency);
+                entry.copyEngineGroup = copy_engine_group;
+                entry.timestamp = Utility::getCurrentMillisecond();
+                entry_indexes[std::make_pair(i, j)] = entries.size();
+                entries.push_back(entry);
+                XPUM_LOG_DEBUG("Xe Link matrix - GPU {}/{} >> GPU {}/{} : {} GBPS on copy engine group {}, {} us", src.device_id, src.tile_id, dst.device_id, dst.tile_id,
+                               entry.uniBandwidth, entry.copyEngineGroup, entry.latency);
+            } catch (BaseException &e) {
+                XPUM_LOG_ERROR("Xe Link matrix - failed to measure GPU {}/{} >> GPU {}/{}: {}", src.device_id, src.tile_id, dst.device_id, dst.tile_id, e.what());
+            }
+        }
+    }
+
+    // both directions of a pair are measured once, with the best group of each side
+    for (auto &entry_index : entry_indexes) {
+        size_t i = entry_index.first.first;
+        size_t j = entry_index.first.second;
+        auto reverse = entry_indexes.find(std::make_pair(j, i));
+        if (i > j || reverse == entry_indexes.end())
+            continue;
+        auto &forward_entry = entries[entry_index.second];
+        auto &reverse_entry = entries[reverse->second];
+        if (forward_entry.copyEngineGroup < 0 || reverse_entry.copyEngineGroup < 0)
+            continue;
+        try {
+            double bandwidth = measureXeLinkBiBandwidth(endpoints[i].ze_driver, endpoints[i].ze_device, forward_entry.copyEngineGroup,
+                                                        endpoints[j].ze_device, reverse_entry.copyEngineGroup);
+            forward_entry.biBandwidth = bandwidth;
+            reverse_entry.biBandwidth = bandwidth;
+        } catch (BaseException &e) {
+            XPUM_LOG_ERROR("Xe Link matrix - failed to measure GPU {}/{} <> GPU {}/{}: {}", endpoints[i].device_id, endpoints[i].tile_id,
+                           endpoints[j].device_id, endpoints[j].tile_id, e.what());
+        }
+    }
+
+    if (!entries.empty()) {
+        std::vector<double> bandwidths;
+        for (auto &entry : entries)
+            bandwidths.push_back(entry.uniBandwidth);
+        std::sort(bandwidths.begin(), bandwidths.end());
+        double median = bandwidths[bandwidths.size() / 2];
+        for (auto &entry : entries)
+            entry.degraded = entry.uniBandwidth < median * XE_LINK_THROUGHPUT_USAGE_PERCENTAGE;
+    }
+    XPUM_LOG_INFO("Xe Link matrix of {} devices measured, {} pairs", matrix_devices.size(), entries.size());
+    Topology::setXeLinkMatrix(entries);
+    xe_link_matrix_running = false;
 }
 
 void DiagnosticManager::doDiagnosticXeLinkAllToAllThroughput(const ze_driver_handle_t &ze_driver,
@@ -3488,13 +4191,13 @@ void DiagnosticManager::doDiagnosticXeLinkAllToAllThroughput(const ze_driver_han
         zes_devices.emplace_back(zes_device);
 
         uint32_t fabric_port_count = 0;
-        XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesDeviceEnumFabricPorts(zes_device, &fabric_port_count, nullptr));
+        XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, ret = zesDeviceEnumFabricPorts(zes_device, &fabric_port_count, nullptr));
         if (fabric_port_count == 0) {
             failed_port_status_message = "Xe Link port not found";
             break;
         }
         std::vector<zes_fabric_port_handle_t> fabric_ports(fabric_port_count);
-        XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesDeviceEnumFabricPorts(zes_device, &fabric_port_count, fabric_ports.data()));
+        XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, ret = zesDeviceEnumFabricPorts(zes_device, &fabric_port_count, fabric_ports.data()));
         if (ret != ZE_RESULT_SUCCESS) {
             failed_port_status_message = "Xe Link port not found";
             break;
@@ -3503,14 +4206,14 @@ void DiagnosticManager::doDiagnosticXeLinkAllToAllThroughput(const ze_driver_han
             zes_fabric_port_properties_t properties;
             properties.stype = ZES_STRUCTURE_TYPE_FABRIC_PORT_PROPERTIES;
             properties.pNext = nullptr;
-            XPUM_ZE_HANDLE_LOCK(fabric_port, ret = zesFabricPortGetProperties(fabric_port, &properties));
+            XPUM_ZE_HANDLE_SHARED_LOCK(fabric_port, ret = zesFabricPortGetProperties(fabric_port, &properties));
             if (ret == ZE_RESULT_SUCCESS) {
                 fabric_id_convert_to_device_id[properties.portId.fabricId] = std::stoi(device->getId());
             }
             zes_fabric_port_state_t state;
             state.stype = ZES_STRUCTURE_TYPE_FABRIC_PORT_STATE;
             state.pNext = nullptr;
-            XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesFabricPortGetState(fabric_port, &state));
+            XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, ret = zesFabricPortGetState(fabric_port, &state));
             if (ret == ZE_RESULT_SUCCESS) {
                 XPUM_LOG_DEBUG("GPU {} fabric port status {}", device->getId(), state.status);
                 if (state.status != ZES_FABRIC_PORT_STATUS_HEALTHY && state.status != ZES_FABRIC_PORT_STATUS_DEGRADED) {
@@ -3545,13 +4248,13 @@ void DiagnosticManager::doDiagnosticXeLinkAllToAllThroughput(const ze_driver_han
     std::vector<ze_device_handle_t> ze_tile_devices;
     for (auto& ze_device : ze_devices) {
         uint32_t subdevice_count = 0;
-        XPUM_ZE_HANDLE_LOCK(ze_device, ret = zeDeviceGetSubDevices(ze_device, &subdevice_count, nullptr));
+        XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetSubDevices(ze_device, &subdevice_count, nullptr));
         if (subdevice_count == 0) {
             break;
         } else {
             hasTile = true;
             std::vector<ze_device_handle_t> subdevices(subdevice_count);
-            XPUM_ZE_HANDLE_LOCK(ze_device, ret = zeDeviceGetSubDevices(ze_device, &subdevice_count, subdevices.data()));
+            XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetSubDevices(ze_device, &subdevice_count, subdevices.data()));
             for (auto &subdevice : subdevices) {
                 ze_tile_devices.push_back(subdevice);
             }
@@ -3617,8 +4320,7 @@ void DiagnosticManager::doDiagnosticXeLinkAllToAllThroughput(const ze_driver_han
     std::atomic<bool> all_to_all_copy_done(false);
     std::vector<uint64_t> temperatures(root_device_count);
     std::vector<double> allToallThroughputs(root_device_count);
-    std::thread read_temperature_and_rwbandwidth_thread = std::thread([&all_to_all_copy_done, &zes_devices, &temperatures, &allToallThroughputs]() {
-        std::map<std::string, uint64_t> TxCnts, RxCnts, Timestamps;
+    std::thread read_temperature_thread = std::thread([&all_to_all_copy_done, &zes_devices, &temperatures]() {
         while (!all_to_all_copy_done.load()) {
             for (std::size_t i = 0; i < zes_devices.size(); i++) {
                 try {
@@ -3640,90 +4342,22 @@ void DiagnosticManager::doDiagnosticXeLinkAllToAllThroughput(const ze_driver_han
                     break;
                 }
             }
-            try {
-                std::map<std::string, uint64_t> currentTxCnts, currentRxCnts, currentTimestamps;
-                ze_result_t ret;
-                for (std::size_t i = 0; i < zes_devices.size(); i++) {
-                    zes_device_handle_t zes_device = zes_devices[i];
-                    int deviceId = i;
-
-                    uint32_t fabric_port_count = 0;
-                    XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesDeviceEnumFabricPorts(zes_device, &fabric_port_count, nullptr));
-                    if (ret != ZE_RESULT_SUCCESS || fabric_port_count == 0) {
-                        continue;
-                    }
-                    std::vector<zes_fabric_port_handle_t> fabric_ports(fabric_port_count);
-                    XPUM_ZE_HANDLE_LOCK(zes_device, ret = zesDeviceEnumFabricPorts(zes_device, &fabric_port_count, fabric_ports.data()));
-                    if (ret != ZE_RESULT_SUCCESS) {
-                        continue;
-                    }
-                    for (auto& fabric_port: fabric_ports) {
-                        zes_fabric_port_properties_t properties;
-                        properties.stype = ZES_STRUCTURE_TYPE_FABRIC_PORT_PROPERTIES;
-                        properties.pNext = nullptr;
-                        XPUM_ZE_HANDLE_LOCK(fabric_port, ret = zesFabricPortGetProperties(fabric_port, &properties));
-
-                        zes_fabric_port_state_t state;
-                        state.stype = ZES_STRUCTURE_TYPE_FABRIC_PORT_STATE;
-                        state.pNext = nullptr;
-                        XPUM_ZE_HANDLE_LOCK(fabric_port, ret = zesFabricPortGetState(fabric_port, &state));
-
-                        if (state.status != ZES_FABRIC_PORT_STATUS_HEALTHY && state.status != ZES_FABRIC_PORT_STATUS_DEGRADED) {
-                            continue;
-                        }
-
-                        zes_fabric_port_throughput_t fabric_port_throughput;
-                        XPUM_ZE_HANDLE_LOCK(fabric_port, ret = zesFabricPortGetThroughput(fabric_port, &fabric_port_throughput));
-
-                        std::string peer_port = std::to_string(deviceId) + "-" + std::to_string(properties.portId.attachId) + "-" + std::to_string(properties.portId.portNumber);
-                        currentTxCnts[peer_port] = fabric_port_throughput.txCounter;
-                        currentRxCnts[peer_port] = fabric_port_throughput.rxCounter;
-                        currentTimestamps[peer_port] = fabric_port_throughput.timestamp;
-                    }
-                }
-                if (TxCnts.size() > 0 && RxCnts.size() > 0 && Timestamps.size() > 0) {
-                    std::vector<double> currentAllToallThroughputs(zes_devices.size(), 0.0);
-                    double txThroughtput = 0;
-                    for (auto port : currentTxCnts) {
-                        int32_t deviceId = std::stoi(port.first.substr(0, 1));
-                        if (TxCnts.count(port.first) > 0 && currentTimestamps.count(port.first) > 0 && Timestamps.count(port.first) 
-                                && port.second > TxCnts[port.first] && currentTimestamps[port.first] > Timestamps[port.first]) {
-                            txThroughtput = 1000000.0 * (port.second - TxCnts[port.first]) / (currentTimestamps[port.first] - Timestamps[port.first]) / 1000000000;
-                            // only count per GPU tx throughput
-                            currentAllToallThroughputs[deviceId] += txThroughtput;
-                            XPUM_LOG_DEBUG("peer_port : {} txThroughtput(GB/s): {}",  port.first, txThroughtput);
-                        }
-                    }
-                    double rxThroughtput = 0;
-                    for (auto port : currentRxCnts) {
-                        if (RxCnts.count(port.first) > 0 && currentTimestamps.count(port.first) > 0 && Timestamps.count(port.first)
-                                && port.second > RxCnts[port.first] && currentTimestamps[port.first] > Timestamps[port.first]) {
-                            rxThroughtput = 1000000.0 * (port.second - RxCnts[port.first]) / (currentTimestamps[port.first] - Timestamps[port.first]) / 1000000000;
-                            // log rx throughput info for debug 
-                            XPUM_LOG_DEBUG("peer_port : {} rxThroughtput(GB/s): {}",  port.first, rxThroughtput);
-                        }
-                    }
-                    double currentSum = std::accumulate(currentAllToallThroughputs.begin(), currentAllToallThroughputs.end(), 0.0);
-                    if (currentSum > std::accumulate(allToallThroughputs.begin(), allToallThroughputs.end(), 0.0)) {
-                        allToallThroughputs = currentAllToallThroughputs;
-                        XPUM_LOG_DEBUG("diagnostic: update max xe link all-to-all throughput {}", currentSum);
-                    }
-                }
-
-                TxCnts = currentTxCnts;
-                RxCnts = currentRxCnts;
-                Timestamps = currentTimestamps;
-            } catch (...) {
-                XPUM_LOG_ERROR("Failed to update Xe Link all-to-all throughput");
-            }
             std::this_thread::sleep_for(std::chrono::seconds(1));
         }
     });
 
-    xe_link_all_to_all_parallel_copy(ze_driver, all_ze_devices, hasXeLink);
+    // the throughput is measured by the device timestamps of the copies, per tile if the devices have tiles
+    std::vector<double> throughputs = xe_link_all_to_all_parallel_copy(ze_driver, all_ze_devices, hasXeLink);
+    for (std::size_t i = 0; i < throughputs.size(); i++) {
+        std::size_t root = hasTile ? i / 2 : i;
+        if (root < allToallThroughputs.size())
+            allToallThroughputs[root] += throughputs[i];
+    }
+    for (std::size_t i = 0; i < allToallThroughputs.size(); i++)
+        XPUM_LOG_DEBUG("diagnostic: xe link all-to-all throughput {} on GPU {}", allToallThroughputs[i], i);
 
     all_to_all_copy_done.store(true);
-    read_temperature_and_rwbandwidth_thread.join();
+    read_temperature_thread.join();
     
     for (auto& diagnostic_task_info : diagnostic_task_infos) {
         xpum_diag_component_info_t &xe_link_throughput_component = diagnostic_task_info.second->componentList[xpum_diag_task_type_t::XPUM_DIAG_XE_LINK_ALL_TO_ALL_THROUGHPUT];
@@ -3741,8 +4375,23 @@ void DiagnosticManager::doDiagnosticXeLinkAllToAllThroughput(const ze_driver_han
             desc += " Threshold is " + std::to_string(all_to_all_bandwidth_threshold) + " GBPS.";
             xe_link_throughput_component.result = xpum_diag_task_result_t::XPUM_DIAG_RESULT_FAIL;
         } else {
-            std::string desc = "Pass to check Xe Link all-to-all throughput.";
-            xe_link_throughput_component.result = xpum_diag_task_result_t::XPUM_DIAG_RESULT_PASS;
+            std::string detail = " Its all-to-all bandwidth is " + roundDouble(allToallThroughputs[diagnostic_task_info.first], 3) + " GBPS.";
+            bool regressed = false;
+            for (std::size_t i = 0; i < devices.size() && i < zes_devices.size(); i++) {
+                if (devices[i]->getId() == std::to_string(diagnostic_task_info.first)) {
+                    // the reference depends on the number of devices exchanging data
+                    regressed = checkReference(zes_devices[i], "XE_LINK_ALL_TO_ALL_THROUGHPUT_X" + std::to_string(root_device_count) + "_GBPS",
+                                               allToallThroughputs[diagnostic_task_info.first], "GBPS", detail);
+                    break;
+                }
+            }
+            if (regressed) {
+                desc = "Fail to check Xe Link all-to-all throughput." + detail;
+                xe_link_throughput_component.result = xpum_diag_task_result_t::XPUM_DIAG_RESULT_FAIL;
+            } else {
+                desc = "Pass to check Xe Link all-to-all throughput." + detail;
+                xe_link_throughput_component.result = xpum_diag_task_result_t::XPUM_DIAG_RESULT_PASS;
+            }
         }
         if (temperatures[diagnostic_task_info.first] >= GPU_TEMPERATURE_THRESHOLD)
             desc += " GPU " + std::to_string(diagnostic_task_info.first) + " temperature is " + std::to_string(temperatures[diagnostic_task_info.first]) + " Celsius degree and the threshold is " + std::to_string(GPU_TEMPERATURE_THRESHOLD) + ".";
@@ -3753,133 +4402,432 @@ void DiagnosticManager::doDiagnosticXeLinkAllToAllThroughput(const ze_driver_han
 }
 
 #define SCORE_VECTOR_MAX 1024 * 1024
-void DiagnosticManager::stressThreadFunc(int stress_time,
-                                          const ze_device_handle_t &ze_device,
-                                          const ze_driver_handle_t &ze_driver,
-                                          std::shared_ptr<xpum_diag_task_info_t> p_task_info,
-                                          std::mutex *p_mutex,
-                                          std::map<xpum_device_id_t, std::shared_ptr<std::vector<double>>> *p_stress_score_map) {
-    
-    xpum_device_id_t device_id = p_task_info->deviceId;
-    try {
-        ze_result_t ret;
-        struct ZeWorkGroups workgroup_info;
-        int input_value = 4;
-        size_t flops_per_work_item = 2048;
-
-        ze_device_properties_t device_properties;
-        device_properties.pNext = nullptr;
-        device_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
-        XPUM_ZE_HANDLE_LOCK(ze_device, ret = zeDeviceGetProperties(ze_device, &device_properties));
-        if (ret != ZE_RESULT_SUCCESS) {
-            throw BaseException("zeDeviceGetProperties()[" + zeResultErrorCodeStr(ret) + "]");
+#define KERN_TIMES 5
+
+// the name and the score unit of each stress profile for checkStress
+static const std::vector<std::tuple<xpum_stress_profile_t, std::string, std::string>> STRESS_PROFILE_NAMES = {
+    std::make_tuple(XPUM_STRESS_PROFILE_INT_COMPUTE, "Integer compute", "GIOPS"),
+    std::make_tuple(XPUM_STRESS_PROFILE_FP32_COMPUTE, "Single-precision compute", "GFLOPS"),
+    std::make_tuple(XPUM_STRESS_PROFILE_FP64_COMPUTE, "Double-precision compute", "GFLOPS"),
+    std::make_tuple(XPUM_STRESS_PROFILE_MEMORY_BANDWIDTH, "Memory bandwidth", "GBPS"),
+    std::make_tuple(XPUM_STRESS_PROFILE_PCIE_H2D, "PCIe host to device", "GBPS"),
+    std::make_tuple(XPUM_STRESS_PROFILE_PCIE_D2H, "PCIe device to host", "GBPS"),
+    std::make_tuple(XPUM_STRESS_PROFILE_XE_LINK, "Xe Link", "GBPS"),
+    std::make_tuple(XPUM_STRESS_PROFILE_MEDIA, "Media transcode", "FPS")};
+
+bool StressRound::finish(double score, long double busy_time_nsec) {
+    {
+        std::unique_lock<std::mutex> lock(*p_mutex);
+        auto &scores = (*p_stress_score_map)[device_id][profile];
+        if (scores.size() > SCORE_VECTOR_MAX) {
+            scores.clear();
+        }
+        scores.push_back(score);
+    }
+    XPUM_LOG_DEBUG("a stress round of profile {} is done on device {} with score {}", profile, device_id, score);
+    auto now = std::chrono::steady_clock::now();
+    if (!unlimited && now >= end_time) {
+        return false;
+    }
+    if (target_utilization < 100) {
+        // idle (100 - target) / target of the busy time, e.g. as long as the round for 50%
+        auto idle = std::chrono::nanoseconds(static_cast<int64_t>(busy_time_nsec * (100 - target_utilization) / target_utilization));
+        if (!unlimited && now + idle > end_time) {
+            std::this_thread::sleep_until(end_time);
+            return false;
         }
-        ze_device_compute_properties_t device_compute_properties;
-        device_compute_properties.pNext = nullptr;
-        device_compute_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_COMPUTE_PROPERTIES;
-        XPUM_ZE_HANDLE_LOCK(ze_device, ret = zeDeviceGetComputeProperties(ze_device, &device_compute_properties));
-        if (ret != ZE_RESULT_SUCCESS) {
-            throw BaseException("zeDeviceGetComputeProperties()[" + zeResultErrorCodeStr(ret) + "]");
+        std::this_thread::sleep_for(idle);
+    }
+    return true;
+}
+
+void DiagnosticManager::stressCompute(StressRound &round, const ze_device_handle_t &ze_device, const ze_driver_handle_t &ze_driver,
+                                      const std::string &kernel_file, const char *kernel_name,
+                                      const void *input_value, std::size_t element_size, std::size_t flops_per_work_item) {
+    ze_result_t ret;
+    struct ZeWorkGroups workgroup_info;
+
+    ze_device_properties_t device_properties;
+    device_properties.pNext = nullptr;
+    device_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+    XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetProperties(ze_device, &device_properties));
+    if (ret != ZE_RESULT_SUCCESS) {
+        throw BaseException("zeDeviceGetProperties()[" + zeResultErrorCodeStr(ret) + "]");
+    }
+    ze_device_compute_properties_t device_compute_properties;
+    device_compute_properties.pNext = nullptr;
+    device_compute_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_COMPUTE_PROPERTIES;
+    XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetComputeProperties(ze_device, &device_compute_properties));
+    if (ret != ZE_RESULT_SUCCESS) {
+        throw BaseException("zeDeviceGetComputeProperties()[" + zeResultErrorCodeStr(ret) + "]");
+    }
+    ze_context_handle_t context;
+    contextCreate(ze_driver, &context);
+    std::vector<uint8_t> binary_file = loadBinaryFile(kernel_file);
+    ze_module_handle_t module_handle;
+    moduleCreate(context, ze_device, binary_file, &module_handle);
+    uint64_t max_work_items = (uint64_t)device_properties.numSlices *
+                                device_properties.numSubslicesPerSlice *
+                                device_properties.numEUsPerSubslice *
+                                device_compute_properties.maxGroupCountX * 2048;
+
+    uint64_t max_number_of_allocated_items = device_properties.maxMemAllocSize / element_size;
+    uint64_t number_of_work_items = std::min(max_number_of_allocated_items, (max_work_items * element_size));
+    number_of_work_items = setWorkgroups(device_compute_properties, number_of_work_items, &workgroup_info);
+
+    void *device_input_value;
+    memoryAlloc(context, ze_device, element_size, 1, &device_input_value);
+    void *device_output_buffer;
+    memoryAlloc(context, ze_device, static_cast<std::size_t>((number_of_work_items * element_size)), 1, &device_output_buffer);
+    ze_command_list_handle_t command_list;
+    commandListCreate(context, ze_device, 0, &command_list, ZE_COMMAND_LIST_FLAG_EXPLICIT_ONLY);
+    ze_command_queue_handle_t command_queue;
+    commandQueueCreate(context, ze_device, 0, 0, &command_queue, ZE_COMMAND_QUEUE_FLAG_EXPLICIT_ONLY);
+    commandListAppendMemoryCopy(command_list, device_input_value, input_value, element_size);
+    commandListAppendBarrier(command_list);
+    commandListClose(command_list);
+    commandQueueExecuteCommandLists(command_queue, command_list);
+    commandQueueSynchronize(command_queue);
+    commandListReset(command_list);
+    ze_kernel_handle_t kernel;
+    setupFunction(module_handle, kernel, kernel_name, device_input_value, device_output_buffer);
+
+    kernelSetGroupSize(kernel, workgroup_info.group_size_x, workgroup_info.group_size_y, workgroup_info.group_size_z);
+    ze_group_count_t thread_group_dimensions;
+    thread_group_dimensions.groupCountX = workgroup_info.group_count_x;
+    thread_group_dimensions.groupCountY = workgroup_info.group_count_y;
+    thread_group_dimensions.groupCountZ = workgroup_info.group_count_z;
+    commandListAppendLaunchKernel(command_list, kernel, &thread_group_dimensions);
+    commandListClose(command_list);
+
+    while (true) {
+        auto begin = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < KERN_TIMES; i++) {
+            commandQueueExecuteCommandLists(command_queue, command_list);
+            commandQueueSynchronize(command_queue);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        long double timed = std::chrono::duration<long double, 
+            std::chrono::nanoseconds::period>(end - begin).count();
+        auto ops = calculateGbps(timed / KERN_TIMES, number_of_work_items * flops_per_work_item);
+        if (!round.finish(ops, timed)) {
+            break;
         }
-        ze_context_handle_t context;
-        contextCreate(ze_driver, &context);
-        std::vector<uint8_t> binary_file = loadBinaryFile("ze_int_compute.spv");
-        ze_module_handle_t module_handle;
-        moduleCreate(context, ze_device, binary_file, &module_handle);
-        uint64_t max_work_items = (uint64_t)device_properties.numSlices *
-                                    device_properties.numSubslicesPerSlice *
-                                    device_properties.numEUsPerSubslice *
-                                    device_compute_properties.maxGroupCountX * 2048;
-
-        uint64_t max_number_of_allocated_items = device_properties.maxMemAllocSize / sizeof(int);
-        uint64_t number_of_work_items = std::min(max_number_of_allocated_items, (max_work_items * sizeof(int)));
-        number_of_work_items = setWorkgroups(device_compute_properties, number_of_work_items, &workgroup_info);
-
-        void *device_input_value;
-        memoryAlloc(context, ze_device, sizeof(int), 1, &device_input_value);
-        void *device_output_buffer;
-        memoryAlloc(context, ze_device, static_cast<std::size_t>((number_of_work_items * sizeof(int))), 1, &device_output_buffer);
-        ze_command_list_handle_t command_list;
-        commandListCreate(context, ze_device, 0, &command_list, ZE_COMMAND_LIST_FLAG_EXPLICIT_ONLY);
-        ze_command_queue_handle_t command_queue;
-        commandQueueCreate(context, ze_device, 0, 0, &command_queue, ZE_COMMAND_QUEUE_FLAG_EXPLICIT_ONLY);
-        commandListAppendMemoryCopy(command_list, device_input_value, &input_value, sizeof(int));
-        commandListAppendBarrier(command_list);
-        commandListClose(command_list);
-        commandQueueExecuteCommandLists(command_queue, command_list);
-        commandQueueSynchronize(command_queue);
-        commandListReset(command_list);
-        ze_kernel_handle_t compute_int_v1;
-        setupFunction(module_handle, compute_int_v1, "compute_int_v1", device_input_value, device_output_buffer);
-
-        //runKernel stuff
-        kernelSetGroupSize(compute_int_v1, workgroup_info.group_size_x, workgroup_info.group_size_y, workgroup_info.group_size_z);
-        ze_group_count_t thread_group_dimensions;
-        thread_group_dimensions.groupCountX = workgroup_info.group_count_x;
-        thread_group_dimensions.groupCountY = workgroup_info.group_count_y;
-        thread_group_dimensions.groupCountZ = workgroup_info.group_count_z;
-        commandListAppendLaunchKernel(command_list, compute_int_v1, &thread_group_dimensions);
-        commandListClose(command_list);
+    }
 
-        #define KERN_TIMES 5
-        long double workTime = 0;
-        while (true) {
-            auto begin = std::chrono::high_resolution_clock::now();
-            for (int i = 0; i < KERN_TIMES; i++) {
-                commandQueueExecuteCommandLists(command_queue, command_list);
-                commandQueueSynchronize(command_queue);
-            }
-            auto end = std::chrono::high_resolution_clock::now();
-            long double timed = std::chrono::duration<long double, 
-                std::chrono::nanoseconds::period>(end - begin).count();
-            workTime += timed / 1000 / 1000;
-            timed /= KERN_TIMES;
-            auto iops = calculateGbps(timed, number_of_work_items * flops_per_work_item);
-            {
-                std::unique_lock<std::mutex> lock(*p_mutex);
-                auto iter = p_stress_score_map->find(device_id);
-                if (iter == p_stress_score_map->end()) {
-                    auto scores = std::make_shared<std::vector<double>>();
-                    scores->push_back(iops);
-                    (*p_stress_score_map)[device_id] = scores;
-                } else {
-                    if (iter->second->size() > SCORE_VECTOR_MAX) {
-                        iter->second->clear();
-                    }
-                    iter->second->push_back(iops);
-                }
-            }
-            XPUM_LOG_DEBUG("a stress round is done with score {}", iops);
-            if (stress_time != 0 && stress_time <= workTime / (60 * 1000)) {
-                break;
+    commandListReset(command_list);
+    kernelDestroy(kernel);
+    commandListDestroy(command_list);
+    commandQueueDestroy(command_queue);
+    memoryFree(context, device_input_value);
+    memoryFree(context, device_output_buffer);
+    moduleDestroy(module_handle);
+    contextDestroy(context);
+}
+
+void DiagnosticManager::stressMemoryBandwidth(StressRound &round, const ze_device_handle_t &ze_device, const ze_driver_handle_t &ze_driver) {
+    ze_result_t ret;
+    struct ZeWorkGroups workgroup_info;
+    ze_device_properties_t device_properties;
+    device_properties.pNext = nullptr;
+    device_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+    XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetProperties(ze_device, &device_properties));
+    if (ret != ZE_RESULT_SUCCESS) {
+        throw BaseException("zeDeviceGetProperties()[" + zeResultErrorCodeStr(ret) + "]");
+    }
+    ze_device_compute_properties_t device_compute_properties;
+    device_compute_properties.pNext = nullptr;
+    device_compute_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_COMPUTE_PROPERTIES;
+    XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetComputeProperties(ze_device, &device_compute_properties));
+    if (ret != ZE_RESULT_SUCCESS) {
+        throw BaseException("zeDeviceGetComputeProperties()[" + zeResultErrorCodeStr(ret) + "]");
+    }
+    ze_context_handle_t context;
+    contextCreate(ze_driver, &context);
+    std::vector<uint8_t> binary_file = loadBinaryFile("ze_global_bw.spv");
+    ze_module_handle_t module_handle;
+    moduleCreate(context, ze_device, binary_file, &module_handle);
+    uint64_t max_items = device_properties.maxMemAllocSize / sizeof(float) / 2;
+    uint64_t num_items = std::min(max_items, (uint64_t)(1 << 29));
+    uint64_t base = (uint64_t)device_compute_properties.maxGroupSizeX * 16 * 16;
+    num_items = (num_items / base) * base;
+
+    std::vector<float> arr(static_cast<uint32_t>(num_items));
+    for (uint32_t i = 0; i < num_items; i++) {
+        arr[i] = static_cast<float>(i);
+    }
+
+    void *inputBuf;
+    memoryAlloc(context, ze_device, static_cast<size_t>((num_items * sizeof(float))), 1, &inputBuf);
+    void *outputBuf;
+    memoryAlloc(context, ze_device, static_cast<size_t>((num_items * sizeof(float))), 1, &outputBuf);
+    ze_command_list_handle_t command_list;
+    commandListCreate(context, ze_device, 0, &command_list, ZE_COMMAND_LIST_FLAG_EXPLICIT_ONLY);
+    ze_command_queue_handle_t command_queue;
+    commandQueueCreate(context, ze_device, 0, 0, &command_queue, ZE_COMMAND_QUEUE_FLAG_EXPLICIT_ONLY);
+    commandListAppendMemoryCopy(command_list, inputBuf, arr.data(), (arr.size() * sizeof(float)));
+    commandListAppendBarrier(command_list);
+    commandListClose(command_list);
+    commandQueueExecuteCommandLists(command_queue, command_list);
+    commandQueueSynchronize(command_queue);
+    commandListReset(command_list);
+
+    // the widest vector reads the memory fastest in the memory bandwidth diagnostic
+    ze_kernel_handle_t global_offset_v16;
+    setupFunction(module_handle, global_offset_v16, "global_bandwidth_v16_global_offset", inputBuf, outputBuf);
+    setWorkgroups(device_compute_properties, num_items / 16 / 16, &workgroup_info);
+    kernelSetGroupSize(global_offset_v16, workgroup_info.group_size_x, workgroup_info.group_size_y, workgroup_info.group_size_z);
+    ze_group_count_t thread_group_dimensions;
+    thread_group_dimensions.groupCountX = workgroup_info.group_count_x;
+    thread_group_dimensions.groupCountY = workgroup_info.group_count_y;
+    thread_group_dimensions.groupCountZ = workgroup_info.group_count_z;
+    commandListAppendLaunchKernel(command_list, global_offset_v16, &thread_group_dimensions);
+    commandListClose(command_list);
+
+    while (true) {
+        auto begin = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < KERN_TIMES; i++) {
+            commandQueueExecuteCommandLists(command_queue, command_list);
+            commandQueueSynchronize(command_queue);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        long double timed = std::chrono::duration<long double, 
+            std::chrono::nanoseconds::period>(end - begin).count();
+        auto gbps = calculateGbps(timed / KERN_TIMES, num_items * sizeof(float));
+        if (!round.finish(gbps, timed)) {
+            break;
+        }
+    }
+
+    commandListReset(command_list);
+    kernelDestroy(global_offset_v16);
+    commandListDestroy(command_list);
+    commandQueueDestroy(command_queue);
+    memoryFree(context, inputBuf);
+    memoryFree(context, outputBuf);
+    moduleDestroy(module_handle);
+    contextDestroy(context);
+}
+
+void DiagnosticManager::stressCopy(StressRound &round, const ze_device_handle_t &ze_device, const ze_driver_handle_t &ze_driver,
+                                   const std::vector<ze_device_handle_t> &peer_devices) {
+    ze_result_t ret;
+    std::vector<ze_device_handle_t> targets;
+    if (round.profile == XPUM_STRESS_PROFILE_XE_LINK) {
+        for (auto peer_device : peer_devices) {
+            ze_bool_t can_access = false;
+            XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceCanAccessPeer(ze_device, peer_device, &can_access));
+            if (ret == ZE_RESULT_SUCCESS && can_access) {
+                targets.push_back(peer_device);
             }
         }
+        if (targets.empty()) {
+            throw BaseException("No GPU is accessible to copy through Xe Link");
+        }
+    }
 
-        commandListReset(command_list);
-        //end of runKernel
+    std::vector<int> copyEngineGroupIds = getDeviceAvailableCopyEngingGroups(ze_device, true);
+    int copyEngineGroupId = copyEngineGroupIds.back();
+    if (round.profile == XPUM_STRESS_PROFILE_XE_LINK) {
+        uint32_t numQueueGroups = 0;
+        XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetCommandQueueGroupProperties(ze_device, &numQueueGroups, nullptr));
+        if (ret == ZE_RESULT_SUCCESS && numQueueGroups > XE_LINK_COPY_ENGINE_GROUP) {
+            copyEngineGroupId = XE_LINK_COPY_ENGINE_GROUP;
+        }
+    }
 
-        kernelDestroy(compute_int_v1);
-        commandListDestroy(command_list);
-        commandQueueDestroy(command_queue);
-        memoryFree(context, device_input_value);
-        memoryFree(context, device_output_buffer);
-        moduleDestroy(module_handle);
-        contextDestroy(context);
+    ze_context_handle_t context;
+    contextCreate(ze_driver, &context);
+    ze_command_list_handle_t command_list;
+    commandListCreate(context, ze_device, copyEngineGroupId, &command_list);
+    ze_command_queue_handle_t command_queue;
+    commandQueueCreate(context, ze_device, copyEngineGroupId, 0, &command_queue);
+
+    std::size_t size = 1 << 28;
+    void *device_buffer;
+    memoryAlloc(context, ze_device, size, 1, &device_buffer);
+    std::vector<void *> other_buffers;
+    if (round.profile == XPUM_STRESS_PROFILE_XE_LINK) {
+        for (auto target : targets) {
+            void *peer_buffer;
+            memoryAlloc(context, target, size, 1, &peer_buffer);
+            other_buffers.push_back(peer_buffer);
+        }
+    } else {
+        void *host_buffer;
+        memoryAllocHost(context, size, 1, &host_buffer);
+        other_buffers.push_back(host_buffer);
+    }
+    for (auto other_buffer : other_buffers) {
+        if (round.profile == XPUM_STRESS_PROFILE_PCIE_D2H) {
+            commandListAppendMemoryCopy(command_list, other_buffer, device_buffer, size);
+        } else if (round.profile == XPUM_STRESS_PROFILE_PCIE_H2D) {
+            commandListAppendMemoryCopy(command_list, device_buffer, other_buffer, size);
+        } else {
+            commandListAppendMemoryCopy(command_list, other_buffer, device_buffer, size);
+        }
+    }
+    commandListClose(command_list);
 
-    } catch (BaseException &e) {
-        XPUM_LOG_DEBUG("Error in stress test with BaseException");
-        XPUM_LOG_DEBUG(e.what());
-    } catch (...) {
-        XPUM_LOG_DEBUG("Error in stress test");
+    while (true) {
+        auto begin = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < KERN_TIMES; i++) {
+            commandQueueExecuteCommandLists(command_queue, command_list);
+            commandQueueSynchronize(command_queue);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        long double timed = std::chrono::duration<long double, 
+            std::chrono::nanoseconds::period>(end - begin).count();
+        auto gbps = calculateGbps(timed / KERN_TIMES, static_cast<long double>(size * other_buffers.size()));
+        if (!round.finish(gbps, timed)) {
+            break;
+        }
+    }
+
+    commandListDestroy(command_list);
+    commandQueueDestroy(command_queue);
+    memoryFree(context, device_buffer);
+    for (auto other_buffer : other_buffers) {
+        memoryFree(context, other_buffer);
     }
+    contextDestroy(context);
+}
 
+void DiagnosticManager::stressMedia(StressRound &round, const zes_device_handle_t &zes_device) {
+    ze_result_t ret;
+    zes_pci_properties_t pci_props;
+    pci_props.stype = ZES_STRUCTURE_TYPE_PCI_PROPERTIES;
+    pci_props.pNext = nullptr;
+    XPUM_ZE_HANDLE_SHARED_LOCK(zes_device, ret = zesDevicePciGetProperties(zes_device, &pci_props));
+    if (ret != ZE_RESULT_SUCCESS) {
+        throw BaseException("zesDevicePciGetProperties()[" + zeResultErrorCodeStr(ret) + "]");
+    }
+    std::string device_path = getDevicePath(pci_props);
+    if (device_path.empty()) {
+        throw BaseException("Can't find the graphics device.");
+    }
+    if (!findMediaCodecTools()) {
+        throw BaseException("No sample_multi_transcode tool.");
+    }
+    std::string mediadata_folder = getMediaDataFolder();
+    std::string test_command;
+    if (std::ifstream(mediadata_folder + MEDIA_CODER_TOOLS_1080P_FILE).good()) {
+        test_command = MEDIA_CODER_TOOLS_PATH + "sample_multi_transcode -device " + device_path +
+                       " -hw -i::h265 " + mediadata_folder + MEDIA_CODER_TOOLS_1080P_FILE + " -o::h265 null 2>&1";
+    } else if (std::ifstream(mediadata_folder + MEDIA_CODEC_TOOLS_LIGHT_FILE).good()) {
+        test_command = MEDIA_CODER_TOOLS_PATH + "sample_multi_transcode -device " + device_path +
+                       " -hw -i::h264 " + mediadata_folder + MEDIA_CODEC_TOOLS_LIGHT_FILE + " -o::h264 null 2>&1";
+    } else {
+        throw BaseException("No Media test file.");
+    }
+    XPUM_LOG_INFO("Media stress command: {}", test_command);
+
+    while (true) {
+        int fps = 0;
+        auto begin = std::chrono::high_resolution_clock::now();
+        std::string result = getCommandResult(test_command, fps);
+        auto end = std::chrono::high_resolution_clock::now();
+        if (result.find("ERROR") != std::string::npos || result.find("ERR_UNSUPPORTED") != std::string::npos) {
+            XPUM_LOG_ERROR("detailed error message:\n {}", result);
+            throw BaseException("Fail to run media transcode.");
+        }
+        long double timed = std::chrono::duration<long double, 
+            std::chrono::nanoseconds::period>(end - begin).count();
+        if (!round.finish(fps, timed)) {
+            break;
+        }
+    }
+}
+
+void DiagnosticManager::stressThreadFunc(xpum_stress_options_t options,
+                                          std::shared_ptr<Device> p_device,
+                                          std::vector<ze_device_handle_t> peer_devices,
+                                          std::shared_ptr<xpum_diag_task_info_t> p_task_info,
+                                          std::mutex *p_mutex,
+                                          StressScoreMap *p_stress_score_map) {
+    ze_device_handle_t ze_device = p_device->getDeviceZeHandle();
+    ze_driver_handle_t ze_driver = p_device->getDriverHandle();
+    zes_device_handle_t zes_device = p_device->getDeviceHandle();
+    auto end_time = std::chrono::steady_clock::now() + std::chrono::minutes(options.stressTime);
+
+    // the profiles run at the same time, each one in its own thread
+    std::vector<std::thread> profile_threads;
+    for (auto &profile_name : STRESS_PROFILE_NAMES) {
+        xpum_stress_profile_t profile = std::get<0>(profile_name);
+        if ((options.profiles & profile) == 0) {
+            continue;
+        }
+        StressRound round{p_task_info->deviceId, profile, options.targetUtilization, options.stressTime == 0, end_time, p_mutex, p_stress_score_map};
+        profile_threads.push_back(std::thread([round, ze_device, ze_driver, zes_device, &peer_devices]() mutable {
+            try {
+                switch (round.profile) {
+                    case XPUM_STRESS_PROFILE_INT_COMPUTE: {
+                        int input_value = 4;
+                        stressCompute(round, ze_device, ze_driver, "ze_int_compute.spv", "compute_int_v1", &input_value, sizeof(int), 2048);
+                        break;
+                    }
+                    case XPUM_STRESS_PROFILE_FP32_COMPUTE: {
+                        float input_value = 1.3f;
+                        stressCompute(round, ze_device, ze_driver, "ze_sp_compute.spv", "compute_sp_v1", &input_value, sizeof(float), 4096);
+                        break;
+                    }
+                    case XPUM_STRESS_PROFILE_FP64_COMPUTE: {
+                        double input_value = 1.3;
+                        stressCompute(round, ze_device, ze_driver, "ze_dp_compute.spv", "compute_dp_v1", &input_value, sizeof(double), 4096);
+                        break;
+                    }
+                    case XPUM_STRESS_PROFILE_MEMORY_BANDWIDTH:
+                        stressMemoryBandwidth(round, ze_device, ze_driver);
+                        break;
+                    case XPUM_STRESS_PROFILE_PCIE_H2D:
+                    case XPUM_STRESS_PROFILE_PCIE_D2H:
+                    case XPUM_STRESS_PROFILE_XE_LINK:
+                        stressCopy(round, ze_device, ze_driver, peer_devices);
+                        break;
+                    case XPUM_STRESS_PROFILE_MEDIA:
+                        stressMedia(round, zes_device);
+                        break;
+                    default:
+                        break;
+                }
+            } catch (BaseException &e) {
+                XPUM_LOG_WARN("Error in stress profile {} on device {}: {}", round.profile, round.device_id, e.what());
+            } catch (...) {
+                XPUM_LOG_WARN("Error in stress profile {} on device {}", round.profile, round.device_id);
+            }
+        }));
+    }
+    for (auto &profile_thread : profile_threads) {
+        profile_thread.join();
+    }
+
+    p_task_info->endTime = Utility::getCurrentMillisecond();
     p_task_info->finished = true;
     return;
 }
 
 xpum_result_t DiagnosticManager::runStress(xpum_device_id_t deviceId, uint32_t stressTime) {
+    xpum_stress_options_t options = {};
+    options.stressTime = stressTime;
+    options.profiles = XPUM_STRESS_PROFILE_INT_COMPUTE;
+    options.targetUtilization = 100;
+    return runStress(deviceId, options);
+}
+
+xpum_result_t DiagnosticManager::runStress(xpum_device_id_t deviceId, const xpum_stress_options_t &options) {
+    xpum_stress_options_t stress_options = options;
+    if (stress_options.profiles == 0) {
+        stress_options.profiles = XPUM_STRESS_PROFILE_INT_COMPUTE;
+    }
+    if (stress_options.targetUtilization == 0) {
+        stress_options.targetUtilization = 100;
+    }
+    if ((stress_options.profiles & ~(uint32_t)XPUM_STRESS_PROFILE_ALL) != 0 || stress_options.targetUtilization > 100) {
+        return XPUM_RESULT_STRESS_INVALID_OPTIONS;
+    }
     readConfigFile(XPUM_GLOBAL_CONFIG_FILE);
     readConfigFile(DIAG_CONFIG_THRESHOLD_CONIG_FILE);
+    ReferencePerformance::load();
     std::unique_lock<std::mutex> lock(this->mutex);
     std::vector<std::shared_ptr<Device>> devices;
     if (deviceId == -1) {
@@ -3896,7 +4844,7 @@ xpum_result_t DiagnosticManager::runStress(xpum_device_id_t deviceId, uint32_t s
         stress_task_map.clear();
         this->p_device_manager->getDeviceList(devices);
     } else {
-        if (this->p_device_manager->getDevice(std::to_string(deviceId)) == 
+        if (this->p_device_manager->getDevice(deviceId) == 
                 nullptr) {
             return XPUM_RESULT_DEVICE_NOT_FOUND;
         }
@@ -3910,10 +4858,21 @@ xpum_result_t DiagnosticManager::runStress(xpum_device_id_t deviceId, uint32_t s
             return XPUM_RESULT_DIAGNOSTIC_TASK_NOT_COMPLETE;
         }
         stress_task_map.erase(deviceId);
-        devices.push_back(this->p_device_manager->getDevice(std::to_string(deviceId)));
+        devices.push_back(this->p_device_manager->getDevice(deviceId));
     }
 
+    // the Xe Link profile copies to all the other GPUs
+    std::vector<std::shared_ptr<Device>> all_devices;
+    this->p_device_manager->getDeviceList(all_devices);
     for (auto device : devices) {
+        std::vector<ze_device_handle_t> peer_devices;
+        if (stress_options.profiles & XPUM_STRESS_PROFILE_XE_LINK) {
+            for (auto peer : all_devices) {
+                if (peer->getId() != device->getId() && peer->getDriverHandle() == device->getDriverHandle()) {
+                    peer_devices.push_back(peer->getDeviceZeHandle());
+                }
+            }
+        }
         std::shared_ptr<xpum_diag_task_info_t> p_task_info = std::make_shared<xpum_diag_task_info_t>();
         
         p_task_info->deviceId = std::stoi(device->getId());
@@ -3923,9 +4882,9 @@ xpum_result_t DiagnosticManager::runStress(xpum_device_id_t deviceId, uint32_t s
         p_task_info->startTime = Utility::getCurrentMillisecond();
         updateMessage(p_task_info->message, std::string("Doing stress"));
         stress_task_map.insert(std::pair<xpum_device_id_t, std::shared_ptr<xpum_diag_task_info_t>>(p_task_info->deviceId, p_task_info));
-        std::thread thread(DiagnosticManager::stressThreadFunc, stressTime,
-                           device->getDeviceZeHandle(),
-                           device->getDriverHandle(), p_task_info, &this->mutex, 
+        stress_score_map.erase(p_task_info->deviceId);
+        std::thread thread(DiagnosticManager::stressThreadFunc, stress_options,
+                           device, peer_devices, p_task_info, &this->mutex, 
                            &this->stress_score_map);
         thread.detach();
     }
@@ -3938,7 +4897,7 @@ xpum_result_t DiagnosticManager::checkStress(xpum_device_id_t deviceId, xpum_dia
         *count = stress_task_map.size();
         return XPUM_OK;
     }
-    std::vector<double> allScores;
+    std::map<xpum_stress_profile_t, std::vector<double>> allScores;
     if (deviceId == -1) {
         if (*count < (int)stress_task_map.size()) {
             return XPUM_BUFFER_TOO_SMALL;
@@ -3954,9 +4913,11 @@ xpum_result_t DiagnosticManager::checkStress(xpum_device_id_t deviceId, xpum_dia
         *count = i;
         for (auto iter = stress_score_map.begin(); 
             iter != stress_score_map.end(); iter++) {
-            allScores.insert(allScores.end(), iter->second->begin(), 
-                iter->second->end());
-            iter->second->clear();
+            for (auto &scores : iter->second) {
+                allScores[scores.first].insert(allScores[scores.first].end(), 
+                    scores.second.begin(), scores.second.end());
+                scores.second.clear();
+            }
         }
     } else {
         if (*count < 1) {
@@ -3972,21 +4933,36 @@ xpum_result_t DiagnosticManager::checkStress(xpum_device_id_t deviceId, xpum_dia
         *count = 1;
         auto score = stress_score_map.find(deviceId);
         if (score != stress_score_map.end()) {
-            allScores.insert(allScores.end(), score->second->begin(), 
-                score->second->end());
-            score->second->clear();
+            for (auto &scores : score->second) {
+                allScores[scores.first].insert(allScores[scores.first].end(), 
+                    scores.second.begin(), scores.second.end());
+                scores.second.clear();
+            }
         }
     }
     // this feature does not consider diff GPU in same server node
     auto device = p_device_manager->getDevice("0");
-    if (stress_task_map.size() > 0 && allScores.size() > 0 && 
-        device != nullptr) {
-        double mean = calculateMean(allScores);
-        double variance = calcaulateVariance(allScores);
-        int ref = thresholds[device_names[device->getDeviceZeHandle()]]["REF_INT_GFLOPS"];
-        std::string msg = "Integer compute: Mean: " + roundDouble(mean, 3) + " GIOPS. Var: ";
-        msg += roundDouble(variance, 3) + ". Ref: " + std::to_string(ref) + " GIOPS.";
-        updateMessage(resultList[0].message, msg);
+    if (stress_task_map.size() > 0 && device != nullptr) {
+        std::string msg;
+        for (auto &profile_name : STRESS_PROFILE_NAMES) {
+            auto scores = allScores.find(std::get<0>(profile_name));
+            if (scores == allScores.end() || scores->second.empty()) {
+                continue;
+            }
+            double mean = calculateMean(scores->second);
+            double variance = calcaulateVariance(scores->second);
+            if (!msg.empty()) {
+                msg += " ";
+            }
+            msg += std::get<1>(profile_name) + ": Mean: " + roundDouble(mean, 3) + " " + std::get<2>(profile_name) + ". Var: " + roundDouble(variance, 3) + ".";
+            if (std::get<0>(profile_name) == XPUM_STRESS_PROFILE_INT_COMPUTE) {
+                int ref = thresholds[device_names[device->getDeviceZeHandle()]]["REF_INT_GFLOPS"];
+                msg += " Ref: " + std::to_string(ref) + " GIOPS.";
+            }
+        }
+        if (!msg.empty()) {
+            updateMessage(resultList[0].message, msg);
+        }
     }
     return XPUM_OK;
 }
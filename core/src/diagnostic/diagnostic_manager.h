@@ -13,6 +13,7 @@
 
 #include <atomic>
 #include <bitset>
+#include <chrono>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -64,6 +65,27 @@ struct PerfDatas {
     int reference_xe_link_all_to_all_throughtput;
 };
 
+typedef std::map<xpum_device_id_t, std::map<xpum_stress_profile_t, std::vector<double>>> StressScoreMap;
+
+/*
+  StressRound paces the rounds of one stress profile on a device. It records
+  the score of each round and pauses after it, so that the profile keeps the
+  GPU busy for the target utilization and the profiles running at the same
+  time share it as requested.
+*/
+struct StressRound {
+    xpum_device_id_t device_id;
+    xpum_stress_profile_t profile;
+    uint32_t target_utilization;
+    bool unlimited;
+    std::chrono::steady_clock::time_point end_time;
+    std::mutex *p_mutex;
+    StressScoreMap *p_stress_score_map;
+
+    // return false if the stress time is over
+    bool finish(double score, long double busy_time_nsec);
+};
+
 class DiagnosticManager : public DiagnosticManagerInterface {
    public:
     DiagnosticManager(std::shared_ptr<DeviceManagerInterface> &p_device_manager,
@@ -95,14 +117,33 @@ class DiagnosticManager : public DiagnosticManagerInterface {
 
     xpum_result_t getDiagnosticsXeLinkThroughputResult(xpum_device_id_t deviceId, xpum_diag_xe_link_throughput_t resultList[], int *count) override;
 
+    // measure the Xe Link matrix of deviceIds, all devices if empty, and keep it in Topology
+    xpum_result_t runXeLinkMatrix(std::vector<xpum_device_id_t> deviceIds) override;
+
+    bool isXeLinkMatrixRunning() override;
+
     xpum_result_t runStress(xpum_device_id_t deviceId, uint32_t stressTime) override;
 
+    xpum_result_t runStress(xpum_device_id_t deviceId, const xpum_stress_options_t &options) override;
+
     xpum_result_t checkStress(xpum_device_id_t deviceId, xpum_diag_task_info_t resultList[], int *count) override;
 
     static bool isLevelDiagnosticType(xpum_diag_task_type_t type);
 
     void doDiagnosticCore(xpum_device_id_t deviceId);
 
+    void doDiagnosticTask(xpum_diag_task_type_t type, std::shared_ptr<Device> device, xpum_device_id_t deviceId);
+
+    // if the test uses other devices or resources shared by the devices, so it is not run in parallel
+    static bool isCrossDeviceDiagnosticType(xpum_diag_task_type_t type);
+
+    // the threshold of the device in diagnostics.conf, 0 if not set
+    static int getThreshold(const ze_device_handle_t &ze_device, const std::string &name);
+
+    // append the percentile rank of value in reference_performance.conf to detail, true if it is a regression
+    static bool checkReference(const ze_device_handle_t &ze_device, const std::string &name, double value,
+                               const std::string &unit, std::string &detail);
+
     static void doDiagnosticEnvironmentVariables(std::shared_ptr<xpum_diag_task_info_t> p_task_info);
 
     static void doDiagnosticLibraries(std::vector<std::shared_ptr<Device>> devices,
@@ -169,12 +210,24 @@ class DiagnosticManager : public DiagnosticManagerInterface {
                                                     std::map<xpum_device_id_t, std::shared_ptr<xpum_diag_task_info_t>>& diagnostic_task_infos, 
                                                     std::map<xpum_device_id_t, PerfDatas> &diagnostic_perf_datas);
 
+    void doXeLinkMatrix(std::vector<std::shared_ptr<Device>> matrix_devices);
+
+    // the best bandwidth of the copy engine groups from src_device to dst_device, the group and the latency of a small copy on it
+    static void measureXeLinkUniBandwidth(const ze_driver_handle_t &ze_driver, ze_device_handle_t src_device, ze_device_handle_t dst_device,
+                                          const std::vector<int> &copy_engine_groups, int &copy_engine_group, double &bandwidth, double &latency);
+
+    // the bandwidth of the copies between device_a and device_b in both directions at the same time
+    static double measureXeLinkBiBandwidth(const ze_driver_handle_t &ze_driver, ze_device_handle_t device_a, int group_a,
+                                           ze_device_handle_t device_b, int group_b);
+
     static void doDiagnosticExceptionHandle(xpum_diag_task_type_t type, std::string error, std::shared_ptr<xpum_diag_task_info_t> p_task_info);
 
     static std::map<std::string, std::map<std::string, int>> thresholds;
 
     static std::map<ze_device_handle_t, std::string> device_names;
 
+    static std::map<ze_device_handle_t, std::string> device_firmwares;
+
     static std::string MEDIA_CODER_TOOLS_PATH;
 
     static std::string MEDIA_CODER_TOOLS_1080P_FILE;
@@ -222,7 +275,12 @@ class DiagnosticManager : public DiagnosticManagerInterface {
 
     static std::string getCommandResult(std::string command, int& fps);
 
-    static std::vector<xpum_diag_media_codec_metrics_t> getMediaCodecMetricsData(xpum_device_id_t deviceId, std::string device_path,
+    static std::string getMediaDataFolder();
+
+    // return false if sample_multi_transcode is not found
+    static bool findMediaCodecTools();
+
+    static std::vector<xpum_diag_media_codec_metrics_t> getMediaCodecMetricsData(const zes_device_handle_t &zes_device, xpum_device_id_t deviceId, std::string device_path,
                                                                                 bool h265_1080p_file_exist, bool h265_4k_file_exist);
 
     static void calculateBandwidthLatency(long double total_time_nsec, long double total_data_transfer,
@@ -230,13 +288,23 @@ class DiagnosticManager : public DiagnosticManagerInterface {
 
     static void showResultsHost2device(std::size_t buffer_size, long double total_bandwidth, long double total_latency);
 
+    // the kernel file in the resources, read once per process
     static std::vector<uint8_t> loadBinaryFile(const std::string &file_path);
 
+    static std::vector<uint8_t> readKernelFile(const std::string &file_path);
+
     static void dispatchKernelsForMemoryTest(const ze_device_handle_t device, ze_module_handle_t module,
                                              std::vector<uint8_t *> src_allocations, std::vector<uint8_t *> dst_allocations,
                                              std::vector<std::vector<uint8_t>> &data_out, const std::vector<std::string> &test_kernel_names,
                                              uint64_t number_of_dispatch, uint64_t one_case_allocation_count, ze_context_handle_t context);
 
+    // write, read back and verify the allocations chunk by chunk, the next chunks run while the host verifies one,
+    // returns the number of wrong bytes and stops early if failed is set
+    static uint64_t testMemoryErrorOnDevice(const ze_device_handle_t device, ze_module_handle_t module,
+                                            const std::vector<uint8_t *> &src_allocations, const std::vector<uint8_t *> &dst_allocations,
+                                            uint64_t one_case_allocation_count, ze_context_handle_t context,
+                                            std::atomic<uint64_t> &tested_size, std::atomic<bool> &failed);
+
     static uint64_t setWorkgroups(ze_device_compute_properties_t &device_compute_properties,
                                   const uint64_t total_work_items_requested,
                                   struct ZeWorkGroups *workgroup_info);
@@ -244,7 +312,9 @@ class DiagnosticManager : public DiagnosticManagerInterface {
     static void setupFunction(ze_module_handle_t &module_handle, ze_kernel_handle_t &function,
                               const char *name, void *input, void *output);
 
-    static long double runKernel(ze_command_queue_handle_t command_queue, ze_command_list_handle_t command_list,
+    // the device time of one run of function, median of the measured iterations
+    static long double runKernel(const ze_context_handle_t &context, ze_device_handle_t ze_device,
+                                 ze_command_queue_handle_t command_queue, ze_command_list_handle_t command_list,
                                  ze_kernel_handle_t &function,
                                  struct ZeWorkGroups &workgroup_info, xpum_diag_task_type_t type, bool checkOnly = false);
 
@@ -254,12 +324,24 @@ class DiagnosticManager : public DiagnosticManagerInterface {
 
     static std::string roundDouble(double r, int precision);
 
-    static void stressThreadFunc(int stress_time,
-                                 const ze_device_handle_t &ze_device,
-                                 const ze_driver_handle_t &ze_driver,
+    static void stressThreadFunc(xpum_stress_options_t options,
+                                 std::shared_ptr<Device> p_device,
+                                 std::vector<ze_device_handle_t> peer_devices,
                                  std::shared_ptr<xpum_diag_task_info_t> p_task_info,
                                  std::mutex *p_mutex,
-                                 std::map<xpum_device_id_t, std::shared_ptr<std::vector<double>>> *p_stress_score_map);
+                                 StressScoreMap *p_stress_score_map);
+
+    static void stressCompute(StressRound &round, const ze_device_handle_t &ze_device, const ze_driver_handle_t &ze_driver,
+                              const std::string &kernel_file, const char *kernel_name,
+                              const void *input_value, std::size_t element_size, std::size_t flops_per_work_item);
+
+    static void stressMemoryBandwidth(StressRound &round, const ze_device_handle_t &ze_device, const ze_driver_handle_t &ze_driver);
+
+    // copy between host memory and ze_device, or from ze_device to peer_devices for XPUM_STRESS_PROFILE_XE_LINK
+    static void stressCopy(StressRound &round, const ze_device_handle_t &ze_device, const ze_driver_handle_t &ze_driver,
+                           const std::vector<ze_device_handle_t> &peer_devices);
+
+    static void stressMedia(StressRound &round, const zes_device_handle_t &zes_device);
     
     static void copyMemoryDataAndCalculateXeLinkThroughput(const ze_driver_handle_t &ze_driver, std::vector<std::tuple<ze_device_handle_t, zes_device_handle_t, int32_t, ze_device_handle_t, zes_device_handle_t, int32_t>> test_pairs,
                                                         std::map<xpum_device_id_t, PerfDatas> &diagnostic_perf_datas,
@@ -298,10 +380,12 @@ class DiagnosticManager : public DiagnosticManagerInterface {
 
     std::map<xpum_device_id_t, std::shared_ptr<xpum_diag_task_info_t>> stress_task_map;
 
-    std::map<xpum_device_id_t, std::shared_ptr<std::vector<double>>> stress_score_map;
+    StressScoreMap stress_score_map;
 
     std::vector<std::shared_ptr<Device>> devices;
 
+    std::atomic<bool> xe_link_matrix_running{false};
+
     std::mutex mutex;
 };
 
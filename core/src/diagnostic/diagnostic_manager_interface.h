@@ -30,9 +30,15 @@ class DiagnosticManagerInterface : public InitCloseInterface {
     virtual xpum_result_t getDiagnosticsMediaCodecResult(xpum_device_id_t deviceId, xpum_diag_media_codec_metrics_t resultList[], int *count) = 0;
 
     virtual xpum_result_t getDiagnosticsXeLinkThroughputResult(xpum_device_id_t deviceId, xpum_diag_xe_link_throughput_t resultList[], int *count) = 0;
+
+    virtual xpum_result_t runXeLinkMatrix(std::vector<xpum_device_id_t> deviceIds) = 0;
+
+    virtual bool isXeLinkMatrixRunning() = 0;
     
     virtual xpum_result_t runStress(xpum_device_id_t deviceId, uint32_t stressTime) = 0;
 
+    virtual xpum_result_t runStress(xpum_device_id_t deviceId, const xpum_stress_options_t &options) = 0;
+
     virtual xpum_result_t checkStress(xpum_device_id_t deviceId, xpum_diag_task_info_t resultList[], int *count) = 0;
 };
 } // end namespace xpum
@@ -0,0 +1,31 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file diagnostic_plugin.cpp
+ */
+
+#include "diagnostic_plugin.h"
+
+#include "diagnostic_manager.h"
+#include "infrastructure/xpum_config.h"
+
+extern "C" {
+
+xpum::DiagnosticManagerInterface* xpum_create_diagnostic_manager(const xpum::DiagnosticPluginContext& context) {
+#ifdef XPUM_PLUGIN
+    if (context.p_logger != nullptr) {
+        spdlog::set_default_logger(context.p_logger);
+    }
+#endif
+    auto p_device_manager = context.p_device_manager;
+    auto p_data_logic = context.p_data_logic;
+    auto p_firmware_manager = context.p_firmware_manager;
+    return new xpum::DiagnosticManager(p_device_manager, p_data_logic, p_firmware_manager);
+}
+
+#ifdef XPUM_PLUGIN
+const char* xpum_plugin_build() {
+    return XPUM_VERSION "+" XPUM_VERSION_GIT;
+}
+#endif
+}
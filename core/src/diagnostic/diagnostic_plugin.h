@@ -0,0 +1,101 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file diagnostic_plugin.h
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "control/device_manager_interface.h"
+#include "data_logic/data_logic_interface.h"
+#include "diagnostic_manager_interface.h"
+#include "firmware/firmware_manager.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+/*
+  The diagnostics are built into libxpum_diagnostic.so with BUILD_PLUGINS,
+  the core creates the manager by the entry below when the diagnostics are
+  used first. Without it the entry is a function of the core library.
+*/
+struct DiagnosticPluginContext {
+    std::shared_ptr<DeviceManagerInterface> p_device_manager;
+    std::shared_ptr<DataLogicInterface> p_data_logic;
+    std::shared_ptr<FirmwareManager> p_firmware_manager;
+    // the logger of the core, the plugin has its own copy of spdlog
+    std::shared_ptr<spdlog::logger> p_logger;
+};
+
+using CreateDiagnosticManagerFunc = DiagnosticManagerInterface* (*)(const DiagnosticPluginContext& context);
+
+#define XPUM_CREATE_DIAGNOSTIC_MANAGER_SYMBOL "xpum_create_diagnostic_manager"
+
+/*
+  The diagnostic manager used when the plugin is not installed, like in a
+  telemetry only deployment, every call returns XPUM_API_UNSUPPORTED.
+*/
+class UnavailableDiagnosticManager : public DiagnosticManagerInterface {
+   public:
+    void init() override {}
+
+    void close() override {}
+
+    xpum_result_t runLevelDiagnostics(xpum_device_id_t deviceId, xpum_diag_level_t level) override {
+        return XPUM_API_UNSUPPORTED;
+    }
+
+    xpum_result_t runMultipleSpecificDiagnostics(xpum_device_id_t deviceId, xpum_diag_task_type_t types[], int count) override {
+        return XPUM_API_UNSUPPORTED;
+    }
+
+    bool isDiagnosticsRunning(xpum_device_id_t deviceId) override {
+        return false;
+    }
+
+    xpum_result_t getDiagnosticsResult(xpum_device_id_t deviceId, xpum_diag_task_info_t* result) override {
+        return XPUM_API_UNSUPPORTED;
+    }
+
+    xpum_result_t getDiagnosticsMediaCodecResult(xpum_device_id_t deviceId, xpum_diag_media_codec_metrics_t resultList[], int* count) override {
+        return XPUM_API_UNSUPPORTED;
+    }
+
+    xpum_result_t getDiagnosticsXeLinkThroughputResult(xpum_device_id_t deviceId, xpum_diag_xe_link_throughput_t resultList[], int* count) override {
+        return XPUM_API_UNSUPPORTED;
+    }
+
+    xpum_result_t runXeLinkMatrix(std::vector<xpum_device_id_t> deviceIds) override {
+        return XPUM_API_UNSUPPORTED;
+    }
+
+    bool isXeLinkMatrixRunning() override {
+        return false;
+    }
+
+    xpum_result_t runStress(xpum_device_id_t deviceId, uint32_t stressTime) override {
+        return XPUM_API_UNSUPPORTED;
+    }
+
+    xpum_result_t runStress(xpum_device_id_t deviceId, const xpum_stress_options_t& options) override {
+        return XPUM_API_UNSUPPORTED;
+    }
+
+    xpum_result_t checkStress(xpum_device_id_t deviceId, xpum_diag_task_info_t resultList[], int* count) override {
+        return XPUM_API_UNSUPPORTED;
+    }
+};
+
+} // end namespace xpum
+
+extern "C" {
+
+// the manager is created and not initialized, the caller owns it
+xpum::DiagnosticManagerInterface* xpum_create_diagnostic_manager(const xpum::DiagnosticPluginContext& context);
+
+#ifdef XPUM_PLUGIN
+const char* xpum_plugin_build();
+#endif
+}
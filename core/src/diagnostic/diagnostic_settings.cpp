@@ -0,0 +1,41 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file diagnostic_settings.cpp
+ */
+
+#include "diagnostic_manager.h"
+
+namespace xpum {
+
+// the settings of the diagnostics stay in the core library with BUILD_PLUGINS, readConfigFile() of precheck sets them
+std::map<std::string, std::map<std::string, int>> DiagnosticManager::thresholds;
+std::map<ze_device_handle_t, std::string> DiagnosticManager::device_names;
+std::map<ze_device_handle_t, std::string> DiagnosticManager::device_firmwares;
+std::string DiagnosticManager::MEDIA_CODER_TOOLS_PATH = "/usr/share/mfx/samples/";
+std::string DiagnosticManager::MEDIA_CODER_TOOLS_1080P_FILE = "test_stream_1080p.265";
+std::string DiagnosticManager::MEDIA_CODER_TOOLS_4K_FILE = "test_stream_4K.265";
+std::string DiagnosticManager::MEDIA_CODEC_TOOLS_LIGHT_FILE = "test_stream.264";
+uint64_t DiagnosticManager::GPU_TEMPERATURE_THRESHOLD = 80;
+int DiagnosticManager::ZE_COMMAND_QUEUE_SYNCHRONIZE_TIMEOUT = 600;
+float DiagnosticManager::MEMORY_USE_PERCENTAGE_FOR_ERROR_TEST = 0.9;
+float DiagnosticManager::XE_LINK_THROUGHPUT_USAGE_PERCENTAGE = 0.7;
+int DiagnosticManager::REF_XE_LINK_THROUGHPUT_ONE_TILE_DEVICE = 23;
+int DiagnosticManager::REF_XE_LINK_THROUGHPUT_TWO_TILE_DEVICE = 19;
+float DiagnosticManager::XE_LINK_ALL_TO_ALL_THROUGHPUT_MIN_RATIO_OF_REF = 0.8;
+int DiagnosticManager::REF_XE_LINK_ALL_TO_ALL_THROUGHPUT_X2_ONE_TILE_DEVICE = 117;
+int DiagnosticManager::REF_XE_LINK_ALL_TO_ALL_THROUGHPUT_X4_ONE_TILE_DEVICE = 55;
+int DiagnosticManager::REF_XE_LINK_ALL_TO_ALL_THROUGHPUT_X8_ONE_TILE_DEVICE = 51;
+int DiagnosticManager::REF_XE_LINK_ALL_TO_ALL_THROUGHPUT_X2_TWO_TILE_DEVICE = 303;
+int DiagnosticManager::REF_XE_LINK_ALL_TO_ALL_THROUGHPUT_X4_TWO_TILE_DEVICE = 116;
+int DiagnosticManager::REF_XE_LINK_ALL_TO_ALL_THROUGHPUT_X8_TWO_TILE_DEVICE = 67;
+const std::string DiagnosticManager::COMPONENT_TYPE_NOT_SUPPORTED = "Not supported";
+const std::string DiagnosticManager::COMPONENT_TYPE_NOT_SUPPORTED_ON_PF = "Not supported on physical functions.";
+std::map<uint32_t, int32_t> DiagnosticManager::fabric_id_convert_to_device_id;
+std::map<int32_t, std::set<int32_t>> DiagnosticManager::device_id_link_to_device_ids;
+std::string DiagnosticManager::PVC_FW_MINIMUM_VERSION = "PVC2_1.23423";
+std::string DiagnosticManager::PVC_AMC_MINIMUM_VERSION = "6.7.0.0";
+std::string DiagnosticManager::ATSM150_FW_MINIMUM_VERSION = "DG02_1.3271";
+std::string DiagnosticManager::ATSM75_FW_MINIMUM_VERSION = "DG02_2.2277";
+
+} // end namespace xpum
@@ -6,6 +6,7 @@
 
 #include "helper.h"
 #include "diagnostic_manager.h"
+#include "kernel_cache.h"
 #include "precheck.h"
 #include "infrastructure/xpum_config.h"
 #include <sys/stat.h>
@@ -57,18 +58,8 @@ namespace xpum {
     }
 
     void moduleCreate(const ze_context_handle_t &context, ze_device_handle_t ze_device, std::vector<uint8_t> binary_file, ze_module_handle_t *module_handle) {
-        ze_module_desc_t module_description = {};
-        module_description.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
-        module_description.pNext = nullptr;
-        module_description.format = ZE_MODULE_FORMAT_IL_SPIRV;
-        module_description.inputSize = static_cast<uint32_t>(binary_file.size());
-        module_description.pInputModule = binary_file.data();
-        module_description.pBuildFlags = nullptr;
-        ze_result_t ret;
-        XPUM_ZE_HANDLE_LOCK(ze_device, ret = zeModuleCreate(context, ze_device, &module_description, module_handle, nullptr));
-        if (ret != ZE_RESULT_SUCCESS) {
-            throw BaseException("zeModuleCreate()[" + zeResultErrorCodeStr(ret) + "]");
-        }
+        // from the native binary of an earlier build if there is one
+        KernelCache::instance().createModule(context, ze_device, binary_file, module_handle);
     }
 
     void moduleDestroy(ze_module_handle_t hModule) {
@@ -260,6 +251,80 @@ namespace xpum {
         }
     }
 
+    void commandListAppendSignalEvent(ze_command_list_handle_t hCommandList, ze_event_handle_t hEvent) {
+        ze_result_t ret = zeCommandListAppendSignalEvent(hCommandList, hEvent);
+        if (ret != ZE_RESULT_SUCCESS) {
+            throw BaseException("zeCommandListAppendSignalEvent()[" + zeResultErrorCodeStr(ret) + "]");
+        }
+    }
+
+    void commandListAppendWaitOnEvent(ze_command_list_handle_t hCommandList, ze_event_handle_t hEvent) {
+        ze_result_t ret = zeCommandListAppendWaitOnEvents(hCommandList, 1, &hEvent);
+        if (ret != ZE_RESULT_SUCCESS) {
+            throw BaseException("zeCommandListAppendWaitOnEvents()[" + zeResultErrorCodeStr(ret) + "]");
+        }
+    }
+
+    void commandListAppendWriteGlobalTimestamp(ze_command_list_handle_t hCommandList, uint64_t *dstptr) {
+        ze_result_t ret = zeCommandListAppendWriteGlobalTimestamp(hCommandList, dstptr, nullptr, 0, nullptr);
+        if (ret != ZE_RESULT_SUCCESS) {
+            throw BaseException("zeCommandListAppendWriteGlobalTimestamp()[" + zeResultErrorCodeStr(ret) + "]");
+        }
+    }
+
+    void eventPoolCreate(const ze_context_handle_t &context, uint32_t count, ze_event_pool_handle_t *phEventPool) {
+        ze_event_pool_desc_t event_pool_description = {};
+        event_pool_description.stype = ZE_STRUCTURE_TYPE_EVENT_POOL_DESC;
+        event_pool_description.pNext = nullptr;
+        event_pool_description.flags = ZE_EVENT_POOL_FLAG_HOST_VISIBLE;
+        event_pool_description.count = count;
+        ze_result_t ret = zeEventPoolCreate(context, &event_pool_description, 0, nullptr, phEventPool);
+        if (ret != ZE_RESULT_SUCCESS) {
+            throw BaseException("zeEventPoolCreate()[" + zeResultErrorCodeStr(ret) + "]");
+        }
+    }
+
+    void eventPoolDestroy(ze_event_pool_handle_t hEventPool) {
+        ze_result_t ret = zeEventPoolDestroy(hEventPool);
+        if (ret != ZE_RESULT_SUCCESS) {
+            throw BaseException("zeEventPoolDestroy()[" + zeResultErrorCodeStr(ret) + "]");
+        }
+    }
+
+    void eventCreate(ze_event_pool_handle_t hEventPool, uint32_t index, ze_event_handle_t *phEvent) {
+        ze_event_desc_t event_description = {};
+        event_description.stype = ZE_STRUCTURE_TYPE_EVENT_DESC;
+        event_description.pNext = nullptr;
+        event_description.index = index;
+        event_description.signal = ZE_EVENT_SCOPE_FLAG_HOST;
+        event_description.wait = ZE_EVENT_SCOPE_FLAG_HOST;
+        ze_result_t ret = zeEventCreate(hEventPool, &event_description, phEvent);
+        if (ret != ZE_RESULT_SUCCESS) {
+            throw BaseException("zeEventCreate()[" + zeResultErrorCodeStr(ret) + "]");
+        }
+    }
+
+    void eventDestroy(ze_event_handle_t hEvent) {
+        ze_result_t ret = zeEventDestroy(hEvent);
+        if (ret != ZE_RESULT_SUCCESS) {
+            throw BaseException("zeEventDestroy()[" + zeResultErrorCodeStr(ret) + "]");
+        }
+    }
+
+    void eventHostSynchronize(ze_event_handle_t hEvent) {
+        ze_result_t ret = zeEventHostSynchronize(hEvent, UINT64_MAX);
+        if (ret != ZE_RESULT_SUCCESS) {
+            throw BaseException("zeEventHostSynchronize()[" + zeResultErrorCodeStr(ret) + "]");
+        }
+    }
+
+    void eventHostReset(ze_event_handle_t hEvent) {
+        ze_result_t ret = zeEventHostReset(hEvent);
+        if (ret != ZE_RESULT_SUCCESS) {
+            throw BaseException("zeEventHostReset()[" + zeResultErrorCodeStr(ret) + "]");
+        }
+    }
+
     bool zeDeviceCanAccessAllPeer(std::vector<ze_device_handle_t> ze_devices) {
         bool canAccessAll = true;
         ze_result_t ret;
@@ -269,7 +334,7 @@ namespace xpum {
                     break;
                 if (ze_device_lh != ze_device_rh) {
                     ze_bool_t can_access;
-                    XPUM_ZE_HANDLE_LOCK(ze_device_lh, ret = zeDeviceCanAccessPeer(ze_device_lh, ze_device_rh, &can_access));
+                    XPUM_ZE_HANDLE_SHARED_LOCK(ze_device_lh, ret = zeDeviceCanAccessPeer(ze_device_lh, ze_device_rh, &can_access));
                     if (ret != ZE_RESULT_SUCCESS || can_access != 1) {
                         canAccessAll = false;
                         break;
@@ -285,8 +350,7 @@ namespace xpum {
         return (stat(s.c_str(), &buffer) == 0);
     }
     
-    void readConfigFile(std::string conf_file_name) {
-        DiagnosticManager::thresholds.clear();
+    std::string getConfigFilePath(const std::string &conf_file_name) {
         std::string file_name = std::string(XPUM_CONFIG_DIR) + conf_file_name;
         if (!isPathExist(file_name)) {
             char exe_path[XPUM_MAX_PATH_LEN];
@@ -309,6 +373,12 @@ namespace xpum {
                     file_name = current_file.substr(0, current_file.find_last_of('/')) + "/../lib64/xpu-smi/config/" + conf_file_name;
             }
         }
+        return file_name;
+    }
+
+    void readConfigFile(std::string conf_file_name) {
+        DiagnosticManager::thresholds.clear();
+        std::string file_name = getConfigFilePath(conf_file_name);
         std::ifstream conf_file(file_name);
         if (conf_file.is_open()) {
             XPUM_LOG_DEBUG("read config for diagnostics and precheck from file: {}", file_name);
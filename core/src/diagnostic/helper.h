@@ -22,6 +22,9 @@ namespace xpum {
 
     bool isPathExist(const std::string &s);
 
+    // the config file in the config folder of XPUM, or next to the executable
+    std::string getConfigFilePath(const std::string &conf_file_name);
+
     void readConfigFile(std::string conf_file_name);
 
     double calculateMean(const std::vector<double>& data);
@@ -78,6 +81,24 @@ namespace xpum {
 
     void commandListDestroy(ze_command_list_handle_t hCommandList);
 
+    void commandListAppendSignalEvent(ze_command_list_handle_t hCommandList, ze_event_handle_t hEvent);
+
+    void commandListAppendWaitOnEvent(ze_command_list_handle_t hCommandList, ze_event_handle_t hEvent);
+
+    void commandListAppendWriteGlobalTimestamp(ze_command_list_handle_t hCommandList, uint64_t *dstptr);
+
+    void eventPoolCreate(const ze_context_handle_t &context, uint32_t count, ze_event_pool_handle_t *phEventPool);
+
+    void eventPoolDestroy(ze_event_pool_handle_t hEventPool);
+
+    void eventCreate(ze_event_pool_handle_t hEventPool, uint32_t index, ze_event_handle_t *phEvent);
+
+    void eventDestroy(ze_event_handle_t hEvent);
+
+    void eventHostSynchronize(ze_event_handle_t hEvent);
+
+    void eventHostReset(ze_event_handle_t hEvent);
+
     bool zeDeviceCanAccessAllPeer(std::vector<ze_device_handle_t> ze_devices);
 
 } // namespace xpum
\ No newline at end of file
@@ -0,0 +1,204 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file kernel_cache.cpp
+ */
+
+#include "kernel_cache.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "helper.h"
+#include "infrastructure/configuration.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+static void buildModule(const ze_context_handle_t& context, ze_device_handle_t ze_device, ze_module_format_t format,
+                        const std::vector<uint8_t>& binary, ze_module_handle_t* module_handle, ze_result_t& ret) {
+    ze_module_desc_t module_description = {};
+    module_description.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+    module_description.pNext = nullptr;
+    module_description.format = format;
+    module_description.inputSize = static_cast<uint32_t>(binary.size());
+    module_description.pInputModule = binary.data();
+    module_description.pBuildFlags = nullptr;
+    XPUM_ZE_HANDLE_LOCK(ze_device, ret = zeModuleCreate(context, ze_device, &module_description, module_handle, nullptr));
+}
+
+// FNV-1a, stable across builds unlike std::hash
+static uint64_t hashOf(const std::vector<uint8_t>& data) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (auto byte : data) {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static bool createDirectories(const std::string& path) {
+    for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+        std::string dir = path.substr(0, pos);
+        if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+        if (pos == std::string::npos) {
+            return true;
+        }
+    }
+}
+
+KernelCache& KernelCache::instance() {
+    static KernelCache cache;
+    return cache;
+}
+
+std::vector<uint8_t> KernelCache::getSpirv(const std::string& name, const std::function<std::vector<uint8_t>()>& load) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = spirvs.find(name);
+        if (it != spirvs.end()) {
+            return it->second;
+        }
+    }
+    std::vector<uint8_t> spirv = load();
+    std::lock_guard<std::mutex> lock(mutex);
+    spirvs[name] = spirv;
+    return spirv;
+}
+
+std::string KernelCache::buildKey(ze_device_handle_t ze_device, const std::vector<uint8_t>& spirv) {
+    ze_device_properties_t device_properties = {};
+    device_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+    ze_result_t ret;
+    XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetProperties(ze_device, &device_properties));
+    if (ret != ZE_RESULT_SUCCESS) {
+        return "";
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!driver_versions_read) {
+        // a native binary is only valid for the driver that built it
+        uint32_t driver_count = 0;
+        if (zeDriverGet(&driver_count, nullptr) == ZE_RESULT_SUCCESS && driver_count > 0) {
+            std::vector<ze_driver_handle_t> drivers(driver_count);
+            if (zeDriverGet(&driver_count, drivers.data()) == ZE_RESULT_SUCCESS) {
+                for (auto driver : drivers) {
+                    ze_driver_properties_t driver_properties = {};
+                    driver_properties.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+                    if (zeDriverGetProperties(driver, &driver_properties) == ZE_RESULT_SUCCESS) {
+                        driver_versions += "-" + std::to_string(driver_properties.driverVersion);
+                    }
+                }
+            }
+        }
+        driver_versions_read = true;
+    }
+
+    std::stringstream ss;
+    ss << std::hex << device_properties.vendorId << "-" << device_properties.deviceId << driver_versions
+       << "-" << std::setfill('0') << std::setw(16) << hashOf(spirv);
+    return ss.str();
+}
+
+bool KernelCache::loadNativeBinary(const std::string& key, std::vector<uint8_t>& binary) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = native_binaries.find(key);
+        if (it != native_binaries.end()) {
+            binary = it->second;
+            return true;
+        }
+    }
+    if (Configuration::DIAGNOSTIC_KERNEL_CACHE_DIR.empty()) {
+        return false;
+    }
+    std::ifstream ifs(Configuration::DIAGNOSTIC_KERNEL_CACHE_DIR + "/" + key + ".bin", std::ios::in | std::ios::binary);
+    if (!ifs.good()) {
+        return false;
+    }
+    binary.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    if (binary.empty()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    native_binaries[key] = binary;
+    return true;
+}
+
+void KernelCache::storeNativeBinary(const std::string& key, ze_module_handle_t module_handle) {
+    size_t size = 0;
+    if (zeModuleGetNativeBinary(module_handle, &size, nullptr) != ZE_RESULT_SUCCESS || size == 0) {
+        return;
+    }
+    std::vector<uint8_t> binary(size);
+    if (zeModuleGetNativeBinary(module_handle, &size, binary.data()) != ZE_RESULT_SUCCESS) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        native_binaries[key] = binary;
+    }
+
+    const std::string& dir = Configuration::DIAGNOSTIC_KERNEL_CACHE_DIR;
+    if (dir.empty()) {
+        return;
+    }
+    if (!createDirectories(dir)) {
+        XPUM_LOG_DEBUG("Failed to create the diagnostic kernel cache directory {}", dir);
+        return;
+    }
+    // write a temporary file and rename it, so a reader never sees a partial file
+    std::string path = dir + "/" + key + ".bin";
+    std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream ofs(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!ofs.good()) {
+            XPUM_LOG_DEBUG("Failed to write diagnostic kernel cache {}", path);
+            return;
+        }
+        ofs.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+        if (!ofs.good()) {
+            ofs.close();
+            remove(tmp_path.c_str());
+            return;
+        }
+    }
+    if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+        remove(tmp_path.c_str());
+        XPUM_LOG_DEBUG("Failed to write diagnostic kernel cache {}", path);
+    }
+}
+
+void KernelCache::createModule(const ze_context_handle_t& context, ze_device_handle_t ze_device,
+                               const std::vector<uint8_t>& spirv, ze_module_handle_t* module_handle) {
+    ze_result_t ret;
+    std::string key = buildKey(ze_device, spirv);
+    std::vector<uint8_t> native_binary;
+    if (!key.empty() && loadNativeBinary(key, native_binary)) {
+        buildModule(context, ze_device, ZE_MODULE_FORMAT_NATIVE, native_binary, module_handle, ret);
+        if (ret == ZE_RESULT_SUCCESS) {
+            return;
+        }
+        XPUM_LOG_DEBUG("Cached native binary {} is rejected: {}", key, zeResultErrorCodeStr(ret));
+        std::lock_guard<std::mutex> lock(mutex);
+        native_binaries.erase(key);
+    }
+
+    buildModule(context, ze_device, ZE_MODULE_FORMAT_IL_SPIRV, spirv, module_handle, ret);
+    if (ret != ZE_RESULT_SUCCESS) {
+        throw BaseException("zeModuleCreate()[" + zeResultErrorCodeStr(ret) + "]");
+    }
+    if (!key.empty()) {
+        storeNativeBinary(key, *module_handle);
+    }
+}
+
+} // end namespace xpum
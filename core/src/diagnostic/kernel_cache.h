@@ -0,0 +1,65 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file kernel_cache.h
+ */
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "level_zero/ze_api.h"
+
+namespace xpum {
+
+/*
+  KernelCache keeps the kernels of the diagnostics, so that a repeated run
+  does not read and JIT compile them again.
+
+  The SPIR-V files are read once per process. A module built from SPIR-V
+  stores its native binary, in memory and in the directory
+  Configuration::DIAGNOSTIC_KERNEL_CACHE_DIR. A later module of the same
+  SPIR-V on the same kind of device and driver is created from the native
+  binary, and built from SPIR-V again if the driver rejects it.
+*/
+class KernelCache {
+   public:
+    static KernelCache& instance();
+
+    /*
+      The content of the kernel file name, load returns it the first time.
+    */
+    std::vector<uint8_t> getSpirv(const std::string& name, const std::function<std::vector<uint8_t>()>& load);
+
+    /*
+      Create the module of spirv on ze_device, throw BaseException on failure.
+    */
+    void createModule(const ze_context_handle_t& context, ze_device_handle_t ze_device,
+                      const std::vector<uint8_t>& spirv, ze_module_handle_t* module_handle);
+
+   private:
+    KernelCache() = default;
+
+    // empty if the device properties can not be read
+    std::string buildKey(ze_device_handle_t ze_device, const std::vector<uint8_t>& spirv);
+
+    bool loadNativeBinary(const std::string& key, std::vector<uint8_t>& binary);
+
+    void storeNativeBinary(const std::string& key, ze_module_handle_t module_handle);
+
+    std::mutex mutex;
+
+    bool driver_versions_read = false;
+
+    std::string driver_versions;
+
+    std::map<std::string, std::vector<uint8_t>> spirvs;
+
+    std::map<std::string, std::vector<uint8_t>> native_binaries;
+};
+
+} // end namespace xpum
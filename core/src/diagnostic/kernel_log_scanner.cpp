@@ -0,0 +1,352 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file kernel_log_scanner.cpp
+ */
+
+#include "kernel_log_scanner.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <queue>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/logger.h"
+
+using namespace nlohmann;
+
+namespace xpum {
+
+// changed whenever the saved state or its meaning change
+static const int PRECHECK_LOG_STATE_VERSION = 1;
+
+// the first lines are the ones precheck reports, later ones of a noisy log are dropped
+static const size_t MAX_KEPT_LINES = 4096;
+
+static std::string readFirstLine(const std::string& path) {
+    std::ifstream ifs(path);
+    std::string line;
+    if (ifs.good()) {
+        std::getline(ifs, line);
+    }
+    return line;
+}
+
+KeywordMatcher::KeywordMatcher(const std::vector<std::string>& keywords) {
+    states.emplace_back();
+    std::fill(std::begin(states[0].next), std::end(states[0].next), -1);
+    for (size_t i = 0; i < keywords.size() && i < 64; i++) {
+        int32_t s = 0;
+        for (unsigned char c : keywords[i]) {
+            c = std::tolower(c);
+            if (states[s].next[c] < 0) {
+                states[s].next[c] = states.size();
+                states.emplace_back();
+                std::fill(std::begin(states.back().next), std::end(states.back().next), -1);
+            }
+            s = states[s].next[c];
+        }
+        states[s].output |= 1ULL << i;
+    }
+
+    // turn the trie into a DFA, the missing transitions follow the failure links
+    std::vector<int32_t> fail(states.size(), 0);
+    std::queue<int32_t> queue;
+    for (int c = 0; c < 256; c++) {
+        int32_t v = states[0].next[c];
+        if (v < 0) {
+            states[0].next[c] = 0;
+        } else {
+            fail[v] = 0;
+            queue.push(v);
+        }
+    }
+    while (!queue.empty()) {
+        int32_t u = queue.front();
+        queue.pop();
+        states[u].output |= states[fail[u]].output;
+        for (int c = 0; c < 256; c++) {
+            int32_t v = states[u].next[c];
+            if (v < 0) {
+                states[u].next[c] = states[fail[u]].next[c];
+            } else {
+                fail[v] = states[fail[u]].next[c];
+                queue.push(v);
+            }
+        }
+    }
+}
+
+uint64_t KeywordMatcher::match(const std::string& text) const {
+    uint64_t found = 0;
+    int32_t s = 0;
+    for (unsigned char c : text) {
+        s = states[s].next[std::tolower(c)];
+        found |= states[s].output;
+    }
+    return found;
+}
+
+KernelLogScanner::KernelLogScanner(Source source, const std::string& file, const std::string& since_time, const std::string& filter_id)
+    : source(source), file(file), since_time(since_time) {
+    key = std::to_string(source) + "|" + file + "|" + since_time + "|" + filter_id;
+    boot_id = readFirstLine("/proc/sys/kernel/random/boot_id");
+}
+
+std::vector<std::string> KernelLogScanner::scan(const KernelLogFilter_t& filter) {
+    loadState();
+    size_t saved = lines.size();
+    switch (source) {
+        case SOURCE_JOURNAL:
+            readJournal(filter);
+            break;
+        case SOURCE_KMSG:
+            readKmsg(filter);
+            break;
+        case SOURCE_FILE:
+            readFile(filter);
+            break;
+    }
+    XPUM_LOG_DEBUG("precheck kernel log scan: {} saved lines, {} lines now", saved, lines.size());
+    saveState();
+    return lines;
+}
+
+void KernelLogScanner::loadState() {
+    cursor.clear();
+    lines.clear();
+    const std::string& path = Configuration::PRECHECK_LOG_STATE_FILE;
+    if (path.empty() || boot_id.empty()) {
+        return;
+    }
+    std::ifstream ifs(path);
+    if (!ifs.good()) {
+        return;
+    }
+    try {
+        json j = json::parse(ifs);
+        if (j.value("version", 0) != PRECHECK_LOG_STATE_VERSION || j.value("boot_id", "") != boot_id || j.value("key", "") != key) {
+            return;
+        }
+        cursor = j.value("cursor", "");
+        lines = j.at("lines").get<std::vector<std::string>>();
+    } catch (std::exception& e) {
+        XPUM_LOG_DEBUG("Invalid precheck log state {}: {}", path, e.what());
+        cursor.clear();
+        lines.clear();
+    }
+}
+
+void KernelLogScanner::saveState() {
+    const std::string& path = Configuration::PRECHECK_LOG_STATE_FILE;
+    if (path.empty() || boot_id.empty() || cursor.empty()) {
+        return;
+    }
+    auto pos = path.rfind('/');
+    if (pos != std::string::npos && pos > 0) {
+        std::string dir = path.substr(0, pos);
+        if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+            XPUM_LOG_DEBUG("Failed to create the directory of precheck log state {}", path);
+            return;
+        }
+    }
+
+    json j;
+    j["version"] = PRECHECK_LOG_STATE_VERSION;
+    j["boot_id"] = boot_id;
+    j["key"] = key;
+    j["cursor"] = cursor;
+    j["lines"] = lines;
+    // write a temporary file and rename it, so a reader never sees a partial file
+    std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream ofs(tmp_path, std::ios::trunc);
+        if (!ofs.good()) {
+            XPUM_LOG_DEBUG("Failed to write precheck log state {}", path);
+            return;
+        }
+        ofs << j.dump();
+        if (!ofs.good()) {
+            ofs.close();
+            remove(tmp_path.c_str());
+            return;
+        }
+    }
+    if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+        remove(tmp_path.c_str());
+        XPUM_LOG_DEBUG("Failed to write precheck log state {}", path);
+    }
+}
+
+void KernelLogScanner::addLine(const std::string& line, const KernelLogFilter_t& filter) {
+    static const KeywordMatcher boot_matcher({"command line: ", "boot"});
+    if (boot_matcher.match(line) == 3) {
+        XPUM_LOG_DEBUG("precheck find kernel boot log: {}", line);
+        lines.clear();
+    }
+    if (lines.size() < MAX_KEPT_LINES && filter(line)) {
+        lines.push_back(line);
+    }
+}
+
+int KernelLogScanner::readCommand(const std::string& command, const KernelLogFilter_t& filter) {
+    XPUM_LOG_INFO("precheck log command: {}", command);
+    FILE* f = popen(command.c_str(), "r");
+    if (f == nullptr) {
+        XPUM_LOG_ERROR("Failed to check log with command: {}", command);
+        return -1;
+    }
+    char* buf = nullptr;
+    size_t size = 0;
+    ssize_t len;
+    while ((len = getline(&buf, &size, f)) >= 0) {
+        if (len > 0 && buf[len - 1] == '\n') {
+            buf[--len] = '\0';
+        }
+        std::string line(buf, len);
+        static const std::string cursor_prefix = "-- cursor: ";
+        if (source == SOURCE_JOURNAL && line.compare(0, cursor_prefix.size(), cursor_prefix) == 0) {
+            cursor = line.substr(cursor_prefix.size());
+            continue;
+        }
+        addLine(line, filter);
+    }
+    free(buf);
+    return pclose(f);
+}
+
+void KernelLogScanner::readJournal(const KernelLogFilter_t& filter) {
+    std::string command = "journalctl -q -b 0 --dmesg -o short-iso --show-cursor";
+    if (!since_time.empty()) {
+        command += " --since \"" + since_time + "\"";
+    }
+    if (cursor.empty()) {
+        readCommand(command, filter);
+        return;
+    }
+    // the cursor consists of hex digits, '=' and ';'
+    if (readCommand(command + " --after-cursor '" + cursor + "'", filter) != 0) {
+        // the entry of the cursor may have been rotated away
+        cursor.clear();
+        lines.clear();
+        readCommand(command, filter);
+    }
+}
+
+void KernelLogScanner::readKmsg(const KernelLogFilter_t& filter) {
+    int fd = open("/dev/kmsg", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        // e.g. kernel.dmesg_restrict, dmesg may still be allowed to read it
+        XPUM_LOG_DEBUG("Failed to open /dev/kmsg: {}", strerror(errno));
+        cursor.clear();
+        lines.clear();
+        readCommand("dmesg --time-format iso", filter);
+        return;
+    }
+
+    int64_t boot_time = bootTime();
+    uint64_t last_seq = cursor.empty() ? 0 : std::strtoull(cursor.c_str(), nullptr, 10);
+    bool has_last_seq = !cursor.empty();
+    char record[8192];
+    while (true) {
+        ssize_t len = read(fd, record, sizeof(record) - 1);
+        if (len < 0) {
+            // EPIPE: records were overwritten before they were read, go on with the next one
+            if (errno == EPIPE || errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        record[len] = '\0';
+        uint64_t seq;
+        std::string line;
+        if (!parseKmsgRecord(record, boot_time, seq, line)) {
+            continue;
+        }
+        if (has_last_seq && seq <= last_seq) {
+            continue;
+        }
+        last_seq = seq;
+        has_last_seq = true;
+        addLine(line, filter);
+    }
+    close(fd);
+    if (has_last_seq) {
+        cursor = std::to_string(last_seq);
+    }
+}
+
+int64_t KernelLogScanner::bootTime() {
+    // dmesg shows the records relative to the boot time too
+    struct timespec now_real, now_boot;
+    clock_gettime(CLOCK_REALTIME, &now_real);
+    clock_gettime(CLOCK_BOOTTIME, &now_boot);
+    return (now_real.tv_sec - now_boot.tv_sec) * 1000000LL + (now_real.tv_nsec - now_boot.tv_nsec) / 1000;
+}
+
+bool KernelLogScanner::parseKmsgRecord(char* record, int64_t boot_time, uint64_t& seq, std::string& line) {
+    // "<priority>,<sequence>,<microseconds>,<flags>;<message>\n" and continuation lines
+    unsigned long long record_seq, us;
+    char* message = strchr(record, ';');
+    if (message == nullptr || sscanf(record, "%*u,%llu,%llu", &record_seq, &us) != 2) {
+        return false;
+    }
+    seq = record_seq;
+    message++;
+    char* end = strchr(message, '\n');
+    if (end != nullptr) {
+        *end = '\0';
+    }
+
+    // YYYY-MM-DDThh:mm:ss,uuuuuu+hh:mm
+    int64_t t_us = boot_time + (int64_t)us;
+    time_t t = t_us / 1000000;
+    struct tm tm;
+    localtime_r(&t, &tm);
+    char time[64], zone[8];
+    size_t n = strftime(time, sizeof(time), "%Y-%m-%dT%H:%M:%S", &tm);
+    strftime(zone, sizeof(zone), "%z", &tm);
+    snprintf(time + n, sizeof(time) - n, ",%06lld%.3s:%s", (long long)(t_us % 1000000), zone, zone + 3);
+    line = std::string(time) + " " + message;
+    return true;
+}
+
+void KernelLogScanner::readFile(const KernelLogFilter_t& filter) {
+    struct stat st;
+    if (stat(file.c_str(), &st) != 0) {
+        XPUM_LOG_ERROR("Failed to check log file: {}", file);
+        return;
+    }
+    // continue at the saved offset if it is the same file and it only grew
+    unsigned long long inode = 0, offset = 0;
+    if (cursor.empty() || sscanf(cursor.c_str(), "%llu:%llu", &inode, &offset) != 2 ||
+        inode != (unsigned long long)st.st_ino || offset > (unsigned long long)st.st_size) {
+        offset = 0;
+        lines.clear();
+    }
+    std::ifstream ifs(file);
+    if (!ifs.good()) {
+        XPUM_LOG_ERROR("Failed to check log file: {}", file);
+        return;
+    }
+    ifs.seekg(offset);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        offset += line.size() + (ifs.eof() ? 0 : 1);
+        addLine(line, filter);
+    }
+    cursor = std::to_string((unsigned long long)st.st_ino) + ":" + std::to_string(offset);
+}
+
+} // end namespace xpum
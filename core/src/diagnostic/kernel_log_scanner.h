@@ -0,0 +1,111 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file kernel_log_scanner.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace xpum {
+
+/*
+  KeywordMatcher finds which of up to 64 keywords occur in a text in one
+  pass over it (Aho-Corasick), ignoring the case of ASCII letters.
+*/
+class KeywordMatcher {
+   public:
+    explicit KeywordMatcher(const std::vector<std::string>& keywords);
+
+    // bit i is set if keywords[i] occurs in text
+    uint64_t match(const std::string& text) const;
+
+   private:
+    struct State {
+        int32_t next[256];
+        uint64_t output = 0;
+    };
+
+    std::vector<State> states;
+};
+
+typedef std::function<bool(const std::string& line)> KernelLogFilter_t;
+
+/*
+  KernelLogScanner reads the kernel messages of the current boot for
+  precheck, from the journal, /dev/kmsg or a log file, and keeps the lines
+  the filter accepts.
+
+  The kept lines and the position read up to are saved in
+  Configuration::PRECHECK_LOG_STATE_FILE, so a later scan of the same
+  source with the same filter id only reads the new messages. A line that
+  starts a boot drops the lines kept before it, as only the last boot is
+  checked.
+*/
+class KernelLogScanner {
+   public:
+    enum Source {
+        SOURCE_JOURNAL,
+        SOURCE_KMSG,
+        SOURCE_FILE
+    };
+
+    /*
+      file is the log file of SOURCE_FILE, since_time limits the journal.
+      filter_id identifies what filter accepts, a saved state of another
+      filter id is not used.
+    */
+    KernelLogScanner(Source source, const std::string& file, const std::string& since_time, const std::string& filter_id);
+
+    /*
+      The kept lines of the current boot, oldest first. Lines of the kernel
+      ring buffer are formatted like dmesg --time-format iso does.
+    */
+    std::vector<std::string> scan(const KernelLogFilter_t& filter);
+
+    // the wall clock time of the boot in microseconds, the kmsg records are relative to it
+    static int64_t bootTime();
+
+    /*
+      Parse the /dev/kmsg record, a line like dmesg --time-format iso prints
+      and its sequence number. Return false if record is not valid.
+    */
+    static bool parseKmsgRecord(char* record, int64_t boot_time, uint64_t& seq, std::string& line);
+
+   private:
+    void loadState();
+
+    void saveState();
+
+    void addLine(const std::string& line, const KernelLogFilter_t& filter);
+
+    void readJournal(const KernelLogFilter_t& filter);
+
+    void readKmsg(const KernelLogFilter_t& filter);
+
+    // return the exit status of command
+    int readCommand(const std::string& command, const KernelLogFilter_t& filter);
+
+    void readFile(const KernelLogFilter_t& filter);
+
+    Source source;
+
+    std::string file;
+
+    std::string since_time;
+
+    std::string key;
+
+    std::string boot_id;
+
+    // the journal cursor, the last kmsg sequence number or the inode and offset of the file
+    std::string cursor;
+
+    std::vector<std::string> lines;
+};
+
+} // end namespace xpum
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file micro_benchmark.cpp
+ */
+
+#include "micro_benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "helper.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+const uint32_t MicroBenchmark::DEFAULT_WARMUP_ITERATIONS;
+
+const uint32_t MicroBenchmark::DEFAULT_ITERATIONS;
+
+MicroBenchmark::MicroBenchmark(const ze_context_handle_t &context, ze_device_handle_t ze_device,
+                               uint32_t warmup_iterations, uint32_t iterations)
+    : context(context), warmup_iterations(warmup_iterations), iterations(std::max(iterations, (uint32_t)1)) {
+    getDeviceTimer(ze_device, ns_per_tick, timestamp_mask);
+    void *memory = nullptr;
+    memoryAllocHost(context, 2 * sizeof(uint64_t), sizeof(uint64_t), &memory);
+    timestamps = static_cast<uint64_t *>(memory);
+}
+
+MicroBenchmark::~MicroBenchmark() {
+    if (timestamps != nullptr) {
+        zeMemFree(context, timestamps);
+    }
+}
+
+void MicroBenchmark::getDeviceTimer(ze_device_handle_t ze_device, double &ns_per_tick, uint64_t &timestamp_mask) {
+    ze_device_properties_t device_properties = {};
+    device_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES_1_2;
+    ze_result_t ret;
+    XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetProperties(ze_device, &device_properties));
+    if (ret != ZE_RESULT_SUCCESS) {
+        throw BaseException("zeDeviceGetProperties()[" + zeResultErrorCodeStr(ret) + "]");
+    }
+    // the resolution is in cycles per second with this structure type, and in ns before 1.2
+    if (device_properties.timerResolution > 0) {
+        ns_per_tick = 1000000000.0 / device_properties.timerResolution;
+    } else {
+        device_properties.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+        XPUM_ZE_HANDLE_SHARED_LOCK(ze_device, ret = zeDeviceGetProperties(ze_device, &device_properties));
+        ns_per_tick = (ret == ZE_RESULT_SUCCESS && device_properties.timerResolution > 0) ? device_properties.timerResolution : 1;
+    }
+    uint32_t valid_bits = device_properties.timestampValidBits;
+    timestamp_mask = (valid_bits == 0 || valid_bits >= 64) ? UINT64_MAX : (1ULL << valid_bits) - 1;
+}
+
+MicroBenchmarkResult MicroBenchmark::run(ze_command_queue_handle_t command_queue, ze_command_list_handle_t command_list,
+                                         const std::function<void(ze_command_list_handle_t)> &append) {
+    // the barriers keep the commands between the timestamps
+    commandListAppendWriteGlobalTimestamp(command_list, &timestamps[0]);
+    commandListAppendBarrier(command_list);
+    append(command_list);
+    commandListAppendBarrier(command_list);
+    commandListAppendWriteGlobalTimestamp(command_list, &timestamps[1]);
+    commandListClose(command_list);
+
+    for (uint32_t i = 0; i < warmup_iterations; i++) {
+        commandQueueExecuteCommandLists(command_queue, command_list);
+        commandQueueSynchronize(command_queue);
+    }
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for (uint32_t i = 0; i < iterations; i++) {
+        commandQueueExecuteCommandLists(command_queue, command_list);
+        commandQueueSynchronize(command_queue);
+        // the counter may wrap around between the timestamps
+        uint64_t ticks = (timestamps[1] - timestamps[0]) & timestamp_mask;
+        samples.push_back(ticks * ns_per_tick);
+    }
+
+    MicroBenchmarkResult result;
+    result.iterations = iterations;
+    double sum = 0;
+    for (auto sample : samples) {
+        sum += sample;
+    }
+    result.mean_nsec = sum / samples.size();
+    double square_sum = 0;
+    for (auto sample : samples) {
+        square_sum += (sample - result.mean_nsec) * (sample - result.mean_nsec);
+    }
+    result.stddev_nsec = std::sqrt(square_sum / samples.size());
+    std::sort(samples.begin(), samples.end());
+    result.min_nsec = samples.front();
+    size_t middle = samples.size() / 2;
+    result.median_nsec = samples.size() % 2 == 1 ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2;
+    XPUM_LOG_DEBUG("micro benchmark - iters: {}, min: {} ns, median: {} ns, mean: {} ns, stddev: {} ns",
+                   result.iterations, result.min_nsec, result.median_nsec, result.mean_nsec, result.stddev_nsec);
+    return result;
+}
+
+} // end namespace xpum
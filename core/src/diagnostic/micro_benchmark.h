@@ -0,0 +1,74 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file micro_benchmark.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "level_zero/ze_api.h"
+
+namespace xpum {
+
+struct MicroBenchmarkResult {
+    uint32_t iterations = 0;
+    double min_nsec = 0;
+    double median_nsec = 0;
+    double mean_nsec = 0;
+    double stddev_nsec = 0;
+};
+
+/*
+  MicroBenchmark times the commands of a command list with the device timer.
+  Global timestamps are written before and after the commands, so a short
+  kernel or copy is not measured together with its submission and the host
+  synchronization. The list is run a number of warm-up iterations first,
+  then the measured ones, the median of which is the time to report.
+*/
+class MicroBenchmark {
+   public:
+    // consistent with ze_peak
+    static const uint32_t DEFAULT_WARMUP_ITERATIONS = 5;
+
+    static const uint32_t DEFAULT_ITERATIONS = 20;
+
+    MicroBenchmark(const ze_context_handle_t &context, ze_device_handle_t ze_device,
+                   uint32_t warmup_iterations = DEFAULT_WARMUP_ITERATIONS, uint32_t iterations = DEFAULT_ITERATIONS);
+
+    ~MicroBenchmark();
+
+    MicroBenchmark(const MicroBenchmark &) = delete;
+
+    MicroBenchmark &operator=(const MicroBenchmark &) = delete;
+
+    /*
+      Record what append adds to the empty command_list between the
+      timestamps, execute it on command_queue and return the device time of
+      the commands. command_list is closed on return. Throw BaseException on
+      failure.
+    */
+    MicroBenchmarkResult run(ze_command_queue_handle_t command_queue, ze_command_list_handle_t command_list,
+                             const std::function<void(ze_command_list_handle_t)> &append);
+
+    // the nanoseconds of a tick of the timer of ze_device and the mask of its valid bits
+    static void getDeviceTimer(ze_device_handle_t ze_device, double &ns_per_tick, uint64_t &timestamp_mask);
+
+   private:
+    ze_context_handle_t context;
+
+    uint32_t warmup_iterations;
+
+    uint32_t iterations;
+
+    double ns_per_tick = 1;
+
+    uint64_t timestamp_mask = UINT64_MAX;
+
+    // the begin and end timestamps in host memory
+    uint64_t *timestamps = nullptr;
+};
+
+} // end namespace xpum
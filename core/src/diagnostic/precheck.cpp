@@ -6,19 +6,27 @@
 
 #include "precheck.h"
 #include "infrastructure/xpum_config.h"
+#include "infrastructure/thread_factory.h"
 #include "level_zero/ze_api.h"
 #include <string>
 #include <regex>
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <mutex>
 #include <unistd.h>
 #include <fcntl.h>
 #include <dirent.h>
 #include <dlfcn.h>
+#include <poll.h>
 #include <unistd.h>
 #include <sys/wait.h>
 #include "helper.h"
+#include "kernel_log_scanner.h"
 #include "device/gpu/gpu_device_stub.h"
 
 namespace xpum {
@@ -35,6 +43,22 @@ namespace xpum {
 
     std::vector<xpum_precheck_component_info_t> PrecheckManager::component_gpus;
 
+    // guards the component info, it is updated by precheck and the watching thread
+    static std::mutex precheck_mutex;
+
+    static std::thread watcher_thread;
+
+    static std::atomic<bool> watcher_stopping(false);
+
+    // the component info is the current result of a full precheck
+    static bool watched_result_valid = false;
+
+    static std::mutex listener_mutex;
+
+    static std::map<int, PrecheckErrorListener_t> error_listeners;
+
+    static int next_listener_id = 0;
+
 
     /**
      * some helper functions for precheck
@@ -213,123 +237,186 @@ namespace xpum {
         }
     }
 
-    static void scanErrorLogLinesByFile(std::string print_log_cmd, std::unordered_map<std::string, std::vector<ErrorPattern>>& key_to_error_patterns) {
-        // detect current boot line
-        std::string currentBootLine;
-        std::string detect_cmd = print_log_cmd + " | grep -i \"Command line: \" | grep -i boot | tail -n 1";
-        FILE* f = popen(detect_cmd.c_str(), "r");
-        if (f == nullptr) {
-            XPUM_LOG_ERROR("Failed to detect current boot line with command: {}", detect_cmd);
-            return;
-        } 
-        char c_line[1024];
-        while (fgets(c_line, 1024, f) != NULL) {
-            size_t len = strnlen(c_line, 1024);
-            if (len > 0 && c_line[len-1] == '\n') {
-                c_line[--len] = '\0';
-            }
-            currentBootLine = std::string(c_line);
-        }
-        pclose(f);
-
-        bool findCurrentBootLine = false;
-        // Filter related logs
-        print_log_cmd += " | grep -i \"mei\\|boot\\|i915\\|drm\\|mce\\|mca\\|caterr\"";
-        f = popen(print_log_cmd.c_str(), "r");
-        if (f == nullptr) {
-            XPUM_LOG_ERROR("Failed to check log with command: {}", print_log_cmd);
-            return;
-        }
-        std::smatch match;
-        while (fgets(c_line, 1024, f) != NULL) {
-            size_t len = strnlen(c_line, 1024);
-            if (len > 0 && c_line[len-1] == '\n') {
-                c_line[--len] = '\0';
-            }
-            std::string line(c_line);
-            // if currentBootLine is empty, scan all content in the log file.
-            if (!currentBootLine.empty()) {
-                if (findCurrentBootLine == false && line == currentBootLine) {
-                    findCurrentBootLine = true;
-                    XPUM_LOG_DEBUG("precheck find current kernel boot log: {}", line);
-                }
+    struct CompiledErrorPattern {
+        ErrorPattern error_pattern;
+        std::regex re;
+    };
 
-                if (!findCurrentBootLine) {
-                    continue;
+    /*
+      Finds the error patterns a kernel log line matches, the patterns are
+      compiled once and one pass over a line finds the targeted words and
+      the related words the lines are filtered by.
+    */
+    class ErrorLogMatcher {
+       public:
+        explicit ErrorLogMatcher(const std::vector<ErrorPattern>& error_patterns)
+            : word_to_error_patterns(targeted_words.size()), matcher(keywords()) {
+            for (size_t i = 0; i < targeted_words.size(); i++) {
+                filter_id += targeted_words[i] + ";";
+                for (auto& ep : error_patterns) {
+                    if (findCaseInsensitive(ep.pattern, targeted_words[i], 0) != std::string::npos) {
+                        word_to_error_patterns[i].push_back({ep, std::regex(ep.pattern, std::regex_constants::icase)});
+                    }
                 }
             }
-            XPUM_LOG_DEBUG("precheck scans log line: {}", line);
-            std::string target_found;
-            for (auto tw : targeted_words)
-                if (findCaseInsensitive(line, tw, 0) != std::string::npos) {
-                    target_found = tw;
-                    break;
+            for (auto& ep : error_patterns) {
+                filter_id += ep.pattern + ";" + ep.filter + ";";
+            }
+            auto words = keywords();
+            for (size_t i = 0; i < words.size(); i++) {
+                if (i < targeted_words.size()) {
+                    targeted_mask |= 1ULL << i;
                 }
-            if (target_found.empty())
-                continue;
-            for (auto error_pattern : key_to_error_patterns[target_found]) {
-                std::regex re(error_pattern.pattern, std::regex_constants::icase);
-                if(std::regex_search(line, match, re)) {
-                    if (error_pattern.filter.size() > 0 && line.find(error_pattern.filter) != std::string::npos)
+                if (std::find(std::begin(RELATED_WORDS), std::end(RELATED_WORDS), words[i]) != std::end(RELATED_WORDS)) {
+                    related_mask |= 1ULL << i;
+                }
+            }
+        }
+
+        // the patterns line matches, of the first targeted word it contains
+        std::vector<const ErrorPattern*> match(const std::string& line) const {
+            std::vector<const ErrorPattern*> matched;
+            uint64_t found = matcher.match(line);
+            if ((found & related_mask) == 0 || (found & targeted_mask) == 0) {
+                return matched;
+            }
+            size_t word = 0;
+            while ((found & (1ULL << word)) == 0) {
+                word++;
+            }
+            std::smatch match;
+            for (auto& cp : word_to_error_patterns[word]) {
+                if (std::regex_search(line, match, cp.re)) {
+                    if (cp.error_pattern.filter.size() > 0 && line.find(cp.error_pattern.filter) != std::string::npos)
                         continue;
-                    updateErrorLogLine(line, error_pattern);
+                    matched.push_back(&cp.error_pattern);
                 }
             }
+            return matched;
         }
-        pclose(f);
-    }
 
-    static void scanErrorLogLines(xpum_precheck_log_source logSource, std::vector<ErrorPattern> error_patterns, std::string since_time) {
-        std::unordered_map<std::string, std::vector<ErrorPattern>> key_to_error_patterns;
-        for (auto& key : targeted_words) {
-            std::vector<ErrorPattern> patterns;
-            for (auto& ep : error_patterns) {
-                if (findCaseInsensitive(ep.pattern, key, 0) != std::string::npos) {
-                    patterns.push_back(ep);
+        // identifies the patterns for the saved scan state
+        std::string filter_id;
+
+       private:
+        // the lines without any of them are not checked, as the log was grep'ed before
+        static constexpr const char* RELATED_WORDS[] = {"mei", "boot", "i915", "drm", "mce", "mca", "caterr"};
+
+        static std::vector<std::string> keywords() {
+            std::vector<std::string> words = targeted_words;
+            for (auto word : RELATED_WORDS) {
+                if (std::find(words.begin(), words.end(), word) == words.end()) {
+                    words.push_back(word);
                 }
             }
-            key_to_error_patterns[key] = patterns;
+            return words;
         }
 
-        std::string print_log_cmd;
+        std::vector<std::vector<CompiledErrorPattern>> word_to_error_patterns;
+        KeywordMatcher matcher;
+        uint64_t targeted_mask = 0;
+        uint64_t related_mask = 0;
+    };
+
+    constexpr const char* ErrorLogMatcher::RELATED_WORDS[];
+
+    // the lines of the log matching the error patterns, the component info is not touched
+    static std::vector<std::string> scanErrorLogLines(xpum_precheck_log_source logSource, const ErrorLogMatcher& matcher, std::string since_time) {
+        KernelLogScanner::Source source = KernelLogScanner::SOURCE_JOURNAL;
         if (logSource == XPUM_PRECHECK_LOG_SOURCE_DMESG) {
-            print_log_cmd = "dmesg --time-format iso";
-        } else if (logSource == XPUM_PRECHECK_LOG_SOURCE_JOURNALCTL) {
-            print_log_cmd = "journalctl -q -b 0 --dmesg -o short-iso";
-            if (!since_time.empty())
-                print_log_cmd += " --since \"" + since_time + "\"";
+            source = KernelLogScanner::SOURCE_KMSG;
         } else if (logSource == XPUM_PRECHECK_LOG_SOURCE_FILE) {
-            print_log_cmd = "cat " + PrecheckManager::KERNEL_MESSAGES_FILE;
+            source = KernelLogScanner::SOURCE_FILE;
+        }
+        KernelLogScanner scanner(source, PrecheckManager::KERNEL_MESSAGES_FILE, since_time, matcher.filter_id);
+        return scanner.scan([&matcher](const std::string& line) { return !matcher.match(line).empty(); });
+    }
+
+    static void updateErrorLogLines(const std::vector<std::string>& lines, const ErrorLogMatcher& matcher) {
+        for (auto& line : lines) {
+            XPUM_LOG_DEBUG("precheck scans log line: {}", line);
+            for (auto p_error_pattern : matcher.match(line)) {
+                updateErrorLogLine(line, *p_error_pattern);
+            }
+        }
+    }
+
+    /*
+      An error found by a check. The checks run in parallel and only return
+      what they find, it is applied to the component info in the order of the
+      checks afterwards, so the first error of a component is the one kept.
+    */
+    struct PrecheckFinding {
+        // empty for the driver
+        std::string bdf;
+        std::string error_detail;
+        int error_id;
+    };
+
+    typedef std::vector<PrecheckFinding> PrecheckFindings;
+
+    static void updateFindings(const PrecheckFindings& findings) {
+        for (auto& finding : findings) {
+            if (finding.bdf.empty()) {
+                updateErrorComponentInfo(PrecheckManager::component_driver, XPUM_PRECHECK_COMPONENT_STATUS_FAIL, finding.error_detail, finding.error_id);
+            } else {
+                updateErrorComponentInfoList(finding.bdf, -1, XPUM_PRECHECK_COMPONENT_STATUS_FAIL, finding.error_detail, finding.error_id);
+            }
+        }
+    }
+
+    static std::string readBootId() {
+        std::string boot_id;
+        std::ifstream file("/proc/sys/kernel/random/boot_id");
+        std::getline(file, boot_id);
+        return boot_id;
+    }
+
+    /*
+      xpu-smi inits level zero in a child to avoid crashing if the GPU driver
+      crashes. The child is forked before the other checks start their
+      threads and runs while they do. Return -1 if no child is forked.
+    */
+    static pid_t startZeInitChild() {
+        if (Configuration::XPUM_MODE.empty())
+            Configuration::init();
+        if (Configuration::XPUM_MODE != "xpu-smi")
+            return -1;
+        pid_t pid = fork();
+        if (pid == 0) {
+            putenv(const_cast<char*>("ZES_ENABLE_SYSMAN=1"));
+            putenv(const_cast<char*>("ZET_ENABLE_METRICS=1"));
+            int init_status = zeInit(0);
+            if (init_status == 0 || init_status == 1)
+                exit(init_status);
+            else if (init_status == 0x78000001)
+                exit(2);
+            else if (init_status == 0x70020000)
+                exit(3);
+            else
+                exit(255);
+        }
+        return pid;
+    }
+
+    static bool isI915Loaded() {
+        std::ifstream modules("/proc/modules");
+        std::string line;
+        while (std::getline(modules, line)) {
+            if (line.compare(0, 5, "i915 ") == 0) {
+                return true;
+            }
         }
-        XPUM_LOG_INFO("precheck log command: {}", print_log_cmd);
-        scanErrorLogLinesByFile(print_log_cmd, key_to_error_patterns);
+        return false;
     }
 
-    static void doPreCheckDriver() {
+    static PrecheckFindings doPreCheckDriver(pid_t ze_init_pid) {
         // GPU level-zero driver
         std::string level0_driver_error_info;
         bool dependency_issue = false;
-        if (Configuration::XPUM_MODE.empty())
-            Configuration::init();
-        // avoid xpu-smi crash if gpu driver crash
         if (Configuration::XPUM_MODE == "xpu-smi") {
-            pid_t pid = fork();
-            if (pid == 0) {
-                putenv(const_cast<char*>("ZES_ENABLE_SYSMAN=1"));
-                putenv(const_cast<char*>("ZET_ENABLE_METRICS=1"));
-                int init_status = zeInit(0);
-                if (init_status == 0 || init_status == 1)
-                    exit(init_status);
-                else if (init_status == 0x78000001)
-                    exit(2);
-                else if (init_status == 0x70020000)
-                    exit(3);
-                else
-                    exit(255);
-            }
             int status;
-            waitpid(pid, &status, 0);
-            if (WIFEXITED(status)) {
+            if (ze_init_pid > 0 && waitpid(ze_init_pid, &status, 0) == ze_init_pid && WIFEXITED(status)) {
                 int exit_code = WEXITSTATUS(status);
                 if (exit_code != 0) {
                     std::unordered_map<int, int> exit_code_map = {{2, 0x78000001}, {3, 0x70020000}};
@@ -357,146 +444,173 @@ namespace xpum {
             }
         }
         // GPU i915 driver
-        bool is_i915_loaded = false;
-        FILE* f = popen("cat /proc/modules | grep \"^i915 \" 2>/dev/null", "r");
-        char c_line[1024];
-        while (fgets(c_line, 1024, f) != NULL) {
-            std::string line(c_line);
-            if (line.find("i915") != std::string::npos) {
-                is_i915_loaded = true;
-            }
-        }
-        pclose(f);
-
-        if (!is_i915_loaded) {
-            updateErrorComponentInfo(PrecheckManager::component_driver, XPUM_PRECHECK_COMPONENT_STATUS_FAIL, "Failed to find i915 in /proc/modules.", XPUM_I915_NOT_LOADED);
+        PrecheckFindings findings;
+        if (!isI915Loaded()) {
+            findings.push_back({"", "Failed to find i915 in /proc/modules.", XPUM_I915_NOT_LOADED});
         } else if (!level0_driver_error_info.empty()) {
-            updateErrorComponentInfo(PrecheckManager::component_driver, XPUM_PRECHECK_COMPONENT_STATUS_FAIL, level0_driver_error_info, dependency_issue? XPUM_LEVEL_ZERO_METRICS_INIT_ERROR : XPUM_LEVEL_ZERO_INIT_ERROR);
+            findings.push_back({"", level0_driver_error_info, dependency_issue? XPUM_LEVEL_ZERO_METRICS_INIT_ERROR : XPUM_LEVEL_ZERO_INIT_ERROR});
         }
+        return findings;
     }
 
-    static void doPreCheckGuCHuCWedgedPCIe(std::vector<std::string> gpu_ids, std::vector<std::string> gpu_bdfs, bool is_atsm_platform) {
-        // GPU GuC HuC i915 wedged
+    struct FirmwareStatus {
+        std::string boot_id;
+        std::string gpu_id;
+        PrecheckFindings findings;
+    };
+
+    // the GuC and HuC status of the GPUs by the bdf, kept once the firmware is loaded
+    static std::mutex firmware_mutex;
+
+    static std::map<std::string, FirmwareStatus> firmware_status;
+
+    /*
+      The firmware is loaded when the driver binds the GPU, its status is
+      then kept until the boot id or the DRM card of the GPU changes, that
+      is until a reboot or the driver is loaded again. A firmware still
+      loading or failed is read again every time.
+    */
+    static PrecheckFindings doPreCheckGuCHuC(const std::string& gpu_id, const std::string& bdf, bool is_atsm_platform, const std::string& boot_id) {
+        {
+            std::lock_guard<std::mutex> lock(firmware_mutex);
+            auto it = firmware_status.find(bdf);
+            if (it != firmware_status.end() && !boot_id.empty() && it->second.boot_id == boot_id && it->second.gpu_id == gpu_id) {
+                return it->second.findings;
+            }
+        }
+        PrecheckFindings findings;
         char path[PATH_MAX];
-        int gpu_id_index = 0;
-        for (auto gpu_id : gpu_ids) {
-            std::string line;
-            snprintf(path, PATH_MAX, "/sys/kernel/debug/dri/%s/gt0/uc/guc_info", gpu_id.c_str());
-            bool is_guc_running = false;
-            bool is_guc_missing = false;
-            std::ifstream guc_info_file(path);
-            if (guc_info_file.good()) {
-                std::string error_details; // Example: GuC firmware: i915/dg2_guc_70.6.5.bin. status: MISSING. version: wanted 70.6.0, found 0.0.0.
-                while(std::getline(guc_info_file, line)) {
+        std::string line;
+        snprintf(path, PATH_MAX, "/sys/kernel/debug/dri/%s/gt0/uc/guc_info", gpu_id.c_str());
+        bool is_guc_running = false;
+        bool is_guc_missing = false;
+        std::ifstream guc_info_file(path);
+        if (guc_info_file.good()) {
+            std::string error_details; // Example: GuC firmware: i915/dg2_guc_70.6.5.bin. status: MISSING. version: wanted 70.6.0, found 0.0.0.
+            while(std::getline(guc_info_file, line)) {
+                if (line.empty())
+                    continue;
+                if (line.find("GuC firmware") != std::string::npos || line.find("status: ") != std::string::npos || line.find("version: ") != std::string::npos) {
+                    line.erase(0, line.find_first_not_of(" \n\r\t"));
+                    line.erase(line.find_last_not_of(" \n\r\t") + 1);
+                    if (!error_details.empty())
+                        error_details += " ";
+                    error_details += line + ".";
+                }
+                if (line.find("status: ") != std::string::npos) {
+                    if (line.find("RUNNING") != std::string::npos) {
+                        is_guc_running = true;
+                        break;
+                    }
+                    if (line.find("MISSING") != std::string::npos)
+                        is_guc_missing = true;
+                }
+            }
+            if (!is_guc_running) {
+                findings.push_back({bdf, error_details, is_guc_missing ?  XPUM_GUC_INITIALIZATION_FAILED : XPUM_GUC_NOT_RUNNING});
+            }
+        }
+        guc_info_file.close();
+        bool is_huc_loaded = true;
+        if (is_atsm_platform) {
+            snprintf(path, PATH_MAX, "/sys/kernel/debug/dri/%s/gt0/uc/huc_info", gpu_id.c_str());
+            bool is_huc_running = false;
+            bool is_huc_disabled = false;
+            std::ifstream huc_info_file(path);
+            if (huc_info_file.good()) {
+                std::string error_details; // Example: HuC firmware: i915/dg2_huc_7.10.3_gsc.bin. status: ERROR. version: wanted 7.10.0, found 0.0.0. HuC status: 0x00164000.
+                while(std::getline(huc_info_file, line)) {
                     if (line.empty())
                         continue;
-                    if (line.find("GuC firmware") != std::string::npos || line.find("status: ") != std::string::npos || line.find("version: ") != std::string::npos) {
+                    if (line.find("HuC firmware") != std::string::npos || line.find("status: ") != std::string::npos || line.find("version: ") != std::string::npos) {
                         line.erase(0, line.find_first_not_of(" \n\r\t"));
                         line.erase(line.find_last_not_of(" \n\r\t") + 1);
                         if (!error_details.empty())
                             error_details += " ";
                         error_details += line + ".";
                     }
-                    if (line.find("status: ") != std::string::npos) {
-                        if (line.find("RUNNING") != std::string::npos) {
-                            is_guc_running = true;
-                            break;
-                        }
-                        if (line.find("MISSING") != std::string::npos)
-                            is_guc_missing = true;
-                    }
-                }
-                if (!is_guc_running) {
-                    updateErrorComponentInfoList(gpu_bdfs[gpu_id_index], -1, XPUM_PRECHECK_COMPONENT_STATUS_FAIL, error_details, is_guc_missing ?  XPUM_GUC_INITIALIZATION_FAILED : XPUM_GUC_NOT_RUNNING);
-                }
-            }
-            guc_info_file.close();
-            if (is_atsm_platform) {
-                snprintf(path, PATH_MAX, "/sys/kernel/debug/dri/%s/gt0/uc/huc_info", gpu_id.c_str());
-                bool is_huc_running = false;
-                bool is_huc_disabled = false;
-                std::ifstream huc_info_file(path);
-                if (huc_info_file.good()) {
-                    std::string error_details; // Example: HuC firmware: i915/dg2_huc_7.10.3_gsc.bin. status: ERROR. version: wanted 7.10.0, found 0.0.0. HuC status: 0x00164000.
-                    while(std::getline(huc_info_file, line)) {
-                        if (line.empty())
-                            continue;
-                        if (line.find("HuC firmware") != std::string::npos || line.find("status: ") != std::string::npos || line.find("version: ") != std::string::npos) {
-                            line.erase(0, line.find_first_not_of(" \n\r\t"));
-                            line.erase(line.find_last_not_of(" \n\r\t") + 1);
-                            if (!error_details.empty())
-                                error_details += " ";
-                            error_details += line + ".";
-                        }
-                        if (line.find("HuC disabled") != std::string::npos) {
-                            error_details = "HuC is disabled.";
-                            is_huc_disabled = true;
-                            break;
-                        }
-                        if (line.find("status: ") != std::string::npos && line.find("RUNNING") != std::string::npos) {
-                            is_huc_running = true;
-                            break;
-                        }
-                    }
-                    if (!is_huc_running) {
-                        if (is_huc_disabled)
-                            updateErrorComponentInfoList(gpu_bdfs[gpu_id_index], -1, XPUM_PRECHECK_COMPONENT_STATUS_FAIL, error_details, XPUM_HUC_DISABLED);
-                        else
-                            updateErrorComponentInfoList(gpu_bdfs[gpu_id_index], -1, XPUM_PRECHECK_COMPONENT_STATUS_FAIL, error_details, XPUM_HUC_NOT_RUNNING);
+                    if (line.find("HuC disabled") != std::string::npos) {
+                        error_details = "HuC is disabled.";
+                        is_huc_disabled = true;
+                        break;
                     }
-                }
-                huc_info_file.close();
-            }
-
-            snprintf(path, PATH_MAX, "/sys/kernel/debug/dri/%s/i915_wedged", gpu_id.c_str());
-            bool is_i915_wedged = false;
-            std::ifstream i915_wedged_file(path);
-            if (i915_wedged_file.good()) {
-                while(std::getline(i915_wedged_file, line)) {
-                    try {
-                        if (!line.empty() && std::stoi(line) != 0) {
-                            is_i915_wedged = true;
-                            break;
-                        }
-                    } catch (...) {
-                        XPUM_LOG_ERROR("Failed to get i915 wedged status: {}", path);
+                    if (line.find("status: ") != std::string::npos && line.find("RUNNING") != std::string::npos) {
+                        is_huc_running = true;
+                        break;
                     }
                 }
-                if (is_i915_wedged) {
-                    updateErrorComponentInfoList(gpu_bdfs[gpu_id_index], -1, XPUM_PRECHECK_COMPONENT_STATUS_FAIL, "i915 wedged", XPUM_I915_ERROR);
+                if (!is_huc_running) {
+                    if (is_huc_disabled)
+                        findings.push_back({bdf, error_details, XPUM_HUC_DISABLED});
+                    else
+                        findings.push_back({bdf, error_details, XPUM_HUC_NOT_RUNNING});
                 }
             }
-            i915_wedged_file.close();
+            huc_info_file.close();
+            is_huc_loaded = is_huc_running || is_huc_disabled;
+        }
 
-            gpu_id_index += 1;
+        if (is_guc_running && is_huc_loaded && !boot_id.empty()) {
+            std::lock_guard<std::mutex> lock(firmware_mutex);
+            firmware_status[bdf] = {boot_id, gpu_id, findings};
         }
+        return findings;
+    }
 
-        // PCIe error
-        std::vector<std::string> pci_erros = {"TAbort+", "<TAbort+", "<MAbort+", ">SERR+", "<PERR+",
-                                                "CorrErr+", "NonFatalErr+", "FatalErr+"};
-        for (auto bdf : gpu_bdfs) {
-            bool is_pcie_ok = true;
-            std::string cmd = "lspci -vvvvv -s " + bdf + " 2>/dev/null";
-            FILE* f = popen(cmd.c_str(), "r");
-            char c_line[1024];
-            while (fgets(c_line, 1024, f) != NULL) {
-                std::string line(c_line);
-                if (line.find("DevSta: ") != std::string::npos || line.find("Status: ") != std::string::npos) {
-                    for (auto pci_error : pci_erros) {
-                        if (line.find(pci_error) != std::string::npos) {
-                            is_pcie_ok = false;
-                            break;
-                        }
-                    }
-                    if (!is_pcie_ok)
-                        break;
+    static bool isI915Wedged(const std::string& gpu_id) {
+        char path[PATH_MAX];
+        snprintf(path, PATH_MAX, "/sys/kernel/debug/dri/%s/i915_wedged", gpu_id.c_str());
+        std::ifstream i915_wedged_file(path);
+        std::string line;
+        while (std::getline(i915_wedged_file, line)) {
+            try {
+                if (!line.empty() && std::stoi(line) != 0) {
+                    return true;
                 }
+            } catch (...) {
+                XPUM_LOG_ERROR("Failed to get i915 wedged status: {}", path);
             }
-            pclose(f);
-            if (!is_pcie_ok) {
-                updateErrorComponentInfoList(bdf, -1, XPUM_PRECHECK_COMPONENT_STATUS_FAIL, "PCIe error", XPUM_PCIE_ERROR);
+        }
+        return false;
+    }
+
+    // the signaled and received target abort, received master abort, signaled system error and detected parity error bits
+    static const uint16_t PCI_STATUS_ERRORS = 0xF800;
+
+    // the correctable, non-fatal and fatal error detected bits
+    static const uint16_t PCIE_DEVICE_STATUS_ERRORS = 0x0007;
+
+    /*
+      Check the error bits lspci -vvv shows in the Status and DevSta lines,
+      read from the config space of the device. Only the first 64 bytes
+      are readable without root privileges, the PCIe capability is not
+      checked then.
+    */
+    static bool hasPCIeError(const std::string& bdf) {
+        std::ifstream config("/sys/bus/pci/devices/" + bdf + "/config", std::ios::binary);
+        unsigned char data[256] = {};
+        config.read(reinterpret_cast<char*>(data), sizeof(data));
+        int size = (int)config.gcount();
+        if (size < 0x40) {
+            return false;
+        }
+        auto read16 = [&data](int offset) { return (uint16_t)(data[offset] | (data[offset + 1] << 8)); };
+        uint16_t status = read16(0x06);
+        if (status & PCI_STATUS_ERRORS) {
+            return true;
+        }
+        // no capability list
+        if ((status & 0x10) == 0) {
+            return false;
+        }
+        int pos = data[0x34] & ~3;
+        for (int i = 0; i < 48 && pos >= 0x40 && pos + 0x0C <= size; i++) {
+            if (data[pos] == 0x10) {
+                return (read16(pos + 0x0A) & PCIE_DEVICE_STATUS_ERRORS) != 0;
             }
+            pos = data[pos + 1] & ~3;
         }
+        return false;
     }
 
     bool isATSMPlatform(std::string str) {
@@ -504,13 +618,59 @@ namespace xpum {
         return str.find("56c0") != std::string::npos || str.find("56c1") != std::string::npos || str.find("56c2") != std::string::npos;
     }
 
-    void checkMemoryMRCStatus(std::vector<std::string>& gpu_bdfs) {
-        for(auto gpu_bdf : gpu_bdfs) {
-            auto memoryFailedMRCInfo = GPUDeviceStub::parseMemoryFailedMRCInfo(GPUDeviceStub::getRegisterValueFromSys(gpu_bdf, 0x4F104));
-            if (memoryFailedMRCInfo.size() > 0)  {
-                updateErrorComponentInfoList(gpu_bdf, -1, XPUM_PRECHECK_COMPONENT_STATUS_FAIL, memoryFailedMRCInfo, XPUM_MEMORY_ERROR);
+    static PrecheckFindings doPreCheckGPU(std::string gpu_id, std::string bdf, bool is_atsm_platform, std::string boot_id) {
+        // GPU GuC HuC i915 wedged
+        PrecheckFindings findings = doPreCheckGuCHuC(gpu_id, bdf, is_atsm_platform, boot_id);
+        if (isI915Wedged(gpu_id)) {
+            findings.push_back({bdf, "i915 wedged", XPUM_I915_ERROR});
+        }
+        // PCIe error
+        if (hasPCIeError(bdf)) {
+            findings.push_back({bdf, "PCIe error", XPUM_PCIE_ERROR});
+        }
+        if (is_atsm_platform) {
+            auto memoryFailedMRCInfo = GPUDeviceStub::parseMemoryFailedMRCInfo(GPUDeviceStub::getRegisterValueFromSys(bdf, 0x4F104));
+            if (memoryFailedMRCInfo.size() > 0) {
+                findings.push_back({bdf, memoryFailedMRCInfo, XPUM_MEMORY_ERROR});
             }
         }
+        return findings;
+    }
+
+    /*
+      The Intel display controllers, like lspci -D -nn|grep -i Display|grep -i Intel
+      lists them, in the order of their bdf. The second of a pair is the device id.
+    */
+    static std::vector<std::pair<std::string, std::string>> listDisplayControllers() {
+        std::vector<std::pair<std::string, std::string>> controllers;
+        DIR* pdir = opendir("/sys/bus/pci/devices");
+        if (pdir == NULL) {
+            return controllers;
+        }
+        struct dirent* pdirent = NULL;
+        while ((pdirent = readdir(pdir)) != NULL) {
+            if (pdirent->d_name[0] == '.') {
+                continue;
+            }
+            std::string dir = std::string("/sys/bus/pci/devices/") + pdirent->d_name;
+            std::string pci_class, vendor, device;
+            std::ifstream class_file(dir + "/class");
+            std::getline(class_file, pci_class);
+            if (pci_class.compare(0, 6, "0x0380") != 0) {
+                continue;
+            }
+            std::ifstream vendor_file(dir + "/vendor");
+            std::getline(vendor_file, vendor);
+            if (vendor != "0x8086") {
+                continue;
+            }
+            std::ifstream device_file(dir + "/device");
+            std::getline(device_file, device);
+            controllers.push_back({pdirent->d_name, device});
+        }
+        closedir(pdir);
+        std::sort(controllers.begin(), controllers.end());
+        return controllers;
     }
 
     static void toCheck(xpum_precheck_log_source logSource, bool onlyGPU, std::string sinceTime, bool getComponentCount = false) {
@@ -532,14 +692,10 @@ namespace xpum {
         bool is_atsm_platform = true;
         std::vector<std::string> gpu_ids;
         std::vector<std::string> gpu_bdfs;
-        std::string cmd = "lspci -D -nn|grep -i Display|grep -i Intel"; // -nn Show both textual and numeric ID's (names & numbers)
-        FILE* f = popen(cmd.c_str(), "r");
-        char c_line[1024];
         int gpu_id = 0;
-        while (fgets(c_line, 1024, f) != NULL) {
-            std::string line(c_line);
-            is_atsm_platform = isATSMPlatform(line);
-            std::string bdf = line.substr(0, 12);
+        for (auto& controller : listDisplayControllers()) {
+            is_atsm_platform = isATSMPlatform(controller.second);
+            std::string bdf = controller.first;
             if (GPUDeviceStub::isPhysicalFunctionDevice(bdf)) {
                 gpu_ids.push_back(std::to_string(gpu_id));
                 gpu_bdfs.push_back(bdf);
@@ -554,7 +710,6 @@ namespace xpum {
                 gpu_id++;
             }
         }
-        pclose(f);
 
         if (gpu_bdfs.empty()) {
             pdir = opendir("/sys/class/drm");
@@ -669,18 +824,24 @@ namespace xpum {
             return;
         }
         
-        doPreCheckDriver();
-
-        doPreCheckGuCHuCWedgedPCIe(gpu_ids, gpu_bdfs, is_atsm_platform);
-
-        if (is_atsm_platform) {
-            checkMemoryMRCStatus(gpu_bdfs); 
+        // the checks of the driver, of each GPU and of the log run in parallel
+        pid_t ze_init_pid = startZeInitChild();
+        std::string boot_id = readBootId();
+        ErrorLogMatcher matcher(error_patterns);
+        auto log_lines = std::async(std::launch::async, scanErrorLogLines, logSource, std::cref(matcher), sinceTime);
+        std::vector<std::future<PrecheckFindings>> gpu_findings;
+        for (size_t i = 0; i < gpu_ids.size(); i++) {
+            gpu_findings.push_back(std::async(std::launch::async, doPreCheckGPU, gpu_ids[i], gpu_bdfs[i], is_atsm_platform, boot_id));
         }
 
-        scanErrorLogLines(logSource, error_patterns, sinceTime);
+        updateFindings(doPreCheckDriver(ze_init_pid));
+        for (auto& findings : gpu_findings) {
+            updateFindings(findings.get());
+        }
+        updateErrorLogLines(log_lines.get(), matcher);
     }
 
-    xpum_result_t PrecheckManager::precheck(xpum_precheck_component_info_t resultList[], int *count, xpum_precheck_options options) {
+    static xpum_precheck_log_source getLogSource() {
         xpum_precheck_log_source logSource = XPUM_PRECHECK_LOG_SOURCE_JOURNALCTL;
         readConfigFile(XPUM_GLOBAL_CONFIG_FILE);
         XPUM_LOG_INFO("log source: {}, log file: {}", PrecheckManager::KERNEL_MESSAGES_SOURCE, PrecheckManager::KERNEL_MESSAGES_FILE);
@@ -692,6 +853,180 @@ namespace xpum {
         } else if (PrecheckManager::KERNEL_MESSAGES_SOURCE == "dmesg")
             logSource = XPUM_PRECHECK_LOG_SOURCE_DMESG;
         XPUM_LOG_INFO("final log source: {}", logSourceToString(logSource));
+        return logSource;
+    }
+
+    static std::vector<xpum_precheck_component_info_t> snapshotComponents() {
+        std::vector<xpum_precheck_component_info_t> components;
+        components.push_back(PrecheckManager::component_driver);
+        components.insert(components.end(), PrecheckManager::component_cpus.begin(), PrecheckManager::component_cpus.end());
+        components.insert(components.end(), PrecheckManager::component_gpus.begin(), PrecheckManager::component_gpus.end());
+        return components;
+    }
+
+    static bool isSameComponent(const xpum_precheck_component_info_t& a, const xpum_precheck_component_info_t& b) {
+        if (a.componentType != b.componentType) {
+            return false;
+        }
+        if (a.componentType == XPUM_PRECHECK_COMPONENT_TYPE_GPU) {
+            return strncmp(a.bdf, b.bdf, sizeof(a.bdf)) == 0;
+        }
+        if (a.componentType == XPUM_PRECHECK_COMPONENT_TYPE_CPU) {
+            return a.cpuId == b.cpuId;
+        }
+        return true;
+    }
+
+    // tell the listeners about the components failed in after but not in before
+    static void notifyNewErrors(const std::vector<xpum_precheck_component_info_t>& before, const std::vector<xpum_precheck_component_info_t>& after) {
+        std::vector<xpum_precheck_component_info_t> failed;
+        for (auto& component : after) {
+            if (component.status != XPUM_PRECHECK_COMPONENT_STATUS_FAIL) {
+                continue;
+            }
+            auto it = std::find_if(before.begin(), before.end(), [&component](const xpum_precheck_component_info_t& c) {
+                return isSameComponent(c, component);
+            });
+            if (it == before.end() || it->status != XPUM_PRECHECK_COMPONENT_STATUS_FAIL) {
+                XPUM_LOG_INFO("precheck finds new error: {}", component.errorDetail);
+                failed.push_back(component);
+            }
+        }
+        if (failed.empty()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(listener_mutex);
+        for (auto& component : failed) {
+            for (auto& listener : error_listeners) {
+                listener.second(component);
+            }
+        }
+    }
+
+    static void watchKernelLog() {
+        XPUM_LOG_INFO("precheck watcher is started");
+        ErrorLogMatcher matcher(error_patterns);
+        // the messages from now on are read here, the earlier ones by the first full check
+        int fd = open("/dev/kmsg", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd >= 0) {
+            lseek(fd, 0, SEEK_END);
+        } else {
+            XPUM_LOG_WARN("Failed to open /dev/kmsg, precheck only refreshes its result periodically: {}", strerror(errno));
+        }
+        int64_t boot_time = KernelLogScanner::bootTime();
+        bool first_check = true;
+        // false while the log source is a file, then the result is not kept
+        bool followed = true;
+        auto last_refresh = std::chrono::steady_clock::now();
+        char record[8192];
+        while (!watcher_stopping) {
+            bool valid;
+            {
+                std::lock_guard<std::mutex> lock(precheck_mutex);
+                valid = watched_result_valid;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if ((!valid && followed) || first_check || now - last_refresh >= std::chrono::milliseconds(Configuration::PRECHECK_WATCH_REFRESH_INTERVAL)) {
+                xpum_precheck_log_source logSource = getLogSource();
+                followed = logSource != XPUM_PRECHECK_LOG_SOURCE_FILE;
+                std::vector<xpum_precheck_component_info_t> before, after;
+                {
+                    std::lock_guard<std::mutex> lock(precheck_mutex);
+                    before = snapshotComponents();
+                    // a log file is not followed, so precheck reads it every time
+                    if (followed) {
+                        toCheck(logSource, false, "");
+                        watched_result_valid = true;
+                    }
+                    after = snapshotComponents();
+                }
+                last_refresh = now;
+                if (!first_check) {
+                    notifyNewErrors(before, after);
+                }
+                first_check = false;
+            }
+
+            if (fd < 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+                continue;
+            }
+            struct pollfd pfd = {fd, POLLIN, 0};
+            if (poll(&pfd, 1, 1000) <= 0) {
+                continue;
+            }
+            while (!watcher_stopping) {
+                ssize_t len = read(fd, record, sizeof(record) - 1);
+                if (len < 0) {
+                    // EPIPE: records were overwritten before they were read, go on with the next one
+                    if (errno == EPIPE || errno == EINTR) {
+                        continue;
+                    }
+                    break;
+                }
+                record[len] = '\0';
+                uint64_t seq;
+                std::string line;
+                if (!KernelLogScanner::parseKmsgRecord(record, boot_time, seq, line)) {
+                    continue;
+                }
+                auto matched = matcher.match(line);
+                if (matched.empty()) {
+                    continue;
+                }
+                XPUM_LOG_DEBUG("precheck watcher gets log line: {}", line);
+                std::vector<xpum_precheck_component_info_t> before, after;
+                {
+                    std::lock_guard<std::mutex> lock(precheck_mutex);
+                    if (!watched_result_valid) {
+                        break;
+                    }
+                    before = snapshotComponents();
+                    for (auto p_error_pattern : matched) {
+                        updateErrorLogLine(line, *p_error_pattern);
+                    }
+                    after = snapshotComponents();
+                }
+                notifyNewErrors(before, after);
+            }
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        XPUM_LOG_INFO("precheck watcher is stopped");
+    }
+
+    void PrecheckManager::startWatching() {
+        if (watcher_thread.joinable()) {
+            return;
+        }
+        watcher_stopping = false;
+        watcher_thread = ThreadFactory::create("xpum-precheck", watchKernelLog);
+    }
+
+    void PrecheckManager::stopWatching() {
+        watcher_stopping = true;
+        if (watcher_thread.joinable()) {
+            watcher_thread.join();
+        }
+        std::lock_guard<std::mutex> lock(precheck_mutex);
+        watched_result_valid = false;
+    }
+
+    int PrecheckManager::addErrorListener(PrecheckErrorListener_t listener) {
+        std::lock_guard<std::mutex> lock(listener_mutex);
+        int id = next_listener_id++;
+        error_listeners[id] = listener;
+        return id;
+    }
+
+    void PrecheckManager::removeErrorListener(int id) {
+        std::lock_guard<std::mutex> lock(listener_mutex);
+        error_listeners.erase(id);
+    }
+
+    xpum_result_t PrecheckManager::precheck(xpum_precheck_component_info_t resultList[], int *count, xpum_precheck_options options) {
+        xpum_precheck_log_source logSource = getLogSource();
         bool onlyGPU = options.onlyGPU;
         const char* sinceTime = options.sinceTime;
         if (logSource == XPUM_PRECHECK_LOG_SOURCE_JOURNALCTL && sinceTime != nullptr) {
@@ -704,18 +1039,27 @@ namespace xpum {
             }
         }
 
+        std::string sinceTimeStr;
+        if (sinceTime != nullptr)
+            sinceTimeStr = std::string(sinceTime);
+        std::lock_guard<std::mutex> lock(precheck_mutex);
+        // the watching thread keeps the result of a precheck without since time
+        bool use_watched = watched_result_valid && sinceTimeStr.empty() && logSource != XPUM_PRECHECK_LOG_SOURCE_FILE;
+        if (!use_watched) {
+            watched_result_valid = false;
+        }
+
         if (resultList == nullptr) {
-            toCheck(logSource, false, "", true);
+            if (!use_watched)
+                toCheck(logSource, false, "", true);
             int val = PrecheckManager::component_gpus.size() + 1;
             if (!onlyGPU)
                 val += PrecheckManager::component_cpus.size();
             *count = val;
             return XPUM_OK;
         }
-        std::string sinceTimeStr;
-        if (sinceTime != nullptr)
-            std::string sinceTimeStr = std::string(sinceTime);
-        toCheck(logSource, onlyGPU, sinceTimeStr);
+        if (!use_watched)
+            toCheck(logSource, onlyGPU, sinceTimeStr);
         int val = PrecheckManager::component_gpus.size() + 1;
         if (!onlyGPU)
             val += PrecheckManager::component_cpus.size();
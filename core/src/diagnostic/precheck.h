@@ -7,6 +7,7 @@
 
 #include "../include/xpum_structs.h"
 #include "infrastructure/configuration.h"
+#include <functional>
 #include <thread>
 #include <vector>
 
@@ -71,10 +72,27 @@ const std::vector<ErrorPattern> error_patterns = {
 // The order of the vector impacts how error patterns are matched. It starts from special patterns to general patterns.
 const std::vector<std::string> targeted_words = {"hang", "guc", "iommu", "lmem", "forcewake", "mei", "i915", "drm",  "mce", "mca", "caterr"};
 
+// called with a component that has failed since the last check
+typedef std::function<void(const xpum_precheck_component_info_t&)> PrecheckErrorListener_t;
+
 class PrecheckManager {
    public:
     static xpum_result_t precheck(xpum_precheck_component_info_t resultList[], int *count, xpum_precheck_options options);
 
+    /*
+      Keep the precheck result current in a thread, it follows the kernel log and
+      runs the other checks every Configuration::PRECHECK_WATCH_REFRESH_INTERVAL.
+      A precheck without since time then returns the kept result.
+    */
+    static void startWatching();
+
+    static void stopWatching();
+
+    // return the id to remove listener, it is called in the watching thread
+    static int addErrorListener(PrecheckErrorListener_t listener);
+
+    static void removeErrorListener(int id);
+
     static xpum_result_t getPrecheckErrorList(xpum_precheck_error_t resultList[], int *count);
 
     static int cpu_temperature_threshold;
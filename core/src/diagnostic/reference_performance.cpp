@@ -0,0 +1,122 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file reference_performance.cpp
+ */
+
+#include "reference_performance.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+
+#include "helper.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+// the 5th percentile of the standard normal distribution is this many standard deviations below the median
+static const double P5_Z_SCORE = 1.6448536;
+
+static const double DEFAULT_REGRESSION_PERCENTILE = 1;
+
+std::mutex ReferencePerformance::mutex;
+
+int ReferencePerformance::version = 0;
+
+double ReferencePerformance::regression_percentile = DEFAULT_REGRESSION_PERCENTILE;
+
+std::map<std::pair<std::string, std::string>, std::map<std::string, ReferenceDistribution>> ReferencePerformance::entries;
+
+void ReferencePerformance::load() {
+    std::string file_name = getConfigFilePath(DIAG_REFERENCE_PERFORMANCE_CONFIG_FILE);
+    std::unique_lock<std::mutex> lock(mutex);
+    entries.clear();
+    version = 0;
+    regression_percentile = DEFAULT_REGRESSION_PERCENTILE;
+    std::ifstream conf_file(file_name);
+    if (!conf_file.is_open()) {
+        XPUM_LOG_DEBUG("no reference performance for diagnostics in {}", file_name);
+        return;
+    }
+    std::string line;
+    std::pair<std::string, std::string> current_entry;
+    while (getline(conf_file, line)) {
+        // the names in diagnostics.conf have no spaces either
+        line.erase(std::remove_if(line.begin(), line.end(), isspace), line.end());
+        if (line.empty() || line[0] == '#')
+            continue;
+        auto delimiter_pos = line.find("=");
+        if (delimiter_pos == std::string::npos)
+            continue;
+        auto name = line.substr(0, delimiter_pos);
+        auto value = line.substr(delimiter_pos + 1);
+        if (value.find("#") != std::string::npos)
+            value = value.substr(0, value.find("#"));
+        try {
+            if (name == "VERSION") {
+                version = std::stoi(value);
+            } else if (name == "REGRESSION_PERCENTILE") {
+                double val = std::stod(value);
+                if (val > 0 && val < 50)
+                    regression_percentile = val;
+            } else if (name == "NAME") {
+                current_entry = std::make_pair(value, std::string());
+            } else if (name == "FIRMWARE") {
+                current_entry.second = value;
+            } else if (!current_entry.first.empty()) {
+                // "median,p5"
+                auto comma = value.find(",");
+                if (comma == std::string::npos)
+                    continue;
+                ReferenceDistribution distribution;
+                distribution.median = std::stod(value.substr(0, comma));
+                distribution.p5 = std::stod(value.substr(comma + 1));
+                if (distribution.median > 0 && distribution.p5 > 0 && distribution.p5 < distribution.median)
+                    entries[current_entry][name] = distribution;
+                else
+                    XPUM_LOG_WARN("invalid reference performance {} of {}", name, current_entry.first);
+            }
+        } catch (...) {
+            XPUM_LOG_WARN("invalid line in {}: {}", file_name, line);
+        }
+    }
+    XPUM_LOG_DEBUG("read reference performance version {} for {} devices from {}", version, entries.size(), file_name);
+}
+
+bool ReferencePerformance::find(const std::string& device_name, const std::string& firmware, const std::string& name,
+                                ReferenceDistribution& distribution) {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::string firmware_key(firmware);
+    firmware_key.erase(std::remove_if(firmware_key.begin(), firmware_key.end(), isspace), firmware_key.end());
+    // the entry of the firmware version first, then the entry of all versions
+    auto entry = entries.find(std::make_pair(device_name, firmware_key));
+    if (entry == entries.end() || entry->second.find(name) == entry->second.end())
+        entry = entries.find(std::make_pair(device_name, std::string()));
+    if (entry == entries.end())
+        return false;
+    auto item = entry->second.find(name);
+    if (item == entry->second.end())
+        return false;
+    distribution = item->second;
+    return true;
+}
+
+double ReferencePerformance::percentileRank(const ReferenceDistribution& distribution, double value) {
+    double sigma = (distribution.median - distribution.p5) / P5_Z_SCORE;
+    double z = (value - distribution.median) / sigma;
+    return 50 * std::erfc(-z / std::sqrt(2.0));
+}
+
+double ReferencePerformance::getRegressionPercentile() {
+    std::unique_lock<std::mutex> lock(mutex);
+    return regression_percentile;
+}
+
+int ReferencePerformance::getVersion() {
+    std::unique_lock<std::mutex> lock(mutex);
+    return version;
+}
+
+} // end namespace xpum
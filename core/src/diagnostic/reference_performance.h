@@ -0,0 +1,65 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file reference_performance.h
+ */
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace xpum {
+
+const std::string DIAG_REFERENCE_PERFORMANCE_CONFIG_FILE = "reference_performance.conf";
+
+// the results of a diagnostic on the fleet of one SKU
+struct ReferenceDistribution {
+    double median;
+    // the 5th percentile
+    double p5;
+};
+
+/*
+  ReferencePerformance is the database of the performance the diagnostics
+  measured on the fleet, in reference_performance.conf. Each entry holds the
+  median and the 5th percentile of the results of a SKU, for one GFX
+  firmware version or for all the versions without their own entry, so the
+  diagnostics rank a result against the devices of the same kind instead of
+  only comparing it to a fixed threshold.
+
+  The rank is estimated from a normal distribution through the median and the
+  5th percentile. A rank below REGRESSION_PERCENTILE of the file is a
+  regression, a device that is well slower than its fleet though above the
+  minimum of diagnostics.conf.
+*/
+class ReferencePerformance {
+   public:
+    // read the database again, it is empty if the file can not be read
+    static void load();
+
+    // the distribution of name for a device, by its name in diagnostics.conf and its GFX firmware version
+    static bool find(const std::string& device_name, const std::string& firmware, const std::string& name,
+                     ReferenceDistribution& distribution);
+
+    // in percent, 50 at the median
+    static double percentileRank(const ReferenceDistribution& distribution, double value);
+
+    static double getRegressionPercentile();
+
+    // the VERSION of the file, 0 if it is not loaded
+    static int getVersion();
+
+   private:
+    static std::mutex mutex;
+
+    static int version;
+
+    static double regression_percentile;
+
+    // keyed by device name and firmware version, the firmware version is empty for the entry of all versions
+    static std::map<std::pair<std::string, std::string>, std::map<std::string, ReferenceDistribution>> entries;
+};
+
+} // end namespace xpum
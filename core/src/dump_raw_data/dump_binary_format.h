@@ -0,0 +1,75 @@
+/* 
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file dump_binary_format.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace xpum {
+namespace dump {
+
+/*
+  Layout of the binary raw data dump, all the integers are little-endian:
+
+  file header
+    char[8]   magic "XPUMDUMP"
+    uint32    format version
+    uint32    column count N
+    N columns
+      uint8   column type, one of DumpColumnType
+      uint8   reserved, 0
+      uint16  length of the column name
+      char[]  column name, the same as the CSV header, not terminated
+  rows, until the end of the file
+    N cells of 8 bytes, in the order of the columns
+
+  A cell without value is NaN for FLOAT64 and UINT64_MAX for the other types.
+*/
+
+const char DUMP_BINARY_MAGIC[8] = {'X', 'P', 'U', 'M', 'D', 'U', 'M', 'P'};
+
+const uint32_t DUMP_BINARY_VERSION = 1;
+
+const std::size_t DUMP_BINARY_CELL_SIZE = 8;
+
+enum DumpColumnType : uint8_t {
+    // IEEE 754 double, the scaled metric value
+    DUMP_COLUMN_FLOAT64 = 0,
+    // milliseconds since the epoch
+    DUMP_COLUMN_TIMESTAMP = 1,
+    // unsigned integer or bit flags
+    DUMP_COLUMN_UINT64 = 2,
+};
+
+inline void appendLittleEndian(std::string& out, uint64_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; i++) {
+        out += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+inline void appendCell(std::string& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    appendLittleEndian(out, bits, DUMP_BINARY_CELL_SIZE);
+}
+
+inline void appendCell(std::string& out, uint64_t value) {
+    appendLittleEndian(out, value, DUMP_BINARY_CELL_SIZE);
+}
+
+inline void appendEmptyCell(std::string& out, DumpColumnType type) {
+    if (type == DUMP_COLUMN_FLOAT64) {
+        appendCell(out, std::numeric_limits<double>::quiet_NaN());
+    } else {
+        appendCell(out, std::numeric_limits<uint64_t>::max());
+    }
+}
+
+} // namespace dump
+} // namespace xpum
@@ -23,9 +23,27 @@ namespace xpum {
 
 DumpRawDataManager::DumpRawDataManager() {
     pThreadPool = std::make_shared<ScheduledThreadPool>(2);
+    pPolicyDispatcher.reset(new EventDispatcher<PolicyEvent>("dump_policy_trigger", 256, [this](const PolicyEvent& event) {
+        onPolicyTriggered(event.para.deviceId, event.para.type);
+    }));
+    pHealthDispatcher.reset(new EventDispatcher<HealthEvent>("dump_health_trigger", 256, [this](const HealthEvent& event) {
+        std::lock_guard<std::mutex> lock(dumpMutex);
+        for (auto &p_task : taskList) {
+            p_task->onHealthChanged(event);
+        }
+    }));
+    pDiagnosticDispatcher.reset(new EventDispatcher<DiagnosticEvent>("dump_diagnostic_trigger", 64, [this](const DiagnosticEvent& event) {
+        std::lock_guard<std::mutex> lock(dumpMutex);
+        for (auto &p_task : taskList) {
+            p_task->onDiagnosticDone(event);
+        }
+    }));
 }
 
 DumpRawDataManager::~DumpRawDataManager() {
+    pPolicyDispatcher->stop();
+    pHealthDispatcher->stop();
+    pDiagnosticDispatcher->stop();
     pThreadPool->close();
     // std::cout << "DumpRawDataManager::~DumpRawDataManager() called" << std::endl;
 }
@@ -37,15 +55,9 @@ void DumpRawDataManager::resetDumpFrequency() {
     }
 }
 
-xpum_result_t DumpRawDataManager::
-    startDumpRawDataTask(xpum_device_id_t deviceId,
-                         xpum_device_tile_id_t tileId,
-                         const xpum_dump_type_t dumpTypeList[],
-                         const int count,
-                         const char *dumpFilePath,
-                         xpum_dump_raw_data_option_t dumpOptions,
-                         xpum_dump_raw_data_task_t *taskInfo) {
-    std::lock_guard<std::mutex> lock(dumpMutex);
+static xpum_result_t validateDumpTask(const xpum_dump_type_t dumpTypeList[],
+                                      const int count,
+                                      const char *dumpFilePath) {
     if (dumpFilePath == nullptr)
         return XPUM_DUMP_RAW_DATA_ILLEGAL_DUMP_FILE_PATH;
     std::string filepath(dumpFilePath);
@@ -69,6 +81,21 @@ xpum_result_t DumpRawDataManager::
         if (getConfigOptionPointer(dumpType) == nullptr)
             return XPUM_RESULT_DUMP_METRICS_TYPE_NOT_SUPPORT;
     }
+    return XPUM_OK;
+}
+
+xpum_result_t DumpRawDataManager::
+    startDumpRawDataTask(xpum_device_id_t deviceId,
+                         xpum_device_tile_id_t tileId,
+                         const xpum_dump_type_t dumpTypeList[],
+                         const int count,
+                         const char *dumpFilePath,
+                         xpum_dump_raw_data_option_t dumpOptions,
+                         xpum_dump_raw_data_task_t *taskInfo) {
+    std::lock_guard<std::mutex> lock(dumpMutex);
+    xpum_result_t res = validateDumpTask(dumpTypeList, count, dumpFilePath);
+    if (res != XPUM_OK)
+        return res;
 
     // create task
     std::shared_ptr<DumpRawDataTask> p_task = std::make_shared<DumpRawDataTask>(taskIndex++, deviceId, tileId, std::string(dumpFilePath), pThreadPool);
@@ -90,6 +117,35 @@ xpum_result_t DumpRawDataManager::
     return XPUM_OK;
 }
 
+xpum_result_t DumpRawDataManager::
+    startDumpRawDataTask(const std::vector<xpum_device_id_t> &deviceIdList,
+                         const xpum_dump_type_t dumpTypeList[],
+                         const int count,
+                         const char *dumpFilePath,
+                         xpum_dump_raw_data_option_t dumpOptions,
+                         xpum_dump_raw_data_task_t *taskInfo) {
+    std::lock_guard<std::mutex> lock(dumpMutex);
+    if (deviceIdList.empty())
+        return XPUM_RESULT_DEVICE_NOT_FOUND;
+    xpum_result_t res = validateDumpTask(dumpTypeList, count, dumpFilePath);
+    if (res != XPUM_OK)
+        return res;
+
+    // one task samples all the devices in the same tick
+    std::shared_ptr<DumpRawDataTask> p_task = std::make_shared<DumpRawDataTask>(taskIndex++, deviceIdList[0], -1, std::string(dumpFilePath), pThreadPool);
+    p_task->deviceIdList = deviceIdList;
+    p_task->dumpOptions = dumpOptions;
+    for (int i = 0; i < count; i++) {
+        p_task->dumpTypeList.push_back(dumpTypeList[i]);
+    }
+    taskList.push_back(p_task);
+
+    p_task->start();
+
+    p_task->fillTaskInfoBuffer(taskInfo);
+    return XPUM_OK;
+}
+
 xpum_result_t DumpRawDataManager::
     stopDumpRawDataTask(xpum_dump_task_id_t taskId, xpum_dump_raw_data_task_t *taskInfo) {
     std::lock_guard<std::mutex> lock(dumpMutex);
@@ -130,6 +186,13 @@ xpum_result_t DumpRawDataManager::
     return XPUM_OK;
 }
 
+void DumpRawDataManager::onPolicyTriggered(xpum_device_id_t deviceId, xpum_policy_type_t type) {
+    std::lock_guard<std::mutex> lock(dumpMutex);
+    for (auto &p_task : taskList) {
+        p_task->trigger(deviceId, type);
+    }
+}
+
 void DumpRawDataManager::init() {
 }
 } // namespace xpum
\ No newline at end of file
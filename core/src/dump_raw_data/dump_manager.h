@@ -10,8 +10,11 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "dump_task.h"
+#include "event/event_bus.h"
+#include "event/events.h"
 #include "infrastructure/scheduled_thread_pool.h"
 #include "xpum_structs.h"
 
@@ -25,6 +28,14 @@ class DumpRawDataManager {
 
     std::shared_ptr<ScheduledThreadPool> pThreadPool;
 
+    // takes the triggered policies from the event bus for onPolicyTriggered
+    std::unique_ptr<EventDispatcher<PolicyEvent>> pPolicyDispatcher;
+
+    // the health changes and the diagnostics results, instant events of the traces and triggers
+    std::unique_ptr<EventDispatcher<HealthEvent>> pHealthDispatcher;
+
+    std::unique_ptr<EventDispatcher<DiagnosticEvent>> pDiagnosticDispatcher;
+
    public:
     DumpRawDataManager();
 
@@ -42,8 +53,18 @@ class DumpRawDataManager {
                                        xpum_dump_raw_data_option_t dumpOptions,
                                        xpum_dump_raw_data_task_t *taskInfo);
 
+    xpum_result_t startDumpRawDataTask(const std::vector<xpum_device_id_t> &deviceIdList,
+                                       const xpum_dump_type_t dumpTypeList[],
+                                       const int count,
+                                       const char *dumpFilePath,
+                                       xpum_dump_raw_data_option_t dumpOptions,
+                                       xpum_dump_raw_data_task_t *taskInfo);
+
     xpum_result_t stopDumpRawDataTask(xpum_dump_task_id_t taskId, xpum_dump_raw_data_task_t *taskInfo);
 
     xpum_result_t listDumpRawDataTasks(xpum_dump_raw_data_task_t taskList[], int *count);
+
+    // called when a policy of the device is triggered, for the triggered tasks
+    void onPolicyTriggered(xpum_device_id_t deviceId, xpum_policy_type_t type);
 };
 } // namespace xpum
\ No newline at end of file
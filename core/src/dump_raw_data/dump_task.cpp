@@ -7,8 +7,7 @@
 #include "dump_task.h"
 
 #include <algorithm>
-#include <fstream>
-#include <iomanip>
+#include <cstdio>
 #include <iostream>
 #include <map>
 #include <sstream>
@@ -16,6 +15,7 @@
 #include "api/internal_api.h"
 #include "api/internal_dump_raw_data.h"
 #include "core/core.h"
+#include "dump_binary_format.h"
 #include "infrastructure/configuration.h"
 
 using xpum::dump::dumpTypeOptions;
@@ -37,6 +37,7 @@ DumpRawDataTask::DumpRawDataTask(xpum_dump_task_id_t taskId,
     p_data_logic = xpum::Core::instance().getDataLogic();
     begin = 0;
     dumpOptions = xpum_dump_raw_data_option_t{};
+    deviceIdList.push_back(deviceId);
 }
 
 DumpRawDataTask::~DumpRawDataTask() {
@@ -47,66 +48,444 @@ DumpRawDataTask::~DumpRawDataTask() {
     std::cout << "~DumpRawDataTask() called" << std::endl;
 }
 
-void DumpRawDataTask::writeToFile(std::string text) {
-    std::ofstream outfile;
-    outfile.open(dumpFilePath.c_str(), std::ios::out | std::ios::app);
-    outfile << text << std::endl;
-    outfile.flush();
-    outfile.close();
+void DumpRawDataTask::writeToFile(const std::string& text) {
+    pWriter->write(text.data(), text.size());
 }
 
-void DumpRawDataTask::writeHeader() {
-    std::ofstream outfile;
-    outfile.open(dumpFilePath.c_str(), std::ios::out | std::ios::app);
-    for (std::size_t i = 0; i < columnList.size(); i++) {
-        auto dc = columnList[i];
-        outfile << dc.header;
-        if (i < columnList.size() - 1) {
-            outfile << ", ";
-        }
+static dump::DumpColumnType getBinaryColumnType(DumpValueFormat format) {
+    switch (format) {
+        case DumpValueFormat::SCALED:
+        case DumpValueFormat::ERROR_COUNTER:
+            return dump::DUMP_COLUMN_FLOAT64;
+        case DumpValueFormat::TIMESTAMP:
+            return dump::DUMP_COLUMN_TIMESTAMP;
+        default:
+            return dump::DUMP_COLUMN_UINT64;
     }
-    outfile << std::endl;
-    outfile.flush();
-    outfile.close();
 }
 
-std::string keepTwoDecimalPrecision(double value) {
-    std::ostringstream os;
-    os << std::fixed;
-    os << std::setprecision(2);
-    os << value;
-    return os.str();
+void DumpRawDataTask::writeHeader() {
+    std::string header;
+    if (dumpOptions.format == XPUM_DUMP_FORMAT_BINARY) {
+        header.append(dump::DUMP_BINARY_MAGIC, sizeof(dump::DUMP_BINARY_MAGIC));
+        dump::appendLittleEndian(header, dump::DUMP_BINARY_VERSION, 4);
+        dump::appendLittleEndian(header, columns.size(), 4);
+        for (auto& dc : columns) {
+            dump::appendLittleEndian(header, getBinaryColumnType(dc.format), 1);
+            dump::appendLittleEndian(header, 0, 1);
+            dump::appendLittleEndian(header, dc.header.size(), 2);
+            header += dc.header;
+        }
+    } else if (dumpOptions.format == XPUM_DUMP_FORMAT_TRACE) {
+        // the JSON array format of the trace event format, the closing bracket is optional
+        // so a file is complete at each flush and at each rotation
+        header += "[\n";
+        for (auto& source : sources) {
+            std::string name = "GPU " + std::to_string(source->deviceId);
+            if (source->tileId != -1) {
+                name += " Tile " + std::to_string(source->tileId);
+            }
+            header += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + std::to_string(source->deviceId) + ",\"args\":{\"name\":\"" + name + "\"}},\n";
+            header += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + std::to_string(source->deviceId) + ",\"tid\":0,\"args\":{\"name\":\"Frequency Throttle Reasons\"}},\n";
+        }
+    } else {
+        for (std::size_t i = 0; i < columns.size(); i++) {
+            header += columns[i].header;
+            if (i < columns.size() - 1) {
+                header += ", ";
+            }
+        }
+        header += '\n';
+    }
+    // the header is written out right away, and again at the start of each rotated file
+    pWriter->setHeader(header);
 }
 
-std::string getScaledValue(uint64_t value, uint32_t scale) {
+static void appendScaledValue(std::string& out, uint64_t value, uint32_t scale) {
+    char buf[32];
+    int len;
     if (scale == 1) {
-        return std::to_string(value);
+        len = snprintf(buf, sizeof(buf), "%llu", (unsigned long long)value);
     } else {
-        double v = value / (double)scale;
-        return keepTwoDecimalPrecision(v);
+        len = snprintf(buf, sizeof(buf), "%.2f", value / (double)scale);
+    }
+    if (len > 0) {
+        out.append(buf, std::min<std::size_t>(len, sizeof(buf) - 1));
+    }
+}
+
+static void appendThrottleReasons(std::string& out, uint64_t value) {
+    auto begin = out.size();
+    if (value & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_AVE_PWR_CAP) {
+        out += "AVE_PWR_CAP | ";
+    }
+    if (value & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_BURST_PWR_CAP) {
+        out += "BURST_PWR_CAP | ";
+    }
+    if (value & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_CURRENT_LIMIT) {
+        out += "CURRENT_LIMIT | ";
+    }
+    if (value & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_THERMAL_LIMIT) {
+        out += "THERMAL_LIMIT | ";
+    }
+    if (value & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_PSU_ALERT) {
+        out += "PSU_ALERT | ";
+    }
+    if (value & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_SW_RANGE) {
+        out += "SW_RANGE | ";
+    }
+    if (value & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_HW_RANGE) {
+        out += "HW_RANGE | ";
+    }
+    if (out.size() == begin) {
+        out += "Not Throttled | ";
+    }
+    out.resize(out.size() - 3);
+}
+
+void DumpRawDataTask::appendCsvRow(std::string& row) {
+    for (std::size_t i = 0; i < columns.size(); i++) {
+        auto& dc = columns[i];
+        auto& value = cells[i];
+        if (!cellPresent[i]) {
+            row += "N/A";
+        } else if (dc.format == DumpValueFormat::TIMESTAMP) {
+            row += Utility::getLocalTimeString(value.value, dumpOptions.showDate);
+        } else if (dc.format == DumpValueFormat::THROTTLE_REASONS) {
+            appendThrottleReasons(row, value.value);
+        } else {
+            appendScaledValue(row, value.value, value.scale);
+        }
+        if (i < columns.size() - 1) {
+            row += ',';
+        }
+    }
+    row += '\n';
+}
+
+void DumpRawDataTask::appendBinaryRow(std::string& row) {
+    for (std::size_t i = 0; i < columns.size(); i++) {
+        auto type = getBinaryColumnType(columns[i].format);
+        auto& value = cells[i];
+        if (!cellPresent[i]) {
+            dump::appendEmptyCell(row, type);
+        } else if (type == dump::DUMP_COLUMN_FLOAT64) {
+            dump::appendCell(row, value.scale == 1 ? (double)value.value : value.value / (double)value.scale);
+        } else {
+            dump::appendCell(row, value.value);
+        }
+    }
+}
+
+static const char* getPolicyTypeName(xpum_policy_type_t type) {
+    switch (type) {
+        case XPUM_POLICY_TYPE_GPU_TEMPERATURE:
+            return "GPU Temperature";
+        case XPUM_POLICY_TYPE_GPU_MEMORY_TEMPERATURE:
+            return "GPU Memory Temperature";
+        case XPUM_POLICY_TYPE_GPU_POWER:
+            return "GPU Power";
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_RESET:
+            return "Reset";
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_PROGRAMMING_ERRORS:
+            return "Programming Errors";
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_DRIVER_ERRORS:
+            return "Driver Errors";
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE:
+            return "Cache Errors Correctable";
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE:
+            return "Cache Errors Uncorrectable";
+        case XPUM_POLICY_TYPE_GPU_MISSING:
+            return "GPU Missing";
+        case XPUM_POLICY_TYPE_GPU_THROTTLE:
+            return "GPU Throttle";
+        case XPUM_POLICY_TYPE_PRECHECK_ERROR:
+            return "Precheck Error";
+        default:
+            return "Unknown";
+    }
+}
+
+// the fields of a trace event up to its args, the caller closes the event
+static void appendTraceEvent(std::string& out, const std::string& name, const char* phase, uint64_t timestamp, xpum_device_id_t deviceId) {
+    out += "{\"name\":\"";
+    out += name;
+    out += "\",\"ph\":\"";
+    out += phase;
+    out += "\",\"ts\":";
+    out += std::to_string(timestamp);
+    out += ",\"pid\":";
+    out += std::to_string(deviceId);
+    out += ",\"tid\":0";
+}
+
+void DumpRawDataTask::appendTraceEvents(std::string& row, uint64_t timestamp) {
+    // the trace event format counts in microseconds
+    uint64_t ts = timestamp * 1000;
+    std::vector<TraceInstantEvent> instantEvents;
+    {
+        std::lock_guard<std::mutex> lock(traceInstantMutex);
+        instantEvents.swap(traceInstantEvents);
+    }
+    for (auto& event : instantEvents) {
+        appendTraceEvent(row, event.name, "i", event.time * 1000, event.deviceId);
+        row += ",\"s\":\"p\",\"args\":" + event.args + "},\n";
+    }
+
+    traceLastValues.resize(sources.size());
+    traceLastPresent.resize(sources.size());
+    for (std::size_t k = 0; k < sources.size(); k++) {
+        auto& source = *sources[k];
+        auto& lastValues = traceLastValues[k];
+        auto& lastPresent = traceLastPresent[k];
+        lastValues.resize(source.values.size());
+        lastPresent.resize(source.present.size());
+        for (std::size_t i = source.getConstantCount(); i < source.columnList.size(); i++) {
+            if (!source.present[i]) {
+                continue;
+            }
+            auto& dc = source.columnList[i];
+            auto& value = source.values[i];
+            if (dc.format == DumpValueFormat::THROTTLE_REASONS) {
+                // a slice per run of the same reasons, nothing while not throttled
+                if (lastPresent[i] && lastValues[i].value == value.value) {
+                    continue;
+                }
+                if (lastPresent[i] && lastValues[i].value != 0) {
+                    appendTraceEvent(row, "", "E", ts, source.deviceId);
+                    row += "},\n";
+                }
+                if (value.value != 0) {
+                    std::string reasons;
+                    appendThrottleReasons(reasons, value.value);
+                    appendTraceEvent(row, reasons, "B", ts, source.deviceId);
+                    row += "},\n";
+                }
+            } else {
+                appendTraceEvent(row, dc.header, "C", ts, source.deviceId);
+                row += ",\"args\":{\"value\":";
+                appendScaledValue(row, value.value, value.scale);
+                row += "}},\n";
+                if (dc.format == DumpValueFormat::ERROR_COUNTER && lastPresent[i] && value.value > lastValues[i].value) {
+                    appendTraceEvent(row, dc.header, "i", ts, source.deviceId);
+                    row += ",\"s\":\"p\",\"args\":{\"increase\":";
+                    appendScaledValue(row, value.value - lastValues[i].value, value.scale);
+                    row += "}},\n";
+                }
+            }
+            lastValues[i] = value;
+            lastPresent[i] = true;
+        }
     }
 }
 
 void DumpRawDataTask::buildColumns() {
-    auto p_this = shared_from_this();
+    XPUM_LOG_DEBUG("showDate: {}", dumpOptions.showDate ? "true" : "false");
+    for (auto id : deviceIdList) {
+        sources.emplace_back(new DumpDeviceSource(id, tileId, dumpTypeList, p_data_logic));
+        sources.back()->buildColumns();
+    }
+
+    // the timestamp is taken once per tick and shared by all the devices
+    columns.emplace_back("Timestamp", DumpValueFormat::TIMESTAMP);
+
+    // the wide layout has one row per tick with the columns of every device,
+    // the long layout has one row per device and the columns of the same name are merged
+    bool wide = dumpOptions.layout == XPUM_DUMP_LAYOUT_WIDE && sources.size() > 1;
+    std::map<std::string, std::size_t> columnIndexByHeader;
+    for (auto& source : sources) {
+        std::vector<std::size_t> indexes;
+        for (auto& dc : source->columnList) {
+            if (wide) {
+                indexes.push_back(columns.size());
+                columns.emplace_back("GPU " + std::to_string(source->deviceId) + " " + dc.header, dc.format);
+                continue;
+            }
+            auto it = columnIndexByHeader.find(dc.header);
+            if (it == columnIndexByHeader.end()) {
+                it = columnIndexByHeader.emplace(dc.header, columns.size()).first;
+                columns.emplace_back(dc.header, dc.format);
+            }
+            indexes.push_back(it->second);
+        }
+        sourceColumnIndexes.push_back(indexes);
+    }
+    cells.resize(columns.size());
+    cellPresent.resize(columns.size());
+}
+
+void DumpRawDataTask::readSource(std::size_t index) {
+    auto& source = *sources[index];
+    auto& indexes = sourceColumnIndexes[index];
+    for (std::size_t i = 0; i < indexes.size(); i++) {
+        cells[indexes[i]] = source.values[i];
+        cellPresent[indexes[i]] = source.present[i];
+    }
+}
+
+void DumpRawDataTask::dumpRows() {
+    long long now = Utility::getCurrentMillisecond();
+    for (auto& source : sources) {
+        source->updateData();
+    }
+
+    // the row buffer keeps its capacity across ticks
+    auto& row = rowBuffer;
+    row.clear();
+    if (dumpOptions.format == XPUM_DUMP_FORMAT_TRACE) {
+        // a trace has tracks by device instead of rows, the layout does not apply
+        appendTraceEvents(row, (uint64_t)now);
+        if (dumpOptions.triggered) {
+            captureRow((uint64_t)now, row);
+        } else {
+            writeToFile(row);
+        }
+        return;
+    }
+    bool wide = dumpOptions.layout == XPUM_DUMP_LAYOUT_WIDE;
+    for (std::size_t i = 0; i < sources.size(); i++) {
+        if (i == 0 || !wide) {
+            std::fill(cellPresent.begin(), cellPresent.end(), false);
+            cells[0] = DumpValue((uint64_t)now, 1);
+            cellPresent[0] = true;
+        }
+        readSource(i);
+        if (i == sources.size() - 1 || !wide) {
+            if (dumpOptions.format == XPUM_DUMP_FORMAT_BINARY) {
+                appendBinaryRow(row);
+            } else {
+                appendCsvRow(row);
+            }
+        }
+    }
 
-    // timestamp column
-    auto showDate = p_this->dumpOptions.showDate;
-    XPUM_LOG_DEBUG("showDate: {}", showDate ? "true" : "false");
-    columnList.push_back({"Timestamp",
-                          [showDate]() { return Utility::getCurrentLocalTimeString(showDate); }});
+    if (dumpOptions.triggered) {
+        captureRow((uint64_t)now, row);
+    } else {
+        writeToFile(row);
+    }
+}
 
-    // device id column
-    auto deviceId = p_this->deviceId;
-    columnList.push_back({"DeviceId",
-                          [deviceId]() { return std::to_string(deviceId); }});
+void DumpRawDataTask::captureRow(uint64_t timestamp, const std::string& row) {
+    uint64_t triggerTime = pendingTrigger.exchange(0);
+    if (triggerTime != 0) {
+        // the rows before the trigger go out first, a trigger during the capture extends it
+        for (auto& kept : triggerRing) {
+            writeToFile(kept.second);
+        }
+        triggerRing.clear();
+        captureUntil = std::max(captureUntil, triggerTime + (uint64_t)dumpOptions.postTriggerTime * 1000);
+    }
+    if (timestamp <= captureUntil) {
+        writeToFile(row);
+        return;
+    }
+    if (captureUntil != 0) {
+        // the capture is over, put it on disk before going back to memory only
+        pWriter->flush();
+        captureUntil = 0;
+    }
+    triggerRing.emplace_back(timestamp, row);
+    uint64_t keep = (uint64_t)dumpOptions.preTriggerTime * 1000;
+    while (triggerRing.front().first + keep < timestamp) {
+        triggerRing.pop_front();
+    }
+}
 
-    // tile id column
-    auto tileId = p_this->tileId;
+void DumpRawDataTask::notifyEvent(xpum_device_id_t id, const std::string& name, const std::string& args, bool fire, uint32_t triggerBit) {
+    if (std::find(deviceIdList.begin(), deviceIdList.end(), id) == deviceIdList.end()) {
+        return;
+    }
+    if (dumpOptions.format == XPUM_DUMP_FORMAT_TRACE) {
+        std::lock_guard<std::mutex> lock(traceInstantMutex);
+        traceInstantEvents.push_back(TraceInstantEvent{(uint64_t)Utility::getCurrentMillisecond(), id, name, args});
+    }
+    if (!fire || !dumpOptions.triggered) {
+        return;
+    }
+    if (dumpOptions.triggerMask != 0 && (dumpOptions.triggerMask & triggerBit) == 0) {
+        return;
+    }
+    pendingTrigger.store(Utility::getCurrentMillisecond());
+    triggerCount++;
+    XPUM_LOG_INFO("Dump task {} is triggered by {} of device {}", taskId, name, id);
+}
+
+void DumpRawDataTask::trigger(xpum_device_id_t id, xpum_policy_type_t type) {
+    uint32_t bit = type < XPUM_POLICY_TYPE_MAX ? 1U << type : 0;
+    notifyEvent(id, std::string("Policy ") + getPolicyTypeName(type), "{\"type\":" + std::to_string(type) + "}", true, bit);
+}
+
+static const char* getHealthTypeName(xpum_health_type_t type) {
+    switch (type) {
+        case XPUM_HEALTH_CORE_THERMAL:
+            return "Core Thermal";
+        case XPUM_HEALTH_MEMORY_THERMAL:
+            return "Memory Thermal";
+        case XPUM_HEALTH_POWER:
+            return "Power";
+        case XPUM_HEALTH_MEMORY:
+            return "Memory";
+        case XPUM_HEALTH_FABRIC_PORT:
+            return "Fabric Port";
+        case XPUM_HEALTH_FREQUENCY:
+            return "Frequency";
+        default:
+            return "Unknown";
+    }
+}
+
+static const char* getHealthStatusName(xpum_health_status_t status) {
+    switch (status) {
+        case XPUM_HEALTH_STATUS_OK:
+            return "OK";
+        case XPUM_HEALTH_STATUS_WARNING:
+            return "Warning";
+        case XPUM_HEALTH_STATUS_CRITICAL:
+            return "Critical";
+        default:
+            return "Unknown";
+    }
+}
+
+void DumpRawDataTask::onHealthChanged(const HealthEvent& event) {
+    std::string name = std::string("Health ") + getHealthTypeName(event.type) + " " + getHealthStatusName(event.status);
+    std::string args = "{\"type\":" + std::to_string(event.type) + ",\"status\":" + std::to_string(event.status) + ",\"previous\":" + std::to_string(event.previousStatus) + "}";
+    notifyEvent(event.deviceId, name, args, event.status == XPUM_HEALTH_STATUS_CRITICAL, XPUM_DUMP_TRIGGER_HEALTH);
+}
+
+void DumpRawDataTask::onDiagnosticDone(const DiagnosticEvent& event) {
+    bool failed = event.result == XPUM_DIAG_RESULT_FAIL;
+    std::string name = failed ? "Diagnostics Failed" : "Diagnostics Passed";
+    notifyEvent(event.deviceId, name, "{\"result\":" + std::to_string(event.result) + "}", failed, XPUM_DUMP_TRIGGER_DIAGNOSTIC);
+}
+
+DumpDeviceSource::DumpDeviceSource(xpum_device_id_t deviceId,
+                                   xpum_device_tile_id_t tileId,
+                                   const std::vector<xpum_dump_type_t>& dumpTypeList,
+                                   std::shared_ptr<xpum::DataLogicInterface> p_data_logic)
+    : deviceId(deviceId),
+      tileId(tileId),
+      dumpTypeList(dumpTypeList),
+      p_data_logic(p_data_logic) {
+}
+
+std::size_t DumpDeviceSource::addColumn(const std::string& header, DumpValueFormat format) {
+    columnList.emplace_back(header, format);
+    values.emplace_back();
+    present.push_back(false);
+    return columnList.size() - 1;
+}
+
+void DumpDeviceSource::buildColumns() {
+    // the device id and tile id columns keep their values
+    present[addColumn("DeviceId", DumpValueFormat::INTEGER)] = true;
+    values.back() = DumpValue((uint64_t)deviceId, 1);
     if (tileId != -1) {
-        columnList.push_back({"TileId",
-                              [tileId]() { return std::to_string(tileId); }});
+        present[addColumn("TileId", DumpValueFormat::INTEGER)] = true;
+        values.back() = DumpValue((uint64_t)tileId, 1);
     }
+    constantCount = columnList.size();
 
     // get engine count
     auto engineCountList = getDeviceAndTileEngineCount(deviceId);
@@ -154,167 +533,77 @@ void DumpRawDataTask::buildColumns() {
         }
     }
 
+    engineByTile = needAggFromTiles;
+
     // other columns
     for (std::size_t i = 0; i < dumpTypeList.size(); i++) {
         int dumpTypeIdx = dumpTypeList[i];
         auto config = dumpTypeOptions[dumpTypeIdx];
         if (config.optionType == xpum::dump::DUMP_OPTION_STATS) {
-            int columnIdx = columnList.size();
-            columnList.push_back({std::string(config.name),
-                                  [config, p_this, columnIdx]() {
-                                      DumpColumn& dc = p_this->columnList.at(columnIdx);
-                                      auto statsType = config.metricsType;
-                                      auto& m = p_this->rawDataMap;
-                                      auto it = m.find(statsType);
-                                      std::string value;
-                                      if (it != m.end()) {
-                                          auto data = it->second;
-                                          if (dc.lastTimestamp != data.timestamp) {
-                                              value = getScaledValue(data.value, data.scale * config.scale);
-                                          }
-                                          dc.lastTimestamp = data.timestamp;
-                                      }
-                                      return value;
-                                  }});
+            bool errorCounter = config.metricsType >= XPUM_STATS_RAS_ERROR_CAT_RESET && config.metricsType <= XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE;
+            auto slot = addColumn(std::string(config.name), errorCounter ? DumpValueFormat::ERROR_COUNTER : DumpValueFormat::SCALED);
+            statsBindings.emplace_back(config.metricsType, config.scale, slot, false);
         } else if (config.optionType == xpum::dump::DUMP_OPTION_ENGINE) {
-            if (curEngineCountList.empty())
-                continue;
-            for (auto ec : curEngineCountList) {
-            for(auto ecByType : ec.engineCountList){
-                auto engineType = ecByType.engineType;
-                auto tileId = ec.tileId;
-                if (engineType != config.engineType)
-                    continue;
-
-                std::string tileInfo = "";
-                if(needAggFromTiles) {
-                    tileInfo = std::to_string(ec.tileId) + "/";
-                }
-                for (int engineIdx = 0; engineIdx < ecByType.count; engineIdx++) {
-                    std::string header = engineNameMap[config.engineType] + " " + tileInfo + std::to_string(engineIdx) + " (%)";
-                    columnList.push_back({header,
-                                          [engineType, needAggFromTiles, tileId, engineIdx, p_this, config]() {
-                                              auto& m = p_this->engineUtilRawDataMap;
-                                              auto it = m.find(engineType);
-                                              std::string value;
-                                              if (it == m.end()) {
-                                                  return value;
-                                              }
-                                              auto& mm = it->second;
-                                              auto it2 = mm.find(engineIdx);
-                                              if (it2 == mm.end()) {
-                                                  return value;
-                                              }
-                                              auto& dataList = it2->second;
-                                              if (!needAggFromTiles && dataList.size() > 0){
-                                                  auto& data = dataList[0];
-                                                  return getScaledValue(data.value, data.scale * config.scale);
-                                              } else if (needAggFromTiles && dataList.size() > 0){
-                                                  auto it = std::find_if(dataList.begin(), dataList.end(),
-                                                                        [tileId] (const xpum::xpum_device_engine_metric_t& d) {return tileId == d.tileId;});
-                                                  if(it == dataList.end()){
-                                                    return value;
-                                                  }
-                                                  auto& data = (*it);
-                                                  return getScaledValue(data.value, data.scale * config.scale);
-                                              } else {
-                                                  return value;
-                                              }
-                                          }});
+            for (auto& ec : curEngineCountList) {
+                for (auto& ecByType : ec.engineCountList) {
+                    if (ecByType.engineType != config.engineType)
+                        continue;
+                    std::string tileInfo = "";
+                    if (needAggFromTiles) {
+                        tileInfo = std::to_string(ec.tileId) + "/";
+                    }
+                    for (int engineIdx = 0; engineIdx < ecByType.count; engineIdx++) {
+                        std::string header = engineNameMap[config.engineType] + " " + tileInfo + std::to_string(engineIdx) + " (%)";
+                        auto slot = addColumn(header, DumpValueFormat::SCALED);
+                        auto key = std::make_tuple((int)config.engineType, (uint64_t)engineIdx, needAggFromTiles ? ec.tileId : -1);
+                        engineSlots.emplace(key, SlotBinding(slot, config.scale));
+                    }
                 }
             }
-            }
         } else if (config.optionType == xpum::dump::DUMP_OPTION_FABRIC && pFabricCountList) {
             for (auto& fc : *pFabricCountList) {
-                std::stringstream ss;
-                std::string key;
-                std::string header;
                 // tx
-                ss << deviceId << "/" << fc.tile_id;
-                ss << "->" << fc.remote_device_id << "/" << fc.remote_tile_id;
-                key = ss.str();
-                header = "XL " + key + " (kB/s)";
-                columnList.push_back({header,
-                                      [config, key, p_this]() {
-                                          auto& m = p_this->fabricRawDataMap;
-                                          auto it = m.find(key);
-                                          std::string value;
-                                          if (it == m.end()) {
-                                              return value;
-                                          }
-                                          auto& data = it->second;
-                                          return getScaledValue(data.value, data.scale * config.scale * 1000); // kB
-                                      }});
+                std::string header = "XL " + std::to_string(deviceId) + "/" + std::to_string(fc.tile_id) + "->" + std::to_string(fc.remote_device_id) + "/" + std::to_string(fc.remote_tile_id) + " (kB/s)";
+                auto slot = addColumn(header, DumpValueFormat::SCALED);
+                fabricSlots.emplace(std::make_tuple(fc.tile_id, fc.remote_device_id, fc.remote_tile_id, (int)XPUM_FABRIC_THROUGHPUT_TYPE_TRANSMITTED), SlotBinding(slot, config.scale * 1000)); // kB
                 // rx
-                ss.str("");
-                ss << fc.remote_device_id << "/" << fc.remote_tile_id;
-                ss << "->";
-                ss << deviceId << "/" << fc.tile_id;
-                key = ss.str();
-                header = "XL " + key + " (kB/s)";
-                columnList.push_back({header,
-                                      [config, key, p_this]() {
-                                          auto& m = p_this->fabricRawDataMap;
-                                          auto it = m.find(key);
-                                          std::string value;
-                                          if (it == m.end()) {
-                                              return value;
-                                          }
-                                          auto& data = it->second;
-                                          return getScaledValue(data.value, data.scale * config.scale * 1000); // kB
-                                      }});
+                header = "XL " + std::to_string(fc.remote_device_id) + "/" + std::to_string(fc.remote_tile_id) + "->" + std::to_string(deviceId) + "/" + std::to_string(fc.tile_id) + " (kB/s)";
+                slot = addColumn(header, DumpValueFormat::SCALED);
+                fabricSlots.emplace(std::make_tuple(fc.tile_id, fc.remote_device_id, fc.remote_tile_id, (int)XPUM_FABRIC_THROUGHPUT_TYPE_RECEIVED), SlotBinding(slot, config.scale * 1000)); // kB
             }
         } else if (config.optionType == xpum::dump::DUMP_OPTION_THROTTLE_REASON) {
-            int columnIdx = columnList.size();
-            columnList.push_back({std::string(config.name),
-                                  [config, p_this, columnIdx]() {
-                                        DumpColumn& dc = p_this->columnList.at(columnIdx);
-                                        auto statsType = config.metricsType;
-                                        auto& m = p_this->rawDataMap;
-                                        auto it = m.find(statsType);
-                                        std::string value;
-                                        if (it != m.end()) {
-                                            auto data = it->second;
-                                            if (dc.lastTimestamp != data.timestamp) {
-                                                std::string ss;
-                                            if (data.value & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_AVE_PWR_CAP) {
-                                                ss += "AVE_PWR_CAP | ";
-                                            }
-                                            if (data.value & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_BURST_PWR_CAP) {
-                                                ss += "BURST_PWR_CAP | ";
-                                            }
-                                            if (data.value & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_CURRENT_LIMIT) {
-                                                ss += "CURRENT_LIMIT | ";
-                                            }
-                                            if (data.value & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_THERMAL_LIMIT) {
-                                                ss += "THERMAL_LIMIT | ";
-                                            }
-                                            if (data.value & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_PSU_ALERT) {
-                                                ss += "PSU_ALERT | ";
-                                            }
-                                            if (data.value & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_SW_RANGE) {
-                                                ss += "SW_RANGE | ";
-                                            }
-                                            if (data.value & xpum::dump::ZES_FREQ_THROTTLE_REASON_FLAG_HW_RANGE) {
-                                                ss += "HW_RANGE | ";
-                                            }
-                                            if (ss.size() == 0) {
-                                                ss += "Not Throttled | ";
-                                            }
-                                            return ss.substr(0, ss.size() - 3);
-                                          }
-                                          dc.lastTimestamp = data.timestamp;
-                                      }
-                                      return value;
-                                  }});
+            auto slot = addColumn(std::string(config.name), DumpValueFormat::THROTTLE_REASONS);
+            statsBindings.emplace_back(config.metricsType, 1, slot, true);
         }
     }
 }
 
-void DumpRawDataTask::updateData() {
-    auto p_this = shared_from_this();
+void DumpDeviceSource::updateStats() {
+    for (auto& binding : statsBindings) {
+        auto it = rawDataMap.find(binding.metricsType);
+        if (it == rawDataMap.end()) {
+            continue;
+        }
+        auto& data = it->second;
+        if (binding.repeated) {
+            values[binding.slot] = DumpValue(data.value, 1);
+            present[binding.slot] = true;
+            continue;
+        }
+        if (binding.lastTimestamp != data.timestamp) {
+            values[binding.slot] = DumpValue(data.value, data.scale * binding.scale);
+            present[binding.slot] = true;
+        }
+        binding.lastTimestamp = data.timestamp;
+    }
+}
+
+void DumpDeviceSource::updateData() {
+    auto p_this = this;
     auto p_data_logic = p_this->p_data_logic;
 
+    std::fill(present.begin() + constantCount, present.end(), false);
+
     // get raw data
     int metricsCount = 0;
     p_data_logic->getLatestMetrics(p_this->deviceId, nullptr, &metricsCount);
@@ -393,54 +682,40 @@ void DumpRawDataTask::updateData() {
         }
     }
 
-    // get engine raw data
-    engineUtilRawDataMap.clear();
+    updateStats();
 
+    // get engine raw data
     uint32_t engineUtilRawDataSize = 0;
-
     p_data_logic->getEngineUtilizations(p_this->deviceId, nullptr, &engineUtilRawDataSize);
     std::vector<xpum_device_engine_metric_t> engineUtilRawDataList(engineUtilRawDataSize);
     p_data_logic->getEngineUtilizations(p_this->deviceId, engineUtilRawDataList.data(), &engineUtilRawDataSize);
     for (uint32_t i = 0; i < engineUtilRawDataSize; i++) {
-        auto engineUtilRawData = engineUtilRawDataList[i];
-        if ((p_this->tileId == -1) || (engineUtilRawData.isTileData && (p_this->tileId == engineUtilRawData.tileId))) {
-            auto engineType = engineUtilRawData.type;
-            auto it = engineUtilRawDataMap.find(engineType);
-            if (it == engineUtilRawDataMap.end()) {
-                engineUtilRawDataMap[engineType] = std::map<int, std::vector<xpum_device_engine_metric_t>>();
-            }
-
-            auto it1 = engineUtilRawDataMap[engineType].find(engineUtilRawData.index);
-            if (it1 == engineUtilRawDataMap[engineType].end()) {
-                engineUtilRawDataMap[engineType][engineUtilRawData.index] = std::vector<xpum_device_engine_metric_t>();
-            }
-            engineUtilRawDataMap[engineType][engineUtilRawData.index].push_back(engineUtilRawData);
+        auto& data = engineUtilRawDataList[i];
+        if (!((p_this->tileId == -1) || (data.isTileData && (p_this->tileId == data.tileId)))) {
+            continue;
+        }
+        auto it = engineSlots.find(std::make_tuple((int)data.type, data.index, engineByTile ? data.tileId : -1));
+        // the first sample of an engine is taken
+        if (it == engineSlots.end() || present[it->second.first]) {
+            continue;
         }
+        values[it->second.first] = DumpValue(data.value, data.scale * it->second.second);
+        present[it->second.first] = true;
     }
 
     // get fabric raw data
-    fabricRawDataMap.clear();
-
     uint32_t fabricRawDataSize = 0;
     p_data_logic->getFabricThroughput(p_this->deviceId, nullptr, &fabricRawDataSize);
     std::vector<xpum_device_fabric_throughput_metric_t> fabricRawDataList(fabricRawDataSize);
     p_data_logic->getFabricThroughput(p_this->deviceId, fabricRawDataList.data(), &fabricRawDataSize);
-
-    for (auto fabricRawData : fabricRawDataList) {
-        std::stringstream ss;
-        if (fabricRawData.type == XPUM_FABRIC_THROUGHPUT_TYPE_TRANSMITTED) {
-            ss << p_this->deviceId << "/" << fabricRawData.tile_id;
-            ss << "->";
-            ss << fabricRawData.remote_device_id << "/" << fabricRawData.remote_device_tile_id;
-        } else if (fabricRawData.type == XPUM_FABRIC_THROUGHPUT_TYPE_RECEIVED) {
-            ss << fabricRawData.remote_device_id << "/" << fabricRawData.remote_device_tile_id;
-            ss << "->";
-            ss << p_this->deviceId << "/" << fabricRawData.tile_id;
-        } else {
+    for (uint32_t i = 0; i < fabricRawDataSize; i++) {
+        auto& data = fabricRawDataList[i];
+        auto it = fabricSlots.find(std::make_tuple(data.tile_id, data.remote_device_id, data.remote_device_tile_id, (int)data.type));
+        if (it == fabricSlots.end()) {
             continue;
         }
-        std::string key = ss.str();
-        fabricRawDataMap[key] = fabricRawData;
+        values[it->second.first] = DumpValue(data.value, data.scale * it->second.second);
+        present[it->second.first] = true;
     }
 }
 
@@ -452,28 +727,19 @@ void DumpRawDataTask::start() {
 
     begin = time(nullptr) * 1000;
 
+    DumpRotation rotation;
+    rotation.size = dumpOptions.rotateSize;
+    rotation.interval = dumpOptions.rotateInterval;
+    rotation.maxFiles = dumpOptions.maxFiles;
+    rotation.compress = dumpOptions.compress;
+    pWriter = std::make_shared<DumpFileWriter>(dumpFilePath, Configuration::DUMP_FLUSH_SIZE, Configuration::DUMP_FLUSH_INTERVAL, Configuration::DUMP_FSYNC, rotation);
+
     // write to file with header
     writeHeader();
 
     auto p_this = shared_from_this();
     lambda = [p_this]() {
-        // update data
-        p_this->updateData();
-
-        std::stringstream ss;
-
-        for (std::size_t i = 0; i < p_this->columnList.size(); i++) {
-            auto& dc = p_this->columnList[i];
-            auto value = dc.getValue();
-            if (value.empty())
-                value = "N/A";
-            ss << value;
-            if (i < p_this->columnList.size() - 1) {
-                ss << ",";
-            }
-        }
-
-        p_this->writeToFile(ss.str());
+        p_this->dumpRows();
     };
     // schedule task
     pThreadPoolTask = pThreadPool->scheduleAtFixedRate(0, Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE, -1, lambda);
@@ -484,13 +750,18 @@ void DumpRawDataTask::stop() {
         pThreadPoolTask->cancel();
         pThreadPoolTask.reset();
     }
+    // write out the pending rows, the file stays open for reschedule
+    if (pWriter != nullptr) {
+        pWriter->flush();
+    }
 }
 
 void DumpRawDataTask::reschedule() {
-    // stop task first
-    stop();
-    // reschedule the task to refresh the dump interval
-    pThreadPoolTask = pThreadPool->scheduleAtFixedRate(0, Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE, -1, lambda);
+    // re-arm the task in place with the new dump interval, no tick is lost
+    if (pThreadPoolTask == nullptr) {
+        return;
+    }
+    pThreadPool->reschedule(pThreadPoolTask, 0, Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE);
 }
 
 void DumpRawDataTask::fillTaskInfoBuffer(xpum_dump_raw_data_task_t* taskInfo) {
@@ -503,6 +774,25 @@ void DumpRawDataTask::fillTaskInfoBuffer(xpum_dump_raw_data_task_t* taskInfo) {
         buf[i] = dumpTypeList[i];
     }
     taskInfo->count = dumpTypeList.size();
+    taskInfo->deviceId = deviceId;
+    taskInfo->tileId = tileId;
+    taskInfo->deviceCount = 0;
+    for (auto id : deviceIdList) {
+        if (taskInfo->deviceCount >= XPUM_MAX_NUM_DEVICES) {
+            break;
+        }
+        taskInfo->deviceIdList[taskInfo->deviceCount++] = id;
+    }
+    std::string currentPath = dumpFilePath;
+    taskInfo->currentFileBytes = 0;
+    taskInfo->totalBytes = 0;
+    taskInfo->fileCount = 1;
+    if (pWriter != nullptr) {
+        pWriter->getStatus(currentPath, taskInfo->currentFileBytes, taskInfo->totalBytes, taskInfo->fileCount);
+    }
+    size = currentPath.copy(taskInfo->currentFilePath, XPUM_MAX_STR_LENGTH - 1);
+    taskInfo->currentFilePath[size] = '\0';
+    taskInfo->triggerCount = triggerCount.load();
 }
 
 } // namespace xpum
\ No newline at end of file
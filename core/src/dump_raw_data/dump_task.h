@@ -6,56 +6,114 @@
 
 #pragma once
 
-#include <fstream>
+#include <atomic>
+#include <deque>
+#include <functional>
 #include <map>
 #include <set>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "data_logic/data_logic_interface.h"
+#include "dump_writer.h"
+#include "event/events.h"
 #include "infrastructure/scheduled_thread_pool.h"
 #include "xpum_structs.h"
 
 namespace xpum {
 
-typedef std::function<std::string()> getValueFunc;
+// the value of a column in one row, divided by scale when it is written out
+struct DumpValue {
+    uint64_t value;
+    uint32_t scale;
+
+    DumpValue(uint64_t value = 0, uint32_t scale = 1)
+        : value(value),
+          scale(scale) {}
+};
+
+// how the value of a column is written out
+enum class DumpValueFormat {
+    SCALED,
+    TIMESTAMP,
+    INTEGER,
+    THROTTLE_REASONS,
+    // a RAS error counter, written out like SCALED, its increases are instant events in a trace
+    ERROR_COUNTER,
+};
 
 struct DumpColumn {
     std::string header;
-    getValueFunc getValue;
-    uint64_t lastTimestamp = 0;
+    DumpValueFormat format;
 
     DumpColumn(
         std::string header,
-        getValueFunc getValue)
+        DumpValueFormat format)
         : header(header),
-          getValue(getValue) {}
+          format(format) {}
 };
 
-class DumpRawDataTask : public std::enable_shared_from_this<DumpRawDataTask> {
+/*
+  DumpDeviceSource reads the raw data of one device or tile and provides the
+  columns of that device, a dump task samples one or more sources per tick.
+
+  Each column has a slot in the values of the source. The raw data is bound
+  to the slots when the columns are built, so updateData puts each sample
+  into its slot and a row is read out in one pass over the slots.
+*/
+
+class DumpDeviceSource {
    public:
-    xpum_dump_task_id_t taskId;
     xpum_device_id_t deviceId;
     xpum_device_tile_id_t tileId;
-    // std::vector<xpum_stats_type_t> metricsTypeList;
-    std::vector<xpum_dump_type_t> dumpTypeList;
-    std::string dumpFilePath;
-    uint64_t begin;
-    xpum_dump_raw_data_option_t dumpOptions;
+
+    std::vector<DumpColumn> columnList;
+
+    // the values of the columns for the current tick, by column
+    std::vector<DumpValue> values;
+
+    std::vector<bool> present;
 
    private:
-    std::shared_ptr<ScheduledThreadPool> pThreadPool;
-    std::shared_ptr<ScheduledThreadPoolTask> pThreadPoolTask;
-    std::function<void()> lambda;
+    // a column of a statistics metric, a value only counts once per timestamp unless repeated is set
+    struct StatsBinding {
+        xpum_stats_type_t metricsType;
+        uint32_t scale;
+        std::size_t slot;
+        bool repeated;
+        uint64_t lastTimestamp = 0;
 
-    std::shared_ptr<xpum::DataLogicInterface> p_data_logic;
+        StatsBinding(xpum_stats_type_t metricsType, uint32_t scale, std::size_t slot, bool repeated)
+            : metricsType(metricsType),
+              scale(scale),
+              slot(slot),
+              repeated(repeated) {}
+    };
 
-    std::vector<DumpColumn> columnList;
+    // the slot of a column and the scale of its value
+    typedef std::pair<std::size_t, uint32_t> SlotBinding;
+
+    std::vector<xpum_dump_type_t> dumpTypeList;
+
+    std::shared_ptr<xpum::DataLogicInterface> p_data_logic;
 
     std::map<xpum_stats_type_t, xpum_device_metric_data_t> rawDataMap;
-    std::map<xpum_engine_type_t, std::map<int, std::vector<xpum_device_engine_metric_t>>> engineUtilRawDataMap;
-    std::map<std::string, xpum_device_fabric_throughput_metric_t> fabricRawDataMap;
+
+    std::vector<StatsBinding> statsBindings;
+
+    // by engine type, engine index and tile id, the tile id is -1 unless the engines are split by tile
+    std::map<std::tuple<int, uint64_t, int32_t>, SlotBinding> engineSlots;
+
+    bool engineByTile = false;
+
+    // the device id and tile id columns come first and are not updated
+    std::size_t constantCount = 0;
+
+    // by local tile id, remote device id, remote tile id and direction
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t, int>, SlotBinding> fabricSlots;
 
     std::set<xpum_stats_type_t> sumMetricsList{ XPUM_STATS_MEMORY_READ,
                                                         XPUM_STATS_MEMORY_WRITE,
@@ -77,6 +135,95 @@ class DumpRawDataTask : public std::enable_shared_from_this<DumpRawDataTask> {
                                                         XPUM_STATS_POWER
                                                         };
 
+   public:
+    DumpDeviceSource(xpum_device_id_t deviceId,
+                     xpum_device_tile_id_t tileId,
+                     const std::vector<xpum_dump_type_t> &dumpTypeList,
+                     std::shared_ptr<xpum::DataLogicInterface> p_data_logic);
+
+    DumpDeviceSource(const DumpDeviceSource &) = delete;
+
+    DumpDeviceSource &operator=(const DumpDeviceSource &) = delete;
+
+    void buildColumns();
+
+    // fill the slots with the latest raw data
+    void updateData();
+
+    // the count of the leading device id and tile id columns
+    std::size_t getConstantCount() const {
+        return constantCount;
+    }
+
+   private:
+    std::size_t addColumn(const std::string &header, DumpValueFormat format);
+
+    void updateStats();
+};
+
+class DumpRawDataTask : public std::enable_shared_from_this<DumpRawDataTask> {
+   public:
+    xpum_dump_task_id_t taskId;
+    xpum_device_id_t deviceId;
+    xpum_device_tile_id_t tileId;
+    // all the devices dumped by the task, deviceId is the first of them
+    std::vector<xpum_device_id_t> deviceIdList;
+    // std::vector<xpum_stats_type_t> metricsTypeList;
+    std::vector<xpum_dump_type_t> dumpTypeList;
+    std::string dumpFilePath;
+    uint64_t begin;
+    xpum_dump_raw_data_option_t dumpOptions;
+
+   private:
+    std::shared_ptr<ScheduledThreadPool> pThreadPool;
+    std::shared_ptr<ScheduledThreadPoolTask> pThreadPoolTask;
+    std::function<void()> lambda;
+
+    std::shared_ptr<xpum::DataLogicInterface> p_data_logic;
+
+    std::vector<std::unique_ptr<DumpDeviceSource>> sources;
+
+    std::vector<DumpColumn> columns;
+
+    // the file column of each column of each source
+    std::vector<std::vector<std::size_t>> sourceColumnIndexes;
+
+    // the cells of the row being built
+    std::vector<DumpValue> cells;
+
+    std::vector<bool> cellPresent;
+
+    std::shared_ptr<DumpFileWriter> pWriter;
+
+    std::string rowBuffer;
+
+    // the rows of the last preTriggerTime seconds of a triggered task, by timestamp
+    std::deque<std::pair<uint64_t, std::string>> triggerRing;
+
+    // the time of the latest trigger not yet seen by the dump thread, 0 if none
+    std::atomic<uint64_t> pendingTrigger{0};
+
+    std::atomic<uint32_t> triggerCount{0};
+
+    // the rows are written out until this time after a trigger
+    uint64_t captureUntil = 0;
+
+    // the values of the previous tick of a trace, by source and column, to find the changes
+    std::vector<std::vector<DumpValue>> traceLastValues;
+
+    std::vector<std::vector<bool>> traceLastPresent;
+
+    // the policy triggers, health changes and diagnostics results not yet written out as instant events of a trace
+    struct TraceInstantEvent {
+        uint64_t time;
+        xpum_device_id_t deviceId;
+        std::string name;
+        std::string args;
+    };
+
+    std::vector<TraceInstantEvent> traceInstantEvents;
+
+    std::mutex traceInstantMutex;
 
    public:
     DumpRawDataTask(xpum_dump_task_id_t taskId,
@@ -95,12 +242,37 @@ class DumpRawDataTask : public std::enable_shared_from_this<DumpRawDataTask> {
 
     void fillTaskInfoBuffer(xpum_dump_raw_data_task_t *taskInfo);
 
-    void writeToFile(std::string text);
+    void writeToFile(const std::string &text);
 
     void writeHeader();
 
+    void appendCsvRow(std::string &row);
+
+    void appendBinaryRow(std::string &row);
+
+    // the trace events of one tick of all the sources
+    void appendTraceEvents(std::string &row, uint64_t timestamp);
+
     void buildColumns();
 
-    void updateData();
+    void dumpRows();
+
+    // a policy of the device is triggered, a triggered task writes out the rows it keeps,
+    // a trace gets an instant event
+    void trigger(xpum_device_id_t deviceId, xpum_policy_type_t type);
+
+    // the health of the device changed, a triggered task is triggered when it turns critical
+    void onHealthChanged(const HealthEvent &event);
+
+    // the diagnostics of the device are done, a triggered task is triggered when they failed
+    void onDiagnosticDone(const DiagnosticEvent &event);
+
+   private:
+    // the instant event of a trace, and the trigger of a triggered task if fire and the bit is selected
+    void notifyEvent(xpum_device_id_t deviceId, const std::string &name, const std::string &args, bool fire, uint32_t triggerBit);
+
+    void readSource(std::size_t index);
+
+    void captureRow(uint64_t timestamp, const std::string &row);
 };
-} // namespace xpum
\ No newline at end of file
+} // namespace xpum
@@ -0,0 +1,242 @@
+/* 
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file dump_writer.cpp
+ */
+
+#include "dump_writer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "infrastructure/logger.h"
+#include "infrastructure/utility.h"
+
+extern char** environ;
+
+namespace xpum {
+
+DumpFileWriter::DumpFileWriter(const std::string& path, std::size_t flushSize, long long flushInterval, bool sync,
+                               const DumpRotation& rotation)
+    : path(path),
+      flushSize(flushSize),
+      flushInterval(flushInterval),
+      sync(sync),
+      rotation(rotation),
+      fileFd(-1),
+      fd(-1),
+      compressor(-1),
+      fileIndex(0),
+      fileSince(0),
+      fileBytes(0),
+      totalBytes(0),
+      ownerKnown(false),
+      ownerUid(0),
+      ownerGid(0),
+      ownerMode(0644),
+      pendingSince(0) {
+    pending.reserve(flushSize);
+}
+
+DumpFileWriter::~DumpFileWriter() {
+    close();
+}
+
+std::string DumpFileWriter::getFilePath(uint32_t index) const {
+    std::string res = path;
+    if (index > 0) {
+        std::size_t slash = path.rfind('/');
+        std::size_t dot = path.rfind('.');
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+            dot = path.size();
+        }
+        res = path.substr(0, dot) + "." + std::to_string(index) + path.substr(dot);
+    }
+    if (rotation.compress) {
+        res += ".zst";
+    }
+    return res;
+}
+
+void DumpFileWriter::open() {
+    if (!ownerKnown) {
+        struct stat st;
+        if (stat(path.c_str(), &st) == 0) {
+            ownerUid = st.st_uid;
+            ownerGid = st.st_gid;
+            ownerMode = st.st_mode & 0777;
+            ownerKnown = true;
+            // the empty file created for the task is replaced by the compressed one
+            if (rotation.compress && st.st_size == 0) {
+                unlink(path.c_str());
+            }
+        }
+    }
+    currentPath = getFilePath(fileIndex);
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (rotation.compress ? O_TRUNC : O_APPEND);
+    fileFd = ::open(currentPath.c_str(), flags, ownerMode);
+    if (fileFd < 0) {
+        XPUM_LOG_ERROR("Failed to open dump file {}, errno: {}", currentPath, errno);
+        return;
+    }
+    if (ownerKnown && (fileIndex > 0 || rotation.compress)) {
+        if (fchown(fileFd, ownerUid, ownerGid) != 0 || fchmod(fileFd, ownerMode) != 0) {
+            XPUM_LOG_WARN("Failed to set the owner of dump file {}, errno: {}", currentPath, errno);
+        }
+    }
+    fd = fileFd;
+    if (rotation.compress) {
+        // a socket instead of a pipe, so a zstd that exits does not raise SIGPIPE
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+            XPUM_LOG_ERROR("Failed to create the pipe of dump file {}, errno: {}", currentPath, errno);
+            closeFile();
+            return;
+        }
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, fds[0], STDIN_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, fileFd, STDOUT_FILENO);
+        char arg0[] = "zstd";
+        char arg1[] = "-q";
+        char arg2[] = "-c";
+        char* argv[] = {arg0, arg1, arg2, nullptr};
+        int ret = posix_spawnp(&compressor, "zstd", &actions, nullptr, argv, environ);
+        posix_spawn_file_actions_destroy(&actions);
+        ::close(fds[0]);
+        if (ret != 0) {
+            XPUM_LOG_ERROR("Failed to start zstd for dump file {}, error: {}", currentPath, ret);
+            compressor = -1;
+            ::close(fds[1]);
+            closeFile();
+            return;
+        }
+        fd = fds[1];
+    }
+    fileSince = Utility::getCurrentMillisecond();
+    fileBytes = 0;
+    if (rotation.maxFiles > 0) {
+        files.push_back(currentPath);
+        while (files.size() > rotation.maxFiles) {
+            unlink(files.front().c_str());
+            files.pop_front();
+        }
+    }
+    if (!header.empty() && writeAll(header.data(), header.size())) {
+        fileBytes += header.size();
+        totalBytes += header.size();
+    }
+}
+
+void DumpFileWriter::closeFile() {
+    if (fd >= 0 && fd != fileFd) {
+        // zstd writes out the end of the frame when its input is closed
+        ::close(fd);
+        if (compressor > 0) {
+            int status;
+            while (waitpid(compressor, &status, 0) < 0 && errno == EINTR) {
+            }
+            compressor = -1;
+        }
+    }
+    if (fileFd >= 0) {
+        if (sync) {
+            ::fsync(fileFd);
+        }
+        ::close(fileFd);
+    }
+    fd = -1;
+    fileFd = -1;
+}
+
+bool DumpFileWriter::writeAll(const char* p, std::size_t left) {
+    while (left > 0) {
+        ssize_t n = fd == fileFd ? ::write(fd, p, left) : ::send(fd, p, left, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            XPUM_LOG_ERROR("Failed to write dump file {}, errno: {}", currentPath, errno);
+            return false;
+        }
+        p += n;
+        left -= n;
+    }
+    return true;
+}
+
+void DumpFileWriter::setHeader(const std::string& header) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->header = header;
+    if (fd < 0) {
+        open();
+    }
+}
+
+void DumpFileWriter::write(const char* data, std::size_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    long long now = Utility::getCurrentMillisecond();
+    if (pending.empty()) {
+        pendingSince = now;
+    }
+    pending.append(data, size);
+    if (pending.size() >= flushSize || now - pendingSince >= flushInterval) {
+        flushLocked();
+    }
+}
+
+void DumpFileWriter::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    flushLocked();
+}
+
+void DumpFileWriter::flushLocked() {
+    if (pending.empty()) {
+        return;
+    }
+    if (fd >= 0) {
+        // the pending data holds whole rows, so a file never ends inside a row
+        long long now = Utility::getCurrentMillisecond();
+        bool full = rotation.size > 0 && fileBytes > header.size() && fileBytes + pending.size() > rotation.size;
+        bool old = rotation.interval > 0 && now - fileSince >= (long long)rotation.interval * 1000;
+        if (full || old) {
+            closeFile();
+            fileIndex++;
+        }
+    }
+    if (fd < 0) {
+        open();
+    }
+    if (fd >= 0) {
+        if (writeAll(pending.data(), pending.size())) {
+            fileBytes += pending.size();
+            totalBytes += pending.size();
+        }
+        if (sync && fd == fileFd) {
+            ::fsync(fd);
+        }
+    }
+    // the buffer keeps its capacity for the next rows
+    pending.clear();
+}
+
+void DumpFileWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    flushLocked();
+    closeFile();
+}
+
+void DumpFileWriter::getStatus(std::string& currentPath, uint64_t& currentBytes, uint64_t& totalBytes, uint32_t& fileCount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    currentPath = this->currentPath.empty() ? getFilePath(fileIndex) : this->currentPath;
+    currentBytes = fileBytes;
+    totalBytes = this->totalBytes;
+    fileCount = fileIndex + 1;
+}
+
+} // namespace xpum
@@ -0,0 +1,122 @@
+/* 
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file dump_writer.h
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace xpum {
+
+// when the dump file is rotated and how it is stored, 0 means no limit
+struct DumpRotation {
+    uint64_t size = 0;
+    // seconds
+    uint32_t interval = 0;
+    uint32_t maxFiles = 0;
+    bool compress = false;
+};
+
+/*
+  DumpFileWriter keeps the dump file open and collects the output in memory.
+  The pending data is written out with one write call when it exceeds
+  flushSize bytes or when its oldest part is older than flushInterval ms,
+  and optionally synced to the disk after each write.
+
+  The output is split into files by the rotation: the first file is path,
+  the next ones have the index before the extension, like dump.1.csv. A new
+  file starts before a write would take the current one over the rotation
+  size, or when the current one is older than the rotation interval, and
+  begins with the header again, so every file is read on its own. With
+  compress the files are piped through a zstd process and get the .zst
+  suffix, the compression runs beside the dump thread instead of over the
+  whole file afterwards.
+*/
+
+class DumpFileWriter {
+   public:
+    DumpFileWriter(const std::string &path, std::size_t flushSize, long long flushInterval, bool sync,
+                   const DumpRotation &rotation = DumpRotation());
+
+    ~DumpFileWriter();
+
+    // the header is written now and at the start of every next file
+    void setHeader(const std::string &header);
+
+    void write(const char *data, std::size_t size);
+
+    void flush();
+
+    void close();
+
+    // the current file and the bytes written to it, the bytes of all files, and the count of files
+    void getStatus(std::string &currentPath, uint64_t &currentBytes, uint64_t &totalBytes, uint32_t &fileCount);
+
+   private:
+    void open();
+
+    void closeFile();
+
+    void flushLocked();
+
+    bool writeAll(const char *data, std::size_t size);
+
+    std::string getFilePath(uint32_t index) const;
+
+    std::string path;
+
+    std::size_t flushSize;
+
+    long long flushInterval;
+
+    bool sync;
+
+    DumpRotation rotation;
+
+    // the file on the disk, and where the data is written, the zstd input when compressing
+    int fileFd;
+
+    int fd;
+
+    pid_t compressor;
+
+    std::string header;
+
+    uint32_t fileIndex;
+
+    std::string currentPath;
+
+    long long fileSince;
+
+    uint64_t fileBytes;
+
+    uint64_t totalBytes;
+
+    // the files kept by maxFiles, the oldest first
+    std::deque<std::string> files;
+
+    // the owner and mode of the file created for the task, the next files get the same
+    bool ownerKnown;
+
+    uid_t ownerUid;
+
+    gid_t ownerGid;
+
+    mode_t ownerMode;
+
+    std::string pending;
+
+    long long pendingSince;
+
+    std::mutex mutex;
+};
+
+} // namespace xpum
@@ -0,0 +1,325 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file event_bus.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "infrastructure/internal_stats.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+/*
+  Bounded multi-producer single-consumer queue, after the bounded MPMC queue
+  of Dmitry Vyukov: every slot has a sequence number telling whether it is
+  free for the producer at a position or filled for the consumer. Producers
+  claim a position with a CAS on head and never wait: push fails when the
+  queue is full.
+*/
+template <typename T>
+class EventQueue {
+   public:
+    explicit EventQueue(size_t capacity)
+        : slots(new Slot[roundUpPowerOfTwo(capacity)]), mask(roundUpPowerOfTwo(capacity) - 1), head(0), tail(0) {
+        for (size_t i = 0; i <= mask; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    EventQueue(const EventQueue&) = delete;
+
+    EventQueue& operator=(const EventQueue&) = delete;
+
+    // any thread
+    bool push(const T& value) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[pos & mask];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = value;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only
+    bool pop(T& value) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Slot& slot = slots[pos & mask];
+        if ((intptr_t)slot.sequence.load(std::memory_order_acquire) - (intptr_t)(pos + 1) < 0) {
+            return false;
+        }
+        value = std::move(slot.value);
+        slot.sequence.store(pos + mask + 1, std::memory_order_release);
+        tail.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+   private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t roundUpPowerOfTwo(size_t n) {
+        size_t ret = 1;
+        while (ret < n) {
+            ret <<= 1;
+        }
+        return ret;
+    }
+
+    std::unique_ptr<Slot[]> slots;
+
+    const size_t mask;
+
+    // head and tail are written by different threads, keep them on separate cache lines
+    alignas(64) std::atomic<size_t> head;
+
+    alignas(64) std::atomic<size_t> tail;
+};
+
+/*
+  EventBus carries the events of type E from any thread to the subscribers of
+  the type, one bus per type. Every subscriber has its own bounded queue, so
+  a slow subscriber only loses its own events and never holds up the thread
+  publishing them: an event that does not fit the queue of a subscriber is
+  dropped and counted for it. publish does not take the mutex of the bus, it
+  reads the subscriber list by std::atomic_load, which libstdc++ guards with
+  a short spinlock, so it is not lock-free.
+
+  The delivery time from publish to pop of each subscriber is kept in the
+  internal statistics as XPUM_INTERNAL_STATS_EVENT_DELIVERY, its error count
+  is the dropped events.
+*/
+template <typename E>
+class EventBus {
+   public:
+    class Subscription {
+       public:
+        // name must be a string literal
+        Subscription(const char* name, size_t capacity) : name(name), queue(capacity) {}
+
+        Subscription(const Subscription&) = delete;
+
+        Subscription& operator=(const Subscription&) = delete;
+
+        /*
+          Take the oldest event, waiting up to timeout for one. Return false
+          on timeout, or when the subscription is closed and empty. Only one
+          thread may pop.
+        */
+        bool pop(E& event, std::chrono::milliseconds timeout) {
+            Envelope envelope;
+            if (!queue.pop(envelope)) {
+                std::unique_lock<std::mutex> lock(mutex);
+                waiting.store(true);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                bool popped = false;
+                cv.wait_for(lock, timeout, [&]() {
+                    popped = queue.pop(envelope);
+                    return popped || closed.load();
+                });
+                waiting.store(false);
+                if (!popped) {
+                    return false;
+                }
+            }
+            auto now = std::chrono::steady_clock::now().time_since_epoch();
+            InternalStats::instance().record(XPUM_INTERNAL_STATS_EVENT_DELIVERY, name, -1,
+                                             std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() - envelope.published_ns);
+            event = std::move(envelope.event);
+            return true;
+        }
+
+        // wake the popping thread, pop returns the events left and then false
+        void close() {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed.store(true);
+            cv.notify_all();
+        }
+
+        bool isClosed() const {
+            return closed.load();
+        }
+
+        uint64_t getDropped() const {
+            return dropped.load(std::memory_order_relaxed);
+        }
+
+        const char* getName() const {
+            return name;
+        }
+
+       private:
+        friend class EventBus;
+
+        struct Envelope {
+            E event;
+            uint64_t published_ns = 0;
+        };
+
+        void deliver(const Envelope& envelope) {
+            if (!queue.push(envelope)) {
+                uint64_t count = dropped.fetch_add(1, std::memory_order_relaxed) + 1;
+                InternalStats::instance().recordError(XPUM_INTERNAL_STATS_EVENT_DELIVERY, name, -1);
+                // at the first drop and then at every power of two
+                if ((count & (count - 1)) == 0) {
+                    XPUM_LOG_WARN("Event subscriber {} is behind, {} events are dropped", name, count);
+                }
+                return;
+            }
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiting.load()) {
+                std::lock_guard<std::mutex> lock(mutex);
+                cv.notify_one();
+            }
+        }
+
+        const char* name;
+
+        EventQueue<Envelope> queue;
+
+        std::atomic<uint64_t> dropped{0};
+
+        std::atomic<bool> waiting{false};
+
+        std::atomic<bool> closed{false};
+
+        // only taken to sleep and to wake a sleeping consumer
+        std::mutex mutex;
+
+        std::condition_variable cv;
+    };
+
+    static EventBus& instance() {
+        static EventBus bus;
+        return bus;
+    }
+
+    // name must be a string literal, capacity is the number of events kept for the subscriber
+    std::shared_ptr<Subscription> subscribe(const char* name, size_t capacity) {
+        auto p_subscription = std::make_shared<Subscription>(name, capacity);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto p_list = std::make_shared<SubscriptionList>(*std::atomic_load(&subscriptions));
+        p_list->push_back(p_subscription);
+        std::atomic_store(&subscriptions, std::shared_ptr<const SubscriptionList>(p_list));
+        return p_subscription;
+    }
+
+    // the subscription gets no new events and is closed, a publish already running may still deliver one
+    void unsubscribe(const std::shared_ptr<Subscription>& p_subscription) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto p_list = std::make_shared<SubscriptionList>();
+            for (auto& p : *std::atomic_load(&subscriptions)) {
+                if (p != p_subscription) {
+                    p_list->push_back(p);
+                }
+            }
+            std::atomic_store(&subscriptions, std::shared_ptr<const SubscriptionList>(p_list));
+        }
+        p_subscription->close();
+    }
+
+    void publish(const E& event) {
+        auto p_list = std::atomic_load(&subscriptions);
+        if (p_list->empty()) {
+            return;
+        }
+        typename Subscription::Envelope envelope;
+        envelope.event = event;
+        envelope.published_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now().time_since_epoch())
+                                    .count();
+        for (auto& p_subscription : *p_list) {
+            p_subscription->deliver(envelope);
+        }
+    }
+
+   private:
+    typedef std::vector<std::shared_ptr<Subscription>> SubscriptionList;
+
+    EventBus() : subscriptions(std::make_shared<const SubscriptionList>()) {}
+
+    // serializes subscribe and unsubscribe, publish reads the list without it
+    std::mutex mutex;
+
+    std::shared_ptr<const SubscriptionList> subscriptions;
+};
+
+/*
+  EventDispatcher subscribes to the bus of E and calls the handler with every
+  event in its own thread, for subscribers that may block or take long.
+*/
+template <typename E>
+class EventDispatcher {
+   public:
+    // name must be a string literal
+    EventDispatcher(const char* name, size_t capacity, std::function<void(const E&)> handler)
+        : p_subscription(EventBus<E>::instance().subscribe(name, capacity)), handler(handler) {
+        worker = std::thread([this]() {
+            E event;
+            while (true) {
+                if (p_subscription->pop(event, std::chrono::milliseconds(1000))) {
+                    this->handler(event);
+                } else if (p_subscription->isClosed()) {
+                    break;
+                }
+            }
+        });
+    }
+
+    ~EventDispatcher() {
+        stop();
+    }
+
+    EventDispatcher(const EventDispatcher&) = delete;
+
+    EventDispatcher& operator=(const EventDispatcher&) = delete;
+
+    // the events already queued are handled before return
+    void stop() {
+        EventBus<E>::instance().unsubscribe(p_subscription);
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+   private:
+    std::shared_ptr<typename EventBus<E>::Subscription> p_subscription;
+
+    std::function<void(const E&)> handler;
+
+    std::thread worker;
+};
+
+} // end namespace xpum
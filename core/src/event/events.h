@@ -0,0 +1,64 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file events.h
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "level_zero/zes_api.h"
+#include "xpum_structs.h"
+
+namespace xpum {
+
+/*
+  The events published on the event bus, one bus per type.
+*/
+
+// a policy is triggered, notifyCallBack is the callback of the policy if it has one
+struct PolicyEvent {
+    xpum_policy_notify_callback_para_t para;
+    xpum_notify_callback_ptr_t notifyCallBack = nullptr;
+};
+
+// the evaluated health of a component of a device differs from the one before
+struct HealthEvent {
+    xpum_device_id_t deviceId = 0;
+    xpum_health_type_t type = XPUM_HEALTH_CORE_THERMAL;
+    xpum_health_status_t status = XPUM_HEALTH_STATUS_UNKNOWN;
+    xpum_health_status_t previousStatus = XPUM_HEALTH_STATUS_UNKNOWN;
+    uint64_t timestamp = 0;
+};
+
+// the status of a fabric port of a device differs from the one read before
+struct FabricPortEvent {
+    xpum_device_id_t deviceId = 0;
+    zes_fabric_port_id_t portId = {};
+    zes_fabric_port_status_t status = ZES_FABRIC_PORT_STATUS_UNKNOWN;
+    zes_fabric_port_status_t previousStatus = ZES_FABRIC_PORT_STATUS_UNKNOWN;
+    uint64_t timestamp = 0;
+};
+
+// all diagnostics of a device are done
+struct DiagnosticEvent {
+    xpum_device_id_t deviceId = 0;
+    xpum_diag_task_result_t result = XPUM_DIAG_RESULT_UNKNOWN;
+    uint64_t timestamp = 0;
+};
+
+enum TaskProgressSource {
+    TASK_PROGRESS_FIRMWARE_FLASH,
+    TASK_PROGRESS_DIAGNOSTICS,
+    TASK_PROGRESS_SOURCE_MAX,
+};
+
+// the progress of a firmware flash or of the diagnostics changes, deviceId is -1 if the task is not of one device
+struct TaskProgressEvent {
+    TaskProgressSource source = TASK_PROGRESS_FIRMWARE_FLASH;
+    xpum_device_id_t deviceId = -1;
+    uint64_t timestamp = 0;
+};
+
+} // end namespace xpum
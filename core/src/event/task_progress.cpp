@@ -0,0 +1,71 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file task_progress.cpp
+ */
+
+#include "task_progress.h"
+
+#include "infrastructure/utility.h"
+
+namespace xpum {
+
+void publishTaskProgress(TaskProgressSource source, xpum_device_id_t deviceId) {
+    TaskProgressEvent event;
+    event.source = source;
+    event.deviceId = deviceId;
+    event.timestamp = Utility::getCurrentMillisecond();
+    EventBus<TaskProgressEvent>::instance().publish(event);
+}
+
+TaskProgress& TaskProgress::instance() {
+    static TaskProgress progress;
+    return progress;
+}
+
+TaskProgress::TaskProgress() {
+    p_dispatcher.reset(new EventDispatcher<TaskProgressEvent>("task_progress", 256, [this](const TaskProgressEvent& event) {
+        handle(event);
+    }));
+}
+
+void TaskProgress::handle(const TaskProgressEvent& event) {
+    if (event.source < 0 || event.source >= TASK_PROGRESS_SOURCE_MAX) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    counts[std::make_pair(event.source, event.deviceId)]++;
+    totals[event.source]++;
+    cv.notify_all();
+}
+
+uint64_t TaskProgress::getGeneration(TaskProgressSource source, xpum_device_id_t deviceId) {
+    if (deviceId == -1) {
+        return totals[source];
+    }
+    uint64_t generation = 0;
+    auto it = counts.find(std::make_pair(source, deviceId));
+    if (it != counts.end()) {
+        generation += it->second;
+    }
+    it = counts.find(std::make_pair(source, -1));
+    if (it != counts.end()) {
+        generation += it->second;
+    }
+    return generation;
+}
+
+uint64_t TaskProgress::wait(TaskProgressSource source, xpum_device_id_t deviceId, uint64_t generation, uint32_t timeout) {
+    if (source < 0 || source >= TASK_PROGRESS_SOURCE_MAX) {
+        return generation;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t current = generation;
+    cv.wait_for(lock, std::chrono::milliseconds(timeout), [&]() {
+        current = getGeneration(source, deviceId);
+        return current != generation;
+    });
+    return current;
+}
+
+} // end namespace xpum
@@ -0,0 +1,56 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file task_progress.h
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "event_bus.h"
+#include "events.h"
+
+namespace xpum {
+
+// publish a TaskProgressEvent of the device, -1 for a task not of one device
+void publishTaskProgress(TaskProgressSource source, xpum_device_id_t deviceId);
+
+/*
+  TaskProgress counts the TaskProgressEvents of each device, so a thread
+  streaming the progress of a task sleeps until the task moves instead of
+  polling its result. The generation of a device also counts the events of
+  the tasks not of one device, and the generation of -1 counts all the
+  events of the source.
+*/
+class TaskProgress {
+   public:
+    static TaskProgress& instance();
+
+    // wait up to timeout ms for a generation other than generation, return the generation then
+    uint64_t wait(TaskProgressSource source, xpum_device_id_t deviceId, uint64_t generation, uint32_t timeout);
+
+   private:
+    TaskProgress();
+
+    void handle(const TaskProgressEvent& event);
+
+    uint64_t getGeneration(TaskProgressSource source, xpum_device_id_t deviceId);
+
+    std::mutex mutex;
+
+    std::condition_variable cv;
+
+    // by source and device
+    std::map<std::pair<TaskProgressSource, xpum_device_id_t>, uint64_t> counts;
+
+    uint64_t totals[TASK_PROGRESS_SOURCE_MAX] = {};
+
+    std::unique_ptr<EventDispatcher<TaskProgressEvent>> p_dispatcher;
+};
+
+} // end namespace xpum
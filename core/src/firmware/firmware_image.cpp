@@ -0,0 +1,215 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file firmware_image.cpp
+ */
+
+#include "firmware_image.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static inline uint32_t rotr(uint32_t x, uint32_t n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+static void sha256Block(uint32_t* h, const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 | (uint32_t)block[i * 4 + 2] << 8 | (uint32_t)block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = k + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        k = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+    h[5] += f;
+    h[6] += g;
+    h[7] += k;
+}
+
+std::string sha256Of(const uint8_t* data, size_t size) {
+    uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    size_t full = size - size % 64;
+    for (size_t i = 0; i < full; i += 64) {
+        sha256Block(h, data + i);
+    }
+    // the last bytes, the 0x80 end mark and the bit length, in one or two blocks
+    uint8_t tail[128] = {};
+    size_t rest = size - full;
+    if (rest > 0) {
+        memcpy(tail, data + full, rest);
+    }
+    tail[rest] = 0x80;
+    size_t tail_size = rest < 56 ? 64 : 128;
+    uint64_t bits = (uint64_t)size * 8;
+    for (int i = 0; i < 8; i++) {
+        tail[tail_size - 1 - i] = (uint8_t)(bits >> (i * 8));
+    }
+    for (size_t i = 0; i < tail_size; i += 64) {
+        sha256Block(h, tail + i);
+    }
+
+    static const char hex[] = "0123456789abcdef";
+    std::string res;
+    for (int i = 0; i < 8; i++) {
+        for (int j = 28; j >= 0; j -= 4) {
+            res += hex[(h[i] >> j) & 0xf];
+        }
+    }
+    return res;
+}
+
+FirmwareImage::FirmwareImage(void* addr, size_t length) : addr(addr), length(length) {
+    sha256 = sha256Of(data(), size());
+}
+
+FirmwareImage::~FirmwareImage() {
+    munmap(addr, length);
+}
+
+int FirmwareImage::getType(uint8_t& type) {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (!type_parsed) {
+        type_ret = igsc_image_get_type(data(), size(), &this->type);
+        type_parsed = true;
+    }
+    type = this->type;
+    return type_ret;
+}
+
+int FirmwareImage::getFwVersion(struct igsc_fw_version& version) {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (!fw_version_parsed) {
+        fw_version_ret = igsc_image_fw_version(data(), size(), &fw_version);
+        fw_version_parsed = true;
+    }
+    version = fw_version;
+    return fw_version_ret;
+}
+
+int FirmwareImage::getHwConfig(struct igsc_hw_config& config) {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (!hw_config_parsed) {
+        hw_config_ret = igsc_image_hw_config(data(), size(), &hw_config);
+        hw_config_parsed = true;
+    }
+    config = hw_config;
+    return hw_config_ret;
+}
+
+FirmwareImageCache& FirmwareImageCache::instance() {
+    static FirmwareImageCache cache;
+    return cache;
+}
+
+void FirmwareImageCache::keep(const std::shared_ptr<FirmwareImage>& image) {
+    images.remove(image);
+    images.push_front(image);
+    while (images.size() > Configuration::FIRMWARE_IMAGE_CACHE_SIZE) {
+        auto last = images.back();
+        images.pop_back();
+        for (auto it = files.begin(); it != files.end();) {
+            if (it->second.second == last) {
+                it = files.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+std::shared_ptr<FirmwareImage> FirmwareImageCache::load(const std::string& filePath) {
+    static const std::string hashPrefix = "sha256:";
+    std::lock_guard<std::mutex> lck(mtx);
+    if (filePath.compare(0, hashPrefix.size(), hashPrefix) == 0) {
+        std::string hash = filePath.substr(hashPrefix.size());
+        std::transform(hash.begin(), hash.end(), hash.begin(), ::tolower);
+        for (auto& image : images) {
+            if (image->getSha256() == hash) {
+                auto res = image;
+                keep(res);
+                return res;
+            }
+        }
+        XPUM_LOG_WARN("No firmware image with sha256 {} is loaded", hash);
+        return nullptr;
+    }
+
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+    FileKey key = {st.st_dev, st.st_ino, st.st_size, (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec};
+    auto it = files.find(filePath);
+    if (it != files.end() && it->second.first == key) {
+        close(fd);
+        auto res = it->second.second;
+        keep(res);
+        return res;
+    }
+
+    void* addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        XPUM_LOG_ERROR("Failed to map the firmware image {}", filePath);
+        return nullptr;
+    }
+    auto image = std::make_shared<FirmwareImage>(addr, st.st_size);
+    // the same content from another path is shared
+    for (auto& other : images) {
+        if (other->getSha256() == image->getSha256()) {
+            image = other;
+            break;
+        }
+    }
+    XPUM_LOG_INFO("Firmware image {} loaded, sha256 {}", filePath, image->getSha256());
+    files[filePath] = std::make_pair(key, image);
+    keep(image);
+    return image;
+}
+
+} // namespace xpum
@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file firmware_image.h
+ */
+
+#pragma once
+
+#include <igsc_lib.h>
+#include <sys/types.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace xpum {
+
+/*
+  FirmwareImage is a firmware image file mapped in memory. It is shared by
+  the validations and the flashes of all devices, and the igsc parse results
+  of the image are kept after the first call.
+*/
+class FirmwareImage {
+   public:
+    FirmwareImage(void* addr, size_t length);
+
+    ~FirmwareImage();
+
+    const uint8_t* data() const {
+        return static_cast<const uint8_t*>(addr);
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    // the lowercase hex SHA-256 of the content
+    const std::string& getSha256() const {
+        return sha256;
+    }
+
+    // igsc_image_get_type() of the image
+    int getType(uint8_t& type);
+
+    // igsc_image_fw_version() of the image
+    int getFwVersion(struct igsc_fw_version& version);
+
+    // igsc_image_hw_config() of the image
+    int getHwConfig(struct igsc_hw_config& config);
+
+   private:
+    void* addr;
+
+    size_t length;
+
+    std::string sha256;
+
+    std::mutex mtx;
+
+    bool type_parsed = false;
+    int type_ret = 0;
+    uint8_t type = 0;
+
+    bool fw_version_parsed = false;
+    int fw_version_ret = 0;
+    struct igsc_fw_version fw_version = {};
+
+    bool hw_config_parsed = false;
+    int hw_config_ret = 0;
+    struct igsc_hw_config hw_config = {};
+};
+
+/*
+  FirmwareImageCache keeps the images flashed recently, keyed by their
+  SHA-256. A file is mapped and hashed again only when it changes, and a
+  request can give "sha256:<hash>" instead of the path of an image flashed
+  before, so the image does not have to be copied to the node again.
+*/
+class FirmwareImageCache {
+   public:
+    static FirmwareImageCache& instance();
+
+    // the image of filePath or of "sha256:<hash>", nullptr if it can not be read
+    std::shared_ptr<FirmwareImage> load(const std::string& filePath);
+
+   private:
+    struct FileKey {
+        dev_t dev;
+        ino_t ino;
+        off_t size;
+        int64_t mtime_nsec;
+
+        bool operator==(const FileKey& other) const {
+            return dev == other.dev && ino == other.ino && size == other.size && mtime_nsec == other.mtime_nsec;
+        }
+    };
+
+    void keep(const std::shared_ptr<FirmwareImage>& image);
+
+    std::mutex mtx;
+
+    std::map<std::string, std::pair<FileKey, std::shared_ptr<FirmwareImage>>> files;
+
+    // the most recently used image first
+    std::list<std::shared_ptr<FirmwareImage>> images;
+};
+
+std::string sha256Of(const uint8_t* data, size_t size);
+
+} // namespace xpum
@@ -9,19 +9,24 @@
 #include "fwdata_mgmt.h"
 #include "fwcodedata_mgmt.h"
 #include "psc_mgmt.h"
+#include "mei_firmware_info.h"
 #include "group/group_manager.h"
 #include "api/device_model.h"
 #include "amc/ipmi_amc_manager.h"
-#include "amc/redfish_amc_manager.h"
+#include "redfish/redfish_plugin.h"
 #include "igsc_err_msg.h"
+#include "event/task_progress.h"
+#include "infrastructure/configuration.h"
 #include "infrastructure/utility.h"
 #include "infrastructure/logger.h"
+#include "infrastructure/plugin_loader.h"
 #include "device/skuType.h"
 
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <regex>
+#include <set>
 #include <igsc_lib.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -32,6 +37,7 @@ namespace xpum {
 using namespace std::chrono_literals;
 
 static std::vector<std::shared_ptr<Device>> getSiblingDevices(std::shared_ptr<Device> pDevice);
+static std::vector<FlashGroup> groupSiblingDevices(const std::vector<std::shared_ptr<Device>>& deviceList);
 
 SystemCommandResult execCommand(const std::string& command) {
     int exitcode = 0;
@@ -69,24 +75,12 @@ static std::string print_fw_version(const struct igsc_fw_version* fw_version) {
 }
 
 static std::string getGfxVersionByMeiDevice(std::string meiDevicePath) {
-    int ret;
-    struct igsc_device_handle handle;
-    struct igsc_fw_version fw_version;
-    std::string res = "unknown";
-    ret = igsc_device_init_by_device(&handle, meiDevicePath.c_str());
-    if (ret != IGSC_SUCCESS) {
-        return res;
-    }
-
-    ret = igsc_device_fw_version(&handle, &fw_version);
-    if (ret == IGSC_SUCCESS) {
-        res = print_fw_version(&fw_version);
-    } else {
+    auto p_versions = MeiFirmwareInfo::instance().get(meiDevicePath, MEI_FW_GFX_VERSION);
+    if (!p_versions->has(MEI_FW_GFX_VERSION)) {
         XPUM_LOG_ERROR("Fail to get SoC fw version from device: {}", meiDevicePath);
+        return "unknown";
     }
-    /* make sure we have a printable name */
-    (void)igsc_device_close(&handle);
-    return res;
+    return print_fw_version(&p_versions->fw_version);
 }
 
 void FirmwareManager::init() {
@@ -101,6 +95,18 @@ void FirmwareManager::init() {
     Utility::parallel_in_batches(devices.size(), devices.size(), [&](int start, int end) {
         for (int i = start; i < end; ++i) {
             auto pDevice = devices.at(i);
+            // all the versions the managers below ask for, read in one MEI session
+            uint32_t components = MEI_FW_GFX_VERSION;
+            Property prop;
+            // nothing but the GFX version is read for a VF
+            if (pDevice->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_DEVICE_FUNCTION_TYPE, prop) && prop.getValueInt() == DEVICE_FUNCTION_TYPE_VIRTUAL) {
+                components = MEI_FW_GFX_VERSION;
+            } else if (pDevice->getDeviceModel() == XPUM_DEVICE_MODEL_ATS_M_1 || pDevice->getDeviceModel() == XPUM_DEVICE_MODEL_ATS_M_3 || pDevice->getDeviceModel() == XPUM_DEVICE_MODEL_ATS_M_1G) {
+                components |= MEI_FW_HW_CONFIG | MEI_FW_DEVICE_INFO | MEI_FW_DATA_VERSION;
+            } else if (pDevice->getDeviceModel() == XPUM_DEVICE_MODEL_PVC) {
+                components |= MEI_FW_PSC_VERSION;
+            }
+            MeiFirmwareInfo::instance().get(pDevice->getMeiDevicePath(), components);
             // GFX fw version
             auto gfxFwVersion = getGfxVersionByMeiDevice(pDevice->getMeiDevicePath());
             pDevice->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_GFX_FIRMWARE_VERSION, gfxFwVersion));
@@ -129,12 +135,25 @@ void FirmwareManager::init() {
     }
 };
 
+static std::shared_ptr<AmcManager> createRedfishAmcManager() {
+    RedfishPluginContext context{spdlog::default_logger()};
+#ifdef XPUM_REDFISH_PLUGIN
+    auto create = reinterpret_cast<CreateRedfishAmcManagerFunc>(PluginLoader::getSymbol("redfish", XPUM_CREATE_REDFISH_AMC_MANAGER_SYMBOL));
+    if (create == nullptr) {
+        return std::make_shared<UnavailableAmcManager>();
+    }
+#else
+    CreateRedfishAmcManagerFunc create = xpum_create_redfish_amc_manager;
+#endif
+    return std::shared_ptr<AmcManager>(create(context));
+}
+
 void FirmwareManager::preInitAmcManager() {
     p_amc_manager = std::make_shared<IpmiAmcManager>();
     auto ipmi_enabled = p_amc_manager->preInit();
     XPUM_LOG_DEBUG("Finish IPMI scan AMC");
     if (!ipmi_enabled) {
-        p_amc_manager = RedfishAmcManager::instance();
+        p_amc_manager = createRedfishAmcManager();
         p_amc_manager->preInit();
     }
 }
@@ -225,13 +244,27 @@ xpum_result_t FirmwareManager::getAMCFirmwareFlashResult(xpum_firmware_flash_tas
 std::string FirmwareManager::getAmcWarnMsg() {
     if (p_amc_manager)
         return "";
-    return getRedfishAmcWarn();
+    RedfishPluginContext context{spdlog::default_logger()};
+#ifdef XPUM_REDFISH_PLUGIN
+    auto getWarn = reinterpret_cast<GetRedfishAmcWarnFunc>(PluginLoader::getSymbol("redfish", XPUM_GET_REDFISH_AMC_WARN_SYMBOL));
+    if (getWarn == nullptr) {
+        return "";
+    }
+#else
+    GetRedfishAmcWarnFunc getWarn = xpum_get_redfish_amc_warn;
+#endif
+    std::string warn;
+    getWarn(context, warn);
+    return warn;
 }
 
-static bool isGscFwImage(std::vector<char>& buffer) {
+static bool isGscFwImage(std::shared_ptr<FirmwareImage>& image) {
+    if (image == nullptr) {
+        return false;
+    }
     uint8_t type;
     int ret;
-    ret = igsc_image_get_type((const uint8_t*)buffer.data(), buffer.size(), &type);
+    ret = image->getType(type);
     if (ret != IGSC_SUCCESS)
     {
         return false;
@@ -239,73 +272,45 @@ static bool isGscFwImage(std::vector<char>& buffer) {
     return type == IGSC_IMAGE_TYPE_GFX_FW;
 }
 
-xpum_result_t FirmwareManager::atsmHwConfigCompatibleCheck(std::string meiPath, std::vector<char>& buffer) {
-    struct igsc_hw_config img_hw_config, dev_hw_config;
+xpum_result_t FirmwareManager::atsmHwConfigCompatibleCheck(std::string meiPath, std::shared_ptr<FirmwareImage>& image) {
+    struct igsc_hw_config img_hw_config;
     int ret;
 
-    struct igsc_device_handle handle;
-
-    memset(&handle, 0, sizeof(handle));
-    ret = igsc_device_init_by_device(&handle, meiPath.c_str());
-    if (ret != IGSC_SUCCESS) {
-        flashFwErrMsg = "Fail to init device: " + meiPath;
-        (void)igsc_device_close(&handle);
-        return XPUM_GENERIC_ERROR;
-    }
-
     // image hw config
-    ret = igsc_image_hw_config((const uint8_t*)buffer.data(), buffer.size(), &img_hw_config);
+    ret = image->getHwConfig(img_hw_config);
     if (ret != IGSC_SUCCESS) {
-        flashFwErrMsg = "Fail to parse image hardware config. " + print_device_fw_status(&handle);
-        (void)igsc_device_close(&handle);
+        flashFwErrMsg = "Fail to parse image hardware config.";
         return XPUM_GENERIC_ERROR;
     }
 
     // device hw config
-    ret = igsc_device_hw_config(&handle, &dev_hw_config);
-    if (ret != IGSC_SUCCESS) {
-        flashFwErrMsg = "Fail to get device hardware config. " + print_device_fw_status(&handle);
-        (void)igsc_device_close(&handle);
+    auto p_versions = MeiFirmwareInfo::instance().get(meiPath, MEI_FW_HW_CONFIG);
+    if (!p_versions->has(MEI_FW_HW_CONFIG)) {
+        flashFwErrMsg = p_versions->errorStatus.empty() ? "Fail to init device: " + meiPath : "Fail to get device hardware config. " + p_versions->errorStatus;
         return XPUM_GENERIC_ERROR;
     }
 
-    (void)igsc_device_close(&handle);
-
-    ret = igsc_hw_config_compatible(&img_hw_config, &dev_hw_config);
+    ret = igsc_hw_config_compatible(&img_hw_config, &p_versions->hw_config);
     return ret == IGSC_SUCCESS ? XPUM_OK : XPUM_UPDATE_FIRMWARE_FW_IMAGE_NOT_COMPATIBLE_WITH_DEVICE;
 }
 
-xpum_result_t FirmwareManager::isPVCFwImageAndDeviceCompatible(std::string meiPath, std::vector<char>& buffer) {
-    struct igsc_fw_version img_fw_version, dev_fw_version;
+xpum_result_t FirmwareManager::isPVCFwImageAndDeviceCompatible(std::string meiPath, std::shared_ptr<FirmwareImage>& image) {
+    struct igsc_fw_version img_fw_version;
     int ret;
 
-    struct igsc_device_handle handle;
-
-    memset(&handle, 0, sizeof(handle));
-    ret = igsc_device_init_by_device(&handle, meiPath.c_str());
-    if (ret != IGSC_SUCCESS) {
-        flashFwErrMsg = "Fail to init device: " + meiPath;
-        (void)igsc_device_close(&handle);
-        return XPUM_GENERIC_ERROR;
-    }
-
     // image fw version
-    ret = igsc_image_fw_version((const uint8_t*)buffer.data(), buffer.size(), &img_fw_version);
+    ret = image->getFwVersion(img_fw_version);
     if (ret != IGSC_SUCCESS) {
-        flashFwErrMsg = "Fail to parse image firmware version. " + print_device_fw_status(&handle);
-        (void)igsc_device_close(&handle);
+        flashFwErrMsg = "Fail to parse image firmware version.";
         return XPUM_GENERIC_ERROR;
     }
     // device fw version
-    memset(&dev_fw_version, 0, sizeof(dev_fw_version));
-    ret = igsc_device_fw_version(&handle, &dev_fw_version);
-    if (ret != IGSC_SUCCESS) {
-        flashFwErrMsg = "Fail to get device firmware version. " + print_device_fw_status(&handle);
-        (void)igsc_device_close(&handle);
+    auto p_versions = MeiFirmwareInfo::instance().get(meiPath, MEI_FW_GFX_VERSION);
+    if (!p_versions->has(MEI_FW_GFX_VERSION)) {
+        flashFwErrMsg = p_versions->errorStatus.empty() ? "Fail to init device: " + meiPath : "Fail to get device firmware version. " + p_versions->errorStatus;
         return XPUM_GENERIC_ERROR;
     }
-
-    (void)igsc_device_close(&handle);
+    auto& dev_fw_version = p_versions->fw_version;
 
     if (std::equal(std::begin(dev_fw_version.project), std::end(dev_fw_version.project), std::begin(img_fw_version.project))) {
         return XPUM_OK;
@@ -315,41 +320,31 @@ xpum_result_t FirmwareManager::isPVCFwImageAndDeviceCompatible(std::string meiPa
 }
 
 std::vector<char> readImageContent(const char* filePath) {
-    struct stat s;
-    if (stat(filePath, &s) != 0 || !(s.st_mode & S_IFREG))
-        return std::vector<char>();
-    std::ifstream is(std::string(filePath), std::ifstream::binary);
-    if (!is) {
+    auto image = FirmwareImageCache::instance().load(filePath);
+    if (image == nullptr) {
         return std::vector<char>();
     }
-    // get length of file:
-    is.seekg(0, is.end);
-    int length = is.tellg();
-    is.seekg(0, is.beg);
-
-    std::vector<char> buffer(length);
-
-    is.read(buffer.data(), length);
-    is.close();
-    return buffer;
+    return std::vector<char>(image->data(), image->data() + image->size());
 }
 
 static void progress_percentage_func(uint32_t done, uint32_t total, void* ctx) {
     uint32_t percent = (done * 100) / total;
     FirmwareManager *pFM = (FirmwareManager*) ctx;
-    pFM->gscFwFlashPercent.store(percent);
+    if (pFM->gscFwFlashPercent.exchange(percent) != (int)percent)
+        publishTaskProgress(TASK_PROGRESS_FIRMWARE_FLASH, -1);
 }
 
 static void data_progress_percentage_func(uint32_t done, uint32_t total, void* ctx) {
     uint32_t percent = (done * 100) / total;
     FirmwareManager *pFM = (FirmwareManager*) ctx;
-    pFM->gscFwDataFlashPercent.store(percent);
+    if (pFM->gscFwDataFlashPercent.exchange(percent) != (int)percent)
+        publishTaskProgress(TASK_PROGRESS_FIRMWARE_FLASH, -1);
 }
 
 
 xpum_result_t FirmwareManager::runGscOnlyFwFlash(const char* filePath, bool force) {
     // read image file
-    auto img = readImageContent(filePath);
+    auto img = FirmwareImageCache::instance().load(filePath);
 
     // validate the image file
     if (!isGscFwImage(img)) {
@@ -390,8 +385,9 @@ xpum_result_t FirmwareManager::runGscOnlyFwFlash(const char* filePath, bool forc
                 return XPUM_DEVICE_FIRMWARE_FLASH_ERROR;
             }
 
-            ret = igsc_device_fw_update_ex(&handle, (const uint8_t*)img.data(), 
-                img.size(), progress_func, this, flags);
+            ret = igsc_device_fw_update_ex(&handle, img->data(), 
+                img->size(), progress_func, this, flags);
+            MeiFirmwareInfo::instance().invalidate(device.meiDevicePath);
             if (ret) {
                 flashFwErrMsg = "Update process failed. " + print_device_fw_status(&handle);
                 XPUM_LOG_ERROR("Update process failed. {}", print_device_fw_status(&handle));
@@ -454,10 +450,10 @@ xpum_result_t FirmwareManager::runGSCFirmwareFlash(xpum_device_id_t deviceId, co
 
     flashFwErrMsg.clear();
     // read image file
-    auto buffer = readImageContent(filePath);
+    auto image = FirmwareImageCache::instance().load(filePath);
 
     // validate the image file
-    if (!isGscFwImage(buffer)) {
+    if (!isGscFwImage(image)) {
         return XPUM_UPDATE_FIRMWARE_INVALID_FW_IMAGE;
     }
 
@@ -470,7 +466,7 @@ xpum_result_t FirmwareManager::runGSCFirmwareFlash(xpum_device_id_t deviceId, co
             return XPUM_GENERIC_ERROR;
         }
     } else {
-        pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+        pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
         if (pDevice == nullptr) {
             return XPUM_GENERIC_ERROR;
         }
@@ -489,12 +485,12 @@ xpum_result_t FirmwareManager::runGSCFirmwareFlash(xpum_device_id_t deviceId, co
         // validate the image is compatible with the device
         if (device->getDeviceModel() == XPUM_DEVICE_MODEL_ATS_M_1 || device->getDeviceModel() == XPUM_DEVICE_MODEL_ATS_M_3 || device->getDeviceModel() == XPUM_DEVICE_MODEL_ATS_M_1G) {
             if (!force) {
-                auto res = atsmHwConfigCompatibleCheck(device->getMeiDevicePath(), buffer);
+                auto res = atsmHwConfigCompatibleCheck(device->getMeiDevicePath(), image);
                 if (res != XPUM_OK)
                     return res;
             }
         } else {
-            auto res = isPVCFwImageAndDeviceCompatible(device->getMeiDevicePath(), buffer);
+            auto res = isPVCFwImageAndDeviceCompatible(device->getMeiDevicePath(), image);
             if (res != XPUM_OK) {
                 return res;
             }
@@ -513,31 +509,25 @@ xpum_result_t FirmwareManager::runGSCFirmwareFlash(xpum_device_id_t deviceId, co
             return xpum_result_t::XPUM_UPDATE_FIRMWARE_TASK_RUNNING;
         }
     }
-    // try to update
-    bool stop = false;
-    std::vector<std::shared_ptr<Device>> toUnlock;
-    for (auto pd : deviceList) {
-        if (!stop) {
+    // try to update, the devices that fail to start or are not started are unlocked
+    std::vector<FlashGroup> groups = deviceId == XPUM_DEVICE_ID_ALL_DEVICES ? groupSiblingDevices(deviceList) : std::vector<FlashGroup>{deviceList};
+    res = gscFlashScheduler.run(
+        groups, Configuration::FIRMWARE_FLASH_PARALLELISM,
+        [image, force, deviceId](std::shared_ptr<Device> pd, std::string& errMsg) {
             RunGSCFirmwareFlashParam param;
-            param.img = buffer;
+            param.img = image;
             param.force = force;
-            res = pd->runFirmwareFlash(param);
+            auto res = pd->runFirmwareFlash(param);
             if (res != XPUM_OK) {
-                flashFwErrMsg = param.errMsg;
+                errMsg = param.errMsg;
                 if (deviceId == XPUM_DEVICE_ID_ALL_DEVICES) {
-                    flashFwErrMsg += " Device ID: " + pd->getId();
+                    errMsg += " Device ID: " + pd->getId();
                 }
-                stop = true;
-                toUnlock.push_back(pd);
             }
-        } else {
-            toUnlock.push_back(pd);
-        }
-    }
-    if (toUnlock.size() > 0) {
-        // some device fail to start, remember to unlock
-        Core::instance().getDeviceManager()->unlockDevices(toUnlock);
-    }
+            return res;
+        },
+        [](std::shared_ptr<Device> pd) { return pd->isUpgradingFw() && !pd->isUpgradingFwResultReady(); },
+        flashFwErrMsg);
     return res;
 }
 
@@ -556,7 +546,7 @@ void FirmwareManager::getGSCFirmwareFlashResult(xpum_device_id_t deviceId, xpum_
             return;
         }
     } else {
-        pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+        pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
         if (pDevice == nullptr) {
             result->result = XPUM_DEVICE_FIRMWARE_FLASH_ERROR;
             return;
@@ -568,7 +558,11 @@ void FirmwareManager::getGSCFirmwareFlashResult(xpum_device_id_t deviceId, xpum_
     result->type = XPUM_DEVICE_FIRMWARE_GFX;
 
     int totalPercent = 0;
-    bool ongoing = false;
+    // some devices are not started yet
+    bool ongoing = gscFlashScheduler.isRunning();
+    if (ongoing) {
+        result->result = XPUM_DEVICE_FIRMWARE_FLASH_ONGOING;
+    }
     for (auto pd : deviceList) {
         totalPercent += pd->gscFwFlashPercent.load();
         // if sibling device is upgrading, and dont get the result until all device is ready
@@ -583,6 +577,10 @@ void FirmwareManager::getGSCFirmwareFlashResult(xpum_device_id_t deviceId, xpum_
     }
 
     result->result = xpum_firmware_flash_result_t::XPUM_DEVICE_FIRMWARE_FLASH_OK;
+    if (gscFlashScheduler.getResult(flashFwErrMsg) != XPUM_OK) {
+        result->result = XPUM_DEVICE_FIRMWARE_FLASH_ERROR;
+        return;
+    }
 
     for (auto pd : deviceList) {
         GetGSCFirmwareFlashResultParam param;
@@ -642,17 +640,37 @@ static std::vector<std::shared_ptr<Device>> getSiblingDevices(std::shared_ptr<De
     return result;
 }
 
+static std::vector<FlashGroup> groupSiblingDevices(const std::vector<std::shared_ptr<Device>>& deviceList) {
+    std::vector<FlashGroup> groups;
+    std::set<std::string> grouped;
+    for (auto& pDevice : deviceList) {
+        if (grouped.count(pDevice->getId()) > 0) {
+            continue;
+        }
+        FlashGroup group;
+        for (auto& pSibling : getSiblingDevices(pDevice)) {
+            if (pSibling != nullptr && grouped.insert(pSibling->getId()).second) {
+                group.push_back(pSibling);
+            }
+        }
+        groups.push_back(group);
+    }
+    return groups;
+}
+
 xpum_result_t FirmwareManager::runGscOnlyFwDataFlash(const char* filePath) {
     auto devices = getPCIAddrAndMeiDevices();
     if (devices.size() == 0) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
     // read image file
-    auto buffer = readImageContent(filePath);
+    auto image = FirmwareImageCache::instance().load(filePath);
+    if (image == nullptr) {
+        return XPUM_UPDATE_FIRMWARE_INVALID_FW_IMAGE;
+    }
     int ret = 0;
     uint8_t type = 0;
-    ret = igsc_image_get_type((const uint8_t*)buffer.data(), buffer.size(), 
-        &type);
+    ret = image->getType(type);
     if (ret != IGSC_SUCCESS || type != IGSC_IMAGE_TYPE_FW_DATA) {
         return XPUM_UPDATE_FIRMWARE_INVALID_FW_IMAGE;
     }
@@ -665,7 +683,7 @@ xpum_result_t FirmwareManager::runGscOnlyFwDataFlash(const char* filePath) {
     gscFwDataFlashPercent.store(0);
     gscFwDataFlashTotalPercent.store(0);
     taskGSCData = std::async(std::launch::async, 
-        [this, buffer, filePath, devices] {
+        [this, image, filePath, devices] {
         for (auto &device : devices) {
              XPUM_LOG_INFO("Start update GSC FW-DATA on device {}", 
                 device.meiDevicePath);
@@ -686,7 +704,7 @@ xpum_result_t FirmwareManager::runGscOnlyFwDataFlash(const char* filePath) {
                 return XPUM_DEVICE_FIRMWARE_FLASH_ERROR;
             }
 
-            ret = igsc_image_fwdata_init(&oimg, (const uint8_t*)buffer.data(), buffer.size());
+            ret = igsc_image_fwdata_init(&oimg, image->data(), image->size());
             if (ret == IGSC_ERROR_BAD_IMAGE) {
                 flashFwErrMsg = "Invalid image format: " + std::string(filePath);
                 XPUM_LOG_ERROR("Invalid image format: {}", std::string(filePath));
@@ -696,6 +714,7 @@ xpum_result_t FirmwareManager::runGscOnlyFwDataFlash(const char* filePath) {
             }
 
             ret = igsc_device_fwdata_image_update(&handle, oimg, progress_func, this);
+            MeiFirmwareInfo::instance().invalidate(device.meiDevicePath);
 
             if (ret) {
                 flashFwErrMsg = "GFX_DATA update failed. " + print_device_fw_status(&handle);
@@ -756,7 +775,7 @@ xpum_result_t FirmwareManager::runFwDataFlash(xpum_device_id_t deviceId, const c
             return XPUM_GENERIC_ERROR;
         }
     } else {
-        pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+        pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
         if (pDevice == nullptr) {
             return XPUM_GENERIC_ERROR;
         }
@@ -784,30 +803,25 @@ xpum_result_t FirmwareManager::runFwDataFlash(xpum_device_id_t deviceId, const c
             return xpum_result_t::XPUM_UPDATE_FIRMWARE_TASK_RUNNING;
         }
     }
-    // try to update
-    bool stop = false;
-    std::vector<std::shared_ptr<Device>> toUnlock;
-    for (auto pd : deviceList) {
-        if (!stop) {
+    // try to update, the devices that fail to start or are not started are unlocked
+    std::vector<FlashGroup> groups = deviceId == XPUM_DEVICE_ID_ALL_DEVICES ? groupSiblingDevices(deviceList) : std::vector<FlashGroup>{deviceList};
+    std::string path = filePath;
+    res = fwDataFlashScheduler.run(
+        groups, Configuration::FIRMWARE_FLASH_PARALLELISM,
+        [path, deviceId](std::shared_ptr<Device> pd, std::string& errMsg) {
             FlashFwDataParam param;
-            param.filePath = filePath;
-            res = pd->getFwDataMgmt()->flashFwData(param);
+            param.filePath = path;
+            auto res = pd->getFwDataMgmt()->flashFwData(param);
             if (res != XPUM_OK) {
-                flashFwErrMsg = param.errMsg;
+                errMsg = param.errMsg;
                 if (deviceId == XPUM_DEVICE_ID_ALL_DEVICES) {
-                    flashFwErrMsg += " Device ID: " + pd->getId();
+                    errMsg += " Device ID: " + pd->getId();
                 }
-                stop = true;
-                toUnlock.push_back(pd);
             }
-        } else {
-            toUnlock.push_back(pd);
-        }
-    }
-    if (toUnlock.size() > 0) {
-        // some device fail to start, remember to unlock
-        Core::instance().getDeviceManager()->unlockDevices(toUnlock);
-    }
+            return res;
+        },
+        [](std::shared_ptr<Device> pd) { return pd->getFwDataMgmt()->isUpgradingFw() && !pd->getFwDataMgmt()->isReady(); },
+        flashFwErrMsg);
     return res;
 }
 
@@ -827,7 +841,7 @@ void FirmwareManager::getFwDataFlashResult(xpum_device_id_t deviceId, xpum_firmw
             return;
         }
     } else {
-        pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+        pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
         if (pDevice == nullptr) {
             result->result = XPUM_DEVICE_FIRMWARE_FLASH_ERROR;
             return;
@@ -846,7 +860,11 @@ void FirmwareManager::getFwDataFlashResult(xpum_device_id_t deviceId, xpum_firmw
         }
     }
 
-    bool ongoing = false;
+    // some devices are not started yet
+    bool ongoing = fwDataFlashScheduler.isRunning();
+    if (ongoing) {
+        result->result = XPUM_DEVICE_FIRMWARE_FLASH_ONGOING;
+    }
     int totalPercent = 0;
     for (auto pd : deviceList) {
         // if sibling device is upgrading, and dont get the result until all device is ready
@@ -875,6 +893,9 @@ void FirmwareManager::getFwDataFlashResult(xpum_device_id_t deviceId, xpum_firmw
             result->result = res;
         }
     }
+    if (fwDataFlashScheduler.getResult(flashFwErrMsg) != XPUM_OK) {
+        result->result = XPUM_DEVICE_FIRMWARE_FLASH_ERROR;
+    }
 }
 
 xpum_result_t FirmwareManager::getAMCSensorReading(xpum_sensor_reading_t data[], int* count) {
@@ -934,35 +955,42 @@ xpum_result_t FirmwareManager::runPscFwFlash(xpum_device_id_t deviceId, const ch
             return XPUM_GENERIC_ERROR;
         }
     } else {
-        pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+        pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
         if (pDevice == nullptr) {
             return XPUM_GENERIC_ERROR;
         }
         deviceList.push_back(pDevice);
     }
-    xpum_result_t ret;
+    flashFwErrMsg.clear();
     for (auto device : deviceList) {
-        bool locked = device->try_lock();
-        if (!locked)
-            return xpum_result_t::XPUM_UPDATE_FIRMWARE_TASK_RUNNING;
-        flashFwErrMsg.clear();
-        FlashPscFwParam param;
-        param.filePath = filePath;
-        param.force = force;
-        auto pPscMgmt = device->getPscMgmt();
-        if (!pPscMgmt) {
+        if (!device->getPscMgmt()) {
             return xpum_result_t::XPUM_UPDATE_FIRMWARE_UNSUPPORTED_PSC;
         }
-        ret = pPscMgmt->flashPscFw(param);
-        flashFwErrMsg = param.errMsg;
-        if (ret != XPUM_OK) {
-            if (deviceId == XPUM_DEVICE_ID_ALL_DEVICES) {
-                flashFwErrMsg += " Device ID: " + device->getId();
-            }
-            break;
-        }
     }
-    return ret;
+    bool locked = Core::instance().getDeviceManager()->tryLockDevices(deviceList);
+    if (!locked)
+        return xpum_result_t::XPUM_UPDATE_FIRMWARE_TASK_RUNNING;
+    // the devices that fail to start or are not started are unlocked
+    std::vector<FlashGroup> groups;
+    for (auto& device : deviceList) {
+        groups.push_back({device});
+    }
+    std::string path = filePath;
+    return pscFlashScheduler.run(
+        groups, Configuration::FIRMWARE_FLASH_PARALLELISM,
+        [path, force, deviceId](std::shared_ptr<Device> pd, std::string& errMsg) {
+            FlashPscFwParam param;
+            param.filePath = path;
+            param.force = force;
+            auto res = pd->getPscMgmt()->flashPscFw(param);
+            errMsg = param.errMsg;
+            if (res != XPUM_OK && deviceId == XPUM_DEVICE_ID_ALL_DEVICES) {
+                errMsg += " Device ID: " + pd->getId();
+            }
+            return res;
+        },
+        [](std::shared_ptr<Device> pd) { return pd->getPscMgmt()->isUpgradingFw() && !pd->getPscMgmt()->isReady(); },
+        flashFwErrMsg);
 }
 
 void FirmwareManager::getPscFwFlashResult(xpum_device_id_t deviceId, xpum_firmware_flash_task_result_t* result) {
@@ -975,7 +1003,7 @@ void FirmwareManager::getPscFwFlashResult(xpum_device_id_t deviceId, xpum_firmwa
             return;
         }
     } else {
-        pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+        pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
         if (pDevice == nullptr) {
             result->result = XPUM_DEVICE_FIRMWARE_FLASH_ERROR;
             return;
@@ -1007,6 +1035,14 @@ void FirmwareManager::getPscFwFlashResult(xpum_device_id_t deviceId, xpum_firmwa
         }
     }
     result->percentage = totalPercent / deviceList.size();
+    if (result->result == XPUM_DEVICE_FIRMWARE_FLASH_OK) {
+        // some devices are not started yet
+        if (pscFlashScheduler.isRunning()) {
+            result->result = XPUM_DEVICE_FIRMWARE_FLASH_ONGOING;
+        } else if (pscFlashScheduler.getResult(flashFwErrMsg) != XPUM_OK) {
+            result->result = XPUM_DEVICE_FIRMWARE_FLASH_ERROR;
+        }
+    }
     return;
 }
 
@@ -1038,7 +1074,7 @@ std::string FirmwareManager::transGfxFwStatusToString(GfxFwStatus status) {
 }
 
 GfxFwStatus FirmwareManager::getGfxFwStatus(xpum_device_id_t deviceId){
-    std::shared_ptr<Device> pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
     uint32_t status = 0x10;
 
     auto meiPath = pDevice->getMeiDevicePath();
@@ -1073,7 +1109,7 @@ xpum_result_t FirmwareManager::runFwCodeDataFlash(xpum_device_id_t deviceId, con
     }
 
     // check device exists
-    std::shared_ptr<Device> pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (pDevice == nullptr) {
         return XPUM_GENERIC_ERROR;
     }
@@ -1109,7 +1145,7 @@ xpum_result_t FirmwareManager::runFwCodeDataFlash(xpum_device_id_t deviceId, con
 
 void FirmwareManager::getFwCodeDataFlashResult(xpum_device_id_t deviceId, xpum_firmware_flash_task_result_t* result){
     xpum_firmware_flash_result_t res;
-    std::shared_ptr<Device> pDevice = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> pDevice = Core::instance().getDeviceManager()->getDevice(deviceId);
 
     result->deviceId = deviceId;
     result->type = XPUM_DEVICE_FIRMWARE_GFX_CODE_DATA;
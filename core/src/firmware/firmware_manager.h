@@ -13,6 +13,8 @@
 
 #include "xpum_structs.h"
 #include "amc/amc_manager.h"
+#include "firmware/firmware_image.h"
+#include "firmware/flash_scheduler.h"
 
 namespace xpum {
 
@@ -37,7 +39,7 @@ enum GfxFwStatus {
 }
 
 struct RunGSCFirmwareFlashParam {
-    std::vector<char> img;
+    std::shared_ptr<FirmwareImage> img;
     bool force;
     std::string errMsg;
 };
@@ -54,15 +56,20 @@ class FirmwareManager {
     std::future<xpum_firmware_flash_result_t> taskGSC;
     std::future<xpum_firmware_flash_result_t> taskGSCData;
 
+    // the flashes of many devices, at most Configuration::FIRMWARE_FLASH_PARALLELISM cards at a time
+    FlashScheduler gscFlashScheduler;
+    FlashScheduler fwDataFlashScheduler;
+    FlashScheduler pscFlashScheduler;
+
     std::shared_ptr<AmcManager> p_amc_manager;
 
     void preInitAmcManager();
 
     bool initAmcManager();
 
-    xpum_result_t atsmHwConfigCompatibleCheck(std::string meiPath, std::vector<char>& buffer);
+    xpum_result_t atsmHwConfigCompatibleCheck(std::string meiPath, std::shared_ptr<FirmwareImage>& image);
 
-    xpum_result_t isPVCFwImageAndDeviceCompatible(std::string meiPath, std::vector<char>& buffer);
+    xpum_result_t isPVCFwImageAndDeviceCompatible(std::string meiPath, std::shared_ptr<FirmwareImage>& image);
 
     xpum_result_t runGscOnlyFwFlash(const char* filePath, bool force);
     void getGscOnlyFwFlashResult(xpum_firmware_flash_task_result_t* result);
@@ -121,6 +128,7 @@ class FirmwareManager {
     std::atomic<int> gscFwDataFlashTotalPercent;
 };
 
+// a copy of the image of filePath, for the flashes that change the image
 std::vector<char> readImageContent(const char* filePath);
 
 static const std::string igscPath{"igsc"};
@@ -0,0 +1,117 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file flash_scheduler.cpp
+ */
+
+#include "flash_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+FlashScheduler::~FlashScheduler() {
+    if (task.valid()) {
+        task.wait();
+    }
+}
+
+xpum_result_t FlashScheduler::startGroup(FlashGroup& group, StartFunc& start, std::string& errMsg) {
+    for (size_t i = 0; i < group.size(); i++) {
+        auto res = start(group[i], errMsg);
+        if (res != XPUM_OK) {
+            for (size_t j = i; j < group.size(); j++) {
+                group[j]->unlock();
+            }
+            return res;
+        }
+    }
+    return XPUM_OK;
+}
+
+void FlashScheduler::unlockGroups(std::vector<FlashGroup>& groups, size_t from) {
+    for (size_t i = from; i < groups.size(); i++) {
+        for (auto& pd : groups[i]) {
+            pd->unlock();
+        }
+    }
+}
+
+xpum_result_t FlashScheduler::run(std::vector<FlashGroup> groups, uint32_t parallelism, StartFunc start, OngoingFunc ongoing, std::string& errMsg) {
+    if (task.valid()) {
+        task.wait();
+    }
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        result = XPUM_OK;
+        this->errMsg.clear();
+    }
+    if (parallelism == 0) {
+        parallelism = groups.size();
+    }
+
+    // the first groups are started here so that their errors are returned to the caller
+    std::vector<size_t> active;
+    size_t next = 0;
+    while (next < groups.size() && active.size() < parallelism) {
+        auto res = startGroup(groups[next], start, errMsg);
+        if (res != XPUM_OK) {
+            unlockGroups(groups, next + 1);
+            return res;
+        }
+        active.push_back(next++);
+    }
+    if (next == groups.size()) {
+        return XPUM_OK;
+    }
+
+    XPUM_LOG_INFO("Flash {} of {} device groups, the others are flashed when they end", active.size(), groups.size());
+    running = true;
+    task = std::async(std::launch::async, [this, groups, parallelism, start, ongoing, active, next]() mutable {
+        while (next < groups.size()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            active.erase(std::remove_if(active.begin(), active.end(), [&](size_t i) {
+                             bool done = std::none_of(groups[i].begin(), groups[i].end(), ongoing);
+                             if (done) {
+                                 XPUM_LOG_INFO("Flash ended on device {} and its siblings", groups[i].front()->getId());
+                             }
+                             return done;
+                         }),
+                         active.end());
+            while (next < groups.size() && active.size() < parallelism) {
+                std::string msg;
+                auto res = startGroup(groups[next], start, msg);
+                if (res != XPUM_OK) {
+                    XPUM_LOG_ERROR("Failed to start the flash on device {}: {}", groups[next].front()->getId(), msg);
+                    unlockGroups(groups, next + 1);
+                    std::lock_guard<std::mutex> lck(mtx);
+                    result = res;
+                    this->errMsg = msg;
+                    running = false;
+                    return;
+                }
+                active.push_back(next++);
+            }
+        }
+        running = false;
+    });
+    return XPUM_OK;
+}
+
+bool FlashScheduler::isRunning() {
+    return running;
+}
+
+xpum_result_t FlashScheduler::getResult(std::string& errMsg) {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (result != XPUM_OK) {
+        errMsg = this->errMsg;
+    }
+    return result;
+}
+
+} // namespace xpum
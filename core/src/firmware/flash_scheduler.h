@@ -0,0 +1,69 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file flash_scheduler.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "device/device.h"
+#include "xpum_structs.h"
+
+namespace xpum {
+
+typedef std::vector<std::shared_ptr<Device>> FlashGroup;
+
+/*
+  FlashScheduler flashes the firmware of groups of devices, with at most a
+  number of groups flashed at a time. The devices of a group (the sibling
+  devices of a card) are always flashed together. The groups that can not be
+  started at once are started in the background when earlier groups end.
+*/
+class FlashScheduler {
+   public:
+    // starts the flash of a device, the flash unlocks the device when it ends
+    typedef std::function<xpum_result_t(std::shared_ptr<Device>, std::string& errMsg)> StartFunc;
+
+    // whether the flash of a device started by StartFunc is still ongoing
+    typedef std::function<bool(std::shared_ptr<Device>)> OngoingFunc;
+
+    FlashScheduler() : running(false), result(XPUM_OK) {}
+
+    ~FlashScheduler();
+
+    // the devices of groups are locked by the caller, the devices not flashed are unlocked,
+    // returns the error of the groups started at once
+    xpum_result_t run(std::vector<FlashGroup> groups, uint32_t parallelism, StartFunc start, OngoingFunc ongoing, std::string& errMsg);
+
+    // whether some groups are not started yet
+    bool isRunning();
+
+    // the error of the groups started in the background
+    xpum_result_t getResult(std::string& errMsg);
+
+   private:
+    // starts the group, unlocks its devices not started on error
+    static xpum_result_t startGroup(FlashGroup& group, StartFunc& start, std::string& errMsg);
+
+    static void unlockGroups(std::vector<FlashGroup>& groups, size_t from);
+
+    std::future<void> task;
+
+    std::atomic<bool> running;
+
+    std::mutex mtx;
+
+    xpum_result_t result;
+
+    std::string errMsg;
+};
+
+} // namespace xpum
@@ -116,10 +116,13 @@ bool removeDir(const char* dirPath){
     return success;
 }
 
-static bool validateImageFormat(std::vector<char>& buffer){
+static bool validateImageFormat(std::shared_ptr<FirmwareImage>& image){
+    if (image == nullptr) {
+        return false;
+    }
     uint8_t type;
     int ret;
-    ret = igsc_image_get_type((const uint8_t*)buffer.data(), buffer.size(), &type);
+    ret = image->getType(type);
     if (ret != IGSC_SUCCESS)
     {
         return false;
@@ -127,10 +130,13 @@ static bool validateImageFormat(std::vector<char>& buffer){
     return type == IGSC_IMAGE_TYPE_FW_DATA;
 }
 
-static bool isGscFwImage(std::vector<char>& buffer) {
+static bool isGscFwImage(std::shared_ptr<FirmwareImage>& image) {
+    if (image == nullptr) {
+        return false;
+    }
     uint8_t type;
     int ret;
-    ret = igsc_image_get_type((const uint8_t*)buffer.data(), buffer.size(), &type);
+    ret = image->getType(type);
     if (ret != IGSC_SUCCESS)
     {
         return false;
@@ -154,14 +160,14 @@ xpum_result_t FwCodeDataMgmt::flashFwCodeData(FlashFwCodeDataParam &param) {
             return XPUM_GENERIC_ERROR;
         }
         // read code image file
-        auto codeImageBuffer = readImageContent(codeImagePath.c_str());
+        auto codeImageBuffer = FirmwareImageCache::instance().load(codeImagePath);
         // validate the code image file
         if (!isGscFwImage(codeImageBuffer)) {
             return XPUM_UPDATE_FIRMWARE_INVALID_FW_IMAGE;
         }
 
         // read data image file
-        auto dataImg = readImageContent(dataImagePath.c_str());
+        auto dataImg = FirmwareImageCache::instance().load(dataImagePath);
         if (!validateImageFormat(dataImg)) {
             return XPUM_UPDATE_FIRMWARE_INVALID_FW_IMAGE;
         }
@@ -16,6 +16,8 @@
 #include "system_cmd.h"
 #include "firmware_manager.h"
 #include "igsc_err_msg.h"
+#include "mei_firmware_info.h"
+#include "event/task_progress.h"
 
 namespace xpum {
 
@@ -23,10 +25,13 @@ using namespace std::chrono_literals;
 
 static std::string print_fwdata_version(const struct igsc_fwdata_version *fwdata_version);
 
-static bool validateImageFormat(std::vector<char>& buffer){
+static bool validateImageFormat(std::shared_ptr<FirmwareImage>& image){
+    if (image == nullptr) {
+        return false;
+    }
     uint8_t type;
     int ret;
-    ret = igsc_image_get_type((const uint8_t*)buffer.data(), buffer.size(), &type);
+    ret = image->getType(type);
     if (ret != IGSC_SUCCESS)
     {
         return false;
@@ -34,12 +39,12 @@ static bool validateImageFormat(std::vector<char>& buffer){
     return type == IGSC_IMAGE_TYPE_FW_DATA;
 }
 
-xpum_result_t isFwDataImageAndDeviceCompatible(std::vector<char>& buffer, std::string devicePath) {
+xpum_result_t isFwDataImageAndDeviceCompatible(std::shared_ptr<FirmwareImage>& image, std::string devicePath) {
     struct igsc_fwdata_image* oimg = NULL;
     int ret;
     // image
     struct igsc_fwdata_version img_version;
-    ret = igsc_image_fwdata_init(&oimg, (const uint8_t*)buffer.data(), buffer.size());
+    ret = igsc_image_fwdata_init(&oimg, image->data(), image->size());
     if (ret != IGSC_SUCCESS) {
         igsc_image_fwdata_release(oimg);
         return XPUM_UPDATE_FIRMWARE_INVALID_FW_IMAGE;
@@ -51,37 +56,27 @@ xpum_result_t isFwDataImageAndDeviceCompatible(std::vector<char>& buffer, std::s
         return XPUM_UPDATE_FIRMWARE_INVALID_FW_IMAGE;
     }
     // device
-    struct igsc_device_info dev_info;
-    struct igsc_fwdata_version dev_version;
-    struct igsc_device_handle handle;
-    ret = igsc_device_init_by_device(&handle, devicePath.c_str());
-    if (ret != IGSC_SUCCESS) {
+    auto p_versions = MeiFirmwareInfo::instance().get(devicePath, MEI_FW_DEVICE_INFO | MEI_FW_DATA_VERSION);
+    if (!p_versions->has(MEI_FW_DEVICE_INFO)) {
         igsc_image_fwdata_release(oimg);
-        igsc_device_close(&handle);
-        return XPUM_GENERIC_ERROR;
-    }
-    ret = igsc_device_get_device_info(&handle, &dev_info);
-    if (ret != IGSC_SUCCESS) {
-        igsc_image_fwdata_release(oimg);
-        igsc_device_close(&handle);
         return XPUM_GENERIC_ERROR;
     }
 
+    // igsc takes them non-const, compare copies
+    struct igsc_device_info dev_info = p_versions->device_info;
     ret = igsc_image_fwdata_match_device(oimg, &dev_info);
     if (ret != IGSC_SUCCESS) {
         XPUM_LOG_ERROR("The image is not compatible with the device\nDevice info doesn't match image device Id extension\n");
         igsc_image_fwdata_release(oimg);
-        igsc_device_close(&handle);
         return XPUM_UPDATE_FIRMWARE_FW_IMAGE_NOT_COMPATIBLE_WITH_DEVICE;
     }
 
-    ret = igsc_device_fwdata_version(&handle, &dev_version);
-    if (ret != IGSC_SUCCESS) {
+    if (!p_versions->has(MEI_FW_DATA_VERSION)) {
         XPUM_LOG_ERROR("Fail to get GFX_DATA version from dev {}", devicePath);
         igsc_image_fwdata_release(oimg);
-        igsc_device_close(&handle);
         return XPUM_GENERIC_ERROR;
     }
+    struct igsc_fwdata_version dev_version = p_versions->fwdata_version;
 
     xpum_result_t result = XPUM_UPDATE_FIRMWARE_FW_IMAGE_NOT_COMPATIBLE_WITH_DEVICE;
     uint8_t cmp = igsc_fwdata_version_compare(&img_version, &dev_version);
@@ -107,7 +102,6 @@ xpum_result_t isFwDataImageAndDeviceCompatible(std::vector<char>& buffer, std::s
             XPUM_LOG_ERROR("firmware data version error in comparison\n");
     }
     igsc_image_fwdata_release(oimg);
-    igsc_device_close(&handle);
     return result;
 }
 
@@ -116,7 +110,8 @@ static void progress_percentage_func(uint32_t done, uint32_t total, void* ctx) {
 
     // store percent 
     FwDataMgmt* p = (FwDataMgmt*) ctx;
-    p->percent.store(percent);
+    if (p->percent.exchange(percent) != (int)percent)
+        publishTaskProgress(TASK_PROGRESS_FIRMWARE_FLASH, -1);
 }
 
 xpum_result_t FwDataMgmt::flashFwData(FlashFwDataParam &param) {
@@ -126,12 +121,12 @@ xpum_result_t FwDataMgmt::flashFwData(FlashFwDataParam &param) {
         // task already running
         return xpum_result_t::XPUM_UPDATE_FIRMWARE_TASK_RUNNING;
     } else {
-        auto buffer = readImageContent(filePath.c_str());
+        auto image = FirmwareImageCache::instance().load(filePath);
 
-        if (!validateImageFormat(buffer)) {
+        if (!validateImageFormat(image)) {
             return XPUM_UPDATE_FIRMWARE_INVALID_FW_IMAGE;
         }
-        auto res = isFwDataImageAndDeviceCompatible(buffer, devicePath);
+        auto res = isFwDataImageAndDeviceCompatible(image, devicePath);
         if (res != XPUM_OK) {
             return res;
         }
@@ -139,7 +134,7 @@ xpum_result_t FwDataMgmt::flashFwData(FlashFwDataParam &param) {
         // init fw-data update progress
         percent.store(0);
 
-        taskFwData = std::async(std::launch::async, [this, buffer, filePath] {
+        taskFwData = std::async(std::launch::async, [this, image, filePath] {
             XPUM_LOG_INFO("Start update GSC FW-DATA on device {}", devicePath);
 
             struct igsc_device_handle handle;
@@ -160,7 +155,7 @@ xpum_result_t FwDataMgmt::flashFwData(FlashFwDataParam &param) {
                 return xpum_firmware_flash_result_t::XPUM_DEVICE_FIRMWARE_FLASH_ERROR;
             }
 
-            ret = igsc_image_fwdata_init(&oimg, (const uint8_t*)buffer.data(), buffer.size());
+            ret = igsc_image_fwdata_init(&oimg, image->data(), image->size());
             if (ret == IGSC_ERROR_BAD_IMAGE) {
                 flashFwErrMsg = "Invalid image format: " + filePath;
                 XPUM_LOG_ERROR("Invalid image format: {}", filePath);
@@ -171,6 +166,7 @@ xpum_result_t FwDataMgmt::flashFwData(FlashFwDataParam &param) {
             }
 
             ret = igsc_device_fwdata_image_update(&handle, oimg, progress_func, this);
+            MeiFirmwareInfo::instance().invalidate(devicePath);
 
             if (ret) {
                 flashFwErrMsg = "GFX_DATA update failed. " + print_device_fw_status(&handle);
@@ -208,41 +204,21 @@ static std::string print_fwdata_version(const struct igsc_fwdata_version *fwdata
 
 std::string fwdata_device_version(const char *device_path)
 {
-    struct igsc_fwdata_version fwdata_version;
-    struct igsc_device_handle handle;
-    int ret;
-
-    memset(&handle, 0, sizeof(handle));
-    ret = igsc_device_init_by_device(&handle, device_path);
-    if (ret != IGSC_SUCCESS) {
-        XPUM_LOG_ERROR("Failed to initialize device: {}", device_path);
-        igsc_device_close(&handle);
-        return "";
-    }
-
-    memset(&fwdata_version, 0, sizeof(fwdata_version));
-    ret = igsc_device_fwdata_version(&handle, &fwdata_version);
-    if (ret != IGSC_SUCCESS)
+    auto p_versions = MeiFirmwareInfo::instance().get(device_path, MEI_FW_DATA_VERSION);
+    if (!p_versions->has(MEI_FW_DATA_VERSION))
     {
-        if (ret == IGSC_ERROR_PERMISSION_DENIED)
+        if (p_versions->lastError == IGSC_ERROR_PERMISSION_DENIED)
         {
             XPUM_LOG_ERROR("Permission denied: missing required credentials to access the device {}", device_path);
         }
         else
         {
             XPUM_LOG_ERROR("Fail to get fwdata version from device: {}", device_path);
-            // print_device_fw_status(&handle);
         }
-        igsc_device_close(&handle);
         return "";
     }
 
-    auto version = print_fwdata_version(&fwdata_version);
-
-    igsc_device_close(&handle);
-    
-    return version;
-
+    return print_fwdata_version(&p_versions->fwdata_version);
 }
 
 void FwDataMgmt::getFwDataVersion() {
@@ -12,6 +12,7 @@
 #include <atomic>
 
 #include "device/device.h"
+#include "firmware/firmware_image.h"
 
 namespace xpum {
 
@@ -51,6 +52,6 @@ class FwDataMgmt {
     std::string flashFwErrMsg;
 };
 
-xpum_result_t isFwDataImageAndDeviceCompatible(std::vector<char>& buffer, std::string devicePath);
+xpum_result_t isFwDataImageAndDeviceCompatible(std::shared_ptr<FirmwareImage>& image, std::string devicePath);
 
 } // namespace xpum
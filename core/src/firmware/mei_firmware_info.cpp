@@ -0,0 +1,91 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file mei_firmware_info.cpp
+ */
+
+#include "mei_firmware_info.h"
+
+#include "igsc_err_msg.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+MeiFirmwareInfo& MeiFirmwareInfo::instance() {
+    static MeiFirmwareInfo info;
+    return info;
+}
+
+std::shared_ptr<MeiFirmwareInfo::Entry> MeiFirmwareInfo::getEntry(const std::string& meiPath) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& p_entry = entries[meiPath];
+    if (p_entry == nullptr) {
+        p_entry = std::make_shared<Entry>();
+    }
+    return p_entry;
+}
+
+std::shared_ptr<const MeiFirmwareVersions> MeiFirmwareInfo::get(const std::string& meiPath, uint32_t components) {
+    auto p_entry = getEntry(meiPath);
+    std::lock_guard<std::mutex> lock(p_entry->mutex);
+    // a failed read is tried again, the device may have been busy
+    uint32_t missing = components & ~(p_entry->p_versions->read & ~p_entry->p_versions->failed);
+    if (missing == 0) {
+        return p_entry->p_versions;
+    }
+
+    auto p_versions = std::make_shared<MeiFirmwareVersions>(*p_entry->p_versions);
+    struct igsc_device_handle handle {};
+    int ret = igsc_device_init_by_device(&handle, meiPath.c_str());
+    if (ret != IGSC_SUCCESS) {
+        XPUM_LOG_ERROR("Failed to initialize device: {}", meiPath);
+        (void)igsc_device_close(&handle);
+        // not kept, the device is opened again on the next call
+        p_versions->read |= missing;
+        p_versions->failed |= missing;
+        p_versions->lastError = ret;
+        return p_versions;
+    }
+
+    auto readComponent = [&](uint32_t component, int ret) {
+        p_versions->read |= component;
+        if (ret == IGSC_SUCCESS) {
+            p_versions->failed &= ~component;
+        } else {
+            p_versions->failed |= component;
+            p_versions->lastError = ret;
+            // the status is one more round trip, not worth it for a missing library call
+            if (ret != IGSC_ERROR_NOT_SUPPORTED) {
+                p_versions->errorStatus = print_device_fw_status(&handle);
+            }
+        }
+    };
+    if (missing & MEI_FW_GFX_VERSION) {
+        readComponent(MEI_FW_GFX_VERSION, igsc_device_fw_version(&handle, &p_versions->fw_version));
+    }
+    if (missing & MEI_FW_HW_CONFIG) {
+        readComponent(MEI_FW_HW_CONFIG, igsc_device_hw_config(&handle, &p_versions->hw_config));
+    }
+    if (missing & MEI_FW_DEVICE_INFO) {
+        readComponent(MEI_FW_DEVICE_INFO, igsc_device_get_device_info(&handle, &p_versions->device_info));
+    }
+    if (missing & MEI_FW_DATA_VERSION) {
+        readComponent(MEI_FW_DATA_VERSION, igsc_device_fwdata_version(&handle, &p_versions->fwdata_version));
+    }
+    if (missing & MEI_FW_PSC_VERSION) {
+        // the igsc of some distributions has no PSC support
+        readComponent(MEI_FW_PSC_VERSION, libIgsc.ok() ? libIgsc.igsc_device_psc_version(&handle, &p_versions->psc_version) : IGSC_ERROR_NOT_SUPPORTED);
+    }
+    (void)igsc_device_close(&handle);
+
+    p_entry->p_versions = p_versions;
+    return p_versions;
+}
+
+void MeiFirmwareInfo::invalidate(const std::string& meiPath) {
+    auto p_entry = getEntry(meiPath);
+    std::lock_guard<std::mutex> lock(p_entry->mutex);
+    p_entry->p_versions = std::make_shared<const MeiFirmwareVersions>();
+}
+
+} // namespace xpum
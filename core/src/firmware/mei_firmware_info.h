@@ -0,0 +1,93 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file mei_firmware_info.h
+ */
+
+#pragma once
+
+#include <igsc_lib.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "load_igsc.h"
+
+namespace xpum {
+
+enum MeiFirmwareComponent : uint32_t {
+    MEI_FW_GFX_VERSION = 1 << 0,
+    MEI_FW_HW_CONFIG = 1 << 1,
+    MEI_FW_DEVICE_INFO = 1 << 2,
+    MEI_FW_DATA_VERSION = 1 << 3,
+    MEI_FW_PSC_VERSION = 1 << 4,
+};
+
+struct MeiFirmwareVersions {
+    // the components read from the device, and those of them whose read failed
+    uint32_t read = 0;
+
+    uint32_t failed = 0;
+
+    // the igsc error and print_device_fw_status of the device after the last failed read
+    int lastError = IGSC_SUCCESS;
+
+    std::string errorStatus;
+
+    struct igsc_fw_version fw_version {};
+
+    struct igsc_hw_config hw_config {};
+
+    struct igsc_device_info device_info {};
+
+    struct igsc_fwdata_version fwdata_version {};
+
+    struct igsc_psc_version psc_version {};
+
+    bool has(uint32_t components) const {
+        return (read & ~failed & components) == components;
+    }
+};
+
+/*
+  The firmware versions of the MEI devices. Each MEI round trip takes tens
+  of ms, so the versions of a device are read in one igsc session the first
+  time they are asked for, and kept until invalidate(). The flash routines
+  call invalidate() once a flash is over, the next request reads the new
+  versions. The device is not kept open between the reads, an open handle
+  would hold the MEI connection the flash and the other igsc users need.
+*/
+class MeiFirmwareInfo {
+   public:
+    static MeiFirmwareInfo& instance();
+
+    /*
+      The versions of meiPath with at least the components asked for read,
+      those not read before or whose read failed are read in one session.
+    */
+    std::shared_ptr<const MeiFirmwareVersions> get(const std::string& meiPath, uint32_t components);
+
+    void invalidate(const std::string& meiPath);
+
+   private:
+    struct Entry {
+        std::mutex mutex;
+
+        std::shared_ptr<const MeiFirmwareVersions> p_versions = std::make_shared<const MeiFirmwareVersions>();
+    };
+
+    MeiFirmwareInfo() = default;
+
+    std::shared_ptr<Entry> getEntry(const std::string& meiPath);
+
+    std::mutex mutex;
+
+    std::map<std::string, std::shared_ptr<Entry>> entries;
+
+    LibIgsc libIgsc;
+};
+
+} // namespace xpum
@@ -17,8 +17,10 @@
 #include "infrastructure/logger.h"
 #include "load_igsc.h"
 #include "igsc_err_msg.h"
+#include "mei_firmware_info.h"
 #include "api/psc.h"
 #include "psc_txcal_blob.h"
+#include "event/task_progress.h"
 #include "handle_lock.h"
 
 namespace xpum {
@@ -42,7 +44,8 @@ static void progress_percentage_func(uint32_t done, uint32_t total, void* ctx) {
 
     // store percent 
     PscMgmt* p = (PscMgmt*) ctx;
-    p->percent.store(percent);
+    if (p->percent.exchange(percent) != (int)percent)
+        publishTaskProgress(TASK_PROGRESS_FIRMWARE_FLASH, -1);
 }
 
 xpum_result_t PscMgmt::flashPscFw(FlashPscFwParam &param) {
@@ -102,6 +105,7 @@ xpum_result_t PscMgmt::flashPscFw(FlashPscFwParam &param) {
 
             ret = igsc_iaf_psc_update(&handle, (const uint8_t*)buffer.data(), buffer.size(),
                                       progress_func, this);
+            MeiFirmwareInfo::instance().invalidate(devicePath);
 
             if (ret) {
                 flashFwErrMsg = "GSC_PSCBIN update failed. " + print_device_fw_status(&handle);
@@ -161,30 +165,29 @@ xpum_firmware_flash_result_t PscMgmt::getFlashPscFwResult(GetFlashPscFwResultPar
     }
 }
 
+bool PscMgmt::isUpgradingFw() {
+    return task.valid();
+}
+
+bool PscMgmt::isReady() {
+    if (!task.valid()) {
+        return true;
+    }
+    using namespace std::chrono_literals;
+    return task.wait_for(0ms) == std::future_status::ready;
+}
+
 void PscMgmt::getPscFwVersion() {
     if (!libIgsc.ok())
         return;
 
-    struct igsc_device_handle handle {};
-    int ret;
-
-    ret = igsc_device_init_by_device(&handle, devicePath.c_str());
-    if (ret != IGSC_SUCCESS) {
-        XPUM_LOG_ERROR("Failed to initialize device: {}", devicePath);
-        igsc_device_close(&handle);
-        return;
-    }
-    struct igsc_psc_version dev_version {};
-    {
-        ret = libIgsc.igsc_device_psc_version(&handle, &dev_version);
-    }
-    if (ret != IGSC_SUCCESS) {
+    auto p_versions = MeiFirmwareInfo::instance().get(devicePath, MEI_FW_PSC_VERSION);
+    if (!p_versions->has(MEI_FW_PSC_VERSION)) {
         XPUM_LOG_ERROR("Failed to get GFX_PSCBIN firmware version from device {}", devicePath);
     } else {
-        std::string version = print_psc_version(&dev_version);
+        std::string version = print_psc_version(&p_versions->psc_version);
         pDevice->addProperty(Property(XPUM_DEVICE_PROPERTY_INTERNAL_GFX_PSCBIN_FIRMWARE_VERSION, version));
         XPUM_LOG_INFO("GFX_PSCBIN version of device {} is {}", devicePath, version);
     }
-    igsc_device_close(&handle);
 }
 } // namespace xpum
\ No newline at end of file
@@ -33,6 +33,10 @@ class PscMgmt {
 
     xpum_firmware_flash_result_t getFlashPscFwResult(GetFlashPscFwResultParam &param);
 
+    bool isUpgradingFw();
+
+    bool isReady();
+
     void getPscFwVersion();
     std::atomic<int> percent;
 
@@ -6,8 +6,16 @@
 
 #include "group_manager.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <set>
 #include <vector>
 
+#include "data_logic/job_accounting.h"
+#include "device/gpu/device_event_listener.h"
+#include "device/gpu/gpu_device_stub.h"
+#include "infrastructure/configuration.h"
 #include "infrastructure/device_property.h"
 #include "infrastructure/logger.h"
 #include "topology/pci_database.h"
@@ -17,7 +25,7 @@ namespace xpum {
 
 GroupManager::GroupManager(std::shared_ptr<DeviceManagerInterface>& p_device_manager,
                            std::shared_ptr<DataLogicInterface>& p_data_logic)
-    : p_devicemanager(p_device_manager), p_datalogic(p_data_logic), groupSequence(1), internalSequence(1) {
+    : p_devicemanager(p_device_manager), p_datalogic(p_data_logic), groupSequence(1), internalSequence(1), selectorFlags(0), listening(false), event_subscription(-1) {
     XPUM_LOG_TRACE("GroupManager()");
 }
 
@@ -59,12 +67,99 @@ xpum_result_t GroupManager::createGroup(const char* pGroupName, xpum_group_id_t*
         groupId = groupSequence++;
     }
 
-    groupMap.insert({groupId, std::make_shared<GroupUnit>(name, groupId)});
+    auto pGroup = std::make_shared<GroupUnit>(name, groupId);
+    groupMap.insert({groupId, pGroup});
+    registerGroup(pGroup);
     *pGroupId = groupId;
 
     return XPUM_OK;
 }
 
+// the pod UIDs of the processes with a drm client of the device, the pods of the pids not in cache are read from /proc
+static std::set<std::string> readDevicePods(const std::shared_ptr<Device>& p_device, std::map<uint32_t, std::string>& cache, std::set<uint32_t>& pids) {
+    std::set<std::string> pods;
+    ClientBusyTimes busy_times;
+    if (!GPUDeviceStub::getDeviceClientBusyTime(p_device->getDeviceHandle(), p_device->getId(), busy_times)) {
+        return pods;
+    }
+    for (auto& client : busy_times) {
+        uint32_t pid = client.second.first;
+        pids.insert(pid);
+        auto iter = cache.find(pid);
+        if (iter == cache.end()) {
+            JobProcessEnergy process;
+            JobAccounting::readProcessInfo(pid, process);
+            iter = cache.emplace(pid, process.pod_uid).first;
+        }
+        if (!iter->second.empty()) {
+            pods.insert(iter->second);
+        }
+    }
+    return pods;
+}
+
+xpum_result_t GroupManager::createGroupBySelector(const char* pGroupName, const xpum_group_selector_t* pSelector, xpum_group_id_t* pGroupId) {
+    XPUM_LOG_TRACE("GroupManager::createGroupBySelector");
+
+    if (pSelector == nullptr || !GroupSelector::validate(*pSelector)) {
+        XPUM_LOG_DEBUG("GroupManager::createGroupBySelector-invalid selector");
+        return XPUM_GENERIC_ERROR;
+    }
+    xpum_group_id_t groupId;
+    xpum_result_t res = createGroup(pGroupName, &groupId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    std::shared_ptr<GroupUnit> pGroupInfo = getGroupById(groupId);
+    if (pGroupInfo == nullptr) {
+        return XPUM_RESULT_GROUP_NOT_FOUND;
+    }
+    pGroupInfo->setSelector(*pSelector);
+    uint32_t flags = pSelector->flags & ~selectorFlags;
+    updateSelectorFlags();
+
+    // the attributes not kept up to date before the group are read now
+    std::vector<std::shared_ptr<Device>> devices;
+    p_devicemanager->getDeviceList(devices);
+    std::set<uint32_t> pids;
+    for (auto& p_device : devices) {
+        std::string deviceId = p_device->getId();
+        auto& attributes = getDeviceAttributes(deviceId);
+        if (flags & XPUM_GROUP_SELECTOR_HEALTH) {
+            attributes.health = GroupSelector::readHealth(std::stoi(deviceId));
+        }
+        if (flags & XPUM_GROUP_SELECTOR_THROTTLED) {
+            auto p_data = p_datalogic->getLatestData(MeasurementType::METRIC_FREQUENCY_THROTTLE_REASON_GPU, deviceId);
+            attributes.throttled = p_data != nullptr && p_data->getCurrent() != 0 && p_data->getCurrent() != std::numeric_limits<uint64_t>::max();
+        }
+        if (flags & XPUM_GROUP_SELECTOR_POD) {
+            attributes.pod_uids = readDevicePods(p_device, processPods, pids);
+        }
+        pGroupInfo->setDeviceMatched(std::stoi(deviceId), GroupSelector::matches(*pSelector, attributes));
+    }
+    registerGroup(pGroupInfo);
+    XPUM_LOG_DEBUG("GroupManager::createGroupBySelector-group {} flags {:#x} devices {}", groupId, pSelector->flags, pGroupInfo->getDeviceCount());
+    *pGroupId = groupId;
+    return XPUM_OK;
+}
+
+xpum_result_t GroupManager::getGroupSelector(xpum_group_id_t groupId, xpum_group_selector_t* pSelector) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    std::shared_ptr<GroupUnit> pGroupInfo = getGroupById(groupId);
+    if (pGroupInfo == nullptr) {
+        XPUM_LOG_DEBUG("GroupManager::getGroupSelector-invalid group {}", groupId);
+        return XPUM_RESULT_GROUP_NOT_FOUND;
+    }
+    if (pSelector == nullptr || !pGroupInfo->isDynamic()) {
+        return XPUM_GENERIC_ERROR;
+    }
+    *pSelector = pGroupInfo->getSelector();
+    return XPUM_OK;
+}
+
 xpum_result_t GroupManager::destroyGroup(xpum_group_id_t groupId) {
     std::unique_lock<std::mutex> lock(this->mutex);
     std::shared_ptr<GroupUnit> pGroupInfo;
@@ -82,6 +177,8 @@ xpum_result_t GroupManager::destroyGroup(xpum_group_id_t groupId) {
         return XPUM_RESULT_GROUP_NOT_FOUND;
     } else {
         groupMap.erase(groupId);
+        p_datalogic->removeGroup(groupId);
+        updateSelectorFlags();
         XPUM_LOG_DEBUG("GroupManager::destroyGroup-group {}", groupId);
     }
 
@@ -102,12 +199,21 @@ xpum_result_t GroupManager::addDeviceToGroup(xpum_group_id_t groupId, xpum_devic
         return XPUM_RESULT_GROUP_NOT_FOUND;
     }
 
-    if (p_devicemanager->getDevice(std::to_string(deviceId)) == nullptr) {
+    if (pGroupInfo->isDynamic()) {
+        XPUM_LOG_DEBUG("GroupManager::addDeviceToGroup- can not add to dynamic group {}", groupId);
+        return XPUM_GROUP_CHANGE_NOT_ALLOWED;
+    }
+
+    if (p_devicemanager->getDevice(deviceId) == nullptr) {
         XPUM_LOG_DEBUG("GroupInfo::addDevice-invalid device id {}", deviceId);
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
 
-    return pGroupInfo->addDevice(deviceId);
+    xpum_result_t res = pGroupInfo->addDevice(deviceId);
+    if (res == XPUM_OK) {
+        registerGroup(pGroupInfo);
+    }
+    return res;
 }
 
 xpum_result_t GroupManager::removeDeviceFromGroup(xpum_group_id_t groupId, xpum_device_id_t deviceId) {
@@ -124,7 +230,16 @@ xpum_result_t GroupManager::removeDeviceFromGroup(xpum_group_id_t groupId, xpum_
         return XPUM_RESULT_GROUP_NOT_FOUND;
     }
 
-    return pGroupInfo->removeDevice(p_devicemanager, groupId, deviceId);
+    if (pGroupInfo->isDynamic()) {
+        XPUM_LOG_DEBUG("GroupManager::removeDeviceFromGroup- can not remove from dynamic group {}", groupId);
+        return XPUM_GROUP_CHANGE_NOT_ALLOWED;
+    }
+
+    xpum_result_t res = pGroupInfo->removeDevice(p_devicemanager, groupId, deviceId);
+    if (res == XPUM_OK) {
+        registerGroup(pGroupInfo);
+    }
+    return res;
 }
 
 xpum_result_t GroupManager::getGroupInfo(xpum_group_id_t groupId, xpum_group_info_t* pGroupInfo) {
@@ -172,6 +287,23 @@ xpum_result_t GroupManager::getAllGroupIds(xpum_group_id_t groupIds[], int* coun
     return XPUM_OK;
 }
 
+bool GroupManager::getCardId(xpum_device_id_t deviceId, xpum_group_id_t* pCardId) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    xpum_device_id_t deviceList[XPUM_MAX_NUM_DEVICES];
+    for (auto& group : groupMap) {
+        if (group.second == nullptr || (group.first & BUILD_IN_GROUP_MASK) != BUILD_IN_GROUP_MASK) {
+            continue;
+        }
+        group.second->getDeviceList(deviceList);
+        auto end = deviceList + group.second->getDeviceCount();
+        if (std::find(deviceList, end, deviceId) != end) {
+            *pCardId = group.first;
+            return true;
+        }
+    }
+    return false;
+}
+
 std::shared_ptr<GroupUnit> GroupManager::getGroupById(xpum_group_id_t groupId) {
     std::shared_ptr<GroupUnit> pGroupInfo;
     GroupMap::iterator groupIterator = groupMap.find(groupId);
@@ -195,6 +327,117 @@ bool deviceInGroup(std::string bdfAddress, std::shared_ptr<GroupUnit> pGroupInfo
     return pGroupInfo->deviceInGroup(pcieTop);
 }
 
+void GroupManager::registerGroup(const std::shared_ptr<GroupUnit>& pGroupInfo) {
+    xpum_device_id_t deviceList[XPUM_MAX_NUM_DEVICES];
+    pGroupInfo->getDeviceList(deviceList);
+    std::vector<xpum_device_id_t> deviceIds(deviceList, deviceList + pGroupInfo->getDeviceCount());
+    p_datalogic->setGroupDevices(pGroupInfo->getId(), deviceIds);
+}
+
+GroupDeviceAttributes& GroupManager::getDeviceAttributes(const std::string& deviceId) {
+    auto iter = deviceAttributes.find(deviceId);
+    if (iter == deviceAttributes.end()) {
+        iter = deviceAttributes.emplace(deviceId, GroupDeviceAttributes()).first;
+        auto p_device = p_devicemanager->getDevice(deviceId);
+        if (p_device != nullptr) {
+            GroupSelector::readStaticAttributes(p_device, iter->second);
+        }
+    }
+    return iter->second;
+}
+
+void GroupManager::evaluateDevice(const std::string& deviceId) {
+    auto& attributes = getDeviceAttributes(deviceId);
+    xpum_device_id_t id = std::stoi(deviceId);
+    for (auto& group : groupMap) {
+        if (group.second == nullptr || !group.second->isDynamic()) {
+            continue;
+        }
+        if (group.second->setDeviceMatched(id, GroupSelector::matches(group.second->getSelector(), attributes))) {
+            XPUM_LOG_DEBUG("GroupManager::evaluateDevice-device {} {} dynamic group {}", deviceId, attributes.detached ? "detached from" : "changed in", group.first);
+            registerGroup(group.second);
+        }
+    }
+}
+
+void GroupManager::updateSelectorFlags() {
+    uint32_t flags = 0;
+    for (auto& group : groupMap) {
+        if (group.second != nullptr && group.second->isDynamic()) {
+            flags |= group.second->getSelector().flags;
+        }
+    }
+    selectorFlags = flags;
+}
+
+void GroupManager::handleMeasurementData(MeasurementType type, std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas) {
+    uint32_t flags = selectorFlags;
+    bool throttle = type == MeasurementType::METRIC_FREQUENCY_THROTTLE_REASON_GPU && (flags & XPUM_GROUP_SELECTOR_THROTTLED);
+    bool health = (type == MeasurementType::METRIC_TEMPERATURE || type == MeasurementType::METRIC_MEMORY_TEMPERATURE || type == MeasurementType::METRIC_POWER) && (flags & XPUM_GROUP_SELECTOR_HEALTH);
+    bool pod = type == MeasurementType::METRIC_ENERGY && (flags & XPUM_GROUP_SELECTOR_POD);
+    if (datas == nullptr || !(throttle || health || pod)) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(this->mutex);
+    std::set<uint32_t> pids;
+    for (auto& data : *datas) {
+        auto& p_measurement = data.second;
+        if (p_measurement == nullptr) {
+            continue;
+        }
+        // the selector attributes are kept by the string id
+        std::string deviceId = std::to_string(data.first);
+        auto& attributes = getDeviceAttributes(deviceId);
+        bool changed = false;
+        if (throttle && p_measurement->hasDataOnDevice()) {
+            bool throttled = p_measurement->getCurrent() != 0 && p_measurement->getCurrent() != std::numeric_limits<uint64_t>::max();
+            changed = throttled != attributes.throttled;
+            attributes.throttled = throttled;
+        }
+        if (health) {
+            xpum_health_status_t status = GroupSelector::readHealth(data.first);
+            changed = status != attributes.health;
+            attributes.health = status;
+        }
+        if (pod) {
+            auto p_device = p_devicemanager->getDevice(data.first);
+            if (p_device != nullptr) {
+                auto pods = readDevicePods(p_device, processPods, pids);
+                changed = pods != attributes.pod_uids;
+                attributes.pod_uids = std::move(pods);
+            }
+        }
+        if (changed) {
+            evaluateDevice(deviceId);
+        }
+    }
+    if (pod) {
+        // a pid reused by another process is read again
+        for (auto iter = processPods.begin(); iter != processPods.end();) {
+            iter = pids.find(iter->first) == pids.end() ? processPods.erase(iter) : std::next(iter);
+        }
+    }
+}
+
+void GroupManager::handleDeviceEvent(const std::string& deviceId, zes_event_type_flags_t events) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    auto& attributes = getDeviceAttributes(deviceId);
+    bool changed = false;
+    if (events & ZES_EVENT_TYPE_FLAG_DEVICE_DETACH) {
+        changed = !attributes.detached;
+        attributes.detached = true;
+    }
+    // HealthManager handles the event before, its status is up to date
+    if (selectorFlags & XPUM_GROUP_SELECTOR_HEALTH) {
+        xpum_health_status_t status = GroupSelector::readHealth(std::stoi(deviceId));
+        changed = changed || status != attributes.health;
+        attributes.health = status;
+    }
+    if (changed) {
+        evaluateDevice(deviceId);
+    }
+}
+
 void GroupManager::createBuildInGroup(bool bBuildInDevice, int vendorId, int deviceId, std::string devID, std::string bdfAddress) {
     GroupMap::iterator iterator;
     if (bBuildInDevice) {
@@ -210,6 +453,7 @@ void GroupManager::createBuildInGroup(bool bBuildInDevice, int vendorId, int dev
 
             if (deviceInGroup(bdfAddress, pGroupInfo)) {
                 pGroupInfo->addDevice(std::stoi(devID));
+                registerGroup(pGroupInfo);
                 return;
             }
         }
@@ -227,6 +471,7 @@ void GroupManager::createBuildInGroup(bool bBuildInDevice, int vendorId, int dev
         return;
     }
     pInfo->addDevice(std::stoi(devID));
+    registerGroup(pInfo);
 
     if (bBuildInDevice) {
         std::vector<zes_pci_address_t> pcieTop;
@@ -343,6 +588,36 @@ void GroupManager::copySlotNameForBuildinGroups() {
 }
 
 void GroupManager::init() {
+    // the dynamic groups follow the samples and the events of the devices, not a timer
+    std::weak_ptr<GroupManager> this_weak_ptr = shared_from_this();
+    this->listening = true;
+    p_datalogic->addMeasurementListener([this_weak_ptr](MeasurementType type, std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas) {
+        auto p_this = this_weak_ptr.lock();
+        if (p_this == nullptr || !p_this->listening) {
+            return;
+        }
+        p_this->handleMeasurementData(type, datas);
+    });
+    if (Configuration::XPUM_MODE != "xpu-smi") {
+        std::vector<std::shared_ptr<Device>> devices;
+        p_devicemanager->getDeviceList(devices);
+        zes_event_type_flags_t events = ZES_EVENT_TYPE_FLAG_MEM_HEALTH | ZES_EVENT_TYPE_FLAG_FABRIC_PORT_HEALTH | ZES_EVENT_TYPE_FLAG_FREQ_THROTTLED |
+                                        ZES_EVENT_TYPE_FLAG_RAS_UNCORRECTABLE_ERRORS | ZES_EVENT_TYPE_FLAG_DEVICE_RESET_REQUIRED | ZES_EVENT_TYPE_FLAG_DEVICE_DETACH;
+        event_subscription = DeviceEventListener::instance().subscribe(devices, events, [this_weak_ptr](const std::string& deviceId, zes_event_type_flags_t events) {
+            auto p_this = this_weak_ptr.lock();
+            if (p_this == nullptr || !p_this->listening) {
+                return;
+            }
+            p_this->handleDeviceEvent(deviceId, events);
+        });
+    }
+
+    // the card groups need the PCIe topology from hwloc, which a one-shot tool may not need
+    char* env = std::getenv("_XPUM_INIT_SKIP");
+    std::string xpum_init_skip_module_list{env != NULL ? env : ""};
+    if (xpum_init_skip_module_list.find("TOPOLOGY") != xpum_init_skip_module_list.npos) {
+        return;
+    }
     createBuildInGroup();
     /* 
     Add a temporary workaround for SMC servers because they return
@@ -358,5 +633,10 @@ void GroupManager::init() {
 }
 
 void GroupManager::close() {
+    this->listening = false;
+    if (event_subscription >= 0) {
+        DeviceEventListener::instance().unsubscribe(event_subscription);
+        event_subscription = -1;
+    }
 }
 } // end namespace xpum
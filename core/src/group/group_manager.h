@@ -6,17 +6,25 @@
 
 #pragma once
 
+#include <atomic>
+#include <map>
+#include <mutex>
+
 #include "../include/xpum_structs.h"
 #include "control/device_manager_interface.h"
 #include "data_logic/data_logic_interface.h"
 #include "group_manager_interface.h"
+#include "group_selector.h"
 #include "group_unit.h"
+#include "level_zero/zes_api.h"
 
 namespace xpum {
 /**
  * The class is responsible for GROUP manager. Two kinds of group are currently supported. 
  * 1. normal group, group id starts from 1
  * 2. build-in group, group id mask with BUILD_IN_GROUP_MASK
+ * A normal group may be dynamic: its devices are the ones matching its selector,
+ * evaluated again for a device when a sample or an event changes what it is matched on.
  */
 
 #define BUILD_IN_GROUP 0
@@ -33,6 +41,10 @@ class GroupManager : public GroupManagerInterface,
 
     xpum_result_t createGroup(const char *pGroupName, xpum_group_id_t *pGroupId, bool buildIn = false) override;
 
+    xpum_result_t createGroupBySelector(const char *pGroupName, const xpum_group_selector_t *pSelector, xpum_group_id_t *pGroupId) override;
+
+    xpum_result_t getGroupSelector(xpum_group_id_t groupId, xpum_group_selector_t *pSelector) override;
+
     xpum_result_t destroyGroup(xpum_group_id_t groupId) override;
 
     xpum_result_t addDeviceToGroup(xpum_group_id_t groupId, xpum_device_id_t deviceId) override;
@@ -43,6 +55,8 @@ class GroupManager : public GroupManagerInterface,
 
     xpum_result_t getAllGroupIds(xpum_group_id_t groupIds[], int *count) override;
 
+    bool getCardId(xpum_device_id_t deviceId, xpum_group_id_t *pCardId) override;
+
     void init() override;
 
     void close() override;
@@ -50,6 +64,9 @@ class GroupManager : public GroupManagerInterface,
    private:
     std::shared_ptr<GroupUnit> getGroupById(xpum_group_id_t groupId);
 
+    // pass the devices of the group to DataLogic, which aggregates the group every sampling tick
+    void registerGroup(const std::shared_ptr<GroupUnit> &pGroupInfo);
+
     GroupManager() = default;
 
     GroupManager &operator=(const GroupManager &) = delete;
@@ -60,6 +77,19 @@ class GroupManager : public GroupManagerInterface,
     void createBuildInGroup(bool bBuildInDevice, int vendorId, int deviceId, std::string devID, std::string bdfAddress);
     void copySlotNameForBuildinGroups();
 
+    // the attributes of the device, the static ones are read on the first call
+    GroupDeviceAttributes &getDeviceAttributes(const std::string &deviceId);
+
+    // add or remove the device in the dynamic groups as it matches their selectors
+    void evaluateDevice(const std::string &deviceId);
+
+    // the flags of the selectors of all the dynamic groups
+    void updateSelectorFlags();
+
+    void handleMeasurementData(MeasurementType type, std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas);
+
+    void handleDeviceEvent(const std::string &deviceId, zes_event_type_flags_t events);
+
    private:
     std::shared_ptr<DeviceManagerInterface> p_devicemanager;
     std::shared_ptr<DataLogicInterface> p_datalogic;
@@ -68,5 +98,12 @@ class GroupManager : public GroupManagerInterface,
     std::atomic_int internalSequence;
     typedef std::map<xpum_group_id_t, std::shared_ptr<GroupUnit>> GroupMap;
     GroupMap groupMap;
+    // by device id
+    std::map<std::string, GroupDeviceAttributes> deviceAttributes;
+    // the pod UID of the processes seen on the devices, by pid
+    std::map<uint32_t, std::string> processPods;
+    std::atomic<uint32_t> selectorFlags;
+    std::atomic_bool listening;
+    int event_subscription;
 };
 } // end namespace xpum
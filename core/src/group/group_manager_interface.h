@@ -17,6 +17,11 @@ class GroupManagerInterface : public InitCloseInterface {
 
     virtual xpum_result_t createGroup(const char *pGroupName, xpum_group_id_t *pGroupId, bool buildIn = false) = 0;
 
+    // a dynamic group, of the devices matching selector while they match it
+    virtual xpum_result_t createGroupBySelector(const char *pGroupName, const xpum_group_selector_t *pSelector, xpum_group_id_t *pGroupId) = 0;
+
+    virtual xpum_result_t getGroupSelector(xpum_group_id_t groupId, xpum_group_selector_t *pSelector) = 0;
+
     virtual xpum_result_t destroyGroup(xpum_group_id_t groupId) = 0;
 
     virtual xpum_result_t addDeviceToGroup(xpum_group_id_t groupId, xpum_device_id_t deviceId) = 0;
@@ -26,5 +31,8 @@ class GroupManagerInterface : public InitCloseInterface {
     virtual xpum_result_t getGroupInfo(xpum_group_id_t groupId, xpum_group_info_t *pGroupInfo) = 0;
 
     virtual xpum_result_t getAllGroupIds(xpum_group_id_t groupIds[XPUM_MAX_NUM_GROUPS], int *count) = 0;
+
+    // the id of the built-in group of the card of the device
+    virtual bool getCardId(xpum_device_id_t deviceId, xpum_group_id_t *pCardId) = 0;
 };
 } // end namespace xpum
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file group_selector.cpp
+ */
+
+#include "group_selector.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "core/core.h"
+#include "infrastructure/logger.h"
+#include "topology/topology.h"
+
+namespace xpum {
+
+static const uint32_t GROUP_SELECTOR_ALL_FLAGS = XPUM_GROUP_SELECTOR_MODEL | XPUM_GROUP_SELECTOR_NUMA_NODE | XPUM_GROUP_SELECTOR_PCIE_SWITCH |
+                                                 XPUM_GROUP_SELECTOR_FUNCTION_TYPE | XPUM_GROUP_SELECTOR_POD | XPUM_GROUP_SELECTOR_HEALTH |
+                                                 XPUM_GROUP_SELECTOR_THROTTLED;
+
+static std::string toLower(std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+    return str;
+}
+
+// the string of a selector field, which may not end with 0
+static std::string selectorString(const char* str) {
+    return std::string(str, strnlen(str, XPUM_MAX_STR_LENGTH));
+}
+
+bool GroupSelector::validate(const xpum_group_selector_t& selector) {
+    if (selector.flags == 0 || (selector.flags & ~GROUP_SELECTOR_ALL_FLAGS) != 0) {
+        return false;
+    }
+    if ((selector.flags & XPUM_GROUP_SELECTOR_MODEL) && selectorString(selector.model).empty()) {
+        return false;
+    }
+    if ((selector.flags & XPUM_GROUP_SELECTOR_NUMA_NODE) && selector.numaNode < 0) {
+        return false;
+    }
+    if ((selector.flags & XPUM_GROUP_SELECTOR_PCIE_SWITCH) && selectorString(selector.pcieSwitch).empty()) {
+        return false;
+    }
+    if ((selector.flags & XPUM_GROUP_SELECTOR_FUNCTION_TYPE) && selector.functionType != DEVICE_FUNCTION_TYPE_VIRTUAL && selector.functionType != DEVICE_FUNCTION_TYPE_PHYSICAL) {
+        return false;
+    }
+    if ((selector.flags & XPUM_GROUP_SELECTOR_POD) && selectorString(selector.podUid).empty()) {
+        return false;
+    }
+    if ((selector.flags & XPUM_GROUP_SELECTOR_HEALTH) && selector.healthStatus != XPUM_HEALTH_STATUS_WARNING && selector.healthStatus != XPUM_HEALTH_STATUS_CRITICAL) {
+        return false;
+    }
+    return true;
+}
+
+std::string GroupSelector::normalizeBdf(const std::string& bdf) {
+    std::string str = toLower(bdf);
+    if (std::count(str.begin(), str.end(), ':') == 1) {
+        str = "0000:" + str;
+    }
+    return str;
+}
+
+void GroupSelector::readStaticAttributes(const std::shared_ptr<Device>& p_device, GroupDeviceAttributes& attributes) {
+    attributes.name = p_device->getPropertyValue(XPUM_DEVICE_PROPERTY_INTERNAL_DEVICE_NAME);
+    attributes.pci_device_id = toLower(p_device->getPropertyValue(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_DEVICE_ID));
+    Property prop;
+    if (p_device->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_DEVICE_FUNCTION_TYPE, prop) && !prop.getValue().empty()) {
+        attributes.function_type = prop.getValueInt();
+    }
+    std::string bdf = normalizeBdf(p_device->getPropertyValue(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS));
+    if (bdf.empty()) {
+        return;
+    }
+    std::ifstream numa("/sys/bus/pci/devices/" + bdf + "/numa_node");
+    if (!(numa >> attributes.numa_node)) {
+        attributes.numa_node = -1;
+    }
+    attributes.pcie_path.push_back(bdf);
+    std::vector<zes_pci_address_t> pcieTop;
+    if (Topology::getPcieTopo(bdf, pcieTop)) {
+        for (auto& address : pcieTop) {
+            char str[16];
+            snprintf(str, sizeof(str), "%04x:%02x:%02x.%x", address.domain, address.bus, address.device, address.function);
+            attributes.pcie_path.push_back(str);
+        }
+    }
+}
+
+xpum_health_status_t GroupSelector::readHealth(xpum_device_id_t deviceId) {
+    xpum_health_status_t worst = XPUM_HEALTH_STATUS_UNKNOWN;
+    auto p_health_manager = Core::instance().getHealthManager();
+    if (p_health_manager == nullptr) {
+        return worst;
+    }
+    for (int type = XPUM_HEALTH_CORE_THERMAL; type <= XPUM_HEALTH_FREQUENCY; type++) {
+        xpum_health_data_t data;
+        if (p_health_manager->getHealth(deviceId, (xpum_health_type_t)type, &data) == XPUM_OK && data.status > worst) {
+            worst = data.status;
+        }
+    }
+    return worst;
+}
+
+bool GroupSelector::matches(const xpum_group_selector_t& selector, const GroupDeviceAttributes& attributes) {
+    if (attributes.detached) {
+        return false;
+    }
+    if (selector.flags & XPUM_GROUP_SELECTOR_MODEL) {
+        std::string model = toLower(selectorString(selector.model));
+        std::string pciId = attributes.pci_device_id.compare(0, 2, "0x") == 0 ? attributes.pci_device_id.substr(2) : attributes.pci_device_id;
+        bool byId = !pciId.empty() && (model == pciId || model == "0x" + pciId);
+        if (!byId && toLower(attributes.name).find(model) == std::string::npos) {
+            return false;
+        }
+    }
+    if ((selector.flags & XPUM_GROUP_SELECTOR_NUMA_NODE) && attributes.numa_node != selector.numaNode) {
+        return false;
+    }
+    if (selector.flags & XPUM_GROUP_SELECTOR_PCIE_SWITCH) {
+        std::string bdf = normalizeBdf(selectorString(selector.pcieSwitch));
+        if (std::find(attributes.pcie_path.begin(), attributes.pcie_path.end(), bdf) == attributes.pcie_path.end()) {
+            return false;
+        }
+    }
+    if ((selector.flags & XPUM_GROUP_SELECTOR_FUNCTION_TYPE) && attributes.function_type != selector.functionType) {
+        return false;
+    }
+    if ((selector.flags & XPUM_GROUP_SELECTOR_POD) && attributes.pod_uids.find(selectorString(selector.podUid)) == attributes.pod_uids.end()) {
+        return false;
+    }
+    if ((selector.flags & XPUM_GROUP_SELECTOR_HEALTH) && attributes.health < selector.healthStatus) {
+        return false;
+    }
+    if ((selector.flags & XPUM_GROUP_SELECTOR_THROTTLED) && !attributes.throttled) {
+        return false;
+    }
+    return true;
+}
+
+} // end namespace xpum
@@ -0,0 +1,59 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file group_selector.h
+ */
+
+#pragma once
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../include/xpum_structs.h"
+#include "device/device.h"
+
+namespace xpum {
+
+// the attributes of a device the selectors of the dynamic groups are matched against
+struct GroupDeviceAttributes {
+    // read once, when the device is first evaluated
+    std::string name;
+    std::string pci_device_id;
+    int numa_node;
+    // the BDFs of the device and the bridges and switches above it, lower case
+    std::vector<std::string> pcie_path;
+    int function_type;
+    // updated from the samples and the events of the device
+    bool throttled;
+    xpum_health_status_t health;
+    std::set<std::string> pod_uids;
+    bool detached;
+
+    GroupDeviceAttributes() : numa_node(-1), function_type(DEVICE_FUNCTION_TYPE_UNKNOWN), throttled(false), health(XPUM_HEALTH_STATUS_UNKNOWN), detached(false) {}
+};
+
+/*
+  GroupSelector matches the selector of a dynamic group against the
+  attributes of a device. The attributes which never change are read once,
+  the others are kept up to date by GroupManager from the samples and the
+  driver events, so a device is matched without reading it again.
+*/
+class GroupSelector {
+   public:
+    // if the selector has conditions, only known ones, with valid values
+    static bool validate(const xpum_group_selector_t& selector);
+
+    static void readStaticAttributes(const std::shared_ptr<Device>& p_device, GroupDeviceAttributes& attributes);
+
+    // the worst status of the health types of the device
+    static xpum_health_status_t readHealth(xpum_device_id_t deviceId);
+
+    static bool matches(const xpum_group_selector_t& selector, const GroupDeviceAttributes& attributes);
+
+    // the BDF in lower case with the PCI domain, "3a:00.0" is "0000:3a:00.0"
+    static std::string normalizeBdf(const std::string& bdf);
+};
+
+} // end namespace xpum
@@ -6,12 +6,14 @@
 
 #include "group_unit.h"
 
+#include <algorithm>
+
 #include "infrastructure/logger.h"
 
 namespace xpum {
 
 GroupUnit::GroupUnit(std::string groupname, xpum_group_id_t groupId)
-    : topoLevel(0) {
+    : topoLevel(0), dynamic(false), selector() {
     XPUM_LOG_TRACE("GroupUnit");
     name = groupname;
     id = groupId;
@@ -103,4 +105,31 @@ bool GroupUnit::deviceInGroup(std::vector<zes_pci_address_t>& pcieTop) {
     return false;
 }
 
+void GroupUnit::setSelector(const xpum_group_selector_t& groupSelector) {
+    selector = groupSelector;
+    dynamic = true;
+}
+
+bool GroupUnit::isDynamic() {
+    return dynamic;
+}
+
+const xpum_group_selector_t& GroupUnit::getSelector() {
+    return selector;
+}
+
+bool GroupUnit::setDeviceMatched(xpum_device_id_t deviceId, bool matched) {
+    auto iter = std::find(deviceList.begin(), deviceList.end(), deviceId);
+    if (matched == (iter != deviceList.end())) {
+        return false;
+    }
+    if (matched) {
+        // in the order of the device ids, as the devices are evaluated on creation
+        deviceList.insert(std::upper_bound(deviceList.begin(), deviceList.end(), deviceId), deviceId);
+    } else {
+        deviceList.erase(iter);
+    }
+    return true;
+}
+
 } // end namespace xpum
@@ -32,11 +32,21 @@ class GroupUnit : public std::enable_shared_from_this<GroupUnit> {
     void setPcieTopo(std::vector<zes_pci_address_t>& pcieTop);
     bool deviceInGroup(std::vector<zes_pci_address_t>& pcieTop);
 
+    // a dynamic group has a selector, its devices are set by GroupManager only
+    void setSelector(const xpum_group_selector_t& groupSelector);
+    bool isDynamic();
+    const xpum_group_selector_t& getSelector();
+
+    // add or remove the device of a dynamic group, true if the devices changed
+    bool setDeviceMatched(xpum_device_id_t deviceId, bool matched);
+
    private:
     xpum_group_id_t id;
     std::string name;
     std::vector<xpum_device_id_t> deviceList;
     std::vector<zes_pci_address_t> pcieTopology;
     std::size_t topoLevel;
+    bool dynamic;
+    xpum_group_selector_t selector;
 };
 } // end namespace xpum
@@ -5,7 +5,22 @@
  */
 
 #pragma once
+#include <string>
+
 #include "../include/xpum_structs.h"
 namespace xpum {
 
+/*
+  The last evaluated health of one component of a device, kept until a device
+  event changes the component or it is older than HEALTH_STATE_MAX_AGE.
+*/
+struct HealthState {
+    bool valid = false;
+    xpum_health_status_t status = xpum_health_status_t::XPUM_HEALTH_STATUS_UNKNOWN;
+    std::string description;
+    long long timestamp = 0;
+    // changed by every event, a state evaluated before an event is not stored
+    uint64_t generation = 0;
+};
+
 } // end namespace xpum
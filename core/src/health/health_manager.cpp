@@ -8,15 +8,38 @@
 
 #include <algorithm>
 
+#include "core/core.h"
+#include "device/gpu/device_event_listener.h"
 #include "device/gpu/gpu_device_stub.h"
+#include "event/event_bus.h"
+#include "event/events.h"
 #include "infrastructure/configuration.h"
 #include "infrastructure/logger.h"
+#include "infrastructure/utility.h"
 
 namespace xpum {
 
+// the driver events that change the health kept in HealthState
+static const zes_event_type_flags_t HEALTH_EVENTS =
+    ZES_EVENT_TYPE_FLAG_MEM_HEALTH | ZES_EVENT_TYPE_FLAG_FABRIC_PORT_HEALTH | ZES_EVENT_TYPE_FLAG_FREQ_THROTTLED |
+    ZES_EVENT_TYPE_FLAG_RAS_UNCORRECTABLE_ERRORS | ZES_EVENT_TYPE_FLAG_DEVICE_RESET_REQUIRED | ZES_EVENT_TYPE_FLAG_DEVICE_DETACH;
+
+// the events after which nothing known about the device holds
+static const zes_event_type_flags_t DEVICE_STATE_EVENTS =
+    ZES_EVENT_TYPE_FLAG_DEVICE_RESET_REQUIRED | ZES_EVENT_TYPE_FLAG_DEVICE_DETACH;
+
+static void setHealthDescription(xpum_health_data_t* data, const std::string& description) {
+    int index = 0;
+    while (index < (int)description.size() && index < XPUM_MAX_STR_LENGTH - 1) {
+        data->description[index] = description[index];
+        index++;
+    }
+    data->description[index] = 0;
+}
+
 HealthManager::HealthManager(std::shared_ptr<DeviceManagerInterface>& p_device_manager,
                              std::shared_ptr<DataLogicInterface>& p_data_logic)
-    : p_device_manager(p_device_manager), p_data_logic(p_data_logic) {
+    : p_device_manager(p_device_manager), p_data_logic(p_data_logic), event_subscription(-1) {
     XPUM_LOG_TRACE("HealthManager()");
     p_health_device_to_tdps = {{0x0205, 150}, {0x0203, 150}, {0x020A, 300}, {0x56C0, 150}, {0x56C1, 37.5}, {0x56C2, 150}, 
                                {0x0BD0, 600}, {0x0BD4, 600}, {0x0BD5, 600}, {0x0BD6, 600}, {0x0BD7, 450}, {0x0BD8, 450},
@@ -31,13 +54,54 @@ HealthManager::~HealthManager() {
 }
 
 void HealthManager::init() {
+    // xpu-smi evaluates the health once per run, only xpumd keeps the states
+    if (Configuration::XPUM_MODE == "xpu-smi" || p_device_manager == nullptr) {
+        return;
+    }
+    std::vector<std::shared_ptr<Device>> devices;
+    p_device_manager->getDeviceList(devices);
+    event_subscription = DeviceEventListener::instance().subscribe(devices, HEALTH_EVENTS,
+        [this](const std::string& deviceId, zes_event_type_flags_t events) {
+            onDeviceEvent(deviceId, events);
+        });
 }
 
 void HealthManager::close() {
+    if (event_subscription >= 0) {
+        DeviceEventListener::instance().unsubscribe(event_subscription);
+        event_subscription = -1;
+    }
+}
+
+void HealthManager::onDeviceEvent(const std::string& deviceId, zes_event_type_flags_t events) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    auto& states = p_health_states[std::stoi(deviceId)];
+    std::vector<xpum_health_type_t> types;
+    if (events & DEVICE_STATE_EVENTS) {
+        for (auto& state : states) {
+            types.push_back(state.first);
+        }
+    } else {
+        if (events & (ZES_EVENT_TYPE_FLAG_MEM_HEALTH | ZES_EVENT_TYPE_FLAG_RAS_UNCORRECTABLE_ERRORS)) {
+            types.push_back(xpum_health_type_t::XPUM_HEALTH_MEMORY);
+        }
+        if (events & ZES_EVENT_TYPE_FLAG_FABRIC_PORT_HEALTH) {
+            types.push_back(xpum_health_type_t::XPUM_HEALTH_FABRIC_PORT);
+        }
+        if (events & ZES_EVENT_TYPE_FLAG_FREQ_THROTTLED) {
+            types.push_back(xpum_health_type_t::XPUM_HEALTH_FREQUENCY);
+        }
+    }
+    for (auto type : types) {
+        auto& state = states[type];
+        state.valid = false;
+        state.generation++;
+        XPUM_LOG_DEBUG("Health {} of device {} is changed by an event", type, deviceId);
+    }
 }
 
 xpum_result_t HealthManager::setHealthConfig(xpum_device_id_t deviceId, xpum_health_config_type_t key, void* value) {
-    if (this->p_device_manager->getDevice(std::to_string(deviceId)) == nullptr) {
+    if (this->p_device_manager->getDevice(deviceId) == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
 
@@ -60,11 +124,7 @@ xpum_result_t HealthManager::setHealthConfig(xpum_device_id_t deviceId, xpum_hea
     }
 
     int threshold = *static_cast<int*>(value);
-    Property prop;
-    std::string pciDeviceId;
-    if (this->p_device_manager->getDevice(std::to_string(deviceId))->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_DEVICE_ID, prop)) {
-        pciDeviceId = prop.getValue();
-    }
+    std::string pciDeviceId = this->p_device_manager->getDevice(deviceId)->getPropertyValue(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_DEVICE_ID);
     int limit = -1;
     switch (key) {
         case xpum_health_config_type_t::XPUM_HEALTH_CORE_THERMAL_LIMIT:
@@ -92,7 +152,7 @@ xpum_result_t HealthManager::setHealthConfig(xpum_device_id_t deviceId, xpum_hea
 }
 
 xpum_result_t HealthManager::getHealthConfig(xpum_device_id_t deviceId, xpum_health_config_type_t key, void* value) {
-    if (this->p_device_manager->getDevice(std::to_string(deviceId)) == nullptr) {
+    if (this->p_device_manager->getDevice(deviceId) == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
 
@@ -127,20 +187,19 @@ xpum_result_t HealthManager::getHealthConfig(xpum_device_id_t deviceId, xpum_hea
 }
 
 xpum_result_t HealthManager::getHealth(xpum_device_id_t deviceId, xpum_health_type_t type, xpum_health_data_t* data) {
-    if (this->p_device_manager->getDevice(std::to_string(deviceId)) == nullptr) {
+    if (this->p_device_manager->getDevice(deviceId) == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
 
+    // nullptr while the core is initialized, the fabric ports are read here then
+    auto p_monitor_manager = Core::instance().getMonitorManager();
+
     std::unique_lock<std::mutex> lock(this->mutex);
     data->deviceId = deviceId;
     data->type = type;
     data->status = xpum_health_status_t::XPUM_HEALTH_STATUS_UNKNOWN;
 
-    Property prop;
-    std::string pciDeviceId;
-    if (this->p_device_manager->getDevice(std::to_string(deviceId))->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_DEVICE_ID, prop)) {
-        pciDeviceId = prop.getValue();
-    }
+    std::string pciDeviceId = this->p_device_manager->getDevice(deviceId)->getPropertyValue(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_DEVICE_ID);
     if (type == xpum_health_type_t::XPUM_HEALTH_CORE_THERMAL) {
         data->throttleThreshold = getThrottleCoreTemperature(pciDeviceId);
         data->shutdownThreshold = getShutdownCoreTemperature(pciDeviceId);
@@ -180,9 +239,80 @@ xpum_result_t HealthManager::getHealth(xpum_device_id_t deviceId, xpum_health_ty
         global_default_limit = false;
     }
 
+    // the latest monitor samples, those too old to tell the current state are not used
+    std::shared_ptr<MeasurementData> p_latest_power;
+    std::shared_ptr<MeasurementData> p_latest_temperature;
+    if (p_data_logic != nullptr) {
+        std::string device_id = std::to_string(deviceId);
+        if (type == xpum_health_type_t::XPUM_HEALTH_POWER) {
+            p_latest_power = p_data_logic->getLatestData(MeasurementType::METRIC_POWER, device_id);
+        } else if (type == xpum_health_type_t::XPUM_HEALTH_CORE_THERMAL) {
+            p_latest_temperature = p_data_logic->getLatestData(MeasurementType::METRIC_TEMPERATURE, device_id);
+        } else if (type == xpum_health_type_t::XPUM_HEALTH_MEMORY_THERMAL) {
+            p_latest_temperature = p_data_logic->getLatestData(MeasurementType::METRIC_MEMORY_TEMPERATURE, device_id);
+        }
+    }
+    long long now = Utility::getCurrentMillisecond();
+    if (p_latest_power != nullptr && now - (long long)p_latest_power->getTimestamp() > Configuration::HEALTH_STATE_MAX_AGE) {
+        p_latest_power = nullptr;
+    }
+    if (p_latest_temperature != nullptr && now - (long long)p_latest_temperature->getTimestamp() > Configuration::HEALTH_STATE_MAX_AGE) {
+        p_latest_temperature = nullptr;
+    }
+
+    // the components changed by driver events are only evaluated again after one
+    bool keep_state = event_subscription >= 0 && (type == xpum_health_type_t::XPUM_HEALTH_MEMORY ||
+                                                  type == xpum_health_type_t::XPUM_HEALTH_FABRIC_PORT ||
+                                                  type == xpum_health_type_t::XPUM_HEALTH_FREQUENCY);
+    uint64_t generation = 0;
+    if (keep_state) {
+        auto& state = p_health_states[deviceId][type];
+        // a change of the fabric ports seen by the monitor without a driver event also takes effect
+        bool changed = type == xpum_health_type_t::XPUM_HEALTH_FABRIC_PORT && p_monitor_manager != nullptr &&
+                       (long long)p_monitor_manager->getFabricPortChangeTime(std::to_string(deviceId)) >= state.timestamp;
+        if (state.valid && !changed && now - state.timestamp <= Configuration::HEALTH_STATE_MAX_AGE) {
+            data->status = state.status;
+            setHealthDescription(data, state.description);
+            return XPUM_OK;
+        }
+        generation = state.generation;
+    }
+    auto device_handle = this->p_device_manager->getDevice(deviceId)->getDeviceHandle();
+    lock.unlock();
+
+    std::vector<port_info> fabric_ports;
+    bool latest_fabric_ports = false;
+    if (type == xpum_health_type_t::XPUM_HEALTH_FABRIC_PORT && p_monitor_manager != nullptr) {
+        p_monitor_manager->getFabricPorts(std::to_string(deviceId), fabric_ports);
+        latest_fabric_ports = true;
+    }
     GPUDeviceStub::instance().getHealthStatus(
-        this->p_device_manager->getDevice(std::to_string(deviceId))->getDeviceHandle(), type, data, core_thermal_thresold, memory_thermal_thresold, power_threshold, global_default_limit);
+        device_handle, type, data, core_thermal_thresold, memory_thermal_thresold, power_threshold, global_default_limit,
+        p_latest_power, p_latest_temperature, latest_fabric_ports ? &fabric_ports : nullptr);
 
+    // the driver sends no event when throttling ends, so a throttled frequency is not kept
+    if (!keep_state || (type == xpum_health_type_t::XPUM_HEALTH_FREQUENCY && data->status != xpum_health_status_t::XPUM_HEALTH_STATUS_OK)) {
+        return XPUM_OK;
+    }
+    lock.lock();
+    auto& state = p_health_states[deviceId][type];
+    if (state.generation == generation) {
+        bool changed = state.status != data->status;
+        HealthEvent event;
+        event.deviceId = deviceId;
+        event.type = type;
+        event.status = data->status;
+        event.previousStatus = state.status;
+        event.timestamp = now;
+        state.valid = true;
+        state.status = data->status;
+        state.description = data->description;
+        state.timestamp = now;
+        lock.unlock();
+        if (changed) {
+            EventBus<HealthEvent>::instance().publish(event);
+        }
+    }
     return XPUM_OK;
 }
 
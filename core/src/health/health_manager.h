@@ -6,10 +6,14 @@
 
 #pragma once
 
+#include <map>
+#include <mutex>
+
 #include "control/device_manager_interface.h"
 #include "data_logic/data_logic_interface.h"
 #include "health_data_type.h"
 #include "health_manager_interface.h"
+#include "level_zero/zes_api.h"
 
 namespace xpum {
 
@@ -18,6 +22,10 @@ namespace xpum {
  * power, temperature, memory and fabric port. In addition, users can set reasonable thresholds for power
  * and temperature to suit their needs.
  *
+ * The thermal and power health are evaluated from the latest monitor samples. The memory, fabric port and
+ * frequency health are evaluated through Level Zero once and kept, until a driver event of the component
+ * arrives or the state is older than HEALTH_STATE_MAX_AGE.
+ *
  */
 
 class HealthManager : public HealthManagerInterface {
@@ -39,6 +47,8 @@ class HealthManager : public HealthManagerInterface {
     xpum_result_t getHealth(xpum_device_id_t deviceId, xpum_health_type_t type, xpum_health_data_t *data) override;
 
    private:
+    void onDeviceEvent(const std::string &deviceId, zes_event_type_flags_t events);
+
     uint64_t getThrottlePower(std::string pciDeviceId);
 
     uint64_t getThrottleCoreTemperature(std::string pciDeviceId);
@@ -65,6 +75,10 @@ class HealthManager : public HealthManagerInterface {
 
     std::map<uint32_t, uint64_t> p_health_device_to_shutdown_memory_temperatures;
 
+    std::map<xpum_device_id_t, std::map<xpum_health_type_t, HealthState>> p_health_states;
+
+    int event_subscription;
+
     std::mutex mutex;
 };
 
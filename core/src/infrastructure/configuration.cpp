@@ -6,6 +6,7 @@
 
 #include "configuration.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <cstdlib>
@@ -36,8 +37,61 @@ int Configuration::EU_ACTIVE_STALL_IDLE_MONITOR_INTERNAL_PERIOD = 50;
 int Configuration::EU_ACTIVE_STALL_IDLE_STREAMER_SAMPLING_PERIOD = 20000000;
 bool Configuration::INITIALIZE_PCIE_MANAGER = false;
 uint32_t Configuration::DEFAULT_MEASUREMENT_DATA_SCALE = 100;
-uint32_t Configuration::MAX_STATISTICS_SESSION_NUM = 2;
+uint32_t Configuration::MAX_STATISTICS_SESSION_NUM = 1024;
+// the sessions used by xpu-smi and xpumd, their begin timestamps are set when monitoring starts
+uint32_t Configuration::DEFAULT_STATISTICS_SESSION_NUM = 2;
 bool Configuration::INITIALIZE_PERF_METRIC = false;
+std::string Configuration::PERSISTENCY_DIR;
+// 0 sizes the raw file of a metric from PERSISTENCY_RETENTION
+uint32_t Configuration::PERSISTENCY_FILE_SIZE = 0;
+// hours of raw samples kept
+uint32_t Configuration::PERSISTENCY_RETENTION = 24;
+uint32_t Configuration::PERSISTENCY_ROLLUP_FILE_SIZE = 4 * 1024 * 1024;
+std::string Configuration::DISCOVERY_CACHE_FILE = "/var/cache/xpum/discovery_cache.json";
+std::string Configuration::DIAGNOSTIC_KERNEL_CACHE_DIR = "/var/cache/xpum/kernels";
+std::string Configuration::PRECHECK_LOG_STATE_FILE = "/var/cache/xpum/precheck_log_state.json";
+std::string Configuration::CHECKPOINT_FILE;
+std::string Configuration::PLUGIN_DIR = XPUM_PLUGIN_DIR;
+uint32_t Configuration::CHECKPOINT_INTERVAL = 30;
+bool Configuration::MONITOR_DEVICE_SWEEP = false;
+bool Configuration::MONITOR_ADAPTIVE_SAMPLING = false;
+bool Configuration::MONITOR_BIND_THREADS = false;
+bool Configuration::MONITOR_HUGE_PAGES = false;
+bool Configuration::MONITOR_DEVICE_LANES = false;
+uint32_t Configuration::MONITOR_DEVICE_DEADLINE = 0;
+std::string Configuration::ENGINE_ACTIVITY_PMU;
+bool Configuration::STAGED_CAPABILITY_PROBING = false;
+bool Configuration::HOTPLUG_REDISCOVERY = false;
+uint32_t Configuration::ADAPTIVE_SAMPLING_MAX_FACTOR = 8;
+uint32_t Configuration::ADAPTIVE_SAMPLING_STABLE_TICKS = 5;
+uint32_t Configuration::ADAPTIVE_SAMPLING_CHANGE_THRESHOLD = 2;
+uint32_t Configuration::PERF_METRIC_RETENTION = 60 * 1000;
+uint32_t Configuration::TELEMETRY_MEMORY_LIMIT = 0;
+double Configuration::CPU_BUDGET = 0;
+uint32_t Configuration::CPU_BUDGET_INTERVAL = 10;
+uint32_t Configuration::RAS_EVENT_POLL_FACTOR = 10;
+uint32_t Configuration::DUMP_FLUSH_SIZE = 64 * 1024;
+uint32_t Configuration::DUMP_FLUSH_INTERVAL = 1000;
+bool Configuration::DUMP_FSYNC = false;
+uint32_t Configuration::BURST_SAMPLING_MIN_INTERVAL = 10;
+uint32_t Configuration::BURST_SAMPLING_MAX_DURATION = 60 * 1000;
+uint32_t Configuration::BURST_SAMPLING_MAX_SAMPLES = 64 * 1024;
+bool Configuration::PRECHECK_WATCH = true;
+uint32_t Configuration::PRECHECK_WATCH_REFRESH_INTERVAL = 60 * 1000;
+uint32_t Configuration::HEALTH_STATE_MAX_AGE = 60 * 1000;
+uint32_t Configuration::SIMULATED_DEVICE_COUNT = 0;
+uint32_t Configuration::SIMULATED_DEVICE_TILES = 2;
+uint32_t Configuration::SIMULATED_FABRIC_PORTS = 4;
+uint32_t Configuration::FIRMWARE_FLASH_PARALLELISM = 8;
+uint32_t Configuration::FIRMWARE_IMAGE_CACHE_SIZE = 4;
+uint32_t Configuration::AMC_SENSOR_REFRESH_INTERVAL = 5000;
+uint32_t Configuration::VGPU_PROVISION_PARALLELISM = 8;
+uint32_t Configuration::PCIE_SAMPLING_INTERVAL = 100;
+bool Configuration::HOST_TELEMETRY = false;
+std::string Configuration::HOUSEKEEPING_CPUS;
+int32_t Configuration::HOUSEKEEPING_NODE = -1;
+int32_t Configuration::THREAD_NICE = 0;
+uint32_t Configuration::DEVICE_CONFIG_MAX_AGE = 5 * 60 * 1000;
 
 std::set<MeasurementType> Configuration::enabled_metrics;
 std::shared_ptr<std::set<int>> Configuration::enabled_gpu_ids;
@@ -211,4 +265,408 @@ void Configuration::initPerfMetrics() {
     conf_file.close();
 }
 
+void Configuration::initPersistency() {
+    char* dir_env = std::getenv("XPUM_PERSISTENCY_DIR");
+    if (dir_env != NULL) {
+        PERSISTENCY_DIR = dir_env;
+        XPUM_LOG_INFO("The environment variable XPUM_PERSISTENCY_DIR is detected: {}", PERSISTENCY_DIR);
+    }
+    char* size_env = std::getenv("XPUM_PERSISTENCY_FILE_SIZE");
+    if (size_env != NULL) {
+        try {
+            // size of each metric file in KB
+            PERSISTENCY_FILE_SIZE = std::stoul(size_env) * 1024;
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_PERSISTENCY_FILE_SIZE: {}", size_env);
+        }
+    }
+    char* retention_env = std::getenv("XPUM_PERSISTENCY_RETENTION");
+    if (retention_env != NULL) {
+        try {
+            // hours of raw samples, ignored when XPUM_PERSISTENCY_FILE_SIZE is set
+            uint32_t retention = std::stoul(retention_env);
+            if (retention > 0) {
+                PERSISTENCY_RETENTION = retention;
+            }
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_PERSISTENCY_RETENTION: {}", retention_env);
+        }
+    }
+    char* rollup_size_env = std::getenv("XPUM_PERSISTENCY_ROLLUP_FILE_SIZE");
+    if (rollup_size_env != NULL) {
+        try {
+            // size of each rollup file of a metric in KB
+            PERSISTENCY_ROLLUP_FILE_SIZE = std::stoul(rollup_size_env) * 1024;
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_PERSISTENCY_ROLLUP_FILE_SIZE: {}", rollup_size_env);
+        }
+    }
+    // an empty value disables the discovery cache
+    char* cache_env = std::getenv("XPUM_DISCOVERY_CACHE_FILE");
+    if (cache_env != NULL) {
+        DISCOVERY_CACHE_FILE = cache_env;
+        XPUM_LOG_INFO("The environment variable XPUM_DISCOVERY_CACHE_FILE is detected: {}", DISCOVERY_CACHE_FILE);
+    }
+    // an empty value keeps the native binaries of the diagnostic kernels in memory only
+    char* kernel_cache_env = std::getenv("XPUM_DIAGNOSTIC_KERNEL_CACHE_DIR");
+    if (kernel_cache_env != NULL) {
+        DIAGNOSTIC_KERNEL_CACHE_DIR = kernel_cache_env;
+        XPUM_LOG_INFO("The environment variable XPUM_DIAGNOSTIC_KERNEL_CACHE_DIR is detected: {}", DIAGNOSTIC_KERNEL_CACHE_DIR);
+    }
+    // an empty value makes precheck scan all kernel messages of the boot every time
+    char* precheck_env = std::getenv("XPUM_PRECHECK_LOG_STATE_FILE");
+    if (precheck_env != NULL) {
+        PRECHECK_LOG_STATE_FILE = precheck_env;
+        XPUM_LOG_INFO("The environment variable XPUM_PRECHECK_LOG_STATE_FILE is detected: {}", PRECHECK_LOG_STATE_FILE);
+    }
+    // the directory of the subsystems built as plugins, like libxpum_diagnostic.so
+    char* plugin_env = std::getenv("XPUM_PLUGIN_DIR");
+    if (plugin_env != NULL) {
+        PLUGIN_DIR = plugin_env;
+        XPUM_LOG_INFO("The environment variable XPUM_PLUGIN_DIR is detected: {}", PLUGIN_DIR);
+    }
+    // the telemetry state kept across restarts of xpumd, an empty value disables the checkpoints
+    char* checkpoint_env = std::getenv("XPUM_CHECKPOINT_FILE");
+    if (checkpoint_env != NULL) {
+        CHECKPOINT_FILE = checkpoint_env;
+        XPUM_LOG_INFO("The environment variable XPUM_CHECKPOINT_FILE is detected: {}", CHECKPOINT_FILE);
+    }
+    // seconds between two checkpoints, the last one is written when xpumd stops
+    checkpoint_env = std::getenv("XPUM_CHECKPOINT_INTERVAL");
+    if (checkpoint_env != NULL) {
+        try {
+            CHECKPOINT_INTERVAL = std::stoul(checkpoint_env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_CHECKPOINT_INTERVAL: {}", checkpoint_env);
+        }
+    }
+    if (CHECKPOINT_INTERVAL < 1) {
+        CHECKPOINT_INTERVAL = 1;
+    }
+}
+
+void Configuration::initMonitor() {
+    // sample all metrics of a device in one sweep per tick instead of one task per metric
+    char* env = std::getenv("XPUM_MONITOR_DEVICE_SWEEP");
+    if (env != NULL && std::string(env) == "1") {
+        MONITOR_DEVICE_SWEEP = true;
+        XPUM_LOG_INFO("The environment variable XPUM_MONITOR_DEVICE_SWEEP is detected");
+    }
+    // sample stable gauges less often, up to ADAPTIVE_SAMPLING_MAX_FACTOR times the monitor period
+    env = std::getenv("XPUM_MONITOR_ADAPTIVE_SAMPLING");
+    if (env != NULL && std::string(env) == "1") {
+        MONITOR_ADAPTIVE_SAMPLING = true;
+        XPUM_LOG_INFO("The environment variable XPUM_MONITOR_ADAPTIVE_SAMPLING is detected");
+    }
+    // the threads sampling one device run on the CPUs local to the device and prefer the memory of its NUMA node
+    env = std::getenv("XPUM_MONITOR_BIND_THREADS");
+    if (env != NULL && std::string(env) == "1") {
+        MONITOR_BIND_THREADS = true;
+        XPUM_LOG_INFO("The environment variable XPUM_MONITOR_BIND_THREADS is detected");
+    }
+    // the burst sample buffers and the persistent storage mappings ask for transparent huge pages
+    env = std::getenv("XPUM_MONITOR_HUGE_PAGES");
+    if (env != NULL && std::string(env) == "1") {
+        MONITOR_HUGE_PAGES = true;
+        XPUM_LOG_INFO("The environment variable XPUM_MONITOR_HUGE_PAGES is detected");
+    }
+    // every device is collected in its own threads, a device with hanging calls is skipped and backs off;
+    // xpu-smi samples once and waits for all devices
+    MONITOR_DEVICE_LANES = XPUM_MODE != "xpu-smi";
+    env = std::getenv("XPUM_MONITOR_DEVICE_LANES");
+    if (env != NULL && std::string(env) == "0") {
+        MONITOR_DEVICE_LANES = false;
+        XPUM_LOG_INFO("The environment variable XPUM_MONITOR_DEVICE_LANES is detected");
+    }
+    // the time a tick waits for the collection of a device (in milliseconds), 0 for the period of the task
+    env = std::getenv("XPUM_MONITOR_DEVICE_DEADLINE");
+    if (env != NULL) {
+        try {
+            MONITOR_DEVICE_DEADLINE = std::stoul(env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_MONITOR_DEVICE_DEADLINE: {}", env);
+        }
+    }
+    // the engine activities of the GPUs of these PCI device ids, or of "all", are read from the i915 PMU
+    env = std::getenv("XPUM_ENGINE_ACTIVITY_PMU");
+    if (env != NULL) {
+        ENGINE_ACTIVITY_PMU = env;
+        XPUM_LOG_INFO("The environment variable XPUM_ENGINE_ACTIVITY_PMU is detected: {}", ENGINE_ACTIVITY_PMU);
+    }
+    // the devices are available once discovered, their capabilities are probed in the background;
+    // xpu-smi needs them right away for its one-shot queries
+    STAGED_CAPABILITY_PROBING = XPUM_MODE != "xpu-smi";
+    env = std::getenv("XPUM_STAGED_CAPABILITY_PROBING");
+    if (env != NULL && std::string(env) == "0") {
+        STAGED_CAPABILITY_PROBING = false;
+        XPUM_LOG_INFO("The environment variable XPUM_STAGED_CAPABILITY_PROBING is detected");
+    }
+    // the devices are discovered again when a GPU is added, removed, reset or rebound to its driver
+    HOTPLUG_REDISCOVERY = XPUM_MODE != "xpu-smi";
+    env = std::getenv("XPUM_HOTPLUG_REDISCOVERY");
+    if (env != NULL && std::string(env) == "0") {
+        HOTPLUG_REDISCOVERY = false;
+        XPUM_LOG_INFO("The environment variable XPUM_HOTPLUG_REDISCOVERY is detected");
+    }
+    env = std::getenv("XPUM_ADAPTIVE_SAMPLING_MAX_FACTOR");
+    if (env != NULL) {
+        try {
+            ADAPTIVE_SAMPLING_MAX_FACTOR = std::max(1ul, std::stoul(env));
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_ADAPTIVE_SAMPLING_MAX_FACTOR: {}", env);
+        }
+    }
+    // a change larger than this percentage of the previous value restores the full rate
+    env = std::getenv("XPUM_ADAPTIVE_SAMPLING_CHANGE_THRESHOLD");
+    if (env != NULL) {
+        try {
+            ADAPTIVE_SAMPLING_CHANGE_THRESHOLD = std::stoul(env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_ADAPTIVE_SAMPLING_CHANGE_THRESHOLD: {}", env);
+        }
+    }
+    // the RAS errors of a device that sends RAS events are read every this many ticks, and after each event
+    env = std::getenv("XPUM_RAS_EVENT_POLL_FACTOR");
+    if (env != NULL) {
+        try {
+            RAS_EVENT_POLL_FACTOR = std::max(1ul, std::stoul(env));
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_RAS_EVENT_POLL_FACTOR: {}", env);
+        }
+    }
+    // the performance metric samples of a device kept for the windowed queries (in milliseconds)
+    env = std::getenv("XPUM_PERF_METRIC_RETENTION");
+    if (env != NULL) {
+        try {
+            PERF_METRIC_RETENTION = std::stoul(env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_PERF_METRIC_RETENTION: {}", env);
+        }
+    }
+    // the memory the telemetry caches may hold before the sample windows are shrunk (in MB), 0 for no limit
+    env = std::getenv("XPUM_TELEMETRY_MEMORY_LIMIT");
+    if (env != NULL) {
+        try {
+            TELEMETRY_MEMORY_LIMIT = std::stoul(env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_TELEMETRY_MEMORY_LIMIT: {}", env);
+        }
+    }
+    // the CPU time xpumd may spend on its own (in percent of one core), the sampling is cut when it is over, 0 for no budget
+    env = std::getenv("XPUM_CPU_BUDGET");
+    if (env != NULL) {
+        try {
+            CPU_BUDGET = std::max(0.0, std::stod(env));
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_CPU_BUDGET: {}", env);
+        }
+    }
+    // the CPU time is checked against the budget every this many seconds
+    env = std::getenv("XPUM_CPU_BUDGET_INTERVAL");
+    if (env != NULL) {
+        try {
+            CPU_BUDGET_INTERVAL = std::max(1ul, std::stoul(env));
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_CPU_BUDGET_INTERVAL: {}", env);
+        }
+    }
+}
+
+void Configuration::initDump() {
+    // buffered dump rows are written out when this many bytes are pending (in KB)
+    char* size_env = std::getenv("XPUM_DUMP_FLUSH_SIZE");
+    if (size_env != NULL) {
+        try {
+            DUMP_FLUSH_SIZE = std::stoul(size_env) * 1024;
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_DUMP_FLUSH_SIZE: {}", size_env);
+        }
+    }
+    // or when the oldest pending row is older than this (in ms), 0 writes every row
+    char* interval_env = std::getenv("XPUM_DUMP_FLUSH_INTERVAL");
+    if (interval_env != NULL) {
+        try {
+            DUMP_FLUSH_INTERVAL = std::stoul(interval_env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_DUMP_FLUSH_INTERVAL: {}", interval_env);
+        }
+    }
+    char* fsync_env = std::getenv("XPUM_DUMP_FSYNC");
+    if (fsync_env != NULL && std::string(fsync_env) == "1") {
+        DUMP_FSYNC = true;
+        XPUM_LOG_INFO("The environment variable XPUM_DUMP_FSYNC is detected");
+    }
+}
+
+void Configuration::initHealth() {
+    // a health state not updated by a device event is evaluated again after this (in ms)
+    char* env = std::getenv("XPUM_HEALTH_STATE_MAX_AGE");
+    if (env != NULL) {
+        try {
+            HEALTH_STATE_MAX_AGE = std::stoul(env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_HEALTH_STATE_MAX_AGE: {}", env);
+        }
+    }
+}
+
+void Configuration::initDiagnostic() {
+    // xpumd follows the kernel log to keep the precheck result current, 0 runs a full precheck per call
+    char* env = std::getenv("XPUM_PRECHECK_WATCH");
+    if (env != NULL && std::string(env) == "0") {
+        PRECHECK_WATCH = false;
+        XPUM_LOG_INFO("The environment variable XPUM_PRECHECK_WATCH is detected");
+    }
+    // the checks not based on the kernel log are run again after this (in ms)
+    env = std::getenv("XPUM_PRECHECK_WATCH_REFRESH_INTERVAL");
+    if (env != NULL) {
+        try {
+            PRECHECK_WATCH_REFRESH_INTERVAL = std::stoul(env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_PRECHECK_WATCH_REFRESH_INTERVAL: {}", env);
+        }
+    }
+}
+
+void Configuration::initSimulation() {
+    // xpumd uses this number of simulated GPUs instead of the real ones, for scale testing
+    char* env = std::getenv("XPUM_SIMULATED_DEVICES");
+    if (env != NULL) {
+        try {
+            SIMULATED_DEVICE_COUNT = std::stoul(env);
+            XPUM_LOG_INFO("The environment variable XPUM_SIMULATED_DEVICES is detected");
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_SIMULATED_DEVICES: {}", env);
+        }
+    }
+    // the tiles of each simulated GPU
+    env = std::getenv("XPUM_SIMULATED_DEVICE_TILES");
+    if (env != NULL) {
+        try {
+            SIMULATED_DEVICE_TILES = std::max(std::stoul(env), 1UL);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_SIMULATED_DEVICE_TILES: {}", env);
+        }
+    }
+    // the Xe Link ports of each tile of a simulated GPU, 0 for none
+    env = std::getenv("XPUM_SIMULATED_FABRIC_PORTS");
+    if (env != NULL) {
+        try {
+            SIMULATED_FABRIC_PORTS = std::stoul(env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_SIMULATED_FABRIC_PORTS: {}", env);
+        }
+    }
+}
+
+void Configuration::initFirmware() {
+    // the cards flashed at a time when the firmware of all devices is flashed, 0 for no limit
+    char* env = std::getenv("XPUM_FIRMWARE_FLASH_PARALLELISM");
+    if (env != NULL) {
+        try {
+            FIRMWARE_FLASH_PARALLELISM = std::stoul(env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_FIRMWARE_FLASH_PARALLELISM: {}", env);
+        }
+    }
+
+    // the firmware images kept mapped after their flashes
+    env = std::getenv("XPUM_FIRMWARE_IMAGE_CACHE_SIZE");
+    if (env != NULL) {
+        try {
+            FIRMWARE_IMAGE_CACHE_SIZE = std::stoul(env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_FIRMWARE_IMAGE_CACHE_SIZE: {}", env);
+        }
+    }
+}
+
+void Configuration::initAmc() {
+    // the interval in milliseconds of the AMC sensor readings collected over IPMI
+    char* env = std::getenv("XPUM_AMC_SENSOR_REFRESH_INTERVAL");
+    if (env != NULL) {
+        try {
+            AMC_SENSOR_REFRESH_INTERVAL = std::stoul(env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_AMC_SENSOR_REFRESH_INTERVAL: {}", env);
+        }
+    }
+}
+
+void Configuration::initVgpu() {
+    // the VFs whose sysfs attributes are written at a time when VFs are created or removed
+    char* env = std::getenv("XPUM_VGPU_PROVISION_PARALLELISM");
+    if (env != NULL) {
+        try {
+            VGPU_PROVISION_PARALLELISM = std::stoul(env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_VGPU_PROVISION_PARALLELISM: {}", env);
+        }
+    }
+    if (VGPU_PROVISION_PARALLELISM == 0) {
+        VGPU_PROVISION_PARALLELISM = 1;
+    }
+}
+
+void Configuration::initPcie() {
+    // the interval in milliseconds of the PCIe IIO counter samples of pcm-iio-gpu
+    char* env = std::getenv("XPUM_PCIE_SAMPLING_INTERVAL");
+    if (env != NULL) {
+        try {
+            PCIE_SAMPLING_INTERVAL = std::stoul(env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_PCIE_SAMPLING_INTERVAL: {}", env);
+        }
+    }
+    if (PCIE_SAMPLING_INTERVAL < 10) {
+        PCIE_SAMPLING_INTERVAL = 10;
+    }
+    // the DRAM, UPI and IIO stack traffic of the host sockets, sampled with the PCIe counters
+    env = std::getenv("XPUM_HOST_TELEMETRY");
+    if (env != NULL && std::string(env) == "1") {
+        HOST_TELEMETRY = true;
+        INITIALIZE_PCIE_MANAGER = true;
+        XPUM_LOG_INFO("The environment variable XPUM_HOST_TELEMETRY is detected");
+    }
+}
+
+void Configuration::initThreads() {
+    // the CPUs the threads of XPUM run on, like "0-1,64-65", the isolated cores of the jobs are left out
+    char* env = std::getenv("XPUM_HOUSEKEEPING_CPUS");
+    if (env != NULL) {
+        HOUSEKEEPING_CPUS = env;
+        XPUM_LOG_INFO("The environment variable XPUM_HOUSEKEEPING_CPUS is detected");
+    }
+    // the NUMA node whose CPUs the threads also run on and whose memory they prefer
+    env = std::getenv("XPUM_HOUSEKEEPING_NODE");
+    if (env != NULL) {
+        try {
+            HOUSEKEEPING_NODE = std::stoi(env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_HOUSEKEEPING_NODE: {}", env);
+        }
+    }
+    // the nice value of the threads, from 0 to 19, a higher one leaves more CPU time to the jobs
+    env = std::getenv("XPUM_THREAD_NICE");
+    if (env != NULL) {
+        try {
+            THREAD_NICE = std::min(19, std::max(0, std::stoi(env)));
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_THREAD_NICE: {}", env);
+        }
+    }
+}
+
+void Configuration::initDeviceConfig() {
+    // a device configuration not changed by XPUM or a device event is read again after this (in ms), 0 reads it on every query
+    char* env = std::getenv("XPUM_DEVICE_CONFIG_MAX_AGE");
+    if (env != NULL) {
+        try {
+            DEVICE_CONFIG_MAX_AGE = std::stoul(env);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Invalid XPUM_DEVICE_CONFIG_MAX_AGE: {}", env);
+        }
+    }
+}
+
 } // end namespace xpum
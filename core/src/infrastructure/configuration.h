@@ -40,8 +40,58 @@ class Configuration {
     static bool INITIALIZE_PCIE_MANAGER;
     static uint32_t DEFAULT_MEASUREMENT_DATA_SCALE;
     static uint32_t MAX_STATISTICS_SESSION_NUM;
+    static uint32_t DEFAULT_STATISTICS_SESSION_NUM;
     static bool INITIALIZE_PERF_METRIC;
     static std::string XPUM_MODE;
+    static std::string PERSISTENCY_DIR;
+    static uint32_t PERSISTENCY_FILE_SIZE;
+    static uint32_t PERSISTENCY_RETENTION;
+    static uint32_t PERSISTENCY_ROLLUP_FILE_SIZE;
+    static std::string DISCOVERY_CACHE_FILE;
+    static std::string DIAGNOSTIC_KERNEL_CACHE_DIR;
+    static std::string PRECHECK_LOG_STATE_FILE;
+    static std::string CHECKPOINT_FILE;
+    static std::string PLUGIN_DIR;
+    static uint32_t CHECKPOINT_INTERVAL;
+    static bool MONITOR_DEVICE_SWEEP;
+    static bool MONITOR_ADAPTIVE_SAMPLING;
+    static bool MONITOR_BIND_THREADS;
+    static bool MONITOR_HUGE_PAGES;
+    static bool MONITOR_DEVICE_LANES;
+    static uint32_t MONITOR_DEVICE_DEADLINE;
+    static std::string ENGINE_ACTIVITY_PMU;
+    static bool STAGED_CAPABILITY_PROBING;
+    static bool HOTPLUG_REDISCOVERY;
+    static uint32_t ADAPTIVE_SAMPLING_MAX_FACTOR;
+    static uint32_t ADAPTIVE_SAMPLING_STABLE_TICKS;
+    static uint32_t ADAPTIVE_SAMPLING_CHANGE_THRESHOLD;
+    static uint32_t PERF_METRIC_RETENTION;
+    static uint32_t TELEMETRY_MEMORY_LIMIT;
+    static double CPU_BUDGET;
+    static uint32_t CPU_BUDGET_INTERVAL;
+    static uint32_t RAS_EVENT_POLL_FACTOR;
+    static uint32_t DUMP_FLUSH_SIZE;
+    static uint32_t DUMP_FLUSH_INTERVAL;
+    static bool DUMP_FSYNC;
+    static uint32_t BURST_SAMPLING_MIN_INTERVAL;
+    static uint32_t BURST_SAMPLING_MAX_DURATION;
+    static uint32_t BURST_SAMPLING_MAX_SAMPLES;
+    static uint32_t HEALTH_STATE_MAX_AGE;
+    static bool PRECHECK_WATCH;
+    static uint32_t PRECHECK_WATCH_REFRESH_INTERVAL;
+    static uint32_t SIMULATED_DEVICE_COUNT;
+    static uint32_t SIMULATED_DEVICE_TILES;
+    static uint32_t SIMULATED_FABRIC_PORTS;
+    static uint32_t FIRMWARE_FLASH_PARALLELISM;
+    static uint32_t FIRMWARE_IMAGE_CACHE_SIZE;
+    static uint32_t AMC_SENSOR_REFRESH_INTERVAL;
+    static uint32_t VGPU_PROVISION_PARALLELISM;
+    static uint32_t PCIE_SAMPLING_INTERVAL;
+    static bool HOST_TELEMETRY;
+    static std::string HOUSEKEEPING_CPUS;
+    static int32_t HOUSEKEEPING_NODE;
+    static int32_t THREAD_NICE;
+    static uint32_t DEVICE_CONFIG_MAX_AGE;
 
    public:
     static void init() {
@@ -64,11 +114,35 @@ class Configuration {
         initEnabledMetrics();
         initEnabledGPUIds();
         initPerfMetrics();
+        initPersistency();
+        initMonitor();
+        initDump();
+        initHealth();
+        initDiagnostic();
+        initSimulation();
+        initFirmware();
+        initAmc();
+        initVgpu();
+        initPcie();
+        initThreads();
+        initDeviceConfig();
     }
 
     static void initEnabledMetrics();
     static void initEnabledGPUIds();
     static void initPerfMetrics();
+    static void initPersistency();
+    static void initMonitor();
+    static void initDump();
+    static void initHealth();
+    static void initDiagnostic();
+    static void initSimulation();
+    static void initFirmware();
+    static void initAmc();
+    static void initVgpu();
+    static void initPcie();
+    static void initThreads();
+    static void initDeviceConfig();
 
     static std::set<MeasurementType>& getEnabledMetrics() {
         return enabled_metrics;
@@ -32,6 +32,7 @@ enum class DeviceCapability : int {
     METRIC_FABRIC_THROUGHPUT,
     METRIC_PERF,
     METRIC_FREQUENCY_THROTTLE_REASON_GPU,
+    METRIC_VF_ENGINE_UTILIZATION,
 
     DEVICE_CAPABILITY_MAX,
 };
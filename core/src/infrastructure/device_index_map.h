@@ -0,0 +1,198 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file device_index_map.h
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace xpum {
+
+/*
+  DeviceIndexMap keeps a value per device in a vector indexed by the dense
+  index DeviceManager assigns at discovery, Device::getIndex(). A lookup is
+  an index, not a string compare. It iterates the devices in index order
+  like a std::map by the numeric id, entry.first is the index. The values
+  need a default constructor, a slot is kept when its device is erased.
+*/
+template <class T>
+class DeviceIndexMap {
+   public:
+    typedef std::pair<uint32_t, T> value_type;
+
+   private:
+    template <class Map, class Value>
+    class Iterator {
+       public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::pair<uint32_t, T> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Value* pointer;
+        typedef Value& reference;
+
+        Iterator() : map(nullptr), position(0) {}
+
+        Iterator(Map* map, size_t position) : map(map), position(position) {
+            skip();
+        }
+
+        // an iterator converts to a const_iterator
+        template <class OtherMap, class OtherValue>
+        Iterator(const Iterator<OtherMap, OtherValue>& other) : map(other.map), position(other.position) {}
+
+        reference operator*() const {
+            return map->slots[position];
+        }
+
+        pointer operator->() const {
+            return &map->slots[position];
+        }
+
+        Iterator& operator++() {
+            ++position;
+            skip();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return position == other.position;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return position != other.position;
+        }
+
+       private:
+        template <class, class>
+        friend class Iterator;
+
+        void skip() {
+            while (position < map->slots.size() && !map->used[position]) {
+                ++position;
+            }
+        }
+
+        Map* map;
+
+        size_t position;
+    };
+
+   public:
+    typedef Iterator<DeviceIndexMap, value_type> iterator;
+
+    typedef Iterator<const DeviceIndexMap, const value_type> const_iterator;
+
+    iterator begin() {
+        return iterator(this, 0);
+    }
+
+    iterator end() {
+        return iterator(this, slots.size());
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, slots.size());
+    }
+
+    iterator find(uint32_t index) {
+        return iterator(this, contains(index) ? index : slots.size());
+    }
+
+    const_iterator find(uint32_t index) const {
+        return const_iterator(this, contains(index) ? index : slots.size());
+    }
+
+    bool contains(uint32_t index) const {
+        return index < slots.size() && used[index];
+    }
+
+    // the value of the device, default constructed if the device has none
+    T& operator[](uint32_t index) {
+        if (index >= slots.size()) {
+            grow(index + 1);
+        }
+        if (!used[index]) {
+            used[index] = true;
+            slots[index].second = T();
+            ++count;
+        }
+        return slots[index].second;
+    }
+
+    // the value of the device is only set if it has none
+    std::pair<iterator, bool> emplace(uint32_t index, T value) {
+        if (contains(index)) {
+            return std::make_pair(iterator(this, index), false);
+        }
+        (*this)[index] = std::move(value);
+        return std::make_pair(iterator(this, index), true);
+    }
+
+    void erase(uint32_t index) {
+        if (contains(index)) {
+            used[index] = false;
+            slots[index].second = T();
+            --count;
+        }
+    }
+
+    // the slots for the devices up to index slot_count - 1, so they are not grown one by one
+    void reserve(uint32_t slot_count) {
+        if (slot_count > slots.size()) {
+            grow(slot_count);
+        }
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    // the number of slots, the largest index of a device plus one
+    size_t capacity() const {
+        return slots.size();
+    }
+
+    void clear() {
+        slots.clear();
+        used.clear();
+        count = 0;
+    }
+
+   private:
+    void grow(size_t new_size) {
+        size_t old_size = slots.size();
+        slots.resize(new_size);
+        used.resize(new_size, false);
+        for (size_t i = old_size; i < new_size; ++i) {
+            slots[i].first = static_cast<uint32_t>(i);
+        }
+    }
+
+    std::vector<value_type> slots;
+
+    std::vector<bool> used;
+
+    size_t count = 0;
+};
+
+} // end namespace xpum
@@ -13,6 +13,11 @@ namespace xpum {
         this->memSize = 0;
         this->sharedMemSize = 0;
         this->deviceId = 0;
+        this->renderingEngineUtil = 0;
+        this->computeEngineUtil = 0;
+        this->copyEngineUtil = 0;
+        this->mediaEngineUtil = 0;
+        this->mediaEnhancementUtil = 0;
    }
 
     void device_util_by_proc::setval(device_util_by_proc *putil) {
@@ -21,6 +26,11 @@ namespace xpum {
         this->processName = putil->getProcessName();
         this->memSize = putil->getMemSize();
         this->sharedMemSize = putil->getSharedMemSize();
+        this->renderingEngineUtil = putil->getRenderingEngineUtil();
+        this->computeEngineUtil = putil->getComputeEngineUtil();
+        this->copyEngineUtil = putil->getCopyEngineUtil();
+        this->mediaEngineUtil = putil->getMediaEnigineUtil();
+        this->mediaEnhancementUtil = putil->getMediaEnhancementUtil();
    }
 
     void device_util_by_proc::merge(device_util_by_proc *putil) {
@@ -46,6 +56,26 @@ namespace xpum {
         this->processName = processName;
     }
 
+    void device_util_by_proc::setRenderingEngineUtil(double util) {
+        this->renderingEngineUtil = util;
+    }
+
+    void device_util_by_proc::setComputeEngineUtil(double util) {
+        this->computeEngineUtil = util;
+    }
+
+    void device_util_by_proc::setCopyEngineUtil(double util) {
+        this->copyEngineUtil = util;
+    }
+
+    void device_util_by_proc::setMediaEngineUtil(double util) {
+        this->mediaEngineUtil = util;
+    }
+
+    void device_util_by_proc::setMediaEnhancementUtil(double util) {
+        this->mediaEnhancementUtil = util;
+    }
+
     uint32_t device_util_by_proc::getDeviceId() {
         return this->deviceId;
     }
@@ -67,23 +97,23 @@ namespace xpum {
     }
 
     double device_util_by_proc::getComputeEngineUtil() {
-        return 0;
+        return this->computeEngineUtil;
     }
 
     double device_util_by_proc::getRenderingEngineUtil() {
-        return 0;
+        return this->renderingEngineUtil;
     }
 
     double device_util_by_proc::getCopyEngineUtil() {
-        return 0;
+        return this->copyEngineUtil;
     }   
 
     double device_util_by_proc::getMediaEnigineUtil() {
-        return 0;
+        return this->mediaEngineUtil;
     }
 
     double device_util_by_proc::getMediaEnhancementUtil() {
-        return 0;
+        return this->mediaEnhancementUtil;
     }
 
 } // end namespace xpum
@@ -17,6 +17,11 @@ private:
     uint64_t memSize;
     uint64_t sharedMemSize;
     std::string processName;
+    double renderingEngineUtil;
+    double computeEngineUtil;
+    double copyEngineUtil;
+    double mediaEngineUtil;
+    double mediaEnhancementUtil;
 
 public:
     device_util_by_proc(uint32_t processId);
@@ -38,6 +43,11 @@ public:
     void setMemSize(uint64_t memSize);
     void setSharedMemSize(uint64_t sharedMemSize);
     void setProcessName(std::string processName);
+    void setRenderingEngineUtil(double util);
+    void setComputeEngineUtil(double util);
+    void setCopyEngineUtil(double util);
+    void setMediaEngineUtil(double util);
+    void setMediaEnhancementUtil(double util);
 
     char d_name[32];
 };
@@ -14,16 +14,22 @@ void EngineCollectionMeasurementData::addRawData(uint64_t handle,
                                                  uint32_t subdevice_id,
                                                  uint64_t raw_active_time,
                                                  uint64_t raw_timestamp) {
-    (*p_engine_datas)[handle].type = type;
-    (*p_engine_datas)[handle].raw_active_time = raw_active_time;
-    (*p_engine_datas)[handle].raw_timestamp = raw_timestamp;
-    (*p_engine_datas)[handle].on_subdevice = on_subdevice;
-    (*p_engine_datas)[handle].subdevice_id = subdevice_id;
+    uint32_t index = p_multi_metrics_schema->indexOf(handle);
+    if (index >= engine_datas.size()) {
+        engine_datas.resize(index + 1);
+    }
+    auto& data = engine_datas[index];
+    data.valid = true;
+    data.type = type;
+    data.raw_active_time = raw_active_time;
+    data.raw_timestamp = raw_timestamp;
+    data.on_subdevice = on_subdevice;
+    data.subdevice_id = subdevice_id;
 }
 
-zes_engine_group_t EngineCollectionMeasurementData::getEngineType(uint64_t handle) {
-    if (p_engine_datas->find(handle) != p_engine_datas->end()) {
-        return (*p_engine_datas)[handle].type;
+zes_engine_group_t EngineCollectionMeasurementData::getEngineType(uint32_t index) {
+    if (index < engine_datas.size() && engine_datas[index].valid) {
+        return engine_datas[index].type;
     }
     return ZES_ENGINE_GROUP_FORCE_UINT32;
 }
@@ -11,35 +11,42 @@
 namespace xpum {
 
 struct EngineRawData_t {
+    // false for the engines of the schema not read in this sample
+    bool valid;
     zes_engine_group_t type;
     uint64_t raw_active_time;
     uint64_t raw_timestamp;
     bool on_subdevice;
     uint32_t subdevice_id;
     EngineRawData_t() {
+        valid = false;
         type = ZES_ENGINE_GROUP_FORCE_UINT32;
         raw_active_time = std::numeric_limits<uint64_t>::max();
         raw_timestamp = 0;
         on_subdevice = false;
+        subdevice_id = 0;
     };
 };
 
+/*
+  EngineCollectionMeasurementData holds the activities of the engines of a
+  device, indexed by the engine schema of the device. The utilizations
+  calculated from them are the multi metrics datas, with the same indexes.
+*/
 class EngineCollectionMeasurementData : public MeasurementData {
    public:
-    EngineCollectionMeasurementData() {
-        p_engine_datas = std::make_shared<std::map<uint64_t, EngineRawData_t>>();
-    }
-    ~EngineCollectionMeasurementData() {
-        p_engine_datas->clear();
+    EngineCollectionMeasurementData(const std::shared_ptr<MultiMetricsSchema>& schema) {
+        p_multi_metrics_schema = schema;
     }
     void addRawData(uint64_t handle, zes_engine_group_t type, bool on_subdevice, uint32_t subdevice_id, uint64_t raw_active_time, uint64_t raw_timestamp);
-    const std::shared_ptr<std::map<uint64_t, EngineRawData_t>> getEngineRawDatas() {
-        return p_engine_datas;
+    const std::vector<EngineRawData_t>& getEngineRawDatas() {
+        return engine_datas;
     }
-    zes_engine_group_t getEngineType(uint64_t handle);
+    // the type of the engine at index, ZES_ENGINE_GROUP_FORCE_UINT32 if it is not read
+    zes_engine_group_t getEngineType(uint32_t index);
 
    private:
-    std::shared_ptr<std::map<uint64_t, EngineRawData_t>> p_engine_datas;
+    std::vector<EngineRawData_t> engine_datas;
 };
 
-} //namespace xpum
\ No newline at end of file
+} //namespace xpum
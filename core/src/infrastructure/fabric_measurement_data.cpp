@@ -15,14 +15,18 @@ void FabricMeasurementData::addRawData(uint64_t handle,
                                        uint32_t attach_id,
                                        uint32_t remote_fabric_id,
                                        uint32_t remote_attach_id) {
-    FabricRawData_t data;
+    uint32_t index = p_port_schema->indexOf(handle);
+    if (index >= fabric_datas.size()) {
+        fabric_datas.resize(index + 1);
+    }
+    auto& data = fabric_datas[index];
+    data.valid = true;
     data.timestamp = timestamp;
     data.rx_counter = rx_counter;
     data.tx_counter = tx_counter;
     data.attach_id = attach_id;
     data.remote_fabric_id = remote_fabric_id;
     data.remote_attach_id = remote_attach_id;
-    (*p_fabric_datas)[handle] = data;
 }
 
 } //namespace xpum
\ No newline at end of file
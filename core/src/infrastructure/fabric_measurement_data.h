@@ -11,6 +11,8 @@
 namespace xpum {
 
 struct FabricRawData_t {
+    // false for the ports of the schema not read in this sample
+    bool valid;
     uint64_t timestamp;
     uint64_t rx_counter;
     uint64_t tx_counter;
@@ -18,6 +20,7 @@ struct FabricRawData_t {
     uint32_t remote_fabric_id;
     uint32_t remote_attach_id;
     FabricRawData_t() {
+        valid = false;
         timestamp = 0;
         rx_counter = 0;
         tx_counter = 0;
@@ -27,21 +30,28 @@ struct FabricRawData_t {
     };
 };
 
+/*
+  FabricMeasurementData holds the counters of the fabric ports of a device,
+  indexed by the fabric port schema of the device. The throughputs calculated
+  from them are the multi metrics datas, indexed by the fabric throughput
+  schema of the device.
+*/
 class FabricMeasurementData : public MeasurementData {
    public:
-    FabricMeasurementData() {
-        p_fabric_datas = std::make_shared<std::map<uint64_t, FabricRawData_t>>();
-    }
-    ~FabricMeasurementData() {
-        p_fabric_datas->clear();
+    FabricMeasurementData(const std::shared_ptr<MultiMetricsSchema>& port_schema) : p_port_schema(port_schema) {
     }
     void addRawData(uint64_t handle, uint64_t timestamp, uint64_t rx_counter, uint64_t tx_counter, uint32_t attach_id, uint32_t remote_fabric_id, uint32_t remote_attach_id);
-    const std::shared_ptr<std::map<uint64_t, FabricRawData_t>> getFabricRawDatas() {
-        return p_fabric_datas;
+    const std::vector<FabricRawData_t>& getFabricRawDatas() {
+        return fabric_datas;
+    }
+    const std::shared_ptr<MultiMetricsSchema>& getPortSchema() {
+        return p_port_schema;
     }
 
    private:
-    std::shared_ptr<std::map<uint64_t, FabricRawData_t>> p_fabric_datas;
+    std::shared_ptr<MultiMetricsSchema> p_port_schema;
+
+    std::vector<FabricRawData_t> fabric_datas;
 };
 
-} //namespace xpum
\ No newline at end of file
+} //namespace xpum
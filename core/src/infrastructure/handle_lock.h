@@ -6,54 +6,90 @@
 
 #pragma once
 
-#ifdef XPUM_ZE_HANDLE_LOCK_LOG
-#include "logger.h"
-#endif
-
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
+#include "internal_stats.h"
+
 namespace xpum {
+
+/*
+  HandleLock keeps one lock for each Level Zero handle. The locks are never
+  removed, so a thread caches the locks it has resolved and only takes a
+  registry lock the first time it sees a handle. The registry is sharded by
+  handle, threads resolving different handles rarely wait for each other.
+*/
 class HandleLock {
    public:
     template <typename T>
-    static std::shared_ptr<std::mutex> getHandleMutex(T& handle) {
-        auto p = (void*)(handle);
-        std::lock_guard<std::mutex> lock(handle_mutexes_mutex);
-        auto it = handle_mutexes.find(p);
-        if (it != handle_mutexes.end()) {
-            return it->second;
-        } else {
-            handle_mutexes[p] = std::make_shared<std::mutex>();
-            return handle_mutexes[p];
-        }
+    static std::shared_timed_mutex& getHandleMutex(T& handle) {
+        return getMutex((void*)(handle));
     }
 
    private:
-    static std::mutex handle_mutexes_mutex;
-    static std::unordered_map<void*, std::shared_ptr<std::mutex>> handle_mutexes;
+    static const uint32_t SHARD_NUM = 64;
+
+    static const uint32_t THREAD_CACHE_SIZE = 64;
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<void*, std::unique_ptr<std::shared_timed_mutex>> handle_mutexes;
+    };
+
+    struct CacheEntry {
+        void* handle;
+        std::shared_timed_mutex* p_mutex;
+    };
+
+    static uint32_t hashHandle(void* p) {
+        uintptr_t v = (uintptr_t)p;
+        return (uint32_t)((v >> 4) ^ (v >> 12) ^ (v >> 20));
+    }
+
+    static std::shared_timed_mutex& getMutex(void* p) {
+        thread_local CacheEntry cache[THREAD_CACHE_SIZE] = {};
+        uint32_t hash = hashHandle(p);
+        CacheEntry& entry = cache[hash % THREAD_CACHE_SIZE];
+        if (entry.handle == p && entry.p_mutex != nullptr) {
+            return *entry.p_mutex;
+        }
+        Shard& shard = shards[hash % SHARD_NUM];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto& p_mutex = shard.handle_mutexes[p];
+        if (p_mutex == nullptr) {
+            p_mutex.reset(new std::shared_timed_mutex());
+        }
+        entry.handle = p;
+        entry.p_mutex = p_mutex.get();
+        return *p_mutex;
+    }
+
+    static Shard shards[SHARD_NUM];
 };
 
 } // namespace xpum
 
-#ifdef XPUM_ZE_HANDLE_LOCK_LOG
-#define XPUM_ZE_HANDLE_LOCK(handle, zefunc)                                                                                                              \
-    {                                                                                                                                                    \
-        using namespace std::chrono;                                                                                                                     \
-        auto t0 = high_resolution_clock::now();                                                                                                          \
-        std::lock_guard<std::mutex> lock(*HandleLock::getHandleMutex((handle)));                                                                         \
-        auto t1 = high_resolution_clock::now();                                                                                                          \
-        zefunc;                                                                                                                                          \
-        auto t2 = high_resolution_clock::now();                                                                                                          \
-        auto duration1 = duration_cast<microseconds>(t1 - t0);                                                                                           \
-        auto duration2 = duration_cast<microseconds>(t2 - t1);                                                                                           \
-        XPUM_LOG_INFO("{}({}): get lock for {} in {} us, exec in {} us", __FUNCTION__, __LINE__, (void*)(handle), duration1.count(), duration2.count()); \
+/*
+  XPUM_ZE_HANDLE_LOCK serializes the calls on a handle, XPUM_ZE_HANDLE_SHARED_LOCK
+  is for read-only queries, which may run at the same time on the same handle.
+  The time waiting for the lock and the time of the call are recorded in
+  InternalStats.
+*/
+#define XPUM_ZE_HANDLE_LOCK_IMPL(lock_type, handle, zefunc)                                                        \
+    {                                                                                                                \
+        auto xpum_lock_begin = std::chrono::steady_clock::now();                                                     \
+        lock_type<std::shared_timed_mutex> lock(HandleLock::getHandleMutex((handle)));                               \
+        auto xpum_call_begin = std::chrono::steady_clock::now();                                                     \
+        zefunc;                                                                                                      \
+        auto xpum_call_end = std::chrono::steady_clock::now();                                                       \
+        InternalStats::instance().recordZeCall(#zefunc,                                                              \
+                                               std::chrono::duration_cast<std::chrono::nanoseconds>(xpum_call_begin - xpum_lock_begin).count(), \
+                                               std::chrono::duration_cast<std::chrono::nanoseconds>(xpum_call_end - xpum_call_begin).count());  \
     }
-#else
-#define XPUM_ZE_HANDLE_LOCK(handle, zefunc)                                      \
-    {                                                                            \
-        std::lock_guard<std::mutex> lock(*HandleLock::getHandleMutex((handle))); \
-        zefunc;                                                                  \
-    }
-#endif
\ No newline at end of file
+
+#define XPUM_ZE_HANDLE_LOCK(handle, zefunc) XPUM_ZE_HANDLE_LOCK_IMPL(std::unique_lock, handle, zefunc)
+#define XPUM_ZE_HANDLE_SHARED_LOCK(handle, zefunc) XPUM_ZE_HANDLE_LOCK_IMPL(std::shared_lock, handle, zefunc)
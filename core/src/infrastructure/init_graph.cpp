@@ -0,0 +1,143 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file init_graph.cpp
+ */
+
+#include "init_graph.h"
+
+#include <algorithm>
+
+#include "infrastructure/exception/ilegal_state_exception.h"
+#include "infrastructure/logger.h"
+#include "infrastructure/thread_factory.h"
+
+namespace xpum {
+
+static long long elapsedMilliseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+InitGraph::InitGraph(const std::string& name) : name(name), running(0) {
+}
+
+InitGraph::~InitGraph() {
+    join();
+}
+
+void InitGraph::add(const std::string& name, const std::vector<std::string>& dependencies, std::function<void()> init, bool critical) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Step step{name, {}, init, critical, PENDING};
+    for (auto& dependency : dependencies) {
+        auto iter = std::find_if(steps.begin(), steps.end(), [&dependency](const Step& s) { return s.name == dependency; });
+        if (iter == steps.end()) {
+            throw IlegalStateException("Init step " + name + " depends on unknown step " + dependency);
+        }
+        step.dependencies.push_back(iter - steps.begin());
+    }
+    steps.push_back(step);
+}
+
+bool InitGraph::isFinished(const Step& step) const {
+    return step.state == DONE || step.state == FAILED || step.state == SKIPPED;
+}
+
+void InitGraph::schedule() {
+    // the dependencies of a step come before it, one pass sees every skip it depends on
+    for (size_t i = 0; i < steps.size(); i++) {
+        auto& step = steps[i];
+        if (step.state != PENDING) {
+            continue;
+        }
+        bool ready = true;
+        bool blocked = error != nullptr;
+        for (auto dependency : step.dependencies) {
+            State state = steps[dependency].state;
+            if (state == FAILED || state == SKIPPED) {
+                blocked = true;
+            } else if (state != DONE) {
+                ready = false;
+            }
+        }
+        if (blocked) {
+            step.state = SKIPPED;
+            XPUM_LOG_WARN("{}: skip init step {}", name, step.name);
+        } else if (ready) {
+            step.state = RUNNING;
+            running++;
+            workers.push_back(ThreadFactory::create("xpum-init", [this, i]() { execute(i); }));
+        }
+    }
+}
+
+void InitGraph::execute(size_t index) {
+    std::function<void()> init;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        init = steps[index].init;
+    }
+    auto begin = std::chrono::steady_clock::now();
+    std::exception_ptr failure;
+    try {
+        init();
+    } catch (...) {
+        failure = std::current_exception();
+    }
+    long long cost = elapsedMilliseconds(begin);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& step = steps[index];
+    if (failure == nullptr) {
+        step.state = DONE;
+        XPUM_LOG_INFO("{}: {} done in {} ms, at {} ms", name, step.name, cost, elapsedMilliseconds(start_time));
+    } else {
+        step.state = FAILED;
+        try {
+            std::rethrow_exception(failure);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("{}: {} failed in {} ms: {}", name, step.name, cost, e.what());
+        } catch (...) {
+            XPUM_LOG_WARN("{}: {} failed in {} ms: unexpected exception", name, step.name, cost);
+        }
+        if (step.critical && error == nullptr) {
+            error = failure;
+        }
+    }
+    running--;
+    schedule();
+    cv.notify_all();
+}
+
+void InitGraph::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    start_time = std::chrono::steady_clock::now();
+    schedule();
+    cv.wait(lock, [this]() {
+        if (error != nullptr) {
+            return running == 0;
+        }
+        return std::all_of(steps.begin(), steps.end(), [this](const Step& step) { return !step.critical || isFinished(step); });
+    });
+    if (error != nullptr) {
+        std::rethrow_exception(error);
+    }
+    size_t background = std::count_if(steps.begin(), steps.end(), [this](const Step& step) { return !isFinished(step); });
+    XPUM_LOG_INFO("{}: ready in {} ms, {} init steps left in the background", name, elapsedMilliseconds(start_time), background);
+}
+
+void InitGraph::join() {
+    std::vector<std::thread> threads;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        // a step is only started when another one finishes, nothing starts once none runs
+        cv.wait(lock, [this]() { return running == 0; });
+        threads.swap(workers);
+    }
+    for (auto& t : threads) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+}
+
+} // end namespace xpum
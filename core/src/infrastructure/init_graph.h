@@ -0,0 +1,92 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file init_graph.h
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xpum {
+
+/*
+  InitGraph runs the initialization steps of a subsystem by their
+  dependencies, every step in its own thread as soon as the steps it
+  depends on are done, so the independent steps run concurrently and the
+  whole takes about as long as its slowest chain of steps. The time of
+  every step is logged.
+
+  run() returns once the critical steps are done, the others keep running
+  in the background until join(). A step whose dependency failed is
+  skipped, no step is started after a critical one failed and run() throws
+  its exception once the running steps are done.
+*/
+class InitGraph {
+   public:
+    explicit InitGraph(const std::string& name);
+
+    ~InitGraph();
+
+    InitGraph(const InitGraph&) = delete;
+
+    InitGraph& operator=(const InitGraph&) = delete;
+
+    // the dependencies are steps added before, which keeps the graph acyclic
+    void add(const std::string& name, const std::vector<std::string>& dependencies, std::function<void()> init, bool critical = true);
+
+    void run();
+
+    // wait for the background steps
+    void join();
+
+   private:
+    enum State {
+        PENDING,
+        RUNNING,
+        DONE,
+        FAILED,
+        SKIPPED,
+    };
+
+    struct Step {
+        std::string name;
+        std::vector<size_t> dependencies;
+        std::function<void()> init;
+        bool critical;
+        State state;
+    };
+
+    // start the steps that are ready and skip those that can not run, with the mutex held
+    void schedule();
+
+    void execute(size_t index);
+
+    bool isFinished(const Step& step) const;
+
+    std::string name;
+
+    std::vector<Step> steps;
+
+    std::vector<std::thread> workers;
+
+    std::chrono::steady_clock::time_point start_time;
+
+    size_t running;
+
+    // the exception of the first critical step failed
+    std::exception_ptr error;
+
+    std::mutex mutex;
+
+    std::condition_variable cv;
+};
+
+} // end namespace xpum
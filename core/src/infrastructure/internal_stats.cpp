@@ -0,0 +1,210 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file internal_stats.cpp
+ */
+
+#include "internal_stats.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+#include "memory_accounting.h"
+
+namespace xpum {
+
+thread_local int32_t InternalStats::current_device = -1;
+
+thread_local InternalStats::CallCost* InternalStats::current_cost = nullptr;
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other) {
+    count += other.count;
+    sum += other.sum;
+    max = std::max(max, other.max);
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+        buckets[i] += other.buckets[i];
+    }
+}
+
+uint64_t LatencyHistogram::Snapshot::quantile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(q * count);
+    if (rank >= count) {
+        rank = count - 1;
+    }
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i];
+        if (seen > rank) {
+            return std::min(upperBoundOf(i), max);
+        }
+    }
+    return max;
+}
+
+void LatencyHistogram::mergeTo(Snapshot& snapshot) const {
+    // the fields are read one by one, a record() in between only skews the snapshot by one value
+    snapshot.count += count.load(std::memory_order_relaxed);
+    snapshot.sum += sum.load(std::memory_order_relaxed);
+    snapshot.max = std::max(snapshot.max, max.load(std::memory_order_relaxed));
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+        snapshot.buckets[i] += buckets[i].load(std::memory_order_relaxed);
+    }
+}
+
+uint64_t LatencyHistogram::upperBoundOf(uint32_t bucket) {
+    if (bucket < 2 * SUB_BUCKET_COUNT) {
+        return bucket;
+    }
+    uint32_t exponent = bucket / SUB_BUCKET_COUNT + SUB_BUCKET_BITS - 1;
+    uint64_t width = 1ULL << (exponent - SUB_BUCKET_BITS);
+    return (SUB_BUCKET_COUNT + bucket % SUB_BUCKET_COUNT) * width + width - 1;
+}
+
+int32_t InternalStats::toDeviceId(const std::string& deviceId) {
+    try {
+        return std::stoi(deviceId);
+    } catch (std::exception&) {
+        return -1;
+    }
+}
+
+InternalStats::ThreadBufferHolder::ThreadBufferHolder() : p_buffer(std::make_shared<ThreadBuffer>()) {
+    auto& stats = InternalStats::instance();
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    stats.buffers.push_back(p_buffer);
+}
+
+InternalStats::ThreadBufferHolder::~ThreadBufferHolder() {
+    auto& stats = InternalStats::instance();
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    mergeBuffer(*p_buffer, stats.retired);
+    stats.buffers.erase(std::remove(stats.buffers.begin(), stats.buffers.end(), p_buffer), stats.buffers.end());
+}
+
+InternalStats& InternalStats::instance() {
+    static InternalStats stats;
+    return stats;
+}
+
+InternalStats::Entry& InternalStats::addEntry(ThreadBuffer& buffer, const Key& key) {
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    auto& p_entry = buffer.entries[key];
+    p_entry.reset(new Entry());
+    return *p_entry;
+}
+
+void InternalStats::mergeBuffer(ThreadBuffer& buffer, std::unordered_map<Key, MergedStats, KeyHash>& merged) {
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    for (auto& entry : buffer.entries) {
+        auto& stats = merged[entry.first];
+        entry.second->histogram.mergeTo(stats.histogram);
+        stats.errors += entry.second->errors.load(std::memory_order_relaxed);
+    }
+}
+
+/*
+  The site is the call expression, e.g. "res = zesDeviceEnumFabricPorts(device, &count, nullptr)",
+  the function is the first identifier followed by a parenthesis.
+*/
+std::string InternalStats::getFunctionName(const char* site) {
+    const char* p = site;
+    while (*p != '\0') {
+        if (isalpha(*p) || *p == '_') {
+            const char* begin = p;
+            while (isalnum(*p) || *p == '_') {
+                p++;
+            }
+            const char* end = p;
+            while (isspace(*p)) {
+                p++;
+            }
+            if (*p == '(') {
+                return std::string(begin, end);
+            }
+        } else {
+            p++;
+        }
+    }
+    return site;
+}
+
+xpum_result_t InternalStats::getStats(xpum_internal_stats_t dataList[], uint32_t* count) {
+    std::unordered_map<Key, MergedStats, KeyHash> merged;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        merged = retired;
+        for (auto& p_buffer : buffers) {
+            mergeBuffer(*p_buffer, merged);
+        }
+    }
+
+    // the call sites of the same function and device are reported together
+    std::map<std::tuple<xpum_internal_stats_type_t, std::string, int32_t>, MergedStats> by_name;
+    std::unordered_map<const char*, std::string> function_names;
+    for (auto& entry : merged) {
+        std::string name;
+        if (entry.first.type == XPUM_INTERNAL_STATS_ZE_LOCK_WAIT || entry.first.type == XPUM_INTERNAL_STATS_ZE_CALL) {
+            auto function_name = function_names.find(entry.first.name);
+            if (function_name == function_names.end()) {
+                function_name = function_names.emplace(entry.first.name, getFunctionName(entry.first.name)).first;
+            }
+            name = function_name->second;
+        } else {
+            name = entry.first.name;
+        }
+        auto& stats = by_name[std::make_tuple(entry.first.type, name, entry.first.device)];
+        stats.histogram.merge(entry.second.histogram);
+        stats.errors += entry.second.errors;
+    }
+
+    std::vector<MemoryAccounting::Usage> usages;
+    MemoryAccounting::instance().getUsages(usages);
+
+    uint32_t total = by_name.size() + usages.size();
+    if (dataList == nullptr) {
+        *count = total;
+        return XPUM_OK;
+    }
+    if (*count < total) {
+        *count = total;
+        return XPUM_BUFFER_TOO_SMALL;
+    }
+    uint32_t i = 0;
+    for (auto& entry : by_name) {
+        auto& data = dataList[i++];
+        auto& histogram = entry.second.histogram;
+        data.type = std::get<0>(entry.first);
+        strncpy(data.name, std::get<1>(entry.first).c_str(), XPUM_MAX_STR_LENGTH - 1);
+        data.name[XPUM_MAX_STR_LENGTH - 1] = '\0';
+        data.deviceId = std::get<2>(entry.first);
+        data.count = histogram.count;
+        data.errorCount = entry.second.errors;
+        data.sum = histogram.sum;
+        data.max = histogram.max;
+        data.p50 = histogram.quantile(0.5);
+        data.p90 = histogram.quantile(0.9);
+        data.p99 = histogram.quantile(0.99);
+    }
+    for (auto& usage : usages) {
+        auto& data = dataList[i++];
+        data.type = XPUM_INTERNAL_STATS_MEMORY;
+        strncpy(data.name, usage.name.c_str(), XPUM_MAX_STR_LENGTH - 1);
+        data.name[XPUM_MAX_STR_LENGTH - 1] = '\0';
+        data.deviceId = -1;
+        data.count = usage.entries;
+        data.errorCount = 0;
+        data.sum = usage.bytes;
+        data.max = usage.peak_bytes;
+        data.p50 = data.p90 = data.p99 = usage.bytes;
+    }
+    *count = total;
+    return XPUM_OK;
+}
+
+} // end namespace xpum
@@ -0,0 +1,258 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file internal_stats.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "xpum_structs.h"
+
+namespace xpum {
+
+/*
+  Log-linear latency histogram, in the way of HdrHistogram: values below 16
+  have their own buckets, every power of two above is split into 8 buckets,
+  so a bucket is at most 12.5% wide. Values from 2^36 ns (about 69 seconds)
+  on share the last bucket.
+
+  record() is only called by the thread owning the histogram, other threads
+  may read it at any time.
+*/
+class LatencyHistogram {
+   public:
+    static const uint32_t SUB_BUCKET_BITS = 3;
+
+    static const uint32_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+
+    static const uint32_t MAX_EXPONENT = 36;
+
+    static const uint32_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        std::vector<uint64_t> buckets = std::vector<uint64_t>(BUCKET_COUNT);
+
+        void merge(const Snapshot& other);
+
+        // the upper bound of the bucket holding the q-th quantile, capped by max
+        uint64_t quantile(double q) const;
+    };
+
+    void record(uint64_t value) {
+        increase(buckets[bucketOf(value)], 1);
+        increase(count, 1);
+        increase(sum, value);
+        if (value > max.load(std::memory_order_relaxed)) {
+            max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    void mergeTo(Snapshot& snapshot) const;
+
+    static uint32_t bucketOf(uint64_t value) {
+        if (value < 2 * SUB_BUCKET_COUNT) {
+            return (uint32_t)value;
+        }
+        uint32_t exponent = 63 - __builtin_clzll(value);
+        if (exponent >= MAX_EXPONENT) {
+            return BUCKET_COUNT - 1;
+        }
+        return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + (uint32_t)((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1));
+    }
+
+    // the largest value falling into the bucket
+    static uint64_t upperBoundOf(uint32_t bucket);
+
+   private:
+    // a single writer, so a relaxed load and store is enough and cheaper than an atomic add
+    static void increase(std::atomic<uint64_t>& counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> buckets[BUCKET_COUNT] = {};
+
+    std::atomic<uint64_t> count{0};
+
+    std::atomic<uint64_t> sum{0};
+
+    std::atomic<uint64_t> max{0};
+};
+
+/*
+  InternalStats keeps the latency histograms of XPUM itself: the Level Zero
+  calls made through XPUM_ZE_HANDLE_LOCK (the time waiting for the handle
+  lock and the time of the call, per call site and device) and the ticks of
+  the monitor tasks.
+
+  Each thread records into its own buffer, so recording takes no lock except
+  the first time a thread sees a name. The buffers are merged only when the
+  statistics are read. A Level Zero call is attributed to the device of the
+  enclosing DeviceScope, which the monitor sets while it samples a device,
+  and added to the CallCost of the enclosing CallCostScope, if any.
+*/
+class InternalStats {
+   public:
+    static InternalStats& instance();
+
+    /*
+      Record a Level Zero call, site is the stringified call expression of
+      XPUM_ZE_HANDLE_LOCK and must be a string literal.
+    */
+    void recordZeCall(const char* site, uint64_t lock_wait_ns, uint64_t call_ns) {
+        getEntry(XPUM_INTERNAL_STATS_ZE_LOCK_WAIT, site, current_device).histogram.record(lock_wait_ns);
+        getEntry(XPUM_INTERNAL_STATS_ZE_CALL, site, current_device).histogram.record(call_ns);
+        if (current_cost != nullptr) {
+            current_cost->lock_wait_ns += lock_wait_ns;
+            current_cost->call_ns += call_ns;
+            current_cost->calls++;
+        }
+    }
+
+    /*
+      Record a latency, name must be a string literal or live as long as
+      the process.
+    */
+    void record(xpum_internal_stats_type_t type, const char* name, int32_t device, uint64_t value_ns) {
+        getEntry(type, name, device).histogram.record(value_ns);
+    }
+
+    void recordError(xpum_internal_stats_type_t type, const char* name, int32_t device) {
+        auto& errors = getEntry(type, name, device).errors;
+        errors.store(errors.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    xpum_result_t getStats(xpum_internal_stats_t dataList[], uint32_t* count);
+
+    // the numeric id of a device, -1 if it is not a number
+    static int32_t toDeviceId(const std::string& deviceId);
+
+    class DeviceScope {
+       public:
+        explicit DeviceScope(int32_t deviceId) : previous(current_device) {
+            current_device = deviceId;
+        }
+
+        ~DeviceScope() {
+            current_device = previous;
+        }
+
+        DeviceScope(const DeviceScope&) = delete;
+
+        DeviceScope& operator=(const DeviceScope&) = delete;
+
+       private:
+        int32_t previous;
+    };
+
+    // the Level Zero calls made by a thread in a CallCostScope
+    struct CallCost {
+        uint64_t lock_wait_ns = 0;
+        uint64_t call_ns = 0;
+        uint64_t calls = 0;
+    };
+
+    class CallCostScope {
+       public:
+        explicit CallCostScope(CallCost& cost) : previous(current_cost) {
+            current_cost = &cost;
+        }
+
+        ~CallCostScope() {
+            current_cost = previous;
+        }
+
+        CallCostScope(const CallCostScope&) = delete;
+
+        CallCostScope& operator=(const CallCostScope&) = delete;
+
+       private:
+        CallCost* previous;
+    };
+
+   private:
+    struct Key {
+        xpum_internal_stats_type_t type;
+        const char* name;
+        int32_t device;
+
+        bool operator==(const Key& other) const {
+            return type == other.type && name == other.name && device == other.device;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<const void*>()(key.name) ^ ((size_t)(uint32_t)key.device << 1) ^ ((size_t)key.type << 24);
+        }
+    };
+
+    struct Entry {
+        LatencyHistogram histogram;
+        // written by the owner only, like the histogram
+        std::atomic<uint64_t> errors{0};
+    };
+
+    struct ThreadBuffer {
+        // held by the owner only while adding an entry, and by readers
+        std::mutex mutex;
+        std::unordered_map<Key, std::unique_ptr<Entry>, KeyHash> entries;
+    };
+
+    struct MergedStats {
+        LatencyHistogram::Snapshot histogram;
+        uint64_t errors = 0;
+    };
+
+    // registers the buffer of the calling thread and merges it back when the thread exits
+    struct ThreadBufferHolder {
+        ThreadBufferHolder();
+
+        ~ThreadBufferHolder();
+
+        std::shared_ptr<ThreadBuffer> p_buffer;
+    };
+
+    InternalStats() = default;
+
+    Entry& getEntry(xpum_internal_stats_type_t type, const char* name, int32_t device) {
+        thread_local ThreadBufferHolder holder;
+        auto& entries = holder.p_buffer->entries;
+        Key key{type, name, device};
+        // only this thread changes the map, so it can be searched without the lock
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            return *it->second;
+        }
+        return addEntry(*holder.p_buffer, key);
+    }
+
+    Entry& addEntry(ThreadBuffer& buffer, const Key& key);
+
+    static void mergeBuffer(ThreadBuffer& buffer, std::unordered_map<Key, MergedStats, KeyHash>& merged);
+
+    static std::string getFunctionName(const char* site);
+
+    static thread_local int32_t current_device;
+
+    static thread_local CallCost* current_cost;
+
+    std::mutex mutex;
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+    // the statistics of the threads that have exited
+    std::unordered_map<Key, MergedStats, KeyHash> retired;
+};
+
+} // end namespace xpum
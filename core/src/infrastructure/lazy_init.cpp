@@ -0,0 +1,68 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file lazy_init.cpp
+ */
+
+#include "lazy_init.h"
+
+#include <chrono>
+#include <exception>
+
+#include "infrastructure/logger.h"
+#include "infrastructure/thread_factory.h"
+
+namespace xpum {
+
+LazyInit::LazyInit(const std::string& name, std::function<void()> init)
+    : name(name), init(init), done(false) {
+}
+
+LazyInit::~LazyInit() {
+    join();
+}
+
+void LazyInit::ensure() {
+    std::call_once(once, [this]() {
+        auto start = std::chrono::steady_clock::now();
+        init();
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        XPUM_LOG_INFO("{} initialized in {} ms", name,
+                      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+    });
+}
+
+void LazyInit::warmup() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (done || worker.joinable()) {
+        return;
+    }
+    worker = ThreadFactory::create("xpum-lazy-init", [this]() {
+        try {
+            ensure();
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Failed to warm up {}: {}", name, e.what());
+        } catch (...) {
+            XPUM_LOG_WARN("Failed to warm up {}: unexpected exception", name);
+        }
+    });
+}
+
+void LazyInit::join() {
+    std::thread t;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        t = std::move(worker);
+    }
+    if (t.joinable()) {
+        t.join();
+    }
+}
+
+bool LazyInit::isDone() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return done;
+}
+
+} // end namespace xpum
@@ -0,0 +1,57 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file lazy_init.h
+ */
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace xpum {
+
+/*
+  LazyInit runs the initialization of a subsystem the telemetry does not
+  need once, on first use. warmup() runs it in a background thread instead,
+  so it is usually done before the first use while never holding up the
+  caller. A first use during the warmup waits for it.
+*/
+class LazyInit {
+   public:
+    LazyInit(const std::string& name, std::function<void()> init);
+
+    ~LazyInit();
+
+    LazyInit(const LazyInit&) = delete;
+
+    LazyInit& operator=(const LazyInit&) = delete;
+
+    // run init if it has not run, an exception of init is thrown and init is tried again next time
+    void ensure();
+
+    // ensure() in a background thread, a second call does nothing
+    void warmup();
+
+    // wait for the warmup thread
+    void join();
+
+    bool isDone();
+
+   private:
+    std::string name;
+
+    std::function<void()> init;
+
+    std::once_flag once;
+
+    std::mutex mutex;
+
+    std::thread worker;
+
+    bool done;
+};
+
+} // end namespace xpum
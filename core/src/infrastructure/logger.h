@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+
 #include "spdlog/cfg/env.h"
 #include "spdlog/spdlog.h"
 
@@ -13,9 +16,40 @@
 #define XPUM_LOG_WARN(...) spdlog::warn(__VA_ARGS__)
 #define XPUM_LOG_ERROR(...) spdlog::error(__VA_ARGS__)
 #define XPUM_LOG_DEBUG(...) spdlog::debug(__VA_ARGS__)
+#ifdef XPUM_LOG_NO_TRACE
+// release builds compile the trace calls out, the arguments are still type checked but never evaluated
+#define XPUM_LOG_TRACE(...)         \
+    do {                            \
+        if (false) {                \
+            spdlog::trace(__VA_ARGS__); \
+        }                           \
+    } while (0)
+#else
 #define XPUM_LOG_TRACE(...) spdlog::trace(__VA_ARGS__)
+#endif
 #define XPUM_LOG_FATAL(...) spdlog::critical(__VA_ARGS__)
 
+/*
+  Log at most one message every interval_ms milliseconds from the call site,
+  the count of the messages dropped in between is logged with the next one.
+  A failing device logging on every sampling tick does not flood the log
+  and slow down the collection of the other devices.
+*/
+#define XPUM_LOG_RATE_LIMITED(level, interval_ms, ...)                                          \
+    do {                                                                                        \
+        static xpum::LogRateLimit xpum_log_rate_limit_(interval_ms);                            \
+        uint64_t xpum_log_suppressed_ = 0;                                                      \
+        if (xpum_log_rate_limit_.allow(xpum_log_suppressed_)) {                                 \
+            if (xpum_log_suppressed_ > 0) {                                                     \
+                spdlog::log(level, "{} similar messages suppressed", xpum_log_suppressed_);     \
+            }                                                                                   \
+            spdlog::log(level, __VA_ARGS__);                                                    \
+        }                                                                                       \
+    } while (0)
+
+#define XPUM_LOG_WARN_RATE_LIMITED(interval_ms, ...) XPUM_LOG_RATE_LIMITED(spdlog::level::warn, interval_ms, __VA_ARGS__)
+#define XPUM_LOG_ERROR_RATE_LIMITED(interval_ms, ...) XPUM_LOG_RATE_LIMITED(spdlog::level::err, interval_ms, __VA_ARGS__)
+
 namespace xpum {
 
 class Logger {
@@ -24,4 +58,29 @@ class Logger {
         spdlog::cfg::load_env_levels();
     }
 };
+
+class LogRateLimit {
+   public:
+    explicit LogRateLimit(uint32_t interval_ms) : interval((int64_t)interval_ms * 1000000), next(0), dropped(0) {
+    }
+
+    // true if a message can be logged now, suppressed is the count dropped since the last one
+    bool allow(uint64_t& suppressed) noexcept {
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t expected = next.load(std::memory_order_relaxed);
+        if (now < expected || !next.compare_exchange_strong(expected, now + interval, std::memory_order_relaxed)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        suppressed = dropped.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+   private:
+    const int64_t interval;
+
+    std::atomic<int64_t> next;
+
+    std::atomic<uint64_t> dropped;
+};
 } // end namespace xpum
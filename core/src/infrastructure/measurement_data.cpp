@@ -8,100 +8,124 @@
 
 namespace xpum {
 
+namespace {
+
+/*
+  The side tables are only allocated when they are written, readers of a
+  table that was never written get this shared, always empty table.
+*/
+template <typename T>
+const std::shared_ptr<T>& emptyTable() {
+    static const std::shared_ptr<T> empty = std::make_shared<T>();
+    return empty;
+}
+
+template <typename T>
+T& ensureTable(std::shared_ptr<T>& p_table) {
+    if (p_table == nullptr) {
+        p_table = std::make_shared<T>();
+    }
+    return *p_table;
+}
+
+template <typename K, typename V>
+V* findInTable(const std::shared_ptr<std::map<K, V>>& p_table, K key) {
+    if (p_table == nullptr) {
+        return nullptr;
+    }
+    auto iter = p_table->find(key);
+    return iter != p_table->end() ? &iter->second : nullptr;
+}
+
+} // namespace
+
 void MeasurementData::setSubdeviceDataCurrent(uint32_t subdevice_id, uint64_t data) {
-    (*p_subdevice_datas)[subdevice_id].current = data;
+    ensureTable(p_subdevice_datas)[subdevice_id].current = data;
 }
 
 void MeasurementData::clearSubdeviceDataCurrent(uint32_t subdevice_id) {
-    auto iter = p_subdevice_datas->find(subdevice_id);
-    if (iter != p_subdevice_datas->end()) {
-        p_subdevice_datas->erase(iter);
+    if (p_subdevice_datas != nullptr) {
+        p_subdevice_datas->erase(subdevice_id);
     }
 }
 
 void MeasurementData::setSubdeviceDataRawTimestamp(uint32_t subdevice_id, uint64_t data) {
-    (*p_subdevice_rawdatas)[subdevice_id].raw_timestamp = data;
+    ensureTable(p_subdevice_rawdatas)[subdevice_id].raw_timestamp = data;
 }
 
 void MeasurementData::setSubdeviceRawData(uint32_t subdevice_id, uint64_t data) {
-    (*p_subdevice_rawdatas)[subdevice_id].raw_data = data;
+    ensureTable(p_subdevice_rawdatas)[subdevice_id].raw_data = data;
 }
 
 void MeasurementData::clearSubdeviceRawdata(uint32_t subdevice_id) {
-    auto iter = p_subdevice_rawdatas->find(subdevice_id);
-    if (iter != p_subdevice_rawdatas->end()) {
-        p_subdevice_rawdatas->erase(iter);
+    if (p_subdevice_rawdatas != nullptr) {
+        p_subdevice_rawdatas->erase(subdevice_id);
     }
 }
 
 void MeasurementData::setSubdeviceDataMin(uint32_t subdevice_id, uint64_t data) {
-    (*p_subdevice_datas)[subdevice_id].min = data;
+    ensureTable(p_subdevice_datas)[subdevice_id].min = data;
 }
 
 void MeasurementData::setSubdeviceDataMax(uint32_t subdevice_id, uint64_t data) {
-    (*p_subdevice_datas)[subdevice_id].max = data;
+    ensureTable(p_subdevice_datas)[subdevice_id].max = data;
 }
 
 void MeasurementData::setSubdeviceDataAvg(uint32_t subdevice_id, uint64_t data) {
-    (*p_subdevice_datas)[subdevice_id].avg = data;
+    ensureTable(p_subdevice_datas)[subdevice_id].avg = data;
+}
+
+void MeasurementData::setSubdeviceDataPercentiles(uint32_t subdevice_id, uint64_t p50, uint64_t p90, uint64_t p99) {
+    auto& data = ensureTable(p_subdevice_datas)[subdevice_id];
+    data.p50 = p50;
+    data.p90 = p90;
+    data.p99 = p99;
 }
 
 bool MeasurementData::hasSubdeviceData(uint32_t subdevice_id) {
-    return p_subdevice_datas->find(subdevice_id) != p_subdevice_datas->end();
+    return findInTable(p_subdevice_datas, subdevice_id) != nullptr;
 }
 
 uint64_t MeasurementData::getSubdeviceDataCurrent(uint32_t subdevice_id) {
-    if (p_subdevice_datas->find(subdevice_id) != p_subdevice_datas->end()) {
-        return (*p_subdevice_datas)[subdevice_id].current;
-    }
-    return std::numeric_limits<uint64_t>::max();
+    auto p_data = findInTable(p_subdevice_datas, subdevice_id);
+    return p_data != nullptr ? p_data->current : std::numeric_limits<uint64_t>::max();
 }
 
 uint64_t MeasurementData::getSubdeviceDataMin(uint32_t subdevice_id) {
-    if (p_subdevice_datas->find(subdevice_id) != p_subdevice_datas->end()) {
-        return (*p_subdevice_datas)[subdevice_id].min;
-    }
-    return std::numeric_limits<uint64_t>::max();
+    auto p_data = findInTable(p_subdevice_datas, subdevice_id);
+    return p_data != nullptr ? p_data->min : std::numeric_limits<uint64_t>::max();
 }
 
 uint64_t MeasurementData::getSubdeviceDataMax(uint32_t subdevice_id) {
-    if (p_subdevice_datas->find(subdevice_id) != p_subdevice_datas->end()) {
-        return (*p_subdevice_datas)[subdevice_id].max;
-    }
-    return std::numeric_limits<uint64_t>::max();
+    auto p_data = findInTable(p_subdevice_datas, subdevice_id);
+    return p_data != nullptr ? p_data->max : std::numeric_limits<uint64_t>::max();
 }
 
 uint64_t MeasurementData::getSubdeviceDataAvg(uint32_t subdevice_id) {
-    if (p_subdevice_datas->find(subdevice_id) != p_subdevice_datas->end()) {
-        return (*p_subdevice_datas)[subdevice_id].avg;
-    }
-    return std::numeric_limits<uint64_t>::max();
+    auto p_data = findInTable(p_subdevice_datas, subdevice_id);
+    return p_data != nullptr ? p_data->avg : std::numeric_limits<uint64_t>::max();
 }
 
 uint64_t MeasurementData::getSubdeviceDataRawTimestamp(uint32_t subdevice_id) {
-    if (p_subdevice_rawdatas->find(subdevice_id) != p_subdevice_rawdatas->end()) {
-        return (*p_subdevice_rawdatas)[subdevice_id].raw_timestamp;
-    }
-    return std::numeric_limits<uint64_t>::max();
+    auto p_data = findInTable(p_subdevice_rawdatas, subdevice_id);
+    return p_data != nullptr ? p_data->raw_timestamp : std::numeric_limits<uint64_t>::max();
 }
 
 uint64_t MeasurementData::getSubdeviceRawData(uint32_t subdevice_id) {
-    if (p_subdevice_rawdatas->find(subdevice_id) != p_subdevice_rawdatas->end()) {
-        return (*p_subdevice_rawdatas)[subdevice_id].raw_data;
-    }
-    return std::numeric_limits<uint64_t>::max();
+    auto p_data = findInTable(p_subdevice_rawdatas, subdevice_id);
+    return p_data != nullptr ? p_data->raw_data : std::numeric_limits<uint64_t>::max();
 }
 
 const std::shared_ptr<std::map<uint32_t, SubdeviceData>> MeasurementData::getSubdeviceDatas() {
-    return p_subdevice_datas;
+    return p_subdevice_datas != nullptr ? p_subdevice_datas : emptyTable<std::map<uint32_t, SubdeviceData>>();
 }
 
 const std::shared_ptr<std::map<uint32_t, SubdeviceRawData>> MeasurementData::getSubdeviceRawDatas() {
-    return p_subdevice_rawdatas;
+    return p_subdevice_rawdatas != nullptr ? p_subdevice_rawdatas : emptyTable<std::map<uint32_t, SubdeviceRawData>>();
 }
 
 uint32_t MeasurementData::getSubdeviceDataSize() {
-    return p_subdevice_datas->size();
+    return p_subdevice_datas != nullptr ? p_subdevice_datas->size() : 0;
 }
 
 void MeasurementData::setSubdeviceAdditionalData(uint32_t subdevice_id, MeasurementType type, uint64_t data, int scale, bool is_raw_data, uint64_t timestamp) {
@@ -114,28 +138,29 @@ void MeasurementData::setSubdeviceAdditionalData(uint32_t subdevice_id, Measurem
     } else {
         add_data.current = data;
     }
-    subdevice_additional_datas[subdevice_id][type] = add_data;
-    subdevice_additional_data_types.insert(type);
+    subdevice_additional_datas.push_back({type, subdevice_id, add_data});
 }
 
-std::map<uint32_t, std::map<MeasurementType, AdditionalData>> MeasurementData::getSubdeviceAdditionalDatas() {
+const std::vector<SubdeviceAdditionalData_t>& MeasurementData::getSubdeviceAdditionalDatas() {
     return subdevice_additional_datas;
 }
 
-void MeasurementData::insertSubdeviceAdditionalDataType(MeasurementType type) {
-    subdevice_additional_data_types.insert(type);
-}
-
-std::set<MeasurementType> MeasurementData::getSubdeviceAdditionalDataTypes() {
-    return subdevice_additional_data_types;
+void MeasurementData::takeSubdeviceAdditionalDatas(std::vector<SubdeviceAdditionalData_t>& datas) {
+    datas.swap(subdevice_additional_datas);
+    subdevice_additional_datas.clear();
 }
 
-uint32_t MeasurementData::getSubdeviceAdditionalDataTypeSize() {
-    return subdevice_additional_data_types.size();
+bool MeasurementData::hasSubdeviceAdditionalData(MeasurementType type) {
+    for (auto& data : subdevice_additional_datas) {
+        if (data.type == type) {
+            return true;
+        }
+    }
+    return false;
 }
 
-void MeasurementData::clearSubdeviceAdditionalDataTypes() {
-    subdevice_additional_data_types.clear();
+uint32_t MeasurementData::getSubdeviceAdditionalDataSize() {
+    return subdevice_additional_datas.size();
 }
 
 void MeasurementData::clearSubdeviceAdditionalData() {
@@ -143,66 +168,62 @@ void MeasurementData::clearSubdeviceAdditionalData() {
 }
 
 const std::shared_ptr<std::map<uint64_t, ExtendedMeasurementData>> MeasurementData::getExtendedDatas() {
-    return p_extended_datas;
+    return p_extended_datas != nullptr ? p_extended_datas : emptyTable<std::map<uint64_t, ExtendedMeasurementData>>();
 }
 
 void MeasurementData::addExtendedData(uint64_t key, ExtendedMeasurementData data) {
-    (*p_extended_datas)[key] = data;
-}
-
-void MeasurementData::addSingleMeasurementData(uint64_t handle, bool on_subdevice, uint32_t subdevice_id) {
-    (*p_multi_metrics_datas)[handle].on_subdevice = on_subdevice;
-    (*p_multi_metrics_datas)[handle].subdevice_id = subdevice_id;
+    ensureTable(p_extended_datas)[key] = data;
 }
 
-void MeasurementData::setDataCur(uint64_t handle, uint64_t cur) {
-    (*p_multi_metrics_datas)[handle].current = cur;
+const std::shared_ptr<std::vector<SingleMeasurementData_t>> MeasurementData::getMultiMetricsDatas() {
+    return p_multi_metrics_datas != nullptr ? p_multi_metrics_datas : emptyTable<std::vector<SingleMeasurementData_t>>();
 }
 
-void MeasurementData::setDataMin(uint64_t handle, uint64_t min) {
-    if (p_multi_metrics_datas->find(handle) != p_multi_metrics_datas->end()) {
-        (*p_multi_metrics_datas)[handle].min = min;
+SingleMeasurementData_t& MeasurementData::multiMetricsDataAt(uint32_t index) {
+    auto& datas = ensureTable(p_multi_metrics_datas);
+    if (index >= datas.size()) {
+        datas.resize(index + 1);
     }
+    datas[index].valid = true;
+    return datas[index];
 }
 
-void MeasurementData::setDataMax(uint64_t handle, uint64_t max) {
-    if (p_multi_metrics_datas->find(handle) != p_multi_metrics_datas->end()) {
-        (*p_multi_metrics_datas)[handle].max = max;
+SingleMeasurementData_t* MeasurementData::findMultiMetricsData(uint32_t index) {
+    if (p_multi_metrics_datas == nullptr || index >= p_multi_metrics_datas->size() || !(*p_multi_metrics_datas)[index].valid) {
+        return nullptr;
     }
+    return &(*p_multi_metrics_datas)[index];
 }
 
-void MeasurementData::setDataAvg(uint64_t handle, uint64_t avg) {
-    if (p_multi_metrics_datas->find(handle) != p_multi_metrics_datas->end()) {
-        (*p_multi_metrics_datas)[handle].avg = avg;
-    }
+void MeasurementData::addSingleMeasurementData(uint32_t index, bool on_subdevice, uint32_t subdevice_id) {
+    auto& data = multiMetricsDataAt(index);
+    data.on_subdevice = on_subdevice;
+    data.subdevice_id = subdevice_id;
 }
 
-uint64_t MeasurementData::getDataCur(uint64_t handle) {
-    if (p_multi_metrics_datas->find(handle) != p_multi_metrics_datas->end()) {
-        return (*p_multi_metrics_datas)[handle].current;
-    }
-    return std::numeric_limits<uint64_t>::max();
+void MeasurementData::setDataCur(uint32_t index, uint64_t cur) {
+    multiMetricsDataAt(index).current = cur;
 }
 
-uint64_t MeasurementData::getDataMin(uint64_t handle) {
-    if (p_multi_metrics_datas->find(handle) != p_multi_metrics_datas->end()) {
-        return (*p_multi_metrics_datas)[handle].min;
+void MeasurementData::setDataMin(uint32_t index, uint64_t min) {
+    auto p_data = findMultiMetricsData(index);
+    if (p_data != nullptr) {
+        p_data->min = min;
     }
-    return std::numeric_limits<uint64_t>::max();
 }
 
-uint64_t MeasurementData::getDataMax(uint64_t handle) {
-    if (p_multi_metrics_datas->find(handle) != p_multi_metrics_datas->end()) {
-        return (*p_multi_metrics_datas)[handle].max;
+void MeasurementData::setDataMax(uint32_t index, uint64_t max) {
+    auto p_data = findMultiMetricsData(index);
+    if (p_data != nullptr) {
+        p_data->max = max;
     }
-    return std::numeric_limits<uint64_t>::max();
 }
 
-uint64_t MeasurementData::getDataAvg(uint64_t handle) {
-    if (p_multi_metrics_datas->find(handle) != p_multi_metrics_datas->end()) {
-        return (*p_multi_metrics_datas)[handle].avg;
+void MeasurementData::setDataAvg(uint32_t index, uint64_t avg) {
+    auto p_data = findMultiMetricsData(index);
+    if (p_data != nullptr) {
+        p_data->avg = avg;
     }
-    return std::numeric_limits<uint64_t>::max();
 }
 
 } // end namespace xpum
@@ -11,9 +11,11 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "const.h"
 #include "logger.h"
+#include "multi_metrics_schema.h"
 #include "utility.h"
 
 namespace xpum {
@@ -23,8 +25,12 @@ struct SubdeviceData {
     uint64_t min;
     uint64_t max;
     uint64_t current;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
     SubdeviceData() {
         avg = min = max = current = std::numeric_limits<uint64_t>::max();
+        p50 = p90 = p99 = std::numeric_limits<uint64_t>::max();
     }
 };
 
@@ -60,7 +66,17 @@ struct AdditionalData {
     }
 };
 
+// a metric derived by a getter from the data of another metric, like the memory utilization
+struct SubdeviceAdditionalData_t {
+    MeasurementType type;
+    // UINT32_MAX for the data of the device
+    uint32_t subdevice_id;
+    AdditionalData data;
+};
+
 struct SingleMeasurementData_t {
+    // false for the indexes of the schema without data in this sample
+    bool valid;
     bool on_subdevice;
     uint32_t subdevice_id;
     uint64_t current;
@@ -68,6 +84,7 @@ struct SingleMeasurementData_t {
     uint64_t min;
     uint64_t avg;
     SingleMeasurementData_t() {
+        valid = false;
         on_subdevice = false;
         subdevice_id = std::numeric_limits<uint32_t>::max();
         avg = min = max = current = std::numeric_limits<uint64_t>::max();
@@ -76,9 +93,7 @@ struct SingleMeasurementData_t {
 
 class MeasurementData {
    public:
-    ~MeasurementData() {
-        p_multi_metrics_datas->clear();
-    }
+    ~MeasurementData() {}
 
     MeasurementData() : start_time(0),
                         latest_time(0),
@@ -86,6 +101,9 @@ class MeasurementData {
                         min(std::numeric_limits<uint64_t>::max()),
                         max(std::numeric_limits<uint64_t>::max()),
                         current(std::numeric_limits<uint64_t>::max()),
+                        p50(std::numeric_limits<uint64_t>::max()),
+                        p90(std::numeric_limits<uint64_t>::max()),
+                        p99(std::numeric_limits<uint64_t>::max()),
                         raw_data(std::numeric_limits<uint64_t>::max()),
                         scale(1),
                         bHasDataOnDevice(false),
@@ -93,10 +111,6 @@ class MeasurementData {
                         raw_timestamp(0),
                         timestamp(0),
                         num_subdevice(0) {
-        p_subdevice_datas = std::make_shared<std::map<uint32_t, SubdeviceData>>();
-        p_subdevice_rawdatas = std::make_shared<std::map<uint32_t, SubdeviceRawData>>();
-        p_extended_datas = std::make_shared<std::map<uint64_t, ExtendedMeasurementData>>();
-        p_multi_metrics_datas = std::make_shared<std::map<uint64_t, SingleMeasurementData_t>>();
     }
 
     MeasurementData(uint64_t value) : start_time(0),
@@ -105,6 +119,9 @@ class MeasurementData {
                                       min(value),
                                       max(value),
                                       current(value),
+                                      p50(std::numeric_limits<uint64_t>::max()),
+                                      p90(std::numeric_limits<uint64_t>::max()),
+                                      p99(std::numeric_limits<uint64_t>::max()),
                                       raw_data(std::numeric_limits<uint64_t>::max()),
                                       scale(1),
                                       bHasDataOnDevice(true),
@@ -112,10 +129,6 @@ class MeasurementData {
                                       raw_timestamp(0),
                                       timestamp(0),
                                       num_subdevice(0) {
-        p_subdevice_datas = std::make_shared<std::map<uint32_t, SubdeviceData>>();
-        p_subdevice_rawdatas = std::make_shared<std::map<uint32_t, SubdeviceRawData>>();
-        p_extended_datas = std::make_shared<std::map<uint64_t, ExtendedMeasurementData>>();
-        p_multi_metrics_datas = std::make_shared<std::map<uint64_t, SingleMeasurementData_t>>();
     }
 
     MeasurementData(const MeasurementData& other) {
@@ -124,6 +137,9 @@ class MeasurementData {
         min = other.min;
         max = other.max;
         current = other.current;
+        p50 = other.p50;
+        p90 = other.p90;
+        p99 = other.p99;
         raw_data = other.raw_data;
         scale = other.scale;
         start_time = other.start_time;
@@ -135,9 +151,9 @@ class MeasurementData {
         p_extended_datas = other.p_extended_datas;
         raw_timestamp = other.raw_timestamp;
         timestamp = other.timestamp;
-        subdevice_additional_data_types = other.subdevice_additional_data_types;
         subdevice_additional_datas = other.subdevice_additional_datas;
         errors = other.errors;
+        p_multi_metrics_schema = other.p_multi_metrics_schema;
         p_multi_metrics_datas = other.p_multi_metrics_datas;
     }
 
@@ -155,6 +171,13 @@ class MeasurementData {
 
     void setScale(uint64_t scale) { this->scale = scale; }
 
+    // the percentiles of the statistics, UINT64_MAX while a statistics handler has not set them
+    void setPercentiles(uint64_t p50, uint64_t p90, uint64_t p99) {
+        this->p50 = p50;
+        this->p90 = p90;
+        this->p99 = p99;
+    }
+
     void setStartTime(long long time) { this->start_time = time; }
 
     void setLatestTime(long long time) { this->latest_time = time; }
@@ -167,6 +190,12 @@ class MeasurementData {
 
     uint64_t getCurrent() { return this->current; }
 
+    uint64_t getP50() { return this->p50; }
+
+    uint64_t getP90() { return this->p90; }
+
+    uint64_t getP99() { return this->p99; }
+
     uint64_t getScale() { return this->scale; }
 
     long long getStartTime() { return start_time; }
@@ -191,6 +220,8 @@ class MeasurementData {
 
     void setSubdeviceDataAvg(uint32_t subdevice_id, uint64_t data);
 
+    void setSubdeviceDataPercentiles(uint32_t subdevice_id, uint64_t p50, uint64_t p90, uint64_t p99);
+
     void setSubdeviceDataRawTimestamp(uint32_t subdevice_id, uint64_t data);
 
     uint64_t getSubdeviceDataRawTimestamp(uint32_t subdevice_id);
@@ -203,11 +234,11 @@ class MeasurementData {
 
     bool hasSubdeviceData(uint32_t subdevice_id);
 
-    bool hasSubdeviceData() { return p_subdevice_datas->size() > 0; }
+    bool hasSubdeviceData() { return p_subdevice_datas != nullptr && p_subdevice_datas->size() > 0; }
 
-    bool hasSubdeviceRawData() { return p_subdevice_rawdatas->size() > 0; }
+    bool hasSubdeviceRawData() { return p_subdevice_rawdatas != nullptr && p_subdevice_rawdatas->size() > 0; }
 
-    uint32_t subdeviceNum() { return p_subdevice_datas->size(); }
+    uint32_t subdeviceNum() { return getSubdeviceDataSize(); }
 
     bool hasDataOnDevice() { return bHasDataOnDevice; }
 
@@ -240,15 +271,18 @@ class MeasurementData {
 
     void setSubdeviceAdditionalData(uint32_t subdevice_id, MeasurementType type, uint64_t data, int scale = 1, bool is_raw_data = false, uint64_t timestamp = 0);
 
-    std::map<uint32_t, std::map<MeasurementType, AdditionalData>> getSubdeviceAdditionalDatas();
+    // in the order they are set, a later data of the same subdevice and type replaces an earlier one
+    const std::vector<SubdeviceAdditionalData_t>& getSubdeviceAdditionalDatas();
 
-    void insertSubdeviceAdditionalDataType(MeasurementType type);
+    /*
+      Move the additional datas out of this measurement data, leaving them
+      empty.
+    */
+    void takeSubdeviceAdditionalDatas(std::vector<SubdeviceAdditionalData_t>& datas);
 
-    std::set<MeasurementType> getSubdeviceAdditionalDataTypes();
+    bool hasSubdeviceAdditionalData(MeasurementType type);
 
-    uint32_t getSubdeviceAdditionalDataTypeSize();
-
-    void clearSubdeviceAdditionalDataTypes();
+    uint32_t getSubdeviceAdditionalDataSize();
 
     void clearSubdeviceAdditionalData();
 
@@ -268,20 +302,27 @@ class MeasurementData {
         return this->errors;
     }
 
-    const std::shared_ptr<std::map<uint64_t, SingleMeasurementData_t>> getMultiMetricsDatas() {
-        return p_multi_metrics_datas;
-    }
-    void addSingleMeasurementData(uint64_t handle, bool on_subdevice, uint32_t subdevice_id);
-    void setDataCur(uint64_t handle, uint64_t cur);
-    void setDataMin(uint64_t handle, uint64_t min);
-    void setDataMax(uint64_t handle, uint64_t max);
-    void setDataAvg(uint64_t handle, uint64_t avg);
-    uint64_t getDataCur(uint64_t handle);
-    uint64_t getDataMin(uint64_t handle);
-    uint64_t getDataMax(uint64_t handle);
-    uint64_t getDataAvg(uint64_t handle);
+    /*
+      The multi metrics datas are indexed by the schema of the engines or the
+      fabric throughputs of the device, the key of index i is
+      getMultiMetricsSchema()->keyOf(i).
+    */
+    const std::shared_ptr<MultiMetricsSchema>& getMultiMetricsSchema() { return p_multi_metrics_schema; }
+    void setMultiMetricsSchema(const std::shared_ptr<MultiMetricsSchema>& schema) { p_multi_metrics_schema = schema; }
+    const std::shared_ptr<std::vector<SingleMeasurementData_t>> getMultiMetricsDatas();
+    void addSingleMeasurementData(uint32_t index, bool on_subdevice, uint32_t subdevice_id);
+    void setDataCur(uint32_t index, uint64_t cur);
+    void setDataMin(uint32_t index, uint64_t min);
+    void setDataMax(uint32_t index, uint64_t max);
+    void setDataAvg(uint32_t index, uint64_t avg);
 
    protected:
+    // the data at index, it is added as valid if it is not in the table
+    SingleMeasurementData_t& multiMetricsDataAt(uint32_t index);
+
+    // the valid data at index, nullptr if there is none
+    SingleMeasurementData_t* findMultiMetricsData(uint32_t index);
+
     std::string device_id;
 
     Timestamp_t start_time;
@@ -296,6 +337,12 @@ class MeasurementData {
 
     uint64_t current;
 
+    uint64_t p50;
+
+    uint64_t p90;
+
+    uint64_t p99;
+
     uint64_t raw_data;
 
     int scale;
@@ -304,6 +351,10 @@ class MeasurementData {
 
     bool bHasRawDataOnDevice;
 
+    /*
+      The subdevice, raw, extended and multi metrics tables below are allocated on
+      first write, most metrics never use some of them. They are null until then.
+    */
     std::shared_ptr<std::map<uint32_t, SubdeviceData>> p_subdevice_datas;
 
     std::shared_ptr<std::map<uint32_t, SubdeviceRawData>> p_subdevice_rawdatas;
@@ -316,13 +367,13 @@ class MeasurementData {
 
     std::shared_ptr<std::map<uint64_t, ExtendedMeasurementData>> p_extended_datas;
 
-    std::set<MeasurementType> subdevice_additional_data_types;
-
-    std::map<uint32_t, std::map<MeasurementType, AdditionalData>> subdevice_additional_datas;
+    std::vector<SubdeviceAdditionalData_t> subdevice_additional_datas;
 
     std::string errors;
 
-    std::shared_ptr<std::map<uint64_t, SingleMeasurementData_t>> p_multi_metrics_datas;
+    std::shared_ptr<MultiMetricsSchema> p_multi_metrics_schema;
+
+    std::shared_ptr<std::vector<SingleMeasurementData_t>> p_multi_metrics_datas;
 };
 
 } // end namespace xpum
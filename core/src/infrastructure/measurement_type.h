@@ -50,6 +50,7 @@ enum MeasurementType {
     METRIC_PERF,
     METRIC_FREQUENCY_THROTTLE_REASON_GPU,
     METRIC_MEDIA_ENGINE_FREQUENCY,
+    METRIC_VF_ENGINE_UTILIZATION,
 
     METRIC_MAX,
 };
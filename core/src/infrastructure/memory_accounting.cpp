@@ -0,0 +1,68 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file memory_accounting.cpp
+ */
+
+#include "memory_accounting.h"
+
+#include <algorithm>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+MemoryAccounting& MemoryAccounting::instance() {
+    static MemoryAccounting accounting;
+    return accounting;
+}
+
+void MemoryAccounting::report(const std::string& name, uint64_t bytes, uint64_t entries) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = usages.find(name);
+    if (it == usages.end()) {
+        it = usages.emplace(name, Usage{name, 0, 0, 0}).first;
+    }
+    auto& usage = it->second;
+    bool was_over = isOverBudget();
+    uint64_t new_total = total.load(std::memory_order_relaxed) - usage.bytes + bytes;
+    usage.bytes = bytes;
+    usage.peak_bytes = std::max(usage.peak_bytes, bytes);
+    usage.entries = entries;
+    total.store(new_total, std::memory_order_relaxed);
+    peak_total = std::max(peak_total, new_total);
+    bool is_over = isOverBudget();
+    if (is_over && !was_over) {
+        XPUM_LOG_WARN("Telemetry memory of {} bytes is over the limit of {} MB, the sample windows are shrunk", new_total, Configuration::TELEMETRY_MEMORY_LIMIT);
+    } else if (was_over && !is_over) {
+        XPUM_LOG_INFO("Telemetry memory of {} bytes is back under the limit of {} MB", new_total, Configuration::TELEMETRY_MEMORY_LIMIT);
+    }
+}
+
+void MemoryAccounting::remove(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = usages.find(name);
+    if (it == usages.end()) {
+        return;
+    }
+    total.store(total.load(std::memory_order_relaxed) - it->second.bytes, std::memory_order_relaxed);
+    usages.erase(it);
+}
+
+bool MemoryAccounting::isOverBudget() const {
+    return Configuration::TELEMETRY_MEMORY_LIMIT > 0 && getTotal() > (uint64_t)Configuration::TELEMETRY_MEMORY_LIMIT * 1024 * 1024;
+}
+
+void MemoryAccounting::getUsages(std::vector<Usage>& result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    result.clear();
+    uint64_t entries = 0;
+    for (auto& usage : usages) {
+        result.push_back(usage.second);
+        entries += usage.second.entries;
+    }
+    result.push_back(Usage{"total", getTotal(), peak_total, entries});
+}
+
+} // end namespace xpum
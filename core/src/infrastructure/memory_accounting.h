@@ -0,0 +1,72 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file memory_accounting.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace xpum {
+
+/*
+  MemoryAccounting adds up the memory held by the telemetry caches of XPUM:
+  the statistics of the sessions and the sample windows of the handlers.
+  Each cache reports its own estimated size after it changes, the sizes are
+  read through the internal statistics.
+
+  When Configuration::TELEMETRY_MEMORY_LIMIT is set and the total is over
+  it, isOverBudget() is true and the caches that can keep less history,
+  like the performance metric windows, shrink their windows.
+*/
+class MemoryAccounting {
+   public:
+    struct Usage {
+        std::string name;
+        uint64_t bytes;
+        uint64_t peak_bytes;
+        uint64_t entries;
+    };
+
+    static MemoryAccounting& instance();
+
+    // set the size of the cache name, it replaces the size reported before
+    void report(const std::string& name, uint64_t bytes, uint64_t entries);
+
+    void remove(const std::string& name);
+
+    uint64_t getTotal() const {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    bool isOverBudget() const;
+
+    // the caches sorted by name, and the total of all of them with the name "total"
+    void getUsages(std::vector<Usage>& usages);
+
+    // the estimated size of a node of a std::map with the key and the value
+    template <typename K, typename V>
+    static constexpr uint64_t mapNodeSize() {
+        // the color, parent, left and right of the tree node
+        return sizeof(std::pair<const K, V>) + 4 * sizeof(void*);
+    }
+
+   private:
+    MemoryAccounting() = default;
+
+    std::mutex mutex;
+
+    std::map<std::string, Usage> usages;
+
+    std::atomic<uint64_t> total{0};
+
+    uint64_t peak_total = 0;
+};
+
+} // end namespace xpum
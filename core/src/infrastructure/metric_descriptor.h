@@ -0,0 +1,152 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file metric_descriptor.h
+ */
+
+#pragma once
+
+#include "../include/xpum_structs.h"
+#include "device_capability.h"
+#include "measurement_type.h"
+
+namespace xpum {
+
+// the data handler class that aggregates the samples of a metric
+enum class MetricHandlerKind {
+    STATS,
+    TIME_WEIGHTED_AVERAGE,
+    COUNTER,
+    ENGINE_UTILIZATION,
+    GPU_UTILIZATION,
+    ENGINE_GROUP_UTILIZATION,
+    FABRIC_THROUGHPUT,
+    PERF,
+    VF_ENGINE_UTILIZATION,
+    THROTTLE_REASON,
+};
+
+// the order the CPU budget governor cuts the periodic sampling of the metrics in, the metrics of a capability share one
+enum class MetricPriority {
+    HIGH,
+    // cut first when xpumd is over its CPU budget
+    LOW,
+    // the performance metric streaming, cut last
+    STREAMING,
+};
+
+struct MetricDescriptor {
+    MeasurementType type;
+    // XPUM_STATS_MAX if the metric is not exposed as a stats type
+    xpum_stats_type_t stats_type;
+    // the device method that samples the metric
+    DeviceCapability capability;
+    // the metric monitored for the capability, one per capability
+    bool primary;
+    // the value is accumulated by the device, the stats are its delta
+    bool counter;
+    MetricHandlerKind handler;
+    const char* name;
+    // a cumulative histogram of every sample is kept for the export, only for the main gauges
+    bool histogram;
+    MetricPriority priority;
+};
+
+/*
+  The metrics in the order of MeasurementType. A new MeasurementType needs
+  one line here, the lookups of Utility and the data handlers of
+  DataHandlerManager are generated from it.
+*/
+constexpr MetricDescriptor metric_descriptors[] = {
+    {MeasurementType::METRIC_POWER, XPUM_STATS_POWER, DeviceCapability::METRIC_POWER, true, false, MetricHandlerKind::TIME_WEIGHTED_AVERAGE, "power", true, MetricPriority::HIGH},
+    {MeasurementType::METRIC_ENERGY, XPUM_STATS_ENERGY, DeviceCapability::METRIC_ENERGY, true, true, MetricHandlerKind::STATS, "energy", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_FREQUENCY, XPUM_STATS_GPU_FREQUENCY, DeviceCapability::METRIC_FREQUENCY, true, false, MetricHandlerKind::STATS, "frequency", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_TEMPERATURE, XPUM_STATS_GPU_CORE_TEMPERATURE, DeviceCapability::METRIC_TEMPERATURE, true, false, MetricHandlerKind::STATS, "temperature", true, MetricPriority::HIGH},
+    {MeasurementType::METRIC_MEMORY_USED, XPUM_STATS_MEMORY_USED, DeviceCapability::METRIC_MEMORY_USED_UTILIZATION, true, false, MetricHandlerKind::STATS, "memory used", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_MEMORY_UTILIZATION, XPUM_STATS_MEMORY_UTILIZATION, DeviceCapability::METRIC_MEMORY_USED_UTILIZATION, false, false, MetricHandlerKind::STATS, "memory utilization", true, MetricPriority::HIGH},
+    {MeasurementType::METRIC_MEMORY_BANDWIDTH, XPUM_STATS_MEMORY_BANDWIDTH, DeviceCapability::METRIC_MEMORY_THROUGHPUT_BANDWIDTH, false, false, MetricHandlerKind::TIME_WEIGHTED_AVERAGE, "memory bandwidth", false, MetricPriority::LOW},
+    {MeasurementType::METRIC_MEMORY_READ, XPUM_STATS_MEMORY_READ, DeviceCapability::METRIC_MEMORY_THROUGHPUT_BANDWIDTH, true, true, MetricHandlerKind::COUNTER, "memory read", false, MetricPriority::LOW},
+    {MeasurementType::METRIC_MEMORY_WRITE, XPUM_STATS_MEMORY_WRITE, DeviceCapability::METRIC_MEMORY_THROUGHPUT_BANDWIDTH, false, true, MetricHandlerKind::COUNTER, "memory write", false, MetricPriority::LOW},
+    {MeasurementType::METRIC_MEMORY_READ_THROUGHPUT, XPUM_STATS_MEMORY_READ_THROUGHPUT, DeviceCapability::METRIC_MEMORY_THROUGHPUT_BANDWIDTH, false, false, MetricHandlerKind::TIME_WEIGHTED_AVERAGE, "memory read throughput", false, MetricPriority::LOW},
+    {MeasurementType::METRIC_MEMORY_WRITE_THROUGHPUT, XPUM_STATS_MEMORY_WRITE_THROUGHPUT, DeviceCapability::METRIC_MEMORY_THROUGHPUT_BANDWIDTH, false, false, MetricHandlerKind::TIME_WEIGHTED_AVERAGE, "memory write throughput", false, MetricPriority::LOW},
+    {MeasurementType::METRIC_COMPUTATION, XPUM_STATS_GPU_UTILIZATION, DeviceCapability::METRIC_COMPUTATION, true, false, MetricHandlerKind::GPU_UTILIZATION, "GPU utilization", true, MetricPriority::HIGH},
+    {MeasurementType::METRIC_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION, XPUM_STATS_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION, DeviceCapability::METRIC_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION, true, false, MetricHandlerKind::ENGINE_GROUP_UTILIZATION, "compute engine group utilization", false, MetricPriority::LOW},
+    {MeasurementType::METRIC_ENGINE_GROUP_MEDIA_ALL_UTILIZATION, XPUM_STATS_ENGINE_GROUP_MEDIA_ALL_UTILIZATION, DeviceCapability::METRIC_ENGINE_GROUP_MEDIA_ALL_UTILIZATION, true, false, MetricHandlerKind::ENGINE_GROUP_UTILIZATION, "media engine group utilization", false, MetricPriority::LOW},
+    {MeasurementType::METRIC_ENGINE_GROUP_COPY_ALL_UTILIZATION, XPUM_STATS_ENGINE_GROUP_COPY_ALL_UTILIZATION, DeviceCapability::METRIC_ENGINE_GROUP_COPY_ALL_UTILIZATION, true, false, MetricHandlerKind::ENGINE_GROUP_UTILIZATION, "copy engine group utilization", false, MetricPriority::LOW},
+    {MeasurementType::METRIC_ENGINE_GROUP_RENDER_ALL_UTILIZATION, XPUM_STATS_ENGINE_GROUP_RENDER_ALL_UTILIZATION, DeviceCapability::METRIC_ENGINE_GROUP_RENDER_ALL_UTILIZATION, true, false, MetricHandlerKind::ENGINE_GROUP_UTILIZATION, "render engine group utilization", false, MetricPriority::LOW},
+    {MeasurementType::METRIC_ENGINE_GROUP_3D_ALL_UTILIZATION, XPUM_STATS_ENGINE_GROUP_3D_ALL_UTILIZATION, DeviceCapability::METRIC_ENGINE_GROUP_3D_ALL_UTILIZATION, true, false, MetricHandlerKind::ENGINE_GROUP_UTILIZATION, "3D engine group utilization", false, MetricPriority::LOW},
+    {MeasurementType::METRIC_EU_ACTIVE, XPUM_STATS_EU_ACTIVE, DeviceCapability::METRIC_EU_ACTIVE_STALL_IDLE, true, false, MetricHandlerKind::STATS, "EU active", false, MetricPriority::STREAMING},
+    {MeasurementType::METRIC_EU_STALL, XPUM_STATS_EU_STALL, DeviceCapability::METRIC_EU_ACTIVE_STALL_IDLE, false, false, MetricHandlerKind::STATS, "EU stall", false, MetricPriority::STREAMING},
+    {MeasurementType::METRIC_EU_IDLE, XPUM_STATS_EU_IDLE, DeviceCapability::METRIC_EU_ACTIVE_STALL_IDLE, false, false, MetricHandlerKind::STATS, "EU idle", false, MetricPriority::STREAMING},
+    {MeasurementType::METRIC_RAS_ERROR_CAT_RESET, XPUM_STATS_RAS_ERROR_CAT_RESET, DeviceCapability::METRIC_RAS_ERROR, true, true, MetricHandlerKind::STATS, "RAS reset", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_RAS_ERROR_CAT_PROGRAMMING_ERRORS, XPUM_STATS_RAS_ERROR_CAT_PROGRAMMING_ERRORS, DeviceCapability::METRIC_RAS_ERROR, false, true, MetricHandlerKind::STATS, "RAS programming errors", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_RAS_ERROR_CAT_DRIVER_ERRORS, XPUM_STATS_RAS_ERROR_CAT_DRIVER_ERRORS, DeviceCapability::METRIC_RAS_ERROR, false, true, MetricHandlerKind::STATS, "RAS driver errors", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE, XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE, DeviceCapability::METRIC_RAS_ERROR, false, true, MetricHandlerKind::STATS, "RAS cache correctable errors", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE, XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE, DeviceCapability::METRIC_RAS_ERROR, false, true, MetricHandlerKind::STATS, "RAS cache uncorrectable errors", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE, XPUM_STATS_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE, DeviceCapability::METRIC_RAS_ERROR, false, true, MetricHandlerKind::STATS, "RAS display correctable errors", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE, XPUM_STATS_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE, DeviceCapability::METRIC_RAS_ERROR, false, true, MetricHandlerKind::STATS, "RAS display uncorrectable errors", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE, XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE, DeviceCapability::METRIC_RAS_ERROR, false, true, MetricHandlerKind::STATS, "RAS non compute correctable errors", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE, XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE, DeviceCapability::METRIC_RAS_ERROR, false, true, MetricHandlerKind::STATS, "RAS non compute uncorrectable errors", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_REQUEST_FREQUENCY, XPUM_STATS_GPU_REQUEST_FREQUENCY, DeviceCapability::METRIC_FREQUENCY, false, false, MetricHandlerKind::STATS, "request frequency", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_MEMORY_TEMPERATURE, XPUM_STATS_MEMORY_TEMPERATURE, DeviceCapability::METRIC_MEMORY_TEMPERATURE, true, false, MetricHandlerKind::STATS, "memory temperature", true, MetricPriority::HIGH},
+    {MeasurementType::METRIC_FREQUENCY_THROTTLE, XPUM_STATS_FREQUENCY_THROTTLE, DeviceCapability::METRIC_FREQUENCY_THROTTLE, true, false, MetricHandlerKind::TIME_WEIGHTED_AVERAGE, "throttle frequency", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_PCIE_READ_THROUGHPUT, XPUM_STATS_PCIE_READ_THROUGHPUT, DeviceCapability::METRIC_PCIE_READ_THROUGHPUT, true, false, MetricHandlerKind::STATS, "PCIE read throughput", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_PCIE_WRITE_THROUGHPUT, XPUM_STATS_PCIE_WRITE_THROUGHPUT, DeviceCapability::METRIC_PCIE_WRITE_THROUGHPUT, true, false, MetricHandlerKind::STATS, "PCIE write throughput", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_PCIE_READ, XPUM_STATS_PCIE_READ, DeviceCapability::METRIC_PCIE_READ, true, true, MetricHandlerKind::STATS, "PCIE read", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_PCIE_WRITE, XPUM_STATS_PCIE_WRITE, DeviceCapability::METRIC_PCIE_WRITE, true, true, MetricHandlerKind::STATS, "PCIE write", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_ENGINE_UTILIZATION, XPUM_STATS_ENGINE_UTILIZATION, DeviceCapability::METRIC_ENGINE_UTILIZATION, true, false, MetricHandlerKind::ENGINE_UTILIZATION, "engine utilization", false, MetricPriority::LOW},
+    {MeasurementType::METRIC_FABRIC_THROUGHPUT, XPUM_STATS_FABRIC_THROUGHPUT, DeviceCapability::METRIC_FABRIC_THROUGHPUT, true, false, MetricHandlerKind::FABRIC_THROUGHPUT, "fabric throughput", false, MetricPriority::LOW},
+    {MeasurementType::METRIC_PERF, XPUM_STATS_MAX, DeviceCapability::METRIC_PERF, false, false, MetricHandlerKind::PERF, "", false, MetricPriority::STREAMING},
+    {MeasurementType::METRIC_FREQUENCY_THROTTLE_REASON_GPU, XPUM_STATS_FREQUENCY_THROTTLE_REASON_GPU, DeviceCapability::METRIC_FREQUENCY_THROTTLE_REASON_GPU, true, false, MetricHandlerKind::THROTTLE_REASON, "throttle reason", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_MEDIA_ENGINE_FREQUENCY, XPUM_STATS_MEDIA_ENGINE_FREQUENCY, DeviceCapability::METRIC_FREQUENCY, false, false, MetricHandlerKind::STATS, "media engine frequency", false, MetricPriority::HIGH},
+    {MeasurementType::METRIC_VF_ENGINE_UTILIZATION, XPUM_STATS_MAX, DeviceCapability::METRIC_VF_ENGINE_UTILIZATION, true, false, MetricHandlerKind::VF_ENGINE_UTILIZATION, "VF engine utilization", false, MetricPriority::LOW},
+};
+
+constexpr bool metricDescriptorsInOrder() {
+    for (int i = 0; i < MeasurementType::METRIC_MAX; i++) {
+        if (metric_descriptors[i].type != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(sizeof(metric_descriptors) / sizeof(metric_descriptors[0]) == MeasurementType::METRIC_MAX, "metric_descriptors misses a MeasurementType");
+static_assert(metricDescriptorsInOrder(), "metric_descriptors is not in the order of MeasurementType");
+
+// the reverse lookups of metric_descriptors
+struct MetricLookupTables {
+    MeasurementType by_stats_type[XPUM_STATS_MAX];
+    MeasurementType by_capability[(int)DeviceCapability::DEVICE_CAPABILITY_MAX];
+};
+
+constexpr MetricLookupTables buildMetricLookupTables() {
+    MetricLookupTables tables = {};
+    for (int i = 0; i < XPUM_STATS_MAX; i++) {
+        tables.by_stats_type[i] = MeasurementType::METRIC_MAX;
+    }
+    for (int i = 0; i < (int)DeviceCapability::DEVICE_CAPABILITY_MAX; i++) {
+        tables.by_capability[i] = MeasurementType::METRIC_MAX;
+    }
+    for (auto& descriptor : metric_descriptors) {
+        if (descriptor.stats_type != XPUM_STATS_MAX) {
+            tables.by_stats_type[descriptor.stats_type] = descriptor.type;
+        }
+        if (descriptor.primary) {
+            tables.by_capability[(int)descriptor.capability] = descriptor.type;
+        }
+    }
+    return tables;
+}
+
+constexpr MetricLookupTables metric_lookup_tables = buildMetricLookupTables();
+
+// nullptr if type is not a MeasurementType
+inline const MetricDescriptor* getMetricDescriptor(MeasurementType type) {
+    if (type < 0 || type >= MeasurementType::METRIC_MAX) {
+        return nullptr;
+    }
+    return &metric_descriptors[type];
+}
+
+} // end namespace xpum
@@ -0,0 +1,54 @@
+/* 
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file multi_metrics_schema.cpp
+ */
+
+#include "multi_metrics_schema.h"
+
+namespace xpum {
+
+std::shared_ptr<MultiMetricsSchema> MultiMetricsSchema::instance(const void* owner, MultiMetricsSchemaType type) {
+    static std::mutex instance_mutex;
+    static std::map<std::pair<const void*, MultiMetricsSchemaType>, std::shared_ptr<MultiMetricsSchema>> schemas;
+    std::lock_guard<std::mutex> lock(instance_mutex);
+    auto& schema = schemas[std::make_pair(owner, type)];
+    if (schema == nullptr) {
+        schema = std::make_shared<MultiMetricsSchema>();
+    }
+    return schema;
+}
+
+uint32_t MultiMetricsSchema::indexOf(uint64_t key) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = indexes.find(key);
+    if (it != indexes.end()) {
+        return it->second;
+    }
+    uint32_t index = keys.size();
+    keys.push_back(key);
+    indexes[key] = index;
+    return index;
+}
+
+bool MultiMetricsSchema::find(uint64_t key, uint32_t& index) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = indexes.find(key);
+    if (it == indexes.end()) {
+        return false;
+    }
+    index = it->second;
+    return true;
+}
+
+uint64_t MultiMetricsSchema::keyOf(uint32_t index) {
+    std::lock_guard<std::mutex> lock(mtx);
+    return keys[index];
+}
+
+uint32_t MultiMetricsSchema::size() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return keys.size();
+}
+
+} // namespace xpum
@@ -0,0 +1,58 @@
+/* 
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file multi_metrics_schema.h
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace xpum {
+
+enum MultiMetricsSchemaType {
+    // engine handles
+    SCHEMA_ENGINE,
+    // fabric port handles
+    SCHEMA_FABRIC_PORT,
+    // the fabric throughput IDs of the links of Device::getFabricLinks()
+    SCHEMA_FABRIC_THROUGHPUT,
+};
+
+/*
+  MultiMetricsSchema gives the engines or the fabric ports of one device a
+  dense index, assigned the first time the handle is added and kept for the
+  life of the device. The engine and fabric raw datas, the values calculated
+  from them and their statistics are arrays indexed by it, so the handlers and
+  the readers do not look the handles up in maps on every sample.
+*/
+class MultiMetricsSchema {
+   public:
+    // the schema of the type of owner (a device handle or a device), created on first use
+    static std::shared_ptr<MultiMetricsSchema> instance(const void* owner, MultiMetricsSchemaType type);
+
+    // the index of key, a new index is assigned if key was not added before
+    uint32_t indexOf(uint64_t key);
+
+    // whether key was added, and its index
+    bool find(uint64_t key, uint32_t& index);
+
+    // the key at index, it must be less than size()
+    uint64_t keyOf(uint32_t index);
+
+    uint32_t size();
+
+   private:
+    std::mutex mtx;
+
+    std::vector<uint64_t> keys;
+
+    std::unordered_map<uint64_t, uint32_t> indexes;
+};
+
+} // namespace xpum
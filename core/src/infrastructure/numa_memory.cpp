@@ -0,0 +1,80 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file numa_memory.cpp
+ */
+
+#include "numa_memory.h"
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+const size_t NumaMemory::HUGE_PAGE_SIZE;
+
+// the nodes beyond are not preferred, the memory stays on any node
+static bool toNodeMask(int node, unsigned long& nodemask) {
+    if (node < 0 || node >= (int)(sizeof(unsigned long) * 8)) {
+        return false;
+    }
+    nodemask = 1UL << node;
+    return true;
+}
+
+void* NumaMemory::allocate(size_t size, int node, bool huge_pages) {
+    if (size == 0) {
+        return nullptr;
+    }
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        XPUM_LOG_WARN("Failed to map {} bytes of sample memory: {}", size, strerror(errno));
+        return nullptr;
+    }
+    unsigned long nodemask;
+    // the pages are placed when they are first written, by the policy of the mapping
+    if (toNodeMask(node, nodemask) && syscall(SYS_mbind, p, size, MPOL_PREFERRED, &nodemask, sizeof(nodemask) * 8, 0) != 0) {
+        XPUM_LOG_WARN("Failed to prefer the memory of NUMA node {} for the samples: {}", node, strerror(errno));
+    }
+    if (huge_pages) {
+        adviseHugePages(p, size);
+    }
+    return p;
+}
+
+void NumaMemory::release(void* p, size_t size) {
+    if (p != nullptr) {
+        munmap(p, size);
+    }
+}
+
+bool NumaMemory::preferNode(int node) {
+    unsigned long nodemask;
+    if (!toNodeMask(node, nodemask)) {
+        return false;
+    }
+    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, &nodemask, sizeof(nodemask) * 8) != 0) {
+        XPUM_LOG_WARN("Failed to prefer the memory of NUMA node {}: {}", node, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void NumaMemory::adviseHugePages(void* p, size_t size) {
+    // a smaller mapping can not hold a huge page
+    if (p == nullptr || size < HUGE_PAGE_SIZE) {
+        return;
+    }
+    if (madvise(p, size, MADV_HUGEPAGE) != 0) {
+        XPUM_LOG_DEBUG("Failed to ask for huge pages: {}", strerror(errno));
+    }
+}
+
+} // end namespace xpum
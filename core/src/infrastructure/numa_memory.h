@@ -0,0 +1,39 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file numa_memory.h
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace xpum {
+
+/*
+  NumaMemory places the memory a device is sampled into on the NUMA node
+  local to the device, so the collection does not cross the sockets. The
+  node is only preferred, the memory comes from the other nodes when it is
+  full. It uses the system calls, not libnuma, which XPUM does not link to.
+*/
+class NumaMemory {
+   public:
+    static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    /*
+      Map size bytes of zeroed anonymous memory preferring node, any node if
+      it is -1. With huge_pages a mapping of at least HUGE_PAGE_SIZE is backed
+      by transparent huge pages. Return nullptr if it can not be mapped.
+    */
+    static void* allocate(size_t size, int node, bool huge_pages);
+
+    static void release(void* p, size_t size);
+
+    // prefer the memory of node for the allocations of the calling thread
+    static bool preferNode(int node);
+
+    // ask for transparent huge pages for a mapping, only the shmem and anonymous ones get them
+    static void adviseHugePages(void* p, size_t size);
+};
+
+} // end namespace xpum
@@ -22,12 +22,28 @@ struct PerfMetricData_t {
 struct PerfMetricGroupData_t {
     std::string name;
     std::vector<PerfMetricData_t> data;
+    // the fraction of the time the group was active when it is multiplexed with other groups
+    double active_ratio = 1;
 };
 
 struct PerfMetricDeviceData_t {
     std::vector<PerfMetricGroupData_t> data;
 };
 
+// the aggregation of one metric of a tile over the samples in a window
+struct PerfMetricStat_t {
+    uint32_t tile_id;
+    std::string group_name;
+    std::string metric_name;
+    double current;
+    double average;
+    double min;
+    double max;
+    uint32_t count;
+    // the active ratio of the group in the latest sample
+    double active_ratio;
+};
+
 class PerfMeasurementData : public MeasurementData {
    public:
     PerfMeasurementData();
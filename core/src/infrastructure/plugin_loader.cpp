@@ -0,0 +1,73 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file plugin_loader.cpp
+ */
+
+#include "plugin_loader.h"
+
+#include <dlfcn.h>
+
+#include <chrono>
+#include <cstring>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/logger.h"
+#include "infrastructure/xpum_config.h"
+
+namespace xpum {
+
+std::mutex PluginLoader::mutex;
+
+std::map<std::string, void*> PluginLoader::handles;
+
+const char* PluginLoader::getBuild() {
+    return XPUM_VERSION "+" XPUM_VERSION_GIT;
+}
+
+void* PluginLoader::open(const std::string& plugin) {
+    std::string dir = Configuration::PLUGIN_DIR;
+    if (!dir.empty() && dir.back() != '/') {
+        dir += '/';
+    }
+    std::string path = dir + "libxpum_" + plugin + ".so";
+    auto start = std::chrono::steady_clock::now();
+    // the plugin resolves the symbols of the core library it uses when loaded, not every first call
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr) {
+        XPUM_LOG_WARN("Plugin {} is not available: {}", plugin, dlerror());
+        return nullptr;
+    }
+    using BuildFunc = const char* (*)();
+    auto build = reinterpret_cast<BuildFunc>(dlsym(handle, XPUM_PLUGIN_BUILD_SYMBOL));
+    if (build == nullptr || std::strcmp(build(), getBuild()) != 0) {
+        XPUM_LOG_ERROR("Plugin {} is built from {} and does not fit {}", path, build == nullptr ? "unknown" : build(), getBuild());
+        dlclose(handle);
+        return nullptr;
+    }
+    XPUM_LOG_INFO("Plugin {} loaded in {} ms", path,
+                  std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+    return handle;
+}
+
+void* PluginLoader::getSymbol(const std::string& plugin, const std::string& symbol) {
+    void* handle;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto iter = handles.find(plugin);
+        if (iter == handles.end()) {
+            iter = handles.emplace(plugin, open(plugin)).first;
+        }
+        handle = iter->second;
+    }
+    if (handle == nullptr) {
+        return nullptr;
+    }
+    void* address = dlsym(handle, symbol.c_str());
+    if (address == nullptr) {
+        XPUM_LOG_ERROR("Plugin {} has no symbol {}", plugin, symbol);
+    }
+    return address;
+}
+
+} // end namespace xpum
@@ -0,0 +1,42 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file plugin_loader.h
+ */
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+
+// exported by every plugin, the XPUM version and commit the plugin is built from
+#define XPUM_PLUGIN_BUILD_SYMBOL "xpum_plugin_build"
+
+namespace xpum {
+
+/*
+  PluginLoader opens the subsystems built as plugins, libxpum_<name>.so in
+  Configuration::PLUGIN_DIR, on first use, so a process that never uses
+  them does not map, relocate or initialize them. A plugin uses the
+  internal classes of the core library, it is only loaded by the build it
+  comes from. The plugins are never unloaded.
+*/
+class PluginLoader {
+   public:
+    // the address of symbol in the plugin, nullptr if the plugin is not installed or does not fit
+    static void* getSymbol(const std::string& plugin, const std::string& symbol);
+
+    // the version and the commit of this build, what xpum_plugin_build() of a plugin returns
+    static const char* getBuild();
+
+   private:
+    static void* open(const std::string& plugin);
+
+    static std::mutex mutex;
+
+    // the handles by the plugin names, nullptr for a plugin that failed to load
+    static std::map<std::string, void*> handles;
+};
+
+} // end namespace xpum
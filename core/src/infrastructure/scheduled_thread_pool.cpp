@@ -12,6 +12,7 @@
 #include <thread>
 
 #include "logger.h"
+#include "thread_factory.h"
 
 // #define TRACE_SCHEDULED_TASK_RUN
 
@@ -60,7 +61,7 @@ void ScheduledThreadPool::init(uint32_t& size) {
             XPUM_LOG_TRACE("ScheduledThreadPool worker thread exit");
         };
         ////////////////////////////////////////////////////////////////////////////////////////////////////////////
-        this->workers.emplace_back(std::thread(worker_thread_proc));
+        this->workers.emplace_back(ThreadFactory::create("xpum-monitor", worker_thread_proc));
         XPUM_LOG_TRACE("workder thread created in scheduled thread pool");
     }
 }
@@ -81,6 +82,11 @@ void ScheduledThreadPool::close() {
     XPUM_LOG_TRACE("scheduled thread pool closed");
 }
 
+void ScheduledThreadPool::reschedule(std::shared_ptr<ScheduledThreadPoolTask> p_task, uint64_t delay, uint32_t interval) {
+    if (p_task == nullptr || this->stop.load(std::memory_order_acquire)) return;
+    this->p_taskqueue->reschedule(p_task, delay, interval);
+}
+
 /// ScheduledThreadPoolTask
 
 bool ScheduledThreadPoolTask::after(std::shared_ptr<ScheduledThreadPoolTask> other) {
@@ -89,22 +95,29 @@ bool ScheduledThreadPoolTask::after(std::shared_ptr<ScheduledThreadPoolTask> oth
 
 bool ScheduledThreadPoolTask::next() {
     if (this->remaining_exe_time == 0) return false;
-    this->scheduled_time += std::chrono::milliseconds{this->interval};
+    uint32_t interval = this->interval;
+    this->scheduled_time += std::chrono::milliseconds{interval};
     auto now = std::chrono::steady_clock::now();
     if (now > this->scheduled_time) {
         // the scheduled time is too far before now, advance it to a near time
         auto gap_to_now = std::chrono::duration_cast<std::chrono::milliseconds>(now - this->scheduled_time);
-        auto gaps = gap_to_now.count() / this->interval;
-        auto advanced_ms = std::chrono::milliseconds{this->interval * gaps};
+        auto gaps = gap_to_now.count() / interval;
+        auto advanced_ms = std::chrono::milliseconds{interval * gaps};
         this->scheduled_time += advanced_ms;
     }
     return true;
 }
 
+namespace {
+
+thread_local uint64_t current_lateness = 0;
+
+} // namespace
+
 void ScheduledThreadPoolTask::run() {
-#ifdef TRACE_SCHEDULED_TASK_RUN
     auto start = std::chrono::steady_clock::now();
     auto delay = start - this->scheduled_time;
+#ifdef TRACE_SCHEDULED_TASK_RUN
     XPUM_LOG_DEBUG("calling user function in worker thread, scheduled_time delayed: {}us",
                    std::chrono::duration_cast<std::chrono::microseconds>(delay).count());
 
@@ -113,7 +126,21 @@ void ScheduledThreadPoolTask::run() {
         return;
     else if (this->remaining_exe_time > 0)
         this->remaining_exe_time--;
+    auto lateness_count = std::chrono::duration_cast<std::chrono::microseconds>(delay).count();
+    uint64_t lateness = lateness_count > 0 ? lateness_count : 0;
+    if (this->run_count > 0) {
+        this->total_jitter += lateness > this->last_lateness ? lateness - this->last_lateness : this->last_lateness - lateness;
+    }
+    this->last_lateness = lateness;
+    this->total_lateness += lateness;
+    if (lateness > this->max_lateness) {
+        this->max_lateness = lateness;
+    }
+    this->run_count++;
+    auto lateness_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count();
+    current_lateness = lateness_ns > 0 ? lateness_ns : 0;
     this->func();
+    current_lateness = 0;
 #ifdef TRACE_SCHEDULED_TASK_RUN
     auto duration = std::chrono::steady_clock::now() - start;
     XPUM_LOG_DEBUG("user function runs for {}ms",
@@ -129,32 +156,52 @@ int ScheduledThreadPoolTask::getExeTime(){
     return exe_time;
 }
 
+uint64_t ScheduledThreadPoolTask::getCurrentLateness() {
+    return current_lateness;
+}
+
+ScheduledTaskStats ScheduledThreadPoolTask::getStats() {
+    ScheduledTaskStats stats;
+    stats.run_count = this->run_count;
+    stats.avg_lateness = stats.run_count > 0 ? this->total_lateness / stats.run_count : 0;
+    stats.max_lateness = this->max_lateness;
+    stats.avg_jitter = stats.run_count > 1 ? this->total_jitter / (stats.run_count - 1) : 0;
+    return stats;
+}
+
+namespace {
+
+// orders the heap so that the task scheduled earliest is at the front
+bool runsAfter(const std::shared_ptr<ScheduledThreadPoolTask>& a, const std::shared_ptr<ScheduledThreadPoolTask>& b) {
+    return a->after(b);
+}
+
+} // namespace
+
 /// SchedulingQueue
 
 void SchedulingQueue::enqueue(std::shared_ptr<ScheduledThreadPoolTask> newTask) {
+    bool new_head = false;
     {
         std::lock_guard<std::mutex> lock(q_mutex);
         if (this->stop.load(std::memory_order_acquire)) {
             XPUM_LOG_TRACE("trying to enqueue after queue has stopped");
             return;
         }
-        auto itr = std::find_if(q.rbegin(), q.rend(), [&newTask](auto& item) {
-            return newTask->after(item);
-        });
-
-        if (itr == q.rbegin()) {
-            // if at rbegin then newTask's priority is now the lowest
-            q.emplace_back(newTask);
-        } else if (itr == q.rend()) {
-            // if at rend then newTask's priority is now the highest
-            q.emplace_front(newTask);
-        } else {
-            // insert in middle
-            q.emplace(itr.base(), newTask);
+        if (newTask->rearm_pending) {
+            // rescheduled while it was running, the time advanced by next() is replaced
+            newTask->scheduled_time = newTask->rearm_time;
+            newTask->interval = newTask->rearm_interval;
+            newTask->rearm_pending = false;
         }
+        q.emplace_back(newTask);
+        std::push_heap(q.begin(), q.end(), runsAfter);
+        new_head = q.front() == newTask;
+    }
+    // waiters sleep until the scheduled time of the head, only wake one if the head changed
+    if (new_head) {
+        cv.notify_one();
     }
-    // notify all waiters on task queue change so that they can try to get new task from the queue
-    cv.notify_all();
 }
 
 std::shared_ptr<ScheduledThreadPoolTask> SchedulingQueue::dequeue() {
@@ -165,12 +212,18 @@ std::shared_ptr<ScheduledThreadPoolTask> SchedulingQueue::dequeue() {
             auto now = std::chrono::steady_clock::now();
             if (first->cancelled) {
                 // if the first task has been cancelled, remove it from the queue and continue to lookup next task in the queue
-                q.pop_front();
+                std::pop_heap(q.begin(), q.end(), runsAfter);
+                q.pop_back();
                 continue;
             }
             if (now >= first->scheduled_time) {
                 // if the task at the head of the queue has reached its scheduled time
-                q.pop_front();
+                std::pop_heap(q.begin(), q.end(), runsAfter);
+                q.pop_back();
+                if (!q.empty()) {
+                    // let another waiter pick up the new head
+                    cv.notify_one();
+                }
                 return first;
             }
             cv.wait_for(lock, first->scheduled_time - now);
@@ -181,6 +234,26 @@ std::shared_ptr<ScheduledThreadPoolTask> SchedulingQueue::dequeue() {
     return nullptr;
 }
 
+void SchedulingQueue::reschedule(std::shared_ptr<ScheduledThreadPoolTask> p_task, uint64_t delay, uint32_t interval) {
+    if (interval == 0) return;
+    auto at = std::chrono::steady_clock::now() + std::chrono::milliseconds{delay};
+    {
+        std::lock_guard<std::mutex> lock(q_mutex);
+        if (std::find(q.begin(), q.end(), p_task) == q.end()) {
+            // the task is running, or has ended, enqueue() applies the new schedule
+            p_task->rearm_time = at;
+            p_task->rearm_interval = interval;
+            p_task->rearm_pending = true;
+            return;
+        }
+        p_task->scheduled_time = at;
+        p_task->interval = interval;
+        std::make_heap(q.begin(), q.end(), runsAfter);
+    }
+    // the head may have changed, the waiters sleep until its scheduled time
+    cv.notify_all();
+}
+
 void SchedulingQueue::close() {
     if (this->stop.load(std::memory_order_acquire)) return;
     XPUM_LOG_TRACE("closing scheduling queue");
@@ -11,7 +11,6 @@
 #include <condition_variable>
 #include <cstdint>
 #include <functional>
-#include <list>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -19,6 +18,18 @@
 
 namespace xpum {
 
+/**
+ * @brief How late a task starts compared to its scheduled time, in microseconds
+ * 
+ */
+struct ScheduledTaskStats {
+    uint64_t run_count;
+    uint64_t avg_lateness;
+    uint64_t max_lateness;
+    // the mean difference between the lateness of two successive runs
+    uint64_t avg_jitter;
+};
+
 class ScheduledThreadPoolTask {
     friend class SchedulingQueue;
 
@@ -31,7 +42,7 @@ class ScheduledThreadPoolTask {
      * @param execution_times the execution times of the task (-1 indicates run forever)
      * @param func the function to execute
      */
-    ScheduledThreadPoolTask(uint64_t delay, uint32_t interval, int execution_times, std::function<void()> func) : interval(interval), remaining_exe_time(execution_times), exe_time(execution_times), func(func), cancelled(false) {
+    ScheduledThreadPoolTask(uint64_t delay, uint32_t interval, int execution_times, std::function<void()> func) : interval(interval), remaining_exe_time(execution_times), exe_time(execution_times), func(func), cancelled(false), rearm_pending(false), rearm_interval(0), run_count(0), total_lateness(0), max_lateness(0), total_jitter(0), last_lateness(0) {
         scheduled_time = std::chrono::steady_clock::now() + std::chrono::milliseconds{delay};
     }
 
@@ -72,8 +83,22 @@ class ScheduledThreadPoolTask {
 
     int getExeTime();
 
+    /**
+     * @brief Gets the lateness statistics of the runs of this task so far
+     * 
+     * @return ScheduledTaskStats 
+     */
+    ScheduledTaskStats getStats();
+
+    /**
+     * @brief Gets how late the run in progress in the calling thread started, in nanoseconds
+     * 
+     * @return uint64_t 0 if the calling thread is not running a task
+     */
+    static uint64_t getCurrentLateness();
+
    private:
-    uint32_t interval;
+    std::atomic<uint32_t> interval;
     // One design option is that we can use remaining_exe_time to judge whether is the task finished.
     // But then this member will need to be public and should be sync. So, we choose the member exe_time to finish the work.
     int remaining_exe_time;
@@ -81,6 +106,16 @@ class ScheduledThreadPoolTask {
     std::function<void()> func;
     std::chrono::steady_clock::time_point scheduled_time;
     std::atomic<bool> cancelled;
+    // set by SchedulingQueue::reschedule() while the task runs, applied when it is enqueued again; guarded by the queue mutex
+    bool rearm_pending;
+    std::chrono::steady_clock::time_point rearm_time;
+    uint32_t rearm_interval;
+    // updated by the worker running the task, a task is never run by two workers at the same time
+    std::atomic<uint64_t> run_count;
+    std::atomic<uint64_t> total_lateness;
+    std::atomic<uint64_t> max_lateness;
+    std::atomic<uint64_t> total_jitter;
+    uint64_t last_lateness;
 };
 
 class SchedulingQueue {
@@ -101,10 +136,20 @@ class SchedulingQueue {
      */
     std::shared_ptr<ScheduledThreadPoolTask> dequeue();
 
+    /**
+     * @brief Moves the next run of a queued or running task to delay milliseconds from now and runs it every interval milliseconds after that
+     * 
+     * @param p_task 
+     * @param delay 
+     * @param interval 
+     */
+    void reschedule(std::shared_ptr<ScheduledThreadPoolTask> p_task, uint64_t delay, uint32_t interval);
+
     void close();
 
    private:
-    std::list<std::shared_ptr<ScheduledThreadPoolTask>> q;
+    // a min-heap on scheduled_time, the task to run next is at the front
+    std::vector<std::shared_ptr<ScheduledThreadPoolTask>> q;
     std::mutex q_mutex;
     std::condition_variable cv;
     std::atomic<bool> stop;
@@ -123,6 +168,15 @@ class ScheduledThreadPool {
         return p_task;
     }
 
+    /**
+     * @brief Re-arms a task with a new interval in place, its statistics and remaining runs are kept
+     * 
+     * @param p_task the task returned by scheduleAtFixedRate
+     * @param delay the time in milliseconds to the next execution
+     * @param interval the new interval in milliseconds
+     */
+    void reschedule(std::shared_ptr<ScheduledThreadPoolTask> p_task, uint64_t delay, uint32_t interval);
+
     void close();
 
    private:
@@ -0,0 +1,102 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file suspension.cpp
+ */
+
+#include "suspension.h"
+
+#include <exception>
+
+#include "infrastructure/logger.h"
+#include "infrastructure/thread_factory.h"
+
+namespace xpum {
+
+static thread_local SuspendScope* current_suspend_scope = nullptr;
+
+SuspendScope::SuspendScope() : previous(current_suspend_scope) {
+    current_suspend_scope = this;
+}
+
+SuspendScope::~SuspendScope() {
+    current_suspend_scope = previous;
+}
+
+bool SuspendScope::active() {
+    return current_suspend_scope != nullptr;
+}
+
+std::shared_ptr<SuspendedMeasurementData> SuspendScope::suspend(std::chrono::steady_clock::time_point resume_at,
+                                                                std::function<std::shared_ptr<MeasurementData>()> resume) {
+    auto p_suspended = std::make_shared<SuspendedMeasurementData>(resume_at, resume);
+    current_suspend_scope->p_suspended = p_suspended;
+    return p_suspended;
+}
+
+std::shared_ptr<SuspendedMeasurementData> SuspendScope::take() {
+    if (current_suspend_scope == nullptr) {
+        return nullptr;
+    }
+    return std::move(current_suspend_scope->p_suspended);
+}
+
+ResumeExecutor& ResumeExecutor::instance() {
+    static ResumeExecutor executor;
+    return executor;
+}
+
+ResumeExecutor::ResumeExecutor() : sequence(0), stop(false) {
+    worker = ThreadFactory::create("xpum-resume", [this]() { run(); });
+}
+
+ResumeExecutor::~ResumeExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void ResumeExecutor::schedule(std::chrono::steady_clock::time_point resume_at, std::function<void()> continuation) {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool earliest = entries.empty() || resume_at < entries.top().resume_at;
+    entries.push(Entry{resume_at, sequence++, std::move(continuation)});
+    if (earliest) {
+        cv.notify_one();
+    }
+}
+
+void ResumeExecutor::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        if (entries.empty()) {
+            if (stop) {
+                break;
+            }
+            cv.wait(lock);
+            continue;
+        }
+        // at stop the continuations left are run at once, a getter may hold a window open until its continuation
+        if (!stop && std::chrono::steady_clock::now() < entries.top().resume_at) {
+            cv.wait_until(lock, entries.top().resume_at);
+            continue;
+        }
+        auto continuation = std::move(const_cast<Entry&>(entries.top()).continuation);
+        entries.pop();
+        lock.unlock();
+        try {
+            continuation();
+        } catch (std::exception& e) {
+            XPUM_LOG_ERROR("Failed to resume a suspended collection: {}", e.what());
+        } catch (...) {
+            XPUM_LOG_ERROR("Failed to resume a suspended collection: unexpected exception");
+        }
+        lock.lock();
+    }
+}
+
+} // end namespace xpum
@@ -0,0 +1,118 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file suspension.h
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "measurement_data.h"
+
+namespace xpum {
+
+/*
+  A getter that has to wait for a sampling window suspends instead of
+  sleeping, like a coroutine would; the tree is C++14, so the rest of the
+  getter is a continuation. Called in a SuspendScope, the getter starts the
+  window and returns a SuspendedMeasurementData, the caller hands it to the
+  ResumeExecutor, which runs the continuation once the window is over.
+  Outside of a scope the getters sleep as before.
+*/
+class SuspendedMeasurementData : public MeasurementData {
+   public:
+    SuspendedMeasurementData(std::chrono::steady_clock::time_point resume_at,
+                             std::function<std::shared_ptr<MeasurementData>()> resume)
+        : resume_at(resume_at), resume(resume) {}
+
+    std::chrono::steady_clock::time_point resume_at;
+
+    // returns the data of the getter or throws its exception, it never suspends again
+    std::function<std::shared_ptr<MeasurementData>()> resume;
+};
+
+/*
+  The getters called by this thread may suspend while the scope lives. The
+  data is not polymorphic, so a suspending getter goes through suspend(),
+  and the caller asks take() whether the data it got is a suspension.
+*/
+class SuspendScope {
+   public:
+    SuspendScope();
+
+    ~SuspendScope();
+
+    SuspendScope(const SuspendScope&) = delete;
+
+    SuspendScope& operator=(const SuspendScope&) = delete;
+
+    static bool active();
+
+    // only in an active scope, the suspension is returned by the getter as its data
+    static std::shared_ptr<SuspendedMeasurementData> suspend(std::chrono::steady_clock::time_point resume_at,
+                                                             std::function<std::shared_ptr<MeasurementData>()> resume);
+
+    // the suspension of the last getter, null if it did not suspend
+    static std::shared_ptr<SuspendedMeasurementData> take();
+
+   private:
+    SuspendScope* previous;
+
+    std::shared_ptr<SuspendedMeasurementData> p_suspended;
+};
+
+/*
+  ResumeExecutor runs the continuations of the suspended getters of all
+  devices on one thread. A continuation must be short and must not sleep,
+  the other continuations wait for it.
+*/
+class ResumeExecutor {
+   public:
+    static ResumeExecutor& instance();
+
+    void schedule(std::chrono::steady_clock::time_point resume_at, std::function<void()> continuation);
+
+   private:
+    struct Entry {
+        std::chrono::steady_clock::time_point resume_at;
+        uint64_t sequence;
+        std::function<void()> continuation;
+
+        // the earliest on top of the queue, in order of scheduling for the same time
+        bool operator<(const Entry& other) const {
+            return resume_at != other.resume_at ? resume_at > other.resume_at : sequence > other.sequence;
+        }
+    };
+
+    ResumeExecutor();
+
+    ~ResumeExecutor();
+
+    ResumeExecutor(const ResumeExecutor&) = delete;
+
+    ResumeExecutor& operator=(const ResumeExecutor&) = delete;
+
+    void run();
+
+    std::mutex mutex;
+
+    std::condition_variable cv;
+
+    std::priority_queue<Entry> entries;
+
+    uint64_t sequence;
+
+    bool stop;
+
+    std::thread worker;
+};
+
+} // end namespace xpum
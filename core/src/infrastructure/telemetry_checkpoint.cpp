@@ -0,0 +1,359 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file telemetry_checkpoint.cpp
+ */
+
+#include "telemetry_checkpoint.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+#include "control/device_manager_interface.h"
+#include "device/device.h"
+#include "infrastructure/configuration.h"
+#include "infrastructure/logger.h"
+#include "infrastructure/thread_factory.h"
+#include "infrastructure/utility.h"
+
+namespace xpum {
+
+namespace {
+
+const char CP_FILE_MAGIC[8] = {'X', 'P', 'U', 'M', 'C', 'P', '0', '1'};
+const uint32_t CP_FILE_VERSION = 1;
+const uint32_t CP_FILE_HEADER_SIZE = 4096;
+const uint32_t CP_SLOT_COUNT = 2;
+const uint32_t CP_SLOT_MAGIC = 0x50434B58;
+const uint32_t CP_MAX_RECORDS = 1024;
+
+struct CheckpointFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t slot_size;
+    uint32_t slot_count;
+};
+
+struct CheckpointSlotHeader {
+    uint32_t magic;
+    // of the rest of the header and the records
+    uint32_t checksum;
+    uint64_t sequence;
+    int64_t time;
+    char boot_id[40];
+    uint32_t record_count;
+    uint32_t reserved;
+};
+
+struct CheckpointFileRecord {
+    char section[16];
+    char bdf[16];
+    uint32_t subdevice_id;
+    uint32_t reserved;
+    uint64_t values[CheckpointRecord::MAX_VALUES];
+};
+
+const uint32_t CP_SLOT_SIZE = (sizeof(CheckpointSlotHeader) + CP_MAX_RECORDS * sizeof(CheckpointFileRecord) + 4095) / 4096 * 4096;
+
+const uint32_t CP_FILE_SIZE = CP_FILE_HEADER_SIZE + CP_SLOT_COUNT * CP_SLOT_SIZE;
+
+uint32_t checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t slotChecksum(const uint8_t* slot, uint32_t record_count) {
+    size_t begin = offsetof(CheckpointSlotHeader, sequence);
+    return checksum(slot + begin, sizeof(CheckpointSlotHeader) - begin + (size_t)record_count * sizeof(CheckpointFileRecord));
+}
+
+bool createDirectories(const std::string& dir) {
+    std::string path;
+    for (size_t pos = 0; pos != std::string::npos;) {
+        pos = dir.find('/', pos + 1);
+        path = dir.substr(0, pos);
+        if (path.empty()) {
+            continue;
+        }
+        if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string readFirstLine(const std::string& path) {
+    std::ifstream ifs(path);
+    std::string line;
+    if (ifs.good()) {
+        std::getline(ifs, line);
+    }
+    return line;
+}
+
+// copy a string into a fixed size field, always terminated
+void copyField(char* field, size_t size, const std::string& value) {
+    std::memset(field, 0, size);
+    std::strncpy(field, value.c_str(), size - 1);
+}
+
+std::string readField(const char* field, size_t size) {
+    return std::string(field, strnlen(field, size));
+}
+
+} // namespace
+
+TelemetryCheckpoint& TelemetryCheckpoint::instance() {
+    static TelemetryCheckpoint checkpoint;
+    return checkpoint;
+}
+
+TelemetryCheckpoint::TelemetryCheckpoint() : fd(-1), base(nullptr), next_sequence(1), stopping(false) {
+}
+
+TelemetryCheckpoint::~TelemetryCheckpoint() {
+    stop();
+}
+
+void TelemetryCheckpoint::registerSection(const std::string& name, SaveFunc save, RestoreFunc restore) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // a section registered again, after xpumInit is called again, replaces the former one
+    Section section{name.substr(0, 15), save, restore};
+    auto iter = std::find_if(sections.begin(), sections.end(), [&section](const Section& s) { return s.name == section.name; });
+    if (iter != sections.end()) {
+        *iter = section;
+    } else {
+        sections.push_back(section);
+    }
+}
+
+void TelemetryCheckpoint::start(std::shared_ptr<DeviceManagerInterface> p_device_manager) {
+    if (Configuration::CHECKPOINT_FILE.empty() || Configuration::getXPUMMode() != "xpum" || p_device_manager == nullptr) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    if (worker.joinable()) {
+        return;
+    }
+    std::vector<std::shared_ptr<Device>> devices;
+    p_device_manager->getDeviceList(devices);
+    for (auto& p_device : devices) {
+        Property prop;
+        if (p_device->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS, prop) && !prop.getValue().empty()) {
+            device_bdfs[p_device->getId()] = prop.getValue();
+            bdf_devices[prop.getValue()] = p_device->getId();
+        }
+    }
+    boot_id = readFirstLine("/proc/sys/kernel/random/boot_id");
+    if (!open()) {
+        return;
+    }
+    restore();
+    stopping = false;
+    worker = ThreadFactory::create("xpum-checkpoint", [this]() { run(); });
+}
+
+void TelemetryCheckpoint::stop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!worker.joinable()) {
+        return;
+    }
+    stopping = true;
+    cv.notify_all();
+    lock.unlock();
+    worker.join();
+    lock.lock();
+    save();
+    close();
+}
+
+bool TelemetryCheckpoint::open() {
+    auto& path = Configuration::CHECKPOINT_FILE;
+    size_t pos = path.find_last_of('/');
+    if (pos != std::string::npos && pos > 0 && !createDirectories(path.substr(0, pos))) {
+        XPUM_LOG_WARN("Failed to create the directory of checkpoint file {}: {}", path, strerror(errno));
+        return false;
+    }
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        XPUM_LOG_WARN("Failed to open checkpoint file {}: {}", path, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close();
+        return false;
+    }
+    bool fresh = st.st_size != (off_t)CP_FILE_SIZE;
+    if (fresh && (ftruncate(fd, 0) != 0 || ftruncate(fd, CP_FILE_SIZE) != 0)) {
+        XPUM_LOG_WARN("Failed to resize checkpoint file {}: {}", path, strerror(errno));
+        close();
+        return false;
+    }
+    void* p = mmap(nullptr, CP_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        XPUM_LOG_WARN("Failed to map checkpoint file {}: {}", path, strerror(errno));
+        close();
+        return false;
+    }
+    base = (uint8_t*)p;
+
+    CheckpointFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (!fresh && (std::memcmp(header.magic, CP_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != CP_FILE_VERSION || header.record_size != sizeof(CheckpointFileRecord) || header.slot_size != CP_SLOT_SIZE || header.slot_count != CP_SLOT_COUNT)) {
+        XPUM_LOG_INFO("Checkpoint file {} has a different layout, reset it", path);
+        fresh = true;
+    }
+    if (fresh) {
+        std::memset(base, 0, CP_FILE_SIZE);
+        std::memcpy(header.magic, CP_FILE_MAGIC, sizeof(header.magic));
+        header.version = CP_FILE_VERSION;
+        header.record_size = sizeof(CheckpointFileRecord);
+        header.slot_size = CP_SLOT_SIZE;
+        header.slot_count = CP_SLOT_COUNT;
+        std::memcpy(base, &header, sizeof(header));
+        msync(base, CP_FILE_SIZE, MS_ASYNC);
+    }
+    return true;
+}
+
+void TelemetryCheckpoint::close() {
+    if (base != nullptr) {
+        msync(base, CP_FILE_SIZE, MS_SYNC);
+        munmap(base, CP_FILE_SIZE);
+        base = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void TelemetryCheckpoint::restore() {
+    auto begin = std::chrono::steady_clock::now();
+    const uint8_t* latest = nullptr;
+    CheckpointSlotHeader latest_header{};
+    for (uint32_t i = 0; i < CP_SLOT_COUNT; i++) {
+        const uint8_t* slot = base + CP_FILE_HEADER_SIZE + (size_t)i * CP_SLOT_SIZE;
+        CheckpointSlotHeader header;
+        std::memcpy(&header, slot, sizeof(header));
+        if (header.magic != CP_SLOT_MAGIC || header.record_count > CP_MAX_RECORDS || slotChecksum(slot, header.record_count) != header.checksum) {
+            continue;
+        }
+        next_sequence = std::max(next_sequence, header.sequence + 1);
+        if (latest == nullptr || header.sequence > latest_header.sequence) {
+            latest = slot;
+            latest_header = header;
+        }
+    }
+    if (latest == nullptr) {
+        return;
+    }
+    if (boot_id.empty() || readField(latest_header.boot_id, sizeof(latest_header.boot_id)) != boot_id) {
+        XPUM_LOG_INFO("The checkpoint of {} is of another boot, it is not restored", latest_header.time);
+        return;
+    }
+
+    std::map<std::string, std::vector<CheckpointRecord>> section_records;
+    uint32_t dropped = 0;
+    const CheckpointFileRecord* p_records = (const CheckpointFileRecord*)(latest + sizeof(CheckpointSlotHeader));
+    for (uint32_t i = 0; i < latest_header.record_count; i++) {
+        auto& file_record = p_records[i];
+        auto iter = bdf_devices.find(readField(file_record.bdf, sizeof(file_record.bdf)));
+        if (iter == bdf_devices.end()) {
+            dropped++;
+            continue;
+        }
+        CheckpointRecord record;
+        record.device_id = iter->second;
+        record.subdevice_id = file_record.subdevice_id;
+        std::memcpy(record.values, file_record.values, sizeof(record.values));
+        section_records[readField(file_record.section, sizeof(file_record.section))].push_back(record);
+    }
+    for (auto& section : sections) {
+        auto iter = section_records.find(section.name);
+        if (iter == section_records.end()) {
+            continue;
+        }
+        try {
+            section.restore(iter->second);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Failed to restore checkpoint section {}: {}", section.name, e.what());
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+    XPUM_LOG_INFO("Restored {} records of the checkpoint of {} in {} us, {} records of devices gone are dropped",
+                  latest_header.record_count - dropped, latest_header.time, elapsed, dropped);
+}
+
+void TelemetryCheckpoint::save() {
+    if (base == nullptr) {
+        return;
+    }
+    uint8_t* slot = base + CP_FILE_HEADER_SIZE + (size_t)(next_sequence % CP_SLOT_COUNT) * CP_SLOT_SIZE;
+    CheckpointFileRecord* p_records = (CheckpointFileRecord*)(slot + sizeof(CheckpointSlotHeader));
+    uint32_t count = 0;
+    std::vector<CheckpointRecord> records;
+    for (auto& section : sections) {
+        records.clear();
+        try {
+            section.save(records);
+        } catch (std::exception& e) {
+            XPUM_LOG_WARN("Failed to save checkpoint section {}: {}", section.name, e.what());
+            continue;
+        }
+        for (auto& record : records) {
+            auto iter = device_bdfs.find(record.device_id);
+            if (iter == device_bdfs.end()) {
+                continue;
+            }
+            if (count == CP_MAX_RECORDS) {
+                XPUM_LOG_WARN("The checkpoint is full, the records of section {} are cut", section.name);
+                break;
+            }
+            auto& file_record = p_records[count++];
+            copyField(file_record.section, sizeof(file_record.section), section.name);
+            copyField(file_record.bdf, sizeof(file_record.bdf), iter->second);
+            file_record.subdevice_id = record.subdevice_id;
+            file_record.reserved = 0;
+            std::memcpy(file_record.values, record.values, sizeof(file_record.values));
+        }
+    }
+    CheckpointSlotHeader header{};
+    header.magic = CP_SLOT_MAGIC;
+    header.sequence = next_sequence++;
+    header.time = Utility::getCurrentTime();
+    copyField(header.boot_id, sizeof(header.boot_id), boot_id);
+    header.record_count = count;
+    std::memcpy(slot, &header, sizeof(header));
+    header.checksum = slotChecksum(slot, count);
+    std::memcpy(slot, &header, sizeof(header));
+    msync(slot, CP_SLOT_SIZE, MS_ASYNC);
+}
+
+void TelemetryCheckpoint::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        cv.wait_for(lock, std::chrono::seconds(Configuration::CHECKPOINT_INTERVAL), [this]() { return stopping; });
+        if (stopping) {
+            break;
+        }
+        save();
+    }
+}
+
+} // end namespace xpum
@@ -0,0 +1,121 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file telemetry_checkpoint.h
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xpum {
+
+class DeviceManagerInterface;
+
+// the state of a device or a tile saved by a checkpoint section
+struct CheckpointRecord {
+    static const uint32_t MAX_VALUES = 10;
+
+    // the device ID the record is saved from or restored to
+    std::string device_id;
+    // UINT32_MAX for the device
+    uint32_t subdevice_id;
+    uint64_t values[MAX_VALUES];
+
+    CheckpointRecord() : subdevice_id(UINT32_MAX), values() {}
+};
+
+/*
+  TelemetryCheckpoint keeps the telemetry state that only grows, like the
+  accumulated counters, across restarts of xpumd. The components register
+  a section that saves its state as records and restores it from them. The
+  records are written every CHECKPOINT_INTERVAL seconds and when xpumd
+  stops into a memory-mapped file, the sections are restored from it when
+  xpumd starts, before the monitor tasks run.
+
+  The file has two slots written in turn, a slot is only read if its
+  checksum is right, so a crash while writing leaves the previous
+  checkpoint. A checkpoint of another boot is dropped, the device counters
+  were reset then. The records are stored by the PCI address of their
+  device, device IDs may change between two runs, and the records of a
+  device that is gone are dropped.
+*/
+class TelemetryCheckpoint {
+   public:
+    typedef std::function<void(std::vector<CheckpointRecord>& records)> SaveFunc;
+
+    typedef std::function<void(const std::vector<CheckpointRecord>& records)> RestoreFunc;
+
+    static TelemetryCheckpoint& instance();
+
+    // only the sections registered before start() are restored, the name is cut to 15 characters
+    // and a section of the same name is replaced
+    void registerSection(const std::string& name, SaveFunc save, RestoreFunc restore);
+
+    // restore the sections and start the checkpoints, nothing is done if CHECKPOINT_FILE is empty
+    void start(std::shared_ptr<DeviceManagerInterface> p_device_manager);
+
+    // write the last checkpoint and stop
+    void stop();
+
+    // the PCI address by device ID, set by start() and read by the sections without a lock
+    const std::map<std::string, std::string>& getDeviceBdfs() const { return device_bdfs; }
+
+   private:
+    struct Section {
+        std::string name;
+        SaveFunc save;
+        RestoreFunc restore;
+    };
+
+    TelemetryCheckpoint();
+
+    ~TelemetryCheckpoint();
+
+    TelemetryCheckpoint(const TelemetryCheckpoint&) = delete;
+
+    TelemetryCheckpoint& operator=(const TelemetryCheckpoint&) = delete;
+
+    bool open();
+
+    void close();
+
+    void restore();
+
+    void save();
+
+    void run();
+
+    std::vector<Section> sections;
+
+    // the PCI address of each device ID and the reverse, they do not change after start()
+    std::map<std::string, std::string> device_bdfs;
+
+    std::map<std::string, std::string> bdf_devices;
+
+    std::string boot_id;
+
+    int fd;
+
+    uint8_t* base;
+
+    uint64_t next_sequence;
+
+    std::mutex mutex;
+
+    std::condition_variable cv;
+
+    bool stopping;
+
+    std::thread worker;
+};
+
+} // end namespace xpum
@@ -0,0 +1,121 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file thread_factory.cpp
+ */
+
+#include "thread_factory.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/logger.h"
+#include "infrastructure/numa_memory.h"
+
+namespace xpum {
+
+// a list like "0-3,8", as Topology::parseCpuList, kept here so the tools built from the infrastructure sources need no hwloc
+static bool parseCpuList(const std::string& cpu_list, std::set<int>& cpus) {
+    std::stringstream ss(cpu_list);
+    std::string range;
+    try {
+        while (std::getline(ss, range, ',')) {
+            if (range.find_first_not_of(" \t\n") == std::string::npos) {
+                continue;
+            }
+            std::size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.insert(cpu);
+            }
+        }
+    } catch (std::exception& e) {
+        return false;
+    }
+    return true;
+}
+
+const std::set<int>& ThreadFactory::getHousekeepingCpus() {
+    static const std::set<int> cpus = []() {
+        std::set<int> result;
+        if (!Configuration::HOUSEKEEPING_CPUS.empty() && !parseCpuList(Configuration::HOUSEKEEPING_CPUS, result)) {
+            XPUM_LOG_WARN("Invalid XPUM_HOUSEKEEPING_CPUS: {}", Configuration::HOUSEKEEPING_CPUS);
+            result.clear();
+        }
+        if (Configuration::HOUSEKEEPING_NODE >= 0) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(Configuration::HOUSEKEEPING_NODE) + "/cpulist");
+            std::string cpu_list;
+            if (!std::getline(file, cpu_list) || !parseCpuList(cpu_list, result)) {
+                XPUM_LOG_WARN("Failed to read the CPUs of NUMA node {}", Configuration::HOUSEKEEPING_NODE);
+            }
+        }
+        if (!result.empty()) {
+            XPUM_LOG_INFO("XPUM threads run on {} housekeeping CPUs", result.size());
+        }
+        return result;
+    }();
+    return cpus;
+}
+
+void ThreadFactory::restrictToHousekeeping(std::set<int>& cpus) {
+    auto& housekeeping = getHousekeepingCpus();
+    if (housekeeping.empty()) {
+        return;
+    }
+    std::set<int> result;
+    for (int cpu : cpus) {
+        if (housekeeping.find(cpu) != housekeeping.end()) {
+            result.insert(cpu);
+        }
+    }
+    cpus = result.empty() ? housekeeping : result;
+}
+
+void ThreadFactory::setupCurrentThread(const std::string& name) {
+    if (!name.empty()) {
+        prctl(PR_SET_NAME, name.substr(0, 15).c_str(), 0, 0, 0);
+    }
+    auto& cpus = getHousekeepingCpus();
+    if (!cpus.empty()) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for (int cpu : cpus) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &cpuset);
+            }
+        }
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+        if (err != 0) {
+            XPUM_LOG_WARN("Failed to bind the thread to the housekeeping CPUs: {}", strerror(err));
+        }
+    }
+    if (Configuration::HOUSEKEEPING_NODE >= 0) {
+        NumaMemory::preferNode(Configuration::HOUSEKEEPING_NODE);
+    }
+    if (Configuration::THREAD_NICE != 0) {
+        // the nice value of a thread on Linux, the threads it starts inherit it
+        if (setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), Configuration::THREAD_NICE) != 0) {
+            XPUM_LOG_WARN("Failed to set the nice value {} of the thread: {}", Configuration::THREAD_NICE, strerror(errno));
+        }
+    }
+}
+
+std::thread ThreadFactory::create(const std::string& name, std::function<void()> func) {
+    return std::thread([name, func]() {
+        setupCurrentThread(name);
+        func();
+    });
+}
+
+} // end namespace xpum
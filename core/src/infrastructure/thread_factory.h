@@ -0,0 +1,50 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file thread_factory.h
+ */
+
+#pragma once
+
+#include <functional>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace xpum {
+
+/*
+  ThreadFactory starts the threads of XPUM. Each thread is named, so it can
+  be told apart in top and by the CPU budget governor, and gets the
+  housekeeping policy: it only runs on HOUSEKEEPING_CPUS and the CPUs of
+  HOUSEKEEPING_NODE, prefers the memory of HOUSEKEEPING_NODE and runs at
+  THREAD_NICE. The jobs on the isolated cores then never see XPUM threads.
+
+  The policy is also applied to the thread calling xpumInit, so the threads
+  XPUM does not start itself, like those of gRPC and of the Level Zero
+  loader, inherit it.
+*/
+class ThreadFactory {
+   public:
+    // the name is cut to 15 characters
+    static std::thread create(const std::string& name, std::function<void()> func);
+
+    /*
+      Name the calling thread and apply the housekeeping policy to it, for
+      the threads not started by create(), the name is kept if it is empty.
+    */
+    static void setupCurrentThread(const std::string& name);
+
+    /*
+      Restrict a set of CPUs to the housekeeping CPUs, the housekeeping CPUs
+      are used if none of the set is one of them. Nothing is changed if there
+      are no housekeeping CPUs.
+    */
+    static void restrictToHousekeeping(std::set<int>& cpus);
+
+   private:
+    // parsed once from the configuration, empty if the threads may run on every CPU
+    static const std::set<int>& getHousekeepingCpus();
+};
+
+} // end namespace xpum
@@ -14,11 +14,12 @@
 #include "infrastructure/exception/ilegal_parameter_exception.h"
 #include "infrastructure/exception/ilegal_state_exception.h"
 #include "logger.h"
+#include "thread_factory.h"
 #include "utility.h"
 
 namespace xpum {
 
-Timer::Timer() : canceled(true), to_cancel(false) {
+Timer::Timer() : canceled(true), to_cancel(false), rate(0) {
 }
 
 Timer::~Timer() {
@@ -38,11 +39,13 @@ void Timer::scheduleAtFixedRate(long delay, int interval,
     }
 
     this->canceled = false;
+    this->rate = interval;
 
-    std::thread([this, delay, interval, task]() {
+    ThreadFactory::create("xpum-timer", [this, delay, task]() {
         int wait = delay;
         std::this_thread::sleep_for(std::chrono::milliseconds(wait));
         while (!this->to_cancel) {
+            int interval = this->rate;
             long begin = Utility::getCurrentMillisecond();
             task();
             long end = Utility::getCurrentMillisecond();
@@ -63,12 +66,18 @@ void Timer::scheduleAtFixedRate(long delay, int interval,
 }
 
 void Timer::schedule(int delay, std::function<void()> task) {
-    std::thread([delay, task]() {
+    ThreadFactory::create("xpum-timer", [delay, task]() {
         std::this_thread::sleep_for(std::chrono::milliseconds(delay));
         task();
     }).detach();
 }
 
+void Timer::setInterval(int interval) noexcept {
+    if (interval > 0) {
+        this->rate = interval;
+    }
+}
+
 bool Timer::isCanceld() {
     return this->canceled;
 }
@@ -23,6 +23,9 @@ class Timer {
 
     void schedule(int delay, std::function<void()> task);
 
+    // the interval of a timer scheduled at fixed rate, taken after the running wait
+    void setInterval(int interval) noexcept;
+
     void cancel() noexcept;
     bool isCanceld();
 
@@ -34,6 +37,8 @@ class Timer {
 
     std::atomic<bool> to_cancel;
 
+    std::atomic<int> rate;
+
     std::mutex mutex;
 
     std::condition_variable cancel_condition;
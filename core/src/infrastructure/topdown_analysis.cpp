@@ -0,0 +1,175 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file topdown_analysis.cpp
+ */
+
+#include "topdown_analysis.h"
+
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace xpum {
+
+int topdownCounterOf(const std::string& metric_name, bool& exact) {
+    static const std::pair<const char*, int> exact_metrics[] = {
+        {"XveActive", TOPDOWN_XVE_ACTIVE},
+        {"XveStall", TOPDOWN_XVE_STALL},
+        {"EmActive", TOPDOWN_EM_ACTIVE},
+        {"XmxActive", TOPDOWN_XMX_ACTIVE},
+        {"FpuActive", TOPDOWN_FPU_ACTIVE},
+        {"XveFpuEmActive", TOPDOWN_EM_FPU_ACTIVE},
+        {"XveFpuXmxActive", TOPDOWN_XMX_FPU_ACTIVE},
+        {"XveThreadOccupancy", TOPDOWN_THREAD_OCCUPANCY}};
+    static const std::pair<const char*, int> stall_metrics[] = {
+        {"ALUWR", TOPDOWN_STALL_ALU},
+        {"BARRIER", TOPDOWN_STALL_BARRIER},
+        {"SHARED_FUNCTION", TOPDOWN_STALL_SFU},
+        {"SBID", TOPDOWN_STALL_SB},
+        {"SENDWR", TOPDOWN_STALL_SEND},
+        {"OTHER", TOPDOWN_STALL_OTHER},
+        {"INSTFETCH", TOPDOWN_STALL_INST_FETCH}};
+    exact = true;
+    for (auto& metric : exact_metrics) {
+        if (metric_name == metric.first) {
+            return metric.second;
+        }
+    }
+    exact = false;
+    for (auto& metric : stall_metrics) {
+        if (metric_name.find(metric.first) != std::string::npos) {
+            return metric.second;
+        }
+    }
+    return -1;
+}
+
+void addTopdownMetric(TopdownCounters_t& counters, const std::string& metric_name, double value) {
+    bool exact = false;
+    int counter = topdownCounterOf(metric_name, exact);
+    if (counter < 0) {
+        return;
+    }
+    if (exact) {
+        counters.values[counter] = value;
+    } else {
+        counters.values[counter] += value;
+    }
+}
+
+void computeTopdownRatios(const TopdownCounters_t& counters, double engine_usage, xpum_device_components_ratio_t& ratios) {
+    std::float_t active = counters.values[TOPDOWN_XVE_ACTIVE];
+    std::float_t stall = counters.values[TOPDOWN_XVE_STALL];
+    std::float_t emActive = counters.values[TOPDOWN_EM_ACTIVE];
+    std::float_t xmxActive = counters.values[TOPDOWN_XMX_ACTIVE];
+    std::float_t fpuActive = counters.values[TOPDOWN_FPU_ACTIVE];
+    std::float_t emFpuActive = counters.values[TOPDOWN_EM_FPU_ACTIVE];
+    std::float_t xmxFpuActive = counters.values[TOPDOWN_XMX_FPU_ACTIVE];
+    std::float_t occupancy = counters.values[TOPDOWN_THREAD_OCCUPANCY];
+    std::float_t stallALU = counters.values[TOPDOWN_STALL_ALU];
+    std::float_t stallBarrier = counters.values[TOPDOWN_STALL_BARRIER];
+    std::float_t stallSFU = counters.values[TOPDOWN_STALL_SFU];
+    std::float_t stallSB = counters.values[TOPDOWN_STALL_SB];
+    std::float_t stallOther = counters.values[TOPDOWN_STALL_OTHER];
+    std::float_t stallInstFetch = counters.values[TOPDOWN_STALL_INST_FETCH];
+    std::float_t engineUsage = engine_usage;
+
+    std::float_t stallDep = 0;
+    std::float_t xmxOnly = 0;
+    std::float_t fpuWithoutXMX = 0;
+    std::float_t fpuOnly = 0;
+    std::float_t emIntOnly = 0;
+    std::float_t aluActive = 0;
+    std::float_t other = 0;
+    std::float_t stallTotal = 0;
+    std::float_t nonOccupancy = 0;
+    std::float_t remaining = 0;
+    std::float_t stallRatio = 0;
+
+    std::float_t inUse = active + stall;
+    std::float_t notInUse = 100 - inUse;
+    std::float_t hypoInUse = inUse * 100 / engineUsage;
+    if (hypoInUse > 100) {
+        hypoInUse = 100;
+    }
+
+    std::float_t engine = hypoInUse - inUse;
+    if (engine < 0 || std::isnan(engine)) {
+        engine = 0;
+    }
+    std::float_t workload = notInUse - engine;
+    if (workload < 0) {
+        workload = 0;
+    }
+
+    if (inUse != 0) {
+        if (inUse > 0) {
+            stallRatio = stall / inUse;
+        }
+        if (occupancy > 0) {
+            nonOccupancy = (stallRatio - std::pow(stallRatio, inUse / occupancy)) * inUse;
+        }
+        if (nonOccupancy < 0) {
+            nonOccupancy = 0;
+        }
+        remaining = stall - nonOccupancy;
+        if (remaining < 0) {
+            remaining = 0;
+        }
+
+        stallDep = stallSB;
+        if (stallDep < stallSFU) {
+            stallDep = stallSFU;
+        }
+        stallTotal = stallALU + stallBarrier + stallDep + stallOther + stallInstFetch;
+
+        remaining /= stallTotal;
+        stallALU *= remaining;
+        stallBarrier *= remaining;
+        stallDep *= remaining;
+        stallOther *= remaining;
+        stallInstFetch *= remaining;
+
+        aluActive = emActive + fpuActive - emFpuActive + xmxActive - xmxFpuActive;
+        xmxOnly = xmxActive - xmxFpuActive;
+        fpuWithoutXMX = fpuActive - xmxFpuActive;
+        fpuOnly = fpuActive - xmxFpuActive - emFpuActive;
+        emIntOnly = emActive - emFpuActive;
+        other = active - aluActive;
+    }
+
+    std::vector<std::pair<std::string, std::double_t>> components_ratios;
+    components_ratios.push_back(std::pair<std::string, std::double_t>("notInUse", notInUse));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("workload", workload));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("engine", engine));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("inUse", inUse));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("active", active));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("aluActive", aluActive));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("xmxActive", xmxActive));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("xmxOnly", xmxOnly));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("xmxFpuActive", xmxFpuActive));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("fpuWithoutXMX", fpuWithoutXMX));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("fpuOnly", fpuOnly));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("emFpuActive", emFpuActive));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("emIntOnly", emIntOnly));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("other", other));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("stall", stall));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("nonOccupancy", nonOccupancy));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("stallALU", stallALU));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("stallBarrier", stallBarrier));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("stallDep", stallDep));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("stallOther", stallOther));
+    components_ratios.push_back(std::pair<std::string, std::double_t>("stallInstFetch", stallInstFetch));
+
+    ratios.componentNum = components_ratios.size();
+    int idx = 0;
+    for (auto it = components_ratios.begin(); it != components_ratios.end(); it++) {
+        std::strcpy(ratios.ratios[idx].occupancyName, (*it).first.c_str());
+        ratios.ratios[idx].value = (*it).second;
+        idx++;
+    }
+}
+
+} // end namespace xpum
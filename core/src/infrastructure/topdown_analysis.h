@@ -0,0 +1,63 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file topdown_analysis.h
+ */
+
+#pragma once
+
+#include <string>
+
+#include "xpum_structs.h"
+
+namespace xpum {
+
+/*
+  The perf metrics the top-down analysis of a tile is derived from. The
+  exact metrics are the averages of one metric, the stall metrics are the
+  sums of all metrics whose name contains the stall reason.
+*/
+enum TopdownCounter {
+    TOPDOWN_XVE_ACTIVE,
+    TOPDOWN_XVE_STALL,
+    TOPDOWN_EM_ACTIVE,
+    TOPDOWN_XMX_ACTIVE,
+    TOPDOWN_FPU_ACTIVE,
+    TOPDOWN_EM_FPU_ACTIVE,
+    TOPDOWN_XMX_FPU_ACTIVE,
+    TOPDOWN_THREAD_OCCUPANCY,
+    TOPDOWN_STALL_ALU,
+    TOPDOWN_STALL_BARRIER,
+    TOPDOWN_STALL_SFU,
+    TOPDOWN_STALL_SB,
+    TOPDOWN_STALL_SEND,
+    TOPDOWN_STALL_OTHER,
+    TOPDOWN_STALL_INST_FETCH,
+    TOPDOWN_COUNTER_NUM
+};
+
+struct TopdownCounters_t {
+    double values[TOPDOWN_COUNTER_NUM] = {};
+
+    // add the counters of other multiplied by factor
+    void add(const TopdownCounters_t& other, double factor = 1) {
+        for (int i = 0; i < TOPDOWN_COUNTER_NUM; i++) {
+            values[i] += other.values[i] * factor;
+        }
+    }
+};
+
+// The counter a perf metric is reduced into, -1 if it is not used by the analysis.
+// exact is set to true if the counter is the value of this metric only.
+int topdownCounterOf(const std::string& metric_name, bool& exact);
+
+// Reduce one perf metric average into counters
+void addTopdownMetric(TopdownCounters_t& counters, const std::string& metric_name, double value);
+
+/*
+  Derive the top-down hierarchy of a tile from its counters. engine_usage is
+  the ratio of the busy time of the compute and render engines, between 0 and 1.
+*/
+void computeTopdownRatios(const TopdownCounters_t& counters, double engine_usage, xpum_device_components_ratio_t& ratios);
+
+} // end namespace xpum
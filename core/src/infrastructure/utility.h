@@ -39,6 +39,8 @@ class Utility {
 
     static DeviceCapability capabilityFromMeasurementType(const MeasurementType& measurementType);
 
+    static const char* getCapabilityName(DeviceCapability capability);
+
     static xpum_stats_type_t xpumStatsTypeFromMeasurementType(MeasurementType& MeasurementType);
 
     static MeasurementType measurementTypeFromXpumStatsType(xpum_stats_type_t& xpum_stats_type);
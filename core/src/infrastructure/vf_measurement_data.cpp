@@ -0,0 +1,29 @@
+/* 
+ *  Copyright (C) 2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file vf_measurement_data.cpp
+ */
+
+#include "vf_measurement_data.h"
+
+namespace xpum {
+
+void VfMeasurementData::addRawData(uint32_t vf_index,
+                                   zes_engine_group_t type,
+                                   uint64_t raw_active_time,
+                                   uint64_t raw_timestamp) {
+    raw_datas[vf_index][type] = {raw_active_time, raw_timestamp};
+}
+
+void VfMeasurementData::setUtilization(uint32_t vf_index, zes_engine_group_t type, uint64_t value) {
+    utilizations[vf_index][type] = value;
+}
+
+std::string VfMeasurementData::getVfBdf(uint32_t vf_index) const {
+    if (vf_index == 0 || vf_index > vf_bdfs.size()) {
+        return "";
+    }
+    return vf_bdfs[vf_index - 1];
+}
+
+} //namespace xpum
@@ -0,0 +1,58 @@
+/* 
+ *  Copyright (C) 2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file vf_measurement_data.h
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "measurement_data.h"
+
+namespace xpum {
+
+struct VfEngineRawData_t {
+    uint64_t raw_active_time;
+    uint64_t raw_timestamp;
+};
+
+/*
+  VfMeasurementData holds the engine group activities of all VFs of a PF,
+  read in one pass of zesEngineGetActivityExt, and the utilizations computed
+  by the data handler against the previous pass. VF indexes start from 1.
+*/
+class VfMeasurementData : public MeasurementData {
+   public:
+    void addRawData(uint32_t vf_index, zes_engine_group_t type, uint64_t raw_active_time, uint64_t raw_timestamp);
+
+    const std::map<uint32_t, std::map<zes_engine_group_t, VfEngineRawData_t>>& getVfRawDatas() const {
+        return raw_datas;
+    }
+
+    void setUtilization(uint32_t vf_index, zes_engine_group_t type, uint64_t value);
+
+    // vf index, engine group and the utilization in DEFAULT_MEASUREMENT_DATA_SCALE
+    const std::map<uint32_t, std::map<zes_engine_group_t, uint64_t>>& getUtilizations() const {
+        return utilizations;
+    }
+
+    void setVfBdfs(const std::vector<std::string>& bdfs) {
+        vf_bdfs = bdfs;
+    }
+
+    // the BDF address of the VF, empty if it is unknown
+    std::string getVfBdf(uint32_t vf_index) const;
+
+   private:
+    std::map<uint32_t, std::map<zes_engine_group_t, VfEngineRawData_t>> raw_datas;
+
+    std::map<uint32_t, std::map<zes_engine_group_t, uint64_t>> utilizations;
+
+    // the BDF of VF i is at index i - 1
+    std::vector<std::string> vf_bdfs;
+};
+
+} //namespace xpum
@@ -0,0 +1,129 @@
+/* 
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file worker_pool.cpp
+ */
+
+#include "worker_pool.h"
+
+#include <atomic>
+#include <memory>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/logger.h"
+#include "infrastructure/thread_factory.h"
+
+namespace xpum {
+
+namespace {
+
+// shared by the caller and the workers helping it with one run()
+struct BatchGroup {
+    std::function<void(unsigned batch)> functor;
+    unsigned batch_count;
+    std::atomic<unsigned> next_batch;
+    unsigned done_count;
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    // run batches until none is left, returns after the last batch taken by this thread is done
+    void work() {
+        unsigned finished = 0;
+        unsigned batch;
+        while ((batch = next_batch.fetch_add(1)) < batch_count) {
+            try {
+                functor(batch);
+            } catch (std::exception& e) {
+                XPUM_LOG_ERROR("Failed to execute worker pool batch: {}", e.what());
+            } catch (...) {
+                XPUM_LOG_ERROR("Failed to execute worker pool batch: unexpected exception");
+            }
+            finished++;
+        }
+        if (finished > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done_count += finished;
+            if (done_count == batch_count) {
+                cv.notify_all();
+            }
+        }
+    }
+};
+
+} // namespace
+
+WorkerPool& WorkerPool::instance() {
+    static WorkerPool pool;
+    return pool;
+}
+
+WorkerPool::WorkerPool() : stop(false) {
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::start() {
+    int size = Configuration::DEVICE_THREAD_POOL_SIZE > 0 ? Configuration::DEVICE_THREAD_POOL_SIZE : 1;
+    for (int i = 0; i < size; i++) {
+        workers.emplace_back(ThreadFactory::create("xpum-worker", [this]() {
+            while (true) {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [this]() { return stop || !jobs.empty(); });
+                    if (stop) {
+                        break;
+                    }
+                    job = std::move(jobs.front());
+                    jobs.pop_front();
+                }
+                job();
+            }
+        }));
+    }
+    XPUM_LOG_TRACE("worker pool started with {} threads", size);
+}
+
+void WorkerPool::run(unsigned batch_count, const std::function<void(unsigned batch)>& functor) {
+    if (batch_count == 0) {
+        return;
+    }
+    if (batch_count == 1) {
+        functor(0);
+        return;
+    }
+
+    auto p_group = std::make_shared<BatchGroup>();
+    p_group->functor = functor;
+    p_group->batch_count = batch_count;
+    p_group->next_batch = 0;
+    p_group->done_count = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (workers.empty()) {
+            start();
+        }
+        // the caller takes one batch itself
+        for (unsigned i = 1; i < batch_count; i++) {
+            jobs.emplace_back([p_group]() { p_group->work(); });
+        }
+    }
+    cv.notify_all();
+
+    p_group->work();
+
+    std::unique_lock<std::mutex> lock(p_group->mutex);
+    p_group->cv.wait(lock, [&p_group]() { return p_group->done_count == p_group->batch_count; });
+}
+
+} // end namespace xpum
@@ -0,0 +1,53 @@
+/* 
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file worker_pool.h
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace xpum {
+
+/*
+  WorkerPool is a process wide pool of persistent threads for short, blocking
+  per-device work like sysfs reads and Level Zero queries. The threads are
+  created on first use and live until the process exits.
+*/
+class WorkerPool {
+   public:
+    static WorkerPool& instance();
+
+    /*
+      Run functor on batch_count batches and block until all of them are done.
+      The calling thread runs batches too, so a full pool, or a call made from
+      a worker thread, can never block the caller forever.
+    */
+    void run(unsigned batch_count, const std::function<void(unsigned batch)>& functor);
+
+   private:
+    WorkerPool();
+
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void start();
+
+   private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stop;
+};
+
+} // end namespace xpum
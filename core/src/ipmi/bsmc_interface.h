@@ -140,5 +140,7 @@ typedef struct {
     int (*cmd)(bsmc_req *req, bsmc_res *res);
     int (*validate_res)(bsmc_res res, uint16_t res_size);
     void (*oem_req_init)(bsmc_req *req, void *addr, uint8_t cmd);
+    // send several requests with their own netfn and cmd, errs gets the result of each
+    int (*cmd_batch)(bsmc_req *reqs, bsmc_res *res, int *errs, int count);
 } bsmc_hal_t;
 } // namespace xpum
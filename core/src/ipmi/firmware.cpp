@@ -14,9 +14,9 @@
 #elif (_MSC_VER < 1910)
 #pragma warning(disable : 4244)
 #pragma warning(disable : 4702)
-UINT32 gMaxDataLen;
-UINT8 gFwReqData[270];
-UINT32 gFwReqSize;
+thread_local UINT32 gMaxDataLen;
+thread_local UINT8 gFwReqData[270];
+thread_local UINT32 gFwReqSize;
 #define SIZE_DETECT_RES 3
 #define SIZE_FW_GET_INFO_RES 18
 #define SIZE_FW_UPDATE_SYNC_RES 10
@@ -44,6 +44,8 @@ UINT32 gFwReqSize;
 #include "tool.h"
 #include "amc/ipmi_amc_manager.h"
 
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <string>
 #include <sstream>
@@ -55,14 +57,43 @@ static void* amcManager;
 
 static percent_callback_func_t percentCallback;
 
-static int fw_update_device_count;
-static int fw_update_device_index;
+static card_percent_callback_func_t cardPercentCallback;
+
+// the cards are updated in parallel, each by its own thread
+static thread_local int fw_update_device_index;
+
+static std::mutex fw_update_percent_mutex;
+
+static std::vector<uint32_t> fw_update_percents;
 
 void setPercentCallbackAndContext(percent_callback_func_t callback, void *pAmcManager) {
     percentCallback = callback;
     amcManager = pAmcManager;
 }
 
+void setCardPercentCallback(card_percent_callback_func_t callback) {
+    cardPercentCallback = callback;
+}
+
+/*
+ * report_progress stores the percent of a card and reports it with the
+ * mean of all cards, one report at a time.
+ */
+static void report_progress(int card, uint32_t percent) {
+    std::lock_guard<std::mutex> lock(fw_update_percent_mutex);
+    if (card < 0 || card >= (int)fw_update_percents.size())
+        return;
+    fw_update_percents[card] = percent;
+    if (cardPercentCallback)
+        cardPercentCallback(card, percent, amcManager);
+    if (percentCallback) {
+        uint32_t total = 0;
+        for (auto p : fw_update_percents)
+            total += p;
+        percentCallback(total / fw_update_percents.size(), amcManager);
+    }
+}
+
 #define LINE_LENGTH 4096
 
 #define MODULE_LIST_PATH "/proc/modules"
@@ -75,12 +106,12 @@ void setPercentCallbackAndContext(percent_callback_func_t callback, void *pAmcMa
 
 #define CHECK_FW_VERSION 0 // 0 - will not check the firmware version whereas 1 will check firmware version //
 
-extern unsigned char gNetfn;
-extern unsigned char gCmd;
-extern uint8_t gData[267];
-extern uint8_t gUpdateType;
-extern unsigned short gSize;
-extern uint8_t gReqData[300];
+extern thread_local unsigned char gNetfn;
+extern thread_local unsigned char gCmd;
+extern thread_local uint8_t gData[267];
+extern thread_local uint8_t gUpdateType;
+extern thread_local unsigned short gSize;
+extern thread_local uint8_t gReqData[300];
 
 struct firmware_versions {
     fw_get_info_res bsmc;
@@ -352,10 +383,7 @@ static int fw_update_transfer(ipmi_address_t *addr, unsigned short max_data_len,
             offset += req.data_len;
         }
 
-        if (percentCallback) {
-            int percent = (fw_update_device_index * 100 + (offset * 100) / data_size) / fw_update_device_count;
-            percentCallback(percent, amcManager);
-        }
+        report_progress(fw_update_device_index, (offset * 100) / data_size);
 
         //log_progress_next();
     }
@@ -581,14 +609,36 @@ static bool fw_match(struct firmware_versions *cur, struct firmware_versions *pr
     return true;
 }
 
+/*
+ * for_each_card runs func for every card in its own thread and waits for
+ * all of them.
+ */
+template <typename Func>
+static void for_each_card(int count, Func func) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < count; i++) {
+        threads.emplace_back([i, &func]() {
+            fw_update_device_index = i;
+            func(i);
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+}
+
 static int cmd_firmware_update(const char* file, nrv_list cards, uint8_t *bsmc_data, size_t bsmc_size) {
     int err = NRV_SUCCESS;
     struct firmware_versions prev_ver[MAX_CARD_NO] = {{{0}}};
     pci_address_t pci_address[MAX_CARD_NO];
     int pci_address_count = 0;
     bool reset_failed = false;
-    fw_update_device_index = 0;
-    fw_update_device_count = cards.count;
+    // one card failing does not stop the update of the others
+    int card_err[MAX_CARD_NO] = {0};
+    bool card_reboot_needed[MAX_CARD_NO] = {false};
+    {
+        std::lock_guard<std::mutex> lock(fw_update_percent_mutex);
+        fw_update_percents.assign(cards.count, 0);
+    }
     if (percentCallback) {
         percentCallback(0, amcManager);
     }
@@ -611,34 +661,29 @@ static int cmd_firmware_update(const char* file, nrv_list cards, uint8_t *bsmc_d
     firmware_versions cur_fw_version{};
     bool parse_success = parse_cur_fw_version(file, &cur_fw_version);
 
-    /* BSMC firmware update */
-    //TODO for all cards:
-    for (int i = 0; i < cards.count; i++) {
-        //if ( cards.count > 0 ) { //only one card now
+    /* BSMC firmware update, the image is shared by all cards */
+    for_each_card(cards.count, [&](int i) {
         nrv_card *card = &cards.card[i];
 
-        fw_update_device_index = i;
-
-        err = get_fw_version(&card->ipmi_address, &prev_ver[i]);
-        if (err)
-            goto exit;
+        card_err[i] = get_fw_version(&card->ipmi_address, &prev_ver[i]);
+        if (card_err[i]) {
+            XPUM_LOG_ERROR("card {} get_fw_version fail, err {}", i, card_err[i]);
+            return;
+        }
 
-        if(parse_success && fw_match(&cur_fw_version, &prev_ver[i])){
-            if (percentCallback) {
-                int percent = (fw_update_device_index + 1) * 100  / fw_update_device_count;
-                percentCallback(percent, amcManager);
-            }
-            continue;
+        if (parse_success && fw_match(&cur_fw_version, &prev_ver[i])) {
+            report_progress(i, 100);
+            return;
         }
         card->max_transfer_len = IPMI_TRANSFER_SIZE_BIG;
 
         if (bsmc_data) {
-            err = fw_update(card, bsmc_data, bsmc_size, &prev_ver[i].bsmc,
-                            FW_UPDATE_TYPE_BSMC);
-            if (err)
-                goto exit;
+            card_err[i] = fw_update(card, bsmc_data, bsmc_size, &prev_ver[i].bsmc,
+                                    FW_UPDATE_TYPE_BSMC);
+            if (card_err[i])
+                XPUM_LOG_ERROR("card {} fw_update fail, err {}", i, card_err[i]);
         }
-    }
+    });
 
 #if 0
 	/* CSMC firmware update */
@@ -676,47 +721,51 @@ static int cmd_firmware_update(const char* file, nrv_list cards, uint8_t *bsmc_d
     }
 
     /* Firmware update completion check */
-    //TODO for all cards:
-    for (int i = 0; i < cards.count; i++) {
-        /*
-    if ( cards.count > 0 ) {
-        int i = 0;
-        */
-
-        if(parse_success && fw_match(&cur_fw_version, &prev_ver[i])){
-            continue;
+    for_each_card(cards.count, [&](int i) {
+        if (card_err[i])
+            return;
+        if (parse_success && fw_match(&cur_fw_version, &prev_ver[i])) {
+            return;
         }
         struct firmware_versions curr_ver = {{0}};
 
         XPUM_LOG_INFO("card {} i2c_addr is: 0x{:x}", i, cards.card[i].ipmi_address.i2c_addr);
 
         if (bsmc_data) {
-            err = wait_for_bsmc(&cards.card[i].ipmi_address, prev_ver[i].bsmc);
-            if (err) {
+            int wait_err = wait_for_bsmc(&cards.card[i].ipmi_address, prev_ver[i].bsmc);
+            if (wait_err) {
                 XPUM_LOG_INFO("card {} wait_for_bsmc retry with i2c_addr 0x{:x}", i, CARD_FIRST_I2C_ADDR);
                 cards.card[i].ipmi_address.i2c_addr = CARD_FIRST_I2C_ADDR;
-                err = wait_for_bsmc(&cards.card[i].ipmi_address, prev_ver[i].bsmc);
+                wait_err = wait_for_bsmc(&cards.card[i].ipmi_address, prev_ver[i].bsmc);
             }
-            if (err == NRV_REBOOT_NEEDED) {
+            if (wait_err == NRV_REBOOT_NEEDED) {
                 XPUM_LOG_INFO("card {} wait_for_bsmc return error NRV_REBOOT_NEEDED", i);
-                reset_failed = true;
-            } else if (err) {
+                card_reboot_needed[i] = true;
+            } else if (wait_err) {
                 XPUM_LOG_ERROR("card {} wait_for_bsmc fail with i2c_addr 0x{:x}", i, cards.card[i].ipmi_address.i2c_addr);
-                goto exit;
+                card_err[i] = wait_err;
+                return;
             }
         }
 
-        err = get_fw_version(&cards.card[i].ipmi_address, &curr_ver);
-        if (err){
-            XPUM_LOG_ERROR("card {} get_fw_version fail with i2c_addr 0x{:x}, err {}", i, cards.card[i].ipmi_address.i2c_addr, err);
-            goto exit;
+        card_err[i] = get_fw_version(&cards.card[i].ipmi_address, &curr_ver);
+        if (card_err[i]) {
+            XPUM_LOG_ERROR("card {} get_fw_version fail with i2c_addr 0x{:x}, err {}", i, cards.card[i].ipmi_address.i2c_addr, card_err[i]);
+            return;
         }
 
-        if (bsmc_data && !reset_failed)
+        if (bsmc_data && !card_reboot_needed[i])
             XPUM_LOG_INFO("BSMC updated on card {} to version {}.{}.{}.{}",
                           std::to_string(cards.card[i].id), std::to_string(curr_ver.bsmc.major),
                           std::to_string(curr_ver.bsmc.minor), std::to_string(curr_ver.bsmc.patch),
                           std::to_string(curr_ver.bsmc.build));
+    });
+
+    for (int i = 0; i < cards.count; i++) {
+        if (card_err[i] && !err)
+            err = card_err[i];
+        if (card_reboot_needed[i])
+            reset_failed = true;
     }
 exit:
     // clean discovered cards, since fw update may change I2C addr
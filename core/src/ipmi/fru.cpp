@@ -10,16 +10,17 @@
 #include "fru.h"
 #include <bitset>
 #include <iostream>
+#include <vector>
 #include "ipmi.h"
 
 namespace xpum {
 
-extern unsigned char gNetfn;
-extern unsigned char gCmd;
-extern uint8_t gDeviceId;
-extern uint8_t gOffsetLsb;
-extern uint8_t gOffsetMsb;
-extern uint8_t gReadCount;
+extern thread_local unsigned char gNetfn;
+extern thread_local unsigned char gCmd;
+extern thread_local uint8_t gDeviceId;
+extern thread_local uint8_t gOffsetLsb;
+extern thread_local uint8_t gOffsetMsb;
+extern thread_local uint8_t gReadCount;
 
 int get_fru_data_size(ipmi_address_t *ipmi_address) {
     bsmc_req req;
@@ -43,7 +44,6 @@ int get_fru_data_size(ipmi_address_t *ipmi_address) {
 
 int get_fru_data(ipmi_address_t *ipmi_address, uint16_t fru_size, uint8_t *out_data) {
 	bsmc_req req;
-	bsmc_res res;
 
 	req.ipmi_address = *ipmi_address;
 	req.netfn = IPMI_STORAGE_NETFN;
@@ -56,30 +56,36 @@ int get_fru_data(ipmi_address_t *ipmi_address, uint16_t fru_size, uint8_t *out_d
 	gNetfn = IPMI_STORAGE_NETFN;
 	gCmd = IPMI_FRU_READ_DATA;
 
-	/* Read FRU data from 0 offset */
-	for (uint16_t offset = 0; offset < fru_size; offset += res.fru_read.bytes_read) {
+	/* Read FRU data from 0 offset, the chunks are sent together */
+	std::vector<bsmc_req> reqs;
+	for (uint16_t offset = 0; offset < fru_size; offset += req.fru_read.read_count) {
 		req.fru_read.offset_lsb = 0xff & offset;
 		req.fru_read.offset_msb = offset >> 8;
 		/* Prevent size exceeded */
 		if (offset + req.fru_read.read_count > fru_size)
 			req.fru_read.read_count = fru_size - offset;
+		reqs.push_back(req);
+	}
+	if (reqs.empty())
+		return NRV_SUCCESS;
 
-        gDeviceId = 0;
-		gOffsetLsb = req.fru_read.offset_lsb;
-		gOffsetMsb = req.fru_read.offset_msb;
-		gReadCount = req.fru_read.read_count;
+	std::vector<bsmc_res> res(reqs.size());
+	std::vector<int> errs(reqs.size());
+	bsmc_hal->cmd_batch(reqs.data(), res.data(), errs.data(), reqs.size());
 
-		if (bsmc_hal->cmd(&req, &res))
+	for (std::size_t i = 0; i < reqs.size(); i++) {
+		if (errs[i])
 			return NRV_IPMI_ERROR;
 
-		if (bsmc_hal->validate_res(res, sizeof(fru_read_data_resp_t)))
+		if (bsmc_hal->validate_res(res[i], sizeof(fru_read_data_resp_t)))
 		        return NRV_IPMI_ERROR;
 
-		if (res.fru_read.bytes_read != req.fru_read.read_count) {
+		if (res[i].fru_read.bytes_read != reqs[i].fru_read.read_count) {
 			return NRV_IPMI_ERROR;
 		}
 
-		memcpy((out_data + offset), res.fru_read.read_data, res.fru_read.bytes_read);
+		uint16_t offset = (reqs[i].fru_read.offset_msb << 8) + reqs[i].fru_read.offset_lsb;
+		memcpy((out_data + offset), res[i].fru_read.read_data, res[i].fru_read.bytes_read);
 	}
 	return NRV_SUCCESS;
 }
@@ -37,8 +37,8 @@ static bsmc_interface_t iface;
 //extern nnp_hal scr_hal;
 extern bsmc_hal_t *bsmc_hal;
 
-extern unsigned char gNetfn;
-extern unsigned char gCmd;
+extern thread_local unsigned char gNetfn;
+extern thread_local unsigned char gCmd;
 
 /*
 nnp_hal *ops_table[NUM_BOARD_PRODUCTS] = {
@@ -38,12 +38,17 @@ namespace xpum {
 
 typedef void (*percent_callback_func_t)(uint32_t percent, void *pAmcManager);
 
+typedef void (*card_percent_callback_func_t)(int card, uint32_t percent, void *pAmcManager);
+
 int cmd_firmware(const char *file, unsigned int versions[4]);
 
 int cmd_get_amc_firmware_versions(int buf[][4], int *count);
 
 void setPercentCallbackAndContext(percent_callback_func_t callback, void *pAmcManager);
 
+// the percent of each card while they are updated in parallel, called before the percent callback
+void setCardPercentCallback(card_percent_callback_func_t callback);
+
 std::vector<xpum_sensor_reading_t> read_sensor();
 
 int get_sn_number(uint8_t baseboardSlot, uint8_t riserSlot, std::string &sn_number);
@@ -5,6 +5,7 @@
  */
 
 #ifdef __linux__
+#include <poll.h>
 #include <sys/fcntl.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
@@ -28,6 +29,14 @@
 #include <string.h>
 #include <time.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+
 #include "tool.h"
 #include "ipmi.h"
 
@@ -38,25 +47,29 @@ namespace xpum {
 #define RETRY_SLEEP_TIME_US 100
 #define SLOT_IPMB_NETFN 0x3e
 #define SLOT_IPMB_CMD 0x51
+#define MAX_IN_FLIGHT 8
+#define RECV_SLICE_MS 100
 
 static int g_ipmi_dev = -1;
 
-unsigned char gNetfn;
-unsigned char gCmd;
-uint8_t gSensorIndex;
-uint8_t gUpdateType;
-uint8_t gData[267];
-unsigned short gSize;
-uint8_t gReqData[300];
-uint8_t gDeviceId;
-uint8_t gOffsetLsb;
-uint8_t gOffsetMsb;
-uint8_t gReadCount;
-uint8_t gRequestType;
-uint16_t gEntryType;
+// the fields of the current request of each thread, the cards are updated by one thread each
+thread_local unsigned char gNetfn;
+thread_local unsigned char gCmd;
+thread_local uint8_t gSensorIndex;
+thread_local uint8_t gUpdateType;
+thread_local uint8_t gData[267];
+thread_local unsigned short gSize;
+thread_local uint8_t gReqData[300];
+thread_local uint8_t gDeviceId;
+thread_local uint8_t gOffsetLsb;
+thread_local uint8_t gOffsetMsb;
+thread_local uint8_t gReadCount;
+thread_local uint8_t gRequestType;
+thread_local uint16_t gEntryType;
 
 static int ipmi_init();
 static int ipmi_cmd(bsmc_req *req, bsmc_res *res);
+static int ipmi_cmd_batch(bsmc_req *reqs, bsmc_res *res, int *errs, int count);
 static int ipmi_validate_res(bsmc_res res, uint16_t res_size);
 static void ipmi_oem_req_init(bsmc_req *req, void *addr, uint8_t cmd);
 
@@ -65,6 +78,7 @@ bsmc_hal_t ipmi_hal = {
     .cmd = ipmi_cmd,
     .validate_res = ipmi_validate_res,
     .oem_req_init = ipmi_oem_req_init,
+    .cmd_batch = ipmi_cmd_batch,
 };
 
 static void ipmi_cleanup() {
@@ -137,7 +151,29 @@ static bool timeout_expired(struct timespec *to) {
         return false;
 }
 
-static int slot_ipmb_send_devid() {
+/*
+ * Every request gets its own msgid, which the driver returns with the
+ * response, so a late response of a request that timed out is not taken
+ * as the response of the next request.
+ */
+static std::atomic<long> g_next_msgid{1};
+
+struct ipmi_response {
+    std::vector<unsigned char> data;
+    std::chrono::steady_clock::time_point received;
+};
+
+/*
+ * One thread at a time reads the responses from the device, and keeps the
+ * responses it does not wait for in g_responses for the other threads.
+ */
+static std::mutex g_recv_mutex;
+static std::condition_variable g_recv_cv;
+static bool g_receiving = false;
+static std::map<long, ipmi_response> g_responses;
+
+static int ipmi_send(unsigned char netfn, unsigned char cmd,
+                     unsigned char *data, unsigned short data_len, long msgid) {
     struct ipmi_req req;
     struct ipmi_system_interface_addr req_addr;
     int err;
@@ -148,11 +184,11 @@ static int slot_ipmb_send_devid() {
 
     req.addr = (unsigned char *)&req_addr;
     req.addr_len = sizeof(req_addr);
-    req.msg.netfn = IPMI_GET_DEVID_OEM_NETFN;
-    req.msg.cmd = IPMI_FW_GET_INFO_CMD;
-    req.msg.data_len = 0;
-
-    XPUM_LOG_DEBUG("SlotIPMB Request (len: {}):", req.msg.data_len);
+    req.msgid = msgid;
+    req.msg.netfn = netfn;
+    req.msg.cmd = cmd;
+    req.msg.data = data;
+    req.msg.data_len = data_len;
 
     err = ioctl(g_ipmi_dev, IPMICTL_SEND_COMMAND, &req);
     if (err) {
@@ -166,14 +202,13 @@ static int slot_ipmb_send_devid() {
     return 0;
 }
 
-static int slot_ipmb_send(unsigned char *request_buf, unsigned short request_len) {
-    struct ipmi_req req;
-    struct ipmi_system_interface_addr req_addr;
-    int err;
+static int slot_ipmb_send_devid(long msgid) {
+    XPUM_LOG_DEBUG("SlotIPMB Request (len: {}):", 0);
 
-    req_addr.addr_type = IPMI_SYSTEM_INTERFACE_ADDR_TYPE;
-    req_addr.channel = IPMI_BMC_CHANNEL;
-    req_addr.lun = 0;
+    return ipmi_send(IPMI_GET_DEVID_OEM_NETFN, IPMI_FW_GET_INFO_CMD, NULL, 0, msgid);
+}
+
+static int slot_ipmb_send(unsigned char *request_buf, unsigned short request_len, long msgid) {
     request_buf[3] = gNetfn;
     request_buf[4] = gCmd;
     if (gNetfn == IPMI_INTEL_OEM_NETFN && gCmd == IPMI_READ_SENSOR_CMD)
@@ -203,60 +238,183 @@ static int slot_ipmb_send(unsigned char *request_buf, unsigned short request_len
             request_buf[7] = 0x00;
         }
     }
-    req.addr = (unsigned char *)&req_addr;
-    req.addr_len = sizeof(req_addr);
-    req.msg.netfn = SLOT_IPMB_NETFN;
-    req.msg.cmd = SLOT_IPMB_CMD;
-    req.msg.data = request_buf;
-    req.msg.data_len = request_len;
 
-    err = ioctl(g_ipmi_dev, IPMICTL_SEND_COMMAND, &req);
-    if (err) {
-        XPUM_LOG_WARN(
-            "Ioctl IPMICTL_SEND_COMMAND return error:{}, "
-            "errno: {}({})\n",
-            err, errno, strerror(errno));
-        return NRV_IPMI_ERROR;
-    }
-
-    return 0;
+    return ipmi_send(SLOT_IPMB_NETFN, SLOT_IPMB_CMD, request_buf, request_len, msgid);
 }
 
-static int slot_ipmb_recv(unsigned char *response_buf, unsigned short *response_len) {
+/*
+ * ipmi_recv waits with poll() for the next response until the deadline
+ * and stores its msgid, timed_out is set if the deadline passed.
+ */
+static int ipmi_recv(unsigned char *response_buf, unsigned short *response_len,
+                     long *msgid, struct timespec *deadline, bool *timed_out) {
     struct ipmi_recv res;
     struct ipmi_addr res_addr;
-    struct timespec timeout;
+    struct pollfd pfd;
+    struct timespec t;
+    long wait_ms;
     int err;
 
     res.addr = (unsigned char *)&res_addr;
     res.addr_len = sizeof(res_addr);
     res.msg.data = response_buf;
-    res.msg.data_len = *response_len;
-    memset(res.msg.data, 0, res.msg.data_len);
 
-    clock_gettime(CLOCK_MONOTONIC, &timeout);
-    timeout.tv_sec += RESPONSE_TIMEOUT_SEC;
-retry:
+    pfd.fd = g_ipmi_dev;
+    pfd.events = POLLIN;
+    *timed_out = false;
+
+    while (true) {
+        res.msg.data_len = *response_len;
+        memset(res.msg.data, 0, res.msg.data_len);
+
+        /*
+         * IPMICTL_RECEIVE_MSG_TRUNC grab message from queue when response
+         * length is too small. It helps to avoid plugging message queue.
+         */
+        err = ioctl(g_ipmi_dev, IPMICTL_RECEIVE_MSG_TRUNC, &res);
+        if (err == 0)
+            break;
+        if (errno != EAGAIN) {
+            XPUM_LOG_WARN(
+                "Ioctl call IPMICTL_RECEIVE_MSG return error: {}, "
+                "errno: {}({})\n",
+                err, errno, strerror(errno));
+            return NRV_IPMI_ERROR;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        wait_ms = (deadline->tv_sec - t.tv_sec) * 1000 + (deadline->tv_nsec - t.tv_nsec) / 1000000;
+        if (wait_ms <= 0) {
+            *timed_out = true;
+            return NRV_IPMI_ERROR;
+        }
+        if (poll(&pfd, 1, (int)wait_ms) < 0 && errno != EINTR) {
+            XPUM_LOG_WARN("Poll on IPMI device return errno: {}({})\n", errno, strerror(errno));
+            return NRV_IPMI_ERROR;
+        }
+    }
+
+    *response_len = res.msg.data_len;
+    *msgid = res.msgid;
+    return 0;
+}
+
+static void response_deadline(struct timespec *deadline) {
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += RESPONSE_TIMEOUT_SEC;
+}
+
+/*
+ * ipmi_recv_for waits until the deadline for the response of a msgid the
+ * caller wants, received by this thread or by another one.
+ */
+template <typename Wanted>
+static int ipmi_recv_for(Wanted wanted, unsigned char *response_buf, unsigned short *response_len,
+                         long *msgid, struct timespec *deadline) {
+    std::vector<unsigned char> buf(*response_len);
+    std::unique_lock<std::mutex> lck(g_recv_mutex);
+
+    while (true) {
+        auto now = std::chrono::steady_clock::now();
+        for (auto it = g_responses.begin(); it != g_responses.end();) {
+            if (wanted(it->first)) {
+                unsigned short len = it->second.data.size() < *response_len ? it->second.data.size() : *response_len;
+                memcpy(response_buf, it->second.data.data(), len);
+                *response_len = len;
+                *msgid = it->first;
+                g_responses.erase(it);
+                return 0;
+            }
+            // nobody waits for it any more
+            if (now - it->second.received > std::chrono::seconds(RESPONSE_TIMEOUT_SEC))
+                it = g_responses.erase(it);
+            else
+                ++it;
+        }
+
+        if (timeout_expired(deadline))
+            return NRV_IPMI_ERROR;
+
+        if (g_receiving) {
+            g_recv_cv.wait_for(lck, std::chrono::milliseconds(RECV_SLICE_MS));
+            continue;
+        }
+
+        // read the device for a while, then look at what the others received
+        struct timespec slice;
+        clock_gettime(CLOCK_MONOTONIC, &slice);
+        slice.tv_nsec += RECV_SLICE_MS * 1000000L;
+        slice.tv_sec += slice.tv_nsec / 1000000000L;
+        slice.tv_nsec %= 1000000000L;
+        if (slice.tv_sec > deadline->tv_sec || (slice.tv_sec == deadline->tv_sec && slice.tv_nsec > deadline->tv_nsec))
+            slice = *deadline;
+
+        unsigned short len = buf.size();
+        long res_msgid;
+        bool timed_out;
+        g_receiving = true;
+        lck.unlock();
+        int err = ipmi_recv(buf.data(), &len, &res_msgid, &slice, &timed_out);
+        lck.lock();
+        g_receiving = false;
+        g_recv_cv.notify_all();
+
+        if (err && !timed_out)
+            return err;
+        if (err)
+            continue;
+        if (wanted(res_msgid)) {
+            memcpy(response_buf, buf.data(), len);
+            *response_len = len;
+            *msgid = res_msgid;
+            return 0;
+        }
+        g_responses[res_msgid] = ipmi_response{std::vector<unsigned char>(buf.begin(), buf.begin() + len),
+                                               std::chrono::steady_clock::now()};
+    }
+}
+
+static int slot_ipmb_recv(unsigned char *response_buf, unsigned short *response_len, long msgid) {
+    struct timespec deadline;
+    long res_msgid;
+
+    response_deadline(&deadline);
+    return ipmi_recv_for([msgid](long id) { return id == msgid; },
+                         response_buf, response_len, &res_msgid, &deadline);
+}
+
+/*
+ * Check the SlotIPMB response of a request and set its data length, retry
+ * is set if the request should be sent again.
+ */
+static int slot_ipmb_check_res(bool devid, bsmc_res *res, unsigned short response_len, bool *retry) {
+    *retry = false;
+    if (response_len < RESPONSE_HEADER_SIZE) {
+        XPUM_LOG_WARN("Invalid IPMI response header size\n");
+        return NRV_IPMI_ERROR;
+    }
+
+    if (devid)
+        return NRV_SUCCESS;
+
+    if (res->slot_ipmb_completion_code == IPMB_CC_INVALID_PCIE_SLOT_NUM)
+        return NRV_IPMI_ERROR;
+
     /*
-     * IPMICTL_RECEIVE_MSG_TRUNC grab message from queue when response
-     * length is too small. It helps to avoid plugging message queue.
+     * SuperMicro BMC firmware returns invalid command code in SlotIPMB
+     * response when there is a heavy trafic of IPMI messages. It is only
+     * occured in firmware update process with very low reproduction ratio.
      */
-    err = ioctl(g_ipmi_dev, IPMICTL_RECEIVE_MSG_TRUNC, &res);
-    if (err && errno == EAGAIN) {
-        if (timeout_expired(&timeout))
-            return NRV_IPMI_ERROR;
-        usleep(1);
-        goto retry;
-    } else if (err) {
-        XPUM_LOG_WARN(
-            "Ioctl call IPMICTL_RECEIVE_MSG return error: {}, "
-            "errno: {}({})\n",
-            err, errno, strerror(errno));
+    if (res->slot_ipmb_completion_code == IPMB_CC_BUS_ERROR ||
+        res->slot_ipmb_completion_code == IPMI_CC_INVALID_COMMAND) {
+        *retry = true;
+        return NRV_IPMI_ERROR;
+    } else if (res->slot_ipmb_completion_code != IPMI_CC_SUCCESS) {
         return NRV_IPMI_ERROR;
     }
 
-    *response_len = res.msg.data_len;
-    return err;
+    res->data_len = response_len - RESPONSE_HEADER_SIZE;
+    return NRV_SUCCESS;
 }
 #endif
 
@@ -354,56 +512,111 @@ static int ipmi_cmd(bsmc_req *req, bsmc_res *res) {
 #elif __linux__
 
     int retries = MAX_RETRIES;
-    bool super_micro_wa_retry;
+    bool devid = gNetfn == IPMI_GET_DEVID_OEM_NETFN;
+    bool retry;
+    int err;
 
-retry:
-    super_micro_wa_retry = false;
+    while (true) {
+        long msgid = g_next_msgid++;
+        if (devid) {
+            if (slot_ipmb_send_devid(msgid))
+                return NRV_IPMI_ERROR;
+        } else {
+            if (slot_ipmb_send((unsigned char *)req, REQUEST_HEADER_SIZE + req->data_len, msgid))
+                return NRV_IPMI_ERROR;
+        }
 
-    if (gNetfn == IPMI_GET_DEVID_OEM_NETFN) {
-        if (slot_ipmb_send_devid())
-            return NRV_IPMI_ERROR;
-    } else {
-        if (slot_ipmb_send((unsigned char *)req, REQUEST_HEADER_SIZE + req->data_len))
+        response_len = sizeof(*res);
+        if (slot_ipmb_recv((unsigned char *)res, &response_len, msgid))
             return NRV_IPMI_ERROR;
-    }
-
-    response_len = sizeof(*res);
-    if (slot_ipmb_recv((unsigned char *)res, &response_len))
-        return NRV_IPMI_ERROR;
 
-    if (response_len < RESPONSE_HEADER_SIZE) {
-        XPUM_LOG_WARN("Invalid IPMI response header size\n");
-        return NRV_IPMI_ERROR;
+        err = slot_ipmb_check_res(devid, res, response_len, &retry);
+        if (!retry || !retries)
+            return err;
+        retries--;
+        usleep(RETRY_SLEEP_TIME_US);
     }
+#endif
+    return NRV_SUCCESS;
+}
 
-    if (gNetfn != IPMI_GET_DEVID_OEM_NETFN) {
-        if (res->slot_ipmb_completion_code == IPMB_CC_INVALID_PCIE_SLOT_NUM)
-            return NRV_IPMI_ERROR;
+/*
+ * ipmi_cmd_batch sends the SlotIPMB requests reqs, which carry their own
+ * netfn, cmd and data instead of the g* globals, with up to MAX_IN_FLIGHT
+ * of them waiting for their response at a time. The result of each request
+ * is stored in errs.
+ *
+ * If all requests succeed than return NRV_SUCCESS
+ * Otherwise return NRV_IPMI_ERROR
+ */
+static int ipmi_cmd_batch(bsmc_req *reqs, bsmc_res *res, int *errs, int count) {
+    int ret = NRV_SUCCESS;
 
-        /*
-         * SuperMicro BMC firmware returns invalid command code in SlotIPMB
-         * response when there is a heavy trafic of IPMI messages. It is only
-         * occured in firmware update process with very low reproduction ratio.
-         */
-        if (res->slot_ipmb_completion_code == IPMI_CC_INVALID_COMMAND)
-            super_micro_wa_retry = true;
-
-        if (res->slot_ipmb_completion_code == IPMB_CC_BUS_ERROR ||
-            super_micro_wa_retry) {
-            if (retries) {
-                retries--;
-                usleep(RETRY_SLEEP_TIME_US);
-                goto retry;
-            }
-            return NRV_IPMI_ERROR;
-        } else if (res->slot_ipmb_completion_code != IPMI_CC_SUCCESS) {
-            return NRV_IPMI_ERROR;
-        }
+    for (int i = 0; i < count; i++)
+        errs[i] = NRV_IPMI_ERROR;
 
-        res->data_len = response_len - RESPONSE_HEADER_SIZE;
+#ifdef __linux__
+    std::deque<int> pending;
+    std::vector<int> retries(count, MAX_RETRIES);
+    // the index of the request by msgid
+    std::map<long, int> in_flight;
+    struct timespec deadline;
+
+    for (int i = 0; i < count; i++)
+        pending.push_back(i);
+
+    response_deadline(&deadline);
+    while (!pending.empty() || !in_flight.empty()) {
+        while (!pending.empty() && in_flight.size() < MAX_IN_FLIGHT) {
+            int i = pending.front();
+            long msgid = g_next_msgid++;
+            pending.pop_front();
+            if (ipmi_send(SLOT_IPMB_NETFN, SLOT_IPMB_CMD, (unsigned char *)&reqs[i],
+                          REQUEST_HEADER_SIZE + reqs[i].data_len, msgid))
+                continue;
+            in_flight[msgid] = i;
+        }
+        if (in_flight.empty())
+            break;
+
+        bsmc_res response;
+        unsigned short response_len = sizeof(response);
+        long msgid;
+        bool retry;
+        if (ipmi_recv_for([&in_flight](long id) { return in_flight.count(id) > 0; },
+                          (unsigned char *)&response, &response_len, &msgid, &deadline))
+            break;
+        auto it = in_flight.find(msgid);
+        int i = it->second;
+        in_flight.erase(it);
+        res[i] = response;
+        errs[i] = slot_ipmb_check_res(false, &res[i], response_len, &retry);
+        if (retry && retries[i]) {
+            retries[i]--;
+            pending.push_back(i);
+        }
+    }
+#else
+    for (int i = 0; i < count; i++) {
+        gNetfn = reqs[i].netfn;
+        gCmd = reqs[i].cmd;
+        if (gNetfn == IPMI_INTEL_OEM_NETFN && gCmd == IPMI_READ_SENSOR_CMD)
+            gSensorIndex = reqs[i].data[0];
+        if (gNetfn == IPMI_STORAGE_NETFN && (gCmd == IPMI_FRU_GET_INFO || gCmd == IPMI_FRU_READ_DATA)) {
+            gDeviceId = reqs[i].data[0];
+            gOffsetLsb = reqs[i].data[1];
+            gOffsetMsb = reqs[i].data[2];
+            gReadCount = reqs[i].data[3];
+        }
+        errs[i] = ipmi_cmd(&reqs[i], &res[i]);
     }
 #endif
-    return NRV_SUCCESS;
+
+    for (int i = 0; i < count; i++) {
+        if (errs[i])
+            ret = NRV_IPMI_ERROR;
+    }
+    return ret;
 }
 
 static int ipmi_validate_res(bsmc_res res, uint16_t res_size) {
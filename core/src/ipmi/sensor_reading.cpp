@@ -11,33 +11,67 @@
 #include "sensor_reading.h"
 #include "xpum_structs.h"
 #include "ipmi.h"
+#include "infrastructure/configuration.h"
+#include "infrastructure/thread_factory.h"
 
 namespace xpum {
 
-extern unsigned char gNetfn;
-extern unsigned char gCmd;
-extern uint8_t gSensorIndex;
+extern thread_local unsigned char gNetfn;
+extern thread_local unsigned char gCmd;
+extern thread_local uint8_t gSensorIndex;
 
-int get_sdr_count(ipmi_address_t *ipmi_address, int &count) {
+// the requests below carry netfn 0x4 themselves for cmd_batch, ipmi_cmd takes it from gNetfn
+static void sdr_info_req_init(bsmc_req *req, ipmi_address_t *ipmi_address) {
+    bsmc_hal->oem_req_init(req, ipmi_address, 0x20);
+    req->netfn = 0x4;
+    req->data[0] = 1;
+    req->data_len = 1;
+}
+
+static void parse_sdr_info(const bsmc_res &res, int &count, uint32_t &change_indicator) {
+    count = res.data[0];
+    change_indicator = 0;
+    if (res.data_len >= 7)
+        memcpy(&change_indicator, res.data + 2, 4);
+}
+
+// get device sdr info, change_indicator is the sensor population change indicator, 0 if the card has none
+static int get_sdr_info(ipmi_address_t *ipmi_address, int &count, uint32_t &change_indicator) {
     bsmc_req req;
     bsmc_res res;
-    bsmc_hal->oem_req_init(&req, ipmi_address, 0x20);
-    req.data[0] = 1;
-    req.data_len = 1;
+    sdr_info_req_init(&req, ipmi_address);
     gNetfn = 0x4;
     gCmd = 0x20;
     if (bsmc_hal->cmd(&req, &res))
         return NRV_IPMI_ERROR;
-    count = res.data[0];
+    parse_sdr_info(res, count, change_indicator);
+    return NRV_SUCCESS;
+}
+
+int get_sdr_count(ipmi_address_t *ipmi_address, int &count) {
+    uint32_t change_indicator;
+    return get_sdr_info(ipmi_address, count, change_indicator);
+}
+
+static void sensor_reading_req_init(bsmc_req *req, ipmi_address_t *ipmi_address, uint8_t sensor_number) {
+    bsmc_hal->oem_req_init(req, ipmi_address, 0x2d);
+    req->netfn = 0x4;
+    req->data[0] = sensor_number;
+    req->data_len = 1;
+}
+
+static int parse_sensor_reading(const bsmc_res &res, ipmi_buf *buf) {
+    if (res.completion_code)
+        return NRV_IPMI_ERROR;
+    memcpy(buf->data, res.data, res.data_len - 1);
+    buf->data_len = res.data_len - 1;
     return NRV_SUCCESS;
 }
 
 int cmd_get_sensor_reading(ipmi_address_t *ipmi_address, uint8_t sensor_number, ipmi_buf *buf) {
     bsmc_req req;
     bsmc_res res;
-    bsmc_hal->oem_req_init(&req, ipmi_address, 0x2d);
-    req.data[0] = sensor_number;
-    req.data_len = 1;
+    sensor_reading_req_init(&req, ipmi_address, sensor_number);
     gNetfn = 0x4;
     gCmd = 0x2d;
     // std::cout << "Sensor Reading:" << std::endl;
@@ -50,10 +84,8 @@ int cmd_get_sensor_reading(ipmi_address_t *ipmi_address, uint8_t sensor_number,
         return NRV_IPMI_ERROR;
     // std::cout << "completion code: ";
     // std::cout << std::dec << (int)res.completion_code << std::endl;
-    if (res.completion_code)
+    if (parse_sensor_reading(res, buf))
         return NRV_IPMI_ERROR;
-    memcpy(buf->data, res.data, res.data_len - 1);
-    buf->data_len = res.data_len - 1;
     // std::cout << std::dec << "response data_len: " << res.data_len << std::endl;
     // std::cout << "response data: " << std::endl;
     // for (int i = 0; i < res.data_len; i++) {
@@ -69,6 +101,7 @@ int get_sdr(ipmi_address_t *ipmi_address,
     bsmc_req req;
     bsmc_res res;
     bsmc_hal->oem_req_init(&req, ipmi_address, 0x21); // 0x21 is get device sdr
+    req.netfn = 0x4;
     gNetfn = 0x4;
     gCmd = 0x21;
 
@@ -100,7 +133,31 @@ int get_sdr(ipmi_address_t *ipmi_address,
     int bytes_left = record_length_following;
     int offset = 0x5;
 
-    while (bytes_left) {
+    // the rest of the record is read in chunks sent together
+    std::vector<bsmc_req> chunk_reqs;
+    for (int chunk_offset = offset; chunk_offset < offset + bytes_left; chunk_offset += 0x1d) {
+        int left = offset + bytes_left - chunk_offset;
+        chunk_reqs.push_back(req);
+        chunk_reqs.back().data[4] = chunk_offset;
+        chunk_reqs.back().data[5] = left < 0x1d ? left : 0x1d;
+    }
+    std::vector<bsmc_res> chunk_res(chunk_reqs.size());
+    std::vector<int> chunk_errs(chunk_reqs.size());
+    if (!chunk_reqs.empty())
+        bsmc_hal->cmd_batch(chunk_reqs.data(), chunk_res.data(), chunk_errs.data(), chunk_reqs.size());
+    for (std::size_t i = 0; i < chunk_reqs.size() && bytes_left > 0; i++) {
+        int tmp = chunk_res[i].data_len - 3;
+        if (chunk_errs[i] || chunk_reqs[i].data[4] != offset || tmp <= 0)
+            break;
+        bytes_left -= tmp;
+        offset += tmp;
+        memcpy(p_buf, chunk_res[i].data + 2, tmp);
+        p_buf += tmp;
+        buf->data_len += tmp;
+    }
+
+    // one by one from a chunk that failed or came back short
+    while (bytes_left > 0) {
         bsmc_res res_;
         int bytes_to_read = bytes_left < 0x1d ? bytes_left : 0x1d;
         req.data[4] = offset;        // offset into record
@@ -156,12 +213,28 @@ int get_sdr_list(nrv_card& card){
     return NRV_SUCCESS;
 }
 
-void get_sensor_reading(nrv_card& card, std::vector<xpum_sensor_reading_t>& reading_list){
-    int sdr_count = card.sdr_list.size();
-    ipmi_address_t *ipmi_address = &card.ipmi_address;
-
-    for (int i = 0; i < sdr_count; i++) {
-        ipmi_buf sdr_buf = card.sdr_list[i];
+// read the sensors of all the cards with the requests sent together
+static void get_sensor_reading(std::vector<nrv_card*>& cards, std::vector<xpum_sensor_reading_t>& reading_list){
+    std::vector<bsmc_req> reqs;
+    // the card and sdr of each request
+    std::vector<std::pair<nrv_card*, std::size_t>> targets;
+    for (auto p_card : cards) {
+        for (std::size_t i = 0; i < p_card->sdr_list.size(); i++) {
+            struct sdr_record_common_sensor * record = (struct sdr_record_common_sensor *)(p_card->sdr_list[i].data+7);
+            reqs.emplace_back();
+            sensor_reading_req_init(&reqs.back(), &p_card->ipmi_address, record->keys.sensor_num);
+            targets.emplace_back(p_card, i);
+        }
+    }
+    if (reqs.empty())
+        return;
+    std::vector<bsmc_res> res(reqs.size());
+    std::vector<int> errs(reqs.size());
+    bsmc_hal->cmd_batch(reqs.data(), res.data(), errs.data(), reqs.size());
+
+    for (std::size_t i = 0; i < reqs.size(); i++) {
+        nrv_card& card = *targets[i].first;
+        ipmi_buf& sdr_buf = card.sdr_list[targets[i].second];
         ipmi_buf reading_buf;
         memset(&reading_buf, 0, sizeof(ipmi_buf));
 
@@ -169,8 +242,7 @@ void get_sensor_reading(nrv_card& card, std::vector<xpum_sensor_reading_t>& read
 
         struct sdr_record_common_sensor * record = (struct sdr_record_common_sensor *)(sdr_buf.data+7);
 
-        int err = cmd_get_sensor_reading(ipmi_address, record->keys.sensor_num, &reading_buf);
-        if (err)
+        if (errs[i] || parse_sensor_reading(res[i], &reading_buf))
             continue;
 
         xpum_sensor_reading_t sensor_reading_data;
@@ -219,26 +291,120 @@ void get_sensor_reading(nrv_card& card, std::vector<xpum_sensor_reading_t>& read
 }
 
 
-std::vector<xpum_sensor_reading_t> read_sensor() {
+SensorReadingCollector& SensorReadingCollector::instance() {
+    static SensorReadingCollector collector;
+    return collector;
+}
+
+std::vector<xpum_sensor_reading_t> SensorReadingCollector::collect() {
     std::vector<xpum_sensor_reading_t> res;
-    // read_sensor_res sensor_read;
-    // csv_buffer cbuf_header;
-    // csv_buffer cbuf_data;
-    int err = NRV_SUCCESS;
-    int card_id = CARD_SELECT_ALL;
     nrv_list cards{};
-    err = get_card_list(&cards, card_id);
+    int err = get_card_list(&cards, CARD_SELECT_ALL);
     if (err)
-        goto exit;
-
+        return res;
+
+    // the sdr info of all the cards is asked together
+    std::vector<bsmc_req> info_reqs(cards.count);
+    std::vector<bsmc_res> info_res(cards.count);
+    std::vector<int> info_errs(cards.count);
+    for (int i = 0; i < cards.count; i++)
+        sdr_info_req_init(&info_reqs[i], &cards.card[i].ipmi_address);
+    if (cards.count > 0)
+        bsmc_hal->cmd_batch(info_reqs.data(), info_res.data(), info_errs.data(), cards.count);
+
+    std::vector<nrv_card*> read_cards;
     for (int i = 0; i < cards.count; i++) {
-        get_sensor_reading(cards.card[i], res);
+        nrv_card& card = cards.card[i];
+        int count = 0;
+        uint32_t change_indicator = 0;
+        auto it = sdrs.find(card.id);
+        if (info_errs[i] == NRV_SUCCESS) {
+            parse_sdr_info(info_res[i], count, change_indicator);
+            if (it == sdrs.end()) {
+                // the sdrs read when the card is discovered
+                it = sdrs.emplace(card.id, CardSdr{count, change_indicator, card.sdr_list}).first;
+            } else if (it->second.count != count || it->second.change_indicator != change_indicator) {
+                XPUM_LOG_INFO("SDR repository of card {} changed, read it again", card.id);
+                get_sdr_list(card);
+                it->second = CardSdr{count, change_indicator, card.sdr_list};
+            }
+        }
+        if (it != sdrs.end())
+            card.sdr_list = it->second.sdr_list;
+        read_cards.push_back(&card);
     }
-
-exit:
-    // free(cbuf_header.buf);
-    // free(cbuf_data.buf);
+    get_sensor_reading(read_cards, res);
     return res;
 }
 
+void SensorReadingCollector::run() {
+    // no readings are collected when they are not asked for this long
+    const auto idle_timeout = std::chrono::seconds(60);
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            cv.wait_for(lck, std::chrono::milliseconds(Configuration::AMC_SENSOR_REFRESH_INTERVAL));
+            if (paused || std::chrono::steady_clock::now() - last_request > idle_timeout)
+                continue;
+        }
+        std::lock_guard<std::mutex> refresh_lck(refresh_mtx);
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            if (paused)
+                continue;
+        }
+        auto res = collect();
+        std::lock_guard<std::mutex> lck(mtx);
+        readings = res;
+        valid = true;
+    }
+}
+
+std::vector<xpum_sensor_reading_t> SensorReadingCollector::get() {
+    std::unique_lock<std::mutex> lck(mtx);
+    last_request = std::chrono::steady_clock::now();
+    if ((!valid || Configuration::AMC_SENSOR_REFRESH_INTERVAL == 0) && !paused) {
+        lck.unlock();
+        // pause() waits for the readings
+        std::lock_guard<std::mutex> refresh_lck(refresh_mtx);
+        lck.lock();
+        if ((!valid || Configuration::AMC_SENSOR_REFRESH_INTERVAL == 0) && !paused) {
+            lck.unlock();
+            auto res = collect();
+            lck.lock();
+            readings = res;
+            valid = true;
+        }
+    }
+    if (!started && Configuration::AMC_SENSOR_REFRESH_INTERVAL > 0) {
+        started = true;
+        ThreadFactory::create("xpum-amc-sensor", [this]() { run(); }).detach();
+    }
+    return readings;
+}
+
+void SensorReadingCollector::pause() {
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        paused++;
+    }
+    // wait for the readings in progress
+    std::lock_guard<std::mutex> refresh_lck(refresh_mtx);
+}
+
+void SensorReadingCollector::resume(bool invalidate) {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (paused > 0)
+        paused--;
+    if (invalidate) {
+        valid = false;
+        sdrs.clear();
+        readings.clear();
+    }
+}
+
+std::vector<xpum_sensor_reading_t> read_sensor() {
+    return SensorReadingCollector::instance().get();
+}
+
 } // namespace xpum
\ No newline at end of file
@@ -6,10 +6,73 @@
 
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <vector>
+
 #include "sdr.h"
 #include "tool.h"
+#include "xpum_structs.h"
 
 namespace xpum {
 
 int get_sdr_list(nrv_card& card);
-}
\ No newline at end of file
+
+/*
+  SensorReadingCollector reads the AMC sensors of all cards in the
+  background, every Configuration::AMC_SENSOR_REFRESH_INTERVAL ms, and
+  read_sensor() returns the last readings. The SDRs of a card are read
+  again only when its SDR count or sensor population change indicator
+  changes. The collector stops reading when no readings are asked for a
+  while, and it is paused while other IPMI commands are sent.
+*/
+class SensorReadingCollector {
+   public:
+    static SensorReadingCollector& instance();
+
+    std::vector<xpum_sensor_reading_t> get();
+
+    // no IPMI commands are sent by the collector until resume()
+    void pause();
+
+    // invalidate when the cards may have changed, e.g. after a firmware update
+    void resume(bool invalidate = false);
+
+   private:
+    SensorReadingCollector() = default;
+
+    struct CardSdr {
+        int count;
+        uint32_t change_indicator;
+        std::vector<ipmi_buf> sdr_list;
+    };
+
+    // read the sensors of all cards, the caller holds refresh_mtx
+    std::vector<xpum_sensor_reading_t> collect();
+
+    void run();
+
+    std::mutex mtx;
+
+    // held while the collector sends IPMI commands
+    std::mutex refresh_mtx;
+
+    std::condition_variable cv;
+
+    bool started = false;
+
+    int paused = 0;
+
+    bool valid = false;
+
+    std::vector<xpum_sensor_reading_t> readings;
+
+    std::chrono::steady_clock::time_point last_request;
+
+    // by card id
+    std::map<int, CardSdr> sdrs;
+};
+
+} // namespace xpum
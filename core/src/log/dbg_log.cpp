@@ -1,248 +1,467 @@
-/* 
+/*
  *  Copyright (C) 2022-2023 Intel Corporation
  *  SPDX-License-Identifier: MIT
  *  @file dbg_log.cpp
  */
 
+#include <dirent.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <spawn.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
-#include <iostream>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
 #include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 #include "dbg_log.h"
 #include "firmware/system_cmd.h"
 
 #define ERR_UUID -1
-#define ERR_TMP_DIR -2
-#define ERR_COPY_FILES -3
-#define ERR_GEN_OUT -5
 #define ERR_TAR -6
-#define ERR_RM_TMP -7
+
+extern char **environ;
 
 using namespace xpum;
 using namespace std;
 
-// The shell scritp fucntions string to 
-// copy filds under under dir:
-// /sys/class/drm/*/
-// /sys/kernel/debug/dri/*/
-// /sys/kernel/debug/dri/*/i915_params
-// /sys/kernel/debug/dri/*/gt0
-// /sys/kernel/debug/dri/*/gt1
-
-const string SHELL_FUNCS = "#!/bin/sh\n\
-copy_files_d1() {\n\
-    for f1 in `ls $1 2> /dev/null;`; do\n\
-        if [ ! -f \"$1/$f1\" ]; then\n\
-            continue\n\
-        fi\n\
-        if [ ! -r \"$1/$f1\" ]; then\n\
-            continue\n\
-        fi\n\
-#       echo \"cp $1/$f1 to $2\"\n\
-        cp \"$1/$f1\" \"$2\"\n\
-    done\n\
-}\n\n\
-\
-copy_files_d2() {\n\
-    for d1 in `ls $1 2> /dev/null;`; do\n\
-        if [ -d \"$1/$d1\" ]; then\n\
-            mkdir -p \"$2$1/$d1\"\n\
-            copy_files_d1 \"$1/$d1\" \"$2$1/$d1\"\n\
-        fi\n\
-    done\n\
-}\n\n\
-copy_a_dir() { \n\
-    for d1 in `ls $1 2> /dev/null;`; do\n\
-        if [ -d \"$1/$d1\" ]; then \n\
-            for d2 in `ls $1/$d1 2> /dev/null;`; do\n\
-                if [ -d \"$1/$d1/$d2\" ] && [ \"$d2\" = \"$2\" ]; then\n\
-                     mkdir -p \"$3$1/$d1/\"\n\
-                     cp -r  \"$1/$d1/$d2\" \"$3$1/$d1/\"\n\
-                fi\n\
-            done\n\
-        fi\n\
-    done\n\
-}\n\n\
-copy_files_d2 /sys/class/drm $1\n\
-copy_files_d2 /sys/kernel/debug/dri $1\n\
-copy_a_dir /sys/kernel/debug/dri i915_params $1\n\
-#copy_a_dir /sys/kernel/debug/dri gt0 $1\n\
-#copy_a_dir /sys/kernel/debug/dri gt1 $1\n\
-";
+/*
+  The debug log is a tar.gz of the files below under the folder xpum-UUID:
+    proc, os-release, syslog, kern.log      system files
+    sys/class/drm, sys/kernel/debug/dri     the files of the drm devices
+    driver-info, dmesg-output, package-info, system-info   command outputs
+    probe-status                            the time and result of each probe
+
+  The probes run in parallel, each in its own thread, and the commands are
+  killed by timeout(1) after PROBE_TIMEOUT. The files of a probe are written
+  to the archive as soon as the probe is done, through a tar stream piped
+  into gzip, so nothing is written to /var/tmp. A probe not done after
+  TOTAL_TIMEOUT is left out and marked as timed out in probe-status.
+*/
+
+const int PROBE_TIMEOUT = 30;
+
+const int TOTAL_TIMEOUT = 90;
 
 const string PACKS = "\'intel-915\\|intel-gsc\\|libmetee\\|level-zero\\|intel-level-zero-gpu\\|intel-gmmlib\\|intel-igc-core\\|intel-igc-opencl\\|intel-mediasdk-utils\\|ocl-icd\\|intel-mediasdk\\|libX11-xcb\\|libXfixes\\|libXxf86vm\\|libdrm\\|libglvnd\\|libglvnd-glx\\|libpciaccess\\|libva\\|libwayland-client\\|libxshmfence\\|mesa-filesystem\\|mesa-libGL\\|mesa-libglapi\\|intel-media-driver\\|libmfxgen1\\|libmfx1\\|libmfx-utils\\|libmfx-tools\\|intel-media-va-driver-non-free\'";
 
-int getUUID(std::string &uuid) {
-    SystemCommandResult scr = execCommand("cat /proc/sys/kernel/random/uuid");
-    uuid = scr.output();
-    return scr.exitStatus();
+typedef vector<pair<string, string>> ProbeFiles;
+
+struct Probe {
+    // the name in probe-status
+    string name;
+    // the file of the command output, the outputs of the commands in the
+    // same file are joined in the order of the probes
+    string file;
+    string command;
+    // the probe that reads files instead of running a command
+    function<void(ProbeFiles &)> collect;
+
+    bool done = false;
+    bool written = false;
+    string output;
+    ProbeFiles files;
+    double seconds = 0;
+};
+
+struct ProbeSync {
+    mutex mtx;
+    condition_variable cv;
+};
+
+static string shellQuote(const string &s) {
+    string res = "'";
+    for (char c : s) {
+        if (c == '\'') {
+            res += "'\\''";
+        } else {
+            res += c;
+        }
+    }
+    return res + "'";
 }
 
-int createTmpDir(const string &uuid) {
-    string dirName = "/var/tmp/xpum-" + uuid;
-    return mkdir(dirName.c_str(), 0777);
+static string runCommand(const string &cmd) {
+    string timed = "timeout -k 1 " + to_string(PROBE_TIMEOUT) + " sh -c " + shellQuote(cmd);
+    SystemCommandResult scr = execCommand(timed);
+    return scr.output();
 }
 
-int copyFiles(const string &uuid) {
-    int ret = 0;
-    string dirName = "/var/tmp/xpum-" + uuid + "/proc";
-    ret = mkdir(dirName.c_str(), 0777);
-    if (ret != 0) {
-        return ret;
-    }
-    string cmd = "cp /proc/cpuinfo " + dirName;
-    SystemCommandResult scr = execCommand(cmd.c_str()) ;
-    cmd = "cp /proc/interrupts " + dirName;
-    scr = execCommand(cmd.c_str()) ;
-    cmd = "cp /proc/meminfo " + dirName;
-    scr = execCommand(cmd.c_str()) ;
-    cmd = "cp /proc/modules " + dirName;
-    scr = execCommand(cmd.c_str()) ;
-    cmd = "cp /proc/version " + dirName;
-    scr = execCommand(cmd.c_str()) ;
-    cmd = "cp /proc/pci " + dirName + " 2>&1";
-    scr = execCommand(cmd.c_str()) ;
-    cmd = "cp /proc/iomem " + dirName;
-    scr = execCommand(cmd.c_str()) ;
-    cmd = "cp /proc/mtrr " + dirName;
-    scr = execCommand(cmd.c_str()) ;
-    cmd = "cp /proc/cmdline " + dirName;
-    scr = execCommand(cmd.c_str()) ;
-
-    dirName = "/var/tmp/xpum-" + uuid;
-    cmd = "cp /etc/os-release " + dirName;
-    scr = execCommand(cmd.c_str());
-    cmd = "cp /var/log/syslog " + dirName + " 2>&1";
-    scr = execCommand(cmd.c_str());
-    cmd = "cp /var/log/kern*.log " + dirName + " 2>&1";
-    scr = execCommand(cmd.c_str());
-
-    string shName = "/var/tmp/xpum-" + uuid + "/cp.sh" ; 
-    ofstream os(shName);
-    os << SHELL_FUNCS;
-    os.close();
-    cmd = "chmod u+x " + shName;
-    scr = execCommand(cmd.c_str());
-    cmd = shName + " /var/tmp/xpum-" + uuid + " 2>&1";
-    scr = execCommand(cmd.c_str());
-    cmd = "rm -f " + shName;
-    scr = execCommand(cmd.c_str());
-
-    return ret;
+static bool readFile(const string &path, string &content) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode) || access(path.c_str(), R_OK) != 0) {
+        return false;
+    }
+    ifstream is(path, ios::binary);
+    if (!is) {
+        return false;
+    }
+    stringstream ss;
+    ss << is.rdbuf();
+    content = ss.str();
+    return true;
+}
+
+static void listDir(const string &dir, vector<string> &names) {
+    names.clear();
+    DIR *d = opendir(dir.c_str());
+    if (d == nullptr) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != nullptr) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+            names.push_back(entry->d_name);
+        }
+    }
+    closedir(d);
+}
+
+static bool isDir(const string &path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+// the readable files in the folders under dir, like "cp dir/*/* "
+static void copyFilesD2(const string &dir, ProbeFiles &files) {
+    vector<string> subdirs, names;
+    listDir(dir, subdirs);
+    for (auto &d1 : subdirs) {
+        string sub = dir + "/" + d1;
+        if (!isDir(sub)) {
+            continue;
+        }
+        listDir(sub, names);
+        for (auto &f1 : names) {
+            string content;
+            if (readFile(sub + "/" + f1, content)) {
+                files.emplace_back(sub.substr(1) + "/" + f1, content);
+            }
+        }
+    }
+}
+
+// the files under path, recursively, like "cp -r"
+static void copyTree(const string &path, ProbeFiles &files) {
+    vector<string> names;
+    listDir(path, names);
+    for (auto &name : names) {
+        string sub = path + "/" + name;
+        string content;
+        if (isDir(sub)) {
+            copyTree(sub, files);
+        } else if (readFile(sub, content)) {
+            files.emplace_back(sub.substr(1), content);
+        }
+    }
 }
 
-int genCmdOut(const string &uuid) {
-    /*
-    Orgnize the output to 4 files:
-        driver-info (file names under /dev/dri, modinfo -n i915, uname -r)
-        dmesg-output
-        package-info
-        system-info (lspci, dmidecode, lsusb, xpu-smi, clinfo, vainfo)
-    */
-    int ret = 0;
-
-    string fileName = "/var/tmp/xpum-" + uuid + "/driver-info";
-    ofstream os(fileName);
-    string cmd = "modinfo -n i915";
-    SystemCommandResult scr = execCommand(cmd.c_str()) ;
-    os << cmd + "\n" + scr.output();
-    cmd = "uname -r";
-    scr = execCommand(cmd.c_str());
-    os << "\n" + cmd + "\n" + scr.output();
-    cmd = "ls /dev/dri";
-    scr = execCommand(cmd.c_str());
-    os << "\n" + cmd + "\n" + scr.output();
-    os.close();
-
-    fileName = "/var/tmp/xpum-" + uuid + "/dmesg-output";
-    os.open(fileName);
-    cmd = "dmesg";
-    scr = execCommand(cmd.c_str()) ;
-    os << cmd + "\n" + scr.output();
-    os.close();
-
-    fileName = "/var/tmp/xpum-" + uuid + "/package-info";
-    os.open(fileName);
-    cmd = "which rpm";
-    scr = execCommand(cmd.c_str());
-    if (scr.exitStatus() == 0) {
-        cmd = "rpm -qa|grep ";
-    } else {
-        cmd = "apt list --installed 2>&1|grep ";
-    }
-    cmd += PACKS;
-    scr = execCommand(cmd.c_str());
-    os << cmd + "\n" + scr.output();
-    os.close();
-
-    fileName = "/var/tmp/xpum-" + uuid + "/system-info";
-    os.open(fileName);
-    cmd = "lspci -v -xxx";
-    scr = execCommand(cmd.c_str());
-    os << cmd + "\n" + scr.output();
-    cmd = "dmidecode 2>&1";
-    scr = execCommand(cmd.c_str());
-    os << "\n" + cmd + "\n" + scr.output();
-    cmd = "lsusb 2>&1";
-    scr = execCommand(cmd.c_str());
-    os << "\n" + cmd + "\n" + scr.output();
-    cmd = "xpu-smi discovery 2>&1";
-    scr = execCommand(cmd.c_str());
-    os << "\n" + cmd + "\n" + scr.output();
-    cmd = "clinfo 2>&1";
-    scr = execCommand(cmd.c_str());
-    os << "\n" + cmd + "\n" + scr.output();
-    cmd = "vainfo 2>&1";
-    scr = execCommand(cmd.c_str());
-    os << "\n" + cmd + "\n" + scr.output();
-    os.close();
-
-    return ret;
+static void copyADir(const string &dir, const string &name, ProbeFiles &files) {
+    vector<string> subdirs;
+    listDir(dir, subdirs);
+    for (auto &d1 : subdirs) {
+        string path = dir + "/" + d1 + "/" + name;
+        if (isDir(path)) {
+            copyTree(path, files);
+        }
+    }
 }
 
-int tarBall(const string &uuid, const char *fileName) {
-    string cmd = "tar -C /var/tmp/ -czf " + string(fileName) + " xpum-" + uuid;
-    SystemCommandResult scr = execCommand(cmd.c_str()) ;
-    return scr.exitStatus();
+static vector<shared_ptr<Probe>> createProbes() {
+    vector<shared_ptr<Probe>> probes;
+    auto addCommand = [&](const string &file, const string &command) {
+        auto probe = make_shared<Probe>();
+        probe->name = command;
+        probe->file = file;
+        probe->command = command;
+        probes.push_back(probe);
+    };
+    auto addCollect = [&](const string &name, function<void(ProbeFiles &)> collect) {
+        auto probe = make_shared<Probe>();
+        probe->name = name;
+        probe->collect = collect;
+        probes.push_back(probe);
+    };
+
+    addCollect("system files", [](ProbeFiles &files) {
+        for (auto name : {"cpuinfo", "interrupts", "meminfo", "modules", "version", "pci", "iomem", "mtrr", "cmdline"}) {
+            string content;
+            if (readFile(string("/proc/") + name, content)) {
+                files.emplace_back(string("proc/") + name, content);
+            }
+        }
+        string content;
+        if (readFile("/etc/os-release", content)) {
+            files.emplace_back("os-release", content);
+        }
+        if (readFile("/var/log/syslog", content)) {
+            files.emplace_back("syslog", content);
+        }
+        glob_t g;
+        if (glob("/var/log/kern*.log", 0, nullptr, &g) == 0) {
+            for (size_t i = 0; i < g.gl_pathc; i++) {
+                string path = g.gl_pathv[i];
+                if (readFile(path, content)) {
+                    files.emplace_back(path.substr(path.rfind('/') + 1), content);
+                }
+            }
+            globfree(&g);
+        }
+    });
+    addCollect("/sys/class/drm", [](ProbeFiles &files) {
+        copyFilesD2("/sys/class/drm", files);
+    });
+    addCollect("/sys/kernel/debug/dri", [](ProbeFiles &files) {
+        copyFilesD2("/sys/kernel/debug/dri", files);
+    });
+    addCollect("/sys/kernel/debug/dri/*/i915_params", [](ProbeFiles &files) {
+        copyADir("/sys/kernel/debug/dri", "i915_params", files);
+    });
+    addCollect("package-info", [](ProbeFiles &files) {
+        string cmd;
+        if (execCommand("which rpm").exitStatus() == 0) {
+            cmd = "rpm -qa|grep ";
+        } else {
+            cmd = "apt list --installed 2>&1|grep ";
+        }
+        cmd += PACKS;
+        files.emplace_back("package-info", cmd + "\n" + runCommand(cmd));
+    });
+
+    addCommand("driver-info", "modinfo -n i915");
+    addCommand("driver-info", "uname -r");
+    addCommand("driver-info", "ls /dev/dri");
+    addCommand("dmesg-output", "dmesg");
+    addCommand("system-info", "lspci -v -xxx");
+    addCommand("system-info", "dmidecode 2>&1");
+    addCommand("system-info", "lsusb 2>&1");
+    addCommand("system-info", "xpu-smi discovery 2>&1");
+    addCommand("system-info", "clinfo 2>&1");
+    addCommand("system-info", "vainfo 2>&1");
+    return probes;
 }
 
-int removeTmp(const string &uuid) {
-    string cmd = "rm -rf /var/tmp/xpum-" + uuid;
-    SystemCommandResult scr = execCommand(cmd.c_str()) ;
-    return scr.exitStatus();
+class TarStream {
+   public:
+    explicit TarStream(int fd) : fd(fd), failed(false) {
+    }
+
+    void add(const string &name, const string &content) {
+        char header[512] = {};
+        string prefix, base = name;
+        // ustar keeps a name up to 255 bytes in the prefix and the name fields
+        if (base.size() > 100) {
+            size_t pos = base.rfind('/', 155);
+            if (pos == string::npos || base.size() - pos - 1 > 100) {
+                return;
+            }
+            prefix = base.substr(0, pos);
+            base = base.substr(pos + 1);
+        }
+        memcpy(header, base.data(), base.size());
+        snprintf(header + 100, 8, "%07o", 0644);
+        snprintf(header + 108, 8, "%07o", 0);
+        snprintf(header + 116, 8, "%07o", 0);
+        snprintf(header + 124, 12, "%011llo", (unsigned long long)content.size());
+        snprintf(header + 136, 12, "%011llo", (unsigned long long)time(nullptr));
+        header[156] = '0';
+        memcpy(header + 257, "ustar", 6);
+        memcpy(header + 263, "00", 2);
+        memcpy(header + 345, prefix.data(), prefix.size());
+        memset(header + 148, ' ', 8);
+        unsigned int sum = 0;
+        for (int i = 0; i < 512; i++) {
+            sum += (unsigned char)header[i];
+        }
+        snprintf(header + 148, 8, "%06o", sum);
+        write(header, sizeof(header));
+        write(content.data(), content.size());
+        static const char zeros[512] = {};
+        write(zeros, (512 - content.size() % 512) % 512);
+    }
+
+    void finish() {
+        static const char zeros[1024] = {};
+        write(zeros, sizeof(zeros));
+    }
+
+    bool isFailed() const {
+        return failed;
+    }
+
+   private:
+    void write(const char *data, size_t size) {
+        while (size > 0 && !failed) {
+            // a socket, so a gzip that exits early does not raise SIGPIPE
+            ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+            if (n <= 0) {
+                failed = true;
+                return;
+            }
+            data += n;
+            size -= n;
+        }
+    }
+
+    int fd;
+
+    bool failed;
+};
+
+// start "gzip -c > fileName" and return the socket of its input
+static int openArchive(const char *fileName, pid_t &pid) {
+    int out = open(fileName, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        return -1;
+    }
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0) {
+        close(out);
+        return -1;
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, sv[1], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, out, STDOUT_FILENO);
+    char arg0[] = "gzip";
+    char arg1[] = "-c";
+    char *argv[] = {arg0, arg1, nullptr};
+    int ret = posix_spawnp(&pid, "gzip", &actions, nullptr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(sv[1]);
+    close(out);
+    if (ret != 0) {
+        close(sv[0]);
+        return -1;
+    }
+    return sv[0];
+}
+
+int getUUID(std::string &uuid) {
+    if (!readFile("/proc/sys/kernel/random/uuid", uuid)) {
+        return -1;
+    }
+    return 0;
 }
 
 int genDebugLog(const char *fileName) {
-    int ret = 0;
     string uuid;
     if (getUUID(uuid) != 0 || uuid.empty() == true) {
-        ret = ERR_UUID; 
-        goto ERR;
+        return ERR_UUID;
     }
     uuid.pop_back();
-    if (createTmpDir(uuid) != 0) {
-        ret = ERR_TMP_DIR;
-        goto ERR;
+    string folder = "xpum-" + uuid + "/";
+
+    pid_t pid;
+    int fd = openArchive(fileName, pid);
+    if (fd < 0) {
+        return ERR_TAR;
     }
-    if (copyFiles(uuid) != 0) {
-        ret = ERR_COPY_FILES;
-        goto ERR;
+    TarStream tar(fd);
+
+    // the probes own their results, a probe still running after the total
+    // timeout finishes in its detached thread without touching the archive
+    auto sync = make_shared<ProbeSync>();
+    auto probes = createProbes();
+    auto start = chrono::steady_clock::now();
+    for (auto &probe : probes) {
+        thread([probe, sync, start]() {
+            string output;
+            ProbeFiles files;
+            if (probe->collect) {
+                probe->collect(files);
+            } else {
+                output = runCommand(probe->command);
+            }
+            lock_guard<mutex> lck(sync->mtx);
+            probe->output = std::move(output);
+            probe->files = std::move(files);
+            probe->seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            probe->done = true;
+            sync->cv.notify_all();
+        }).detach();
     }
-    if (genCmdOut(uuid) != 0) {
-        ret = ERR_GEN_OUT;
-        goto ERR;
+
+    auto deadline = start + chrono::seconds(TOTAL_TIMEOUT);
+    auto writeFile = [&](const string &file, bool final) {
+        // the outputs of a file in the order of the probes, once all are done
+        for (auto &probe : probes) {
+            if (probe->file == file && !probe->done && !final) {
+                return;
+            }
+        }
+        string content;
+        for (auto &probe : probes) {
+            if (probe->file != file) {
+                continue;
+            }
+            content += (content.empty() ? "" : "\n") + probe->command + "\n";
+            content += probe->done ? probe->output : "timed out\n";
+            probe->written = true;
+        }
+        tar.add(folder + file, content);
+    };
+    unique_lock<mutex> lck(sync->mtx);
+    while (true) {
+        bool pending = false;
+        for (auto &probe : probes) {
+            if (probe->written) {
+                continue;
+            }
+            if (!probe->done) {
+                pending = true;
+                continue;
+            }
+            if (probe->collect) {
+                for (auto &file : probe->files) {
+                    tar.add(folder + file.first, file.second);
+                }
+                probe->files.clear();
+                probe->written = true;
+            } else {
+                writeFile(probe->file, false);
+            }
+        }
+        if (!pending || sync->cv.wait_until(lck, deadline) == cv_status::timeout) {
+            break;
+        }
     }
-    if (tarBall(uuid, fileName) != 0) {
-        ret = ERR_TAR;
-        goto ERR;
+    for (auto &probe : probes) {
+        if (!probe->written && !probe->collect) {
+            writeFile(probe->file, true);
+        }
     }
-    if (removeTmp(uuid) != 0) {
-        ret = ERR_RM_TMP;
-        goto ERR;
+    stringstream status;
+    for (auto &probe : probes) {
+        if (probe->done) {
+            status << probe->name << ": done in " << probe->seconds << " s\n";
+        } else {
+            status << probe->name << ": timed out after " << TOTAL_TIMEOUT << " s\n";
+        }
     }
+    lck.unlock();
+    tar.add(folder + "probe-status", status.str());
+    tar.finish();
+    bool failed = tar.isFailed();
+    close(fd);
 
-ERR:
-    return ret;
+    int wstatus = 0;
+    if (waitpid(pid, &wstatus, 0) < 0 || !WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0 || failed) {
+        return ERR_TAR;
+    }
+    return 0;
 }
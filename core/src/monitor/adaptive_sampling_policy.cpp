@@ -0,0 +1,160 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file adaptive_sampling_policy.cpp
+ */
+
+#include "adaptive_sampling_policy.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "core/core.h"
+#include "infrastructure/configuration.h"
+
+namespace xpum {
+
+bool AdaptiveSamplingPolicy::isAdaptive(DeviceCapability capability) {
+    if (!Configuration::MONITOR_ADAPTIVE_SAMPLING) {
+        return false;
+    }
+    // only gauges, a repeated counter sample would read as a zero rate
+    switch (capability) {
+        case DeviceCapability::METRIC_TEMPERATURE:
+        case DeviceCapability::METRIC_MEMORY_TEMPERATURE:
+        case DeviceCapability::METRIC_MEMORY_USED_UTILIZATION:
+        case DeviceCapability::METRIC_FREQUENCY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool AdaptiveSamplingPolicy::isEventDriven(DeviceCapability capability) {
+    // a repeated RAS sample is right as long as no event says the counters changed
+    return capability == DeviceCapability::METRIC_RAS_ERROR && Configuration::RAS_EVENT_POLL_FACTOR > 1;
+}
+
+void AdaptiveSamplingPolicy::setEventDriven(DeviceCapability capability, const std::string& device_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    states[std::make_pair(capability, device_id)].event_driven = true;
+}
+
+void AdaptiveSamplingPolicy::notifyEvent(DeviceCapability capability, const std::string& device_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    states[std::make_pair(capability, device_id)].event_pending = true;
+}
+
+bool AdaptiveSamplingPolicy::isPolicyArmed(DeviceCapability capability, const std::string& device_id) {
+    auto p_policy_manager = Core::instance().getPolicyManager();
+    if (p_policy_manager == nullptr) {
+        return false;
+    }
+    xpum_device_id_t deviceId = std::stoi(device_id);
+    switch (capability) {
+        case DeviceCapability::METRIC_TEMPERATURE:
+            return p_policy_manager->hasPolicy(deviceId, XPUM_POLICY_TYPE_GPU_TEMPERATURE);
+        case DeviceCapability::METRIC_MEMORY_TEMPERATURE:
+            return p_policy_manager->hasPolicy(deviceId, XPUM_POLICY_TYPE_GPU_MEMORY_TEMPERATURE);
+        case DeviceCapability::METRIC_FREQUENCY:
+            return p_policy_manager->hasPolicy(deviceId, XPUM_POLICY_TYPE_GPU_THROTTLE);
+        default:
+            return false;
+    }
+}
+
+bool AdaptiveSamplingPolicy::isStable(MeasurementData& pre, MeasurementData& cur) {
+    const uint64_t invalid = std::numeric_limits<uint64_t>::max();
+    auto close = [](uint64_t a, uint64_t b) {
+        uint64_t diff = a > b ? a - b : b - a;
+        return diff * 100 <= std::max(a, b) * Configuration::ADAPTIVE_SAMPLING_CHANGE_THRESHOLD;
+    };
+    if (pre.hasDataOnDevice() != cur.hasDataOnDevice()) {
+        return false;
+    }
+    if (cur.hasDataOnDevice() && pre.getCurrent() != invalid && cur.getCurrent() != invalid &&
+        !close(pre.getCurrent(), cur.getCurrent())) {
+        return false;
+    }
+    if (pre.hasSubdeviceData() != cur.hasSubdeviceData()) {
+        return false;
+    }
+    if (!cur.hasSubdeviceData()) {
+        return true;
+    }
+    auto p_pre_subs = pre.getSubdeviceDatas();
+    auto p_cur_subs = cur.getSubdeviceDatas();
+    if (p_pre_subs->size() != p_cur_subs->size()) {
+        return false;
+    }
+    for (auto& sub : *p_cur_subs) {
+        auto pre_iter = p_pre_subs->find(sub.first);
+        if (pre_iter == p_pre_subs->end()) {
+            return false;
+        }
+        if (pre_iter->second.current != invalid && sub.second.current != invalid &&
+            !close(pre_iter->second.current, sub.second.current)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<MeasurementData> AdaptiveSamplingPolicy::skipSample(DeviceCapability capability, const std::string& device_id) {
+    auto key = std::make_pair(capability, device_id);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto iter = states.find(key);
+        if (iter != states.end() && iter->second.event_driven) {
+            auto& state = iter->second;
+            if (state.event_pending || state.p_last == nullptr || state.skipped_ticks + 1 >= Configuration::RAS_EVENT_POLL_FACTOR) {
+                state.event_pending = false;
+                state.skipped_ticks = 0;
+                return nullptr;
+            }
+            state.skipped_ticks++;
+            return std::make_shared<MeasurementData>(*state.p_last);
+        }
+        if (iter == states.end() || iter->second.factor <= 1 || iter->second.p_last == nullptr ||
+            iter->second.skipped_ticks + 1 >= iter->second.factor) {
+            if (iter != states.end()) {
+                iter->second.skipped_ticks = 0;
+            }
+            return nullptr;
+        }
+    }
+    // the policy manager has its own lock, do not hold ours while asking it
+    bool armed = isPolicyArmed(capability, device_id);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& state = states[key];
+    if (armed || state.p_last == nullptr) {
+        state.factor = 1;
+        state.stable_ticks = 0;
+        state.skipped_ticks = 0;
+        return nullptr;
+    }
+    state.skipped_ticks++;
+    return std::make_shared<MeasurementData>(*state.p_last);
+}
+
+void AdaptiveSamplingPolicy::update(DeviceCapability capability, const std::string& device_id, const std::shared_ptr<MeasurementData>& p_data) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& state = states[std::make_pair(capability, device_id)];
+    // keep a copy, the monitor task takes the additional data out of the sample it stores
+    state.p_last = std::make_shared<MeasurementData>(*p_data);
+    if (state.event_driven) {
+        return;
+    }
+    if (state.p_reference != nullptr && isStable(*state.p_reference, *p_data)) {
+        if (++state.stable_ticks >= Configuration::ADAPTIVE_SAMPLING_STABLE_TICKS) {
+            state.factor = std::min(state.factor * 2, Configuration::ADAPTIVE_SAMPLING_MAX_FACTOR);
+            state.stable_ticks = 0;
+        }
+    } else {
+        state.factor = 1;
+        state.stable_ticks = 0;
+        state.p_reference = state.p_last;
+    }
+}
+
+} // end namespace xpum
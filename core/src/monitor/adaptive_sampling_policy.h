@@ -0,0 +1,77 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file adaptive_sampling_policy.h
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "infrastructure/device_capability.h"
+#include "infrastructure/measurement_data.h"
+
+namespace xpum {
+
+/*
+  AdaptiveSamplingPolicy lowers the sampling rate of a gauge on a device while
+  its values stay stable. After ADAPTIVE_SAMPLING_STABLE_TICKS stable samples
+  the device is sampled every second tick, then every fourth, up to
+  ADAPTIVE_SAMPLING_MAX_FACTOR. A change beyond ADAPTIVE_SAMPLING_CHANGE_THRESHOLD
+  percent, or a policy armed on the metric, restores the full rate. On a
+  skipped tick the last sample is reported again, so the data handlers keep
+  seeing every device.
+
+  The RAS errors of a device that sends RAS events are event driven instead:
+  they are read every RAS_EVENT_POLL_FACTOR ticks, and on the first tick after
+  an event.
+*/
+
+class AdaptiveSamplingPolicy {
+   public:
+    static bool isAdaptive(DeviceCapability capability);
+
+    static bool isEventDriven(DeviceCapability capability);
+
+    /*
+      Sample capability on the device at the reduced rate, its changes are
+      announced by notifyEvent.
+    */
+    void setEventDriven(DeviceCapability capability, const std::string& device_id);
+
+    void notifyEvent(DeviceCapability capability, const std::string& device_id);
+
+    /*
+      Returns a copy of the last sample if the tick is skipped for the device,
+      nullptr if the device should be sampled.
+    */
+    std::shared_ptr<MeasurementData> skipSample(DeviceCapability capability, const std::string& device_id);
+
+    void update(DeviceCapability capability, const std::string& device_id, const std::shared_ptr<MeasurementData>& p_data);
+
+   private:
+    struct SamplingState {
+        uint32_t factor = 1;
+        uint32_t stable_ticks = 0;
+        uint32_t skipped_ticks = 0;
+        bool event_driven = false;
+        bool event_pending = false;
+        std::shared_ptr<MeasurementData> p_last;
+        // the sample the current stable run is compared to, so a slow drift is still noticed
+        std::shared_ptr<MeasurementData> p_reference;
+    };
+
+    static bool isStable(MeasurementData& pre, MeasurementData& cur);
+
+    static bool isPolicyArmed(DeviceCapability capability, const std::string& device_id);
+
+    std::map<std::pair<DeviceCapability, std::string>, SamplingState> states;
+
+    std::mutex mutex;
+};
+
+} // end namespace xpum
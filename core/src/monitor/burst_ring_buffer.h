@@ -0,0 +1,105 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file burst_ring_buffer.h
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "infrastructure/numa_memory.h"
+
+namespace xpum {
+
+/*
+  Bounded single-producer single-consumer ring buffer. The producer never
+  waits for the consumer: push fails when the buffer is full. The slots are
+  mapped on the NUMA node of the producer, if it is given, and may be backed
+  by huge pages.
+*/
+
+template <typename T>
+class BurstRingBuffer {
+   public:
+    static_assert(std::is_trivially_copyable<T>::value, "the slots are mapped memory");
+
+    explicit BurstRingBuffer(size_t capacity, int node = -1, bool huge_pages = false)
+        : slot_count(roundUpPowerOfTwo(capacity)), mask(slot_count - 1), head(0), tail(0) {
+        slots = static_cast<T*>(NumaMemory::allocate(slot_count * sizeof(T), node, huge_pages));
+        if (slots == nullptr) {
+            fallback.resize(slot_count);
+            slots = fallback.data();
+        }
+    }
+
+    ~BurstRingBuffer() {
+        if (fallback.empty()) {
+            NumaMemory::release(slots, slot_count * sizeof(T));
+        }
+    }
+
+    BurstRingBuffer(const BurstRingBuffer&) = delete;
+
+    BurstRingBuffer& operator=(const BurstRingBuffer&) = delete;
+
+    // producer only
+    bool push(const T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == slot_count) {
+            return false;
+        }
+        slots[h & mask] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only, copies up to max of the oldest values to out
+    size_t pop(T* out, size_t max) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t n = std::min(head.load(std::memory_order_acquire) - t, max);
+        for (size_t i = 0; i < n; i++) {
+            out[i] = slots[(t + i) & mask];
+        }
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return slot_count;
+    }
+
+   private:
+    static size_t roundUpPowerOfTwo(size_t n) {
+        size_t ret = 1;
+        while (ret < n) {
+            ret <<= 1;
+        }
+        return ret;
+    }
+
+   private:
+    const size_t slot_count;
+
+    const size_t mask;
+
+    T* slots;
+
+    // the slots if they can not be mapped
+    std::vector<T> fallback;
+
+    // head and tail are written by different threads, keep them on separate cache lines
+    alignas(64) std::atomic<size_t> head;
+
+    alignas(64) std::atomic<size_t> tail;
+};
+
+} // end namespace xpum
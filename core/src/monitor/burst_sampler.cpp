@@ -0,0 +1,365 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file burst_sampler.cpp
+ */
+
+#include "burst_sampler.h"
+
+#include <chrono>
+#include <limits>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/internal_stats.h"
+#include "infrastructure/logger.h"
+#include "infrastructure/thread_factory.h"
+#include "topology/topology.h"
+
+namespace xpum {
+
+static const uint32_t DEVICE_LEVEL = std::numeric_limits<uint32_t>::max();
+
+static bool capabilityFromBurstMetric(xpum_stats_type_t type, DeviceCapability& capability) {
+    switch (type) {
+        case XPUM_STATS_POWER:
+            capability = DeviceCapability::METRIC_POWER;
+            return true;
+        case XPUM_STATS_GPU_FREQUENCY:
+            capability = DeviceCapability::METRIC_FREQUENCY;
+            return true;
+        case XPUM_STATS_GPU_UTILIZATION:
+            capability = DeviceCapability::METRIC_COMPUTATION;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static uint64_t getCurrentMicrosecond() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+// the NUMA node of the device when its sampling threads are bound to it, the samples are written there
+static int sampleNode(const std::shared_ptr<Device>& p_device) {
+    Property prop;
+    if (!Configuration::MONITOR_BIND_THREADS || !p_device->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS, prop)) {
+        return -1;
+    }
+    return Topology::getNumaNode(prop.getValue());
+}
+
+BurstSamplingSession::BurstSamplingSession(std::shared_ptr<Device> p_device,
+                                           const std::vector<xpum_stats_type_t>& metrics,
+                                           uint32_t interval,
+                                           uint32_t duration)
+    : p_device(p_device),
+      metrics(metrics),
+      interval(interval),
+      duration(duration),
+      // a device reports at most a device level and a few tile level samples per metric
+      ring(std::min<size_t>((duration / interval + 1) * metrics.size() * 4, Configuration::BURST_SAMPLING_MAX_SAMPLES),
+           sampleNode(p_device), Configuration::MONITOR_HUGE_PAGES),
+      dropped(0),
+      running(false),
+      stop_requested(false) {
+}
+
+BurstSamplingSession::~BurstSamplingSession() {
+    stop();
+}
+
+void BurstSamplingSession::start() {
+    running = true;
+    worker = ThreadFactory::create("xpum-burst", [this]() { run(); });
+}
+
+void BurstSamplingSession::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop_requested = true;
+    }
+    cv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+size_t BurstSamplingSession::takeSamples(xpum_burst_sample_t samples[], size_t count) {
+    std::lock_guard<std::mutex> lock(consumer_mutex);
+    return ring.pop(samples, count);
+}
+
+void BurstSamplingSession::run() {
+    // a dedicated thread instead of the scheduled thread pool, whose tasks may
+    // run late by more than the whole burst interval
+    if (Configuration::MONITOR_BIND_THREADS) {
+        Property prop;
+        if (p_device->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS, prop)) {
+            Topology::bindThreadToDevice(prop.getValue());
+        }
+    }
+    auto period = std::chrono::milliseconds(interval);
+    auto next = std::chrono::steady_clock::now();
+    auto end = next + std::chrono::milliseconds(duration);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stop_requested && next <= end) {
+        lock.unlock();
+        sample(getCurrentMicrosecond());
+        lock.lock();
+        next += period;
+        auto now = std::chrono::steady_clock::now();
+        if (next < now) {
+            // sampling took longer than the interval, skip the missed ticks
+            next += ((now - next) / period + 1) * period;
+        }
+        cv.wait_until(lock, next, [this] { return stop_requested; });
+    }
+    running = false;
+    XPUM_LOG_DEBUG("burst sampling on device {} finished, {} samples dropped", p_device->getId(), dropped.load());
+}
+
+void BurstSamplingSession::sample(uint64_t timestamp) {
+    for (auto type : metrics) {
+        switch (type) {
+            case XPUM_STATS_POWER:
+                samplePower(timestamp);
+                break;
+            case XPUM_STATS_GPU_FREQUENCY:
+                sampleFrequency(timestamp);
+                break;
+            case XPUM_STATS_GPU_UTILIZATION:
+                sampleGPUUtilization(timestamp);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+std::shared_ptr<MeasurementData> BurstSamplingSession::collect(DeviceCapability capability) {
+    std::shared_ptr<MeasurementData> ret;
+    // the device methods run the task in the calling thread
+    auto method = Device::getDeviceMethod(capability, p_device.get());
+    InternalStats::DeviceScope device_scope(InternalStats::toDeviceId(p_device->getId()));
+    method([&ret](std::shared_ptr<void> data, std::shared_ptr<BaseException> e) {
+        if (e == nullptr && data != nullptr) {
+            ret = std::static_pointer_cast<MeasurementData>(data);
+        }
+    });
+    return ret;
+}
+
+void BurstSamplingSession::push(uint64_t timestamp, xpum_stats_type_t type, uint32_t subdevice_id, uint64_t value, uint32_t scale) {
+    xpum_burst_sample_t sample;
+    sample.timestamp = timestamp;
+    sample.metricsType = type;
+    sample.isTileData = subdevice_id != DEVICE_LEVEL;
+    sample.tileId = sample.isTileData ? subdevice_id : -1;
+    sample.value = value;
+    sample.scale = scale;
+    if (!ring.push(sample)) {
+        dropped++;
+    }
+}
+
+void BurstSamplingSession::samplePower(uint64_t timestamp) {
+    auto p_cur = collect(DeviceCapability::METRIC_POWER);
+    if (p_cur == nullptr) {
+        return;
+    }
+    auto p_pre = p_pre_power;
+    p_pre_power = p_cur;
+    if (p_pre == nullptr) {
+        return;
+    }
+    // energy in uJ * scale over microseconds, the power is in W * scale
+    auto rate = [](uint64_t pre, uint64_t pre_time, uint64_t cur, uint64_t cur_time, uint64_t& value) {
+        const uint64_t invalid = std::numeric_limits<uint64_t>::max();
+        if (pre == invalid || cur == invalid || pre > cur || cur_time <= pre_time) {
+            return false;
+        }
+        value = (cur - pre) / (cur_time - pre_time);
+        return true;
+    };
+    uint32_t scale = p_cur->getScale();
+    uint64_t value;
+    if (p_cur->hasRawDataOnDevice() && p_pre->hasRawDataOnDevice() &&
+        rate(p_pre->getRawdata(), p_pre->getRawTimestamp(), p_cur->getRawdata(), p_cur->getRawTimestamp(), value)) {
+        push(timestamp, XPUM_STATS_POWER, DEVICE_LEVEL, value, scale);
+    }
+    if (!p_cur->hasSubdeviceRawData() || !p_pre->hasSubdeviceRawData()) {
+        return;
+    }
+    auto p_pre_subs = p_pre->getSubdeviceRawDatas();
+    for (auto& sub : *p_cur->getSubdeviceRawDatas()) {
+        auto pre_iter = p_pre_subs->find(sub.first);
+        if (pre_iter != p_pre_subs->end() &&
+            rate(pre_iter->second.raw_data, pre_iter->second.raw_timestamp, sub.second.raw_data, sub.second.raw_timestamp, value)) {
+            push(timestamp, XPUM_STATS_POWER, sub.first, value, scale);
+        }
+    }
+}
+
+void BurstSamplingSession::sampleFrequency(uint64_t timestamp) {
+    auto p_cur = collect(DeviceCapability::METRIC_FREQUENCY);
+    if (p_cur == nullptr) {
+        return;
+    }
+    uint32_t scale = p_cur->getScale();
+    if (p_cur->hasDataOnDevice()) {
+        push(timestamp, XPUM_STATS_GPU_FREQUENCY, DEVICE_LEVEL, p_cur->getCurrent(), scale);
+    }
+    if (p_cur->hasSubdeviceData()) {
+        for (auto& sub : *p_cur->getSubdeviceDatas()) {
+            if (sub.second.current != std::numeric_limits<uint64_t>::max()) {
+                push(timestamp, XPUM_STATS_GPU_FREQUENCY, sub.first, sub.second.current, scale);
+            }
+        }
+    }
+}
+
+void BurstSamplingSession::sampleGPUUtilization(uint64_t timestamp) {
+    auto p_cur = collect(DeviceCapability::METRIC_COMPUTATION);
+    if (p_cur == nullptr) {
+        return;
+    }
+    auto p_pre = p_pre_utilization;
+    p_pre_utilization = p_cur;
+    if (p_pre == nullptr || p_cur->getExtendedDatas() == nullptr || p_pre->getExtendedDatas() == nullptr) {
+        return;
+    }
+    uint32_t scale = Configuration::DEFAULT_MEASUREMENT_DATA_SCALE;
+    auto p_pre_datas = p_pre->getExtendedDatas();
+    std::map<uint32_t, std::pair<uint64_t, uint32_t>> tiles;
+    bool device_level = false;
+    for (auto& engine : *p_cur->getExtendedDatas()) {
+        auto pre_iter = p_pre_datas->find(engine.first);
+        if (pre_iter == p_pre_datas->end()) {
+            continue;
+        }
+        auto& pre = pre_iter->second;
+        auto& cur = engine.second;
+        if (cur.timestamp <= pre.timestamp || cur.active_time < pre.active_time) {
+            continue;
+        }
+        uint64_t value = (cur.active_time - pre.active_time) * 100 * scale / (cur.timestamp - pre.timestamp);
+        if (value > 100 * scale) {
+            value = 100 * scale;
+        }
+        if (cur.on_subdevice) {
+            push(timestamp, XPUM_STATS_GPU_UTILIZATION, cur.subdevice_id, value, scale);
+            tiles[cur.subdevice_id].first += value;
+            tiles[cur.subdevice_id].second++;
+        } else {
+            push(timestamp, XPUM_STATS_GPU_UTILIZATION, DEVICE_LEVEL, value, scale);
+            device_level = true;
+        }
+    }
+    // without a device level engine group, the device is the average of its tiles
+    if (!device_level && !tiles.empty()) {
+        uint64_t sum = 0;
+        for (auto& tile : tiles) {
+            sum += tile.second.first / tile.second.second;
+        }
+        push(timestamp, XPUM_STATS_GPU_UTILIZATION, DEVICE_LEVEL, sum / tiles.size(), scale);
+    }
+}
+
+BurstSampler::BurstSampler(std::shared_ptr<DeviceManagerInterface>& p_device_manager)
+    : p_device_manager(p_device_manager) {
+}
+
+BurstSampler::~BurstSampler() {
+    close();
+}
+
+xpum_result_t BurstSampler::start(xpum_device_id_t deviceId, const std::vector<xpum_stats_type_t>& metrics,
+                                  uint32_t interval, uint32_t duration) {
+    if (interval < Configuration::BURST_SAMPLING_MIN_INTERVAL || duration == 0 ||
+        duration > Configuration::BURST_SAMPLING_MAX_DURATION || interval > duration) {
+        return XPUM_INTERVAL_INVALID;
+    }
+    auto p_device = p_device_manager->getDevice(std::to_string(deviceId));
+    if (p_device == nullptr) {
+        return XPUM_RESULT_DEVICE_NOT_FOUND;
+    }
+    if (metrics.empty()) {
+        return XPUM_METRIC_NOT_SUPPORTED;
+    }
+    for (auto type : metrics) {
+        DeviceCapability capability;
+        if (!capabilityFromBurstMetric(type, capability) || !p_device->hasCapability(capability)) {
+            return XPUM_METRIC_NOT_SUPPORTED;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iter = sessions.find(deviceId);
+    if (iter != sessions.end()) {
+        if (iter->second->isRunning()) {
+            return XPUM_RESULT_BURST_SAMPLING_RUNNING;
+        }
+        sessions.erase(iter);
+    }
+    auto p_session = std::make_shared<BurstSamplingSession>(p_device, metrics, interval, duration);
+    p_session->start();
+    sessions[deviceId] = p_session;
+    return XPUM_OK;
+}
+
+xpum_result_t BurstSampler::getSamples(xpum_device_id_t deviceId, xpum_burst_sample_t samples[], uint32_t* count,
+                                       bool* running, uint64_t* dropped) {
+    std::shared_ptr<BurstSamplingSession> p_session;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto iter = sessions.find(deviceId);
+        if (iter == sessions.end()) {
+            return XPUM_RESULT_BURST_SAMPLING_NOT_FOUND;
+        }
+        p_session = iter->second;
+    }
+    // read the state before the samples, so no sample is missed when the caller stops on !running
+    bool is_running = p_session->isRunning();
+    if (samples == nullptr) {
+        *count = p_session->getPendingCount();
+    } else {
+        *count = p_session->takeSamples(samples, *count);
+    }
+    if (running != nullptr) {
+        *running = is_running;
+    }
+    if (dropped != nullptr) {
+        *dropped = p_session->getDropped();
+    }
+    return XPUM_OK;
+}
+
+xpum_result_t BurstSampler::stop(xpum_device_id_t deviceId) {
+    std::shared_ptr<BurstSamplingSession> p_session;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto iter = sessions.find(deviceId);
+        if (iter == sessions.end()) {
+            return XPUM_RESULT_BURST_SAMPLING_NOT_FOUND;
+        }
+        p_session = iter->second;
+        sessions.erase(iter);
+    }
+    p_session->stop();
+    return XPUM_OK;
+}
+
+void BurstSampler::close() {
+    std::map<xpum_device_id_t, std::shared_ptr<BurstSamplingSession>> closing;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing.swap(sessions);
+    }
+    for (auto& session : closing) {
+        session.second->stop();
+    }
+}
+
+} // end namespace xpum
@@ -0,0 +1,129 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file burst_sampler.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "burst_ring_buffer.h"
+#include "control/device_manager_interface.h"
+#include "device/device.h"
+#include "infrastructure/measurement_data.h"
+#include "xpum_structs.h"
+
+namespace xpum {
+
+/*
+  BurstSamplingSession samples a few metrics of one device at a short
+  interval on its own thread, for a bounded duration. The samples are pushed
+  to a lock-free ring buffer sized for the whole duration, so a slow reader
+  never delays sampling.
+*/
+
+class BurstSamplingSession {
+   public:
+    BurstSamplingSession(std::shared_ptr<Device> p_device,
+                         const std::vector<xpum_stats_type_t>& metrics,
+                         uint32_t interval,
+                         uint32_t duration);
+
+    ~BurstSamplingSession();
+
+    void start();
+
+    void stop();
+
+    bool isRunning() const { return running.load(); }
+
+    uint64_t getDropped() const { return dropped.load(); }
+
+    size_t getPendingCount() const { return ring.size(); }
+
+    size_t takeSamples(xpum_burst_sample_t samples[], size_t count);
+
+   private:
+    void run();
+
+    void sample(uint64_t timestamp);
+
+    void samplePower(uint64_t timestamp);
+
+    void sampleFrequency(uint64_t timestamp);
+
+    void sampleGPUUtilization(uint64_t timestamp);
+
+    std::shared_ptr<MeasurementData> collect(DeviceCapability capability);
+
+    void push(uint64_t timestamp, xpum_stats_type_t type, uint32_t subdevice_id, uint64_t value, uint32_t scale);
+
+   private:
+    std::shared_ptr<Device> p_device;
+
+    std::vector<xpum_stats_type_t> metrics;
+
+    uint32_t interval;
+
+    uint32_t duration;
+
+    BurstRingBuffer<xpum_burst_sample_t> ring;
+
+    std::atomic<uint64_t> dropped;
+
+    std::atomic<bool> running;
+
+    bool stop_requested;
+
+    std::mutex mutex;
+
+    std::condition_variable cv;
+
+    // serializes readers, the sampling thread is the only producer
+    std::mutex consumer_mutex;
+
+    std::thread worker;
+
+    // the previous counters, power and utilization are derived from two samples
+    std::shared_ptr<MeasurementData> p_pre_power;
+
+    std::shared_ptr<MeasurementData> p_pre_utilization;
+};
+
+/*
+  BurstSampler keeps at most one burst sampling session per device. A
+  finished session stays until its samples are read or it is stopped.
+*/
+
+class BurstSampler {
+   public:
+    explicit BurstSampler(std::shared_ptr<DeviceManagerInterface>& p_device_manager);
+
+    ~BurstSampler();
+
+    xpum_result_t start(xpum_device_id_t deviceId, const std::vector<xpum_stats_type_t>& metrics,
+                        uint32_t interval, uint32_t duration);
+
+    xpum_result_t getSamples(xpum_device_id_t deviceId, xpum_burst_sample_t samples[], uint32_t* count,
+                             bool* running, uint64_t* dropped);
+
+    xpum_result_t stop(xpum_device_id_t deviceId);
+
+    void close();
+
+   private:
+    std::shared_ptr<DeviceManagerInterface> p_device_manager;
+
+    std::map<xpum_device_id_t, std::shared_ptr<BurstSamplingSession>> sessions;
+
+    std::mutex mutex;
+};
+
+} // end namespace xpum
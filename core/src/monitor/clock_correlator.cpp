@@ -0,0 +1,247 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file clock_correlator.cpp
+ */
+
+#include "clock_correlator.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "infrastructure/handle_lock.h"
+#include "infrastructure/logger.h"
+#include "infrastructure/utility.h"
+
+namespace xpum {
+
+const uint32_t ClockCorrelator::REFRESH_INTERVAL;
+
+const uint32_t ClockCorrelator::WINDOW;
+
+static uint64_t readClock(clockid_t clock_id) {
+    struct timespec ts;
+    if (clock_gettime(clock_id, &ts) != 0) {
+        return 0;
+    }
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// the device timer between two reads of CLOCK_MONOTONIC, called with the handle lock held
+static ze_result_t readGlobalTimestamps(ze_device_handle_t device, uint64_t& device_ticks, uint64_t& before, uint64_t& after) {
+    uint64_t host_ticks = 0;
+    before = readClock(CLOCK_MONOTONIC);
+    ze_result_t ret = zeDeviceGetGlobalTimestamps(device, &host_ticks, &device_ticks);
+    after = readClock(CLOCK_MONOTONIC);
+    return ret;
+}
+
+// the signed distance from ticks to other on a timer that wraps at mask + 1
+static int64_t tickDistance(uint64_t ticks, uint64_t other, uint64_t mask) {
+    if (mask == UINT64_MAX) {
+        return (int64_t)(other - ticks);
+    }
+    uint64_t d = (other - ticks) & mask;
+    return d > mask / 2 ? -(int64_t)(mask - d + 1) : (int64_t)d;
+}
+
+ClockCorrelator::ClockCorrelator(std::shared_ptr<DeviceManagerInterface>& p_device_manager)
+    : p_device_manager(p_device_manager), p_task(nullptr) {
+}
+
+void ClockCorrelator::start(std::shared_ptr<ScheduledThreadPool>& p_thread_pool) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    if (p_task != nullptr) {
+        return;
+    }
+    p_task = p_thread_pool->scheduleAtFixedRate(0, REFRESH_INTERVAL, -1, [this]() { refresh(); });
+}
+
+void ClockCorrelator::stop() {
+    std::shared_ptr<ScheduledThreadPoolTask> task;
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        task.swap(p_task);
+    }
+    // a refresh in progress holds the mutex
+    if (task != nullptr) {
+        task->cancel();
+    }
+}
+
+void ClockCorrelator::refresh() {
+    std::vector<std::shared_ptr<Device>> devices;
+    p_device_manager->getDeviceList(devices);
+    std::unique_lock<std::mutex> lock(this->mutex);
+    for (auto& p_device : devices) {
+        auto& clock = clocks[std::stoi(p_device->getId())];
+        clock.handle = p_device->getDeviceZeHandle();
+        if (!clock.failed) {
+            sample(clock);
+        }
+    }
+}
+
+bool ClockCorrelator::sample(DeviceClock& clock) {
+    if (clock.handle == nullptr) {
+        return false;
+    }
+    ze_result_t ret;
+    if (!clock.timer_read) {
+        ze_device_properties_t props = {};
+        props.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES_1_2;
+        XPUM_ZE_HANDLE_SHARED_LOCK(clock.handle, ret = zeDeviceGetProperties(clock.handle, &props));
+        if (ret != ZE_RESULT_SUCCESS) {
+            clock.failed = true;
+            return false;
+        }
+        // the resolution is in cycles per second with this structure type, and in ns before 1.2
+        if (props.timerResolution > 0) {
+            clock.ns_per_tick = 1000000000.0 / props.timerResolution;
+        } else {
+            props.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            XPUM_ZE_HANDLE_SHARED_LOCK(clock.handle, ret = zeDeviceGetProperties(clock.handle, &props));
+            clock.ns_per_tick = (ret == ZE_RESULT_SUCCESS && props.timerResolution > 0) ? props.timerResolution : 1;
+        }
+        clock.valid_bits = (props.timestampValidBits == 0 || props.timestampValidBits >= 64) ? 64 : props.timestampValidBits;
+        clock.mask = clock.valid_bits == 64 ? UINT64_MAX : (1ULL << clock.valid_bits) - 1;
+        clock.timer_read = true;
+    }
+
+    uint64_t ticks = 0, before = 0, after = 0;
+    XPUM_ZE_HANDLE_SHARED_LOCK(clock.handle, ret = readGlobalTimestamps(clock.handle, ticks, before, after));
+    if (ret != ZE_RESULT_SUCCESS || before == 0 || after < before) {
+        if (clock.samples.empty()) {
+            XPUM_LOG_INFO("The timer of the device can not be read with the host clock, zeDeviceGetGlobalTimestamps returned {}", ret);
+            clock.failed = true;
+        }
+        return false;
+    }
+    uint64_t realtime = readClock(CLOCK_REALTIME);
+    uint64_t monotonic = before + (after - before) / 2;
+    ticks &= clock.mask;
+
+    if (!clock.samples.empty()) {
+        // a gap of half the wrap period or more can not be unwrapped, the model starts over
+        double wrap_ns = clock.valid_bits == 64 ? INFINITY : std::ldexp(clock.ns_per_tick, clock.valid_bits);
+        if ((double)(monotonic - clock.samples.back().monotonic_ns) >= wrap_ns / 2) {
+            clock.samples.clear();
+        }
+    }
+    if (clock.samples.empty()) {
+        clock.unwrapped_ticks = ticks;
+    } else {
+        clock.unwrapped_ticks += (ticks - clock.last_ticks) & clock.mask;
+    }
+    clock.last_ticks = ticks;
+    clock.realtime_offset = (int64_t)(realtime - after);
+    clock.update_time = Utility::getCurrentMillisecond();
+    clock.samples.push_back(Sample{clock.unwrapped_ticks, monotonic, (after - before) / 2});
+    while (clock.samples.size() > WINDOW) {
+        clock.samples.pop_front();
+    }
+    fit(clock);
+    return true;
+}
+
+void ClockCorrelator::fit(DeviceClock& clock) {
+    // the sums are taken relative to the latest sample, the doubles keep ns precision over the window
+    auto& latest = clock.samples.back();
+    double n = (double)clock.samples.size();
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    uint64_t min_uncertainty = latest.uncertainty_ns;
+    for (auto& s : clock.samples) {
+        double x = -(double)(latest.device_ticks - s.device_ticks) * clock.ns_per_tick;
+        double y = -(double)(latest.monotonic_ns - s.monotonic_ns);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        min_uncertainty = std::min(min_uncertainty, s.uncertainty_ns);
+    }
+    double denominator = n * sxx - sx * sx;
+    if (clock.samples.size() < 2 || denominator <= 0) {
+        clock.slope = 1;
+        clock.intercept = 0;
+        clock.error_ns = latest.uncertainty_ns;
+        return;
+    }
+    clock.slope = (n * sxy - sx * sy) / denominator;
+    clock.intercept = (sy - clock.slope * sx) / n;
+    double residuals = 0;
+    for (auto& s : clock.samples) {
+        double x = -(double)(latest.device_ticks - s.device_ticks) * clock.ns_per_tick;
+        double y = -(double)(latest.monotonic_ns - s.monotonic_ns);
+        double r = y - (clock.intercept + clock.slope * x);
+        residuals += r * r;
+    }
+    // the scatter of the samples around the line, and the best read of the host clock
+    clock.error_ns = (uint64_t)std::sqrt(residuals / n) + min_uncertainty;
+}
+
+ClockCorrelator::DeviceClock* ClockCorrelator::getClock(xpum_device_id_t deviceId, xpum_result_t& res) {
+    auto p_device = p_device_manager->getDevice(std::to_string(deviceId));
+    if (p_device == nullptr) {
+        res = XPUM_RESULT_DEVICE_NOT_FOUND;
+        return nullptr;
+    }
+    auto& clock = clocks[deviceId];
+    if (clock.samples.empty() && !clock.failed) {
+        // queried before the first refresh
+        clock.handle = p_device->getDeviceZeHandle();
+        sample(clock);
+    }
+    if (clock.samples.empty()) {
+        res = XPUM_RESULT_CLOCK_NOT_CORRELATED;
+        return nullptr;
+    }
+    res = XPUM_OK;
+    return &clock;
+}
+
+xpum_result_t ClockCorrelator::getCorrelation(xpum_device_id_t deviceId, xpum_clock_correlation_t* correlation) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    xpum_result_t res;
+    auto p_clock = getClock(deviceId, res);
+    if (p_clock == nullptr) {
+        return res;
+    }
+    auto& latest = p_clock->samples.back();
+    correlation->deviceId = deviceId;
+    correlation->deviceTimestamp = p_clock->last_ticks;
+    correlation->monotonicTimestamp = (uint64_t)((int64_t)latest.monotonic_ns + (int64_t)std::llround(p_clock->intercept));
+    correlation->realtimeTimestamp = (uint64_t)((int64_t)correlation->monotonicTimestamp + p_clock->realtime_offset);
+    correlation->nsPerTick = p_clock->ns_per_tick;
+    correlation->driftPpm = (p_clock->slope - 1) * 1e6;
+    correlation->errorNs = p_clock->error_ns;
+    correlation->validBits = p_clock->valid_bits;
+    correlation->sampleCount = (uint32_t)p_clock->samples.size();
+    correlation->updateTime = p_clock->update_time;
+    return XPUM_OK;
+}
+
+xpum_result_t ClockCorrelator::convert(xpum_device_id_t deviceId, uint64_t deviceTimestamp, xpum_clock_domain_t domain, uint64_t* hostTimestamp) {
+    if (domain != XPUM_CLOCK_DOMAIN_MONOTONIC && domain != XPUM_CLOCK_DOMAIN_REALTIME) {
+        return XPUM_GENERIC_ERROR;
+    }
+    std::unique_lock<std::mutex> lock(this->mutex);
+    xpum_result_t res;
+    auto p_clock = getClock(deviceId, res);
+    if (p_clock == nullptr) {
+        return res;
+    }
+    int64_t ticks = tickDistance(p_clock->last_ticks, deviceTimestamp & p_clock->mask, p_clock->mask);
+    double ns = p_clock->intercept + p_clock->slope * (double)ticks * p_clock->ns_per_tick;
+    int64_t host = (int64_t)p_clock->samples.back().monotonic_ns + (int64_t)std::llround(ns);
+    if (domain == XPUM_CLOCK_DOMAIN_REALTIME) {
+        host += p_clock->realtime_offset;
+    }
+    *hostTimestamp = host < 0 ? 0 : (uint64_t)host;
+    return XPUM_OK;
+}
+
+} // end namespace xpum
@@ -0,0 +1,99 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file clock_correlator.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "control/device_manager_interface.h"
+#include "infrastructure/scheduled_thread_pool.h"
+#include "level_zero/ze_api.h"
+#include "xpum_structs.h"
+
+namespace xpum {
+
+/*
+  ClockCorrelator models the timer of each device against the host clocks.
+  Every REFRESH_INTERVAL ms the device timer is read by
+  zeDeviceGetGlobalTimestamps between two reads of CLOCK_MONOTONIC, the
+  midpoint of the host reads is taken as the host time of the device
+  timestamp and half their distance as its error. A line is fitted by least
+  squares to the latest WINDOW samples, its intercept is the offset and its
+  slope the drift of the device timer.
+
+  CLOCK_REALTIME is the CLOCK_MONOTONIC of the model plus their difference
+  at the latest sample, so a step of the wall clock takes effect on the next
+  refresh.
+*/
+class ClockCorrelator {
+   public:
+    static const uint32_t REFRESH_INTERVAL = 1000;
+
+    static const uint32_t WINDOW = 64;
+
+    explicit ClockCorrelator(std::shared_ptr<DeviceManagerInterface>& p_device_manager);
+
+    void start(std::shared_ptr<ScheduledThreadPool>& p_thread_pool);
+
+    void stop();
+
+    xpum_result_t getCorrelation(xpum_device_id_t deviceId, xpum_clock_correlation_t* correlation);
+
+    xpum_result_t convert(xpum_device_id_t deviceId, uint64_t deviceTimestamp, xpum_clock_domain_t domain, uint64_t* hostTimestamp);
+
+   private:
+    struct Sample {
+        // the device timer unwrapped
+        uint64_t device_ticks;
+        uint64_t monotonic_ns;
+        uint64_t uncertainty_ns;
+    };
+
+    struct DeviceClock {
+        ze_device_handle_t handle = nullptr;
+        bool timer_read = false;
+        bool failed = false;
+        double ns_per_tick = 1;
+        uint32_t valid_bits = 64;
+        uint64_t mask = UINT64_MAX;
+        // the raw device timer of the latest sample and its unwrapped ticks
+        uint64_t last_ticks = 0;
+        uint64_t unwrapped_ticks = 0;
+        // CLOCK_REALTIME minus CLOCK_MONOTONIC at the latest sample
+        int64_t realtime_offset = 0;
+        uint64_t update_time = 0;
+        std::deque<Sample> samples;
+        // the fitted line relative to the latest sample: the host ns after its CLOCK_MONOTONIC
+        // are intercept + slope * the nominal device ns after its ticks
+        double intercept = 0;
+        double slope = 1;
+        uint64_t error_ns = 0;
+    };
+
+    void refresh();
+
+    // read the timer of the device together with the host clocks, false if it can not be read
+    bool sample(DeviceClock& clock);
+
+    void fit(DeviceClock& clock);
+
+    // the clock of the device sampled at least once, nullptr if the device is not found or can not be read
+    DeviceClock* getClock(xpum_device_id_t deviceId, xpum_result_t& res);
+
+    std::shared_ptr<DeviceManagerInterface> p_device_manager;
+
+    std::shared_ptr<ScheduledThreadPoolTask> p_task;
+
+    std::map<xpum_device_id_t, DeviceClock> clocks;
+
+    std::mutex mutex;
+};
+
+} // end namespace xpum
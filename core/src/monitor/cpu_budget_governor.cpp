@@ -0,0 +1,194 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file cpu_budget_governor.cpp
+ */
+
+#include "cpu_budget_governor.h"
+
+#include <dirent.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/internal_stats.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+const uint32_t CpuBudgetGovernor::STRETCH_FACTOR;
+
+const uint32_t CpuBudgetGovernor::RELAX_INTERVALS;
+
+const uint32_t CpuBudgetGovernor::RELAX_RATIO;
+
+// the names of the steps by level, XPUM_INTERNAL_STATS_CPU_BUDGET_CUT keys them by pointer
+static const char* cut_names[] = {
+    nullptr,
+    "low priority metrics",
+    "monitor interval",
+    "perf metric streaming",
+};
+
+static uint64_t processCpuNs() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+CpuBudgetGovernor::CpuBudgetGovernor(ApplyFunc apply)
+    : apply(apply), p_task(nullptr), level(LEVEL_NONE), relax_intervals(0), last_process_ns(0) {
+}
+
+void CpuBudgetGovernor::start(std::shared_ptr<ScheduledThreadPool>& p_thread_pool) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    if (p_task != nullptr) {
+        return;
+    }
+    std::map<const char*, uint64_t> group_ns;
+    readThreadTimes(group_ns);
+    last_process_ns = processCpuNs();
+    last_time = std::chrono::steady_clock::now();
+    uint32_t interval = Configuration::CPU_BUDGET_INTERVAL * 1000;
+    p_task = p_thread_pool->scheduleAtFixedRate(interval, interval, -1, [this]() { check(); });
+    XPUM_LOG_INFO("CPU budget of xpumd: {}% of one core", Configuration::CPU_BUDGET);
+}
+
+void CpuBudgetGovernor::stop() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    if (p_task != nullptr) {
+        p_task->cancel();
+        p_task = nullptr;
+    }
+}
+
+CpuBudgetGovernor::Level CpuBudgetGovernor::getLevel() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    return level;
+}
+
+const char* CpuBudgetGovernor::groupOf(const std::string& thread_name) {
+    // the names given by ThreadFactory, and the threads of gRPC and its executors
+    if (thread_name.compare(0, 12, "xpum-monitor") == 0) {
+        return "monitor";
+    }
+    if (thread_name.compare(0, 9, "xpum-lane") == 0) {
+        return "device lane";
+    }
+    if (thread_name.compare(0, 9, "xpum-pcie") == 0) {
+        return "pcie";
+    }
+    if (thread_name.compare(0, 10, "xpum-burst") == 0) {
+        return "burst sampling";
+    }
+    if (thread_name.compare(0, 11, "xpum-worker") == 0) {
+        return "worker pool";
+    }
+    if (thread_name.compare(0, 4, "grpc") == 0 || thread_name.find("execut") != std::string::npos) {
+        return "grpc";
+    }
+    return "other";
+}
+
+void CpuBudgetGovernor::readThreadTimes(std::map<const char*, uint64_t>& group_ns) {
+    static const uint64_t ns_per_tick = 1000000000ULL / (uint64_t)sysconf(_SC_CLK_TCK);
+    DIR* dir = opendir("/proc/self/task");
+    if (dir == nullptr) {
+        return;
+    }
+    std::map<int, uint64_t> thread_ns;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+            continue;
+        }
+        std::ifstream file(std::string("/proc/self/task/") + entry->d_name + "/stat");
+        std::string stat;
+        if (!std::getline(file, stat)) {
+            continue;
+        }
+        // the name may hold spaces and parentheses, the fields after it start at the last ')'
+        auto name_begin = stat.find('(');
+        auto name_end = stat.rfind(')');
+        if (name_begin == std::string::npos || name_end == std::string::npos || name_end < name_begin) {
+            continue;
+        }
+        std::istringstream fields(stat.substr(name_end + 2));
+        std::string field;
+        uint64_t utime = 0, stime = 0;
+        // state is the 3rd field of the line, utime the 14th and stime the 15th
+        for (int i = 3; i <= 15 && fields >> field; i++) {
+            if (i == 14) {
+                utime = std::stoull(field);
+            } else if (i == 15) {
+                stime = std::stoull(field);
+            }
+        }
+        int tid = std::atoi(entry->d_name);
+        uint64_t ns = (utime + stime) * ns_per_tick;
+        thread_ns[tid] = ns;
+        auto last = last_thread_ns.find(tid);
+        uint64_t previous = last != last_thread_ns.end() && last->second <= ns ? last->second : 0;
+        group_ns[groupOf(stat.substr(name_begin + 1, name_end - name_begin - 1))] += ns - previous;
+    }
+    closedir(dir);
+    last_thread_ns.swap(thread_ns);
+}
+
+void CpuBudgetGovernor::check() {
+    Level applied;
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        if (p_task == nullptr) {
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        uint64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_time).count();
+        uint64_t process_ns = processCpuNs();
+        uint64_t used_ns = process_ns > last_process_ns ? process_ns - last_process_ns : 0;
+        last_time = now;
+        last_process_ns = process_ns;
+        std::map<const char*, uint64_t> group_ns;
+        readThreadTimes(group_ns);
+        InternalStats::instance().record(XPUM_INTERNAL_STATS_CPU_TIME, "total", -1, used_ns);
+        for (auto& group : group_ns) {
+            InternalStats::instance().record(XPUM_INTERNAL_STATS_CPU_TIME, group.first, -1, group.second);
+        }
+
+        uint64_t budget_ns = (uint64_t)(elapsed_ns * Configuration::CPU_BUDGET / 100);
+        applied = level;
+        if (used_ns > budget_ns) {
+            relax_intervals = 0;
+            if (level < LEVEL_MAX) {
+                level = (Level)(level + 1);
+                InternalStats::instance().recordError(XPUM_INTERNAL_STATS_CPU_BUDGET_CUT, cut_names[level], -1);
+                XPUM_LOG_WARN("xpumd used {} ms of CPU time in {} ms, over its budget of {}%, {} is cut",
+                              used_ns / 1000000, elapsed_ns / 1000000, Configuration::CPU_BUDGET, cut_names[level]);
+            }
+        } else if (level > LEVEL_NONE && used_ns * 100 < budget_ns * RELAX_RATIO) {
+            if (++relax_intervals >= RELAX_INTERVALS) {
+                relax_intervals = 0;
+                XPUM_LOG_INFO("xpumd is back within its CPU budget, {} is restored", cut_names[level]);
+                level = (Level)(level - 1);
+            }
+        } else {
+            relax_intervals = 0;
+        }
+        for (int cut = LEVEL_SHED_LOW_PRIORITY; cut <= level; cut++) {
+            InternalStats::instance().record(XPUM_INTERNAL_STATS_CPU_BUDGET_CUT, cut_names[cut], -1, elapsed_ns);
+        }
+        if (applied == level) {
+            return;
+        }
+        applied = level;
+    }
+    apply(applied);
+}
+
+} // end namespace xpum
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file cpu_budget_governor.h
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "infrastructure/scheduled_thread_pool.h"
+
+namespace xpum {
+
+/*
+  CpuBudgetGovernor keeps the CPU time of xpumd within CPU_BUDGET percent of
+  one core. Every CPU_BUDGET_INTERVAL seconds the CPU time of the process is
+  compared to the budget, an interval over the budget cuts one more step of
+  the sampling, in this order:
+
+    1. the metrics of MetricPriority::LOW are not sampled
+    2. the monitor period is stretched to STRETCH_FACTOR times
+    3. the metrics of MetricPriority::STREAMING are not sampled
+
+  A step is restored after RELAX_INTERVALS intervals in a row below
+  RELAX_RATIO percent of the budget. The CPU time of each interval is
+  recorded as XPUM_INTERNAL_STATS_CPU_TIME, in total and by the named thread
+  groups, and each active cut as XPUM_INTERNAL_STATS_CPU_BUDGET_CUT.
+*/
+class CpuBudgetGovernor {
+   public:
+    enum Level {
+        LEVEL_NONE,
+        LEVEL_SHED_LOW_PRIORITY,
+        LEVEL_STRETCH_INTERVAL,
+        LEVEL_STOP_STREAMING,
+        LEVEL_MAX = LEVEL_STOP_STREAMING,
+    };
+
+    // stays within ThrottleReasonDataHandler::MAX_GAP_FACTOR, a longer period would read as gaps in the sampling
+    static const uint32_t STRETCH_FACTOR = 2;
+
+    static const uint32_t RELAX_INTERVALS = 3;
+
+    static const uint32_t RELAX_RATIO = 50;
+
+    typedef std::function<void(Level level)> ApplyFunc;
+
+    explicit CpuBudgetGovernor(ApplyFunc apply);
+
+    void start(std::shared_ptr<ScheduledThreadPool>& p_thread_pool);
+
+    void stop();
+
+    Level getLevel();
+
+   private:
+    // the CPU time of each thread group since the previous check, in nanoseconds
+    void readThreadTimes(std::map<const char*, uint64_t>& group_ns);
+
+    static const char* groupOf(const std::string& thread_name);
+
+    void check();
+
+    ApplyFunc apply;
+
+    std::shared_ptr<ScheduledThreadPoolTask> p_task;
+
+    Level level;
+
+    uint32_t relax_intervals;
+
+    std::chrono::steady_clock::time_point last_time;
+
+    uint64_t last_process_ns;
+
+    // the CPU time of each thread by thread ID, the threads that exited are only in the total
+    std::map<int, uint64_t> last_thread_ns;
+
+    std::mutex mutex;
+};
+
+} // end namespace xpum
@@ -0,0 +1,112 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file device_lanes.cpp
+ */
+
+#include "device_lanes.h"
+
+#include <thread>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/logger.h"
+#include "infrastructure/thread_factory.h"
+#include "topology/topology.h"
+
+namespace xpum {
+
+DeviceLanes& DeviceLanes::instance() {
+    static DeviceLanes lanes;
+    return lanes;
+}
+
+DeviceLanes::~DeviceLanes() {
+    // a thread stuck in a call can not be joined, the threads hold their lane and exit on their own
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& entry : lanes) {
+        std::lock_guard<std::mutex> lane_lock(entry.second->mutex);
+        entry.second->stop = true;
+        entry.second->cv.notify_all();
+    }
+}
+
+std::shared_ptr<DeviceLanes::Lane> DeviceLanes::getLane(const std::string& device_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& p_lane = lanes[device_id];
+    if (p_lane == nullptr) {
+        p_lane = std::make_shared<Lane>();
+    }
+    return p_lane;
+}
+
+void DeviceLanes::submit(const std::shared_ptr<Device>& p_device, std::function<void()> job) {
+    auto p_lane = getLane(p_device->getId());
+    std::lock_guard<std::mutex> lock(p_lane->mutex);
+    p_lane->jobs.push_back(std::move(job));
+    if (p_lane->idle > 0) {
+        p_lane->cv.notify_one();
+        return;
+    }
+    if (p_lane->threads >= MAX_LANE_THREADS) {
+        return;
+    }
+    if (p_lane->threads == 0 && Configuration::MONITOR_BIND_THREADS) {
+        Property prop;
+        if (p_device->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS, prop)) {
+            p_lane->bdf = prop.getValue();
+        }
+    }
+    p_lane->threads++;
+    ThreadFactory::create("xpum-lane", [p_lane]() { work(p_lane); }).detach();
+}
+
+void DeviceLanes::work(std::shared_ptr<Lane> p_lane) {
+    if (!p_lane->bdf.empty()) {
+        Topology::bindThreadToDevice(p_lane->bdf);
+    }
+    std::unique_lock<std::mutex> lock(p_lane->mutex);
+    while (true) {
+        p_lane->idle++;
+        p_lane->cv.wait(lock, [&]() { return p_lane->stop || !p_lane->jobs.empty(); });
+        p_lane->idle--;
+        if (p_lane->stop) {
+            break;
+        }
+        auto job = std::move(p_lane->jobs.front());
+        p_lane->jobs.pop_front();
+        lock.unlock();
+        try {
+            job();
+        } catch (std::exception& e) {
+            XPUM_LOG_ERROR("Failed to execute device lane job: {}", e.what());
+        } catch (...) {
+            XPUM_LOG_ERROR("Failed to execute device lane job: unexpected exception");
+        }
+        lock.lock();
+    }
+    p_lane->threads--;
+}
+
+void DeviceLanes::degrade(const std::string& device_id, const char* task_name) {
+    auto p_lane = getLane(device_id);
+    std::lock_guard<std::mutex> lock(p_lane->mutex);
+    if (p_lane->degraded_tasks++ == 0) {
+        XPUM_LOG_WARN("Device {} is degraded, {} missed its deadline", device_id, task_name);
+    }
+}
+
+void DeviceLanes::recover(const std::string& device_id, const char* task_name) {
+    auto p_lane = getLane(device_id);
+    std::lock_guard<std::mutex> lock(p_lane->mutex);
+    if (p_lane->degraded_tasks > 0 && --p_lane->degraded_tasks == 0) {
+        XPUM_LOG_INFO("Device {} is sampled on time again, {} recovered last", device_id, task_name);
+    }
+}
+
+bool DeviceLanes::isDegraded(const std::string& device_id) {
+    auto p_lane = getLane(device_id);
+    std::lock_guard<std::mutex> lock(p_lane->mutex);
+    return p_lane->degraded_tasks > 0;
+}
+
+} // end namespace xpum
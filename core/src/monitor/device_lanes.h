@@ -0,0 +1,78 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file device_lanes.h
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "device/device.h"
+
+namespace xpum {
+
+/*
+  DeviceLanes runs the collection of each device in threads of its own, a
+  lane per device. A device whose Level Zero calls hang holds up the threads
+  of its lane only, the other devices are sampled on time. A lane starts a
+  thread when a job finds none idle, up to MAX_LANE_THREADS, the jobs beyond
+  wait in the lane.
+
+  The lanes also keep the watchdog state: a device is degraded while the
+  collection of any monitor task on it is overdue or backing off.
+*/
+class DeviceLanes {
+   public:
+    static const uint32_t MAX_LANE_THREADS = 4;
+
+    static DeviceLanes& instance();
+
+    void submit(const std::shared_ptr<Device>& p_device, std::function<void()> job);
+
+    // the collection of a monitor task on the device missed its deadline, the task calls it once per stall
+    void degrade(const std::string& device_id, const char* task_name);
+
+    // a monitor task that missed a deadline on the device collected it on time again
+    void recover(const std::string& device_id, const char* task_name);
+
+    bool isDegraded(const std::string& device_id);
+
+   private:
+    struct Lane {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::function<void()>> jobs;
+        uint32_t threads = 0;
+        uint32_t idle = 0;
+        bool stop = false;
+        std::string bdf;
+        // the monitor tasks overdue or backing off on the device
+        uint32_t degraded_tasks = 0;
+    };
+
+    DeviceLanes() = default;
+
+    ~DeviceLanes();
+
+    DeviceLanes(const DeviceLanes&) = delete;
+
+    DeviceLanes& operator=(const DeviceLanes&) = delete;
+
+    std::shared_ptr<Lane> getLane(const std::string& device_id);
+
+    static void work(std::shared_ptr<Lane> p_lane);
+
+    std::mutex mutex;
+
+    std::map<std::string, std::shared_ptr<Lane>> lanes;
+};
+
+} // end namespace xpum
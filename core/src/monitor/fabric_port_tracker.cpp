@@ -0,0 +1,160 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file fabric_port_tracker.cpp
+ */
+
+#include "fabric_port_tracker.h"
+
+#include "device/gpu/device_event_listener.h"
+#include "device/gpu/gpu_device_stub.h"
+#include "event/event_bus.h"
+#include "event/events.h"
+#include "infrastructure/logger.h"
+#include "infrastructure/utility.h"
+
+namespace xpum {
+
+const uint32_t FabricPortTracker::REFRESH_INTERVAL;
+
+static bool samePort(const zes_fabric_port_id_t& port, const zes_fabric_port_id_t& other) {
+    return port.fabricId == other.fabricId && port.attachId == other.attachId && port.portNumber == other.portNumber;
+}
+
+FabricPortTracker::FabricPortTracker(std::shared_ptr<DeviceManagerInterface>& p_device_manager)
+    : p_device_manager(p_device_manager), p_thread_pool(nullptr), p_task(nullptr), event_subscription(-1), last_full_refresh(0) {
+}
+
+void FabricPortTracker::start(std::shared_ptr<ScheduledThreadPool>& p_thread_pool) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    if (p_task != nullptr) {
+        return;
+    }
+    this->p_thread_pool = p_thread_pool;
+    p_task = p_thread_pool->scheduleAtFixedRate(0, REFRESH_INTERVAL, -1, [this]() { refresh(); });
+    lock.unlock();
+
+    std::vector<std::shared_ptr<Device>> device_list;
+    p_device_manager->getDeviceList(device_list);
+    int subscription = DeviceEventListener::instance().subscribe(device_list, ZES_EVENT_TYPE_FLAG_FABRIC_PORT_HEALTH,
+        [this](const std::string& deviceId, zes_event_type_flags_t events) {
+            requestRefresh(deviceId);
+        });
+    lock.lock();
+    event_subscription = subscription;
+}
+
+void FabricPortTracker::stop() {
+    int subscription;
+    std::shared_ptr<ScheduledThreadPoolTask> task;
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        subscription = event_subscription;
+        event_subscription = -1;
+        task.swap(p_task);
+        p_thread_pool = nullptr;
+    }
+    if (subscription >= 0) {
+        DeviceEventListener::instance().unsubscribe(subscription);
+    }
+    if (task != nullptr) {
+        task->cancel();
+    }
+}
+
+void FabricPortTracker::requestRefresh(const std::string& deviceId) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    if (p_task == nullptr) {
+        return;
+    }
+    pending.insert(deviceId);
+    p_thread_pool->reschedule(p_task, 0, REFRESH_INTERVAL);
+}
+
+void FabricPortTracker::refresh() {
+    uint64_t now = Utility::getCurrentMillisecond();
+    std::set<std::string> targets;
+    bool full = false;
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        // a run brought forward by an event soon after the last full refresh only reads the devices of the events
+        full = now - last_full_refresh >= REFRESH_INTERVAL / 2;
+        if (full) {
+            last_full_refresh = now;
+        }
+        targets.swap(pending);
+    }
+    std::vector<std::shared_ptr<Device>> device_list;
+    p_device_manager->getDeviceList(device_list);
+    for (auto& p_device : device_list) {
+        if (full || targets.find(p_device->getId()) != targets.end()) {
+            refreshDevice(p_device);
+        }
+    }
+}
+
+void FabricPortTracker::refreshDevice(const std::shared_ptr<Device>& p_device) {
+    std::vector<port_info> ports;
+    bool has_ports = GPUDeviceStub::getFabricPorts(p_device->getDeviceHandle(), ports);
+    uint64_t now = Utility::getCurrentMillisecond();
+    std::vector<FabricPortEvent> events;
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        auto& entry = devices[p_device->getId()];
+        if (entry.update_time != 0) {
+            for (auto& port : ports) {
+                for (auto& old : entry.ports) {
+                    if (!samePort(port.portProps.portId, old.portProps.portId)) {
+                        continue;
+                    }
+                    if (port.portState.status != old.portState.status) {
+                        FabricPortEvent event;
+                        event.deviceId = std::stoi(p_device->getId());
+                        event.portId = port.portProps.portId;
+                        event.status = port.portState.status;
+                        event.previousStatus = old.portState.status;
+                        event.timestamp = now;
+                        events.push_back(event);
+                    }
+                    break;
+                }
+            }
+            if (!events.empty()) {
+                entry.change_time = now;
+            }
+        }
+        entry.has_ports = has_ports;
+        entry.ports.swap(ports);
+        entry.update_time = now;
+    }
+    for (auto& event : events) {
+        XPUM_LOG_INFO("Fabric port {}.{}.{} of device {} changes status from {} to {}", event.portId.fabricId, event.portId.attachId,
+                      (int)event.portId.portNumber, event.deviceId, event.previousStatus, event.status);
+        EventBus<FabricPortEvent>::instance().publish(event);
+    }
+}
+
+bool FabricPortTracker::getPorts(const std::string& deviceId, std::vector<port_info>& portInfo) {
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        auto it = devices.find(deviceId);
+        if (p_task != nullptr && it != devices.end()) {
+            portInfo.insert(portInfo.end(), it->second.ports.begin(), it->second.ports.end());
+            return it->second.has_ports;
+        }
+    }
+    // not started or the device is not read yet
+    auto p_device = p_device_manager->getDevice(deviceId);
+    if (p_device == nullptr) {
+        return false;
+    }
+    return GPUDeviceStub::getFabricPorts(p_device->getDeviceHandle(), portInfo);
+}
+
+uint64_t FabricPortTracker::getChangeTime(const std::string& deviceId) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    auto it = devices.find(deviceId);
+    return it != devices.end() ? it->second.change_time : 0;
+}
+
+} // end namespace xpum
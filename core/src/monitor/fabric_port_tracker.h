@@ -0,0 +1,81 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file fabric_port_tracker.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "control/device_manager_interface.h"
+#include "infrastructure/scheduled_thread_pool.h"
+#include "topology/xe_link.h"
+
+namespace xpum {
+
+/*
+  FabricPortTracker keeps the properties, state, config and link type of the
+  fabric ports of each device. They are read every REFRESH_INTERVAL ms and,
+  for a device, as soon as the driver sends a fabric port health event of it,
+  so the queries of the ports and of their health are answered from the
+  latest read. A FabricPortEvent is published for each port whose status
+  differs from the read before.
+*/
+class FabricPortTracker {
+   public:
+    static const uint32_t REFRESH_INTERVAL = 10000;
+
+    explicit FabricPortTracker(std::shared_ptr<DeviceManagerInterface>& p_device_manager);
+
+    void start(std::shared_ptr<ScheduledThreadPool>& p_thread_pool);
+
+    void stop();
+
+    // the ports of the latest read, read now if the tracker is not started; false if the device has no ports
+    bool getPorts(const std::string& deviceId, std::vector<port_info>& portInfo);
+
+    // read the ports of the device on the next run of the task, after they are configured
+    void requestRefresh(const std::string& deviceId);
+
+    // the time in milliseconds the status of a port of the device was last seen changed, 0 if never
+    uint64_t getChangeTime(const std::string& deviceId);
+
+   private:
+    struct DevicePorts {
+        bool has_ports = false;
+        std::vector<port_info> ports;
+        uint64_t update_time = 0;
+        uint64_t change_time = 0;
+    };
+
+    void refresh();
+
+    // read the ports of the device and publish the changes of their status, called without the mutex
+    void refreshDevice(const std::shared_ptr<Device>& p_device);
+
+    std::shared_ptr<DeviceManagerInterface> p_device_manager;
+
+    std::shared_ptr<ScheduledThreadPool> p_thread_pool;
+
+    std::shared_ptr<ScheduledThreadPoolTask> p_task;
+
+    int event_subscription;
+
+    std::map<std::string, DevicePorts> devices;
+
+    // the devices with a fabric port event since their last read
+    std::set<std::string> pending;
+
+    uint64_t last_full_refresh;
+
+    std::mutex mutex;
+};
+
+} // end namespace xpum
@@ -7,12 +7,17 @@
 #include "monitor_manager.h"
 
 #include <algorithm>
+#include <chrono>
 #include <set>
+#include <thread>
 
 #include "core/core.h"
 #include "infrastructure/configuration.h"
 #include "infrastructure/device_capability.h"
+#include "device/gpu/device_event_listener.h"
+#include "device/gpu/gpu_device_stub.h"
 #include "infrastructure/logger.h"
+#include "infrastructure/metric_descriptor.h"
 #include "infrastructure/utility.h"
 #include "monitor_task.h"
 
@@ -20,9 +25,13 @@ namespace xpum {
 
 MonitorManager::MonitorManager(std::shared_ptr<DeviceManagerInterface>& p_device_manager,
                                std::shared_ptr<DataLogicInterface>& p_data_logic)
-    : p_device_manager(p_device_manager), p_data_logic(p_data_logic) {
+    : p_device_manager(p_device_manager), p_data_logic(p_data_logic), event_subscription(-1), frequency_stretch(1) {
     XPUM_LOG_TRACE("MonitorManager()");
     p_scheduled_thread_pool = std::make_shared<ScheduledThreadPool>(16);
+    p_burst_sampler = std::make_shared<BurstSampler>(this->p_device_manager);
+    p_clock_correlator = std::make_shared<ClockCorrelator>(this->p_device_manager);
+    p_fabric_port_tracker = std::make_shared<FabricPortTracker>(this->p_device_manager);
+    p_adaptive_sampling_policy = std::make_shared<AdaptiveSamplingPolicy>();
 }
 
 MonitorManager::~MonitorManager() {
@@ -39,7 +48,7 @@ void MonitorManager::init() {
 
     createMonitorTasks(MeasurementType::METRIC_MAX);
 
-    for (uint64_t session = 0; session < Configuration::MAX_STATISTICS_SESSION_NUM; session++) {
+    for (uint64_t session = 0; session < Configuration::DEFAULT_STATISTICS_SESSION_NUM; session++) {
         std::vector<std::shared_ptr<Device>> devices;
         Core::instance().getDeviceManager()->getDeviceList(devices);
         for (auto device : devices) {
@@ -49,12 +58,65 @@ void MonitorManager::init() {
         }
     }
 
+    if (AdaptiveSamplingPolicy::isEventDriven(DeviceCapability::METRIC_RAS_ERROR)) {
+        subscribeRasEvents();
+    }
+
     for (auto& p_task : tasks) {
         p_task->start(this->p_scheduled_thread_pool);
     }
+
+    if (Configuration::CPU_BUDGET > 0 && Configuration::getXPUMMode() != "xpu-smi") {
+        p_cpu_budget_governor = std::make_shared<CpuBudgetGovernor>([this](CpuBudgetGovernor::Level level) {
+            applyCpuBudgetLevel(level);
+        });
+        p_cpu_budget_governor->start(this->p_scheduled_thread_pool);
+    }
+
+    // xpu-smi converts on demand, a correlation is sampled on the first query
+    if (Configuration::getXPUMMode() != "xpu-smi") {
+        p_clock_correlator->start(this->p_scheduled_thread_pool);
+    }
+
+    // xpu-smi reads the fabric ports on each query
+    if (Configuration::getXPUMMode() != "xpu-smi") {
+        p_fabric_port_tracker->start(this->p_scheduled_thread_pool);
+    }
+}
+
+void MonitorManager::subscribeRasEvents() {
+    const zes_event_type_flags_t ras_events = ZES_EVENT_TYPE_FLAG_RAS_CORRECTABLE_ERRORS | ZES_EVENT_TYPE_FLAG_RAS_UNCORRECTABLE_ERRORS;
+    std::vector<std::shared_ptr<Device>> devices;
+    p_device_manager->getDeviceList(devices);
+    std::weak_ptr<AdaptiveSamplingPolicy> weak_policy = p_adaptive_sampling_policy;
+    event_subscription = DeviceEventListener::instance().subscribe(devices, ras_events,
+        [weak_policy](const std::string& deviceId, zes_event_type_flags_t events) {
+            auto p_policy = weak_policy.lock();
+            if (p_policy != nullptr) {
+                p_policy->notifyEvent(DeviceCapability::METRIC_RAS_ERROR, deviceId);
+            }
+        });
+    // the driver only sends RAS events for the error sets with a threshold
+    for (auto& p_device : devices) {
+        if (DeviceEventListener::instance().isRegistered(p_device->getId(), ras_events) &&
+            GPUDeviceStub::hasRasEventThresholds(p_device->getDeviceHandle())) {
+            p_adaptive_sampling_policy->setEventDriven(DeviceCapability::METRIC_RAS_ERROR, p_device->getId());
+            XPUM_LOG_INFO("RAS errors of device {} are read on RAS events", p_device->getId());
+        }
+    }
 }
 
 void MonitorManager::close() {
+    if (event_subscription >= 0) {
+        DeviceEventListener::instance().unsubscribe(event_subscription);
+        event_subscription = -1;
+    }
+    p_burst_sampler->close();
+    p_clock_correlator->stop();
+    p_fabric_port_tracker->stop();
+    if (p_cpu_budget_governor != nullptr) {
+        p_cpu_budget_governor->stop();
+    }
     std::unique_lock<std::mutex> lock(this->mutex);
     for (auto& p_task : tasks) {
         p_task->stop();
@@ -66,19 +128,37 @@ void MonitorManager::close() {
     }
 }
 
-void MonitorManager::createMonitorTasks(MeasurementType target_type) {
+void MonitorManager::createMonitorTasks(MeasurementType target_type, const std::set<DeviceCapability>& running_caps) {
     auto metric_types = Configuration::getEnabledMetrics();
-    std::set<DeviceCapability> created_caps;
+    std::set<DeviceCapability> created_caps = running_caps;
+    std::vector<DeviceCapability> sweep_caps;
+    bool device_sweep = Configuration::MONITOR_DEVICE_SWEEP && target_type == MeasurementType::METRIC_MAX;
     for (auto& type : metric_types) {
         if (target_type != MeasurementType::METRIC_MAX && type != target_type) {
             continue;
         }
+        if (target_type == MeasurementType::METRIC_MAX && !isSampled(type)) {
+            continue;
+        }
         DeviceCapability capability = Utility::capabilityFromMeasurementType(type);
         if (created_caps.find(capability) == created_caps.end()) {
-            tasks.emplace_back(std::make_shared<MonitorTask>(capability, Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE, p_device_manager, p_data_logic, MonitorTaskType::GPU_METRICS));
+            if (device_sweep) {
+                sweep_caps.push_back(capability);
+            } else {
+                tasks.emplace_back(std::make_shared<MonitorTask>(capability, Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE * frequency_stretch, p_device_manager, p_data_logic, MonitorTaskType::GPU_METRICS));
+            }
             created_caps.emplace(capability);
         }
     }
+    if (!sweep_caps.empty()) {
+        tasks.emplace_back(std::make_shared<MonitorTask>(sweep_caps, Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE * frequency_stretch, p_device_manager, p_data_logic));
+    }
+    // one-time tasks sample every metric exactly once, only periodic tasks adapt
+    if (target_type == MeasurementType::METRIC_MAX) {
+        for (auto& p_task : tasks) {
+            p_task->setAdaptiveSamplingPolicy(p_adaptive_sampling_policy);
+        }
+    }
 }
 
 void MonitorManager::resetMetricTasksFrequency() {
@@ -89,16 +169,84 @@ void MonitorManager::resetMetricTasksFrequency() {
     }
     
     std::unique_lock<std::mutex> lock(this->mutex);
-    for (auto& p_task : tasks) {
-        p_task->stop();
+    // the governor may still run a check while closing
+    if (p_scheduled_thread_pool == nullptr) {
+        return;
     }
-    tasks.clear();
-    createMonitorTasks(MeasurementType::METRIC_MAX);
+    std::set<DeviceCapability> enabled_caps;
+    for (auto& type : Configuration::getEnabledMetrics()) {
+        if (isSampled(type)) {
+            enabled_caps.insert(Utility::capabilityFromMeasurementType(type));
+        }
+    }
+    std::vector<std::shared_ptr<MonitorTask>> kept;
+    std::set<DeviceCapability> running_caps;
     for (auto& p_task : tasks) {
-        p_task->start(this->p_scheduled_thread_pool);
+        bool keep;
+        if (p_task->getType() == MonitorTaskType::DEVICE_SWEEP) {
+            // a sweep samples a fixed set of capabilities, it is created again if the set changed
+            auto& caps = p_task->getCapabilities();
+            keep = std::set<DeviceCapability>(caps.begin(), caps.end()) == enabled_caps && Configuration::MONITOR_DEVICE_SWEEP;
+            if (keep) {
+                running_caps.insert(caps.begin(), caps.end());
+            }
+        } else {
+            keep = enabled_caps.find(p_task->getCapability()) != enabled_caps.end() && !Configuration::MONITOR_DEVICE_SWEEP;
+            if (keep) {
+                running_caps.insert(p_task->getCapability());
+            }
+        }
+        if (keep) {
+            p_task->rearm(this->p_scheduled_thread_pool, Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE * frequency_stretch);
+            kept.push_back(p_task);
+        } else {
+            XPUM_LOG_INFO("Monitor task for {} is stopped", p_task->getName());
+            p_task->stop();
+        }
+    }
+    tasks = kept;
+    size_t started = tasks.size();
+    createMonitorTasks(MeasurementType::METRIC_MAX, running_caps);
+    for (size_t i = started; i < tasks.size(); i++) {
+        XPUM_LOG_INFO("Monitor task for {} is started", tasks[i]->getName());
+        tasks[i]->start(this->p_scheduled_thread_pool);
     }
 }
 
+void MonitorManager::setMetricEnabled(MeasurementType type, bool enabled) {
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        if (enabled == (disabled_metrics.find(type) == disabled_metrics.end())) {
+            return;
+        }
+        if (enabled) {
+            disabled_metrics.erase(type);
+        } else {
+            disabled_metrics.insert(type);
+        }
+    }
+    resetMetricTasksFrequency();
+}
+
+bool MonitorManager::isSampled(MeasurementType type) {
+    return disabled_metrics.find(type) == disabled_metrics.end() && shed_metrics.find(type) == shed_metrics.end();
+}
+
+void MonitorManager::applyCpuBudgetLevel(CpuBudgetGovernor::Level level) {
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        shed_metrics.clear();
+        for (auto& descriptor : metric_descriptors) {
+            if ((descriptor.priority == MetricPriority::LOW && level >= CpuBudgetGovernor::LEVEL_SHED_LOW_PRIORITY) ||
+                (descriptor.priority == MetricPriority::STREAMING && level >= CpuBudgetGovernor::LEVEL_STOP_STREAMING)) {
+                shed_metrics.insert(descriptor.type);
+            }
+        }
+        frequency_stretch = level >= CpuBudgetGovernor::LEVEL_STRETCH_INTERVAL ? CpuBudgetGovernor::STRETCH_FACTOR : 1;
+    }
+    resetMetricTasksFrequency();
+}
+
 bool MonitorManager::initOneTimeMetricMonitorTasks(MeasurementType type) {
     char* env = std::getenv("XPUM_DISABLE_PERIODIC_METRIC_MONITOR");
     std::string xpum_disable_periodic_metric_monitor{env != NULL ? env : ""};
@@ -108,7 +256,7 @@ bool MonitorManager::initOneTimeMetricMonitorTasks(MeasurementType type) {
 
         createMonitorTasks(type);
 
-        for (uint64_t session = 0; session < Configuration::MAX_STATISTICS_SESSION_NUM; session++) {
+        for (uint64_t session = 0; session < Configuration::DEFAULT_STATISTICS_SESSION_NUM; session++) {
             std::vector<std::shared_ptr<Device>> devices;
             Core::instance().getDeviceManager()->getDeviceList(devices);
             for (auto device : devices) {
@@ -118,25 +266,65 @@ bool MonitorManager::initOneTimeMetricMonitorTasks(MeasurementType type) {
             }
         }
 
+        // all the capabilities are sampled at once in the calling thread, the counter metrics
+        // take their second sample after one shared window
+        auto sampleAll = [](std::vector<std::shared_ptr<MonitorTask>>& list) {
+            long long now = Utility::getCurrentMillisecond();
+            Utility::parallel_in_batches(list.size(), list.size(), [&](int start, int end) {
+                for (int i = start; i < end; ++i) {
+                    list[i]->sample(now);
+                }
+            });
+        };
+        sampleAll(tasks);
+        std::vector<std::shared_ptr<MonitorTask>> counter_tasks;
         for (auto& p_task : tasks) {
-            p_task->start(this->p_scheduled_thread_pool);
-        }
-
-        int count = 0;
-        while (std::find_if(tasks.begin(), tasks.end(), [&](const auto& it) { return !it->finished(); }) != tasks.end()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            if (++count > 50) {
-                XPUM_LOG_WARN("Timed out while waiting for some monitor metrics.");
-                break;
+            if (p_task->getOneShotSamples() > 1) {
+                counter_tasks.push_back(p_task);
             }
         }
-
-        for (auto& p_task : tasks) {
-            p_task->stop();
+        if (!counter_tasks.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE / 2));
+            sampleAll(counter_tasks);
         }
         tasks.clear();
         return true;
     }
     return false;
 }
+
+xpum_result_t MonitorManager::startBurstSampling(xpum_device_id_t deviceId, const std::vector<xpum_stats_type_t>& metrics,
+                                                 uint32_t interval, uint32_t duration) {
+    return p_burst_sampler->start(deviceId, metrics, interval, duration);
+}
+
+xpum_result_t MonitorManager::getBurstSamples(xpum_device_id_t deviceId, xpum_burst_sample_t samples[], uint32_t* count,
+                                              bool* running, uint64_t* dropped) {
+    return p_burst_sampler->getSamples(deviceId, samples, count, running, dropped);
+}
+
+xpum_result_t MonitorManager::stopBurstSampling(xpum_device_id_t deviceId) {
+    return p_burst_sampler->stop(deviceId);
+}
+
+xpum_result_t MonitorManager::getClockCorrelation(xpum_device_id_t deviceId, xpum_clock_correlation_t* correlation) {
+    return p_clock_correlator->getCorrelation(deviceId, correlation);
+}
+
+xpum_result_t MonitorManager::convertDeviceTimestamp(xpum_device_id_t deviceId, uint64_t deviceTimestamp,
+                                                     xpum_clock_domain_t domain, uint64_t* hostTimestamp) {
+    return p_clock_correlator->convert(deviceId, deviceTimestamp, domain, hostTimestamp);
+}
+
+bool MonitorManager::getFabricPorts(const std::string& deviceId, std::vector<port_info>& portInfo) {
+    return p_fabric_port_tracker->getPorts(deviceId, portInfo);
+}
+
+void MonitorManager::refreshFabricPorts(const std::string& deviceId) {
+    p_fabric_port_tracker->requestRefresh(deviceId);
+}
+
+uint64_t MonitorManager::getFabricPortChangeTime(const std::string& deviceId) {
+    return p_fabric_port_tracker->getChangeTime(deviceId);
+}
 } // end namespace xpum
@@ -6,8 +6,14 @@
 
 #pragma once
 
+#include <set>
 #include <vector>
 
+#include "adaptive_sampling_policy.h"
+#include "burst_sampler.h"
+#include "clock_correlator.h"
+#include "cpu_budget_governor.h"
+#include "fabric_port_tracker.h"
 #include "monitor_manager_interface.h"
 #include "monitor_task.h"
 
@@ -25,12 +31,49 @@ class MonitorManager : public MonitorManagerInterface {
 
     void close() override;
 
+    /*
+      Apply TELEMETRY_DATA_MONITOR_FREQUENCE and the metrics enabled to the
+      periodic tasks in place: the running tasks are re-armed, only the tasks
+      of the metrics disabled are stopped and of the metrics enabled created.
+      The cuts of the CPU budget governor are applied on top.
+    */
     void resetMetricTasksFrequency();
 
+    // enable or disable the periodic sampling of one of the metrics enabled in the configuration
+    void setMetricEnabled(MeasurementType type, bool enabled) override;
+
     bool initOneTimeMetricMonitorTasks(MeasurementType type);
 
+    xpum_result_t startBurstSampling(xpum_device_id_t deviceId, const std::vector<xpum_stats_type_t>& metrics,
+                                     uint32_t interval, uint32_t duration) override;
+
+    xpum_result_t getBurstSamples(xpum_device_id_t deviceId, xpum_burst_sample_t samples[], uint32_t* count,
+                                  bool* running, uint64_t* dropped) override;
+
+    xpum_result_t stopBurstSampling(xpum_device_id_t deviceId) override;
+
+    xpum_result_t getClockCorrelation(xpum_device_id_t deviceId, xpum_clock_correlation_t* correlation) override;
+
+    xpum_result_t convertDeviceTimestamp(xpum_device_id_t deviceId, uint64_t deviceTimestamp,
+                                         xpum_clock_domain_t domain, uint64_t* hostTimestamp) override;
+
+    // the fabric ports of the latest read of FabricPortTracker
+    bool getFabricPorts(const std::string& deviceId, std::vector<port_info>& portInfo) override;
+
+    void refreshFabricPorts(const std::string& deviceId) override;
+
+    uint64_t getFabricPortChangeTime(const std::string& deviceId) override;
+
    private:
-    void createMonitorTasks(MeasurementType target_type);
+    // the metrics not sampled and the period stretch for a level of the CPU budget governor
+    void applyCpuBudgetLevel(CpuBudgetGovernor::Level level);
+
+    bool isSampled(MeasurementType type);
+
+    // the tasks of the enabled metrics not in disabled_metrics, except those of the capabilities in running_caps
+    void createMonitorTasks(MeasurementType target_type, const std::set<DeviceCapability>& running_caps = {});
+
+    void subscribeRasEvents();
 
    private:
     std::shared_ptr<DeviceManagerInterface> p_device_manager;
@@ -41,6 +84,27 @@ class MonitorManager : public MonitorManagerInterface {
 
     std::vector<std::shared_ptr<MonitorTask>> tasks;
 
+    std::shared_ptr<BurstSampler> p_burst_sampler;
+
+    std::shared_ptr<AdaptiveSamplingPolicy> p_adaptive_sampling_policy;
+
+    std::shared_ptr<CpuBudgetGovernor> p_cpu_budget_governor;
+
+    std::shared_ptr<ClockCorrelator> p_clock_correlator;
+
+    std::shared_ptr<FabricPortTracker> p_fabric_port_tracker;
+
+    int event_subscription;
+
+    // the enabled metrics not sampled periodically, set by setMetricEnabled()
+    std::set<MeasurementType> disabled_metrics;
+
+    // the metrics cut by the CPU budget governor, kept apart so the choices of the user are restored
+    std::set<MeasurementType> shed_metrics;
+
+    // the monitor period is stretched to this many times by the CPU budget governor
+    uint32_t frequency_stretch;
+
     std::mutex mutex;
 };
 
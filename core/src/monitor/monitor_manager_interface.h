@@ -6,10 +6,13 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include "infrastructure/init_close_interface.h"
 #include "infrastructure/measurement_type.h"
+#include "topology/xe_link.h"
+#include "xpum_structs.h"
 
 namespace xpum {
 
@@ -17,7 +20,19 @@ class MonitorManagerInterface : public InitCloseInterface {
    public:
     virtual ~MonitorManagerInterface(){};
     virtual void resetMetricTasksFrequency() = 0;
+    virtual void setMetricEnabled(MeasurementType type, bool enabled) = 0;
     virtual bool initOneTimeMetricMonitorTasks(MeasurementType type) = 0;
+    virtual xpum_result_t startBurstSampling(xpum_device_id_t deviceId, const std::vector<xpum_stats_type_t>& metrics,
+                                             uint32_t interval, uint32_t duration) = 0;
+    virtual xpum_result_t getBurstSamples(xpum_device_id_t deviceId, xpum_burst_sample_t samples[], uint32_t* count,
+                                          bool* running, uint64_t* dropped) = 0;
+    virtual xpum_result_t stopBurstSampling(xpum_device_id_t deviceId) = 0;
+    virtual xpum_result_t getClockCorrelation(xpum_device_id_t deviceId, xpum_clock_correlation_t* correlation) = 0;
+    virtual xpum_result_t convertDeviceTimestamp(xpum_device_id_t deviceId, uint64_t deviceTimestamp,
+                                                 xpum_clock_domain_t domain, uint64_t* hostTimestamp) = 0;
+    virtual bool getFabricPorts(const std::string& deviceId, std::vector<port_info>& portInfo) = 0;
+    virtual void refreshFabricPorts(const std::string& deviceId) = 0;
+    virtual uint64_t getFabricPortChangeTime(const std::string& deviceId) = 0;
 };
 
 } // end namespace xpum
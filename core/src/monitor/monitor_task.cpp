@@ -6,18 +6,66 @@
 
 #include "monitor_task.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <limits>
 #include <mutex>
 #include <set>
 #include <thread>
 
 #include "control/device_manager.h"
+#include "device_lanes.h"
 #include "infrastructure/configuration.h"
+#include "infrastructure/internal_stats.h"
 #include "infrastructure/logger.h"
+#include "infrastructure/suspension.h"
 #include "infrastructure/utility.h"
 
 namespace xpum {
 
+// a sampling failure is logged at most once per second from each call site, over all devices
+static const uint32_t log_rate_limit_ms = 1000;
+
+// a device that missed its deadline is tried again after the period of the task, doubled on every miss up to this
+static const long long lane_max_backoff_ms = 60 * 1000;
+
+namespace {
+
+// the collections of one tick in the device lanes
+struct LaneTick {
+    std::mutex mutex;
+    std::condition_variable cv;
+    // the devices whose collection has not returned
+    std::set<std::string> pending;
+    // set when the tick stops waiting, the collections returning later are dropped
+    bool closed = false;
+    std::vector<std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>>> datas_list;
+};
+
+// the collection of one device in a tick, done when the last of its suspended getters is resumed
+struct LaneCollection {
+    // one for the lane job itself, so the collection is not finished before all getters were called
+    std::atomic<int> outstanding{1};
+    std::vector<std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>>> datas_list;
+};
+
+// the slots for the data of all the devices, so the map of a tick is not grown while it is filled
+std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> makeDatas(const std::vector<std::shared_ptr<Device>>& devices) {
+    auto datas = std::make_shared<DeviceIndexMap<std::shared_ptr<MeasurementData>>>();
+    uint32_t slots = 0;
+    for (auto& p_device : devices) {
+        if (p_device->getIndex() != std::numeric_limits<uint32_t>::max()) {
+            slots = std::max(slots, p_device->getIndex() + 1);
+        }
+    }
+    datas->reserve(slots);
+    return datas;
+}
+
+} // namespace
+
 MonitorTask::MonitorTask(
     DeviceCapability capability, int freq,
     std::shared_ptr<DeviceManagerInterface>& p_device_manager,
@@ -47,8 +95,28 @@ MonitorTask::MonitorTask(
     XPUM_LOG_TRACE("MonitorTask(), capability: {}", capability);
 }
 
+MonitorTask::MonitorTask(
+    const std::vector<DeviceCapability>& capabilities, int freq,
+    std::shared_ptr<DeviceManagerInterface>& p_device_manager,
+    std::shared_ptr<DataLogicInterface>& p_data_logic)
+    : capability(capabilities.empty() ? DeviceCapability::DEVICE_CAPABILITY_MAX : capabilities.front()),
+      capabilities(capabilities),
+      freq(freq),
+      p_device_manager(p_device_manager),
+      p_data_logic(p_data_logic),
+      type(MonitorTaskType::DEVICE_SWEEP),
+      p_scheduled_task(nullptr),
+      exe_counter(0) {
+    XPUM_LOG_TRACE("MonitorTask(), device sweep of {} capabilities", capabilities.size());
+}
+
 MonitorTask::~MonitorTask() {
     XPUM_LOG_TRACE("~MonitorTask(), capability: {}", capability);
+    for (auto& entry : lane_states) {
+        if (entry.second.misses > 0) {
+            DeviceLanes::instance().recover(entry.first, getName());
+        }
+    }
 }
 
 void MonitorTask::start(std::shared_ptr<ScheduledThreadPool>& threadPool) {
@@ -57,145 +125,359 @@ void MonitorTask::start(std::shared_ptr<ScheduledThreadPool>& threadPool) {
     int interval = freq;
     int execution_times = -1;
 
-    char* env = std::getenv("XPUM_DISABLE_PERIODIC_METRIC_MONITOR");
-    std::string xpum_disable_periodic_metric_monitor{env != NULL ? env : ""};
-    if (xpum_disable_periodic_metric_monitor == "1") {
-        delay = 0;
-        interval = Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE / 2;
-        if (this->getCapability() == DeviceCapability::METRIC_RAS_ERROR ||
-        this->getCapability() == DeviceCapability::METRIC_MEMORY_USED_UTILIZATION ||
-        this->getCapability() == DeviceCapability::METRIC_FREQUENCY ||
-        this->getCapability() == DeviceCapability::METRIC_TEMPERATURE ||
-        this->getCapability() == DeviceCapability::METRIC_ENERGY ||
-        this->getCapability() == DeviceCapability::METRIC_FREQUENCY_THROTTLE_REASON_GPU) {
-            execution_times = 1;
-        } else {
-            // Currently known types that need to be executed twice as follows
-            // METRIC_ENGINE_UTILIZATION, METRIC_FABRIC_THROUGHPUT and METRIC_POWER
-            // later will move more types from executed twice to executed once
-            execution_times = 2;
-        }
-    }
-
     std::weak_ptr<MonitorTask> this_weak_ptr = shared_from_this();
 
     std::lock_guard<std::mutex> lock(this->mutex);
     p_scheduled_task = threadPool->scheduleAtFixedRate(delay, interval, execution_times, [this_weak_ptr]() {
         auto p_this = this_weak_ptr.lock();
         if (p_this == nullptr) {
-            XPUM_LOG_WARN("this_weak_ptr is nullptr for monitor data");
+            XPUM_LOG_WARN_RATE_LIMITED(log_rate_limit_ms, "this_weak_ptr is nullptr for monitor data");
             return;
         }
 
         long long now = Utility::getCurrentMillisecond();
+        InternalStats::instance().record(XPUM_INTERNAL_STATS_MONITOR_TICK_LATENESS, p_this->getName(), -1, ScheduledThreadPoolTask::getCurrentLateness());
 
-        std::vector<std::shared_ptr<Device>> devices;
-        p_this->p_device_manager->getDeviceList(p_this->capability, devices);
-        if (devices.size() == 0) {
-            XPUM_LOG_TRACE("no device supports capability: {}", p_this->capability);
-            p_this->exe_counter++;
-            return;
-        }
+        p_this->sample(now);
+        p_this->countRun();
+    });
+
+    XPUM_LOG_TRACE("Monitor task started for {}", this->capability);
+}
+
+void MonitorTask::sample(long long now) {
+    if (type == MonitorTaskType::DEVICE_SWEEP) {
+        sweepDevices(now);
+        return;
+    }
+
+    std::vector<std::shared_ptr<Device>> devices;
+    p_device_manager->getDeviceList(capability, devices);
+    if (devices.size() == 0) {
+        XPUM_LOG_TRACE("no device supports capability: {}", capability);
+        return;
+    }
+
+    if (Configuration::MONITOR_DEVICE_LANES) {
+        std::vector<std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>>> datas_list;
+        collectInLanes(devices, {capability}, now, datas_list);
+        storeData(capability, now, datas_list.front());
+        return;
+    }
+
+    auto datas = makeDatas(devices);
+
+    // devices are sampled in parallel so that a slow device does not delay the others
+    Utility::parallel_in_batches(devices.size(), devices.size(), [&](int start, int end){
+    for (int i = start; i < end; ++i) {
+        collectData(capability, devices[i], datas);
+    }
+    });
+
+    storeData(capability, now, datas);
+}
+
+static bool needsOneSample(DeviceCapability capability) {
+    return capability == DeviceCapability::METRIC_RAS_ERROR ||
+           capability == DeviceCapability::METRIC_MEMORY_USED_UTILIZATION ||
+           capability == DeviceCapability::METRIC_FREQUENCY ||
+           capability == DeviceCapability::METRIC_TEMPERATURE ||
+           capability == DeviceCapability::METRIC_ENERGY ||
+           capability == DeviceCapability::METRIC_FREQUENCY_THROTTLE_REASON_GPU;
+}
 
-        auto datas = std::make_shared<std::map<std::string, std::shared_ptr<MeasurementData>>>();
+int MonitorTask::getOneShotSamples() {
+    // the metrics computed from counters, like METRIC_ENGINE_UTILIZATION, METRIC_FABRIC_THROUGHPUT
+    // and METRIC_POWER, need two samples
+    if (type == MonitorTaskType::DEVICE_SWEEP) {
+        return std::all_of(capabilities.begin(), capabilities.end(), needsOneSample) ? 1 : 2;
+    }
+    return needsOneSample(capability) ? 1 : 2;
+}
 
-        bool use_multithreading = false;
-        if(p_this->getCapability() == DeviceCapability::METRIC_MEMORY_USED_UTILIZATION){
-            use_multithreading = true;
+bool MonitorTask::collectData(DeviceCapability capability, std::shared_ptr<Device>& p_device,
+                              std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>>& datas,
+                              const std::function<void()>& on_resumed) {
+    // the data of the devices are kept by their dense index, every discovered device has one
+    if (p_device->getIndex() == std::numeric_limits<uint32_t>::max()) {
+        return true;
+    }
+    // a sweep task reports the errors of every capability of a device separately
+    std::string log_key = type == MonitorTaskType::DEVICE_SWEEP ? p_device->getId() + ":" + std::to_string(static_cast<int>(capability)) : p_device->getId();
+    bool sampled_by_policy = AdaptiveSamplingPolicy::isAdaptive(capability) || AdaptiveSamplingPolicy::isEventDriven(capability);
+    auto p_policy = sampled_by_policy ? p_adaptive_sampling_policy : nullptr;
+    if (p_policy != nullptr) {
+        auto p_skipped = p_policy->skipSample(capability, p_device->getId());
+        if (p_skipped != nullptr) {
+            // the copy of the last sample is stamped with the time of the tick
+            p_skipped->setTimestamp(0);
+            std::lock_guard<std::mutex> lock(callback_mutex);
+            (*datas)[p_device->getIndex()] = p_skipped;
+            return true;
+        }
+    }
+    std::weak_ptr<MonitorTask> this_weak_ptr = shared_from_this();
+    auto method = Device::getDeviceMethod(capability, p_device.get());
+    int32_t device_id = InternalStats::toDeviceId(p_device->getId());
+    const char* capability_name = Utility::getCapabilityName(capability);
+    // the device methods run in this thread, the Level Zero calls are accounted to the device
+    InternalStats::DeviceScope device_scope(device_id);
+    auto begin = std::chrono::steady_clock::now();
+    Callback_t handle = [p_device, this_weak_ptr, datas, log_key, capability, p_policy, device_id, capability_name](std::shared_ptr<void> ret, std::shared_ptr<BaseException> e) {
+        auto p_this = this_weak_ptr.lock();
+        if (p_this == nullptr) {
+            return;
+        }
+        auto p_mdata = std::static_pointer_cast<MeasurementData>(ret);
+        // the sample is stamped when it is read, the devices of a tick are read one after another
+        if (p_mdata != nullptr && p_mdata->getTimestamp() == 0) {
+            p_mdata->setTimestamp(Utility::getCurrentMillisecond());
+        }
+        if (e != nullptr || (p_mdata != nullptr && !p_mdata->getErrors().empty())) {
+            InternalStats::instance().recordError(XPUM_INTERNAL_STATS_MONITOR_COLLECT, capability_name, device_id);
+        }
+        std::lock_guard<std::mutex> lock(p_this->callback_mutex);
+        if (e == nullptr && ret != nullptr) {
+            if (p_policy != nullptr) {
+                p_policy->update(capability, p_device->getId(), p_mdata);
+            }
+            (*datas)[p_device->getIndex()] = p_mdata;
+            if (p_mdata->getErrors().empty()) {
+                // everything is ok, no error messages reported in executing the underlying task, clear the log reported flag
+                p_this->monitor_task_log_status[log_key] = false;
+            } else {
+                // errors happened in executing the underlying task though partial data has been collected successfully, log the error if it has not been logged before
+                if (!p_this->monitor_task_log_status[log_key]) {
+                    XPUM_LOG_WARN_RATE_LIMITED(log_rate_limit_ms, "partial monitoring failure: {}", p_mdata->getErrors());
+                    p_this->monitor_task_log_status[log_key] = true;
+                }
+            }
+        } else if (e != nullptr) {
+            // errors happened in executing the underlying task, log the error if it has not been logged before
+            if (!p_this->monitor_task_log_status[log_key]) {
+                XPUM_LOG_WARN_RATE_LIMITED(log_rate_limit_ms, "monitoring failure: {}", e->what());
+                p_this->monitor_task_log_status[log_key] = true;
+            }
+        }
+    };
+    bool done = true;
+    method([&](std::shared_ptr<void> ret, std::shared_ptr<BaseException> e) {
+        auto p_suspended = on_resumed != nullptr ? SuspendScope::take() : nullptr;
+        if (p_suspended == nullptr || p_suspended.get() != ret.get()) {
+            handle(ret, e);
+            return;
         }
+        // the getter waits for a window, the rest of it runs in the resume executor
+        done = false;
+        ResumeExecutor::instance().schedule(p_suspended->resume_at, [handle, p_suspended, on_resumed, device_id]() {
+            InternalStats::DeviceScope device_scope(device_id);
+            try {
+                handle(std::static_pointer_cast<void>(p_suspended->resume()), nullptr);
+            } catch (std::exception& e) {
+                handle(nullptr, std::make_shared<BaseException>(e.what()));
+            }
+            on_resumed();
+        });
+    });
+    InternalStats::instance().record(XPUM_INTERNAL_STATS_MONITOR_COLLECT, capability_name, device_id,
+                                     std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+    return done;
+}
 
-        Utility::parallel_in_batches(devices.size(), devices.size(), [&](int start, int end){
-        for (int i = start; i < end; ++i) {
-            auto& p_device = devices[i];
-            DeviceCapability capability = p_this->capability;
-            auto method = Device::getDeviceMethod(capability, p_device.get());
-            method([p_device, this_weak_ptr, datas, capability](
-                       std::shared_ptr<void> ret, std::shared_ptr<BaseException> e) {
-                auto p_this = this_weak_ptr.lock();
-                if (p_this == nullptr) {
-                    return;
+void MonitorTask::storeData(DeviceCapability capability, long long now,
+                            std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>>& datas) {
+    // the metrics derived by the getters, filled in one pass over the devices, per type
+    std::map<MeasurementType, std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>>> additional_datas;
+    std::vector<SubdeviceAdditionalData_t> device_additional_datas;
+    for (auto& data : (*datas)) {
+        if (data.second->getSubdeviceAdditionalDataSize() == 0) {
+            continue;
+        }
+        data.second->takeSubdeviceAdditionalDatas(device_additional_datas);
+        for (auto& additional : device_additional_datas) {
+            auto& type_datas = additional_datas[additional.type];
+            if (type_datas == nullptr) {
+                type_datas = std::make_shared<DeviceIndexMap<std::shared_ptr<MeasurementData>>>();
+            }
+            auto& mData = (*type_datas)[data.first];
+            if (mData == nullptr) {
+                mData = std::make_shared<MeasurementData>();
+                mData->setTimestamp(data.second->getTimestamp());
+            }
+            auto& sData = additional.data;
+            mData->setScale(sData.scale);
+            if (additional.subdevice_id == UINT32_MAX) {
+                if (!sData.is_raw_data) {
+                    mData->setCurrent(sData.current);
+                } else {
+                    mData->setRawData(sData.raw_data);
+                    mData->setRawTimestamp(sData.raw_timestamp);
                 }
-                std::lock_guard<std::mutex> lock(p_this->callback_mutex);
-                if (e == nullptr && ret != nullptr) {
-                    std::string id = p_device->getId();
-                    auto p_mdata = std::static_pointer_cast<MeasurementData>(ret);
-                    (*datas)[id] = p_mdata;
-                    if (p_mdata->getErrors().empty()) {
-                        // everything is ok, no error messages reported in executing the underlying task, clear the log reported flag
-                        p_this->monitor_task_log_status[p_device->getId()] = false;
-                    } else {
-                        // errors happened in executing the underlying task though partial data has been collected successfully, log the error if it has not been logged before
-                        if (!p_this->monitor_task_log_status[p_device->getId()]) {
-                            XPUM_LOG_WARN("partial monitoring failure: {}", p_mdata->getErrors());
-                            p_this->monitor_task_log_status[p_device->getId()] = true;
-                        }
-                    }
-                } else if (e != nullptr) {
-                    // errors happened in executing the underlying task, log the error if it has not been logged before
-                    if (!p_this->monitor_task_log_status[p_device->getId()]) {
-                        XPUM_LOG_WARN("monitoring failure: {}", e->what());
-                        p_this->monitor_task_log_status[p_device->getId()] = true;
+            } else {
+                if (!sData.is_raw_data) {
+                    mData->setSubdeviceDataCurrent(additional.subdevice_id, sData.current);
+                } else {
+                    mData->setSubdeviceRawData(additional.subdevice_id, sData.raw_data);
+                    mData->setSubdeviceDataRawTimestamp(additional.subdevice_id, sData.raw_timestamp);
+                }
+            }
+        }
+    }
+    auto begin = std::chrono::steady_clock::now();
+    MeasurementType measurmentType = Utility::measurementTypeFromCapability(capability);
+    XPUM_LOG_TRACE("Monitor passes data {} to datalogic", capability);
+    p_data_logic->storeMeasurementData(measurmentType, now, datas);
+    for (auto& type_datas : additional_datas) {
+        XPUM_LOG_TRACE("Monitor passes data {} to datalogic", capability);
+        p_data_logic->storeMeasurementData(type_datas.first, now, std::move(type_datas.second));
+    }
+    InternalStats::instance().record(XPUM_INTERNAL_STATS_MONITOR_STORE, Utility::getCapabilityName(capability), -1,
+                                     std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+}
+
+void MonitorTask::sweepDevices(long long now) {
+    std::vector<std::shared_ptr<Device>> devices;
+    p_device_manager->getDeviceList(devices);
+    std::vector<std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>>> datas_list;
+    if (Configuration::MONITOR_DEVICE_LANES) {
+        collectInLanes(devices, capabilities, now, datas_list);
+    } else {
+        for (size_t i = 0; i < capabilities.size(); i++) {
+            datas_list.emplace_back(makeDatas(devices));
+        }
+        // visit each device once and collect all its capabilities back to back,
+        // so the samples of a device are close in time
+        Utility::parallel_in_batches(devices.size(), devices.size(), [&](int start, int end) {
+            for (int d = start; d < end; ++d) {
+                for (size_t i = 0; i < capabilities.size(); i++) {
+                    if (devices[d]->hasCapability(capabilities[i])) {
+                        collectData(capabilities[i], devices[d], datas_list[i]);
                     }
                 }
-            });
-        }
-        }, use_multithreading);
-
-        bool hasSubdeviceAdditionalData = false;
-        std::set<MeasurementType> subdeviceAdditionalDataTypes;
-        // deviceId, subdeviceId, addtionalType, addtionalData
-        std::map<std::string, std::map<uint32_t, std::map<MeasurementType, AdditionalData>>> subdeviceAdditionalCurrentDatasAll;
-        for (auto& data : (*datas)) {
-            if (data.second->getSubdeviceAdditionalDataTypeSize() > 0) {
-                hasSubdeviceAdditionalData = true;
-                subdeviceAdditionalDataTypes = data.second->getSubdeviceAdditionalDataTypes();
-                subdeviceAdditionalCurrentDatasAll[data.first] = data.second->getSubdeviceAdditionalDatas();
-                data.second->clearSubdeviceAdditionalDataTypes();
-                data.second->clearSubdeviceAdditionalData();
             }
+        });
+    }
+    for (size_t i = 0; i < capabilities.size(); i++) {
+        if (!datas_list[i]->empty()) {
+            storeData(capabilities[i], now, datas_list[i]);
         }
-        MeasurementType measurmentType = Utility::measurementTypeFromCapability(p_this->capability);
-        XPUM_LOG_TRACE("Monitor passes data {} to datalogic", p_this->capability);
-        p_this->p_data_logic->storeMeasurementData(measurmentType, now, datas);
-        if (hasSubdeviceAdditionalData) {
-            for (auto& type : subdeviceAdditionalDataTypes) {
-                for (auto& data : (*datas)) {
-                    auto mData = std::make_shared<MeasurementData>();
-                    for (auto& sData : subdeviceAdditionalCurrentDatasAll[data.first]) {
-                        mData->setScale(sData.second[type].scale);
-                        if (sData.first == UINT32_MAX) {
-                            if (!sData.second[type].is_raw_data)
-                                mData->setCurrent(sData.second[type].current);
-                            else {
-                                mData->setRawData(sData.second[type].raw_data);
-                                mData->setRawTimestamp(sData.second[type].raw_timestamp);
+    }
+}
+
+void MonitorTask::collectInLanes(const std::vector<std::shared_ptr<Device>>& devices, const std::vector<DeviceCapability>& capabilities,
+                                 long long now, std::vector<std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>>>& datas_list) {
+    auto p_tick = std::make_shared<LaneTick>();
+    for (size_t i = 0; i < capabilities.size(); i++) {
+        p_tick->datas_list.emplace_back(makeDatas(devices));
+    }
+    std::shared_ptr<MonitorTask> p_this = shared_from_this();
+    for (auto& p_device : devices) {
+        std::string device_id = p_device->getId();
+        if (!acquireLane(device_id, now)) {
+            InternalStats::instance().recordError(XPUM_INTERNAL_STATS_MONITOR_COLLECT, getName(), InternalStats::toDeviceId(device_id));
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(p_tick->mutex);
+            p_tick->pending.insert(device_id);
+        }
+        DeviceLanes::instance().submit(p_device, [p_this, p_tick, p_device, device_id, capabilities]() {
+            // the collection fills its own maps, a late one never touches the maps of the tick
+            auto p_collection = std::make_shared<LaneCollection>();
+            auto finish = [p_this, p_tick, p_collection, device_id, capabilities]() {
+                if (--p_collection->outstanding > 0) {
+                    return;
+                }
+                bool on_time;
+                {
+                    std::lock_guard<std::mutex> lock(p_tick->mutex);
+                    on_time = !p_tick->closed;
+                    if (on_time) {
+                        for (size_t i = 0; i < capabilities.size(); i++) {
+                            for (auto& data : *p_collection->datas_list[i]) {
+                                (*p_tick->datas_list[i])[data.first] = data.second;
                             }
                         }
-                        else {
-                            if (!sData.second[type].is_raw_data)
-                                mData->setSubdeviceDataCurrent(sData.first, sData.second[type].current);
-                            else {
-                                mData->setSubdeviceRawData(sData.first, sData.second[type].raw_data);
-                                mData->setSubdeviceDataRawTimestamp(sData.first, sData.second[type].raw_timestamp);
-                            }
+                        p_tick->pending.erase(device_id);
+                        if (p_tick->pending.empty()) {
+                            p_tick->cv.notify_all();
                         }
                     }
-                    (*datas)[data.first] = mData;
                 }
-                XPUM_LOG_TRACE("Monitor passes data {} to datalogic", p_this->capability);
-                p_this->p_data_logic->storeMeasurementData(type, now, datas);
+                p_this->releaseLane(device_id, on_time);
+            };
+            std::function<void()> on_resumed = finish;
+            std::shared_ptr<Device> p_dev = p_device;
+            // the getters waiting for a sampling window suspend and free the lane
+            SuspendScope suspend_scope;
+            for (size_t i = 0; i < capabilities.size(); i++) {
+                p_collection->datas_list.emplace_back(std::make_shared<DeviceIndexMap<std::shared_ptr<MeasurementData>>>());
+                DeviceCapability capability = capabilities[i];
+                if (p_dev->hasCapability(capability)) {
+                    p_collection->outstanding++;
+                    if (p_this->collectData(capability, p_dev, p_collection->datas_list[i], on_resumed)) {
+                        p_collection->outstanding--;
+                    }
+                }
             }
+            finish();
+        });
+    }
+
+    int deadline = Configuration::MONITOR_DEVICE_DEADLINE > 0 ? Configuration::MONITOR_DEVICE_DEADLINE : freq;
+    std::unique_lock<std::mutex> lock(p_tick->mutex);
+    p_tick->cv.wait_for(lock, std::chrono::milliseconds(deadline), [&]() { return p_tick->pending.empty(); });
+    p_tick->closed = true;
+    // still under the lock of the tick, so a late collection is released after its miss is counted
+    for (auto& device_id : p_tick->pending) {
+        missLane(device_id);
+    }
+    datas_list = p_tick->datas_list;
+}
+
+bool MonitorTask::acquireLane(const std::string& device_id, long long now) {
+    std::lock_guard<std::mutex> lock(lane_mutex);
+    LaneState& state = lane_states[device_id];
+    if (state.busy || now < state.retry_at) {
+        return false;
+    }
+    state.busy = true;
+    return true;
+}
+
+void MonitorTask::releaseLane(const std::string& device_id, bool on_time) {
+    std::lock_guard<std::mutex> lock(lane_mutex);
+    LaneState& state = lane_states[device_id];
+    state.busy = false;
+    if (on_time) {
+        if (state.misses > 0) {
+            state.misses = 0;
+            state.retry_at = 0;
+            DeviceLanes::instance().recover(device_id, getName());
         }
-        p_this->exe_counter++;
-    });
+        return;
+    }
+    long long backoff = std::min((long long)freq << std::min(state.misses, 16u), lane_max_backoff_ms);
+    state.retry_at = Utility::getCurrentMillisecond() + backoff;
+    XPUM_LOG_WARN_RATE_LIMITED(log_rate_limit_ms, "{} on device {} returned late, it is tried again in {}ms", getName(), device_id, backoff);
+}
 
-    XPUM_LOG_TRACE("Monitor task started for {}", this->capability);
+void MonitorTask::missLane(const std::string& device_id) {
+    std::lock_guard<std::mutex> lock(lane_mutex);
+    LaneState& state = lane_states[device_id];
+    if (state.misses++ == 0) {
+        DeviceLanes::instance().degrade(device_id, getName());
+    }
+    InternalStats::instance().recordError(XPUM_INTERNAL_STATS_MONITOR_COLLECT, getName(), InternalStats::toDeviceId(device_id));
 }
 
 void MonitorTask::stop() {
     std::lock_guard<std::mutex> lock(this->mutex);
     if (p_scheduled_task != nullptr) {
         p_scheduled_task->cancel();
+        auto stats = p_scheduled_task->getStats();
+        XPUM_LOG_DEBUG("Monitor task for {} stopped after {} runs, lateness avg: {}us, max: {}us, jitter: {}us",
+                       capability, stats.run_count, stats.avg_lateness, stats.max_lateness, stats.avg_jitter);
         p_scheduled_task = nullptr;
     }
 }
@@ -204,6 +486,29 @@ bool MonitorTask::finished(){
     return exe_counter.load() == p_scheduled_task->getExeTime();
 }
 
+void MonitorTask::countRun() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    exe_counter++;
+    data_cv.notify_all();
+}
+
+void MonitorTask::rearm(std::shared_ptr<ScheduledThreadPool>& threadPool, int freq) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->freq == freq || p_scheduled_task == nullptr) {
+        this->freq = freq;
+        return;
+    }
+    long long now = Utility::getCurrentMillisecond();
+    long delay = freq - now % freq;
+    XPUM_LOG_DEBUG("Monitor task for {} re-armed from {}ms to {}ms", getName(), this->freq, freq);
+    this->freq = freq;
+    threadPool->reschedule(p_scheduled_task, delay, freq);
+}
+
+const std::vector<DeviceCapability>& MonitorTask::getCapabilities() {
+    return capabilities;
+}
+
 DeviceCapability MonitorTask::getCapability() {
     return capability;
 }
@@ -212,4 +517,12 @@ MonitorTaskType MonitorTask::getType() {
     return type;
 }
 
+const char* MonitorTask::getName() {
+    return type == MonitorTaskType::DEVICE_SWEEP ? "DEVICE_SWEEP" : Utility::getCapabilityName(capability);
+}
+
+void MonitorTask::setAdaptiveSamplingPolicy(std::shared_ptr<AdaptiveSamplingPolicy>& p_policy) {
+    p_adaptive_sampling_policy = p_policy;
+}
+
 } // end namespace xpum
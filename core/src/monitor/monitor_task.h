@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "adaptive_sampling_policy.h"
 #include "control/device_manager_interface.h"
 #include "data_logic/data_logic_interface.h"
 #include "infrastructure/device_capability.h"
@@ -16,6 +17,7 @@ namespace xpum {
 enum MonitorTaskType {
     DEFAULT_TELEMETRY = 0,
     GPU_METRICS = 1,
+    DEVICE_SWEEP = 2,
     TASK_TYPE_FORCE_UINT32 = 0x7fffffff
 };
 
@@ -34,6 +36,16 @@ class MonitorTask : public std::enable_shared_from_this<MonitorTask> {
         std::shared_ptr<DataLogicInterface>& p_data_logic,
         MonitorTaskType type);
 
+    /*
+      A device sweep task visits every device once per tick and samples all of
+      the given capabilities it supports back to back.
+    */
+    MonitorTask(
+        const std::vector<DeviceCapability>& capabilities,
+        int freq,
+        std::shared_ptr<DeviceManagerInterface>& p_device_manager,
+        std::shared_ptr<DataLogicInterface>& p_data_logic);
+
     virtual ~MonitorTask();
 
    public:
@@ -41,14 +53,64 @@ class MonitorTask : public std::enable_shared_from_this<MonitorTask> {
 
     void stop();
 
+    /*
+      Re-arm the running task with a new frequency, aligned on its multiples
+      as in start(). The task keeps its state and the data handlers see no
+      gap, the next tick is just moved.
+    */
+    void rearm(std::shared_ptr<ScheduledThreadPool>& p_scheduled_thread_pool, int freq);
+
     DeviceCapability getCapability();
 
+    // the capabilities of a device sweep task
+    const std::vector<DeviceCapability>& getCapabilities();
+
     MonitorTaskType getType();
 
+    // the name of the task in the internal statistics
+    const char* getName();
+
     bool finished();
 
+    // sample the devices once and store the data, in the calling thread
+    void sample(long long now);
+
+    // the samples a one-shot collection takes, two for the metrics computed from counters
+    int getOneShotSamples();
+
+    void setAdaptiveSamplingPolicy(std::shared_ptr<AdaptiveSamplingPolicy>& p_policy);
+
+   private:
+    /*
+      Collect one capability of the device into datas. With on_resumed, a
+      getter may suspend: collectData then returns false and the data is
+      stored by the resume executor, which calls on_resumed after it.
+    */
+    bool collectData(DeviceCapability capability, std::shared_ptr<Device>& p_device,
+                     std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>>& datas,
+                     const std::function<void()>& on_resumed = nullptr);
+
+    void storeData(DeviceCapability capability, long long now,
+                   std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>>& datas);
+
+    void sweepDevices(long long now);
+
+    // collect the capabilities of the devices in their lanes, the tick waits for them up to its deadline
+    void collectInLanes(const std::vector<std::shared_ptr<Device>>& devices, const std::vector<DeviceCapability>& capabilities,
+                        long long now, std::vector<std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>>>& datas_list);
+
+    // false while the last collection of the device is still running or the device backs off
+    bool acquireLane(const std::string& device_id, long long now);
+
+    void releaseLane(const std::string& device_id, bool on_time);
+
+    void missLane(const std::string& device_id);
+
+    void countRun();
+
    private:
     DeviceCapability capability;
+    std::vector<DeviceCapability> capabilities;
     int freq;
     std::mutex mutex;
     std::condition_variable data_cv;
@@ -59,6 +121,17 @@ class MonitorTask : public std::enable_shared_from_this<MonitorTask> {
     std::shared_ptr<ScheduledThreadPoolTask> p_scheduled_task;
     std::atomic<int> exe_counter;
     std::mutex callback_mutex;
+    std::shared_ptr<AdaptiveSamplingPolicy> p_adaptive_sampling_policy;
+
+    // the watchdog state of the devices collected in lanes
+    struct LaneState {
+        bool busy = false;
+        // the deadlines missed in a row, the device is tried again at retry_at
+        uint32_t misses = 0;
+        long long retry_at = 0;
+    };
+    std::mutex lane_mutex;
+    std::map<std::string, LaneState> lane_states;
 };
 
 } // end namespace xpum
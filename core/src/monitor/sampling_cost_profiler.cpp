@@ -0,0 +1,119 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file sampling_cost_profiler.cpp
+ */
+
+#include "sampling_cost_profiler.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <set>
+
+#include "infrastructure/configuration.h"
+#include "infrastructure/internal_stats.h"
+#include "infrastructure/measurement_data.h"
+#include "infrastructure/utility.h"
+
+namespace xpum {
+
+const uint32_t SamplingCostProfiler::MAX_ITERATIONS;
+
+const uint32_t SamplingCostProfiler::INTERVAL_STEP;
+
+static uint64_t threadCpuTime() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+std::vector<DeviceCapability> SamplingCostProfiler::getCapabilities(const std::shared_ptr<Device>& p_device) {
+    std::set<DeviceCapability> capabilities;
+    for (auto type : Configuration::getEnabledMetrics()) {
+        DeviceCapability capability = Utility::capabilityFromMeasurementType(type);
+        // a second metric streamer can not be opened while the monitor has one
+        if (capability == DeviceCapability::METRIC_EU_ACTIVE_STALL_IDLE || capability == DeviceCapability::METRIC_PERF) {
+            continue;
+        }
+        if (p_device->hasCapability(capability) && Device::getDeviceMethod(capability, p_device.get()) != nullptr) {
+            capabilities.insert(capability);
+        }
+    }
+    return std::vector<DeviceCapability>(capabilities.begin(), capabilities.end());
+}
+
+void SamplingCostProfiler::measureCapability(const std::shared_ptr<Device>& p_device, DeviceCapability capability, uint32_t iterations,
+                                             xpum_sampling_cost_t& cost) {
+    auto method = Device::getDeviceMethod(capability, p_device.get());
+    InternalStats::DeviceScope device_scope(InternalStats::toDeviceId(p_device->getId()));
+    InternalStats::CallCost calls;
+    uint64_t latency_sum = 0;
+    uint64_t cpu_sum = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        bool failed = false;
+        InternalStats::CallCostScope cost_scope(calls);
+        // the device methods run the task in the calling thread
+        uint64_t cpu_begin = threadCpuTime();
+        auto begin = std::chrono::steady_clock::now();
+        method([&failed](std::shared_ptr<void> data, std::shared_ptr<BaseException> e) {
+            auto p_data = std::static_pointer_cast<MeasurementData>(data);
+            failed = e != nullptr || p_data == nullptr || !p_data->getErrors().empty();
+        });
+        uint64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+        cpu_sum += threadCpuTime() - cpu_begin;
+        latency_sum += latency;
+        cost.maxLatency = std::max(cost.maxLatency, latency);
+        if (failed) {
+            cost.errorCount++;
+        }
+    }
+    cost.samples = iterations;
+    cost.latency = latency_sum / iterations;
+    cost.cpuTime = cpu_sum / iterations;
+    cost.lockWait = calls.lock_wait_ns / iterations;
+    cost.driverTime = calls.call_ns / iterations;
+    cost.driverCalls = (uint32_t)((calls.calls + iterations / 2) / iterations);
+}
+
+void SamplingCostProfiler::measure(const std::vector<std::shared_ptr<Device>>& devices, uint32_t iterations, double target_overhead,
+                                   std::vector<xpum_sampling_cost_t>& costs) {
+    // the CPU time and the wall time of a sweep of each capability over the devices, in ns
+    std::map<DeviceCapability, std::pair<uint64_t, uint64_t>> sweeps;
+    std::vector<DeviceCapability> capabilities;
+    for (auto& p_device : devices) {
+        for (auto capability : getCapabilities(p_device)) {
+            xpum_sampling_cost_t cost;
+            std::memset(&cost, 0, sizeof(cost));
+            cost.deviceId = std::stoi(p_device->getId());
+            std::strncpy(cost.name, Utility::getCapabilityName(capability), XPUM_MAX_STR_LENGTH - 1);
+            cost.currentInterval = (uint32_t)Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE;
+            measureCapability(p_device, capability, iterations, cost);
+            auto& sweep = sweeps[capability];
+            sweep.first += cost.cpuTime;
+            sweep.second += cost.latency;
+            costs.push_back(cost);
+            capabilities.push_back(capability);
+        }
+    }
+    if (sweeps.empty()) {
+        return;
+    }
+    // the CPU time a capability may use in each ms
+    double share = target_overhead / 100 / sweeps.size();
+    std::map<DeviceCapability, uint32_t> intervals;
+    for (auto& sweep : sweeps) {
+        double interval = std::max(sweep.second.first / 1e6 / share, 2 * sweep.second.second / 1e6);
+        double steps = std::max(std::ceil(interval / INTERVAL_STEP), 1.0);
+        intervals[sweep.first] = (uint32_t)std::min(steps * INTERVAL_STEP, (double)UINT32_MAX);
+    }
+    for (size_t i = 0; i < costs.size(); i++) {
+        costs[i].recommendedInterval = intervals[capabilities[i]];
+    }
+}
+
+} // end namespace xpum
@@ -0,0 +1,50 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file sampling_cost_profiler.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "device/device.h"
+#include "infrastructure/device_capability.h"
+#include "xpum_structs.h"
+
+namespace xpum {
+
+/*
+  SamplingCostProfiler measures what sampling each capability of the monitor
+  costs on this machine: every capability of a device is read back to back
+  in the calling thread, and the wall time, the CPU time of the thread and
+  the handle lock wait and driver time of the Level Zero calls of the reads
+  are averaged. The costs vary a lot between drivers, so the intervals are
+  chosen from them rather than set blind.
+
+  The interval recommended for a capability gives every capability the same
+  share of the target overhead, the CPU time of one core the monitor may
+  use. It is never shorter than twice the time of a sweep of the devices.
+*/
+class SamplingCostProfiler {
+   public:
+    static const uint32_t MAX_ITERATIONS = 1000;
+
+    // the recommended intervals are rounded up to a multiple of it
+    static const uint32_t INTERVAL_STEP = 100;
+
+    // the capabilities of the device measured, those of the enabled metrics the device has
+    static std::vector<DeviceCapability> getCapabilities(const std::shared_ptr<Device>& p_device);
+
+    // the costs of each device and capability, in the order of the devices
+    static void measure(const std::vector<std::shared_ptr<Device>>& devices, uint32_t iterations, double target_overhead,
+                        std::vector<xpum_sampling_cost_t>& costs);
+
+   private:
+    static void measureCapability(const std::shared_ptr<Device>& p_device, DeviceCapability capability, uint32_t iterations,
+                                  xpum_sampling_cost_t& cost);
+};
+
+} // end namespace xpum
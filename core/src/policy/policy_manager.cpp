@@ -7,10 +7,16 @@
 #include "policy_manager.h"
 
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
 #include <mutex>
 #include <thread>
 
+#include "core/core.h"
+#include "device/gpu/device_event_listener.h"
 #include "device/gpu/gpu_device_stub.h"
+#include "diagnostic/precheck.h"
 #include "infrastructure/configuration.h"
 #include "infrastructure/logger.h"
 #include "infrastructure/utility.h"
@@ -84,20 +90,96 @@ PolicyManager::~PolicyManager() {
 }
 
 void PolicyManager::resetCheckFrequency() {
-    this->stop();
-    XPUM_LOG_INFO("PolicyManager::resetCheckFrequency(): stop check with old freq:{}", this->freq);
-    //std::this_thread::sleep_for(std::chrono::milliseconds(old*2));
+    int old = this->freq;
     this->freq = Configuration::TELEMETRY_DATA_MONITOR_FREQUENCE;
-    this->start();
-    XPUM_LOG_INFO("PolicyManager::resetCheckFrequency(): start check with new freq:{}", this->freq);
+    if (this->p_timer == nullptr || this->p_timer->isCanceld()) {
+        this->start();
+    } else {
+        // the running check timer takes the new interval after its current wait
+        this->p_timer->setInterval(this->freq);
+    }
+    XPUM_LOG_INFO("PolicyManager::resetCheckFrequency(): check freq changed from {} to {}", old, this->freq);
+}
+
+bool PolicyManager::hasPolicy(xpum_device_id_t deviceId, xpum_policy_type_t type) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    auto it = policyMap.find(deviceId);
+    if (it == policyMap.end() || it->second == nullptr) {
+        return false;
+    }
+    for (auto& p_policy : *(it->second)) {
+        if (p_policy->type == type) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void PolicyManager::init() {
+    char* env = std::getenv("_XPUM_INIT_SKIP");
+    std::string xpum_init_skip_module_list{env != NULL ? env : ""};
+    if (xpum_init_skip_module_list.find("POLICY") != xpum_init_skip_module_list.npos) {
+        return;
+    }
+    std::weak_ptr<PolicyManager> this_weak_ptr = shared_from_this();
+    p_notifier.reset(new EventDispatcher<PolicyEvent>("policy_notifier", 256, [](const PolicyEvent& event) {
+        if (event.notifyCallBack == nullptr) {
+            return;
+        }
+        xpum_policy_notify_callback_para_t para = event.para;
+        XPUM_LOG_TRACE("PolicyManager::triggerNotification():before do custom notifyCallBack for deviceId={}", para.deviceId);
+        event.notifyCallBack(&para);
+        XPUM_LOG_TRACE("PolicyManager::triggerNotification():after do custom notifyCallBack for deviceId={}", para.deviceId);
+    }));
+    this->listening = true;
+    p_data_logic->addMeasurementListener([this_weak_ptr](MeasurementType type, std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas) {
+        auto p_this = this_weak_ptr.lock();
+        if (p_this == nullptr || !p_this->listening) {
+            return;
+        }
+        p_this->handleMeasurementData(type, datas);
+    });
+    // check the policies on a detach, a reset or RAS errors as the driver reports them,
+    // not at the next sample or timer tick
+    if (Configuration::XPUM_MODE != "xpu-smi") {
+        std::vector<std::shared_ptr<Device>> devices;
+        p_device_manager->getDeviceList(devices);
+        zes_event_type_flags_t events = ZES_EVENT_TYPE_FLAG_DEVICE_DETACH | ZES_EVENT_TYPE_FLAG_DEVICE_RESET_REQUIRED |
+                                        ZES_EVENT_TYPE_FLAG_RAS_CORRECTABLE_ERRORS | ZES_EVENT_TYPE_FLAG_RAS_UNCORRECTABLE_ERRORS |
+                                        ZES_EVENT_TYPE_FLAG_TEMP_CRITICAL;
+        event_subscription = DeviceEventListener::instance().subscribe(devices, events, [this_weak_ptr](const std::string& deviceId, zes_event_type_flags_t events) {
+            auto p_this = this_weak_ptr.lock();
+            if (p_this == nullptr || !p_this->listening) {
+                return;
+            }
+            p_this->handleDeviceEvent(deviceId, events);
+        });
+        precheck_listener = PrecheckManager::addErrorListener([this_weak_ptr](const xpum_precheck_component_info_t& component) {
+            auto p_this = this_weak_ptr.lock();
+            if (p_this == nullptr || !p_this->listening) {
+                return;
+            }
+            p_this->handlePrecheckError(component);
+        });
+    }
     this->start();
 }
 
 void PolicyManager::close() {
+    this->listening = false;
+    if (event_subscription >= 0) {
+        DeviceEventListener::instance().unsubscribe(event_subscription);
+        event_subscription = -1;
+    }
+    if (precheck_listener >= 0) {
+        PrecheckManager::removeErrorListener(precheck_listener);
+        precheck_listener = -1;
+    }
     this->stop();
+    if (p_notifier != nullptr) {
+        p_notifier->stop();
+        p_notifier = nullptr;
+    }
 }
 
 void PolicyManager::stop() {
@@ -141,12 +223,12 @@ void PolicyManager::handleForOneCyle() {
 
 void PolicyManager::checkPolicy() {
     //XPUM_LOG_INFO("---PolicyManager::checkPolicy()---1--");
-    //Go through by key
-    for (auto it = policyMap.begin(); it != policyMap.end(); it = policyMap.upper_bound(it->first)) {
-        auto range = policyMap.equal_range(it->first);
-
-        //Get devcie metric
+    for (auto it = policyMap.begin(); it != policyMap.end(); it++) {
         xpum_device_id_t deviceId = it->first;
+        std::shared_ptr<std::list<std::shared_ptr<xpum_policy_data>>> pList = it->second;
+        if (pList->empty()) {
+            continue;
+        }
 
         // Check device id
         xpum_result_t result = this->isValidateDeviceId(deviceId);
@@ -155,47 +237,209 @@ void PolicyManager::checkPolicy() {
             continue;
         }
 
-        //XPUM_LOG_INFO("---PolicyManager::checkPolicy()---2--deviceId={}",deviceId);
-        int count = -1;
-        p_data_logic->getLatestMetrics(deviceId, nullptr, &count);
-        if (count <= 0) {
-            XPUM_LOG_ERROR("PolicyManager::checkPolicy(): failed to getLatestMetrics(deviceId={})--count={}", deviceId, count);
+        //check policy, the policies on telemetry metrics are checked by handleMeasurementData
+        for (auto itList = pList->begin(); itList != pList->end(); itList++) {
+            std::shared_ptr<xpum_policy_data> p_policy = *itList;
+            MeasurementType measurementType;
+            if (getPolicyMeasurementType(p_policy->type, measurementType)) {
+                continue;
+            }
+
+            //trace
+            print_policy_for_demoEx2("checkPolicy", p_policy);
+
+            //check condition
+            if (isPolicyMeetCondition(p_policy)) {
+                this->triggerNotification(p_policy);
+                this->triggerAction(p_policy);
+            }
+        }
+    }
+}
+
+void PolicyManager::rebuildMetricPolicyIndex() {
+    metricPolicyIndex.clear();
+    for (auto it = policyMap.begin(); it != policyMap.end(); it++) {
+        for (auto& p_policy : *(it->second)) {
+            MeasurementType measurementType;
+            if (getPolicyMeasurementType(p_policy->type, measurementType)) {
+                metricPolicyIndex[measurementType][it->first].push_back(p_policy);
+            }
+        }
+    }
+}
+
+void PolicyManager::handleMeasurementData(MeasurementType type, std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    auto index = metricPolicyIndex.find(type);
+    if (index == metricPolicyIndex.end()) {
+        return;
+    }
+    for (auto& devicePolicies : index->second) {
+        uint32_t deviceId = devicePolicies.first;
+        if (!datas->contains(deviceId)) {
+            continue;
+        }
+        // the handled data, the same as getLatestMetrics returns
+        std::shared_ptr<MeasurementData> p_data = p_data_logic->getLatestData(type, deviceId);
+        if (p_data == nullptr) {
+            continue;
+        }
+        for (auto& p_policy : devicePolicies.second) {
+            //trace
+            print_policy_for_demoEx2("handleMeasurementData", p_policy);
+
+            //check condition
+            if (isMetricPolicyMeetCondition(p_policy, p_data)) {
+                this->triggerNotification(p_policy);
+                this->triggerAction(p_policy);
+            }
+            p_policy->preValue = p_policy->curValue;
+            p_policy->preTimestamp = p_policy->curTimestamp;
+        }
+    }
+}
+
+bool PolicyManager::getPolicyEvents(xpum_policy_type_t policyType, zes_event_type_flags_t& events) {
+    switch (policyType) {
+        case XPUM_POLICY_TYPE_GPU_MISSING:
+            events = ZES_EVENT_TYPE_FLAG_DEVICE_DETACH;
+            return true;
+        case XPUM_POLICY_TYPE_GPU_TEMPERATURE:
+            events = ZES_EVENT_TYPE_FLAG_TEMP_CRITICAL;
+            return true;
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_RESET:
+            events = ZES_EVENT_TYPE_FLAG_RAS_UNCORRECTABLE_ERRORS | ZES_EVENT_TYPE_FLAG_DEVICE_RESET_REQUIRED;
+            return true;
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_PROGRAMMING_ERRORS:
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_DRIVER_ERRORS:
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE:
+            events = ZES_EVENT_TYPE_FLAG_RAS_UNCORRECTABLE_ERRORS;
+            return true;
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE:
+            events = ZES_EVENT_TYPE_FLAG_RAS_CORRECTABLE_ERRORS;
+            return true;
+        default:
+            return false;
+    }
+}
+
+void PolicyManager::handleDeviceEvent(const std::string& deviceId, zes_event_type_flags_t events) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    auto it = policyMap.find(std::stoi(deviceId));
+    if (it == policyMap.end() || it->second == nullptr) {
+        return;
+    }
+    std::shared_ptr<Device> p_device = p_device_manager->getDevice(deviceId);
+    if (p_device == nullptr) {
+        return;
+    }
+    uint64_t now = Utility::getCurrentMillisecond();
+    uint64_t rasErrors[XPUM_RAS_ERROR_MAX] = {};
+    bool rasErrorsRead = false;
+    for (auto& p_policy : *(it->second)) {
+        zes_event_type_flags_t policyEvents;
+        if (!getPolicyEvents(p_policy->type, policyEvents) || (events & policyEvents) == 0) {
             continue;
         }
-        //XPUM_LOG_INFO("---PolicyManager::checkPolicy()---getLatestMetrics--deviceId={}--count={}",deviceId,count);
-        std::shared_ptr<std::vector<xpum_device_metrics_t>> pMetricCur = std::make_shared<std::vector<xpum_device_metrics_t>>(count);
-        p_data_logic->getLatestMetrics(deviceId, pMetricCur->data(), &count);
-
-        //check policy
-        bool isResetDevice = false;
-        while (range.first != range.second) {
-            std::shared_ptr<std::list<std::shared_ptr<xpum_policy_data>>> pList = range.first->second;
-            for (auto itList = pList->begin(); itList != pList->end(); itList++) {
-                std::shared_ptr<xpum_policy_data> p_policy = *itList;
-                p_policy->pMetricCur = pMetricCur;
-
-                //trace
-                print_policy_for_demoEx2("checkPolicy", p_policy);
-
-                //check condition
-                bool isResetDeviceOne = false;
-                if (isPolicyMeetCondition(p_policy)) {
-                    this->triggerNotification(p_policy);
-                    isResetDeviceOne = this->triggerAction(p_policy);
-                }
+        XPUM_LOG_INFO("PolicyManager::handleDeviceEvent(): device {} events {:x} for policy type {}", deviceId, events, p_policy->type);
 
-                //isResetDevice
-                isResetDevice = isResetDeviceOne ? true : isResetDevice;
+        if (p_policy->type == XPUM_POLICY_TYPE_GPU_MISSING) {
+            // the timer finds the device missing later, report it only once
+            if (p_policy->preValue == 1) {
+                continue;
+            }
+            p_policy->curValue = 1;
+            p_policy->curTimestamp = now;
+            p_policy->isTileData = false;
+            p_policy->tileId = 0;
+            this->triggerNotification(p_policy);
+            this->triggerAction(p_policy);
+            p_policy->preValue = p_policy->curValue;
+            p_policy->preTimestamp = p_policy->curTimestamp;
+            continue;
+        }
+
+        // read the value now, the monitor may not sample it for a while
+        std::shared_ptr<MeasurementData> p_data;
+        if (p_policy->type == XPUM_POLICY_TYPE_GPU_TEMPERATURE) {
+            try {
+                p_data = GPUDeviceStub::toGetTemperature(p_device->getDeviceHandle(), ZES_TEMP_SENSORS_GPU);
+            } catch (BaseException& e) {
+                XPUM_LOG_DEBUG("PolicyManager::handleDeviceEvent(): failed to get temperature: {}", e.what());
+                continue;
             }
-            ++range.first;
+        } else {
+            if (!rasErrorsRead) {
+                GPUDeviceStub::instance().getRasError(p_device->getDeviceHandle(), rasErrors);
+                rasErrorsRead = true;
+            }
+            int category;
+            switch (p_policy->type) {
+                case XPUM_POLICY_TYPE_RAS_ERROR_CAT_RESET:
+                    category = XPUM_RAS_ERROR_CAT_RESET;
+                    break;
+                case XPUM_POLICY_TYPE_RAS_ERROR_CAT_PROGRAMMING_ERRORS:
+                    category = XPUM_RAS_ERROR_CAT_PROGRAMMING_ERRORS;
+                    break;
+                case XPUM_POLICY_TYPE_RAS_ERROR_CAT_DRIVER_ERRORS:
+                    category = XPUM_RAS_ERROR_CAT_DRIVER_ERRORS;
+                    break;
+                case XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE:
+                    category = XPUM_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE;
+                    break;
+                default:
+                    category = XPUM_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE;
+                    break;
+            }
+            p_data = std::make_shared<MeasurementData>(rasErrors[category]);
+        }
+        if (p_data == nullptr) {
+            continue;
+        }
+        p_data->setTimestamp(now);
+        if (isMetricPolicyMeetCondition(p_policy, p_data)) {
+            this->triggerNotification(p_policy);
+            this->triggerAction(p_policy);
         }
+        p_policy->preValue = p_policy->curValue;
+        p_policy->preTimestamp = p_policy->curTimestamp;
+    }
+}
 
-        // //isResetDevice
-        // if (isResetDevice) {
-        //     XPUM_LOG_INFO("PolicyManager::triggerAction():before resetDevice(deviceId={})",deviceId);
-        //     this->p_device_manager->resetDevice(std::to_string(deviceId), true);
-        //     XPUM_LOG_INFO("PolicyManager::triggerAction():after resetDevice(deviceId={})",deviceId);
-        // }
+void PolicyManager::handlePrecheckError(const xpum_precheck_component_info_t& component) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    uint64_t now = Utility::getCurrentMillisecond();
+    std::string bdf = component.bdf;
+    for (auto it = policyMap.begin(); it != policyMap.end(); it++) {
+        if (it->second == nullptr) {
+            continue;
+        }
+        // a driver or cpu error affects all devices
+        if (component.componentType == XPUM_PRECHECK_COMPONENT_TYPE_GPU) {
+            std::shared_ptr<Device> p_device = p_device_manager->getDevice(std::to_string(it->first));
+            Property prop;
+            if (p_device == nullptr || !p_device->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS, prop) ||
+                prop.getValue() != bdf) {
+                continue;
+            }
+        }
+        for (auto& p_policy : *(it->second)) {
+            if (p_policy->type != XPUM_POLICY_TYPE_PRECHECK_ERROR) {
+                continue;
+            }
+            XPUM_LOG_INFO("PolicyManager::handlePrecheckError(): device {} precheck error {}", it->first, component.errorId);
+            p_policy->curValue = component.errorId > 0 ? component.errorId : 1;
+            p_policy->curTimestamp = now;
+            p_policy->isTileData = false;
+            p_policy->tileId = 0;
+            strncpy(p_policy->description, component.errorDetail, sizeof(p_policy->description) - 1);
+            p_policy->description[sizeof(p_policy->description) - 1] = '\0';
+            this->triggerNotification(p_policy);
+            this->triggerAction(p_policy);
+            p_policy->preValue = p_policy->curValue;
+            p_policy->preTimestamp = p_policy->curTimestamp;
+        }
     }
 }
 
@@ -239,7 +483,7 @@ bool PolicyManager::isPolicyMeetCondition(std::shared_ptr<xpum_policy_data> p_po
     //XPUM_POLICY_TYPE_GPU_THROTTLE
     if (p_policy->type == XPUM_POLICY_TYPE_GPU_THROTTLE) {
         std::string freq_throttle_message;
-        bool get_state = GPUDeviceStub::instance().getFrequencyState(this->p_device_manager->getDevice(std::to_string(p_policy->deviceId))->getDeviceHandle(), freq_throttle_message);
+        bool get_state = GPUDeviceStub::instance().getFrequencyState(this->p_device_manager->getDevice(p_policy->deviceId)->getDeviceHandle(), freq_throttle_message);
         if (get_state) {
             p_policy->curValue = freq_throttle_message.size() > 0 ? 1 : 0;
             p_policy->curTimestamp = Utility::getCurrentMillisecond();
@@ -256,46 +500,110 @@ bool PolicyManager::isPolicyMeetCondition(std::shared_ptr<xpum_policy_data> p_po
         return false;
     }
 
-    //std::shared_ptr<std::vector<xpum_device_metrics_t>> pMetricCur = std::make_shared<std::vector<xpum_device_metrics_t>>(count);
-    auto pMetricCur = p_policy->pMetricCur;
-    for (auto itVector = pMetricCur->begin(); itVector != pMetricCur->end(); itVector++) {
-        xpum_device_metric_data_t* curData = this->getPolicyCurValue(p_policy, (*itVector));
-        if (curData == nullptr) {
-            continue;
+    return false;
+}
+
+bool PolicyManager::isMetricPolicyMeetCondition(std::shared_ptr<xpum_policy_data> p_policy, std::shared_ptr<MeasurementData> p_data) {
+    //check timestamp
+    uint64_t curTimestamp = p_data->getTimestamp();
+    if (p_policy->preTimestamp > 0 && curTimestamp <= p_policy->preTimestamp) {
+        return false;
+    }
+    uint64_t scale = p_data->getScale() > 0 ? p_data->getScale() : 1;
+    p_policy->curTimestamp = curTimestamp;
+
+    //device level data first, then the data of each tile. All of them are
+    //checked, so the stateful conditions see every sample
+    bool isMeet = false;
+    auto checkValue = [&](bool isTileData, int32_t tileId, uint64_t value) {
+        bool isMeetOne = isValueMeetCondition(p_policy, isTileData ? tileId : -1, curTimestamp, value);
+        if (isMeet) {
+            return;
         }
-        //check timestamp
-        uint64_t preTimestamp = p_policy->preTimestamp;
-        uint64_t curTimestamp = curData->timestamp;
-        if (preTimestamp > 0) {
-            if (curTimestamp <= preTimestamp) {
+        p_policy->curValue = value;
+        p_policy->isTileData = isTileData;
+        p_policy->tileId = tileId;
+        isMeet = isMeetOne;
+    };
+    if (p_data->hasDataOnDevice()) {
+        checkValue(false, 0, p_data->getCurrent() / scale);
+    }
+    if (p_data->hasSubdeviceData()) {
+        auto subdeviceDatas = p_data->getSubdeviceDatas();
+        for (auto it = subdeviceDatas->begin(); it != subdeviceDatas->end(); it++) {
+            if (it->second.current == std::numeric_limits<uint64_t>::max()) {
                 continue;
             }
+            checkValue(true, it->first, it->second.current / scale);
         }
+    }
+    return isMeet;
+}
 
-        //save data
-        uint64_t curValue = curData->value / curData->scale;
-        p_policy->curValue = curValue;
-        p_policy->curTimestamp = curTimestamp;
-        p_policy->isTileData = (*itVector).isTileData;
-        p_policy->tileId = (*itVector).tileId;
+bool PolicyManager::isStatefulCondition(xpum_policy_conditon_type_t type) {
+    return type == XPUM_POLICY_CONDITION_TYPE_SUSTAINED_GREATER || type == XPUM_POLICY_CONDITION_TYPE_RATE_GREATER || type == XPUM_POLICY_CONDITION_TYPE_EWMA_GREATER;
+}
 
-        //check condition
-        if (p_policy->condition.type == XPUM_POLICY_CONDITION_TYPE_GREATER) {
-            uint64_t threshold = p_policy->condition.threshold;
-            if (curValue > threshold) {
-                return true;
-            }
-        } else if (p_policy->condition.type == XPUM_POLICY_CONDITION_TYPE_LESS) {
-            uint64_t threshold = p_policy->condition.threshold;
-            if (curValue < threshold) {
-                return true;
-            }
-        } else if (p_policy->condition.type == XPUM_POLICY_CONDITION_TYPE_WHEN_OCCUR) {
-            uint64_t preValue = p_policy->preValue;
-            if (curValue > preValue) {
-                return true;
+bool PolicyManager::isValueMeetCondition(std::shared_ptr<xpum_policy_data> p_policy, int32_t tileId, uint64_t timestamp, uint64_t& curValue) {
+    uint64_t threshold = p_policy->condition.threshold;
+    if (p_policy->condition.type == XPUM_POLICY_CONDITION_TYPE_GREATER) {
+        return curValue > threshold;
+    } else if (p_policy->condition.type == XPUM_POLICY_CONDITION_TYPE_LESS) {
+        return curValue < threshold;
+    } else if (p_policy->condition.type == XPUM_POLICY_CONDITION_TYPE_WHEN_OCCUR) {
+        return curValue > p_policy->preValue;
+    } else if (!isStatefulCondition(p_policy->condition.type)) {
+        return false;
+    }
+
+    xpum_policy_condition_state& state = p_policy->conditionStates[tileId];
+    uint64_t value = curValue;
+    double level = 0;
+    bool isLevelValid = true;
+    if (p_policy->condition.type == XPUM_POLICY_CONDITION_TYPE_SUSTAINED_GREATER) {
+        if (value > threshold) {
+            if (state.aboveSince == 0) {
+                state.aboveSince = timestamp;
             }
+        } else {
+            state.aboveSince = 0;
+        }
+        level = value;
+        // not sustained long enough, handled as not greater
+        if (state.aboveSince != 0 && timestamp - state.aboveSince < p_policy->condition.window) {
+            level = threshold;
         }
+    } else if (p_policy->condition.type == XPUM_POLICY_CONDITION_TYPE_RATE_GREATER) {
+        // per second, only the increase counts
+        isLevelValid = state.initialized && timestamp > state.lastTimestamp;
+        if (isLevelValid) {
+            level = value > state.lastValue ? (double)(value - state.lastValue) * 1000 / (timestamp - state.lastTimestamp) : 0;
+        }
+    } else if (p_policy->condition.type == XPUM_POLICY_CONDITION_TYPE_EWMA_GREATER) {
+        if (!state.initialized) {
+            state.ewma = value;
+        } else if (timestamp > state.lastTimestamp) {
+            double alpha = 1 - std::exp(-(double)(timestamp - state.lastTimestamp) / p_policy->condition.window);
+            state.ewma += alpha * (value - state.ewma);
+        }
+        level = state.ewma;
+    }
+    state.initialized = true;
+    state.lastValue = value;
+    state.lastTimestamp = timestamp;
+    if (!isLevelValid) {
+        return false;
+    }
+    curValue = (uint64_t)level;
+
+    // trigger once when greater than threshold, again after falling to the release threshold
+    uint64_t releaseThreshold = p_policy->condition.releaseThreshold > 0 ? p_policy->condition.releaseThreshold : threshold;
+    if (!state.triggered && level > threshold) {
+        state.triggered = true;
+        return true;
+    }
+    if (state.triggered && level <= releaseThreshold) {
+        state.triggered = false;
     }
     return false;
 }
@@ -307,41 +615,35 @@ bool PolicyManager::isPerGpuMetric(xpum_policy_type_t type) {
     return false;
 }
 
-xpum_device_metric_data_t* PolicyManager::getPolicyCurValue(std::shared_ptr<xpum_policy_data> p_policy, xpum_device_metrics_t& dataList) {
-    // get data from monitor interface
-    int cc2 = dataList.count;
-    for (int j = 0; j < cc2; j++) {
-        if (this->isMatchMetricType(dataList.dataList[j].metricsType, p_policy->type)) {
-            return &(dataList.dataList[j]);
-        }
-    }
-    return nullptr;
-}
-
-bool PolicyManager::isMatchMetricType(xpum_stats_type_t metricsType, xpum_policy_type_t policyType) {
-    if (policyType == XPUM_POLICY_TYPE_GPU_TEMPERATURE && metricsType == XPUM_STATS_GPU_CORE_TEMPERATURE) {
-        return true;
-    } else if (policyType == XPUM_POLICY_TYPE_GPU_MEMORY_TEMPERATURE && metricsType == XPUM_STATS_MEMORY_TEMPERATURE) {
-        return true;
-    } else if (policyType == XPUM_POLICY_TYPE_GPU_POWER && metricsType == XPUM_STATS_POWER) {
-        return true;
-    } else if (policyType == XPUM_POLICY_TYPE_RAS_ERROR_CAT_RESET && metricsType == XPUM_STATS_RAS_ERROR_CAT_RESET) {
-        return true;
-    } else if (policyType == XPUM_POLICY_TYPE_RAS_ERROR_CAT_PROGRAMMING_ERRORS && metricsType == XPUM_STATS_RAS_ERROR_CAT_PROGRAMMING_ERRORS) {
-        return true;
-    } else if (policyType == XPUM_POLICY_TYPE_RAS_ERROR_CAT_DRIVER_ERRORS && metricsType == XPUM_STATS_RAS_ERROR_CAT_DRIVER_ERRORS) {
-        return true;
-    } else if (policyType == XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE && metricsType == XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE) {
-        return true;
-    } else if (policyType == XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE && metricsType == XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE) {
-        return true;
+bool PolicyManager::getPolicyMeasurementType(xpum_policy_type_t policyType, MeasurementType& measurementType) {
+    switch (policyType) {
+        case XPUM_POLICY_TYPE_GPU_TEMPERATURE:
+            measurementType = METRIC_TEMPERATURE;
+            return true;
+        case XPUM_POLICY_TYPE_GPU_MEMORY_TEMPERATURE:
+            measurementType = METRIC_MEMORY_TEMPERATURE;
+            return true;
+        case XPUM_POLICY_TYPE_GPU_POWER:
+            measurementType = METRIC_POWER;
+            return true;
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_RESET:
+            measurementType = METRIC_RAS_ERROR_CAT_RESET;
+            return true;
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_PROGRAMMING_ERRORS:
+            measurementType = METRIC_RAS_ERROR_CAT_PROGRAMMING_ERRORS;
+            return true;
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_DRIVER_ERRORS:
+            measurementType = METRIC_RAS_ERROR_CAT_DRIVER_ERRORS;
+            return true;
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE:
+            measurementType = METRIC_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE;
+            return true;
+        case XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE:
+            measurementType = METRIC_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE;
+            return true;
+        default:
+            return false;
     }
-    // else if (policyType == XPUM_POLICY_TYPE_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE && metricsType == XPUM_STATS_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE) {
-    //     return true;
-    // } else if (policyType == XPUM_POLICY_TYPE_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE && metricsType == XPUM_STATS_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE) {
-    //     return true;
-    // }
-    return false;
 }
 
 void PolicyManager::savePolicyStatus() {
@@ -352,13 +654,15 @@ void PolicyManager::savePolicyStatus() {
         std::shared_ptr<std::list<std::shared_ptr<xpum_policy_data>>> p_list = it->second;
         for (auto itList = p_list->begin(); itList != p_list->end(); itList++) {
             std::shared_ptr<xpum_policy_data> p_policy = *itList;
+            MeasurementType measurementType;
+            if (getPolicyMeasurementType(p_policy->type, measurementType)) {
+                continue;
+            }
             //check
             p_policy->preValue = p_policy->curValue;
             p_policy->preTimestamp = p_policy->curTimestamp;
-            p_policy->pMetricPre = p_policy->pMetricCur;
             p_policy->curValue = 0;
             p_policy->curTimestamp = 0;
-            p_policy->pMetricCur = nullptr;
         }
     }
     //XPUM_LOG_INFO("---PolicyManager::savePolicyStatus()---2--");
@@ -400,14 +704,11 @@ void PolicyManager::triggerNotification(std::shared_ptr<xpum_policy_data> p_poli
     /////
     xpum_policy_triggered_for_trace(&para);
 
-    /////
-    if (p_policy->notifyCallBack == nullptr) {
-        //XPUM_LOG_INFO("---PolicyManager::triggerNotification()---3--deviceId={}",p_policy->deviceId);
-        return;
-    }
-    XPUM_LOG_TRACE("PolicyManager::triggerNotification():before do custom notifyCallBack for deviceId={}", p_policy->deviceId);
-    p_policy->notifyCallBack(&para);
-    XPUM_LOG_TRACE("PolicyManager::triggerNotification():after do custom notifyCallBack for deviceId={}", p_policy->deviceId);
+    // the notify callback and the triggered dump tasks take the event from the bus
+    PolicyEvent event;
+    event.para = para;
+    event.notifyCallBack = p_policy->notifyCallBack;
+    EventBus<PolicyEvent>::instance().publish(event);
 }
 
 bool PolicyManager::isInDeviceIds(xpum_device_id_t deviceId, xpum_device_id_t deviceIds[], int count) {
@@ -444,7 +745,7 @@ xpum_result_t PolicyManager::xpumSetPolicyByGroup(xpum_group_id_t groupId, xpum_
 }
 
 xpum_result_t PolicyManager::isValidateDeviceId(xpum_device_id_t deviceId) {
-    auto pDevice = this->p_device_manager->getDevice(std::to_string(deviceId));
+    auto pDevice = this->p_device_manager->getDevice(deviceId);
     if (pDevice == nullptr)
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     return XPUM_OK;
@@ -477,6 +778,7 @@ xpum_result_t PolicyManager::xpumSetPolicyByDeviceIds(xpum_device_id_t deviceIds
             return XPUM_RESULT_POLICY_NOT_EXIST;
         } else {
             XPUM_LOG_INFO("PolicyManager::xpumSetPolicyByDeviceIds(): Delete policy ok");
+            this->rebuildMetricPolicyIndex();
             return XPUM_OK;
         }
     } else {
@@ -536,6 +838,7 @@ xpum_result_t PolicyManager::xpumSetPolicyByDeviceIds(xpum_device_id_t deviceIds
             }
         }
         XPUM_LOG_INFO("---PolicyManager::xpumSetPolicyByDeviceIds()---set--ok--");
+        this->rebuildMetricPolicyIndex();
         return XPUM_OK;
     }
 }
@@ -548,13 +851,27 @@ xpum_result_t PolicyManager::checkPolicyValidation(xpum_policy_t policy) {
     if (policy.action.type < XPUM_POLICY_ACTION_TYPE_NULL || policy.action.type > XPUM_POLICY_ACTION_TYPE_THROTTLE_DEVICE) {
         return XPUM_RESULT_POLICY_ACTION_TYPE_INVALID;
     }
-    if (policy.condition.type < XPUM_POLICY_CONDITION_TYPE_GREATER || policy.condition.type > XPUM_POLICY_CONDITION_TYPE_WHEN_OCCUR) {
+    if (policy.condition.type < XPUM_POLICY_CONDITION_TYPE_GREATER || policy.condition.type > XPUM_POLICY_CONDITION_TYPE_EWMA_GREATER) {
         return XPUM_RESULT_POLICY_CONDITION_TYPE_INVALID;
     }
 
+    // the stateful conditions are checked on telemetry samples only
+    if (isStatefulCondition(policy.condition.type)) {
+        MeasurementType measurementType;
+        if (!getPolicyMeasurementType(policy.type, measurementType)) {
+            return XPUM_RESULT_POLICY_TYPE_CONDITION_NOT_SUPPORT;
+        }
+        if (policy.condition.type != XPUM_POLICY_CONDITION_TYPE_RATE_GREATER && policy.condition.window == 0) {
+            return XPUM_RESULT_POLICY_INVALID_THRESHOLD;
+        }
+        if (policy.condition.releaseThreshold > policy.condition.threshold) {
+            return XPUM_RESULT_POLICY_INVALID_THRESHOLD;
+        }
+    }
+
     //
     if (policy.type == XPUM_POLICY_TYPE_GPU_TEMPERATURE) {
-        if (!(policy.condition.type == XPUM_POLICY_CONDITION_TYPE_GREATER || policy.condition.type == XPUM_POLICY_CONDITION_TYPE_LESS)) {
+        if (!(policy.condition.type == XPUM_POLICY_CONDITION_TYPE_GREATER || policy.condition.type == XPUM_POLICY_CONDITION_TYPE_LESS || isStatefulCondition(policy.condition.type))) {
             return XPUM_RESULT_POLICY_TYPE_CONDITION_NOT_SUPPORT;
         }
         if (!(policy.action.type == XPUM_POLICY_ACTION_TYPE_NULL || policy.action.type == XPUM_POLICY_ACTION_TYPE_THROTTLE_DEVICE)) {
@@ -563,7 +880,7 @@ xpum_result_t PolicyManager::checkPolicyValidation(xpum_policy_t policy) {
     }
 
     if (policy.type == XPUM_POLICY_TYPE_GPU_MEMORY_TEMPERATURE || policy.type == XPUM_POLICY_TYPE_GPU_POWER) {
-        if (!(policy.condition.type == XPUM_POLICY_CONDITION_TYPE_GREATER || policy.condition.type == XPUM_POLICY_CONDITION_TYPE_LESS)) {
+        if (!(policy.condition.type == XPUM_POLICY_CONDITION_TYPE_GREATER || policy.condition.type == XPUM_POLICY_CONDITION_TYPE_LESS || isStatefulCondition(policy.condition.type))) {
             return XPUM_RESULT_POLICY_TYPE_CONDITION_NOT_SUPPORT;
         }
         if (!(policy.action.type == XPUM_POLICY_ACTION_TYPE_NULL)) {
@@ -580,7 +897,7 @@ xpum_result_t PolicyManager::checkPolicyValidation(xpum_policy_t policy) {
         }
     }
 
-    if (policy.type == XPUM_POLICY_TYPE_GPU_THROTTLE) {
+    if (policy.type == XPUM_POLICY_TYPE_GPU_THROTTLE || policy.type == XPUM_POLICY_TYPE_PRECHECK_ERROR) {
         if (!(policy.condition.type == XPUM_POLICY_CONDITION_TYPE_WHEN_OCCUR)) {
             return XPUM_RESULT_POLICY_TYPE_CONDITION_NOT_SUPPORT;
         }
@@ -10,6 +10,7 @@
 #include <dlfcn.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <bitset>
 #include <fstream>
 #include <iomanip>
@@ -19,12 +20,28 @@
 
 #include "control/device_manager_interface.h"
 #include "data_logic/data_logic_interface.h"
+#include "event/event_bus.h"
+#include "event/events.h"
 #include "group/group_manager_interface.h"
 #include "infrastructure/timer.h"
+#include "level_zero/zes_api.h"
 #include "policy_manager_interface.h"
 
 namespace xpum {
 
+/*
+  The state of the stateful conditions for the data of a device or one of its tiles,
+  updated in O(1) for each sample.
+*/
+struct xpum_policy_condition_state {
+    bool initialized = false;
+    bool triggered = false;
+    uint64_t lastValue = 0;
+    uint64_t lastTimestamp = 0;
+    uint64_t aboveSince = 0; // the timestamp the value became greater than the threshold, 0 if not greater
+    double ewma = 0;
+};
+
 struct xpum_policy_data {
     xpum_policy_type_t type;
     xpum_policy_condition_t condition;
@@ -34,8 +51,6 @@ struct xpum_policy_data {
     char description[XPUM_MAX_STR_LENGTH];
     xpum_device_id_t deviceId; // Only for get policy api, ignored by set policy api.
     bool isDeletePolicy;
-    std::shared_ptr<std::vector<xpum_device_metrics_t>> pMetricCur;
-    std::shared_ptr<std::vector<xpum_device_metrics_t>> pMetricPre;
     ////
     bool isTileData; ///< If this statistics data is tile level
     int32_t tileId;  ///< The tile id, only valid if isTileData is true
@@ -43,6 +58,8 @@ struct xpum_policy_data {
     uint64_t preValue = 0;
     uint64_t curTimestamp = 0;
     uint64_t preTimestamp = 0;
+    // by tile id, -1 for the device level data
+    std::map<int32_t, xpum_policy_condition_state> conditionStates;
 };
 
 class PolicyManager : public PolicyManagerInterface, public std::enable_shared_from_this<PolicyManager> {
@@ -62,15 +79,23 @@ class PolicyManager : public PolicyManagerInterface, public std::enable_shared_f
     xpum_result_t xpumGetPolicy(xpum_device_id_t deviceId, xpum_policy_t resultList[], int* count);
     xpum_result_t xpumGetPolicyByGroup(xpum_group_id_t groupId, xpum_policy_t resultList[], int* count);
     void resetCheckFrequency();
+    bool hasPolicy(xpum_device_id_t deviceId, xpum_policy_type_t type);
 
    private:
     void start();
     void stop();
     void handleForOneCyle();
-    bool isMatchMetricType(xpum_stats_type_t metricsType, xpum_policy_type_t policyType);
+    bool getPolicyMeasurementType(xpum_policy_type_t policyType, MeasurementType& measurementType);
     void checkPolicy();
     void savePolicyStatus();
-    xpum_device_metric_data_t* getPolicyCurValue(std::shared_ptr<xpum_policy_data> p_policy, xpum_device_metrics_t& dataList);
+    void rebuildMetricPolicyIndex();
+    void handleMeasurementData(MeasurementType type, std::shared_ptr<DeviceIndexMap<std::shared_ptr<MeasurementData>>> datas);
+    void handleDeviceEvent(const std::string& deviceId, zes_event_type_flags_t events);
+    bool getPolicyEvents(xpum_policy_type_t policyType, zes_event_type_flags_t& events);
+    void handlePrecheckError(const xpum_precheck_component_info_t& component);
+    bool isMetricPolicyMeetCondition(std::shared_ptr<xpum_policy_data> p_policy, std::shared_ptr<MeasurementData> p_data);
+    bool isValueMeetCondition(std::shared_ptr<xpum_policy_data> p_policy, int32_t tileId, uint64_t timestamp, uint64_t& curValue);
+    bool isStatefulCondition(xpum_policy_conditon_type_t type);
     bool triggerAction(std::shared_ptr<xpum_policy_data> p_policy);
     void triggerNotification(std::shared_ptr<xpum_policy_data> p_policy);
     bool isPerGpuMetric(xpum_policy_type_t type);
@@ -96,6 +121,23 @@ class PolicyManager : public PolicyManagerInterface, public std::enable_shared_f
     std::map<xpum_device_id_t, std::shared_ptr<std::list<std::shared_ptr<xpum_policy_data>>>> policyMap;
     std::mutex mutex;
 
+    // The policies on telemetry metrics by measurement type and device, rebuilt
+    // from policyMap whenever it changes. They are checked as the data is stored,
+    // the timer only checks the other policies.
+    std::map<MeasurementType, std::map<xpum_device_id_t, std::vector<std::shared_ptr<xpum_policy_data>>>> metricPolicyIndex;
+    std::atomic<bool> listening{false};
+
+    // The subscription to the driver events that trigger the policies at once,
+    // -1 if not subscribed
+    int event_subscription = -1;
+
+    // The listener of the errors precheck finds in the kernel log, -1 if not added
+    int precheck_listener = -1;
+
+    // calls the notify callbacks of the triggered policies, so a slow callback
+    // never holds up the thread checking the policies
+    std::unique_ptr<EventDispatcher<PolicyEvent>> p_notifier;
+
     //
     int freq;
     //Timer timer;
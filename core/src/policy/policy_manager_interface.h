@@ -23,5 +23,6 @@ class PolicyManagerInterface : public InitCloseInterface {
     virtual xpum_result_t xpumGetPolicy(xpum_device_id_t deviceId, xpum_policy_t resultList[], int *count) = 0;
     virtual xpum_result_t xpumGetPolicyByGroup(xpum_group_id_t groupId, xpum_policy_t resultList[], int *count) = 0;
     virtual void resetCheckFrequency() = 0;
+    virtual bool hasPolicy(xpum_device_id_t deviceId, xpum_policy_type_t type) = 0;
 };
 } // end namespace xpum
@@ -24,14 +24,7 @@ using namespace nlohmann;
 namespace xpum {
 
 bool static checkPrerequisiteTool() {
-    std::string output;
-    int ret = doCmd("which ifconfig", output);
-    if (ret)
-        return false;
-    ret = doCmd("which dhclient", output);
-    if (ret)
-        return false;
-    return true;
+    return isCmdInPath("ifconfig") && isCmdInPath("dhclient");
 }
 
 static bool parseInterface(std::string dmiDecodeOutput, std::string& interface_name) {
@@ -5,6 +5,7 @@
  */
 #include "intel_dnp_redfish_amc_manager.h"
 
+#include <fstream>
 #include <future>
 #include <nlohmann/json.hpp>
 #include <regex>
@@ -14,6 +15,7 @@
 #include "detect_usb_interface.h"
 #include "infrastructure/logger.h"
 #include "libcurl.h"
+#include "redfish_client.h"
 #include "util.h"
 
 
@@ -307,144 +309,35 @@ static bool parseErrorMsg(json obj, std::string& errMsg) {
     return false;
 }
 
-static xpum_result_t getGPUFwInventoryList(DNPRedfishHostInterface interface,
-                                    std::string username,
-                                    std::string password,
-                                    std::vector<std::string>& gpuOdataIdList,
-                                    std::string& errMsg) {
-    // get gpu list
-    std::string path = "/redfish/v1/UpdateService/FirmwareInventory";
-    std::stringstream url;
-    url << "https://";
-    url << interface.ipv4_service_addr;
-    url << path;
-
-    CURL* curl;
-    CURLcode res = CURL_LAST;
-    std::string buffer;
-    curl = libcurl.curl_easy_init();
-    if (curl) {
-        libcurl.curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "GET");
-        libcurl.curl_easy_setopt(curl, CURLOPT_URL, url.str().c_str());
-
-        curlBasicConfig(curl, buffer, username, password);
-
-        res = libcurl.curl_easy_perform(curl);
-    }
-    long response_code;
-    libcurl.curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-    libcurl.curl_easy_cleanup(curl);
-    if (res != CURLE_OK){
-        switch (res) {
-            case CURLE_OPERATION_TIMEDOUT:
-                errMsg = "Request to " + url.str() + " timeout";
-                break;
-            default:
-                errMsg = "Fail to request " + url.str();
-        }
-        return XPUM_GENERIC_ERROR;
-    }
-    if (response_code == 401) {
-        errMsg = "Unauthorized";
-        return XPUM_GENERIC_ERROR;
-    }
-    json fwInventoryJson;
-    try {
-        fwInventoryJson = json::parse(buffer);
-    } catch (...) {
-        // parse error
-        errMsg = "Fail to parse fw inventory json";
-        return XPUM_GENERIC_ERROR;
-    }
-
-    if (fwInventoryJson.contains("Members")) {
-        for (auto inv : fwInventoryJson["Members"]) {
-            if (inv.contains("@odata.id")) {
-                std::string link = inv["@odata.id"].get<std::string>();
-                if (link.find("/redfish/v1/UpdateService/FirmwareInventory/PonteVecchio") != link.npos || link.find("/redfish/v1/UpdateService/FirmwareInventory/IntelDataCenterGPUMaxSeries") != link.npos) {
-                    gpuOdataIdList.push_back(link);
-                } else {
-                    auto tmp = link;
-                    std::transform(tmp.begin(), tmp.end(), tmp.begin(),
-                                   [](unsigned char c) { return std::tolower(c); });
-                    if (tmp.find("flex") != tmp.npos || tmp.find("ats_m") != tmp.npos) {
-                        gpuOdataIdList.push_back(link);
-                    }
-                }
-            }
-        }
-        return XPUM_OK;
-    }
-    // if contains error
-    parseErrorMsg(fwInventoryJson, errMsg);
-    return XPUM_GENERIC_ERROR;
-}
-
-static bool getAmcFwVersionByOdataId(DNPRedfishHostInterface interface,
-                                     std::string username,
-                                     std::string password,
-                                     std::string odataid,
-                                     std::string& version,
-                                     std::string& errMsg) {
-    std::stringstream url;
-    url << "https://";
-    url << interface.ipv4_service_addr;
-    url << odataid;
-    CURL* curl;
-    CURLcode res = CURL_LAST;
-    std::string buffer;
-    curl = libcurl.curl_easy_init();
-    if (curl) {
-        libcurl.curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "GET");
-        libcurl.curl_easy_setopt(curl, CURLOPT_URL, url.str().c_str());
-
-        curlBasicConfig(curl, buffer, username, password);
-
-        res = libcurl.curl_easy_perform(curl);
-    }
-    libcurl.curl_easy_cleanup(curl);
-    if (res != CURLE_OK) {
-        switch (res) {
-            case CURLE_OPERATION_TIMEDOUT:
-                errMsg = "Request to " + url.str() + " timeout";
-                break;
-            default:
-                errMsg = "Fail to get " + odataid;
-        }
-        return false;
-    }
-    json fwJson;
-    try {
-        fwJson = json::parse(buffer);
-    } catch (...) {
-        // parse error
-        errMsg = "Fail to parse json from " + odataid;
-        return false;
-    }
-    if (fwJson.contains("Version")) {
-        version = fwJson["Version"].get<std::string>();
+static bool isAmcFwInventory(const std::string& link) {
+    if (link.find("/redfish/v1/UpdateService/FirmwareInventory/PonteVecchio") != link.npos || link.find("/redfish/v1/UpdateService/FirmwareInventory/IntelDataCenterGPUMaxSeries") != link.npos) {
         return true;
     }
-    parseErrorMsg(fwJson, errMsg);
-    return false;
+    auto tmp = link;
+    std::transform(tmp.begin(), tmp.end(), tmp.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return tmp.find("flex") != tmp.npos || tmp.find("ats_m") != tmp.npos;
 }
 
 void DenaliPassRedfishAmcManager::getAmcFirmwareVersions(GetAmcFirmwareVersionsParam& param) {
     readConfigFile();
-    std::vector<std::string> gpuOdataIdList;
-    auto errCode = getGPUFwInventoryList(hostInterface, param.username, param.password, gpuOdataIdList, param.errMsg);
-    if (errCode != XPUM_OK) {
-        param.errCode = errCode;
+    auto client = RedfishClient::instance(libcurl, "https://" + hostInterface.ipv4_service_addr, param.username, param.password);
+    std::vector<json> fwInventoryList;
+    json fwInventoryJson;
+    if (!client->getCollectionMembers("/redfish/v1/UpdateService/FirmwareInventory", isAmcFwInventory, fwInventoryList, fwInventoryJson, param.errMsg)) {
+        if (param.errMsg.empty()) {
+            // if contains error
+            parseErrorMsg(fwInventoryJson, param.errMsg);
+        }
+        param.errCode = XPUM_GENERIC_ERROR;
         return;
     }
-    for (auto link : gpuOdataIdList) {
-        std::string version;
-        std::string message;
-        if (getAmcFwVersionByOdataId(hostInterface, param.username, param.password, link, version, message)) {
-            param.versions.push_back(version);
+    for (auto& fwJson : fwInventoryList) {
+        if (fwJson.contains("Version")) {
+            param.versions.push_back(fwJson["Version"].get<std::string>());
         } else {
             param.errCode = XPUM_GENERIC_ERROR;
-            param.errMsg = message;
+            parseErrorMsg(fwJson, param.errMsg);
             return;
         }
     }
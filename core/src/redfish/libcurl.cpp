@@ -6,38 +6,32 @@
 
 #include "libcurl.h"
 
-std::string getLibCurlPath() {
-    std::string cmd = "ldconfig -p 2>&1";
-    FILE *f = popen(cmd.c_str(), "r");
-    char c_line[1024];
-
-    std::vector<CurlLibVersion> libList;
+#include <mutex>
 
-    while (fgets(c_line, 1024, f) != NULL) {
-        std::string line(c_line);
-        auto idx = line.find("libcurl.so");
-        if (idx != line.npos) {
-            line = line.substr(idx);
-            auto endIdx = line.find(' ');
-            if (endIdx != line.npos) {
-                std::string name = line.substr(0, endIdx);
-                if (name.length() > 0) {
-                    CurlLibVersion lib(name);
-                    if (lib.valid)
-                        libList.push_back(lib);
-                }
-            }
-        }
-    }
-    pclose(f);
-    if (libList.size() > 0) {
-        auto &lib = libList.at(0);
-        for (size_t i = 1; i < libList.size(); i++) {
-            if (lib < libList.at(i)) {
-                lib = libList.at(i);
-            }
+static std::string findLibCurlPath() {
+    // the sonames of the libcurl builds shipped by the distributions, the newest first
+    static const char* sonames[] = {
+        "libcurl.so.4",
+        "libcurl-gnutls.so.4",
+        "libcurl-nss.so.4",
+        "libcurl.so.3",
+    };
+    for (auto soname : sonames) {
+        void *handle = dlopen(soname, RTLD_LAZY);
+        if (handle != NULL) {
+            dlclose(handle);
+            return soname;
         }
-        return lib.name;
     }
     return "libcurl.so";
-}
\ No newline at end of file
+}
+
+std::string getLibCurlPath() {
+    // resolved once, the libraries installed do not change while xpum runs
+    static std::once_flag once;
+    static std::string path;
+    std::call_once(once, [] {
+        path = findLibCurlPath();
+    });
+    return path;
+}
@@ -21,9 +21,8 @@
 #include "infrastructure/configuration.h"
 
 namespace xpum {
-std::shared_ptr<AmcManager> RedfishAmcManager::instance() {
-    std::string output;
-    doCmd("dmidecode -t system", output);
+AmcManager* RedfishAmcManager::create() {
+    std::string output = getDmiDecodeSystemOutput();
 
     std::regex manufacturerPattern("Manufacturer\\: (.*)");
     std::smatch sm;
@@ -32,21 +31,20 @@ std::shared_ptr<AmcManager> RedfishAmcManager::instance() {
         manufacturer = sm[1].str();
     }
     if (manufacturer == "HPE") {
-        return std::make_shared<HEPRedfishAmcManager>();
+        return new HEPRedfishAmcManager();
     } else if (manufacturer == "Dell Inc.") {
-        return std::make_shared<DELLRedfishAmcManager>();
+        return new DELLRedfishAmcManager();
     } else if (manufacturer == "Intel Corporation") {
-        return std::make_shared<DenaliPassRedfishAmcManager>();
+        return new DenaliPassRedfishAmcManager();
     } else if (manufacturer == "Lenovo") {
-        return std::make_shared<FlorenceRedfishAmcManager>();
+        return new FlorenceRedfishAmcManager();
     } else {
-        return std::make_shared<SMCRedfishAmcManager>();
+        return new SMCRedfishAmcManager();
     }
 }
 
 std::string getRedfishAmcWarn() {
-    std::string output;
-    doCmd("dmidecode -t system", output);
+    std::string output = getDmiDecodeSystemOutput();
 
     std::regex manufacturerPattern("Manufacturer\\: (.*)");
     std::smatch sm;
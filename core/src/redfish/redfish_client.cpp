@@ -0,0 +1,254 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file redfish_client.cpp
+ */
+#include "redfish_client.h"
+
+#include <map>
+
+#include "amc/redfish_amc_manager.h"
+#include "infrastructure/logger.h"
+
+using namespace nlohmann;
+
+namespace xpum {
+
+static size_t curlWriteToStringCallback(void* contents, size_t size, size_t nmemb, std::string* s) {
+    size_t newLength = size * nmemb;
+    try {
+        s->append((char*)contents, newLength);
+    } catch (std::bad_alloc& e) {
+        // handle memory problem
+        return 0;
+    }
+    return newLength;
+}
+
+RedfishClient::RedfishClient(LibCurlApi& libcurl, std::string host, std::string username, std::string password)
+    : libcurl(libcurl), host(host), username(username), password(password), multi(nullptr), expand_supported(-1) {
+    size_t count = max_parallel_requests;
+    if (libcurl.multiInitialized()) {
+        multi = libcurl.curl_multi_init();
+    }
+    if (multi == nullptr) {
+        count = 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        CURL* curl = libcurl.curl_easy_init();
+        if (curl == nullptr) {
+            break;
+        }
+        configHandle(curl);
+        handles.push_back(curl);
+    }
+}
+
+RedfishClient::~RedfishClient() {
+    for (auto curl : handles) {
+        libcurl.curl_easy_cleanup(curl);
+    }
+    if (multi != nullptr) {
+        libcurl.curl_multi_cleanup(multi);
+    }
+}
+
+std::shared_ptr<RedfishClient> RedfishClient::instance(LibCurlApi& libcurl, std::string host, std::string username, std::string password) {
+    static std::mutex instanceMutex;
+    static std::map<std::string, std::shared_ptr<RedfishClient>> clients;
+    std::lock_guard<std::mutex> lck(instanceMutex);
+    auto& client = clients[host + " " + username];
+    if (client == nullptr || client->password != password || &client->libcurl != &libcurl) {
+        client = std::make_shared<RedfishClient>(libcurl, host, username, password);
+    }
+    return client;
+}
+
+void RedfishClient::configHandle(CURL* curl) {
+    libcurl.curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "GET");
+    libcurl.curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    libcurl.curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    libcurl.curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    libcurl.curl_easy_setopt(curl, CURLOPT_NOPROXY, "*");
+    libcurl.curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+    // buffer
+    libcurl.curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteToStringCallback);
+
+    // credential
+    libcurl.curl_easy_setopt(curl, CURLOPT_HTTPAUTH, (long)CURLAUTH_BASIC);
+    libcurl.curl_easy_setopt(curl, CURLOPT_USERNAME, username.c_str());
+    libcurl.curl_easy_setopt(curl, CURLOPT_PASSWORD, password.c_str());
+}
+
+bool RedfishClient::fetch(const std::vector<std::string>& paths, std::vector<json>& objs, std::string& errMsg) {
+    if (handles.empty()) {
+        errMsg = "Fail to init curl";
+        return false;
+    }
+    std::vector<std::string> urls;
+    for (auto& path : paths) {
+        urls.push_back(host + path);
+    }
+    std::vector<std::string> buffers(paths.size());
+    std::vector<CURLcode> results(paths.size(), CURL_LAST);
+    std::vector<long> responseCodes(paths.size(), 0);
+
+    auto prepare = [&](CURL* curl, size_t i) {
+        libcurl.curl_easy_setopt(curl, CURLOPT_URL, urls[i].c_str());
+        libcurl.curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffers[i]);
+        // the timeout may be changed in the config file
+        libcurl.curl_easy_setopt(curl, CURLOPT_TIMEOUT, XPUM_CURL_TIMEOUT);
+    };
+    auto getResponseCode = [&](CURL* curl, size_t i) {
+        if (libcurl.curl_easy_getinfo != NULL) {
+            libcurl.curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCodes[i]);
+        }
+    };
+
+    if (multi == nullptr) {
+        CURL* curl = handles.front();
+        for (size_t i = 0; i < paths.size(); i++) {
+            prepare(curl, i);
+            results[i] = libcurl.curl_easy_perform(curl);
+            getResponseCode(curl, i);
+        }
+    } else {
+        std::vector<CURL*> idle(handles.rbegin(), handles.rend());
+        std::map<CURL*, size_t> active;
+        size_t next = 0;
+        while (next < paths.size() || !active.empty()) {
+            while (next < paths.size() && !idle.empty()) {
+                CURL* curl = idle.back();
+                idle.pop_back();
+                prepare(curl, next);
+                libcurl.curl_multi_add_handle(multi, curl);
+                active[curl] = next++;
+            }
+            int running = 0;
+            libcurl.curl_multi_perform(multi, &running);
+            CURLMsg* msg;
+            int left = 0;
+            while ((msg = libcurl.curl_multi_info_read(multi, &left)) != NULL) {
+                if (msg->msg != CURLMSG_DONE) {
+                    continue;
+                }
+                CURL* curl = msg->easy_handle;
+                size_t i = active[curl];
+                results[i] = msg->data.result;
+                getResponseCode(curl, i);
+                libcurl.curl_multi_remove_handle(multi, curl);
+                active.erase(curl);
+                idle.push_back(curl);
+            }
+            if (running > 0) {
+                libcurl.curl_multi_wait(multi, NULL, 0, 1000, NULL);
+            }
+        }
+    }
+
+    objs.clear();
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (results[i] != CURLE_OK) {
+            switch (results[i]) {
+                case CURLE_OPERATION_TIMEDOUT:
+                    errMsg = "Request to " + urls[i] + " timeout";
+                    break;
+                default:
+                    errMsg = "Fail to request " + urls[i];
+            }
+            return false;
+        }
+        if (responseCodes[i] == 401) {
+            errMsg = "Unauthorized";
+            return false;
+        }
+        try {
+            objs.push_back(json::parse(buffers[i]));
+        } catch (...) {
+            // parse error
+            errMsg = "Fail to parse json from " + paths[i];
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RedfishClient::get(const std::string& path, json& obj, std::string& errMsg) {
+    std::lock_guard<std::mutex> lck(mtx);
+    std::vector<json> objs;
+    if (!fetch({path}, objs, errMsg)) {
+        return false;
+    }
+    obj = objs.front();
+    return true;
+}
+
+bool RedfishClient::getAll(const std::vector<std::string>& paths, std::vector<json>& objs, std::string& errMsg) {
+    std::lock_guard<std::mutex> lck(mtx);
+    return fetch(paths, objs, errMsg);
+}
+
+bool RedfishClient::isExpandSupported() {
+    if (expand_supported < 0) {
+        std::vector<json> objs;
+        std::string errMsg;
+        expand_supported = 0;
+        if (fetch({"/redfish/v1"}, objs, errMsg)) {
+            auto& root = objs.front();
+            if (root.contains("ProtocolFeaturesSupported") &&
+                root["ProtocolFeaturesSupported"].contains("ExpandQuery") &&
+                root["ProtocolFeaturesSupported"]["ExpandQuery"].contains("NoLinks") &&
+                root["ProtocolFeaturesSupported"]["ExpandQuery"]["NoLinks"].is_boolean() &&
+                root["ProtocolFeaturesSupported"]["ExpandQuery"]["NoLinks"].get<bool>()) {
+                expand_supported = 1;
+            }
+        }
+        XPUM_LOG_INFO("Redfish service {} {} $expand", host, expand_supported ? "supports" : "does not support");
+    }
+    return expand_supported == 1;
+}
+
+bool RedfishClient::getCollectionMembers(const std::string& path, std::function<bool(const std::string&)> filter, std::vector<json>& members, json& collection, std::string& errMsg) {
+    std::lock_guard<std::mutex> lck(mtx);
+    bool expand = isExpandSupported();
+    std::vector<json> objs;
+    if (!fetch({expand ? path + "?$expand=." : path}, objs, errMsg)) {
+        return false;
+    }
+    collection = objs.front();
+    if (!collection.contains("Members") || !collection["Members"].is_array()) {
+        return false;
+    }
+
+    // the members not expanded by the service are fetched
+    std::vector<size_t> toFetch;
+    std::vector<std::string> paths;
+    members.clear();
+    for (auto& member : collection["Members"]) {
+        if (!member.contains("@odata.id") || !member["@odata.id"].is_string()) {
+            continue;
+        }
+        std::string link = member["@odata.id"].get<std::string>();
+        if (!filter(link)) {
+            continue;
+        }
+        if (member.size() <= 1) {
+            toFetch.push_back(members.size());
+            paths.push_back(link);
+        }
+        members.push_back(member);
+    }
+    if (paths.empty()) {
+        return true;
+    }
+    if (!fetch(paths, objs, errMsg)) {
+        return false;
+    }
+    for (size_t i = 0; i < toFetch.size(); i++) {
+        members[toFetch[i]] = objs[i];
+    }
+    return true;
+}
+
+} // namespace xpum
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file redfish_client.h
+ */
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "libcurl.h"
+
+namespace xpum {
+
+/*
+  RedfishClient sends the GET requests of the AMC managers to one BMC. Its
+  curl handles are kept between requests, so the TCP connections and TLS
+  sessions to the BMC are reused, and the members of a collection are
+  fetched in parallel, or in one request with $expand when the service
+  supports it.
+*/
+class RedfishClient {
+   public:
+    // host is like "https://169.254.3.254:443"
+    RedfishClient(LibCurlApi& libcurl, std::string host, std::string username, std::string password);
+
+    ~RedfishClient();
+
+    // the client of host, shared by the requests with the same credential
+    static std::shared_ptr<RedfishClient> instance(LibCurlApi& libcurl, std::string host, std::string username, std::string password);
+
+    // GET path and parse the response as json
+    bool get(const std::string& path, nlohmann::json& obj, std::string& errMsg);
+
+    // GET the paths in parallel, objs are in the order of paths
+    bool getAll(const std::vector<std::string>& paths, std::vector<nlohmann::json>& objs, std::string& errMsg);
+
+    // the members of the collection at path whose @odata.id pass filter, the error json if the
+    // collection has no Members
+    bool getCollectionMembers(const std::string& path, std::function<bool(const std::string&)> filter, std::vector<nlohmann::json>& members, nlohmann::json& collection, std::string& errMsg);
+
+   private:
+    // the requests sent at a time
+    static const size_t max_parallel_requests = 4;
+
+    void configHandle(CURL* curl);
+
+    // getAll(), the caller holds mtx
+    bool fetch(const std::vector<std::string>& paths, std::vector<nlohmann::json>& objs, std::string& errMsg);
+
+    // whether the service root has ProtocolFeaturesSupported.ExpandQuery.NoLinks, the caller holds mtx
+    bool isExpandSupported();
+
+    LibCurlApi& libcurl;
+
+    std::string host;
+
+    std::string username;
+
+    std::string password;
+
+    std::mutex mtx;
+
+    CURLM* multi;
+
+    std::vector<CURL*> handles;
+
+    // -1 if the service root is not read yet
+    int expand_supported;
+};
+
+} // namespace xpum
@@ -0,0 +1,37 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file redfish_plugin.cpp
+ */
+
+#include "redfish_plugin.h"
+
+#include "amc/redfish_amc_manager.h"
+#include "infrastructure/xpum_config.h"
+
+static void setLogger(const xpum::RedfishPluginContext& context) {
+#ifdef XPUM_PLUGIN
+    if (context.p_logger != nullptr) {
+        spdlog::set_default_logger(context.p_logger);
+    }
+#endif
+}
+
+extern "C" {
+
+xpum::AmcManager* xpum_create_redfish_amc_manager(const xpum::RedfishPluginContext& context) {
+    setLogger(context);
+    return xpum::RedfishAmcManager::create();
+}
+
+void xpum_get_redfish_amc_warn(const xpum::RedfishPluginContext& context, std::string& warn) {
+    setLogger(context);
+    warn = xpum::getRedfishAmcWarn();
+}
+
+#ifdef XPUM_PLUGIN
+const char* xpum_plugin_build() {
+    return XPUM_VERSION "+" XPUM_VERSION_GIT;
+}
+#endif
+}
@@ -0,0 +1,88 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file redfish_plugin.h
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "amc/amc_manager.h"
+#include "infrastructure/logger.h"
+
+namespace xpum {
+
+/*
+  The Redfish AMC managers and libcurl are built into libxpum_redfish.so
+  with BUILD_PLUGINS, the firmware manager creates the manager by the
+  entries below when IPMI finds no AMC. Without it the entries are
+  functions of the core library.
+*/
+struct RedfishPluginContext {
+    // the logger of the core, the plugin has its own copy of spdlog
+    std::shared_ptr<spdlog::logger> p_logger;
+};
+
+using CreateRedfishAmcManagerFunc = AmcManager* (*)(const RedfishPluginContext& context);
+
+using GetRedfishAmcWarnFunc = void (*)(const RedfishPluginContext& context, std::string& warn);
+
+#define XPUM_CREATE_REDFISH_AMC_MANAGER_SYMBOL "xpum_create_redfish_amc_manager"
+
+#define XPUM_GET_REDFISH_AMC_WARN_SYMBOL "xpum_get_redfish_amc_warn"
+
+/*
+  The AMC manager used when the plugin is not installed, it finds no AMC
+  and every AMC call fails in init with the reason.
+*/
+class UnavailableAmcManager : public AmcManager {
+   public:
+    bool preInit() override {
+        return false;
+    }
+
+    bool init(InitParam& param) override {
+        param.errMsg = "Redfish is not available, libxpum_redfish.so is not installed";
+        return false;
+    }
+
+    std::string getProtocol() override {
+        return "redfish";
+    }
+
+    void flashAMCFirmware(FlashAmcFirmwareParam& param) override {
+        param.errCode = XPUM_UPDATE_FIRMWARE_UNSUPPORTED_AMC;
+    }
+
+    void getAmcFirmwareVersions(GetAmcFirmwareVersionsParam& param) override {
+        param.errCode = XPUM_UPDATE_FIRMWARE_UNSUPPORTED_AMC;
+    }
+
+    void getAMCFirmwareFlashResult(GetAmcFirmwareFlashResultParam& param) override {
+        param.errCode = XPUM_UPDATE_FIRMWARE_UNSUPPORTED_AMC;
+    }
+
+    void getAMCSensorReading(GetAmcSensorReadingParam& param) override {
+        param.errCode = XPUM_UPDATE_FIRMWARE_UNSUPPORTED_AMC;
+    }
+
+    void getAMCSlotSerialNumbers(GetAmcSlotSerialNumbersParam& param) override {
+    }
+};
+
+} // end namespace xpum
+
+extern "C" {
+
+// the manager of the vendor of this system, created and not pre-initialized, the caller owns it
+xpum::AmcManager* xpum_create_redfish_amc_manager(const xpum::RedfishPluginContext& context);
+
+// what to tell the user to set up before the AMC of this system is reachable by Redfish
+void xpum_get_redfish_amc_warn(const xpum::RedfishPluginContext& context, std::string& warn);
+
+#ifdef XPUM_PLUGIN
+const char* xpum_plugin_build();
+#endif
+}
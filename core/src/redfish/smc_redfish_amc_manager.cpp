@@ -13,6 +13,7 @@
 #include "detect_usb_interface.h"
 #include "infrastructure/logger.h"
 #include "libcurl.h"
+#include "redfish_client.h"
 #include "util.h"
 #include <regex>
 
@@ -132,54 +133,20 @@ static bool parseErrorMsg(json obj, std::string& errMsg) {
     return false;
 }
 
-static bool getAmcFwVersionByOdataId(RedfishHostInterface interface,
-                                     std::string username,
-                                     std::string password,
-                                     std::string odataid,
-                                     std::string& version,
-                                     std::string& errMsg) {
-    std::stringstream url;
-    url << "https://";
-    url << interface.ipv4_service_addr;
+static std::string getServiceHost(RedfishHostInterface interface) {
+    std::string host = "https://" + interface.ipv4_service_addr;
     if (interface.ipv4_service_port.length() > 0)
-        url << ":" << interface.ipv4_service_port;
-    url << odataid;
-    CURL* curl;
-    CURLcode res = CURL_LAST;
-    std::string buffer;
-    curl = libcurl.curl_easy_init();
-    if (curl) {
-        libcurl.curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "GET");
-        libcurl.curl_easy_setopt(curl, CURLOPT_URL, url.str().c_str());
-
-        curlBasicConfig(curl, buffer, username, password);
+        host += ":" + interface.ipv4_service_port;
+    return host;
+}
 
-        res = libcurl.curl_easy_perform(curl);
-    }
-    libcurl.curl_easy_cleanup(curl);
-    if (res != CURLE_OK) {
-        switch (res) {
-            case CURLE_OPERATION_TIMEDOUT:
-                errMsg = "Request to " + url.str() + " timeout";
-                break;
-            default:
-                errMsg = "Fail to get " + odataid;
+static bool isAmcFwInventory(const std::string& link) {
+    for (auto patternString : AMC_PATTERN_LIST) {
+        std::regex pattern(patternString);
+        if (regex_search(link, pattern)) {
+            return true;
         }
-        return false;
-    }
-    json fwJson;
-    try {
-        fwJson = json::parse(buffer);
-    } catch (...) {
-        // parse error
-        errMsg = "Fail to parse json from " + odataid;
-        return false;
-    }
-    if (fwJson.contains("Version")) {
-        version = fwJson["Version"].get<std::string>();
-        return true;
     }
-    parseErrorMsg(fwJson, errMsg);
     return false;
 }
 
@@ -189,43 +156,9 @@ static xpum_result_t getGPUFwInventoryList(RedfishHostInterface interface,
                                     std::vector<std::string>& gpuOdataIdList,
                                     std::string& errMsg) {
     // get gpu list
-    std::string path = "/redfish/v1/UpdateService/FirmwareInventory";
-    std::stringstream url;
-    url << "https://";
-    url << interface.ipv4_service_addr;
-    if (interface.ipv4_service_port.length() > 0)
-        url << ":" << interface.ipv4_service_port;
-    url << path;
-
-    CURL* curl;
-    CURLcode res = CURL_LAST;
-    std::string buffer;
-    curl = libcurl.curl_easy_init();
-    if (curl) {
-        libcurl.curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "GET");
-        libcurl.curl_easy_setopt(curl, CURLOPT_URL, url.str().c_str());
-
-        curlBasicConfig(curl, buffer, username, password);
-
-        res = libcurl.curl_easy_perform(curl);
-    }
-    libcurl.curl_easy_cleanup(curl);
-    if (res != CURLE_OK){
-        switch (res) {
-            case CURLE_OPERATION_TIMEDOUT:
-                errMsg = "Request to " + url.str() + " timeout";
-                break;
-            default:
-                errMsg = "Fail to request " + url.str();
-        }
-        return XPUM_GENERIC_ERROR;
-    }
+    auto client = RedfishClient::instance(libcurl, getServiceHost(interface), username, password);
     json fwInventoryJson;
-    try {
-        fwInventoryJson = json::parse(buffer);
-    } catch (...) {
-        // parse error
-        errMsg = "Fail to parse fw inventory json";
+    if (!client->get("/redfish/v1/UpdateService/FirmwareInventory", fwInventoryJson, errMsg)) {
         return XPUM_GENERIC_ERROR;
     }
 
@@ -233,12 +166,8 @@ static xpum_result_t getGPUFwInventoryList(RedfishHostInterface interface,
         for (auto inv : fwInventoryJson["Members"]) {
             if (inv.contains("@odata.id")) {
                 std::string link = inv["@odata.id"].get<std::string>();
-                for(auto patternString : AMC_PATTERN_LIST){
-                    std::regex pattern(patternString);
-                    if (regex_search(link, pattern)) {
-                        gpuOdataIdList.push_back(link);
-                        break;
-                    }
+                if (isAmcFwInventory(link)) {
+                    gpuOdataIdList.push_back(link);
                 }
             }
         }
@@ -341,20 +270,23 @@ bool SMCRedfishAmcManager::init(InitParam& param) {
 
 void SMCRedfishAmcManager::getAmcFirmwareVersions(GetAmcFirmwareVersionsParam& param) {
     readConfigFile();
-    std::vector<std::string> gpuOdataIdList;
-    auto errCode = getGPUFwInventoryList(hostInterface, param.username, param.password, gpuOdataIdList, param.errMsg);
-    if (errCode != XPUM_OK) {
-        param.errCode = errCode;
+    auto client = RedfishClient::instance(libcurl, getServiceHost(hostInterface), param.username, param.password);
+    std::vector<json> fwInventoryList;
+    json fwInventoryJson;
+    if (!client->getCollectionMembers("/redfish/v1/UpdateService/FirmwareInventory", isAmcFwInventory, fwInventoryList, fwInventoryJson, param.errMsg)) {
+        if (param.errMsg.empty()) {
+            // if contains error
+            parseErrorMsg(fwInventoryJson, param.errMsg);
+        }
+        param.errCode = XPUM_GENERIC_ERROR;
         return;
     }
-    for (auto link : gpuOdataIdList) {
-        std::string version;
-        std::string message;
-        if (getAmcFwVersionByOdataId(hostInterface, param.username, param.password, link, version, message)) {
-            param.versions.push_back(version);
+    for (auto& fwJson : fwInventoryList) {
+        if (fwJson.contains("Version")) {
+            param.versions.push_back(fwJson["Version"].get<std::string>());
         } else {
             param.errCode = XPUM_GENERIC_ERROR;
-            param.errMsg = message;
+            parseErrorMsg(fwJson, param.errMsg);
             return;
         }
     }
@@ -1472,138 +1404,36 @@ void SMCRedfishAmcManager::getAMCSensorReading(GetAmcSensorReadingParam& param){
     param.errCode = XPUM_OK;
 }
 
-static xpum_result_t getGPUPCIeSlots(RedfishHostInterface interface,
-                                     std::string username,
-                                     std::string password,
-                                     std::vector<std::string>& gpuOdataIdList,
-                                     std::string& errMsg) {
-    // get gpu list
-    std::string path = "/redfish/v1/Chassis/1/PCIeDevices";
-    std::stringstream url;
-    url << "https://";
-    url << interface.ipv4_service_addr;
-    if (interface.ipv4_service_port.length() > 0)
-        url << ":" << interface.ipv4_service_port;
-    url << path;
-
-    CURL* curl;
-    CURLcode res = CURL_LAST;
-    std::string buffer;
-    curl = libcurl.curl_easy_init();
-    if (curl) {
-        libcurl.curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "GET");
-        libcurl.curl_easy_setopt(curl, CURLOPT_URL, url.str().c_str());
-
-        curlBasicConfig(curl, buffer, username, password);
-
-        res = libcurl.curl_easy_perform(curl);
-    }
-    libcurl.curl_easy_cleanup(curl);
-    if (res != CURLE_OK){
-        switch (res) {
-            case CURLE_OPERATION_TIMEDOUT:
-                errMsg = "Request to " + url.str() + " timeout";
-                break;
-            default:
-                errMsg = "Fail to request " + url.str();
-        }
-        return XPUM_GENERIC_ERROR;
-    }
-    json fwInventoryJson;
-    try {
-        fwInventoryJson = json::parse(buffer);
-    } catch (...) {
-        // parse error
-        errMsg = "Fail to parse PCIe device collection json";
-        return XPUM_GENERIC_ERROR;
-    }
-
-    if (fwInventoryJson.contains("Members")) {
-        for (auto inv : fwInventoryJson["Members"]) {
-            if (inv.contains("@odata.id")) {
-                std::string link = inv["@odata.id"].get<std::string>();
-                if (link.find("/GPU") != link.npos) {
-                    gpuOdataIdList.push_back(link);
-                }
-            }
-        }
-        return XPUM_OK;
-    }
-    // if contains error
-    parseErrorMsg(fwInventoryJson, errMsg);
-    return XPUM_GENERIC_ERROR;
-}
-
-static xpum_result_t getSlotIdAndSerialNumber(RedfishHostInterface interface,
-                                              std::string username,
-                                              std::string password,
-                                              std::string path,
-                                              std::string& errMsg,
-                                              SlotSerialNumberAndFwVersion& data) {
-    std::stringstream url;
-    url << "https://";
-    url << interface.ipv4_service_addr;
-    if (interface.ipv4_service_port.length() > 0)
-        url << ":" << interface.ipv4_service_port;
-    url << path;
-
-    CURL* curl;
-    CURLcode res = CURL_LAST;
-    std::string buffer;
-    curl = libcurl.curl_easy_init();
-    if (curl) {
-        libcurl.curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "GET");
-        libcurl.curl_easy_setopt(curl, CURLOPT_URL, url.str().c_str());
-
-        curlBasicConfig(curl, buffer, username, password);
-
-        res = libcurl.curl_easy_perform(curl);
-    }
-    libcurl.curl_easy_cleanup(curl);
-    if (res != CURLE_OK){
-        switch (res) {
-            case CURLE_OPERATION_TIMEDOUT:
-                errMsg = "Request to " + url.str() + " timeout";
-                break;
-            default:
-                errMsg = "Fail to request " + url.str();
-        }
-        return XPUM_GENERIC_ERROR;
-    }
-    json fwInventoryJson;
-    try {
-        fwInventoryJson = json::parse(buffer);
-    } catch (...) {
-        // parse error
-        errMsg = "Fail to parse PCIe device json";
-        return XPUM_GENERIC_ERROR;
-    }
-
-    if (fwInventoryJson.contains("SerialNumber") &&
-        fwInventoryJson.contains("FirmwareVersion") &&
-        fwInventoryJson.contains("Oem") &&
-        fwInventoryJson["Oem"].contains("Supermicro") &&
-        fwInventoryJson["Oem"]["Supermicro"].contains("GPUSlot")) {
-        data.serialNumber = fwInventoryJson["SerialNumber"].get<std::string>();
-        data.firmwareVersion = fwInventoryJson["FirmwareVersion"].get<std::string>();
-        data.slotId = fwInventoryJson["Oem"]["Supermicro"]["GPUSlot"].get<int>();
-        return XPUM_OK;
+static bool getSlotIdAndSerialNumber(json& pcieDeviceJson, SlotSerialNumberAndFwVersion& data) {
+    if (pcieDeviceJson.contains("SerialNumber") &&
+        pcieDeviceJson.contains("FirmwareVersion") &&
+        pcieDeviceJson.contains("Oem") &&
+        pcieDeviceJson["Oem"].contains("Supermicro") &&
+        pcieDeviceJson["Oem"]["Supermicro"].contains("GPUSlot")) {
+        data.serialNumber = pcieDeviceJson["SerialNumber"].get<std::string>();
+        data.firmwareVersion = pcieDeviceJson["FirmwareVersion"].get<std::string>();
+        data.slotId = pcieDeviceJson["Oem"]["Supermicro"]["GPUSlot"].get<int>();
+        return true;
     }
-    // if contains error
-    parseErrorMsg(fwInventoryJson, errMsg);
-    return XPUM_GENERIC_ERROR;
+    return false;
 }
 
 void SMCRedfishAmcManager::getAMCSlotSerialNumbers(GetAmcSlotSerialNumbersParam& param) {
     readConfigFile();
-    std::vector<std::string> gpuOdataIdList;
-    auto res = getGPUPCIeSlots(hostInterface, param.username, param.password, gpuOdataIdList, param.errMsg);
-    if (res)
+    auto client = RedfishClient::instance(libcurl, getServiceHost(hostInterface), param.username, param.password);
+    std::vector<json> pcieDeviceList;
+    json pcieDevicesJson;
+    auto isGPU = [](const std::string& link) { return link.find("/GPU") != link.npos; };
+    if (!client->getCollectionMembers("/redfish/v1/Chassis/1/PCIeDevices", isGPU, pcieDeviceList, pcieDevicesJson, param.errMsg)) {
+        if (param.errMsg.empty()) {
+            // if contains error
+            parseErrorMsg(pcieDevicesJson, param.errMsg);
+        }
         return;
-    for (auto link : gpuOdataIdList) {
-        std::string errMsg;
+    }
+    for (auto& pcieDeviceJson : pcieDeviceList) {
         SlotSerialNumberAndFwVersion data;
-        if (getSlotIdAndSerialNumber(hostInterface, param.username, param.password, link, errMsg, data) == XPUM_OK) {
+        if (getSlotIdAndSerialNumber(pcieDeviceJson, data)) {
             param.serialNumberList.push_back(data);
         }
     }
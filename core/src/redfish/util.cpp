@@ -6,6 +6,13 @@
 
 #include "util.h"
 
+#include <unistd.h>
+
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <sstream>
+
 namespace xpum {
 
 int doCmd(std::string cmd, std::string& output) {
@@ -31,13 +38,45 @@ int doCmd(std::string cmd, std::string& output) {
     return ret;
 }
 
-std::string getDmiDecodeOutput() {
-    // dmidecode -t 42
+// the DMI tables do not change while xpum runs, dmidecode is run once per type
+static std::string getCachedCmdOutput(std::string cmd) {
+    static std::mutex mtx;
+    static std::map<std::string, std::string> outputs;
+    std::lock_guard<std::mutex> lck(mtx);
+    auto it = outputs.find(cmd);
+    if (it != outputs.end()) {
+        return it->second;
+    }
     std::string output;
-    doCmd("dmidecode -t42", output);
+    if (doCmd(cmd, output) != 0) {
+        // not kept, dmidecode may be installed later
+        return output;
+    }
+    outputs[cmd] = output;
     return output;
 }
 
+std::string getDmiDecodeOutput() {
+    // dmidecode -t 42
+    return getCachedCmdOutput("dmidecode -t42");
+}
+
+std::string getDmiDecodeSystemOutput() {
+    return getCachedCmdOutput("dmidecode -t system");
+}
+
+bool isCmdInPath(std::string cmd) {
+    const char* env = std::getenv("PATH");
+    std::stringstream paths(env != nullptr ? env : "/usr/local/sbin:/usr/local/bin:/usr/sbin:/usr/bin:/sbin:/bin");
+    std::string dir;
+    while (std::getline(paths, dir, ':')) {
+        if (!dir.empty() && access((dir + "/" + cmd).c_str(), X_OK) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 unsigned short toCidr(const char* ipAddress) {
     unsigned short netmask_cidr;
     int ipbytes[4];
@@ -11,6 +11,11 @@ namespace xpum {
 
 std::string getDmiDecodeOutput();
 
+std::string getDmiDecodeSystemOutput();
+
+// whether cmd is an executable in PATH, like which
+bool isCmdInPath(std::string cmd);
+
 int doCmd(std::string cmd, std::string& output);
 
 unsigned short toCidr(const char* ipAddress);
@@ -36,7 +36,7 @@ std::string HWInfo::getDevicePath(const std::string& bdf_address) {
 
 bool HWInfo::isPcieDevExist(xpum_device_id_t deviceId) {
     Property prop;
-    std::shared_ptr<Device> p_device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    std::shared_ptr<Device> p_device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (p_device == nullptr) {
         XPUM_LOG_ERROR("isPcieDevExist, device {} not exist", deviceId);
         throw IlegalParameterException("device does not exist");
@@ -6,8 +6,12 @@
 
 #include "pci_database.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
@@ -22,11 +26,16 @@ namespace xpum {
 
 PciDatabase::PciDatabase() {
     bInitialized = false;
+    pci_ids = nullptr;
+    pci_ids_size = 0;
     XPUM_LOG_TRACE("PciDatabase()");
 }
 
 PciDatabase::~PciDatabase() {
     devices.clear();
+    if (pci_ids != nullptr) {
+        munmap(const_cast<char *>(pci_ids), pci_ids_size);
+    }
 }
 
 PciDatabase &PciDatabase::instance() {
@@ -49,14 +58,7 @@ bool PciDatabase::init() {
     folder = std::string(XPUM_CONFIG_DIR);
     fileName = folder + std::string(PCI_IDS_FILE);
 
-    infile.open(fileName.data());
-
-    if (infile.is_open()) {
-        if (!parse_pci_device(infile)) {
-            XPUM_LOG_DEBUG("PciDatabase::init()- parse_pci_device error.");
-        }
-        infile.close();
-    } else {
+    if (!map_pci_ids(fileName)) {
         XPUM_LOG_DEBUG("PciDatabase::init()- open file {} error.", fileName);
         char exePath[XPUM_MAX_PATH_LEN];
         ssize_t len = ::readlink("/proc/self/exe", exePath, sizeof(exePath));
@@ -73,16 +75,11 @@ bool PciDatabase::init() {
         if (stat(folder.c_str(), &buffer) != 0)
             folder = currentFile.substr(0, currentFile.find_last_of('/')) + "/../lib64/" + Configuration::getXPUMMode() + "/config/";
         fileName = folder + std::string(PCI_IDS_FILE);
-        infile.open(fileName.data());
-        if (!infile.is_open()) {
+        if (!map_pci_ids(fileName)) {
             XPUM_LOG_DEBUG("PciDatabase::init()- open file {} error.", fileName);
-        } else {
-            if (!parse_pci_device(infile)) {
-                XPUM_LOG_DEBUG("PciDatabase::init()- parse_pci_device error.");
-            }
-            infile.close();
         }
     }
+    index_vendors();
 
     fileName = folder + std::string(PCI_IDS_CONFIG);
     infile.open(fileName.data());
@@ -97,181 +94,144 @@ bool PciDatabase::init() {
     return true;
 }
 
-bool PciDatabase::parse_pci_device(std::ifstream &fstream) {
-    bool bResult = false;
-    int vendor_id = 0, device_id = 0, sub_vendor_id = 0, sub_device_id = 0;
-    std::string verdor_name, device_name, sub_s_name;
-    id_type idtype = ID_UNKNOWN;
-    std::string info;
-
-    while (std::getline(fstream, info)) {
-        bool comment = false;
-        int level = 0;
-        std::size_t idx = 0;
-        std::size_t len = info.length();
-
-        if (len == 0) {
-            continue;
-        }
-        while (idx < len) {
-            if (is_blank_space(info.at(idx))) {
-                idx++;
-            } else if ((info.at(idx) == '#')) {
-                comment = true;
-                break;
-            } else {
-                break;
-            }
-        }
-        if (comment) {
-            continue;
-        }
-
-        idx = 0;
-        while (idx < len) {
-            if (info.at(idx) == '\t') {
-                idx++;
-                level++;
-            } else {
-                break;
-            }
-        }
+bool PciDatabase::map_pci_ids(const std::string &fileName) {
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    pci_ids = static_cast<const char *>(p);
+    pci_ids_size = st.st_size;
+    return true;
+}
 
-        if (level == 0) {
-            device_id = sub_vendor_id = sub_device_id = -1;
-            bResult = parse_level_0(info, len, &idtype, &vendor_id, &idx);
-            std::string name = info.substr(idx);
-            verdor_name = name.erase(0, name.find_first_not_of(' '));
-        } else if (level == 1) {
-            device_id = sub_vendor_id = sub_device_id = -1;
-            bResult = parse_level_1(info, len, &idtype, &device_id, &idx);
-            std::string name = info.substr(idx);
-            device_name = name.erase(0, name.find_first_not_of(' '));
-
-            if (idtype != ID_KNOWN_D_CLASS) {
-                add_switch_device(vendor_id, device_id, verdor_name, device_name,
-                                  sub_vendor_id, sub_device_id, sub_s_name);
-            }
-            //device_name.erase();
-        } else if (level == 2) {
-            sub_vendor_id = sub_device_id = -1;
-            bResult = parse_level_2(info, len, &idtype, &sub_vendor_id, &sub_device_id, &idx);
-            std::string name = info.substr(idx);
-            sub_s_name = name.erase(0, name.find_first_not_of(' '));
-            if (idtype != ID_KNOWN_D_CLASS) {
-                add_switch_device(vendor_id, device_id, verdor_name, device_name,
-                                  sub_vendor_id, sub_device_id, sub_s_name);
-            }
-            //sub_s_name.erase();
+bool PciDatabase::parse_hex(const char *p, const char *end, int digits, int32_t *value) {
+    if (end - p < digits) {
+        return false;
+    }
+    int32_t v = 0;
+    for (int i = 0; i < digits; i++) {
+        char c = p[i];
+        if (c >= '0' && c <= '9') {
+            v = v * 16 + (c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            v = v * 16 + (c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            v = v * 16 + (c - 'A' + 10);
         } else {
-            // level 3 if not defined, the code should not be here, just ignore this line
-            continue;
+            return false;
         }
     }
-
-    return bResult;
+    *value = v;
+    return true;
 }
 
-bool PciDatabase::parse_level_0(const std::string &info, int len,
-                                id_type *type, int *vendor_id, std::size_t *idx) {
-    bool bResult = false;
-    int min_level_0_len = 5;
-    if (info.at(0) == 'C' && len >= 2 && is_blank_space(info.at(1))) {
-        // known device classes, subclasses and programming interfaces
-        if (len > min_level_0_len) {
-            *vendor_id = std::stoi(info.substr(2, 2).c_str(), nullptr, 16);
-            if (*vendor_id >= 0) {
-                *type = ID_KNOWN_D_CLASS;
-                *idx = min_level_0_len;
-                bResult = true;
+void PciDatabase::index_vendors() {
+    vendors.clear();
+    if (pci_ids == nullptr) {
+        return;
+    }
+    // a vendor line is "vvvv  name" without indent, its devices follow until the next line without indent
+    const char *end = pci_ids + pci_ids_size;
+    const char *line = pci_ids;
+    VendorLines *current = nullptr;
+    while (line < end) {
+        const char *next = static_cast<const char *>(memchr(line, '\n', end - line));
+        next = next == nullptr ? end : next + 1;
+        char c = *line;
+        if (c != '\t' && c != '#' && c != '\n' && c != '\r') {
+            if (current != nullptr) {
+                current->end = line - pci_ids;
+                current = nullptr;
             }
-        }
-    } else if (info.at(0) >= 'A' && info.at(0) <= 'Z' && len >= 2 && is_blank_space(info.at(1))) {
-        *type = ID_UNKNOWN;
-        bResult = true;
-    } else {
-        if (len > min_level_0_len) {
-            *vendor_id = std::stoi(info.substr(0, 4).c_str(), nullptr, 16);
-            if (*vendor_id >= 0 && is_blank_space(info.at(4))) {
-                *type = ID_VENDOR;
-                *idx = min_level_0_len;
-                bResult = true;
+            int32_t vendor_id;
+            if (next - line > 5 && parse_hex(line, end, 4, &vendor_id) && is_blank_space(line[4])) {
+                vendors.push_back({vendor_id, (std::size_t)(next - pci_ids), pci_ids_size});
+                current = &vendors.back();
             }
         }
+        line = next;
     }
-    return bResult;
+    std::stable_sort(vendors.begin(), vendors.end(), [](const VendorLines &a, const VendorLines &b) {
+        return a.vendor_id < b.vendor_id;
+    });
+    XPUM_LOG_TRACE("PciDatabase::index_vendors()- {} vendors", vendors.size());
 }
 
-bool PciDatabase::parse_level_1(const std::string &info, int len, id_type *type,
-                                int *device_id, std::size_t *idx) {
-    bool bResult = false;
-    int start = 1;
-    int min_level_1_len;
-    switch (*type) {
-        case ID_UNKNOWN: {
-            bResult = true;
-        } break;
-        case ID_KNOWN_D_CLASS: {
-            min_level_1_len = start + 3;
-            *device_id = std::stoi(info.substr(start, 2).c_str(), nullptr, 16);
-            if (*device_id >= 0 && is_blank_space(info.at(start + 2))) {
-                *idx = min_level_1_len;
-                bResult = true;
+bool PciDatabase::lookup_pci_ids(int32_t vendor_id, int32_t device_id, PcieDevice &device) {
+    static const char switch_string[] = " Switch ";
+    auto range = std::equal_range(vendors.begin(), vendors.end(), VendorLines{vendor_id, 0, 0},
+                                  [](const VendorLines &a, const VendorLines &b) {
+                                      return a.vendor_id < b.vendor_id;
+                                  });
+    bool found = false;
+    for (auto it = range.first; it != range.second; ++it) {
+        const char *end = pci_ids + it->end;
+        const char *line = pci_ids + it->begin;
+        bool in_device = false;
+        while (line < end) {
+            const char *eol = static_cast<const char *>(memchr(line, '\n', end - line));
+            eol = eol == nullptr ? end : eol;
+            const char *p = line;
+            while (p < eol && is_blank_space(*p)) {
+                p++;
             }
-        } break;
-        case ID_VENDOR:
-        case ID_DEVICE:
-        case ID_SUB_SYS: {
-            min_level_1_len = start + 5;
-            if (len > min_level_1_len) {
-                *device_id = std::stoi(info.substr(start, 4).c_str(), nullptr, 16);
-                if (*device_id >= 0 && is_blank_space(info.at(start + 4))) {
-                    *type = ID_DEVICE;
-                    *idx = min_level_1_len;
-                    bResult = true;
-                }
+            if (p == eol || *p == '#') {
+                line = eol + 1;
+                continue;
             }
-        } break;
-    }
-    return bResult;
-}
-
-bool PciDatabase::parse_level_2(const std::string &info, int len, id_type *type,
-                                int *sub_vendor_id, int *sub_device_id, std::size_t *idx) {
-    bool bResult = false;
-    int start = 2;
-    int min_level_2_len;
-    switch (*type) {
-        case ID_UNKNOWN: {
-            bResult = true;
-        } break;
-        case ID_KNOWN_D_CLASS: {
-            min_level_2_len = 5;
-            bResult = true;
-        } break;
-        case ID_DEVICE:
-        case ID_SUB_SYS: {
-            min_level_2_len = 12;
-            if (len > min_level_2_len) {
-                *sub_vendor_id = std::stoi(info.substr(start, 4), nullptr, 16);
-                if (*sub_vendor_id >= 0 && is_blank_space(info.at(start + 4))) {
-                    start = start + 5;
-                    *sub_device_id = std::stoi(info.substr(start, 4), nullptr, 16);
-                    if (*sub_device_id >= 0 && is_blank_space(info.at(start + 4))) {
-                        *type = ID_SUB_SYS;
-                        bResult = true;
-                        *idx = min_level_2_len;
+            int level = 0;
+            while (line + level < eol && line[level] == '\t') {
+                level++;
+            }
+            int32_t id;
+            if (level == 1) {
+                // "\tdddd  device name"
+                in_device = eol - line > 6 && parse_hex(line + 1, eol, 4, &id) && is_blank_space(line[5]) && id == device_id;
+                if (in_device) {
+                    const char *name = line + 6;
+                    while (name < eol && *name == ' ') {
+                        name++;
+                    }
+                    if (name < eol && std::search(name, eol, switch_string, switch_string + sizeof(switch_string) - 1) != eol) {
+                        device.sub_v_id = -1;
+                        device.sub_d_id = -1;
+                        found = true;
+                    }
+                }
+            } else if (level == 2 && in_device) {
+                // "\t\tssss ssss  subsystem name"
+                int32_t sub_v_id, sub_d_id;
+                if (eol - line > 12 && parse_hex(line + 2, eol, 4, &sub_v_id) && is_blank_space(line[6]) &&
+                    parse_hex(line + 7, eol, 4, &sub_d_id) && is_blank_space(line[11])) {
+                    const char *name = line + 12;
+                    while (name < eol && *name == ' ') {
+                        name++;
+                    }
+                    if (name < eol && std::search(name, eol, switch_string, switch_string + sizeof(switch_string) - 1) != eol) {
+                        device.sub_v_id = sub_v_id;
+                        device.sub_d_id = sub_d_id;
+                        found = true;
                     }
                 }
             }
-        } break;
-        case ID_VENDOR: {
-            XPUM_LOG_DEBUG("PciDatabase::parse_level_2() error- unknow device.");
-            bResult = true;
-        } break;
+            line = eol + 1;
+        }
     }
-
-    return bResult;
+    if (found) {
+        device.type = DV_SWITCH;
+        XPUM_LOG_DEBUG("PciDatabase::lookup_pci_ids {}", device.tostring());
+    }
+    return found;
 }
 
 bool PciDatabase::is_blank_space(const char c) {
@@ -315,11 +275,11 @@ void PciDatabase::parse_device_config(std::ifstream &fstream) {
                 PcieDevice device = {DV_UNKNOW, false, vendor_id, device_id, 0, 0};
 
                 if (info.at(start) == '0') {
-                    int ret = devices.erase(std::make_pair(vendor_id, device_id));
-                    XPUM_LOG_TRACE("PciDatabase::parse_switch_config()- remove d_id:v_id = [{}:{}] count:{}", vendor_id, device_id, ret);
+                    config_devices[std::make_pair(vendor_id, device_id)] = device;
+                    XPUM_LOG_TRACE("PciDatabase::parse_switch_config()- remove d_id:v_id = [{}:{}]", vendor_id, device_id);
                 } else if (info.at(start) == '1') {
                     device.type = DV_SWITCH;
-                    devices[std::make_pair(vendor_id, device_id)] = device;
+                    config_devices[std::make_pair(vendor_id, device_id)] = device;
                 } else if (info.at(start) == '2') {
                     start++;
                     device.type = DV_GRAPHIC;
@@ -347,7 +307,7 @@ void PciDatabase::parse_device_config(std::ifstream &fstream) {
                         device.device_name = info.substr(start);
                         XPUM_LOG_TRACE("PciDatabase::parse_switch_config()- device_name:{}", device.device_name);
                     }
-                    devices[std::make_pair(vendor_id, device_id)] = device;
+                    config_devices[std::make_pair(vendor_id, device_id)] = device;
                 } else {
                     XPUM_LOG_DEBUG("PciDatabase::parse_switch_config() error- unknow value.");
                 }
@@ -356,33 +316,21 @@ void PciDatabase::parse_device_config(std::ifstream &fstream) {
     }
 }
 
-void PciDatabase::add_switch_device(int32_t vendor_id, int32_t device_id, std::string &verdor_name,
-                                    std::string &device_name, int32_t sub_v_id, int32_t sub_d_id, std::string &sub_s_name) {
-    std::string switch_string = std::string(" Switch ");
-    PcieDevice device =
-        {DV_SWITCH, false, vendor_id, device_id, sub_v_id, sub_d_id};
-
-    if (sub_v_id >= 0 && sub_d_id >= 0 && !sub_s_name.empty()) {
-        if (sub_s_name.find(switch_string) != std::string::npos) {
-            XPUM_LOG_DEBUG("PciDatabase::add_switch_device {}", device.tostring());
-            devices[std::make_pair(vendor_id, device_id)] = device;
-        }
-    } else if (vendor_id >= 0 && device_id >= 0 && !device_name.empty()) {
-        if (device_name.find(switch_string) != std::string::npos) {
-            XPUM_LOG_DEBUG("PciDatabase::add_switch_device {}", device.tostring());
-            devices[std::make_pair(vendor_id, device_id)] = device;
-        }
-    } else {
-        XPUM_LOG_DEBUG("PciDatabase::add_switch_device() error- unknow device {}.", device.tostring());
-    }
-}
-
 const PcieDevice *PciDatabase::getDevice(int32_t vendor_id, int32_t device_id) {
     std::unique_lock<std::mutex> lock(mutex);
 
-    device_map::iterator it = devices.find(std::make_pair(vendor_id, device_id));
+    pair key = std::make_pair(vendor_id, device_id);
+    device_map::iterator it = config_devices.find(key);
+    if (it == config_devices.end()) {
+        it = devices.find(key);
+        if (it == devices.end()) {
+            PcieDevice device = {DV_UNKNOW, false, vendor_id, device_id, -1, -1};
+            lookup_pci_ids(vendor_id, device_id, device);
+            it = devices.emplace(key, device).first;
+        }
+    }
 
-    if (it != devices.end()) {
+    if (it->second.type != DV_UNKNOW) {
         return &it->second;
     }
 
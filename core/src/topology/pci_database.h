@@ -6,15 +6,20 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <mutex>
 #include <string>
+#include <vector>
 
 namespace xpum {
 
 /**
- * Class to parse "pci.ids" and "pci.conf" file, save pcie switch and build-in device info.
- * 
+ * Class to look up the pcie switches and build-in devices in "pci.ids" and "pci.conf".
+ *
+ * "pci.ids" is mapped into memory and indexed by vendor, only the lines of the vendor
+ * of a device are parsed when it is first looked up. "pci.conf" is small and parsed at once.
  */
 
 enum DeviceType {
@@ -36,14 +41,6 @@ struct PcieDevice {
     }
 };
 
-enum id_type {
-    ID_UNKNOWN,
-    ID_VENDOR,
-    ID_DEVICE,
-    ID_SUB_SYS,
-    ID_KNOWN_D_CLASS
-};
-
 class PciDatabase {
    public:
     static PciDatabase &instance();
@@ -59,24 +56,39 @@ class PciDatabase {
 
     bool init();
 
-    bool parse_pci_device(std::ifstream &fstream);
-    bool parse_level_0(const std::string &info, int len, id_type *type, int *vendor_id, std::size_t *idx);
-    bool parse_level_1(const std::string &info, int len, id_type *type, int *device_id, std::size_t *idx);
-    bool parse_level_2(const std::string &info, int len, id_type *type, int *sub_vendor_id,
-                       int *sub_device_id, std::size_t *idx);
+    bool map_pci_ids(const std::string &fileName);
+
+    // the offsets of the lines of each vendor in the mapped file, sorted by vendor id
+    void index_vendors();
+
+    // parse the lines of the vendor for the device, false if it is not a switch
+    bool lookup_pci_ids(int32_t vendor_id, int32_t device_id, PcieDevice &device);
+
+    static bool parse_hex(const char *p, const char *end, int digits, int32_t *value);
 
     void parse_device_config(std::ifstream &fstream);
 
     bool is_blank_space(const char c);
 
-    void add_switch_device(int32_t vendor_id, int32_t device_id, std::string &verdor_name,
-                           std::string &device_name, int32_t sub_v_id, int32_t sub_d_id, std::string &sub_s_name);
-
     bool bInitialized;
     std::mutex mutex;
     typedef std::pair<int32_t, int32_t> pair;
     typedef std::map<pair, PcieDevice> device_map;
 
+    struct VendorLines {
+        int32_t vendor_id;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    const char *pci_ids;
+    std::size_t pci_ids_size;
+    std::vector<VendorLines> vendors;
+
+    // the devices of pci.conf, they replace those of pci.ids, DV_UNKNOW if removed
+    device_map config_devices;
+
+    // the devices looked up in pci.ids, DV_UNKNOW if not a switch
     device_map devices;
 };
 } // end namespace xpum
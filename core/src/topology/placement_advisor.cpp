@@ -0,0 +1,162 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file placement_advisor.cpp
+ */
+
+#include "placement_advisor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <set>
+
+#include "topology.h"
+
+namespace xpum {
+
+// the PCIe bridges assumed between devices whose path is unknown
+static const int UNKNOWN_PCIE_HOPS = 8;
+
+int PlacementAdvisor::linkCost(const std::vector<PlacementDevice>& devices,
+                               const std::vector<std::vector<int>>& xelinkLanes,
+                               const std::vector<std::vector<int>>& pcieHops,
+                               size_t i, size_t j) {
+    if (xelinkLanes[i][j] > 0) {
+        return 1;
+    }
+    int hops = pcieHops[i][j] < 0 ? UNKNOWN_PCIE_HOPS : pcieHops[i][j];
+    int cost = 10 + 10 * hops;
+    if (devices[i].numaIdx != devices[j].numaIdx) {
+        cost += 100;
+    }
+    return cost;
+}
+
+int PlacementAdvisor::ringCost(const std::vector<std::vector<int>>& costs, const std::vector<size_t>& ring) {
+    int cost = 0;
+    for (size_t k = 0; k < ring.size(); k++) {
+        cost += costs[ring[k]][ring[(k + 1) % ring.size()]];
+    }
+    return cost;
+}
+
+void PlacementAdvisor::advise(const std::vector<PlacementDevice>& devices,
+                              const std::vector<std::vector<int>>& xelinkLanes,
+                              const std::vector<std::vector<int>>& pcieHops,
+                              xpum_placement_advice_t& advice) {
+    size_t n = devices.size();
+    std::vector<std::vector<int>> costs(n, std::vector<int>(n, 0));
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            if (i != j) {
+                costs[i][j] = linkCost(devices, xelinkLanes, pcieHops, i, j);
+            }
+        }
+    }
+
+    // the nearest neighbor ring from each device, improved by 2-opt
+    std::vector<size_t> best;
+    int bestCost = std::numeric_limits<int>::max();
+    for (size_t start = 0; start < n; start++) {
+        std::vector<size_t> ring = {start};
+        std::vector<bool> visited(n, false);
+        visited[start] = true;
+        while (ring.size() < n) {
+            size_t last = ring.back(), next = n;
+            for (size_t j = 0; j < n; j++) {
+                if (!visited[j] && (next == n || costs[last][j] < costs[last][next])) {
+                    next = j;
+                }
+            }
+            visited[next] = true;
+            ring.push_back(next);
+        }
+        bool improved = true;
+        while (improved) {
+            improved = false;
+            for (size_t a = 1; a + 1 < n; a++) {
+                for (size_t b = a + 1; b < n; b++) {
+                    size_t prev = ring[a - 1], first = ring[a], last = ring[b], next = ring[(b + 1) % n];
+                    if (costs[prev][last] + costs[first][next] < costs[prev][first] + costs[last][next]) {
+                        std::reverse(ring.begin() + a, ring.begin() + b + 1);
+                        improved = true;
+                    }
+                }
+            }
+        }
+        int cost = ringCost(costs, ring);
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = ring;
+        }
+    }
+    // the ring starts at the first device requested
+    auto first = std::find(best.begin(), best.end(), 0);
+    std::rotate(best.begin(), first, best.end());
+
+    // the minimum spanning tree rooted at the first device of the ring
+    std::vector<int> parent(n, -1);
+    std::vector<int> distance(n, std::numeric_limits<int>::max());
+    std::vector<bool> inTree(n, false);
+    if (n > 0) {
+        distance[best.front()] = 0;
+    }
+    for (size_t k = 0; k < n; k++) {
+        size_t u = n;
+        for (size_t j = 0; j < n; j++) {
+            if (!inTree[j] && (u == n || distance[j] < distance[u])) {
+                u = j;
+            }
+        }
+        inTree[u] = true;
+        for (size_t j = 0; j < n; j++) {
+            if (!inTree[j] && costs[u][j] < distance[j]) {
+                distance[j] = costs[u][j];
+                parent[j] = u;
+            }
+        }
+    }
+
+    memset(&advice, 0, sizeof(advice));
+    advice.count = n;
+    std::set<int> cpus;
+    std::set<int32_t> numaNodes;
+    for (size_t k = 0; k < n; k++) {
+        size_t i = best[k], next = best[(k + 1) % n];
+        auto& placement = advice.devices[k];
+        placement.deviceId = devices[i].deviceId;
+        placement.numaIdx = devices[i].numaIdx;
+        std::size_t len = devices[i].cpuAffinity.copy(placement.cpuAffinity, XPUM_MAX_CPU_LIST_LEN - 1);
+        placement.cpuAffinity[len] = '\0';
+        placement.treeParent = parent[i] < 0 ? -1 : devices[parent[i]].deviceId;
+        Topology::parseCpuList(devices[i].cpuAffinity, cpus);
+        if (devices[i].numaIdx >= 0) {
+            numaNodes.insert(devices[i].numaIdx);
+        }
+
+        if (n == 1) {
+            placement.nextLinkType = XPUM_LINK_SELF;
+        } else if (xelinkLanes[i][next] > 0) {
+            placement.nextLinkType = XPUM_LINK_XE;
+            advice.ringXelinkHops++;
+        } else {
+            placement.nextPcieHops = pcieHops[i][next] < 0 ? 0 : pcieHops[i][next];
+            advice.ringPcieHops += placement.nextPcieHops;
+            if (devices[i].numaIdx == devices[next].numaIdx) {
+                placement.nextLinkType = XPUM_LINK_NODE;
+            } else {
+                placement.nextLinkType = XPUM_LINK_SYS;
+                advice.ringCrossNumaHops++;
+            }
+        }
+    }
+    std::string cpuList = Topology::formatCpuList(cpus);
+    std::size_t len = cpuList.copy(advice.cpuList, XPUM_MAX_CPU_LIST_LEN - 1);
+    advice.cpuList[len] = '\0';
+    for (auto numa : numaNodes) {
+        advice.numaNodes[advice.numaNodeCount++] = numa;
+    }
+}
+
+} // namespace xpum
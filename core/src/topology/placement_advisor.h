@@ -0,0 +1,46 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file placement_advisor.h
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../include/xpum_structs.h"
+
+namespace xpum {
+
+struct PlacementDevice {
+    xpum_device_id_t deviceId;
+    int32_t numaIdx;
+    std::string cpuAffinity;
+};
+
+/*
+  PlacementAdvisor orders a device set for the collectives. The ring visits
+  the devices over Xe Link where it can, then over the fewest PCIe bridges
+  within a NUMA node, and crosses the NUMA nodes as few times as it can. The
+  tree is the minimum spanning tree over the same link costs.
+*/
+class PlacementAdvisor {
+   public:
+    // xelinkLanes[i][j] are the Xe Link lanes and pcieHops[i][j] the PCIe bridges between
+    // devices[i] and devices[j], -1 if unknown
+    static void advise(const std::vector<PlacementDevice>& devices,
+                       const std::vector<std::vector<int>>& xelinkLanes,
+                       const std::vector<std::vector<int>>& pcieHops,
+                       xpum_placement_advice_t& advice);
+
+   private:
+    static int linkCost(const std::vector<PlacementDevice>& devices,
+                        const std::vector<std::vector<int>>& xelinkLanes,
+                        const std::vector<std::vector<int>>& pcieHops,
+                        size_t i, size_t j);
+
+    static int ringCost(const std::vector<std::vector<int>>& costs, const std::vector<size_t>& ring);
+};
+
+} // namespace xpum
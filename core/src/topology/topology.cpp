@@ -7,6 +7,11 @@
 #include "topology.h"
 
 #include <assert.h>
+#include <linux/netlink.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <fstream>
@@ -17,8 +22,11 @@
 
 #include "core/core.h"
 #include "hwinfo.h"
+#include "infrastructure/configuration.h"
 #include "infrastructure/device_property.h"
 #include "infrastructure/logger.h"
+#include "infrastructure/numa_memory.h"
+#include "infrastructure/thread_factory.h"
 #include "pci_database.h"
 #include "xe_link.h"
 
@@ -26,6 +34,13 @@ namespace xpum {
 hwloc_topology_t *Topology::hwtopology = nullptr;
 std::mutex Topology::mutex;
 int Topology::maxTraversingLevel = 4;
+hwloc_topology_t *Topology::fullTopology = nullptr;
+std::string Topology::xmlCache;
+std::string Topology::xmlCacheKey;
+std::map<std::string, std::pair<int, std::string>> Topology::numaCache;
+int Topology::ueventFd = -2;
+std::vector<xpum_xe_link_matrix_entry_t> Topology::xeLinkMatrix;
+uint64_t Topology::version = 1;
 /* According to the hardware design, a ATS-M3 package includes two ATS-M3 SOCs and a internal pci switch which is
    connected between two SOCs and outside. And the internal pci switch contains 4 level pci address mapping.
    In some multi-ATS-M3 system (ex: 10-ATS-M3-package server), there are also a series of external pci switches to bridge
@@ -41,13 +56,88 @@ Topology::~Topology() {
     XPUM_LOG_INFO("~Topology()");
 }
 
+void Topology::destroyTopology(hwloc_topology_t*& topo) {
+    if (topo != nullptr) {
+        hwloc_topology_destroy(*topo);
+        delete topo;
+        topo = nullptr;
+    }
+}
+
 void Topology::clearTopology(){
     XPUM_LOG_INFO("Clear Topology()");
-    if (hwtopology != nullptr) {
-        hwloc_topology_destroy( *hwtopology);
-        delete hwtopology;
-        hwtopology = nullptr;
+    std::unique_lock<std::mutex> lock(mutex);
+    destroyTopology(hwtopology);
+    destroyTopology(fullTopology);
+    xmlCache.clear();
+    xmlCacheKey.clear();
+    numaCache.clear();
+    if (ueventFd >= 0) {
+        close(ueventFd);
+    }
+    ueventFd = -2;
+}
+
+/* The topologies are loaded once and kept until a PCI device is added, removed, or bound to or unbound
+   from a driver, which the kernel reports with a uevent. The caller holds the mutex.
+*/
+bool Topology::pciDevicesChanged() {
+    if (ueventFd == -2) {
+        ueventFd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+        if (ueventFd >= 0) {
+            struct sockaddr_nl addr = {};
+            addr.nl_family = AF_NETLINK;
+            addr.nl_groups = 1;
+            if (bind(ueventFd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+                close(ueventFd);
+                ueventFd = -1;
+            }
+        }
+        if (ueventFd < 0) {
+            XPUM_LOG_WARN("Failed to listen to the kernel uevents, PCI hotplug is not tracked by the topology");
+        }
+        return false;
+    }
+    if (ueventFd < 0) {
+        return false;
+    }
+
+    bool changed = false;
+    char buf[8192];
+    while (true) {
+        ssize_t len = recv(ueventFd, buf, sizeof(buf) - 1, MSG_DONTWAIT);
+        if (len < 0) {
+            // the events dropped by an overflow may be PCI ones
+            if (errno == ENOBUFS) {
+                changed = true;
+                continue;
+            }
+            break;
+        }
+        buf[len] = '\0';
+        // the header is like "add@/devices/pci0000:00/0000:00:01.0"
+        std::string header(buf);
+        std::size_t at = header.find('@');
+        if (at == std::string::npos) {
+            continue;
+        }
+        std::string action = header.substr(0, at);
+        if ((action == "add" || action == "remove" || action == "bind" || action == "unbind" || action == "move") &&
+            header.compare(at + 1, 12, "/devices/pci") == 0) {
+            changed = true;
+        }
     }
+    if (changed) {
+        XPUM_LOG_INFO("PCI devices changed, reload the topology");
+        destroyTopology(hwtopology);
+        destroyTopology(fullTopology);
+        xmlCache.clear();
+        xmlCacheKey.clear();
+        numaCache.clear();
+        xeLinkMatrix.clear();
+        version++;
+    }
+    return changed;
 }
 
 std::string Topology::getLocalCpus(std::string address) {
@@ -65,10 +155,9 @@ std::string Topology::getLocalCpus(std::string address) {
 }
 
 void Topology::reNewTopology(bool reload){
-    if (reload == true && hwtopology != nullptr) {
-        hwloc_topology_destroy(*hwtopology);
-        delete hwtopology;
-        hwtopology = nullptr;
+    pciDevicesChanged();
+    if (reload == true) {
+        destroyTopology(hwtopology);
     }
 
     if (hwtopology == nullptr) {
@@ -79,6 +168,41 @@ void Topology::reNewTopology(bool reload){
     }
 }
 
+void Topology::preload() {
+    std::unique_lock<std::mutex> lock(mutex);
+    reNewTopology(false);
+}
+
+bool Topology::loadFullTopology() {
+    pciDevicesChanged();
+    if (fullTopology != nullptr) {
+        return true;
+    }
+
+    unsigned long flags = HWLOC_TOPOLOGY_FLAG_IMPORT_SUPPORT;
+    hwloc_topology_t* topo = new hwloc_topology_t();
+    hwloc_topology_init(topo);
+    hwloc_topology_set_userdata_export_callback(*topo, export_cb);
+    hwloc_topology_set_all_types_filter(*topo, HWLOC_TYPE_FILTER_KEEP_ALL);
+    hwloc_topology_set_io_types_filter(*topo, HWLOC_TYPE_FILTER_KEEP_IMPORTANT);
+
+    int err = hwloc_topology_set_flags(*topo, flags);
+    if (err < 0) {
+        XPUM_LOG_ERROR("Failed to set flags {}  {}.\n", flags, strerror(errno));
+        destroyTopology(topo);
+        return false;
+    }
+
+    err = hwloc_topology_load(*topo);
+    if (err < 0) {
+        XPUM_LOG_ERROR("Failed to load topology {}.\n", strerror(errno));
+        destroyTopology(topo);
+        return false;
+    }
+    fullTopology = topo;
+    return true;
+}
+
 std::string Topology::getLocalCpusList(std::string address) {
     std::string affinity;
     std::ifstream infile;
@@ -93,6 +217,16 @@ std::string Topology::getLocalCpusList(std::string address) {
 
     return affinity;
 }
+
+int Topology::getNumaNode(std::string address) {
+    std::ifstream infile(std::string("/sys/bus/pci/devices/") + address + std::string("/numa_node"));
+    int node = -1;
+    if (!(infile >> node)) {
+        return -1;
+    }
+    return node;
+}
+
 /*Get the current pcie address as well as back-travsering its parent address(es) till non-bridge (non-pcie-switch) device\.
   Currently, ATS-M3 calls the function and fetches pcie address set ONLY.
 */
@@ -334,97 +468,120 @@ void Topology::export_cb(void* reserved, hwloc_topology_t topo, hwloc_obj_t obj)
 
 xpum_result_t Topology::topo2xml(char* buffer, int* buflen, std::map<device_pair, GraphicDevice>& device_map) {
     xpum_result_t result = XPUM_OK;
-    unsigned long flags = HWLOC_TOPOLOGY_FLAG_IMPORT_SUPPORT;
-    hwloc_topology_t hwtopology;
     hwloc_obj_t obj = nullptr;
     char* xmlbuf;
-    int xmlbuflen, err;
+    int xmlbuflen;
     std::vector<std::shared_ptr<char> > buffers;
 
-    hwloc_topology_init(&hwtopology);
-    hwloc_topology_set_userdata_export_callback(hwtopology, export_cb);
-    hwloc_topology_set_flags(hwtopology, HWLOC_TOPOLOGY_FLAG_IS_THISSYSTEM);
-    hwloc_topology_set_all_types_filter(hwtopology, HWLOC_TYPE_FILTER_KEEP_ALL);
-    hwloc_topology_set_io_types_filter(hwtopology, HWLOC_TYPE_FILTER_KEEP_IMPORTANT);
+    std::unique_lock<std::mutex> lock(mutex);
 
-    err = hwloc_topology_set_flags(hwtopology, flags);
-    if (err < 0) {
-        XPUM_LOG_ERROR("Failed to set flags {}  {}.\n", flags, strerror(errno));
-        hwloc_topology_destroy(hwtopology);
+    if (!loadFullTopology()) {
         return XPUM_GENERIC_ERROR;
     }
 
-    err = hwloc_topology_load(hwtopology);
-    if (err < 0) {
-        XPUM_LOG_ERROR("Failed to load topology {}.\n", strerror(errno));
-        hwloc_topology_destroy(hwtopology);
-        return XPUM_GENERIC_ERROR;
+    // the xml is exported again only when the topology or the device names change
+    std::ostringstream os;
+    for (auto& device : device_map) {
+        os << device.first.first << ":" << device.first.second << "=" << device.second.device_name << "\n";
     }
-
-    while ((obj = hwloc_get_next_pcidev(hwtopology, obj)) != nullptr) {
-        std::string name;
-        device_pair pare = std::make_pair(obj->attr->pcidev.vendor_id,
-                                          obj->attr->pcidev.device_id);
-        std::map<device_pair, GraphicDevice>::iterator it = device_map.find(pare);
-        if (it != device_map.end()) {
-            const PcieDevice* pDevice = PciDatabase::instance().getDevice(
-                obj->attr->pcidev.vendor_id, obj->attr->pcidev.device_id);
-
-            if (pDevice != nullptr) {
-                if (!pDevice->device_name.empty()) {
-                    name = pDevice->device_name.c_str();
+    std::string key = os.str();
+
+    if (xmlCache.empty() || key != xmlCacheKey) {
+        hwloc_topology_t hwtopology = *fullTopology;
+        while ((obj = hwloc_get_next_pcidev(hwtopology, obj)) != nullptr) {
+            std::string name;
+            device_pair pare = std::make_pair(obj->attr->pcidev.vendor_id,
+                                              obj->attr->pcidev.device_id);
+            std::map<device_pair, GraphicDevice>::iterator it = device_map.find(pare);
+            if (it != device_map.end()) {
+                const PcieDevice* pDevice = PciDatabase::instance().getDevice(
+                    obj->attr->pcidev.vendor_id, obj->attr->pcidev.device_id);
+
+                if (pDevice != nullptr) {
+                    if (!pDevice->device_name.empty()) {
+                        name = pDevice->device_name.c_str();
+                    }
                 }
-            }
 
-            if (name.empty()) {
-                name = it->second.device_name;
-            }
-            std::shared_ptr<char> tmpBuffer(static_cast<char*>(malloc(512)), free);
-            if (tmpBuffer != nullptr && tmpBuffer.get() != nullptr) {
-                buffers.push_back(tmpBuffer);
-                memset(tmpBuffer.get(), 0, 512);
-
-                if (!name.empty()) {
-                    strncpy(tmpBuffer.get(), name.c_str(), name.length() >= 511? 511:name.length());
-                    obj->userdata = (void*)tmpBuffer.get();
+                if (name.empty()) {
+                    name = it->second.device_name;
+                }
+                std::shared_ptr<char> tmpBuffer(static_cast<char*>(malloc(512)), free);
+                if (tmpBuffer != nullptr && tmpBuffer.get() != nullptr) {
+                    buffers.push_back(tmpBuffer);
+                    memset(tmpBuffer.get(), 0, 512);
+
+                    if (!name.empty()) {
+                        strncpy(tmpBuffer.get(), name.c_str(), name.length() >= 511? 511:name.length());
+                        obj->userdata = (void*)tmpBuffer.get();
+                    }
                 }
             }
         }
-    }
 
-    if (hwloc_topology_export_xmlbuffer(hwtopology, &xmlbuf, &xmlbuflen, 0) < 0) {
-        XPUM_LOG_ERROR("XML buffer export failed {}", strerror(errno));
-        result = XPUM_GENERIC_ERROR;
-    } else {
-        if (buffer != nullptr) {
-            if (*buflen <= xmlbuflen) {
-                *buflen = xmlbuflen + 1;
-                result = XPUM_BUFFER_TOO_SMALL;
-            } else {
-                *buflen = xmlbuflen;
-                memcpy(buffer, xmlbuf, xmlbuflen);
-                buffer[xmlbuflen] = 0;
-            }
-        } else {
-            *buflen = xmlbuflen + 1;
+        int err = hwloc_topology_export_xmlbuffer(hwtopology, &xmlbuf, &xmlbuflen, 0);
+        // the names are freed with buffers, the kept topology must not point to them
+        obj = nullptr;
+        while ((obj = hwloc_get_next_pcidev(hwtopology, obj)) != nullptr) {
+            obj->userdata = nullptr;
         }
+        if (err < 0) {
+            XPUM_LOG_ERROR("XML buffer export failed {}", strerror(errno));
+            return XPUM_GENERIC_ERROR;
+        }
+        xmlCache.assign(xmlbuf, xmlbuflen);
+        xmlCacheKey = key;
         hwloc_free_xmlbuffer(hwtopology, xmlbuf);
     }
 
-    hwloc_topology_destroy(hwtopology);
+    xmlbuflen = xmlCache.size();
+    if (buffer != nullptr) {
+        if (*buflen <= xmlbuflen) {
+            *buflen = xmlbuflen + 1;
+            result = XPUM_BUFFER_TOO_SMALL;
+        } else {
+            *buflen = xmlbuflen;
+            memcpy(buffer, xmlCache.data(), xmlbuflen);
+            buffer[xmlbuflen] = 0;
+        }
+    } else {
+        *buflen = xmlbuflen + 1;
+    }
     return result;
 }
 
 xpum_result_t Topology::getXelinkTopo(std::vector<std::shared_ptr<Device>>& devices, std::vector<xpum_fabric_port_pair>& fabricPorts) {
     xpum_result_t result = XPUM_GENERIC_ERROR;
-    hwloc_topology_t topology;
     bool bNuma = false;
 
-    hwloc_topology_init(&topology);
-    hwloc_topology_set_flags(topology, HWLOC_TOPOLOGY_FLAG_IS_THISSYSTEM);
-    hwloc_topology_set_all_types_filter(topology, HWLOC_TYPE_FILTER_KEEP_ALL);
-    hwloc_topology_set_io_types_filter(topology, HWLOC_TYPE_FILTER_KEEP_IMPORTANT);
-    hwloc_topology_load(topology);
+    // only the NUMA nodes are cached, the port states are read for every call
+    std::map<std::string, std::pair<int, std::string>> numaNodes;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        bool loaded = loadFullTopology();
+        for (auto& info : devices) {
+            Property prop;
+            if (!info->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_BDF_ADDRESS, prop)) {
+                continue;
+            }
+            std::string bdfAddress = prop.getValue();
+            auto it = numaCache.find(bdfAddress);
+            if (it == numaCache.end() && loaded) {
+                std::string cpuAffinity = "";
+                unsigned int numa_os_idx = (unsigned)-1;
+                zes_pci_address_t address;
+                getBDF(bdfAddress, address);
+                bNuma = numaDevice(*fullTopology, address, numa_os_idx, cpuAffinity);
+                if (bNuma) {
+                    XPUM_LOG_DEBUG("NUMA: idx {} addr {} affinity {}", numa_os_idx, bdfAddress, cpuAffinity);
+                }
+                it = numaCache.emplace(bdfAddress, std::make_pair((int)numa_os_idx, cpuAffinity)).first;
+            }
+            if (it != numaCache.end()) {
+                numaNodes[bdfAddress] = it->second;
+            }
+        }
+    }
 
     std::string xeLinkStr("XeLink");
     for (size_t j = 0; j < devices.size(); j++) {
@@ -440,15 +597,14 @@ xpum_result_t Topology::getXelinkTopo(std::vector<std::shared_ptr<Device>>& devi
         }
         bdfAddress = prop.getValue();
 
-        zes_pci_address_t address;
-        getBDF(bdfAddress, address);
-        bNuma = numaDevice(topology, address, numa_os_idx, cpuAffinity);
-        if (bNuma) {
-           XPUM_LOG_DEBUG("NUMA: idx {} addr {} affinity {}", numa_os_idx, bdfAddress, cpuAffinity);
+        auto numa = numaNodes.find(bdfAddress);
+        if (numa != numaNodes.end()) {
+            numa_os_idx = (unsigned)numa->second.first;
+            cpuAffinity = numa->second.second;
         }
         result = XPUM_OK;
 
-        bool bResult = xpum::Core::instance().getDeviceManager()->getFabricPorts(
+        bool bResult = xpum::Core::instance().getMonitorManager()->getFabricPorts(
             info->getId(), portInfo);
         if (!bResult) {
             XPUM_LOG_WARN("getFabricPorts result {}",bResult);
@@ -509,10 +665,134 @@ xpum_result_t Topology::getXelinkTopo(std::vector<std::shared_ptr<Device>>& devi
         }
     }
 
-    hwloc_topology_destroy(topology);
     return result;
 }
 
+int Topology::getPcieHops(std::string bdfAddress1, std::string bdfAddress2) {
+    zes_pci_address_t addresses[2];
+    getBDF(bdfAddress1, addresses[0]);
+    getBDF(bdfAddress2, addresses[1]);
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    reNewTopology(false);
+
+    // the ancestors of each device, from the device itself to the root
+    std::vector<hwloc_obj_t> paths[2];
+    for (int i = 0; i < 2; i++) {
+        hwloc_obj_t obj = nullptr;
+        while ((obj = hwloc_get_next_pcidev(*hwtopology, obj)) != nullptr) {
+            if (obj->attr->pcidev.domain == addresses[i].domain && obj->attr->pcidev.bus == addresses[i].bus && obj->attr->pcidev.dev == addresses[i].device && obj->attr->pcidev.func == addresses[i].function) {
+                break;
+            }
+        }
+        if (obj == nullptr) {
+            return -1;
+        }
+        for (; obj != nullptr; obj = obj->parent) {
+            paths[i].push_back(obj);
+        }
+    }
+
+    // the bridges below the lowest common ancestor, counted on both sides
+    int hops = 0;
+    for (int i = 0; i < 2; i++) {
+        for (auto obj : paths[i]) {
+            if (std::find(paths[1 - i].begin(), paths[1 - i].end(), obj) != paths[1 - i].end()) {
+                break;
+            }
+            if (obj->type == HWLOC_OBJ_BRIDGE) {
+                hops++;
+            }
+        }
+    }
+    return hops;
+}
+
+bool Topology::parseCpuList(const std::string& cpuList, std::set<int>& cpus) {
+    std::stringstream ss(cpuList);
+    std::string range;
+    try {
+        while (std::getline(ss, range, ',')) {
+            range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+            if (range.empty()) {
+                continue;
+            }
+            std::size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.insert(cpu);
+            }
+        }
+    } catch (std::exception& e) {
+        return false;
+    }
+    return true;
+}
+
+std::string Topology::formatCpuList(const std::set<int>& cpus) {
+    std::ostringstream os;
+    for (auto it = cpus.begin(); it != cpus.end();) {
+        int first = *it, last = *it;
+        while (++it != cpus.end() && *it == last + 1) {
+            last = *it;
+        }
+        if (os.tellp() > 0) {
+            os << ",";
+        }
+        os << first;
+        if (last != first) {
+            os << "-" << last;
+        }
+    }
+    return os.str();
+}
+
+bool Topology::bindThreadToDevice(std::string bdfAddress) {
+    std::set<int> cpus;
+    if (!parseCpuList(getLocalCpusList(bdfAddress), cpus) || cpus.empty()) {
+        return false;
+    }
+    // the housekeeping CPUs still win over the CPUs local to the device
+    ThreadFactory::restrictToHousekeeping(cpus);
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for (int cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpuset);
+        }
+    }
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+    if (err != 0) {
+        XPUM_LOG_WARN("Failed to bind the thread to the CPUs {} of device {}: {}", formatCpuList(cpus), bdfAddress, strerror(err));
+        return false;
+    }
+    // what the thread allocates while it samples the device, the node of the housekeeping policy still wins
+    if (Configuration::HOUSEKEEPING_NODE < 0) {
+        NumaMemory::preferNode(getNumaNode(bdfAddress));
+    }
+    return true;
+}
+
+void Topology::setXeLinkMatrix(const std::vector<xpum_xe_link_matrix_entry_t>& entries) {
+    std::unique_lock<std::mutex> lock(mutex);
+    pciDevicesChanged();
+    xeLinkMatrix = entries;
+}
+
+std::vector<xpum_xe_link_matrix_entry_t> Topology::getXeLinkMatrix() {
+    std::unique_lock<std::mutex> lock(mutex);
+    pciDevicesChanged();
+    return xeLinkMatrix;
+}
+
+uint64_t Topology::getVersion() {
+    std::unique_lock<std::mutex> lock(mutex);
+    pciDevicesChanged();
+    return version;
+}
+
 bool Topology::numaDevice(hwloc_topology_t topology, zes_pci_address_t& address,
                           unsigned int& numa_os_idx, std::string& cpuAffinity) {
     hwloc_obj_t objNuma = nullptr, obj_anc = nullptr;
@@ -7,6 +7,7 @@
 #pragma once
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -48,17 +49,50 @@ class Topology {
     static std::mutex mutex;
     static hwloc_topology_t *hwtopology;
     static int maxTraversingLevel;
+    // the topology with all object types, for the xml export and the NUMA nodes
+    static hwloc_topology_t *fullTopology;
+    // the last xml exported and the device names it was exported with
+    static std::string xmlCache;
+    static std::string xmlCacheKey;
+    // the NUMA node and the cpu affinity of the devices, keyed by BDF address
+    static std::map<std::string, std::pair<int, std::string>> numaCache;
+    // the NETLINK_KOBJECT_UEVENT socket, -1 if it can not be opened
+    static int ueventFd;
+    // the last Xe Link matrix measured
+    static std::vector<xpum_xe_link_matrix_entry_t> xeLinkMatrix;
+    // incremented every time the PCI devices change
+    static uint64_t version;
 
    public:
     static bool getPcieTopo(std::string bdfAddress, std::vector<zes_pci_address_t>& pcieAdds, bool checkDevice = true, bool reload = false);
     static xpum_result_t getSwitchTopo(std::string bdfAddress, xpum_topology_t* topology, std::size_t* memSize, bool reload = false);
     static std::string getLocalCpus(std::string address);
     static std::string getLocalCpusList(std::string address);
+    // the NUMA node the device is attached to, -1 if unknown
+    static int getNumaNode(std::string address);
     static void clearTopology();
 
     static xpum_result_t topo2xml(char* buffer, int* buflen, std::map<device_pair, GraphicDevice>& device_map);
     static xpum_result_t getXelinkTopo(std::vector<std::shared_ptr<Device>>& devices, std::vector<xpum_fabric_port_pair>& fabricPorts);
 
+    // the PCIe bridges between two devices, -1 if a device is not found
+    static int getPcieHops(std::string bdfAddress1, std::string bdfAddress2);
+    // a cpu list like "0-15,32-47"
+    static bool parseCpuList(const std::string& cpuList, std::set<int>& cpus);
+    static std::string formatCpuList(const std::set<int>& cpus);
+    // binds the calling thread to the CPUs local to the device and prefers the memory of its NUMA node
+    static bool bindThreadToDevice(std::string bdfAddress);
+
+    // the Xe Link matrix measured by the diagnostic manager, dropped when the PCI devices change
+    static void setXeLinkMatrix(const std::vector<xpum_xe_link_matrix_entry_t>& entries);
+    static std::vector<xpum_xe_link_matrix_entry_t> getXeLinkMatrix();
+
+    // changed every time the topologies are dropped for a change of the PCI devices
+    static uint64_t getVersion();
+
+    // load the hwloc topology of the PCI devices ahead of the first query
+    static void preload();
+
    private:
     static bool hasChildPciDevice(hwloc_obj_t obj, int32_t domain, int32_t bus, int32_t device, int32_t function);
     static bool isSwitchDevice(hwloc_obj_t obj);
@@ -66,6 +100,9 @@ class Topology {
     static void get_p_switch_dev_path(hwloc_obj_t par_obj, parent_switch* pSwitch);
     static std::string pci2RegxString(hwloc_obj_t obj);
     static void reNewTopology(bool reload);
+    static bool loadFullTopology();
+    static void destroyTopology(hwloc_topology_t*& topo);
+    static bool pciDevicesChanged();
 
     static void export_cb(void* reserved, hwloc_topology_t topo, hwloc_obj_t obj);
     static void getBDF(std::string bdfAddress, zes_pci_address_t& pciAddress);
@@ -13,14 +13,19 @@
 #include <algorithm>
 #include <sys/stat.h>
 #include <iomanip>
-#include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
 
 #include "./vgpu_manager.h"
 #include "core/core.h"
+#include "device/gpu/gpu_device_stub.h"
 #include "infrastructure/xpum_config.h"
 #include "infrastructure/configuration.h"
 #include "infrastructure/utility.h"
 #include "infrastructure/handle_lock.h"
+#include "infrastructure/vf_measurement_data.h"
 #include "xpum_api.h"
 
 namespace xpum {
@@ -49,20 +54,11 @@ static uint32_t getVFMaxNumberByPciDeviceId(int deviceId) {
     }
 }
 
-xpum_result_t VgpuManager::createVf(xpum_device_id_t deviceId, xpum_vgpu_config_t* param) {
-    XPUM_LOG_DEBUG("vgpuCreateVf, {}, {}, {}", deviceId, param->numVfs, param->lmemPerVf);
-    auto res = vgpuValidateDevice(deviceId);
-    if (res != XPUM_OK) {
-        return res;
-    }
-
-    DeviceSriovInfo deviceInfo;
+xpum_result_t VgpuManager::prepareCreateVf(xpum_device_id_t deviceId, xpum_vgpu_config_t* param, DeviceSriovInfo& deviceInfo, AttrFromConfigFile& attrs, uint64_t& lmem) {
     if (!loadSriovData(deviceId, deviceInfo)) {
         return XPUM_VGPU_SYSFS_ERROR;
     }
 
-    std::unique_lock<std::mutex> lock(mutex);
-
     std::string numVfsString;
     std::stringstream numVfsPath;
     numVfsPath << "/sys/class/drm/" << deviceInfo.drmPath << "/device/sriov_numvfs";
@@ -76,7 +72,7 @@ xpum_result_t VgpuManager::createVf(xpum_device_id_t deviceId, xpum_vgpu_config_
     }
 
     Property prop;
-    Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_DEVICE_ID, prop);
+    Core::instance().getDeviceManager()->getDevice(deviceId)->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_DEVICE_ID, prop);
     int pciDeviceId = std::stoi(prop.getValue().substr(2), nullptr, 16);
     if (param->numVfs == 0 || param->numVfs > getVFMaxNumberByPciDeviceId(pciDeviceId)){
         XPUM_LOG_ERROR("Configuration item for {} VFs out of range", param->numVfs);
@@ -87,7 +83,6 @@ xpum_result_t VgpuManager::createVf(xpum_device_id_t deviceId, xpum_vgpu_config_
         return XPUM_VGPU_INVALID_NUMVFS;
     }
 
-    AttrFromConfigFile attrs = {};
     bool readFlag = readConfigFromFile(deviceId, param->numVfs, attrs);
     if (!readFlag) {
         return XPUM_VGPU_NO_CONFIG_FILE;
@@ -97,20 +92,111 @@ xpum_result_t VgpuManager::createVf(xpum_device_id_t deviceId, xpum_vgpu_config_
         return XPUM_VGPU_INVALID_NUMVFS;
     }
 
-    uint64_t lmemToUse = 0;
     if (param->lmemPerVf > 0) {
-        lmemToUse = param->lmemPerVf;
+        lmem = param->lmemPerVf;
     } else if (deviceInfo.eccState == XPUM_ECC_STATE_ENABLED) {
-        lmemToUse = attrs.vfLmemEcc;
+        lmem = attrs.vfLmemEcc;
     } else {
-        lmemToUse = attrs.vfLmem;
+        lmem = attrs.vfLmem;
     }
 
-    if (deviceInfo.lmemSizeFree < lmemToUse * param->numVfs) {
+    if (deviceInfo.lmemSizeFree < lmem * param->numVfs) {
         XPUM_LOG_ERROR("LMEM size too large");
         return XPUM_VGPU_INVALID_LMEM;
     }
-    return createVfInternal(deviceInfo, attrs, param->numVfs, lmemToUse) ? XPUM_OK : XPUM_VGPU_CREATE_VF_FAILED;
+    return XPUM_OK;
+}
+
+xpum_result_t VgpuManager::createVf(xpum_device_id_t deviceId, xpum_vgpu_config_t* param) {
+    XPUM_LOG_DEBUG("vgpuCreateVf, {}, {}, {}", deviceId, param->numVfs, param->lmemPerVf);
+    auto res = vgpuValidateDevice(deviceId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    DeviceSriovInfo deviceInfo;
+    AttrFromConfigFile attrs = {};
+    uint64_t lmemToUse = 0;
+    res = prepareCreateVf(deviceId, param, deviceInfo, attrs, lmemToUse);
+    if (res != XPUM_OK) {
+        return res;
+    }
+    if (!beginProvision(deviceId, param->numVfs)) {
+        return XPUM_RESULT_VGPU_PROVISION_RUNNING;
+    }
+    bool created = createVfInternal(deviceId, deviceInfo, attrs, param->numVfs, lmemToUse);
+    return endProvision(deviceId, created ? XPUM_OK : XPUM_VGPU_CREATE_VF_FAILED);
+}
+
+xpum_result_t VgpuManager::createVfAsync(xpum_device_id_t deviceId, xpum_vgpu_config_t* param) {
+    XPUM_LOG_DEBUG("vgpuCreateVfAsync, {}, {}, {}", deviceId, param->numVfs, param->lmemPerVf);
+    auto res = vgpuValidateDevice(deviceId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+
+    DeviceSriovInfo deviceInfo;
+    AttrFromConfigFile attrs = {};
+    uint64_t lmemToUse = 0;
+    uint32_t numVfs = param->numVfs;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        res = prepareCreateVf(deviceId, param, deviceInfo, attrs, lmemToUse);
+        if (res != XPUM_OK) {
+            return res;
+        }
+        if (!beginProvision(deviceId, numVfs)) {
+            return XPUM_RESULT_VGPU_PROVISION_RUNNING;
+        }
+    }
+    // a createVf or removeAllVf called before the task locks mutex sees the provisioning running
+    auto task = std::async(std::launch::async, [this, deviceId, deviceInfo, attrs, numVfs, lmemToUse]() mutable {
+        std::unique_lock<std::mutex> lock(mutex);
+        bool created = createVfInternal(deviceId, deviceInfo, attrs, numVfs, lmemToUse);
+        endProvision(deviceId, created ? XPUM_OK : XPUM_VGPU_CREATE_VF_FAILED);
+    });
+    std::lock_guard<std::mutex> lck(status_mutex);
+    tasks[deviceId] = std::move(task);
+    return XPUM_OK;
+}
+
+xpum_result_t VgpuManager::getProvisionStatus(xpum_device_id_t deviceId, xpum_vgpu_provision_status_t& status) {
+    auto res = vgpuValidateDevice(deviceId);
+    if (res != XPUM_OK) {
+        return res;
+    }
+    std::lock_guard<std::mutex> lck(status_mutex);
+    auto it = statuses.find(deviceId);
+    if (it == statuses.end()) {
+        status = {};
+        status.result = XPUM_OK;
+    } else {
+        status = it->second;
+    }
+    return XPUM_OK;
+}
+
+bool VgpuManager::beginProvision(xpum_device_id_t deviceId, uint32_t numVfs) {
+    std::lock_guard<std::mutex> lck(status_mutex);
+    auto& status = statuses[deviceId];
+    if (status.running) {
+        return false;
+    }
+    status.running = true;
+    status.numVfs = numVfs;
+    status.numVfsDone = 0;
+    status.result = XPUM_OK;
+    return true;
+}
+
+xpum_result_t VgpuManager::endProvision(xpum_device_id_t deviceId, xpum_result_t result) {
+    std::lock_guard<std::mutex> lck(status_mutex);
+    auto& status = statuses[deviceId];
+    status.running = false;
+    status.result = result;
+    return result;
 }
 
 /*
@@ -222,46 +308,54 @@ xpum_result_t VgpuManager::removeAllVf(xpum_device_id_t deviceId) {
     std::stringstream iovPath, numvfsPath;
 
     /*
-     *  Disable all VFs by setting sriov_numvfs to 0
-     */
-    numvfsPath << "/sys/bus/pci/devices/" << deviceInfo.bdfAddress << "/sriov_numvfs";
-    try {
-        writeFile(numvfsPath.str(), "0");
-    } catch (std::ios::failure &e) {
-        return XPUM_VGPU_REMOVE_VF_FAILED;
-    }
-
-    /*
-     *  Then clear all resources allocated to all VFs
+     *  The resources allocated to all VFs are cleared after the VFs are disabled
      */
     DIR *dir;
     dirent *ent;
     iovPath << "/sys/class/drm/" << deviceInfo.drmPath << "/iov/";
     AttrFromConfigFile zeroAttr = {};
+    std::vector<std::vector<SysfsWrite>> vfWrites;
     if ((dir = opendir(iovPath.str().c_str())) != NULL) {
         while ((ent = readdir(dir)) != NULL) {
             if (strstr(ent->d_name, "vf") == NULL) {
                 continue;
             }
-            try {
-                if (deviceInfo.deviceModel == XPUM_DEVICE_MODEL_ATS_M_1 || deviceInfo.deviceModel == XPUM_DEVICE_MODEL_ATS_M_3 || deviceInfo.deviceModel == XPUM_DEVICE_MODEL_ATS_M_1G) {
-                    writeVfAttrToSysfs(iovPath.str() + ent->d_name + "/gt", zeroAttr, 0);
-                } else if (deviceInfo.deviceModel == XPUM_DEVICE_MODEL_PVC) {
-                    for (uint32_t tile = 0; tile < deviceInfo.numTiles; tile++) {
-                        writeVfAttrToSysfs(iovPath.str() + ent->d_name + "/gt" + std::to_string(tile), zeroAttr, 0);
-                    }
+            std::vector<SysfsWrite> writes;
+            if (deviceInfo.deviceModel == XPUM_DEVICE_MODEL_ATS_M_1 || deviceInfo.deviceModel == XPUM_DEVICE_MODEL_ATS_M_3 || deviceInfo.deviceModel == XPUM_DEVICE_MODEL_ATS_M_1G) {
+                addVfAttrWrites(writes, iovPath.str() + ent->d_name + "/gt", zeroAttr, 0);
+            } else if (deviceInfo.deviceModel == XPUM_DEVICE_MODEL_PVC) {
+                for (uint32_t tile = 0; tile < deviceInfo.numTiles; tile++) {
+                    addVfAttrWrites(writes, iovPath.str() + ent->d_name + "/gt" + std::to_string(tile), zeroAttr, 0);
                 }
-            } catch(std::ios::failure &e) {
-                closedir(dir);
-                return XPUM_VGPU_REMOVE_VF_FAILED;
             }
+            vfWrites.push_back(std::move(writes));
         }
+        closedir(dir);
     } else {
         XPUM_LOG_ERROR("Failed to open directory {}", iovPath.str());
         return XPUM_VGPU_REMOVE_VF_FAILED;
     }
-    closedir(dir);
-    return XPUM_OK;
+    if (!beginProvision(deviceId, vfWrites.size())) {
+        return XPUM_RESULT_VGPU_PROVISION_RUNNING;
+    }
+
+    /*
+     *  Disable all VFs by setting sriov_numvfs to 0
+     */
+    numvfsPath << "/sys/bus/pci/devices/" << deviceInfo.bdfAddress << "/sriov_numvfs";
+    try {
+        writeFile(numvfsPath.str(), "0");
+    } catch (std::ios::failure &e) {
+        return endProvision(deviceId, XPUM_VGPU_REMOVE_VF_FAILED);
+    }
+
+    /*
+     *  Then clear all resources allocated to all VFs
+     */
+    if (!writeVfsInParallel(deviceId, vfWrites)) {
+        return endProvision(deviceId, XPUM_VGPU_REMOVE_VF_FAILED);
+    }
+    return endProvision(deviceId, XPUM_OK);
 }
 
 static xpum_realtime_metric_type_t engineToMetricType(zes_engine_group_t engine) {
@@ -288,46 +382,37 @@ static xpum_realtime_metric_type_t engineToMetricType(zes_engine_group_t engine)
     return metricType;
 }
 
-typedef ze_result_t (*pfnZesEngineGetActivityExt_t)(
-    zes_engine_handle_t hEngine,
-    uint32_t *pCount, zes_engine_stats_t *pStats);
+static bool isVfEngineGroup(zes_engine_group_t type) {
+    return type == ZES_ENGINE_GROUP_ALL ||
+        type == ZES_ENGINE_GROUP_COMPUTE_ALL ||
+        type == ZES_ENGINE_GROUP_MEDIA_ALL ||
+        type == ZES_ENGINE_GROUP_COPY_ALL ||
+        type == ZES_ENGINE_GROUP_RENDER_ALL;
+}
 
 static bool getEngineStats(std::map<zes_engine_group_t, 
     std::vector<zes_engine_stats_t>> &snap, 
-    std::vector<zes_engine_handle_t> engines,
+    const std::vector<DeviceEngine_t> &engines,
     pfnZesEngineGetActivityExt_t pfnZesEngineGetActivityExt) {
     ze_result_t res = ZE_RESULT_SUCCESS;
     for (auto &engine : engines) {
-        zes_engine_properties_t props = {};
-        props.stype = ZES_STRUCTURE_TYPE_ENGINE_PROPERTIES;
-        props.pNext = nullptr;
-        XPUM_ZE_HANDLE_LOCK(engine, res = zesEngineGetProperties(engine, 
-            &props));
-        if (res != ZE_RESULT_SUCCESS) {
-            XPUM_LOG_ERROR("zesDeviceEnumEngineGroups returns {}", res);
-            return false;
-        }
-        if (props.type == ZES_ENGINE_GROUP_ALL ||
-            props.type == ZES_ENGINE_GROUP_COMPUTE_ALL ||
-            props.type == ZES_ENGINE_GROUP_MEDIA_ALL ||
-            props.type == ZES_ENGINE_GROUP_COPY_ALL ||
-            props.type == ZES_ENGINE_GROUP_RENDER_ALL) {
+        if (isVfEngineGroup(engine.type)) {
             uint32_t stats_count = 0;
-            XPUM_ZE_HANDLE_LOCK(engine, res = pfnZesEngineGetActivityExt(
-                        engine, &stats_count, nullptr));
+            XPUM_ZE_HANDLE_SHARED_LOCK(engine.handle, res = pfnZesEngineGetActivityExt(
+                        engine.handle, &stats_count, nullptr));
             if (res != ZE_RESULT_SUCCESS || stats_count <= 1) {
                 XPUM_LOG_ERROR("zesEngineGetActivityExt returns {} stats_count = {}",
                                res, stats_count);
                 return false;
             }
             std::vector<zes_engine_stats_t> stats(stats_count);
-            XPUM_ZE_HANDLE_LOCK(engine, res = pfnZesEngineGetActivityExt(
-                        engine, &stats_count, stats.data()));
+            XPUM_ZE_HANDLE_SHARED_LOCK(engine.handle, res = pfnZesEngineGetActivityExt(
+                        engine.handle, &stats_count, stats.data()));
             if (res != ZE_RESULT_SUCCESS) {
                 XPUM_LOG_ERROR("zesEngineGetActivityExt returns {}", res);
                 return false;
             }
-            snap.insert({props.type, stats});
+            snap.insert({engine.type, stats});
         }
     }
     return true;
@@ -341,38 +426,31 @@ xpum_result_t VgpuManager::getVfMetrics(xpum_device_id_t deviceId,
     if (xdev == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
-    void *handle = dlopen("libze_loader.so.1", RTLD_NOW);
-    if (handle == nullptr) {
-        return XPUM_LEVEL_ZERO_INITIALIZATION_ERROR;
+    DeviceCapability cap = DeviceCapability::METRIC_VF_ENGINE_UTILIZATION;
+    if (xdev->hasCapability(cap)) {
+        // until the first two samples are taken, the VFs are measured below
+        auto res = getVfMetricsFromDataLogic(deviceId, metrics, count);
+        if (res != XPUM_METRIC_NOT_SUPPORTED) {
+            return res;
+        }
     }
-    pfnZesEngineGetActivityExt_t pfnZesEngineGetActivityExt = 
-        reinterpret_cast<pfnZesEngineGetActivityExt_t>(dlsym(handle, 
-        "zesEngineGetActivityExt"));
+    auto pfnZesEngineGetActivityExt = GPUDeviceStub::getZesEngineGetActivityExt();
     if (pfnZesEngineGetActivityExt == nullptr) {
         XPUM_LOG_ERROR("dlsym zesEngineGetActivityExt returns NULL");
-        dlclose(handle);
         return XPUM_API_UNSUPPORTED;
     }
     auto device = xdev->getDeviceHandle();
-    ze_result_t res = ZE_RESULT_SUCCESS;
-    uint32_t engine_count = 0;
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device,
-                                    &engine_count, nullptr));
-    std::vector<zes_engine_handle_t> engines(engine_count);
+    // the engine handles and types are cached by the stub, so they are not
+    // enumerated again for each call
+    std::shared_ptr<const std::vector<DeviceEngine_t>> p_engines;
+    ze_result_t res = GPUDeviceStub::getDeviceEngines(device, p_engines);
     std::map<zes_engine_group_t, std::vector<zes_engine_stats_t>> snap;
     std::map<zes_engine_group_t, std::vector<zes_engine_stats_t>>::iterator it; 
-    if (res != ZE_RESULT_SUCCESS || engine_count == 0) {
-        XPUM_LOG_ERROR("zesDeviceEnumEngineGroups returns {} engine_count = {}", 
-            res, engine_count);
-        goto RTN;
-    }
-    XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device,
-                                    &engine_count, engines.data()));
-    if (res != ZE_RESULT_SUCCESS || engine_count == 0) {
-        XPUM_LOG_ERROR("zesDeviceEnumEngineGroups returns {} engine_count = {}", 
-            res, engine_count);
-        goto RTN;
+    if (res != ZE_RESULT_SUCCESS || p_engines->empty()) {
+        XPUM_LOG_ERROR("zesDeviceEnumEngineGroups returns {}", res);
+        return ret;
     }
+    const std::vector<DeviceEngine_t> &engines = *p_engines;
     if (getEngineStats(snap, engines, pfnZesEngineGetActivityExt) == false) {
         XPUM_LOG_ERROR("getEngineStats return false");
         goto RTN;
@@ -389,37 +467,24 @@ xpum_result_t VgpuManager::getVfMetrics(xpum_device_id_t deviceId,
     std::this_thread::sleep_for(std::chrono::milliseconds(
         Configuration::VF_METRICS_INTERVAL));
     for (auto &engine : engines) {
-        zes_engine_properties_t props = {};
-        props.stype = ZES_STRUCTURE_TYPE_ENGINE_PROPERTIES;
-        props.pNext = nullptr;
-        XPUM_ZE_HANDLE_LOCK(engine, res = zesEngineGetProperties(engine, 
-            &props));
-        if (res != ZE_RESULT_SUCCESS) {
-            XPUM_LOG_ERROR("zesDeviceEnumEngineGroups returns {}", res);
-            goto RTN;
-        }
-        if (props.type == ZES_ENGINE_GROUP_ALL || 
-            props.type == ZES_ENGINE_GROUP_COMPUTE_ALL || 
-            props.type == ZES_ENGINE_GROUP_MEDIA_ALL || 
-            props.type == ZES_ENGINE_GROUP_COPY_ALL ||
-            props.type == ZES_ENGINE_GROUP_RENDER_ALL) {
-            it = snap.find(props.type);
+        if (isVfEngineGroup(engine.type)) {
+            it = snap.find(engine.type);
             if (it == snap.end()) {
                 XPUM_LOG_ERROR("Engine stats not found");
                 goto RTN;
             }
             auto stats0 = it->second;
             uint32_t stats_count1 = 0;
-            XPUM_ZE_HANDLE_LOCK(engine, res = pfnZesEngineGetActivityExt(
-                        engine, &stats_count1, nullptr));
+            XPUM_ZE_HANDLE_SHARED_LOCK(engine.handle, res = pfnZesEngineGetActivityExt(
+                        engine.handle, &stats_count1, nullptr));
             std::vector<zes_engine_stats_t> stats1(stats_count1);
             if (res != ZE_RESULT_SUCCESS || stats_count1 <= 1) {
                 XPUM_LOG_ERROR("zesEngineGetActivityExt returns {} stats_count1 = {}", 
                     res, stats_count1);
                 goto RTN;
             }
-            XPUM_ZE_HANDLE_LOCK(engine, res = pfnZesEngineGetActivityExt(
-                        engine, &stats_count1, stats1.data()));
+            XPUM_ZE_HANDLE_SHARED_LOCK(engine.handle, res = pfnZesEngineGetActivityExt(
+                        engine.handle, &stats_count1, stats1.data()));
             if (res != ZE_RESULT_SUCCESS || stats_count1 != stats0.size()) {
                 XPUM_LOG_ERROR("zesEngineGetActivityExt returns {} stats_count1 = {} stats0.size() = {}", 
                     res, stats_count1, stats0.size());
@@ -428,11 +493,11 @@ xpum_result_t VgpuManager::getVfMetrics(xpum_device_id_t deviceId,
             for (uint32_t i = 1; i < stats_count1; i++) {
                 xpum_vf_metric_t vfm = {};
                 XPUM_LOG_DEBUG("engine type {} VF index {} stats0 activeTime {} timestamp {} stats1 activeTime {} timestamp {}", 
-                        props.type, i, stats0[i].activeTime, stats0[i].timestamp, 
+                        engine.type, i, stats0[i].activeTime, stats0[i].timestamp, 
                         stats1[i].activeTime, stats1[i].timestamp);
                 if (stats1[i].timestamp == stats0[i].timestamp) {
                     XPUM_LOG_DEBUG("NA: engine type {} VF index {} stats0 activeTime {} timestamp {} stats1 activeTime {} timestamp {}", 
-                        props.type, i, stats0[i].activeTime, stats0[i].timestamp, 
+                        engine.type, i, stats0[i].activeTime, stats0[i].timestamp, 
                         stats1[i].activeTime, stats1[i].timestamp);
                     continue;
                 }
@@ -447,9 +512,9 @@ xpum_result_t VgpuManager::getVfMetrics(xpum_device_id_t deviceId,
                         stats0[i].activeTime) / (stats1[i].timestamp -
                             stats0[i].timestamp);
                 vfm.deviceId = deviceId;
-                auto metricType = engineToMetricType(props.type);
+                auto metricType = engineToMetricType(engine.type);
                 if (metricType == XPUM_STATS_MAX) {
-                    XPUM_LOG_ERROR("Unsupported engine type {}", props.type);
+                    XPUM_LOG_ERROR("Unsupported engine type {}", engine.type);
                     goto RTN;
                 }
                 vfm.metric.metricsType = metricType;
@@ -462,10 +527,56 @@ xpum_result_t VgpuManager::getVfMetrics(xpum_device_id_t deviceId,
     }
     ret = XPUM_OK;
 RTN:
-    dlclose(handle);
     return ret;
 }
 
+xpum_result_t VgpuManager::getVfMetricsFromDataLogic(xpum_device_id_t deviceId,
+    std::vector<xpum_vf_metric_t> &metrics, uint32_t *count) {
+    std::string id = std::to_string(deviceId);
+    auto data = std::static_pointer_cast<VfMeasurementData>(
+        Core::instance().getDataLogic()->getLatestData(
+            MeasurementType::METRIC_VF_ENGINE_UTILIZATION, id));
+    if (data == nullptr || data->getUtilizations().empty()) {
+        return XPUM_METRIC_NOT_SUPPORTED;
+    }
+    auto &utilizations = data->getUtilizations();
+    //check count only
+    if (count != nullptr) {
+        for (auto &vf : utilizations) {
+            *count += vf.second.size();
+        }
+        XPUM_LOG_DEBUG("check count returns {}", *count);
+        return XPUM_OK;
+    }
+    for (auto &vf : utilizations) {
+        std::string bdf = data->getVfBdf(vf.first);
+        for (auto &engine : vf.second) {
+            auto metricType = engineToMetricType(engine.first);
+            if (metricType == XPUM_STATS_MAX) {
+                continue;
+            }
+            xpum_vf_metric_t vfm = {};
+            vfm.vfIndex = vf.first;
+            if (bdf.empty()) {
+                if (getVfBdf(vfm.bdfAddress, XPUM_MAX_STR_LENGTH, vf.first,
+                        deviceId) == false) {
+                    XPUM_LOG_ERROR("getVfBdf returns false at vf index {}",
+                        vf.first);
+                    return XPUM_GENERIC_ERROR;
+                }
+            } else {
+                strncpy(vfm.bdfAddress, bdf.c_str(), XPUM_MAX_STR_LENGTH - 1);
+            }
+            vfm.deviceId = deviceId;
+            vfm.metric.metricsType = metricType;
+            vfm.metric.value = engine.second;
+            vfm.metric.scale = data->getScale();
+            metrics.push_back(vfm);
+        }
+    }
+    return XPUM_OK;
+}
+
 bool VgpuManager::getVfBdf(char *bdf, uint32_t szBdf, uint32_t vfIndex, 
         xpum_device_id_t deviceId) {
 //BDF Format in uevent is cccc:cc:cc.c
@@ -512,7 +623,7 @@ bool VgpuManager::getVfBdf(char *bdf, uint32_t szBdf, uint32_t vfIndex,
 }
 
 bool VgpuManager::loadSriovData(xpum_device_id_t deviceId, DeviceSriovInfo &data) {
-    auto device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    auto device = Core::instance().getDeviceManager()->getDevice(deviceId);
     Property prop;
 
     data.deviceModel = device->getDeviceModel();
@@ -711,7 +822,7 @@ bool VgpuManager::readConfigFromFile(xpum_device_id_t deviceId, uint32_t numVfs,
     }
     XPUM_LOG_DEBUG("read vgpu.conf: {}", fileName);
     Property prop;
-    Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId))->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_DEVICE_ID, prop);
+    Core::instance().getDeviceManager()->getDevice(deviceId)->getProperty(XPUM_DEVICE_PROPERTY_INTERNAL_PCI_DEVICE_ID, prop);
     std::ostringstream oss;
     oss << std::setw(4) << std::setfill('0') << prop.getValue().substr(2);
     std::string devicePciId = oss.str();
@@ -784,7 +895,7 @@ bool VgpuManager::readConfigFromFile(xpum_device_id_t deviceId, uint32_t numVfs,
 }
 
 xpum_result_t VgpuManager::vgpuValidateDevice(xpum_device_id_t deviceId) {
-    auto device = Core::instance().getDeviceManager()->getDevice(std::to_string(deviceId));
+    auto device = Core::instance().getDeviceManager()->getDevice(deviceId);
     if (device == nullptr) {
         return XPUM_RESULT_DEVICE_NOT_FOUND;
     }
@@ -806,39 +917,58 @@ xpum_result_t VgpuManager::vgpuValidateDevice(xpum_device_id_t deviceId) {
     return XPUM_OK;
 }
 
-bool VgpuManager::createVfInternal(const DeviceSriovInfo& deviceInfo, AttrFromConfigFile& attrs, uint32_t numVfs, uint64_t lmem) {
+bool VgpuManager::createVfInternal(xpum_device_id_t deviceId, const DeviceSriovInfo& deviceInfo, AttrFromConfigFile& attrs, uint32_t numVfs, uint64_t lmem) {
     std::string devicePathString = std::string("/sys/class/drm/") + deviceInfo.drmPath;
-    try {
-        if (deviceInfo.deviceModel == XPUM_DEVICE_MODEL_ATS_M_1 || deviceInfo.deviceModel == XPUM_DEVICE_MODEL_ATS_M_3 || deviceInfo.deviceModel == XPUM_DEVICE_MODEL_ATS_M_1G) {
-            writeFile(devicePathString + "/iov/pf/gt/exec_quantum_ms", std::to_string(attrs.pfExec));
-            writeFile(devicePathString + "/iov/pf/gt/preempt_timeout_us", std::to_string(attrs.pfPreempt));
-            writeFile(devicePathString + "/iov/pf/gt/policies/sched_if_idle", attrs.schedIfIdle ? "1": "0");
-            for (uint32_t vfNum = 1; vfNum <= numVfs; vfNum++) {
-                writeVfAttrToSysfs(devicePathString + "/iov/vf" + std::to_string(vfNum) + "/gt", attrs, lmem);
-            }
-        } else if (deviceInfo.deviceModel == XPUM_DEVICE_MODEL_PVC) {
-            for (uint32_t tile = 0; tile < deviceInfo.numTiles; tile++) {
-                std::string gtNum = std::to_string(tile);
-                writeFile(devicePathString + "/iov/pf/gt" + gtNum + "/exec_quantum_ms", std::to_string(attrs.pfExec));
-                writeFile(devicePathString + "/iov/pf/gt" + gtNum + "/preempt_timeout_us", std::to_string(attrs.pfPreempt));
-                writeFile(devicePathString + "/iov/pf/gt" + gtNum + "/policies/sched_if_idle", attrs.schedIfIdle ? "1": "0");
-                // Each VF should be mapped to only one tile, except the case of 1 VF on 2 tiles
-                if (numVfs == 1 && deviceInfo.numTiles > 1) {
-                    std::string vfResPath = devicePathString + "/iov/vf1/gt" + gtNum + "/";
-                    attrs.vfGgtt /= deviceInfo.numTiles;
-                    attrs.vfDoorbells /= deviceInfo.numTiles;
-                    attrs.vfContexts /= deviceInfo.numTiles;
-                    writeVfAttrToSysfs(devicePathString + "/iov/vf1/gt" + gtNum, attrs, lmem / deviceInfo.numTiles);
-                } else {
-                    for (uint32_t vfNum = 1; vfNum <= numVfs; vfNum++) {
-                        if (vfNum % deviceInfo.numTiles != tile) {
-                            continue;
-                        }
-                        writeVfAttrToSysfs(devicePathString + "/iov/vf" + std::to_string(vfNum) + "/gt" + gtNum, attrs, lmem);
+    /*
+     *  All attributes are computed first, then the PF is configured and the VFs,
+     *  which do not depend on each other, are configured in parallel
+     */
+    std::vector<SysfsWrite> pfWrites;
+    std::vector<std::vector<SysfsWrite>> vfWrites(numVfs);
+    if (deviceInfo.deviceModel == XPUM_DEVICE_MODEL_ATS_M_1 || deviceInfo.deviceModel == XPUM_DEVICE_MODEL_ATS_M_3 || deviceInfo.deviceModel == XPUM_DEVICE_MODEL_ATS_M_1G) {
+        std::string pfDir = devicePathString + "/iov/pf/gt";
+        pfWrites.push_back({pfDir, "exec_quantum_ms", std::to_string(attrs.pfExec)});
+        pfWrites.push_back({pfDir, "preempt_timeout_us", std::to_string(attrs.pfPreempt)});
+        pfWrites.push_back({pfDir + "/policies", "sched_if_idle", attrs.schedIfIdle ? "1": "0"});
+        for (uint32_t vfNum = 1; vfNum <= numVfs; vfNum++) {
+            addVfAttrWrites(vfWrites[vfNum - 1], devicePathString + "/iov/vf" + std::to_string(vfNum) + "/gt", attrs, lmem);
+        }
+    } else if (deviceInfo.deviceModel == XPUM_DEVICE_MODEL_PVC) {
+        // Each VF should be mapped to only one tile, except the case of 1 VF on 2 tiles
+        // whose resources are split between the tiles
+        AttrFromConfigFile splitAttrs = attrs;
+        if (numVfs == 1 && deviceInfo.numTiles > 1) {
+            splitAttrs.vfGgtt /= deviceInfo.numTiles;
+            splitAttrs.vfDoorbells /= deviceInfo.numTiles;
+            splitAttrs.vfContexts /= deviceInfo.numTiles;
+        }
+        for (uint32_t tile = 0; tile < deviceInfo.numTiles; tile++) {
+            std::string gtNum = std::to_string(tile);
+            std::string pfDir = devicePathString + "/iov/pf/gt" + gtNum;
+            pfWrites.push_back({pfDir, "exec_quantum_ms", std::to_string(attrs.pfExec)});
+            pfWrites.push_back({pfDir, "preempt_timeout_us", std::to_string(attrs.pfPreempt)});
+            pfWrites.push_back({pfDir + "/policies", "sched_if_idle", attrs.schedIfIdle ? "1": "0"});
+            if (numVfs == 1 && deviceInfo.numTiles > 1) {
+                addVfAttrWrites(vfWrites[0], devicePathString + "/iov/vf1/gt" + gtNum, splitAttrs, lmem / deviceInfo.numTiles);
+            } else {
+                for (uint32_t vfNum = 1; vfNum <= numVfs; vfNum++) {
+                    if (vfNum % deviceInfo.numTiles != tile) {
+                        continue;
                     }
-                }   
-            }
+                    addVfAttrWrites(vfWrites[vfNum - 1], devicePathString + "/iov/vf" + std::to_string(vfNum) + "/gt" + gtNum, attrs, lmem);
+                }
+            }   
         }
+    }
+    try {
+        writeFiles(pfWrites);
+    } catch (std::ios::failure &e) {
+        return false;
+    }
+    if (!writeVfsInParallel(deviceId, vfWrites)) {
+        return false;
+    }
+    try {
         writeFile(devicePathString + "/device/sriov_drivers_autoprobe", attrs.driversAutoprobe ? "1" : "0");
         writeFile(devicePathString + "/device/sriov_numvfs", std::to_string(numVfs));
     } catch (std::ios::failure &e) {
@@ -847,13 +977,71 @@ bool VgpuManager::createVfInternal(const DeviceSriovInfo& deviceInfo, AttrFromCo
     return true;
 }
 
-void VgpuManager::writeVfAttrToSysfs(std::string vfDir, AttrFromConfigFile attrs, uint64_t lmem) {
-    writeFile(vfDir + "/exec_quantum_ms", std::to_string(attrs.vfExec));
-    writeFile(vfDir + "/preempt_timeout_us", std::to_string(attrs.vfPreempt));
-    writeFile(vfDir + "/lmem_quota", std::to_string(lmem));
-    writeFile(vfDir + "/ggtt_quota", std::to_string(attrs.vfGgtt));
-    writeFile(vfDir + "/doorbells_quota", std::to_string(attrs.vfDoorbells));
-    writeFile(vfDir + "/contexts_quota", std::to_string(attrs.vfContexts));
+void VgpuManager::addVfAttrWrites(std::vector<SysfsWrite>& writes, const std::string& vfDir, const AttrFromConfigFile& attrs, uint64_t lmem) {
+    writes.push_back({vfDir, "exec_quantum_ms", std::to_string(attrs.vfExec)});
+    writes.push_back({vfDir, "preempt_timeout_us", std::to_string(attrs.vfPreempt)});
+    writes.push_back({vfDir, "lmem_quota", std::to_string(lmem)});
+    writes.push_back({vfDir, "ggtt_quota", std::to_string(attrs.vfGgtt)});
+    writes.push_back({vfDir, "doorbells_quota", std::to_string(attrs.vfDoorbells)});
+    writes.push_back({vfDir, "contexts_quota", std::to_string(attrs.vfContexts)});
+}
+
+void VgpuManager::writeFiles(const std::vector<SysfsWrite>& writes) {
+    int dirFd = -1;
+    std::string dir;
+    for (auto& w : writes) {
+        if (dirFd < 0 || w.dir != dir) {
+            if (dirFd >= 0) {
+                close(dirFd);
+            }
+            dir = w.dir;
+            dirFd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+        }
+        int fd = dirFd < 0 ? -1 : openat(dirFd, w.name.c_str(), O_WRONLY | O_TRUNC);
+        ssize_t len = fd < 0 ? -1 : write(fd, w.value.c_str(), w.value.size());
+        if (fd >= 0) {
+            close(fd);
+        }
+        if (len != (ssize_t)w.value.size()) {
+            XPUM_LOG_ERROR("write: {}/{} {} failed", w.dir, w.name, w.value);
+            if (dirFd >= 0) {
+                close(dirFd);
+            }
+            throw std::ios::failure("write " + w.dir + "/" + w.name);
+        }
+        XPUM_LOG_DEBUG("write: {}/{} {}", w.dir, w.name, w.value);
+    }
+    if (dirFd >= 0) {
+        close(dirFd);
+    }
+}
+
+bool VgpuManager::writeVfsInParallel(xpum_device_id_t deviceId, const std::vector<std::vector<SysfsWrite>>& vfWrites) {
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    auto worker = [&]() {
+        size_t i;
+        while (!failed && (i = next++) < vfWrites.size()) {
+            try {
+                writeFiles(vfWrites[i]);
+            } catch (std::ios::failure &e) {
+                failed = true;
+                return;
+            }
+            std::lock_guard<std::mutex> lck(status_mutex);
+            statuses[deviceId].numVfsDone++;
+        }
+    };
+    size_t workers = std::min<size_t>(Configuration::VGPU_PROVISION_PARALLELISM, vfWrites.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : threads) {
+        t.join();
+    }
+    return !failed;
 }
 
 }
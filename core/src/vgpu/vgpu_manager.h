@@ -9,6 +9,8 @@
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <future>
+#include <map>
 #include <mutex>
 
 #include "../include/xpum_structs.h"
@@ -30,20 +32,51 @@ private:
 
     xpum_result_t vgpuValidateDevice(xpum_device_id_t deviceId);
 
-    bool createVfInternal(const DeviceSriovInfo& deviceInfo, AttrFromConfigFile& attrs, uint32_t numVfs, uint64_t lmem);
+    bool createVfInternal(xpum_device_id_t deviceId, const DeviceSriovInfo& deviceInfo, AttrFromConfigFile& attrs, uint32_t numVfs, uint64_t lmem);
     
-    void writeVfAttrToSysfs(std::string vfDir, AttrFromConfigFile attrs, uint64_t lmem);
+    void addVfAttrWrites(std::vector<SysfsWrite>& writes, const std::string& vfDir, const AttrFromConfigFile& attrs, uint64_t lmem);
+
+    // write the attributes in order, the fd of a dir is reused by its consecutive attributes
+    void writeFiles(const std::vector<SysfsWrite>& writes);
+
+    // write the attributes of each VF, Configuration::VGPU_PROVISION_PARALLELISM VFs at a time
+    bool writeVfsInParallel(xpum_device_id_t deviceId, const std::vector<std::vector<SysfsWrite>>& vfWrites);
+
+    // the checks of createVf, they are done with mutex held
+    xpum_result_t prepareCreateVf(xpum_device_id_t deviceId, xpum_vgpu_config_t* param, DeviceSriovInfo& deviceInfo, AttrFromConfigFile& attrs, uint64_t& lmem);
+
+    // mark the provisioning of numVfs VFs running, false if one is already running on the device
+    bool beginProvision(xpum_device_id_t deviceId, uint32_t numVfs);
+
+    xpum_result_t endProvision(xpum_device_id_t deviceId, xpum_result_t result);
 
     bool getVfBdf(char *bdf, uint32_t szBdf, uint32_t vfIndex, 
         xpum_device_id_t deviceId);
 
+    // the VF metrics of the latest monitor sample, XPUM_METRIC_NOT_SUPPORTED
+    // if none is taken yet
+    xpum_result_t getVfMetricsFromDataLogic(xpum_device_id_t deviceId,
+        std::vector<xpum_vf_metric_t> &metrics, uint32_t *count);
+
     std::mutex mutex;
 
+    std::mutex status_mutex;
+
+    std::map<xpum_device_id_t, xpum_vgpu_provision_status_t> statuses;
+
+    std::map<xpum_device_id_t, std::future<void>> tasks;
+
 public:
 
     // Check whether resources is enough before, then create VF
     xpum_result_t createVf(xpum_device_id_t deviceId, xpum_vgpu_config_t* config);
 
+    // Check like createVf, then create VF in the background
+    xpum_result_t createVfAsync(xpum_device_id_t deviceId, xpum_vgpu_config_t* config);
+
+    // The progress of the running VF creation or removal, or the result of the last one
+    xpum_result_t getProvisionStatus(xpum_device_id_t deviceId, xpum_vgpu_provision_status_t& status);
+
     // List VF info
     xpum_result_t getFunctionList(xpum_device_id_t deviceId, std::vector<xpum_vgpu_function_info_t> &functionList);
 
@@ -27,6 +27,13 @@ struct AttrFromConfigFile {
     uint64_t pfPreempt;
 };
 
+// a sysfs attribute of dir and the value written to it
+struct SysfsWrite {
+    std::string dir;
+    std::string name;
+    std::string value;
+};
+
 struct DeviceSriovInfo {
     int deviceModel;
     std::string drmPath;
@@ -6,6 +6,7 @@
 
 #include <string>
 
+#include "rpc_admission.h"
 #include "xpum_api.h"
 #include "xpum_core_service_impl.h"
 
@@ -65,6 +66,10 @@ void static fillAgentConfigReponse(::AgentConfigEntryList* response, xpum_result
 }
 
 ::grpc::Status XpumCoreServiceImpl::setAgentConfig(::grpc::ServerContext* context, const ::SetAgentConfigRequest* request, ::SetAgentConfigResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     auto entries = request->configentries();
     for (auto entry : entries) {
         auto keyStr = entry.key();
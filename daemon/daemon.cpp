@@ -7,6 +7,7 @@
 #include <fcntl.h>
 #include <getopt.h>
 #include <grpc++/grpc++.h>
+#include <grpc++/resource_quota.h>
 #include <grpc++/server.h>
 #include <grpc++/server_builder.h>
 #include <grpc++/server_context.h>
@@ -25,7 +26,14 @@
 #include <string>
 #include <thread>
 
+#include "internal_api.h"
 #include "logger.h"
+#include "metrics_exporter.h"
+#include "power_cap_controller.h"
+#include "rest_gateway.h"
+#include "rpc_admission.h"
+#include "telemetry_pusher.h"
+#include "telemetry_shm_publisher.h"
 #include "xpum_api.h"
 #include "xpum_core_service_impl.h"
 #include "xpum_core_service_unprivileged_impl.h"
@@ -55,6 +63,20 @@ char* sock_file_dir = nullptr;
 char* dump_folder_name = nullptr;
 char* log_file_name = nullptr;
 char* enabled_metrics = nullptr;
+char* persistency_folder_name = nullptr;
+char* metrics_address = nullptr;
+int metrics_port = 0;
+char* rest_address = nullptr;
+int rest_port = 0;
+bool telemetry_shm = false;
+char* push_endpoint = nullptr;
+std::size_t push_interval = 10;
+char* push_spool_folder = nullptr;
+std::size_t power_budget = 0;
+std::size_t power_budget_group = 0;
+std::size_t power_budget_interval = 500;
+PowerCapController::Policy power_budget_policy = PowerCapController::Policy::DEMAND;
+std::size_t rpc_rate_limit = 0;
 std::size_t log_max_size = 10 * 1024 * 1024;
 std::size_t log_max_files = 3;
 std::string log_level = "";
@@ -77,6 +99,20 @@ void print_help(const char* app_name) {
     printf("   -l, --log_file=filename          logfile to write\n");
     printf("       --log_max_size=number        max size of log file in MB\n");
     printf("       --log_max_files=number       max number of log files\n");
+    printf("       --persistency_folder=foldername  folder to keep the telemetry history in\n");
+    printf("       --metrics_port=number        serve Prometheus metrics at http://ADDRESS:PORT/metrics\n");
+    printf("       --metrics_address=address    IPv4 address to serve metrics at, default 127.0.0.1\n");
+    printf("       --rest_port=number           serve the telemetry REST endpoints at http://ADDRESS:PORT/rest/v1\n");
+    printf("       --rest_address=address       IPv4 address to serve the REST endpoints at, default 127.0.0.1\n");
+    printf("       --telemetry_shm              publish the latest metrics to shared memory %s\n", XPUM_TELEMETRY_SHM_NAME);
+    printf("       --push_endpoint=address:port push compressed telemetry batches to a collector over TCP\n");
+    printf("       --push_interval=number       seconds between the pushed batches, default 10\n");
+    printf("       --push_spool_folder=foldername  folder to keep the batches in while the collector is down\n");
+    printf("       --power_budget=number        keep the power of the devices under a budget in watts\n");
+    printf("       --power_budget_group=number  apply the power budget to the devices of a group only\n");
+    printf("       --power_budget_interval=number  ms between the power limit updates, default 500\n");
+    printf("       --power_budget_policy=POLICY share the budget by demand (default) or equal\n");
+    printf("       --rpc_rate_limit=number      telemetry requests a second per client, default 0 for no limit\n");
     printf("   -m, --enable_metrics=METRICS     list enabled metric indexes, seperated by comma,\n");
     printf("                                    use hyphen to indicate a range (e.g., 0,4-7,27-29)\n");
     printf("        Index   Metric                                              Default\n");
@@ -124,9 +160,10 @@ void print_help(const char* app_name) {
     printf("\n");
 }
 
-unique_ptr<grpc::Server> buildAndStartRPCServer(const string& unixSockAddr, XpumCoreServiceImpl& service) {
+unique_ptr<grpc::Server> buildAndStartRPCServer(const string& unixSockAddr, XpumCoreServiceImpl& service, grpc::ResourceQuota& quota) {
     grpc::ServerBuilder builder;
     builder.AddListeningPort(unixSockAddr, grpc::InsecureServerCredentials());
+    builder.SetResourceQuota(quota);
     builder.RegisterService(&service);
     return builder.BuildAndStart();
 }
@@ -154,9 +191,19 @@ void runRPCServers() {
 
     umask(S_IXUSR | S_IXGRP | S_IROTH | S_IWOTH | S_IXOTH);
 
+    // every server has its own thread limit, the rpc slots keep threads free for telemetry
+    grpc::ResourceQuota privQuota(RpcSlotPool::privileged().getName());
+    privQuota.SetMaxThreads(RpcSlotPool::privileged().getMaxThreads());
+    grpc::ResourceQuota upriQuota(RpcSlotPool::unprivileged().getName());
+    upriQuota.SetMaxThreads(RpcSlotPool::unprivileged().getMaxThreads());
+    RpcRateLimiter::instance().setRate(rpc_rate_limit);
+    if (rpc_rate_limit > 0) {
+        XPUM_LOG_INFO("XPUM: telemetry requests are limited to {} a second per client", rpc_rate_limit);
+    }
+
     //privileged socket
     XpumCoreServiceImpl privService;
-    unique_ptr<grpc::Server> privServer =  buildAndStartRPCServer("unix://" + privSock, privService);
+    unique_ptr<grpc::Server> privServer =  buildAndStartRPCServer("unix://" + privSock, privService, privQuota);
     XPUM_LOG_INFO("XPUM: RPC server is listening at {}", privSock);
 
     passwd* pwd = getpwnam("xpum");
@@ -174,7 +221,7 @@ void runRPCServers() {
 
     //non-privileged socket
     XpumCoreServiceUnprivilegedImpl upriService;
-    unique_ptr<grpc::Server> upriServer = buildAndStartRPCServer("unix://" + upriSock, upriService);
+    unique_ptr<grpc::Server> upriServer = buildAndStartRPCServer("unix://" + upriSock, upriService, upriQuota);
 
     chown(upriSock.c_str(), pwd->pw_uid, pwd->pw_gid);
     if(chmod(upriSock.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH ) < 0){
@@ -182,6 +229,60 @@ void runRPCServers() {
         return;
     }
 
+    unique_ptr<MetricsExporter> metricsExporter;
+    if (metrics_port > 0) {
+        metricsExporter.reset(new MetricsExporter(metrics_address != nullptr ? metrics_address : "127.0.0.1", metrics_port));
+        if (!metricsExporter->start()) {
+            metricsExporter.reset();
+        }
+    }
+    if (metrics_address != nullptr) {
+        free(metrics_address);
+        metrics_address = nullptr;
+    }
+
+    unique_ptr<RestGateway> restGateway;
+    if (rest_port > 0) {
+        restGateway.reset(new RestGateway(rest_address != nullptr ? rest_address : "127.0.0.1", rest_port));
+        if (!restGateway->start()) {
+            restGateway.reset();
+        }
+    }
+    if (rest_address != nullptr) {
+        free(rest_address);
+        rest_address = nullptr;
+    }
+
+    unique_ptr<TelemetryShmPublisher> telemetryShmPublisher;
+    if (telemetry_shm) {
+        telemetryShmPublisher.reset(new TelemetryShmPublisher());
+        if (!telemetryShmPublisher->start()) {
+            telemetryShmPublisher.reset();
+        }
+    }
+
+    unique_ptr<TelemetryPusher> telemetryPusher;
+    if (push_endpoint != nullptr) {
+        telemetryPusher.reset(new TelemetryPusher(push_endpoint, push_interval, push_spool_folder != nullptr ? push_spool_folder : ""));
+        if (!telemetryPusher->start()) {
+            telemetryPusher.reset();
+        }
+        free(push_endpoint);
+        push_endpoint = nullptr;
+    }
+    if (push_spool_folder != nullptr) {
+        free(push_spool_folder);
+        push_spool_folder = nullptr;
+    }
+
+    unique_ptr<PowerCapController> powerCapController;
+    if (power_budget > 0) {
+        powerCapController.reset(new PowerCapController(power_budget, power_budget_group, power_budget_interval, power_budget_policy));
+        if (!powerCapController->start()) {
+            powerCapController.reset();
+        }
+    }
+
     // start a background thread for the server.
     std::thread grpc_server_thread(
         [](::grpc::Server* grpc_server_ptr) {
@@ -195,6 +296,21 @@ void runRPCServers() {
     }
 
     // Shut down server.
+    if (metricsExporter != nullptr) {
+        metricsExporter->stop();
+    }
+    if (restGateway != nullptr) {
+        restGateway->stop();
+    }
+    if (telemetryShmPublisher != nullptr) {
+        telemetryShmPublisher->stop();
+    }
+    if (telemetryPusher != nullptr) {
+        telemetryPusher->stop();
+    }
+    if (powerCapController != nullptr) {
+        powerCapController->stop();
+    }
     XPUM_LOG_INFO("XPUM: Shutting down RPC server...");
     // must close service before shutdown the server to avoid stuck in server->Shutdown()
     privService.close();
@@ -303,6 +419,20 @@ void parse_opts(int argc, char* argv[]) {
         {"log_max_size", required_argument, &lopt, 1},
         {"log_max_files", required_argument, &lopt, 2},
         {"log_level", required_argument, &lopt, 3},
+        {"persistency_folder", required_argument, &lopt, 4},
+        {"metrics_port", required_argument, &lopt, 5},
+        {"metrics_address", required_argument, &lopt, 6},
+        {"telemetry_shm", no_argument, &lopt, 7},
+        {"push_endpoint", required_argument, &lopt, 8},
+        {"push_interval", required_argument, &lopt, 9},
+        {"push_spool_folder", required_argument, &lopt, 10},
+        {"power_budget", required_argument, &lopt, 11},
+        {"power_budget_group", required_argument, &lopt, 12},
+        {"power_budget_interval", required_argument, &lopt, 13},
+        {"power_budget_policy", required_argument, &lopt, 14},
+        {"rpc_rate_limit", required_argument, &lopt, 15},
+        {"rest_port", required_argument, &lopt, 16},
+        {"rest_address", required_argument, &lopt, 17},
         {NULL, 0, 0, 0}};
     int value, option_index = 0;
     while ((value = getopt_long(argc, argv, "s:p:d:l:m:h", long_options, &option_index)) != -1) {
@@ -319,6 +449,70 @@ void parse_opts(int argc, char* argv[]) {
                     case 3:
                         valid = to_log_level(optarg, log_level);
                         break;
+                    case 4:
+                        if (persistency_folder_name == nullptr) {
+                            persistency_folder_name = strdup(optarg);
+                        }
+                        valid = true;
+                        break;
+                    case 5: {
+                        std::size_t port = 0;
+                        valid = to_size_t(optarg, port) && port > 0 && port <= 65535;
+                        metrics_port = (int)port;
+                        break;
+                    }
+                    case 6:
+                        if (metrics_address == nullptr) {
+                            metrics_address = strdup(optarg);
+                        }
+                        valid = true;
+                        break;
+                    case 7:
+                        telemetry_shm = true;
+                        valid = true;
+                        break;
+                    case 8:
+                        if (push_endpoint == nullptr) {
+                            push_endpoint = strdup(optarg);
+                        }
+                        valid = true;
+                        break;
+                    case 9:
+                        valid = to_size_t(optarg, push_interval) && push_interval > 0;
+                        break;
+                    case 10:
+                        if (push_spool_folder == nullptr) {
+                            push_spool_folder = strdup(optarg);
+                        }
+                        valid = true;
+                        break;
+                    case 11:
+                        valid = to_size_t(optarg, power_budget) && power_budget > 0;
+                        break;
+                    case 12:
+                        valid = to_size_t(optarg, power_budget_group);
+                        break;
+                    case 13:
+                        valid = to_size_t(optarg, power_budget_interval) && power_budget_interval > 0;
+                        break;
+                    case 14:
+                        valid = PowerCapController::toPolicy(optarg, power_budget_policy);
+                        break;
+                    case 15:
+                        valid = to_size_t(optarg, rpc_rate_limit) && rpc_rate_limit <= UINT32_MAX;
+                        break;
+                    case 16: {
+                        std::size_t port = 0;
+                        valid = to_size_t(optarg, port) && port > 0 && port <= 65535;
+                        rest_port = (int)port;
+                        break;
+                    }
+                    case 17:
+                        if (rest_address == nullptr) {
+                            rest_address = strdup(optarg);
+                        }
+                        valid = true;
+                        break;
                     default:
                         break;
                 }
@@ -390,10 +584,18 @@ int main(int argc, char* argv[]) {
         enabled_metrics = nullptr;
     }
 
+    if (persistency_folder_name != nullptr) {
+        setenv("XPUM_PERSISTENCY_DIR", persistency_folder_name, 1);
+        free(persistency_folder_name);
+        persistency_folder_name = nullptr;
+    }
+
     XPUM_LOG_INFO("XPUM: Init xpum library");
     xpum::xpum_result_t res = xpum::xpumInit();
     if (res != xpum::XPUM_OK) {
         XPUM_LOG_ERROR("XPUM: Load xpum library failed! {}", res);
+    } else {
+        xpum::prefetchDeviceProperties();
     }
 
     XPUM_LOG_INFO("XPUM: start XPUM RPC Server.");
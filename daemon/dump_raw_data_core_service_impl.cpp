@@ -12,8 +12,10 @@
 
 #include <fstream>
 #include <thread>
+#include <vector>
 
 #include "logger.h"
+#include "rpc_admission.h"
 #include "xpum_api.h"
 #include "xpum_core_service_impl.h"
 #include "xpum_structs.h"
@@ -52,6 +54,10 @@ static void removeFileOnStartTaskFail(std::string filePath) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::startDumpRawDataTask(::grpc::ServerContext* context, const ::StartDumpRawDataTaskRequest* request, ::StartDumpRawDataTaskResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     std::vector<xpum_dump_type_t> dumpTypeList;
     for (auto enumValue : request->metricstypelist()) {
         xpum_dump_type_t dumpType = static_cast<xpum_dump_type_t>(enumValue.value());
@@ -63,6 +69,20 @@ static void removeFileOnStartTaskFail(std::string filePath) {
     int tileId = request->tileid();
     xpum_dump_raw_data_option_t dumpOptions {};
     dumpOptions.showDate = request->showdate();
+    dumpOptions.format = XPUM_DUMP_FORMAT_CSV;
+    if (request->format() == XPUM_DUMP_FORMAT_BINARY || request->format() == XPUM_DUMP_FORMAT_TRACE) {
+        dumpOptions.format = static_cast<xpum_dump_format_t>(request->format());
+    }
+    dumpOptions.layout = request->layout() == XPUM_DUMP_LAYOUT_WIDE ? XPUM_DUMP_LAYOUT_WIDE : XPUM_DUMP_LAYOUT_LONG;
+    dumpOptions.rotateSize = request->rotatesize();
+    dumpOptions.rotateInterval = request->rotateinterval();
+    dumpOptions.maxFiles = request->maxfiles();
+    dumpOptions.compress = request->compress();
+    dumpOptions.triggered = request->triggered();
+    dumpOptions.preTriggerTime = request->pretriggertime();
+    dumpOptions.postTriggerTime = request->posttriggertime();
+    dumpOptions.triggerMask = request->triggermask();
+    std::vector<xpum_device_id_t> deviceIdList(request->deviceidlist().begin(), request->deviceidlist().end());
 
     dumpRawDataFilenameMtx.lock();
     int64_t milli_sec = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -73,24 +93,48 @@ static void removeFileOnStartTaskFail(std::string filePath) {
     dumpRawDataFilenameMtx.unlock();
 
     std::string fileName;
-    if (tileId != -1) {
+    if (deviceIdList.size() > 1) {
+        fileName = "devices";
+        for (std::size_t i = 0; i < deviceIdList.size(); i++) {
+            fileName += (i == 0 ? "" : "_") + std::to_string(deviceIdList[i]);
+        }
+        fileName += "-" + isotimestamp(milli_sec);
+    } else if (tileId != -1) {
         fileName = "device" + std::to_string(deviceId) + "-tile" + std::to_string(tileId) + "-" + isotimestamp(milli_sec);
     } else {
         fileName = "device" + std::to_string(deviceId) + "-" + isotimestamp(milli_sec);
     }
 
-    std::string dumpFilePath = dumpRawDataFileFolder + "/" + fileName + ".csv";
+    std::string extension = ".csv";
+    if (dumpOptions.format == XPUM_DUMP_FORMAT_BINARY) {
+        extension = ".bin";
+    } else if (dumpOptions.format == XPUM_DUMP_FORMAT_TRACE) {
+        extension = ".json";
+    }
+    std::string dumpFilePath = dumpRawDataFileFolder + "/" + fileName + extension;
 
     createEmptyFile(dumpFilePath);
 
-    auto res = xpumStartDumpRawDataTaskEx(
-        deviceId,
-        tileId,
-        dumpTypeList.data(),
-        dumpTypeList.size(),
-        dumpFilePath.c_str(),
-        dumpOptions,
-        &taskInfo);
+    xpum_result_t res;
+    if (deviceIdList.size() > 1) {
+        res = xpumStartDumpRawDataTaskMultiDevice(
+            deviceIdList.data(),
+            deviceIdList.size(),
+            dumpTypeList.data(),
+            dumpTypeList.size(),
+            dumpFilePath.c_str(),
+            dumpOptions,
+            &taskInfo);
+    } else {
+        res = xpumStartDumpRawDataTaskEx(
+            deviceId,
+            tileId,
+            dumpTypeList.data(),
+            dumpTypeList.size(),
+            dumpFilePath.c_str(),
+            dumpOptions,
+            &taskInfo);
+    }
     response->set_errorno(res);
     if (res == XPUM_OK) {
         auto grpcTaskInfo = response->mutable_taskinfo();
@@ -103,6 +147,14 @@ static void removeFileOnStartTaskFail(std::string filePath) {
         }
         grpcTaskInfo->set_begintime(taskInfo.beginTime);
         grpcTaskInfo->set_dumpfilepath(taskInfo.dumpFilePath);
+        grpcTaskInfo->set_currentfilepath(taskInfo.currentFilePath);
+        grpcTaskInfo->set_currentfilebytes(taskInfo.currentFileBytes);
+        grpcTaskInfo->set_totalbytes(taskInfo.totalBytes);
+        grpcTaskInfo->set_filecount(taskInfo.fileCount);
+        grpcTaskInfo->set_triggercount(taskInfo.triggerCount);
+        for (int i = 0; i < taskInfo.deviceCount; i++) {
+            grpcTaskInfo->add_deviceidlist(taskInfo.deviceIdList[i]);
+        }
     } else {
         removeFileOnStartTaskFail(dumpFilePath);
         switch (res) {
@@ -124,6 +176,10 @@ static void removeFileOnStartTaskFail(std::string filePath) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::stopDumpRawDataTask(::grpc::ServerContext* context, const ::StopDumpRawDataTaskRequest* request, ::StopDumpRawDataTaskReponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_dump_raw_data_task_t taskInfo;
     auto res = xpumStopDumpRawDataTask(request->dumptaskid(), &taskInfo);
     response->set_errorno(res);
@@ -138,6 +194,14 @@ static void removeFileOnStartTaskFail(std::string filePath) {
         }
         grpcTaskInfo->set_begintime(taskInfo.beginTime);
         grpcTaskInfo->set_dumpfilepath(taskInfo.dumpFilePath);
+        grpcTaskInfo->set_currentfilepath(taskInfo.currentFilePath);
+        grpcTaskInfo->set_currentfilebytes(taskInfo.currentFileBytes);
+        grpcTaskInfo->set_totalbytes(taskInfo.totalBytes);
+        grpcTaskInfo->set_filecount(taskInfo.fileCount);
+        grpcTaskInfo->set_triggercount(taskInfo.triggerCount);
+        for (int i = 0; i < taskInfo.deviceCount; i++) {
+            grpcTaskInfo->add_deviceidlist(taskInfo.deviceIdList[i]);
+        }
     } else {
         switch (res) {
             case XPUM_DUMP_RAW_DATA_TASK_NOT_EXIST:
@@ -197,6 +261,14 @@ static void removeFileOnStartTaskFail(std::string filePath) {
             }
             grpcTaskInfo->set_begintime(taskInfo.beginTime);
             grpcTaskInfo->set_dumpfilepath(taskInfo.dumpFilePath);
+            grpcTaskInfo->set_currentfilepath(taskInfo.currentFilePath);
+            grpcTaskInfo->set_currentfilebytes(taskInfo.currentFileBytes);
+            grpcTaskInfo->set_totalbytes(taskInfo.totalBytes);
+            grpcTaskInfo->set_filecount(taskInfo.fileCount);
+            grpcTaskInfo->set_triggercount(taskInfo.triggerCount);
+            for (int j = 0; j < taskInfo.deviceCount; j++) {
+                grpcTaskInfo->add_deviceidlist(taskInfo.deviceIdList[j]);
+            }
         }
     } else {
         switch (res) {
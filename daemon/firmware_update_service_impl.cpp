@@ -7,6 +7,7 @@
 #include "xpum_core_service_impl.h"
 #include "redfish_amc_manager.h"
 #include "internal_api.h"
+#include "rpc_admission.h"
 
 namespace xpum::daemon {
 
@@ -22,6 +23,10 @@ static std::string getFlashFwErrMsg() {
 ::grpc::Status XpumCoreServiceImpl::runFirmwareFlash(::grpc::ServerContext* context,
                                                      const ::XpumFirmwareFlashJob* request,
                                                      ::XpumFirmwareFlashJobResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_firmware_flash_job job;
     job.type = (xpum_firmware_type_enum)request->type().value();
     job.filePath = request->path().c_str();
@@ -77,9 +82,48 @@ static std::string getFlashFwErrMsg() {
     return grpc::Status::OK;
 }
 
+::grpc::Status XpumCoreServiceImpl::watchFirmwareFlash(::grpc::ServerContext* context,
+                                                       const ::XpumFirmwareFlashTaskRequest* request,
+                                                       ::grpc::ServerWriter<XpumFirmwareFlashTaskResult>* writer) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::STREAMING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
+    // the longest wait before checking if the daemon stops or the client goes away, the result is read again then
+    // as the flashes of the AMC and through Redfish finish without a progress event
+    const uint32_t pollTimeout = 500;
+    xpum_device_id_t deviceId = request->id().id();
+    if (deviceId == XPUM_DEVICE_ID_ALL_DEVICES) {
+        deviceId = -1;
+    }
+
+    uint64_t generation = 0;
+    std::string sent;
+    while (!this->stop && !context->IsCancelled()) {
+        XpumFirmwareFlashTaskResult result;
+        getFirmwareFlashResult(context, request, &result);
+        std::string serialized = result.SerializeAsString();
+        if (serialized != sent) {
+            if (!writer->Write(result)) {
+                break;
+            }
+            sent.swap(serialized);
+        }
+        if (result.errorno() != XPUM_OK || result.result().value() != XPUM_DEVICE_FIRMWARE_FLASH_ONGOING) {
+            break;
+        }
+        xpumWaitForFirmwareFlashProgress(deviceId, &generation, pollTimeout);
+    }
+    return grpc::Status::OK;
+}
+
 grpc::Status XpumCoreServiceImpl::getRedfishAmcWarnMsg(::grpc::ServerContext* context,
                                                        const ::google::protobuf::Empty* request,
                                                        ::GetRedfishAmcWarnMsgResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     auto msg = getRedfishAmcWarn();
     response->set_warnmsg(msg);
     response->set_errorno(XPUM_OK);
@@ -89,6 +133,10 @@ grpc::Status XpumCoreServiceImpl::getRedfishAmcWarnMsg(::grpc::ServerContext* co
 ::grpc::Status XpumCoreServiceImpl::getAMCSensorReading(::grpc::ServerContext* context,
                                 const ::google::protobuf::Empty* request,
                                 ::GetAMCSensorReadingResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     int count;
     auto res = xpumGetAMCSensorReading(nullptr, &count);
     auto errMsg = getFlashFwErrMsg();
@@ -0,0 +1,810 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file xpum_loadtest.cpp
+ */
+
+/*
+  xpum_loadtest scrapes a running xpumd the way a fleet of dashboards and
+  collectors do, over the gRPC socket, the REST endpoints and the Prometheus
+  endpoint at once, and reports what it costs:
+
+    - the latency percentiles and the errors of the requests of each target
+    - the CPU and the resident memory of xpumd, read from /proc every second
+    - the staleness of the samples, the age of the newest sample of the
+      metrics read over REST and of the frames of a subscribeMetrics stream
+
+  With --xpumd the tool starts that xpumd itself on simulated devices, so it
+  runs without any GPU:
+
+    xpum_loadtest --xpumd=/usr/bin/xpumd --devices=16 --grpc_clients=8 \
+                  --rest_clients=8 --metrics_clients=4 --interval=1000 --duration=60
+
+  Without it the tool attaches to the xpumd of --socket_folder and --pid, and
+  scrapes the --rest_url and --metrics_url given, which may be the ones of
+  the Python REST server and Prometheus exporter (--rest_user for their basic
+  authentication, plain HTTP only). The privileged socket is used, so the
+  tool runs as root or as a member of the xpum group.
+*/
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <netdb.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+
+#include "core.grpc.pb.h"
+#include "core.pb.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string xpumd;
+    int devices = 8;
+    int tiles = 0;
+    std::string socket_folder;
+    pid_t pid = 0;
+    int metrics_port = 39966;
+    int rest_port = 39967;
+    int grpc_clients = 4;
+    std::string grpc_rpc = "bulk";
+    int rest_clients = 4;
+    std::string rest_url;
+    std::string rest_user;
+    int metrics_clients = 2;
+    std::string metrics_url;
+    int interval = 1000;
+    int duration = 60;
+    bool staleness_stream = true;
+};
+
+Options options;
+
+std::atomic_bool stopping(false);
+
+long long nowMillisecond() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (long long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+// the values recorded by all the clients of a target, in ms
+class Recorder {
+   public:
+    explicit Recorder(const std::string& name) : name(name) {
+    }
+
+    void add(double value) {
+        std::lock_guard<std::mutex> lck(mutex);
+        values.push_back(value);
+    }
+
+    void addError() {
+        errors++;
+    }
+
+    void print(int clients) {
+        std::lock_guard<std::mutex> lck(mutex);
+        std::sort(values.begin(), values.end());
+        printf("  %-26s %7d %9zu %7u %9.2f %9.2f %9.2f %9.2f\n", name.c_str(), clients, values.size() + errors, errors.load(),
+               percentile(0.5), percentile(0.9), percentile(0.99), values.empty() ? 0.0 : values.back());
+    }
+
+    void printPercentiles() {
+        std::lock_guard<std::mutex> lck(mutex);
+        std::sort(values.begin(), values.end());
+        printf("  %-26s %9zu %9.1f %9.1f %9.1f %9.1f\n", name.c_str(), values.size(), percentile(0.5), percentile(0.9),
+               percentile(0.99), values.empty() ? 0.0 : values.back());
+    }
+
+   private:
+    // called with the values sorted
+    double percentile(double p) {
+        if (values.empty()) {
+            return 0;
+        }
+        size_t index = (size_t)(p * values.size() + 0.999999);
+        return values[std::min(std::max(index, (size_t)1), values.size()) - 1];
+    }
+
+    std::string name;
+    std::mutex mutex;
+    std::vector<double> values;
+    std::atomic<uint32_t> errors{0};
+};
+
+// run a request every interval ms until the end of the test, the latency of each is recorded
+void runClient(Recorder& recorder, Clock::time_point end, const std::function<bool()>& request) {
+    auto next = Clock::now();
+    while (!stopping && Clock::now() < end) {
+        auto begin = Clock::now();
+        bool ok = request();
+        auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+        ok ? recorder.add(elapsed) : recorder.addError();
+        if (options.interval == 0) {
+            continue;
+        }
+        next += std::chrono::milliseconds(options.interval);
+        // a client that falls behind skips the scrapes it missed, as Prometheus does
+        auto now = Clock::now();
+        while (next < now) {
+            next += std::chrono::milliseconds(options.interval);
+        }
+        while (!stopping && Clock::now() < std::min(next, end)) {
+            std::this_thread::sleep_for(std::min(std::chrono::duration_cast<std::chrono::milliseconds>(std::min(next, end) - Clock::now()),
+                                                 std::chrono::milliseconds(100)));
+        }
+    }
+}
+
+// ---------------------------------------------------------------- gRPC
+
+std::shared_ptr<grpc::Channel> createChannel() {
+    std::string folder = options.socket_folder.empty() ? "/tmp/" : options.socket_folder;
+    if (folder.back() != '/') {
+        folder += "/";
+    }
+    grpc::ChannelArguments args;
+    args.SetInt(GRPC_ARG_ENABLE_HTTP_PROXY, 0);
+    // a connection for each client, as separate collectors have
+    args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+    args.SetUserAgentPrefix("xpum_loadtest");
+    return grpc::CreateCustomChannel("unix://" + folder + "xpum_p.sock", grpc::InsecureChannelCredentials(), args);
+}
+
+std::unique_ptr<grpc::ClientContext> createContext() {
+    std::unique_ptr<grpc::ClientContext> context(new grpc::ClientContext());
+    context->set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(10));
+    return context;
+}
+
+bool readDeviceIds(XpumCoreService::Stub& stub, std::vector<uint32_t>& deviceIds) {
+    auto context = createContext();
+    google::protobuf::Empty request;
+    XpumDeviceBasicInfoArray response;
+    grpc::Status status = stub.getDeviceList(context.get(), request, &response);
+    if (!status.ok() || !response.errormsg().empty()) {
+        return false;
+    }
+    deviceIds.clear();
+    for (auto& info : response.info()) {
+        deviceIds.push_back(info.id().id());
+    }
+    return !deviceIds.empty();
+}
+
+// a request of the RPC chosen, the device RPCs ask the devices in turn
+std::function<bool()> createGrpcRequest(const std::shared_ptr<XpumCoreService::Stub>& stub, const std::vector<uint32_t>& deviceIds) {
+    auto turn = std::make_shared<size_t>(0);
+    if (options.grpc_rpc == "bulk") {
+        return [stub, deviceIds]() {
+            auto context = createContext();
+            XpumGetStatsBulkRequest request;
+            for (auto id : deviceIds) {
+                request.add_deviceidlist(id);
+            }
+            request.set_enablefilter(true);
+            XpumGetStatsBulkResponse response;
+            return stub->getStatisticsBulk(context.get(), request, &response).ok() && response.errormsg().empty();
+        };
+    }
+    if (options.grpc_rpc == "snapshot") {
+        return [stub, deviceIds]() {
+            auto context = createContext();
+            XpumGetTelemetrySnapshotRequest request;
+            for (auto id : deviceIds) {
+                request.add_deviceidlist(id);
+            }
+            XpumGetTelemetrySnapshotResponse response;
+            return stub->getTelemetrySnapshot(context.get(), request, &response).ok() && response.errormsg().empty();
+        };
+    }
+    if (options.grpc_rpc == "packed") {
+        auto schemaId = std::make_shared<uint32_t>(0);
+        return [stub, schemaId]() {
+            auto context = createContext();
+            XpumGetPackedStatsRequest request;
+            request.set_schemaid(*schemaId);
+            XpumGetPackedStatsResponse response;
+            if (!stub->getStatisticsPacked(context.get(), request, &response).ok() || !response.errormsg().empty()) {
+                return false;
+            }
+            *schemaId = response.schemaid();
+            return true;
+        };
+    }
+    if (options.grpc_rpc == "stats") {
+        return [stub, deviceIds, turn]() {
+            auto context = createContext();
+            XpumGetStatsRequest request;
+            request.set_deviceid(deviceIds[(*turn)++ % deviceIds.size()]);
+            request.set_enablefilter(true);
+            XpumGetStatsResponse response;
+            return stub->getStatistics(context.get(), request, &response).ok() && response.errormsg().empty();
+        };
+    }
+    return [stub, deviceIds, turn]() {
+        auto context = createContext();
+        DeviceId request;
+        request.set_id(deviceIds[(*turn)++ % deviceIds.size()]);
+        DeviceStatsInfoArray response;
+        return stub->getMetrics(context.get(), request, &response).ok() && response.errormsg().empty();
+    };
+}
+
+// the age of the newest sample of each frame when it is received
+void runStalenessStream(Recorder& recorder, const std::vector<uint32_t>& deviceIds, grpc::ClientContext& context) {
+    auto stub = XpumCoreService::NewStub(createChannel());
+    XpumSubscribeMetricsRequest request;
+    for (auto id : deviceIds) {
+        request.add_deviceidlist(id);
+    }
+    request.set_interval(options.interval > 0 ? options.interval : 100);
+    auto reader = stub->subscribeMetrics(&context, request);
+    MetricsFrame frame;
+    while (reader->Read(&frame)) {
+        long long now = nowMillisecond();
+        uint64_t newest = 0;
+        for (auto& data : frame.datalist()) {
+            newest = std::max(newest, (uint64_t)data.timestamp());
+        }
+        if (newest > 0 && !frame.keyframe()) {
+            recorder.add((double)std::max(now - (long long)newest, 0LL));
+        }
+    }
+    reader->Finish();
+}
+
+// ---------------------------------------------------------------- HTTP
+
+struct Url {
+    std::string host;
+    std::string port;
+    std::string path;
+};
+
+bool parseUrl(const std::string& str, Url& url) {
+    const std::string scheme = "http://";
+    if (str.compare(0, scheme.size(), scheme) != 0) {
+        return false;
+    }
+    auto authority_end = str.find('/', scheme.size());
+    std::string authority = str.substr(scheme.size(), authority_end == std::string::npos ? std::string::npos : authority_end - scheme.size());
+    url.path = authority_end == std::string::npos ? "/" : str.substr(authority_end);
+    auto colon = authority.rfind(':');
+    url.host = colon == std::string::npos ? authority : authority.substr(0, colon);
+    url.port = colon == std::string::npos ? "80" : authority.substr(colon + 1);
+    while (url.path.size() > 1 && url.path.back() == '/') {
+        url.path.pop_back();
+    }
+    return !url.host.empty();
+}
+
+std::string base64(const std::string& str) {
+    static const char* table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < str.size(); i += 3) {
+        uint32_t n = (uint8_t)str[i] << 16;
+        if (i + 1 < str.size()) {
+            n |= (uint8_t)str[i + 1] << 8;
+        }
+        if (i + 2 < str.size()) {
+            n |= (uint8_t)str[i + 2];
+        }
+        out += table[(n >> 18) & 63];
+        out += table[(n >> 12) & 63];
+        out += i + 1 < str.size() ? table[(n >> 6) & 63] : '=';
+        out += i + 2 < str.size() ? table[n & 63] : '=';
+    }
+    return out;
+}
+
+// GET the path on a connection of its own, false unless the status is 200
+bool httpGet(const Url& url, const std::string& path, std::string& body) {
+    struct addrinfo hints {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* addresses = nullptr;
+    if (getaddrinfo(url.host.c_str(), url.port.c_str(), &hints, &addresses) != 0) {
+        return false;
+    }
+    int fd = -1;
+    for (auto address = addresses; address != nullptr && fd < 0; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+        if (fd >= 0 && connect(fd, address->ai_addr, address->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0) {
+        return false;
+    }
+    struct timeval timeout {10, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: " + url.host + ":" + url.port + "\r\nConnection: close\r\n";
+    if (!options.rest_user.empty()) {
+        request += "Authorization: Basic " + base64(options.rest_user) + "\r\n";
+    }
+    request += "\r\n";
+    bool ok = send(fd, request.data(), request.size(), MSG_NOSIGNAL) == (ssize_t)request.size();
+    std::string response;
+    char buf[16384];
+    ssize_t n = 0;
+    while (ok && (n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+        response.append(buf, n);
+    }
+    close(fd);
+    if (!ok || n < 0) {
+        return false;
+    }
+    auto header_end = response.find("\r\n\r\n");
+    bool http = response.compare(0, 9, "HTTP/1.1 ") == 0 || response.compare(0, 9, "HTTP/1.0 ") == 0;
+    if (header_end == std::string::npos || !http || response.compare(9, 3, "200") != 0) {
+        return false;
+    }
+    body = response.substr(header_end + 4);
+    return true;
+}
+
+// the newest of the "timestamp": "2022-02-23T05:21:08.000Z" of a metrics body, in ms
+long long newestTimestamp(const std::string& body) {
+    const std::string key = "\"timestamp\": \"";
+    long long newest = 0;
+    for (auto pos = body.find(key); pos != std::string::npos; pos = body.find(key, pos + key.size())) {
+        struct tm tm {};
+        int ms = 0;
+        if (sscanf(body.c_str() + pos + key.size(), "%d-%d-%dT%d:%d:%d.%dZ", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour,
+                   &tm.tm_min, &tm.tm_sec, &ms) != 7) {
+            continue;
+        }
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+        newest = std::max(newest, (long long)timegm(&tm) * 1000 + ms);
+    }
+    return newest;
+}
+
+// ---------------------------------------------------------------- xpumd
+
+struct ProcessUsage {
+    std::mutex mutex;
+    std::vector<double> cpu;
+    long max_rss_kb = 0;
+    long last_rss_kb = 0;
+};
+
+bool readCpuTicks(pid_t pid, unsigned long long& ticks) {
+    std::ifstream file("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat;
+    if (!std::getline(file, stat)) {
+        return false;
+    }
+    // the command may hold spaces, the fields are counted from its closing parenthesis
+    auto pos = stat.rfind(')');
+    if (pos == std::string::npos) {
+        return false;
+    }
+    std::istringstream fields(stat.substr(pos + 2));
+    std::string field;
+    unsigned long long utime = 0, stime = 0;
+    for (int i = 3; i <= 15 && fields >> field; i++) {
+        if (i == 14) {
+            utime = std::stoull(field);
+        } else if (i == 15) {
+            stime = std::stoull(field);
+        }
+    }
+    ticks = utime + stime;
+    return true;
+}
+
+long readRssKb(pid_t pid) {
+    std::ifstream file("/proc/" + std::to_string(pid) + "/status");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return std::atol(line.c_str() + 6);
+        }
+    }
+    return 0;
+}
+
+void sampleProcess(pid_t pid, Clock::time_point end, ProcessUsage& usage) {
+    long clock_ticks = sysconf(_SC_CLK_TCK);
+    unsigned long long last_ticks = 0;
+    if (!readCpuTicks(pid, last_ticks)) {
+        return;
+    }
+    auto last = Clock::now();
+    while (!stopping && Clock::now() < end) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        unsigned long long ticks;
+        if (!readCpuTicks(pid, ticks)) {
+            return;
+        }
+        auto now = Clock::now();
+        double seconds = std::chrono::duration<double>(now - last).count();
+        long rss = readRssKb(pid);
+        std::lock_guard<std::mutex> lck(usage.mutex);
+        usage.cpu.push_back(100.0 * (ticks - last_ticks) / clock_ticks / seconds);
+        usage.last_rss_kb = rss;
+        usage.max_rss_kb = std::max(usage.max_rss_kb, rss);
+        last_ticks = ticks;
+        last = now;
+    }
+}
+
+// start options.xpumd on simulated devices, with its sockets, PID file and log in a folder of its own
+pid_t startXpumd(std::string& folder) {
+    char dir[] = "/tmp/xpum_loadtest.XXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        perror("mkdtemp");
+        return -1;
+    }
+    folder = dir;
+    chmod(dir, 0755);
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+    setenv("XPUM_SIMULATED_DEVICES", std::to_string(options.devices).c_str(), 1);
+    if (options.tiles > 0) {
+        setenv("XPUM_SIMULATED_DEVICE_TILES", std::to_string(options.tiles).c_str(), 1);
+    }
+    std::vector<std::string> args = {options.xpumd, "-s", folder, "-p", folder + "/xpumd.pid", "-d", folder, "-l", folder + "/xpumd.log",
+                                     "--metrics_port=" + std::to_string(options.metrics_port),
+                                     "--rest_port=" + std::to_string(options.rest_port)};
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+    execv(argv[0], argv.data());
+    perror("execv");
+    _exit(127);
+}
+
+bool waitForDevices(XpumCoreService::Stub& stub, pid_t child, std::vector<uint32_t>& deviceIds) {
+    for (int i = 0; i < 600 && !stopping; i++) {
+        if (readDeviceIds(stub, deviceIds)) {
+            return true;
+        }
+        if (child > 0 && waitpid(child, nullptr, WNOHANG) == child) {
+            fprintf(stderr, "xpumd exited\n");
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return false;
+}
+
+void printHelp(const char* app_name) {
+    printf("\n Usage: %s [OPTIONS]\n\n", app_name);
+    printf("  Options:\n");
+    printf("   -h, --help                       print this help\n");
+    printf("       --xpumd=filename             start this xpumd on simulated devices and stop it at the end\n");
+    printf("       --devices=number             simulated devices of the xpumd started, default 8\n");
+    printf("       --tiles=number               tiles of each simulated device\n");
+    printf("       --metrics_port=number        metrics port of the xpumd started, default 39966\n");
+    printf("       --rest_port=number           REST port of the xpumd started, default 39967\n");
+    printf("   -s, --socket_folder=foldername   socket folder of the xpumd attached to, default /tmp\n");
+    printf("       --pid=number                 the xpumd attached to, to measure its CPU and memory\n");
+    printf("       --grpc_clients=number        gRPC clients, default 4\n");
+    printf("       --grpc_rpc=RPC               bulk (default), snapshot, packed, stats or metrics\n");
+    printf("       --rest_clients=number        REST clients, default 4\n");
+    printf("       --rest_url=url               REST API to scrape, e.g. http://127.0.0.1:30000/rest/v1\n");
+    printf("       --rest_user=user:password    basic authentication of the REST API\n");
+    printf("       --metrics_clients=number     Prometheus clients, default 2\n");
+    printf("       --metrics_url=url            Prometheus endpoint to scrape, e.g. http://127.0.0.1:9966/metrics\n");
+    printf("       --interval=number            ms between the requests of a client, default 1000, 0 for back to back\n");
+    printf("       --duration=number            seconds of the test, default 60\n");
+    printf("       --no_staleness_stream        do not follow the samples with a subscribeMetrics stream\n");
+    printf("\n");
+}
+
+bool parseNumber(const char* str, long min, long max, long& value) {
+    char* end = nullptr;
+    value = strtol(str, &end, 10);
+    return end != str && *end == '\0' && value >= min && value <= max;
+}
+
+bool parseOptions(int argc, char* argv[]) {
+    int lopt = 0;
+    static struct option long_options[] = {
+        {"help", no_argument, 0, 'h'},
+        {"socket_folder", required_argument, 0, 's'},
+        {"xpumd", required_argument, &lopt, 1},
+        {"devices", required_argument, &lopt, 2},
+        {"tiles", required_argument, &lopt, 3},
+        {"metrics_port", required_argument, &lopt, 4},
+        {"rest_port", required_argument, &lopt, 5},
+        {"pid", required_argument, &lopt, 6},
+        {"grpc_clients", required_argument, &lopt, 7},
+        {"grpc_rpc", required_argument, &lopt, 8},
+        {"rest_clients", required_argument, &lopt, 9},
+        {"rest_url", required_argument, &lopt, 10},
+        {"rest_user", required_argument, &lopt, 11},
+        {"metrics_clients", required_argument, &lopt, 12},
+        {"metrics_url", required_argument, &lopt, 13},
+        {"interval", required_argument, &lopt, 14},
+        {"duration", required_argument, &lopt, 15},
+        {"no_staleness_stream", no_argument, &lopt, 16},
+        {0, 0, 0, 0}};
+    int value = 0;
+    int option_index = 0;
+    long number = 0;
+    while ((value = getopt_long(argc, argv, "s:h", long_options, &option_index)) != -1) {
+        switch (value) {
+            case 0: {
+                bool ok = true;
+                switch (lopt) {
+                    case 1:
+                        options.xpumd = optarg;
+                        break;
+                    case 2:
+                        ok = parseNumber(optarg, 1, 1024, number);
+                        options.devices = (int)number;
+                        break;
+                    case 3:
+                        ok = parseNumber(optarg, 1, 16, number);
+                        options.tiles = (int)number;
+                        break;
+                    case 4:
+                        ok = parseNumber(optarg, 1, 65535, number);
+                        options.metrics_port = (int)number;
+                        break;
+                    case 5:
+                        ok = parseNumber(optarg, 1, 65535, number);
+                        options.rest_port = (int)number;
+                        break;
+                    case 6:
+                        ok = parseNumber(optarg, 1, INT32_MAX, number);
+                        options.pid = (pid_t)number;
+                        break;
+                    case 7:
+                        ok = parseNumber(optarg, 0, 1024, number);
+                        options.grpc_clients = (int)number;
+                        break;
+                    case 8:
+                        options.grpc_rpc = optarg;
+                        ok = options.grpc_rpc == "bulk" || options.grpc_rpc == "snapshot" || options.grpc_rpc == "packed" ||
+                             options.grpc_rpc == "stats" || options.grpc_rpc == "metrics";
+                        break;
+                    case 9:
+                        ok = parseNumber(optarg, 0, 1024, number);
+                        options.rest_clients = (int)number;
+                        break;
+                    case 10:
+                        options.rest_url = optarg;
+                        break;
+                    case 11:
+                        options.rest_user = optarg;
+                        break;
+                    case 12:
+                        ok = parseNumber(optarg, 0, 1024, number);
+                        options.metrics_clients = (int)number;
+                        break;
+                    case 13:
+                        options.metrics_url = optarg;
+                        break;
+                    case 14:
+                        ok = parseNumber(optarg, 0, 3600000, number);
+                        options.interval = (int)number;
+                        break;
+                    case 15:
+                        ok = parseNumber(optarg, 1, 86400, number);
+                        options.duration = (int)number;
+                        break;
+                    case 16:
+                        options.staleness_stream = false;
+                        break;
+                }
+                if (!ok) {
+                    fprintf(stderr, "invalid value of --%s: %s\n", long_options[option_index].name, optarg);
+                    return false;
+                }
+                break;
+            }
+            case 's':
+                options.socket_folder = optarg;
+                break;
+            case 'h':
+            case '?':
+            default:
+                printHelp(argv[0]);
+                return false;
+        }
+    }
+    return true;
+}
+
+void signalHandler(int sig) {
+    stopping = true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (!parseOptions(argc, argv)) {
+        return 1;
+    }
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+
+    pid_t child = -1;
+    std::string folder;
+    if (!options.xpumd.empty()) {
+        child = startXpumd(folder);
+        if (child < 0) {
+            return 1;
+        }
+        options.socket_folder = folder;
+        options.pid = child;
+        if (options.rest_url.empty()) {
+            options.rest_url = "http://127.0.0.1:" + std::to_string(options.rest_port) + "/rest/v1";
+        }
+        if (options.metrics_url.empty()) {
+            options.metrics_url = "http://127.0.0.1:" + std::to_string(options.metrics_port) + "/metrics";
+        }
+    }
+    auto stopXpumd = [&]() {
+        if (child > 0) {
+            kill(child, SIGTERM);
+            waitpid(child, nullptr, 0);
+            printf("xpumd log: %s/xpumd.log\n", folder.c_str());
+        }
+    };
+
+    Url rest_url, metrics_url;
+    if (options.rest_url.empty() || !parseUrl(options.rest_url, rest_url)) {
+        if (!options.rest_url.empty()) {
+            fprintf(stderr, "invalid REST URL: %s\n", options.rest_url.c_str());
+        }
+        options.rest_clients = 0;
+    }
+    if (options.metrics_url.empty() || !parseUrl(options.metrics_url, metrics_url)) {
+        if (!options.metrics_url.empty()) {
+            fprintf(stderr, "invalid metrics URL: %s\n", options.metrics_url.c_str());
+        }
+        options.metrics_clients = 0;
+    }
+
+    std::vector<uint32_t> deviceIds;
+    {
+        auto stub = XpumCoreService::NewStub(createChannel());
+        if (!waitForDevices(*stub, child, deviceIds)) {
+            fprintf(stderr, "no device is read from xpumd\n");
+            stopXpumd();
+            return 1;
+        }
+    }
+    // the first samples of the devices of an xpumd just started
+    if (child > 0) {
+        std::this_thread::sleep_for(std::chrono::seconds(2));
+    }
+    printf("%zu devices, %d gRPC (%s), %d REST and %d metrics clients, every %d ms for %d s\n", deviceIds.size(), options.grpc_clients,
+           options.grpc_rpc.c_str(), options.rest_clients, options.metrics_clients, options.interval, options.duration);
+
+    Recorder grpc_latency("grpc " + options.grpc_rpc);
+    Recorder rest_latency("rest metrics");
+    Recorder metrics_latency("prometheus metrics");
+    Recorder rest_staleness("rest metrics");
+    Recorder stream_staleness("grpc subscribeMetrics");
+    ProcessUsage usage;
+
+    auto end = Clock::now() + std::chrono::seconds(options.duration);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.grpc_clients; i++) {
+        std::shared_ptr<XpumCoreService::Stub> stub(XpumCoreService::NewStub(createChannel()));
+        auto request = createGrpcRequest(stub, deviceIds);
+        threads.emplace_back([&grpc_latency, end, request]() { runClient(grpc_latency, end, request); });
+    }
+    for (int i = 0; i < options.rest_clients; i++) {
+        // the clients start on different devices, each asks the devices in turn
+        auto turn = std::make_shared<size_t>(i);
+        auto request = [&rest_url, &rest_staleness, &deviceIds, turn]() {
+            std::string body;
+            std::string path = rest_url.path + "/devices/" + std::to_string(deviceIds[(*turn)++ % deviceIds.size()]) + "/metrics";
+            if (!httpGet(rest_url, path, body)) {
+                return false;
+            }
+            long long newest = newestTimestamp(body);
+            if (newest > 0) {
+                rest_staleness.add((double)std::max(nowMillisecond() - newest, 0LL));
+            }
+            return true;
+        };
+        threads.emplace_back([&rest_latency, end, request]() { runClient(rest_latency, end, request); });
+    }
+    for (int i = 0; i < options.metrics_clients; i++) {
+        auto request = [&metrics_url]() {
+            std::string body;
+            return httpGet(metrics_url, metrics_url.path, body) && !body.empty();
+        };
+        threads.emplace_back([&metrics_latency, end, request]() { runClient(metrics_latency, end, request); });
+    }
+    grpc::ClientContext stream_context;
+    std::thread stream;
+    if (options.staleness_stream) {
+        stream = std::thread([&]() { runStalenessStream(stream_staleness, deviceIds, stream_context); });
+    }
+    std::thread sampler;
+    if (options.pid > 0) {
+        sampler = std::thread([&]() { sampleProcess(options.pid, end, usage); });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (sampler.joinable()) {
+        sampler.join();
+    }
+    if (stream.joinable()) {
+        stream_context.TryCancel();
+        stream.join();
+    }
+
+    printf("\nLatency (ms)\n");
+    printf("  %-26s %7s %9s %7s %9s %9s %9s %9s\n", "target", "clients", "requests", "errors", "p50", "p90", "p99", "max");
+    if (options.grpc_clients > 0) {
+        grpc_latency.print(options.grpc_clients);
+    }
+    if (options.rest_clients > 0) {
+        rest_latency.print(options.rest_clients);
+    }
+    if (options.metrics_clients > 0) {
+        metrics_latency.print(options.metrics_clients);
+    }
+
+    printf("\nSample staleness (ms)\n");
+    printf("  %-26s %9s %9s %9s %9s %9s\n", "source", "samples", "p50", "p90", "p99", "max");
+    if (options.rest_clients > 0) {
+        rest_staleness.printPercentiles();
+    }
+    if (options.staleness_stream) {
+        stream_staleness.printPercentiles();
+    }
+
+    if (options.pid > 0) {
+        std::lock_guard<std::mutex> lck(usage.mutex);
+        double total = 0, max = 0;
+        for (auto cpu : usage.cpu) {
+            total += cpu;
+            max = std::max(max, cpu);
+        }
+        printf("\nxpumd %d\n", (int)options.pid);
+        printf("  CPU %% of a core          avg %.1f, max %.1f\n", usage.cpu.empty() ? 0.0 : total / usage.cpu.size(), max);
+        printf("  RSS MB                   max %.1f, end %.1f\n", usage.max_rss_kb / 1024.0, usage.last_rss_kb / 1024.0);
+    }
+
+    stopXpumd();
+    return 0;
+}
@@ -5,8 +5,10 @@
  */
 
 #pragma once
+#include <cstdlib>
 #include <string>
 
+#include "spdlog/async.h"
 #include "spdlog/cfg/env.h"
 #include "spdlog/sinks/rotating_file_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
@@ -16,7 +18,16 @@
 #define XPUM_LOG_WARN(...) spdlog::warn(__VA_ARGS__)
 #define XPUM_LOG_ERROR(...) spdlog::error(__VA_ARGS__)
 #define XPUM_LOG_DEBUG(...) spdlog::debug(__VA_ARGS__)
+#ifdef XPUM_LOG_NO_TRACE
+#define XPUM_LOG_TRACE(...)         \
+    do {                            \
+        if (false) {                \
+            spdlog::trace(__VA_ARGS__); \
+        }                           \
+    } while (0)
+#else
 #define XPUM_LOG_TRACE(...) spdlog::trace(__VA_ARGS__)
+#endif
 #define XPUM_LOG_FATAL(...) spdlog::critical(__VA_ARGS__)
 
 namespace xpum::daemon {
@@ -29,7 +40,17 @@ class Logger {
         if (log_file_name != nullptr) {
             sinks.emplace_back(std::make_shared<spdlog::sinks::rotating_file_sink_mt>(log_file_name, max_size, max_files, false));
         }
-        auto logger = std::make_shared<spdlog::logger>("daemon", begin(sinks), end(sinks));
+        std::shared_ptr<spdlog::logger> logger;
+        // the messages are formatted and written by a spdlog thread, a full queue drops the oldest
+        // ones instead of blocking the monitor threads; XPUM_LOG_ASYNC=0 logs in the caller thread
+        const char* env = std::getenv("XPUM_LOG_ASYNC");
+        if (env == nullptr || std::string(env) != "0") {
+            spdlog::init_thread_pool(async_queue_size, 1);
+            logger = std::make_shared<spdlog::async_logger>("daemon", begin(sinks), end(sinks), spdlog::thread_pool(),
+                                                            spdlog::async_overflow_policy::overrun_oldest);
+        } else {
+            logger = std::make_shared<spdlog::logger>("daemon", begin(sinks), end(sinks));
+        }
         logger->flush_on(spdlog::level::info);
         spdlog::flush_every(std::chrono::seconds(3));
         spdlog::set_default_logger(logger);
@@ -51,5 +72,8 @@ class Logger {
     static void close() {
         spdlog::shutdown();
     }
+
+   private:
+    static const std::size_t async_queue_size = 8192;
 };
 } // namespace xpum::daemon
\ No newline at end of file
@@ -0,0 +1,790 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file metrics_exporter.cpp
+ */
+
+#include "metrics_exporter.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/sysinfo.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include "internal_api.h"
+#include "logger.h"
+#include "xpum_api.h"
+
+namespace xpum::daemon {
+
+namespace {
+
+struct MetricFamily {
+    const char* name;
+    const char* help;
+    bool counter;
+};
+
+enum MetricFamilyIndex {
+    ENGINE_RATIO,
+    ENGINE_GROUP_RATIO,
+    EU_ACTIVE_RATIO,
+    EU_STALL_RATIO,
+    EU_IDLE_RATIO,
+    POWER_WATTS,
+    ENERGY_JOULES,
+    TEMPERATURE_CELSIUS,
+    FREQUENCY_MHZ,
+    MEMORY_USED_BYTES,
+    MEMORY_RATIO,
+    MEMORY_BANDWIDTH_RATIO,
+    MEMORY_READ_BYTES,
+    MEMORY_WRITE_BYTES,
+    RESETS,
+    PROGRAMMING_ERRORS,
+    DRIVER_ERRORS,
+    CACHE_ERRORS,
+    NON_COMPUTE_ERRORS,
+    PCIE_READ_BYTES,
+    PCIE_WRITE_BYTES,
+    FABRIC_TX_BYTES,
+    PER_ENGINE_RATIO,
+    METRIC_FAMILY_COUNT
+};
+
+// keep in sync with rest/prometheus_exporter/prometheus_exporter_types.py
+const MetricFamily metric_families[METRIC_FAMILY_COUNT] = {
+    {"xpum_engine_ratio", "GPU active time of the elapsed time (in %), per GPU tile", false},
+    {"xpum_engine_group_ratio", "Avg utilization of engine group (in %), per GPU tile", false},
+    {"xpum_eu_active_ratio", "GPU EU Array Active (in %), the normalized sum of all cycles on all EUs that were spent actively executing instructions. Per tile.", false},
+    {"xpum_eu_stall_ratio", "GPU EU Array Stall (in %), the normalized sum of all cycles on all EUs during which the EUs were stalled. Per tile. At least one thread is loaded, but the EU is stalled. Per tile.", false},
+    {"xpum_eu_idle_ratio", "GPU EU Array Idle (in %), the normalized sum of all cycles on all cores when no threads were scheduled on a core. Per tile.", false},
+    {"xpum_power_watts", "Avg GPU power (in watts), per GPU and per card", false},
+    {"xpum_energy_joules", "Total GPU energy consumption since boot (in Joules), per GPU", true},
+    {"xpum_temperature_celsius", "Avg GPU temperature (in Celsius degree), per tile", false},
+    {"xpum_frequency_mhz", "Avg (GPU) frequency (in MHz), per GPU tile", false},
+    {"xpum_memory_used_bytes", "Used GPU memory (in bytes), per GPU tile", false},
+    {"xpum_memory_ratio", "Used GPU memory / Total used GPU memory (in %), per GPU tile", false},
+    {"xpum_memory_bandwidth_ratio", "Avg memory throughput / max memory bandwidth (in %), per GPU tile", false},
+    {"xpum_memory_read_bytes", "Total memory read bytes (in bytes), per GPU tile", true},
+    {"xpum_memory_write_bytes", "Total memory write bytes (in bytes), per GPU tile", true},
+    {"xpum_resets", "Total number of GPU reset since Sysman init, per GPU", true},
+    {"xpum_programming_errors", "Total number of GPU programming errors since Sysman init, per GPU", true},
+    {"xpum_driver_errors", "Total number of GPU driver errors since Sysman init, per GPU", true},
+    {"xpum_cache_errors", "Total number of GPU cache errors since Sysman init, per GPU", true},
+    {"xpum_non_compute_errors", "Total number of GPU non-compute errors since Sysman init, per GPU", true},
+    {"xpum_pcie_read_bytes", "Total PCIe read bytes (in bytes), per GPU", true},
+    {"xpum_pcie_write_bytes", "Total PCIe write bytes (in bytes), per GPU", true},
+    {"xpum_fabric_tx_bytes", "Data transmitted through fabric link (in bytes)", true},
+    {"xpum_per_engine_ratio", "Per-engine utilization (in %)", false},
+};
+
+struct InternalStatsFamily {
+    xpum_internal_stats_type_t type;
+    const char* name;
+    const char* help;
+    // the label of the name of the operation
+    const char* label;
+};
+
+const InternalStatsFamily internal_stats_families[] = {
+    {XPUM_INTERNAL_STATS_ZE_LOCK_WAIT, "xpum_internal_ze_lock_wait_seconds", "Time waiting for the lock of a Level Zero handle (in seconds), per Level Zero function", "function"},
+    {XPUM_INTERNAL_STATS_ZE_CALL, "xpum_internal_ze_call_seconds", "Time spent in Level Zero calls (in seconds), per Level Zero function", "function"},
+    {XPUM_INTERNAL_STATS_MONITOR_TICK_LATENESS, "xpum_internal_monitor_tick_lateness_seconds", "How late the ticks of a monitor task start (in seconds), per monitor task", "task"},
+    {XPUM_INTERNAL_STATS_MONITOR_COLLECT, "xpum_internal_monitor_collect_seconds", "Time collecting a capability from a device in a monitor tick (in seconds), per capability", "capability"},
+    {XPUM_INTERNAL_STATS_MONITOR_STORE, "xpum_internal_monitor_store_seconds", "Time storing the data of a capability in a monitor tick (in seconds), per capability", "capability"},
+    {XPUM_INTERNAL_STATS_EVENT_DELIVERY, "xpum_internal_event_delivery_seconds", "Time from publishing an event to its delivery to a subscriber (in seconds), per subscriber", "subscriber"},
+    {XPUM_INTERNAL_STATS_CPU_TIME, "xpum_internal_cpu_seconds", "CPU time of xpumd in an interval of the CPU budget governor (in seconds), per thread group", "group"},
+};
+
+// the statistics session of the exporter, reading the fabric statistics restarts the session
+const uint64_t FABRIC_STATS_SESSION = 2;
+
+// the hardware counters count since boot, the RAS counts since Sysman init
+bool countsSinceBoot(MetricFamilyIndex family) {
+    switch (family) {
+        case RESETS:
+        case PROGRAMMING_ERRORS:
+        case DRIVER_ERRORS:
+        case CACHE_ERRORS:
+        case NON_COMPUTE_ERRORS:
+            return false;
+        default:
+            return true;
+    }
+}
+
+double getEpochSeconds() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() / 1000.0;
+}
+
+enum class TileAggregation {
+    NONE,
+    SUM,
+    AVG
+};
+
+struct StatsMetric {
+    MetricFamilyIndex family;
+    // rendered extra labels, each followed by a comma
+    const char* ext_labels;
+    double scale;
+    // how the tile values make up the device value if the device has none
+    TileAggregation aggregation;
+};
+
+const std::map<xpum_stats_type_t, StatsMetric> stats_metrics = {
+    {XPUM_STATS_GPU_UTILIZATION, {ENGINE_RATIO, "", 0.01, TileAggregation::AVG}},
+    {XPUM_STATS_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION, {ENGINE_GROUP_RATIO, "type=\"compute\",", 0.01, TileAggregation::NONE}},
+    {XPUM_STATS_ENGINE_GROUP_MEDIA_ALL_UTILIZATION, {ENGINE_GROUP_RATIO, "type=\"media\",", 0.01, TileAggregation::NONE}},
+    {XPUM_STATS_ENGINE_GROUP_COPY_ALL_UTILIZATION, {ENGINE_GROUP_RATIO, "type=\"copy\",", 0.01, TileAggregation::NONE}},
+    {XPUM_STATS_ENGINE_GROUP_RENDER_ALL_UTILIZATION, {ENGINE_GROUP_RATIO, "type=\"render\",", 0.01, TileAggregation::NONE}},
+    {XPUM_STATS_ENGINE_GROUP_3D_ALL_UTILIZATION, {ENGINE_GROUP_RATIO, "type=\"3d\",", 0.01, TileAggregation::NONE}},
+    {XPUM_STATS_EU_ACTIVE, {EU_ACTIVE_RATIO, "", 0.01, TileAggregation::NONE}},
+    {XPUM_STATS_EU_STALL, {EU_STALL_RATIO, "", 0.01, TileAggregation::NONE}},
+    {XPUM_STATS_EU_IDLE, {EU_IDLE_RATIO, "", 0.01, TileAggregation::NONE}},
+    {XPUM_STATS_POWER, {POWER_WATTS, "", 1, TileAggregation::SUM}},
+    {XPUM_STATS_ENERGY, {ENERGY_JOULES, "", 0.001, TileAggregation::NONE}},
+    {XPUM_STATS_GPU_CORE_TEMPERATURE, {TEMPERATURE_CELSIUS, "location=\"gpu\",", 1, TileAggregation::NONE}},
+    {XPUM_STATS_MEMORY_TEMPERATURE, {TEMPERATURE_CELSIUS, "location=\"mem\",", 1, TileAggregation::NONE}},
+    {XPUM_STATS_GPU_FREQUENCY, {FREQUENCY_MHZ, "location=\"gpu\",type=\"actual\",", 1, TileAggregation::NONE}},
+    {XPUM_STATS_GPU_REQUEST_FREQUENCY, {FREQUENCY_MHZ, "location=\"gpu\",type=\"request\",", 1, TileAggregation::NONE}},
+    {XPUM_STATS_MEMORY_USED, {MEMORY_USED_BYTES, "", 1, TileAggregation::NONE}},
+    {XPUM_STATS_MEMORY_UTILIZATION, {MEMORY_RATIO, "", 0.01, TileAggregation::AVG}},
+    {XPUM_STATS_MEMORY_BANDWIDTH, {MEMORY_BANDWIDTH_RATIO, "", 0.01, TileAggregation::AVG}},
+    {XPUM_STATS_MEMORY_READ, {MEMORY_READ_BYTES, "", 1, TileAggregation::NONE}},
+    {XPUM_STATS_MEMORY_WRITE, {MEMORY_WRITE_BYTES, "", 1, TileAggregation::NONE}},
+    {XPUM_STATS_RAS_ERROR_CAT_RESET, {RESETS, "", 1, TileAggregation::SUM}},
+    {XPUM_STATS_RAS_ERROR_CAT_PROGRAMMING_ERRORS, {PROGRAMMING_ERRORS, "", 1, TileAggregation::SUM}},
+    {XPUM_STATS_RAS_ERROR_CAT_DRIVER_ERRORS, {DRIVER_ERRORS, "", 1, TileAggregation::SUM}},
+    {XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE, {CACHE_ERRORS, "type=\"correctable\",", 1, TileAggregation::SUM}},
+    {XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE, {CACHE_ERRORS, "type=\"uncorrectable\",", 1, TileAggregation::SUM}},
+    {XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE, {NON_COMPUTE_ERRORS, "type=\"correctable\",", 1, TileAggregation::SUM}},
+    {XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE, {NON_COMPUTE_ERRORS, "type=\"uncorrectable\",", 1, TileAggregation::SUM}},
+    {XPUM_STATS_PCIE_READ, {PCIE_READ_BYTES, "", 1, TileAggregation::NONE}},
+    {XPUM_STATS_PCIE_WRITE, {PCIE_WRITE_BYTES, "", 1, TileAggregation::NONE}},
+};
+
+const char* engineTypeName(xpum_engine_type_t type) {
+    switch (type) {
+        case XPUM_ENGINE_TYPE_COMPUTE:
+            return "XPUM_ENGINE_TYPE_COMPUTE";
+        case XPUM_ENGINE_TYPE_RENDER:
+            return "XPUM_ENGINE_TYPE_RENDER";
+        case XPUM_ENGINE_TYPE_DECODE:
+            return "XPUM_ENGINE_TYPE_DECODE";
+        case XPUM_ENGINE_TYPE_ENCODE:
+            return "XPUM_ENGINE_TYPE_ENCODE";
+        case XPUM_ENGINE_TYPE_COPY:
+            return "XPUM_ENGINE_TYPE_COPY";
+        case XPUM_ENGINE_TYPE_MEDIA_ENHANCEMENT:
+            return "XPUM_ENGINE_TYPE_MEDIA_ENHANCEMENT";
+        case XPUM_ENGINE_TYPE_3D:
+            return "XPUM_ENGINE_TYPE_3D";
+        default:
+            return "XPUM_ENGINE_TYPE_UNKNOWN";
+    }
+}
+
+void appendLabel(std::string& labels, const char* name, const std::string& value) {
+    if (!labels.empty()) {
+        labels += ',';
+    }
+    labels += name;
+    labels += "=\"";
+    for (char c : value) {
+        switch (c) {
+            case '\\':
+                labels += "\\\\";
+                break;
+            case '"':
+                labels += "\\\"";
+                break;
+            case '\n':
+                labels += "\\n";
+                break;
+            default:
+                labels += c;
+                break;
+        }
+    }
+    labels += '"';
+}
+
+void appendSample(std::string& body, MetricFamilyIndex family, const std::string& labels,
+                  const char* ext_labels, const char* src, double value, const char* suffix = nullptr) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.15g", value);
+    body += metric_families[family].name;
+    if (suffix != nullptr) {
+        body += suffix;
+    } else if (metric_families[family].counter) {
+        body += "_total";
+    }
+    body += '{';
+    body += labels;
+    body += ',';
+    body += ext_labels;
+    body += "src=\"";
+    body += src;
+    body += "\"} ";
+    body += buf;
+    body += '\n';
+}
+
+double toValue(const xpum_device_metric_data_t& data, const StatsMetric& metric) {
+    double value = data.value;
+    if (data.scale > 1) {
+        value /= data.scale;
+    }
+    return value * metric.scale;
+}
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+void sendResponse(int fd, const char* status, const char* content_type, const std::string& body) {
+    std::string response = "HTTP/1.1 ";
+    response += status;
+    response += "\r\nContent-Type: ";
+    response += content_type;
+    response += "\r\nContent-Length: ";
+    response += std::to_string(body.size());
+    response += "\r\nConnection: close\r\n\r\n";
+    response += body;
+    sendAll(fd, response);
+}
+
+} // namespace
+
+MetricsExporter::MetricsExporter(const std::string& address, int port)
+    : address(address), port(port), listen_fd(-1), stopping(false) {
+    start_time = getEpochSeconds();
+    struct sysinfo info {};
+    boot_time = sysinfo(&info) == 0 ? start_time - info.uptime : start_time;
+    const char* node = std::getenv("NODE_NAME");
+    if (node != nullptr) {
+        appendLabel(node_label, "node", node);
+    }
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::start() {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        XPUM_LOG_ERROR("XPUM: invalid metrics address {}", address);
+        return false;
+    }
+    listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        XPUM_LOG_ERROR("XPUM: failed to create metrics socket: {}", strerror(errno));
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 16) < 0) {
+        XPUM_LOG_ERROR("XPUM: failed to listen at {}:{} for metrics: {}", address, port, strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+    stopping = false;
+    worker = std::thread(&MetricsExporter::serve, this);
+    XPUM_LOG_INFO("XPUM: metrics are served at http://{}:{}/metrics", address, port);
+    return true;
+}
+
+void MetricsExporter::stop() {
+    stopping = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+    }
+}
+
+void MetricsExporter::serve() {
+    pollfd pfd{};
+    pfd.fd = listen_fd;
+    pfd.events = POLLIN;
+    while (!stopping) {
+        // wake up now and then to notice stop()
+        int ret = poll(&pfd, 1, 500);
+        if (ret <= 0 || (pfd.revents & POLLIN) == 0) {
+            continue;
+        }
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        // a stalled client must not block the next scrape for long
+        timeval timeout{5, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        handleConnection(fd);
+        close(fd);
+    }
+}
+
+void MetricsExporter::handleConnection(int fd) {
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            return;
+        }
+        request.append(buf, n);
+    }
+    auto line_end = request.find("\r\n");
+    std::string line = request.substr(0, line_end);
+    auto method_end = line.find(' ');
+    auto path_end = line.find(' ', method_end + 1);
+    if (method_end == std::string::npos || path_end == std::string::npos) {
+        sendResponse(fd, "400 Bad Request", "text/plain", "");
+        return;
+    }
+    std::string method = line.substr(0, method_end);
+    std::string path = line.substr(method_end + 1, path_end - method_end - 1);
+    path = path.substr(0, path.find('?'));
+    if (method != "GET") {
+        sendResponse(fd, "405 Method Not Allowed", "text/plain", "");
+    } else if (path == "/metrics") {
+        // only the OpenMetrics format has the _created samples of the counters
+        if (request.find("application/openmetrics-text") != std::string::npos) {
+            sendResponse(fd, "200 OK", "application/openmetrics-text; version=1.0.0; charset=utf-8", renderMetrics(true));
+        } else {
+            sendResponse(fd, "200 OK", "text/plain; version=0.0.4; charset=utf-8", renderMetrics(false));
+        }
+    } else {
+        sendResponse(fd, "404 Not Found", "text/plain", "");
+    }
+}
+
+void MetricsExporter::refreshLabels(const std::vector<xpum_device_basic_info>& devices) {
+    std::map<xpum_device_id_t, DeviceLabels> labels;
+    for (auto& device : devices) {
+        auto iter = label_cache.find(device.deviceId);
+        if (iter != label_cache.end() && iter->second.uuid == device.uuid && iter->second.bdf == device.PCIBDFAddress) {
+            labels[device.deviceId] = std::move(iter->second);
+            continue;
+        }
+        DeviceLabels& entry = labels[device.deviceId];
+        entry.uuid = device.uuid;
+        entry.bdf = device.PCIBDFAddress;
+        appendLabel(entry.device, "uuid", device.uuid);
+        appendLabel(entry.device, "dev_name", device.deviceName);
+        appendLabel(entry.device, "pci_dev", device.PCIDeviceId);
+        appendLabel(entry.device, "vendor", device.VendorName);
+        appendLabel(entry.device, "pci_bdf", device.PCIBDFAddress);
+        std::string drm = device.drmDevice;
+        if (!drm.empty()) {
+            entry.dev_file = drm.substr(drm.rfind('/') + 1);
+            appendLabel(entry.device, "dev_file", entry.dev_file);
+        }
+        if (!node_label.empty()) {
+            entry.device += ',';
+            entry.device += node_label;
+        }
+    }
+    label_cache = std::move(labels);
+}
+
+const std::string& MetricsExporter::getTileLabels(DeviceLabels& labels, int32_t tileId) {
+    auto iter = labels.tiles.find(tileId);
+    if (iter != labels.tiles.end()) {
+        return iter->second;
+    }
+    std::string tile = labels.device;
+    appendLabel(tile, "sub_dev", std::to_string(tileId));
+    return labels.tiles.emplace(tileId, std::move(tile)).first->second;
+}
+
+const std::string& MetricsExporter::getEngineLabels(DeviceLabels& labels, const xpum_device_engine_metric_t& engine) {
+    int32_t tileId = engine.isTileData ? engine.tileId : -1;
+    auto key = std::make_tuple(tileId, static_cast<int>(engine.type), engine.index);
+    auto iter = labels.engines.find(key);
+    if (iter != labels.engines.end()) {
+        return iter->second;
+    }
+    std::string ret = tileId >= 0 ? getTileLabels(labels, tileId) : labels.device;
+    appendLabel(ret, "type", engineTypeName(engine.type));
+    appendLabel(ret, "engine_id", std::to_string(engine.index));
+    return labels.engines.emplace(key, std::move(ret)).first->second;
+}
+
+void MetricsExporter::appendCounter(std::string& body, int family, const std::string& labels, const char* ext_labels,
+                                    const char* src, double value, bool openmetrics) {
+    auto index = static_cast<MetricFamilyIndex>(family);
+    std::string series = metric_families[family].name;
+    series += '{';
+    series += labels;
+    series += ext_labels;
+    series += src;
+    CounterState state{value, countsSinceBoot(index) ? boot_time : start_time};
+    auto iter = counter_states.find(series);
+    if (iter != counter_states.end()) {
+        // a lower value means the driver or the device reset the counter, it starts over now
+        state.created = value < iter->second.last ? getEpochSeconds() : iter->second.created;
+    }
+    seen_counters[series] = state;
+    appendSample(body, index, labels, ext_labels, src, value);
+    if (openmetrics) {
+        appendSample(body, index, labels, ext_labels, src, state.created, "_created");
+    }
+}
+
+/*
+  The latencies are rendered as summaries. The devices are labeled like the
+  telemetry, calls not made for the monitoring of a device have no device
+  labels.
+*/
+void MetricsExporter::renderInternalStats(std::string& ret) {
+    uint32_t count = 0;
+    if (xpumGetInternalStats(nullptr, &count) != XPUM_OK || count == 0) {
+        return;
+    }
+    std::vector<xpum_internal_stats_t> stats(count);
+    if (xpumGetInternalStats(stats.data(), &count) != XPUM_OK) {
+        return;
+    }
+    for (auto& family : internal_stats_families) {
+        std::string body;
+        for (uint32_t i = 0; i < count; i++) {
+            auto& data = stats[i];
+            if (data.type != family.type) {
+                continue;
+            }
+            std::string labels;
+            auto device = label_cache.find(data.deviceId);
+            if (device != label_cache.end()) {
+                labels = device->second.device;
+            } else {
+                labels = node_label;
+            }
+            appendLabel(labels, family.label, data.name);
+            const std::pair<const char*, uint64_t> quantiles[] = {{"0.5", data.p50}, {"0.9", data.p90}, {"0.99", data.p99}};
+            char buf[32];
+            for (auto& quantile : quantiles) {
+                snprintf(buf, sizeof(buf), "%.15g", quantile.second / 1e9);
+                body += family.name;
+                body += '{' + labels + ",quantile=\"" + quantile.first + "\"} " + buf + '\n';
+            }
+            snprintf(buf, sizeof(buf), "%.15g", data.sum / 1e9);
+            body += family.name;
+            body += "_sum{" + labels + "} " + buf + '\n';
+            body += family.name;
+            body += "_count{" + labels + "} " + std::to_string(data.count) + '\n';
+        }
+        if (body.empty()) {
+            continue;
+        }
+        ret += std::string("# HELP ") + family.name + " " + family.help + "\n";
+        ret += std::string("# TYPE ") + family.name + " summary\n";
+        ret += body;
+    }
+
+    // the estimated memory of the telemetry caches, sum is the current bytes and max the peak
+    std::string bytes_body;
+    std::string peak_body;
+    for (uint32_t i = 0; i < count; i++) {
+        auto& data = stats[i];
+        if (data.type != XPUM_INTERNAL_STATS_MEMORY) {
+            continue;
+        }
+        std::string labels = node_label;
+        appendLabel(labels, "cache", data.name);
+        bytes_body += "xpum_internal_memory_bytes{" + labels + "} " + std::to_string(data.sum) + '\n';
+        peak_body += "xpum_internal_memory_peak_bytes{" + labels + "} " + std::to_string(data.max) + '\n';
+    }
+    if (!bytes_body.empty()) {
+        ret += "# HELP xpum_internal_memory_bytes Estimated memory held by a telemetry cache of XPUM (in bytes), per cache\n";
+        ret += "# TYPE xpum_internal_memory_bytes gauge\n";
+        ret += bytes_body;
+        ret += "# HELP xpum_internal_memory_peak_bytes Peak estimated memory held by a telemetry cache of XPUM (in bytes), per cache\n";
+        ret += "# TYPE xpum_internal_memory_peak_bytes gauge\n";
+        ret += peak_body;
+    }
+
+    // the events dropped for the subscribers of the event bus that are behind
+    std::string dropped_body;
+    for (uint32_t i = 0; i < count; i++) {
+        auto& data = stats[i];
+        if (data.type != XPUM_INTERNAL_STATS_EVENT_DELIVERY) {
+            continue;
+        }
+        std::string labels = node_label;
+        appendLabel(labels, "subscriber", data.name);
+        dropped_body += "xpum_internal_event_dropped_total{" + labels + "} " + std::to_string(data.errorCount) + '\n';
+    }
+    if (!dropped_body.empty()) {
+        ret += "# HELP xpum_internal_event_dropped_total Events dropped because the queue of the subscriber was full, per subscriber\n";
+        ret += "# TYPE xpum_internal_event_dropped_total counter\n";
+        ret += dropped_body;
+    }
+
+    // the sampling cut by the CPU budget governor, the time each cut was active and the times it was applied
+    std::string cut_seconds_body;
+    std::string cuts_body;
+    for (uint32_t i = 0; i < count; i++) {
+        auto& data = stats[i];
+        if (data.type != XPUM_INTERNAL_STATS_CPU_BUDGET_CUT) {
+            continue;
+        }
+        std::string labels = node_label;
+        appendLabel(labels, "cut", data.name);
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.15g", data.sum / 1e9);
+        cut_seconds_body += "xpum_internal_cpu_budget_cut_seconds_total{" + labels + "} " + buf + '\n';
+        cuts_body += "xpum_internal_cpu_budget_cuts_total{" + labels + "} " + std::to_string(data.errorCount) + '\n';
+    }
+    if (!cut_seconds_body.empty()) {
+        ret += "# HELP xpum_internal_cpu_budget_cut_seconds_total Time a cut of the sampling was active because xpumd was over its CPU budget (in seconds), per cut\n";
+        ret += "# TYPE xpum_internal_cpu_budget_cut_seconds_total counter\n";
+        ret += cut_seconds_body;
+        ret += "# HELP xpum_internal_cpu_budget_cuts_total Times a cut of the sampling was applied because xpumd was over its CPU budget, per cut\n";
+        ret += "# TYPE xpum_internal_cpu_budget_cuts_total counter\n";
+        ret += cuts_body;
+    }
+}
+
+/*
+  The counters the processes publish with xpum_app_counters.h, joined with
+  the energy and the engine busy time of each device they use.
+*/
+void MetricsExporter::renderAppCounters(std::string& ret, const std::vector<xpum_device_basic_info>& devices, bool openmetrics) {
+    struct AppFamily {
+        const char* name;
+        const char* help;
+        const char* type;
+        double xpum_app_counter_efficiency_t::*value;
+    };
+    const AppFamily families[] = {
+        {"xpum_app_work_rate", "Work of an application counter per second on the GPU, per process and counter", "gauge", &xpum_app_counter_efficiency_t::rate},
+        {"xpum_app_work_per_joule", "Work of an application counter per joule attributed to the process on the GPU, per process and counter", "gauge", &xpum_app_counter_efficiency_t::workPerJoule},
+        {"xpum_app_work_per_utilization", "Work of an application counter per second per % of engine busy time of the process on the GPU, per process and counter", "gauge", &xpum_app_counter_efficiency_t::workPerUtilization},
+        {"xpum_app_work_total", "Work of an application counter on the GPU since it was first seen, per process and counter", "counter", &xpum_app_counter_efficiency_t::work},
+        {"xpum_app_energy_joules_total", "Energy attributed to the process on the GPU since the counter was first seen (in Joules), per process and counter", "counter", &xpum_app_counter_efficiency_t::energy},
+    };
+    const size_t family_count = sizeof(families) / sizeof(families[0]);
+    std::vector<std::string> bodies(family_count);
+    std::vector<xpum_app_counter_efficiency_t> efficiencies;
+    for (auto& device : devices) {
+        uint32_t count = 0;
+        if (xpumGetAppCounterEfficiency(device.deviceId, nullptr, &count) != XPUM_OK || count == 0) {
+            continue;
+        }
+        efficiencies.resize(count);
+        if (xpumGetAppCounterEfficiency(device.deviceId, efficiencies.data(), &count) != XPUM_OK) {
+            continue;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            auto& data = efficiencies[i];
+            std::string labels = label_cache[device.deviceId].device;
+            appendLabel(labels, "pid", std::to_string(data.processId));
+            appendLabel(labels, "process", data.processName);
+            appendLabel(labels, "counter", data.counterName);
+            appendLabel(labels, "unit", data.unit);
+            char buf[32];
+            for (size_t j = 0; j < family_count; j++) {
+                snprintf(buf, sizeof(buf), "%.15g", data.*families[j].value);
+                bodies[j] += families[j].name;
+                bodies[j] += '{' + labels + "} " + buf + '\n';
+            }
+        }
+    }
+    for (size_t j = 0; j < family_count; j++) {
+        if (bodies[j].empty()) {
+            continue;
+        }
+        std::string name = families[j].name;
+        // OpenMetrics names the family without the suffix of its samples
+        if (openmetrics && std::string(families[j].type) == "counter") {
+            name.erase(name.size() - strlen("_total"));
+        }
+        ret += "# HELP " + name + " " + families[j].help + "\n";
+        ret += "# TYPE " + name + " " + families[j].type + "\n";
+        ret += bodies[j];
+    }
+}
+
+void MetricsExporter::renderFabric(std::vector<std::string>& bodies, const DeviceLabels& labels, xpum_device_id_t deviceId, bool openmetrics) {
+    uint32_t count = 0;
+    uint64_t begin, end;
+    if (xpumGetFabricThroughputStats(deviceId, nullptr, &count, &begin, &end, FABRIC_STATS_SESSION) != XPUM_OK || count == 0) {
+        return;
+    }
+    std::vector<xpum_device_fabric_throughput_stats_t> fabrics(count);
+    if (xpumGetFabricThroughputStats(deviceId, fabrics.data(), &count, &begin, &end, FABRIC_STATS_SESSION) != XPUM_OK) {
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        auto& stats = fabrics[i];
+        if (stats.type != XPUM_FABRIC_THROUGHPUT_TYPE_TRANSMITTED_COUNTER) {
+            continue;
+        }
+        auto remote = label_cache.find(stats.remote_device_id);
+        if (remote == label_cache.end()) {
+            continue;
+        }
+        std::string ext;
+        appendLabel(ext, "sub_dev", std::to_string(stats.tile_id));
+        appendLabel(ext, "dst_dev_file", remote->second.dev_file);
+        appendLabel(ext, "dst_pci_bdf", remote->second.bdf);
+        appendLabel(ext, "dst_sub_dev", std::to_string(stats.remote_device_tile_id));
+        ext += ',';
+        double value = stats.accumulated;
+        if (stats.scale > 1) {
+            value /= stats.scale;
+        }
+        appendCounter(bodies[FABRIC_TX_BYTES], FABRIC_TX_BYTES, labels.device, ext.c_str(), "direct", value, openmetrics);
+    }
+}
+
+std::string MetricsExporter::renderMetrics(bool openmetrics) {
+    int device_count = XPUM_MAX_NUM_DEVICES;
+    xpum_device_basic_info device_list[XPUM_MAX_NUM_DEVICES];
+    if (xpumGetDeviceList(device_list, &device_count) != XPUM_OK) {
+        device_count = 0;
+    }
+    std::vector<xpum_device_basic_info> devices(device_list, device_list + device_count);
+    refreshLabels(devices);
+
+    std::vector<std::string> bodies(METRIC_FAMILY_COUNT);
+    std::vector<xpum_device_metrics_t> metrics;
+    std::vector<xpum_device_engine_metric_t> engines;
+    auto emit = [&](const StatsMetric& metric, const std::string& labels, const char* src, double value) {
+        if (metric_families[metric.family].counter) {
+            appendCounter(bodies[metric.family], metric.family, labels, metric.ext_labels, src, value, openmetrics);
+        } else {
+            appendSample(bodies[metric.family], metric.family, labels, metric.ext_labels, src, value);
+        }
+    };
+    for (auto& device : devices) {
+        auto& labels = label_cache[device.deviceId];
+
+        int count = 0;
+        if (xpumGetMetrics(device.deviceId, nullptr, &count) != XPUM_OK || count <= 0) {
+            continue;
+        }
+        metrics.resize(count);
+        if (xpumGetMetrics(device.deviceId, metrics.data(), &count) != XPUM_OK) {
+            continue;
+        }
+
+        // tile values of the metrics the device level lacks, aggregated below
+        std::map<xpum_stats_type_t, std::vector<double>> tile_values;
+        std::map<xpum_stats_type_t, bool> on_device;
+        for (int i = 0; i < count; i++) {
+            auto& entry = metrics[i];
+            for (int j = 0; j < entry.count; j++) {
+                auto& data = entry.dataList[j];
+                auto iter = stats_metrics.find(data.metricsType);
+                if (iter == stats_metrics.end() || data.value == std::numeric_limits<uint64_t>::max()) {
+                    continue;
+                }
+                auto& metric = iter->second;
+                double value = toValue(data, metric);
+                if (entry.isTileData) {
+                    emit(metric, getTileLabels(labels, entry.tileId), "direct", value);
+                    if (metric.aggregation != TileAggregation::NONE) {
+                        tile_values[data.metricsType].push_back(value);
+                    }
+                } else {
+                    emit(metric, labels.device, "direct", value);
+                    on_device[data.metricsType] = true;
+                }
+            }
+        }
+        for (auto& tile_value : tile_values) {
+            if (on_device[tile_value.first]) {
+                continue;
+            }
+            auto& metric = stats_metrics.at(tile_value.first);
+            double sum = 0;
+            for (double value : tile_value.second) {
+                sum += value;
+            }
+            if (metric.aggregation == TileAggregation::SUM) {
+                emit(metric, labels.device, "sum", sum);
+            } else {
+                emit(metric, labels.device, "avg", sum / tile_value.second.size());
+            }
+        }
+
+        renderFabric(bodies, labels, device.deviceId, openmetrics);
+
+        uint32_t engine_count = 0;
+        if (xpumGetEngineUtilizations(device.deviceId, nullptr, &engine_count) != XPUM_OK || engine_count == 0) {
+            continue;
+        }
+        engines.resize(engine_count);
+        if (xpumGetEngineUtilizations(device.deviceId, engines.data(), &engine_count) != XPUM_OK) {
+            continue;
+        }
+        for (uint32_t i = 0; i < engine_count; i++) {
+            auto& engine = engines[i];
+            if (engine.value == std::numeric_limits<uint64_t>::max()) {
+                continue;
+            }
+            double value = engine.value;
+            if (engine.scale > 1) {
+                value /= engine.scale;
+            }
+            appendSample(bodies[PER_ENGINE_RATIO], PER_ENGINE_RATIO, getEngineLabels(labels, engine), "", "direct", value * 0.01);
+        }
+    }
+
+    std::string ret;
+    for (int i = 0; i < METRIC_FAMILY_COUNT; i++) {
+        if (bodies[i].empty()) {
+            continue;
+        }
+        auto& family = metric_families[i];
+        std::string name = family.name;
+        // OpenMetrics names the family without the suffix of its samples
+        if (family.counter && !openmetrics) {
+            name += "_total";
+        }
+        ret += "# HELP " + name + " " + family.help + "\n";
+        ret += "# TYPE " + name + (family.counter ? " counter\n" : " gauge\n");
+        ret += bodies[i];
+    }
+    renderAppCounters(ret, devices, openmetrics);
+    renderInternalStats(ret);
+    if (openmetrics) {
+        ret += "# EOF\n";
+    }
+    // series not rendered this time are forgotten
+    counter_states = std::move(seen_counters);
+    seen_counters.clear();
+    return ret;
+}
+
+} // end namespace xpum::daemon
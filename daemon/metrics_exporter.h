@@ -0,0 +1,110 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file metrics_exporter.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "xpum_structs.h"
+
+namespace xpum::daemon {
+
+/*
+  MetricsExporter serves the latest telemetry of all devices at /metrics in
+  the Prometheus text format, with the metric names and labels of the Python
+  exporter in rest/prometheus_exporter. The values are read from the snapshot
+  the monitor keeps in DataLogic, so a scrape does not trigger any sampling.
+  The device and tile label sets are rendered once and reused until the
+  device list changes.
+
+  Counters carry the raw values of Level Zero, so they keep counting across
+  exporter restarts. Each counter series remembers when it was created: boot
+  time for the hardware counters, daemon start for the RAS counts, and the
+  time the value went down when the driver or the device reset it. The
+  creation time is sent as a _created sample when the scraper asks for the
+  OpenMetrics format.
+*/
+
+class MetricsExporter {
+   public:
+    MetricsExporter(const std::string& address, int port);
+
+    ~MetricsExporter();
+
+    bool start();
+
+    void stop();
+
+   private:
+    struct DeviceLabels {
+        std::string uuid;
+        std::string bdf;
+        std::string dev_file;
+        // labels of the device, without the trailing comma
+        std::string device;
+        std::map<int32_t, std::string> tiles;
+        // the per engine labels, keyed by tile id (-1 for the device), engine type and index
+        std::map<std::tuple<int32_t, int, uint64_t>, std::string> engines;
+    };
+
+    void serve();
+
+    void handleConnection(int fd);
+
+    struct CounterState {
+        double last;
+        double created;
+    };
+
+    std::string renderMetrics(bool openmetrics);
+
+    void renderFabric(std::vector<std::string>& bodies, const DeviceLabels& labels, xpum_device_id_t deviceId, bool openmetrics);
+
+    void renderInternalStats(std::string& ret);
+
+    void renderAppCounters(std::string& ret, const std::vector<xpum_device_basic_info>& devices, bool openmetrics);
+
+    void appendCounter(std::string& body, int family, const std::string& labels, const char* ext_labels,
+                       const char* src, double value, bool openmetrics);
+
+    void refreshLabels(const std::vector<xpum_device_basic_info>& devices);
+
+    const std::string& getTileLabels(DeviceLabels& labels, int32_t tileId);
+
+    const std::string& getEngineLabels(DeviceLabels& labels, const xpum_device_engine_metric_t& engine);
+
+   private:
+    std::string address;
+
+    int port;
+
+    int listen_fd;
+
+    std::atomic<bool> stopping;
+
+    std::thread worker;
+
+    std::string node_label;
+
+    // only used by the worker thread, scrapes are served one at a time
+    std::map<xpum_device_id_t, DeviceLabels> label_cache;
+
+    // keyed by the rendered series, only used by the worker thread
+    std::map<std::string, CounterState> counter_states;
+
+    std::map<std::string, CounterState> seen_counters;
+
+    double boot_time;
+
+    double start_time;
+};
+
+} // end namespace xpum::daemon
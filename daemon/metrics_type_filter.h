@@ -0,0 +1,61 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file metrics_type_filter.h
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "xpum_structs.h"
+
+namespace xpum::daemon {
+
+// the metrics the REST API shows, for the statistics requests with enableFilter and the REST gateway
+inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
+    std::vector<xpum_stats_type_t> allowList{
+        XPUM_STATS_GPU_UTILIZATION,
+        XPUM_STATS_EU_ACTIVE,
+        XPUM_STATS_EU_STALL,
+        XPUM_STATS_EU_IDLE,
+        XPUM_STATS_POWER,
+        XPUM_STATS_ENERGY,
+        XPUM_STATS_GPU_FREQUENCY,
+        XPUM_STATS_GPU_CORE_TEMPERATURE,
+        XPUM_STATS_MEMORY_USED,
+        XPUM_STATS_MEMORY_UTILIZATION,
+        XPUM_STATS_MEMORY_BANDWIDTH,
+        // XPUM_STATS_MEMORY_READ,
+        // XPUM_STATS_MEMORY_WRITE,
+        XPUM_STATS_MEMORY_READ_THROUGHPUT,
+        XPUM_STATS_MEMORY_WRITE_THROUGHPUT,
+        XPUM_STATS_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION,
+        XPUM_STATS_ENGINE_GROUP_MEDIA_ALL_UTILIZATION,
+        XPUM_STATS_ENGINE_GROUP_COPY_ALL_UTILIZATION,
+        XPUM_STATS_ENGINE_GROUP_RENDER_ALL_UTILIZATION,
+        XPUM_STATS_ENGINE_GROUP_3D_ALL_UTILIZATION,
+        XPUM_STATS_RAS_ERROR_CAT_RESET,
+        XPUM_STATS_RAS_ERROR_CAT_PROGRAMMING_ERRORS,
+        XPUM_STATS_RAS_ERROR_CAT_DRIVER_ERRORS,
+        XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE,
+        XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE,
+        // XPUM_STATS_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE,
+        // XPUM_STATS_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE,
+        XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE,
+        XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE,
+        // XPUM_STATS_GPU_REQUEST_FREQUENCY,
+        XPUM_STATS_MEMORY_TEMPERATURE,
+        XPUM_STATS_FREQUENCY_THROTTLE,
+        XPUM_STATS_PCIE_READ_THROUGHPUT,
+        XPUM_STATS_PCIE_WRITE_THROUGHPUT,
+        XPUM_STATS_PCIE_READ,
+        XPUM_STATS_PCIE_WRITE,
+        XPUM_STATS_ENGINE_UTILIZATION,
+        XPUM_STATS_MEDIA_ENGINE_FREQUENCY,
+    };
+    return std::find(allowList.begin(), allowList.end(), metricsType) != allowList.end();
+}
+
+} // end namespace xpum::daemon
@@ -0,0 +1,308 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file power_cap_controller.cpp
+ */
+
+#include "power_cap_controller.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "internal_api.h"
+#include "logger.h"
+#include "xpum_api.h"
+
+namespace xpum::daemon {
+
+namespace {
+
+// the share of the error added to the integral per second
+const double integral_gain = 0.5;
+
+// a device is held at its limit when it draws this share of it
+const double limited_ratio = 0.95;
+
+// the share of the integral kept per interval when no device is held at its limit
+const double integral_decay = 0.9;
+
+} // namespace
+
+PowerCapController::PowerCapController(uint32_t budget, xpum_group_id_t groupId, uint32_t interval, Policy policy)
+    : budget((int64_t)budget * 1000), group_id(groupId), interval(interval), policy(policy), integral(0), stopping(false) {
+}
+
+PowerCapController::~PowerCapController() {
+    stop();
+}
+
+bool PowerCapController::toPolicy(const std::string& name, Policy& policy) {
+    if (name == "equal") {
+        policy = Policy::EQUAL;
+    } else if (name == "demand") {
+        policy = Policy::DEMAND;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool PowerCapController::start() {
+    if (budget <= 0 || interval == 0) {
+        XPUM_LOG_ERROR("XPUM: invalid power budget {} W or interval {} ms", budget / 1000, interval);
+        return false;
+    }
+    stopping = false;
+    worker = std::thread(&PowerCapController::run, this);
+    if (group_id != 0) {
+        XPUM_LOG_INFO("XPUM: power of group {} is capped to {} W every {} ms", group_id, budget / 1000, interval);
+    } else {
+        XPUM_LOG_INFO("XPUM: power of all devices is capped to {} W every {} ms", budget / 1000, interval);
+    }
+    return true;
+}
+
+void PowerCapController::stop() {
+    stopping = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void PowerCapController::run() {
+    // the longest sleep before checking if the controller stops
+    const uint32_t pollTimeout = 100;
+    double dt = interval / 1000.0;
+    auto next = std::chrono::steady_clock::now();
+    std::vector<xpum_device_id_t> devices;
+    while (!stopping) {
+        next += std::chrono::milliseconds(interval);
+        auto now = std::chrono::steady_clock::now();
+        if (next < now) {
+            // a late loop is not made up with a burst of steps
+            next = now;
+        }
+        while (!stopping && std::chrono::steady_clock::now() < next) {
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(next - std::chrono::steady_clock::now(), std::chrono::milliseconds(pollTimeout)));
+        }
+        if (stopping) {
+            break;
+        }
+        if (!getDevices(devices)) {
+            continue;
+        }
+
+        // the devices that left the group get their limits back
+        for (auto it = states.begin(); it != states.end();) {
+            if (std::find(devices.begin(), devices.end(), it->first) == devices.end()) {
+                auto& state = it->second;
+                if (state.applied >= 0 && state.original.power > 0) {
+                    xpumSetDevicePowerSustainedLimits(it->first, -1, state.original);
+                }
+                it = states.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        int64_t total = 0;
+        int64_t minTotal = 0;
+        int64_t maxTotal = 0;
+        bool limited = false;
+        for (auto deviceId : devices) {
+            auto it = states.find(deviceId);
+            if (it == states.end()) {
+                it = states.emplace(deviceId, DeviceState()).first;
+                initDevice(deviceId, it->second);
+            }
+            auto& state = it->second;
+            if (!state.controllable) {
+                continue;
+            }
+            measure(deviceId, state);
+            int64_t limit = state.applied > 0 ? state.applied : state.max_limit;
+            // a device without a power reading is counted at its limit
+            int64_t power = state.power >= 0 ? state.power : limit;
+            total += power;
+            minTotal += state.min_limit;
+            maxTotal += state.max_limit;
+            if (power >= limit * limited_ratio) {
+                limited = true;
+            }
+        }
+        if (maxTotal == 0) {
+            continue;
+        }
+
+        // the integral grows only while the limits bind, otherwise it decays
+        double error = (double)(budget - total);
+        if (error < 0 || limited) {
+            integral += integral_gain * error * dt;
+        } else {
+            integral *= integral_decay;
+        }
+        integral = std::max(-budget / 2.0, std::min(budget / 2.0, integral));
+        double target = budget + integral;
+        // back-calculation, the integral is not kept beyond what the limits can follow
+        double clamped = std::max((double)minTotal, std::min((double)maxTotal, target));
+        integral += clamped - target;
+
+        distribute((int64_t)clamped);
+        for (auto deviceId : devices) {
+            auto& state = states[deviceId];
+            if (state.controllable) {
+                apply(deviceId, state);
+            }
+        }
+    }
+    restore();
+}
+
+bool PowerCapController::getDevices(std::vector<xpum_device_id_t>& devices) {
+    devices.clear();
+    if (group_id != 0) {
+        xpum_group_info_t groupInfo;
+        if (xpumGroupGetInfo(group_id, &groupInfo) != XPUM_OK) {
+            return false;
+        }
+        devices.assign(groupInfo.deviceList, groupInfo.deviceList + groupInfo.count);
+        return true;
+    }
+    int count = XPUM_MAX_NUM_DEVICES;
+    xpum_device_basic_info deviceList[XPUM_MAX_NUM_DEVICES];
+    if (xpumGetDeviceList(deviceList, &count) != XPUM_OK) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        devices.push_back(deviceList[i].deviceId);
+    }
+    return true;
+}
+
+void PowerCapController::initDevice(xpum_device_id_t deviceId, DeviceState& state) {
+    xpum_power_prop_data_t props[32];
+    uint32_t count = 32;
+    if (xpumGetDevicePowerProps(deviceId, props, &count) != XPUM_OK) {
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (props[i].on_subdevice || !props[i].can_control) {
+            continue;
+        }
+        state.max_limit = props[i].max_limit > 0 ? props[i].max_limit : props[i].default_limit;
+        // a device without a min limit is not capped below a quarter of its max
+        state.min_limit = props[i].min_limit > 0 ? props[i].min_limit : state.max_limit / 4;
+        state.controllable = state.max_limit > 0 && state.min_limit <= state.max_limit;
+        break;
+    }
+    xpum_power_limits_t limits;
+    if (state.controllable && xpumGetDevicePowerLimits(deviceId, -1, &limits) == XPUM_OK) {
+        state.original = limits.sustained_limit;
+    }
+    if (!state.controllable) {
+        XPUM_LOG_WARN("XPUM: power limit of device {} can not be controlled, it is not capped", deviceId);
+    }
+}
+
+void PowerCapController::measure(xpum_device_id_t deviceId, DeviceState& state) {
+    state.power = -1;
+    int count = 0;
+    if (xpumGetMetrics(deviceId, nullptr, &count) != XPUM_OK || count <= 0) {
+        return;
+    }
+    std::vector<xpum_device_metrics_t> metrics(count);
+    if (xpumGetMetrics(deviceId, metrics.data(), &count) != XPUM_OK) {
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        if (metrics[i].isTileData) {
+            continue;
+        }
+        for (int j = 0; j < metrics[i].count; j++) {
+            auto& data = metrics[i].dataList[j];
+            double value = data.scale > 1 ? (double)data.value / data.scale : (double)data.value;
+            if (data.metricsType == XPUM_STATS_POWER) {
+                state.power = (int64_t)(value * 1000);
+            } else if (data.metricsType == XPUM_STATS_GPU_UTILIZATION) {
+                state.utilization = value;
+            }
+        }
+    }
+}
+
+void PowerCapController::distribute(int64_t total) {
+    // water filling: the share above the min limits is split by weight, and
+    // the part beyond the max limit of a device goes to the other devices
+    std::vector<DeviceState*> open;
+    double remaining = (double)total;
+    for (auto& item : states) {
+        auto& state = item.second;
+        if (!state.controllable) {
+            continue;
+        }
+        state.share = state.min_limit;
+        remaining -= state.min_limit;
+        if (state.min_limit < state.max_limit) {
+            open.push_back(&state);
+        }
+    }
+    while (remaining >= 1 && !open.empty()) {
+        double weightTotal = 0;
+        for (auto state : open) {
+            // an idle device keeps a little share to ramp up
+            weightTotal += policy == Policy::DEMAND ? state->utilization + 1 : 1;
+        }
+        double given = 0;
+        std::vector<DeviceState*> stillOpen;
+        for (auto state : open) {
+            double weight = policy == Policy::DEMAND ? state->utilization + 1 : 1;
+            double add = remaining * weight / weightTotal;
+            if (state->share + add >= state->max_limit) {
+                given += state->max_limit - state->share;
+                state->share = state->max_limit;
+            } else {
+                given += add;
+                state->share += (int64_t)add;
+                stillOpen.push_back(state);
+            }
+        }
+        remaining -= given;
+        if (stillOpen.size() == open.size()) {
+            break;
+        }
+        open.swap(stillOpen);
+    }
+}
+
+void PowerCapController::apply(xpum_device_id_t deviceId, DeviceState& state) {
+    // the limits are set in whole watts
+    int64_t limit = std::max(state.min_limit, state.share / 1000 * 1000);
+    if (state.applied >= 0 && std::abs(limit - state.applied) < hysteresis) {
+        return;
+    }
+    xpum_power_sustained_limit_t sustained;
+    sustained.enabled = true;
+    sustained.power = (int32_t)limit;
+    sustained.interval = state.original.interval;
+    if (xpumSetDevicePowerSustainedLimits(deviceId, -1, sustained) == XPUM_OK) {
+        state.applied = limit;
+        state.warned = false;
+    } else if (!state.warned) {
+        XPUM_LOG_WARN("XPUM: failed to set power limit {} mW of device {}", limit, deviceId);
+        state.warned = true;
+    }
+}
+
+void PowerCapController::restore() {
+    for (auto& item : states) {
+        auto& state = item.second;
+        if (state.applied >= 0 && state.original.power > 0) {
+            xpumSetDevicePowerSustainedLimits(item.first, -1, state.original);
+        }
+    }
+    states.clear();
+    integral = 0;
+}
+
+} // end namespace xpum::daemon
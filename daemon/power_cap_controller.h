@@ -0,0 +1,106 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file power_cap_controller.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "xpum_structs.h"
+
+namespace xpum::daemon {
+
+/*
+  PowerCapController keeps the power of the GPUs of the node, or of one
+  group, under a budget by setting the sustained power limit of each device
+  every control interval.
+
+  The sum of the device limits follows the budget with an integral term on
+  the measured power, so devices that draw less than their limit let the
+  others go higher. The integral only grows while a device is held at its
+  limit and is clamped to half the budget, so a long idle period does not
+  wind it up and overshoot the budget when the load comes back.
+
+  The sum is shared between the devices by the fairness policy: "equal"
+  gives every device the same share above its minimum limit, "demand" gives
+  the shares by the GPU utilization. A share beyond the max limit of a
+  device goes to the others. The limits set before the controller started
+  are restored when it stops.
+*/
+
+class PowerCapController {
+   public:
+    enum class Policy {
+        EQUAL,
+        DEMAND,
+    };
+
+    // budget in watts, the devices of the group or all devices if groupId is 0, interval in ms
+    PowerCapController(uint32_t budget, xpum_group_id_t groupId, uint32_t interval, Policy policy);
+
+    ~PowerCapController();
+
+    bool start();
+
+    void stop();
+
+    static bool toPolicy(const std::string& name, Policy& policy);
+
+   private:
+    struct DeviceState {
+        // the limits in mW
+        int64_t min_limit = 0;
+        int64_t max_limit = 0;
+        xpum_power_sustained_limit_t original{};
+        int64_t applied = -1;
+        bool controllable = false;
+        bool warned = false;
+        // the latest measurement, power in mW and utilization in percent
+        int64_t power = -1;
+        double utilization = 0;
+        int64_t share = 0;
+    };
+
+    void run();
+
+    bool getDevices(std::vector<xpum_device_id_t>& devices);
+
+    void initDevice(xpum_device_id_t deviceId, DeviceState& state);
+
+    void measure(xpum_device_id_t deviceId, DeviceState& state);
+
+    // split total mW between the devices by the policy into their share
+    void distribute(int64_t total);
+
+    void apply(xpum_device_id_t deviceId, DeviceState& state);
+
+    void restore();
+
+    // the smallest change of a limit that is applied, in mW
+    static const int64_t hysteresis = 1000;
+
+    int64_t budget;
+
+    xpum_group_id_t group_id;
+
+    uint32_t interval;
+
+    Policy policy;
+
+    double integral;
+
+    std::map<xpum_device_id_t, DeviceState> states;
+
+    std::atomic<bool> stopping;
+
+    std::thread worker;
+};
+
+} // end namespace xpum::daemon
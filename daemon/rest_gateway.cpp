@@ -0,0 +1,802 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file rest_gateway.cpp
+ */
+
+#include "rest_gateway.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "internal_api.h"
+#include "logger.h"
+#include "metrics_type_filter.h"
+#include "xpum_api.h"
+
+namespace xpum::daemon {
+
+namespace {
+
+// the requests of a connection are at most this long with their headers
+const size_t MAX_REQUEST_SIZE = 16384;
+
+// keep in sync with XpumStatsType in rest/stub/xpum_enums.py
+const char* stats_type_names[] = {
+    "XPUM_STATS_GPU_UTILIZATION",
+    "XPUM_STATS_EU_ACTIVE",
+    "XPUM_STATS_EU_STALL",
+    "XPUM_STATS_EU_IDLE",
+    "XPUM_STATS_POWER",
+    "XPUM_STATS_ENERGY",
+    "XPUM_STATS_GPU_FREQUENCY",
+    "XPUM_STATS_GPU_CORE_TEMPERATURE",
+    "XPUM_STATS_MEMORY_USED",
+    "XPUM_STATS_MEMORY_UTILIZATION",
+    "XPUM_STATS_MEMORY_BANDWIDTH",
+    "XPUM_STATS_MEMORY_READ",
+    "XPUM_STATS_MEMORY_WRITE",
+    "XPUM_STATS_MEMORY_READ_THROUGHPUT",
+    "XPUM_STATS_MEMORY_WRITE_THROUGHPUT",
+    "XPUM_STATS_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION",
+    "XPUM_STATS_ENGINE_GROUP_MEDIA_ALL_UTILIZATION",
+    "XPUM_STATS_ENGINE_GROUP_COPY_ALL_UTILIZATION",
+    "XPUM_STATS_ENGINE_GROUP_RENDER_ALL_UTILIZATION",
+    "XPUM_STATS_ENGINE_GROUP_3D_ALL_UTILIZATION",
+    "XPUM_STATS_RAS_ERROR_CAT_RESET",
+    "XPUM_STATS_RAS_ERROR_CAT_PROGRAMMING_ERRORS",
+    "XPUM_STATS_RAS_ERROR_CAT_DRIVER_ERRORS",
+    "XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE",
+    "XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE",
+    "XPUM_STATS_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE",
+    "XPUM_STATS_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE",
+    "XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE",
+    "XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE",
+    "XPUM_STATS_GPU_REQUEST_FREQUENCY",
+    "XPUM_STATS_MEMORY_TEMPERATURE",
+    "XPUM_STATS_FREQUENCY_THROTTLE",
+    "XPUM_STATS_PCIE_READ_THROUGHPUT",
+    "XPUM_STATS_PCIE_WRITE_THROUGHPUT",
+    "XPUM_STATS_PCIE_READ",
+    "XPUM_STATS_PCIE_WRITE",
+    "XPUM_STATS_ENGINE_UTILIZATION",
+    "XPUM_STATS_FABRIC_THROUGHPUT",
+    "XPUM_STATS_FREQUENCY_THROTTLE_REASON_GPU",
+    "XPUM_STATS_MEDIA_ENGINE_FREQUENCY",
+};
+
+static_assert(sizeof(stats_type_names) / sizeof(stats_type_names[0]) == XPUM_STATS_MAX, "a name for each xpum_stats_type_t");
+
+// the health types by index, with the name in the path and the key in the body as rest/stub/health.py
+struct HealthType {
+    const char* path;
+    const char* key;
+    // the thresholds of the temperatures and the power are in the body
+    bool throttle;
+    bool shutdown;
+};
+
+const HealthType health_types[] = {
+    {"coreTemperature", "core_temperature", true, true},
+    {"memoryTemperature", "memory_temperature", true, true},
+    {"power", "power", true, false},
+    {"memory", "memory", false, false},
+    {"xeLinkPort", "xe_link_port", false, false},
+    {"frequency", "frequency", false, false},
+};
+
+const int HEALTH_TYPE_COUNT = sizeof(health_types) / sizeof(health_types[0]);
+
+// all the health types
+const int HEALTH_ALL = -1;
+
+const char* healthStatusName(xpum_health_status_t status) {
+    switch (status) {
+        case XPUM_HEALTH_STATUS_OK:
+            return "OK";
+        case XPUM_HEALTH_STATUS_WARNING:
+            return "Warning";
+        case XPUM_HEALTH_STATUS_CRITICAL:
+            return "Critical";
+        default:
+            return "Unknown";
+    }
+}
+
+// the keys of engine_util in rest/stub/statistics.py
+const char* engineUtilKey(xpum_engine_type_t type) {
+    switch (type) {
+        case XPUM_ENGINE_TYPE_COMPUTE:
+            return "compute";
+        case XPUM_ENGINE_TYPE_RENDER:
+            return "render";
+        case XPUM_ENGINE_TYPE_DECODE:
+            return "decoder";
+        case XPUM_ENGINE_TYPE_ENCODE:
+            return "encoder";
+        case XPUM_ENGINE_TYPE_COPY:
+            return "copy";
+        case XPUM_ENGINE_TYPE_MEDIA_ENHANCEMENT:
+            return "media_enhancement";
+        case XPUM_ENGINE_TYPE_3D:
+            return "3d";
+        default:
+            return nullptr;
+    }
+}
+
+const xpum_engine_type_t engine_util_types[] = {
+    XPUM_ENGINE_TYPE_COMPUTE,
+    XPUM_ENGINE_TYPE_RENDER,
+    XPUM_ENGINE_TYPE_DECODE,
+    XPUM_ENGINE_TYPE_ENCODE,
+    XPUM_ENGINE_TYPE_COPY,
+    XPUM_ENGINE_TYPE_MEDIA_ENHANCEMENT,
+    XPUM_ENGINE_TYPE_3D,
+};
+
+const char* statusText(int status) {
+    switch (status) {
+        case 200:
+            return "200 OK";
+        case 400:
+            return "400 Bad Request";
+        case 404:
+            return "404 Not Found";
+        case 405:
+            return "405 Method Not Allowed";
+        default:
+            return "500 Internal Server Error";
+    }
+}
+
+void appendString(std::string& body, const char* value) {
+    body += '"';
+    for (const char* c = value; *c != '\0'; c++) {
+        switch (*c) {
+            case '"':
+                body += "\\\"";
+                break;
+            case '\\':
+                body += "\\\\";
+                break;
+            case '\n':
+                body += "\\n";
+                break;
+            case '\r':
+                body += "\\r";
+                break;
+            case '\t':
+                body += "\\t";
+                break;
+            default:
+                if ((unsigned char)*c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", *c);
+                    body += buf;
+                } else {
+                    body += *c;
+                }
+                break;
+        }
+    }
+    body += '"';
+}
+
+void appendKey(std::string& body, const char* key) {
+    if (body.back() != '{') {
+        body += ", ";
+    }
+    appendString(body, key);
+    body += ": ";
+}
+
+void appendUint(std::string& body, const char* key, uint64_t value) {
+    appendKey(body, key);
+    body += std::to_string(value);
+}
+
+// a scaled value is divided into a float, as the values of the Python server
+void appendScaled(std::string& body, const char* key, uint64_t value, uint32_t scale) {
+    appendKey(body, key);
+    if (scale <= 1) {
+        body += std::to_string(value);
+        return;
+    }
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.15g", (double)value / scale);
+    body += buf;
+    // keep it a float to JSON readers, like Python prints 100.0
+    if (strpbrk(buf, ".en") == nullptr) {
+        body += ".0";
+    }
+}
+
+// "2022-02-23T05:21:08.000Z" as the Python server formats the timestamps in ms
+void appendTime(std::string& body, const char* key, uint64_t ms) {
+    time_t seconds = (time_t)(ms / 1000);
+    struct tm tm {};
+    gmtime_r(&seconds, &tm);
+    char buf[40];
+    size_t n = strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+    snprintf(buf + n, sizeof(buf) - n, ".%03uZ", (unsigned)(ms % 1000));
+    appendKey(body, key);
+    appendString(body, buf);
+}
+
+std::string errorBody(const char* key, const std::string& message) {
+    std::string body = "{";
+    appendKey(body, key);
+    appendString(body, message.c_str());
+    body += '}';
+    return body;
+}
+
+// the body of the Python server for the errors of health and topology
+std::string statusBody(int status, const std::string& message) {
+    std::string body = "{";
+    appendUint(body, "Status", status);
+    appendKey(body, "Message");
+    appendString(body, message.c_str());
+    body += '}';
+    return body;
+}
+
+// "/rest/v1/devices/<id>/<rest>", false for the other paths
+bool parseDevicePath(const std::string& path, xpum_device_id_t& deviceId, std::string& rest) {
+    static const std::string prefix = "/rest/v1/devices/";
+    if (path.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    size_t begin = prefix.size();
+    size_t end = path.find('/', begin);
+    if (end == std::string::npos || end == begin || end - begin > 9) {
+        return false;
+    }
+    for (size_t i = begin; i < end; i++) {
+        if (path[i] < '0' || path[i] > '9') {
+            return false;
+        }
+    }
+    deviceId = (xpum_device_id_t)std::stoul(path.substr(begin, end - begin));
+    rest = path.substr(end + 1);
+    return true;
+}
+
+bool hasToken(const std::string& headers, const char* name, const char* token) {
+    // the header names are not case sensitive, the values of Connection neither
+    std::string lower(headers);
+    for (char& c : lower) {
+        c = (char)tolower((unsigned char)c);
+    }
+    std::string key = std::string("\r\n") + name + ":";
+    size_t pos = lower.find(key);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    size_t end = lower.find("\r\n", pos + key.size());
+    return lower.substr(pos + key.size(), end - pos - key.size()).find(token) != std::string::npos;
+}
+
+} // namespace
+
+const uint32_t RestGateway::MAX_CONNECTIONS;
+
+const uint32_t RestGateway::IDLE_TIMEOUT;
+
+const uint32_t RestGateway::MAX_CACHED_RESPONSES;
+
+RestGateway::RestGateway(const std::string& address, int port)
+    : address(address), port(port), listen_fd(-1), stopping(false), generation(0) {
+}
+
+RestGateway::~RestGateway() {
+    stop();
+}
+
+bool RestGateway::start() {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        XPUM_LOG_ERROR("XPUM: invalid REST gateway address {}", address);
+        return false;
+    }
+    listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (listen_fd < 0) {
+        XPUM_LOG_ERROR("XPUM: failed to create REST gateway socket: {}", strerror(errno));
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 64) < 0) {
+        XPUM_LOG_ERROR("XPUM: failed to listen at {}:{} for REST: {}", address, port, strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+    stopping = false;
+    worker = std::thread(&RestGateway::serve, this);
+    XPUM_LOG_INFO("XPUM: telemetry REST endpoints are served at http://{}:{}/rest/v1", address, port);
+    return true;
+}
+
+void RestGateway::stop() {
+    stopping = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    for (auto& connection : connections) {
+        close(connection.fd);
+    }
+    connections.clear();
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+    }
+}
+
+void RestGateway::serve() {
+    std::vector<pollfd> pfds;
+    while (!stopping) {
+        pfds.resize(connections.size() + 1);
+        pfds[0].fd = listen_fd;
+        pfds[0].events = connections.size() < MAX_CONNECTIONS ? POLLIN : 0;
+        pfds[0].revents = 0;
+        for (size_t i = 0; i < connections.size(); i++) {
+            pfds[i + 1].fd = connections[i].fd;
+            pfds[i + 1].events = connections[i].output.empty() ? POLLIN : POLLIN | POLLOUT;
+            pfds[i + 1].revents = 0;
+        }
+        // wake up now and then to notice stop() and the idle connections
+        int ret = poll(pfds.data(), pfds.size(), 500);
+        if (ret < 0) {
+            continue;
+        }
+        auto now = std::chrono::steady_clock::now();
+        std::vector<Connection> alive;
+        alive.reserve(connections.size() + 1);
+        for (size_t i = 0; i < connections.size(); i++) {
+            auto& connection = connections[i];
+            short revents = pfds[i + 1].revents;
+            bool keep = true;
+            if (revents & (POLLERR | POLLNVAL)) {
+                keep = false;
+            } else if (revents & (POLLIN | POLLHUP)) {
+                connection.last_active = now;
+                keep = readConnection(connection);
+                if (keep) {
+                    handleRequests(connection);
+                }
+            } else if (now - connection.last_active > std::chrono::seconds(IDLE_TIMEOUT)) {
+                keep = false;
+            }
+            if (keep && !connection.output.empty()) {
+                keep = writeConnection(connection);
+            }
+            if (keep && connection.closing && connection.output.empty()) {
+                keep = false;
+            }
+            if (keep) {
+                alive.push_back(std::move(connection));
+            } else {
+                close(connection.fd);
+            }
+        }
+        connections.swap(alive);
+        if (pfds[0].revents & POLLIN) {
+            while (connections.size() < MAX_CONNECTIONS) {
+                int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+                if (fd < 0) {
+                    break;
+                }
+                int nodelay = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+                connections.push_back(Connection{fd, std::string(), std::string(), false, now});
+            }
+        }
+    }
+}
+
+bool RestGateway::readConnection(Connection& connection) {
+    char buf[4096];
+    while (true) {
+        ssize_t n = recv(connection.fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            connection.input.append(buf, n);
+            if (connection.input.size() > MAX_REQUEST_SIZE) {
+                return false;
+            }
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        // closed by the client, the responses to its last requests are still sent
+        connection.closing = true;
+        return !connection.input.empty() || !connection.output.empty();
+    }
+}
+
+bool RestGateway::writeConnection(Connection& connection) {
+    while (!connection.output.empty()) {
+        ssize_t n = send(connection.fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL);
+        if (n > 0) {
+            connection.output.erase(0, n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+void RestGateway::handleRequests(Connection& connection) {
+    // pipelined requests are answered in order
+    while (true) {
+        size_t header_end = connection.input.find("\r\n\r\n");
+        if (header_end == std::string::npos) {
+            break;
+        }
+        std::string headers = connection.input.substr(0, header_end + 2);
+        size_t consumed = header_end + 4;
+        // the GET requests have no body, a body sent anyway is skipped
+        size_t pos = headers.find("ontent-Length:");
+        if (pos == std::string::npos) {
+            pos = headers.find("ontent-length:");
+        }
+        if (pos != std::string::npos) {
+            consumed += std::strtoul(headers.c_str() + pos + 14, nullptr, 10);
+        }
+        if (consumed > connection.input.size()) {
+            break;
+        }
+        connection.input.erase(0, consumed);
+
+        std::string line = headers.substr(0, headers.find("\r\n"));
+        auto method_end = line.find(' ');
+        auto path_end = method_end == std::string::npos ? std::string::npos : line.find(' ', method_end + 1);
+        const Response* response;
+        Response error;
+        if (method_end == std::string::npos || path_end == std::string::npos) {
+            error = Response{400, errorBody("message", "bad request")};
+            response = &error;
+            connection.closing = true;
+        } else if (line.compare(0, method_end, "GET") != 0) {
+            error = Response{405, errorBody("message", "only the telemetry endpoints are served by xpumd")};
+            response = &error;
+        } else {
+            std::string path = line.substr(method_end + 1, path_end - method_end - 1);
+            response = &getResponse(path.substr(0, path.find('?')));
+        }
+        // HTTP/1.1 keeps the connection unless asked not to, HTTP/1.0 closes it unless asked to keep it
+        bool http10 = line.compare(path_end + 1, std::string::npos, "HTTP/1.0") == 0;
+        if (http10 ? !hasToken(headers, "connection", "keep-alive") : hasToken(headers, "connection", "close")) {
+            connection.closing = true;
+        }
+        auto& output = connection.output;
+        output += http10 ? "HTTP/1.0 " : "HTTP/1.1 ";
+        output += statusText(response->status);
+        output += "\r\nContent-Type: application/json\r\nContent-Length: ";
+        output += std::to_string(response->body.size());
+        output += connection.closing ? "\r\nConnection: close\r\n\r\n" : "\r\nConnection: keep-alive\r\n\r\n";
+        output += response->body;
+        if (connection.closing) {
+            connection.input.clear();
+            break;
+        }
+    }
+}
+
+const RestGateway::Response& RestGateway::getResponse(const std::string& path) {
+    uint64_t current = generation;
+    // a timeout of 0 only reads the generation
+    xpumWaitForMetricsUpdate(&current, 0);
+    if (current != generation) {
+        generation = current;
+        responses.clear();
+    }
+    auto it = responses.find(path);
+    if (it != responses.end()) {
+        return it->second;
+    }
+    Response response = route(path);
+    // before the first store there is nothing to keep the bodies for
+    if (generation == 0 || response.status == 404 || responses.size() >= MAX_CACHED_RESPONSES) {
+        uncached = std::move(response);
+        return uncached;
+    }
+    return responses[path] = std::move(response);
+}
+
+RestGateway::Response RestGateway::route(const std::string& path) {
+    xpum_device_id_t deviceId;
+    std::string endpoint;
+    if (parseDevicePath(path, deviceId, endpoint)) {
+        if (endpoint == "stats") {
+            return renderStats(deviceId);
+        }
+        if (endpoint == "metrics") {
+            return renderMetrics(deviceId);
+        }
+        if (endpoint == "topology") {
+            return renderTopology(deviceId);
+        }
+        if (endpoint == "health") {
+            return renderHealth(deviceId, HEALTH_ALL);
+        }
+        if (endpoint.compare(0, 7, "health/") == 0) {
+            for (int type = 0; type < HEALTH_TYPE_COUNT; type++) {
+                if (endpoint.compare(7, std::string::npos, health_types[type].path) == 0) {
+                    return renderHealth(deviceId, type);
+                }
+            }
+            return Response{404, statusBody(1, "health type not supported")};
+        }
+    }
+    return Response{404, errorBody("message", "not served by xpumd, the other endpoints are served by the REST server")};
+}
+
+RestGateway::Response RestGateway::renderStats(xpum_device_id_t deviceId) {
+    // the device and its tiles, as the getStatisticsNotForPrometheus RPC
+    uint32_t count = 5;
+    xpum_device_stats_t dataList[5];
+    uint64_t begin = 0, end = 0;
+    xpum_result_t res = xpumGetStatsByMask(deviceId, 0, dataList, &count, &begin, &end, 0);
+    if (res == XPUM_RESULT_DEVICE_NOT_FOUND) {
+        return Response{400, errorBody("message", "device not found")};
+    }
+    if (res != XPUM_OK) {
+        return Response{500, errorBody("message", "Error code: " + std::to_string(res) + ", error message: fail to get statistics data")};
+    }
+
+    uint32_t engine_count = 0;
+    uint64_t engine_begin, engine_end;
+    std::vector<xpum_device_engine_stats_t> engines;
+    res = xpumGetEngineStats(deviceId, nullptr, &engine_count, &engine_begin, &engine_end, 0);
+    if (res == XPUM_OK && engine_count > 0) {
+        engines.resize(engine_count);
+        res = xpumGetEngineStats(deviceId, engines.data(), &engine_count, &engine_begin, &engine_end, 0);
+        engines.resize(res == XPUM_OK ? engine_count : 0);
+    }
+    if (res != XPUM_OK) {
+        return Response{500, errorBody("message", "Error code: " + std::to_string(res) + ", error message: Fail to get engine statistics")};
+    }
+    auto appendEngineUtil = [&](std::string& body, bool isTileData, int32_t tileId) {
+        bool any = false;
+        for (auto& engine : engines) {
+            any |= engine.isTileData == isTileData && (!isTileData || engine.tileId == tileId);
+        }
+        if (!any) {
+            return;
+        }
+        appendKey(body, "engine_util");
+        body += '{';
+        for (auto type : engine_util_types) {
+            appendKey(body, engineUtilKey(type));
+            body += '[';
+            bool first = true;
+            for (auto& engine : engines) {
+                if (engine.type != type || engine.isTileData != isTileData || (isTileData && engine.tileId != tileId)) {
+                    continue;
+                }
+                body += first ? "{" : ", {";
+                first = false;
+                appendUint(body, "engine_id", engine.index);
+                appendScaled(body, "value", engine.value, engine.scale);
+                appendScaled(body, "avg", engine.avg, engine.scale);
+                appendScaled(body, "min", engine.min, engine.scale);
+                appendScaled(body, "max", engine.max, engine.scale);
+                body += '}';
+            }
+            body += ']';
+        }
+        body += '}';
+    };
+    auto appendDataList = [](std::string& body, const char* key, const xpum_device_stats_t& stats) {
+        appendKey(body, key);
+        body += '[';
+        bool first = true;
+        for (int j = 0; j < stats.count; j++) {
+            auto& data = stats.dataList[j];
+            if (data.metricsType < 0 || data.metricsType >= XPUM_STATS_MAX || !metricsTypeAllowList(data.metricsType)) {
+                continue;
+            }
+            body += first ? "{" : ", {";
+            first = false;
+            appendKey(body, "metrics_type");
+            appendString(body, stats_type_names[data.metricsType]);
+            appendScaled(body, "value", data.value, data.scale);
+            if (!data.isCounter) {
+                appendScaled(body, "avg", data.avg, data.scale);
+                appendScaled(body, "min", data.min, data.scale);
+                appendScaled(body, "max", data.max, data.scale);
+                appendScaled(body, "p50", data.p50, data.scale);
+                appendScaled(body, "p90", data.p90, data.scale);
+                appendScaled(body, "p99", data.p99, data.scale);
+            }
+            body += '}';
+        }
+        body += ']';
+    };
+
+    std::string body = "{";
+    appendUint(body, "device_id", deviceId);
+    appendTime(body, "begin", begin);
+    appendTime(body, "end", end);
+    bool has_tiles = false;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!dataList[i].isTileData) {
+            appendDataList(body, "device_level", dataList[i]);
+        }
+        has_tiles |= dataList[i].isTileData;
+    }
+    if (has_tiles) {
+        appendKey(body, "tile_level");
+        body += '[';
+        bool first = true;
+        for (uint32_t i = 0; i < count; i++) {
+            if (!dataList[i].isTileData) {
+                continue;
+            }
+            body += first ? "{" : ", {";
+            first = false;
+            appendUint(body, "tile_id", dataList[i].tileId);
+            appendDataList(body, "data_list", dataList[i]);
+            appendEngineUtil(body, true, dataList[i].tileId);
+            body += '}';
+        }
+        body += ']';
+    }
+    appendEngineUtil(body, false, -1);
+    body += '}';
+    return Response{200, std::move(body)};
+}
+
+RestGateway::Response RestGateway::renderMetrics(xpum_device_id_t deviceId) {
+    int count = 0;
+    xpum_result_t res = xpumGetMetrics(deviceId, nullptr, &count);
+    std::vector<xpum_device_metrics_t> metrics;
+    if (res == XPUM_OK && count > 0) {
+        metrics.resize(count);
+        res = xpumGetMetrics(deviceId, metrics.data(), &count);
+    }
+    if (res == XPUM_RESULT_DEVICE_NOT_FOUND) {
+        return Response{400, errorBody("message", "device not found")};
+    }
+    if (res != XPUM_OK) {
+        return Response{500, errorBody("message", "Error code: " + std::to_string(res) + ", error message: fail to get metrics")};
+    }
+    auto appendDataList = [](std::string& body, const char* key, const xpum_device_metrics_t& entry) {
+        appendKey(body, key);
+        body += '[';
+        for (int j = 0; j < entry.count; j++) {
+            auto& data = entry.dataList[j];
+            if (data.metricsType < 0 || data.metricsType >= XPUM_STATS_MAX) {
+                continue;
+            }
+            body += body.back() == '[' ? "{" : ", {";
+            appendKey(body, "metrics_type");
+            appendString(body, stats_type_names[data.metricsType]);
+            appendScaled(body, "value", data.value, data.scale);
+            appendTime(body, "timestamp", data.timestamp);
+            body += '}';
+        }
+        body += ']';
+    };
+
+    std::string body = "{";
+    appendUint(body, "device_id", deviceId);
+    std::string tiles;
+    for (int i = 0; i < count; i++) {
+        if (!metrics[i].isTileData) {
+            appendDataList(body, "device_level", metrics[i]);
+            continue;
+        }
+        tiles += tiles.empty() ? "{" : ", {";
+        appendUint(tiles, "tile_id", metrics[i].tileId);
+        appendDataList(tiles, "data_list", metrics[i]);
+        tiles += '}';
+    }
+    if (!tiles.empty()) {
+        appendKey(body, "tile_level");
+        body += '[' + tiles + ']';
+    }
+    body += '}';
+    return Response{200, std::move(body)};
+}
+
+RestGateway::Response RestGateway::renderHealth(xpum_device_id_t deviceId, int type) {
+    std::string body = "{";
+    appendUint(body, "device_id", deviceId);
+    int first = type == HEALTH_ALL ? 0 : type;
+    int last = type == HEALTH_ALL ? HEALTH_TYPE_COUNT - 1 : type;
+    for (int t = first; t <= last; t++) {
+        xpum_health_data_t data;
+        xpum_result_t res = xpumGetHealth(deviceId, (xpum_health_type_t)t, &data);
+        if (res == XPUM_RESULT_DEVICE_NOT_FOUND) {
+            return Response{404, statusBody(1, "device not found")};
+        }
+        if (res != XPUM_OK) {
+            return Response{500, statusBody(1, res == XPUM_LEVEL_ZERO_INITIALIZATION_ERROR ? "Level Zero Initialization Error" : "Error")};
+        }
+        auto& health_type = health_types[t];
+        appendKey(body, health_type.key);
+        body += '{';
+        appendKey(body, "status");
+        appendString(body, healthStatusName(data.status));
+        appendKey(body, "description");
+        appendString(body, data.description);
+        if (health_type.throttle) {
+            appendUint(body, "throttle_threshold", data.throttleThreshold);
+            if (health_type.shutdown) {
+                appendUint(body, "shutdown_threshold", data.shutdownThreshold);
+            }
+            // the health config types share the index of these health types
+            int threshold = 0;
+            res = xpumGetHealthConfig(deviceId, (xpum_health_config_type_t)t, &threshold);
+            if (res != XPUM_OK) {
+                return Response{500, statusBody(1, "Error")};
+            }
+            appendKey(body, "custom_threshold");
+            body += std::to_string(threshold);
+        }
+        body += '}';
+    }
+    body += '}';
+    return Response{200, std::move(body)};
+}
+
+RestGateway::Response RestGateway::renderTopology(xpum_device_id_t deviceId) {
+    std::size_t size = sizeof(xpum_topology_t);
+    std::shared_ptr<xpum_topology_t> topology(static_cast<xpum_topology_t*>(malloc(size)), free);
+    xpum_result_t res = xpumGetTopology(deviceId, topology.get(), &size);
+    if (res == XPUM_BUFFER_TOO_SMALL) {
+        topology.reset(static_cast<xpum_topology_t*>(malloc(size)), free);
+        res = xpumGetTopology(deviceId, topology.get(), &size);
+    }
+    if (res != XPUM_OK) {
+        return Response{400, statusBody(1, res == XPUM_LEVEL_ZERO_INITIALIZATION_ERROR ? "Level Zero Initialization Error" : "Error")};
+    }
+    std::string body = "{";
+    appendUint(body, "device_id", deviceId);
+    appendKey(body, "affinity_localcpulist");
+    appendString(body, topology->cpuAffinity.localCPUList);
+    appendKey(body, "affinity_localcpus");
+    appendString(body, topology->cpuAffinity.localCPUs);
+    appendUint(body, "switch_count", topology->switchCount);
+    if (topology->switchCount > 0) {
+        appendKey(body, "switch_list");
+        body += '[';
+        for (int i = 0; i < topology->switchCount; i++) {
+            if (i > 0) {
+                body += ", ";
+            }
+            appendString(body, topology->switches[i].switchDevicePath);
+        }
+        body += ']';
+    }
+    body += '}';
+    return Response{200, std::move(body)};
+}
+
+} // end namespace xpum::daemon
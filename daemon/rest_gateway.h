@@ -0,0 +1,118 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file rest_gateway.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "xpum_structs.h"
+
+namespace xpum::daemon {
+
+/*
+  RestGateway serves the read-only telemetry endpoints of the REST API from
+  xpumd itself, with the paths and the JSON of the Python REST server:
+
+    GET /rest/v1/devices/<id>/stats
+    GET /rest/v1/devices/<id>/metrics       the latest values of the monitor
+    GET /rest/v1/devices/<id>/health
+    GET /rest/v1/devices/<id>/health/<type>
+    GET /rest/v1/devices/<id>/topology
+
+  The other endpoints stay in the Python server. The bodies are read from
+  the data the monitor keeps in DataLogic, rendered to JSON once per data
+  generation and sent as is to every request of the same path until the
+  monitor stores new data, so a dashboard polling many devices costs one
+  rendering per store and no gRPC hop.
+
+  The connections are kept alive as HTTP/1.1 asks, up to MAX_CONNECTIONS,
+  and closed after IDLE_TIMEOUT seconds without a request. The gateway does
+  not authenticate, it listens at the loopback address by default.
+*/
+
+class RestGateway {
+   public:
+    static const uint32_t MAX_CONNECTIONS = 64;
+
+    static const uint32_t IDLE_TIMEOUT = 30;
+
+    // the responses kept for one generation, the paths beyond are rendered for each request
+    static const uint32_t MAX_CACHED_RESPONSES = 256;
+
+    RestGateway(const std::string& address, int port);
+
+    ~RestGateway();
+
+    bool start();
+
+    void stop();
+
+   private:
+    struct Connection {
+        int fd;
+        std::string input;
+        std::string output;
+        bool closing;
+        std::chrono::steady_clock::time_point last_active;
+    };
+
+    struct Response {
+        int status;
+        std::string body;
+    };
+
+    void serve();
+
+    // false if the connection is to be closed
+    bool readConnection(Connection& connection);
+
+    bool writeConnection(Connection& connection);
+
+    // the requests read so far, the responses are appended to the output
+    void handleRequests(Connection& connection);
+
+    const Response& getResponse(const std::string& path);
+
+    Response route(const std::string& path);
+
+    Response renderStats(xpum_device_id_t deviceId);
+
+    Response renderMetrics(xpum_device_id_t deviceId);
+
+    Response renderHealth(xpum_device_id_t deviceId, int type);
+
+    Response renderTopology(xpum_device_id_t deviceId);
+
+   private:
+    std::string address;
+
+    int port;
+
+    int listen_fd;
+
+    std::atomic<bool> stopping;
+
+    std::thread worker;
+
+    // only used by the worker thread
+    std::vector<Connection> connections;
+
+    // the rendered responses by path, of the data generation below
+    std::map<std::string, Response> responses;
+
+    uint64_t generation;
+
+    // the response of a path not kept in responses
+    Response uncached;
+};
+
+} // end namespace xpum::daemon
@@ -0,0 +1,158 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file rpc_admission.cpp
+ */
+
+#include "rpc_admission.h"
+
+#include <algorithm>
+#include <string>
+
+namespace xpum::daemon {
+
+namespace {
+
+const char* getClassName(RpcClass rpcClass) {
+    switch (rpcClass) {
+        case RpcClass::CONTROL:
+            return "control";
+        case RpcClass::LONG_RUNNING:
+            return "long-running";
+        case RpcClass::STREAMING:
+            return "streaming";
+        default:
+            return "telemetry";
+    }
+}
+
+// the clients kept before the buckets refilled to the full burst are dropped
+const size_t MAX_RATE_LIMITED_CLIENTS = 256;
+
+std::string getClientKey(const grpc::ServerContext* context) {
+    std::string key = context->peer();
+    auto& metadata = context->client_metadata();
+    auto it = metadata.find("user-agent");
+    if (it != metadata.end()) {
+        key += " ";
+        key.append(it->second.data(), it->second.size());
+    }
+    return key;
+}
+
+} // namespace
+
+RpcSlotPool::RpcSlotPool(const char* name, uint32_t telemetryThreads, uint32_t controlSlots, uint32_t longRunningSlots, uint32_t streamingSlots)
+    : name(name), limits{telemetryThreads, controlSlots, longRunningSlots, streamingSlots} {
+    for (auto& count : in_flight) {
+        count.store(0);
+    }
+}
+
+const char* RpcSlotPool::getName() const {
+    return name;
+}
+
+uint32_t RpcSlotPool::getLimit(RpcClass rpcClass) const {
+    return limits[static_cast<int>(rpcClass)];
+}
+
+int RpcSlotPool::getMaxThreads() const {
+    return limits[0] + limits[1] + limits[2] + limits[3];
+}
+
+RpcSlotPool& RpcSlotPool::privileged() {
+    static RpcSlotPool pool("xpumd", 32, 8, 4, 16);
+    return pool;
+}
+
+RpcSlotPool& RpcSlotPool::unprivileged() {
+    // the control RPCs are refused on the unprivileged socket, the slots are for the read only ones of the class
+    static RpcSlotPool pool("xpumd_unprivileged", 8, 2, 1, 4);
+    return pool;
+}
+
+RpcSlot::RpcSlot(RpcSlotPool& pool, RpcClass rpcClass) : pool(pool), rpcClass(rpcClass), acquired(true) {
+    if (rpcClass == RpcClass::TELEMETRY) {
+        return;
+    }
+    auto& count = pool.in_flight[static_cast<int>(rpcClass)];
+    uint32_t current = count.load();
+    do {
+        if (current >= pool.getLimit(rpcClass)) {
+            acquired = false;
+            return;
+        }
+    } while (!count.compare_exchange_weak(current, current + 1));
+}
+
+RpcSlot::~RpcSlot() {
+    if (acquired && rpcClass != RpcClass::TELEMETRY) {
+        pool.in_flight[static_cast<int>(rpcClass)]--;
+    }
+}
+
+bool RpcSlot::isAcquired() const {
+    return acquired;
+}
+
+grpc::Status RpcSlot::getBusyStatus() const {
+    return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                        std::string("too many ") + getClassName(rpcClass) + " requests in progress, retry later");
+}
+
+RpcRateLimiter& RpcRateLimiter::instance() {
+    static RpcRateLimiter limiter;
+    return limiter;
+}
+
+void RpcRateLimiter::setRate(uint32_t rate) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->rate.store(rate);
+    buckets.clear();
+}
+
+uint32_t RpcRateLimiter::getRate() const {
+    return rate.load();
+}
+
+bool RpcRateLimiter::admit(const grpc::ServerContext* context) {
+    uint32_t current = rate.load();
+    if (current == 0) {
+        return true;
+    }
+    double burst = 2.0 * current;
+    auto now = std::chrono::steady_clock::now();
+    std::string key = getClientKey(context);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = buckets.find(key);
+    if (it == buckets.end()) {
+        if (buckets.size() >= MAX_RATE_LIMITED_CLIENTS) {
+            for (auto bucket = buckets.begin(); bucket != buckets.end();) {
+                std::chrono::duration<double> idle = now - bucket->second.updated;
+                if (bucket->second.tokens + idle.count() * current >= burst) {
+                    bucket = buckets.erase(bucket);
+                } else {
+                    ++bucket;
+                }
+            }
+        }
+        it = buckets.emplace(key, Bucket{burst, now}).first;
+    }
+    Bucket& bucket = it->second;
+    std::chrono::duration<double> elapsed = now - bucket.updated;
+    bucket.tokens = std::min(burst, bucket.tokens + elapsed.count() * current);
+    bucket.updated = now;
+    if (bucket.tokens < 1) {
+        return false;
+    }
+    bucket.tokens -= 1;
+    return true;
+}
+
+grpc::Status RpcRateLimiter::getLimitedStatus() const {
+    return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                        "more than " + std::to_string(rate.load()) + " telemetry requests a second from this client, retry later");
+}
+
+} // end namespace xpum::daemon
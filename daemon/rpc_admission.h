@@ -0,0 +1,134 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file rpc_admission.h
+ */
+
+#pragma once
+
+#include <grpc++/grpc++.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace xpum::daemon {
+
+/*
+  Every synchronous gRPC server has its own bounded thread pool. Every RPC
+  that can hold a thread for long is assigned to a class with a fixed number
+  of slots in the pool of its server; a call that finds its class full fails
+  with RESOURCE_EXHAUSTED right away instead of waiting for a thread. The
+  RPCs not guarded by a slot are telemetry and always keep the threads left
+  over by the other classes.
+*/
+
+enum class RpcClass {
+    TELEMETRY,
+    // device settings, groups, policies, vf and firmware flash
+    CONTROL,
+    // diagnostics, stress, process utilization, amc and debug log
+    LONG_RUNNING,
+    // the server streaming RPCs, which hold a thread until the client leaves
+    STREAMING,
+};
+
+/*
+  The slots of one RPC server. The privileged and the unprivileged server
+  have their own pools, so the polling of the clients of the unprivileged
+  socket never takes the threads or slots of the privileged one.
+*/
+class RpcSlotPool {
+   public:
+    RpcSlotPool(const char* name, uint32_t telemetryThreads, uint32_t controlSlots, uint32_t longRunningSlots, uint32_t streamingSlots);
+
+    RpcSlotPool(const RpcSlotPool&) = delete;
+
+    RpcSlotPool& operator=(const RpcSlotPool&) = delete;
+
+    const char* getName() const;
+
+    uint32_t getLimit(RpcClass rpcClass) const;
+
+    /*
+      The thread limit of the resource quota of the server, the slots of all
+      classes plus the threads reserved for telemetry.
+    */
+    int getMaxThreads() const;
+
+    static RpcSlotPool& privileged();
+
+    static RpcSlotPool& unprivileged();
+
+   private:
+    friend class RpcSlot;
+
+    const char* name;
+
+    uint32_t limits[4];
+
+    std::atomic<uint32_t> in_flight[4];
+};
+
+class RpcSlot {
+   public:
+    RpcSlot(RpcSlotPool& pool, RpcClass rpcClass);
+
+    ~RpcSlot();
+
+    RpcSlot(const RpcSlot&) = delete;
+
+    RpcSlot& operator=(const RpcSlot&) = delete;
+
+    bool isAcquired() const;
+
+    grpc::Status getBusyStatus() const;
+
+   private:
+    RpcSlotPool& pool;
+
+    RpcClass rpcClass;
+
+    bool acquired;
+};
+
+/*
+  A token bucket per client for the telemetry RPCs that clients poll, so a
+  client polling far faster than the monitor stores data is refused with
+  RESOURCE_EXHAUSTED instead of taking the threads of the others. Clients are
+  told apart by their peer and user agent; the REST server and xpu-smi set
+  their own user agent.
+*/
+class RpcRateLimiter {
+   public:
+    static RpcRateLimiter& instance();
+
+    // requests a second per client, 0 for no limit; a client may send a burst of twice the rate
+    void setRate(uint32_t rate);
+
+    uint32_t getRate() const;
+
+    // take a token of the client of the call, false when its bucket is empty
+    bool admit(const grpc::ServerContext* context);
+
+    grpc::Status getLimitedStatus() const;
+
+   private:
+    struct Bucket {
+        double tokens;
+        std::chrono::steady_clock::time_point updated;
+    };
+
+    RpcRateLimiter() = default;
+
+    std::atomic<uint32_t> rate{0};
+
+    std::mutex mutex;
+
+    std::unordered_map<std::string, Bucket> buckets;
+};
+
+} // end namespace xpum::daemon
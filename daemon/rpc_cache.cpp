@@ -0,0 +1,98 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file rpc_cache.cpp
+ */
+
+#include "rpc_cache.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include "internal_api.h"
+
+namespace xpum::daemon {
+
+namespace {
+
+// the responses kept for one generation, the requests beyond are not cached
+const size_t MAX_CACHED_RESPONSES = 256;
+
+} // namespace
+
+RpcResponseCache& RpcResponseCache::instance() {
+    static RpcResponseCache cache;
+    return cache;
+}
+
+uint64_t RpcResponseCache::getGeneration() {
+    uint64_t current = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = generation;
+    }
+    // a timeout of 0 only reads the generation, it is left as is when no data is stored since
+    xpumWaitForMetricsUpdate(&current, 0);
+    return current;
+}
+
+bool RpcResponseCache::get(const std::string& key, uint64_t generation, google::protobuf::Message* response) {
+    if (generation == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (generation != this->generation) {
+        return false;
+    }
+    auto it = responses.find(key);
+    if (it == responses.end()) {
+        return false;
+    }
+    return response->ParseFromString(it->second);
+}
+
+void RpcResponseCache::put(const std::string& key, uint64_t generation, const google::protobuf::Message& response) {
+    if (generation == 0) {
+        return;
+    }
+    std::string serialized;
+    if (!response.SerializeToString(&serialized)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (generation < this->generation) {
+        return;
+    }
+    if (generation > this->generation) {
+        this->generation = generation;
+        responses.clear();
+    }
+    if (responses.size() < MAX_CACHED_RESPONSES) {
+        responses[key] = std::move(serialized);
+    }
+}
+
+CachedResponse::CachedResponse(const char* rpc, const google::protobuf::Message& request, google::protobuf::Message* response)
+    : key(rpc), generation(RpcResponseCache::instance().getGeneration()), response(response), hit(false) {
+    key.push_back('\0');
+    {
+        // deterministic, so that identical requests give the same key
+        google::protobuf::io::StringOutputStream stream(&key);
+        google::protobuf::io::CodedOutputStream output(&stream);
+        output.SetSerializationDeterministic(true);
+        request.SerializeToCodedStream(&output);
+    }
+    hit = RpcResponseCache::instance().get(key, generation, response);
+}
+
+CachedResponse::~CachedResponse() {
+    if (!hit) {
+        RpcResponseCache::instance().put(key, generation, *response);
+    }
+}
+
+bool CachedResponse::isHit() const {
+    return hit;
+}
+
+} // end namespace xpum::daemon
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file rpc_cache.h
+ */
+
+#pragma once
+
+#include <google/protobuf/message.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace xpum::daemon {
+
+/*
+  The telemetry RPCs answer the same to identical requests as long as the
+  monitor stores no new data. The serialized response to a request is kept
+  for the data generation it was made in, and identical requests that follow
+  get a copy of it, so the exporter, the REST server and xpu-smi polling the
+  same devices cost one computed response per store. A new generation drops
+  all the kept responses.
+*/
+class RpcResponseCache {
+   public:
+    static RpcResponseCache& instance();
+
+    // the generation of the data stored by the monitor, 0 before the first store
+    uint64_t getGeneration();
+
+    bool get(const std::string& key, uint64_t generation, google::protobuf::Message* response);
+
+    void put(const std::string& key, uint64_t generation, const google::protobuf::Message& response);
+
+   private:
+    RpcResponseCache() = default;
+
+    std::mutex mutex;
+
+    uint64_t generation = 0;
+
+    std::unordered_map<std::string, std::string> responses;
+};
+
+/*
+  The cache entry of one call. When isHit() the response is filled from the
+  cache, otherwise the response made by the RPC is kept when the entry goes
+  out of scope, after the RPC has filled it.
+*/
+class CachedResponse {
+   public:
+    // rpc must be a string literal
+    CachedResponse(const char* rpc, const google::protobuf::Message& request, google::protobuf::Message* response);
+
+    ~CachedResponse();
+
+    CachedResponse(const CachedResponse&) = delete;
+
+    CachedResponse& operator=(const CachedResponse&) = delete;
+
+    bool isHit() const;
+
+   private:
+    std::string key;
+
+    uint64_t generation;
+
+    google::protobuf::Message* response;
+
+    bool hit;
+};
+
+} // end namespace xpum::daemon
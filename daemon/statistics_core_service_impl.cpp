@@ -4,64 +4,38 @@
  *  @file statistics_core_service_impl.cpp
  */
 
+#include <algorithm>
+#include <chrono>
+#include <google/protobuf/arena.h>
+#include <map>
+#include <set>
+#include <thread>
+#include <tuple>
+
 #include "internal_api.h"
+#include "metrics_type_filter.h"
+#include "rpc_admission.h"
+#include "rpc_cache.h"
 #include "xpum_api.h"
 #include "xpum_core_service_impl.h"
 #include "xpum_structs.h"
 
 namespace xpum::daemon {
 
-inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
-    std::vector<xpum_stats_type_t> allowList{
-        XPUM_STATS_GPU_UTILIZATION,
-        XPUM_STATS_EU_ACTIVE,
-        XPUM_STATS_EU_STALL,
-        XPUM_STATS_EU_IDLE,
-        XPUM_STATS_POWER,
-        XPUM_STATS_ENERGY,
-        XPUM_STATS_GPU_FREQUENCY,
-        XPUM_STATS_GPU_CORE_TEMPERATURE,
-        XPUM_STATS_MEMORY_USED,
-        XPUM_STATS_MEMORY_UTILIZATION,
-        XPUM_STATS_MEMORY_BANDWIDTH,
-        // XPUM_STATS_MEMORY_READ,
-        // XPUM_STATS_MEMORY_WRITE,
-        XPUM_STATS_MEMORY_READ_THROUGHPUT,
-        XPUM_STATS_MEMORY_WRITE_THROUGHPUT,
-        XPUM_STATS_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION,
-        XPUM_STATS_ENGINE_GROUP_MEDIA_ALL_UTILIZATION,
-        XPUM_STATS_ENGINE_GROUP_COPY_ALL_UTILIZATION,
-        XPUM_STATS_ENGINE_GROUP_RENDER_ALL_UTILIZATION,
-        XPUM_STATS_ENGINE_GROUP_3D_ALL_UTILIZATION,
-        XPUM_STATS_RAS_ERROR_CAT_RESET,
-        XPUM_STATS_RAS_ERROR_CAT_PROGRAMMING_ERRORS,
-        XPUM_STATS_RAS_ERROR_CAT_DRIVER_ERRORS,
-        XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE,
-        XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE,
-        // XPUM_STATS_RAS_ERROR_CAT_DISPLAY_ERRORS_CORRECTABLE,
-        // XPUM_STATS_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE,
-        XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE,
-        XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE,
-        // XPUM_STATS_GPU_REQUEST_FREQUENCY,
-        XPUM_STATS_MEMORY_TEMPERATURE,
-        XPUM_STATS_FREQUENCY_THROTTLE,
-        XPUM_STATS_PCIE_READ_THROUGHPUT,
-        XPUM_STATS_PCIE_WRITE_THROUGHPUT,
-        XPUM_STATS_PCIE_READ,
-        XPUM_STATS_PCIE_WRITE,
-        XPUM_STATS_ENGINE_UTILIZATION,
-        XPUM_STATS_MEDIA_ENGINE_FREQUENCY,
-    };
-    return std::find(allowList.begin(), allowList.end(), metricsType) != allowList.end();
-}
-
 ::grpc::Status XpumCoreServiceImpl::getStatistics(::grpc::ServerContext* context, const ::XpumGetStatsRequest* request, ::XpumGetStatsResponse* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    CachedResponse cached("getStatistics", *request, response);
+    if (cached.isHit()) {
+        return grpc::Status::OK;
+    }
     xpum_device_id_t deviceId = request->deviceid();
     uint64_t sessionId = request->sessionid();
     uint32_t count = 5;
     xpum_device_stats_t dataList[count];
     uint64_t begin, end;
-    xpum_result_t res = xpumGetStats(deviceId, dataList, &count, &begin, &end, sessionId);
+    xpum_result_t res = xpumGetStatsByMask(deviceId, request->metricsmask(), dataList, &count, &begin, &end, sessionId);
     if (res != XPUM_OK) {
         switch (res) {
             case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
@@ -94,6 +68,9 @@ inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
             deviceStatsData->set_min(data.min);
             deviceStatsData->set_avg(data.avg);
             deviceStatsData->set_max(data.max);
+            deviceStatsData->set_p50(data.p50);
+            deviceStatsData->set_p90(data.p90);
+            deviceStatsData->set_p99(data.p99);
             deviceStatsData->set_accumulated(data.accumulated);
             deviceStatsData->set_scale(data.scale);
         }
@@ -103,6 +80,13 @@ inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::getStatisticsByGroup(::grpc::ServerContext* context, const ::XpumGetStatsByGroupRequest* request, ::XpumGetStatsResponse* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    CachedResponse cached("getStatisticsByGroup", *request, response);
+    if (cached.isHit()) {
+        return grpc::Status::OK;
+    }
     xpum_device_id_t groupId = request->groupid();
     uint64_t sessionId = request->sessionid();
     uint32_t count = 5 * XPUM_MAX_NUM_DEVICES;
@@ -141,6 +125,9 @@ inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
             deviceStatsData->set_min(data.min);
             deviceStatsData->set_avg(data.avg);
             deviceStatsData->set_max(data.max);
+            deviceStatsData->set_p50(data.p50);
+            deviceStatsData->set_p90(data.p90);
+            deviceStatsData->set_p99(data.p99);
             deviceStatsData->set_accumulated(data.accumulated);
             deviceStatsData->set_scale(data.scale);
         }
@@ -149,12 +136,19 @@ inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::getStatisticsNotForPrometheus(::grpc::ServerContext* context, const ::XpumGetStatsRequest* request, ::XpumGetStatsResponse* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    CachedResponse cached("getStatisticsNotForPrometheus", *request, response);
+    if (cached.isHit()) {
+        return grpc::Status::OK;
+    }
     xpum_device_id_t deviceId = request->deviceid();
     uint64_t sessionId = request->sessionid();
     uint32_t count = 5;
     xpum_device_stats_t dataList[count];
     uint64_t begin, end;
-    xpum_result_t res = xpumGetStats(deviceId, dataList, &count, &begin, &end, sessionId);
+    xpum_result_t res = xpumGetStatsByMask(deviceId, request->metricsmask(), dataList, &count, &begin, &end, sessionId);
     response->set_errorno(res);
     if (res != XPUM_OK) {
         switch (res) {
@@ -190,6 +184,9 @@ inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
             deviceStatsData->set_min(data.min);
             deviceStatsData->set_avg(data.avg);
             deviceStatsData->set_max(data.max);
+            deviceStatsData->set_p50(data.p50);
+            deviceStatsData->set_p90(data.p90);
+            deviceStatsData->set_p99(data.p99);
             deviceStatsData->set_accumulated(data.accumulated);
             deviceStatsData->set_scale(data.scale);
         }
@@ -198,6 +195,13 @@ inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::getStatisticsByGroupNotForPrometheus(::grpc::ServerContext* context, const ::XpumGetStatsByGroupRequest* request, ::XpumGetStatsResponse* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    CachedResponse cached("getStatisticsByGroupNotForPrometheus", *request, response);
+    if (cached.isHit()) {
+        return grpc::Status::OK;
+    }
     xpum_device_id_t groupId = request->groupid();
     uint64_t sessionId = request->sessionid();
     uint32_t count = 5 * XPUM_MAX_NUM_DEVICES;
@@ -238,6 +242,9 @@ inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
             deviceStatsData->set_min(data.min);
             deviceStatsData->set_avg(data.avg);
             deviceStatsData->set_max(data.max);
+            deviceStatsData->set_p50(data.p50);
+            deviceStatsData->set_p90(data.p90);
+            deviceStatsData->set_p99(data.p99);
             deviceStatsData->set_accumulated(data.accumulated);
             deviceStatsData->set_scale(data.scale);
         }
@@ -245,26 +252,551 @@ inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
     return grpc::Status::OK;
 }
 
-::grpc::Status XpumCoreServiceImpl::getEngineStatistics(::grpc::ServerContext* context, const ::XpumGetEngineStatsRequest* request, ::XpumGetEngineStatsResponse* response) {
+::grpc::Status XpumCoreServiceImpl::getMetricsHistory(::grpc::ServerContext* context, const ::XpumGetMetricsHistoryRequest* request, ::XpumGetMetricsHistoryResponse* response) {
     xpum_device_id_t deviceId = request->deviceid();
-    uint64_t sessionId = request->sessionid();
-    uint32_t count;
-    uint64_t begin, end;
-    xpum_result_t res = xpumGetEngineStats(deviceId, nullptr, &count, &begin, &end, sessionId);
+    std::vector<xpum_stats_type_t> metricsTypes;
+    for (auto& type : request->metricstypes()) {
+        metricsTypes.push_back((xpum_stats_type_t)type.value());
+    }
+    uint32_t seriesCount = 0;
+    uint32_t pointCount = 0;
+    xpum_result_t res = xpumGetMetricsHistory(deviceId, metricsTypes.data(), metricsTypes.size(), request->begin(), request->end(), request->step(),
+                                              nullptr, &seriesCount, nullptr, &pointCount);
+    std::vector<xpum_metrics_history_t> seriesList(seriesCount);
+    std::vector<xpum_metrics_history_point_t> pointList(pointCount);
+    if (res == XPUM_OK) {
+        res = xpumGetMetricsHistory(deviceId, metricsTypes.data(), metricsTypes.size(), request->begin(), request->end(), request->step(),
+                                    seriesList.data(), &seriesCount, pointList.data(), &pointCount);
+    }
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        switch (res) {
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+                response->set_errormsg("Device not found");
+                break;
+            case XPUM_INTERVAL_INVALID:
+                response->set_errormsg("Invalid time range or step");
+                break;
+            case XPUM_METRIC_NOT_SUPPORTED:
+                response->set_errormsg("Unsupported metric type");
+                break;
+            case XPUM_API_UNSUPPORTED:
+                response->set_errormsg("Telemetry data is not persisted");
+                break;
+            case XPUM_BUFFER_TOO_SMALL:
+                response->set_errormsg("Metrics history changed during query, please retry");
+                break;
+            default:
+                response->set_errormsg("Error");
+                break;
+        }
+        return grpc::Status::OK;
+    }
+    response->set_deviceid(deviceId);
+    for (uint32_t i = 0; i < seriesCount; i++) {
+        xpum_metrics_history_t& history = seriesList[i];
+        MetricsHistorySeries* series = response->add_serieslist();
+        series->set_istiledata(history.isTileData);
+        series->set_tileid(history.tileId);
+        series->mutable_metricstype()->set_value(history.metricsType);
+        series->set_iscounter(history.isCounter);
+        series->set_scale(history.scale);
+        for (uint32_t j = history.offset; j < history.offset + history.count && j < pointCount; j++) {
+            MetricsHistoryPoint* point = series->add_points();
+            point->set_timestamp(pointList[j].timestamp);
+            point->set_min(pointList[j].min);
+            point->set_avg(pointList[j].avg);
+            point->set_max(pointList[j].max);
+            point->set_count(pointList[j].count);
+        }
+    }
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::getMetricsHistograms(::grpc::ServerContext* context, const ::DeviceId* request, ::XpumGetMetricsHistogramsResponse* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    xpum_device_id_t deviceId = request->id();
+    std::vector<xpum_metrics_histogram_t> histogramList;
+    std::vector<xpum_metrics_histogram_bin_t> binList;
+    xpum_result_t res;
+    // a histogram may gain a bin between the two calls, it is asked again then
+    for (int attempt = 0; attempt < 3; attempt++) {
+        uint32_t histogramCount = 0;
+        uint32_t binCount = 0;
+        res = xpumGetMetricsHistograms(deviceId, nullptr, &histogramCount, nullptr, &binCount);
+        if (res != XPUM_OK) {
+            break;
+        }
+        // room for the bins added until the second call
+        binCount += histogramCount;
+        histogramList.resize(histogramCount);
+        binList.resize(binCount);
+        res = xpumGetMetricsHistograms(deviceId, histogramList.data(), &histogramCount, binList.data(), &binCount);
+        histogramList.resize(histogramCount);
+        if (res != XPUM_BUFFER_TOO_SMALL) {
+            break;
+        }
+    }
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        switch (res) {
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+                response->set_errormsg("Device not found");
+                break;
+            case XPUM_BUFFER_TOO_SMALL:
+                response->set_errormsg("Metrics histograms changed during query, please retry");
+                break;
+            default:
+                response->set_errormsg("Error");
+                break;
+        }
+        return grpc::Status::OK;
+    }
+    response->set_deviceid(deviceId);
+    for (auto& data : histogramList) {
+        MetricsHistogram* histogram = response->add_histogramlist();
+        histogram->set_istiledata(data.isTileData);
+        histogram->set_tileid(data.tileId);
+        histogram->mutable_metricstype()->set_value(data.metricsType);
+        histogram->set_scale(data.scale);
+        histogram->set_count(data.count);
+        histogram->set_sum(data.sum);
+        for (uint32_t j = data.offset; j < data.offset + data.binCount && j < binList.size(); j++) {
+            MetricsHistogramBin* bin = histogram->add_bins();
+            bin->set_upperbound(binList[j].upperBound);
+            bin->set_count(binList[j].count);
+        }
+    }
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::getThrottleResidency(::grpc::ServerContext* context, const ::DeviceId* request, ::XpumGetThrottleResidencyResponse* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    xpum_device_id_t deviceId = request->id();
+    uint32_t count = 0;
+    xpum_result_t res = xpumGetThrottleResidency(deviceId, nullptr, &count);
+    // a tile may be sampled for the first time between the two calls
+    std::vector<xpum_throttle_residency_t> dataList(count + 1);
+    if (res == XPUM_OK) {
+        count = dataList.size();
+        res = xpumGetThrottleResidency(deviceId, dataList.data(), &count);
+    }
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        switch (res) {
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+                response->set_errormsg("Device not found");
+                break;
+            case XPUM_BUFFER_TOO_SMALL:
+                response->set_errormsg("Throttle residency changed during query, please retry");
+                break;
+            default:
+                response->set_errormsg("Error");
+                break;
+        }
+        return grpc::Status::OK;
+    }
+    response->set_deviceid(deviceId);
+    for (uint32_t i = 0; i < count; i++) {
+        auto& data = dataList[i];
+        ThrottleResidency* residency = response->add_datalist();
+        residency->set_istiledata(data.isTileData);
+        residency->set_tileid(data.tileId);
+        residency->set_sampledtime(data.sampledTime);
+        residency->set_throttledtime(data.throttledTime);
+        residency->set_avgpowercaptime(data.avgPowerCapTime);
+        residency->set_burstpowercaptime(data.burstPowerCapTime);
+        residency->set_currentlimittime(data.currentLimitTime);
+        residency->set_thermallimittime(data.thermalLimitTime);
+        residency->set_psualerttime(data.psuAlertTime);
+        residency->set_swrangetime(data.swRangeTime);
+        residency->set_hwrangetime(data.hwRangeTime);
+    }
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::getHostTelemetry(::grpc::ServerContext* context, const ::google::protobuf::Empty* request, ::XpumGetHostTelemetryResponse* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    uint32_t socketCount = 0;
+    uint32_t stackCount = 0;
+    xpum_result_t res = xpumGetHostSocketTelemetry(nullptr, &socketCount);
+    if (res == XPUM_OK) {
+        res = xpumGetHostIioStackTelemetry(nullptr, &stackCount);
+    }
+    std::vector<xpum_host_socket_telemetry_t> sockets(socketCount);
+    std::vector<xpum_host_iio_stack_telemetry_t> stacks(stackCount);
+    if (res == XPUM_OK) {
+        res = xpumGetHostSocketTelemetry(sockets.data(), &socketCount);
+    }
+    if (res == XPUM_OK) {
+        res = xpumGetHostIioStackTelemetry(stacks.data(), &stackCount);
+    }
     response->set_errorno(res);
     if (res != XPUM_OK) {
         switch (res) {
+            case XPUM_METRIC_NOT_ENABLED:
+                response->set_errormsg("Host telemetry is not enabled, set XPUM_HOST_TELEMETRY=1 to enable it");
+                break;
+            case XPUM_METRIC_NOT_SUPPORTED:
+                response->set_errormsg("Host telemetry is not supported on this CPU");
+                break;
+            default:
+                response->set_errormsg("Error");
+                break;
+        }
+        return grpc::Status::OK;
+    }
+    for (uint32_t i = 0; i < socketCount; i++) {
+        auto& data = sockets[i];
+        HostSocketTelemetry* socket = response->add_sockets();
+        socket->set_socketid(data.socketId);
+        socket->set_timestamp(data.timestamp);
+        socket->set_dramreadthroughput(data.dramReadThroughput);
+        socket->set_dramwritethroughput(data.dramWriteThroughput);
+        socket->set_dramread(data.dramRead);
+        socket->set_dramwrite(data.dramWrite);
+        socket->set_upiincomingthroughput(data.upiIncomingThroughput);
+        socket->set_upiincoming(data.upiIncoming);
+        socket->set_upiutilization(data.upiUtilization);
+    }
+    for (uint32_t i = 0; i < stackCount; i++) {
+        auto& data = stacks[i];
+        HostIioStackTelemetry* stack = response->add_stacks();
+        stack->set_socketid(data.socketId);
+        stack->set_stackid(data.stackId);
+        stack->set_timestamp(data.timestamp);
+        stack->set_readthroughput(data.readThroughput);
+        stack->set_writethroughput(data.writeThroughput);
+        stack->set_read(data.read);
+        stack->set_write(data.write);
+    }
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::getMetricsAggregatedByGroup(::grpc::ServerContext* context, const ::GroupId* request, ::XpumGetMetricsAggregatedByGroupResponse* response) {
+    xpum_group_id_t groupId = request->id();
+    uint32_t count = 0;
+    xpum_result_t res = xpumGetMetricsAggregatedByGroup(groupId, nullptr, &count);
+    std::vector<xpum_group_metric_data_t> dataList(count);
+    if (res == XPUM_OK) {
+        res = xpumGetMetricsAggregatedByGroup(groupId, dataList.data(), &count);
+    }
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        switch (res) {
+            case XPUM_RESULT_GROUP_NOT_FOUND:
+                response->set_errormsg("Group not found");
+                break;
             case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
                 response->set_errormsg("Level Zero Initialization Error");
                 break;
             default:
-                response->set_errormsg("Fail to get engine statistics data count");
+                response->set_errormsg("Error");
+                break;
+        }
+        return grpc::Status::OK;
+    }
+    response->set_groupid(groupId);
+    for (uint32_t i = 0; i < count; i++) {
+        GroupMetricData* data = response->add_datalist();
+        data->mutable_metricstype()->set_value(dataList[i].metricsType);
+        data->set_iscounter(dataList[i].isCounter);
+        data->set_timestamp(dataList[i].timestamp);
+        data->set_devicecount(dataList[i].deviceCount);
+        data->set_sum(dataList[i].sum);
+        data->set_avg(dataList[i].avg);
+        data->set_min(dataList[i].min);
+        data->set_max(dataList[i].max);
+        data->set_scale(dataList[i].scale);
+    }
+    return grpc::Status::OK;
+}
+
+static void setJobWindowError(xpum_result_t res, ::XpumJobWindowResponse* response) {
+    switch (res) {
+        case XPUM_RESULT_DEVICE_NOT_FOUND:
+            response->set_errormsg("Device not found");
+            break;
+        case XPUM_RESULT_JOB_WINDOW_EXISTS:
+            response->set_errormsg("Job window already open");
+            break;
+        case XPUM_RESULT_JOB_WINDOW_NOT_FOUND:
+            response->set_errormsg("Job window not found");
+            break;
+        default:
+            response->set_errormsg("Error");
+            break;
+    }
+}
+
+static ::grpc::Status fillJobWindowStats(const std::string& jobId, bool close, ::XpumJobWindowResponse* response) {
+    uint32_t count = 0;
+    xpum_result_t res = xpumGetJobWindowStats(jobId.c_str(), nullptr, &count);
+    std::vector<xpum_job_window_stats_t> dataList(count);
+    // the processes are read before the window is closed
+    uint32_t processCount = 0;
+    std::vector<xpum_job_process_energy_t> processList;
+    if (res == XPUM_OK) {
+        res = xpumGetJobWindowProcessEnergy(jobId.c_str(), nullptr, &processCount);
+    }
+    if (res == XPUM_OK) {
+        processList.resize(processCount);
+        res = xpumGetJobWindowProcessEnergy(jobId.c_str(), processList.data(), &processCount);
+    }
+    if (res == XPUM_OK) {
+        res = close ? xpumCloseJobWindow(jobId.c_str(), dataList.data(), &count) : xpumGetJobWindowStats(jobId.c_str(), dataList.data(), &count);
+    }
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        setJobWindowError(res, response);
+        return grpc::Status::OK;
+    }
+    response->set_jobid(jobId);
+    for (uint32_t i = 0; i < count; i++) {
+        JobWindowDeviceStats* stats = response->add_datalist();
+        stats->set_deviceid(dataList[i].deviceId);
+        stats->set_begin(dataList[i].begin);
+        stats->set_end(dataList[i].end);
+        stats->set_energy(dataList[i].energy);
+        stats->set_avgpower(dataList[i].avgPower);
+        stats->set_peakpower(dataList[i].peakPower);
+        stats->set_avggpuutilization(dataList[i].avgGpuUtilization);
+        stats->set_avgmemoryused(dataList[i].avgMemoryUsed);
+        stats->set_peakmemoryused(dataList[i].peakMemoryUsed);
+        stats->set_memoryusedintegral(dataList[i].memoryUsedIntegral);
+    }
+    for (uint32_t i = 0; i < processCount; i++) {
+        JobWindowProcessEnergy* energy = response->add_processlist();
+        energy->set_deviceid(processList[i].deviceId);
+        energy->set_processid(processList[i].processId);
+        energy->set_processname(processList[i].processName);
+        energy->set_containerid(processList[i].containerId);
+        energy->set_poduid(processList[i].podUid);
+        energy->set_busytime(processList[i].busyTime);
+        energy->set_energy(processList[i].energy);
+    }
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::openJobWindow(::grpc::ServerContext* context, const ::XpumOpenJobWindowRequest* request, ::XpumJobWindowResponse* response) {
+    std::vector<xpum_device_id_t> deviceIds(request->deviceids().begin(), request->deviceids().end());
+    xpum_result_t res = xpumOpenJobWindow(request->jobid().c_str(), deviceIds.data(), deviceIds.size());
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        setJobWindowError(res, response);
+        return grpc::Status::OK;
+    }
+    response->set_jobid(request->jobid());
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::getJobWindowStats(::grpc::ServerContext* context, const ::XpumJobWindowRequest* request, ::XpumJobWindowResponse* response) {
+    return fillJobWindowStats(request->jobid(), false, response);
+}
+
+::grpc::Status XpumCoreServiceImpl::closeJobWindow(::grpc::ServerContext* context, const ::XpumJobWindowRequest* request, ::XpumJobWindowResponse* response) {
+    return fillJobWindowStats(request->jobid(), true, response);
+}
+
+static void setBurstSamplingError(xpum_result_t res, ::XpumBurstSamplingResponse* response) {
+    switch (res) {
+        case XPUM_RESULT_DEVICE_NOT_FOUND:
+            response->set_errormsg("Device not found");
+            break;
+        case XPUM_INTERVAL_INVALID:
+            response->set_errormsg("Invalid burst sampling interval or duration");
+            break;
+        case XPUM_METRIC_NOT_SUPPORTED:
+            response->set_errormsg("Metric not supported by burst sampling");
+            break;
+        case XPUM_RESULT_BURST_SAMPLING_RUNNING:
+            response->set_errormsg("Burst sampling already running");
+            break;
+        case XPUM_RESULT_BURST_SAMPLING_NOT_FOUND:
+            response->set_errormsg("Burst sampling not found");
+            break;
+        default:
+            response->set_errormsg("Error");
+            break;
+    }
+}
+
+::grpc::Status XpumCoreServiceImpl::startBurstSampling(::grpc::ServerContext* context, const ::XpumStartBurstSamplingRequest* request, ::XpumBurstSamplingResponse* response) {
+    std::vector<xpum_stats_type_t> metricsTypes;
+    for (auto& type : request->metricstypes()) {
+        metricsTypes.push_back((xpum_stats_type_t)type.value());
+    }
+    xpum_result_t res = xpumStartBurstSampling(request->deviceid(), metricsTypes.data(), metricsTypes.size(),
+                                               request->interval(), request->duration());
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        setBurstSamplingError(res, response);
+        return grpc::Status::OK;
+    }
+    response->set_deviceid(request->deviceid());
+    response->set_running(true);
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::getBurstSamples(::grpc::ServerContext* context, const ::XpumBurstSamplingRequest* request, ::XpumBurstSamplingResponse* response) {
+    xpum_device_id_t deviceId = request->deviceid();
+    uint32_t count = 0;
+    bool running = false;
+    uint64_t dropped = 0;
+    xpum_result_t res = xpumGetBurstSamples(deviceId, nullptr, &count, nullptr, nullptr);
+    std::vector<xpum_burst_sample_t> samples(count);
+    if (res == XPUM_OK) {
+        res = xpumGetBurstSamples(deviceId, samples.data(), &count, &running, &dropped);
+    }
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        setBurstSamplingError(res, response);
+        return grpc::Status::OK;
+    }
+    response->set_deviceid(deviceId);
+    response->set_running(running);
+    response->set_dropped(dropped);
+    for (uint32_t i = 0; i < count; i++) {
+        auto sample = response->add_samples();
+        sample->set_timestamp(samples[i].timestamp);
+        sample->mutable_metricstype()->set_value(samples[i].metricsType);
+        sample->set_istiledata(samples[i].isTileData);
+        sample->set_tileid(samples[i].tileId);
+        sample->set_value(samples[i].value);
+        sample->set_scale(samples[i].scale);
+    }
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::stopBurstSampling(::grpc::ServerContext* context, const ::XpumBurstSamplingRequest* request, ::XpumBurstSamplingResponse* response) {
+    xpum_result_t res = xpumStopBurstSampling(request->deviceid());
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        setBurstSamplingError(res, response);
+        return grpc::Status::OK;
+    }
+    response->set_deviceid(request->deviceid());
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::getDeviceClockCorrelation(::grpc::ServerContext* context, const ::DeviceId* request, ::XpumClockCorrelationResponse* response) {
+    xpum_clock_correlation_t correlation;
+    xpum_result_t res = xpumGetDeviceClockCorrelation(request->id(), &correlation);
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        switch (res) {
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+                response->set_errormsg("Device not found");
+                break;
+            case XPUM_RESULT_CLOCK_NOT_CORRELATED:
+                response->set_errormsg("The timer of the device can not be read with the host clock");
+                break;
+            default:
+                response->set_errormsg("Error");
+                break;
+        }
+        return grpc::Status::OK;
+    }
+    response->set_deviceid(correlation.deviceId);
+    response->set_devicetimestamp(correlation.deviceTimestamp);
+    response->set_monotonictimestamp(correlation.monotonicTimestamp);
+    response->set_realtimetimestamp(correlation.realtimeTimestamp);
+    response->set_nspertick(correlation.nsPerTick);
+    response->set_driftppm(correlation.driftPpm);
+    response->set_errorns(correlation.errorNs);
+    response->set_validbits(correlation.validBits);
+    response->set_samplecount(correlation.sampleCount);
+    response->set_updatetime(correlation.updateTime);
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::getAppCounterEfficiency(::grpc::ServerContext* context, const ::DeviceId* request, ::XpumAppCounterEfficiencyResponse* response) {
+    uint32_t count = 0;
+    xpum_result_t res = xpumGetAppCounterEfficiency(request->id(), nullptr, &count);
+    std::vector<xpum_app_counter_efficiency_t> dataList(count);
+    if (res == XPUM_OK && count > 0) {
+        res = xpumGetAppCounterEfficiency(request->id(), dataList.data(), &count);
+    }
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        switch (res) {
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+                response->set_errormsg("Device not found");
+                break;
+            default:
+                response->set_errormsg("Error");
                 break;
         }
         return grpc::Status::OK;
     }
-    xpum_device_engine_stats_t dataList[count];
-    res = xpumGetEngineStats(deviceId, dataList, &count, &begin, &end, sessionId);
+    for (uint32_t i = 0; i < count; i++) {
+        AppCounterEfficiency* data = response->add_datalist();
+        data->set_deviceid(dataList[i].deviceId);
+        data->set_processid(dataList[i].processId);
+        data->set_processname(dataList[i].processName);
+        data->set_countername(dataList[i].counterName);
+        data->set_unit(dataList[i].unit);
+        data->set_timestamp(dataList[i].timestamp);
+        data->set_rate(dataList[i].rate);
+        data->set_workperjoule(dataList[i].workPerJoule);
+        data->set_workperutilization(dataList[i].workPerUtilization);
+        data->set_utilization(dataList[i].utilization);
+        data->set_work(dataList[i].work);
+        data->set_energy(dataList[i].energy);
+    }
+    return grpc::Status::OK;
+}
+
+/*
+  Fills dataList with a single core call while the buffer kept from earlier
+  calls is large enough. Only when the core reports XPUM_BUFFER_TOO_SMALL is
+  the count queried and the call repeated with a grown buffer.
+*/
+template <typename T, typename Fill>
+static xpum_result_t fillFromCore(std::vector<T>& dataList, uint32_t& count, Fill fill) {
+    if (dataList.empty()) {
+        dataList.resize(64);
+    }
+    count = dataList.size();
+    xpum_result_t res = fill(dataList.data(), &count);
+    if (res != XPUM_BUFFER_TOO_SMALL) {
+        return res;
+    }
+    // some calls report the size they need, the others are asked for it
+    uint32_t needed = count;
+    if (needed <= dataList.size()) {
+        res = fill(nullptr, &needed);
+        if (res != XPUM_OK) {
+            return res;
+        }
+    }
+    dataList.resize(std::max<size_t>(needed, dataList.size() * 2));
+    count = dataList.size();
+    return fill(dataList.data(), &count);
+}
+
+::grpc::Status XpumCoreServiceImpl::getEngineStatistics(::grpc::ServerContext* context, const ::XpumGetEngineStatsRequest* request, ::XpumGetEngineStatsResponse* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    CachedResponse cached("getEngineStatistics", *request, response);
+    if (cached.isHit()) {
+        return grpc::Status::OK;
+    }
+    xpum_device_id_t deviceId = request->deviceid();
+    uint64_t sessionId = request->sessionid();
+    uint32_t count;
+    uint64_t begin, end;
+    thread_local std::vector<xpum_device_engine_stats_t> dataList;
+    xpum_result_t res = fillFromCore(dataList, count, [&](xpum_device_engine_stats_t* data, uint32_t* n) {
+        return xpumGetEngineStats(deviceId, data, n, &begin, &end, sessionId);
+    });
     response->set_errorno(res);
     if (res != XPUM_OK) {
         switch (res) {
@@ -279,6 +811,7 @@ inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
     }
     response->set_begin(begin);
     response->set_end(end);
+    response->mutable_datalist()->Reserve(count);
     for (uint32_t i = 0; i < count; i++) {
         DeviceEngineStatsInfo* engineStatsInfo = response->add_datalist();
         xpum_device_engine_stats_t& stats = dataList[i];
@@ -314,31 +847,21 @@ inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::getFabricStatistics(::grpc::ServerContext* context, const ::GetFabricStatsRequest* request, ::GetFabricStatsResponse* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    CachedResponse cached("getFabricStatistics", *request, response);
+    if (cached.isHit()) {
+        return grpc::Status::OK;
+    }
     xpum_device_id_t deviceId = request->deviceid();
     uint64_t sessionId = request->sessionid();
     uint32_t count;
     uint64_t begin, end;
-    auto res = xpumGetFabricThroughputStats(deviceId, nullptr, &count, &begin, &end, sessionId);
-    response->set_errorno(res);
-    if (res != XPUM_OK) {
-        switch (res) {
-            case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
-                response->set_errormsg("Level Zero Initialization Error");
-                break;
-            case XPUM_METRIC_NOT_SUPPORTED:
-                response->set_errormsg("Metric not supported");
-                break;
-            case XPUM_METRIC_NOT_ENABLED:
-                response->set_errormsg("Metric not enabled");
-                break;
-            default:
-                response->set_errormsg("Fail to get fabric throughput statistics data count");
-                break;
-        }
-        return grpc::Status::OK;
-    }
-    xpum_device_fabric_throughput_stats_t dataList[count];
-    res = xpumGetFabricThroughputStats(deviceId, dataList, &count, &begin, &end, sessionId);
+    thread_local std::vector<xpum_device_fabric_throughput_stats_t> dataList;
+    auto res = fillFromCore(dataList, count, [&](xpum_device_fabric_throughput_stats_t* data, uint32_t* n) {
+        return xpumGetFabricThroughputStats(deviceId, data, n, &begin, &end, sessionId);
+    });
     response->set_errorno(res);
     if (res != XPUM_OK) {
         switch (res) {
@@ -359,6 +882,7 @@ inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
     }
     response->set_begin(begin);
     response->set_end(end);
+    response->mutable_datalist()->Reserve(count);
     for (uint32_t i = 0; i < count; i++) {
         FabricStatsInfo* fabricStatsInfo = response->add_datalist();
         xpum_device_fabric_throughput_stats_t& stats = dataList[i];
@@ -378,19 +902,24 @@ inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::getFabricStatisticsEx(::grpc::ServerContext* context, const ::GetFabricStatsExRequest* request, ::GetFabricStatsResponse* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    CachedResponse cached("getFabricStatisticsEx", *request, response);
+    if (cached.isHit()) {
+        return grpc::Status::OK;
+    }
     std::vector<xpum_device_id_t> deviceIdList;
     for (auto deviceId : request->deviceidlist()) {
         deviceIdList.push_back(deviceId);
     }
     uint64_t sessionId = request->sessionid();
-    uint32_t count = deviceIdList.size() * 32;
-    std::vector<xpum_device_fabric_throughput_stats_t> dataList(count);
+    uint32_t count;
     uint64_t begin, end;
-    auto res = xpumGetFabricThroughputStatsEx(deviceIdList.data(), deviceIdList.size(), dataList.data(), &count, &begin, &end, sessionId);
-    if (res == XPUM_BUFFER_TOO_SMALL) {
-        dataList.reserve(count);
-        res = xpumGetFabricThroughputStatsEx(deviceIdList.data(), deviceIdList.size(), dataList.data(), &count, &begin, &end, sessionId);
-    }
+    thread_local std::vector<xpum_device_fabric_throughput_stats_t> dataList;
+    auto res = fillFromCore(dataList, count, [&](xpum_device_fabric_throughput_stats_t* data, uint32_t* n) {
+        return xpumGetFabricThroughputStatsEx(deviceIdList.data(), deviceIdList.size(), data, n, &begin, &end, sessionId);
+    });
     response->set_errorno(res);
     if (res != XPUM_OK) {
         switch (res) {
@@ -411,6 +940,7 @@ inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
     }
     response->set_begin(begin);
     response->set_end(end);
+    response->mutable_datalist()->Reserve(count);
     for (uint32_t i = 0; i < count; i++) {
         FabricStatsInfo* fabricStatsInfo = response->add_datalist();
         xpum_device_fabric_throughput_stats_t& stats = dataList[i];
@@ -429,6 +959,364 @@ inline bool metricsTypeAllowList(xpum_stats_type_t metricsType) {
     return grpc::Status::OK;
 }
 
+::grpc::Status XpumCoreServiceImpl::getStatisticsBulk(::grpc::ServerContext* context, const ::XpumGetStatsBulkRequest* request, ::XpumGetStatsBulkResponse* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    if (request->compress()) {
+        context->set_compression_algorithm(GRPC_COMPRESS_GZIP);
+    }
+    CachedResponse cached("getStatisticsBulk", *request, response);
+    if (cached.isHit()) {
+        return grpc::Status::OK;
+    }
+    std::vector<xpum_device_id_t> deviceIdList(request->deviceidlist().begin(), request->deviceidlist().end());
+    std::vector<xpum_device_stats_t> stats;
+    std::vector<xpum_device_engine_stats_t> engineStats;
+    std::vector<xpum_device_fabric_throughput_stats_t> fabricStats;
+    std::vector<DerivedStats> derivedStats;
+    uint64_t begin, end;
+    xpum_result_t res = xpumGetStatsBulk(deviceIdList.data(), deviceIdList.size(), stats, engineStats, fabricStats, derivedStats, &begin, &end, request->sessionid());
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        switch (res) {
+            case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
+                response->set_errormsg("Level Zero Initialization Error");
+                break;
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+                response->set_errormsg("Device not found");
+                break;
+            case XPUM_UNSUPPORTED_SESSIONID:
+                response->set_errormsg("Unsupported session id");
+                break;
+            default:
+                response->set_errormsg("Fail to get statistics");
+                break;
+        }
+        return grpc::Status::OK;
+    }
+    response->set_begin(begin);
+    response->set_end(end);
+    for (auto& data : stats) {
+        DeviceStatsInfo* deviceStatsInfo = response->add_datalist();
+        deviceStatsInfo->set_deviceid(data.deviceId);
+        deviceStatsInfo->set_istiledata(data.isTileData);
+        deviceStatsInfo->set_tileid(data.tileId);
+        deviceStatsInfo->set_count(data.count);
+        for (int j = 0; j < data.count; j++) {
+            xpum_device_stats_data_t& statsData = data.dataList[j];
+            if (request->enablefilter() && !metricsTypeAllowList(statsData.metricsType))
+                continue;
+            DeviceStatsData* deviceStatsData = deviceStatsInfo->add_datalist();
+            deviceStatsData->mutable_metricstype()->set_value(statsData.metricsType);
+            deviceStatsData->set_iscounter(statsData.isCounter);
+            deviceStatsData->set_value(statsData.value);
+            deviceStatsData->set_min(statsData.min);
+            deviceStatsData->set_avg(statsData.avg);
+            deviceStatsData->set_max(statsData.max);
+            deviceStatsData->set_p50(statsData.p50);
+            deviceStatsData->set_p90(statsData.p90);
+            deviceStatsData->set_p99(statsData.p99);
+            deviceStatsData->set_accumulated(statsData.accumulated);
+            deviceStatsData->set_scale(statsData.scale);
+        }
+    }
+    for (auto& data : engineStats) {
+        DeviceEngineStatsInfo* engineStatsInfo = response->add_enginedatalist();
+        engineStatsInfo->set_deviceid(data.deviceId);
+        engineStatsInfo->set_istiledata(data.isTileData);
+        engineStatsInfo->set_tileid(data.tileId);
+        engineStatsInfo->set_engineid(data.index);
+        engineStatsInfo->set_enginetype(data.type);
+        engineStatsInfo->set_value(data.value);
+        engineStatsInfo->set_min(data.min);
+        engineStatsInfo->set_avg(data.avg);
+        engineStatsInfo->set_max(data.max);
+        engineStatsInfo->set_scale(data.scale);
+    }
+    for (auto& data : fabricStats) {
+        FabricStatsInfo* fabricStatsInfo = response->add_fabricdatalist();
+        fabricStatsInfo->set_tileid(data.tile_id);
+        fabricStatsInfo->set_remote_device_id(data.remote_device_id);
+        fabricStatsInfo->set_remote_device_tile_id(data.remote_device_tile_id);
+        fabricStatsInfo->set_type(data.type);
+        fabricStatsInfo->set_value(data.value);
+        fabricStatsInfo->set_min(data.min);
+        fabricStatsInfo->set_avg(data.avg);
+        fabricStatsInfo->set_max(data.max);
+        fabricStatsInfo->set_scale(data.scale);
+        fabricStatsInfo->set_accumulated(data.accumulated);
+        fabricStatsInfo->set_deviceid(data.deviceId);
+    }
+    for (auto& data : derivedStats) {
+        DerivedStatsInfo* derivedStatsInfo = response->add_deriveddatalist();
+        derivedStatsInfo->set_iscard(data.isCard);
+        derivedStatsInfo->set_id(data.id);
+        derivedStatsInfo->mutable_metricstype()->set_value(data.metricsType);
+        derivedStatsInfo->set_isaccumulated(data.isAccumulated);
+        derivedStatsInfo->set_issum(data.isSum);
+        derivedStatsInfo->set_value(data.value);
+        derivedStatsInfo->set_scale(data.scale);
+    }
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::getTelemetrySnapshot(::grpc::ServerContext* context, const ::XpumGetTelemetrySnapshotRequest* request, ::XpumGetTelemetrySnapshotResponse* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    if (request->compress()) {
+        context->set_compression_algorithm(GRPC_COMPRESS_GZIP);
+    }
+    CachedResponse cached("getTelemetrySnapshot", *request, response);
+    if (cached.isHit()) {
+        return grpc::Status::OK;
+    }
+    std::vector<xpum_device_id_t> deviceIdList(request->deviceidlist().begin(), request->deviceidlist().end());
+    uint32_t size = 0;
+    xpum_result_t res = xpumGetTelemetrySnapshot(deviceIdList.data(), deviceIdList.size(), nullptr, &size, request->sessionid());
+    if (res == XPUM_OK) {
+        // the snapshot is written into the response as is
+        std::string* snapshot = response->mutable_snapshot();
+        snapshot->resize(size);
+        res = xpumGetTelemetrySnapshot(deviceIdList.data(), deviceIdList.size(), &(*snapshot)[0], &size, request->sessionid());
+        snapshot->resize(res == XPUM_OK ? size : 0);
+    }
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        switch (res) {
+            case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
+                response->set_errormsg("Level Zero Initialization Error");
+                break;
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+                response->set_errormsg("Device not found");
+                break;
+            case XPUM_UNSUPPORTED_SESSIONID:
+                response->set_errormsg("Unsupported session id");
+                break;
+            default:
+                response->set_errormsg("Fail to get statistics");
+                break;
+        }
+    }
+    return grpc::Status::OK;
+}
+
+// the metrics of the packed statistics by bit, in the order of xpum_stats_type_t; the id changes with the metrics
+static_assert(XPUM_STATS_MAX <= 64, "the packed statistics masks hold 64 metrics");
+
+static const uint32_t PACKED_STATS_SCHEMA_ID = (1 << 16) | XPUM_STATS_MAX;
+
+::grpc::Status XpumCoreServiceImpl::getStatisticsPacked(::grpc::ServerContext* context, const ::XpumGetPackedStatsRequest* request, ::XpumGetPackedStatsResponse* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    if (request->compress()) {
+        context->set_compression_algorithm(GRPC_COMPRESS_GZIP);
+    }
+    CachedResponse cached("getStatisticsPacked", *request, response);
+    if (cached.isHit()) {
+        return grpc::Status::OK;
+    }
+    response->set_schemaid(PACKED_STATS_SCHEMA_ID);
+    if (request->schemaid() != PACKED_STATS_SCHEMA_ID) {
+        auto schema = response->mutable_schema();
+        schema->set_schemaid(PACKED_STATS_SCHEMA_ID);
+        for (int type = 0; type < XPUM_STATS_MAX; type++) {
+            schema->add_metricstypes()->set_value(type);
+        }
+    }
+    std::vector<xpum_device_id_t> deviceIdList(request->deviceidlist().begin(), request->deviceidlist().end());
+    if (deviceIdList.empty()) {
+        int count{XPUM_MAX_NUM_DEVICES};
+        xpum_device_basic_info devices[XPUM_MAX_NUM_DEVICES];
+        if (xpumGetDeviceList(devices, &count) == XPUM_OK) {
+            for (int i = 0; i < count; i++) {
+                deviceIdList.push_back(devices[i].deviceId);
+            }
+        }
+    }
+    uint32_t count = 0;
+    uint64_t begin, end;
+    std::vector<xpum_device_stats_t> stats;
+    xpum_result_t res = xpumGetStatsEx(deviceIdList.data(), deviceIdList.size(), nullptr, &count, &begin, &end, request->sessionid());
+    if (res == XPUM_OK) {
+        stats.resize(count);
+        res = xpumGetStatsEx(deviceIdList.data(), deviceIdList.size(), stats.data(), &count, &begin, &end, request->sessionid());
+    }
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        switch (res) {
+            case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
+                response->set_errormsg("Level Zero Initialization Error");
+                break;
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+                response->set_errormsg("Device not found");
+                break;
+            case XPUM_UNSUPPORTED_SESSIONID:
+                response->set_errormsg("Unsupported session id");
+                break;
+            default:
+                response->set_errormsg("Fail to get statistics");
+                break;
+        }
+        return grpc::Status::OK;
+    }
+    response->set_begin(begin);
+    response->set_end(end);
+    for (uint32_t i = 0; i < count; i++) {
+        auto& data = stats[i];
+        // the values are in the order of the schema, whatever order the statistics come in
+        const xpum_device_stats_data_t* byType[XPUM_STATS_MAX] = {};
+        for (int j = 0; j < data.count; j++) {
+            if (data.dataList[j].metricsType < XPUM_STATS_MAX) {
+                byType[data.dataList[j].metricsType] = &data.dataList[j];
+            }
+        }
+        PackedStatsRecord* record = response->add_records();
+        record->set_deviceid(data.deviceId);
+        record->set_tileid(data.isTileData ? data.tileId : -1);
+        uint64_t presentMask = 0;
+        uint64_t counterMask = 0;
+        for (int type = 0; type < XPUM_STATS_MAX; type++) {
+            const xpum_device_stats_data_t* statsData = byType[type];
+            if (statsData == nullptr) {
+                continue;
+            }
+            presentMask |= 1ULL << type;
+            record->add_scale(statsData->scale);
+            record->add_value(statsData->value);
+            if (statsData->isCounter) {
+                counterMask |= 1ULL << type;
+                record->add_accumulated(statsData->accumulated);
+            } else {
+                record->add_min(statsData->min);
+                record->add_avg(statsData->avg);
+                record->add_max(statsData->max);
+                record->add_p50(statsData->p50);
+                record->add_p90(statsData->p90);
+                record->add_p99(statsData->p99);
+            }
+        }
+        record->set_presentmask(presentMask);
+        record->set_countermask(counterMask);
+    }
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::subscribeMetrics(::grpc::ServerContext* context, const ::XpumSubscribeMetricsRequest* request, ::grpc::ServerWriter<MetricsFrame>* writer) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::STREAMING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
+    const std::chrono::milliseconds minInterval(100);
+    // the longest wait before checking if the daemon stops or the client goes away
+    const uint32_t pollTimeout = 500;
+
+    std::vector<xpum_device_id_t> deviceIdList(request->deviceidlist().begin(), request->deviceidlist().end());
+    if (deviceIdList.empty()) {
+        int count{XPUM_MAX_NUM_DEVICES};
+        xpum_device_basic_info devices[XPUM_MAX_NUM_DEVICES];
+        if (xpumGetDeviceList(devices, &count) == XPUM_OK) {
+            for (int i = 0; i < count; i++) {
+                deviceIdList.push_back(devices[i].deviceId);
+            }
+        }
+    }
+    for (auto deviceId : deviceIdList) {
+        xpum_result_t res = validateDeviceId(deviceId);
+        if (res != XPUM_OK) {
+            MetricsFrame frame;
+            frame.set_errorno(res);
+            frame.set_errormsg("Device not found");
+            writer->Write(frame);
+            return grpc::Status::OK;
+        }
+    }
+    std::set<xpum_stats_type_t> metricsTypes;
+    for (auto& metricsType : request->metricstypes()) {
+        metricsTypes.insert(static_cast<xpum_stats_type_t>(metricsType.value()));
+    }
+    auto interval = std::max(std::chrono::milliseconds(request->interval()), minInterval);
+
+    // the last value sent for each device, tile and metric, only changed values are sent again
+    std::map<std::tuple<xpum_device_id_t, int32_t, xpum_stats_type_t>, uint64_t> sentValues;
+    uint64_t generation = 0;
+    uint64_t sentGeneration = 0;
+    bool keyFrame = true;
+    std::chrono::steady_clock::time_point lastFrame;
+    std::vector<xpum_device_metrics_t> dataList;
+    // no device is read for the frames of the updates only
+    const std::vector<xpum_device_id_t> noDevices;
+    const std::vector<xpum_device_id_t>& readDevices = request->updatesonly() ? noDevices : deviceIdList;
+    while (!this->stop && !context->IsCancelled()) {
+        xpumWaitForMetricsUpdate(&generation, pollTimeout);
+        if (generation == sentGeneration) {
+            continue;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (!keyFrame && now - lastFrame < interval) {
+            std::this_thread::sleep_for(std::min(std::chrono::duration_cast<std::chrono::milliseconds>(interval - (now - lastFrame)),
+                                                 std::chrono::milliseconds(pollTimeout)));
+            continue;
+        }
+
+        // the frame and all its data entries come from one arena, freed at once after the write
+        google::protobuf::Arena arena;
+        MetricsFrame& frame = *google::protobuf::Arena::CreateMessage<MetricsFrame>(&arena);
+        frame.set_keyframe(keyFrame);
+        for (auto deviceId : readDevices) {
+            int count = 0;
+            if (xpumGetMetrics(deviceId, nullptr, &count) != XPUM_OK || count <= 0) {
+                continue;
+            }
+            if (dataList.size() < static_cast<size_t>(count)) {
+                dataList.resize(count);
+            }
+            if (xpumGetMetrics(deviceId, dataList.data(), &count) != XPUM_OK) {
+                continue;
+            }
+            for (int i = 0; i < count; i++) {
+                xpum_device_metrics_t& metrics = dataList[i];
+                int32_t tileId = metrics.isTileData ? metrics.tileId : -1;
+                for (int j = 0; j < metrics.count; j++) {
+                    xpum_device_metric_data_t& data = metrics.dataList[j];
+                    if (!metricsTypes.empty() && metricsTypes.find(data.metricsType) == metricsTypes.end()) {
+                        continue;
+                    }
+                    auto key = std::make_tuple(deviceId, tileId, data.metricsType);
+                    auto iter = sentValues.find(key);
+                    if (!keyFrame && iter != sentValues.end() && iter->second == data.value) {
+                        continue;
+                    }
+                    sentValues[key] = data.value;
+                    MetricsFrameData* frameData = frame.add_datalist();
+                    frameData->set_deviceid(deviceId);
+                    frameData->set_istiledata(metrics.isTileData);
+                    frameData->set_tileid(metrics.tileId);
+                    frameData->mutable_metricstype()->set_value(data.metricsType);
+                    frameData->set_iscounter(data.isCounter);
+                    frameData->set_value(data.value);
+                    frameData->set_scale(data.scale);
+                    frameData->set_timestamp(data.timestamp);
+                }
+            }
+        }
+        sentGeneration = generation;
+        lastFrame = now;
+        if (!keyFrame && frame.datalist_size() == 0 && !request->updatesonly()) {
+            continue;
+        }
+        keyFrame = false;
+        frame.set_timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        frame.set_errorno(XPUM_OK);
+        if (!writer->Write(frame)) {
+            break;
+        }
+    }
+    return grpc::Status::OK;
+}
+
 ::grpc::Status XpumCoreServiceImpl::getFabricCount(::grpc::ServerContext* context, const ::GetFabricCountRequest* request, ::GetFabricCountResponse* response) {
     xpum_device_id_t deviceId = request->deviceid();
     auto fabricCountInfo = getDeviceAndTileFabricCount(deviceId);
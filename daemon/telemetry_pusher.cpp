@@ -0,0 +1,391 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file telemetry_pusher.cpp
+ */
+
+#include "telemetry_pusher.h"
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "internal_api.h"
+#include "logger.h"
+#include "xpum_api.h"
+
+namespace xpum::daemon {
+
+namespace {
+
+const uint32_t batch_magic = 0x50545058;
+
+const uint16_t batch_version = 1;
+
+const char* spool_prefix = "xpum-push-";
+
+uint64_t nowMillisecond() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+template <typename T>
+void putInt(std::string& out, T value) {
+    for (size_t i = 0; i < sizeof(T); i++) {
+        out += (char)(((uint64_t)value >> (i * 8)) & 0xff);
+    }
+}
+
+bool fits(int64_t value, int bits) {
+    int64_t limit = (int64_t)1 << (bits - 1);
+    return value >= -limit && value < limit;
+}
+
+} // namespace
+
+void TelemetryPusher::BitWriter::write(uint64_t value, int bits) {
+    while (bits > 0) {
+        if (free_bits == 0) {
+            buffer += '\0';
+            free_bits = 8;
+        }
+        int n = std::min(bits, free_bits);
+        uint64_t chunk = (value >> (bits - n)) & ((1ull << n) - 1);
+        buffer.back() = (char)((uint8_t)buffer.back() | (chunk << (free_bits - n)));
+        free_bits -= n;
+        bits -= n;
+    }
+}
+
+void TelemetryPusher::Series::append(uint64_t timestamp, uint64_t value) {
+    if (count == 0) {
+        bits.write(timestamp, 64);
+        bits.write(value, 64);
+        last_timestamp = timestamp;
+        last_value = value;
+        count = 1;
+        return;
+    }
+
+    int64_t delta = (int64_t)(timestamp - last_timestamp);
+    int64_t dod = delta - last_delta;
+    if (dod == 0) {
+        bits.write(0, 1);
+    } else if (fits(dod, 7)) {
+        bits.write(0x2, 2);
+        bits.write((uint64_t)dod, 7);
+    } else if (fits(dod, 9)) {
+        bits.write(0x6, 3);
+        bits.write((uint64_t)dod, 9);
+    } else if (fits(dod, 12)) {
+        bits.write(0xe, 4);
+        bits.write((uint64_t)dod, 12);
+    } else {
+        bits.write(0xf, 4);
+        bits.write((uint64_t)dod, 64);
+    }
+
+    uint64_t x = value ^ last_value;
+    if (x == 0) {
+        bits.write(0, 1);
+    } else {
+        int lead = __builtin_clzll(x);
+        int trail = __builtin_ctzll(x);
+        if (leading >= 0 && lead >= leading && trail >= trailing) {
+            bits.write(0x2, 2);
+            bits.write(x >> trailing, 64 - leading - trailing);
+        } else {
+            int meaningful = 64 - lead - trail;
+            bits.write(0x3, 2);
+            bits.write(lead, 6);
+            bits.write(meaningful - 1, 6);
+            bits.write(x >> trail, meaningful);
+            leading = lead;
+            trailing = trail;
+        }
+    }
+    last_timestamp = timestamp;
+    last_delta = delta;
+    last_value = value;
+    count++;
+}
+
+TelemetryPusher::TelemetryPusher(const std::string& endpoint, uint32_t interval, const std::string& spoolFolder)
+    : port(0), interval(interval), spool_folder(spoolFolder), spool_sequence(0), fd(-1), connected_before(false), stopping(false) {
+    auto pos = endpoint.rfind(':');
+    if (pos != std::string::npos) {
+        address = endpoint.substr(0, pos);
+        port = atoi(endpoint.c_str() + pos + 1);
+    }
+}
+
+TelemetryPusher::~TelemetryPusher() {
+    stop();
+}
+
+bool TelemetryPusher::start() {
+    sockaddr_in addr{};
+    if (port <= 0 || port > 65535 || inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        XPUM_LOG_ERROR("XPUM: invalid telemetry push endpoint {}:{}", address, port);
+        return false;
+    }
+    if (!spool_folder.empty() && mkdir(spool_folder.c_str(), S_IRWXU) < 0 && errno != EEXIST) {
+        XPUM_LOG_ERROR("XPUM: failed to create telemetry spool folder {}: {}", spool_folder, strerror(errno));
+        return false;
+    }
+    stopping = false;
+    worker = std::thread(&TelemetryPusher::run, this);
+    XPUM_LOG_INFO("XPUM: telemetry is pushed to {}:{} every {} seconds", address, port, interval);
+    return true;
+}
+
+void TelemetryPusher::stop() {
+    stopping = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+void TelemetryPusher::run() {
+    // the longest wait before checking if the pusher stops
+    const uint32_t pollTimeout = 500;
+    uint64_t generation = 0;
+    uint64_t collected = 0;
+    uint64_t next_push = nowMillisecond() + interval * 1000ull;
+    while (!stopping) {
+        xpumWaitForMetricsUpdate(&generation, pollTimeout);
+        if (generation != collected) {
+            collected = generation;
+            collect();
+        }
+        uint64_t now = nowMillisecond();
+        if (now >= next_push) {
+            next_push = now + interval * 1000ull;
+            if (!series.empty()) {
+                push(finishBatch());
+            }
+        }
+    }
+    // the samples since the last push are sent or spooled before exit
+    if (!series.empty()) {
+        push(finishBatch());
+    }
+}
+
+void TelemetryPusher::collect() {
+    int device_count = XPUM_MAX_NUM_DEVICES;
+    xpum_device_basic_info device_list[XPUM_MAX_NUM_DEVICES];
+    if (xpumGetDeviceList(device_list, &device_count) != XPUM_OK) {
+        return;
+    }
+    std::vector<xpum_device_metrics_t> metrics;
+    for (int d = 0; d < device_count; d++) {
+        xpum_device_id_t deviceId = device_list[d].deviceId;
+        int count = 0;
+        if (xpumGetMetrics(deviceId, nullptr, &count) != XPUM_OK || count <= 0) {
+            continue;
+        }
+        metrics.resize(count);
+        if (xpumGetMetrics(deviceId, metrics.data(), &count) != XPUM_OK) {
+            continue;
+        }
+        for (int i = 0; i < count; i++) {
+            auto& data = metrics[i];
+            for (int j = 0; j < data.count; j++) {
+                auto& metric = data.dataList[j];
+                SeriesKey key((uint32_t)deviceId, data.isTileData ? data.tileId : -1, (uint32_t)metric.metricsType);
+                auto& s = series[key];
+                // a metric not sampled again since the last update keeps its timestamp
+                if (s.count > 0 && metric.timestamp <= s.last_timestamp) {
+                    continue;
+                }
+                s.scale = metric.scale;
+                s.is_counter = metric.isCounter;
+                s.append(metric.timestamp, metric.value);
+            }
+        }
+    }
+}
+
+std::string TelemetryPusher::finishBatch() {
+    std::string frame;
+    putInt<uint32_t>(frame, 0);
+    putInt<uint32_t>(frame, batch_magic);
+    putInt<uint16_t>(frame, batch_version);
+    putInt<uint16_t>(frame, 0);
+    putInt<uint64_t>(frame, nowMillisecond());
+    putInt<uint32_t>(frame, series.size());
+    for (auto& item : series) {
+        auto& s = item.second;
+        putInt<uint32_t>(frame, std::get<0>(item.first));
+        putInt<int32_t>(frame, std::get<1>(item.first));
+        putInt<uint32_t>(frame, std::get<2>(item.first));
+        putInt<uint32_t>(frame, s.scale);
+        putInt<uint8_t>(frame, s.is_counter ? 1 : 0);
+        putInt<uint32_t>(frame, s.count);
+        putInt<uint32_t>(frame, s.bits.bytes().size());
+        frame += s.bits.bytes();
+    }
+    uint32_t length = frame.size() - sizeof(uint32_t);
+    for (size_t i = 0; i < sizeof(uint32_t); i++) {
+        frame[i] = (char)((length >> (i * 8)) & 0xff);
+    }
+    series.clear();
+    return frame;
+}
+
+void TelemetryPusher::push(const std::string& frame) {
+    if (connectCollector() && replaySpool() && sendFrame(frame)) {
+        return;
+    }
+    spool(frame);
+}
+
+bool TelemetryPusher::connectCollector() {
+    if (fd >= 0) {
+        return true;
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, address.c_str(), &addr.sin_addr);
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    // a collector that stops reading does not block the monitor updates
+    timeval timeout{5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        if (connected_before) {
+            XPUM_LOG_WARN("XPUM: telemetry collector {}:{} is not reachable: {}", address, port, strerror(errno));
+            connected_before = false;
+        }
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    if (!connected_before) {
+        XPUM_LOG_INFO("XPUM: connected to telemetry collector {}:{}", address, port);
+        connected_before = true;
+    }
+    return true;
+}
+
+bool TelemetryPusher::sendFrame(const std::string& frame) {
+    size_t sent = 0;
+    while (sent < frame.size()) {
+        ssize_t n = send(fd, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            XPUM_LOG_WARN("XPUM: failed to push telemetry to {}:{}: {}", address, port, strerror(errno));
+            close(fd);
+            fd = -1;
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+void TelemetryPusher::spool(const std::string& frame) {
+    if (spool_folder.empty()) {
+        return;
+    }
+    // the names sort in the order the batches are spooled
+    char name[64];
+    snprintf(name, sizeof(name), "%s%020llu-%06llu.bin", spool_prefix,
+             (unsigned long long)nowMillisecond(), (unsigned long long)(spool_sequence++ % 1000000));
+    std::string path = spool_folder + "/" + name;
+    std::ofstream out(path, std::ios::binary);
+    out.write(frame.data(), frame.size());
+    out.close();
+    if (!out) {
+        XPUM_LOG_WARN("XPUM: failed to spool telemetry batch to {}", path);
+        unlink(path.c_str());
+        return;
+    }
+
+    // the oldest batches are dropped when the spool is full
+    std::vector<std::pair<std::string, uint64_t>> files;
+    uint64_t total = 0;
+    DIR* dir = opendir(spool_folder.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (strncmp(entry->d_name, spool_prefix, strlen(spool_prefix)) != 0) {
+            continue;
+        }
+        struct stat st;
+        std::string file = spool_folder + "/" + entry->d_name;
+        if (stat(file.c_str(), &st) == 0) {
+            files.emplace_back(file, st.st_size);
+            total += st.st_size;
+        }
+    }
+    closedir(dir);
+    std::sort(files.begin(), files.end());
+    for (auto& file : files) {
+        if (total <= max_spool_bytes) {
+            break;
+        }
+        unlink(file.first.c_str());
+        total -= file.second;
+        XPUM_LOG_WARN("XPUM: telemetry spool is full, {} is dropped", file.first);
+    }
+}
+
+bool TelemetryPusher::replaySpool() {
+    if (spool_folder.empty()) {
+        return true;
+    }
+    std::vector<std::string> files;
+    DIR* dir = opendir(spool_folder.c_str());
+    if (dir == nullptr) {
+        return true;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (strncmp(entry->d_name, spool_prefix, strlen(spool_prefix)) == 0) {
+            files.push_back(spool_folder + "/" + entry->d_name);
+        }
+    }
+    closedir(dir);
+    std::sort(files.begin(), files.end());
+    for (auto& file : files) {
+        std::ifstream in(file, std::ios::binary);
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        std::string frame = buffer.str();
+        if (!frame.empty() && !sendFrame(frame)) {
+            return false;
+        }
+        unlink(file.c_str());
+    }
+    if (!files.empty()) {
+        XPUM_LOG_INFO("XPUM: {} spooled telemetry batches are pushed to {}:{}", files.size(), address, port);
+    }
+    return true;
+}
+
+} // end namespace xpum::daemon
@@ -0,0 +1,149 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file telemetry_pusher.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <tuple>
+
+#include "xpum_structs.h"
+
+namespace xpum::daemon {
+
+/*
+  TelemetryPusher pushes the metrics of all devices and tiles to a central
+  collector over TCP, in one batch per push interval. Every monitor update
+  is appended to the series of its device, tile and metric type, and the
+  samples of a series are compressed like Gorilla: the timestamps as the
+  delta of their deltas and the values as the XOR with the value before, so
+  a series sampled at a fixed interval with slowly changing values costs a
+  few bits per sample.
+
+  A batch is one frame on the connection, all integers are little endian:
+
+    uint32  length of the rest of the frame
+    uint32  magic, "XPTP"
+    uint16  version, 1
+    uint16  reserved
+    uint64  timestamp of the batch in ms
+    uint32  count of series
+    series:
+      uint32  device id
+      int32   tile id, -1 for the device
+      uint32  metric type, xpum_stats_type_t
+      uint32  scale of the values
+      uint8   1 if the metric is a counter
+      uint32  count of samples
+      uint32  length of the bit stream in bytes
+      bytes   bit stream, from the highest bit of each byte
+
+  The bit stream begins with the first timestamp and value in 64 bits each.
+  The timestamp of each next sample is the delta of delta D from the
+  delta before, which is 0 for the second sample:
+    '0' if D is 0, '10' and 7 bits, '110' and 9 bits, '1110' and 12 bits
+    of D in two's complement, or '1111' and 64 bits
+  and its value is the XOR X with the value before:
+    '0' if X is 0, '10' and the bits of X in the window of the value
+    before, or '11', 6 bits of the leading zeros, 6 bits of the length of
+    the meaningful bits minus 1 and the meaningful bits of X
+
+  Every batch starts its series again, so a batch is decoded without the
+  batches before. When the collector is not reachable, the batches are
+  written to the spool folder, up to max_spool_bytes, and sent oldest first
+  when the connection is back.
+*/
+
+class TelemetryPusher {
+   public:
+    // endpoint is "IPv4 address:port", the spool folder may be empty
+    TelemetryPusher(const std::string& endpoint, uint32_t interval, const std::string& spoolFolder);
+
+    ~TelemetryPusher();
+
+    bool start();
+
+    void stop();
+
+   private:
+    class BitWriter {
+       public:
+        void write(uint64_t value, int bits);
+
+        const std::string& bytes() const {
+            return buffer;
+        }
+
+       private:
+        std::string buffer;
+
+        int free_bits = 0;
+    };
+
+    struct Series {
+        uint32_t scale = 1;
+        bool is_counter = false;
+        uint32_t count = 0;
+        uint64_t last_timestamp = 0;
+        int64_t last_delta = 0;
+        uint64_t last_value = 0;
+        int leading = -1;
+        int trailing = 0;
+        BitWriter bits;
+
+        void append(uint64_t timestamp, uint64_t value);
+    };
+
+    // device id, tile id and metric type
+    typedef std::tuple<uint32_t, int32_t, uint32_t> SeriesKey;
+
+    void run();
+
+    void collect();
+
+    // serialize the series into a frame and clear them
+    std::string finishBatch();
+
+    void push(const std::string& frame);
+
+    bool connectCollector();
+
+    bool sendFrame(const std::string& frame);
+
+    void spool(const std::string& frame);
+
+    // send the spooled batches oldest first, false if a send fails
+    bool replaySpool();
+
+    // the max size of the spool folder
+    static const uint64_t max_spool_bytes = 64 * 1024 * 1024;
+
+    std::string address;
+
+    int port;
+
+    // the push interval in seconds
+    uint32_t interval;
+
+    std::string spool_folder;
+
+    uint64_t spool_sequence;
+
+    int fd;
+
+    bool connected_before;
+
+    std::map<SeriesKey, Series> series;
+
+    std::atomic<bool> stopping;
+
+    std::thread worker;
+};
+
+} // end namespace xpum::daemon
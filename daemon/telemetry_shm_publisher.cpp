@@ -0,0 +1,201 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file telemetry_shm_publisher.cpp
+ */
+
+#include "telemetry_shm_publisher.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "internal_api.h"
+#include "logger.h"
+#include "xpum_api.h"
+#include "xpum_structs.h"
+
+namespace xpum::daemon {
+
+TelemetryShmPublisher::TelemetryShmPublisher() : header(nullptr), size(0), stopping(false) {
+}
+
+TelemetryShmPublisher::~TelemetryShmPublisher() {
+    stop();
+}
+
+bool TelemetryShmPublisher::start() {
+    std::size_t pcieOffset = sizeof(xpum_telemetry_shm_header_t) + sizeof(xpum_telemetry_shm_entry_t) * XPUM_TELEMETRY_SHM_MAX_ENTRIES;
+    size = pcieOffset + sizeof(xpum_telemetry_shm_pcie_entry_t) * XPUM_TELEMETRY_SHM_MAX_PCIE_ENTRIES;
+    // a segment left by a daemon that did not stop cleanly is replaced
+    shm_unlink(XPUM_TELEMETRY_SHM_NAME);
+    int fd = shm_open(XPUM_TELEMETRY_SHM_NAME, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd < 0) {
+        XPUM_LOG_ERROR("XPUM: failed to create telemetry shared memory: {}", strerror(errno));
+        return false;
+    }
+    // shm_open applies the umask, readers only need read access
+    fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (ftruncate(fd, size) < 0) {
+        XPUM_LOG_ERROR("XPUM: failed to size telemetry shared memory: {}", strerror(errno));
+        close(fd);
+        shm_unlink(XPUM_TELEMETRY_SHM_NAME);
+        return false;
+    }
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        XPUM_LOG_ERROR("XPUM: failed to map telemetry shared memory: {}", strerror(errno));
+        shm_unlink(XPUM_TELEMETRY_SHM_NAME);
+        return false;
+    }
+    header = static_cast<xpum_telemetry_shm_header_t*>(addr);
+    header->version = XPUM_TELEMETRY_SHM_VERSION;
+    header->headerSize = sizeof(xpum_telemetry_shm_header_t);
+    header->entrySize = sizeof(xpum_telemetry_shm_entry_t);
+    header->maxEntries = XPUM_TELEMETRY_SHM_MAX_ENTRIES;
+    header->entryCount = 0;
+    header->sequence = 0;
+    header->timestamp = 0;
+    header->pcieOffset = pcieOffset;
+    header->pcieEntrySize = sizeof(xpum_telemetry_shm_pcie_entry_t);
+    header->maxPcieEntries = XPUM_TELEMETRY_SHM_MAX_PCIE_ENTRIES;
+    header->pcieEntryCount = 0;
+    // the layout fields must be visible before a reader accepts the magic
+    __atomic_store_n(&header->magic, XPUM_TELEMETRY_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    stopping = false;
+    worker = std::thread(&TelemetryShmPublisher::publish, this);
+    XPUM_LOG_INFO("XPUM: telemetry is published to shared memory {}", XPUM_TELEMETRY_SHM_NAME);
+    return true;
+}
+
+void TelemetryShmPublisher::stop() {
+    stopping = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (header != nullptr) {
+        // readers still mapping the segment see it is no longer updated
+        __atomic_store_n(&header->magic, 0, __ATOMIC_RELEASE);
+        munmap(header, size);
+        header = nullptr;
+        shm_unlink(XPUM_TELEMETRY_SHM_NAME);
+    }
+}
+
+void TelemetryShmPublisher::publish() {
+    // the longest wait before checking if the publisher stops
+    const uint32_t pollTimeout = 500;
+    uint64_t generation = 0;
+    uint64_t published = 0;
+    std::vector<xpum_telemetry_shm_entry_t> entries;
+    std::vector<xpum_telemetry_shm_pcie_entry_t> pcieEntries;
+    while (!stopping) {
+        xpumWaitForMetricsUpdate(&generation, pollTimeout);
+        if (generation == published) {
+            continue;
+        }
+        published = generation;
+        entries.clear();
+        pcieEntries.clear();
+        collect(entries, pcieEntries);
+        write(entries, pcieEntries);
+    }
+}
+
+void TelemetryShmPublisher::collect(std::vector<xpum_telemetry_shm_entry_t>& entries, std::vector<xpum_telemetry_shm_pcie_entry_t>& pcieEntries) {
+    int device_count = XPUM_MAX_NUM_DEVICES;
+    xpum_device_basic_info device_list[XPUM_MAX_NUM_DEVICES];
+    if (xpumGetDeviceList(device_list, &device_count) != XPUM_OK) {
+        return;
+    }
+    std::vector<xpum_device_metrics_t> metrics;
+    for (int d = 0; d < device_count; d++) {
+        xpum_device_id_t deviceId = device_list[d].deviceId;
+        int count = 0;
+        if (xpumGetMetrics(deviceId, nullptr, &count) != XPUM_OK || count <= 0) {
+            continue;
+        }
+        metrics.resize(count);
+        if (xpumGetMetrics(deviceId, metrics.data(), &count) != XPUM_OK) {
+            continue;
+        }
+        xpum_telemetry_shm_pcie_entry_t pcie{};
+        bool hasPcie = false;
+        for (int i = 0; i < count; i++) {
+            auto& data = metrics[i];
+            for (int j = 0; j < data.count; j++) {
+                uint64_t* pcieField = nullptr;
+                switch (data.isTileData ? XPUM_STATS_MAX : data.dataList[j].metricsType) {
+                    case XPUM_STATS_PCIE_READ_THROUGHPUT:
+                        pcieField = &pcie.readThroughput;
+                        break;
+                    case XPUM_STATS_PCIE_WRITE_THROUGHPUT:
+                        pcieField = &pcie.writeThroughput;
+                        break;
+                    case XPUM_STATS_PCIE_READ:
+                        pcieField = &pcie.read;
+                        break;
+                    case XPUM_STATS_PCIE_WRITE:
+                        pcieField = &pcie.write;
+                        break;
+                    default:
+                        break;
+                }
+                if (pcieField != nullptr) {
+                    uint32_t scale = data.dataList[j].scale;
+                    *pcieField = scale > 1 ? data.dataList[j].value / scale : data.dataList[j].value;
+                    pcie.timestamp = std::max<uint64_t>(pcie.timestamp, data.dataList[j].timestamp);
+                    hasPcie = true;
+                }
+                xpum_telemetry_shm_entry_t entry{};
+                entry.deviceId = deviceId;
+                entry.tileId = data.isTileData ? data.tileId : -1;
+                entry.metricsType = data.dataList[j].metricsType;
+                entry.isCounter = data.dataList[j].isCounter ? 1 : 0;
+                entry.scale = data.dataList[j].scale;
+                entry.value = data.dataList[j].value;
+                entry.timestamp = data.dataList[j].timestamp;
+                entries.push_back(entry);
+            }
+        }
+        // the PCIe counters are read by the daemonless xpu-smi by PCI address
+        unsigned int domain, bus, dev, func;
+        if (hasPcie && sscanf(device_list[d].PCIBDFAddress, "%x:%x:%x.%x", &domain, &bus, &dev, &func) == 4) {
+            pcie.domain = domain;
+            pcie.bus = bus;
+            pcie.device = dev;
+            pcie.function = func;
+            pcieEntries.push_back(pcie);
+        }
+    }
+}
+
+void TelemetryShmPublisher::write(const std::vector<xpum_telemetry_shm_entry_t>& entries, const std::vector<xpum_telemetry_shm_pcie_entry_t>& pcieEntries) {
+    uint32_t count = std::min<std::size_t>(entries.size(), XPUM_TELEMETRY_SHM_MAX_ENTRIES);
+    uint32_t pcieCount = std::min<std::size_t>(pcieEntries.size(), XPUM_TELEMETRY_SHM_MAX_PCIE_ENTRIES);
+    auto table = reinterpret_cast<xpum_telemetry_shm_entry_t*>(reinterpret_cast<char*>(header) + header->headerSize);
+    auto pcieTable = reinterpret_cast<xpum_telemetry_shm_pcie_entry_t*>(reinterpret_cast<char*>(header) + header->pcieOffset);
+    uint64_t sequence = __atomic_load_n(&header->sequence, __ATOMIC_RELAXED);
+    // odd while the table is written, the fence keeps the table stores after it
+    __atomic_store_n(&header->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    std::copy(entries.begin(), entries.begin() + count, table);
+    header->entryCount = count;
+    std::copy(pcieEntries.begin(), pcieEntries.begin() + pcieCount, pcieTable);
+    header->pcieEntryCount = pcieCount;
+    header->timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count();
+    __atomic_store_n(&header->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+} // end namespace xpum::daemon
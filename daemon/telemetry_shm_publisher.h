@@ -0,0 +1,53 @@
+/*
+ *  Copyright (C) 2021-2023 Intel Corporation
+ *  SPDX-License-Identifier: MIT
+ *  @file telemetry_shm_publisher.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "xpum_telemetry_shm.h"
+
+namespace xpum::daemon {
+
+/*
+  TelemetryShmPublisher copies the latest metrics of all devices and tiles
+  into the shared memory segment described in xpum_telemetry_shm.h, once per
+  monitor update, with the PCIe counters of the GPUs by PCI address. Readers
+  on the same host map the segment read only and take their copy under the
+  sequence lock in the header.
+*/
+
+class TelemetryShmPublisher {
+   public:
+    TelemetryShmPublisher();
+
+    ~TelemetryShmPublisher();
+
+    bool start();
+
+    void stop();
+
+   private:
+    void publish();
+
+    void collect(std::vector<xpum_telemetry_shm_entry_t>& entries, std::vector<xpum_telemetry_shm_pcie_entry_t>& pcieEntries);
+
+    void write(const std::vector<xpum_telemetry_shm_entry_t>& entries, const std::vector<xpum_telemetry_shm_pcie_entry_t>& pcieEntries);
+
+   private:
+    xpum_telemetry_shm_header_t* header;
+
+    std::size_t size;
+
+    std::atomic<bool> stopping;
+
+    std::thread worker;
+};
+
+} // end namespace xpum::daemon
@@ -9,6 +9,7 @@
 #include <condition_variable>
 #include <iostream>
 #include <iomanip>
+#include <map>
 #include <sstream>
 #include <mutex>
 #include <thread>
@@ -16,6 +17,8 @@
 
 #include "internal_api.h"
 #include "logger.h"
+#include "rpc_admission.h"
+#include "rpc_cache.h"
 #include "xpum_api.h"
 #include "xpum_structs.h"
 
@@ -54,6 +57,20 @@ grpc::Status XpumCoreServiceImpl::getVersion(grpc::ServerContext* context, const
     return grpc::Status::OK;
 }
 
+grpc::Status XpumCoreServiceImpl::getDataVersion(grpc::ServerContext* context, const google::protobuf::Empty* request,
+                                                 XpumDataVersion* response) {
+    // the generation of the cached responses, the one the telemetry RPCs answer with
+    response->set_generation(RpcResponseCache::instance().getGeneration());
+    uint64_t topologyVersion = 0;
+    xpum_result_t res = xpumGetTopologyVersion(&topologyVersion);
+    if (res != XPUM_OK) {
+        response->set_errormsg("Error");
+    }
+    response->set_topologyversion(topologyVersion);
+    response->set_errorno(res);
+    return grpc::Status::OK;
+}
+
 grpc::Status XpumCoreServiceImpl::getDeviceList(grpc::ServerContext* context, const google::protobuf::Empty* request,
                                                 XpumDeviceBasicInfoArray* response) {
     int count{XPUM_MAX_NUM_DEVICES};
@@ -89,17 +106,21 @@ grpc::Status XpumCoreServiceImpl::getDeviceList(grpc::ServerContext* context, co
     return grpc::Status::OK;
 }
 
+static void addDeviceProperties(const xpum_device_properties_t& data, XpumDeviceProperties* response) {
+    for (int i = 0; i < data.propertyLen; i++) {
+        auto& prop = data.properties[i];
+        auto propRpc = response->add_properties();
+        propRpc->set_name(getXpumDevicePropertyNameString(prop.name));
+        std::string value(prop.value);
+        propRpc->set_value(value);
+    }
+}
+
 grpc::Status XpumCoreServiceImpl::getDeviceProperties(grpc::ServerContext* context, const DeviceId* request, XpumDeviceProperties* response) {
     xpum_device_properties_t data;
     auto res = xpumGetDeviceProperties(request->id(), &data);
     if (res == XPUM_OK) {
-        for (int i = 0; i < data.propertyLen; i++) {
-            auto& prop = data.properties[i];
-            auto propRpc = response->add_properties();
-            propRpc->set_name(getXpumDevicePropertyNameString(prop.name));
-            std::string value(prop.value);
-            propRpc->set_value(value);
-        }
+        addDeviceProperties(data, response);
     } else {
         switch (res) {
             case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
@@ -116,6 +137,56 @@ grpc::Status XpumCoreServiceImpl::getDeviceProperties(grpc::ServerContext* conte
     return grpc::Status::OK;
 }
 
+grpc::Status XpumCoreServiceImpl::getAllDeviceProperties(grpc::ServerContext* context, const google::protobuf::Empty* request, GetAllDevicePropertiesResponse* response) {
+    int count = 0;
+    auto res = xpumGetAllDeviceProperties(nullptr, &count);
+    std::vector<xpum_device_properties_t> dataList;
+    if (res == XPUM_OK) {
+        dataList.resize(count);
+        res = xpumGetAllDeviceProperties(dataList.data(), &count);
+    }
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        switch (res) {
+            case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
+                response->set_errormsg("Level Zero Initialization Error");
+                break;
+            default:
+                response->set_errormsg("Error");
+        }
+        return grpc::Status::OK;
+    }
+    for (int i = 0; i < count; i++) {
+        auto& data = dataList[i];
+        auto device = response->add_devices();
+        device->set_deviceid(data.deviceId);
+        addDeviceProperties(data, device->mutable_properties());
+        device->mutable_properties()->set_errorno(XPUM_OK);
+        for (auto& tileEngineCountInfo : getDeviceAndTileEngineCount(data.deviceId)) {
+            auto countInfo = device->add_enginecountlist();
+            countInfo->set_istilelevel(tileEngineCountInfo.isTileLevel);
+            countInfo->set_tileid(tileEngineCountInfo.tileId);
+            for (auto& typeCountInfo : tileEngineCountInfo.engineCountList) {
+                auto countData = countInfo->add_datalist();
+                countData->set_enginetype(typeCountInfo.engineType);
+                countData->set_count(typeCountInfo.count);
+            }
+        }
+        for (auto& tileFabricCountInfo : getDeviceAndTileFabricCount(data.deviceId)) {
+            auto countInfo = device->add_fabriccountlist();
+            countInfo->set_istilelevel(tileFabricCountInfo.isTileLevel);
+            countInfo->set_tileid(tileFabricCountInfo.tileId);
+            for (auto& d : tileFabricCountInfo.dataList) {
+                auto countData = countInfo->add_datalist();
+                countData->set_tileid(d.tile_id);
+                countData->set_remotedeviceid(d.remote_device_id);
+                countData->set_remotetileid(d.remote_tile_id);
+            }
+        }
+    }
+    return grpc::Status::OK;
+}
+
 grpc::Status XpumCoreServiceImpl::getDeviceIdByBDF(grpc::ServerContext* context, const DeviceBDF* request, DeviceId* response) {
     xpum_device_id_t device_id;
     xpum_result_t res = xpumGetDeviceIdByBDF(request->bdf().c_str(), &device_id);
@@ -153,6 +224,10 @@ static std::string getAmcFwErrMsg() {
 grpc::Status XpumCoreServiceImpl::getAMCFirmwareVersions(::grpc::ServerContext* context,
                                                          const ::GetAMCFirmwareVersionsRequest* request,
                                                          ::GetAMCFirmwareVersionsResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     int count;
     auto res = xpumGetAMCFirmwareVersions(nullptr, &count, request->username().c_str(), request->password().c_str());
     response->set_errorno(res);
@@ -192,6 +267,10 @@ grpc::Status XpumCoreServiceImpl::getAMCFirmwareVersions(::grpc::ServerContext*
 ::grpc::Status XpumCoreServiceImpl::getDeviceSerialNumberAndAmcFwVersion(::grpc::ServerContext* context,
                                                           const ::GetDeviceSerialNumberRequest* request,
                                                           ::GetDeviceSerialNumberResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     int deviceId = request->deviceid();
     std::string username = request->username();
     std::string password = request->password();
@@ -245,6 +324,10 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
 
 ::grpc::Status XpumCoreServiceImpl::groupCreate(::grpc::ServerContext* context, const ::GroupName* request,
                                                 ::GroupInfo* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     XPUM_LOG_TRACE("call group create");
     xpum_group_id_t id;
     std::string validNameChars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789@#_-.";
@@ -278,8 +361,92 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
     return grpc::Status::OK;
 }
 
+// the selector of a dynamic group in the group info, nothing for the other groups
+static void setGroupSelector(xpum_group_id_t groupId, ::GroupInfo* response) {
+    xpum_group_selector_t selector;
+    if (xpumGroupGetSelector(groupId, &selector) != XPUM_OK) {
+        return;
+    }
+    ::GroupSelector* p_selector = response->mutable_selector();
+    p_selector->set_flags(selector.flags);
+    p_selector->set_model(selector.model);
+    p_selector->set_numanode(selector.numaNode);
+    p_selector->set_pcieswitch(selector.pcieSwitch);
+    p_selector->set_functiontype(selector.functionType);
+    p_selector->set_poduid(selector.podUid);
+    p_selector->set_healthstatus(selector.healthStatus);
+}
+
+::grpc::Status XpumCoreServiceImpl::groupCreateBySelector(::grpc::ServerContext* context, const ::GroupCreateBySelectorRequest* request,
+                                                          ::GroupInfo* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
+    XPUM_LOG_TRACE("call group create by selector");
+    std::string validNameChars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789@#_-.";
+    std::string name = request->name().c_str();
+    if (name.find_first_not_of(validNameChars) != std::string::npos) {
+        response->set_errormsg("Invalid group name, only support 0~9a~zA~Z@#_-.");
+        return grpc::Status::OK;
+    }
+    const ::GroupSelector& p_selector = request->selector();
+    if (p_selector.model().size() >= XPUM_MAX_STR_LENGTH || p_selector.pcieswitch().size() >= XPUM_MAX_STR_LENGTH || p_selector.poduid().size() >= XPUM_MAX_STR_LENGTH) {
+        response->set_errormsg("Invalid selector");
+        response->set_errorno(XPUM_GENERIC_ERROR);
+        return grpc::Status::OK;
+    }
+    xpum_group_selector_t selector = {};
+    selector.flags = p_selector.flags();
+    strncpy(selector.model, p_selector.model().c_str(), XPUM_MAX_STR_LENGTH - 1);
+    selector.numaNode = p_selector.numanode();
+    strncpy(selector.pcieSwitch, p_selector.pcieswitch().c_str(), XPUM_MAX_STR_LENGTH - 1);
+    selector.functionType = (xpum_device_function_type_t)p_selector.functiontype();
+    strncpy(selector.podUid, p_selector.poduid().c_str(), XPUM_MAX_STR_LENGTH - 1);
+    selector.healthStatus = (xpum_health_status_t)p_selector.healthstatus();
+
+    xpum_group_id_t id;
+    xpum_result_t res = xpumGroupCreateBySelector(name.c_str(), &selector, &id);
+    if (res == XPUM_OK) {
+        xpum_group_info_t info;
+        response->set_id(id);
+        response->set_groupname(request->name());
+        if (xpumGroupGetInfo(id, &info) == XPUM_OK) {
+            response->set_count(info.count);
+            for (int i{0}; i < info.count; i++) {
+                DeviceId* deviceid = response->add_devicelist();
+                deviceid->set_id(info.deviceList[i]);
+            }
+        }
+        setGroupSelector(id, response);
+    } else {
+        switch (res) {
+            case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
+                response->set_errormsg("Level Zero Initialization Error");
+                break;
+            case XPUM_GROUP_LIMIT_REACHED:
+                response->set_errormsg(
+                    "Number of groups exceeded maximum limit");
+                break;
+            case XPUM_GENERIC_ERROR:
+                response->set_errormsg("Invalid selector");
+                break;
+            default:
+                response->set_errormsg("Error");
+                break;
+        }
+    }
+    response->set_errorno(res);
+
+    return grpc::Status::OK;
+}
+
 ::grpc::Status XpumCoreServiceImpl::groupDestory(::grpc::ServerContext* context, const ::GroupId* request,
                                                  ::GroupInfo* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     XPUM_LOG_TRACE("call group destory");
     xpum_result_t res = xpumGroupDestroy(request->id());
 
@@ -307,6 +474,10 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
 
 ::grpc::Status XpumCoreServiceImpl::groupAddDevice(::grpc::ServerContext* context, const ::GroupAddRemoveDevice* request,
                                                    ::GroupInfo* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     XPUM_LOG_TRACE("call group add device");
 
     xpum_result_t res = xpumGroupAddDevice(request->groupid(), request->deviceid());
@@ -351,6 +522,10 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
 
 ::grpc::Status XpumCoreServiceImpl::groupRemoveDevice(::grpc::ServerContext* context, const ::GroupAddRemoveDevice* request,
                                                       ::GroupInfo* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     XPUM_LOG_TRACE("call group remove device");
 
     xpum_result_t res = xpumGroupRemoveDevice(request->groupid(), request->deviceid());
@@ -406,6 +581,7 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
             DeviceId* deviceid = response->add_devicelist();
             deviceid->set_id(info.deviceList[i]);
         }
+        setGroupSelector(request->id(), response);
     } else {
         switch (res) {
             case XPUM_RESULT_GROUP_NOT_FOUND:
@@ -464,6 +640,7 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
                     DeviceId* deviceid = groupinfo->add_devicelist();
                     deviceid->set_id(info.deviceList[i]);
                 }
+                setGroupSelector(groups[i], groupinfo);
             }
         }
     } else {
@@ -484,6 +661,10 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
 
 ::grpc::Status XpumCoreServiceImpl::runDiagnostics(::grpc::ServerContext* context, const ::RunDiagnosticsRequest* request,
                                                    ::DiagnosticsTaskInfo* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_result_t res = xpumRunDiagnostics(request->deviceid(), static_cast<xpum_diag_level_t>(request->level()));
     if (res != XPUM_OK) {
         switch (res) {
@@ -508,6 +689,10 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
 }
 ::grpc::Status XpumCoreServiceImpl::runDiagnosticsByGroup(::grpc::ServerContext* context, const ::RunDiagnosticsByGroupRequest* request,
                                                           ::DiagnosticsGroupTaskInfo* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_result_t res = xpumRunDiagnosticsByGroup(request->groupid(), static_cast<xpum_diag_level_t>(request->level()));
     if (res != XPUM_OK) {
         switch (res) {
@@ -536,6 +721,10 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
 
 ::grpc::Status XpumCoreServiceImpl::runMultipleSpecificDiagnostics(::grpc::ServerContext* context, const ::RunMultipleSpecificDiagnosticsRequest* request,
                                                    ::DiagnosticsTaskInfo* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     
     int count = request->types_size();
     xpum_diag_task_type_t types[count];
@@ -566,6 +755,10 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
 }
 ::grpc::Status XpumCoreServiceImpl::runMultipleSpecificDiagnosticsByGroup(::grpc::ServerContext* context, const ::RunMultipleSpecificDiagnosticsByGroupRequest* request,
                                                           ::DiagnosticsGroupTaskInfo* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     int count = request->types_size();
     xpum_diag_task_type_t types[xpum_diag_task_type_t::XPUM_DIAG_TASK_TYPE_MAX];
     for (int i = 0; i < count; i++)
@@ -643,6 +836,34 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
     return grpc::Status::OK;
 }
 
+::grpc::Status XpumCoreServiceImpl::watchDiagnostics(::grpc::ServerContext* context, const ::DeviceId* request,
+                                                     ::grpc::ServerWriter<DiagnosticsTaskInfo>* writer) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::STREAMING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
+    // the longest wait before checking if the daemon stops or the client goes away
+    const uint32_t pollTimeout = 500;
+
+    uint64_t generation = 0;
+    bool progressed = true;
+    while (!this->stop && !context->IsCancelled()) {
+        // read again only when a test is done, every test done is one write
+        if (progressed) {
+            DiagnosticsTaskInfo info;
+            getDiagnosticsResult(context, request, &info);
+            if (!writer->Write(info)) {
+                break;
+            }
+            if (info.errorno() != XPUM_OK || info.finished()) {
+                break;
+            }
+        }
+        progressed = xpumWaitForDiagnosticsProgress(request->id(), &generation, pollTimeout) == XPUM_OK;
+    }
+    return grpc::Status::OK;
+}
+
 ::grpc::Status XpumCoreServiceImpl::getDiagnosticsMediaCodecResult(::grpc::ServerContext* context, const ::DeviceId* request, 
                                                                    ::DiagnosticsMediaCodecInfoArray* response) {
     int count = 6; // Resolution: 1080p, 4K; Format: H264, H265, AV1
@@ -680,6 +901,10 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
 
 ::grpc::Status XpumCoreServiceImpl::getDiagnosticsXeLinkThroughputResult(::grpc::ServerContext* context, const ::DeviceId* request, 
                                                                    ::DiagnosticsXeLinkThroughputInfoArray* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     int count = 64;
     xpum_diag_xe_link_throughput_t resultList[count];
     xpum_result_t res = xpumGetDiagnosticsXeLinkThroughputResult(request->id(), resultList, &count);
@@ -913,6 +1138,10 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
 
 ::grpc::Status XpumCoreServiceImpl::setHealthConfig(::grpc::ServerContext* context, const ::HealthConfigRequest* request,
                                                     ::HealthConfigInfo* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     int threshold = request->threshold();
     xpum_result_t res = xpumSetHealthConfig(request->deviceid(), static_cast<xpum_health_config_type_t>(request->configtype()), &threshold);
     if (res != XPUM_OK) {
@@ -939,6 +1168,10 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
 
 ::grpc::Status XpumCoreServiceImpl::setHealthConfigByGroup(::grpc::ServerContext* context, const ::HealthConfigByGroupRequest* request,
                                                            ::HealthConfigByGroupInfo* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     int threshold = request->threshold();
     xpum_result_t res = xpumSetHealthConfigByGroup(request->groupid(), static_cast<xpum_health_config_type_t>(request->configtype()), &threshold);
     if (res != XPUM_OK) {
@@ -967,6 +1200,13 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
 }
 
 ::grpc::Status XpumCoreServiceImpl::getMetrics(::grpc::ServerContext* context, const ::DeviceId* request, ::DeviceStatsInfoArray* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    CachedResponse cached("getMetrics", *request, response);
+    if (cached.isHit()) {
+        return grpc::Status::OK;
+    }
     xpum_device_id_t deviceId = request->id();
     int count = 5;
     xpum_device_metrics_t dataList[count];
@@ -1004,6 +1244,13 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
 
 ::grpc::Status XpumCoreServiceImpl::getMetricsByGroup(::grpc::ServerContext* context, const ::GroupId* request,
                                                       ::DeviceStatsInfoArray* response) {
+    if (!RpcRateLimiter::instance().admit(context)) {
+        return RpcRateLimiter::instance().getLimitedStatus();
+    }
+    CachedResponse cached("getMetricsByGroup", *request, response);
+    if (cached.isHit()) {
+        return grpc::Status::OK;
+    }
     xpum_group_id_t groupId = request->id();
     int count = 16;
     xpum_device_metrics_t dataList[count];
@@ -1095,6 +1342,8 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
             output->set_type(static_cast<XpumPolicyType>(input.type));
             output->mutable_condition()->set_type(static_cast<XpumPolicyConditionType>(input.condition.type));
             output->mutable_condition()->set_threshold(input.condition.threshold);
+            output->mutable_condition()->set_window(input.condition.window);
+            output->mutable_condition()->set_releasethreshold(input.condition.releaseThreshold);
             output->mutable_action()->set_type(static_cast<XpumPolicyActionType>(input.action.type));
             output->mutable_action()->set_throttle_device_frequency_max(input.action.throttle_device_frequency_max);
             output->mutable_action()->set_throttle_device_frequency_min(input.action.throttle_device_frequency_min);
@@ -1135,6 +1384,8 @@ grpc::Status XpumCoreServiceImpl::getTopology(grpc::ServerContext* context, cons
             output->set_type(static_cast<XpumPolicyType>(input.type));
             output->mutable_condition()->set_type(static_cast<XpumPolicyConditionType>(input.condition.type));
             output->mutable_condition()->set_threshold(input.condition.threshold);
+            output->mutable_condition()->set_window(input.condition.window);
+            output->mutable_condition()->set_releasethreshold(input.condition.releaseThreshold);
             output->mutable_action()->set_type(static_cast<XpumPolicyActionType>(input.action.type));
             output->mutable_action()->set_throttle_device_frequency_max(input.action.throttle_device_frequency_max);
             output->mutable_action()->set_throttle_device_frequency_min(input.action.throttle_device_frequency_min);
@@ -1187,6 +1438,8 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
     output->set_type(static_cast<XpumPolicyType>(p_para->type));
     output->mutable_condition()->set_type(static_cast<XpumPolicyConditionType>(p_para->condition.type));
     output->mutable_condition()->set_threshold(p_para->condition.threshold);
+    output->mutable_condition()->set_window(p_para->condition.window);
+    output->mutable_condition()->set_releasethreshold(p_para->condition.releaseThreshold);
     output->mutable_action()->set_type(static_cast<XpumPolicyActionType>(p_para->action.type));
     output->mutable_action()->set_throttle_device_frequency_max(p_para->action.throttle_device_frequency_max);
     output->mutable_action()->set_throttle_device_frequency_min(p_para->action.throttle_device_frequency_min);
@@ -1213,6 +1466,11 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::readPolicyNotifyData(::grpc::ServerContext* context, const google::protobuf::Empty* request, ::grpc::ServerWriter<ReadPolicyNotifyDataResponse>* writer) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::STREAMING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
+    std::list<std::shared_ptr<ReadPolicyNotifyDataResponse>> outputs;
     while (!this->stop) {
         // XPUM_LOG_INFO("------readPolicyNotifyData-----1----");
         {
@@ -1224,13 +1482,15 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
                 // XPUM_LOG_INFO("------readPolicyNotifyData-----after-wait----size={}", callBackDataList.size());
             }
             if (this->stop) break;
-            for (auto it = callBackDataList.begin(); it != callBackDataList.end(); it++) {
-                std::shared_ptr<ReadPolicyNotifyDataResponse> output = *it;
-                writer->Write(*output);
-                // XPUM_LOG_INFO("------readPolicyNotifyData-----Write----");
-            }
-            callBackDataList.clear();
+            // written without the lock, so a slow client does not hold up the policy notifications
+            outputs.swap(callBackDataList);
         }
+        for (auto it = outputs.begin(); it != outputs.end(); it++) {
+            std::shared_ptr<ReadPolicyNotifyDataResponse> output = *it;
+            writer->Write(*output);
+            // XPUM_LOG_INFO("------readPolicyNotifyData-----Write----");
+        }
+        outputs.clear();
     }
     ///////
     // ReadPolicyNotifyDataResponse resp;
@@ -1246,6 +1506,10 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::setPolicy(::grpc::ServerContext* context, const ::SetPolicyRequest* request, ::SetPolicyResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     bool isDevcie = request->isdevcie();
     XpumPolicyData policyInput = request->policy();
     xpum_policy_t policy{};
@@ -1254,8 +1518,10 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
     //
     policy.type = static_cast<xpum_policy_type_t>(policyInput.type());
     policy.condition.type = static_cast<xpum_policy_conditon_type_t>(policyInput.condition().type());
-    if (policy.condition.type == XPUM_POLICY_CONDITION_TYPE_GREATER || policy.condition.type == XPUM_POLICY_CONDITION_TYPE_LESS) {
+    if (policy.condition.type != XPUM_POLICY_CONDITION_TYPE_WHEN_OCCUR) {
         policy.condition.threshold = static_cast<uint64_t>(policyInput.condition().threshold());
+        policy.condition.window = static_cast<uint64_t>(policyInput.condition().window());
+        policy.condition.releaseThreshold = static_cast<uint64_t>(policyInput.condition().releasethreshold());
     }
     policy.action.type = static_cast<xpum_policy_action_type_t>(policyInput.action().type());
     if (policy.action.type == XPUM_POLICY_ACTION_TYPE_THROTTLE_DEVICE) {
@@ -1296,7 +1562,7 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
         } else if (res == XPUM_RESULT_POLICY_INVALID_FREQUENCY) {
             response->set_errormsg("Error: frequency is invalid (frequency must greater than 0 and max must greater than or equal min).");
         } else if (res == XPUM_RESULT_POLICY_INVALID_THRESHOLD) {
-            response->set_errormsg("Error: threshold is invalid (threshold must greater than or equal 0).");
+            response->set_errormsg("Error: threshold is invalid (threshold must greater than or equal 0, window must greater than 0 and release threshold must not greater than threshold).");
         } else if (res == XPUM_LEVEL_ZERO_INITIALIZATION_ERROR) {
             response->set_errormsg("Level Zero Initialization Error");
         } else {
@@ -1308,13 +1574,39 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
     return grpc::Status::OK;
 }
 
+static bool isSchedulerIntervalValid(uint32_t value) {
+    return value >= 5000 && value <= 100000000;
+}
+
+static bool isPowerLimitInRange(const xpum_power_prop_data_t powerRangeArray[], uint32_t powerRangeCount, int32_t tileId, uint32_t val1) {
+    for (uint32_t i = 0; i < powerRangeCount; i++) {
+        if (powerRangeArray[i].subdevice_Id == (uint32_t)tileId || tileId == -1) {
+            if (val1 < 1 || (uint32_t(powerRangeArray[i].max_limit) > 0  && val1 > uint32_t(powerRangeArray[i].max_limit)) ||
+            (powerRangeArray[i].max_limit == -1  && uint32_t(powerRangeArray[i].default_limit) > 0  && val1 > uint32_t(powerRangeArray[i].default_limit)) ||
+            (powerRangeArray[i].min_limit > 0  && val1 < uint32_t(powerRangeArray[i].min_limit))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 ::grpc::Status XpumCoreServiceImpl::setDeviceSchedulerMode(::grpc::ServerContext* context, const ::ConfigDeviceSchdeulerModeRequest* request,
                                                            ::ConfigDeviceResultData* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
+    applyDeviceSchedulerMode(request, response);
+    return grpc::Status::OK;
+}
+
+void XpumCoreServiceImpl::applyDeviceSchedulerMode(const ::ConfigDeviceSchdeulerModeRequest* request, ::ConfigDeviceResultData* response) {
     xpum_result_t res = XPUM_GENERIC_ERROR;
     if (!request->istiledata()) {
         response->set_errormsg("Error");
         response->set_errorno(res);
-        return grpc::Status::OK;
+        return;
     }
     xpum_device_id_t deviceId = request->deviceid();
     uint32_t subdevice_Id = request->tileid();
@@ -1324,17 +1616,17 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
     /*res = validateDeviceIdAndTileId(deviceId, subdevice_Id);
     if (res != XPUM_OK) {
         response->set_errormsg("device Id or tile Id is invalid");
-        return grpc::Status::OK;
+        return;
     }*/
 
     if (scheduler == SCHEDULER_TIMEOUT) {
         xpum_scheduler_timeout_t sch_timeout;
         sch_timeout.subdevice_Id = subdevice_Id;
         sch_timeout.watchdog_timeout = val1;
-        if (val1 < 5000 || val1 > 100000000) {
+        if (!isSchedulerIntervalValid(val1)) {
             response->set_errormsg("Invalid scheduler timeout value");
             response->set_errorno(res);
-            return grpc::Status::OK;
+            return;
         }
         res = xpumSetDeviceSchedulerTimeoutMode(deviceId, sch_timeout);
     } else if (scheduler == SCHEDULER_TIMESLICE) {
@@ -1342,10 +1634,10 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
         sch_timeslice.subdevice_Id = subdevice_Id;
         sch_timeslice.interval = val1;
         sch_timeslice.yield_timeout = val2;
-        if (val1 < 5000 || val1 > 100000000 || val2 < 5000 || val2 > 100000000) {
+        if (!isSchedulerIntervalValid(val1) || !isSchedulerIntervalValid(val2)) {
             response->set_errormsg("Invalid scheduler timeslice value");
             response->set_errorno(res);
-            return grpc::Status::OK;
+            return;
         }
         res = xpumSetDeviceSchedulerTimesliceMode(deviceId, sch_timeslice);
     } else if (scheduler == SCHEDULER_EXCLUSIVE) {
@@ -1374,11 +1666,19 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
         }
     }
     response->set_errorno(res);
-    return grpc::Status::OK;
 }
 
 ::grpc::Status XpumCoreServiceImpl::setDevicePowerLimit(::grpc::ServerContext* context, const ::ConfigDevicePowerLimitRequest* request,
                                                         ::ConfigDeviceResultData* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
+    applyDevicePowerLimit(request, response);
+    return grpc::Status::OK;
+}
+
+void XpumCoreServiceImpl::applyDevicePowerLimit(const ::ConfigDevicePowerLimitRequest* request, ::ConfigDeviceResultData* response) {
     xpum_device_id_t deviceId = request->deviceid();
     int32_t tileId = request->tileid();
     uint32_t val1 = request->powerlimit();
@@ -1403,19 +1703,13 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
                 break;
         }
         response->set_errorno(res);
-        return grpc::Status::OK;
+        return;
     }
 
-    for (uint32_t i = 0; i < powerRangeCount; i++) {
-        if (powerRangeArray[i].subdevice_Id == (uint32_t)tileId || tileId == -1) {
-            if (val1 < 1 || (uint32_t(powerRangeArray[i].max_limit) > 0  && val1 > uint32_t(powerRangeArray[i].max_limit)) ||
-            (powerRangeArray[i].max_limit == -1  && uint32_t(powerRangeArray[i].default_limit) > 0  && val1 > uint32_t(powerRangeArray[i].default_limit)) ||
-            (powerRangeArray[i].min_limit > 0  && val1 < uint32_t(powerRangeArray[i].min_limit))) {
-                response->set_errormsg("Invalid power limit value");
-                response->set_errorno(XPUM_GENERIC_ERROR);
-                return grpc::Status::OK;
-            }
-        }
+    if (!isPowerLimitInRange(powerRangeArray, powerRangeCount, tileId, val1)) {
+        response->set_errormsg("Invalid power limit value");
+        response->set_errorno(XPUM_GENERIC_ERROR);
+        return;
     }
     sustained_limit.enabled = true;
     sustained_limit.power = val1;
@@ -1423,7 +1717,7 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
     /*res = validateDeviceIdAndTileId(deviceId, tileId);
     if (res != XPUM_OK) {
         response->set_errormsg("device Id or tile Id is invalid");
-        return grpc::Status::OK;
+        return;
     }*/
 
     res = xpumSetDevicePowerSustainedLimits(deviceId, tileId, sustained_limit);
@@ -1442,16 +1736,24 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
         }
     }
     response->set_errorno(res);
-    return grpc::Status::OK;
 }
 
 ::grpc::Status XpumCoreServiceImpl::setDeviceFrequencyRange(::grpc::ServerContext* context, const ::ConfigDeviceFrequencyRangeRequest* request,
                                                             ::ConfigDeviceResultData* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
+    applyDeviceFrequencyRange(request, response);
+    return grpc::Status::OK;
+}
+
+void XpumCoreServiceImpl::applyDeviceFrequencyRange(const ::ConfigDeviceFrequencyRangeRequest* request, ::ConfigDeviceResultData* response) {
     xpum_result_t res;
     if (!request->istiledata()) {
         response->set_errormsg("Error");
         response->set_errorno(XPUM_GENERIC_ERROR);
-        return grpc::Status::OK;
+        return;
     }
     xpum_device_id_t deviceId = request->deviceid();
     uint32_t subdevice_Id = request->tileid();
@@ -1464,7 +1766,7 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
     /*res = validateDeviceIdAndTileId(deviceId, subdevice_Id);
     if (res != XPUM_OK) {
         response->set_errormsg("device Id or tile Id is invalid");
-        return grpc::Status::OK;
+        return;
     }*/
 
     res = xpumSetDeviceFrequencyRange(deviceId, freq_range);
@@ -1483,16 +1785,24 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
         }
     }
     response->set_errorno(res);
-    return grpc::Status::OK;
 }
 
 ::grpc::Status XpumCoreServiceImpl::setDeviceStandbyMode(::grpc::ServerContext* context, const ::ConfigDeviceStandbyRequest* request,
                                                          ::ConfigDeviceResultData* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
+    applyDeviceStandbyMode(request, response);
+    return grpc::Status::OK;
+}
+
+void XpumCoreServiceImpl::applyDeviceStandbyMode(const ::ConfigDeviceStandbyRequest* request, ::ConfigDeviceResultData* response) {
     xpum_result_t res;
     if (!request->istiledata()) {
         response->set_errormsg("Error");
         response->set_errorno(XPUM_GENERIC_ERROR);
-        return grpc::Status::OK;
+        return;
     }
     xpum_device_id_t deviceId = request->deviceid();
     uint32_t subdevice_Id = request->tileid();
@@ -1505,7 +1815,7 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
     /*res = validateDeviceIdAndTileId(deviceId, subdevice_Id);
     if (res != XPUM_OK) {
         response->set_errormsg("device Id or tile Id is invalid");
-        return grpc::Status::OK;
+        return;
     }*/
 
     if (mode == STANDBY_DEFAULT) {
@@ -1515,7 +1825,7 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
     } else {
         response->set_errormsg("Error");
         response->set_errorno(XPUM_GENERIC_ERROR);
-        return grpc::Status::OK;
+        return;
     }
     res = xpumSetDeviceStandby(deviceId, standby);
     if (res != XPUM_OK) {
@@ -1533,10 +1843,13 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
         }
     }
     response->set_errorno(res);
-    return grpc::Status::OK;
 }
 
 ::grpc::Status XpumCoreServiceImpl::applyPPR(::grpc::ServerContext* context, const ::ApplyPprRequest* request, ::ApplyPprResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_result_t res;
     xpum::xpum_health_status_t memoryHealthState{};
     xpum::xpum_diag_result_t diagResult{};
@@ -1580,6 +1893,10 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::resetDevice(::grpc::ServerContext* context, const ::ResetDeviceRequest* request, ::ResetDeviceResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_result_t res;
     xpum_device_id_t deviceId = request->deviceid();
     bool force = request->force();
@@ -1664,11 +1981,20 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::setPerformanceFactor(::grpc::ServerContext* context, const ::PerformanceFactor* request, ::DevicePerformanceFactorSettingResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
+    applyPerformanceFactor(request, response);
+    return grpc::Status::OK;
+}
+
+void XpumCoreServiceImpl::applyPerformanceFactor(const ::PerformanceFactor* request, ::DevicePerformanceFactorSettingResponse* response) {
     xpum_result_t res;
     if (!request->istiledata()) {
         response->set_errormsg("Error");
         response->set_errorno(XPUM_GENERIC_ERROR);
-        return grpc::Status::OK;
+        return;
     }
     xpum_device_id_t deviceId = request->deviceid();
     uint32_t subdevice_Id = request->tileid();
@@ -1695,10 +2021,225 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
         }
     }
     response->set_errorno(res);
+}
+
+void XpumCoreServiceImpl::fillDeviceConfigTarget(const ::ConfigDeviceBatchItem& item, ::ConfigDeviceResultData* result) {
+    switch (item.config_case()) {
+        case ::ConfigDeviceBatchItem::kPowerLimit:
+            result->set_deviceid(item.powerlimit().deviceid());
+            result->set_istiledata(item.powerlimit().tileid() >= 0);
+            result->set_tileid(item.powerlimit().tileid() >= 0 ? item.powerlimit().tileid() : 0);
+            break;
+        case ::ConfigDeviceBatchItem::kFrequencyRange:
+            result->set_deviceid(item.frequencyrange().deviceid());
+            result->set_istiledata(item.frequencyrange().istiledata());
+            result->set_tileid(item.frequencyrange().tileid());
+            break;
+        case ::ConfigDeviceBatchItem::kStandby:
+            result->set_deviceid(item.standby().deviceid());
+            result->set_istiledata(item.standby().istiledata());
+            result->set_tileid(item.standby().tileid());
+            break;
+        case ::ConfigDeviceBatchItem::kScheduler:
+            result->set_deviceid(item.scheduler().deviceid());
+            result->set_istiledata(item.scheduler().istiledata());
+            result->set_tileid(item.scheduler().tileid());
+            break;
+        case ::ConfigDeviceBatchItem::kPerformanceFactor:
+            result->set_deviceid(item.performancefactor().deviceid());
+            result->set_istiledata(item.performancefactor().istiledata());
+            result->set_tileid(item.performancefactor().tileid());
+            break;
+        default:
+            break;
+    }
+}
+
+xpum_result_t XpumCoreServiceImpl::checkDeviceConfig(const ::ConfigDeviceBatchItem& item, std::map<xpum_device_id_t, int>& tileCounts, std::string& errorMsg) {
+    if (item.config_case() == ::ConfigDeviceBatchItem::CONFIG_NOT_SET) {
+        errorMsg = "No configuration is set";
+        return XPUM_GENERIC_ERROR;
+    }
+    ::ConfigDeviceResultData target;
+    fillDeviceConfigTarget(item, &target);
+    xpum_device_id_t deviceId = target.deviceid();
+    // the settings other than the power limit are applied to a tile only
+    if (!target.istiledata() && item.config_case() != ::ConfigDeviceBatchItem::kPowerLimit) {
+        errorMsg = "tile Id is required";
+        return XPUM_GENERIC_ERROR;
+    }
+
+    // the tile count of each device is read once for the batch
+    auto it = tileCounts.find(deviceId);
+    if (it == tileCounts.end()) {
+        int tileCount = -1;
+        xpum_device_properties_t properties;
+        xpum_result_t res = xpumGetDeviceProperties(deviceId, &properties);
+        if (res == XPUM_LEVEL_ZERO_INITIALIZATION_ERROR) {
+            errorMsg = "Level Zero Initialization Error";
+            return res;
+        }
+        if (res == XPUM_OK) {
+            tileCount = 0;
+            for (int i = 0; i < properties.propertyLen; i++) {
+                if (properties.properties[i].name == XPUM_DEVICE_PROPERTY_NUMBER_OF_TILES) {
+                    tileCount = atoi(properties.properties[i].value);
+                    break;
+                }
+            }
+        }
+        it = tileCounts.emplace(deviceId, tileCount).first;
+    }
+    if (it->second < 0 || (target.istiledata() && (int)target.tileid() >= std::max(it->second, 1))) {
+        errorMsg = "device Id or tile Id is invalid";
+        return XPUM_RESULT_DEVICE_NOT_FOUND;
+    }
+
+    switch (item.config_case()) {
+        case ::ConfigDeviceBatchItem::kPowerLimit: {
+            xpum_power_prop_data_t powerRangeArray[32];
+            uint32_t powerRangeCount = 32;
+            xpum_result_t res = xpumGetDevicePowerProps(deviceId, powerRangeArray, &powerRangeCount);
+            if (res != XPUM_OK) {
+                errorMsg = "Error";
+                return res;
+            }
+            if (!isPowerLimitInRange(powerRangeArray, powerRangeCount, item.powerlimit().tileid(), item.powerlimit().powerlimit())) {
+                errorMsg = "Invalid power limit value";
+                return XPUM_GENERIC_ERROR;
+            }
+            break;
+        }
+        case ::ConfigDeviceBatchItem::kFrequencyRange:
+            if (item.frequencyrange().minfreq() > item.frequencyrange().maxfreq()) {
+                errorMsg = "Invalid frequency range";
+                return XPUM_GENERIC_ERROR;
+            }
+            break;
+        case ::ConfigDeviceBatchItem::kStandby:
+            if (item.standby().standby() != STANDBY_DEFAULT && item.standby().standby() != STANDBY_NEVER) {
+                errorMsg = "Invalid standby mode";
+                return XPUM_GENERIC_ERROR;
+            }
+            break;
+        case ::ConfigDeviceBatchItem::kScheduler: {
+            auto& scheduler = item.scheduler();
+            if ((scheduler.scheduler() == SCHEDULER_TIMEOUT && !isSchedulerIntervalValid(scheduler.val1())) ||
+                (scheduler.scheduler() == SCHEDULER_TIMESLICE && (!isSchedulerIntervalValid(scheduler.val1()) || !isSchedulerIntervalValid(scheduler.val2())))) {
+                errorMsg = "Invalid scheduler value";
+                return XPUM_GENERIC_ERROR;
+            }
+            if (scheduler.scheduler() != SCHEDULER_TIMEOUT && scheduler.scheduler() != SCHEDULER_TIMESLICE &&
+                scheduler.scheduler() != SCHEDULER_EXCLUSIVE && scheduler.scheduler() != SCHEDULER_DEBUG) {
+                errorMsg = "Invalid scheduler mode";
+                return XPUM_GENERIC_ERROR;
+            }
+            break;
+        }
+        case ::ConfigDeviceBatchItem::kPerformanceFactor:
+            if (item.performancefactor().factor() < 0 || item.performancefactor().factor() > 100) {
+                errorMsg = "Invalid performance factor value";
+                return XPUM_GENERIC_ERROR;
+            }
+            break;
+        default:
+            break;
+    }
+    return XPUM_OK;
+}
+
+void XpumCoreServiceImpl::applyDeviceConfig(const ::ConfigDeviceBatchItem& item, ::ConfigDeviceResultData* result) {
+    switch (item.config_case()) {
+        case ::ConfigDeviceBatchItem::kPowerLimit:
+            applyDevicePowerLimit(&item.powerlimit(), result);
+            break;
+        case ::ConfigDeviceBatchItem::kFrequencyRange:
+            applyDeviceFrequencyRange(&item.frequencyrange(), result);
+            break;
+        case ::ConfigDeviceBatchItem::kStandby:
+            applyDeviceStandbyMode(&item.standby(), result);
+            break;
+        case ::ConfigDeviceBatchItem::kScheduler:
+            applyDeviceSchedulerMode(&item.scheduler(), result);
+            break;
+        case ::ConfigDeviceBatchItem::kPerformanceFactor: {
+            ::DevicePerformanceFactorSettingResponse pfResult;
+            applyPerformanceFactor(&item.performancefactor(), &pfResult);
+            result->set_errormsg(pfResult.errormsg());
+            result->set_errorno(pfResult.errorno());
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+::grpc::Status XpumCoreServiceImpl::setDeviceConfigBatch(::grpc::ServerContext* context, const ::ConfigDeviceBatchRequest* request, ::ConfigDeviceBatchResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
+    // all items are validated before any of them is applied
+    std::map<xpum_device_id_t, int> tileCounts;
+    std::map<xpum_device_id_t, std::vector<int>> itemsByDevice;
+    int invalidCount = 0;
+    for (int i = 0; i < request->items_size(); i++) {
+        auto& item = request->items(i);
+        auto result = response->add_results();
+        fillDeviceConfigTarget(item, result);
+        std::string errorMsg;
+        xpum_result_t res = checkDeviceConfig(item, tileCounts, errorMsg);
+        if (res != XPUM_OK) {
+            result->set_errormsg(errorMsg);
+            result->set_errorno(res);
+            invalidCount++;
+            continue;
+        }
+        itemsByDevice[result->deviceid()].push_back(i);
+    }
+    if (invalidCount > 0) {
+        response->set_errormsg(std::to_string(invalidCount) + " of the configurations are invalid, none is applied");
+        response->set_errorno(XPUM_GENERIC_ERROR);
+        return grpc::Status::OK;
+    }
+    if (request->validateonly()) {
+        response->set_errorno(XPUM_OK);
+        return grpc::Status::OK;
+    }
+
+    // the devices are configured in parallel, the items of a device in their order
+    std::vector<std::thread> workers;
+    for (auto& group : itemsByDevice) {
+        auto& indexes = group.second;
+        workers.emplace_back([this, request, response, &indexes]() {
+            for (int i : indexes) {
+                applyDeviceConfig(request->items(i), response->mutable_results(i));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    int failedCount = 0;
+    for (auto& result : response->results()) {
+        if (result.errorno() != XPUM_OK) {
+            failedCount++;
+        }
+    }
+    if (failedCount > 0) {
+        response->set_errormsg(std::to_string(failedCount) + " of the configurations failed to apply");
+        response->set_errorno(XPUM_GENERIC_ERROR);
+    } else {
+        response->set_errorno(XPUM_OK);
+    }
     return grpc::Status::OK;
 }
 
 ::grpc::Status XpumCoreServiceImpl::getDeviceProcessState(::grpc::ServerContext* context, const ::DeviceId* request, ::DeviceProcessStateResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_result_t res;
     xpum_device_id_t deviceId = request->id();
 
@@ -1747,7 +2288,81 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
     return grpc::Status::OK;
 }
 
+::grpc::Status XpumCoreServiceImpl::getPerfMetrics(::grpc::ServerContext* context, const ::GetPerfMetricsRequest* request, ::GetPerfMetricsResponse* response) {
+    uint32_t count = 0;
+    xpum_result_t res = xpumGetPerfMetrics(request->deviceid(), request->windowms(), nullptr, &count);
+    std::vector<xpum_perf_metric_t> metrics(count);
+    if (res == XPUM_OK && count > 0) {
+        res = xpumGetPerfMetrics(request->deviceid(), request->windowms(), metrics.data(), &count);
+    }
+    if (res != XPUM_OK) {
+        switch (res) {
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+                response->set_errormsg("device not found");
+                break;
+            case XPUM_METRIC_NOT_ENABLED:
+                response->set_errormsg("METRIC_PERF is not enabled");
+                break;
+            default:
+                response->set_errormsg("Error");
+                break;
+        }
+        response->set_errorno(res);
+        return grpc::Status::OK;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        PerfMetric* metric = response->add_metrics();
+        metric->set_tileid(metrics[i].tileId);
+        metric->set_groupname(metrics[i].groupName);
+        metric->set_metricname(metrics[i].metricName);
+        metric->set_current(metrics[i].current);
+        metric->set_average(metrics[i].average);
+        metric->set_min(metrics[i].min);
+        metric->set_max(metrics[i].max);
+        metric->set_samplecount(metrics[i].sampleCount);
+        metric->set_activeratio(metrics[i].activeRatio);
+    }
+    response->set_errorno(XPUM_OK);
+    return grpc::Status::OK;
+}
+
+static std::string doubleToFormatStr(double val) {
+    std::ostringstream oss;
+    int fixed = 2;
+    oss << std::setw(8) << std::setiosflags(std::ios::fixed) << std::setiosflags(std::ios::right) << std::setprecision(fixed) << val;
+    return oss.str();
+}
+
+static void setComponentOccupancyRatio(DeviceComponentOccupancyRatio* componentsOccupancy, const xpum_device_components_ratio_t& ratios, const std::string& tileId) {
+    componentsOccupancy->set_notinuse(doubleToFormatStr(ratios.ratios[0].value));
+    componentsOccupancy->set_workload(doubleToFormatStr(ratios.ratios[1].value));
+    componentsOccupancy->set_engine(doubleToFormatStr(ratios.ratios[2].value));
+    componentsOccupancy->set_inuse(doubleToFormatStr(ratios.ratios[3].value));
+    componentsOccupancy->set_active(doubleToFormatStr(ratios.ratios[4].value));
+    componentsOccupancy->set_aluactive(doubleToFormatStr(ratios.ratios[5].value));
+    componentsOccupancy->set_xmxactive(doubleToFormatStr(ratios.ratios[6].value));
+    componentsOccupancy->set_xmxonly(doubleToFormatStr(ratios.ratios[7].value));
+    componentsOccupancy->set_xmxfpuactive(doubleToFormatStr(ratios.ratios[8].value));
+    componentsOccupancy->set_fpuwithoutxmx(doubleToFormatStr(ratios.ratios[9].value));
+    componentsOccupancy->set_fpuonly(doubleToFormatStr(ratios.ratios[10].value));
+    componentsOccupancy->set_emfpuactive(doubleToFormatStr(ratios.ratios[11].value));
+    componentsOccupancy->set_emintonly(doubleToFormatStr(ratios.ratios[12].value));
+    componentsOccupancy->set_other(doubleToFormatStr(ratios.ratios[13].value));
+    componentsOccupancy->set_stall(doubleToFormatStr(ratios.ratios[14].value));
+    componentsOccupancy->set_nonoccupancy(doubleToFormatStr(ratios.ratios[15].value));
+    componentsOccupancy->set_stallalu(doubleToFormatStr(ratios.ratios[16].value));
+    componentsOccupancy->set_stallbarrier(doubleToFormatStr(ratios.ratios[17].value));
+    componentsOccupancy->set_stalldep(doubleToFormatStr(ratios.ratios[18].value));
+    componentsOccupancy->set_stallother(doubleToFormatStr(ratios.ratios[19].value));
+    componentsOccupancy->set_stallinstfetch(doubleToFormatStr(ratios.ratios[20].value));
+    componentsOccupancy->set_tileid(tileId);
+}
+
 ::grpc::Status XpumCoreServiceImpl::getDeviceComponentOccupancyRatio(::grpc::ServerContext* context, const ::DeviceComponentOccupancyRatioRequest* request, ::DeviceComponentOccupancyRatioResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_result_t res;
     xpum_device_id_t deviceId = request->deviceid();
     uint32_t tileId = request->tileid();
@@ -1812,12 +2427,6 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
 
     if (tileCount > 0) {
         xpum_device_components_ratio_t dataArray[tileCount];
-        auto doubleToFormatStr = [] (double val) {
-            std::ostringstream oss;
-            int fixed = 2;
-            oss << std::setw(8) << std::setiosflags(std::ios::fixed) << std::setiosflags(std::ios::right) << std::setprecision(fixed) << val;
-            return oss.str();
-        };
         res = xpumGetDeviceComponentOccupancyRatio(deviceId, tileId, samplingInterval, dataArray, &tileTotalCount);
         if (res != XPUM_OK) {
             switch (res) {
@@ -1842,29 +2451,7 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
                 /* tileId specified */
                 if (isTileData && tileId != tileList.at(i)) continue;
 
-                DeviceComponentOccupancyRatio* componentsOccupancy = response->add_componentoccupancylist();
-                componentsOccupancy->set_notinuse(doubleToFormatStr(dataArray[i].ratios[0].value));
-                componentsOccupancy->set_workload(doubleToFormatStr(dataArray[i].ratios[1].value));
-                componentsOccupancy->set_engine(doubleToFormatStr(dataArray[i].ratios[2].value));
-                componentsOccupancy->set_inuse(doubleToFormatStr(dataArray[i].ratios[3].value));
-                componentsOccupancy->set_active(doubleToFormatStr(dataArray[i].ratios[4].value));
-                componentsOccupancy->set_aluactive(doubleToFormatStr(dataArray[i].ratios[5].value));
-                componentsOccupancy->set_xmxactive(doubleToFormatStr(dataArray[i].ratios[6].value));
-                componentsOccupancy->set_xmxonly(doubleToFormatStr(dataArray[i].ratios[7].value));
-                componentsOccupancy->set_xmxfpuactive(doubleToFormatStr(dataArray[i].ratios[8].value));
-                componentsOccupancy->set_fpuwithoutxmx(doubleToFormatStr(dataArray[i].ratios[9].value));
-                componentsOccupancy->set_fpuonly(doubleToFormatStr(dataArray[i].ratios[10].value));
-                componentsOccupancy->set_emfpuactive(doubleToFormatStr(dataArray[i].ratios[11].value));
-                componentsOccupancy->set_emintonly(doubleToFormatStr(dataArray[i].ratios[12].value));
-                componentsOccupancy->set_other(doubleToFormatStr(dataArray[i].ratios[13].value));
-                componentsOccupancy->set_stall(doubleToFormatStr(dataArray[i].ratios[14].value));
-                componentsOccupancy->set_nonoccupancy(doubleToFormatStr(dataArray[i].ratios[15].value));
-                componentsOccupancy->set_stallalu(doubleToFormatStr(dataArray[i].ratios[16].value));
-                componentsOccupancy->set_stallbarrier(doubleToFormatStr(dataArray[i].ratios[17].value));
-                componentsOccupancy->set_stalldep(doubleToFormatStr(dataArray[i].ratios[18].value));
-                componentsOccupancy->set_stallother(doubleToFormatStr(dataArray[i].ratios[19].value));
-                componentsOccupancy->set_stallinstfetch(doubleToFormatStr(dataArray[i].ratios[20].value));
-                componentsOccupancy->set_tileid(std::to_string(deviceId) + "/" + std::to_string(tileList.at(i)));
+                setComponentOccupancyRatio(response->add_componentoccupancylist(), dataArray[i], std::to_string(deviceId) + "/" + std::to_string(tileList.at(i)));
 
                 /* targeted tile founded */
                 if (isTileData && tileId == tileList.at(i)) break;
@@ -1878,7 +2465,57 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
     return grpc::Status::OK;
 }
 
+::grpc::Status XpumCoreServiceImpl::getTopdownRatios(::grpc::ServerContext* context, const ::TopdownRatiosRequest* request, ::DeviceComponentOccupancyRatioResponse* response) {
+    xpum_device_id_t deviceId = request->deviceid();
+    uint32_t tileId = request->tileid();
+    bool isTileData = request->istiledata();
+    xpum_result_t res = isTileData ? validateDeviceIdAndTileId(deviceId, tileId) : validateDeviceId(deviceId);
+    uint32_t tileCount = 0;
+    if (res == XPUM_OK) {
+        res = xpumGetTopdownRatios(deviceId, request->windowms(), nullptr, &tileCount);
+    }
+    std::vector<xpum_device_components_ratio_t> dataArray(tileCount);
+    if (res == XPUM_OK) {
+        res = xpumGetTopdownRatios(deviceId, request->windowms(), dataArray.data(), &tileCount);
+    }
+    if (res != XPUM_OK) {
+        switch (res) {
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+            case XPUM_RESULT_TILE_NOT_FOUND:
+                response->set_errormsg("device Id or tile Id is invalid");
+                break;
+            case XPUM_METRIC_NOT_ENABLED:
+                response->set_errormsg("METRIC_PERF is not enabled");
+                break;
+            case XPUM_METRIC_NOT_SUPPORTED:
+                response->set_errormsg("No perf metric sample of the device is collected yet");
+                break;
+            default:
+                response->set_errormsg("Error");
+                break;
+        }
+        response->set_errorno(res);
+        return grpc::Status::OK;
+    }
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < tileCount; i++) {
+        if (isTileData && i != tileId) {
+            continue;
+        }
+        setComponentOccupancyRatio(response->add_componentoccupancylist(), dataArray[i], std::to_string(deviceId) + "/" + std::to_string(i));
+        count++;
+    }
+    response->set_tilecount(count);
+    response->set_errorno(XPUM_OK);
+    return grpc::Status::OK;
+}
+
 ::grpc::Status XpumCoreServiceImpl::getDeviceUtilizationByProcess(::grpc::ServerContext* context, const ::DeviceUtilizationByProcessRequest* request, ::DeviceUtilizationByProcessResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_result_t res;
     xpum_device_id_t deviceId = request->deviceid();
     uint32_t count = 1024;
@@ -1922,6 +2559,10 @@ void xpum_notify_callback_func(xpum_policy_notify_callback_para_t* p_para) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::getAllDeviceUtilizationByProcess(::grpc::ServerContext* context, const ::UtilizationInterval* request, ::DeviceUtilizationByProcessResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_result_t res;
     uint32_t count = 1024 * 4;
     xpum_device_util_by_process_t dataArray[count];
@@ -1982,6 +2623,10 @@ std::string XpumCoreServiceImpl::convertEngineId2Num(uint32_t engine) {
     return std::to_string(engine);
 }
 ::grpc::Status XpumCoreServiceImpl::setDeviceFabricPortEnabled(::grpc::ServerContext* context, const ::ConfigDeviceFabricPortEnabledRequest* request, ::ConfigDeviceResultData* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_result_t res;
     if (!request->istiledata()) {
         response->set_errormsg("Error");
@@ -2021,6 +2666,10 @@ std::string XpumCoreServiceImpl::convertEngineId2Num(uint32_t engine) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::setDeviceFabricPortBeaconing(::grpc::ServerContext* context, const ::ConfigDeviceFabricPortBeconingRequest* request, ::ConfigDeviceResultData* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_result_t res;
     if (!request->istiledata()) {
         response->set_errormsg("Error");
@@ -2453,6 +3102,10 @@ std::string XpumCoreServiceImpl::eccActionToString(xpum_ecc_action_t action) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::setDeviceMemoryEccState(::grpc::ServerContext* context, const ::ConfigDeviceMemoryEccStateRequest* request, ::ConfigDeviceMemoryEccStateResultData* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_result_t res;
     xpum_device_id_t deviceId = request->deviceid();
     bool available;
@@ -2487,6 +3140,10 @@ std::string XpumCoreServiceImpl::eccActionToString(xpum_ecc_action_t action) {
 
 ::grpc::Status XpumCoreServiceImpl::getTopoXMLBuffer(::grpc::ServerContext* context, const ::google::protobuf::Empty* request,
                                                      ::TopoXMLResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     XPUM_LOG_TRACE("call exportTopoXML");
     int size = 0;
     xpum_result_t res = xpumExportTopology2XML(nullptr, &size);
@@ -2581,19 +3238,166 @@ std::string XpumCoreServiceImpl::eccActionToString(xpum_ecc_action_t action) {
     return grpc::Status::OK;
 }
 
+::grpc::Status XpumCoreServiceImpl::getPlacementAdvice(::grpc::ServerContext* context, const ::XpumPlacementAdviceRequest* request,
+                                                       ::XpumPlacementAdviceResponse* response) {
+    XPUM_LOG_TRACE("call getPlacementAdvice");
+    std::vector<xpum_device_id_t> deviceIdList(request->deviceidlist().begin(), request->deviceidlist().end());
+    xpum_placement_advice_t advice;
+    xpum_result_t res = xpumGetPlacementAdvice(deviceIdList.data(), deviceIdList.size(), &advice);
+
+    if (res == XPUM_OK) {
+        for (int i = 0; i < advice.count; i++) {
+            auto& placement = advice.devices[i];
+            auto device = response->add_devices();
+            device->set_deviceid(placement.deviceId);
+            device->set_numaindex(placement.numaIdx);
+            device->set_cpuaffinity(placement.cpuAffinity);
+            device->set_treeparent(placement.treeParent);
+            std::string linkType;
+            if (placement.nextLinkType == XPUM_LINK_SELF) {
+                linkType = "S";
+            } else if (placement.nextLinkType == XPUM_LINK_XE) {
+                linkType = "XL";
+            } else if (placement.nextLinkType == XPUM_LINK_SYS) {
+                linkType = "SYS";
+            } else if (placement.nextLinkType == XPUM_LINK_NODE) {
+                linkType = "NODE";
+            } else {
+                linkType = "Unknown";
+            }
+            device->set_nextlinktype(linkType);
+            device->set_nextpciehops(placement.nextPcieHops);
+        }
+        response->set_cpulist(advice.cpuList);
+        for (int i = 0; i < advice.numaNodeCount; i++) {
+            response->add_numanodes(advice.numaNodes[i]);
+        }
+        response->set_ringxelinkhops(advice.ringXelinkHops);
+        response->set_ringpciehops(advice.ringPcieHops);
+        response->set_ringcrossnumahops(advice.ringCrossNumaHops);
+    } else {
+        switch (res) {
+            case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
+                response->set_errormsg("Level Zero Initialization Error");
+                break;
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+                response->set_errormsg("Device not found");
+                break;
+            case XPUM_BUFFER_TOO_SMALL:
+                response->set_errormsg("Too many devices");
+                break;
+            default:
+                response->set_errormsg("Error");
+                break;
+        }
+    }
+
+    response->set_errorno(res);
+
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::runXeLinkMatrix(::grpc::ServerContext* context, const ::XpumRunXeLinkMatrixRequest* request,
+                                                    ::XpumXeLinkMatrixResponse* response) {
+    XPUM_LOG_TRACE("call runXeLinkMatrix");
+    std::vector<xpum_device_id_t> deviceIdList(request->deviceidlist().begin(), request->deviceidlist().end());
+    xpum_result_t res = xpumRunXeLinkMatrix(deviceIdList.data(), deviceIdList.size());
+
+    if (res == XPUM_OK) {
+        response->set_running(true);
+    } else {
+        switch (res) {
+            case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
+                response->set_errormsg("Level Zero Initialization Error");
+                break;
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+                response->set_errormsg("Device not found");
+                break;
+            case XPUM_RESULT_DIAGNOSTIC_TASK_NOT_COMPLETE:
+                response->set_errormsg("last diagnostic task on the device is not completed");
+                break;
+            default:
+                response->set_errormsg("Error");
+                break;
+        }
+    }
+
+    response->set_errorno(res);
+
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::getXeLinkMatrix(::grpc::ServerContext* context, const ::google::protobuf::Empty* request,
+                                                    ::XpumXeLinkMatrixResponse* response) {
+    XPUM_LOG_TRACE("call getXeLinkMatrix");
+    int count = 0;
+    bool running = false;
+    xpum_result_t res = xpumGetXeLinkMatrix(nullptr, &count, &running);
+    std::vector<xpum_xe_link_matrix_entry_t> entries(count);
+    if (res == XPUM_OK && count > 0) {
+        res = xpumGetXeLinkMatrix(entries.data(), &count, &running);
+    }
+
+    if (res == XPUM_OK) {
+        for (int i = 0; i < count; i++) {
+            auto& entry = entries[i];
+            auto data = response->add_entries();
+            data->set_srcdeviceid(entry.srcDeviceId);
+            data->set_srctileid(entry.srcTileId);
+            data->set_dstdeviceid(entry.dstDeviceId);
+            data->set_dsttileid(entry.dstTileId);
+            data->set_copyenginegroup(entry.copyEngineGroup);
+            data->set_unibandwidth(entry.uniBandwidth);
+            data->set_bibandwidth(entry.biBandwidth);
+            data->set_latency(entry.latency);
+            data->set_degraded(entry.degraded);
+            data->set_timestamp(entry.timestamp);
+        }
+        response->set_running(running);
+    } else {
+        switch (res) {
+            case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
+                response->set_errormsg("Level Zero Initialization Error");
+                break;
+            default:
+                response->set_errormsg("Error");
+                break;
+        }
+    }
+
+    response->set_errorno(res);
+
+    return grpc::Status::OK;
+}
+
 ::grpc::Status XpumCoreServiceImpl::runStress(::grpc::ServerContext* context, const ::RunStressRequest* request,
                                               ::DiagnosticsTaskInfo* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     if (request->stresstime() <= 0) {
         response->set_errormsg("Error");
         response->set_errorno(XPUM_GENERIC_ERROR);
         return grpc::Status::OK;
     }
-    xpum_result_t res = xpumRunStress(request->deviceid(), request->stresstime());
+    xpum_stress_options_t options = {};
+    options.stressTime = request->stresstime();
+    options.profiles = request->profiles();
+    options.targetUtilization = request->targetutilization();
+    options.traceInterval = request->traceinterval();
+    xpum_result_t res = xpumRunStressWithOptions(request->deviceid(), &options);
     if (res != XPUM_OK) {
         switch (res) {
             case XPUM_LEVEL_ZERO_INITIALIZATION_ERROR:
                 response->set_errormsg("Level Zero Initialization Error");
                 break;
+            case XPUM_RESULT_STRESS_INVALID_OPTIONS:
+                response->set_errormsg("invalid stress profiles or target utilization");
+                break;
+            case XPUM_INTERVAL_INVALID:
+                response->set_errormsg("invalid stress trace interval");
+                break;
             case XPUM_RESULT_DIAGNOSTIC_TASK_NOT_COMPLETE:
                 response->set_errormsg(
                         "last stress task on the device is not completed");
@@ -2638,6 +3442,10 @@ std::string XpumCoreServiceImpl::eccActionToString(xpum_ecc_action_t action) {
 
 ::grpc::Status XpumCoreServiceImpl::precheck(::grpc::ServerContext* context, const ::PrecheckOptionsRequest* request,
                                     ::PrecheckComponentInfoListResponse* response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     int count = 32;
     xpum_precheck_component_info_t resultList[count];
     xpum_precheck_options options = {request->onlygpu(), request->sincetime().c_str()};
@@ -2689,6 +3497,10 @@ std::string XpumCoreServiceImpl::eccActionToString(xpum_ecc_action_t action) {
 };
 
 ::grpc::Status XpumCoreServiceImpl::genDebugLog(::grpc::ServerContext* context, const ::FileName* request, ::GenDebugLogResponse *response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_result_t res = xpumGenerateDebugLog(request->filename().c_str());
     if (res != XPUM_OK) {
         if (res == XPUM_RESULT_FILE_DUP) {
@@ -2703,7 +3515,91 @@ std::string XpumCoreServiceImpl::eccActionToString(xpum_ecc_action_t action) {
     return grpc::Status::OK;
 }
 
+::grpc::Status XpumCoreServiceImpl::getInternalStats(::grpc::ServerContext* context, const ::google::protobuf::Empty* request, ::InternalStatsResponse* response) {
+    std::vector<xpum_internal_stats_t> dataList;
+    uint32_t count = 0;
+    xpum_result_t res = xpumGetInternalStats(nullptr, &count);
+    // entries may be added between the two calls
+    while (res == XPUM_OK || res == XPUM_BUFFER_TOO_SMALL) {
+        dataList.resize(count);
+        res = xpumGetInternalStats(dataList.data(), &count);
+        if (res == XPUM_OK) {
+            break;
+        }
+    }
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        response->set_errormsg("Error");
+        return grpc::Status::OK;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        auto& stats = dataList[i];
+        auto data = response->add_datalist();
+        data->mutable_type()->set_value(stats.type);
+        data->set_name(stats.name);
+        data->set_deviceid(stats.deviceId);
+        data->set_count(stats.count);
+        data->set_errorcount(stats.errorCount);
+        data->set_sum(stats.sum);
+        data->set_max(stats.max);
+        data->set_p50(stats.p50);
+        data->set_p90(stats.p90);
+        data->set_p99(stats.p99);
+    }
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::getSamplingCost(::grpc::ServerContext* context, const ::SamplingCostRequest* request, ::SamplingCostResponse* response) {
+    // the devices are read back to back, it takes seconds
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
+    uint32_t count = 0;
+    xpum_result_t res = xpumGetSamplingCost(request->deviceid(), request->iterations(), request->targetoverhead(), nullptr, &count);
+    std::vector<xpum_sampling_cost_t> dataList(count);
+    if (res == XPUM_OK) {
+        res = xpumGetSamplingCost(request->deviceid(), request->iterations(), request->targetoverhead(), dataList.data(), &count);
+    }
+    response->set_errorno(res);
+    if (res != XPUM_OK) {
+        switch (res) {
+            case XPUM_RESULT_DEVICE_NOT_FOUND:
+                response->set_errormsg("device not found");
+                break;
+            case XPUM_BUFFER_TOO_SMALL:
+                response->set_errormsg("the metrics changed while the costs were measured");
+                break;
+            default:
+                response->set_errormsg("Error");
+                break;
+        }
+        return grpc::Status::OK;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        auto& cost = dataList[i];
+        auto data = response->add_datalist();
+        data->set_deviceid(cost.deviceId);
+        data->set_name(cost.name);
+        data->set_samples(cost.samples);
+        data->set_errorcount(cost.errorCount);
+        data->set_latency(cost.latency);
+        data->set_maxlatency(cost.maxLatency);
+        data->set_cputime(cost.cpuTime);
+        data->set_lockwait(cost.lockWait);
+        data->set_drivertime(cost.driverTime);
+        data->set_drivercalls(cost.driverCalls);
+        data->set_currentinterval(cost.currentInterval);
+        data->set_recommendedinterval(cost.recommendedInterval);
+    }
+    return grpc::Status::OK;
+}
+
 ::grpc::Status XpumCoreServiceImpl::doVgpuPrecheck(::grpc::ServerContext* context, const ::google::protobuf::Empty* request, ::VgpuPrecheckResponse *response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::LONG_RUNNING);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_vgpu_precheck_result_t result;
     xpum_result_t res = xpumDoVgpuPrecheck(&result);
     if (res != XPUM_OK) {
@@ -2720,29 +3616,68 @@ std::string XpumCoreServiceImpl::eccActionToString(xpum_ecc_action_t action) {
     return grpc::Status::OK;
 }
 
+static std::string createVfErrorMessage(xpum_result_t res) {
+    if (res == XPUM_VGPU_INVALID_LMEM) {
+        return "Invalid virtual GPU local memory";
+    } else if (res == XPUM_VGPU_INVALID_NUMVFS) {
+        return "Invalid number of virtual GPUs";
+    } else if (res == XPUM_VGPU_DIRTY_PF) {
+        return "Please clear virtual GPUs first";
+    } else if (res == XPUM_VGPU_VF_UNSUPPORTED_OPERATION) {
+        return "Do not creating virtual GPUs on virtual device";
+    } else if (res == XPUM_VGPU_CREATE_VF_FAILED) {
+        return "Fail to create virtual GPUs";
+    } else if (res == XPUM_VGPU_NO_CONFIG_FILE) {
+        return "vGPU configuration file doesn't exist";
+    } else if (res == XPUM_VGPU_SYSFS_ERROR) {
+        return "Error in sysfs";
+    } else if (res == XPUM_VGPU_UNSUPPORTED_DEVICE_MODEL) {
+        return "Unsupported device model";
+    } else if (res == XPUM_RESULT_VGPU_PROVISION_RUNNING) {
+        return "Virtual GPUs are being created or removed on the device";
+    } else {
+        return "Error";
+    }
+}
+
 ::grpc::Status XpumCoreServiceImpl::createVf(::grpc::ServerContext* context, const ::VgpuCreateVfRequest* request, ::VgpuCreateVfResponse *response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_vgpu_config_t config{request->numvfs(), request->lmempervf()};
     xpum_result_t res = xpumCreateVf(request->deviceid(), &config);
     if (res != XPUM_OK) {
-        if (res == XPUM_VGPU_INVALID_LMEM) {
-            response->set_errormsg("Invalid virtual GPU local memory");
-        } else if (res == XPUM_VGPU_INVALID_NUMVFS) {
-            response->set_errormsg("Invalid number of virtual GPUs");
-        } else if (res == XPUM_VGPU_DIRTY_PF) {
-            response->set_errormsg("Please clear virtual GPUs first");
-        } else if (res == XPUM_VGPU_VF_UNSUPPORTED_OPERATION) {
-            response->set_errormsg("Do not creating virtual GPUs on virtual device");
-        } else if (res == XPUM_VGPU_CREATE_VF_FAILED) {
-            response->set_errormsg("Fail to create virtual GPUs");
-        } else if (res == XPUM_VGPU_NO_CONFIG_FILE) {
-            response->set_errormsg("vGPU configuration file doesn't exist");
-        } else if (res == XPUM_VGPU_SYSFS_ERROR) {
-            response->set_errormsg("Error in sysfs");
-        } else if (res == XPUM_VGPU_UNSUPPORTED_DEVICE_MODEL) {
-            response->set_errormsg("Unsupported device model");
-        } else {
-            response->set_errormsg("Error");
-        }
+        response->set_errormsg(createVfErrorMessage(res));
+    }
+    response->set_errorno(res);
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::createVfAsync(::grpc::ServerContext* context, const ::VgpuCreateVfRequest* request, ::VgpuCreateVfResponse *response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
+    xpum_vgpu_config_t config{request->numvfs(), request->lmempervf()};
+    xpum_result_t res = xpumCreateVfAsync(request->deviceid(), &config);
+    if (res != XPUM_OK) {
+        response->set_errormsg(createVfErrorMessage(res));
+    }
+    response->set_errorno(res);
+    return grpc::Status::OK;
+}
+
+::grpc::Status XpumCoreServiceImpl::getVgpuProvisionStatus(::grpc::ServerContext* context, const ::VgpuProvisionStatusRequest* request, ::VgpuProvisionStatusResponse *response) {
+    xpum_vgpu_provision_status_t status = {};
+    xpum_result_t res = xpumGetVgpuProvisionStatus(request->deviceid(), &status);
+    if (res != XPUM_OK) {
+        response->set_errormsg(createVfErrorMessage(res));
+    } else {
+        response->set_running(status.running);
+        response->set_numvfs(status.numVfs);
+        response->set_numvfsdone(status.numVfsDone);
+        response->set_result(status.result);
     }
     response->set_errorno(res);
     return grpc::Status::OK;
@@ -2775,10 +3710,16 @@ std::string XpumCoreServiceImpl::eccActionToString(xpum_ecc_action_t action) {
 }
 
 ::grpc::Status XpumCoreServiceImpl::removeAllVf(::grpc::ServerContext* context, const ::VgpuRemoveAllVfRequest* request, ::VgpuRemoveAllVfResponse *response) {
+    RpcSlot slot(getRpcSlotPool(), RpcClass::CONTROL);
+    if (!slot.isAcquired()) {
+        return slot.getBusyStatus();
+    }
     xpum_result_t res = xpumRemoveAllVf(request->deviceid());
     if (res != XPUM_OK) {
         if (res == XPUM_VGPU_REMOVE_VF_FAILED) {
             response->set_errormsg("Fail to remove all virtual GPUs");
+        } else if (res == XPUM_RESULT_VGPU_PROVISION_RUNNING) {
+            response->set_errormsg("Virtual GPUs are being created or removed on the device");
         } else if (res == XPUM_VGPU_SYSFS_ERROR) {
             response->set_errormsg("Error in sysfs");
         } else if (res == XPUM_VGPU_UNSUPPORTED_DEVICE_MODEL) {
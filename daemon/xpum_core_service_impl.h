@@ -13,9 +13,12 @@
 #include <grpc/grpc.h>
 
 #include <atomic>
+#include <map>
+#include <string>
 
 #include "core.grpc.pb.h"
 #include "core.pb.h"
+#include "rpc_admission.h"
 #include "xpum_api.h"
 #include "xpum_structs.h"
 
@@ -30,9 +33,17 @@ class XpumCoreServiceImpl : public XpumCoreService::Service {
 
     void close();
 
+    // the admission slots of the server of the service
+    virtual RpcSlotPool& getRpcSlotPool() {
+        return RpcSlotPool::privileged();
+    }
+
     virtual grpc::Status getVersion(grpc::ServerContext* context, const google::protobuf::Empty* request,
                                     XpumVersionInfoArray* response) override;
 
+    virtual grpc::Status getDataVersion(grpc::ServerContext* context, const google::protobuf::Empty* request,
+                                        XpumDataVersion* response) override;
+
     virtual grpc::Status getDeviceList(grpc::ServerContext* context, const google::protobuf::Empty* request,
                                        XpumDeviceBasicInfoArray* response) override;
 
@@ -42,6 +53,8 @@ class XpumCoreServiceImpl : public XpumCoreService::Service {
 
     virtual grpc::Status getDeviceProperties(grpc::ServerContext* context, const DeviceId* request, XpumDeviceProperties* response) override;
 
+    virtual grpc::Status getAllDeviceProperties(grpc::ServerContext* context, const google::protobuf::Empty* request, GetAllDevicePropertiesResponse* response) override;
+
     virtual grpc::Status getDeviceIdByBDF(grpc::ServerContext* context, const DeviceBDF* request, DeviceId* response) override;
 
     virtual grpc::Status getTopology(grpc::ServerContext* context, const DeviceId* request,
@@ -49,6 +62,8 @@ class XpumCoreServiceImpl : public XpumCoreService::Service {
 
     virtual ::grpc::Status groupCreate(::grpc::ServerContext* context, const ::GroupName* request,
                                        ::GroupInfo* response) override;
+    virtual ::grpc::Status groupCreateBySelector(::grpc::ServerContext* context, const ::GroupCreateBySelectorRequest* request,
+                                                 ::GroupInfo* response) override;
     virtual ::grpc::Status groupDestory(::grpc::ServerContext* context, const ::GroupId* request,
                                         ::GroupInfo* response) override;
     virtual ::grpc::Status groupAddDevice(::grpc::ServerContext* context, const ::GroupAddRemoveDevice* request,
@@ -71,6 +86,8 @@ class XpumCoreServiceImpl : public XpumCoreService::Service {
                                           ::DiagnosticsTaskInfo* response) override;
     virtual ::grpc::Status getDiagnosticsResult(::grpc::ServerContext* context, const ::DeviceId* request,
                                                 ::DiagnosticsTaskInfo* response) override;
+    virtual ::grpc::Status watchDiagnostics(::grpc::ServerContext* context, const ::DeviceId* request,
+                                            ::grpc::ServerWriter<DiagnosticsTaskInfo>* writer) override;
     virtual ::grpc::Status getDiagnosticsMediaCodecResult(::grpc::ServerContext* context, const ::DeviceId* request, 
                                                 ::DiagnosticsMediaCodecInfoArray* response) override;
     virtual ::grpc::Status getDiagnosticsXeLinkThroughputResult(::grpc::ServerContext* context, const ::DeviceId* request, 
@@ -106,9 +123,30 @@ class XpumCoreServiceImpl : public XpumCoreService::Service {
     virtual ::grpc::Status getStatisticsNotForPrometheus(::grpc::ServerContext* context, const ::XpumGetStatsRequest* request, ::XpumGetStatsResponse* response);
     virtual ::grpc::Status getStatisticsByGroupNotForPrometheus(::grpc::ServerContext* context, const ::XpumGetStatsByGroupRequest* request, ::XpumGetStatsResponse* response);
 
+    virtual ::grpc::Status getMetricsHistory(::grpc::ServerContext* context, const ::XpumGetMetricsHistoryRequest* request, ::XpumGetMetricsHistoryResponse* response) override;
+
+    virtual ::grpc::Status getMetricsHistograms(::grpc::ServerContext* context, const ::DeviceId* request, ::XpumGetMetricsHistogramsResponse* response) override;
+
+    virtual ::grpc::Status getThrottleResidency(::grpc::ServerContext* context, const ::DeviceId* request, ::XpumGetThrottleResidencyResponse* response) override;
+
+    virtual ::grpc::Status getHostTelemetry(::grpc::ServerContext* context, const ::google::protobuf::Empty* request, ::XpumGetHostTelemetryResponse* response) override;
+    virtual ::grpc::Status openJobWindow(::grpc::ServerContext* context, const ::XpumOpenJobWindowRequest* request, ::XpumJobWindowResponse* response) override;
+    virtual ::grpc::Status getMetricsAggregatedByGroup(::grpc::ServerContext* context, const ::GroupId* request, ::XpumGetMetricsAggregatedByGroupResponse* response) override;
+    virtual ::grpc::Status getJobWindowStats(::grpc::ServerContext* context, const ::XpumJobWindowRequest* request, ::XpumJobWindowResponse* response) override;
+    virtual ::grpc::Status closeJobWindow(::grpc::ServerContext* context, const ::XpumJobWindowRequest* request, ::XpumJobWindowResponse* response) override;
+
+    virtual ::grpc::Status startBurstSampling(::grpc::ServerContext* context, const ::XpumStartBurstSamplingRequest* request, ::XpumBurstSamplingResponse* response) override;
+    virtual ::grpc::Status getBurstSamples(::grpc::ServerContext* context, const ::XpumBurstSamplingRequest* request, ::XpumBurstSamplingResponse* response) override;
+    virtual ::grpc::Status stopBurstSampling(::grpc::ServerContext* context, const ::XpumBurstSamplingRequest* request, ::XpumBurstSamplingResponse* response) override;
+    virtual ::grpc::Status getDeviceClockCorrelation(::grpc::ServerContext* context, const ::DeviceId* request, ::XpumClockCorrelationResponse* response) override;
+
+    virtual ::grpc::Status getAppCounterEfficiency(::grpc::ServerContext* context, const ::DeviceId* request, ::XpumAppCounterEfficiencyResponse* response) override;
+
     virtual ::grpc::Status runFirmwareFlash(::grpc::ServerContext* context, const ::XpumFirmwareFlashJob* request, ::XpumFirmwareFlashJobResponse* response) override;
     virtual ::grpc::Status getFirmwareFlashResult(::grpc::ServerContext* context, const ::XpumFirmwareFlashTaskRequest* request, ::XpumFirmwareFlashTaskResult* response) override;
 
+    virtual ::grpc::Status watchFirmwareFlash(::grpc::ServerContext* context, const ::XpumFirmwareFlashTaskRequest* request, ::grpc::ServerWriter<XpumFirmwareFlashTaskResult>* writer) override;
+
     virtual ::grpc::Status getPolicy(::grpc::ServerContext* context, const ::GetPolicyRequest* request, ::GetPolicyResponse* response) override;
     virtual ::grpc::Status setPolicy(::grpc::ServerContext* context, const ::SetPolicyRequest* request, ::SetPolicyResponse* response) override;
     virtual ::grpc::Status readPolicyNotifyData(::grpc::ServerContext* context, const google::protobuf::Empty* request, grpc::ServerWriter<ReadPolicyNotifyDataResponse>* writer) override;
@@ -121,12 +159,16 @@ class XpumCoreServiceImpl : public XpumCoreService::Service {
     virtual ::grpc::Status setDeviceStandbyMode(::grpc::ServerContext* context, const ::ConfigDeviceStandbyRequest* request, ::ConfigDeviceResultData* response) override;
     virtual ::grpc::Status getDeviceProcessState(::grpc::ServerContext* context, const ::DeviceId* request, ::DeviceProcessStateResponse* response) override;
     virtual ::grpc::Status getDeviceComponentOccupancyRatio(::grpc::ServerContext* context, const ::DeviceComponentOccupancyRatioRequest* request, ::DeviceComponentOccupancyRatioResponse* response) override;
+
+    virtual ::grpc::Status getPerfMetrics(::grpc::ServerContext* context, const ::GetPerfMetricsRequest* request, ::GetPerfMetricsResponse* response) override;
+    virtual ::grpc::Status getTopdownRatios(::grpc::ServerContext* context, const ::TopdownRatiosRequest* request, ::DeviceComponentOccupancyRatioResponse* response) override;
     virtual ::grpc::Status getDeviceUtilizationByProcess(::grpc::ServerContext* context, const ::DeviceUtilizationByProcessRequest* request, ::DeviceUtilizationByProcessResponse* response) override;
     virtual ::grpc::Status getAllDeviceUtilizationByProcess(::grpc::ServerContext* context, const ::UtilizationInterval* request, ::DeviceUtilizationByProcessResponse* response) override;
     virtual ::grpc::Status resetDevice(::grpc::ServerContext* context, const ::ResetDeviceRequest* request, ::ResetDeviceResponse* response) override;
     virtual ::grpc::Status applyPPR(::grpc::ServerContext* context, const ::ApplyPprRequest* request, ::ApplyPprResponse* response) override;
     virtual ::grpc::Status getPerformanceFactor(::grpc::ServerContext* context, const ::DeviceDataRequest* request, ::DevicePerformanceFactorResponse* response) override;
     virtual ::grpc::Status setPerformanceFactor(::grpc::ServerContext* context, const ::PerformanceFactor* request, ::DevicePerformanceFactorSettingResponse* response) override;
+    virtual ::grpc::Status setDeviceConfigBatch(::grpc::ServerContext* context, const ::ConfigDeviceBatchRequest* request, ::ConfigDeviceBatchResponse* response) override;
     virtual ::grpc::Status setDeviceFabricPortEnabled(::grpc::ServerContext* context, const ::ConfigDeviceFabricPortEnabledRequest* request, ::ConfigDeviceResultData* response) override;
     virtual ::grpc::Status setDeviceFabricPortBeaconing(::grpc::ServerContext* context, const ::ConfigDeviceFabricPortBeconingRequest* request, ::ConfigDeviceResultData* response) override;
     virtual ::grpc::Status setDeviceMemoryEccState(::grpc::ServerContext* context, const ::ConfigDeviceMemoryEccStateRequest* request, ::ConfigDeviceMemoryEccStateResultData* response) override;
@@ -146,10 +188,21 @@ class XpumCoreServiceImpl : public XpumCoreService::Service {
     virtual ::grpc::Status getEngineStatistics(::grpc::ServerContext* context, const ::XpumGetEngineStatsRequest* request, ::XpumGetEngineStatsResponse* response) override;
     virtual ::grpc::Status getEngineCount(::grpc::ServerContext* context, const ::GetEngineCountRequest* request, ::GetEngineCountResponse* response) override;
     virtual ::grpc::Status getXelinkTopology(::grpc::ServerContext* context, const ::google::protobuf::Empty* request, ::XpumXelinkTopoInfoArray* response) override;
+    virtual ::grpc::Status getPlacementAdvice(::grpc::ServerContext* context, const ::XpumPlacementAdviceRequest* request, ::XpumPlacementAdviceResponse* response) override;
+    virtual ::grpc::Status runXeLinkMatrix(::grpc::ServerContext* context, const ::XpumRunXeLinkMatrixRequest* request, ::XpumXeLinkMatrixResponse* response) override;
+    virtual ::grpc::Status getXeLinkMatrix(::grpc::ServerContext* context, const ::google::protobuf::Empty* request, ::XpumXeLinkMatrixResponse* response) override;
 
     virtual ::grpc::Status getFabricStatistics(::grpc::ServerContext* context, const ::GetFabricStatsRequest* request, ::GetFabricStatsResponse* response) override;
     virtual ::grpc::Status getFabricStatisticsEx(::grpc::ServerContext* context, const ::GetFabricStatsExRequest* request, ::GetFabricStatsResponse* response) override;
 
+    virtual ::grpc::Status getStatisticsBulk(::grpc::ServerContext* context, const ::XpumGetStatsBulkRequest* request, ::XpumGetStatsBulkResponse* response) override;
+
+    virtual ::grpc::Status getTelemetrySnapshot(::grpc::ServerContext* context, const ::XpumGetTelemetrySnapshotRequest* request, ::XpumGetTelemetrySnapshotResponse* response) override;
+
+    virtual ::grpc::Status getStatisticsPacked(::grpc::ServerContext* context, const ::XpumGetPackedStatsRequest* request, ::XpumGetPackedStatsResponse* response) override;
+
+    virtual ::grpc::Status subscribeMetrics(::grpc::ServerContext* context, const ::XpumSubscribeMetricsRequest* request, ::grpc::ServerWriter<MetricsFrame>* writer) override;
+
     virtual ::grpc::Status getFabricCount(::grpc::ServerContext* context, const ::GetFabricCountRequest* request, ::GetFabricCountResponse* response) override;
 
     virtual ::grpc::Status getAMCSensorReading(::grpc::ServerContext* context, const ::google::protobuf::Empty* request, ::GetAMCSensorReadingResponse* response) override;
@@ -158,6 +211,10 @@ class XpumCoreServiceImpl : public XpumCoreService::Service {
 
     virtual ::grpc::Status genDebugLog(::grpc::ServerContext* context, const ::FileName* request, ::GenDebugLogResponse *response) override;
 
+    virtual ::grpc::Status getInternalStats(::grpc::ServerContext* context, const ::google::protobuf::Empty* request, ::InternalStatsResponse* response) override;
+
+    virtual ::grpc::Status getSamplingCost(::grpc::ServerContext* context, const ::SamplingCostRequest* request, ::SamplingCostResponse* response) override;
+
     virtual ::grpc::Status doVgpuPrecheck(::grpc::ServerContext* context, const ::google::protobuf::Empty* request, ::VgpuPrecheckResponse *response) override;
 
     virtual ::grpc::Status createVf(::grpc::ServerContext* context, const ::VgpuCreateVfRequest* request, ::VgpuCreateVfResponse *response) override;
@@ -168,7 +225,23 @@ class XpumCoreServiceImpl : public XpumCoreService::Service {
 
     virtual ::grpc::Status getVfMetrics(::grpc::ServerContext* context, const ::GetVfMetricsRequest* request, ::GetVfMetricsResponse *response) override;
 
+    virtual ::grpc::Status createVfAsync(::grpc::ServerContext* context, const ::VgpuCreateVfRequest* request, ::VgpuCreateVfResponse *response) override;
+
+    virtual ::grpc::Status getVgpuProvisionStatus(::grpc::ServerContext* context, const ::VgpuProvisionStatusRequest* request, ::VgpuProvisionStatusResponse *response) override;
+
    private:
+    // the setters without the admission slot, shared by the single and the batch RPCs
+    void applyDeviceSchedulerMode(const ::ConfigDeviceSchdeulerModeRequest* request, ::ConfigDeviceResultData* response);
+    void applyDevicePowerLimit(const ::ConfigDevicePowerLimitRequest* request, ::ConfigDeviceResultData* response);
+    void applyDeviceFrequencyRange(const ::ConfigDeviceFrequencyRangeRequest* request, ::ConfigDeviceResultData* response);
+    void applyDeviceStandbyMode(const ::ConfigDeviceStandbyRequest* request, ::ConfigDeviceResultData* response);
+    void applyPerformanceFactor(const ::PerformanceFactor* request, ::DevicePerformanceFactorSettingResponse* response);
+
+    void fillDeviceConfigTarget(const ::ConfigDeviceBatchItem& item, ::ConfigDeviceResultData* result);
+    // the checks of a batch item done before any item is applied, tileCounts are cached by device
+    xpum_result_t checkDeviceConfig(const ::ConfigDeviceBatchItem& item, std::map<xpum_device_id_t, int>& tileCounts, std::string& errorMsg);
+    void applyDeviceConfig(const ::ConfigDeviceBatchItem& item, ::ConfigDeviceResultData* result);
+
     std::atomic_bool stop;
     std::mutex dumpRawDataFilenameMtx;
 };
@@ -17,6 +17,9 @@ public:
     virtual ::grpc::Status groupCreate(::grpc::ServerContext* context, const ::GroupName* request, ::GroupInfo* response) override {
         return PD;
     }
+    virtual ::grpc::Status groupCreateBySelector(::grpc::ServerContext* context, const ::GroupCreateBySelectorRequest* request, ::GroupInfo* response) override {
+        return PD;
+    }
     virtual ::grpc::Status groupDestory(::grpc::ServerContext* context, const ::GroupId* request, ::GroupInfo* response) override {
         return PD;
     }
@@ -38,6 +41,9 @@ public:
     virtual ::grpc::Status getDiagnosticsResult(::grpc::ServerContext* context, const ::DeviceId* request, ::DiagnosticsTaskInfo* response) override {
         return PD;
     }
+    virtual ::grpc::Status watchDiagnostics(::grpc::ServerContext* context, const ::DeviceId* request, ::grpc::ServerWriter<DiagnosticsTaskInfo>* writer) override {
+        return PD;
+    }
     virtual ::grpc::Status checkStress(::grpc::ServerContext* context, const ::CheckStressRequest* request, ::CheckStressResponse* response) override {
         return PD;
     }
@@ -62,6 +68,9 @@ public:
     virtual ::grpc::Status getFirmwareFlashResult(::grpc::ServerContext* context, const ::XpumFirmwareFlashTaskRequest* request, ::XpumFirmwareFlashTaskResult* response) override {
         return PD;
     }
+    virtual ::grpc::Status watchFirmwareFlash(::grpc::ServerContext* context, const ::XpumFirmwareFlashTaskRequest* request, ::grpc::ServerWriter<XpumFirmwareFlashTaskResult>* writer) override {
+        return PD;
+    }
     virtual ::grpc::Status setPolicy(::grpc::ServerContext* context, const ::SetPolicyRequest* request, ::SetPolicyResponse* response) override {
         return PD;
     }
@@ -86,6 +95,9 @@ public:
     virtual ::grpc::Status setPerformanceFactor(::grpc::ServerContext* context, const ::PerformanceFactor* request, ::DevicePerformanceFactorSettingResponse* response) override {
         return PD;
     }
+    virtual ::grpc::Status setDeviceConfigBatch(::grpc::ServerContext* context, const ::ConfigDeviceBatchRequest* request, ::ConfigDeviceBatchResponse* response) override {
+        return PD;
+    }
     virtual ::grpc::Status setDeviceFabricPortEnabled(::grpc::ServerContext* context, const ::ConfigDeviceFabricPortEnabledRequest* request, ::ConfigDeviceResultData* response) override {
         return PD;
     }
@@ -106,6 +118,10 @@ public:
         return PD;
     }
 
+    virtual ::grpc::Status createVfAsync(::grpc::ServerContext* context, const ::VgpuCreateVfRequest* request, ::VgpuCreateVfResponse *response) override {
+        return PD;
+    }
+
     virtual ::grpc::Status precheck(::grpc::ServerContext* context, const ::PrecheckOptionsRequest* request, ::PrecheckComponentInfoListResponse* response) override {
         return PD;
     }
@@ -113,6 +129,31 @@ public:
     virtual ::grpc::Status getPrecheckErrorList(::grpc::ServerContext* context, const ::google::protobuf::Empty* request, ::PrecheckErrorListResponse* response) override {
         return PD;
     } 
+
+    virtual ::grpc::Status openJobWindow(::grpc::ServerContext* context, const ::XpumOpenJobWindowRequest* request, ::XpumJobWindowResponse* response) override {
+        return PD;
+    }
+
+    virtual ::grpc::Status closeJobWindow(::grpc::ServerContext* context, const ::XpumJobWindowRequest* request, ::XpumJobWindowResponse* response) override {
+        return PD;
+    }
+
+    virtual ::grpc::Status startBurstSampling(::grpc::ServerContext* context, const ::XpumStartBurstSamplingRequest* request, ::XpumBurstSamplingResponse* response) override {
+        return PD;
+    }
+
+    virtual ::grpc::Status stopBurstSampling(::grpc::ServerContext* context, const ::XpumBurstSamplingRequest* request, ::XpumBurstSamplingResponse* response) override {
+        return PD;
+    }
+
+    virtual ::grpc::Status runXeLinkMatrix(::grpc::ServerContext* context, const ::XpumRunXeLinkMatrixRequest* request, ::XpumXeLinkMatrixResponse* response) override {
+        return PD;
+    }
+
+    virtual RpcSlotPool& getRpcSlotPool() override {
+        return RpcSlotPool::unprivileged();
+    }
+
 private:
     static const grpc::Status PD;
 };
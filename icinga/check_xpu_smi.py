@@ -6,8 +6,12 @@
 #
 
 import argparse
+import fcntl
 import json
+import os
 import sys
+import tempfile
+import time
 
 import subprocess
 
@@ -22,6 +26,9 @@ identity_file = None
 warning_threshold = None
 critical_threshold = None
 
+batch = False
+cache_ttl = None
+
 telemetry_type_list = [
     ("gpu_utilization", dict(key="XPUM_STATS_GPU_UTILIZATION",
      name="GPU Utilization", unit="%", convert=float)),
@@ -63,9 +70,41 @@ def query_cmd(cmd):
     return json.loads(res.stdout.decode())
 
 
+def query_all_devices(cmd, name):
+    # the checks of all the GPUs of a host share one xpu-smi run for all devices, kept
+    # for cache_ttl seconds; the first check of a round runs it, the others wait for it
+    cache_file = os.path.join(tempfile.gettempdir(), "check_xpu_smi_{}_{}.json".format(
+        "local" if local_run else host, name))
+    with open(cache_file + ".lock", "a") as lock:
+        fcntl.flock(lock, fcntl.LOCK_EX)
+        try:
+            if time.time() - os.path.getmtime(cache_file) < cache_ttl:
+                with open(cache_file, "r") as f:
+                    return json.load(f)
+        except (OSError, ValueError):
+            pass
+        data = query_cmd(cmd)
+        tmp_file = cache_file + ".tmp"
+        with open(tmp_file, "w") as f:
+            json.dump(data, f)
+        os.replace(tmp_file, cache_file)
+        return data
+
+
+def find_device(device_list):
+    for d in device_list:
+        if str(d.get("device_id")) == str(deviceId):
+            return d
+    print("Critical: No data of device {}".format(deviceId))
+    exit(2)
+
+
 def checkTelemetry():
 
-    data = query_cmd("sudo xpu-smi stats -d {} -j".format(deviceId))
+    if batch:
+        data = find_device(query_all_devices("sudo xpu-smi stats -l -j", "stats").get("datas", []))
+    else:
+        data = query_cmd("sudo xpu-smi stats -d {} -j".format(deviceId))
 
     ok_list = []
     warning_list = []
@@ -199,7 +238,10 @@ health_type_dict = dict(health_type_list)
 
 
 def checkHealth():
-    data = query_cmd("sudo xpu-smi health -d {} -j".format(deviceId))
+    if batch:
+        data = find_device(query_all_devices("sudo xpu-smi health -l -j", "health").get("device_list", []))
+    else:
+        data = query_cmd("sudo xpu-smi health -d {} -j".format(deviceId))
     ok_list = []
     warning_list = []
     critical_list = []
@@ -260,6 +302,11 @@ def arg():
     parser.add_argument(
         '-l', '--local_run', help="Run locally without SSH.", action='store_true')
 
+    parser.add_argument(
+        '-b', '--batch', help="Query all the GPUs of the host in one xpu-smi run shared by the checks", action='store_true')
+    parser.add_argument(
+        '--cache_ttl', type=float, default=50, help="Seconds the result of a batch query is reused, default 50")
+
     for k in telemetry_type_dict:
         v = telemetry_type_dict[k]
         parser.add_argument('--{}_warning'.format(k), type=v['convert'],
@@ -275,6 +322,8 @@ def arg():
     global username
     global identity_file
     global local_run
+    global batch
+    global cache_ttl
 
     host = parsed.host
     port = parsed.port
@@ -282,6 +331,8 @@ def arg():
     deviceId = parsed.deviceId
     identity_file = parsed.identity
     local_run = parsed.local_run
+    batch = parsed.batch
+    cache_ttl = parsed.cache_ttl
 
     global warning_threshold
     global critical_threshold
@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2021-2023 Intel Corporation
+# SPDX-License-Identifier: MIT
+# @file xpum_dump_convert.py
+#
+
+# Convert a binary raw data dump (xpumcli dump --rawdata --format binary)
+# to CSV, to a Chrome trace event JSON, or to Parquet when pyarrow is available.
+
+import argparse
+import datetime
+import json
+import math
+import struct
+import sys
+
+MAGIC = b"XPUMDUMP"
+VERSION = 1
+CELL_SIZE = 8
+
+COLUMN_FLOAT64 = 0
+COLUMN_TIMESTAMP = 1
+COLUMN_UINT64 = 2
+
+UINT64_MAX = 0xFFFFFFFFFFFFFFFF
+
+# the frequency throttle reason flags, in the order of the dump
+THROTTLE_REASONS = ["AVE_PWR_CAP", "BURST_PWR_CAP", "CURRENT_LIMIT",
+                    "THERMAL_LIMIT", "PSU_ALERT", "SW_RANGE", "HW_RANGE"]
+
+
+def read_header(f):
+    magic = f.read(len(MAGIC))
+    if magic != MAGIC:
+        raise ValueError("not a binary dump file")
+    version, count = struct.unpack("<II", f.read(8))
+    if version != VERSION:
+        raise ValueError("unsupported dump format version {}".format(version))
+    columns = []
+    for _ in range(count):
+        col_type, _reserved, name_len = struct.unpack("<BBH", f.read(4))
+        columns.append((f.read(name_len).decode("utf-8"), col_type))
+    return columns
+
+
+def read_rows(f, columns, chunk_rows=4096):
+    formats = "".join("d" if t == COLUMN_FLOAT64 else "Q" for _, t in columns)
+    row = struct.Struct("<" + formats)
+    while True:
+        buf = f.read(row.size * chunk_rows)
+        if len(buf) < row.size:
+            return
+        usable = len(buf) - len(buf) % row.size
+        for values in row.iter_unpack(buf[:usable]):
+            yield values
+
+
+def cell_to_python(value, col_type):
+    if col_type == COLUMN_FLOAT64:
+        return None if math.isnan(value) else value
+    if value == UINT64_MAX:
+        return None
+    return value
+
+
+def format_csv_cell(value, col_type, show_date):
+    value = cell_to_python(value, col_type)
+    # a missing value, NaN or UINT64_MAX in the dump, is an empty cell
+    if value is None:
+        return ""
+    if col_type == COLUMN_TIMESTAMP:
+        t = datetime.datetime.fromtimestamp(value / 1000)
+        fmt = "%Y-%m-%dT%H:%M:%S" if show_date else "%H:%M:%S"
+        return t.strftime(fmt) + ".{:03d}".format(value % 1000)
+    if col_type == COLUMN_FLOAT64:
+        # the fixed two decimals of the scaled values of the CSV dump
+        return "{:.2f}".format(value)
+    return str(value)
+
+
+def to_csv(f, columns, out, show_date):
+    out.write(", ".join(name for name, _ in columns) + "\n")
+    for values in read_rows(f, columns):
+        out.write(",".join(format_csv_cell(v, t, show_date)
+                           for v, (_, t) in zip(values, columns)) + "\n")
+
+
+def to_parquet(f, columns, path):
+    try:
+        import pyarrow as pa
+        import pyarrow.parquet as pq
+    except ImportError:
+        sys.exit("pyarrow is required to write Parquet files")
+    types = {COLUMN_FLOAT64: pa.float64(),
+             COLUMN_TIMESTAMP: pa.timestamp("ms"),
+             COLUMN_UINT64: pa.uint64()}
+    schema = pa.schema([(name, types[t]) for name, t in columns])
+    data = [[] for _ in columns]
+    for values in read_rows(f, columns):
+        for i, (v, (_, t)) in enumerate(zip(values, columns)):
+            data[i].append(cell_to_python(v, t))
+    pq.write_table(pa.Table.from_arrays(
+        [pa.array(d, type=schema.field(i).type) for i, d in enumerate(data)],
+        schema=schema), path)
+
+
+def throttle_reasons_name(value):
+    return " | ".join(name for i, name in enumerate(THROTTLE_REASONS) if value & (1 << i))
+
+
+def to_chrome_trace(f, columns, out):
+    # the same tracks as a dump task of trace format: a process per device with a
+    # counter per column, and a slice per run of the same throttle reasons
+    names = [name for name, _ in columns]
+    device_index = names.index("DeviceId") if "DeviceId" in names else None
+    tile_index = names.index("TileId") if "TileId" in names else None
+    time_index = names.index("Timestamp")
+    events = []
+    devices = set()
+    last_throttle = {}
+    for values in read_rows(f, columns):
+        ts = values[time_index] * 1000
+        device_id = 0 if device_index is None else cell_to_python(values[device_index], COLUMN_UINT64)
+        for i, (name, col_type) in enumerate(columns):
+            if i in (time_index, device_index, tile_index):
+                continue
+            value = cell_to_python(values[i], col_type)
+            if value is None:
+                continue
+            pid = device_id
+            # the columns of the wide layout are named by device
+            if name.startswith("GPU ") and name.split(" ")[1].isdigit():
+                pid = int(name.split(" ")[1])
+                name = name.split(" ", 2)[2]
+            devices.add(pid)
+            if col_type == COLUMN_UINT64:
+                last = last_throttle.get((pid, name))
+                if last == value:
+                    continue
+                if last:
+                    events.append(dict(name="", ph="E", ts=ts, pid=pid, tid=0))
+                if value:
+                    events.append(dict(name=throttle_reasons_name(value), ph="B", ts=ts, pid=pid, tid=0))
+                last_throttle[(pid, name)] = value
+            else:
+                events.append(dict(name=name, ph="C", ts=ts, pid=pid, tid=0, args=dict(value=value)))
+    for pid in sorted(devices):
+        events.insert(0, dict(name="process_name", ph="M", pid=pid,
+                              args=dict(name="GPU {}".format(pid))))
+    json.dump(dict(traceEvents=events, displayTimeUnit="ms"), out)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(
+        description="Convert a binary raw data dump to CSV, Chrome trace or Parquet")
+    parser.add_argument("input", help="the binary dump file")
+    parser.add_argument("-o", "--output",
+                        help="output file, CSV is written to stdout if not set")
+    parser.add_argument("-f", "--format", choices=["csv", "chrome-trace", "parquet"],
+                        help="output format, guessed from the output file name if not set")
+    parser.add_argument("--date", action="store_true",
+                        help="show date in the CSV timestamp")
+    args = parser.parse_args()
+
+    out_format = args.format
+    if out_format is None:
+        out_format = "parquet" if args.output and args.output.endswith(".parquet") else "csv"
+    if out_format == "parquet" and not args.output:
+        sys.exit("an output file is required for Parquet")
+
+    with open(args.input, "rb") as f:
+        columns = read_header(f)
+        if out_format == "parquet":
+            to_parquet(f, columns, args.output)
+        elif out_format == "chrome-trace":
+            if args.output:
+                with open(args.output, "w") as out:
+                    to_chrome_trace(f, columns, out)
+            else:
+                to_chrome_trace(f, columns, sys.stdout)
+        elif args.output:
+            with open(args.output, "w") as out:
+                to_csv(f, columns, out, args.date)
+        else:
+            to_csv(f, columns, sys.stdout, args.date)
@@ -0,0 +1,113 @@
+#
+# Copyright (C) 2021-2023 Intel Corporation
+# SPDX-License-Identifier: MIT
+# @file http_cache.py
+#
+
+import functools
+import gzip
+import hashlib
+import os
+
+from flask import request, make_response
+
+import stub
+import xpum_logger as logger
+
+try:
+    import brotli
+except ImportError:
+    brotli = None
+
+# the bodies smaller than it are sent as is
+compress_min_size = int(os.environ.get('XPUM_REST_COMPRESS_MIN_SIZE', '1024'))
+
+compressed_types = {'application/json', 'text/plain', 'text/html'}
+
+
+def _data_version(version):
+    """
+    The version tuple of the data a response of the version kind is made
+    of, None if it can not be read or nothing is stored yet.
+    """
+    try:
+        code, _, data = stub.getDataVersion()
+    except Exception as e:
+        logger.debug('failed to get data version: %s', e)
+        return None
+    if code != 0:
+        return None
+    if version == 'topology':
+        return (data['topology_version'],)
+    if data['generation'] == 0:
+        return None
+    return (data['generation'], data['topology_version'])
+
+
+def etag(version):
+    """
+    Decorates a GET view whose response only changes with the version of
+    the data, 'data' for the generation of the data stored by the monitor
+    or 'topology' for the PCI devices. The response gets a weak ETag of the
+    version and the request URL, a request with a matching If-None-Match
+    gets 304 Not Modified without the view being called.
+    """
+    def decorator(view):
+        @functools.wraps(view)
+        def wrapper(*args, **kwargs):
+            current = _data_version(version)
+            if current is None:
+                return view(*args, **kwargs)
+            tag = hashlib.sha1(repr((version, current, request.full_path)).encode()).hexdigest()
+            if request.if_none_match.contains_weak(tag):
+                response = make_response('', 304)
+                response.set_etag(tag, weak=True)
+                return response
+            response = make_response(view(*args, **kwargs))
+            if response.status_code == 200:
+                response.set_etag(tag, weak=True)
+                # a client keeps the response but asks if it is still valid every time
+                response.headers['Cache-Control'] = 'no-cache'
+            return response
+        return wrapper
+    return decorator
+
+
+def _accepted_encoding():
+    accepted = request.accept_encodings
+    if brotli is not None and accepted['br'] > 0 and accepted['br'] >= accepted['gzip']:
+        return 'br'
+    if accepted['gzip'] > 0:
+        return 'gzip'
+    return None
+
+
+def compress_response(response):
+    """
+    Compresses the body with the best encoding the client accepts, br if
+    the brotli module is installed or gzip. For app.after_request.
+    """
+    if compress_min_size < 0 or request.method == 'HEAD' or response.status_code != 200:
+        return response
+    if response.direct_passthrough or 'Content-Encoding' in response.headers:
+        return response
+    if response.mimetype not in compressed_types:
+        return response
+    response.vary.add('Accept-Encoding')
+    encoding = _accepted_encoding()
+    if encoding is None:
+        return response
+    body = response.get_data()
+    if len(body) < compress_min_size:
+        return response
+    if encoding == 'br':
+        body = brotli.compress(body, quality=5)
+    else:
+        body = gzip.compress(body, compresslevel=5)
+    response.set_data(body)
+    response.headers['Content-Encoding'] = encoding
+    etag, weak = response.get_etag()
+    if etag is not None and not weak:
+        # the compressed body differs from the one the strong ETag is of
+        response.set_etag(etag, weak=True)
+    return response
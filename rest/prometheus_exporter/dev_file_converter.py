@@ -10,27 +10,45 @@ import glob
 
 dev_file_2_bdf_map = {}
 
+# the BDF address of each device id seen, the device ids of the kubelet are resolved once
+device_id_2_bdf_cache = {}
+
 pci_slot_name_pattern = re.compile(
     '^PCI_SLOT_NAME=([0-9a-fA-F]{4}:[0-9a-fA-F]{2}:[0-9a-fA-F]{2}\.[0-9a-fA-F]{1}\S*)')
 
 dev_file_pattern = re.compile('(card\d+)\-\d*')
 
-for dev_file in glob.glob("/dev/dri/card*"):
-    dev_file_basename = os.path.basename(dev_file)
-    with open(f'/sys/class/drm/{dev_file_basename}/device/uevent', 'r') as f:
-        for line in f.readlines():
-            line = line.strip()
-            match = pci_slot_name_pattern.match(line)
-            if match is not None:
-                dev_file_2_bdf_map[dev_file_basename] = match.group(1)
+
+def load_dev_files():
+    for dev_file in glob.glob("/dev/dri/card*"):
+        dev_file_basename = os.path.basename(dev_file)
+        with open(f'/sys/class/drm/{dev_file_basename}/device/uevent', 'r') as f:
+            for line in f.readlines():
+                line = line.strip()
+                match = pci_slot_name_pattern.match(line)
+                if match is not None:
+                    dev_file_2_bdf_map[dev_file_basename] = match.group(1)
+
+
+load_dev_files()
 
 
 def get_bdf_address(dev_file):
+    if dev_file in device_id_2_bdf_cache:
+        return device_id_2_bdf_cache[dev_file]
+
+    bdf = None
     device_id_match = dev_file_pattern.fullmatch(dev_file)
     if device_id_match is not None:
-        return dev_file_2_bdf_map.get(device_id_match.group(1))
-
-    return None
+        card = device_id_match.group(1)
+        if card not in dev_file_2_bdf_map:
+            # a card added after the start
+            load_dev_files()
+        bdf = dev_file_2_bdf_map.get(card)
+
+    if bdf is not None:
+        device_id_2_bdf_cache[dev_file] = bdf
+    return bdf
 
 
 if __name__ == '__main__':
@@ -4,6 +4,10 @@
 # @file kube_pod_resource.py
 #
 
+import os
+import threading
+import time
+
 import grpc
 import api_pb2_grpc as apigrpc
 import api_pb2 as apipb2
@@ -12,15 +16,61 @@ from dev_file_converter import get_bdf_address
 
 KUBELET_SOCKET = 'unix:///var/lib/kubelet/pod-resources/kubelet.sock'
 
+# the seconds between two List calls of the background refresh
+POD_RESOURCE_REFRESH_INTERVAL = float(os.environ.get('XPUM_EXPORTER_POD_RESOURCE_REFRESH_INTERVAL', '5'))
 
-def get_pod_resources():
+# the seconds a List call waits for the kubelet
+POD_RESOURCE_LIST_TIMEOUT = float(os.environ.get('XPUM_EXPORTER_POD_RESOURCE_LIST_TIMEOUT', '5'))
+
+
+class PodResourceCache:
+    """The BDF to pod mapping of the kubelet, refreshed in the background
+
+    The kubelet pod resources API has no watch, so a thread calls List on
+    one channel every POD_RESOURCE_REFRESH_INTERVAL seconds. The scrapes
+    read the last mapping from memory and are not held by a slow List
+    during pod churn. When a List fails, the last mapping is kept.
+    """
+
+    def __init__(self):
+        self._lock = threading.Lock()
+        self._loaded = threading.Event()
+        self._resources = {}
+        self._thread = None
+        self._channel = None
+
+    def get(self):
+        self._start()
+        # the first scrape waits for the first List
+        self._loaded.wait(POD_RESOURCE_LIST_TIMEOUT)
+        with self._lock:
+            return self._resources
+
+    def _start(self):
+        with self._lock:
+            if self._thread is not None:
+                return
+            self._thread = threading.Thread(
+                target=self._run, name='podResourceRefresh', daemon=True)
+            self._thread.start()
 
-    ret = {}
-    try:
-        with grpc.insecure_channel(KUBELET_SOCKET) as channel:
+    def _run(self):
+        while True:
+            resources = self._list()
+            if resources is not None:
+                with self._lock:
+                    self._resources = resources
+            self._loaded.set()
+            time.sleep(POD_RESOURCE_REFRESH_INTERVAL)
 
-            pod_resource_lister = apigrpc.PodResourcesListerStub(channel)
-            res = pod_resource_lister.List(apipb2.ListPodResourcesRequest())
+    def _list(self):
+        ret = {}
+        try:
+            if self._channel is None:
+                self._channel = grpc.insecure_channel(KUBELET_SOCKET)
+            pod_resource_lister = apigrpc.PodResourcesListerStub(self._channel)
+            res = pod_resource_lister.List(
+                apipb2.ListPodResourcesRequest(), timeout=POD_RESOURCE_LIST_TIMEOUT)
 
             for pod_resource in res.pod_resources:
                 for container in pod_resource.containers:
@@ -35,11 +85,25 @@ def get_pod_resources():
                                         'container': container.name,
                                         'device_id': device_id
                                     }
-    except grpc._channel._InactiveRpcError as e:
-        print('grpc channel is inactive')
-    except Exception as e:
-        print('failed to get pod resource list due to: ', e)
-    return ret
+        except grpc.RpcError as e:
+            print('grpc channel is inactive')
+            return None
+        except Exception as e:
+            print('failed to get pod resource list due to: ', e)
+            return None
+        return ret
+
+
+pod_resource_cache = PodResourceCache()
+
+
+def get_pod_resources():
+    return pod_resource_cache.get()
+
+
+def get_pod_bdf_addresses(namespace, pod):
+    return [bdf for bdf, info in get_pod_resources().items()
+            if info['namespace'] == namespace and info['pod'] == pod]
 
 
 if __name__ == '__main__':
@@ -4,19 +4,60 @@
 # @file prometheus_exporter.py
 #
 
-from prometheus_client import CollectorRegistry, Gauge, Counter, generate_latest
+from prometheus_client.utils import floatToGoString
+
+from concurrent.futures import ThreadPoolExecutor
 
 import os
+import threading
+import time
 import traceback
 
-from prometheus_exporter_types import device_to_card_aggregators, tile_to_device_aggregators, metrics_map
-from itertools import filterfalse, groupby
+from prometheus_exporter_types import metrics_map, histograms_map
 
 import xpum_logger as logger
 
+# the metric families of each device, tile and card, in the order they are registered
 registries = {}
 counter_values = {}
 
+# the label sets and serialised label blocks, reused until the devices or the pod mapping change
+label_sets = {}
+series_labels = {}
+label_blocks = {}
+interned_for = [None, None]
+
+# seconds the slow changing sections are reused for before they are requested again
+TOPOLOGY_LINK_TTL = int(os.environ.get('XPUM_EXPORTER_TOPOLOGY_LINK_TTL', '300'))
+XELINK_PORT_STATUS_TTL = int(os.environ.get('XPUM_EXPORTER_XELINK_PORT_STATUS_TTL', '30'))
+
+# the histograms of every sample kept by the daemon, 0 to leave them out of the scrapes
+EXPORT_HISTOGRAMS = os.environ.get('XPUM_EXPORTER_HISTOGRAMS', '1') != '0'
+
+# the job window the exporter keeps open on all the devices, the energy of its processes is exported
+EXPORTER_JOB_ID = os.environ.get('XPUM_EXPORTER_JOB_ID', 'xpum-exporter')
+exporter_job_devices = [None]
+
+# the gRPC requests of a scrape are issued concurrently, the registries are still updated by one thread
+executor = ThreadPoolExecutor(max_workers=8)
+
+section_cache = {}
+section_cache_lock = threading.Lock()
+
+
+def get_cached(key, ttl, fetch):
+    now = time.monotonic()
+    with section_cache_lock:
+        cached = section_cache.get(key)
+        if cached is not None and now - cached[0] < ttl:
+            return cached[1]
+    result = fetch()
+    # only successful responses are kept, a failed one is retried on the next scrape
+    if result[0] == 0:
+        with section_cache_lock:
+            section_cache[key] = (now, result)
+    return result
+
 
 def get_metrics(core, pod_resources):
 
@@ -25,36 +66,128 @@ def get_metrics(core, pod_resources):
         code, _, devices = core.getDeviceList()
         if code != 0:
             return f'#nodata: failed to get devices ({code})', 500
+        check_interned_labels(devices, pod_resources)
+
+        # statistics, per engine and fabric statistics of all devices in one call
+        stats_future = executor.submit(
+            core.getStatisticsBulk, session_id=1, get_accumulated=True)
+        topology_future = executor.submit(
+            get_cached, 'topology_link', TOPOLOGY_LINK_TTL, core.getTopologyLink)
+        port_futures = {}
+        for dev in devices:
+            device_id = dev.get('device_id')
+            port_futures[device_id] = executor.submit(
+                get_cached, ('xelink_port_status', device_id), XELINK_PORT_STATUS_TTL,
+                lambda device_id=device_id: core.getXelinkPortHealth(device_id, session_id=1))
+        histogram_futures = {}
+        if EXPORT_HISTOGRAMS:
+            for dev in devices:
+                device_id = dev.get('device_id')
+                histogram_futures[device_id] = executor.submit(
+                    core.getMetricsHistograms, device_id)
+        residency_futures = {}
+        for dev in devices:
+            device_id = dev.get('device_id')
+            residency_futures[device_id] = executor.submit(
+                core.getThrottleResidency, device_id)
+        host_future = executor.submit(core.getHostTelemetry)
+        process_energy_future = executor.submit(
+            get_process_energy, core, devices)
+
+        code, _, bulk_stats = stats_future.result()
+        if code != 0:
+            return f'#nodata: failed to get statistics ({code})', 500
+        # the tile to device and device to card aggregations are done by the daemon
+        all_stats = bulk_stats['devices']
 
-        resp_devices, all_device_data = process_device_stats(
-            core, pod_resources, devices)
-        resp_cards = process_card_stats(core, pod_resources, all_device_data)
+        resp_devices = process_device_stats(
+            pod_resources, devices, all_stats)
+        resp_cards = process_card_stats(pod_resources, bulk_stats['cards'])
         resp_per_engine = process_per_engine_stats(
-            core, pod_resources, devices)
+            pod_resources, devices, all_stats)
         resp_fabric_throughput = process_fabric_stats(
-            core, pod_resources, devices)
+            pod_resources, devices, all_stats)
 
         resp_topology_link = process_topology_link(
-            core, pod_resources, devices)
+            pod_resources, devices, topology_future.result())
 
+        port_stats = {device_id: future.result()
+                      for device_id, future in port_futures.items()}
         resp_xelink_port_status = process_xelink_port_stats(
-            core, pod_resources, devices)
+            pod_resources, devices, port_stats)
+
+        histograms = {device_id: future.result()
+                      for device_id, future in histogram_futures.items()}
+        resp_histograms = process_histograms(
+            pod_resources, devices, histograms)
 
-        return tidy_response(resp_devices + resp_cards + resp_per_engine + resp_fabric_throughput + resp_topology_link + resp_xelink_port_status)
+        residencies = {device_id: future.result()
+                       for device_id, future in residency_futures.items()}
+        resp_throttle_residency = process_throttle_residency(
+            pod_resources, devices, residencies)
+
+        resp_host = process_host_telemetry(
+            pod_resources, host_future.result())
+
+        resp_process_energy = process_process_energy(
+            pod_resources, devices, process_energy_future.result())
+
+        return tidy_response(''.join([resp_devices, resp_cards, resp_per_engine, resp_fabric_throughput, resp_topology_link, resp_xelink_port_status, resp_histograms, resp_throttle_residency, resp_host, resp_process_energy]))
     except Exception as e:
         traceback.print_exc()
         return "#nodata: due to unexpected failure", 500
 
-def process_xelink_port_stats(core, pod_resources, devices):
+def get_process_energy(core, devices):
+    device_ids = sorted(dev.get('device_id') for dev in devices)
+    if exporter_job_devices[0] == device_ids:
+        result = core.getJobWindowStats(EXPORTER_JOB_ID)
+        if result[0] == 0:
+            return result
+    # the window of an earlier exporter, of other devices, or lost with a restart of the daemon, is opened again
+    core.closeJobWindow(EXPORTER_JOB_ID)
+    code, message, _ = core.openJobWindow(EXPORTER_JOB_ID, device_ids)
+    if code != 0:
+        return code, message, None
+    exporter_job_devices[0] = device_ids
+    return core.getJobWindowStats(EXPORTER_JOB_ID)
+
+def process_process_energy(pod_resources, devices, process_energy):
 
-    resp = b''
+    code, _, data = process_energy
+
+    if code != 0:
+        return ''
+
+    resp = []
 
     for dev in devices:
 
         device_id = dev.get('device_id')
+        data_list = []
 
-        stat_code, _, stat_data = core.getXelinkPortHealth(
-            device_id, session_id=1)
+        for process in data['process_list']:
+            if process.get('device_id') != device_id:
+                continue
+            process['metrics_type'] = 'XPUM_JOB_PROCESS_ENERGY'
+            data_list.append(process)
+
+        # a counter reset by a reopened window starts new series
+        r = convert_to_prometheus_metrics(
+            pod_resources, dev, data_list, device_id, None)
+
+        resp.append(r)
+
+    return ''.join(resp)
+
+def process_xelink_port_stats(pod_resources, devices, port_stats):
+
+    resp = []
+
+    for dev in devices:
+
+        device_id = dev.get('device_id')
+
+        stat_code, _, stat_data = port_stats.get(device_id, (-1, None, None))
 
         if stat_code != 0:
             continue
@@ -67,18 +200,76 @@ def process_xelink_port_stats(core, pod_resources, devices):
         r = convert_to_prometheus_metrics(
             pod_resources, dev, data_list, device_id, None)
 
-        resp = resp + r
+        resp.append(r)
 
-    return resp
+    return ''.join(resp)
+
+def process_histograms(pod_resources, devices, histograms):
+
+    resp = []
+
+    for dev in devices:
+
+        device_id = dev.get('device_id')
+
+        code, _, data = histograms.get(device_id, (-1, None, None))
+
+        if code != 0:
+            continue
 
-def process_topology_link(core, pod_resources, devices):
+        for histogram in data['histograms']:
+            resp.append(convert_to_prometheus_histogram(
+                pod_resources, dev, histogram, device_id, histogram.get('tile_id')))
 
-    resp = b''
+    return ''.join(resp)
 
-    stat_code, _, stat_data = core.getTopologyLink()
+def process_throttle_residency(pod_resources, devices, residencies):
+
+    resp = []
+
+    for dev in devices:
+
+        device_id = dev.get('device_id')
+
+        code, _, data = residencies.get(device_id, (-1, None, None))
+
+        if code != 0:
+            continue
+
+        for residency in data['residencies']:
+            residency['metrics_type'] = 'XPUM_STATS_THROTTLE_RESIDENCY'
+            resp.append(convert_to_prometheus_metrics(
+                pod_resources, dev, [residency], device_id, residency.get('tile_id')))
+
+    return ''.join(resp)
+
+def process_host_telemetry(pod_resources, host_telemetry):
+
+    code, _, data = host_telemetry
+
+    # the host telemetry is off unless the daemon runs with XPUM_HOST_TELEMETRY=1
+    if code != 0:
+        return ''
+
+    datalist = []
+    for socket in data['sockets']:
+        socket['metrics_type'] = 'XPUM_HOST_SOCKET_TELEMETRY'
+        datalist.append(socket)
+    for stack in data['stacks']:
+        stack['metrics_type'] = 'XPUM_HOST_IIO_STACK_TELEMETRY'
+        datalist.append(stack)
+
+    return convert_to_prometheus_metrics(pod_resources, dev=None, datalist=datalist)
+
+
+def process_topology_link(pod_resources, devices, topology):
+
+    resp = []
+
+    stat_code, _, stat_data = topology
 
     if stat_code != 0 or 'topology_link' not in stat_data:
-        return resp
+        return ''
 
     for dev in devices:
 
@@ -94,22 +285,21 @@ def process_topology_link(core, pod_resources, devices):
         r = convert_to_prometheus_metrics(
             pod_resources, dev, data_list, device_id, None)
 
-        resp = resp + r
+        resp.append(r)
 
-    return resp
+    return ''.join(resp)
 
-def process_fabric_stats(core, pod_resources, devices):
+def process_fabric_stats(pod_resources, devices, all_stats):
 
-    resp = b''
+    resp = []
 
     for dev in devices:
 
         device_id = dev.get('device_id')
 
-        stat_code, _, stat_data = core.getFabricStatistics(
-            device_id, session_id=1, get_accumulated=True)
+        stat_data = all_stats.get(device_id)
 
-        if stat_code != 0 or 'fabric_throughput' not in stat_data:
+        if stat_data is None or 'fabric_throughput' not in stat_data:
             continue
 
         data_list = []
@@ -144,32 +334,32 @@ def process_fabric_stats(core, pod_resources, devices):
         s = convert_to_prometheus_metrics(
             pod_resources, dev, throughput_data_list, device_id, None)
 
-        resp = resp + r + s
+        resp.append(r)
+        resp.append(s)
 
-    return resp
+    return ''.join(resp)
 
 
-def process_per_engine_stats(core, pod_resources, devices):
+def process_per_engine_stats(pod_resources, devices, all_stats):
 
-    resp = b''
+    resp = []
 
     for dev in devices:
 
         device_id = dev.get('device_id')
 
-        stat_code, _, stat_data = core.getEngineStatistics(
-            device_id, session_id=1)
+        stat_data = all_stats.get(device_id)
 
-        if stat_code != 0 or 'engine_util' not in stat_data:
+        if stat_data is None or 'engine_util' not in stat_data:
             continue
 
         for tile_id, data_map in stat_data['engine_util'].items():
             flatten_per_engine_datalist = flatten_per_engine_data(data_map)
             r = convert_to_prometheus_metrics(
                 pod_resources, dev, flatten_per_engine_datalist, device_id, None if tile_id == 'device_level' else tile_id)
-            resp = resp + r
+            resp.append(r)
 
-    return resp
+    return ''.join(resp)
 
 
 def flatten_per_engine_data(data_map):
@@ -182,161 +372,160 @@ def flatten_per_engine_data(data_map):
     return data_list
 
 
-def process_device_stats(core, pod_resources, devices):
+def process_device_stats(pod_resources, devices, all_stats):
 
-    resp = b''
-    all_device_data = {}
+    resp = []
 
     for dev in devices:
 
         device_id = dev.get('device_id')
 
-        stat_code, _, stat_data = core.getStatistics(
-            device_id, session_id=1, get_accumulated=True)
+        stat_data = all_stats.get(device_id)
 
-        if stat_code != 0:
+        if stat_data is None:
             continue
 
-            # aggregate tile metrics so that they will be exported at device level
-        aggregate_tile_to_device(stat_data)
-
         if 'device_level' in stat_data:
 
-            # store all device data in dict for later card level aggregation
-            all_device_data[device_id] = stat_data['device_level']
-
             # export device metrics to Prometheus registry
             r = convert_to_prometheus_metrics(
                 pod_resources, dev, stat_data['device_level'], device_id)
-            resp = resp + r
+            resp.append(r)
 
         # export tile metrics to Prometheus registry
         for tile_data in stat_data.get('tile_level', []):
             r = convert_to_prometheus_metrics(
                 pod_resources, dev, tile_data['data_list'], device_id, tile_data['tile_id'])
-            resp = resp + r
+            resp.append(r)
 
-    return resp, all_device_data
+    return ''.join(resp)
 
 
-def process_card_stats(core, pod_resources, all_device_data):
-    resp = b''
-    all_card_data = aggregate_device_to_card(core, all_device_data)
+def process_card_stats(pod_resources, all_card_data):
+    resp = []
     for card_id, card_data in all_card_data.items():
         r = convert_to_prometheus_metrics(
             pod_resources, dev=None, datalist=card_data, card_id=card_id)
-        resp = resp + r
-    return resp
+        resp.append(r)
+    return ''.join(resp)
 
 
-def aggregate_device_to_card(core, all_device_data):
-
-    INVALID_GROUP_ID = 0
-    device_to_card_map = {}
-    # construct mapping "device->card"
-    code, _, data = core.getAllGroups()
-    if code != 0:
-        return f'#nodata: failed to get cards ({code})', 500
-
-    for group in data:
-        group_id = group.get('group_id')
-        # only process built-in groups (i.e., cards) whose group id has 1 as the highest bit
-        if group_id is None or group_id & 0x80000000 != 0x80000000:
-            continue
-
-        for device_id in group.get('device_id_list', []):
-            # a device should belong to one card at most, no check here
-            device_to_card_map[device_id] = group_id
-
-    # group all device data by card
-    groups_data = [(device_to_card_map.get(x, INVALID_GROUP_ID),
-                    all_device_data[x]) for x in all_device_data]
-
-    def key_func(x): return x[0]
-    groups_data = sorted(groups_data, key=key_func)
-    groups_data = groupby(groups_data, key_func)
-    def filter_func(x): return x[0] == INVALID_GROUP_ID
-    valid_groups_data = filterfalse(filter_func, groups_data)
-
-    all_card_data = {}
-    for card_id, data_list in valid_groups_data:
-        # group card data by metric type
-        group_data = [x[1] for x in list(data_list)]
-        group_data = [item for sublist in group_data for item in sublist]
-        def key_func(x): return x['metrics_type']
-        group_data_by_type = groupby(
-            sorted(group_data, key=key_func), key_func)
-
-        def filter_func(x): return x[0] not in device_to_card_aggregators
-        group_data_by_type = filterfalse(filter_func, group_data_by_type)
-
-        # aggregate device data to card
-        aggregate_data(group_data_by_type, device_to_card_aggregators,
-                       all_card_data.setdefault(card_id, []))
-
-    return all_card_data
-
-
-def aggregate_tile_to_device(stat_data):
-
-    device_level = stat_data.get('device_level', {})
-    device_metrics = [x['metrics_type'] for x in device_level]
-    # group tile data by metrics_type
-    tile_level = [x['data_list'] for x in stat_data.get('tile_level', [])]
-    # groupby needs sorted list by the same key_func
-    def key_func(x): return x['metrics_type']
-    tile_level = sorted(
-        [item for sublist in tile_level for item in sublist], key=key_func)
-    tiles_data_by_type = groupby(tile_level, key_func)
-    # device_level already has this metric, skip aggregation from tile
-    def filter_func(
-        x): return x[0] not in tile_to_device_aggregators or x[0] in device_metrics
-    tiles_data_by_type = filterfalse(filter_func, tiles_data_by_type)
-
-    # aggregate tile data to device
-    aggregate_data(tiles_data_by_type,
-                   tile_to_device_aggregators, device_level)
-
-    stat_data['device_level'] = device_level
-
-
-def aggregate_data(data_by_type, data_aggregators, target_list):
-    for metric_type, data in data_by_type:
-        data = list(data)
-        device_data = {'metrics_type': metric_type}
-        for value_type in data[0]:
-            if value_type in data_aggregators[metric_type]:
-                agg = tile_to_device_aggregators[metric_type][value_type]
-                value_list = [x[value_type] for x in data]
-                agg_value = agg(value_list)
-                device_data[value_type] = agg_value
-                device_data['agg_func'] = agg.__name__
-        target_list.append(device_data)
-
-
-def tidy_response(resp):
-    resp_str = resp.decode('UTF-8')
-    comments = []
-    metrics = []
+def tidy_response(resp_str):
+    # dicts drop the duplicates from the shared registries and keep the first-seen order
+    comments = {}
+    metrics = {}
     for line in resp_str.splitlines():
         if not line.startswith('#'):
-            if line not in metrics:
-                metrics.append(line)
-        elif line not in comments:
-            comments.append(line)
-    metrics.sort()
-    return '\n'.join(comments + metrics)
+            metrics[line] = None
+        else:
+            comments[line] = None
+    return '\n'.join(list(comments) + sorted(metrics))
+
+
+class MetricFamily:
+    """A gauge or a counter of a registry
+
+    The text is the one of generate_latest of prometheus_client: the
+    counters have the _total samples and the _created gauges, the labels
+    are sorted by name. The label block of each label set is serialised
+    once and reused by the next scrapes.
+    """
+
+    def __init__(self, name, documentation, is_counter, labelnames):
+        self.name = name
+        self.is_counter = is_counter
+        self.labelnames = tuple(labelnames)
+        doc = documentation.replace('\\', r'\\').replace('\n', r'\n')
+        if is_counter:
+            self.header = f'# HELP {name}_total {doc}\n# TYPE {name}_total counter\n'
+            self.created_header = f'# HELP {name}_created {doc}\n# TYPE {name}_created gauge\n'
+        else:
+            self.header = f'# HELP {name} {doc}\n# TYPE {name} gauge\n'
+        # the value and the creation time of each label value tuple
+        self.children = {}
+
+    def labels(self, labelvalues):
+        child = self.children.get(labelvalues)
+        if child is None:
+            child = self.children[labelvalues] = [0.0, time.time()]
+        return child
+
+    def remove(self, labelvalues):
+        self.children.pop(labelvalues, None)
+
+    def clear(self):
+        self.children.clear()
+
+    def render(self, output):
+        output.append(self.header)
+        sample_name = f'{self.name}_total' if self.is_counter else self.name
+        for labelvalues, child in self.children.items():
+            output.append(
+                f'{sample_name}{label_block(self.labelnames, labelvalues)} {floatToGoString(child[0])}\n')
+        if self.is_counter and self.children:
+            output.append(self.created_header)
+            for labelvalues, child in self.children.items():
+                output.append(
+                    f'{self.name}_created{label_block(self.labelnames, labelvalues)} {floatToGoString(child[1])}\n')
+
+
+def label_block(labelnames, labelvalues):
+    key = (labelnames, labelvalues)
+    block = label_blocks.get(key)
+    if block is None:
+        pairs = sorted(zip(labelnames, labelvalues))
+        block = '{' + ','.join('{}="{}"'.format(name, value.replace('\\', r'\\').replace('\n', r'\n').replace('"', r'\"'))
+                               for name, value in pairs) + '}' if pairs else ''
+        label_blocks[key] = block
+    return block
+
+
+def check_interned_labels(devices, pod_resources):
+    topology = tuple((dev.get('device_id'), dev.get('uuid'), dev.get('device_name'), dev.get('pci_device_id'),
+                      dev.get('vendor_name'), dev.get('pci_bdf_address'), dev.get('drm_device')) for dev in devices)
+    if interned_for[0] != topology or interned_for[1] != pod_resources:
+        label_sets.clear()
+        series_labels.clear()
+        label_blocks.clear()
+        interned_for[0] = topology
+        interned_for[1] = dict(pod_resources) if pod_resources is not None else None
+
+
+def get_label_set(pod_resources, dev, device_id, tile_id, card_id):
+    key = (device_id if dev is not None else None, tile_id, card_id)
+    label_set = label_sets.get(key)
+    if label_set is None:
+        labels, label_values = build_dev_labels(dev)
+        attach_kube_labels(dev, labels, label_values, pod_resources)
+        attach_tile_labels(labels, label_values, tile_id)
+        attach_card_labels(labels, label_values, card_id)
+        label_set = label_sets[key] = (key, labels, label_values)
+    return label_set
+
+
+def get_series_labels(label_set, metric, stat):
+    ext_labelnames = metric.prom_metric.ext_labelnames
+    ext_values = ()
+    if ext_labelnames is not None and len(ext_labelnames) > 0:
+        ext_values = tuple(get_ext_label_value(
+            metric.ext_labels, key, stat) for key in ext_labelnames)
+    src = stat.get('agg_func', 'direct')
+    key = (label_set[0], metric.prom_metric.name, ext_values, src)
+    series = series_labels.get(key)
+    if series is None:
+        all_labelnames, all_labelvalues, ext_labelvalues = attach_ext_labels(
+            label_set[1], label_set[2], ext_labelnames, metric.ext_labels, stat)
+        attach_src_label(all_labelnames, all_labelvalues, src)
+        series = series_labels[key] = (tuple(all_labelnames), tuple(
+            str(value) for value in all_labelvalues), ext_labelvalues)
+    return series
 
 
 def convert_to_prometheus_metrics(pod_resources, dev, datalist, device_id=None, tile_id=None, card_id=None):
-    labels, label_values = build_dev_labels(dev)
-    attach_kube_labels(dev, labels, label_values, pod_resources)
-    attach_tile_labels(labels, label_values, tile_id)
-    attach_card_labels(labels, label_values, card_id)
+    label_set = get_label_set(pod_resources, dev, device_id, tile_id, card_id)
 
     metrics_owner = f'card:{card_id}_gpu:{device_id}_tile:{tile_id}'
-    registry, metrics = registries.setdefault(
-        metrics_owner, (CollectorRegistry(), {}))
+    metrics = registries.setdefault(metrics_owner, {})
 
     if 'xpum_topology_link' in metrics:
         metrics['xpum_topology_link'].clear()
@@ -355,55 +544,85 @@ def convert_to_prometheus_metrics(pod_resources, dev, datalist, device_id=None,
         for metric in metrics_list:
             metric_name = metric.prom_metric.name
 
-            val = stat.get(metric.xpum_field) * metric.scale
+            val = float(stat.get(metric.xpum_field) * metric.scale)
 
-            all_labelnames, all_labelvalues, ext_labelvalues = attach_ext_labels(
-                labels, label_values, metric.prom_metric.ext_labelnames, metric.ext_labels, stat)
-
-            attach_src_label(all_labelnames, all_labelvalues,
-                             stat.get('agg_func', 'direct'))
+            all_labelnames, all_labelvalues, ext_labelvalues = get_series_labels(
+                label_set, metric, stat)
 
             counter_key = f'{metrics_owner}_{metric_name}_{ext_labelvalues}'
 
             if metric_name not in metrics:
+                metrics[metric_name] = MetricFamily(
+                    metric_name, metric.prom_metric.desc, metric.is_counter, all_labelnames)
                 if metric.is_counter:
                     # counter value
-                    metrics[metric_name] = Counter(
-                        metric_name, metric.prom_metric.desc, labelnames=all_labelnames, registry=registry)
-                    mm = metrics[metric_name].labels(*all_labelvalues)
                     counter_values[counter_key] = val
-                    mm.inc(val)
+                    metrics[metric_name].labels(all_labelvalues)[0] += val
                 else:
                     # aggregated value
-                    metrics[metric_name] = Gauge(
-                        metric_name, metric.prom_metric.desc, labelnames=all_labelnames, registry=registry)
-                    metrics[metric_name].labels(*all_labelvalues).set(val)
-            else:
-                if metric.is_counter:
-                    # counter value
-                    mm = metrics[metric_name].labels(*all_labelvalues)
-                    pre_value = counter_values.setdefault(counter_key, 0)
-                    if val >= pre_value:
-                        counter_values[counter_key] = val
-                        mm.inc(val-pre_value)
-                    elif metric.process_counter_wrap:
-                        logger.info(
-                            'counter wrapped, %s: pre=%d, cur=%d, create new counter', metric_name, pre_value, val)
-                        # remove the existing metric child
-                        metrics[metric_name].remove(*all_labelvalues)
-                        del counter_values[counter_key]
-                        # create new metric child
-                        mm = metrics[metric_name].labels(*all_labelvalues)
-                        counter_values[counter_key] = val
-                        mm.inc(val)
-                    else:
-                        logger.warn(
-                            'counter decreased, %s: pre=%d, cur=%d, ignore it', metric_name, pre_value, val)
+                    metrics[metric_name].labels(all_labelvalues)[0] = val
+            elif metric.is_counter:
+                # counter value
+                mm = metrics[metric_name].labels(all_labelvalues)
+                pre_value = counter_values.setdefault(counter_key, 0)
+                if val >= pre_value:
+                    counter_values[counter_key] = val
+                    mm[0] += val - pre_value
+                elif metric.process_counter_wrap:
+                    logger.info(
+                        'counter wrapped, %s: pre=%d, cur=%d, create new counter', metric_name, pre_value, val)
+                    # remove the existing metric child
+                    metrics[metric_name].remove(all_labelvalues)
+                    del counter_values[counter_key]
+                    # create new metric child
+                    mm = metrics[metric_name].labels(all_labelvalues)
+                    counter_values[counter_key] = val
+                    mm[0] += val
                 else:
-                    # aggregated value
-                    metrics[metric_name].labels(*all_labelvalues).set(val)
-
-    return generate_latest(registry)
+                    logger.warn(
+                        'counter decreased, %s: pre=%d, cur=%d, ignore it', metric_name, pre_value, val)
+            else:
+                # aggregated value
+                metrics[metric_name].labels(all_labelvalues)[0] = val
+
+    output = []
+    for family in metrics.values():
+        family.render(output)
+    return ''.join(output)
+
+
+def convert_to_prometheus_histogram(pod_resources, dev, histogram, device_id=None, tile_id=None):
+    """Fold the bins of a daemon histogram into the buckets of its family
+
+    The daemon never resets the histograms, the buckets are cumulative
+    like the ones of prometheus_client. A bin is counted in the buckets at
+    or above its upper bound, which is within 1% of the real one.
+    """
+    metric = histograms_map.get(histogram.get('metrics_type'))
+    if metric is None:
+        return ''
+    label_set = get_label_set(pod_resources, dev, device_id, tile_id, None)
+    labelnames, labelvalues, _ = get_series_labels(label_set, metric, histogram)
+
+    name = metric.prom_metric.name
+    doc = metric.prom_metric.desc.replace('\\', r'\\').replace('\n', r'\n')
+    output = [f'# HELP {name} {doc}\n# TYPE {name} histogram\n']
+    bucket_labelnames = labelnames + ('le',)
+    bins = histogram['bins']
+    i = 0
+    seen = 0
+    for bound in metric.buckets:
+        while i < len(bins) and bins[i][0] * metric.scale <= bound:
+            seen += bins[i][1]
+            i += 1
+        output.append(
+            f'{name}_bucket{label_block(bucket_labelnames, labelvalues + (floatToGoString(bound),))} {floatToGoString(seen)}\n')
+    output.append(
+        f'{name}_bucket{label_block(bucket_labelnames, labelvalues + ("+Inf",))} {floatToGoString(histogram["count"])}\n')
+    block = label_block(labelnames, labelvalues)
+    output.append(f'{name}_sum{block} {floatToGoString(histogram["sum"] * metric.scale)}\n')
+    output.append(f'{name}_count{block} {floatToGoString(histogram["count"])}\n')
+    return ''.join(output)
 
 
 def build_dev_labels(dev):
@@ -460,16 +679,19 @@ def attach_src_label(labels, label_values, src):
     label_values.append(src)
 
 
+def get_ext_label_value(ext_labels, key, stat):
+    value: str = ext_labels.get(key, 'n/a')
+    if value.startswith('$') and stat is not None:
+        value = stat.get(value[1:], 'n/a')
+    return value
+
+
 def attach_ext_labels(labels, label_values, ext_labelnames, ext_labels, stat=None):
     if ext_labelnames is not None and len(ext_labelnames) > 0:
         all_labelnames = labels + ext_labelnames
 
-        ext_labelvalues = []
-        for key in ext_labelnames:
-            value: str = ext_labels.get(key, 'n/a')
-            if value.startswith('$') and stat is not None:
-                value = stat.get(value[1:], 'n/a')
-            ext_labelvalues.append(value)
+        ext_labelvalues = [get_ext_label_value(
+            ext_labels, key, stat) for key in ext_labelnames]
         all_labelvalues = label_values + ext_labelvalues
         return all_labelnames, all_labelvalues, str(ext_labelvalues)
     return labels.copy(), label_values.copy(), ''
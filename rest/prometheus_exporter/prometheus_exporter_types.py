@@ -62,6 +62,27 @@ class PromMetric(Enum):
 
     # Xelink Port Status
     xpum_xelink_port_status = ('xpum_xelink_port_status', 'The Xelink port status', ['device_id', 'description'])
+
+    # Histograms of every sample since the daemon started
+    xpum_power_sample_watts = ('xpum_power_sample_watts', 'Distribution of the sampled GPU power (in watts), per GPU and per tile')  # nopep8
+    xpum_temperature_sample_celsius = ('xpum_temperature_sample_celsius', 'Distribution of the sampled GPU temperature (in Celsius degree), per GPU and per tile', ['location'])  # nopep8
+    xpum_engine_sample_ratio = ('xpum_engine_sample_ratio', 'Distribution of the sampled GPU active time of the elapsed time (in %), per GPU and per tile')  # nopep8
+    xpum_memory_sample_ratio = ('xpum_memory_sample_ratio', 'Distribution of the sampled used GPU memory / total GPU memory (in %), per GPU and per tile')  # nopep8
+
+    # Throttle residency
+    xpum_throttle_seconds = ('xpum_throttle_seconds', 'Time the GPU frequency was throttled since the daemon started (in seconds), per GPU and per tile, by reason', ['reason'])  # nopep8
+    xpum_throttle_sampled_seconds = ('xpum_throttle_sampled_seconds', 'Time covered by the throttle reason samples since the daemon started (in seconds), per GPU and per tile')  # nopep8
+
+    # Host telemetry, sampled with the PCIe throughput of the GPUs
+    xpum_host_dram_read_bytes = ('xpum_host_dram_read_bytes', 'Total bytes read from DRAM since the daemon started (in bytes), per host socket', ['socket'])  # nopep8
+    xpum_host_dram_write_bytes = ('xpum_host_dram_write_bytes', 'Total bytes written to DRAM since the daemon started (in bytes), per host socket', ['socket'])  # nopep8
+    xpum_host_upi_incoming_bytes = ('xpum_host_upi_incoming_bytes', 'Total data bytes received over the UPI links since the daemon started (in bytes), per host socket', ['socket'])  # nopep8
+    xpum_host_upi_utilization_ratio = ('xpum_host_upi_utilization_ratio', 'Incoming data utilization of the busiest UPI link (in %), per host socket', ['socket'])  # nopep8
+    xpum_host_iio_read_bytes = ('xpum_host_iio_read_bytes', 'Total inbound PCIe read bytes since the daemon started (in bytes), per IIO stack of a host socket', ['socket', 'stack'])  # nopep8
+    xpum_host_iio_write_bytes = ('xpum_host_iio_write_bytes', 'Total inbound PCIe write bytes since the daemon started (in bytes), per IIO stack of a host socket', ['socket', 'stack'])  # nopep8
+
+    # Energy of the processes, attributed by their engine busy time in the job window of the exporter
+    xpum_process_energy_joules = ('xpum_process_energy_joules', 'GPU energy attributed to a process by its engine busy time (in Joules), per GPU, pid 0 for the energy while no process was busy', ['pid', 'process', 'container_id', 'pod_uid'])  # nopep8
     def __new__(cls, name, desc=None, ext_labelnames=[]):
         obj = object.__new__(cls)
         obj._value_ = name
@@ -81,6 +102,16 @@ class Metric:
             'acc' if is_counter else 'avg')
 
 
+class Histogram:
+    """A histogram of every sample of a metric, with the upper bounds of its buckets after scaling"""
+
+    def __init__(self, prom_metric: PromMetric, buckets: list, scale: float = 1, ext_labels: dict = {}) -> None:
+        self.prom_metric = prom_metric
+        self.buckets = buckets
+        self.scale = scale
+        self.ext_labels = ext_labels
+
+
 metrics_map = {
     # Engine utilization
     'XPUM_STATS_GPU_UTILIZATION': Metric(PromMetric.xpum_engine_ratio, scale=0.01),
@@ -143,28 +174,41 @@ metrics_map = {
     'XPUM_STATS_XELINK_THROUGHPUT': Metric(PromMetric.xpum_xelink_throughput, ext_labels={'local_device_id': '$local_device_id', 'local_subdevice_id': '$local_subdevice_id', 'remote_device_id': '$remote_device_id', 'remote_subdevice_id': '$remote_subdevice_id'}),  # nopep8
 
     # Xelink Port Status
-    'XPUM_STATS_XELINK_PORT_STATUS': Metric(PromMetric.xpum_xelink_port_status, ext_labels={'device_id': '$device_id', 'description': '$description'})  # nopep8
+    'XPUM_STATS_XELINK_PORT_STATUS': Metric(PromMetric.xpum_xelink_port_status, ext_labels={'device_id': '$device_id', 'description': '$description'}),  # nopep8
+
+    # Throttle residency, the times are in ms
+    'XPUM_STATS_THROTTLE_RESIDENCY': [
+        Metric(PromMetric.xpum_throttle_sampled_seconds, is_counter=True, xpum_field='sampled_time', scale=0.001),  # nopep8
+        Metric(PromMetric.xpum_throttle_seconds, is_counter=True, xpum_field='throttled_time', scale=0.001, ext_labels={'reason': 'any'}),  # nopep8
+        Metric(PromMetric.xpum_throttle_seconds, is_counter=True, xpum_field='avg_power_cap_time', scale=0.001, ext_labels={'reason': 'avg_power_cap'}),  # nopep8
+        Metric(PromMetric.xpum_throttle_seconds, is_counter=True, xpum_field='burst_power_cap_time', scale=0.001, ext_labels={'reason': 'burst_power_cap'}),  # nopep8
+        Metric(PromMetric.xpum_throttle_seconds, is_counter=True, xpum_field='current_limit_time', scale=0.001, ext_labels={'reason': 'current_limit'}),  # nopep8
+        Metric(PromMetric.xpum_throttle_seconds, is_counter=True, xpum_field='thermal_limit_time', scale=0.001, ext_labels={'reason': 'thermal_limit'}),  # nopep8
+        Metric(PromMetric.xpum_throttle_seconds, is_counter=True, xpum_field='psu_alert_time', scale=0.001, ext_labels={'reason': 'psu_alert'}),  # nopep8
+        Metric(PromMetric.xpum_throttle_seconds, is_counter=True, xpum_field='sw_range_time', scale=0.001, ext_labels={'reason': 'sw_range'}),  # nopep8
+        Metric(PromMetric.xpum_throttle_seconds, is_counter=True, xpum_field='hw_range_time', scale=0.001, ext_labels={'reason': 'hw_range'})],  # nopep8
+
+    # Host telemetry
+    'XPUM_HOST_SOCKET_TELEMETRY': [
+        Metric(PromMetric.xpum_host_dram_read_bytes, is_counter=True, xpum_field='dram_read', ext_labels={'socket': '$socket_id'}),  # nopep8
+        Metric(PromMetric.xpum_host_dram_write_bytes, is_counter=True, xpum_field='dram_write', ext_labels={'socket': '$socket_id'}),  # nopep8
+        Metric(PromMetric.xpum_host_upi_incoming_bytes, is_counter=True, xpum_field='upi_incoming', ext_labels={'socket': '$socket_id'}),  # nopep8
+        Metric(PromMetric.xpum_host_upi_utilization_ratio, xpum_field='upi_utilization', scale=0.01, ext_labels={'socket': '$socket_id'})],  # nopep8
+    'XPUM_HOST_IIO_STACK_TELEMETRY': [
+        Metric(PromMetric.xpum_host_iio_read_bytes, is_counter=True, xpum_field='read', ext_labels={'socket': '$socket_id', 'stack': '$stack_id'}),  # nopep8
+        Metric(PromMetric.xpum_host_iio_write_bytes, is_counter=True, xpum_field='write', ext_labels={'socket': '$socket_id', 'stack': '$stack_id'})],  # nopep8
+
+    # Process energy, the energy is in mJ
+    'XPUM_JOB_PROCESS_ENERGY': Metric(PromMetric.xpum_process_energy_joules, is_counter=True, xpum_field='energy', scale=0.001, ext_labels={'pid': '$process_id', 'process': '$process_name', 'container_id': '$container_id', 'pod_uid': '$pod_uid'}),  # nopep8
 }
 
+ratio_buckets = [0.05, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 0.95, 0.99]
+temperature_buckets = [30, 40, 50, 60, 70, 80, 85, 90, 95, 100, 105, 110]
 
-def avg(x):
-    return sum(x)/len(x) if len(x) > 0 else 0
-
-
-tile_to_device_aggregators = {
-    'XPUM_STATS_POWER': {'avg': sum},
-    'XPUM_STATS_RAS_ERROR_CAT_RESET': {'acc': sum},
-    'XPUM_STATS_RAS_ERROR_CAT_PROGRAMMING_ERRORS': {'acc': sum},
-    'XPUM_STATS_RAS_ERROR_CAT_DRIVER_ERRORS': {'acc': sum},
-    'XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE': {'acc': sum},
-    'XPUM_STATS_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE': {'acc': sum},
-    'XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_CORRECTABLE': {'acc': sum},
-    'XPUM_STATS_RAS_ERROR_CAT_NON_COMPUTE_ERRORS_UNCORRECTABLE': {'acc': sum},
-    'XPUM_STATS_MEMORY_UTILIZATION': {'avg': avg},
-    'XPUM_STATS_MEMORY_BANDWIDTH': {'avg': avg},
-    'XPUM_STATS_GPU_UTILIZATION': {'avg': avg}
-}
-
-device_to_card_aggregators = {
-    'XPUM_STATS_POWER': {'avg': sum},
+histograms_map = {
+    'XPUM_STATS_POWER': Histogram(PromMetric.xpum_power_sample_watts, [10, 25, 50, 75, 100, 150, 200, 250, 300, 350, 400, 450, 500, 600]),
+    'XPUM_STATS_GPU_CORE_TEMPERATURE': Histogram(PromMetric.xpum_temperature_sample_celsius, temperature_buckets, ext_labels={'location': 'gpu'}),
+    'XPUM_STATS_MEMORY_TEMPERATURE': Histogram(PromMetric.xpum_temperature_sample_celsius, temperature_buckets, ext_labels={'location': 'mem'}),
+    'XPUM_STATS_GPU_UTILIZATION': Histogram(PromMetric.xpum_engine_sample_ratio, ratio_buckets, scale=0.01),
+    'XPUM_STATS_MEMORY_UTILIZATION': Histogram(PromMetric.xpum_memory_sample_ratio, ratio_buckets, scale=0.01),
 }
@@ -4,15 +4,15 @@
 # @file __init__.py
 #
 
-from .versions import getVersion
+from .versions import getVersion, getDataVersion
 from .devices import getDeviceList, getDeviceProperties, getAMCFirmwareVersions
 from .health import getHealth, getHealthByGroup, setHealthConfig, setHealthConfigByGroup
 from .diagnostics import runDiagnostics, runDiagnosticsByGroup, getDiagnosticsResult, getDiagnosticsResultByGroup
-from .statistics import getStatistics, getStatisticsByGroup, getStatisticsNotForPrometheus, getStatisticsByGroupNotForPrometheus, getEngineStatistics, getFabricStatistics, getTopologyLink, getXelinkPortHealth
+from .statistics import getStatistics, getStatisticsByGroup, getStatisticsNotForPrometheus, getStatisticsByGroupNotForPrometheus, getEngineStatistics, getFabricStatistics, getStatisticsBulk, getStatisticsPacked, getTopologyLink, getXelinkPortHealth, getMetricsHistory, getMetricsHistograms, getThrottleResidency, getHostTelemetry
 from .groups import createGroup, getAllGroups, getGroupInfo, destroyGroup, addDeviceToGroup, removeDeviceFromGroup
 from .firmwares import runFirmwareFlash, getFirmwareFlashResult
 from .ps import getDeviceUtilByProc, getAllDeviceUtilByProc
-from .topology import getTopology, exportTopology, getTopoXelink
+from .topology import getTopology, exportTopology, getTopoXelink, runXeLinkMatrix, getXeLinkMatrix
 from .policy import getPolicy, setPolicy, readPolicyNotifyData
 from .config import setStandby, setPowerLimit, setFrequencyRange, setScheduler, runReset, getConfig, setPortEnabled, setPortBeaconing, setPerformanceFactor, setMemoryecc, runPpr
 from .dump_raw_data import startDumpRawDataTask, stopDumpRawDataTask, listDumpRawDataTasks
@@ -20,3 +20,4 @@ from .agent_settings import getAllAgentConfig, setAgentConfig
 from .xpum_enums import XpumStatsType, XpumResult, XpumEngineType, XpumDumpType
 from .sensor import getAMCSensorReading
 from .vgpu import doVgpuPrecheck, createVf, listVf, removeAllVf, stats
+from .jobs import openJobWindow, getJobWindowStats, closeJobWindow
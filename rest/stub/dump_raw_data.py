@@ -15,7 +15,12 @@ url_prefix = "/download"
 dump_folder = "/tmp/xpumdump"
 
 
-def startDumpRawDataTask(deviceId, tileId, metricsTypeList, showDate=False):
+dump_formats = {"csv": 0, "binary": 1}
+
+dump_layouts = {"long": 0, "wide": 1}
+
+
+def startDumpRawDataTask(deviceId, tileId, metricsTypeList, showDate=False, dumpFormat="csv", deviceIdList=[], layout="long"):
 
     enumList = [core_pb2.GeneralEnum(
         value=XpumDumpType[m].value) for m in metricsTypeList]
@@ -24,7 +29,10 @@ def startDumpRawDataTask(deviceId, tileId, metricsTypeList, showDate=False):
         deviceId=deviceId,
         tileId=tileId,
         metricsTypeList=enumList,
-        showDate=showDate
+        showDate=showDate,
+        format=dump_formats[dumpFormat],
+        deviceIdList=deviceIdList,
+        layout=dump_layouts[layout]
     ))
 
     if len(resp.errorMsg) != 0:
@@ -7,13 +7,94 @@
 import grpc
 import core_pb2_grpc
 import os
+import threading
+import time
 import xpum_logger as logger
 import signal
 
 unixSockName = os.environ.get('XPUM_SOCKET_FILE', '/tmp/xpum_p.sock')
 logger.info('using socket file: %s', unixSockName)
-channel = grpc.insecure_channel('unix://' + unixSockName)
-stub = core_pb2_grpc.XpumCoreServiceStub(channel)
+# one channel per worker, the calls of all request threads are multiplexed
+# on its HTTP/2 connection, which is kept alive between requests
+channel = grpc.insecure_channel('unix://' + unixSockName, options=[
+    ('grpc.keepalive_time_ms', 30000),
+    ('grpc.keepalive_permit_without_calls', 1),
+    ('grpc.max_receive_message_length', 64 * 1024 * 1024),
+    # xpumd rate limits the clients by peer and user agent
+    ('grpc.primary_user_agent', 'xpum-rest'),
+])
+
+# seconds a query result is shared with the identical queries that follow,
+# 0 only shares the calls in flight
+coalesce_ttl = float(os.environ.get('XPUM_REST_COALESCE_TTL', '0.2'))
+
+# the queries with side effects are never shared
+not_coalesced = {'getJobWindowStats', 'readPolicyNotifyData'}
+
+
+class _Call:
+    def __init__(self):
+        self.done = threading.Event()
+        self.result = None
+        self.error = None
+        self.finished = 0
+
+
+class CoalescingStub:
+    """
+    Wraps XpumCoreServiceStub so that identical concurrent get* queries,
+    like the panels of a dashboard opened at once, are sent to xpumd once
+    and their response is shared by all the callers.
+    """
+
+    def __init__(self, stub):
+        self._stub = stub
+        self._lock = threading.Lock()
+        self._calls = dict()
+
+    def __getattr__(self, name):
+        method = getattr(self._stub, name)
+        if not name.startswith('get') or name in not_coalesced:
+            return method
+
+        def call(request, *args, **kwargs):
+            if args or kwargs:
+                # a call with a timeout or metadata is sent as is
+                return method(request, *args, **kwargs)
+            key = (name, request.SerializeToString(deterministic=True))
+            now = time.monotonic()
+            with self._lock:
+                c = self._calls.get(key)
+                if c is not None and c.done.is_set() and now - c.finished > coalesce_ttl:
+                    c = None
+                leader = c is None
+                if leader:
+                    c = _Call()
+                    self._calls[key] = c
+            if not leader:
+                c.done.wait()
+                if c.error is not None:
+                    raise c.error
+                return c.result
+            try:
+                c.result = method(request)
+            except Exception as e:
+                c.error = e
+            c.finished = time.monotonic()
+            with self._lock:
+                if c.error is not None or coalesce_ttl <= 0:
+                    self._calls.pop(key, None)
+                # drop the expired results
+                for k in [k for k, v in self._calls.items() if v.done.is_set() and c.finished - v.finished > coalesce_ttl]:
+                    del self._calls[k]
+            c.done.set()
+            if c.error is not None:
+                raise c.error
+            return c.result
+        return call
+
+
+stub = CoalescingStub(core_pb2_grpc.XpumCoreServiceStub(channel))
 
 gunicorn_pid_file = os.path.dirname(os.path.realpath(__file__)) + "/../gunicorn.pid"
 
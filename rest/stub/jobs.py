@@ -0,0 +1,70 @@
+#
+# Copyright (C) 2021-2023 Intel Corporation
+# SPDX-License-Identifier: MIT
+# @file jobs.py
+#
+
+from .grpc_stub import stub, exit_on_disconnect
+import core_pb2
+
+
+def _jobWindowData(resp):
+    dataList = []
+    for d in resp.dataList:
+        dataList.append(dict(
+            device_id=d.deviceId,
+            begin=d.begin,
+            end=d.end,
+            energy=d.energy,
+            avg_power=d.avgPower / 1000,
+            peak_power=d.peakPower / 1000,
+            avg_gpu_utilization=d.avgGpuUtilization / 100,
+            avg_memory_used=d.avgMemoryUsed,
+            peak_memory_used=d.peakMemoryUsed,
+            memory_used_integral=d.memoryUsedIntegral))
+    processList = []
+    # the energy of the processes summed by the container they run in
+    containers = dict()
+    for p in resp.processList:
+        processList.append(dict(
+            device_id=p.deviceId,
+            process_id=p.processId,
+            process_name=p.processName,
+            container_id=p.containerId,
+            pod_uid=p.podUid,
+            busy_time=p.busyTime,
+            energy=p.energy))
+        if len(p.containerId) == 0:
+            continue
+        container = containers.setdefault(p.containerId, dict(
+            container_id=p.containerId, pod_uid=p.podUid, busy_time=0, energy=0))
+        container['busy_time'] += p.busyTime
+        container['energy'] += p.energy
+    return dict(job_id=resp.jobId, device_list=dataList, process_list=processList,
+                container_list=list(containers.values()))
+
+
+@exit_on_disconnect
+def openJobWindow(job_id, device_ids):
+    resp = stub.openJobWindow(core_pb2.XpumOpenJobWindowRequest(
+        jobId=job_id, deviceIds=device_ids))
+    if len(resp.errorMsg) != 0:
+        return resp.errorNo, resp.errorMsg, None
+    return 0, "OK", dict(job_id=resp.jobId)
+
+
+@exit_on_disconnect
+def getJobWindowStats(job_id):
+    resp = stub.getJobWindowStats(
+        core_pb2.XpumJobWindowRequest(jobId=job_id))
+    if len(resp.errorMsg) != 0:
+        return resp.errorNo, resp.errorMsg, None
+    return 0, "OK", _jobWindowData(resp)
+
+
+@exit_on_disconnect
+def closeJobWindow(job_id):
+    resp = stub.closeJobWindow(core_pb2.XpumJobWindowRequest(jobId=job_id))
+    if len(resp.errorMsg) != 0:
+        return resp.errorNo, resp.errorMsg, None
+    return 0, "OK", _jobWindowData(resp)
@@ -26,6 +26,7 @@ XpumPolicyTypeToString = {
     # core_pb2.POLICY_TYPE_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE : "XPUM_POLICY_TYPE_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE",
     core_pb2.POLICY_TYPE_GPU_MISSING: "XPUM_POLICY_TYPE_GPU_MISSING",
     core_pb2.POLICY_TYPE_GPU_THROTTLE: "XPUM_POLICY_TYPE_GPU_THROTTLE",
+    core_pb2.POLICY_TYPE_PRECHECK_ERROR: "XPUM_POLICY_TYPE_PRECHECK_ERROR",
     core_pb2.POLICY_TYPE_MAX: "XPUM_POLICY_TYPE_MAX",
 }
 
@@ -33,6 +34,9 @@ XpumPolicyConditionTypeToString = {
     core_pb2.POLICY_CONDITION_TYPE_GREATER: "XPUM_POLICY_CONDITION_TYPE_GREATER",
     core_pb2.POLICY_CONDITION_TYPE_LESS: "XPUM_POLICY_CONDITION_TYPE_LESS",
     core_pb2.POLICY_CONDITION_TYPE_WHEN_INCREASE: "XPUM_POLICY_CONDITION_TYPE_WHEN_OCCUR",
+    core_pb2.POLICY_CONDITION_TYPE_SUSTAINED_GREATER: "XPUM_POLICY_CONDITION_TYPE_SUSTAINED_GREATER",
+    core_pb2.POLICY_CONDITION_TYPE_RATE_GREATER: "XPUM_POLICY_CONDITION_TYPE_RATE_GREATER",
+    core_pb2.POLICY_CONDITION_TYPE_EWMA_GREATER: "XPUM_POLICY_CONDITION_TYPE_EWMA_GREATER",
 }
 
 XpumPolicyActionTypeToString = {
@@ -54,6 +58,7 @@ XpumPolicyTypeFromString = {
     # "XPUM_POLICY_TYPE_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE": core_pb2.POLICY_TYPE_RAS_ERROR_CAT_DISPLAY_ERRORS_UNCORRECTABLE,
     "XPUM_POLICY_TYPE_GPU_MISSING": core_pb2.POLICY_TYPE_GPU_MISSING,
     "XPUM_POLICY_TYPE_GPU_THROTTLE": core_pb2.POLICY_TYPE_GPU_THROTTLE,
+    "XPUM_POLICY_TYPE_PRECHECK_ERROR": core_pb2.POLICY_TYPE_PRECHECK_ERROR,
     "XPUM_POLICY_TYPE_MAX": core_pb2.POLICY_TYPE_MAX,
 }
 
@@ -61,8 +66,30 @@ XpumPolicyConditionTypeFromString = {
     "XPUM_POLICY_CONDITION_TYPE_GREATER": core_pb2.POLICY_CONDITION_TYPE_GREATER,
     "XPUM_POLICY_CONDITION_TYPE_LESS": core_pb2.POLICY_CONDITION_TYPE_LESS,
     "XPUM_POLICY_CONDITION_TYPE_WHEN_OCCUR": core_pb2.POLICY_CONDITION_TYPE_WHEN_INCREASE,
+    "XPUM_POLICY_CONDITION_TYPE_SUSTAINED_GREATER": core_pb2.POLICY_CONDITION_TYPE_SUSTAINED_GREATER,
+    "XPUM_POLICY_CONDITION_TYPE_RATE_GREATER": core_pb2.POLICY_CONDITION_TYPE_RATE_GREATER,
+    "XPUM_POLICY_CONDITION_TYPE_EWMA_GREATER": core_pb2.POLICY_CONDITION_TYPE_EWMA_GREATER,
 }
 
+# the condition types that trigger once and again after falling to release_threshold
+StatefulPolicyConditionTypes = [
+    core_pb2.POLICY_CONDITION_TYPE_SUSTAINED_GREATER,
+    core_pb2.POLICY_CONDITION_TYPE_RATE_GREATER,
+    core_pb2.POLICY_CONDITION_TYPE_EWMA_GREATER,
+]
+
+
+def conditionToDict(condition):
+    ret = {}
+    ret["type"] = XpumPolicyConditionTypeToString[condition.type]
+    if condition.type != core_pb2.POLICY_CONDITION_TYPE_WHEN_INCREASE:
+        ret["threshold"] = condition.threshold
+    if condition.type in StatefulPolicyConditionTypes:
+        if condition.type != core_pb2.POLICY_CONDITION_TYPE_RATE_GREATER:
+            ret["window"] = condition.window
+        ret["release_threshold"] = condition.releaseThreshold
+    return ret
+
 XpumPolicyActionTypeFromString = {
     "XPUM_POLICY_ACTION_TYPE_NULL": core_pb2.POLICY_ACTION_TYPE_NULL,
     "XPUM_POLICY_ACTION_TYPE_THROTTLE_DEVICE": core_pb2.POLICY_ACTION_TYPE_THROTTLE_DEVICE,
@@ -88,11 +115,7 @@ def getPolicy(id, isDevcie):
         data['device_id'] = one.deviceId
         data['type'] = XpumPolicyTypeToString[one.type]
         ####
-        condition = {}
-        condition["type"] = XpumPolicyConditionTypeToString[one.condition.type]
-        if(one.condition.type == core_pb2.POLICY_CONDITION_TYPE_LESS or one.condition.type == core_pb2.POLICY_CONDITION_TYPE_GREATER):
-            condition["threshold"] = one.condition.threshold
-        data['condition'] = condition
+        data['condition'] = conditionToDict(one.condition)
         ####
         action = {}
         action["type"] = XpumPolicyActionTypeToString[one.action.type]
@@ -139,6 +162,16 @@ def setPolicy(id, isDevcie, input, is_delete_policy):
                 return 1, "Invalid Parameter: policy condition threshold must be greater than or equal 0.", 400
             condition = core_pb2.XpumPolicyCondition(
                 type=policyConditionType, threshold=input["condition"]["threshold"])
+        elif policyConditionType in StatefulPolicyConditionTypes:
+            if "threshold" not in input["condition"]:
+                return 1, "Invalid Parameter: policy condition threshold is invalid.", 400
+            threshold = int(input["condition"]["threshold"])
+            window = int(input["condition"].get("window", 0))
+            release_threshold = int(input["condition"].get("release_threshold", 0))
+            if threshold < 0 or window < 0 or release_threshold < 0:
+                return 1, "Invalid Parameter: policy condition threshold, window and release_threshold must be greater than or equal 0.", 400
+            condition = core_pb2.XpumPolicyCondition(
+                type=policyConditionType, threshold=threshold, window=window, releaseThreshold=release_threshold)
         else:
             condition = core_pb2.XpumPolicyCondition(type=policyConditionType)
         ##########
@@ -200,10 +233,7 @@ def readPolicyNotifyData():
                     time_stamp, one.notifyCallBackUrl, data['type'], one.timestamp,))
                 continue
             ####
-            condition = {}
-            condition["type"] = XpumPolicyConditionTypeToString[one.condition.type]
-            if(one.condition.type == core_pb2.POLICY_CONDITION_TYPE_LESS or one.condition.type == core_pb2.POLICY_CONDITION_TYPE_GREATER):
-                condition["threshold"] = one.condition.threshold
+            condition = conditionToDict(one.condition)
             data['condition'] = condition
             ####
             action = {}
@@ -218,6 +248,8 @@ def readPolicyNotifyData():
                 data['curValue'] = one.curValue
                 data['isTileData'] = one.isTileData
                 data['tileId'] = one.tileId
+                if data['type'] == 'XPUM_POLICY_TYPE_PRECHECK_ERROR':
+                    data['description'] = one.description
             else:
                 data['description'] = one.description
             ####
@@ -12,9 +12,13 @@ from .xpum_enums import XpumStatsType, XpumEngineType
 
 
 @exit_on_disconnect
-def getStatistics(device_id, session_id=0, get_accumulated=False):
+def getStatistics(device_id, session_id=0, get_accumulated=False, metrics_types=None):
+    # only the metrics in metrics_types are read by xpumd, all of them if it is empty
+    metrics_mask = 0
+    for metrics_type in metrics_types or []:
+        metrics_mask |= 1 << metrics_type
     resp = stub.getStatistics(core_pb2.XpumGetStatsRequest(
-        deviceId=device_id, sessionId=session_id))
+        deviceId=device_id, sessionId=session_id, metricsMask=metrics_mask))
     if len(resp.errorMsg) != 0:
         return 1, resp.errorMsg, None
     data = dict()
@@ -29,43 +33,7 @@ def getStatistics(device_id, session_id=0, get_accumulated=False):
     data['end'] = endTimestamp.isoformat(
         timespec='milliseconds').replace('+00:00', 'Z')
 
-    deviceLevelStatsDataList = []
-    tileLevelStatsDataList = []
-    for stats_info in resp.dataList:
-        dataList = []
-        for stats_data in stats_info.dataList:
-            tmp = dict()
-            try:
-                metricsType = XpumStatsType(stats_data.metricsType.value).name
-            except:
-                metricsType = str(stats_data.metricsType.value)
-            tmp["metrics_type"] = metricsType
-            scale = stats_data.scale
-            if scale == 1:
-                tmp["value"] = stats_data.value
-                if not stats_data.isCounter:
-                    tmp["avg"] = stats_data.avg
-                    tmp["min"] = stats_data.min
-                    tmp["max"] = stats_data.max
-                elif get_accumulated:
-                    tmp["acc"] = stats_data.accumulated
-            else:
-                tmp["value"] = stats_data.value / scale
-                if not stats_data.isCounter:
-                    tmp["avg"] = stats_data.avg / scale
-                    tmp["min"] = stats_data.min / scale
-                    tmp["max"] = stats_data.max / scale
-                elif get_accumulated:
-                    tmp["acc"] = stats_data.accumulated / scale
-            dataList.append(tmp)
-        if stats_info.isTileData:
-            tmp = dict(tile_id=stats_info.tileId, data_list=dataList)
-            tileLevelStatsDataList.append(tmp)
-        else:
-            deviceLevelStatsDataList = dataList
-    data["device_level"] = deviceLevelStatsDataList
-    if tileLevelStatsDataList:
-        data["tile_level"] = tileLevelStatsDataList
+    data.update(convertStatsInfoList(resp.dataList, get_accumulated))
     return 0, "OK", data
 
 
@@ -98,6 +66,9 @@ def getStatisticsByGroup(group_id, session_id=0, get_accumulated=False):
                     tmp["min"] = d.min
                     tmp["avg"] = d.avg
                     tmp["max"] = d.max
+                    tmp["p50"] = d.p50
+                    tmp["p90"] = d.p90
+                    tmp["p99"] = d.p99
                 elif get_accumulated:
                     tmp["acc"] = d.accumulated
             else:
@@ -106,6 +77,9 @@ def getStatisticsByGroup(group_id, session_id=0, get_accumulated=False):
                     tmp["min"] = d.min / scale
                     tmp["avg"] = d.avg / scale
                     tmp["max"] = d.max / scale
+                    tmp["p50"] = d.p50 / scale
+                    tmp["p90"] = d.p90 / scale
+                    tmp["p99"] = d.p99 / scale
                 elif get_accumulated:
                     tmp["acc"] = d.accumulated / scale
             dataList.append(tmp)
@@ -151,50 +125,7 @@ def getEngineStatistics(device_id, session_id=0):
         timespec='milliseconds').replace('+00:00', 'Z')
     data['end'] = endTimestamp.isoformat(
         timespec='milliseconds').replace('+00:00', 'Z')
-    engine_stats = dict()
-    for stats_info in resp.dataList:
-        tmp = dict()
-        try:
-            engineType = XpumEngineType(stats_info.engineType).name
-        except:
-            engineType = stats_info.engineType
-        tmp["engine_id"] = stats_info.engineId
-        scale = stats_info.scale
-        if scale == 1:
-            tmp["value"] = stats_info.value
-            tmp["avg"] = stats_info.avg
-            tmp["min"] = stats_info.min
-            tmp["max"] = stats_info.max
-        else:
-            tmp["value"] = stats_info.value / scale
-            tmp["avg"] = stats_info.avg / scale
-            tmp["min"] = stats_info.min / scale
-            tmp["max"] = stats_info.max / scale
-        tileId = stats_info.tileId if stats_info.isTileData else "device_level"
-        if tileId not in engine_stats:
-            engine_stats[tileId] = dict()
-            engine_stats[tileId]["compute"] = []
-            engine_stats[tileId]["render"] = []
-            engine_stats[tileId]["decoder"] = []
-            engine_stats[tileId]["encoder"] = []
-            engine_stats[tileId]["copy"] = []
-            engine_stats[tileId]["media_enhancement"] = []
-            engine_stats[tileId]["3d"] = []
-        if engineType == "XPUM_ENGINE_TYPE_COMPUTE":
-            engine_stats[tileId]["compute"].append(tmp)
-        elif engineType == "XPUM_ENGINE_TYPE_RENDER":
-            engine_stats[tileId]["render"].append(tmp)
-        elif engineType == "XPUM_ENGINE_TYPE_DECODE":
-            engine_stats[tileId]["decoder"].append(tmp)
-        elif engineType == "XPUM_ENGINE_TYPE_ENCODE":
-            engine_stats[tileId]["encoder"].append(tmp)
-        elif engineType == "XPUM_ENGINE_TYPE_COPY":
-            engine_stats[tileId]["copy"].append(tmp)
-        elif engineType == "XPUM_ENGINE_TYPE_MEDIA_ENHANCEMENT":
-            engine_stats[tileId]["media_enhancement"].append(tmp)
-        elif engineType == "XPUM_ENGINE_TYPE_3D":
-            engine_stats[tileId]["3d"].append(tmp)
-
+    engine_stats = convertEngineStatsList(resp.dataList)
     data["engine_util"] = engine_stats
     return 0, "OK", data
 
@@ -216,43 +147,7 @@ def getFabricStatistics(device_id, session_id=0, get_accumulated=False):
         timespec='milliseconds').replace('+00:00', 'Z')
     data['end'] = endTimestamp.isoformat(
         timespec='milliseconds').replace('+00:00', 'Z')
-    fabric_stats = []
-    for stats_info in resp.dataList:
-        tmp = dict()
-        if stats_info.type == 1 or (stats_info.type == 3 and get_accumulated):
-            tmp["name"] = "{}/{}->{}/{}".format(device_id, stats_info.tileId,
-                                                stats_info.remote_device_id, stats_info.remote_device_tile_id)
-            tmp["src_device_id"] = device_id
-            tmp["src_tile_id"] = stats_info.tileId
-            tmp["dst_device_id"] = stats_info.remote_device_id
-            tmp["dst_tile_id"] = stats_info.remote_device_tile_id
-        elif stats_info.type == 0 or (stats_info.type == 2 and get_accumulated):
-            tmp["name"] = "{}/{}->{}/{}".format(stats_info.remote_device_id,
-                                                stats_info.remote_device_tile_id, device_id, stats_info.tileId)
-            tmp["src_device_id"] = stats_info.remote_device_id
-            tmp["src_tile_id"] = stats_info.remote_device_tile_id
-            tmp["dst_device_id"] = device_id
-            tmp["dst_tile_id"] = stats_info.tileId
-        else:
-            continue
-
-        tmp["type"] = stats_info.type
-        scale = stats_info.scale
-        if scale == 1:
-            tmp["value"] = stats_info.value
-            tmp["avg"] = stats_info.avg
-            tmp["min"] = stats_info.min
-            tmp["max"] = stats_info.max
-            if get_accumulated:
-                tmp["acc"] = stats_info.accumulated
-        else:
-            tmp["value"] = stats_info.value / scale
-            tmp["avg"] = stats_info.avg / scale
-            tmp["min"] = stats_info.min / scale
-            tmp["max"] = stats_info.max / scale
-            if get_accumulated:
-                tmp["acc"] = stats_info.accumulated / scale
-        fabric_stats.append(tmp)
+    fabric_stats = convertFabricStatsList(device_id, resp.dataList, get_accumulated)
     data["fabric_throughput"] = fabric_stats
 
     return 0, "OK", data
@@ -371,6 +266,9 @@ def getStatisticsNotForPrometheus(device_id, session_id=0, get_accumulated=False
                     tmp["avg"] = stats_data.avg
                     tmp["min"] = stats_data.min
                     tmp["max"] = stats_data.max
+                    tmp["p50"] = stats_data.p50
+                    tmp["p90"] = stats_data.p90
+                    tmp["p99"] = stats_data.p99
                 elif get_accumulated:
                     tmp["acc"] = stats_data.accumulated
             else:
@@ -379,6 +277,9 @@ def getStatisticsNotForPrometheus(device_id, session_id=0, get_accumulated=False
                     tmp["avg"] = stats_data.avg / scale
                     tmp["min"] = stats_data.min / scale
                     tmp["max"] = stats_data.max / scale
+                    tmp["p50"] = stats_data.p50 / scale
+                    tmp["p90"] = stats_data.p90 / scale
+                    tmp["p99"] = stats_data.p99 / scale
                 elif get_accumulated:
                     tmp["acc"] = stats_data.accumulated / scale
             dataList.append(tmp)
@@ -421,6 +322,9 @@ def getStatisticsByGroupNotForPrometheus(group_id, session_id=0, get_accumulated
                     tmp["min"] = d.min
                     tmp["avg"] = d.avg
                     tmp["max"] = d.max
+                    tmp["p50"] = d.p50
+                    tmp["p90"] = d.p90
+                    tmp["p99"] = d.p99
                 elif get_accumulated:
                     tmp["acc"] = d.accumulated
             else:
@@ -429,6 +333,9 @@ def getStatisticsByGroupNotForPrometheus(group_id, session_id=0, get_accumulated
                     tmp["min"] = d.min / scale
                     tmp["avg"] = d.avg / scale
                     tmp["max"] = d.max / scale
+                    tmp["p50"] = d.p50 / scale
+                    tmp["p90"] = d.p90 / scale
+                    tmp["p99"] = d.p99 / scale
                 elif get_accumulated:
                     tmp["acc"] = d.accumulated / scale
             dataList.append(tmp)
@@ -456,3 +363,344 @@ def getStatisticsByGroupNotForPrometheus(group_id, session_id=0, get_accumulated
         data["tile_level"] = deviceMap[deviceId]["tile_level"]
         datas.append(data)
     return 0, "OK", dict(group_id=group_id, datas=datas)
+
+
+@exit_on_disconnect
+def getMetricsHistory(device_id, metrics_types, begin, end, step):
+    resp = stub.getMetricsHistory(core_pb2.XpumGetMetricsHistoryRequest(
+        deviceId=device_id,
+        metricsTypes=[core_pb2.GeneralEnum(value=t) for t in metrics_types],
+        begin=begin, end=end, step=step))
+    if len(resp.errorMsg) != 0:
+        return resp.errorNo, resp.errorMsg, None
+    data = dict(device_id=device_id, begin=begin, end=end, step=step)
+    seriesList = []
+    for series in resp.seriesList:
+        try:
+            metricsType = XpumStatsType(series.metricsType.value).name
+        except:
+            metricsType = str(series.metricsType.value)
+        scale = series.scale if series.scale > 0 else 1
+        points = []
+        for p in series.points:
+            if scale == 1:
+                points.append(dict(timestamp=p.timestamp, min=p.min,
+                                   avg=p.avg, max=p.max, count=p.count))
+            else:
+                points.append(dict(timestamp=p.timestamp, min=p.min / scale,
+                                   avg=p.avg / scale, max=p.max / scale, count=p.count))
+        tmp = dict(metrics_type=metricsType, is_counter=series.isCounter, points=points)
+        if series.isTileData:
+            tmp["tile_id"] = series.tileId
+        seriesList.append(tmp)
+    data["series_list"] = seriesList
+    return 0, "OK", data
+
+
+@exit_on_disconnect
+def getMetricsHistograms(device_id):
+    resp = stub.getMetricsHistograms(core_pb2.DeviceId(id=device_id))
+    if len(resp.errorMsg) != 0:
+        return resp.errorNo, resp.errorMsg, None
+    histograms = []
+    for h in resp.histogramList:
+        try:
+            metricsType = XpumStatsType(h.metricsType.value).name
+        except:
+            metricsType = str(h.metricsType.value)
+        scale = h.scale if h.scale > 0 else 1
+        # the bins are in ascending order of their upper bounds
+        bins = [(b.upperBound / scale, b.count) for b in h.bins]
+        tmp = dict(metrics_type=metricsType, count=h.count,
+                   sum=h.sum / scale, bins=bins)
+        if h.isTileData:
+            tmp["tile_id"] = h.tileId
+        histograms.append(tmp)
+    return 0, "OK", dict(device_id=device_id, histograms=histograms)
+
+
+@exit_on_disconnect
+def getThrottleResidency(device_id):
+    resp = stub.getThrottleResidency(core_pb2.DeviceId(id=device_id))
+    if len(resp.errorMsg) != 0:
+        return resp.errorNo, resp.errorMsg, None
+    residencies = []
+    # the times are in milliseconds since the daemon started
+    for r in resp.dataList:
+        tmp = dict(sampled_time=r.sampledTime, throttled_time=r.throttledTime,
+                   avg_power_cap_time=r.avgPowerCapTime, burst_power_cap_time=r.burstPowerCapTime,
+                   current_limit_time=r.currentLimitTime, thermal_limit_time=r.thermalLimitTime,
+                   psu_alert_time=r.psuAlertTime, sw_range_time=r.swRangeTime,
+                   hw_range_time=r.hwRangeTime)
+        if r.isTileData:
+            tmp["tile_id"] = r.tileId
+        residencies.append(tmp)
+    return 0, "OK", dict(device_id=device_id, residencies=residencies)
+
+
+@exit_on_disconnect
+def getHostTelemetry():
+    resp = stub.getHostTelemetry(empty_pb2.Empty())
+    if len(resp.errorMsg) != 0:
+        return resp.errorNo, resp.errorMsg, None
+    # the throughputs are in kB/s, the bytes are accumulated since the daemon started
+    sockets = []
+    for s in resp.sockets:
+        sockets.append(dict(socket_id=s.socketId, timestamp=s.timestamp,
+                            dram_read_throughput=s.dramReadThroughput, dram_write_throughput=s.dramWriteThroughput,
+                            dram_read=s.dramRead, dram_write=s.dramWrite,
+                            upi_incoming_throughput=s.upiIncomingThroughput, upi_incoming=s.upiIncoming,
+                            upi_utilization=s.upiUtilization))
+    stacks = []
+    for s in resp.stacks:
+        stacks.append(dict(socket_id=s.socketId, stack_id=s.stackId, timestamp=s.timestamp,
+                           read_throughput=s.readThroughput, write_throughput=s.writeThroughput,
+                           read=s.read, write=s.write))
+    return 0, "OK", dict(sockets=sockets, stacks=stacks)
+
+
+@exit_on_disconnect
+def getStatisticsBulk(device_ids=[], session_id=0, get_accumulated=False):
+    resp = stub.getStatisticsBulk(core_pb2.XpumGetStatsBulkRequest(
+        deviceIdList=device_ids, sessionId=session_id))
+    if len(resp.errorMsg) != 0:
+        return resp.errorNo, resp.errorMsg, None
+    beginTimestamp = datetime.datetime.fromtimestamp(
+        resp.begin/1e3, datetime.timezone.utc)
+    endTimestamp = datetime.datetime.fromtimestamp(
+        resp.end/1e3, datetime.timezone.utc)
+    datas = dict()
+    for device_id in sorted(set(x.deviceId for x in resp.dataList)):
+        data = dict()
+        data["device_id"] = device_id
+        data['begin'] = beginTimestamp.isoformat(
+            timespec='milliseconds').replace('+00:00', 'Z')
+        data['end'] = endTimestamp.isoformat(
+            timespec='milliseconds').replace('+00:00', 'Z')
+        data.update(convertStatsInfoList(
+            [x for x in resp.dataList if x.deviceId == device_id], get_accumulated))
+        data["engine_util"] = convertEngineStatsList(
+            [x for x in resp.engineDataList if x.deviceId == device_id])
+        data["fabric_throughput"] = convertFabricStatsList(
+            device_id, [x for x in resp.fabricDataList if x.deviceId == device_id], get_accumulated)
+        datas[device_id] = data
+    # the device data aggregated from tiles is added to the device level, the card data is keyed by card id
+    cards = dict()
+    for derived in resp.derivedDataList:
+        tmp = convertDerivedStats(derived)
+        if derived.isCard:
+            cards.setdefault(derived.id, []).append(tmp)
+        elif derived.id in datas:
+            datas[derived.id]["device_level"].append(tmp)
+    return 0, "OK", dict(devices=datas, cards=cards)
+
+
+# the schema of the packed statistics, only fetched again when xpumd has another one
+packed_stats_schema = None
+
+
+@exit_on_disconnect
+def getStatisticsPacked(device_ids=[], session_id=0, get_accumulated=False, compress=False):
+    global packed_stats_schema
+    schema_id = packed_stats_schema.schemaId if packed_stats_schema is not None else 0
+    resp = stub.getStatisticsPacked(core_pb2.XpumGetPackedStatsRequest(
+        deviceIdList=device_ids, sessionId=session_id, schemaId=schema_id, compress=compress))
+    if resp.HasField("schema"):
+        packed_stats_schema = resp.schema
+    if len(resp.errorMsg) != 0:
+        return resp.errorNo, resp.errorMsg, None
+    beginTimestamp = datetime.datetime.fromtimestamp(
+        resp.begin/1e3, datetime.timezone.utc)
+    endTimestamp = datetime.datetime.fromtimestamp(
+        resp.end/1e3, datetime.timezone.utc)
+    datas = dict()
+    for record in resp.records:
+        data = datas.setdefault(record.deviceId, dict(
+            device_id=record.deviceId,
+            begin=beginTimestamp.isoformat(timespec='milliseconds').replace('+00:00', 'Z'),
+            end=endTimestamp.isoformat(timespec='milliseconds').replace('+00:00', 'Z'),
+            device_level=[]))
+        dataList = convertPackedStatsRecord(record, packed_stats_schema, get_accumulated)
+        if record.tileId < 0:
+            data["device_level"] = dataList
+        else:
+            data.setdefault("tile_level", []).append(dict(tile_id=record.tileId, data_list=dataList))
+    return 0, "OK", datas
+
+
+def convertPackedStatsRecord(record, schema, get_accumulated=False):
+    # the values of the present metrics come in the order of the schema, the counters and gauges in their own arrays
+    dataList = []
+    value_index = counter_index = gauge_index = 0
+    for bit, metrics_type in enumerate(schema.metricsTypes):
+        if not record.presentMask & (1 << bit):
+            continue
+        try:
+            metricsType = XpumStatsType(metrics_type.value).name
+        except:
+            metricsType = str(metrics_type.value)
+        scale = record.scale[value_index]
+        tmp = dict(metrics_type=metricsType)
+        tmp["value"] = record.value[value_index] if scale == 1 else record.value[value_index] / scale
+        value_index += 1
+        if record.counterMask & (1 << bit):
+            if get_accumulated:
+                acc = record.accumulated[counter_index]
+                tmp["acc"] = acc if scale == 1 else acc / scale
+            counter_index += 1
+        else:
+            for key in ["avg", "min", "max", "p50", "p90", "p99"]:
+                v = getattr(record, key)[gauge_index]
+                tmp[key] = v if scale == 1 else v / scale
+            gauge_index += 1
+        dataList.append(tmp)
+    return dataList
+
+
+def convertDerivedStats(derived):
+    try:
+        metricsType = XpumStatsType(derived.metricsType.value).name
+    except:
+        metricsType = str(derived.metricsType.value)
+    value = derived.value if derived.scale == 1 else derived.value / derived.scale
+    tmp = dict(metrics_type=metricsType)
+    tmp["acc" if derived.isAccumulated else "avg"] = value
+    tmp["agg_func"] = "sum" if derived.isSum else "avg"
+    return tmp
+
+
+def convertStatsInfoList(statsInfoList, get_accumulated=False):
+    deviceLevelStatsDataList = []
+    tileLevelStatsDataList = []
+    for stats_info in statsInfoList:
+        dataList = []
+        for stats_data in stats_info.dataList:
+            tmp = dict()
+            try:
+                metricsType = XpumStatsType(stats_data.metricsType.value).name
+            except:
+                metricsType = str(stats_data.metricsType.value)
+            tmp["metrics_type"] = metricsType
+            scale = stats_data.scale
+            if scale == 1:
+                tmp["value"] = stats_data.value
+                if not stats_data.isCounter:
+                    tmp["avg"] = stats_data.avg
+                    tmp["min"] = stats_data.min
+                    tmp["max"] = stats_data.max
+                    tmp["p50"] = stats_data.p50
+                    tmp["p90"] = stats_data.p90
+                    tmp["p99"] = stats_data.p99
+                elif get_accumulated:
+                    tmp["acc"] = stats_data.accumulated
+            else:
+                tmp["value"] = stats_data.value / scale
+                if not stats_data.isCounter:
+                    tmp["avg"] = stats_data.avg / scale
+                    tmp["min"] = stats_data.min / scale
+                    tmp["max"] = stats_data.max / scale
+                    tmp["p50"] = stats_data.p50 / scale
+                    tmp["p90"] = stats_data.p90 / scale
+                    tmp["p99"] = stats_data.p99 / scale
+                elif get_accumulated:
+                    tmp["acc"] = stats_data.accumulated / scale
+            dataList.append(tmp)
+        if stats_info.isTileData:
+            tmp = dict(tile_id=stats_info.tileId, data_list=dataList)
+            tileLevelStatsDataList.append(tmp)
+        else:
+            deviceLevelStatsDataList = dataList
+    data = dict()
+    data["device_level"] = deviceLevelStatsDataList
+    if tileLevelStatsDataList:
+        data["tile_level"] = tileLevelStatsDataList
+    return data
+
+
+def convertEngineStatsList(engineStatsList):
+    engine_stats = dict()
+    for stats_info in engineStatsList:
+        tmp = dict()
+        try:
+            engineType = XpumEngineType(stats_info.engineType).name
+        except:
+            engineType = stats_info.engineType
+        tmp["engine_id"] = stats_info.engineId
+        scale = stats_info.scale
+        if scale == 1:
+            tmp["value"] = stats_info.value
+            tmp["avg"] = stats_info.avg
+            tmp["min"] = stats_info.min
+            tmp["max"] = stats_info.max
+        else:
+            tmp["value"] = stats_info.value / scale
+            tmp["avg"] = stats_info.avg / scale
+            tmp["min"] = stats_info.min / scale
+            tmp["max"] = stats_info.max / scale
+        tileId = stats_info.tileId if stats_info.isTileData else "device_level"
+        if tileId not in engine_stats:
+            engine_stats[tileId] = dict()
+            engine_stats[tileId]["compute"] = []
+            engine_stats[tileId]["render"] = []
+            engine_stats[tileId]["decoder"] = []
+            engine_stats[tileId]["encoder"] = []
+            engine_stats[tileId]["copy"] = []
+            engine_stats[tileId]["media_enhancement"] = []
+            engine_stats[tileId]["3d"] = []
+        if engineType == "XPUM_ENGINE_TYPE_COMPUTE":
+            engine_stats[tileId]["compute"].append(tmp)
+        elif engineType == "XPUM_ENGINE_TYPE_RENDER":
+            engine_stats[tileId]["render"].append(tmp)
+        elif engineType == "XPUM_ENGINE_TYPE_DECODE":
+            engine_stats[tileId]["decoder"].append(tmp)
+        elif engineType == "XPUM_ENGINE_TYPE_ENCODE":
+            engine_stats[tileId]["encoder"].append(tmp)
+        elif engineType == "XPUM_ENGINE_TYPE_COPY":
+            engine_stats[tileId]["copy"].append(tmp)
+        elif engineType == "XPUM_ENGINE_TYPE_MEDIA_ENHANCEMENT":
+            engine_stats[tileId]["media_enhancement"].append(tmp)
+        elif engineType == "XPUM_ENGINE_TYPE_3D":
+            engine_stats[tileId]["3d"].append(tmp)
+
+    return engine_stats
+
+
+def convertFabricStatsList(device_id, fabricStatsList, get_accumulated=False):
+    fabric_stats = []
+    for stats_info in fabricStatsList:
+        tmp = dict()
+        if stats_info.type == 1 or (stats_info.type == 3 and get_accumulated):
+            tmp["name"] = "{}/{}->{}/{}".format(device_id, stats_info.tileId,
+                                                stats_info.remote_device_id, stats_info.remote_device_tile_id)
+            tmp["src_device_id"] = device_id
+            tmp["src_tile_id"] = stats_info.tileId
+            tmp["dst_device_id"] = stats_info.remote_device_id
+            tmp["dst_tile_id"] = stats_info.remote_device_tile_id
+        elif stats_info.type == 0 or (stats_info.type == 2 and get_accumulated):
+            tmp["name"] = "{}/{}->{}/{}".format(stats_info.remote_device_id,
+                                                stats_info.remote_device_tile_id, device_id, stats_info.tileId)
+            tmp["src_device_id"] = stats_info.remote_device_id
+            tmp["src_tile_id"] = stats_info.remote_device_tile_id
+            tmp["dst_device_id"] = device_id
+            tmp["dst_tile_id"] = stats_info.tileId
+        else:
+            continue
+
+        tmp["type"] = stats_info.type
+        scale = stats_info.scale
+        if scale == 1:
+            tmp["value"] = stats_info.value
+            tmp["avg"] = stats_info.avg
+            tmp["min"] = stats_info.min
+            tmp["max"] = stats_info.max
+            if get_accumulated:
+                tmp["acc"] = stats_info.accumulated
+        else:
+            tmp["value"] = stats_info.value / scale
+            tmp["avg"] = stats_info.avg / scale
+            tmp["min"] = stats_info.min / scale
+            tmp["max"] = stats_info.max / scale
+            if get_accumulated:
+                tmp["acc"] = stats_info.accumulated / scale
+        fabric_stats.append(tmp)
+    return fabric_stats
@@ -60,3 +60,36 @@ def exportTopology():
         template = "An exception of type {0} occurred. Arguments:\n{1!r}"
         message = template.format(type(ex).__name__, ex.args)
         return 1, message, None
+
+
+def runXeLinkMatrix(deviceIdList):
+    resp = stub.runXeLinkMatrix(
+        core_pb2.XpumRunXeLinkMatrixRequest(deviceIdList=deviceIdList))
+    if len(resp.errorMsg) != 0:
+        return 1, resp.errorMsg, None
+    return 0, "OK", dict(running=resp.running)
+
+
+def getXeLinkMatrix():
+    resp = stub.getXeLinkMatrix(empty_pb2.Empty())
+    if len(resp.errorMsg) != 0:
+        return 1, resp.errorMsg, None
+
+    data = dict()
+    data["running"] = resp.running
+    entries = []
+    for entry in resp.entries:
+        e = dict()
+        e["src_device_id"] = entry.srcDeviceId
+        e["src_tile_id"] = entry.srcTileId
+        e["dst_device_id"] = entry.dstDeviceId
+        e["dst_tile_id"] = entry.dstTileId
+        e["copy_engine_group"] = entry.copyEngineGroup
+        e["uni_bandwidth"] = entry.uniBandwidth
+        e["bi_bandwidth"] = entry.biBandwidth
+        e["latency"] = entry.latency
+        e["degraded"] = entry.degraded
+        e["timestamp"] = entry.timestamp
+        entries.append(e)
+    data["entry_list"] = entries
+    return 0, "OK", data
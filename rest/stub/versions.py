@@ -25,3 +25,13 @@ def getVersion():
         elif versionType == 2:
             data['level_zero_version'] = versionStr
     return 0, "OK", data
+
+
+def getDataVersion():
+    resp = stub.getDataVersion(empty_pb2.Empty())
+    if len(resp.errorMsg) != 0:
+        return resp.errorNo, resp.errorMsg, None
+    data = dict()
+    data['generation'] = resp.generation
+    data['topology_version'] = resp.topologyVersion
+    return 0, "OK", data
@@ -115,6 +115,15 @@ XpumResult = Enum("xpum_result_t", (
     "XPUM_PRECHECK_INVALID_SINCETIME",
     "XPUM_PPR_NOT_FOUND",
     "XPUM_UPDATE_FIRMWARE_GFX_DATA_IMAGE_VERSION_LOWER_OR_EQUAL_TO_DEVICE",
+    "XPUM_RESULT_UNSUPPORTED_DEVICE",
+    "XPUM_GROUP_LIMIT_REACHED",
+    "XPUM_RESULT_JOB_WINDOW_EXISTS",
+    "XPUM_RESULT_JOB_WINDOW_NOT_FOUND",
+    "XPUM_RESULT_BURST_SAMPLING_RUNNING",
+    "XPUM_RESULT_BURST_SAMPLING_NOT_FOUND",
+    "XPUM_RESULT_STRESS_INVALID_OPTIONS",
+    "XPUM_RESULT_VGPU_PROVISION_RUNNING",
+    "XPUM_RESULT_CLOCK_NOT_CORRELATED",
 ), start=0)
 
 XpumEngineType = Enum("xpum_engine_type_t", (
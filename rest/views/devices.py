@@ -7,6 +7,7 @@
 import stub
 from flask import jsonify, request
 from marshmallow import Schema, fields, ValidationError
+from http_cache import etag
 
 
 class DeviceBasicInfoSchema(Schema):
@@ -28,6 +29,7 @@ class DeviceListSchema(Schema):
     devices = fields.Nested(DeviceBasicInfoSchema, many=True)
 
 
+@etag('topology')
 def get_devices():
     """
     Get device list.
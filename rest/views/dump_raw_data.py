@@ -6,7 +6,7 @@
 
 from flask import request, jsonify
 import stub
-from marshmallow import Schema, fields, validate, ValidationError
+from marshmallow import Schema, fields, validate, validates_schema, ValidationError
 
 
 allow_dump_metrics = [e.name for e in stub.XpumDumpType]
@@ -19,10 +19,14 @@ def is_unique(values):
 
 class StartDumpRawDataTaskSchema(Schema):
     device_id = fields.Int(
-        required=True,
         strict=True,
         validate=validate.Range(0),
-        metadata={"description": "The device to dump raw data"}
+        metadata={"description": "The device to dump raw data, required if device_id_list is not set"}
+    )
+    device_id_list = fields.List(
+        fields.Int(strict=True, validate=validate.Range(0)),
+        validate=[validate.Length(1), is_unique],
+        metadata={"description": "The devices to dump raw data into one file with a shared timestamp, tile_id is not supported with it"}
     )
     tile_id = fields.Int(
         required=False,
@@ -43,6 +47,21 @@ class StartDumpRawDataTaskSchema(Schema):
     show_date = fields.Boolean(
         metadata={"description": "Controls timestamp format in dumps: '1' includes full date and time, '0' (default) includes only time."}
     )
+    format = fields.Str(
+        validate=validate.OneOf(["csv", "binary"]),
+        metadata={"description": "Format of the dump file, 'csv' (default) or 'binary'"}
+    )
+    layout = fields.Str(
+        validate=validate.OneOf(["long", "wide"]),
+        metadata={"description": "Layout of the dump file for multiple devices, 'long' (default) has one row per device per sample, 'wide' has one row per sample"}
+    )
+
+    @validates_schema
+    def validate_devices(self, data, **kwargs):
+        if "device_id" not in data and "device_id_list" not in data:
+            raise ValidationError("device_id or device_id_list is required")
+        if "device_id_list" in data and "tile_id" in data:
+            raise ValidationError("tile_id is not supported with device_id_list")
 
 
 class DumpRawDataTaskInfoSchema(Schema):
@@ -88,17 +107,20 @@ def startDumpRawDataTask():
         StartDumpRawDataTaskSchema().load(reqData)
     except ValidationError as err:
         return jsonify(err.messages), 400
-    deviceId = reqData.get("device_id")
+    deviceIdList = reqData.get("device_id_list", [])
+    deviceId = reqData.get("device_id", deviceIdList[0] if deviceIdList else None)
     metricsTypeList = reqData.get("metrics_type_list")
     tileId = reqData.get("tile_id", -1)
     showDate = reqData.get("show_date")
+    dumpFormat = reqData.get("format", "csv")
+    layout = reqData.get("layout", "long")
     code, message, data = stub.startDumpRawDataTask(
-        deviceId, tileId, metricsTypeList, showDate)
+        deviceId, tileId, metricsTypeList, showDate, dumpFormat, deviceIdList, layout)
     if code == 0:
         return jsonify(data)
     elif code == stub.XpumResult["XPUM_RESULT_DEVICE_NOT_FOUND"].value:
         error = dict(
-            message="device_id {} corresponding device not found".format(deviceId))
+            message="device_id {} corresponding device not found".format(deviceIdList if deviceIdList else deviceId))
         return jsonify(error), 400
     elif code == stub.XpumResult["XPUM_RESULT_TILE_NOT_FOUND"].value:
         error = dict(
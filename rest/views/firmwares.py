@@ -12,9 +12,12 @@ from marshmallow import Schema, fields, validate, ValidationError, validates_sch
 
 class FirmwareFlashJobOnAllDevicesSchema(Schema):
     file = fields.Str(
-        required=True,
         metadata={"description": "The path of firmware binary file to flash"}
     )
+    file_sha256 = fields.Str(
+        validate=validate.Regexp("^[0-9a-fA-F]{64}$"),
+        metadata={"description": "The SHA-256 of a GFX or GFX_DATA firmware image flashed before, used instead of file so that the image is not copied to the node again"}
+    )
     firmware_name = fields.Str(
         validate=validate.Equal("AMC"),
         metadata={"description": "Firmware name, options are: AMC"}
@@ -27,9 +30,12 @@ class FirmwareFlashJobOnAllDevicesSchema(Schema):
 
 class FirmwareFlashJobOnSingleDeviceSchema(Schema):
     file = fields.Str(
-        required=True,
         metadata={"description": "The path of firmware binary file to flash"}
     )
+    file_sha256 = fields.Str(
+        validate=validate.Regexp("^[0-9a-fA-F]{64}$"),
+        metadata={"description": "The SHA-256 of a GFX or GFX_DATA firmware image flashed before, used instead of file so that the image is not copied to the node again"}
+    )
     firmware_name = fields.Str(
         validate=validate.OneOf(["GFX","GFX_DATA","GFX_CODE_DATA", "GFX_PSCBIN"]),
         metadata={"description": "Firmware name, options are: GFX, GFX_DATA, GFX_CODE_DATA, GFX_PSCBIN"}
@@ -128,13 +134,18 @@ def runFirmwareFlash(deviceId, username="", password="", force=False):
     req = request.get_json()
     # validate file path
     filePath = req.get('file')
-    if not filePath:
+    fileSha256 = req.get('file_sha256')
+    if not filePath and fileSha256:
+        # the daemon flashes the image with this hash it loaded before
+        filePath = 'sha256:' + fileSha256.lower()
+    elif not filePath:
         return jsonify({'error': 'missing arguments'}), 400
-    pos = filePath.find("/")
-    if pos == -1:
-        return jsonify({'error': 'Invalid file path, only full path supported'}), 400
     else:
-        filePath = filePath[pos:]    # trunc the file path
+        pos = filePath.find("/")
+        if pos == -1:
+            return jsonify({'error': 'Invalid file path, only full path supported'}), 400
+        else:
+            filePath = filePath[pos:]    # trunc the file path
 
     fwType = req.get('firmware_name')
     if fwType == 'GFX' and deviceId == 1024:
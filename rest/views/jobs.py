@@ -0,0 +1,186 @@
+#
+# Copyright (C) 2021-2023 Intel Corporation
+# SPDX-License-Identifier: MIT
+# @file jobs.py
+#
+
+import os
+import sys
+from flask import jsonify, request
+import stub
+from stub import devices
+from marshmallow import Schema, fields
+
+rest_folder = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+sys.path.insert(1, os.path.join(rest_folder, "prometheus_exporter"))
+
+
+class OpenJobWindowSchema(Schema):
+    device_ids = fields.List(fields.Int(), metadata={
+                             "description": "The devices used by the job"})
+    namespace = fields.Str(metadata={
+                           "description": "Kubernetes namespace of the pod, used with pod instead of device_ids"})
+    pod = fields.Str(metadata={
+                     "description": "Kubernetes pod name, the job uses the GPUs allocated to the pod"})
+
+
+class JobWindowDeviceSchema(Schema):
+    device_id = fields.Int(metadata={"description": "Device id"})
+    begin = fields.Int(
+        metadata={"description": "Timestamp in milliseconds, the first sample in the window"})
+    end = fields.Int(
+        metadata={"description": "Timestamp in milliseconds, the latest sample in the window"})
+    energy = fields.Int(
+        metadata={"description": "Energy consumed in the window, unit mJ"})
+    avg_power = fields.Number(
+        metadata={"description": "Time-weighted average power, unit W"})
+    peak_power = fields.Number(metadata={"description": "Peak power, unit W"})
+    avg_gpu_utilization = fields.Number(
+        metadata={"description": "Time-weighted average GPU utilization, unit %"})
+    avg_memory_used = fields.Int(
+        metadata={"description": "Time-weighted average memory used, unit B"})
+    peak_memory_used = fields.Int(
+        metadata={"description": "Peak memory used, unit B"})
+    memory_used_integral = fields.Int(
+        metadata={"description": "Memory used integrated over the window, unit B*s"})
+
+
+class JobWindowProcessSchema(Schema):
+    device_id = fields.Int(metadata={"description": "Device id"})
+    process_id = fields.Int(
+        metadata={"description": "Process id, 0 for the energy of the device while no process was busy"})
+    process_name = fields.Str(metadata={"description": "Process name"})
+    container_id = fields.Str(
+        metadata={"description": "The id of the container of the process, empty if it is not in a container"})
+    pod_uid = fields.Str(
+        metadata={"description": "The UID of the Kubernetes pod of the process, empty if it is not in a pod"})
+    busy_time = fields.Int(
+        metadata={"description": "The engine busy time of the process in the window, unit ns"})
+    energy = fields.Int(
+        metadata={"description": "Energy attributed to the process by its busy time, unit mJ"})
+
+
+class JobWindowContainerSchema(Schema):
+    container_id = fields.Str(metadata={"description": "Container id"})
+    pod_uid = fields.Str(
+        metadata={"description": "The UID of the Kubernetes pod of the container, empty if it is not in a pod"})
+    busy_time = fields.Int(
+        metadata={"description": "The engine busy time of the processes of the container on all the devices, unit ns"})
+    energy = fields.Int(
+        metadata={"description": "Energy attributed to the processes of the container on all the devices, unit mJ"})
+
+
+class JobWindowSchema(Schema):
+    job_id = fields.Str(metadata={"description": "Job id"})
+    device_list = fields.Nested(JobWindowDeviceSchema, many=True, metadata={
+                                "description": "Accounting data per device"})
+    process_list = fields.Nested(JobWindowProcessSchema, many=True, metadata={
+                                 "description": "Energy attributed to the processes of each device"})
+    container_list = fields.Nested(JobWindowContainerSchema, many=True, metadata={
+                                   "description": "Energy attributed to the containers"})
+
+
+def _pod_device_ids(namespace, pod):
+    from kube_pod_resource import get_pod_bdf_addresses
+    bdfs = get_pod_bdf_addresses(namespace, pod)
+    code, _, data = devices.getDeviceList()
+    if code != 0:
+        return []
+    return [d['device_id'] for d in data if d['pci_bdf_address'] in bdfs]
+
+
+def _error(code, message):
+    error_name = stub.XpumResult(code).name
+    error = dict(message="Error code: {}, error message: {}".format(
+        error_name, message))
+    if error_name in ("XPUM_RESULT_DEVICE_NOT_FOUND", "XPUM_RESULT_JOB_WINDOW_EXISTS", "XPUM_RESULT_JOB_WINDOW_NOT_FOUND"):
+        return jsonify(error), 400
+    return jsonify(error), 500
+
+
+def job_window(jobId):
+    """
+    Open / Get / Close a job accounting window
+    ---
+    put:
+        tags:
+            - "Statistics"
+        description: Open a job window. Energy, power, GPU utilization and memory used of the devices are integrated until the window is closed.
+        parameters:
+            - 
+                name: jobId
+                in: path
+                description: Job id
+                type: string
+            - 
+                name: devices
+                in: body
+                description: The devices used by the job, either device_ids or the namespace and pod the GPUs are allocated to
+                schema: OpenJobWindowSchema
+        responses:
+            200:
+                description: OK
+            400:
+                description: Error
+            500:
+                description: Error
+    get:
+        tags:
+            - "Statistics"
+        description: Get the accounting data of an open job window
+        parameters:
+            - 
+                name: jobId
+                in: path
+                description: Job id
+                type: string
+        produces: 
+            - application/json
+        responses:
+            200:
+                description: OK
+                schema: JobWindowSchema
+            400:
+                description: Error
+            500:
+                description: Error
+    delete:
+        tags:
+            - "Statistics"
+        description: Close a job window and get its accounting data
+        parameters:
+            - 
+                name: jobId
+                in: path
+                description: Job id
+                type: string
+        produces: 
+            - application/json
+        responses:
+            200:
+                description: OK
+                schema: JobWindowSchema
+            400:
+                description: Error
+            500:
+                description: Error
+    """
+    if request.method == 'PUT':
+        req = request.get_json(silent=True)
+        if req is None:
+            return jsonify(dict(message="Requires device_ids, or namespace and pod")), 400
+        if "pod" in req:
+            deviceIds = _pod_device_ids(req.get("namespace", "default"), req["pod"])
+        else:
+            deviceIds = req.get("device_ids", [])
+        if len(deviceIds) == 0:
+            return jsonify(dict(message="No device found for the job")), 400
+        code, message, data = stub.openJobWindow(jobId, deviceIds)
+    elif request.method == 'GET':
+        code, message, data = stub.getJobWindowStats(jobId)
+    else:
+        code, message, data = stub.closeJobWindow(jobId)
+    if code == 0:
+        return jsonify(data)
+    return _error(code, message)
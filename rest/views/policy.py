@@ -16,9 +16,13 @@ import datetime
 
 class PolicyConditionSchema(Schema):
     type = fields.Str(metadata={
-                      "description": "Policy conditon type. Supported types: XPUM_POLICY_CONDITION_TYPE_GREATER, XPUM_POLICY_CONDITION_TYPE_LESS, XPUM_POLICY_CONDITION_TYPE_WHEN_OCCUR"})
+                      "description": "Policy conditon type. Supported types: XPUM_POLICY_CONDITION_TYPE_GREATER, XPUM_POLICY_CONDITION_TYPE_LESS, XPUM_POLICY_CONDITION_TYPE_WHEN_OCCUR, XPUM_POLICY_CONDITION_TYPE_SUSTAINED_GREATER, XPUM_POLICY_CONDITION_TYPE_RATE_GREATER, XPUM_POLICY_CONDITION_TYPE_EWMA_GREATER"})
     threshold = fields.Int(
-        metadata={"description": "The threshold for policy"})
+        metadata={"description": "The threshold for policy, per second for XPUM_POLICY_CONDITION_TYPE_RATE_GREATER"})
+    window = fields.Int(
+        metadata={"description": "In milliseconds, how long the value stays above threshold for XPUM_POLICY_CONDITION_TYPE_SUSTAINED_GREATER, the time window of XPUM_POLICY_CONDITION_TYPE_EWMA_GREATER"})
+    release_threshold = fields.Int(
+        metadata={"description": "The SUSTAINED_GREATER, RATE_GREATER and EWMA_GREATER conditions trigger once and again only after falling to this value, 0 for threshold"})
 
 
 class PolicyActionSchema(Schema):
@@ -32,7 +36,7 @@ class PolicyActionSchema(Schema):
 
 class PolicySchema(Schema):
     device_id = fields.Int(metadata={"description": "Device id"})
-    type = fields.Str(metadata={"description": "Policy type. Supported types: XPUM_POLICY_TYPE_GPU_TEMPERATURE, XPUM_POLICY_TYPE_GPU_MEMORY_TEMPERATURE, XPUM_POLICY_TYPE_GPU_POWER, XPUM_POLICY_TYPE_RAS_ERROR_CAT_RESET, XPUM_POLICY_TYPE_RAS_ERROR_CAT_PROGRAMMING_ERRORS, XPUM_POLICY_TYPE_RAS_ERROR_CAT_DRIVER_ERRORS, XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE, XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE, XPUM_POLICY_TYPE_GPU_MISSING, XPUM_POLICY_TYPE_GPU_THROTTLE"})
+    type = fields.Str(metadata={"description": "Policy type. Supported types: XPUM_POLICY_TYPE_GPU_TEMPERATURE, XPUM_POLICY_TYPE_GPU_MEMORY_TEMPERATURE, XPUM_POLICY_TYPE_GPU_POWER, XPUM_POLICY_TYPE_RAS_ERROR_CAT_RESET, XPUM_POLICY_TYPE_RAS_ERROR_CAT_PROGRAMMING_ERRORS, XPUM_POLICY_TYPE_RAS_ERROR_CAT_DRIVER_ERRORS, XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_CORRECTABLE, XPUM_POLICY_TYPE_RAS_ERROR_CAT_CACHE_ERRORS_UNCORRECTABLE, XPUM_POLICY_TYPE_GPU_MISSING, XPUM_POLICY_TYPE_GPU_THROTTLE, XPUM_POLICY_TYPE_PRECHECK_ERROR"})
     notify_callback_url = fields.Str(
         metadata={"description": "Policy notify callback url"})
     action = fields.Nested(PolicyActionSchema)
@@ -4,9 +4,10 @@
 # @file statistics.py
 #
 
-from flask import jsonify
+from flask import jsonify, request
 import stub
 from marshmallow import Schema, fields
+from http_cache import etag
 
 
 class StatisticsDataSchema(Schema):
@@ -18,6 +19,12 @@ class StatisticsDataSchema(Schema):
         metadata={"description": "The max value since last query"})
     min = fields.Int(
         metadata={"description": "The min value since last query"})
+    p50 = fields.Number(
+        metadata={"description": "The 50th percentile since last query, within 1% of a sampled value"})
+    p90 = fields.Number(
+        metadata={"description": "The 90th percentile since last query, within 1% of a sampled value"})
+    p99 = fields.Number(
+        metadata={"description": "The 99th percentile since last query, within 1% of a sampled value"})
 
 
 class EngineUtilDataSchema(Schema):
@@ -83,6 +90,7 @@ class StatisticsSchema(Schema):
         "description": "Fabric throughput statistics"})
 
 
+@etag('data')
 def get_statistics(deviceId):
     """
     Get statistics by device
@@ -220,3 +228,128 @@ def get_group_statistics(groupId):
                 if tileId in engineUtilData:
                     t["engine_util"] = engineUtilData[tileId]
     return jsonify(group_data)
+
+
+class MetricsHistoryPointSchema(Schema):
+    timestamp = fields.Int(
+        metadata={"description": "Timestamp in milliseconds, the begin of the step"})
+    min = fields.Number(metadata={"description": "The min value in the step"})
+    avg = fields.Number(
+        metadata={"description": "The average value in the step"})
+    max = fields.Number(metadata={"description": "The max value in the step"})
+    count = fields.Int(
+        metadata={"description": "The number of samples in the step"})
+
+
+class MetricsHistorySeriesSchema(Schema):
+    metrics_type = fields.Str(metadata={"description": "The metric type"})
+    tile_id = fields.Int(
+        metadata={"description": "The tile this series belongs to, absent for device level series"})
+    is_counter = fields.Bool(
+        metadata={"description": "If the points hold accumulated counter values"})
+    points = fields.Nested(MetricsHistoryPointSchema, many=True, metadata={
+                           "description": "Downsampled points"})
+
+
+class MetricsHistorySchema(Schema):
+    device_id = fields.Int(metadata={"description": "Device id"})
+    begin = fields.Int(metadata={"description": "The begin of the time range"})
+    end = fields.Int(metadata={"description": "The end of the time range"})
+    step = fields.Int(metadata={"description": "The length of one step"})
+    series_list = fields.Nested(MetricsHistorySeriesSchema, many=True, metadata={
+                                "description": "History series"})
+
+
+def history_to_chrome_trace(data):
+    # one counter track per series, the same tracks as a dump task of trace format
+    device_id = data["device_id"]
+    events = [dict(name="process_name", ph="M", pid=device_id,
+                   args=dict(name="GPU {}".format(device_id)))]
+    for series in data["series_list"]:
+        name = series["metrics_type"]
+        if "tile_id" in series:
+            name = "Tile {} {}".format(series["tile_id"], name)
+        for p in series["points"]:
+            if p["count"] == 0:
+                continue
+            events.append(dict(name=name, ph="C", ts=p["timestamp"] * 1000,
+                               pid=device_id, tid=0, args=dict(value=p["avg"])))
+    return dict(traceEvents=events, displayTimeUnit="ms")
+
+
+@etag('data')
+def get_statistics_history(deviceId):
+    """
+    Get metrics history by device
+    ---
+    get:
+        tags:
+            - "Statistics"
+        description: Get the downsampled history of metrics from the persisted telemetry data
+        parameters:
+            - 
+                name: deviceId
+                in: path
+                description: Device id
+                type: integer
+            - 
+                name: metrics
+                in: query
+                description: Comma separated metric types, e.g. XPUM_STATS_POWER,XPUM_STATS_GPU_FREQUENCY
+                type: string
+            - 
+                name: begin
+                in: query
+                description: Timestamp in milliseconds, the begin of the time range
+                type: integer
+            - 
+                name: end
+                in: query
+                description: Timestamp in milliseconds, the end of the time range
+                type: integer
+            - 
+                name: step
+                in: query
+                description: The length in milliseconds of one step
+                type: integer
+            - 
+                name: format
+                in: query
+                description: json, or chrome-trace for a Chrome trace event JSON of the step averages, to open in Perfetto or chrome://tracing. The default is json.
+                type: string
+        produces: 
+            - application/json
+        responses:
+            200:
+                description: OK
+                schema: MetricsHistorySchema
+            400:
+                description: Error
+            500:
+                description: Error
+    """
+    try:
+        metricsTypes = [stub.XpumStatsType[name.strip()].value for name in request.args.get(
+            "metrics", "").split(",") if len(name.strip()) > 0]
+        begin = int(request.args["begin"])
+        end = int(request.args["end"])
+        step = int(request.args["step"])
+    except (KeyError, ValueError):
+        error = dict(message="Invalid metrics, begin, end or step")
+        return jsonify(error), 400
+    output_format = request.args.get("format", "json")
+    if output_format not in ("json", "chrome-trace"):
+        error = dict(message="Invalid format")
+        return jsonify(error), 400
+    code, message, data = stub.getMetricsHistory(
+        deviceId, metricsTypes, begin, end, step)
+    if code == 0:
+        if output_format == "chrome-trace":
+            return jsonify(history_to_chrome_trace(data))
+        return jsonify(data)
+    error_name = stub.XpumResult(code).name
+    error = dict(message="Error code: {}, error message: {}".format(
+        error_name, message))
+    if error_name in ("XPUM_RESULT_DEVICE_NOT_FOUND", "XPUM_INTERVAL_INVALID", "XPUM_METRIC_NOT_SUPPORTED"):
+        return jsonify(error), 400
+    return jsonify(error), 500
@@ -6,7 +6,8 @@
 
 from flask import request, jsonify
 import stub
-from marshmallow import Schema, fields
+from marshmallow import Schema, fields, ValidationError
+from http_cache import etag
 
 
 class TopologyInfoSchema(Schema):
@@ -20,6 +21,7 @@ class TopologyInfoSchema(Schema):
         metadata={"description": "list of switch device path"}))
 
 
+@etag('topology')
 def get_topology(deviceId):
     """
     Get device topology.
@@ -64,6 +66,7 @@ class TopologyXelinkSchema(Schema):
         "description": "port list link to remote device"}))
 
 
+@etag('data')
 def get_topo_xelink():
     """
     Get xelink topology.
@@ -94,6 +97,7 @@ class TopologyXMLSchema(Schema):
         metadata={"description": "XML sting of node topology"})
 
 
+@etag('topology')
 def export_topology():
     """
     Export node topology xml string.
@@ -116,3 +120,85 @@ def export_topology():
         return jsonify(data)
     error = dict(Status=code, Message=message)
     return jsonify(error), 400
+
+
+class XeLinkMatrixRunSchema(Schema):
+    device_id_list = fields.List(fields.Int(strict=True), required=False, metadata={
+        "description": "the devices to measure, all devices if empty"})
+
+
+class XeLinkMatrixEntrySchema(Schema):
+    src_device_id = fields.Int(metadata={"description": "device copied from"})
+    src_tile_id = fields.Int(metadata={"description": "tile copied from"})
+    dst_device_id = fields.Int(metadata={"description": "device copied to"})
+    dst_tile_id = fields.Int(metadata={"description": "tile copied to"})
+    copy_engine_group = fields.Int(metadata={
+        "description": "engine group of the source tile with the highest bandwidth"})
+    uni_bandwidth = fields.Float(metadata={
+        "description": "bandwidth from the source to the destination, in GBPS"})
+    bi_bandwidth = fields.Float(metadata={
+        "description": "bandwidth of both directions at the same time, in GBPS"})
+    latency = fields.Float(metadata={
+        "description": "device time of a 4 KiB copy, in microseconds"})
+    degraded = fields.Boolean(metadata={
+        "description": "if the bandwidth is low compared to the other pairs"})
+    timestamp = fields.Int(metadata={
+        "description": "when the pair was measured, in milliseconds since the epoch"})
+
+
+class XeLinkMatrixSchema(Schema):
+    running = fields.Boolean(metadata={
+        "description": "if a measure is running, the entries are from the previous one"})
+    entry_list = fields.List(fields.Nested(XeLinkMatrixEntrySchema))
+
+
+def xelink_matrix():
+    """
+    Xe Link bandwidth matrix.
+    ---
+    get:
+        tags:
+            - "Topology"
+        description: Get the last Xe Link bandwidth and latency matrix measured
+        produces: 
+            - application/json
+        responses:
+            200:
+                description: OK
+                schema: XeLinkMatrixSchema
+            400:
+                description: Error
+    post:
+        tags:
+            - "Topology"
+        description: Start to measure the Xe Link bandwidth and latency between the tiles of devices
+        consumes:
+            - application/json
+        parameters:
+            - 
+                name: device list
+                in: body
+                description: 
+                schema: XeLinkMatrixRunSchema
+        produces: 
+            - application/json
+        responses:
+            200:
+                description: OK
+            400:
+                description: Error
+    """
+    if request.method == 'POST':
+        req = request.get_json(silent=True) or dict()
+        try:
+            XeLinkMatrixRunSchema().load(req)
+        except ValidationError as err:
+            return jsonify(err.messages), 400
+        code, message, data = stub.runXeLinkMatrix(
+            req.get("device_id_list", []))
+    else:
+        code, message, data = stub.getXeLinkMatrix()
+    if code == 0:
+        return jsonify(data)
+    error = dict(Status=code, Message=message)
+    return jsonify(error), 400
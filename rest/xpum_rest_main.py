@@ -29,8 +29,10 @@ from views import ps
 from views import dump_raw_data
 from views import sensor
 from views import vgpu
+from views import jobs
 
 import xpum_logger as logger
+import http_cache
 
 import argparse
 
@@ -58,6 +60,9 @@ def main(*args, **kwargs):
 
     app.url_map.strict_slashes = False
 
+    # gzip or br bodies for the clients asking for them
+    app.after_request(http_cache.compress_response)
+
     # version
     app.add_url_rule('/rest/v1/version',
                      view_func=versions.get_version, methods=['GET'])
@@ -145,9 +150,15 @@ def main(*args, **kwargs):
     # statistics
     app.add_url_rule('/rest/v1/devices/<int:deviceId>/stats', methods=['GET'],
                      view_func=auth.login_required(statistics.get_statistics))
+    app.add_url_rule('/rest/v1/devices/<int:deviceId>/stats/history', methods=['GET'],
+                     view_func=auth.login_required(statistics.get_statistics_history))
     app.add_url_rule('/rest/v1/groups/<int:groupId>/stats', methods=['GET'],
                      view_func=auth.login_required(statistics.get_group_statistics))
 
+    # job accounting
+    app.add_url_rule('/rest/v1/jobs/<jobId>', methods=['PUT', 'GET', 'DELETE'],
+                     view_func=auth.login_required(jobs.job_window))
+
     # device config
     app.add_url_rule('/rest/v1/devices/<int:deviceId>/standby', methods=['PUT'],
                      view_func=auth.login_required(device_config.set_standby))
@@ -179,6 +190,8 @@ def main(*args, **kwargs):
                      view_func=auth.login_required(topology.export_topology))
     app.add_url_rule('/rest/v1/topology/xelink', methods=['GET'],
                      view_func=auth.login_required(topology.get_topo_xelink))
+    app.add_url_rule('/rest/v1/topology/xelink/matrix', methods=['GET', 'POST'],
+                     view_func=auth.login_required(topology.xelink_matrix))
 
     # ps
     app.add_url_rule('/rest/v1/devices/<int:deviceId>/ps', methods=['GET'],
@@ -17,11 +17,64 @@
  * 
  */
 
+#include <cstdint>
 #include <vector>
-#include <string>
+
+/**
+ * The inbound PCIe throughput of one Intel GPU in the last sampling interval
+ */
+struct pcm_iio_gpu_counter {
+    uint8_t bus;
+    uint8_t device;
+    uint8_t function;
+    uint64_t read_bytes_per_sec;
+    uint64_t write_bytes_per_sec;
+};
 
 int pcm_iio_gpu_init();
 
-std::vector<std::string> pcm_iio_gpu_query();
+/**
+ * Sample the IIO counters for interval_ms milliseconds, the default interval
+ * if it is 0, and fill counters with one entry per GPU. Return 0 on success.
+ */
+int pcm_iio_gpu_query_counters(std::vector<pcm_iio_gpu_counter>& counters, uint32_t interval_ms);
+
+/**
+ * The DRAM and UPI traffic of one socket in the last sampling interval
+ */
+struct pcm_host_socket_counter {
+    uint32_t socket;
+    uint64_t dram_read_bytes_per_sec;
+    uint64_t dram_write_bytes_per_sec;
+    // the data received over all UPI links
+    uint64_t upi_incoming_bytes_per_sec;
+    // the incoming data utilization of the busiest UPI link, in 0.01%
+    uint32_t upi_utilization;
+};
+
+/**
+ * The inbound PCIe throughput of one IIO stack in the last sampling interval,
+ * whatever devices are attached to it
+ */
+struct pcm_iio_stack_counter {
+    uint32_t socket;
+    uint32_t stack;
+    uint64_t read_bytes_per_sec;
+    uint64_t write_bytes_per_sec;
+};
+
+/**
+ * Program the memory controller and UPI counters of the sockets after
+ * pcm_iio_gpu_init(). They are then read at the start and the end of each
+ * pcm_iio_gpu_query_counters() window. Return 0 on success.
+ */
+int pcm_iio_gpu_enable_host_counters();
+
+/**
+ * Fill sockets and stacks with the host counters of the last
+ * pcm_iio_gpu_query_counters() window. Return 0 on success, and -1 if the
+ * host counters are not enabled or no window ended yet.
+ */
+int pcm_iio_gpu_query_host_counters(std::vector<pcm_host_socket_counter>& sockets, std::vector<pcm_iio_stack_counter>& stacks);
 
 #endif
\ No newline at end of file
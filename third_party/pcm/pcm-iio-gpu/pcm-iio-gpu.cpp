@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <set>
 #include <map>
+#include <chrono>
 
 #include "../src/lspci.h"
 #include "../src/utils.h"
@@ -41,8 +42,6 @@ using namespace pcm;
 #define SKX_UNC_SOCKETID_UBOX_GID_OFFSET  0xD4
 
 const uint8_t max_sockets = 4;
-int seq = 1;
-const uint32 max_seq = 10000;
 static const std::string iio_stack_names[6] = {
     "IIO Stack 0 - CBDMA/DMI      ",
     "IIO Stack 1 - PCIe0          ",
@@ -338,13 +337,24 @@ void build_pci_tree(vector<string> &buffer, const PCIDB & pciDB, uint32_t column
 bool cacheSocketStack = false;
 map<uint32, set<uint32>> cachedSocketIdToStackId;
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wformat-truncation" 
-vector<string> query_data(vector<struct iio_stacks_on_socket>& iios, vector<struct iio_counter>& ctrs, const map<string,std::pair<h_id,std::map<string,v_id>>> &nameMap)
+// the h_ids of the inbound read and write events
+void find_inbound_h_ids(const map<string,std::pair<h_id,std::map<string,v_id>>> &nameMap, uint32_t& read_h_id, uint32_t& write_h_id)
 {
-    vector<string> iio_datas;
-    vector<string> headers;
-    vector<struct data> data;
+    read_h_id = 0;
+    write_h_id = 1;
+    for (auto iunit = nameMap.cbegin(); iunit != nameMap.cend(); ++iunit) {
+        if (iunit->first.compare(0, 7, "IB read") == 0)
+            read_h_id = iunit->second.first;
+        else if (iunit->first.compare(0, 8, "IB write") == 0)
+            write_h_id = iunit->second.first;
+    }
+}
+
+void query_counters(vector<struct iio_stacks_on_socket>& iios, vector<struct iio_counter>& ctrs, const map<string,std::pair<h_id,std::map<string,v_id>>> &nameMap, vector<pcm_iio_gpu_counter>& counters)
+{
+    uint32_t read_h_id, write_h_id;
+    find_inbound_h_ids(nameMap, read_h_id, write_h_id);
+    counters.clear();
     for (auto socket = iios.cbegin(); socket != iios.cend(); ++socket) {
         if (cacheSocketStack && cachedSocketIdToStackId.find(socket->socket_id) == cachedSocketIdToStackId.end())
             continue;
@@ -380,49 +390,66 @@ vector<string> query_data(vector<struct iio_stacks_on_socket>& iios, vector<stru
             }
             cachedSocketIdToStackId[socket->socket_id].insert(stack->iio_unit_id);
             auto stack_id = stack->iio_unit_id;
-            headers = combine_stack_name_and_counter_names(stack->stack_name, nameMap);
             std::map<uint32_t,map<uint32_t,struct iio_counter*>> v_sort;
             for (std::vector<struct iio_counter>::iterator counter = ctrs.begin(); counter != ctrs.end(); ++counter) {
                 v_sort[counter->v_id][counter->h_id] = &(*counter);
             }
             for (std::map<uint32_t,map<uint32_t,struct iio_counter*>>::const_iterator vunit = v_sort.cbegin(); vunit != v_sort.cend(); ++vunit) {
-                map<uint32_t, struct iio_counter*> h_array = vunit->second;
+                const map<uint32_t, struct iio_counter*>& h_array = vunit->second;
                 uint32_t vv_id = vunit->first;
-                vector<uint64_t> h_data;
-                string v_name = h_array[0]->v_event_name;
-                for (map<uint32_t,struct iio_counter*>::const_iterator hunit = h_array.cbegin(); hunit != h_array.cend(); ++hunit) {
-                    uint32_t hh_id = hunit->first;
-                    uint64_t raw_data = hunit->second->data[0][socket->socket_id][stack_id][std::pair<h_id,v_id>(hh_id,vv_id)];
-                    h_data.push_back(raw_data);
-                }
-                data = prepare_data(h_data, headers); 
-                char bdf_buf[10];
-                snprintf(bdf_buf, sizeof(bdf_buf), "%02x:%02x.%1d", target_pci_device.bdf.busno, target_pci_device.bdf.devno, target_pci_device.bdf.funcno);
-                ostringstream os;
-                os <<  "seq=" << seq <<",bdf=" << bdf_buf;
-                for (size_t index = 1; index < headers.size(); index++) {
-                    os << "," << headers[index] << "=" << (data[index - 1].value);
-                }
-                iio_datas.push_back(os.str());
+                // the sample of an event is in bytes per second
+                auto sample = [&](uint32_t hh_id) -> uint64_t {
+                    auto hunit = h_array.find(hh_id);
+                    if (hunit == h_array.end() || hunit->second->data.empty())
+                        return 0;
+                    return hunit->second->data[0][socket->socket_id][stack_id][std::pair<h_id,v_id>(hh_id,vv_id)];
+                };
+                pcm_iio_gpu_counter counter = {};
+                counter.read_bytes_per_sec = sample(read_h_id);
+                counter.write_bytes_per_sec = sample(write_h_id);
+                counter.bus = target_pci_device.bdf.busno;
+                counter.device = target_pci_device.bdf.devno;
+                counter.function = target_pci_device.bdf.funcno;
+                counters.push_back(counter);
                 if (countGPU == 2 && target_pci_device_buddy.device_id == 0x56C1) {
-                    os.str("");
-                    os.clear();
-                    snprintf(bdf_buf, sizeof(bdf_buf), "%02x:%02x.%1d", target_pci_device_buddy.bdf.busno, target_pci_device_buddy.bdf.devno, target_pci_device_buddy.bdf.funcno);
-                    os <<  "seq=" << seq <<",bdf=" << bdf_buf;
-                    for (size_t index = 1; index < headers.size(); index++) {
-                        os << "," << headers[index] << "=" << (data[index - 1].value);
-                    }
-                    iio_datas.push_back(os.str());
+                    counter.bus = target_pci_device_buddy.bdf.busno;
+                    counter.device = target_pci_device_buddy.bdf.devno;
+                    counter.function = target_pci_device_buddy.bdf.funcno;
+                    counters.push_back(counter);
                 }
-                seq += 1;
-                seq = seq % max_seq;
             }
         }
     }
     cacheSocketStack = true;
-    return iio_datas;
 }
-#pragma GCC diagnostic pop
+
+// the inbound traffic of every stack, summed over the parts of the stack
+void query_stack_counters(const vector<struct iio_stacks_on_socket>& iios, const vector<struct iio_counter>& ctrs, const map<string,std::pair<h_id,std::map<string,v_id>>> &nameMap, vector<pcm_iio_stack_counter>& stacks)
+{
+    uint32_t read_h_id, write_h_id;
+    find_inbound_h_ids(nameMap, read_h_id, write_h_id);
+    stacks.clear();
+    for (auto socket = iios.cbegin(); socket != iios.cend(); ++socket) {
+        for (auto stack = socket->stacks.cbegin(); stack != socket->stacks.cend(); ++stack) {
+            pcm_iio_stack_counter counter = {};
+            counter.socket = socket->socket_id;
+            counter.stack = stack->iio_unit_id;
+            for (const auto& ctr : ctrs) {
+                if (ctr.data.empty() || (ctr.h_id != read_h_id && ctr.h_id != write_h_id))
+                    continue;
+                const auto& samples = ctr.data[0][socket->socket_id][stack->iio_unit_id];
+                auto sample = samples.find(std::pair<h_id,v_id>(ctr.h_id, ctr.v_id));
+                if (sample == samples.end())
+                    continue;
+                if (ctr.h_id == read_h_id)
+                    counter.read_bytes_per_sec += sample->second;
+                else
+                    counter.write_bytes_per_sec += sample->second;
+            }
+            stacks.push_back(counter);
+        }
+    }
+}
 
 std::string get_root_port_dev(const bool show_root_port, int part_id,  const pcm::iio_stack *stack)
 {
@@ -1536,8 +1563,99 @@ int pcm_iio_gpu_init(){
     return 0;
 }
 
-vector<string> pcm_iio_gpu_query() {
-    collect_data(m, PCM_DELAY_DEFAULT, iios, evt_ctx.ctrs);
-    vector<string> datas = query_data(iios, evt_ctx.ctrs, nameMap);
-    return datas;
+// the host counters, read around each IIO sampling window when enabled
+bool host_counters_enabled = false;
+bool host_counters_valid = false;
+vector<pcm_host_socket_counter> host_sockets;
+vector<pcm_iio_stack_counter> host_stacks;
+
+struct host_counter_states {
+    SystemCounterState system;
+    vector<SocketCounterState> sockets;
+    std::chrono::steady_clock::time_point time;
+};
+
+void read_host_states(host_counter_states& states)
+{
+    m->getUncoreCounterStates(states.system, states.sockets);
+    states.time = std::chrono::steady_clock::now();
+}
+
+void query_host_counters(const host_counter_states& before, const host_counter_states& after)
+{
+    double seconds = std::chrono::duration<double>(after.time - before.time).count();
+    if (seconds <= 0)
+        return;
+    host_sockets.clear();
+    for (uint32_t socket = 0; socket < m->getNumSockets() && socket < after.sockets.size(); ++socket) {
+        pcm_host_socket_counter counter = {};
+        counter.socket = socket;
+        counter.dram_read_bytes_per_sec = uint64_t(getBytesReadFromMC(before.sockets[socket], after.sockets[socket]) / seconds);
+        counter.dram_write_bytes_per_sec = uint64_t(getBytesWrittenToMC(before.sockets[socket], after.sockets[socket]) / seconds);
+        double max_utilization = 0;
+        for (uint32_t link = 0; link < (uint32_t)m->getQPILinksPerSocket(); ++link) {
+            uint64_t bytes = getIncomingQPILinkBytes(socket, link, before.system, after.system);
+            counter.upi_incoming_bytes_per_sec += uint64_t(bytes / seconds);
+            // the link speed is in bytes per second, the wall time is used as the uncore TSC is not read
+            double speed = double(m->getQPILinkSpeed(socket, link));
+            if (speed > 0)
+                max_utilization = (std::max)(max_utilization, bytes / (speed * seconds));
+        }
+        counter.upi_utilization = uint32_t((std::min)(max_utilization, 1.0) * 10000);
+        host_sockets.push_back(counter);
+    }
+    query_stack_counters(iios, evt_ctx.ctrs, nameMap, host_stacks);
+    host_counters_valid = true;
+}
+
+int pcm_iio_gpu_query_counters(std::vector<pcm_iio_gpu_counter>& counters, uint32_t interval_ms) {
+    if (m == nullptr || evt_ctx.ctrs.empty()) {
+        return -1;
+    }
+    std::unique_ptr<host_counter_states> before, after;
+    if (host_counters_enabled) {
+        before.reset(new host_counter_states());
+        read_host_states(*before);
+    }
+    collect_data(m, interval_ms > 0 ? interval_ms / 1000.0 : PCM_DELAY_DEFAULT, iios, evt_ctx.ctrs);
+    if (host_counters_enabled) {
+        after.reset(new host_counter_states());
+        read_host_states(*after);
+    }
+    query_counters(iios, evt_ctx.ctrs, nameMap, counters);
+    if (host_counters_enabled) {
+        query_host_counters(*before, *after);
+    }
+    return 0;
+}
+
+int pcm_iio_gpu_enable_host_counters() {
+    if (m == nullptr || evt_ctx.ctrs.empty()) {
+        return -1;
+    }
+    if (!m->memoryTrafficMetricsAvailable()) {
+        std::cout << "Error! Memory traffic metrics are not supported on this CPU." << std::endl;
+        return -1;
+    }
+    // the memory controller and UPI counters are programmed with the default events, like pcm-memory and pcm
+    cerr.setstate(ios_base::failbit);
+    cout.setstate(ios_base::failbit);
+    PCM::ErrorCode status = m->program(PCM::DEFAULT_EVENTS, nullptr, true);
+    cout.clear();
+    cerr.clear();
+    if (status != PCM::Success) {
+        std::cout << "Error! Failed to program the host counters: " << status << std::endl;
+        return -1;
+    }
+    host_counters_enabled = true;
+    return 0;
+}
+
+int pcm_iio_gpu_query_host_counters(std::vector<pcm_host_socket_counter>& sockets, std::vector<pcm_iio_stack_counter>& stacks) {
+    if (!host_counters_enabled || !host_counters_valid) {
+        return -1;
+    }
+    sockets = host_sockets;
+    stacks = host_stacks;
+    return 0;
 }
\ No newline at end of file
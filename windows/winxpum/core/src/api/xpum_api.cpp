@@ -934,6 +934,7 @@ xpum_result_t xpumSetDeviceFrequencyRange(xpum_device_id_t deviceId, const xpum_
         }
 
         std::map<MeasurementType, std::shared_ptr<MeasurementData>> m_datas = pDevice->getRealtimeMetrics();
+        Core::instance().getDeviceManager()->startMetricsSampler();
         auto datas_iter = m_datas.begin();
         xpum_device_realtime_metrics_t device_realtime_metrics {};
         device_realtime_metrics.deviceId = deviceId;
@@ -8,6 +8,7 @@
 #include "device_manager.h"
 
 #include "device/gpu/gpu_device_stub.h"
+#include "infrastructure/configuration.h"
 #include "infrastructure/logger.h"
 
 
@@ -18,6 +19,7 @@ namespace xpum {
     }
 
     DeviceManager::~DeviceManager() {
+        close();
         XPUM_LOG_TRACE("~DeviceManager()");
     }
 
@@ -30,7 +32,38 @@ namespace xpum {
     }
 
     void DeviceManager::close() {
-    
+        {
+            std::unique_lock<std::mutex> lock(sampler_mutex);
+            sampler_stop = true;
+        }
+        sampler_cv.notify_all();
+        if (sampler.joinable()) {
+            sampler.join();
+        }
+    }
+
+    void DeviceManager::startMetricsSampler() {
+        std::unique_lock<std::mutex> lock(sampler_mutex);
+        if (Configuration::REALTIME_METRICS_SAMPLING_PERIOD <= 0 || sampler.joinable() || sampler_stop) {
+            return;
+        }
+        XPUM_LOG_INFO("Sample the realtime metrics every {} ms", Configuration::REALTIME_METRICS_SAMPLING_PERIOD);
+        // a loop of queries, e.g. xpu-smi dump, then reads the latest values instead of waiting for a sample
+        sampler = std::thread([this]() {
+            std::unique_lock<std::mutex> lock(sampler_mutex);
+            while (!sampler_cv.wait_for(lock, std::chrono::milliseconds(Configuration::REALTIME_METRICS_SAMPLING_PERIOD), [this]() { return sampler_stop; })) {
+                lock.unlock();
+                std::vector<std::shared_ptr<Device>> list;
+                getDeviceList(list);
+                for (auto& p_device : list) {
+                    p_device->refreshRealtimeMetrics();
+                }
+                lock.lock();
+                if (sampler_stop) {
+                    break;
+                }
+            }
+        });
     }
 
     void DeviceManager::getDeviceList(std::vector<std::shared_ptr<Device>>& devices) {
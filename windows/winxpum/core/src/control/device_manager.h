@@ -8,7 +8,9 @@
 
 #include "device_manager_interface.h"
 
+#include <condition_variable>
 #include <memory>
+#include <thread>
 
 namespace xpum {
 
@@ -46,10 +48,20 @@ namespace xpum {
         bool setDeviceFrequencyRange(const std::string& id, int32_t tileId, double min, double max) override;
 
         void getFreqAvailableClocks(const std::string& id, int32_t tileId, std::vector<double>& clocksList) override;
+
+        void startMetricsSampler() override;
     private:
         std::vector<std::shared_ptr<Device>> devices;
 
         std::mutex mutex;
+
+        std::thread sampler;
+
+        std::mutex sampler_mutex;
+
+        std::condition_variable sampler_cv;
+
+        bool sampler_stop = false;
     };
 
 } // end namespace xpum
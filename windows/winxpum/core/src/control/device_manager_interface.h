@@ -39,5 +39,8 @@ namespace xpum {
         virtual bool setDeviceFrequencyRange(const std::string& id, int32_t tileId, double min, double max) = 0;
 
         virtual void getFreqAvailableClocks(const std::string& id, int32_t tileId, std::vector<double>& clocksList) = 0;
+
+        // start refreshing the realtime metrics of all devices in the background, if it is not started yet
+        virtual void startMetricsSampler() = 0;
     };
 }
\ No newline at end of file
@@ -90,6 +90,9 @@ namespace xpum {
 
         virtual std::map<MeasurementType, std::shared_ptr<MeasurementData>> getRealtimeMetrics() noexcept = 0;
 
+        // sample the realtime metrics into the latest value table now
+        virtual void refreshRealtimeMetrics() noexcept = 0;
+
         virtual void getFreqAvailableClocks(int32_t tileId, std::vector<double>& clocksList) noexcept = 0;
         virtual ~Device() {}
 
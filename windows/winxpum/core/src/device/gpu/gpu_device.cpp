@@ -10,6 +10,7 @@
 #include "device/win_native.h"
 
 #include "infrastructure/configuration.h"
+#include "infrastructure/utility.h"
 
 namespace xpum {
     GPUDevice::GPUDevice() {
@@ -150,17 +151,66 @@ namespace xpum {
     }
 
     std::map<MeasurementType, std::shared_ptr<MeasurementData>> GPUDevice::getRealtimeMetrics() noexcept {
+        {
+            std::unique_lock<std::mutex> lock(latest_mutex);
+            if (latest_time > 0 && Utility::getCurrentMillisecond() - latest_time < Configuration::REALTIME_METRICS_MAX_AGE) {
+                return latest_metrics;
+            }
+        }
+        std::unique_lock<std::mutex> sampling_lock(sampling_mutex);
+        {
+            // another caller or the sampler may have refreshed it meanwhile
+            std::unique_lock<std::mutex> lock(latest_mutex);
+            if (latest_time > 0 && Utility::getCurrentMillisecond() - latest_time < Configuration::REALTIME_METRICS_MAX_AGE) {
+                return latest_metrics;
+            }
+        }
+        auto datas = sampleRealtimeMetrics();
+        std::unique_lock<std::mutex> lock(latest_mutex);
+        latest_metrics = datas;
+        latest_time = Utility::getCurrentMillisecond();
+        return datas;
+    }
+
+    void GPUDevice::refreshRealtimeMetrics() noexcept {
+        std::unique_lock<std::mutex> sampling_lock(sampling_mutex);
+        auto datas = sampleRealtimeMetrics();
+        std::unique_lock<std::mutex> lock(latest_mutex);
+        latest_metrics = datas;
+        latest_time = Utility::getCurrentMillisecond();
+    }
+
+    std::map<MeasurementType, std::shared_ptr<MeasurementData>> GPUDevice::sampleRealtimeMetrics() noexcept {
         updatePDHQuery();
         std::map<MeasurementType, std::shared_ptr<MeasurementData>> datas;
 
         int val = -1;
         int scale = 1;
 
+        // the power and the engine group utilizations share one sampling window
+        std::set<MeasurementType> windowed_types;
+        for (auto type : Configuration::getEnabledMetrics()) {
+            switch (type) {
+                case xpum::METRIC_POWER:
+                case xpum::METRIC_COMPUTATION:
+                case xpum::METRIC_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION:
+                case xpum::METRIC_ENGINE_GROUP_MEDIA_ALL_UTILIZATION:
+                case xpum::METRIC_ENGINE_GROUP_COPY_ALL_UTILIZATION:
+                case xpum::METRIC_ENGINE_GROUP_RENDER_ALL_UTILIZATION:
+                case xpum::METRIC_ENGINE_GROUP_3D_ALL_UTILIZATION:
+                    windowed_types.insert(type);
+                    break;
+                default:
+                    break;
+            }
+        }
+        auto windowed = GPUDeviceStub::instance().toGetWindowedMetrics(zes_device_handle, windowed_types);
+
         for (auto type : Configuration::getEnabledMetrics()) {
             std::shared_ptr<MeasurementData> data = std::make_shared<MeasurementData>();
             switch (type) {
                 case xpum::METRIC_POWER:
-                    getPower(data);
+                    data = windowed[type];
                     break;
                 case xpum::METRIC_ENERGY:
                     getEnergy(data);
@@ -192,7 +242,7 @@ namespace xpum {
                 case xpum::METRIC_ENGINE_GROUP_COPY_ALL_UTILIZATION:
                 case xpum::METRIC_ENGINE_GROUP_RENDER_ALL_UTILIZATION:
                 case xpum::METRIC_ENGINE_GROUP_3D_ALL_UTILIZATION:
-                    getEngineGroupUtilization(data, type);
+                    data = windowed[type];
                     if (data->getCurrent() != UINT64_MAX) {
                         val = max(val, (int)data->getCurrent());
                         scale = data->getScale();
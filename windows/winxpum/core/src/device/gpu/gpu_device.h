@@ -76,13 +76,27 @@ namespace xpum {
 
         void getFreqAvailableClocks(int32_t tileId, std::vector<double>& clocksList) noexcept override;
 
+		// the latest value table, sampled again when it is older than Configuration::REALTIME_METRICS_MAX_AGE
 		std::map<MeasurementType, std::shared_ptr<MeasurementData>> getRealtimeMetrics() noexcept override;
 
+		void refreshRealtimeMetrics() noexcept override;
+
 		virtual ~GPUDevice();
 	
 	private:
+		std::map<MeasurementType, std::shared_ptr<MeasurementData>> sampleRealtimeMetrics() noexcept;
+
 		zes_device_handle_t zes_device_handle = nullptr;
 
 		ze_driver_handle_t ze_driver_handle = nullptr;
+
+		// held while sampling, so concurrent callers wait for one sample instead of taking their own
+		std::mutex sampling_mutex;
+
+		std::mutex latest_mutex;
+
+		std::map<MeasurementType, std::shared_ptr<MeasurementData>> latest_metrics;
+
+		long long latest_time = 0;
 	};
 } // end namespace xpum
\ No newline at end of file
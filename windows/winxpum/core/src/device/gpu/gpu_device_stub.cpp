@@ -522,51 +522,278 @@ namespace xpum {
         }
     }
 
-    std::shared_ptr<MeasurementData> GPUDeviceStub::toGetPower(const zes_device_handle_t& device) noexcept {
-        std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
-        if (device == nullptr) {
-            ret->setErrors("toGetPower error");
-            return ret;
+    ze_result_t GPUDeviceStub::getPowerHandles(const zes_device_handle_t& device, std::vector<zes_pwr_handle_t>& handles) noexcept {
+        std::unique_lock<std::mutex> lock(handle_mutex);
+        auto it = power_handles.find(device);
+        if (it != power_handles.end()) {
+            handles = it->second;
+            return ZE_RESULT_SUCCESS;
         }
-
-        std::map<std::string, ze_result_t> exception_msgs;
         uint32_t power_domain_count = 0;
         ze_result_t res;
         XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
-        std::vector<zes_pwr_handle_t> power_handles(power_domain_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
-        if (res == ZE_RESULT_SUCCESS && power_domain_count > 0) {
-            for (auto& power : power_handles) {
-                zes_power_properties_t props = {};
-                XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetProperties(power, &props));
+        if (res != ZE_RESULT_SUCCESS) {
+            return res;
+        }
+        std::vector<zes_pwr_handle_t> all(power_domain_count);
+        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, all.data()));
+        if (res != ZE_RESULT_SUCCESS) {
+            return res;
+        }
+        // only the domains whose properties can be read are sampled
+        handles.clear();
+        for (auto& power : all) {
+            zes_power_properties_t props = {};
+            XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetProperties(power, &props));
+            if (res != ZE_RESULT_SUCCESS) {
+                return res;
+            }
+            handles.push_back(power);
+        }
+        power_handles[device] = handles;
+        return ZE_RESULT_SUCCESS;
+    }
+
+    ze_result_t GPUDeviceStub::getEngineGroups(const zes_device_handle_t& device, std::vector<EngineGroup>& groups) noexcept {
+        std::unique_lock<std::mutex> lock(handle_mutex);
+        auto it = engine_groups.find(device);
+        if (it != engine_groups.end()) {
+            groups = it->second;
+            return ZE_RESULT_SUCCESS;
+        }
+        uint32_t engine_count = 0;
+        ze_result_t res;
+        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_count, nullptr));
+        XPUM_LOG_DEBUG("res = {}, engine_count = {}", res, engine_count);
+        if (res != ZE_RESULT_SUCCESS) {
+            return res;
+        }
+        std::vector<zes_engine_handle_t> engines(engine_count);
+        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_count, engines.data()));
+        if (res != ZE_RESULT_SUCCESS) {
+            return res;
+        }
+        groups.clear();
+        for (auto& engine : engines) {
+            zes_engine_properties_t props = {};
+            props.stype = ZES_STRUCTURE_TYPE_ENGINE_PROPERTIES;
+            props.pNext = nullptr;
+            XPUM_ZE_HANDLE_LOCK(engine, res = zesEngineGetProperties(engine, &props));
+            if (res != ZE_RESULT_SUCCESS) {
+                return res;
+            }
+            groups.push_back({engine, props.type});
+        }
+        engine_groups[device] = groups;
+        return ZE_RESULT_SUCCESS;
+    }
+
+    std::shared_ptr<MeasurementData> GPUDeviceStub::toGetPower(const zes_device_handle_t& device) noexcept {
+        return toGetWindowedMetrics(device, {METRIC_POWER})[METRIC_POWER];
+    }
+
+    static bool engineGroupOfMetric(MeasurementType type, zes_engine_group_t& group) {
+        switch (type) {
+            case MeasurementType::METRIC_COMPUTATION:
+                group = ZES_ENGINE_GROUP_ALL;
+                return true;
+            case MeasurementType::METRIC_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION:
+                group = ZES_ENGINE_GROUP_COMPUTE_ALL;
+                return true;
+            case MeasurementType::METRIC_ENGINE_GROUP_RENDER_ALL_UTILIZATION:
+                group = ZES_ENGINE_GROUP_RENDER_ALL;
+                return true;
+            case MeasurementType::METRIC_ENGINE_GROUP_MEDIA_ALL_UTILIZATION:
+                group = ZES_ENGINE_GROUP_MEDIA_ALL;
+                return true;
+            case MeasurementType::METRIC_ENGINE_GROUP_COPY_ALL_UTILIZATION:
+                group = ZES_ENGINE_GROUP_COPY_ALL;
+                return true;
+            case MeasurementType::METRIC_ENGINE_GROUP_3D_ALL_UTILIZATION:
+                group = ZES_ENGINE_GROUP_3D_ALL;
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    std::map<MeasurementType, std::shared_ptr<MeasurementData>> GPUDeviceStub::toGetWindowedMetrics(const zes_device_handle_t& device, const std::set<MeasurementType>& types) noexcept {
+        std::map<MeasurementType, std::shared_ptr<MeasurementData>> datas;
+        std::map<MeasurementType, std::map<std::string, ze_result_t>> exception_msgs;
+        for (auto type : types) {
+            datas[type] = std::make_shared<MeasurementData>();
+        }
+        if (device == nullptr) {
+            for (auto& data : datas) {
+                data.second->setErrors("toGetWindowedMetrics error");
+            }
+            return datas;
+        }
+        ze_result_t res;
+
+        // the first counters of all power domains and engine groups
+        std::vector<zes_pwr_handle_t> powers;
+        std::vector<zes_power_energy_counter_t> energy1;
+        std::vector<uint64_t> time1;
+        if (types.find(METRIC_POWER) != types.end()) {
+            res = getPowerHandles(device, powers);
+            if (res != ZE_RESULT_SUCCESS || powers.empty()) {
+                exception_msgs[METRIC_POWER]["zesDeviceEnumPowerDomains"] = res;
+                powers.clear();
+            }
+            energy1.resize(powers.size());
+            time1.resize(powers.size());
+            for (size_t i = 0; i < powers.size(); i++) {
+                energy1[i] = {};
+                XPUM_ZE_HANDLE_LOCK(powers[i], res = zesPowerGetEnergyCounter(powers[i], &energy1[i]));
+                time1[i] = Utility::getCurrentMicrosecond();
+                if (res != ZE_RESULT_SUCCESS) {
+                    exception_msgs[METRIC_POWER]["zesPowerGetEnergyCounter"] = res;
+                    time1[i] = 0;
+                }
+            }
+        }
+
+        std::vector<std::pair<MeasurementType, zes_engine_handle_t>> engines;
+        std::vector<zes_engine_stats_t> activity1;
+        bool has_engine_metric = false;
+        for (auto type : types) {
+            zes_engine_group_t group;
+            has_engine_metric |= engineGroupOfMetric(type, group);
+        }
+        if (has_engine_metric) {
+            zes_device_properties_t props = {};
+            props.stype = ZES_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceGetProperties(device, &props));
+            std::vector<EngineGroup> groups;
+            ze_result_t groups_res = getEngineGroups(device, groups);
+            for (auto type : types) {
+                zes_engine_group_t group;
+                if (!engineGroupOfMetric(type, group)) {
+                    continue;
+                }
                 if (res == ZE_RESULT_SUCCESS) {
-                    zes_power_energy_counter_t snap1 = {};
-                    zes_power_energy_counter_t snap2 = {};
-                    XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetEnergyCounter(power, &snap1));
-                    if (res == ZE_RESULT_SUCCESS) {
-                        uint64_t time1 = Utility::getCurrentMicrosecond();
-                        std::this_thread::sleep_for(std::chrono::milliseconds(Configuration::POWER_MONITOR_INTERNAL_PERIOD));
-                        XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetEnergyCounter(power, &snap2));
-                        if (res == ZE_RESULT_SUCCESS) {
-                            uint64_t time2 = Utility::getCurrentMicrosecond();
-                            ret->setCurrent((snap2.energy - snap1.energy) / (time2 - time1));
-                        } else {
-                            exception_msgs["zesPowerGetEnergyCounter"] = res;    
-                        }
-                    } else {
-                        exception_msgs["zesPowerGetEnergyCounter"] = res;
-                    }
+                    datas[type]->setNumSubdevices(props.numSubdevices);
                 } else {
-                    exception_msgs["zesPowerGetProperties"] = res;
+                    exception_msgs[type]["zesDeviceGetProperties"] = res;
+                }
+                if (groups_res != ZE_RESULT_SUCCESS) {
+                    exception_msgs[type]["zesDeviceEnumEngineGroups"] = groups_res;
+                    continue;
+                }
+                for (auto& engine : groups) {
+                    if (engine.type == group) {
+                        engines.push_back({type, engine.handle});
+                    }
+                }
+            }
+            activity1.resize(engines.size());
+            for (size_t i = 0; i < engines.size(); i++) {
+                activity1[i] = {};
+                XPUM_ZE_HANDLE_LOCK(engines[i].second, res = zesEngineGetActivity(engines[i].second, &activity1[i]));
+                if (res != ZE_RESULT_SUCCESS) {
+                    exception_msgs[engines[i].first]["zesEngineGetActivity"] = res;
+                    activity1[i].timestamp = UINT64_MAX;
                 }
             }
-        } else {
-            exception_msgs["zesDeviceEnumPowerDomains"] = res;
         }
-    
-        if (!exception_msgs.empty())
-            ret->setErrors(buildErrors(exception_msgs, __func__, __LINE__));
-        return ret;
+
+        // one window for all counters instead of one sleep per domain and engine
+        int window = 0;
+        if (!powers.empty()) {
+            window = Configuration::POWER_MONITOR_INTERNAL_PERIOD;
+        }
+        if (!engines.empty()) {
+            window = max(window, Configuration::ENGINE_GPU_UTILIZATION_INTERNAL_PERIOD);
+        }
+        if (window > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(window));
+        }
+
+        for (size_t i = 0; i < powers.size(); i++) {
+            if (time1[i] == 0) {
+                continue;
+            }
+            zes_power_energy_counter_t energy2 = {};
+            XPUM_ZE_HANDLE_LOCK(powers[i], res = zesPowerGetEnergyCounter(powers[i], &energy2));
+            if (res == ZE_RESULT_SUCCESS) {
+                uint64_t time2 = Utility::getCurrentMicrosecond();
+                datas[METRIC_POWER]->setCurrent((energy2.energy - energy1[i].energy) / (time2 - time1[i]));
+            } else {
+                exception_msgs[METRIC_POWER]["zesPowerGetEnergyCounter"] = res;
+            }
+        }
+
+        std::set<MeasurementType> gotten;
+        for (size_t i = 0; i < engines.size(); i++) {
+            if (activity1[i].timestamp == UINT64_MAX) {
+                continue;
+            }
+            MeasurementType type = engines[i].first;
+            zes_engine_stats_t activity2 = {};
+            XPUM_ZE_HANDLE_LOCK(engines[i].second, res = zesEngineGetActivity(engines[i].second, &activity2));
+            double val = 0;
+            bool valid = false;
+            if (activity2.timestamp > activity1[i].timestamp) {
+                val = (activity2.activeTime - activity1[i].activeTime) * 100.0 / (activity2.timestamp - activity1[i].timestamp);
+                if (val <= 100.0 && val >= 0) {
+                    valid = true;
+                    gotten.insert(type);
+                }
+            }
+            if (res == ZE_RESULT_SUCCESS && valid == true) {
+                datas[type]->setCurrent(val * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
+                datas[type]->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
+            } else {
+                exception_msgs[type]["zesEngineGetActivity"] = res;
+                XPUM_LOG_DEBUG("s1.activeTime = {}, s1.timestamp = {}, s2.activeTime = {}, s2.timestamp = {}", activity1[i].activeTime, activity1[i].timestamp, activity2.activeTime, activity2.timestamp);
+            }
+        }
+
+        // the PDH counters of the only GPU when Level Zero has no engine group data
+        int deviceCount = -1;
+        for (auto type : types) {
+            zes_engine_group_t group;
+            if (!engineGroupOfMetric(type, group) || gotten.find(type) != gotten.end()) {
+                continue;
+            }
+            if (deviceCount < 0) {
+                std::vector<std::shared_ptr<Device>> devices;
+                Core::instance().getDeviceManager()->getDeviceList(devices);
+                deviceCount = (int)devices.size();
+            }
+            if (deviceCount != 1) {
+                break;
+            }
+            double native = -1;
+            switch (type) {
+                case MeasurementType::METRIC_ENGINE_GROUP_COPY_ALL_UTILIZATION:
+                    native = getCopyEngineUtilByNativeAPI();
+                    break;
+                case MeasurementType::METRIC_ENGINE_GROUP_RENDER_ALL_UTILIZATION:
+                    native = getRenderEngineUtilByNativeAPI();
+                    break;
+                case MeasurementType::METRIC_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION:
+                    native = getComputeEngineUtilByNativeAPI();
+                    break;
+                case MeasurementType::METRIC_ENGINE_GROUP_MEDIA_ALL_UTILIZATION:
+                    native = getMediaEngineUtilByNativeAPI();
+                    break;
+                default:
+                    break;
+            }
+            if (native >= 0) {
+                datas[type]->setCurrent((uint64_t)(native * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE));
+                datas[type]->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
+                exception_msgs.erase(type);
+            }
+        }
+
+        for (auto& msgs : exception_msgs) {
+            if (!msgs.second.empty())
+                datas[msgs.first]->setErrors(buildErrors(msgs.second, __func__, __LINE__));
+        }
+        return datas;
     }
 
     void GPUDeviceStub::getPerformanceFactor(const zes_device_handle_t& device, std::vector<PerformanceFactor>& pf) {
@@ -933,136 +1160,7 @@ namespace xpum {
     }
 
     std::shared_ptr<MeasurementData> GPUDeviceStub::toGetEngineGroupUtilization(const zes_device_handle_t& device, MeasurementType type) noexcept {
-        std::shared_ptr<MeasurementData> ret = std::make_shared<MeasurementData>();
-        if (device == nullptr) {
-            ret->setErrors("toGetEngineGroupUtilization error");
-            return ret;
-        }
-
-        std::map<std::string, ze_result_t> exception_msgs;
-        uint32_t engine_count = 0;
-        ze_result_t res;
-        zes_device_properties_t props = {};
-        props.stype = ZES_STRUCTURE_TYPE_DEVICE_PROPERTIES;
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceGetProperties(device, &props));
-        if (res == ZE_RESULT_SUCCESS) {
-            ret->setNumSubdevices(props.numSubdevices);
-        } else {
-            exception_msgs["zesDeviceGetProperties"] = res;
-        }
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_count, nullptr));
-        XPUM_LOG_DEBUG("res = {}, engine_count = {}", res, engine_count);
-        bool _engineGroupDataGotten = false;
-        if (res == ZE_RESULT_SUCCESS && engine_count > 0) {
-            std::vector<zes_engine_handle_t> engines(engine_count);
-            std::map<uint32_t, std::vector<uint32_t>> group_utilizations;
-            XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumEngineGroups(device, &engine_count, engines.data()));
-            if (res == ZE_RESULT_SUCCESS) {
-                for (auto& engine : engines) {
-                    zes_engine_properties_t props = {};
-                    props.stype = ZES_STRUCTURE_TYPE_ENGINE_PROPERTIES;
-                    props.pNext = nullptr;
-                    XPUM_ZE_HANDLE_LOCK(engine, res = zesEngineGetProperties(engine, &props));
-                    if (res == ZE_RESULT_SUCCESS) {
-                        switch (type) {
-                            case MeasurementType::METRIC_COMPUTATION:
-                                if (props.type != ZES_ENGINE_GROUP_ALL) {
-                                    continue;
-                                }
-                                break;
-                            case MeasurementType::METRIC_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION:
-                                if (props.type != ZES_ENGINE_GROUP_COMPUTE_ALL) {
-                                    continue;
-                                }
-                                break;
-                            case MeasurementType::METRIC_ENGINE_GROUP_RENDER_ALL_UTILIZATION:
-                                if (props.type != ZES_ENGINE_GROUP_RENDER_ALL) {
-                                    continue;
-                                }
-                                break;
-                            case MeasurementType::METRIC_ENGINE_GROUP_MEDIA_ALL_UTILIZATION:
-                                if (props.type != ZES_ENGINE_GROUP_MEDIA_ALL) {
-                                    continue;
-                                }
-                                break;
-                            case MeasurementType::METRIC_ENGINE_GROUP_COPY_ALL_UTILIZATION:
-                                if (props.type != ZES_ENGINE_GROUP_COPY_ALL) {
-                                    continue;
-                                }
-                                break;
-                            case MeasurementType::METRIC_ENGINE_GROUP_3D_ALL_UTILIZATION:
-                                if (props.type != ZES_ENGINE_GROUP_3D_ALL) {
-                                    continue;
-                                }
-                                break;
-                            default:
-                                break;
-                        }
-                        zes_engine_stats_t snap1 = {};
-                        XPUM_ZE_HANDLE_LOCK(engine, res = zesEngineGetActivity(engine, &snap1));
-                        if (res == ZE_RESULT_SUCCESS) {
-                            std::this_thread::sleep_for(std::chrono::milliseconds(Configuration::ENGINE_GPU_UTILIZATION_INTERNAL_PERIOD));
-                            zes_engine_stats_t snap2 = {};
-                            XPUM_ZE_HANDLE_LOCK(engine, res = zesEngineGetActivity(engine, &snap2));
-                            double val = 0;
-                            bool valid = false;
-                            if (snap2.timestamp > snap1.timestamp) {
-                                val = (snap2.activeTime - snap1.activeTime) * 100.0 / (snap2.timestamp - snap1.timestamp);
-                                if (val <= 100.0 && val >= 0) {
-                                    valid = true;
-                                    _engineGroupDataGotten = true;
-                                }
-                            }
-                            if (res == ZE_RESULT_SUCCESS && valid == true) {
-                                ret->setCurrent(val * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
-                                ret->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
-                            } else {
-                                exception_msgs["zesEngineGetActivity"] = res;
-                                XPUM_LOG_DEBUG("s1.activeTime = {}, s1.timestamp = {}, s2.activeTime = {}, s2.timestamp = {}", snap1.activeTime, snap1.timestamp, snap2.activeTime, snap2.timestamp);                            
-                            }
-                        } else {
-                            exception_msgs["zesEngineGetActivity"] = res;
-                        }
-                    } else {
-                        exception_msgs["zesEngineGetProperties"] = res;
-                    }
-                }
-            } else {
-                exception_msgs["zesDeviceEnumEngineGroups"] = res;
-            }
-        }
-        std::vector<std::shared_ptr<Device>> devices;
-        Core::instance().getDeviceManager()->getDeviceList(devices);
-        const int deviceCount = devices.size();
-        if (!_engineGroupDataGotten && deviceCount == 1) {
-            if (type == MeasurementType::METRIC_ENGINE_GROUP_COPY_ALL_UTILIZATION) {
-                ret->setCurrent((uint64_t)(getCopyEngineUtilByNativeAPI() * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE));
-                ret->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
-                return ret;
-            }
-
-            if (type == MeasurementType::METRIC_ENGINE_GROUP_RENDER_ALL_UTILIZATION) {
-                ret->setCurrent((uint64_t)(getRenderEngineUtilByNativeAPI() * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE));
-                ret->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
-                return ret;
-            }
-            
-            if (type == MeasurementType::METRIC_ENGINE_GROUP_COMPUTE_ALL_UTILIZATION) {
-                ret->setCurrent((uint64_t)(getComputeEngineUtilByNativeAPI() * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE));
-                ret->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
-                return ret;
-            }
-
-            if (type == MeasurementType::METRIC_ENGINE_GROUP_MEDIA_ALL_UTILIZATION) {
-                ret->setCurrent((uint64_t)(getMediaEngineUtilByNativeAPI() * Configuration::DEFAULT_MEASUREMENT_DATA_SCALE));
-                ret->setScale(Configuration::DEFAULT_MEASUREMENT_DATA_SCALE);
-                return ret;
-            }
-        }
-
-        if (!exception_msgs.empty())
-            ret->setErrors(buildErrors(exception_msgs, __func__, __LINE__));
-        return ret;
+        return toGetWindowedMetrics(device, {type})[type];
     }
 
     std::shared_ptr<MeasurementData> GPUDeviceStub::toGetEnergy(const zes_device_handle_t& device) noexcept {
@@ -1073,25 +1171,16 @@ namespace xpum {
         }
 
         std::map<std::string, ze_result_t> exception_msgs;
-        uint32_t power_domain_count = 0;
-        ze_result_t res;
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, nullptr));
-        std::vector<zes_pwr_handle_t> power_handles(power_domain_count);
-        XPUM_ZE_HANDLE_LOCK(device, res = zesDeviceEnumPowerDomains(device, &power_domain_count, power_handles.data()));
+        std::vector<zes_pwr_handle_t> power_handles;
+        ze_result_t res = getPowerHandles(device, power_handles);
         if (res == ZE_RESULT_SUCCESS) {
             for (auto& power : power_handles) {
-                zes_power_properties_t props = {};
-                XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetProperties(power, &props));
+                zes_power_energy_counter_t snap = {};
+                XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetEnergyCounter(power, &snap));
                 if (res == ZE_RESULT_SUCCESS) {
-                    zes_power_energy_counter_t snap = {};
-                    XPUM_ZE_HANDLE_LOCK(power, res = zesPowerGetEnergyCounter(power, &snap));
-                    if (res == ZE_RESULT_SUCCESS) {
-                        ret->setCurrent(snap.energy * 1.0 / 1000);
-                    } else {
-                        exception_msgs["zesPowerGetEnergyCounter"] = res;
-                    }
+                    ret->setCurrent(snap.energy * 1.0 / 1000);
                 } else {
-                    exception_msgs["zesPowerGetProperties"] = res;
+                    exception_msgs["zesPowerGetEnergyCounter"] = res;
                 }
             }
         } else {
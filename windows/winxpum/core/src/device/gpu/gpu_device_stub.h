@@ -8,6 +8,7 @@
 #pragma warning(disable : 4996)
 
 #include <mutex>
+#include <set>
 
 #include "device/device.h"
 #include "device/performancefactor.h"
@@ -76,7 +77,14 @@ namespace xpum {
 
         std::shared_ptr<MeasurementData> toGetPerfMetrics(const zes_device_handle_t& device, const ze_driver_handle_t& driver) noexcept;
 
+        // METRIC_POWER and the engine group utilizations in types, all read in one sampling window
+        std::map<MeasurementType, std::shared_ptr<MeasurementData>> toGetWindowedMetrics(const zes_device_handle_t& device, const std::set<MeasurementType>& types) noexcept;
+
     private:
+        struct EngineGroup {
+            zes_engine_handle_t handle;
+            zes_engine_group_t type;
+        };
         GPUDeviceStub();
 
         ~GPUDeviceStub();
@@ -93,9 +101,21 @@ namespace xpum {
 
         static std::string to_string(zes_pci_address_t address);
 
+        // the power domains of device, enumerated once
+        ze_result_t getPowerHandles(const zes_device_handle_t& device, std::vector<zes_pwr_handle_t>& handles) noexcept;
+
+        // the engine groups of device, enumerated once
+        ze_result_t getEngineGroups(const zes_device_handle_t& device, std::vector<EngineGroup>& groups) noexcept;
+
         bool initialized;
 
         std::mutex mutex;
+
+        std::mutex handle_mutex;
+
+        std::map<zes_device_handle_t, std::vector<zes_pwr_handle_t>> power_handles;
+
+        std::map<zes_device_handle_t, std::vector<EngineGroup>> engine_groups;
     };
 
 } // end namespace xpum
\ No newline at end of file
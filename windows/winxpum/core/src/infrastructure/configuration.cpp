@@ -23,8 +23,27 @@ namespace xpum {
     uint32_t Configuration::DEFAULT_MEASUREMENT_DATA_SCALE = 100;
     int Configuration::EU_ACTIVE_STALL_IDLE_MONITOR_INTERNAL_PERIOD = 100;
     int Configuration::EU_ACTIVE_STALL_IDLE_STREAMER_SAMPLING_PERIOD = 20000000;
+    int Configuration::REALTIME_METRICS_SAMPLING_PERIOD = 1000;
+    int Configuration::REALTIME_METRICS_MAX_AGE = 2000;
     std::set<MeasurementType> Configuration::enabled_metrics;
 
+    void Configuration::initRealtimeMetrics() {
+        char* env = nullptr;
+        size_t sz = 0;
+        if (_dupenv_s(&env, &sz, "XPUM_REALTIME_METRICS_PERIOD") == 0 && env != nullptr) {
+            std::string env_str(env);
+            free(env);
+            XPUM_LOG_INFO("The environment variable XPUM_REALTIME_METRICS_PERIOD is detected: {}", env_str);
+            try {
+                REALTIME_METRICS_SAMPLING_PERIOD = (std::max)(0, std::stoi(env_str));
+            } catch (std::exception&) {
+                XPUM_LOG_WARN("Invalid XPUM_REALTIME_METRICS_PERIOD {}", env_str);
+            }
+        }
+        // the sampler refreshes the table before it is too old, callers sampling on their own share it briefly
+        REALTIME_METRICS_MAX_AGE = REALTIME_METRICS_SAMPLING_PERIOD > 0 ? REALTIME_METRICS_SAMPLING_PERIOD * 2 : 500;
+    }
+
     void Configuration::initEnabledMetrics() {
         char* xpum_metrics_env = nullptr;
         size_t sz = 0;
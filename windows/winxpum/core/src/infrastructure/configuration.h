@@ -23,13 +23,20 @@ namespace xpum {
         static uint32_t DEFAULT_MEASUREMENT_DATA_SCALE;
         static int EU_ACTIVE_STALL_IDLE_MONITOR_INTERNAL_PERIOD;
         static int EU_ACTIVE_STALL_IDLE_STREAMER_SAMPLING_PERIOD;
+        // ms between the background samples of the realtime metrics, 0 if they are only sampled on request
+        static int REALTIME_METRICS_SAMPLING_PERIOD;
+        // ms a realtime metrics table is returned before it is sampled again
+        static int REALTIME_METRICS_MAX_AGE;
 
         static void init() {
             initEnabledMetrics();
+            initRealtimeMetrics();
         }
 
         static void initEnabledMetrics();
 
+        static void initRealtimeMetrics();
+
         static std::set<MeasurementType>& getEnabledMetrics() {
             return enabled_metrics;
         }